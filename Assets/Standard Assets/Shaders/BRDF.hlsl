@@ -49,21 +49,75 @@ float3 Diffuse_OrenNayar( float3 DiffuseColor, float Roughness, float NoV, float
 }
 
 // IMAGE BASED LIGHTING ======================================================
-float3 ImageBasedLighting(Material material, float3 lightDirection, float3 normal, float3 viewDir, SamplerState samplerLinear)
+// [Karis 2014, "Physically Based Shading on Mobile"], analytic fit of the pre-integrated environment BRDF
+float3 EnvBRDFApprox(float3 specularColor, float roughness, float NdotV)
+{
+	const float4 c0 = float4(-1.0f, -0.0275f, -0.572f, 0.022f);
+	const float4 c1 = float4(1.0f, 0.0425f, 1.04f, -0.04f);
+	float4 r 		= roughness * c0 + c1;
+	float a004 		= min(r.x * r.x, exp2(-9.28f * NdotV)) * r.x + r.y;
+	float2 AB 		= float2(-1.04f, 1.04f) * a004 + r.zw;
+	return specularColor * AB.x + AB.y;
+}
+
+// Irradiance from 9 pre-convolved coefficients, see ImageBasedLighting.cpp
+float3 SH_Evaluate(float3 sh[9], float3 n)
+{
+	return max(0.0f,
+		sh[0] +
+		sh[1] * n.y +
+		sh[2] * n.z +
+		sh[3] * n.x +
+		sh[4] * n.x * n.y +
+		sh[5] * n.y * n.z +
+		sh[6] * (3.0f * n.z * n.z - 1.0f) +
+		sh[7] * n.x * n.z +
+		sh[8] * (n.x * n.x - n.y * n.y));
+}
+
+float3 Irradiance_SH(float3 n)
+{
+	float3 sh[9];
+	[unroll]
+	for (uint i = 0; i < 9; i++)
+	{
+		sh[i] = environmentSH[i].rgb;
+	}
+	
+	return SH_Evaluate(sh, n);
+}
+
+// The reflection (premultiplied by it's alpha) replaces that much of the environment's, so do the probes (by their w) for the diffuse and the specular
+float3 ImageBasedLighting(Material material, float3 lightDirection, float3 normal, float3 viewDir, float4 reflection, float4 probeIrradiance, float4 probeSpecular, SamplerState samplerLinear)
 {
 	// Compute reflection vector
 	float3 reflectionVector = reflect(-viewDir, normal);
+	float NdotV 			= saturate(dot(normal, viewDir));
 	
-    float a             = max(0.001f, material.roughness * material.roughness);
 	float3 diffuseColor = (1.0f - material.metallic) * material.albedo;
 	float3 F0 			= lerp(0.03f, material.albedo, material.metallic);	
 
-	float3 indirectDiffuse  = ToLinear(environmentTex.SampleLevel(samplerLinear, reflectionVector, 10.0f)).rgb;
-	float3 indirectSpecular = ToLinear(environmentTex.SampleLevel(samplerLinear, reflectionVector, a * 10.0f)).rgb;
-	float3 envFresnel 		= F_FresnelSchlick(F0, a, normal, viewDir);
+	// Each mip of the prefiltered cubemap is GGX convolved for a (perceptual) roughness, one lookup is enough
+	float3 indirectDiffuse;
+	float3 indirectSpecular;
+	[branch]
+	if (environmentMipCount > 1.0f)
+	{
+		indirectDiffuse 	= Irradiance_SH(normal);
+		indirectSpecular 	= ToLinear(environmentPrefilteredTex.SampleLevel(samplerLinear, reflectionVector, material.roughness * (environmentMipCount - 1.0f))).rgb;
+	}
+	else // not prefiltered (yet), approximate with the skybox's mips
+	{
+		indirectDiffuse 	= ToLinear(environmentTex.SampleLevel(samplerLinear, normal, 10.0f)).rgb;
+		indirectSpecular 	= ToLinear(environmentTex.SampleLevel(samplerLinear, reflectionVector, material.roughness * 10.0f)).rgb;
+	}
+
+	indirectDiffuse		= lerp(indirectDiffuse, probeIrradiance.rgb, probeIrradiance.w);
+	indirectSpecular	= lerp(indirectSpecular, probeSpecular.rgb, probeSpecular.w);
+	indirectSpecular 	= indirectSpecular * (1.0f - saturate(reflection.a)) + reflection.rgb;
 
 	float3 cDiffuse 	= indirectDiffuse * diffuseColor;
-	float3 cSpecular 	= indirectSpecular * envFresnel;
+	float3 cSpecular 	= indirectSpecular * EnvBRDFApprox(F0, material.roughness, NdotV);
 	
 	return cDiffuse + cSpecular;
 }
@@ -0,0 +1,75 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+// Progressive bloom, every level is half the size of the one above it.
+// PASS_DOWNSAMPLE: 	texSource is the level above (the frame itself for the first, PASS_BRIGHT then keeps only what's bright)
+// PASS_UPSAMPLE: 		texSource is the (already upsampled) level below, texSource2 is this level's downsample
+
+#define THREAD_GROUP_SIZE 	8
+#define TILE_SIZE 			(THREAD_GROUP_SIZE + 2) // the group's texels plus a one texel border, for the 3x3 tent
+#define TILE_TEXELS 		(TILE_SIZE * TILE_SIZE)
+
+//= TEXTURES ====================================
+Texture2D texSource 			: register(t0);
+Texture2D texSource2 			: register(t1);
+RWTexture2D<float4> texOut 		: register(u0);
+//===============================================
+
+//= SAMPLERS ==============================
+SamplerState samplerLinear 	: register(s0);
+//=========================================
+
+//= CONSTANT BUFFERS ===================
+cbuffer BloomBuffer : register(b0)
+{
+	float2 resolution;	// of texOut
+	float threshold;	// luminance, only for PASS_BRIGHT
+	float padding;
+};
+//======================================
+
+groupshared float3 tile[TILE_TEXELS];
+
+// A bilinear tap at the center of an output texel, when downsampling that's the 2x2 box below it
+float3 SampleSource(int2 texel)
+{
+	float2 uv		= (float2(texel) + 0.5f) / resolution;
+	float3 color	= texSource.SampleLevel(samplerLinear, uv, 0).rgb;
+
+#if PASS_BRIGHT
+	float luminance = dot(color, float3(0.2126f, 0.7152f, 0.0722f));
+	color = luminance > threshold ? color : 0.0f;
+#endif
+
+	return color;
+}
+
+[numthreads(THREAD_GROUP_SIZE, THREAD_GROUP_SIZE, 1)]
+void mainCS(uint3 groupID : SV_GroupID, uint3 threadID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+	// Every texel the group needs gets sampled once, the neighbouring threads share it
+	int2 tileOrigin = int2(groupID.xy) * THREAD_GROUP_SIZE - 1;
+	for (uint i = groupIndex; i < TILE_TEXELS; i += THREAD_GROUP_SIZE * THREAD_GROUP_SIZE)
+	{
+		tile[i] = SampleSource(tileOrigin + int2(i % TILE_SIZE, i / TILE_SIZE));
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	int2 texel = int2(groupID.xy * THREAD_GROUP_SIZE + threadID.xy);
+	if (any(texel >= int2(resolution)))
+		return;
+
+	// 3x3 tent
+	uint center 	= (threadID.y + 1) * TILE_SIZE + threadID.x + 1;
+	float3 color 	= tile[center] * 4.0f;
+	color 			+= (tile[center - 1] + tile[center + 1] + tile[center - TILE_SIZE] + tile[center + TILE_SIZE]) * 2.0f;
+	color 			+= tile[center - TILE_SIZE - 1] + tile[center - TILE_SIZE + 1] + tile[center + TILE_SIZE - 1] + tile[center + TILE_SIZE + 1];
+	color 			/= 16.0f;
+
+#if PASS_UPSAMPLE
+	color += texSource2.Load(int3(texel, 0)).rgb;
+#endif
+
+	texOut[texel] = float4(color, 1.0f);
+}
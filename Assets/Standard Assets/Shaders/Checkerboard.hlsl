@@ -0,0 +1,92 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+//= TEXTURES ==============================
+Texture2D texLit 			: register(t0); // half as wide, this frame's half of the checkerboard
+Texture2D texHistory 		: register(t1);
+Texture2D texVelocity 		: register(t2);
+//=========================================
+
+//= SAMPLERS ==============================
+SamplerState samplerPoint 	: register(s0);
+SamplerState samplerLinear 	: register(s1);
+//=========================================
+
+//= CONSTANT BUFFERS ==========================
+cbuffer MiscBuffer : register(b0)
+{
+	matrix mTransform;
+	float2 resolution;		// of the full width target
+	float resolutionScale;	// everything only covers this much of its textures
+	float historyValid;		// the history was resolved at the same scale
+	float parity;			// which half of the checkerboard got lit
+	float3 padding;
+};
+//=============================================
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 uv 		: TEXCOORD;
+};
+
+struct PixelOutputType
+{
+	float4 color	: SV_Target0;
+	float4 history	: SV_Target1;
+};
+
+PixelInputType mainVS(Vertex_PosUv input)
+{
+    PixelInputType output;
+
+    input.position.w 	= 1.0f;
+    output.position 	= mul(input.position, mTransform);
+    output.uv 			= input.uv;
+
+    return output;
+}
+
+// Every half-width texel holds the lit pixel of its horizontal pair, so any pixel of a row maps to a lit one
+float4 LoadLit(int2 pixel, int2 pixelMax)
+{
+	pixel = clamp(pixel, int2(0, 0), pixelMax);
+	return texLit.Load(int3(pixel.x >> 1, pixel.y, 0));
+}
+
+PixelOutputType mainPS(PixelInputType input)
+{
+	PixelOutputType output;
+
+	int2 pixel		= int2(input.position.xy);
+	int2 pixelMax	= int2(resolution * resolutionScale) - 1;
+	float4 color	= LoadLit(pixel, pixelMax);
+
+	// Lit this frame when x + y + parity is even, the four direct neighbours of a skipped pixel are all lit
+	if (((pixel.x + pixel.y + (int)parity) & 1) != 0)
+	{
+		float4 left		= LoadLit(pixel + int2(-1, 0), pixelMax);
+		float4 right	= LoadLit(pixel + int2(1, 0), pixelMax);
+		float4 up		= LoadLit(pixel + int2(0, -1), pixelMax);
+		float4 down		= LoadLit(pixel + int2(0, 1), pixelMax);
+
+		// Interpolate along the direction that changes the least (luma is in alpha), so edges don't get smeared
+		float4 spatial = abs(left.a - right.a) < abs(up.a - down.a) ? (left + right) * 0.5f : (up + down) * 0.5f;
+
+		// This pixel was lit last frame, reproject it and clamp it to the neighbourhood to reject what changed since
+		float2 uvFull		= input.uv / resolutionScale;
+		float2 velocity		= texVelocity.Sample(samplerPoint, input.uv).xy;
+		float2 uvHistory	= uvFull - velocity;
+		bool offscreen		= any(uvHistory != saturate(uvHistory));
+		float4 history		= texHistory.Sample(samplerLinear, uvHistory * resolutionScale);
+		float4 colorMin		= min(min(left, right), min(up, down));
+		float4 colorMax		= max(max(left, right), max(up, down));
+
+		color = (historyValid == 0.0f || offscreen) ? spatial : clamp(history, colorMin, colorMax);
+	}
+
+	output.color	= color;
+	output.history	= color;
+	return output;
+}
@@ -3,6 +3,7 @@
 ------------------------------------------------------------------------------*/
 #define PI 3.1415926535897932384626433832795
 #define EPSILON 2.7182818284
+#define INSTANCE_BATCH_MAX 256 // must match the engine side
 
 
 //= DEFINES ===================
@@ -36,6 +37,13 @@ struct Vertex_PosColor
     float4 color 	: COLOR;
 };
 
+struct Vertex_Pos2dUvColor
+{
+    float2 position : POSITION0;
+    float2 uv 		: TEXCOORD0;
+    float4 color 	: COLOR;
+};
+
 
 struct Vertex_PosUvTbn
 {
@@ -46,6 +54,26 @@ struct Vertex_PosUvTbn
 	float3 bitangent 	: BITANGENT;
 };
 
+// RHI_Vertex_PosUVTBNPacked, the input assembler already expands the half floats and the unorms
+struct Vertex_PosUvTbnPacked
+{
+	float4 position 	: POSITION0;
+    float2 uv 			: TEXCOORD0;
+    float4 normal 		: NORMAL;
+    float4 tangent		: TANGENT; // w is the bitangent sign, 0 or 1
+};
+
+Vertex_PosUvTbn UnpackVertex(Vertex_PosUvTbnPacked packed)
+{
+	Vertex_PosUvTbn vertex;
+	vertex.position		= packed.position;
+	vertex.uv			= packed.uv;
+	vertex.normal		= normalize(packed.normal.xyz * 2.0f - 1.0f);
+	vertex.tangent		= normalize(packed.tangent.xyz * 2.0f - 1.0f);
+	vertex.bitangent	= cross(vertex.normal, vertex.tangent) * (packed.tangent.w * 2.0f - 1.0f);
+	return vertex;
+}
+
 
 /*------------------------------------------------------------------------------
 							[STRUCTS]
@@ -67,6 +95,16 @@ struct Light
 	float padding;
 };
 
+// A renderable as the GPU culls it, must match GPUCulling.h
+struct CullingObject
+{
+	matrix world;
+	float3 center;
+	uint draw;
+	float3 extents;
+	float padding;
+};
+
 /*------------------------------------------------------------------------------
 							[GAMMA CORRECTION]
 ------------------------------------------------------------------------------*/
@@ -98,6 +136,13 @@ float3 UnpackNormal(float3 normal)
 	return normal * 2.0f - 1.0f;
 }
 
+// Normal maps only need their x and y, z is rebuilt so two channel (BC5) maps work too
+float3 UnpackNormalMap(float2 normal)
+{
+	float2 xy = normal * 2.0f - 1.0f;
+	return float3(xy, sqrt(saturate(1.0f - dot(xy, xy))));
+}
+
 float3 PackNormal(float3 normal)
 {
 	return normal * 0.5f + 0.5f;
@@ -175,25 +220,36 @@ float4 Pass_BlurGaussian(float2 uv, Texture2D sourceTexture, SamplerState biline
 /*------------------------------------------------------------------------------
 							[Chromatic Aberration]
 ------------------------------------------------------------------------------*/
-float3 ChromaticAberrationPass(float2 texCoord, float2 texelSize, Texture2D sourceTexture, SamplerState bilinearSampler)
+float2 ChromaticAberration_Offset(float2 texCoord, float2 texelSize)
 {
-	float2 shift 	= float2(2.5f, -0.5f);	// 	[-10, 10]
-	float strength 	= 0.5f;  				//	[0, 1]
+	float2 shift = float2(2.5f, -0.5f);	// 	[-10, 10]
 	
 	// supposedly, lens effect
 	shift.x *= abs(texCoord.x * 2.0f - 1.0f);
 	shift.y *= abs(texCoord.y * 2.0f - 1.0f);
 	
-	float3 color 		= float3(0.0f, 0.0f, 0.0f);
+	return texelSize * shift;
+}
+
+// red and blue are sampled at texCoord + offset and texCoord - offset respectively
+float3 ChromaticAberration_Combine(float3 colorInput, float red, float blue)
+{
+	float strength = 0.5f;  //	[0, 1]
+	
+	// adjust the strength of the effect
+	return lerp(colorInput, float3(red, colorInput.g, blue), strength);
+}
+
+float3 ChromaticAberrationPass(float2 texCoord, float2 texelSize, Texture2D sourceTexture, SamplerState bilinearSampler)
+{
+	float2 offset 		= ChromaticAberration_Offset(texCoord, texelSize);
 	float3 colorInput 	= sourceTexture.Sample(bilinearSampler, texCoord).rgb;
 	
 	// sample the color components
-	color.r = sourceTexture.Sample(bilinearSampler, texCoord + (texelSize * shift)).r;
-	color.g = colorInput.g;
-	color.b = sourceTexture.Sample(bilinearSampler, texCoord - (texelSize * shift)).b;
+	float red 	= sourceTexture.Sample(bilinearSampler, texCoord + offset).r;
+	float blue 	= sourceTexture.Sample(bilinearSampler, texCoord - offset).b;
 
-	// adjust the strength of the effect
-	return lerp(colorInput, color, strength);
+	return ChromaticAberration_Combine(colorInput, red, blue);
 }
 
 /*------------------------------------------------------------------------------
@@ -221,45 +277,34 @@ float3 FXAA(float2 texCoord, float2 texelSize, Texture2D sourceTexture, SamplerS
 /*------------------------------------------------------------------------------
 								[SHARPENING]
 ------------------------------------------------------------------------------*/
-float3 LumaSharpen(float2 texCoord, Texture2D sourceTexture, SamplerState bilinearSampler, float2 resolution)
+/*
+	LumaSharpen 1.4.1
+	original hlsl by Christian Cann Schuldt Jensen ~ CeeJay.dk
+	port to glsl by Anon
+	ported back to hlsl and modified by Panos karabelas
+	It blurs the original pixel with the surrounding pixels and then subtracts this blur to sharpen the image.
+	It does this in luma to avoid color artifacts and allows limiting the maximum sharpning to avoid or lessen halo artifacts.
+	This is similar to using Unsharp Mask in Photoshop.
+*/
+
+// -- Sharpening --
+#define sharp_strength 1.0f   //[0.10 to 3.00] Strength of the sharpening
+#define sharp_clamp    0.35f  //[0.000 to 1.000] Limits maximum amount of sharpening a pixel recieves - Default is 0.035
+
+// -- Advanced sharpening settings --
+#define offset_bias 1.0f  //[0.0 to 6.0] Offset bias adjusts the radius of the sampling pattern.
+#define CoefLuma float3(0.2126f, 0.7152f, 0.0722f)      // BT.709 & sRBG luma coefficient (Monitors and HD Television)
+
+// The blur is sampled at texCoord +/- this offset, in both axes (the four diagonals)
+float2 LumaSharpen_Offset(float2 resolution)
 {
-	/*
-		LumaSharpen 1.4.1
-		original hlsl by Christian Cann Schuldt Jensen ~ CeeJay.dk
-		port to glsl by Anon
-		ported back to hlsl and modified by Panos karabelas
-		It blurs the original pixel with the surrounding pixels and then subtracts this blur to sharpen the image.
-		It does this in luma to avoid color artifacts and allows limiting the maximum sharpning to avoid or lessen halo artifacts.
-		This is similar to using Unsharp Mask in Photoshop.
-	*/
-	
-	// -- Sharpening --
-	#define sharp_strength 1.0f   //[0.10 to 3.00] Strength of the sharpening
-	#define sharp_clamp    0.35f  //[0.000 to 1.000] Limits maximum amount of sharpening a pixel recieves - Default is 0.035
-	
-	// -- Advanced sharpening settings --
-	#define offset_bias 1.0f  //[0.0 to 6.0] Offset bias adjusts the radius of the sampling pattern.
-	#define CoefLuma float3(0.2126f, 0.7152f, 0.0722f)      // BT.709 & sRBG luma coefficient (Monitors and HD Television)
-
-	float4 colorInput = sourceTexture.Sample(bilinearSampler, texCoord);  	
-	float3 ori = colorInput.rgb;
+	return float2(1.0f / resolution[0], 1.0f / resolution[1]) * 0.5f * offset_bias;
+}
 
+float3 LumaSharpen_Combine(float3 ori, float3 blur_ori)
+{
 	// -- Combining the strength and luma multipliers --
 	float3 sharp_strength_luma = (CoefLuma * sharp_strength); //I'll be combining even more multipliers with it later on
-	
-	// -- Gaussian filter --
-	//   [ .25, .50, .25]     [ 1 , 2 , 1 ]
-	//   [ .50,   1, .50]  =  [ 2 , 4 , 2 ]
- 	//   [ .25, .50, .25]     [ 1 , 2 , 1 ]
-
-	float px = 1.0f / resolution[0];
-	float py = 1.0f / resolution[1];
-
-	float3 blur_ori = sourceTexture.Sample(bilinearSampler, texCoord + float2(px,-py) * 0.5f * offset_bias).rgb; // South East
-	blur_ori += sourceTexture.Sample(bilinearSampler, texCoord + float2(-px,-py) * 0.5f * offset_bias).rgb;  // South West
-	blur_ori += sourceTexture.Sample(bilinearSampler, texCoord + float2(px,py) * 0.5f * offset_bias).rgb; // North East
-	blur_ori += sourceTexture.Sample(bilinearSampler, texCoord + float2(-px,py) * 0.5f * offset_bias).rgb; // North West
-	blur_ori *= 0.25f;  // ( /= 4) Divide by the number of texture fetches
 
 	// -- Calculate the sharpening --
 	float3 sharp = ori - blur_ori;  //Subtracting the blurred image from the original image
@@ -271,8 +316,27 @@ float3 LumaSharpen(float2 texCoord, Texture2D sourceTexture, SamplerState biline
 	sharp_luma = (sharp_clamp * 2.0f) * sharp_luma - sharp_clamp; //scale down
 
 	// -- Combining the values to get the final sharpened pixel	--
-	colorInput.rgb = colorInput.rgb + sharp_luma;    // Add the sharpening to the input color.
-	return clamp(colorInput, 0.0f, 1.0f).rgb;
+	return clamp(ori + sharp_luma, 0.0f, 1.0f);    // Add the sharpening to the input color.
+}
+
+float3 LumaSharpen(float2 texCoord, Texture2D sourceTexture, SamplerState bilinearSampler, float2 resolution)
+{
+	float3 ori = sourceTexture.Sample(bilinearSampler, texCoord).rgb;
+	
+	// -- Gaussian filter --
+	//   [ .25, .50, .25]     [ 1 , 2 , 1 ]
+	//   [ .50,   1, .50]  =  [ 2 , 4 , 2 ]
+ 	//   [ .25, .50, .25]     [ 1 , 2 , 1 ]
+
+	float2 offset = LumaSharpen_Offset(resolution);
+
+	float3 blur_ori = sourceTexture.Sample(bilinearSampler, texCoord + float2(offset.x, -offset.y)).rgb; // South East
+	blur_ori += sourceTexture.Sample(bilinearSampler, texCoord + float2(-offset.x, -offset.y)).rgb;  // South West
+	blur_ori += sourceTexture.Sample(bilinearSampler, texCoord + float2(offset.x, offset.y)).rgb; // North East
+	blur_ori += sourceTexture.Sample(bilinearSampler, texCoord + float2(-offset.x, offset.y)).rgb; // North West
+	blur_ori *= 0.25f;  // ( /= 4) Divide by the number of texture fetches
+
+	return LumaSharpen_Combine(ori, blur_ori);
 }
 
 /*------------------------------------------------------------------------------
@@ -282,13 +346,23 @@ float3 ReconstructPositionWorld(float depth, matrix viewProjectionInverse, float
 {	
 	float x 			= texCoord.x * 2.0f - 1.0f;
 	float y 			= (1.0f - texCoord.y) * 2.0f - 1.0f;
-	float z				= depth;
+	float z				= max(depth, 0.000001f); // with reverse-z (and an infinite far plane) a depth of 0 is at infinity
     float4 pos_clip 	= float4(x, y, z, 1.0f);
 	float4 pos_world 	= mul(pos_clip, viewProjectionInverse);
 	
     return pos_world.xyz / pos_world.w;  
 }
 
+/*------------------------------------------------------------------------------
+								[DEPTH]
+------------------------------------------------------------------------------*/
+// Whether the G-Buffer's depth is closer than depth. Where nothing was rendered it's still
+// cleared to 0, that's never closer (with reverse-z 0 is infinitely far away anyway).
+bool DepthIsCloser(float depthGBuffer, float depth, float reverseZ)
+{
+	return reverseZ != 0.0f ? depthGBuffer > depth : (depthGBuffer != 0.0f && depthGBuffer < depth);
+}
+
 /*------------------------------------------------------------------------------
 								[MISC]
 ------------------------------------------------------------------------------*/
@@ -0,0 +1,266 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+// GPU driven visibility, every draw is a run of instances of one mesh with one set of arguments per level of detail.
+// PASS_RESET:	one thread per set of arguments, writes the mesh's index range with no instances
+// PASS_CULL:	one thread per object, appends the ones that pass the frustum and occlusion tests to their draw
+// PASS_CLUSTER:	one thread group per cluster of a single object draw, when the object is drawn at full detail the
+//				clusters that pass the frustum, occlusion and cone tests copy their indices to the compacted ones
+
+#define THREAD_GROUP_SIZE	64	// must match GPU_CULLING_THREAD_GROUP_SIZE
+#define LODS_MAX			4	// must match MODEL_LODS_MAX
+#define HIZ_LEVELS_MAX		8	// must match GPU_CULLING_HIZ_LEVELS_MAX
+#define ARGUMENTS_SIZE		20	// D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS
+#define ARGUMENT_SETS		(LODS_MAX + 1) // the last one draws the clusters
+#define CLUSTER_DISPATCH_WIDTH	1024 // must match GPU_CULLING_CLUSTER_DISPATCH_WIDTH
+#define DRAW_INDICES_16		1
+#define DRAW_CONE_CULLING	2
+
+struct Draw
+{
+	uint4 indexCount;
+	uint4 indexOffset;
+	float4 lodScreenSize;
+	uint instanceOffset;
+	uint objectCount;
+	uint lodCount;
+	int vertexOffset;
+	uint clusterOffset;
+	uint clusterCount;
+	uint compactedOffset;
+	uint flags;
+};
+
+struct Cluster
+{
+	float3 center;
+	uint indexOffset;
+	float3 extents;
+	uint indexCount;
+	float3 coneApex;
+	float coneCutoff;
+	float3 coneAxis;
+	float padding;
+};
+
+//= BUFFERS ===================================================
+StructuredBuffer<CullingObject> objects	: register(t0);
+StructuredBuffer<Draw> draws			: register(t1);
+Texture2D depthLevels[HIZ_LEVELS_MAX]	: register(t2); // farthest linear depth, each level half the size of the previous one
+ByteAddressBuffer modelIndices			: register(t10);
+StructuredBuffer<Cluster> clusters		: register(t11);
+RWStructuredBuffer<uint> instances		: register(u0);
+RWByteAddressBuffer arguments			: register(u1);
+RWByteAddressBuffer compactedIndices	: register(u2);
+
+cbuffer CullingBuffer : register(b0)
+{
+	matrix mViewProjection;
+	matrix mViewProjectionOccluder;	// what the depth levels were rendered with
+	float3 cameraPosition;
+	float projectionScale;			// the projection's y scale, for the level of detail
+	float farPlaneOccluder;
+	uint objectCount;
+	uint argumentCount;
+	uint levelCount;				// zero skips the occlusion test
+	float3 origin;					// what the world matrices are relative to
+	uint clusterDraw;				// PASS_CLUSTER culls the clusters of one draw
+	uint clusterOffset;
+	uint clusterCount;
+	uint2 padding;
+};
+//=============================================================
+
+float DepthLevel_Load(uint level, uint2 texel)
+{
+	// Resources can only be indexed with literals, the loop unrolls into one branch per level
+	float depth = 1.0f;
+	[unroll]
+	for (uint i = 0; i < HIZ_LEVELS_MAX; i++)
+	{
+		if (i == level)
+		{
+			depth = depthLevels[i].Load(int3(texel, 0)).r;
+		}
+	}
+	return depth;
+}
+
+uint2 DepthLevel_GetSize(uint level)
+{
+	uint2 size = 0;
+	[unroll]
+	for (uint i = 0; i < HIZ_LEVELS_MAX; i++)
+	{
+		if (i == level)
+		{
+			depthLevels[i].GetDimensions(size.x, size.y);
+		}
+	}
+	return size;
+}
+
+bool IsOutsideFrustum(float3 boxMin, float3 boxMax)
+{
+	// Outside when all the corners are past the same clip plane
+	uint outside = 0x3F;
+	[unroll]
+	for (uint i = 0; i < 8; i++)
+	{
+		float3 corner	= float3((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+		float4 clip		= mul(float4(corner, 1.0f), mViewProjection);
+		uint flags		= 0;
+		flags |= clip.x < -clip.w	? 1 << 0 : 0;
+		flags |= clip.x > clip.w	? 1 << 1 : 0;
+		flags |= clip.y < -clip.w	? 1 << 2 : 0;
+		flags |= clip.y > clip.w	? 1 << 3 : 0;
+		flags |= clip.z < 0.0f		? 1 << 4 : 0;
+		flags |= clip.z > clip.w	? 1 << 5 : 0;
+		outside &= flags;
+	}
+	return outside != 0;
+}
+
+// Same test as OcclusionCulling::IsOccluded, against the levels the GPU has (the CPU completes the pyramid further)
+bool IsOccluded(float3 boxMin, float3 boxMax)
+{
+	if (levelCount == 0 || farPlaneOccluder <= 0.0f)
+		return false;
+
+	float2 uvMin	= 1.0f;
+	float2 uvMax	= 0.0f;
+	float depthMin	= 1.0f;
+	[unroll]
+	for (uint i = 0; i < 8; i++)
+	{
+		float3 corner	= float3((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+		float4 clip		= mul(float4(corner, 1.0f), mViewProjectionOccluder);
+
+		// Boxes that reach behind the camera can't be bounded on screen
+		if (clip.w <= 0.0001f)
+			return false;
+
+		float2 uv	= float2(clip.x / clip.w * 0.5f + 0.5f, -clip.y / clip.w * 0.5f + 0.5f);
+		uvMin		= i == 0 ? uv : min(uvMin, uv);
+		uvMax		= i == 0 ? uv : max(uvMax, uv);
+		depthMin	= min(depthMin, clip.w / farPlaneOccluder); // linear depth, like the G-Buffer
+	}
+
+	// Off screen, that's for the frustum test to decide
+	if (any(uvMax < 0.0f) || any(uvMin > 1.0f))
+		return false;
+
+	// The texel range on the first level
+	uint2 size	= DepthLevel_GetSize(0);
+	uint2 t0	= min(uint2(saturate(uvMin) * size), size - 1);
+	uint2 t1	= min(uint2(saturate(uvMax) * size), size - 1);
+
+	// The finest level where that range spans at most 2x2 texels, boxes too big for the coarsest one are kept
+	uint level = 0;
+	while (level + 1 < levelCount && any((t1 >> level) - (t0 >> level) > 1)) { level++; }
+	if (any((t1 >> level) - (t0 >> level) > 1))
+		return false;
+
+	uint2 levelMax	= DepthLevel_GetSize(level) - 1;
+	uint2 a			= min(t0 >> level, levelMax);
+	uint2 b			= min(t1 >> level, levelMax);
+	float depthMax	= max(max(DepthLevel_Load(level, a), DepthLevel_Load(level, uint2(b.x, a.y))), max(DepthLevel_Load(level, uint2(a.x, b.y)), DepthLevel_Load(level, b)));
+
+	return depthMin > depthMax;
+}
+
+#if PASS_CLUSTER
+groupshared uint compactedIndex; // where the cluster's indices go, ~0 when it's culled
+
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void mainCS(uint3 groupID : SV_GroupID, uint threadIndex : SV_GroupIndex)
+{
+	uint index				= groupID.y * CLUSTER_DISPATCH_WIDTH + groupID.x;
+	Draw draw				= draws[clusterDraw];
+	uint argumentsOffset	= clusterDraw * ARGUMENT_SETS * ARGUMENTS_SIZE;
+	Cluster cluster			= clusters[clusterOffset + min(index, clusterCount - 1)];
+
+	if (threadIndex == 0)
+	{
+		compactedIndex = ~0u;
+
+		// The object has an instance at full detail when it passed culling and isn't far enough for a simpler level
+		if (index < clusterCount && arguments.Load(argumentsOffset + 4) != 0)
+		{
+			CullingObject object = objects[instances[draw.instanceOffset]];
+
+			// To the world, the matrix is relative to the origin
+			float3 center	= mul(float4(cluster.center, 1.0f), object.world).xyz + origin;
+			float3 extents	= abs(cluster.extents.x * object.world[0].xyz) + abs(cluster.extents.y * object.world[1].xyz) + abs(cluster.extents.z * object.world[2].xyz);
+			float3 apex		= mul(float4(cluster.coneApex, 1.0f), object.world).xyz + origin;
+			float3 axis		= normalize(mul(cluster.coneAxis, (float3x3)object.world));
+			bool backFacing	= (draw.flags & DRAW_CONE_CULLING) && dot(normalize(apex - cameraPosition), axis) >= cluster.coneCutoff;
+
+			if (!backFacing && !IsOutsideFrustum(center - extents, center + extents) && !IsOccluded(center - extents, center + extents))
+			{
+				arguments.InterlockedAdd(argumentsOffset + LODS_MAX * ARGUMENTS_SIZE, cluster.indexCount, compactedIndex);
+			}
+		}
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (compactedIndex == ~0u)
+		return;
+
+	// Relative to the vertex offset, like the model's
+	for (uint i = threadIndex; i < cluster.indexCount; i += THREAD_GROUP_SIZE)
+	{
+		uint location	= cluster.indexOffset + i;
+		uint value		= (draw.flags & DRAW_INDICES_16) ? (modelIndices.Load((location * 2) & ~3) >> ((location & 1) * 16)) & 0xFFFF : modelIndices.Load(location * 4);
+		compactedIndices.Store((draw.compactedOffset + compactedIndex + i) * 4, value);
+	}
+}
+#else
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void mainCS(uint3 threadID : SV_DispatchThreadID)
+{
+#if PASS_RESET
+	if (threadID.x >= argumentCount)
+		return;
+
+	Draw draw	= draws[threadID.x / ARGUMENT_SETS];
+	uint lod	= threadID.x % ARGUMENT_SETS;
+	uint offset	= threadID.x * ARGUMENTS_SIZE;
+	if (lod == LODS_MAX)
+	{
+		// The clusters append their indices, it's one instance (the object) if any are left
+		arguments.Store4(offset, uint4(0, draw.clusterCount != 0 ? 1 : 0, draw.compactedOffset, asuint(draw.vertexOffset)));
+	}
+	else
+	{
+		arguments.Store4(offset, uint4(lod < draw.lodCount ? draw.indexCount[lod] : 0, 0, draw.indexOffset[lod], asuint(draw.vertexOffset)));
+	}
+	arguments.Store(offset + 16, 0);
+#endif
+
+#if PASS_CULL
+	if (threadID.x >= objectCount)
+		return;
+
+	CullingObject object	= objects[threadID.x];
+	float3 boxMin			= object.center - object.extents;
+	float3 boxMax			= object.center + object.extents;
+	if (IsOutsideFrustum(boxMin, boxMax) || IsOccluded(boxMin, boxMax))
+		return;
+
+	// Level of detail from the size of the bounding sphere relative to the screen height, like Renderer::Renderables_GetLod
+	Draw draw			= draws[object.draw];
+	float radius		= length(object.extents);
+	float distance		= length(object.center - cameraPosition);
+	float screenSize	= distance > radius ? radius * projectionScale / distance : 1.0f;
+	uint lod			= 0;
+	while (lod + 1 < draw.lodCount && screenSize < draw.lodScreenSize[lod]) { lod++; }
+
+	// Claim an instance slot by bumping the instance count
+	uint slot = 0;
+	arguments.InterlockedAdd((object.draw * ARGUMENT_SETS + lod) * ARGUMENTS_SIZE + 4, 1, slot);
+	instances[draw.instanceOffset + lod * draw.objectCount + slot] = threadID.x;
+#endif
+}
+#endif
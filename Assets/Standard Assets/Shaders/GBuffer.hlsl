@@ -11,6 +11,15 @@ Texture2D texHeight 		: register (t4);
 Texture2D texOcclusion 		: register (t5);
 Texture2D texEmission 		: register (t6);
 Texture2D texMask 			: register (t7);
+// The same, out of arrays the material has slices in (see MaterialTextures)
+Texture2DArray arrAlbedo 	: register (t10);
+Texture2DArray arrRoughness : register (t11);
+Texture2DArray arrMetallic 	: register (t12);
+Texture2DArray arrNormal 	: register (t13);
+Texture2DArray arrHeight 	: register (t14);
+Texture2DArray arrOcclusion : register (t15);
+Texture2DArray arrEmission 	: register (t16);
+Texture2DArray arrMask 		: register (t17);
 //==========================================
 
 //= SAMPLERS =============================
@@ -30,24 +39,57 @@ cbuffer PerMaterialBuffer : register(b0)
     float materialNormalStrength;
 	float materialHeight;
 
+	float materialShadingMode;
+	uint materialTextureArrays;
+	float2 padding;
+
+	uint4 materialSlices[2]; // albedo, roughness, metallic, normal, height, occlusion, emission, mask
+};
+
+cbuffer PerFrameBuffer : register(b3)
+{
 	float3 cameraPosWS;
-	float padding;
-	
+	float padding2;
+
 	float2 planes;
 	float2 resolution;
-	
-	float materialShadingMode;
-	float3 padding2;
 };
 
 cbuffer PerObjectBuffer : register(b1)
 {
-	matrix mWorld;
     matrix mView;
     matrix mProjection;
+	matrix mViewProjectionUnjittered;
+	matrix mViewProjectionPrevious;
+}
+
+#if INDIRECT
+// The draw's visible instances were written by Culling.hlsl, they index into the objects
+cbuffer PerDrawBuffer : register(b2)
+{
+	uint instanceOffset;
+	uint3 padding3;
 }
+StructuredBuffer<CullingObject> objects	: register(t8);
+StructuredBuffer<uint> instances		: register(t9);
+#else
+cbuffer PerInstanceBuffer : register(b2)
+{
+	matrix mWorldInstances[INSTANCE_BATCH_MAX];
+}
+#endif
 //===========================================
 
+// Every pixel of a draw takes the same branch
+float4 SampleMaterial(Texture2D tex, Texture2DArray arr, uint slice, float2 uv)
+{
+	[branch]
+	if (materialTextureArrays != 0)
+		return arr.Sample(samplerAniso, float3(uv, slice));
+
+	return tex.Sample(samplerAniso, uv);
+}
+
 //= STRUCTS =================================
 struct PixelInputType
 {
@@ -58,6 +100,8 @@ struct PixelInputType
 	float3 bitangent 	: BITANGENT;
 	float4 positionVS 	: POSITIONT0;
     float4 positionWS 	: POSITIONT1;
+	float4 positionCS_current 	: POSITIONT2;
+	float4 positionCS_previous 	: POSITIONT3;
 };
 
 struct PixelOutputType
@@ -66,17 +110,26 @@ struct PixelOutputType
 	float4 normal	: SV_Target1;
 	float4 specular	: SV_Target2;
 	float2 depth	: SV_Target3;
+	float2 velocity	: SV_Target4;
 };
 //===========================================
 
-PixelInputType mainVS(Vertex_PosUvTbn input)
+PixelInputType mainVS(Vertex_PosUvTbnPacked packed, uint instanceID : SV_InstanceID)
 {
+	Vertex_PosUvTbn input = UnpackVertex(packed);
     PixelInputType output;
-    
+#if INDIRECT
+    matrix mWorld = objects[instances[instanceOffset + instanceID]].world;
+#else
+    matrix mWorld = mWorldInstances[instanceID];
+#endif
+	
     input.position.w 	= 1.0f;	
 	output.positionWS 	= mul(input.position, mWorld);
     output.positionVS   = mul(output.positionWS, mView);
     output.positionCS   = mul(output.positionVS, mProjection);
+	output.positionCS_current	= mul(output.positionWS, mViewProjectionUnjittered);
+	output.positionCS_previous	= mul(output.positionWS, mViewProjectionPrevious); // camera motion only, the previous world matrix isn't kept
 	output.normal 		= normalize(mul(input.normal, 		(float3x3)mWorld)).xyz;	
 	output.tangent 		= normalize(mul(input.tangent, 		(float3x3)mWorld)).xyz;
 	output.bitangent 	= normalize(mul(input.bitangent, 	(float3x3)mWorld)).xyz;
@@ -85,6 +138,13 @@ PixelInputType mainVS(Vertex_PosUvTbn input)
 	return output;
 }
 
+#if DEPTH_PREPASS
+// Depth only, the G-Buffer pass that follows tests against it and shades every pixel once
+void mainPS(PixelInputType input)
+{
+
+}
+#else
 PixelOutputType mainPS(PixelInputType input)
 {
 	PixelOutputType g_buffer;
@@ -110,7 +170,7 @@ PixelOutputType mainPS(PixelInputType input)
 		// Parallax Mapping
 		float height_scale 	= materialHeight * 0.01f;
 		float3 viewDir 		= normalize(cameraPosWS - input.positionWS.xyz);
-		float height 		= texHeight.Sample(samplerAniso, texCoords).r;
+		float height 		= SampleMaterial(texHeight, arrHeight, materialSlices[1].x, texCoords).r;
 		float2 offset 		= viewDir.xy * (height * height_scale);
 		if(texCoords.x <= 1.0 && texCoords.y <= 1.0 && texCoords.x >= 0.0 && texCoords.y >= 0.0)
 		{
@@ -120,7 +180,7 @@ PixelOutputType mainPS(PixelInputType input)
 	
 	//= MASK ====================================================================================
 #if MASK_MAP
-		float3 maskSample = texMask.Sample(samplerAniso, texCoords).rgb;
+		float3 maskSample = SampleMaterial(texMask, arrMask, materialSlices[1].w, texCoords).rgb;
 		float threshold = 0.6f;
 		if (maskSample.r <= threshold && maskSample.g <= threshold && maskSample.b <= threshold)
 			discard;
@@ -128,34 +188,34 @@ PixelOutputType mainPS(PixelInputType input)
 	
 	//= ALBEDO ==================================================================================
 #if ALBEDO_MAP
-		albedo *= texAlbedo.Sample(samplerAniso, texCoords);
+		albedo *= SampleMaterial(texAlbedo, arrAlbedo, materialSlices[0].x, texCoords);
 #endif
 	
 	//= ROUGHNESS ===============================================================================
 #if ROUGHNESS_MAP
-		roughness *= texRoughness.Sample(samplerAniso, texCoords).r;
+		roughness *= SampleMaterial(texRoughness, arrRoughness, materialSlices[0].y, texCoords).r;
 #endif
 	
 	//= METALLIC ================================================================================
 #if METALLIC_MAP
-		metallic *= texMetallic.Sample(samplerAniso, texCoords).r;
+		metallic *= SampleMaterial(texMetallic, arrMetallic, materialSlices[0].z, texCoords).r;
 #endif
 	
 	//= NORMAL ==================================================================================
 #if NORMAL_MAP
-		float3 normalSample = normalize(UnpackNormal(texNormal.Sample(samplerAniso, texCoords).rgb));
+		float3 normalSample = normalize(UnpackNormalMap(SampleMaterial(texNormal, arrNormal, materialSlices[0].w, texCoords).rg));
 		normal = TangentToWorld(normalSample, input.normal.xyz, input.tangent.xyz, input.bitangent.xyz, materialNormalStrength);
 #endif
 	//============================================================================================
 	
 	//= OCCLUSION ================================================================================
 #if OCCLUSION_MAP
-		occlusion = texOcclusion.Sample(samplerAniso, texCoords).r;
+		occlusion = SampleMaterial(texOcclusion, arrOcclusion, materialSlices[1].y, texCoords).r;
 #endif
 	
 	//= EMISSION ================================================================================
 #if EMISSION_MAP
-		emission = texEmission.Sample(samplerAniso, texCoords).r;
+		emission = SampleMaterial(texEmission, arrEmission, materialSlices[1].z, texCoords).r;
 #endif
 		
 	//= CUBEMAP ==================================================================================
@@ -169,6 +229,8 @@ PixelOutputType mainPS(PixelInputType input)
 	g_buffer.normal 	= float4(PackNormal(normal), occlusion);
 	g_buffer.specular	= float4(roughness, metallic, emission, type);
     g_buffer.depth      = float2(depth_linear, depth_cs);
+	g_buffer.velocity	= (input.positionCS_current.xy / input.positionCS_current.w - input.positionCS_previous.xy / input.positionCS_previous.w) * float2(0.5f, -0.5f);
 
     return g_buffer;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+Texture2D depthTexture 		: register(t0);
+SamplerState samplerPoint 	: register(s0);
+
+cbuffer GridBuffer : register(b0)
+{
+	matrix mTransform;
+	matrix mViewProjection;			// camera relative
+	matrix mViewProjectionInverse;	// camera relative
+	float3 cameraPosition;
+	float reverseZ;
+	float2 cameraWrapped;			// the camera's xz wrapped to the major spacing
+	float spacing;
+	float majorSpacing;
+	float fadeDistance;
+	float3 padding;
+};
+
+static const float4 colorMinor	= float4(1.0f, 1.0f, 1.0f, 0.2f);
+static const float4 colorMajor	= float4(1.0f, 1.0f, 1.0f, 0.4f);
+static const float4 colorAxisX	= float4(1.0f, 0.2f, 0.2f, 0.8f);
+static const float4 colorAxisZ	= float4(0.2f, 0.4f, 1.0f, 0.8f);
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 uv 		: TEXCOORD;
+};
+
+// Coverage of the lines closest to a point, a pixel wide whatever the distance
+float Grid_Lines(float2 coordinate, float lineSpacing, out float2 derivative)
+{
+	float2 cell		= coordinate / lineSpacing;
+	derivative		= fwidth(cell);
+	float2 lines	= abs(frac(cell - 0.5f) - 0.5f) / derivative;
+	return 1.0f - min(min(lines.x, lines.y), 1.0f);
+}
+
+// Vertex Shader
+PixelInputType mainVS(Vertex_PosUv input)
+{
+    PixelInputType output;
+	
+    input.position.w 	= 1.0f;
+    output.position 	= mul(input.position, mTransform);
+    output.uv 			= input.uv;
+	
+    return output;
+}
+
+// Pixel Shader
+float4 mainPS(PixelInputType input) : SV_TARGET
+{
+	// Ray through the pixel, the camera is at the origin
+	float2 ndc 			= float2(input.uv.x * 2.0f - 1.0f, 1.0f - input.uv.y * 2.0f);
+	float4 rayPoint 	= mul(float4(ndc, 0.5f, 1.0f), mViewProjectionInverse);
+	float3 rayDirection = rayPoint.xyz / rayPoint.w;
+	
+	// Intersect with the y = 0 plane, pixels looking away from it have no grid.
+	// Nothing is discarded until the end, the derivatives need every pixel of a quad.
+	float rayLength	= -cameraPosition.y / rayDirection.y;
+	float3 position	= rayDirection * rayLength;
+	
+	// Minor lines fade out before they get denser than a pixel, instead of turning into noise
+	float2 coordinate = position.xz + cameraWrapped;
+	float2 derivativeMinor;
+	float2 derivativeMajor;
+	float minor = Grid_Lines(coordinate, spacing, derivativeMinor);
+	float major = Grid_Lines(coordinate, majorSpacing, derivativeMajor);
+	minor 		*= saturate(1.0f - max(derivativeMinor.x, derivativeMinor.y) * 2.0f);
+	float4 color = float4(colorMinor.rgb, colorMinor.a * minor);
+	color 		= lerp(color, colorMajor, major);
+	
+	// The axes, from the absolute position so they stay put
+	float2 world 	= position.xz + cameraPosition.xz;
+	float2 axis 	= saturate(1.0f - abs(world) / (derivativeMinor * spacing));
+	color 			= lerp(color, colorAxisX, axis.y);
+	color 			= lerp(color, colorAxisZ, axis.x);
+	
+	// Fade with distance, so the grid ends softly rather than at the horizon
+	color.a *= 1.0f - saturate(length(position.xz) / fadeDistance);
+	
+	// If an object is in front of the grid, discard this grid pixel
+	float4 positionClip = mul(float4(position, 1.0f), mViewProjection);
+	float gridDepth		= positionClip.z / positionClip.w;
+	float depthMapValue = depthTexture.Sample(samplerPoint, input.uv).g;
+	if (rayLength <= 0.0f || color.a <= 0.0f || DepthIsCloser(depthMapValue, gridDepth, reverseZ))
+		discard;
+	
+	return color;
+}
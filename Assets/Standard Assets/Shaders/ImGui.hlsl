@@ -0,0 +1,37 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+Texture2D texture0 		: register(t0);
+SamplerState sampler0 	: register(s0);
+
+cbuffer MiscBuffer : register(b0)
+{
+	matrix mTransform;
+	float4 padding;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 uv 		: TEXCOORD;
+    float4 color 	: COLOR;
+};
+
+// Vertex Shader
+PixelInputType mainVS(Vertex_Pos2dUvColor input)
+{
+    PixelInputType output;
+	
+    output.position = mul(float4(input.position, 0.0f, 1.0f), mTransform);
+    output.uv 		= input.uv;
+    output.color 	= input.color;
+	
+    return output;
+}
+
+// Pixel Shader
+float4 mainPS(PixelInputType input) : SV_TARGET
+{
+	return input.color * texture0.Sample(sampler0, input.uv);
+}
@@ -0,0 +1,130 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+// Impostors, camera facing quads drawn into the G-Buffer out of views of a renderable baked into an atlas (see Impostors).
+// An instance's world matrix takes the unit sphere to the renderable's bounding sphere, it's unused m03 holds the slot.
+// The views are cells of a hemi-octahedral grid, out of whichever one is closest to the camera's direction the pixel
+// shader reconstructs the surface, it's depth and it's normal, so the quads light and cast like the geometry would.
+
+#define GRID		8	// must match IMPOSTOR_GRID
+#define CELL_SIZE	64	// must match IMPOSTOR_CELL_SIZE
+#define ATLAS_TILES	4	// must match IMPOSTOR_ATLAS_TILES
+
+//= TEXTURES ===========================
+Texture2D texAlbedo		: register(t0);
+Texture2D texNormal		: register(t1);
+Texture2D texSpecular	: register(t2);
+Texture2D texDepth		: register(t3); // linear, over the diameter of the bounding sphere
+//======================================
+
+//= BUFFERS ======================================
+cbuffer ImpostorBuffer : register(b0)
+{
+	matrix mView;
+	matrix mProjection;
+	matrix mViewProjectionUnjittered;
+	matrix mViewProjectionPrevious;
+	float3 cameraPosition;
+	float farPlane;
+};
+
+cbuffer PerInstanceBuffer : register(b2)
+{
+	matrix mWorldInstances[INSTANCE_BATCH_MAX];
+}
+//================================================
+
+struct PixelInputType
+{
+	float4 positionCS						: SV_POSITION;
+	float2 uv								: TEXCOORD;	// in the cell
+	float3 positionWS						: POSITIONT0;	// on the plane through the centre
+	nointerpolation float3 directionWS		: DIRECTION;	// towards the view, as long as the radius
+	nointerpolation float3 axisX			: AXIS0;
+	nointerpolation float3 axisY			: AXIS1;
+	nointerpolation float3 axisZ			: AXIS2;
+	nointerpolation uint2 texel				: TEXEL;		// the cell's first, in the atlas
+};
+
+struct PixelOutputType
+{
+	float4 albedo	: SV_Target0;
+	float4 normal	: SV_Target1;
+	float4 specular	: SV_Target2;
+	float2 depth	: SV_Target3;
+	float2 velocity	: SV_Target4;
+	float z			: SV_Depth;
+};
+
+// Where a cell's centre is in the grid, as a direction on the upper hemisphere (must match Impostors::GetViewDirection)
+float3 CellDirection(uint2 cell)
+{
+	float2 octahedron	= (float2(cell) + 0.5f) / GRID * 2.0f - 1.0f;
+	float2 xz			= float2(octahedron.x + octahedron.y, octahedron.x - octahedron.y) * 0.5f;
+	return normalize(float3(xz.x, 1.0f - abs(xz.x) - abs(xz.y), xz.y));
+}
+
+PixelInputType mainVS(Vertex_PosUv input, uint instanceID : SV_InstanceID)
+{
+	matrix mWorld	= mWorldInstances[instanceID];
+	uint slot		= (uint)mWorld[0].w;
+	mWorld[0].w		= 0.0f;
+
+	// The camera's direction in the renderable's space, views from below the horizon are the closest ones above it
+	float3 toCamera	= normalize(mul((float3x3)mWorld, cameraPosition - mWorld[3].xyz));
+	toCamera.y		= max(toCamera.y, 0.0f);
+	float2 xz		= toCamera.xz / max(abs(toCamera.x) + abs(toCamera.y) + abs(toCamera.z), 0.0001f);
+	uint2 cell		= min(uint2((float2(xz.x + xz.y, xz.x - xz.y) * 0.5f + 0.5f) * GRID), GRID - 1);
+
+	// The cell's view looked at the centre like Matrix::CreateLookAtLH does, with an orthographic projection that fits the sphere
+	float3 direction	= CellDirection(cell);
+	float3 up			= abs(direction.y) > 0.999f ? float3(0.0f, 0.0f, 1.0f) : float3(0.0f, 1.0f, 0.0f);
+	float3 forward		= -direction;
+	float3 right		= normalize(cross(up, forward));
+	up					= cross(forward, right);
+	float3 position		= (right * input.position.x + up * input.position.y) * 2.0f;
+
+	PixelInputType output;
+	float4 positionWS	= mul(float4(position, 1.0f), mWorld);
+	output.positionCS	= mul(mul(positionWS, mView), mProjection);
+	output.uv			= input.uv;
+	output.positionWS	= positionWS.xyz;
+	output.directionWS	= mul(direction, (float3x3)mWorld);
+	output.axisX		= mWorld[0].xyz;
+	output.axisY		= mWorld[1].xyz;
+	output.axisZ		= mWorld[2].xyz;
+	output.texel		= (uint2(slot % ATLAS_TILES, slot / ATLAS_TILES) * GRID + cell) * CELL_SIZE;
+	return output;
+}
+
+PixelOutputType mainPS(PixelInputType input)
+{
+	int3 texel		= int3(input.texel + min(uint2(saturate(input.uv) * CELL_SIZE), CELL_SIZE - 1), 0);
+	float4 albedo	= texAlbedo.Load(texel);
+
+	// The views were cleared to transparent black, only what the renderable covered is opaque
+	clip(albedo.a - 0.5f);
+
+	float4 normal	= texNormal.Load(texel);
+	float4 specular	= texSpecular.Load(texel);
+	float distance	= texDepth.Load(texel).r * 2.0f; // from the view, on the sphere it's 0 to 2 radii away
+
+	// The view was as far in front of the centre as the radius, the surface is as far behind it as it saw
+	float3 positionWS		= input.positionWS + input.directionWS * (1.0f - distance);
+	float4 positionVS		= mul(float4(positionWS, 1.0f), mView);
+	float4 positionCS		= mul(positionVS, mProjection);
+	float4 current			= mul(float4(positionWS, 1.0f), mViewProjectionUnjittered);
+	float4 previous			= mul(float4(positionWS, 1.0f), mViewProjectionPrevious);
+	float3 normalWS			= normalize(UnpackNormal(normal.xyz));
+	normalWS				= normalize(normalWS.x * input.axisX + normalWS.y * input.axisY + normalWS.z * input.axisZ);
+
+	PixelOutputType g_buffer;
+	g_buffer.albedo		= float4(albedo.rgb, 1.0f);
+	g_buffer.normal		= float4(PackNormal(normalWS), normal.a);
+	g_buffer.specular	= specular;
+	g_buffer.depth		= float2(positionVS.z / farPlane, positionCS.z / positionCS.w);
+	g_buffer.velocity	= (current.xy / current.w - previous.xy / previous.w) * float2(0.5f, -0.5f);
+	g_buffer.z			= positionCS.z / positionCS.w;
+	return g_buffer;
+}
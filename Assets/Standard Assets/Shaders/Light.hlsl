@@ -4,16 +4,61 @@ Texture2D texNormal 		: register(t1);
 Texture2D texDepth 			: register(t2);
 Texture2D texSpecular 		: register(t3);
 Texture2D texShadowing 		: register(t4);
-Texture2D texLastFrame 		: register(t5);
+Texture2D texReflections 	: register(t5); // screen space, premultiplied by how much was found
 TextureCube environmentTex 	: register(t6);
+TextureCube environmentPrefilteredTex	: register(t7); // mip = roughness * (environmentMipCount - 1)
 //=========================================
 
+//= CLUSTERS =====================================================
+// Must match LightClusters.h
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 	24
+
+struct ClusterLight
+{
+	float4 positionRange;
+	float4 colorIntensity;
+	float4 directionAngle;
+	float4 type;
+	float4 shadow; // x: first shadow atlas tile or -1, y: depth bias
+};
+
+StructuredBuffer<ClusterLight> clusterLights 	: register(t8);
+StructuredBuffer<uint2> clusterGrid 			: register(t9); // offset, count
+StructuredBuffer<uint> clusterLightIndices 		: register(t10);
+//================================================================
+
+//= SHADOW ATLAS =================================================
+// Must match ShadowAtlas.cpp
+struct ShadowTile
+{
+	matrix viewProjection;
+	float4 rect; // xy: top left texel, z: size in texels, w: 1 for reverse-z
+};
+
+StructuredBuffer<ShadowTile> shadowTiles 		: register(t11);
+Texture2D<float> shadowAtlas 					: register(t12);
+
+// 9 coefficients per probe, x varies the fastest, then y, then z
+StructuredBuffer<uint2> lightProbes 			: register(t13); // rg, b as halfs
+
+// Largest box first, see ReflectionProbes.cpp
+struct ReflectionProbe
+{
+	float4 position; 	// xyz where it was captured, w slice
+	float4 boxMin; 		// w mips
+	float4 boxMax;
+};
+StructuredBuffer<ReflectionProbe> reflectionProbes 	: register(t14);
+TextureCubeArray reflectionProbesTex 				: register(t15); // prefiltered like environmentPrefilteredTex
+//================================================================
+
 //= SAMPLERS ==============================
 SamplerState samplerLinear 	: register(s0);
 //=========================================
 
 //= CONSTANT BUFFERS ==========================
-#define MaxLights 64
 cbuffer MiscBuffer : register(b0)
 {
 	matrix mWorldViewProjection;
@@ -23,23 +68,23 @@ cbuffer MiscBuffer : register(b0)
     float4 dirLightColor;
     float4 dirLightIntensity;
 	float4 dirLightDirection;
-
-    float4 pointLightPosition[MaxLights];
-    float4 pointLightColor[MaxLights];
-    float4 pointLightIntenRange[MaxLights];
-	
-	float4 spotLightColor[MaxLights];
-	float4 spotLightPosition[MaxLights];
-    float4 spotLightDirection[MaxLights];
-    float4 spotLightIntenRangeAngle[MaxLights];
 	
-    float pointlightCount;
-	float spotlightCount;
+    float clusterSliceScale;
+	float clusterLightCount;
     float nearPlane;
     float farPlane;
 	
     float2 resolution;
-    float2 padding;
+    float resolutionScale;
+    float environmentMipCount;
+	
+	float checkerboardParity;
+	float3 padding;
+	
+	float4 environmentSH[9]; // diffuse irradiance, pre-convolved
+	
+	float4 probeOrigin; // xyz first probe, w spacing
+	float4 probeCount; // xyz probes per axis, w is 1 when baked
 };
 //=============================================
 
@@ -48,6 +93,119 @@ cbuffer MiscBuffer : register(b0)
 #include "BRDF.hlsl"
 //====================
 
+// Diffuse irradiance blended out of the 8 probes around the position, w is 0 outside of the volume
+float4 Irradiance_Probes(float3 worldPos, float3 normal)
+{
+	[branch]
+	if (probeCount.w == 0.0f)
+		return 0.0f;
+	
+	// Pushed off the surface so that probes right behind it don't darken it
+	float3 cell = (worldPos + normal * probeOrigin.w * 0.25f - probeOrigin.xyz) / probeOrigin.w;
+	if (any(cell < 0.0f) || any(cell > probeCount.xyz - 1.0f))
+		return 0.0f;
+	
+	uint3 count 	= uint3(probeCount.xyz);
+	uint3 base 		= min(uint3(cell), count - 2);
+	float3 weight 	= cell - base;
+
+	float3 sh[9];
+	[unroll]
+	for (uint c = 0; c < 9; c++)
+	{
+		sh[c] = 0.0f;
+	}
+	
+	for (uint i = 0; i < 8; i++)
+	{
+		uint3 offset 	= uint3(i & 1, (i >> 1) & 1, i >> 2);
+		float3 w 		= lerp(1.0f - weight, weight, float3(offset));
+		uint3 probe 	= base + offset;
+		uint index 		= (probe.x + (probe.y + probe.z * count.y) * count.x) * 9;
+		
+		[unroll]
+		for (uint c = 0; c < 9; c++)
+		{
+			uint2 packed = lightProbes[index + c];
+			sh[c] += float3(f16tof32(packed.x), f16tof32(packed.x >> 16), f16tof32(packed.y)) * (w.x * w.y * w.z);
+		}
+	}
+	
+	return float4(SH_Evaluate(sh, normal), 1.0f);
+}
+
+// Specular of the reflection probes whose box the position is in, w is how much of the environment's they replace
+float4 Reflection_Probes(float3 worldPos, float3 reflectionVector, float roughness)
+{
+	uint count, stride;
+	reflectionProbes.GetDimensions(count, stride);
+	
+	float4 result = 0.0f;
+	for (uint i = 0; i < count; i++)
+	{
+		ReflectionProbe probe = reflectionProbes[i];
+		if (any(worldPos < probe.boxMin.xyz) || any(worldPos > probe.boxMax.xyz))
+			continue;
+		
+		// Where the reflection leaves the box, seen from where the probe was captured, so it lines up with the walls
+		float3 toMax 		= (probe.boxMax.xyz - worldPos) / reflectionVector;
+		float3 toMin 		= (probe.boxMin.xyz - worldPos) / reflectionVector;
+		float3 far 			= max(toMax, toMin);
+		float distance 		= min(min(far.x, far.y), far.z);
+		float3 direction 	= worldPos + reflectionVector * distance - probe.position.xyz;
+		
+		// Fades out over the box's outer tenth, smaller (later) probes blend over larger ones
+		float3 size 	= probe.boxMax.xyz - probe.boxMin.xyz;
+		float3 edge 	= min(worldPos - probe.boxMin.xyz, probe.boxMax.xyz - worldPos) / max(size * 0.1f, 0.0001f);
+		float weight 	= saturate(min(min(edge.x, edge.y), edge.z));
+		
+		float3 color 	= ToLinear(reflectionProbesTex.SampleLevel(samplerLinear, float4(direction, probe.position.w), roughness * (probe.boxMin.w - 1.0f))).rgb;
+		result.rgb 		= lerp(result.rgb, color, weight);
+		result.a 		= lerp(result.a, 1.0f, weight);
+	}
+	
+	return result;
+}
+
+float ShadowAtlas_Sample(float4 shadow, float3 worldPos, float3 normal, float3 lightPos, bool isPoint)
+{
+	if (shadow.x < 0.0f)
+		return 1.0f;
+	
+	// A point light has a tile per cube face, picked by the major axis of the direction away from the light
+	float3 direction	= worldPos - lightPos;
+	uint index			= (uint)shadow.x;
+	if (isPoint)
+	{
+		float3 axis = abs(direction);
+		index += axis.x >= axis.y && axis.x >= axis.z ? (direction.x >= 0.0f ? 0 : 1) : (axis.y >= axis.z ? (direction.y >= 0.0f ? 2 : 3) : (direction.z >= 0.0f ? 4 : 5));
+	}
+	ShadowTile tile = shadowTiles[index];
+	
+	// Offset along the normal by about a texel, which grows with the distance from the light
+	float texelSize		= 2.0f * length(direction) / tile.rect.z;
+	float4 positionLS	= mul(float4(worldPos + normal * texelSize, 1.0f), tile.viewProjection);
+	if (positionLS.w <= 0.0f)
+		return 1.0f;
+	float3 ndc			= positionLS.xyz / positionLS.w;
+	float depth			= ndc.z + (tile.rect.w != 0.0f ? shadow.y : -shadow.y);
+	float2 texel		= (ndc.xy * float2(0.5f, -0.5f) + 0.5f) * tile.rect.z - 0.5f;
+	float2 base			= floor(texel);
+	float2 weight		= texel - base;
+	
+	// Bilinear 2x2 PCF, clamped to the tile so that it's neighbours don't bleed in
+	float2 texelMin = tile.rect.xy;
+	float2 texelMax = tile.rect.xy + tile.rect.z - 1.0f;
+	float4 lit;
+	[unroll]
+	for (uint i = 0; i < 4; i++)
+	{
+		int2 coord	= (int2)clamp(tile.rect.xy + base + float2(i & 1, i >> 1), texelMin, texelMax);
+		lit[i]		= DepthIsCloser(shadowAtlas.Load(int3(coord, 0)), depth, tile.rect.w) ? 0.0f : 1.0f;
+	}
+	return lerp(lerp(lit.x, lit.y, weight.x), lerp(lit.z, lit.w, weight.x), weight.y);
+}
+
 struct PixelInputType
 {
     float4 position : SV_POSITION;
@@ -67,7 +225,14 @@ PixelInputType mainVS(Vertex_PosUv input)
 
 float4 mainPS(PixelInputType input) : SV_TARGET
 {
+#if CHECKERBOARD
+	// The target is half as wide, each of its pixels lights one of a horizontal pair, alternating per row and per frame
+	float2 pixel		= floor(input.position.xy);
+	pixel.x				= pixel.x * 2.0f + fmod(pixel.y + checkerboardParity, 2.0f);
+	float2 texCoord 	= (pixel + 0.5f) / resolution;
+#else
 	float2 texCoord 	= input.uv;
+#endif
     float3 finalColor 	= float3(0, 0, 0);
 	
 	// Sample from G-Buffer
@@ -85,7 +250,8 @@ float4 mainPS(PixelInputType input) : SV_TARGET
 	material.emission	= specular.b * 2.0f;
 		
 	// Extract useful values out of those samples
-	float depth_cs 	    = texDepth.Sample(samplerLinear, texCoord).g;
+	float2 depth		= texDepth.Sample(samplerLinear, texCoord).rg;
+	float depth_cs 	    = depth.g;
     float3 worldPos     = ReconstructPositionWorld(depth_cs, mViewProjectionInverse, texCoord);
     float3 viewDir 		= normalize(cameraPosWS.xyz - worldPos.xyz);
 	 
@@ -118,61 +284,66 @@ float4 mainPS(PixelInputType input) : SV_TARGET
 	directionalLight.direction	= normalize(-dirLightDirection).xyz;
 	directionalLight.intensity 	*= shadow;
 	
-	finalColor += ImageBasedLighting(material, directionalLight.direction, normal, viewDir, samplerLinear) * ambientLight;
+	float4 reflection = texReflections.Sample(samplerLinear, texCoord);
+	float4 probeIrradiance = Irradiance_Probes(worldPos, normal);
+	float4 probeSpecular = Reflection_Probes(worldPos, reflect(-viewDir, normal), material.roughness);
+	finalColor += ImageBasedLighting(material, directionalLight.direction, normal, viewDir, reflection, probeIrradiance, probeSpecular, samplerLinear) * ambientLight;
 	
 	// Compute illumination
 	finalColor += BRDF(material, directionalLight, normal, viewDir);
 	//====================================================================================================================
 	
-	//= POINT LIGHTS ==============================================================================
-	Light pointLight;
-    for (int i = 0; i < pointlightCount; i++)
+	//= POINT & SPOT LIGHTS ======================================================================================================
+	// Find the cluster this pixel belongs to, it lists the lights that can reach it, texCoord only spans the rendered sub-rect
+	float depthVS		= depth.r * farPlane;
+	uint2 tile			= min(uint2(texCoord / resolutionScale * float2(CLUSTER_TILES_X, CLUSTER_TILES_Y)), uint2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+	uint slice			= min(uint(max(log(depthVS / nearPlane), 0.0f) * clusterSliceScale), CLUSTER_SLICES - 1);
+	uint2 cluster		= clusterGrid[tile.x + tile.y * CLUSTER_TILES_X + slice * CLUSTER_TILES_X * CLUSTER_TILES_Y];
+	
+	Light light;
+    for (uint i = 0; i < cluster.y; i++)
     {
 		// Get light data
-        pointLight.color 		= pointLightColor[i].rgb;
-        float3 position 		= pointLightPosition[i].xyz;
-		pointLight.intensity 	= pointLightIntenRange[i].x;
-        float range 			= pointLightIntenRange[i].y;
-        
-		// Compute light
-        pointLight.direction 	= normalize(position - worldPos);
-        float dist 				= length(worldPos - position);
-        float attunation 		= clamp(1.0f - dist / range, 0.0f, 1.0f); attunation *= attunation;
-		pointLight.intensity 	*= attunation;
-
-		// Compute illumination
-        if (dist < range)
+		ClusterLight clusterLight = clusterLights[clusterLightIndices[cluster.x + i]];
+        light.color 		= clusterLight.colorIntensity.rgb;
+		light.intensity 	= clusterLight.colorIntensity.a;
+        float3 position 	= clusterLight.positionRange.xyz;
+        float range 		= clusterLight.positionRange.w;
+		float dist 			= length(worldPos - position);
+		
+		if (clusterLight.type.x == 0.0f) // Point
 		{
-            finalColor += BRDF(material, pointLight, normal, viewDir);
+			// Compute light
+			light.direction 	= normalize(position - worldPos);
+			float attunation 	= clamp(1.0f - dist / range, 0.0f, 1.0f); attunation *= attunation;
+			light.intensity 	*= attunation;
+
+			// Compute illumination
+			if (dist < range)
+			{
+				light.intensity *= ShadowAtlas_Sample(clusterLight.shadow, worldPos, normal, position, true);
+				finalColor += BRDF(material, light, normal, viewDir);
+			}
 		}
-    }
-	//=============================================================================================
-	
-	//= SPOT LIGHTS ==============================================================================================================
-	Light spotLight;
-    for (int j = 0; j < spotlightCount; j++)
-    {
-		// Get light data
-        spotLight.color 	= spotLightColor[j].rgb;
-        float3 position 	= spotLightPosition[j].xyz;
-		spotLight.intensity = spotLightIntenRangeAngle[j].x;
-		spotLight.direction = normalize(-spotLightDirection[j].xyz);
-		float range 		= spotLightIntenRangeAngle[j].y;
-        float cutoffAngle 	= 1.0f - spotLightIntenRangeAngle[j].z;
-        
-		// Compute light
-		float3 direction 	= normalize(position - worldPos);
-		float dist 			= length(worldPos - position);	
-		float theta 		= dot(direction, spotLight.direction);
-		float epsilon   	= cutoffAngle - cutoffAngle * 0.9f;
-		float attunation 	= clamp((theta - cutoffAngle) / epsilon, 0.0f, 1.0f);  // attunate when approaching the outer cone
-		attunation 			*= clamp(1.0f - dist / range, 0.0f, 1.0f); attunation *= attunation; // attunate with distance as well
-		spotLight.intensity *= attunation;
-
-		// Compute illumination
-		if(theta > cutoffAngle)
+		else // Spot
 		{
-            finalColor += BRDF(material, spotLight, normal, viewDir);
+			light.direction 	= normalize(-clusterLight.directionAngle.xyz);
+			float cutoffAngle 	= 1.0f - clusterLight.directionAngle.w;
+			
+			// Compute light
+			float3 direction 	= normalize(position - worldPos);
+			float theta 		= dot(direction, light.direction);
+			float epsilon   	= cutoffAngle - cutoffAngle * 0.9f;
+			float attunation 	= clamp((theta - cutoffAngle) / epsilon, 0.0f, 1.0f);  // attunate when approaching the outer cone
+			attunation 			*= clamp(1.0f - dist / range, 0.0f, 1.0f); attunation *= attunation; // attunate with distance as well
+			light.intensity 	*= attunation;
+
+			// Compute illumination
+			if(theta > cutoffAngle)
+			{
+				light.intensity *= ShadowAtlas_Sample(clusterLight.shadow, worldPos, normal, position, false);
+				finalColor += BRDF(material, light, normal, viewDir);
+			}
 		}
     }
 	//============================================================================================================================
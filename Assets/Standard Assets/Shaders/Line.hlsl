@@ -8,8 +8,19 @@ SamplerState samplerPoint 	: register(s0);
 cbuffer MiscBuffer : register(b0)
 {
 	matrix mTransform;
+	float reverseZ;
+	float3 padding;
 };
 
+#if INSTANCED
+#define INSTANCE_BATCH_MAX 256 // must match DEBUG_INSTANCE_BATCH_MAX
+cbuffer InstanceBuffer : register(b1)
+{
+	matrix mInstanceTransforms[INSTANCE_BATCH_MAX];
+	float4 mInstanceColors[INSTANCE_BATCH_MAX];
+};
+#endif
+
 struct PixelInputType
 {
     float4 position : SV_POSITION;
@@ -18,11 +29,21 @@ struct PixelInputType
 };
 
 // Vertex Shader
+#if INSTANCED
+PixelInputType mainVS(Vertex_PosColor input, uint instanceID : SV_InstanceID)
+#else
 PixelInputType mainVS(Vertex_PosColor input)
+#endif
 {
     PixelInputType output;
     	
     input.position.w 	= 1.0f;
+#if INSTANCED
+	// The w divide is for frustums, their transform is an inverse projection
+	input.position 		= mul(input.position, mInstanceTransforms[instanceID]);
+	input.position 		/= input.position.w;
+	input.color 		*= mInstanceColors[instanceID];
+#endif
     output.position 	= mul(input.position, mTransform);
     output.linePos      = output.position;
 	output.color 		= input.color;
@@ -37,11 +58,11 @@ float4 mainPS(PixelInputType input) : SV_TARGET
     projectDepthMapTexCoord.x = input.linePos.x / input.linePos.w / 2.0f + 0.5f;
     projectDepthMapTexCoord.y = -input.linePos.y / input.linePos.w / 2.0f + 0.5f;
 	
-    float lineDepth     = input.position.z / input.position.w;
+    float lineDepth     = input.linePos.z / input.linePos.w;
     float depthMapValue = depthTexture.Sample(samplerPoint, projectDepthMapTexCoord).g;
 	
 	// If an object is in front of the grid, discard this grid pixel
-    if (depthMapValue > lineDepth) 
+    if (DepthIsCloser(depthMapValue, lineDepth, reverseZ)) 
         discard;
 	
     return input.color;
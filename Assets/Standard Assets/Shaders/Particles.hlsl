@@ -0,0 +1,309 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+// GPU particles, every emitter owns a range of one pool and emits into it like into a ring.
+// PASS_RESET:		one thread, writes the arguments of the draw with no instances
+// PASS_SIMULATE:	one thread per particle of an emitter's range, emits, moves, collides and lists the ones alive
+// Otherwise:		draws the alive particles as camera facing quads, into the weighted blended transparency targets
+
+#define THREAD_GROUP_SIZE		256		// must match GPU_PARTICLES_THREAD_GROUP_SIZE
+#define COLLISION_THICKNESS		0.5f	// how far behind the depth buffer a surface is assumed to reach
+#define SOFT_DISTANCE			0.25f	// particles fade out this close to opaque surfaces
+
+// Must match GPUParticles.h
+struct Particle
+{
+	float3 position;
+	float age;
+	float3 velocity;
+	float lifetime;
+	uint emitter;
+	float scale;
+	float2 padding;
+};
+
+struct Emitter
+{
+	float4 colorStart;
+	float4 colorEnd;
+	float sizeStart;
+	float sizeEnd;
+	float2 padding;
+};
+
+#if PASS_RESET || PASS_SIMULATE
+//= BUFFERS ===================================================
+Texture2D depthTexture					: register(t0);
+Texture2D normalTexture					: register(t1);	// the G-Buffer's, only the rendered sub-rect is valid
+RWStructuredBuffer<Particle> particles	: register(u0);
+RWStructuredBuffer<uint> alive			: register(u1);
+RWByteAddressBuffer arguments			: register(u2);
+
+cbuffer SimulationBuffer : register(b0)
+{
+	matrix mWorld;
+	matrix mViewProjection;	// what the depth buffer was rendered with
+	float3 gravity;
+	float deltaTime;
+	float speed;
+	float spread;			// cosine of half the cone's angle
+	float lifetime;
+	float bounce;
+	uint rangeOffset;
+	uint rangeSize;
+	uint emitStart;
+	uint emitCount;
+	uint emitter;
+	uint seed;
+	uint reset;
+	uint collisions;
+	float farPlane;
+	float resolutionScale;
+	float2 padding;
+};
+//=============================================================
+
+// PCG, good enough randomness from a counter
+uint Hash(uint value)
+{
+	uint state	= value * 747796405u + 2891336453u;
+	uint word	= ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+float Random(inout uint state)
+{
+	state = Hash(state);
+	return float(state) / 4294967295.0f;
+}
+
+Particle Emit(uint index)
+{
+	uint state = Hash(index ^ seed);
+
+	// A direction in the cone around the emitter's up axis
+	float cosTheta	= lerp(1.0f, spread, Random(state));
+	float sinTheta	= sqrt(saturate(1.0f - cosTheta * cosTheta));
+	float phi		= Random(state) * 6.28318530718f;
+	float3 local	= float3(sinTheta * cos(phi), cosTheta, sinTheta * sin(phi));
+
+	Particle particle;
+	particle.position	= mul(float4(0.0f, 0.0f, 0.0f, 1.0f), mWorld).xyz;
+	particle.velocity	= normalize(mul(local, (float3x3)mWorld)) * speed * lerp(0.75f, 1.25f, Random(state));
+	particle.age		= 0.0f;
+	particle.lifetime	= lifetime * lerp(0.75f, 1.25f, Random(state));
+	particle.emitter	= emitter;
+	particle.scale		= lerp(0.75f, 1.25f, Random(state));
+	particle.padding	= 0.0f;
+	return particle;
+}
+
+// Bounces the particle off what the depth buffer saw, particles off screen don't collide
+bool Collide(inout Particle particle, float3 position)
+{
+	float4 clip = mul(float4(position, 1.0f), mViewProjection);
+	if (clip.w <= 0.0f)
+		return false;
+
+	float2 uv = float2(clip.x / clip.w * 0.5f + 0.5f, -clip.y / clip.w * 0.5f + 0.5f);
+	if (any(uv < 0.0f) || any(uv > 1.0f))
+		return false;
+
+	float2 size;
+	depthTexture.GetDimensions(size.x, size.y);
+	float depth = depthTexture.Load(int3(min(uv * size, size - 1.0f), 0)).r * farPlane;
+	if (clip.w < depth || clip.w > depth + COLLISION_THICKNESS)
+		return false;
+
+	normalTexture.GetDimensions(size.x, size.y);
+	float3 normal = normalize(UnpackNormal(normalTexture.Load(int3(min(uv * resolutionScale * size, size - 1.0f), 0)).xyz));
+	if (dot(particle.velocity, normal) >= 0.0f)
+		return false;
+
+	// Reflect and stay where it was, in front of the surface
+	particle.velocity = reflect(particle.velocity, normal) * bounce;
+	return true;
+}
+
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void mainCS(uint3 threadID : SV_DispatchThreadID)
+{
+#if PASS_RESET
+	if (threadID.x != 0)
+		return;
+
+	arguments.Store4(0, uint4(6, 0, 0, 0));
+	arguments.Store(16, 0);
+#endif
+
+#if PASS_SIMULATE
+	if (threadID.x >= rangeSize)
+		return;
+
+	uint index			= rangeOffset + threadID.x;
+	Particle particle	= particles[index];
+
+	if (reset != 0)
+	{
+		particle.age		= 0.0f;
+		particle.lifetime	= 0.0f;
+	}
+
+	// The slots the ring's cursor passes this frame get new particles, whatever was in them
+	if ((threadID.x + rangeSize - emitStart) % rangeSize < emitCount)
+	{
+		particle = Emit(index);
+	}
+
+	if (particle.age < particle.lifetime)
+	{
+		particle.velocity	+= gravity * deltaTime;
+		float3 position		= particle.position + particle.velocity * deltaTime;
+		// A bounce keeps the particle where it was
+		if (collisions == 0 || !Collide(particle, position))
+		{
+			particle.position = position;
+		}
+		particle.age		+= deltaTime;
+
+		if (particle.age < particle.lifetime)
+		{
+			uint slot = 0;
+			arguments.InterlockedAdd(4, 1, slot);
+			alive[slot] = index;
+		}
+	}
+
+	particles[index] = particle;
+#endif
+}
+#else
+//= CLUSTERS =====================================================
+// Must match LightClusters.h
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 	24
+
+struct ClusterLight
+{
+	float4 positionRange;
+	float4 colorIntensity;
+	float4 directionAngle;
+	float4 type;
+	float4 shadow;
+};
+//================================================================
+
+//= BUFFERS ===================================================
+Texture2D depthTexture 								: register(t0);	// the pixel shader's
+StructuredBuffer<Particle> particles				: register(t1);
+StructuredBuffer<uint> alive						: register(t2);
+StructuredBuffer<Emitter> emitters					: register(t3);
+StructuredBuffer<ClusterLight> clusterLights 		: register(t4);
+StructuredBuffer<uint2> clusterGrid 				: register(t5); // offset, count
+StructuredBuffer<uint> clusterLightIndices 			: register(t6);
+
+cbuffer ParticleBuffer : register(b0)
+{
+	matrix mViewProjection;
+	float3 cameraRight;
+	float ambient;
+	float3 cameraUp;
+	float clusterSliceScale;
+	float3 lightColor;		// the directional light's, times it's intensity
+	float nearPlane;
+	float farPlane;
+	float reverseZ;
+	float2 padding;
+};
+//=============================================================
+
+struct PixelInputType
+{
+	float4 position : SV_POSITION;
+	float2 uv 		: TEXCOORD;
+	float4 color 	: COLOR;
+	float viewDepth : DEPTH;
+};
+
+// Quads have no normal worth lighting, so lighting is per vertex and only by distance and cone,
+// the directional light counts half (it lights one side of a round particle)
+float3 Light(float3 position, float4 clip)
+{
+	float3 light = ambient + lightColor * 0.5f;
+
+	float2 uv		= float2(clip.x / clip.w * 0.5f + 0.5f, -clip.y / clip.w * 0.5f + 0.5f);
+	uint2 tile		= min(uint2(saturate(uv) * float2(CLUSTER_TILES_X, CLUSTER_TILES_Y)), uint2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+	uint slice		= min(uint(max(log(max(clip.w, nearPlane) / nearPlane), 0.0f) * clusterSliceScale), CLUSTER_SLICES - 1);
+	uint2 cluster	= clusterGrid[tile.x + tile.y * CLUSTER_TILES_X + slice * CLUSTER_TILES_X * CLUSTER_TILES_Y];
+
+	for (uint i = 0; i < cluster.y; i++)
+	{
+		ClusterLight clusterLight	= clusterLights[clusterLightIndices[cluster.x + i]];
+		float3 toLight				= clusterLight.positionRange.xyz - position;
+		float dist					= length(toLight);
+		float attunation			= clamp(1.0f - dist / clusterLight.positionRange.w, 0.0f, 1.0f); attunation *= attunation;
+
+		if (clusterLight.type.x != 0.0f) // Spot
+		{
+			float cutoffAngle	= 1.0f - clusterLight.directionAngle.w;
+			float theta			= dot(toLight / max(dist, 0.0001f), normalize(-clusterLight.directionAngle.xyz));
+			attunation			*= clamp((theta - cutoffAngle) / (cutoffAngle * 0.1f), 0.0f, 1.0f);
+		}
+
+		light += clusterLight.colorIntensity.rgb * clusterLight.colorIntensity.a * attunation;
+	}
+
+	return light;
+}
+
+// Vertex Shader
+PixelInputType mainVS(Vertex_PosUv input, uint instanceID : SV_InstanceID)
+{
+	Particle particle	= particles[alive[instanceID]];
+	Emitter emitter		= emitters[particle.emitter];
+	float age			= saturate(particle.age / particle.lifetime);
+	float size			= lerp(emitter.sizeStart, emitter.sizeEnd, age) * particle.scale;
+	float3 position		= particle.position + (cameraRight * input.position.x + cameraUp * input.position.y) * size;
+	float4 color		= lerp(emitter.colorStart, emitter.colorEnd, age);
+
+	PixelInputType output;
+	output.position		= mul(float4(position, 1.0f), mViewProjection);
+	output.uv			= input.uv;
+	output.color		= float4(color.rgb * Light(particle.position, output.position), color.a);
+	output.viewDepth	= output.position.w;
+	return output;
+}
+
+// Weighted blended order-independent transparency, like Transparent.hlsl
+struct PixelOutputType
+{
+	float4 accumulation	: SV_Target0;
+	float revealage		: SV_Target1;
+};
+
+// Pixel Shader
+PixelOutputType mainPS(PixelInputType input)
+{
+	float4 opaque = depthTexture.Load(int3(input.position.xy, 0));
+	if (DepthIsCloser(opaque.g, input.position.z, reverseZ))
+		discard;
+
+	// A round, soft sprite that fades out near opaque surfaces instead of cutting through them
+	float radius	= length(input.uv * 2.0f - 1.0f);
+	float soft		= saturate((opaque.r * farPlane - input.viewDepth) / SOFT_DISTANCE);
+	float alpha		= input.color.a * saturate(1.0f - radius) * soft;
+	if (alpha <= 0.001f)
+		discard;
+
+	// Depth weight from McGuire and Bavoil ("Weighted Blended Order-Independent Transparency", equation 7)
+	float viewDepth = input.viewDepth;
+	float weight 	= alpha * clamp(10.0f / (0.00001f + pow(viewDepth / 5.0f, 2.0f) + pow(viewDepth / 200.0f, 6.0f)), 0.01f, 3000.0f);
+
+	PixelOutputType output;
+	output.accumulation = float4(input.color.rgb * alpha, alpha) * weight;
+	output.revealage 	= alpha;
+	return output;
+}
+#endif
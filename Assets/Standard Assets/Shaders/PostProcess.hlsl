@@ -31,6 +31,48 @@ VS_Output mainVS(Vertex_PosUv input)
     return output;
 }
 
+#if PASS_FUSED
+/*------------------------------------------------------------------------------
+	[Fused] Correction, chromatic aberration and sharpening in a single pass,
+	the FUSED_* defines choose which. Each step samples the output of the one
+	before it, computing it on the fly instead of reading it from a texture.
+------------------------------------------------------------------------------*/
+float3 Fused_Correction(float2 texCoord)
+{
+	float3 color = sourceTexture.Sample(bilinearSampler, texCoord).rgb;
+#if FUSED_CORRECTION
+	color = ToGamma(ACESFitted(color));
+#endif
+	return color;
+}
+
+float3 Fused_ChromaticAberration(float2 texCoord, float2 texelSize)
+{
+#if FUSED_CHROMATIC_ABERRATION
+	float2 offset 	= ChromaticAberration_Offset(texCoord, texelSize);
+	float red 		= Fused_Correction(texCoord + offset).r;
+	float blue 		= Fused_Correction(texCoord - offset).b;
+	return ChromaticAberration_Combine(Fused_Correction(texCoord), red, blue);
+#else
+	return Fused_Correction(texCoord);
+#endif
+}
+
+float3 Fused_Sharpening(float2 texCoord, float2 texelSize)
+{
+#if FUSED_SHARPENING
+	float2 offset 	= LumaSharpen_Offset(texRes);
+	float3 blur 	= Fused_ChromaticAberration(texCoord + float2(offset.x, -offset.y), texelSize);
+	blur 			+= Fused_ChromaticAberration(texCoord + float2(-offset.x, -offset.y), texelSize);
+	blur 			+= Fused_ChromaticAberration(texCoord + float2(offset.x, offset.y), texelSize);
+	blur 			+= Fused_ChromaticAberration(texCoord + float2(-offset.x, offset.y), texelSize);
+	return LumaSharpen_Combine(Fused_ChromaticAberration(texCoord, texelSize), blur * 0.25f);
+#else
+	return Fused_ChromaticAberration(texCoord, texelSize);
+#endif
+}
+#endif
+
 /*------------------------------------------------------------------------------
 								[Pixel Shader]
 ------------------------------------------------------------------------------*/
@@ -40,21 +82,48 @@ float4 mainPS(VS_Output input) : SV_TARGET
     float4 color 		= float4(0.0f, 0.0f, 0.0f, 1.0f);
     float2 texelSize 	= float2(1.0f / texRes.x, 1.0f / texRes.y);
 	
+#if PASS_FUSED
+	color.rgb 	= Fused_Sharpening(texCoord, texelSize);
+#endif
+
 #if PASS_FXAA
 	color.rgb 	= FXAA(texCoord, texelSize, sourceTexture, bilinearSampler);
 	color.a 	= 1.0f;
 #endif
 
-#if PASS_CHROMATIC_ABERRATION
-	color.rgb = ChromaticAberrationPass(texCoord, texelSize, sourceTexture, bilinearSampler);
+#if PASS_BLUR_BOX
+	color = Pass_BlurBox(texCoord, texelSize, 4, sourceTexture, bilinearSampler);
 #endif
 
-#if PASS_SHARPENING
-	color.rgb 	= LumaSharpen(texCoord, sourceTexture, bilinearSampler, texRes);	
+#if PASS_COMPOSITE_OIT
+	// Resolves the weighted blended transparency (accumulation, revealage), to be alpha blended over the opaque frame
+	float4 accumulation = sourceTexture.Load(int3(input.position.xy, 0));
+	float revealage 	= sourceTexture2.Load(int3(input.position.xy, 0)).r;
+	color = float4(accumulation.rgb / clamp(accumulation.a, 0.0001f, 50000.0f), 1.0f - revealage);
 #endif
-	
-#if PASS_BLUR_BOX
-	color = Pass_BlurBox(texCoord, texelSize, 4, sourceTexture, bilinearSampler);
+
+#if PASS_UPSAMPLE_BILATERAL
+	// Blurs a lower resolution source (the shadowing) up to the resolution of the depth in sourceTexture2. Source texels
+	// at a different depth than this pixel barely count, so nothing bleeds across silhouettes.
+	float2 depthRes;
+	sourceTexture2.GetDimensions(depthRes.x, depthRes.y);
+	float depth 		= max(sourceTexture2.Load(int3(texCoord * depthRes, 0)).r, 0.00001f);
+	float2 texelFirst 	= floor(texCoord * texRes - 1.5f) + 0.5f; // the 4x4 source texels around this pixel
+	float weightSum 	= 0.0f;
+	[unroll]
+	for (int y = 0; y < 4; y++)
+	{
+		[unroll]
+		for (int x = 0; x < 4; x++)
+		{
+			float2 uv 			= (texelFirst + float2(x, y)) * texelSize;
+			float depthSource 	= sourceTexture2.Load(int3(uv * depthRes, 0)).r;
+			float weight 		= exp(-abs(depthSource - depth) / (depth * 0.05f)) + 0.0001f;
+			color 				+= sourceTexture.SampleLevel(bilinearSampler, uv, 0) * weight;
+			weightSum 			+= weight;
+		}
+	}
+	color /= weightSum;
 #endif
 
 #if PASS_BLUR_GAUSSIAN_H
@@ -77,10 +146,27 @@ float4 mainPS(VS_Output input) : SV_TARGET
 	color 				= sourceColor + sourceColor2 * parameters.x;
 #endif
 
-#if PASS_CORRECTION
-	color 		= sourceTexture.Sample(bilinearSampler, texCoord);
-	color.rgb 	= ACESFitted(color.rgb);
-	color 		= ToGamma(color);
+#if PASS_DOWNSAMPLE_DEPTH_MAX
+	// Farthest and closest linear depth of the source texels behind this pixel, odd sizes fold in the extra row/column.
+	// Nothing was rendered where the G-Buffer depth is still cleared to 0, so that counts as the far plane.
+	int2 texel 		= int2(input.position.xy) * 2;
+	int2 extra 		= int2(texRes) & 1;
+	int2 texelLast 	= int2(texRes) - 1;
+	float depthMax 	= 0.0f;
+	float depthMin 	= 1.0f;
+	for (int y = 0; y <= 1 + extra.y; y++)
+	{
+		for (int x = 0; x <= 1 + extra.x; x++)
+		{
+			float2 depth = sourceTexture.Load(int3(min(texel + int2(x, y), texelLast), 0)).rg;
+#if DOWNSAMPLE_DEPTH_FIRST
+			depth 		= depth.rr; // the G-Buffer's, linear and clip space depth
+#endif
+			depthMax 	= max(depthMax, depth.r == 0.0f ? 1.0f : depth.r);
+			depthMin 	= min(depthMin, depth.g == 0.0f ? 1.0f : depth.g);
+		}
+	}
+	color = float4(depthMax, depthMin, 0.0f, 1.0f);
 #endif
 
     return color;
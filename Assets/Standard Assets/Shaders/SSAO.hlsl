@@ -102,7 +102,7 @@ float SSAO(float2 texCoord, SamplerState samplerState)
     float3 normal 		= GetNormalUnpacked(texNormal, samplerState, texCoord);
     float depth         = texDepth.Sample(samplerState, texCoord).g;
     float3 position     = ReconstructPositionWorld(depth, mViewProjectionInverse, texCoord);
-    float radius_depth  = radius / depth;
+    float radius_depth  = radius / (reverseZ != 0.0f ? 1.0f - depth : depth); // the sampling radius was tuned for conventional depth
 	float occlusion 	= 0.0f;
 	
 	[unroll(kernelSize)]
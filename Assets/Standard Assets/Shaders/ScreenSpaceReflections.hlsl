@@ -0,0 +1,274 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+// Screen space reflections at half resolution. PASS_TRACE follows a few rays per pixel (more on rougher surfaces) against
+// the closest depth of the Hi-Z pyramid, stepping over whole cells of the coarse levels where the ray is in front of
+// everything, and picks up what the last frame looked like where they hit. PASS_RESOLVE accumulates that over frames.
+
+#define SSR_LEVELS_MAX 8 // must match SSR_LEVELS_MAX
+
+//= TEXTURES ==============================
+#if PASS_TRACE
+Texture2D texNormal 					: register(t0);
+Texture2D texDepth 						: register(t1);
+Texture2D texSpecular 					: register(t2);
+Texture2D texVelocity 					: register(t3);
+Texture2D texSource 					: register(t4); // the last frame's lighting
+Texture2D depthLevels[SSR_LEVELS_MAX]	: register(t5); // farthest (r) and closest (g) linear depth, each level half the size of the previous one
+#endif
+#if PASS_RESOLVE
+Texture2D texTrace 						: register(t0); // this frame's
+Texture2D texHistory 					: register(t1);
+Texture2D texVelocity 					: register(t2);
+#endif
+//=========================================
+
+//= SAMPLERS ==============================
+SamplerState samplerPoint 	: register(s0);
+SamplerState samplerLinear 	: register(s1);
+//=========================================
+
+//= CONSTANT BUFFERS ==========================
+cbuffer MiscBuffer : register(b0)
+{
+	matrix mTransform;
+	matrix mViewProjection;
+	matrix mViewProjectionInverse;	// of the scaled texture coordinates, like the light pass'
+	float4 cameraPosition;
+	
+	float2 resolution;				// of the G-Buffer
+	float resolutionScale;			// everything only covers this much of its textures
+	float farPlane;
+	
+	float levelCount;
+	float rayCount;					// on the roughest traced surfaces, mirrors trace one
+	float stepCount;
+	float roughnessMax;				// rougher surfaces are left to the environment
+	
+	float thickness;				// how far behind a surface a ray still hits it, of the surface's depth
+	float frame;
+	float sourceGamma;				// the source is the tone-mapped frame rather than the lighting
+	float historyValid;
+};
+//=============================================
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 uv 		: TEXCOORD;
+};
+
+PixelInputType mainVS(Vertex_PosUv input)
+{
+    PixelInputType output;
+
+    input.position.w 	= 1.0f;
+    output.position 	= mul(input.position, mTransform);
+    output.uv 			= input.uv;
+
+    return output;
+}
+
+#if PASS_TRACE
+float2 DepthLevel_Load(uint level, uint2 texel)
+{
+	// Resources can only be indexed with literals, the loop unrolls into one branch per level
+	float2 depth = 1.0f;
+	[unroll]
+	for (uint i = 0; i < SSR_LEVELS_MAX; i++)
+	{
+		if (i == level)
+		{
+			depth = depthLevels[i].Load(int3(texel, 0)).rg;
+		}
+	}
+	return depth;
+}
+
+float2 DepthLevel_GetSize(uint level)
+{
+	uint2 size = 1;
+	[unroll]
+	for (uint i = 0; i < SSR_LEVELS_MAX; i++)
+	{
+		if (i == level)
+		{
+			depthLevels[i].GetDimensions(size.x, size.y);
+		}
+	}
+	return float2(size);
+}
+
+float Hash(float2 seed)
+{
+	return frac(sin(dot(seed, float2(12.9898f, 78.233f))) * 43758.5453f);
+}
+
+// A half vector around the normal, distributed like GGX's (the roughness is the perceptual one)
+float3 ImportanceSampleGGX(float2 xi, float3 normal, float roughness)
+{
+	float a 		= roughness * roughness;
+	float phi 		= 2.0f * PI * xi.x;
+	float cosTheta 	= sqrt((1.0f - xi.y) / (1.0f + (a * a - 1.0f) * xi.y));
+	float sinTheta 	= sqrt(1.0f - cosTheta * cosTheta);
+
+	float3 up 		= abs(normal.z) < 0.999f ? float3(0.0f, 0.0f, 1.0f) : float3(1.0f, 0.0f, 0.0f);
+	float3 tangentX	= normalize(cross(up, normal));
+	float3 tangentY	= cross(normal, tangentX);
+	return normalize(tangentX * sinTheta * cos(phi) + tangentY * sinTheta * sin(phi) + normal * cosTheta);
+}
+
+// Returns the full resolution texture coordinates of the hit in xy and how much to trust it in z
+float3 Trace(float3 origin, float3 direction)
+{
+	// The ray ends where it would go behind the camera, or far enough to cross the screen
+	float4 h0 		= mul(float4(origin, 1.0f), mViewProjection);
+	float rayLength = farPlane * 0.5f;
+	float4 h1 		= mul(float4(origin + direction * rayLength, 1.0f), mViewProjection);
+	if (h1.w < h0.w * 0.01f)
+	{
+		rayLength 	*= (h0.w - h0.w * 0.01f) / (h0.w - h1.w);
+		h1 			= mul(float4(origin + direction * rayLength, 1.0f), mViewProjection);
+	}
+
+	// Along the screen, the reciprocal of the depth is what changes linearly
+	float2 s0 	= h0.xy / h0.w * float2(0.5f, -0.5f) + 0.5f;
+	float2 s1 	= h1.xy / h1.w * float2(0.5f, -0.5f) + 0.5f;
+	float k0 	= 1.0f / h0.w;
+	float k1 	= 1.0f / h1.w;
+	float2 d 	= s1 - s0;
+	d 			= abs(d) < 1e-6f ? 1e-6f : d;
+
+	// Up to where it leaves the screen
+	float2 exits 	= ((d > 0.0f ? 1.0f : 0.0f) - s0) / d;
+	float tMax 		= saturate(min(exits.x, exits.y));
+
+	// Start a texel away, so that the surface the ray leaves from isn't hit
+	float2 size0 	= DepthLevel_GetSize(0);
+	float t 		= 1.5f / max(abs(d.x) * size0.x, abs(d.y) * size0.y);
+	uint level 		= 0;
+	uint levelLast 	= (uint)levelCount - 1;
+
+	[loop]
+	for (uint i = 0; i < (uint)stepCount && t < tMax; i++)
+	{
+		// Where the ray leaves the cell it's in, a hair past the boundary
+		float2 size 		= DepthLevel_GetSize(level);
+		float2 position		= s0 + d * t;
+		float2 cell 		= floor(position * size);
+		float2 boundary 	= (cell + (d > 0.0f ? 1.0f : 0.0f)) / size;
+		float2 crossings 	= (boundary - s0) / d;
+		float tExit 		= min(min(crossings.x, crossings.y) + 0.01f / max(abs(d.x) * size.x, abs(d.y) * size.y), tMax);
+
+		// The nearest the ray gets to the camera within the cell
+		float depthRay 		= min(1.0f / lerp(k0, k1, t), 1.0f / lerp(k0, k1, tExit)) / farPlane;
+		float depthCell 	= DepthLevel_Load(level, uint2(cell)).g;
+
+		if (depthRay < depthCell)
+		{
+			// In front of everything the cell covers, skip it and take bigger steps
+			t 		= tExit;
+			level 	= min(level + 1, levelLast);
+		}
+		else if (level == 0)
+		{
+			// Reached a surface (the sky isn't one), a ray that went far behind it passed it by
+			if (depthCell < 1.0f && depthRay - depthCell < max(depthCell * thickness, 0.0005f))
+			{
+				float2 edges 	= saturate(min(position, 1.0f - position) * 10.0f);
+				float fade 		= 1.0f - saturate(t / tMax);
+				return float3(position, edges.x * edges.y * fade);
+			}
+			t = tExit;
+		}
+		else
+		{
+			level--;
+		}
+	}
+
+	return 0.0f;
+}
+
+float4 mainPS(PixelInputType input) : SV_TARGET
+{
+	float2 texCoord 	= input.uv;
+	float2 depth 		= texDepth.Sample(samplerPoint, texCoord).rg;
+	float roughness 	= texSpecular.Sample(samplerPoint, texCoord).r;
+	if (depth.r == 0.0f || roughness > roughnessMax)
+		return 0.0f;
+
+	float3 normal 		= normalize(UnpackNormal(texNormal.Sample(samplerPoint, texCoord).xyz));
+	float3 position 	= ReconstructPositionWorld(depth.g, mViewProjectionInverse, texCoord);
+	float3 viewDir 		= normalize(cameraPosition.xyz - position);
+
+	// One ray for mirrors, more the rougher it gets, each frame the rays point elsewhere
+	uint rays 			= (uint)lerp(1.0f, rayCount, saturate(roughness / max(roughnessMax, 0.001f)));
+	float noise 		= Hash(input.position.xy + frame * 0.618f);
+	float4 reflection	= 0.0f;
+	[loop]
+	for (uint i = 0; i < rays; i++)
+	{
+		float2 xi 			= frac(float2((i + 0.5f) / rays, noise * 7.0f + i * 0.754877f) + noise);
+		float3 halfVector 	= ImportanceSampleGGX(xi, normal, roughness);
+		float3 direction 	= reflect(-viewDir, halfVector);
+		if (dot(direction, normal) <= 0.0f)
+			continue;
+
+		float3 hit = Trace(position + normal * depth.r * farPlane * 0.001f, direction);
+		if (hit.z <= 0.0f)
+			continue;
+
+		// Surfaces seen from behind aren't what's reflected
+		float2 hitScaled 	= hit.xy * resolutionScale;
+		float3 hitNormal 	= normalize(UnpackNormal(texNormal.SampleLevel(samplerPoint, hitScaled, 0).xyz));
+		if (dot(hitNormal, direction) > 0.0f)
+			continue;
+
+		// Where the hit was on the last frame
+		float2 velocity 	= texVelocity.SampleLevel(samplerPoint, hitScaled, 0).xy;
+		float2 uvPrevious 	= hit.xy - velocity;
+		if (any(uvPrevious != saturate(uvPrevious)))
+			continue;
+
+		float3 color 	= texSource.SampleLevel(samplerLinear, uvPrevious, 0).rgb;
+		color 			= sourceGamma != 0.0f ? ToLinear(color) : color;
+		reflection 		+= float4(color * hit.z, hit.z);
+	}
+
+	// Premultiplied by how much of it the rays found, the light pass blends the environment in for the rest
+	return reflection / rays;
+}
+#endif
+
+#if PASS_RESOLVE
+float4 mainPS(PixelInputType input) : SV_TARGET
+{
+	float2 texelSize 	= 1.0f / (resolution * 0.5f);
+	float4 current 		= texTrace.Sample(samplerPoint, input.uv);
+	
+	// Clamp the history to what's around this pixel now, so that it can't hold on to what changed
+	float4 colorMin = current;
+	float4 colorMax = current;
+	[unroll]
+	for (int y = -1; y <= 1; y++)
+	{
+		[unroll]
+		for (int x = -1; x <= 1; x++)
+		{
+			float4 neighbour 	= texTrace.Sample(samplerPoint, input.uv + float2(x, y) * texelSize);
+			colorMin 			= min(colorMin, neighbour);
+			colorMax 			= max(colorMax, neighbour);
+		}
+	}
+
+	// Reflections move with the surface they are on, close enough for rough ones
+	float2 velocity 	= texVelocity.Sample(samplerPoint, input.uv).xy;
+	float2 uvHistory 	= input.uv / resolutionScale - velocity;
+	bool offscreen 		= any(uvHistory != saturate(uvHistory));
+	float4 history 		= clamp(texHistory.Sample(samplerLinear, uvHistory * resolutionScale), colorMin, colorMax);
+
+	return (historyValid == 0.0f || offscreen) ? current : lerp(current, history, 0.9f);
+}
+#endif
@@ -12,7 +12,8 @@ float2 texOffset(float2 shadowMapSize, int x, int y)
 float depthTest(Texture2D shadowMap, SamplerState samplerState, float2 texCoords, float compare)
 {
     float depth = shadowMap.Sample(samplerState, texCoords).r;
-    return step(compare, depth);
+    // With reverse-z the occluder has the greater depth
+    return reverseZ != 0.0f ? step(depth, compare) : step(compare, depth);
 }
 
 float sampleShadowMap(Texture2D shadowMap, SamplerState samplerState, float2 size, float2 texCoords, float compare)
@@ -72,8 +73,8 @@ float ShadowMapping(Texture2D shadowMap, SamplerState samplerState, float shadow
 	pos.x = pos.x / 2.0f + 0.5f;
 	pos.y = pos.y / -2.0f + 0.5f;
 
-	// Apply shadow map bias
-	pos.z -= bias;
+	// Apply shadow map bias, towards the light
+	pos.z += reverseZ != 0.0f ? bias : -bias;
 
 	// Interpolation + PCF
 	float amountLit = sampleShadowMapPCF(shadowMap, samplerState, shadowMapResolution, pos.xy, pos.z);
@@ -27,7 +27,8 @@ cbuffer DefaultBuffer : register(b0)
 	float nearPlane;
     float farPlane;	
 	float doShadowMapping;	
-	float3 padding;
+	float reverseZ;
+	float2 padding;
 };
 //========================================
 
@@ -2,9 +2,17 @@
 #include "Common.hlsl"
 //====================
 
-cbuffer MiscBuffer
+cbuffer MiscBuffer : register(b0)
 {
-	matrix mTransform;
+	matrix mViewProjection;
+#if PICKING
+	float4 pickingId; // x, which renderable is being drawn (starting at 1)
+#endif
+};
+
+cbuffer PerInstanceBuffer : register(b2)
+{
+	matrix mWorldInstances[INSTANCE_BATCH_MAX];
 };
 
 struct VS_Output
@@ -13,16 +21,20 @@ struct VS_Output
 };
 
 // Vertex Shader
-VS_Output mainVS(Vertex_Pos input)
+VS_Output mainVS(Vertex_Pos input, uint instanceID : SV_InstanceID)
 {
 	input.position.w = 1.0f;
 	VS_Output output;
-    output.position = mul(input.position, mTransform);
+    output.position = mul(mul(input.position, mWorldInstances[instanceID]), mViewProjection);
 	return output;
 }
 
 // Pixel Shader
 float mainPS(VS_Output input) : SV_TARGET
 {
+#if PICKING
+	return pickingId.x;
+#else
 	return input.position.z / input.position.w;
+#endif
 }
\ No newline at end of file
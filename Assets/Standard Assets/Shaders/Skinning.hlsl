@@ -0,0 +1,82 @@
+// Poses skinned geometry, one dispatch per model. Every instance (a skinned renderable) gets a row of thread groups,
+// one thread per vertex: the bind pose vertex is blended between the palette matrices of its bones and written, packed
+// the way it was read (RHI_Vertex_PosUVTBNPacked), to where the instance starts in the vertex buffer everything draws from.
+
+#define THREAD_GROUP_SIZE	64	// must match GPU_SKINNING_THREAD_GROUP_SIZE
+#define VERTEX_SIZE			24	// RHI_Vertex_PosUVTBNPacked
+
+struct VertexPacked
+{
+	float3 position;
+	uint uv;		// two half floats
+	uint normal;	// 10:10:10:2 unorm
+	uint tangent;	// 10:10:10:2 unorm, w is the bitangent sign
+};
+
+// Must match GPUSkinning.h
+struct Instance
+{
+	uint vertexOffset;
+	uint vertexCount;
+	uint outputOffset;
+	uint paletteOffset;
+};
+
+//= BUFFERS ===================================================
+StructuredBuffer<VertexPacked> vertices	: register(t0); // the model's bind pose
+StructuredBuffer<uint2> weights			: register(t1); // RHI_Vertex_Skin, four bone indices then four unorm weights, a byte each
+StructuredBuffer<matrix> palette		: register(t2);
+StructuredBuffer<Instance> instances	: register(t3);
+RWByteAddressBuffer output				: register(u0);
+
+cbuffer SkinningBuffer : register(b0)
+{
+	uint instanceOffset; // the model's first instance
+	uint3 padding;
+};
+//=============================================================
+
+float3 UnpackUnit(uint value)
+{
+	return float3(value & 0x3FF, (value >> 10) & 0x3FF, (value >> 20) & 0x3FF) / 1023.0f * 2.0f - 1.0f;
+}
+
+// Keeps the w bits of what it packs into
+uint PackUnit(float3 value, uint packed)
+{
+	uint3 unorm = (uint3)round(saturate(value * 0.5f + 0.5f) * 1023.0f);
+	return unorm.x | (unorm.y << 10) | (unorm.z << 20) | (packed & 0xC0000000);
+}
+
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void mainCS(uint3 groupID : SV_GroupID, uint3 threadID : SV_DispatchThreadID)
+{
+	Instance instance	= instances[instanceOffset + groupID.y];
+	uint index			= threadID.x;
+	if (index >= instance.vertexCount)
+		return;
+
+	VertexPacked vertex	= vertices[instance.vertexOffset + index];
+	uint2 skin			= weights[instance.vertexOffset + index];
+
+	// Vertices no bone holds keep their bind pose
+	matrix bone = 0;
+	[unroll]
+	for (uint i = 0; i < 4; i++)
+	{
+		float weight	= ((skin.y >> (i * 8)) & 0xFF) / 255.0f;
+		bone			+= palette[instance.paletteOffset + ((skin.x >> (i * 8)) & 0xFF)] * weight;
+	}
+	if (skin.y == 0)
+	{
+		bone = float4x4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+	}
+
+	float3 position	= mul(float4(vertex.position, 1.0f), bone).xyz;
+	float3 normal	= normalize(mul(UnpackUnit(vertex.normal), (float3x3)bone));
+	float3 tangent	= normalize(mul(UnpackUnit(vertex.tangent), (float3x3)bone));
+
+	uint address = (instance.outputOffset + index) * VERTEX_SIZE;
+	output.Store4(address, uint4(asuint(position), vertex.uv));
+	output.Store2(address + 16, uint2(PackUnit(normal, vertex.normal), PackUnit(tangent, vertex.tangent)));
+}
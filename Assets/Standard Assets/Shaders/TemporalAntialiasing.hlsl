@@ -0,0 +1,92 @@
+// = INCLUDES ========
+#include "Common.hlsl"
+//====================
+
+//= TEXTURES ==============================
+Texture2D texCurrent 		: register(t0);
+Texture2D texHistory 		: register(t1);
+Texture2D texVelocity 		: register(t2);
+//=========================================
+
+//= SAMPLERS ==============================
+SamplerState samplerPoint 	: register(s0);
+SamplerState samplerLinear 	: register(s1);
+//=========================================
+
+//= CONSTANT BUFFERS ==========================
+cbuffer MiscBuffer : register(b0)
+{
+	matrix mTransform;
+	float2 jitter;			// how far the current frame was shifted, in texture coordinates
+	float resolutionScale;	// the current frame (and velocity) only cover this much of their textures
+	float historyValid;
+	float2 resolution;		// of the current frame's texture
+	float2 padding;
+};
+//=============================================
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 uv 		: TEXCOORD;
+};
+
+struct PixelOutputType
+{
+	float4 color	: SV_Target0;
+	float4 history	: SV_Target1;
+};
+
+PixelInputType mainVS(Vertex_PosUv input)
+{
+    PixelInputType output;
+
+    input.position.w 	= 1.0f;
+    output.position 	= mul(input.position, mTransform);
+    output.uv 			= input.uv;
+
+    return output;
+}
+
+PixelOutputType mainPS(PixelInputType input)
+{
+	PixelOutputType output;
+
+	// Undo the jitter, so the current frame is sampled where this pixel is at rest. Stay within the
+	// rendered sub-rect, anything past it is stale.
+	float2 texelSize	= 1.0f / resolution;
+	float2 uvMax		= resolutionScale - texelSize * 0.5f;
+	float2 uvCurrent	= min(input.uv * resolutionScale + jitter, uvMax);
+	float3 current		= texCurrent.Sample(samplerLinear, uvCurrent).rgb;
+
+	// The history gets clamped to the neighbourhood of the current frame, which rejects what got
+	// disoccluded or changed since (the previous world matrices aren't known, only camera motion is in the velocity).
+	float3 colorMin = current;
+	float3 colorMax = current;
+	[unroll]
+	for (int y = -1; y <= 1; y++)
+	{
+		[unroll]
+		for (int x = -1; x <= 1; x++)
+		{
+			float3 neighbour	= texCurrent.Sample(samplerPoint, min(uvCurrent + float2(x, y) * texelSize, uvMax)).rgb;
+			colorMin			= min(colorMin, neighbour);
+			colorMax			= max(colorMax, neighbour);
+		}
+	}
+
+	// Reproject, the history is always at full resolution
+	float2 velocity		= texVelocity.Sample(samplerPoint, uvCurrent).xy;
+	float2 uvHistory	= input.uv - velocity;
+	float3 history		= clamp(texHistory.Sample(samplerLinear, uvHistory).rgb, colorMin, colorMax);
+
+	// Mostly history, unless there is none for this pixel. When upscaling each frame only covers a
+	// fraction of the pixels, so the history has to carry more of the detail.
+	bool offscreen	= any(uvHistory != saturate(uvHistory));
+	float blend		= (historyValid == 0.0f || offscreen) ? 1.0f : lerp(0.05f, 0.1f, resolutionScale);
+	float3 color	= lerp(history, current, blend);
+
+	output.color	= float4(color, 1.0f);
+	output.history	= float4(color, 1.0f);
+	return output;
+}
@@ -19,8 +19,9 @@ struct PixelInputType
 };
 
 // Vertex Shader
-PixelInputType mainVS(Vertex_PosUvTbn input)
+PixelInputType mainVS(Vertex_PosUvTbnPacked packed)
 {
+	Vertex_PosUvTbn input = UnpackVertex(packed);
     PixelInputType output;
     	
     input.position.w 	= 1.0f;	
@@ -16,7 +16,7 @@ cbuffer MiscBuffer : register(b0)
 	float3 cameraPos;
 	float roughness;
 	float3 lightDir;
-	float padding2;
+	float reverseZ;
 };
 
 struct PixelInputType
@@ -31,8 +31,9 @@ struct PixelInputType
 };
 
 // Vertex Shader
-PixelInputType mainVS(Vertex_PosUvTbn input)
+PixelInputType mainVS(Vertex_PosUvTbnPacked packed)
 {
+	Vertex_PosUvTbn input = UnpackVertex(packed);
     PixelInputType output;
     	
     input.position.w 	= 1.0f;	
@@ -48,17 +49,24 @@ PixelInputType mainVS(Vertex_PosUvTbn input)
 	return output;
 }
 
+// Weighted blended order-independent transparency, what's in front counts more, so no sorting is needed
+struct PixelOutputType
+{
+	float4 accumulation	: SV_Target0;
+	float revealage		: SV_Target1;
+};
+
 // Pixel Shader
-float4 mainPS(PixelInputType input) : SV_TARGET
+PixelOutputType mainPS(PixelInputType input)
 {
 	float2 projectDepthMapTexCoord;
 	projectDepthMapTexCoord.x = input.gridPos.x / input.gridPos.w / 2.0f + 0.5f;
 	projectDepthMapTexCoord.y = -input.gridPos.y / input.gridPos.w / 2.0f + 0.5f;
 	
-	float transparentGeometryDepth 	= input.position.z;
-	float opaqueGeometryDepth 		= depthTexture.Sample(samplerLinear, projectDepthMapTexCoord).r;
+	float transparentGeometryDepth 	= input.gridPos.z / input.gridPos.w;
+	float opaqueGeometryDepth 		= depthTexture.Sample(samplerLinear, projectDepthMapTexCoord).g;
 	
-	if (opaqueGeometryDepth > transparentGeometryDepth)
+	if (DepthIsCloser(opaqueGeometryDepth, transparentGeometryDepth, reverseZ))
 		discard;
 	
 	float3 normal				= normalize(input.normal);
@@ -75,5 +83,12 @@ float4 mainPS(PixelInputType input) : SV_TARGET
     float alpha         = color.a;
     float3 finalColor   = saturate(color.rgb + environmentColor * intensity);
 
-    return float4(finalColor, alpha);
+	// Depth weight from McGuire and Bavoil ("Weighted Blended Order-Independent Transparency", equation 7)
+	float viewDepth = abs(mul(input.positionWS, mView).z);
+	float weight 	= alpha * clamp(10.0f / (0.00001f + pow(viewDepth / 5.0f, 2.0f) + pow(viewDepth / 200.0f, 6.0f)), 0.01f, 3000.0f);
+
+	PixelOutputType output;
+	output.accumulation = float4(finalColor * alpha, alpha) * weight;
+	output.revealage 	= alpha;
+    return output;
 }
\ No newline at end of file
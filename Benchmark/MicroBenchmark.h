@@ -0,0 +1,115 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES ==========
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+//=====================
+
+// Batches run until one takes at least this long, the batch size doubles until then
+#define MICRO_BENCHMARK_BATCH_MS	20.0
+// Batches of that size, the fastest one is what's reported (the one least disturbed by the rest of the system)
+#define MICRO_BENCHMARK_REPETITIONS	7
+
+// Registers a micro benchmark, it's body repeats what's measured while state.KeepRunning() returns true:
+//	MICRO_BENCHMARK(Matrix_Multiply) { Matrix a, b; while (state.KeepRunning()) { DoNotOptimize(a * b); } }
+#define MICRO_BENCHMARK(name)																\
+	static void MicroBenchmark_##name(MicroBenchmark_State& state);							\
+	static MicroBenchmark_Registrar microBenchmarkRegistrar_##name(#name, MicroBenchmark_##name);	\
+	static void MicroBenchmark_##name(MicroBenchmark_State& state)
+
+class MicroBenchmark_State
+{
+public:
+	MicroBenchmark_State(uint64_t iterations) : m_iterationsLeft(iterations) {}
+
+	// The clock starts on the first call, so whatever is set up before the loop isn't measured
+	bool KeepRunning()
+	{
+		if (!m_started)
+		{
+			m_started	= true;
+			m_start		= std::chrono::steady_clock::now();
+		}
+
+		if (m_iterationsLeft == 0)
+		{
+			m_end = std::chrono::steady_clock::now();
+			return false;
+		}
+
+		m_iterationsLeft--;
+		return true;
+	}
+
+	// Items a single iteration processes (e.g. the number of matrices multiplied), reported per item
+	void SetItemsPerIteration(uint64_t items) { m_items = items; }
+	uint64_t GetItemsPerIteration() const { return m_items; }
+	double GetElapsedNs() const { return std::chrono::duration<double, std::nano>(m_end - m_start).count(); }
+
+private:
+	uint64_t m_iterationsLeft;
+	uint64_t m_items = 1;
+	bool m_started = false;
+	std::chrono::steady_clock::time_point m_start;
+	std::chrono::steady_clock::time_point m_end;
+};
+
+struct MicroBenchmark
+{
+	std::string name;
+	std::function<void(MicroBenchmark_State&)> function;
+};
+
+inline std::vector<MicroBenchmark>& MicroBenchmarks_Get()
+{
+	static std::vector<MicroBenchmark> benchmarks;
+	return benchmarks;
+}
+
+struct MicroBenchmark_Registrar
+{
+	MicroBenchmark_Registrar(const char* name, void(*function)(MicroBenchmark_State&)) { MicroBenchmarks_Get().push_back({ name, function }); }
+};
+
+// Keeps the compiler from dropping a computation whose result nothing reads, the value's address escapes
+// and the barrier makes the compiler assume anything can be read from memory past that point
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+	static const void* volatile sink;
+	sink = &value;
+#ifdef _MSC_VER
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// Runs the benchmarks whose name contains the filter (all of them when it's empty), prints them and writes JSON if there is a path
+int MicroBenchmarks_Run(const std::string& filter, const std::string& outputPath);
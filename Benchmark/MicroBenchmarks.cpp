@@ -0,0 +1,528 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+//= INCLUDES ===================
+#include "MicroBenchmark.h"
+#include "Core/Context.h"
+#include "Core/EventSystem.h"
+#include "Math/Matrix.h"
+#include "Math/Quaternion.h"
+#include "Math/Frustum.h"
+#include "Math/Ray.h"
+#include "Math/Vector3.h"
+#include "IO/FileStream.h"
+#include "RHI/RHI_Vertex.h"
+#include "RHI/RHI_Definition.h"
+#include "Resource/ResourceCache.h"
+#include "Threading/Threading.h"
+#include "World/SpatialTree.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+//==============================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Directus;
+using namespace Math;
+//=======================
+
+namespace _MicroBenchmarks
+{
+	// The same values every run, so runs compare
+	mt19937& Random()
+	{
+		static mt19937 random(1234);
+		return random;
+	}
+
+	float RandomFloat(float min = -1.0f, float max = 1.0f)
+	{
+		return uniform_real_distribution<float>(min, max)(Random());
+	}
+
+	Vector3 RandomVector3(float min = -1.0f, float max = 1.0f)
+	{
+		return Vector3(RandomFloat(min, max), RandomFloat(min, max), RandomFloat(min, max));
+	}
+
+	Quaternion RandomQuaternion()
+	{
+		return Quaternion::FromEulerAngles(RandomVector3(-180.0f, 180.0f));
+	}
+
+	vector<Matrix> RandomMatrices(unsigned int count)
+	{
+		vector<Matrix> matrices;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			matrices.emplace_back(Matrix::CreateScale(RandomFloat(0.5f, 2.0f)) * Matrix::CreateRotation(RandomQuaternion()) * Matrix::CreateTranslation(RandomVector3(-100.0f, 100.0f)));
+		}
+		return matrices;
+	}
+
+	class Resource : public IResource
+	{
+	public:
+		Resource() : IResource(nullptr, Resource_Texture) {}
+	};
+
+	// Shared by the threading benchmarks, it's threads start once
+	Threading* GetThreading()
+	{
+		static Context context;
+		static unique_ptr<Threading> threading = []()
+		{
+			auto threading = make_unique<Threading>(&context);
+			threading->Initialize();
+			return threading;
+		}();
+		return threading.get();
+	}
+}
+
+//= MATH =======================================================================================================
+MICRO_BENCHMARK(Matrix_Multiply)
+{
+	auto matrices = _MicroBenchmarks::RandomMatrices(1024);
+	state.SetItemsPerIteration(matrices.size());
+	while (state.KeepRunning())
+	{
+		Matrix result = Matrix::Identity;
+		for (const auto& matrix : matrices)
+		{
+			result = result * matrix;
+		}
+		DoNotOptimize(result);
+	}
+}
+
+MICRO_BENCHMARK(Matrix_Inverse)
+{
+	auto matrices = _MicroBenchmarks::RandomMatrices(1024);
+	state.SetItemsPerIteration(matrices.size());
+	while (state.KeepRunning())
+	{
+		for (const auto& matrix : matrices)
+		{
+			DoNotOptimize(matrix.Inverted());
+		}
+	}
+}
+
+MICRO_BENCHMARK(Matrix_InverseGeneral)
+{
+	// Projections, everything else takes the affine path
+	vector<Matrix> matrices;
+	for (unsigned int i = 0; i < 1024; i++)
+	{
+		matrices.emplace_back(Matrix::CreatePerspectiveFieldOfViewLH(_MicroBenchmarks::RandomFloat(0.5f, 1.5f), 16.0f / 9.0f, 0.3f, 1000.0f) * Matrix::CreateTranslation(_MicroBenchmarks::RandomVector3()));
+	}
+	state.SetItemsPerIteration(matrices.size());
+	while (state.KeepRunning())
+	{
+		for (const auto& matrix : matrices)
+		{
+			DoNotOptimize(matrix.Inverted());
+		}
+	}
+}
+
+MICRO_BENCHMARK(Matrix_TransformPoints)
+{
+	auto matrix = _MicroBenchmarks::RandomMatrices(1).front();
+	vector<Vector3> points(4096);
+	for (auto& point : points) point = _MicroBenchmarks::RandomVector3(-100.0f, 100.0f);
+	vector<Vector3> output(points.size());
+
+	state.SetItemsPerIteration(points.size());
+	while (state.KeepRunning())
+	{
+		Matrix::TransformPoints(matrix, points.data(), output.data(), points.size());
+		DoNotOptimize(output.data());
+	}
+}
+
+MICRO_BENCHMARK(Quaternion_Multiply)
+{
+	vector<Quaternion> quaternions;
+	for (unsigned int i = 0; i < 1024; i++) quaternions.emplace_back(_MicroBenchmarks::RandomQuaternion());
+	state.SetItemsPerIteration(quaternions.size());
+	while (state.KeepRunning())
+	{
+		Quaternion result = Quaternion::Identity;
+		for (const auto& quaternion : quaternions)
+		{
+			result = result * quaternion;
+		}
+		DoNotOptimize(result);
+	}
+}
+
+MICRO_BENCHMARK(Quaternion_RotateVector)
+{
+	vector<Quaternion> quaternions;
+	for (unsigned int i = 0; i < 1024; i++) quaternions.emplace_back(_MicroBenchmarks::RandomQuaternion());
+	state.SetItemsPerIteration(quaternions.size());
+	while (state.KeepRunning())
+	{
+		Vector3 result = Vector3::Forward;
+		for (const auto& quaternion : quaternions)
+		{
+			result = quaternion * result;
+		}
+		DoNotOptimize(result);
+	}
+}
+
+MICRO_BENCHMARK(Quaternion_FromEulerAngles)
+{
+	vector<Vector3> angles;
+	for (unsigned int i = 0; i < 1024; i++) angles.emplace_back(_MicroBenchmarks::RandomVector3(-180.0f, 180.0f));
+	state.SetItemsPerIteration(angles.size());
+	while (state.KeepRunning())
+	{
+		for (const auto& angle : angles)
+		{
+			DoNotOptimize(Quaternion::FromEulerAngles(angle));
+		}
+	}
+}
+
+MICRO_BENCHMARK(Frustum_CheckCube)
+{
+	// Half of the boxes are around the camera, the rest anywhere
+	Frustum frustum;
+	auto view		= Matrix::CreateLookAtLH(Vector3(0.0f, 10.0f, -50.0f), Vector3::Zero, Vector3::Up);
+	auto projection	= Matrix::CreatePerspectiveFieldOfViewLH(1.0f, 16.0f / 9.0f, 0.3f, 1000.0f);
+	frustum.Construct(view, projection, 1000.0f);
+
+	vector<pair<Vector3, Vector3>> boxes;
+	for (unsigned int i = 0; i < 4096; i++)
+	{
+		float range = i % 2 ? 50.0f : 1000.0f;
+		boxes.emplace_back(_MicroBenchmarks::RandomVector3(-range, range), _MicroBenchmarks::RandomVector3(0.5f, 10.0f));
+	}
+	state.SetItemsPerIteration(boxes.size());
+	while (state.KeepRunning())
+	{
+		unsigned int visible = 0;
+		for (const auto& box : boxes)
+		{
+			visible += frustum.CheckCube(box.first, box.second) != Outside ? 1 : 0;
+		}
+		DoNotOptimize(visible);
+	}
+}
+
+MICRO_BENCHMARK(Frustum_CheckCubes)
+{
+	// The boxes of Frustum_CheckCube, culled in a batch
+	Frustum frustum;
+	auto view		= Matrix::CreateLookAtLH(Vector3(0.0f, 10.0f, -50.0f), Vector3::Zero, Vector3::Up);
+	auto projection	= Matrix::CreatePerspectiveFieldOfViewLH(1.0f, 16.0f / 9.0f, 0.3f, 1000.0f);
+	frustum.Construct(view, projection, 1000.0f);
+
+	BoundingBoxSoA boxes;
+	for (unsigned int i = 0; i < 4096; i++)
+	{
+		float range = i % 2 ? 50.0f : 1000.0f;
+		boxes.Add(_MicroBenchmarks::RandomVector3(-range, range), _MicroBenchmarks::RandomVector3(0.5f, 10.0f));
+	}
+	vector<uint64_t> visible((boxes.Size() + 63) / 64);
+	state.SetItemsPerIteration(boxes.Size());
+	while (state.KeepRunning())
+	{
+		frustum.CheckCubes(boxes, 0, boxes.Size(), visible.data());
+		DoNotOptimize(visible[0]);
+	}
+}
+
+MICRO_BENCHMARK(SpatialTree_QueryRays)
+{
+	// Line of sight between random points, through a field of boxes
+	SpatialTree tree;
+	for (unsigned int i = 0; i < 4096; i++)
+	{
+		Vector3 center	= _MicroBenchmarks::RandomVector3(-500.0f, 500.0f);
+		Vector3 extents	= _MicroBenchmarks::RandomVector3(0.5f, 10.0f);
+		tree.Insert(nullptr, BoundingBox(center - extents, center + extents), true);
+	}
+
+	vector<Ray> rays;
+	for (unsigned int i = 0; i < 1024; i++)
+	{
+		rays.emplace_back(_MicroBenchmarks::RandomVector3(-500.0f, 500.0f), _MicroBenchmarks::RandomVector3(-500.0f, 500.0f));
+	}
+	vector<SpatialTree::RayHit> hits;
+	state.SetItemsPerIteration(rays.size());
+	while (state.KeepRunning())
+	{
+		hits.clear();
+		tree.Query(rays.data(), rays.size(), hits, true);
+		DoNotOptimize(hits.size());
+	}
+}
+//==============================================================================================================
+
+//= SERIALIZATION ==============================================================================================
+MICRO_BENCHMARK(FileStream_ReadVertices)
+{
+	// From memory, so it's the deserialization that's measured rather than the disk
+	vector<RHI_Vertex_PosUVTBN> vertices(65536);
+	for (auto& vertex : vertices)
+	{
+		vertex = RHI_Vertex_PosUVTBN(_MicroBenchmarks::RandomVector3(), Vector2(0.5f, 0.5f), Vector3::Up, Vector3::Right, Vector3::Forward);
+	}
+	vector<std::byte> buffer;
+	{
+		FileStream stream(&buffer);
+		stream.Write(vertices);
+	}
+
+	state.SetItemsPerIteration(vertices.size());
+	vector<RHI_Vertex_PosUVTBN> read;
+	while (state.KeepRunning())
+	{
+		FileStream stream(buffer.data(), buffer.size());
+		stream.Read(&read);
+		DoNotOptimize(read.data());
+	}
+}
+
+MICRO_BENCHMARK(FileStream_ReadIndices)
+{
+	vector<unsigned int> indices(262144);
+	for (unsigned int i = 0; i < (unsigned int)indices.size(); i++) indices[i] = i;
+	vector<std::byte> buffer;
+	{
+		FileStream stream(&buffer);
+		stream.Write(indices);
+	}
+
+	state.SetItemsPerIteration(indices.size());
+	vector<unsigned int> read;
+	while (state.KeepRunning())
+	{
+		FileStream stream(buffer.data(), buffer.size());
+		stream.Read(&read);
+		DoNotOptimize(read.data());
+	}
+}
+//==============================================================================================================
+
+//= RESOURCES ==================================================================================================
+MICRO_BENCHMARK(ResourceCache_GetByName)
+{
+	ResourceCache cache;
+	vector<string> names;
+	for (unsigned int i = 0; i < 1024; i++)
+	{
+		auto resource = make_shared<_MicroBenchmarks::Resource>();
+		resource->SetResourceName("Resource_" + to_string(i));
+		resource->SetResourceFilePath("Assets/Resource_" + to_string(i) + ".texture");
+		cache.Add(resource);
+		names.emplace_back(resource->GetResourceName());
+	}
+	shuffle(names.begin(), names.end(), _MicroBenchmarks::Random());
+
+	state.SetItemsPerIteration(names.size());
+	while (state.KeepRunning())
+	{
+		for (const auto& name : names)
+		{
+			DoNotOptimize(cache.GetByName(name, Resource_Texture));
+		}
+	}
+}
+
+MICRO_BENCHMARK(ResourceCache_GetByPath)
+{
+	ResourceCache cache;
+	vector<string> paths;
+	for (unsigned int i = 0; i < 1024; i++)
+	{
+		auto resource = make_shared<_MicroBenchmarks::Resource>();
+		resource->SetResourceName("Resource_" + to_string(i));
+		resource->SetResourceFilePath("Assets/Resource_" + to_string(i) + ".texture");
+		cache.Add(resource);
+		paths.emplace_back(resource->GetResourceFilePath());
+	}
+	shuffle(paths.begin(), paths.end(), _MicroBenchmarks::Random());
+
+	state.SetItemsPerIteration(paths.size());
+	while (state.KeepRunning())
+	{
+		for (const auto& path : paths)
+		{
+			DoNotOptimize(cache.GetByPath<RHI_Texture>(path));
+		}
+	}
+}
+//==============================================================================================================
+
+//= THREADING ==================================================================================================
+MICRO_BENCHMARK(Threading_AddTask)
+{
+	// Adding, running and waiting on empty tasks, what's left is the overhead of a task
+	auto threading = _MicroBenchmarks::GetThreading();
+	const unsigned int tasks = 1024;
+	atomic<unsigned int> done = 0;
+
+	state.SetItemsPerIteration(tasks);
+	while (state.KeepRunning())
+	{
+		done = 0;
+		for (unsigned int i = 0; i < tasks; i++)
+		{
+			threading->AddTask([&done]() { done.fetch_add(1, memory_order_relaxed); });
+		}
+		threading->Task_Wait([&done, tasks]() { return done.load(memory_order_relaxed) == tasks; });
+	}
+}
+
+MICRO_BENCHMARK(Threading_ParallelFor)
+{
+	auto threading = _MicroBenchmarks::GetThreading();
+	vector<float> values(65536, 1.0f);
+
+	state.SetItemsPerIteration(values.size());
+	while (state.KeepRunning())
+	{
+		threading->Parallel_For(0, (unsigned int)values.size(), 1024, [&values](unsigned int start, unsigned int end)
+		{
+			for (unsigned int i = start; i < end; i++) values[i] = values[i] * 1.0001f + 0.5f;
+		});
+	}
+	DoNotOptimize(values.data());
+}
+//==============================================================================================================
+
+//= EVENTS =====================================================================================================
+MICRO_BENCHMARK(EventSystem_Fire)
+{
+	// There is no engine around, so the only subscribers of the event are these
+	static unsigned int fired = 0;
+	static bool subscribed = []()
+	{
+		for (unsigned int i = 0; i < 8; i++)
+		{
+			SUBSCRIBE_TO_EVENT(EVENT_FRAME_END, EVENT_HANDLER_STATIC([]() { fired++; }));
+		}
+		return true;
+	}();
+	DoNotOptimize(subscribed);
+
+	while (state.KeepRunning())
+	{
+		FIRE_EVENT(EVENT_FRAME_END);
+	}
+	DoNotOptimize(fired);
+}
+
+MICRO_BENCHMARK(EventSystem_FireData)
+{
+	static float total = 0.0f;
+	static bool subscribed = []()
+	{
+		for (unsigned int i = 0; i < 8; i++)
+		{
+			SUBSCRIBE_TO_EVENT(EVENT_TICK, EVENT_HANDLER_DATA_STATIC([](float deltaTime) { total += deltaTime; }));
+		}
+		return true;
+	}();
+	DoNotOptimize(subscribed);
+
+	while (state.KeepRunning())
+	{
+		FIRE_EVENT_DATA(EVENT_TICK, 0.016f);
+	}
+	DoNotOptimize(total);
+}
+//==============================================================================================================
+
+int MicroBenchmarks_Run(const string& filter, const string& outputPath)
+{
+	struct Result
+	{
+		string name;
+		double nsMin;
+		double nsMedian;
+		uint64_t iterations;
+	};
+	vector<Result> results;
+
+	printf("%-32s %14s %14s %14s\n", "Benchmark", "Fastest", "Median", "Iterations");
+	for (const auto& benchmark : MicroBenchmarks_Get())
+	{
+		if (!filter.empty() && benchmark.name.find(filter) == string::npos)
+			continue;
+
+		// Doubles the batch until it takes long enough for the clock to be precise
+		uint64_t iterations = 1;
+		while (true)
+		{
+			MicroBenchmark_State state(iterations);
+			benchmark.function(state);
+			if (state.GetElapsedNs() >= MICRO_BENCHMARK_BATCH_MS * 1000000.0 || iterations >= (1ULL << 40))
+				break;
+			iterations *= 2;
+		}
+
+		vector<double> runs;
+		for (unsigned int i = 0; i < MICRO_BENCHMARK_REPETITIONS; i++)
+		{
+			MicroBenchmark_State state(iterations);
+			benchmark.function(state);
+			runs.emplace_back(state.GetElapsedNs() / (double)(iterations * state.GetItemsPerIteration()));
+		}
+		sort(runs.begin(), runs.end());
+
+		results.push_back({ benchmark.name, runs.front(), runs[runs.size() / 2], iterations });
+		printf("%-32s %11.2f ns %11.2f ns %14llu\n", benchmark.name.c_str(), runs.front(), runs[runs.size() / 2], (unsigned long long)iterations);
+	}
+
+	if (outputPath.empty())
+		return 0;
+
+	// Per item, what a before and after comparison goes by
+	ofstream file(outputPath, ios::out | ios::trunc);
+	if (!file.is_open())
+	{
+		printf("Failed to write \"%s\"\n", outputPath.c_str());
+		return 1;
+	}
+	file << "[\n";
+	char line[256];
+	for (unsigned int i = 0; i < (unsigned int)results.size(); i++)
+	{
+		const auto& result = results[i];
+		snprintf(line, sizeof(line), "\t{ \"name\": \"%s\", \"ns_min\": %.4f, \"ns_median\": %.4f, \"iterations\": %llu }%s\n",
+			result.name.c_str(), result.nsMin, result.nsMedian, (unsigned long long)result.iterations, i + 1 < results.size() ? "," : "");
+		file << line;
+	}
+	file << "]\n";
+
+	return 0;
+}
@@ -0,0 +1,661 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+//= INCLUDES =================================
+#include "Window.h"
+#include "Core/Engine.h"
+#include "Core/Context.h"
+#include "Core/Stopwatch.h"
+#include "Core/Settings.h"
+#include "World/World.h"
+#include "World/Actor.h"
+#include "World/Components/Camera.h"
+#include "World/Components/Transform.h"
+#include "World/Components/Renderable.h"
+#include "World/Components/Light.h"
+#include "Rendering/Renderer.h"
+#include "RHI/RHI_Device.h"
+#include "RHI/RHI_Capture.h"
+#include "Profiling/Profiler.h"
+#include "Profiling/MemoryTracker.h"
+#include "Logging/Log.h"
+#include "MicroBenchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+//============================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Directus;
+using namespace Math;
+using namespace Helper;
+//=======================
+
+// Loads a world, moves it's camera along a path for a number of frames and writes what it measured as JSON:
+//	Benchmark.exe -world <file> [-frames 600] [-warmup 60] [-path <file>] [-output benchmark.json] [-headless]
+//	Benchmark.exe -micro [-filter <name>] [-output micro_benchmark.json]
+//	Benchmark.exe -calibrate [-world <file>] [-budget 16.6] [-frames 600] [-warmup 60] [-output calibration.json]
+//	Benchmark.exe -replay <iterations> [-world <file>] [-frames 1] [-warmup 60] [-capture <file>] [-output replay.json]
+// Every frame advances the simulation by the same time (see Engine_Benchmark), so runs of the same scene and path can be
+// compared frame for frame. A path file has a "x y z pitch yaw" key per line (degrees), spread evenly over the frames,
+// without one the camera circles the origin at the distance and height it starts at.
+// With -micro there is no engine, it runs the micro benchmarks instead (see MicroBenchmarks.cpp), only the ones with
+// names containing the filter if there is one.
+// With -calibrate it renders the quality presets from the most expensive down, each for the frames, and keeps the first one
+// whose 95th percentile GPU time fits the budget (in ms) as this GPU's settings (see Settings::Quality_Set). Without a world
+// it calibrates on a standard scene, so runs on different adapters are comparable.
+// With -replay it records the RHI calls of the frames once (see RHI_Capture) and then submits only those, the iterations
+// times over, without ticking the engine. What's measured is the RHI's CPU cost and the GPU's cost of the frames, free of
+// the simulation and the renderer's culling and sorting. The capture can be saved, to diff the command streams of two builds.
+
+#define CALIBRATION_HEADROOM 0.85f // a preset that leaves less of the budget than this gets dynamic resolution to absorb spikes
+
+MEMORY_TRACKING_OPERATORS()
+
+namespace _Benchmark
+{
+	struct Options
+	{
+		string world;
+		string path;
+		string output;
+		string filter;
+		unsigned int frames	= 600;
+		unsigned int warmup	= 60;
+		string capture;
+		float budget		= 16.6f;
+		unsigned int replay	= 0;
+		bool headless		= false;
+		bool micro			= false;
+		bool calibrate		= false;
+	};
+
+	struct Key
+	{
+		Vector3 position;
+		Vector3 rotation; // pitch, yaw, roll in degrees
+	};
+
+	// A value of every measured frame
+	struct Series
+	{
+		vector<float> samples;
+
+		void Add(float value) { samples.emplace_back(value); }
+
+		float Percentile(float percentile) const
+		{
+			if (samples.empty())
+				return 0.0f;
+
+			vector<float> sorted = samples;
+			sort(sorted.begin(), sorted.end());
+			auto rank = (size_t)ceil(percentile * sorted.size());
+			return sorted[rank > 0 ? rank - 1 : 0];
+		}
+
+		string ToJson() const
+		{
+			if (samples.empty())
+				return "{}";
+
+			vector<float> sorted = samples;
+			sort(sorted.begin(), sorted.end());
+			double sum = 0.0;
+			for (float sample : sorted) sum += sample;
+
+			char json[256];
+			snprintf(json, sizeof(json), "{ \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+				sum / sorted.size(), Percentile(0.50f), Percentile(0.95f), Percentile(0.99f), sorted.back());
+			return json;
+		}
+	};
+
+	bool Options_Parse(int argc, char** argv, Options* options)
+	{
+		bool framesGiven = false;
+		for (int i = 1; i < argc; i++)
+		{
+			string argument	= argv[i];
+			bool hasValue	= i + 1 < argc;
+
+			if (argument == "-world" && hasValue)			options->world		= argv[++i];
+			else if (argument == "-path" && hasValue)		options->path		= argv[++i];
+			else if (argument == "-output" && hasValue)		options->output		= argv[++i];
+			else if (argument == "-frames" && hasValue)		{ options->frames = (unsigned int)max(1, atoi(argv[++i])); framesGiven = true; }
+			else if (argument == "-warmup" && hasValue)		options->warmup		= (unsigned int)max(0, atoi(argv[++i]));
+			else if (argument == "-filter" && hasValue)		options->filter		= argv[++i];
+			else if (argument == "-budget" && hasValue)		options->budget		= max(1.0f, (float)atof(argv[++i]));
+			else if (argument == "-replay" && hasValue)		options->replay		= (unsigned int)max(1, atoi(argv[++i]));
+			else if (argument == "-capture" && hasValue)	options->capture	= argv[++i];
+			else if (argument == "-calibrate")				options->calibrate	= true;
+			else if (argument == "-headless")				options->headless	= true;
+			else if (argument == "-micro")					options->micro		= true;
+			else
+			{
+				printf("Unknown argument \"%s\"\n", argument.c_str());
+				return false;
+			}
+		}
+
+		if (options->world.empty() && !options->micro && !options->calibrate && !options->replay)
+		{
+			printf("Usage: Benchmark -world <file> [-frames 600] [-warmup 60] [-path <file>] [-output benchmark.json] [-headless]\n");
+			printf("       Benchmark -micro [-filter <name>] [-output micro_benchmark.json]\n");
+			printf("       Benchmark -calibrate [-world <file>] [-budget 16.6] [-frames 600] [-warmup 60] [-output calibration.json]\n");
+			printf("       Benchmark -replay <iterations> [-world <file>] [-frames 1] [-warmup 60] [-capture <file>] [-output replay.json]\n");
+			return false;
+		}
+
+		if (options->calibrate && options->headless)
+		{
+			printf("Calibrating measures the GPU, it can't run headless\n");
+			return false;
+		}
+
+		if (options->replay && (options->headless || options->calibrate))
+		{
+			printf("Replaying submits to the GPU, it can't run headless or calibrate\n");
+			return false;
+		}
+
+		// Every command of every frame is kept, with the data of every buffer update, so a capture is one frame unless asked otherwise
+		if (options->replay && !framesGiven)
+		{
+			options->frames = 1;
+		}
+
+		if (options->output.empty())
+		{
+			options->output = options->micro ? "micro_benchmark.json" : (options->calibrate ? "calibration.json" : (options->replay ? "replay.json" : "benchmark.json"));
+		}
+
+		return true;
+	}
+
+	bool Path_Load(const string& filePath, vector<Key>* keys)
+	{
+		ifstream file(filePath);
+		if (!file.is_open())
+			return false;
+
+		string line;
+		while (getline(file, line))
+		{
+			Key key;
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			if (sscanf(line.c_str(), "%f %f %f %f %f", &key.position.x, &key.position.y, &key.position.z, &key.rotation.x, &key.rotation.y) == 5)
+			{
+				keys->emplace_back(key);
+			}
+		}
+
+		return !keys->empty();
+	}
+
+	// Where the camera is at a point of the path, from 0 to 1
+	void Path_Apply(Transform* camera, const vector<Key>& keys, const Vector3& orbitStart, float t)
+	{
+		if (keys.empty())
+		{
+			float radius	= max(Vector3(orbitStart.x, 0.0f, orbitStart.z).Length(), 10.0f);
+			float angle		= t * PI_2;
+			Vector3 position(cos(angle) * radius, orbitStart.y, sin(angle) * radius);
+			camera->SetPosition(position);
+			camera->SetRotation(Quaternion::FromLookRotation((Vector3::Zero - position).Normalized()));
+			return;
+		}
+
+		float at		= t * (float)(keys.size() - 1);
+		auto index		= min((size_t)at, keys.size() - 1);
+		auto next		= min(index + 1, keys.size() - 1);
+		float blend		= at - (float)index;
+		camera->SetPosition(Lerp(keys[index].position, keys[next].position, blend));
+		camera->SetRotation(Quaternion::FromEulerAngles(Lerp(keys[index].rotation, keys[next].rotation, blend)));
+	}
+
+	// Rows of spheres and cubes on a floor, lit by point lights and the World's directional light, seen from where the camera orbits
+	void Scene_CreateStandard(World* world, Transform* camera)
+	{
+		auto Add = [world](const string& name, GeometryType geometry, const Vector3& position, const Vector3& scale)
+		{
+			auto actor = world->Actor_Create();
+			actor->SetName(name);
+			actor->GetTransform_PtrRaw()->SetPosition(position);
+			actor->GetTransform_PtrRaw()->SetScale(scale);
+			auto renderable = actor->AddComponent<Renderable>();
+			renderable->Geometry_Set(geometry);
+			renderable->Material_UseDefault();
+		};
+
+		Add("Floor", Geometry_Default_Cube, Vector3(0.0f, -0.5f, 0.0f), Vector3(60.0f, 1.0f, 60.0f));
+		for (int x = -6; x <= 6; x++)
+		{
+			for (int z = -6; z <= 6; z++)
+			{
+				bool sphere = (x + z) % 2 == 0;
+				Add(sphere ? "Sphere" : "Cube", sphere ? Geometry_Default_Sphere : Geometry_Default_Cube, Vector3(x * 3.0f, 1.0f, z * 3.0f), Vector3(1.5f, 2.0f, 1.5f));
+			}
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			float angle	= i * PI_2 / 16.0f;
+			auto actor	= world->Actor_Create();
+			actor->SetName("PointLight");
+			actor->GetTransform_PtrRaw()->SetPosition(Vector3(cos(angle) * 12.0f, 3.0f, sin(angle) * 12.0f));
+			auto light = actor->AddComponent<Light>();
+			light->SetLightType(LightType_Point);
+			light->SetRange(10.0f);
+			light->SetIntensity(2.0f);
+			light->SetColor(0.5f + 0.5f * cos(angle), 0.5f + 0.5f * sin(angle), 1.0f, 1.0f);
+		}
+
+		if (camera)
+		{
+			camera->SetPosition(Vector3(0.0f, 6.0f, -20.0f));
+		}
+	}
+
+	string Escape(const string& text)
+	{
+		string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	_Benchmark::Options options;
+	if (!_Benchmark::Options_Parse(argc, argv, &options))
+		return 1;
+
+	if (options.micro)
+		return MicroBenchmarks_Run(options.filter, options.output);
+
+	// Headless there is no window or renderer, what's measured is the simulation
+	if (options.headless)
+	{
+		Engine::EngineMode_Enable(Engine_Headless);
+	}
+	else
+	{
+		Window::g_OnMessage	= [](HWND, UINT, WPARAM, LPARAM) { return (LRESULT)0; };
+		Window::g_onResize	= [](int, int) {};
+		if (!Window::Create(GetModuleHandle(nullptr), "Directus Benchmark"))
+			return 1;
+		Window::Show();
+		Engine::SetHandles(Window::g_handle, Window::g_handle, GetModuleHandle(nullptr));
+	}
+
+	Engine::EngineMode_Enable(Engine_Benchmark);
+	auto engine = make_unique<Engine>(new Context);
+	if (!engine->Initialize())
+		return 1;
+
+	// A replay submits from this thread, nothing else may be rendering
+	if (options.replay)
+	{
+		Engine::EngineMode_Disable(Engine_Pipelined);
+	}
+
+	auto context	= engine->GetContext();
+	auto world		= context->GetSubsystem<World>();
+	auto renderer	= context->GetSubsystem<Renderer>();
+	if (renderer)
+	{
+		renderer->SetBackBufferSize(Window::GetWidth(), Window::GetHeight());
+	}
+
+	if (!options.world.empty() && !world->LoadFromFile(options.world))
+	{
+		printf("Failed to load \"%s\"\n", options.world.c_str());
+		return 1;
+	}
+
+	vector<_Benchmark::Key> keys;
+	if (!options.path.empty() && !_Benchmark::Path_Load(options.path, &keys))
+	{
+		printf("Failed to load the camera path \"%s\"\n", options.path.c_str());
+		return 1;
+	}
+
+	Transform* camera = nullptr;
+	for (const auto& actor : world->Actors_GetAll())
+	{
+		if (actor->GetComponent_PtrRaw<Camera>())
+		{
+			camera = actor->GetTransform_PtrRaw();
+			break;
+		}
+	}
+	if (options.world.empty())
+	{
+		_Benchmark::Scene_CreateStandard(world, camera);
+	}
+	Vector3 orbitStart = camera ? camera->GetPosition() : Vector3::Zero;
+
+	// What's measured per frame
+	_Benchmark::Series frameMs, cpuMs, gpuMs, drawCalls, bindings, allocations;
+	map<string, _Benchmark::Series> passesCPU, passesGPU;
+	auto Tick = [&](unsigned int frame, unsigned int frames)
+	{
+		if (camera)
+		{
+			_Benchmark::Path_Apply(camera, keys, orbitStart, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+		}
+
+		auto frameStart = chrono::steady_clock::now();
+		Stopwatch stopwatch;
+		if (!options.headless)
+		{
+			Window::Tick();
+		}
+		engine->Tick();
+		if (renderer && !Engine::EngineMode_IsSet(Engine_Pipelined))
+		{
+			renderer->Present();
+		}
+		return make_pair(stopwatch.GetElapsedTimeMs(), frameStart);
+	};
+
+	// The most expensive preset first, what's left of the budget afterwards decides on dynamic resolution
+	if (options.calibrate && renderer)
+	{
+		Quality picked			= Quality_Low;
+		bool fits				= false;
+		float pickedMs			= 0.0f;
+		string presetsJson;
+		for (int quality = Quality_Count - 1; quality >= 0 && !fits; quality--)
+		{
+			renderer->Quality_Apply((Quality)quality, options.budget, false);
+			for (unsigned int i = 0; i < options.warmup; i++)
+			{
+				Tick(0, 1);
+			}
+
+			_Benchmark::Series gpu;
+			map<string, _Benchmark::Series> passes;
+			for (unsigned int frame = 0; frame < options.frames; frame++)
+			{
+				Tick(frame, options.frames);
+				gpu.Add(Profiler::Get().GetRenderTime_GPU());
+				for (const auto& block : Profiler::Get().GetTimeBlocks_GPU())
+				{
+					passes[block.first].Add(block.second.duration);
+				}
+			}
+
+			float gpuMs	= gpu.Percentile(0.95f);
+			fits		= gpuMs <= options.budget;
+			picked		= fits ? (Quality)quality : Quality_Low;
+			pickedMs	= gpuMs;
+			printf("%s: %.2f ms on the GPU (p95), %s the %.1f ms budget\n", Renderer::Quality_GetName((Quality)quality), gpuMs, fits ? "fits" : "exceeds", options.budget);
+
+			// What each pass costs, to tell what made a preset miss
+			presetsJson += presetsJson.empty() ? "" : ",\n";
+			presetsJson += string("\t\t\"") + Renderer::Quality_GetName((Quality)quality) + "\": {\n";
+			presetsJson += "\t\t\t\"render_gpu_ms\": " + gpu.ToJson() + ",\n";
+			presetsJson += "\t\t\t\"passes_gpu_ms\": {\n";
+			for (auto it = passes.begin(); it != passes.end(); it++)
+			{
+				presetsJson += "\t\t\t\t\"" + _Benchmark::Escape(it->first) + "\": " + it->second.ToJson() + (next(it) != passes.end() ? ",\n" : "\n");
+			}
+			presetsJson += "\t\t\t}\n\t\t}";
+		}
+
+		// Even the cheapest preset missing the budget leaves it to dynamic resolution
+		bool dynamicResolution = !fits || pickedMs > options.budget * CALIBRATION_HEADROOM;
+		renderer->Quality_Apply(picked, options.budget, dynamicResolution);
+		Settings::Get().Quality_Set(picked, options.budget, dynamicResolution);
+		Settings::Get().Save();
+
+		char line[512];
+		string json = "{\n";
+		snprintf(line, sizeof(line), "\t\"engine\": \"%s\",\n\t\"world\": \"%s\",\n\t\"gpu\": \"%s\",\n\t\"resolution\": [%d, %d],\n\t\"budget_ms\": %.2f,\n\t\"frames\": %u,\n",
+			ENGINE_VERSION, options.world.empty() ? "standard" : _Benchmark::Escape(options.world).c_str(), _Benchmark::Escape(Settings::Get().Gpu_GetName()).c_str(),
+			(int)Settings::Get().Resolution_GetWidth(), (int)Settings::Get().Resolution_GetHeight(), options.budget, options.frames);
+		json += line;
+		json += "\t\"presets\": {\n" + presetsJson + "\n\t},\n";
+		snprintf(line, sizeof(line), "\t\"picked\": \"%s\",\n\t\"dynamic_resolution\": %s\n}\n", Renderer::Quality_GetName(picked), dynamicResolution ? "true" : "false");
+		json += line;
+
+		ofstream file(options.output, ios::out | ios::trunc);
+		if (!file.is_open())
+		{
+			printf("Failed to write \"%s\"\n", options.output.c_str());
+			return 1;
+		}
+		file << json;
+		printf("Picked %s%s for \"%s\", written to \"%s\"\n", Renderer::Quality_GetName(picked), dynamicResolution ? " with dynamic resolution" : "", Settings::Get().Gpu_GetName().c_str(), options.output.c_str());
+
+		engine->Shutdown();
+		return 0;
+	}
+
+	for (unsigned int i = 0; i < options.warmup; i++)
+	{
+		Tick(0, 1);
+	}
+
+	// The frames get recorded once, after that only what was recorded is submitted, the engine doesn't tick anymore
+	if (options.replay && renderer)
+	{
+		auto device		= renderer->GetRHIDevice();
+		auto& capture	= RHI_Capture::Get();
+		capture.Begin(options.frames);
+		for (unsigned int frame = 0; !capture.IsDone() && frame <= options.frames * 2; frame++)
+		{
+			Tick(min(frame, options.frames - 1), options.frames);
+		}
+		if (!capture.IsDone() || capture.GetCommands().empty())
+		{
+			printf("Nothing was recorded, the renderer didn't render\n");
+			return 1;
+		}
+
+		if (!options.capture.empty() && !capture.Save(options.capture))
+		{
+			printf("Failed to write \"%s\"\n", options.capture.c_str());
+			return 1;
+		}
+
+		// GPU durations are read a few iterations late (the queries aren't waited on), the ones not read yet are 0
+		void* queryDisjoint	= nullptr;
+		void* queryStart	= nullptr;
+		void* queryEnd		= nullptr;
+		device->Profiling_CreateQuery(&queryDisjoint, Query_Timestamp_Disjoint);
+		device->Profiling_CreateQuery(&queryStart, Query_Timestamp);
+		device->Profiling_CreateQuery(&queryEnd, Query_Timestamp);
+
+		_Benchmark::Series replayCPU, replayGPU;
+		for (unsigned int iteration = 0; iteration < options.replay; iteration++)
+		{
+			Window::Tick();
+
+			Stopwatch stopwatch;
+			device->Profiling_QueryStart(queryDisjoint);
+			device->Profiling_GetTimeStamp(queryStart);
+			capture.Replay(device.get());
+			device->Profiling_GetTimeStamp(queryEnd);
+			device->Profiling_QueryEnd(queryDisjoint);
+			replayCPU.Add(stopwatch.GetElapsedTimeMs());
+			device->Present();
+
+			float gpu = device->Profiling_GetDuration(queryDisjoint, queryStart, queryEnd);
+			if (gpu > 0.0f)
+			{
+				replayGPU.Add(gpu);
+			}
+		}
+
+		string json = "{\n";
+		char line[512];
+		snprintf(line, sizeof(line), "\t\"engine\": \"%s\",\n\t\"world\": \"%s\",\n\t\"gpu\": \"%s\",\n\t\"resolution\": [%d, %d],\n\t\"frames\": %u,\n\t\"iterations\": %u,\n\t\"commands\": %u,\n",
+			ENGINE_VERSION, options.world.empty() ? "standard" : _Benchmark::Escape(options.world).c_str(), _Benchmark::Escape(Settings::Get().Gpu_GetName()).c_str(),
+			(int)Settings::Get().Resolution_GetWidth(), (int)Settings::Get().Resolution_GetHeight(), capture.GetFrameCount(), options.replay, (unsigned int)capture.GetCommands().size());
+		json += line;
+		json += "\t\"replay_cpu_ms\": " + replayCPU.ToJson() + ",\n";
+		json += "\t\"replay_gpu_ms\": " + replayGPU.ToJson() + ",\n";
+		json += "\t\"ops\": {\n";
+		bool first = true;
+		for (unsigned int op = 0; op < Capture_Op_Count; op++)
+		{
+			auto count = capture.GetCount((Capture_Op)op);
+			if (count == 0)
+				continue;
+
+			snprintf(line, sizeof(line), "%s\t\t\"%s\": %u", first ? "" : ",\n", RHI_Capture::GetName((Capture_Op)op), count);
+			json += line;
+			first = false;
+		}
+		json += "\n\t}\n}\n";
+
+		ofstream file(options.output, ios::out | ios::trunc);
+		if (!file.is_open())
+		{
+			printf("Failed to write \"%s\"\n", options.output.c_str());
+			return 1;
+		}
+		file << json;
+		printf("%u commands replayed %u times, written to \"%s\", %s ms on the CPU\n", (unsigned int)capture.GetCommands().size(), options.replay, options.output.c_str(), replayCPU.ToJson().c_str());
+
+		capture.Clear();
+		engine->Shutdown();
+		return 0;
+	}
+
+	for (unsigned int frame = 0; frame < options.frames; frame++)
+	{
+		auto result = Tick(frame, options.frames);
+
+		auto& profiler = Profiler::Get();
+		frameMs.Add(result.first);
+		cpuMs.Add(profiler.GetRenderTime_CPU());
+		gpuMs.Add(profiler.GetRenderTime_GPU());
+		drawCalls.Add((float)profiler.m_rhiDrawCalls.load());
+		bindings.Add((float)(profiler.m_rhiBindingsBufferIndex + profiler.m_rhiBindingsBufferVertex + profiler.m_rhiBindingsBufferConstant + profiler.m_rhiBindingsSampler +
+			profiler.m_rhiBindingsTexture + profiler.m_rhiBindingsVertexShader + profiler.m_rhiBindingsPixelShader + profiler.m_rhiBindingsRenderTarget));
+
+		// The blocks of this frame, the longest of the threads that ran one
+		map<const char*, float> blocks;
+		for (const auto& thread : profiler.GetTimeBlocks_CPU())
+		{
+			for (const auto& block : thread.blocks)
+			{
+				if (block.second.end >= result.second)
+				{
+					blocks[block.first] = max(blocks[block.first], block.second.duration);
+				}
+			}
+		}
+		for (const auto& block : blocks)
+		{
+			passesCPU[block.first].Add(block.second);
+		}
+		for (const auto& block : profiler.GetTimeBlocks_GPU())
+		{
+			passesGPU[block.first].Add(block.second.duration);
+		}
+
+		unsigned int allocationsFrame = 0;
+		for (unsigned int tag = 0; tag < MemoryTag_Count; tag++)
+		{
+			allocationsFrame += MemoryTracker::GetStats((MemoryTag)tag).allocationsFrame;
+		}
+		allocations.Add((float)allocationsFrame);
+	}
+
+	// Memory, at the end of the run
+	auto ToMB = [](unsigned long long bytes) { return (double)bytes / (1024.0 * 1024.0); };
+	auto device = renderer ? renderer->GetRHIDevice() : nullptr;
+	size_t heapLive = 0, heapPeak = 0;
+	for (unsigned int tag = 0; tag < MemoryTag_Count; tag++)
+	{
+		auto stats	= MemoryTracker::GetStats((MemoryTag)tag);
+		heapLive	+= stats.bytesLive;
+		heapPeak	+= stats.bytesPeak;
+	}
+
+	string json;
+	char line[512];
+	auto Append = [&json, &line](const char* format, auto... values)
+	{
+		snprintf(line, sizeof(line), format, values...);
+		json += line;
+	};
+	auto AppendPasses = [&json](const char* name, const map<string, _Benchmark::Series>& passes)
+	{
+		json += string("\t\"") + name + "\": {\n";
+		for (auto it = passes.begin(); it != passes.end(); it++)
+		{
+			json += "\t\t\"" + _Benchmark::Escape(it->first) + "\": " + it->second.ToJson() + (next(it) != passes.end() ? ",\n" : "\n");
+		}
+		json += "\t},\n";
+	};
+
+	json += "{\n";
+	Append("\t\"engine\": \"%s\",\n", ENGINE_VERSION);
+	Append("\t\"world\": \"%s\",\n", _Benchmark::Escape(options.world).c_str());
+	Append("\t\"path\": \"%s\",\n", keys.empty() ? "orbit" : _Benchmark::Escape(options.path).c_str());
+	Append("\t\"headless\": %s,\n", options.headless ? "true" : "false");
+	Append("\t\"gpu\": \"%s\",\n", renderer ? _Benchmark::Escape(Settings::Get().Gpu_GetName()).c_str() : "none");
+	Append("\t\"resolution\": [%d, %d],\n", (int)Settings::Get().Resolution_GetWidth(), (int)Settings::Get().Resolution_GetHeight());
+	Append("\t\"frames\": %u,\n", options.frames);
+	json += "\t\"frame_ms\": " + frameMs.ToJson() + ",\n";
+	json += "\t\"render_cpu_ms\": " + cpuMs.ToJson() + ",\n";
+	json += "\t\"render_gpu_ms\": " + gpuMs.ToJson() + ",\n";
+	AppendPasses("passes_cpu_ms", passesCPU);
+	AppendPasses("passes_gpu_ms", passesGPU);
+	json += "\t\"draw_calls\": " + drawCalls.ToJson() + ",\n";
+	json += "\t\"bindings\": " + bindings.ToJson() + ",\n";
+	json += "\t\"memory\": {\n";
+	Append("\t\t\"gpu_mb\": %.2f,\n", device ? ToMB(device->Memory_GetUsage()) : 0.0);
+	Append("\t\t\"heap_tracked\": %s,\n", MemoryTracker::IsEnabled() ? "true" : "false");
+	Append("\t\t\"heap_mb\": %.2f,\n", ToMB(heapLive));
+	Append("\t\t\"heap_peak_mb\": %.2f,\n", ToMB(heapPeak));
+	json += "\t\t\"allocations_per_frame\": " + allocations.ToJson() + "\n";
+	json += "\t}\n";
+	json += "}\n";
+
+	ofstream file(options.output, ios::out | ios::trunc);
+	if (!file.is_open())
+	{
+		printf("Failed to write \"%s\"\n", options.output.c_str());
+		return 1;
+	}
+	file << json;
+	printf("%u frames written to \"%s\", %s ms per frame\n", options.frames, options.output.c_str(), frameMs.ToJson().c_str());
+
+	engine->Shutdown();
+	return 0;
+}
@@ -2,8 +2,10 @@ WIN_SDK_VERSION 	= "10.0.17134.0"
 SOLUTION_NAME 		= "Directus"
 EDITOR_NAME 		= "Editor"
 RUNTIME_NAME 		= "Runtime"
+BENCHMARK_NAME 		= "Benchmark"
 EDITOR_DIR			= "../" .. EDITOR_NAME
 RUNTIME_DIR			= "../" .. RUNTIME_NAME
+BENCHMARK_DIR		= "../" .. BENCHMARK_NAME
 TARGET_DIR_RELEASE 	= "../Binaries/Release"
 TARGET_DIR_DEBUG 	= "../Binaries/Debug"
 OBJ_DIR 			= "../Binaries/Obj"
@@ -36,6 +38,9 @@ CPP_VERSION 		= "C++17"
 	includedirs { "../ThirdParty/FreeImage_3.18.0" }
 	includedirs { "../ThirdParty/FreeType_2.9.1" }
 	includedirs { "../ThirdParty/pugixml_1.9" }
+
+-- The Bullet libraries are built thread safe, the headers have to agree
+	defines { "BT_THREADSAFE=1" }
 	
 -- Library directory
 	libdirs { "C:/VulkanSDK/1.1.82.0/Lib" }
@@ -110,6 +115,47 @@ CPP_VERSION 		= "C++17"
 		objdir (OBJ_DIR)
 		debugdir (TARGET_DIR_DEBUG)
 
+	configuration "Release"
+		targetdir (TARGET_DIR_RELEASE)
+		objdir (OBJ_DIR)
+		debugdir (TARGET_DIR_RELEASE)
+
+ -- Benchmark -----------------------------------------------------------------------------------------------
+	project (BENCHMARK_NAME)
+		location (BENCHMARK_DIR)
+		kind "ConsoleApp"
+		language "C++"
+		files { "../Benchmark/**.h", "../Benchmark/**.cpp" }
+		links { RUNTIME_NAME }
+		dependson { RUNTIME_NAME }
+		systemversion(WIN_SDK_VERSION)
+		cppdialect (CPP_VERSION)
+
+-- Includes (the editor's for it's window)
+	includedirs { "../Runtime" }
+	includedirs { "../Editor" }
+
+-- Library directory
+	libdirs { "../ThirdParty/mvsc141_x64" }
+
+-- Debug configuration
+	filter "configurations:Debug"
+		defines { "DEBUG" }
+		symbols "On"
+		flags { "MultiProcessorCompile" }
+
+-- Release configuration
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		optimize "Full"
+		flags { "MultiProcessorCompile", "LinkTimeOptimization" }
+
+-- Output directories
+	configuration "Debug"
+		targetdir (TARGET_DIR_DEBUG)
+		objdir (OBJ_DIR)
+		debugdir (TARGET_DIR_DEBUG)
+
 	configuration "Release"
 		targetdir (TARGET_DIR_RELEASE)
 		objdir (OBJ_DIR)
@@ -22,7 +22,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ================================
 #include "Editor.h"
 #include "ImGui/imgui_impl_win32.h"
+#include "ImGui/imgui_impl_rhi.h"
+#include "Core/BackendConfig.h"
+#ifdef API_D3D11
 #include "ImGui/imgui_impl_dx11.h"
+#endif
 #include "UI/Widgets/Widget_MenuBar.h"
 #include "UI/Widgets/Widget_Properties.h"
 #include "UI/Widgets/Widget_Console.h"
@@ -33,6 +37,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "UI/Widgets/Widget_ProgressDialog.h"
 #include "UI/IconProvider.h"
 #include "UI/EditorHelper.h"
+#include "UI/UndoHistory.h"
+#include "UI/ImportQueue.h"
 #include "RHI/RHI_Device.h"
 #include "Rendering/Renderer.h"
 #include "ImGui/imgui_internal.h"
@@ -50,6 +56,17 @@ namespace _Editor
 	Widget* widget_toolbar		= nullptr;
 	Widget* widget_world		= nullptr;
 	const char* dockspaceName	= "EditorDockspace";
+
+	bool IsUserInteracting()
+	{
+		ImGuiIO& io = ImGui::GetIO();
+		if (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f || io.MouseWheel != 0.0f || io.InputCharacters[0] != 0)
+			return true;
+
+		for (bool down : io.MouseDown)	{ if (down) return true; }
+		for (bool down : io.KeysDown)	{ if (down) return true; }
+		return false;
+	}
 }
 
 Editor::Editor()
@@ -70,7 +87,7 @@ bool Editor::Initialize(Context* context, void* windowHandle)
 
 	Widgets_Create();
 
-	if (!m_rhiDevice->GetDevice<ID3D11Device>() || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+	if (!m_rhiDevice || !m_rhiDevice->IsInitialized())
 	{
 		LOG_ERROR("Editor::Initialize: Invalid RHI device.");
 		return false;
@@ -89,13 +106,22 @@ bool Editor::Initialize(Context* context, void* windowHandle)
 	io.ConfigFlags |= ImGuiConfigFlags_ViewportsNoTaskBarIcon;
 	io.ConfigResizeWindowsFromEdges = true;
 	
-	// ImGui backend setup
+	// ImGui backend setup, the main viewport is drawn by the engine's RHI
 	ImGui_ImplWin32_Init(windowHandle);
+	if (!ImGui_ImplRHI_Init(context))
+		return false;
+#ifdef API_D3D11
+	// Windows dragged out of the main one need swap chains of their own, the RHI only has the one
 	ImGui_ImplDX11_Init(m_rhiDevice->GetDevice<ID3D11Device>(), m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>());
+#else
+	io.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+#endif
 
 	// Initialization of misc custom systems
 	IconProvider::Get().Initialize(context);
 	EditorHelper::Get().Initialize(context);
+	UndoHistory::Get().Initialize(context);
+	ImportQueue::Get().Initialize(context);
 
 	// Apply style
 	ApplyStyle();
@@ -106,8 +132,10 @@ bool Editor::Initialize(Context* context, void* windowHandle)
 
 void Editor::Resize()
 {
+#ifdef API_D3D11
 	ImGui_ImplDX11_InvalidateDeviceObjects();
 	ImGui_ImplDX11_CreateDeviceObjects();
+#endif
 }
 
 void Editor::Tick(float deltaTime)
@@ -116,18 +144,45 @@ void Editor::Tick(float deltaTime)
 		return;
 
 	// ImGui implementation - start frame
+#ifdef API_D3D11
 	ImGui_ImplDX11_NewFrame();
+#endif
+	ImGui_ImplRHI_NewFrame();
 	ImGui_ImplWin32_NewFrame();
 	ImGui::NewFrame();
 
+	// With the world rendered on demand, any input can change what the viewport shows (picking, gizmos, inspector edits)
+	if (_Editor::IsUserInteracting())
+	{
+		m_context->GetSubsystem<Renderer>()->RenderOnDemand_Request();
+	}
+
+	// Undo/redo, unless a text field has the keyboard (it has an undo of its own)
+	ImGuiIO& io = ImGui::GetIO();
+	if (io.KeyCtrl && !io.WantTextInput)
+	{
+		bool redo = ImGui::IsKeyPressed('Y') || (io.KeyShift && ImGui::IsKeyPressed('Z'));
+		if (redo)							{ UndoHistory::Get().Redo(); }
+		else if (ImGui::IsKeyPressed('Z'))	{ UndoHistory::Get().Undo(); }
+	}
+
+	// Imports that finished since the last frame
+	ImportQueue::Get().Tick();
+
 	// Editor update
 	Widgets_Tick(deltaTime);
 
+	// A drag (or typing into a field) is one edit for as long as the widget stays active
+	if (!ImGui::IsAnyItemActive())
+	{
+		UndoHistory::Get().Edit_End();
+	}
+
 	// ImGui implementation - end frame
 	ImGui::Render();
 
 	m_rhiDevice->EventBegin("Pass_ImGui");
-	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+	ImGui_ImplRHI_RenderDrawData(ImGui::GetDrawData());
 	m_rhiDevice->EventEnd();
 
 	// Update and Render additional Platform Windows
@@ -147,7 +202,10 @@ void Editor::Shutdown()
 	m_widgets.shrink_to_fit();
 
 	// ImGui implementation - shutdown
+#ifdef API_D3D11
 	ImGui_ImplDX11_Shutdown();
+#endif
+	ImGui_ImplRHI_Shutdown();
 	ImGui_ImplWin32_Shutdown();
 	ImGui::DestroyContext();
 }
@@ -0,0 +1,330 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "imgui_impl_rhi.h"
+#include "imgui.h"
+#include "Core/Context.h"
+#include "Rendering/Renderer.h"
+#include "RHI/RHI_Device.h"
+#include "RHI/RHI_Pipeline.h"
+#include "RHI/RHI_PipelineCache.h"
+#include "RHI/RHI_PipelineState.h"
+#include "RHI/RHI_Shader.h"
+#include "RHI/RHI_Sampler.h"
+#include "RHI/RHI_Texture.h"
+#include "RHI/RHI_VertexBuffer.h"
+#include "RHI/RHI_IndexBuffer.h"
+#include "RHI/RHI_CommonBuffers.h"
+#include "RHI/RHI_Vertex.h"
+#include "Resource/ResourceManager.h"
+#include "Profiling/Profiler.h"
+#include "Logging/Log.h"
+#include "Math/MathHelper.h"
+//==============================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Directus;
+using namespace Directus::Math;
+//=======================
+
+#define IMGUI_RHI_VERTICES_INITIAL	8192	// the rings double whenever a frame doesn't fit
+#define IMGUI_RHI_INDICES_INITIAL	16384
+
+static_assert(sizeof(ImDrawVert) == sizeof(RHI_Vertex_Pos2DUVCol8), "ImDrawVert doesn't match RHI_Vertex_Pos2DUVCol8");
+
+namespace _ImGui_ImplRHI
+{
+	Context* context		= nullptr;
+	Renderer* renderer		= nullptr;
+	shared_ptr<RHI_Device> rhiDevice;
+	shared_ptr<RHI_Shader> shader;
+	shared_ptr<RHI_Sampler> sampler;
+	shared_ptr<RHI_PipelineState> state;
+	shared_ptr<RHI_Texture> fontTexture;
+
+	// Rings which persist across frames, a frame is appended after the last one and they start over (discarding) once full
+	shared_ptr<RHI_VertexBuffer> vertexBuffer;
+	shared_ptr<RHI_IndexBuffer> indexBuffer;
+	unsigned int vertexCapacity	= 0;
+	unsigned int vertexCursor	= 0;
+	unsigned int indexCapacity	= 0;
+	unsigned int indexCursor	= 0;
+
+	// Consecutive commands which only differ in their index range (draw lists included)
+	struct Batch
+	{
+		ImTextureID texture	= nullptr;
+		ImVec4 clip			= ImVec4(0, 0, 0, 0);
+		unsigned int offset	= 0;
+		unsigned int count	= 0;
+	};
+
+	bool Buffers_Reserve(unsigned int vertexCount, unsigned int indexCount)
+	{
+		if (vertexCount > vertexCapacity || !vertexBuffer)
+		{
+			vertexCapacity = Math::Helper::Max(vertexCapacity, (unsigned int)IMGUI_RHI_VERTICES_INITIAL);
+			while (vertexCapacity < vertexCount) { vertexCapacity *= 2; }
+			vertexBuffer = make_shared<RHI_VertexBuffer>(rhiDevice);
+			if (!vertexBuffer->CreateDynamic(sizeof(RHI_Vertex_Pos2DUVCol8), vertexCapacity))
+			{
+				vertexBuffer = nullptr;
+				return false;
+			}
+			vertexCursor = vertexCapacity;
+		}
+
+		if (indexCount > indexCapacity || !indexBuffer)
+		{
+			indexCapacity = Math::Helper::Max(indexCapacity, (unsigned int)IMGUI_RHI_INDICES_INITIAL);
+			while (indexCapacity < indexCount) { indexCapacity *= 2; }
+			indexBuffer = make_shared<RHI_IndexBuffer>(rhiDevice);
+			if (!indexBuffer->CreateDynamic(indexCapacity))
+			{
+				indexBuffer = nullptr;
+				return false;
+			}
+			indexCursor = indexCapacity;
+		}
+
+		return true;
+	}
+
+	// Copies the frame into the rings, indices are rebased to the frame's first vertex so any run of commands is one draw
+	bool Buffers_Upload(ImDrawData* drawData)
+	{
+		auto vertexCount	= (unsigned int)drawData->TotalVtxCount;
+		auto indexCount		= (unsigned int)drawData->TotalIdxCount;
+		if (!Buffers_Reserve(vertexCount, indexCount))
+			return false;
+
+		bool vertexDiscard	= vertexCursor + vertexCount > vertexCapacity;
+		bool indexDiscard	= indexCursor + indexCount > indexCapacity;
+		if (vertexDiscard)	vertexCursor	= 0;
+		if (indexDiscard)	indexCursor		= 0;
+
+		auto vertices	= (ImDrawVert*)vertexBuffer->Map(vertexDiscard);
+		auto indices	= (uint32_t*)indexBuffer->Map(indexDiscard);
+		if (vertices && indices)
+		{
+			vertices		+= vertexCursor;
+			indices			+= indexCursor;
+			uint32_t base	= 0;
+			for (int i = 0; i < drawData->CmdListsCount; i++)
+			{
+				const ImDrawList* list = drawData->CmdLists[i];
+				memcpy(vertices, list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+				for (int j = 0; j < list->IdxBuffer.Size; j++)
+				{
+					indices[j] = base + (uint32_t)list->IdxBuffer.Data[j];
+				}
+				vertices	+= list->VtxBuffer.Size;
+				indices		+= list->IdxBuffer.Size;
+				base		+= (uint32_t)list->VtxBuffer.Size;
+			}
+		}
+		if (vertices)	vertexBuffer->Unmap();
+		if (indices)	indexBuffer->Unmap();
+
+		return vertices && indices;
+	}
+
+	bool Fonts_Create()
+	{
+		unsigned char* pixels	= nullptr;
+		int width				= 0;
+		int height				= 0;
+		ImGui::GetIO().Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+		if (!pixels)
+			return false;
+
+		vector<Mipmap> mipmaps;
+		mipmaps.emplace_back((std::byte*)pixels, (std::byte*)pixels + width * height * 4);
+
+		fontTexture = make_shared<RHI_Texture>(context);
+		if (!fontTexture->ShaderResource_Create2D(width, height, 4, Texture_Format_R8G8B8A8_UNORM, mipmaps, false))
+		{
+			LOG_ERROR("ImGui_ImplRHI: Failed to create the font atlas.");
+			fontTexture = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+}
+
+bool ImGui_ImplRHI_Init(Context* context)
+{
+	using namespace _ImGui_ImplRHI;
+
+	_ImGui_ImplRHI::context	= context;
+	renderer				= context->GetSubsystem<Renderer>();
+	rhiDevice				= renderer->GetRHIDevice();
+	if (!rhiDevice || !rhiDevice->IsInitialized())
+	{
+		LOG_ERROR("ImGui_ImplRHI_Init: Invalid RHI device.");
+		return false;
+	}
+
+	auto shaderDirectory = context->GetSubsystem<ResourceManager>()->GetStandardResourceDirectory(Resource_Shader);
+	shader = make_shared<RHI_Shader>(rhiDevice);
+	shader->Compile_VertexPixel(shaderDirectory + "ImGui.hlsl", Input_Position2DTextureColor8, context);
+	shader->AddBuffer<Struct_Matrix_Vector4>(0, Buffer_Global);
+
+	sampler = make_shared<RHI_Sampler>(rhiDevice, Texture_Sampler_Linear, Texture_Address_Wrap, Texture_Comparison_Always);
+
+	// Blended and not depth tested, back to front as ImGui submits it
+	RHI_PipelineState description;
+	description.primitiveTopology	= PrimitiveTopology_TriangleList;
+	description.cullMode			= Cull_None;
+	description.fillMode			= Fill_Solid;
+	description.blendMode			= Blend_Alpha;
+	description.depthWrite			= false;
+	description.vertexShader		= shader;
+	description.pixelShader			= shader;
+	description.constantBuffer		= shader->GetConstantBuffer();
+	description.sampler				= sampler;
+	state							= renderer->GetPipelineCache()->GetState(description);
+
+	return Buffers_Reserve(IMGUI_RHI_VERTICES_INITIAL, IMGUI_RHI_INDICES_INITIAL);
+}
+
+void ImGui_ImplRHI_Shutdown()
+{
+	using namespace _ImGui_ImplRHI;
+
+	ImGui::GetIO().Fonts->TexID = nullptr;
+	fontTexture		= nullptr;
+	vertexBuffer	= nullptr;
+	indexBuffer		= nullptr;
+	vertexCapacity	= 0;
+	indexCapacity	= 0;
+	state			= nullptr;
+	sampler			= nullptr;
+	shader			= nullptr;
+	rhiDevice		= nullptr;
+	renderer		= nullptr;
+	context			= nullptr;
+}
+
+void ImGui_ImplRHI_NewFrame()
+{
+	using namespace _ImGui_ImplRHI;
+
+	if (!fontTexture)
+	{
+		Fonts_Create();
+	}
+
+	// Set every frame, another renderer back-end (platform windows) may have pointed it to its own atlas
+	ImGui::GetIO().Fonts->TexID = fontTexture ? fontTexture->GetShaderResource() : nullptr;
+}
+
+void ImGui_ImplRHI_RenderDrawData(ImDrawData* drawData)
+{
+	using namespace _ImGui_ImplRHI;
+
+	if (!drawData || drawData->TotalIdxCount == 0 || !state || shader->GetState() != Shader_Built)
+		return;
+
+	TIME_BLOCK_SCOPED_MULTI();
+
+	if (!Buffers_Upload(drawData))
+		return;
+
+	// Our visible space lies from DisplayPos (top left) to DisplayPos + DisplaySize (bottom right)
+	float left		= drawData->DisplayPos.x;
+	float right		= drawData->DisplayPos.x + drawData->DisplaySize.x;
+	float top		= drawData->DisplayPos.y;
+	float bottom	= drawData->DisplayPos.y + drawData->DisplaySize.y;
+	auto buffer		= Struct_Matrix_Vector4(Matrix::CreateOrthoOffCenterLH(left, right, bottom, top, 0.0f, 1.0f), Vector4::One);
+	shader->UpdateBuffer(&buffer);
+
+	auto& pipeline = renderer->GetRHIPipeline();
+	pipeline->SetState(*state);
+	pipeline->SetVertexBuffer(vertexBuffer);
+	pipeline->SetIndexBuffer(indexBuffer);
+	pipeline->Bind();
+
+	// The back buffer was bound directly (Renderer::SetBackBufferAsRenderTarget), the pipeline may still hold a depth-stencil
+	rhiDevice->Set_DepthEnabled(false);
+	rhiDevice->Set_ScissorEnabled(true);
+
+	// The pipeline skips textures which are already bound, the scissor rectangle is only set when it changes
+	ImVec4 boundClip(-1.0f, -1.0f, -1.0f, -1.0f);
+	auto draw = [&pipeline, &boundClip, left, top](const Batch& batch)
+	{
+		if (batch.count == 0)
+			return;
+
+		if (memcmp(&batch.clip, &boundClip, sizeof(ImVec4)) != 0)
+		{
+			rhiDevice->Set_ScissorRectangle(
+				(int)Math::Helper::Max(batch.clip.x - left, 0.0f),
+				(int)Math::Helper::Max(batch.clip.y - top, 0.0f),
+				(int)(batch.clip.z - left),
+				(int)(batch.clip.w - top)
+			);
+			boundClip = batch.clip;
+		}
+
+		pipeline->SetShaderResource(batch.texture);
+		pipeline->Bind();
+		rhiDevice->DrawIndexed(batch.count, batch.offset, vertexCursor);
+	};
+
+	Batch batch;
+	unsigned int indexOffset = indexCursor;
+	for (int i = 0; i < drawData->CmdListsCount; i++)
+	{
+		const ImDrawList* list = drawData->CmdLists[i];
+		for (int j = 0; j < list->CmdBuffer.Size; j++)
+		{
+			const ImDrawCmd* cmd = &list->CmdBuffer[j];
+			if (cmd->UserCallback)
+			{
+				draw(batch);
+				batch = Batch();
+				cmd->UserCallback(list, cmd);
+				continue;
+			}
+
+			bool merges = batch.count != 0 && cmd->TextureId == batch.texture && memcmp(&cmd->ClipRect, &batch.clip, sizeof(ImVec4)) == 0;
+			if (!merges)
+			{
+				draw(batch);
+				batch.texture	= cmd->TextureId;
+				batch.clip		= cmd->ClipRect;
+				batch.offset	= indexOffset;
+				batch.count		= 0;
+			}
+			batch.count	+= cmd->ElemCount;
+			indexOffset	+= cmd->ElemCount;
+		}
+	}
+	draw(batch);
+
+	rhiDevice->Set_ScissorEnabled(false);
+	vertexCursor	+= (unsigned int)drawData->TotalVtxCount;
+	indexCursor		+= (unsigned int)drawData->TotalIdxCount;
+}
@@ -33,6 +33,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Threading/Threading.h"
 #include "World/World.h"
 #include "RHI/RHI_Texture.h"
+#include "ImportQueue.h"
 //===================================
 
 // An icon shader resource pointer by thumbnail
@@ -129,7 +130,7 @@ public:
 		}
 		else
 		{
-			m_context->GetSubsystem<Directus::Threading>()->AddTask([texture, filePath]()
+			m_context->GetSubsystem<Directus::Threading>()->AddTask(Directus::ThreadGroup_Background, [texture, filePath]()
 			{
 				texture->LoadFromFile(filePath);
 			});
@@ -140,26 +141,20 @@ public:
 
 	void LoadModel(const std::string& filePath)
 	{
-		// Load the model asynchronously
-		m_context->GetSubsystem<Directus::Threading>()->AddTask([this, filePath]()
-		{
-			m_resourceManager->Load<Directus::Model>(filePath);
-		});
+		// Import the model asynchronously, alongside any other imports
+		ImportQueue::Get().Model_Import(filePath);
 	}
 
 	void LoadScene(const std::string& filePath)
 	{
-		// Load the scene asynchronously
-		m_context->GetSubsystem<Directus::Threading>()->AddTask([this, filePath]()
-		{
-			m_scene->LoadFromFile(filePath);
-		});
+		// Load the scene asynchronously, the current one keeps running until it's in
+		m_scene->LoadFromFileAsync(filePath);
 	}
 
 	void SaveScene(const std::string& filePath)
 	{
 		// Save the scene asynchronously
-		m_context->GetSubsystem<Directus::Threading>()->AddTask([this, filePath]()
+		m_context->GetSubsystem<Directus::Threading>()->AddTask(Directus::ThreadGroup_Background, [this, filePath]()
 		{
 			m_scene->SaveToFile(filePath);
 		});
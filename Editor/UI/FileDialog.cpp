@@ -49,6 +49,8 @@ namespace FileDialog_Options
 FileDialog::FileDialog(Context* context, bool standaloneWindow, FileDialog_Type type, FileDialog_Operation operation, FileDialog_Filter filter)
 {
 	m_context						= context;
+	m_fileIndex						= context->GetSubsystem<FileIndex>();
+	m_fileIndexRevision				= 0;
 	m_type							= type;
 	m_operation						= operation;
 	m_filter						= filter;
@@ -77,12 +79,20 @@ bool FileDialog::Show(bool* isVisible, string* itemPath)
 		return false;
 	}
 
-	// Force an update as files may have changed since last time
+	// Force an update as files may have changed since last time (the index can't see outside the working directory)
 	if (!m_wasVisible)
 	{
+		m_fileIndex->Refresh(m_currentPath);
 		m_isDirty = true;
 	}
 
+	// Something the index knows about changed, it might be what's shown
+	if (m_fileIndexRevision != m_fileIndex->GetRevision())
+	{
+		m_fileIndexRevision	= m_fileIndex->GetRevision();
+		m_isDirty			= true;
+	}
+
 	m_selectionMade							= false;
 	m_wasVisible							= true;
 	FileDialog_Options::g_isHoveringItem	= false;
@@ -195,7 +205,10 @@ void FileDialog::Show_Middle()
 				ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 0)); // Remove button's border
 				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0)); // Remove button's background
 
-				if (ImGui::ImageButton(item.GetShaderResource(), ImVec2(m_itemSize, m_itemSize - 23.0f)))
+				// Only the thumbnails on screen are asked for, which is what gets them generated
+				ImVec2 buttonSize		= ImVec2(m_itemSize, m_itemSize - 23.0f);
+				void* shaderResource	= ImGui::IsRectVisible(buttonSize) ? item.GetShaderResource() : nullptr;
+				if (ImGui::ImageButton(shaderResource, buttonSize))
 				{
 					item.Clicked();
 
@@ -354,13 +367,12 @@ void FileDialog::Item_ContextMenu(FileDialog_Item* item)
 		if (item->IsDirectory())
 		{
 			FileSystem::DeleteDirectory(item->GetPath());
-			Dialog_UpdateFromDirectory();
 		}
 		else
 		{
 			FileSystem::DeleteFile_(item->GetPath());
-			Dialog_UpdateFromDirectory();
 		}
+		m_fileIndex->Refresh(m_currentPath); // the items update once it's scanned
 	}
 
 	ImGui::Separator();
@@ -379,47 +391,18 @@ bool FileDialog::Dialog_UpdateFromDirectory(const char* path /*= nullptr*/)
 		path = m_currentPath.c_str();
 	}
 
-	if (!FileSystem::IsDirectory(path))
-	{
-		LOG_WARNING("FileDialog::UpdateFromDirectory: Invalid parameter.");
-		return false;
-	}
-
 	m_items.clear();
 	m_items.shrink_to_fit();
 
-	// Get directories
-	vector<string> childDirectories = FileSystem::GetDirectoriesInDirectory(path);
-	for (const auto& childDir : childDirectories)
+	// The index has the directories first, files are filtered by what they were classified as (nothing here touches the disk)
+	for (const auto& entry : m_fileIndex->GetEntries(path))
 	{
-		m_items.emplace_back(childDir, IconProvider::Get().Thumbnail_Load(childDir, Thumbnail_Folder, (int)m_itemSize));
-	}
+		bool isDirectory	= entry.type == FileType_Directory;
+		bool isFiltered		= (m_filter == FileDialog_Filter_Scene && entry.type != FileType_Scene) || (m_filter == FileDialog_Filter_Model && entry.type != FileType_Model);
+		if (!isDirectory && isFiltered)
+			continue;
 
-	// Get files (based on filter)
-	vector<string> childFiles;
-	if (m_filter == FileDialog_Filter_All)
-	{
-		childFiles = FileSystem::GetFilesInDirectory(path);
-		for (const auto& childFile : childFiles)
-		{
-			m_items.emplace_back(childFile, IconProvider::Get().Thumbnail_Load(childFile, Thumbnail_Custom, (int)m_itemSize));
-		}
-	}
-	else if (m_filter == FileDialog_Filter_Scene)
-	{
-		childFiles = FileSystem::GetSupportedSceneFilesInDirectory(path);
-		for (const auto& childFile : childFiles)
-		{
-			m_items.emplace_back(childFile, IconProvider::Get().Thumbnail_Load(childFile, Thumbnail_File_Scene, (int)m_itemSize));
-		}
-	}
-	else if (m_filter == FileDialog_Filter_Model)
-	{
-		childFiles = FileSystem::GetSupportedModelFilesInDirectory(path);
-		for (const auto& childFile : childFiles)
-		{
-			m_items.emplace_back(childFile, IconProvider::Get().Thumbnail_Load(childFile, Thumbnail_File_Model, (int)m_itemSize));
-		}
+		m_items.emplace_back(entry, IconProvider::Get().Thumbnail_Load(entry.path, entry.type, (int)m_itemSize));
 	}
 
 	return true;
@@ -449,7 +432,7 @@ void FileDialog::Dialog_ContextMenu()
 	if (ImGui::MenuItem("Create folder"))
 	{
 		FileSystem::CreateDirectory_(m_currentPath + "New folder");
-		Dialog_UpdateFromDirectory();
+		m_fileIndex->Refresh(m_currentPath);
 	}
 
 	if (ImGui::MenuItem("Open directory in explorer"))
@@ -51,13 +51,13 @@ enum FileDialog_Filter
 class FileDialog_Item
 {
 public:
-	FileDialog_Item(const std::string& path, const Thumbnail& thumbnail)
+	FileDialog_Item(const Directus::FileIndexEntry& entry, const Thumbnail& thumbnail)
 	{
-		m_path			= path;
+		m_path			= entry.path;
 		m_thumbnail		= thumbnail;
 		m_id			= GENERATE_GUID;
-		m_isDirectory	= Directus::FileSystem::IsDirectory(path);
-		m_label			= Directus::FileSystem::GetFileNameFromFilePath(path);
+		m_isDirectory	= entry.type == Directus::FileType_Directory;
+		m_label			= entry.name;
 	}
 
 	const std::string& GetPath() const	{ return m_path; }
@@ -134,6 +134,8 @@ private:
 	bool m_isDirty;
 	bool m_wasVisible;
 	Directus::Context* m_context;
+	Directus::FileIndex* m_fileIndex;
+	unsigned int m_fileIndexRevision;
 
 	// Callbacks
 	std::function<void(const std::string&)> m_callback_OnPathClicked;
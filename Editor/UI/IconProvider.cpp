@@ -19,18 +19,44 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ============
+//= INCLUDES ======================
 #include "IconProvider.h"
 #include "EditorHelper.h"
-//=======================
+#include "IO/BinaryDocument.h"
+#include "Rendering/Material.h"
+//=================================
 
 //= NAMESPACES ==========
 using namespace std;
 using namespace Directus;
 //=======================
 
+#define THUMBNAIL_VERSION	1					// has to change whenever how thumbnails are made does, the cached ones are made again
+#define THUMBNAIL_DIRECTORY	"Thumbnails//"		// inside the local derived data directory
+
 static Thumbnail g_noThumbnail;
 
+namespace _IconProvider
+{
+	// A material looks like its albedo texture, empty if it has none
+	string Material_GetAlbedo(const string& filePath)
+	{
+		auto document = make_unique<BinaryDocument>();
+		if (!document->Load(filePath))
+			return "";
+
+		auto textureCount = document->GetAttributeAs<int>("Textures", "Count");
+		for (int i = 0; i < textureCount; i++)
+		{
+			string nodeName = "Texture_" + to_string(i);
+			if (document->GetAttributeAs<unsigned int>(nodeName, "Texture_Type") == TextureType_Albedo)
+				return document->GetAttributeAs<string>(nodeName, "Texture_Path");
+		}
+
+		return "";
+	}
+}
+
 IconProvider::IconProvider()
 {
 	m_context = nullptr;
@@ -87,23 +113,26 @@ void* IconProvider::GetShaderResourceByType(Icon_Type type)
 
 void* IconProvider::GetShaderResourceByFilePath(const std::string& filePath)
 {
-	return Thumbnail_Load(filePath).texture->GetShaderResource();
+	return GetShaderResourceByThumbnail(Thumbnail_Load(filePath));
 }
 
 void* IconProvider::GetShaderResourceByThumbnail(const Thumbnail& thumbnail)
 {
-	for (const auto& thumbnailTemp : m_thumbnails)
-	{
-		if (thumbnailTemp.texture->GetLoadState() != LoadState_Completed)
-			continue;
+	if (!thumbnail.texture)
+		return nullptr;
 
-		if (thumbnailTemp.texture->Resource_GetID() == thumbnail.texture->Resource_GetID())
-		{
-			return thumbnailTemp.texture->GetShaderResource();
-		}
+	auto loadState = thumbnail.texture->GetLoadState();
+	if (loadState == LoadState_Completed)
+		return thumbnail.texture->GetShaderResource();
+
+	if (loadState == LoadState_Idle && thumbnail.type == Thumbnail_Custom)
+	{
+		Thumbnail_Generate(thumbnail);
 	}
 
-	return nullptr;
+	// Meanwhile (or if it failed), the icon of the file's type
+	const auto& placeholder = GetThumbnailByType(thumbnail.placeholder);
+	return (placeholder.texture && placeholder.texture->GetLoadState() == LoadState_Completed) ? placeholder.texture->GetShaderResource() : nullptr;
 }
 
 bool IconProvider::ImageButton_enum_id(const char* id, Icon_Type iconEnum, float size)
@@ -134,12 +163,10 @@ const Thumbnail& IconProvider::Thumbnail_Load(const string& filePath, Icon_Type
 		}
 	}
 	else // Check if we already have this thumbnail (by path)
-	{		
-		for (auto& thumbnail : m_thumbnails)
-		{
-			if (thumbnail.filePath == filePath)
-				return thumbnail;
-		}
+	{
+		auto it = m_thumbnailsByPath.find(filePath);
+		if (it != m_thumbnailsByPath.end())
+			return m_thumbnails[it->second];
 	}
 
 	// Deduce file path type
@@ -150,8 +177,6 @@ const Thumbnail& IconProvider::Thumbnail_Load(const string& filePath, Icon_Type
 	if (FileSystem::IsSupportedModelFile(filePath))					return GetThumbnailByType(Thumbnail_File_Model);
 	// Audio
 	if (FileSystem::IsSupportedAudioFile(filePath))					return GetThumbnailByType(Thumbnail_File_Audio);
-	// Material
-	if (FileSystem::IsEngineMaterialFile(filePath))					return GetThumbnailByType(Thumbnail_File_Material);
 	// Shader
 	if (FileSystem::IsSupportedShaderFile(filePath))				return GetThumbnailByType(Thumbnail_File_Shader);
 	// Scene
@@ -172,8 +197,9 @@ const Thumbnail& IconProvider::Thumbnail_Load(const string& filePath, Icon_Type
 	// Exe
 	if (FileSystem::GetExtensionFromFilePath(filePath) == ".exe")	return GetThumbnailByType(Thumbnail_File_Exe);
 
-	// Texture
-	if (FileSystem::IsSupportedImageFile(filePath) || FileSystem::IsEngineTextureFile(filePath))
+	// Texture or material
+	bool isMaterial = FileSystem::IsEngineMaterialFile(filePath);
+	if (FileSystem::IsSupportedImageFile(filePath) || FileSystem::IsEngineTextureFile(filePath) || isMaterial)
 	{
 		// Make a cheap texture
 		auto texture = std::make_shared<RHI_Texture>(m_context);
@@ -181,19 +207,108 @@ const Thumbnail& IconProvider::Thumbnail_Load(const string& filePath, Icon_Type
 		texture->SetWidth(size);
 		texture->SetHeight(size);
 
-		// Load it asynchronously
-		m_context->GetSubsystem<Threading>()->AddTask([texture, filePath]()
+		// Icons load right away, thumbnails once they are shown
+		if (type != Thumbnail_Custom)
 		{
-			texture->LoadFromFile(filePath);
-		});
+			m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [texture, filePath]()
+			{
+				texture->LoadFromFile(filePath);
+			});
+		}
+		else
+		{
+			m_thumbnailsByPath[filePath] = m_thumbnails.size();
+		}
 
-		m_thumbnails.emplace_back(type, texture, filePath);
+		m_thumbnails.emplace_back(type, texture, filePath, isMaterial ? Thumbnail_File_Material : Thumbnail_File_Default);
 		return m_thumbnails.back();
 	}
 
 	return GetThumbnailByType(Thumbnail_File_Default);
 }
 
+const Thumbnail& IconProvider::Thumbnail_Load(const string& filePath, FileType fileType, int size /*100*/)
+{
+	switch (fileType)
+	{
+		case FileType_Directory:	return GetThumbnailByType(Thumbnail_Folder);
+		case FileType_Model:		return GetThumbnailByType(Thumbnail_File_Model);
+		case FileType_Audio:		return GetThumbnailByType(Thumbnail_File_Audio);
+		case FileType_Material:
+		case FileType_Shader:		return GetThumbnailByType(Thumbnail_File_Shader);
+		case FileType_Scene:		return GetThumbnailByType(Thumbnail_File_Scene);
+		case FileType_Script:		return GetThumbnailByType(Thumbnail_File_Script);
+		case FileType_Font:			return GetThumbnailByType(Thumbnail_File_Font);
+		case FileType_Image:
+		case FileType_Texture:		return Thumbnail_Load(filePath, Thumbnail_Custom, size);
+		default: break;
+	}
+
+	string extension = FileSystem::GetExtensionFromFilePath(filePath);
+	if (extension == ".xml")	return GetThumbnailByType(Thumbnail_File_Xml);
+	if (extension == ".dll")	return GetThumbnailByType(Thumbnail_File_Dll);
+	if (extension == ".txt")	return GetThumbnailByType(Thumbnail_File_Txt);
+	if (extension == ".ini")	return GetThumbnailByType(Thumbnail_File_Ini);
+	if (extension == ".exe")	return GetThumbnailByType(Thumbnail_File_Exe);
+
+	return GetThumbnailByType(Thumbnail_File_Default);
+}
+
+void IconProvider::Thumbnail_Generate(const Thumbnail& thumbnail)
+{
+	auto texture	= thumbnail.texture;
+	auto filePath	= thumbnail.filePath;
+	auto context	= m_context;
+	texture->SetLoadState(LoadState_Started);
+
+	m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [context, texture, filePath]()
+	{
+		string source = FileSystem::IsEngineMaterialFile(filePath) ? _IconProvider::Material_GetAlbedo(filePath) : filePath;
+
+		// Engine textures are what the cache would hold already
+		if (FileSystem::IsEngineTextureFile(source))
+		{
+			texture->LoadFromFile(source);
+			return;
+		}
+
+		if (!FileSystem::IsSupportedImageFile(source))
+		{
+			texture->SetLoadState(LoadState_Failed);
+			return;
+		}
+
+		// Cached by the image's content and the thumbnail's size, the file is an engine texture
+		auto ddc			= context->GetSubsystem<ResourceManager>()->GetDerivedDataCache();
+		string key			= ddc ? ddc->GetKey(source, "Thumbnail", THUMBNAIL_VERSION, hash<unsigned int>()(texture->GetWidth())) : "";
+		string directory	= (ddc && !key.empty()) ? ddc->GetDirectory_Local() + THUMBNAIL_DIRECTORY : "";
+		string cacheFilePath = directory.empty() ? "" : directory + key + EXTENSION_TEXTURE;
+		if (!cacheFilePath.empty() && FileSystem::FileExists(cacheFilePath))
+		{
+			texture->LoadFromFile(cacheFilePath);
+			return;
+		}
+
+		// Downscaled while it's imported, the texture is thumbnail sized already
+		auto importer = context->GetSubsystem<ResourceManager>()->GetImageImporter();
+		if (!importer->Load(source, texture.get()))
+		{
+			texture->SetLoadState(LoadState_Failed);
+			return;
+		}
+
+		if (!cacheFilePath.empty() && (FileSystem::DirectoryExists(directory) || FileSystem::CreateDirectory_(directory)) && texture->SaveToFile(cacheFilePath))
+		{
+			texture->LoadFromFile(cacheFilePath);
+			return;
+		}
+
+		// Nowhere to cache it
+		bool created = texture->ShaderResource_Create2D(texture->GetWidth(), texture->GetHeight(), texture->GetChannels(), texture->GetFormat(), texture->Data_Get(), true);
+		texture->SetLoadState(created ? LoadState_Completed : LoadState_Failed);
+	});
+}
+
 const Thumbnail& IconProvider::GetThumbnailByType(Icon_Type type)
 {
 	for (auto& thumbnail : m_thumbnails)
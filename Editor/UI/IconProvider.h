@@ -23,9 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========================
 #include <string>
-#include <vector>
+#include <deque>
 #include <memory>
+#include <unordered_map>
 #include "RHI/RHI_Definition.h"
+#include "FileSystem/FileIndex.h"
 //===================================
 
 enum Icon_Type
@@ -69,16 +71,18 @@ namespace Directus {class Context;}
 struct Thumbnail
 {
 	Thumbnail(){}
-	Thumbnail(Icon_Type type, std::shared_ptr<Directus::RHI_Texture> texture, const std::string& filePath)
+	Thumbnail(Icon_Type type, std::shared_ptr<Directus::RHI_Texture> texture, const std::string& filePath, Icon_Type placeholder = Thumbnail_File_Default)
 	{
 		this->type = type;
 		this->texture = texture;
 		this->filePath = filePath;
+		this->placeholder = placeholder;
 	}
 
 	Icon_Type type;
 	std::shared_ptr<Directus::RHI_Texture> texture;
 	std::string filePath;
+	Icon_Type placeholder = Thumbnail_File_Default; // shown until a custom thumbnail is generated, or if it can't be
 };
 
 class IconProvider
@@ -89,11 +93,12 @@ public:
 
 	void Initialize(Directus::Context* context);
 
-	//= SHADER RESOURCE ===========================================
+	//= SHADER RESOURCE ====================================================================================
 	void* GetShaderResourceByType(Icon_Type type);
 	void* GetShaderResourceByFilePath(const std::string& filePath);
+	// A custom thumbnail is generated the first time it's asked for, so only the ones shown are (see Thumbnail_Generate)
 	void* GetShaderResourceByThumbnail(const Thumbnail& thumbnail);
-	//=============================================================
+	//======================================================================================================
 
 	//= ImGui::ImageButton =======================================================
 	bool ImageButton_enum_id(const char* id, Icon_Type iconEnum, float size);
@@ -102,6 +107,8 @@ public:
 
 	//= THUMBNAIL ==================================================================================================
 	const Thumbnail& Thumbnail_Load(const std::string& filePath, Icon_Type type = Thumbnail_Custom, int size = 100);
+	// For a file the FileIndex already classified, only images have to look at the file
+	const Thumbnail& Thumbnail_Load(const std::string& filePath, Directus::FileType fileType, int size = 100);
 	//==============================================================================================================
 
 	 static IconProvider& Get()
@@ -112,6 +119,10 @@ public:
 
 private:
 	const Thumbnail& GetThumbnailByType(Icon_Type type);
-	std::vector<Thumbnail> m_thumbnails;
+	// Downscales the image (or a material's albedo texture) on a worker, cached on disk by the source's content
+	void Thumbnail_Generate(const Thumbnail& thumbnail);
+
+	std::deque<Thumbnail> m_thumbnails; // the references handed out stay valid as more are added
+	std::unordered_map<std::string, size_t> m_thumbnailsByPath;
 	Directus::Context* m_context;
 };
\ No newline at end of file
@@ -0,0 +1,146 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "ImportQueue.h"
+#include "Core/Context.h"
+#include "Core/EventSystem.h"
+#include "Resource/ResourceManager.h"
+#include "Resource/ProgressReport.h"
+#include "Threading/Threading.h"
+#include "FileSystem/FileSystem.h"
+#include "Rendering/Model.h"
+#include "Logging/Log.h"
+//================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Directus;
+//=======================
+
+ImportQueue::ImportQueue()
+{
+	m_context			= nullptr;
+	m_resourceManager	= nullptr;
+	m_threading			= nullptr;
+}
+
+void ImportQueue::Initialize(Context* context)
+{
+	m_context			= context;
+	m_resourceManager	= context->GetSubsystem<ResourceManager>();
+	m_threading			= context->GetSubsystem<Threading>();
+
+	// The actors of an import belong to the world it started in
+	SUBSCRIBE_TO_EVENT(EVENT_WORLD_UNLOAD, EVENT_HANDLER(CancelAll));
+}
+
+int ImportQueue::Model_Import(const string& filePath)
+{
+	string filePathRelative	= FileSystem::GetRelativeFilePath(filePath);
+	string name				= FileSystem::GetFileNameNoExtensionFromFilePath(filePathRelative);
+
+	if (m_resourceManager->GetResourceByName<Model>(name))
+	{
+		LOGF_INFO("ImportQueue::Model_Import: \"%s\" is loaded already", name.c_str());
+		return -1;
+	}
+
+	int progressID;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		for (const auto& importing : m_importing)
+		{
+			if (importing.second == filePathRelative)
+				return -1;
+		}
+
+		progressID = ProgressReport::Get().Job_Add("Waiting to import \"" + FileSystem::GetFileNameFromFilePath(filePathRelative) + "\"...");
+		m_importing[progressID] = filePathRelative;
+	}
+
+	// Not cached until it's done, nothing can get hold of a model that is half imported
+	auto model = make_shared<Model>(m_context);
+	model->SetResourceName(name);
+	model->SetResourceFilePath(filePathRelative);
+	model->SetImportProgressID(progressID);
+
+	m_threading->AddTask(ThreadGroup_Background, [this, model, filePathRelative, progressID]()
+	{
+		// Cancelled while it was waiting for a thread
+		bool success = !ProgressReport::Get().Job_IsCancelled(progressID) && model->LoadFromFile(filePathRelative);
+
+		lock_guard<mutex> lock(m_mutex);
+		m_finished.emplace_back(Finished{ progressID, model, success });
+	});
+
+	return progressID;
+}
+
+void ImportQueue::Cancel(int progressID)
+{
+	ProgressReport::Get().Job_Cancel(progressID);
+}
+
+void ImportQueue::CancelAll()
+{
+	lock_guard<mutex> lock(m_mutex);
+	for (const auto& importing : m_importing)
+	{
+		ProgressReport::Get().Job_Cancel(importing.first);
+	}
+}
+
+bool ImportQueue::IsEmpty()
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_importing.empty();
+}
+
+void ImportQueue::Tick()
+{
+	vector<Finished> finished;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (m_finished.empty())
+			return;
+
+		finished.swap(m_finished);
+		for (const auto& import : finished)
+		{
+			m_importing.erase(import.progressID);
+		}
+	}
+
+	for (const auto& import : finished)
+	{
+		// A cancel that came after the actors were created is too late, the import is kept
+		if (import.success)
+		{
+			if (m_resourceManager->Add<Model>(import.model) != import.model)
+			{
+				LOGF_WARNING("ImportQueue::Tick: \"%s\" was loaded while it was being imported, the import is left uncached", import.model->GetResourceName().c_str());
+			}
+		}
+
+		ProgressReport::Get().Job_Remove(import.progressID);
+	}
+}
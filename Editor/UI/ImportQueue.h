@@ -0,0 +1,80 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+//===============
+
+namespace Directus
+{
+	class Context;
+	class Model;
+	class ResourceManager;
+	class Threading;
+}
+
+// Models import on the background threads, as many at once as there are threads for them. Every import
+// reports to a ProgressReport job of its own, which is also how it gets cancelled, and a finished import
+// is only added to the resource cache by Tick(), on the main thread.
+class ImportQueue
+{
+public:
+	ImportQueue();
+	~ImportQueue(){}
+
+	static ImportQueue& Get()
+	{
+		static ImportQueue instance;
+		return instance;
+	}
+
+	void Initialize(Directus::Context* context);
+
+	// Returns the ProgressReport id of the import, -1 if the model is loaded (or being imported) already
+	int Model_Import(const std::string& filePath);
+	void Cancel(int progressID);
+	void CancelAll();
+	bool IsEmpty();
+
+	// Caches the finished imports and retires their jobs, call it from the main thread
+	void Tick();
+
+private:
+	struct Finished
+	{
+		int progressID;
+		std::shared_ptr<Directus::Model> model;
+		bool success;
+	};
+
+	std::map<int, std::string> m_importing;	// the file path of every import that isn't retired yet, by progress id
+	std::vector<Finished> m_finished;
+	std::mutex m_mutex;
+	Directus::Context* m_context;
+	Directus::ResourceManager* m_resourceManager;
+	Directus::Threading* m_threading;
+};
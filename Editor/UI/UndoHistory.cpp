@@ -0,0 +1,169 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ============
+#include "UndoHistory.h"
+#include "Core/Context.h"
+#include "Core/EventSystem.h"
+#include "World/World.h"
+#include "World/Actor.h"
+#include "Logging/Log.h"
+//=======================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Directus;
+//=======================
+
+#define UNDO_ARENA_SIZE 1048576 // bytes of recorded values, a transform edit takes 24-32 of them
+
+UndoHistory::UndoHistory()
+{
+	m_arenaHead	= 0;
+	m_cursor	= 0;
+	m_coalesce	= false;
+	m_world		= nullptr;
+	m_arena.resize(UNDO_ARENA_SIZE);
+}
+
+void UndoHistory::Initialize(Context* context)
+{
+	m_world = context->GetSubsystem<World>();
+
+	// Recorded edits point to actors by ID, they don't outlive the world they were made in
+	SUBSCRIBE_TO_EVENT(EVENT_WORLD_UNLOAD, EVENT_HANDLER(Clear));
+	SUBSCRIBE_TO_EVENT(EVENT_WORLD_LOADED, EVENT_HANDLER(Clear));
+}
+
+unsigned int UndoHistory::Property_Register(const char* name, unsigned int size, UndoApply apply)
+{
+	m_properties.emplace_back(Property{ name, (uint32_t)size, apply });
+	return (unsigned int)m_properties.size() - 1;
+}
+
+void UndoHistory::Record(unsigned int actorID, unsigned int property, const void* before, const void* after)
+{
+	if (property >= (unsigned int)m_properties.size())
+		return;
+
+	uint32_t size = m_properties[property].size;
+	if (memcmp(before, after, size) == 0)
+		return;
+
+	// Still the same edit, only where it ends up changes
+	if (m_coalesce && m_cursor != 0 && m_cursor == m_entries.size())
+	{
+		const Entry& last = m_entries.back();
+		if (last.actorID == actorID && last.property == property)
+		{
+			memcpy(&m_arena[last.offset + size], after, size);
+			return;
+		}
+	}
+
+	// A new edit, what could be redone is gone (and so is the room it took)
+	if (m_cursor < m_entries.size())
+	{
+		m_arenaHead = m_entries[m_cursor].offset;
+		m_entries.erase(m_entries.begin() + m_cursor, m_entries.end());
+	}
+
+	uint32_t offset	= 0;
+	uint8_t* values	= Arena_Allocate(size * 2, &offset);
+	if (!values)
+		return;
+	memcpy(values, before, size);
+	memcpy(values + size, after, size);
+
+	m_entries.emplace_back(Entry{ offset, (uint32_t)actorID, (uint16_t)property });
+	m_cursor	= m_entries.size();
+	m_coalesce	= true;
+}
+
+bool UndoHistory::Undo()
+{
+	m_coalesce = false;
+	if (!CanUndo())
+		return false;
+
+	return Apply(m_entries[--m_cursor], false);
+}
+
+bool UndoHistory::Redo()
+{
+	m_coalesce = false;
+	if (!CanRedo())
+		return false;
+
+	return Apply(m_entries[m_cursor++], true);
+}
+
+void UndoHistory::Clear()
+{
+	m_entries.clear();
+	m_arenaHead	= 0;
+	m_cursor	= 0;
+	m_coalesce	= false;
+}
+
+uint8_t* UndoHistory::Arena_Allocate(uint32_t size, uint32_t* offset)
+{
+	auto capacity = (uint32_t)m_arena.size();
+	if (size > capacity)
+		return nullptr;
+
+	// Values are never split, the end of the arena is skipped if they don't fit
+	bool wrap	= m_arenaHead + size > capacity;
+	*offset		= wrap ? 0 : m_arenaHead;
+
+	// Drop the oldest edits until there is room, the ones in what's skipped go too
+	while (!m_entries.empty())
+	{
+		const Entry& oldest	= m_entries.front();
+		uint32_t begin		= oldest.offset;
+		uint32_t end		= begin + m_properties[oldest.property].size * 2;
+		bool skipped		= wrap && begin >= m_arenaHead;
+		bool overlaps		= begin < *offset + size && *offset < end;
+		if (!skipped && !overlaps)
+			break;
+
+		m_entries.pop_front();
+		if (m_cursor > 0) m_cursor--;
+	}
+
+	m_arenaHead = *offset + size;
+	return &m_arena[*offset];
+}
+
+bool UndoHistory::Apply(const Entry& entry, bool after)
+{
+	if (!m_world)
+		return false;
+
+	// An actor which has been removed since, the edit is stepped over
+	const auto& actor = m_world->Actor_GetByID(entry.actorID);
+	if (!actor)
+		return false;
+
+	const Property& property = m_properties[entry.property];
+	property.apply(actor.get(), &m_arena[entry.offset + (after ? property.size : 0)]);
+	return true;
+}
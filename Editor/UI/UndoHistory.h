@@ -0,0 +1,111 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+//=================
+
+namespace Directus
+{
+	class Context;
+	class Actor;
+	class World;
+}
+
+// Sets a property of the actor to a value as it was recorded
+typedef std::function<void(Directus::Actor* actor, const void* value)> UndoApply;
+
+// Edits are recorded as the value of one property before and after, rather than as snapshots of actors.
+// The values live in a fixed size arena which drops the oldest edits to make room, undoing or redoing one
+// only looks up its actor and sets its property.
+class UndoHistory
+{
+public:
+	UndoHistory();
+	~UndoHistory(){}
+
+	static UndoHistory& Get()
+	{
+		static UndoHistory instance;
+		return instance;
+	}
+
+	void Initialize(Directus::Context* context);
+
+	// Properties are registered once, the id is what edits are recorded with
+	unsigned int Property_Register(const char* name, unsigned int size, UndoApply apply);
+
+	// Continuous edits (dragging a value) of one actor's property merge into one, until Edit_End()
+	void Record(unsigned int actorID, unsigned int property, const void* before, const void* after);
+	template <typename T>
+	void Record(unsigned int actorID, unsigned int property, const T& before, const T& after)
+	{
+		static_assert(std::is_standard_layout<T>::value, "Recorded values are copied as they are");
+		Record(actorID, property, (const void*)&before, (const void*)&after);
+	}
+	void Edit_End() { m_coalesce = false; }
+
+	bool Undo();
+	bool Redo();
+	bool CanUndo()				{ return m_cursor > 0; }
+	bool CanRedo()				{ return m_cursor < m_entries.size(); }
+	// The property the next undo or redo sets, nullptr if there is none
+	const char* GetUndoName()	{ return CanUndo() ? m_properties[m_entries[m_cursor - 1].property].name : nullptr; }
+	const char* GetRedoName()	{ return CanRedo() ? m_properties[m_entries[m_cursor].property].name : nullptr; }
+	void Clear();
+
+	unsigned int GetEditCount()		{ return (unsigned int)m_entries.size(); }
+	unsigned int GetMemoryUsage()	{ return (unsigned int)m_arena.size(); }
+
+private:
+	struct Property
+	{
+		const char* name;
+		uint32_t size;
+		UndoApply apply;
+	};
+
+	// The values before and after, back to back in the arena
+	struct Entry
+	{
+		uint32_t offset;
+		uint32_t actorID;
+		uint16_t property;
+	};
+
+	uint8_t* Arena_Allocate(uint32_t size, uint32_t* offset);
+	bool Apply(const Entry& entry, bool after);
+
+	std::vector<uint8_t> m_arena;
+	uint32_t m_arenaHead;				// where the next edit's values go, the oldest edit's come right after (wrapping)
+	std::deque<Entry> m_entries;		// oldest first, in the order their values are in the arena
+	size_t m_cursor;					// edits before it are done, the ones from it on can be redone
+	bool m_coalesce;
+	std::vector<Property> m_properties;
+	Directus::World* m_world;
+};
@@ -31,6 +31,9 @@ using namespace Directus;
 using namespace Math;
 //=======================
 
+// Lines the console keeps, the oldest are overwritten
+#define CONSOLE_LOG_CAPACITY 4096
+
 namespace _Widget_Console
 {
 	static bool scrollToBottom = false;
@@ -47,56 +50,74 @@ Widget_Console::Widget_Console(Context* context) : Widget(context)
 {
 	m_title = "Console";
 
-	// Create an implementation of EngineLogger
-	m_logger = make_shared<EngineLogger>();
-	m_logger->SetCallback([this](LogPackage package) { AddLogPackage(package); });
-
-	// Set the logger implementation for the engine to use
-	Log::SetLogger(m_logger);
-
 	m_showInfo		= true;
 	m_showWarnings	= true;
 	m_showErrors	= true;
+	m_logs.resize(CONSOLE_LOG_CAPACITY);
 }
 
 void Widget_Console::Tick(float deltaTime)
 {
+	// What the engine logged since the last tick, it's written on the log's thread and kept in it's history
+	m_logsNew.clear();
+	Log::History_Get(&m_logSequence, &m_logsNew);
+	for (const auto& record : m_logsNew)
+	{
+		AddLogPackage(LogPackage{ record.text, (int)record.type });
+	}
+
 	// Clear Button
 	if (ImGui::Button("Clear"))	{ Clear();} ImGui::SameLine();
 
-	// Lambda for info, warning, error filter button
-	auto DisplayButton = [](Icon_Type icon, bool* toggle)
+	// Lambda for info, warning, error filter button, with how many of them there are
+	bool filterChanged = false;
+	auto DisplayButton = [&filterChanged](Icon_Type icon, bool* toggle, unsigned int count)
 	{
 		ImGui::PushStyleColor(ImGuiCol_Button, *toggle ? ImGui::GetStyle().Colors[ImGuiCol_ButtonActive] : ImGui::GetStyle().Colors[ImGuiCol_Button]);
 		if (THUMBNAIL_BUTTON_BY_TYPE(icon, 15.0f))
 		{
 			*toggle = !(*toggle);
 			_Widget_Console::scrollToBottom = true;
+			filterChanged = true;
 		}
 		ImGui::PopStyleColor();
 		ImGui::SameLine();
+		ImGui::Text("%u", count);
+		ImGui::SameLine();
 	};
 
 	// Log category visibility buttons
-	DisplayButton(Icon_Console_Info, &m_showInfo);
-	DisplayButton(Icon_Console_Warning, &m_showWarnings);
-	DisplayButton(Icon_Console_Error, &m_showErrors);
+	DisplayButton(Icon_Console_Info, &m_showInfo, m_logsPerType[0]);
+	DisplayButton(Icon_Console_Warning, &m_showWarnings, m_logsPerType[1]);
+	DisplayButton(Icon_Console_Error, &m_showErrors, m_logsPerType[2]);
 
 	// Text filter
-	_Widget_Console::logFilter.Draw("Filter", -100.0f);
+	filterChanged |= _Widget_Console::logFilter.Draw("Filter", -100.0f);
 	ImGui::Separator();
 
-	// Content
-	ImGui::BeginChild("scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
-	for (auto& log : m_logs)
+	// New lines are filtered as they come in, the rest only when the filter changes
+	if (filterChanged)
 	{
-		if (!_Widget_Console::logFilter.PassFilter(log.text.c_str()))
-			continue;
+		Filter_Rebuild();
+	}
 
-		if ((log.errorLevel == 0 && m_showInfo) || (log.errorLevel == 1 && m_showWarnings) || (log.errorLevel == 2 && m_showErrors))
+	// Content, only the visible lines are drawn
+	ImGui::BeginChild("scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+	ImGuiListClipper clipper((int)m_logsFiltered.size());
+	while (clipper.Step())
+	{
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
 		{
+			const auto& log = m_logs[m_logsFiltered[i] % CONSOLE_LOG_CAPACITY];
 			ImGui::PushStyleColor(ImGuiCol_Text, _Widget_Console::colors[log.errorLevel]);	// text
-			ImGui::TextUnformatted(log.text.c_str());
+			if (log.repeats > 1)
+			{
+				ImGui::Text("%s (x%u)", log.text.c_str(), log.repeats);
+			}
+			else
+			{
+				ImGui::TextUnformatted(log.text.c_str());
+			}
 			ImGui::PopStyleColor();
 		}
 	}
@@ -112,17 +133,72 @@ void Widget_Console::Tick(float deltaTime)
 
 void Widget_Console::AddLogPackage(LogPackage package)
 {
-	m_logs.push_back(package);
-	if ((unsigned int)m_logs.size() > m_maxLogEntries)
+	package.errorLevel = package.errorLevel < 0 ? 0 : (package.errorLevel > 2 ? 2 : package.errorLevel);
+	m_logsPerType[package.errorLevel]++;
+
+	// A line logged again (every frame, usually) only counts up
+	if (m_logsCount != 0)
+	{
+		auto& last = m_logs[(m_logsAdded - 1) % CONSOLE_LOG_CAPACITY];
+		if (last.errorLevel == package.errorLevel && last.text == package.text)
+		{
+			last.repeats++;
+			return;
+		}
+	}
+
+	// Overwrites the oldest once full, its slot keeps the string's memory
+	auto& log = m_logs[m_logsAdded % CONSOLE_LOG_CAPACITY];
+	if (m_logsCount == CONSOLE_LOG_CAPACITY)
+	{
+		m_logsPerType[log.errorLevel] -= log.repeats;
+		if (!m_logsFiltered.empty() && m_logsFiltered.front() == m_logsAdded - CONSOLE_LOG_CAPACITY)
+		{
+			m_logsFiltered.pop_front();
+		}
+	}
+	else
 	{
-		m_logs.pop_front();
+		m_logsCount++;
 	}
+	log.text.assign(package.text);
+	log.errorLevel	= package.errorLevel;
+	log.repeats		= package.repeats;
+
+	if (PassFilter(log))
+	{
+		m_logsFiltered.push_back(m_logsAdded);
+	}
+	m_logsAdded++;
 
 	_Widget_Console::scrollToBottom = true;
 }
 
 void Widget_Console::Clear()
 {
-	m_logs.clear();
-	m_logs.shrink_to_fit();
+	m_logsAdded	= 0;
+	m_logsCount	= 0;
+	m_logsFiltered.clear();
+	for (auto& count : m_logsPerType)
+	{
+		count = 0;
+	}
+}
+
+bool Widget_Console::PassFilter(const LogPackage& log)
+{
+	bool shown = (log.errorLevel == 0 && m_showInfo) || (log.errorLevel == 1 && m_showWarnings) || (log.errorLevel == 2 && m_showErrors);
+	return shown && _Widget_Console::logFilter.PassFilter(log.text.c_str());
+}
+
+void Widget_Console::Filter_Rebuild()
+{
+	m_logsFiltered.clear();
+	for (uint64_t number = m_logsAdded - m_logsCount; number < m_logsAdded; number++)
+	{
+		if (PassFilter(m_logs[number % CONSOLE_LOG_CAPACITY]))
+		{
+			m_logsFiltered.push_back(number);
+		}
+	}
 }
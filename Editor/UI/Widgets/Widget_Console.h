@@ -26,7 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <functional>
 #include <deque>
-#include "Logging/ILogger.h"
+#include "Logging/Log.h"
 #include "type_traits"        // for forward, move
 #include "xstring"            // for string
 //==========================
@@ -35,28 +35,7 @@ struct LogPackage
 {
 	std::string text;
 	int errorLevel;
-};
-
-// Implementation of Directus::ILogger so the engine can log into the editor
-class EngineLogger : public Directus::ILogger
-{
-public:
-	typedef std::function<void(LogPackage)> logFunc;
-	void SetCallback(logFunc&& func)
-	{
-		m_logFunc = std::forward<logFunc>(func);
-	}
-
-	void Log(const std::string& text, int errorLevel) override
-	{
-		LogPackage package;
-		package.text = text;
-		package.errorLevel = errorLevel;
-		m_logFunc(package);
-	}
-
-private:
-	logFunc m_logFunc;
+	unsigned int repeats = 1; // the same line logged again right after
 };
 
 class Widget_Console : public Widget
@@ -68,9 +47,18 @@ public:
 	void Clear();
 
 private:
-	std::shared_ptr<EngineLogger> m_logger;
-	std::deque<LogPackage> m_logs;
-	unsigned int m_maxLogEntries = 500;
+	bool PassFilter(const LogPackage& log);
+	void Filter_Rebuild();
+
+	unsigned long long m_logSequence = 0; // the engine's log history up to which is in m_logs
+	std::vector<Directus::Log_Record> m_logsNew;
+	// A ring of CONSOLE_LOG_CAPACITY lines, a line is at its number modulo the capacity
+	std::vector<LogPackage> m_logs;
+	uint64_t m_logsAdded = 0;
+	unsigned int m_logsCount = 0;
+	unsigned int m_logsPerType[3] = {};
+	// The numbers of the lines the filter and the toggles let through, oldest first
+	std::deque<uint64_t> m_logsFiltered;
 	bool m_showInfo;
 	bool m_showWarnings;
 	bool m_showErrors;
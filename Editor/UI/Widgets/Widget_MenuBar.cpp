@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Core/Settings.h"
 #include "Widget_ResourceCache.h"
 #include "Widget_Profiler.h"
+#include "../UndoHistory.h"
 //===============================
 
 //= NAMESPACES ==========
@@ -93,6 +94,16 @@ void Widget_MenuBar::Tick(float deltaTime)
 			ImGui::EndMenu();
 		}
 
+		if (ImGui::BeginMenu("Edit"))
+		{
+			auto& history	= UndoHistory::Get();
+			string undo		= history.CanUndo() ? string("Undo ") + history.GetUndoName() : "Undo";
+			string redo		= history.CanRedo() ? string("Redo ") + history.GetRedoName() : "Redo";
+			if (ImGui::MenuItem(undo.c_str(), "Ctrl+Z", false, history.CanUndo()))	{ history.Undo(); }
+			if (ImGui::MenuItem(redo.c_str(), "Ctrl+Y", false, history.CanRedo()))	{ history.Redo(); }
+			ImGui::EndMenu();
+		}
+
 		if (ImGui::BeginMenu("Tools"))
 		{
 			ImGui::MenuItem("Resource Cache Viewer", nullptr, &m_resourceCache->GetVisible());
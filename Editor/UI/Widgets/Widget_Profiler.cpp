@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Widget_Profiler.h"
 #include "Math/Vector3.h"
 #include "Core/Context.h"
+#include <algorithm>
 //==========================
 
 //= NAMESPACES ==========
@@ -40,6 +41,17 @@ Widget_Profiler::Widget_Profiler(Directus::Context* context) : Widget(context)
 	m_isVisible				= false;
 	m_updateFrequency		= 0.05f;
 	m_timeSinceLastUpdate	= m_updateFrequency;
+	m_captureFrames			= 60;
+	m_spikeBudgetMs			= 33.3f;
+	m_timelinePaused		= false;
+	m_timelineSelected		= 0;
+	m_timelineSpan			= 1;
+	m_timelineZoom			= 1.0f;
+	m_timelineScroll		= 0.0;
+	m_timelineFrom			= 0;
+	m_timelineTo			= 0;
+	m_remotePort			= PROFILER_REMOTE_PORT;
+	snprintf(m_remoteHost, sizeof(m_remoteHost), "127.0.0.1");
 	m_xMin					= 1000;
 	m_yMin					= 715;
 	m_xMax					= FLT_MAX;
@@ -60,29 +72,111 @@ void Widget_Profiler::Tick(float deltaTime)
 
 	Widget::Begin();
 
+	if (ImGui::BeginTabBar("##Widget_Profiler_Tabs"))
+	{
+		if (ImGui::BeginTabItem("Time"))
+		{
+			ShowTime(deltaTime);
+			ImGui::EndTabItem();
+		}
+
+		if (ImGui::BeginTabItem("Memory"))
+		{
+			ShowMemory();
+			ImGui::EndTabItem();
+		}
+
+		if (ImGui::BeginTabItem("Counters"))
+		{
+			ShowStats();
+			ImGui::EndTabItem();
+		}
+
+		if (ImGui::BeginTabItem("Timeline"))
+		{
+			ShowTimeline();
+			ImGui::EndTabItem();
+		}
+
+		if (ImGui::BeginTabItem("Remote"))
+		{
+			ShowRemote();
+			ImGui::EndTabItem();
+		}
+		ImGui::EndTabBar();
+	}
+
+	Widget::End();
+}
+
+void Widget_Profiler::ShowTime(float deltaTime)
+{
 	// Get some useful things
-	auto& cpuBlocks			= Profiler::Get().GetTimeBlocks_CPU();
+	auto cpuBlocks			= Profiler::Get().GetTimeBlocks_CPU();
 	auto gpuBlocks			= Profiler::Get().GetTimeBlocks_GPU();
 	float renderTimeCPU		= Profiler::Get().GetRenderTime_CPU();
 	float renderTimeGPU		= Profiler::Get().GetRenderTime_GPU();
 	float renderTimeTotal	= Profiler::Get().GetRenderTime_CPU() + Profiler::Get().GetRenderTime_GPU();
 
+	// Capture
+	{
+		bool capturing = Profiler::Get().Capture_IsRunning();
+		if (ImGui::Button(capturing ? "Capturing..." : "Capture") && !capturing)
+		{
+			Profiler::Get().Capture_Start(m_captureFrames, "profiler_capture.json");
+		}
+		ImGui::SameLine();
+		ImGui::SliderInt("Frames", &m_captureFrames, 1, 600);
+
+		// Frames over the budget are captured on their own
+		float spikeBudget	= Profiler::Get().Capture_GetSpikeBudget();
+		bool watchSpikes	= spikeBudget > 0.0f;
+		if (ImGui::Checkbox("Capture spikes", &watchSpikes))
+		{
+			Profiler::Get().Capture_SetSpikeBudget(watchSpikes ? m_spikeBudgetMs : 0.0f);
+		}
+		ImGui::SameLine();
+		if (ImGui::SliderFloat("Budget (ms)", &m_spikeBudgetMs, 1.0f, 100.0f) && watchSpikes)
+		{
+			Profiler::Get().Capture_SetSpikeBudget(m_spikeBudgetMs);
+		}
+		ImGui::Separator();
+	}
+
 	// Milliseconds
 	{
-		ImGui::Columns(3, "##Widget_Profiler");
-		ImGui::Text("Function");		ImGui::NextColumn();
-		ImGui::Text("Duration (CPU)");	ImGui::NextColumn();
-		ImGui::Text("Duration (GPU)");	ImGui::NextColumn();
+		ImGui::Columns(5, "##Widget_Profiler");
+		ImGui::Text("Function");				ImGui::NextColumn();
+		ImGui::Text("Calls");					ImGui::NextColumn();
+		ImGui::Text("Duration (CPU)");			ImGui::NextColumn();
+		ImGui::Text("p95 / p99 / max (CPU)");	ImGui::NextColumn();
+		ImGui::Text("Duration (GPU)");			ImGui::NextColumn();
 		ImGui::Separator();
 
-		for (const auto& cpuBlock : cpuBlocks)
+		for (const auto& thread : cpuBlocks)
 		{
-			ImGui::Text("%s", cpuBlock.first);				ImGui::NextColumn();
-			// CPU entry
-			ImGui::Text("%f ms", cpuBlock.second.duration);	ImGui::NextColumn();
-			// GPU entry
-			bool exists = gpuBlocks.find(cpuBlock.first) != gpuBlocks.end();
-			exists ? ImGui::Text("%f ms", gpuBlocks[cpuBlock.first].duration) : ImGui::Text("N/A"); ImGui::NextColumn();
+			ImGui::Text("%s", thread.name.c_str()); ImGui::NextColumn(); ImGui::NextColumn(); ImGui::NextColumn(); ImGui::NextColumn(); ImGui::NextColumn();
+
+			// In the order they started, indented under the scope that enclosed them
+			vector<pair<const char*, const TimeBlock_CPU*>> blocks;
+			for (const auto& block : thread.blocks)
+			{
+				blocks.emplace_back(block.first, &block.second);
+			}
+			sort(blocks.begin(), blocks.end(), [](const auto& a, const auto& b) { return a.second->start < b.second->start; });
+
+			for (const auto& block : blocks)
+			{
+				ImGui::Text("%*s%s", (int)(block.second->depth + 1) * 2, "", block.first);	ImGui::NextColumn();
+				ImGui::Text("%u", block.second->calls);									ImGui::NextColumn();
+				// CPU entry
+				ImGui::Text("%f ms", block.second->duration);								ImGui::NextColumn();
+				auto percentiles = Profiler::Get().GetPercentiles_Block(block.first);
+				ImGui::Text("%.2f / %.2f / %.2f ms", percentiles.p95, percentiles.p99, percentiles.max);	ImGui::NextColumn();
+				// GPU entry
+				bool exists = gpuBlocks.find(block.first) != gpuBlocks.end();
+				exists ? ImGui::Text("%f ms", gpuBlocks[block.first].duration) : ImGui::Text("N/A"); ImGui::NextColumn();
+			}
 		}
 		ImGui::Columns(1);
 	}
@@ -118,6 +212,15 @@ void Widget_Profiler::Tick(float deltaTime)
 		ImGui::Separator();
 		ImGui::Text("GPU: Avg:%.2f, Min:%.2f, Max:%.2f", m_metric_gpu.m_avg, m_metric_gpu.m_min, m_metric_gpu.m_max);
 		ImGui::PlotLines("", m_gpuTimes.data(), (int)m_gpuTimes.size(), 0, "", m_metric_gpu.m_min, m_metric_gpu.m_max, ImVec2(ImGui::GetWindowContentRegionWidth(), 80));
+		ImGui::Separator();
+
+		// Frame time distribution, up to twice the p99 so the tail is visible
+		const auto& history		= Profiler::Get().GetHistory_Frame();
+		const auto& percentiles	= history.GetPercentiles();
+		float buckets[64];
+		history.GetHistogram(buckets, 64, Max(percentiles.p99 * 2.0f, 1.0f));
+		ImGui::Text("Frame: p50:%.2f, p95:%.2f, p99:%.2f, Max:%.2f", percentiles.p50, percentiles.p95, percentiles.p99, percentiles.max);
+		ImGui::PlotHistogram("", buckets, 64, 0, "", 0.0f, FLT_MAX, ImVec2(ImGui::GetWindowContentRegionWidth(), 80));
 	}
 
 	// Bars
@@ -159,6 +262,358 @@ void Widget_Profiler::Tick(float deltaTime)
 
 		ImGui::SetCursorPosY(penY - 160);
 	}
+}
 
-	Widget::End();
+void Widget_Profiler::ShowMemory()
+{
+	if (!MemoryTracker::IsEnabled())
+	{
+		ImGui::Text("The engine has to be built with MEMORY_TRACKING (see MemoryTracker.h)");
+		return;
+	}
+
+	ImGui::Columns(6, "##Widget_Profiler_Memory");
+	ImGui::Text("Tag");					ImGui::NextColumn();
+	ImGui::Text("Live");				ImGui::NextColumn();
+	ImGui::Text("Peak");				ImGui::NextColumn();
+	ImGui::Text("Allocations");			ImGui::NextColumn();
+	ImGui::Text("Allocations (frame)");	ImGui::NextColumn();
+	ImGui::Text("Bytes (frame)");		ImGui::NextColumn();
+	ImGui::Separator();
+
+	auto ToMB = [](size_t bytes) { return (double)bytes / (1024.0 * 1024.0); };
+	for (unsigned int tag = 0; tag < MemoryTag_Count; tag++)
+	{
+		auto stats = MemoryTracker::GetStats((MemoryTag)tag);
+		ImGui::Text("%s", MemoryTracker::GetTagName((MemoryTag)tag));	ImGui::NextColumn();
+		ImGui::Text("%.2f MB", ToMB(stats.bytesLive));					ImGui::NextColumn();
+		ImGui::Text("%.2f MB", ToMB(stats.bytesPeak));					ImGui::NextColumn();
+		ImGui::Text("%llu", (unsigned long long)stats.allocations);	ImGui::NextColumn();
+		// Anything but zero here is what to look into
+		stats.allocationsFrame ? ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "%u", stats.allocationsFrame) : ImGui::Text("0"); ImGui::NextColumn();
+		ImGui::Text("%llu", (unsigned long long)stats.bytesFrame);		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
+
+void Widget_Profiler::ShowStats()
+{
+	ImGui::Columns(4, "##Widget_Profiler_Stats");
+	ImGui::Text("Counter");			ImGui::NextColumn();
+	ImGui::Text("Value");			ImGui::NextColumn();
+	ImGui::Text("p95 / max");		ImGui::NextColumn();
+	ImGui::Text("History");			ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (unsigned int i = 0; i < Stat_Count; i++)
+	{
+		auto stat				= (Stat)i;
+		const auto& history		= Profiler::Get().GetHistory_Stat(stat);
+		const auto& percentiles	= history.GetPercentiles();
+		ImGui::Text("%s", Profiler::GetStatName(stat));						ImGui::NextColumn();
+		ImGui::Text("%.2f", history.GetLast());								ImGui::NextColumn();
+		ImGui::Text("%.2f / %.2f", percentiles.p95, percentiles.max);		ImGui::NextColumn();
+		ImGui::PushID(i);
+		ImGui::PlotLines("", history.GetSamples(), (int)history.GetCount(), (int)history.GetOffset(), "", 0.0f, FLT_MAX, ImVec2(ImGui::GetColumnWidth() - ImGui::GetStyle().ItemSpacing.x, 20));
+		ImGui::PopID();
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	ImGui::Separator();
+	ImGui::Columns(3, "##Widget_Profiler_Passes");
+	ImGui::Text("Pass");			ImGui::NextColumn();
+	ImGui::Text("CPU");				ImGui::NextColumn();
+	ImGui::Text("GPU");				ImGui::NextColumn();
+	ImGui::Separator();
+	for (const auto& pass : Profiler::Get().GetStats_Passes())
+	{
+		ImGui::Text("%s", pass.name);			ImGui::NextColumn();
+		ImGui::Text("%.3f ms", pass.cpuMs);	ImGui::NextColumn();
+		ImGui::Text("%.3f ms", pass.gpuMs);	ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
+
+void Widget_Profiler::ShowTimeline()
+{
+	auto& profiler	= Profiler::Get();
+	auto& io		= ImGui::GetIO();
+
+	ImGui::Checkbox("Pause", &m_timelinePaused);
+	ImGui::SameLine();
+	if (ImGui::Button("Latest"))
+	{
+		m_timelineSelected	= 0;
+		m_timelineZoom		= 1.0f;
+		m_timelineScroll	= 0.0;
+	}
+	ImGui::SameLine();
+	ImGui::SliderInt("Frames", &m_timelineSpan, 1, 16);
+
+	if (!m_timelinePaused)
+	{
+		m_timelineFrames.resize(profiler.Timeline_GetFrameCount());
+		for (unsigned int i = 0; i < (unsigned int)m_timelineFrames.size(); i++)
+		{
+			m_timelineFrames[i] = profiler.Timeline_GetFrame(i);
+		}
+	}
+
+	if (m_timelineFrames.empty())
+		return;
+
+	// The selected frame, the latest if it's gone
+	int selected = (int)m_timelineFrames.size() - 1;
+	for (int i = 0; i < (int)m_timelineFrames.size() && m_timelineSelected != 0; i++)
+	{
+		if (m_timelineFrames[i].frame == m_timelineSelected)
+		{
+			selected = i;
+			break;
+		}
+	}
+	int first = Max(selected - m_timelineSpan + 1, 0);
+
+	ImDrawList* drawList	= ImGui::GetWindowDrawList();
+	float width				= ImGui::GetWindowContentRegionWidth();
+	float rowHeight			= ImGui::GetTextLineHeight() + 4.0f;
+
+	// Frames, click one (a spike) to look into it
+	{
+		float frameMsMax = 0.0f;
+		for (const auto& frame : m_timelineFrames)
+		{
+			frameMsMax = Max(frameMsMax, (float)frame.duration / 1000.0f);
+		}
+
+		ImVec2 pos			= ImGui::GetCursorScreenPos();
+		float height		= 60.0f;
+		float barWidth		= width / PROFILER_TIMELINE_FRAMES;
+		ImGui::InvisibleButton("##Timeline_Frames", ImVec2(width, height));
+		for (int i = 0; i < (int)m_timelineFrames.size(); i++)
+		{
+			float ms		= (float)m_timelineFrames[i].duration / 1000.0f;
+			float x			= pos.x + i * barWidth;
+			float barHeight	= Max(ms / Max(frameMsMax, 0.001f) * height, 1.0f);
+			ImU32 color		= i >= first && i <= selected ? IM_COL32(255, 255, 255, 255) : (ms > m_spikeBudgetMs ? IM_COL32(220, 60, 60, 255) : IM_COL32(60, 180, 60, 255));
+			drawList->AddRectFilled(ImVec2(x, pos.y + height - barHeight), ImVec2(x + Max(barWidth - 1.0f, 1.0f), pos.y + height), color);
+		}
+
+		int hovered = (int)((io.MousePos.x - pos.x) / barWidth);
+		if (ImGui::IsItemHovered() && hovered >= 0 && hovered < (int)m_timelineFrames.size())
+		{
+			const auto& frame = m_timelineFrames[hovered];
+			ImGui::SetTooltip("Frame %llu\n%.2f ms (CPU %.2f, GPU %.2f)", (unsigned long long)frame.frame, (float)frame.duration / 1000.0f, frame.cpuMs, frame.gpuMs);
+			if (ImGui::IsItemClicked(0))
+			{
+				m_timelineSelected	= frame.frame;
+				m_timelineZoom		= 1.0f;
+				m_timelineScroll	= 0.0;
+				selected			= hovered;
+				first				= Max(selected - m_timelineSpan + 1, 0);
+			}
+		}
+	}
+
+	// The scopes of the frames, copied again while paused only if the frames changed (what the threads overwrote since is gone)
+	int64_t spanStart	= m_timelineFrames[first].start;
+	int64_t spanEnd		= m_timelineFrames[selected].start + m_timelineFrames[selected].duration;
+	if (!m_timelinePaused || spanStart != m_timelineFrom || spanEnd != m_timelineTo)
+	{
+		profiler.Timeline_Copy(spanStart, spanEnd, m_timelineThreads);
+		m_timelineFrom	= spanStart;
+		m_timelineTo	= spanEnd;
+	}
+
+	// Lanes, a thread's scopes stacked by depth (a flame chart) and the GPU passes under them
+	unsigned int rows = 3; // the GPU, Renderer::Render and its passes
+	vector<unsigned int> depths(m_timelineThreads.size(), 0);
+	for (size_t i = 0; i < m_timelineThreads.size(); i++)
+	{
+		for (const auto& event : m_timelineThreads[i].events)
+		{
+			depths[i] = Max(depths[i], event.depth + 1);
+		}
+		rows += depths[i] ? depths[i] + 1 : 0;
+	}
+
+	ImGui::Separator();
+	ImVec2 pos = ImGui::GetCursorScreenPos();
+	ImGui::InvisibleButton("##Timeline_Lanes", ImVec2(width, rows * rowHeight));
+
+	// Zooms around the mouse, drags to pan
+	double spanDuration = (double)Max(spanEnd - spanStart, (int64_t)1);
+	if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f)
+	{
+		double mouse		= (io.MousePos.x - pos.x) / width;
+		double mouseUs		= m_timelineScroll + mouse * spanDuration / m_timelineZoom;
+		m_timelineZoom		= Clamp(m_timelineZoom * (io.MouseWheel > 0.0f ? 1.25f : 0.8f), 1.0f, 10000.0f);
+		m_timelineScroll	= mouseUs - mouse * spanDuration / m_timelineZoom;
+	}
+	if (ImGui::IsItemActive() && ImGui::IsMouseDragging(0))
+	{
+		m_timelineScroll -= io.MouseDelta.x / width * spanDuration / m_timelineZoom;
+	}
+	double viewDuration	= spanDuration / m_timelineZoom;
+	m_timelineScroll	= Clamp(m_timelineScroll, 0.0, spanDuration - viewDuration);
+	double viewStart	= (double)spanStart + m_timelineScroll;
+	double scale		= width / viewDuration; // pixels per microsecond
+
+	drawList->PushClipRect(pos, ImVec2(pos.x + width, pos.y + rows * rowHeight), true);
+
+	// Where the frames start
+	for (int i = first; i <= selected; i++)
+	{
+		float x = pos.x + (float)((m_timelineFrames[i].start - viewStart) * scale);
+		drawList->AddLine(ImVec2(x, pos.y), ImVec2(x, pos.y + rows * rowHeight), IM_COL32(255, 255, 255, 60));
+	}
+
+	const char* hovered			= nullptr;
+	int64_t hoveredDuration		= 0;
+	auto DrawScope = [&](const char* name, double start, double duration, float y)
+	{
+		float x0 = pos.x + (float)((start - viewStart) * scale);
+		float x1 = Max(pos.x + (float)((start + duration - viewStart) * scale), x0 + 1.0f);
+		if (x1 < pos.x || x0 > pos.x + width)
+			return;
+
+		ImColor color = ImColor::HSV((float)(((size_t)name >> 4) % 64) / 64.0f, 0.5f, 0.7f);
+		drawList->AddRectFilled(ImVec2(x0, y), ImVec2(x1, y + rowHeight - 1.0f), color);
+		if (x1 - x0 > 20.0f)
+		{
+			drawList->PushClipRect(ImVec2(x0, y), ImVec2(x1, y + rowHeight), true);
+			drawList->AddText(ImVec2(x0 + 2.0f, y + 2.0f), IM_COL32(255, 255, 255, 255), name);
+			drawList->PopClipRect();
+		}
+
+		if (io.MousePos.x >= x0 && io.MousePos.x < x1 && io.MousePos.y >= y && io.MousePos.y < y + rowHeight)
+		{
+			hovered			= name;
+			hoveredDuration	= (int64_t)duration;
+		}
+	};
+
+	float y = pos.y;
+	for (size_t i = 0; i < m_timelineThreads.size(); i++)
+	{
+		if (!depths[i])
+			continue;
+
+		drawList->AddText(ImVec2(pos.x, y + 2.0f), IM_COL32(200, 200, 200, 255), m_timelineThreads[i].name.c_str());
+		y += rowHeight;
+		for (const auto& event : m_timelineThreads[i].events)
+		{
+			DrawScope(event.name, (double)event.start, (double)event.duration, y + event.depth * rowHeight);
+		}
+		y += depths[i] * rowHeight;
+	}
+
+	// The GPU keeps no start times, a pass is placed where the CPU recorded it in that frame (or after the one before)
+	drawList->AddText(ImVec2(pos.x, y + 2.0f), IM_COL32(200, 200, 200, 255), "GPU");
+	y += rowHeight;
+	for (int i = first; i <= selected; i++)
+	{
+		const auto& frame	= m_timelineFrames[i];
+		double passStart	= (double)frame.start;
+		for (unsigned int p = 0; p < frame.passCount; p++)
+		{
+			const auto& pass	= frame.passes[p];
+			bool render			= strcmp(pass.name, "Directus::Renderer::Render") == 0;
+			double start		= render ? (double)frame.start : passStart;
+			for (const auto& thread : m_timelineThreads)
+			{
+				auto it = find_if(thread.events.begin(), thread.events.end(), [&](const TimeBlock_Event& event) { return event.name == pass.name && event.start >= frame.start && event.start < frame.start + frame.duration; });
+				if (it != thread.events.end())
+				{
+					start = (double)it->start;
+					break;
+				}
+			}
+
+			double duration = pass.gpuMs * 1000.0;
+			DrawScope(pass.name, start, duration, render ? y : y + rowHeight);
+			if (!render)
+			{
+				passStart = start + duration;
+			}
+		}
+	}
+
+	drawList->PopClipRect();
+
+	if (hovered && ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("%s\n%.3f ms", hovered, (float)hoveredDuration / 1000.0f);
+	}
+}
+
+void Widget_Profiler::ShowRemote()
+{
+	// Connection
+	bool connected = ProfilerRemote::Client_IsConnected();
+	if (!connected)
+	{
+		ImGui::InputText("Host", m_remoteHost, sizeof(m_remoteHost));
+		ImGui::InputInt("Port", &m_remotePort);
+		if (ImGui::Button("Connect"))
+		{
+			ProfilerRemote::Client_Connect(m_remoteHost, (unsigned short)Clamp(m_remotePort, 1, 65535));
+			m_remoteFrame			= ProfilerRemote_Frame();
+			m_remoteHistory_frame	= TimeHistory();
+		}
+		return;
+	}
+
+	ImGui::Text("Connected to %s:%d, %llu frames received", m_remoteHost, m_remotePort, (unsigned long long)ProfilerRemote::Client_GetFramesReceived());
+	ImGui::SameLine();
+	if (ImGui::Button("Disconnect"))
+	{
+		ProfilerRemote::Client_Disconnect();
+		return;
+	}
+
+	// Frames arrive faster than the widget ticks, the history only sees those it picked up
+	if (ProfilerRemote::Client_GetFrame(&m_remoteFrame))
+	{
+		m_remoteHistory_frame.Add(m_remoteFrame.stats[Stat_FrameMs]);
+		m_remoteHistory_frame.UpdatePercentiles();
+	}
+	ImGui::Separator();
+
+	// Frame time
+	const auto& percentiles = m_remoteHistory_frame.GetPercentiles();
+	ImGui::Text("Frame %llu: %.2f ms (p50:%.2f, p95:%.2f, p99:%.2f, Max:%.2f)", (unsigned long long)m_remoteFrame.frame, m_remoteFrame.stats[Stat_FrameMs], percentiles.p50, percentiles.p95, percentiles.p99, percentiles.max);
+	ImGui::PlotLines("", m_remoteHistory_frame.GetSamples(), (int)m_remoteHistory_frame.GetCount(), (int)m_remoteHistory_frame.GetOffset(), "", 0.0f, FLT_MAX, ImVec2(ImGui::GetWindowContentRegionWidth(), 80));
+	ImGui::Separator();
+
+	// Counters
+	if (ImGui::CollapsingHeader("Counters"))
+	{
+		ImGui::Columns(2, "##Widget_Profiler_Remote_Stats");
+		for (unsigned int i = 0; i < Stat_Count; i++)
+		{
+			ImGui::Text("%s", Profiler::GetStatName((Stat)i));	ImGui::NextColumn();
+			ImGui::Text("%.2f", m_remoteFrame.stats[i]);		ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+
+	// Scopes of the last frame, per thread in the order they ended
+	for (const auto& thread : m_remoteFrame.threads)
+	{
+		if (thread.events.empty())
+			continue;
+
+		ImGui::PushID(thread.thread);
+		if (ImGui::TreeNode("##Thread", "%s (%u scopes)", ProfilerRemote::Client_GetName(thread.name).c_str(), (unsigned int)thread.events.size()))
+		{
+			for (const auto& event : thread.events)
+			{
+				ImGui::Text("%*s%s: %.3f ms", (int)(event.depth + 1) * 2, "", ProfilerRemote::Client_GetName(event.name).c_str(), (float)event.duration / 1000.0f);
+			}
+			ImGui::TreePop();
+		}
+		ImGui::PopID();
+	}
 }
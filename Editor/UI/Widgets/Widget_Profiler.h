@@ -25,6 +25,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Widget.h"
 #include "..\..\ImGui\imgui.h"
 #include "Profiling\Profiler.h"
+#include "Profiling\MemoryTracker.h"
+#include "Profiling\ProfilerRemote.h"
 #include "Math\MathHelper.h"
 #include "Core\Timer.h"
 #include <vector>
@@ -64,10 +66,35 @@ public:
 	void Tick(float deltaTime) override;
 
 private:
+	void ShowTime(float deltaTime);
+	void ShowMemory();
+	void ShowStats();
+	void ShowTimeline();
+	void ShowRemote();
+
 	std::vector<float> m_cpuTimes;
 	std::vector<float> m_gpuTimes;
 	float m_updateFrequency;
 	float m_timeSinceLastUpdate;
 	Metric m_metric_cpu;
 	Metric m_metric_gpu;
+	int m_captureFrames;
+	float m_spikeBudgetMs;
+
+	// Timeline, kept as they were while paused
+	bool m_timelinePaused;
+	uint64_t m_timelineSelected;	// the frame the view ends with, 0 follows the latest
+	int m_timelineSpan;				// frames shown, up to the selected one
+	float m_timelineZoom;			// 1 fits the frames to the width
+	double m_timelineScroll;		// microseconds from the first frame's start to the left edge
+	int64_t m_timelineFrom;
+	int64_t m_timelineTo;
+	std::vector<Directus::Timeline_Frame> m_timelineFrames;
+	std::vector<Directus::Timeline_Thread> m_timelineThreads;
+
+	// Remote, the profiler of another process (see ProfilerRemote)
+	char m_remoteHost[128];
+	int m_remotePort;
+	Directus::ProfilerRemote_Frame m_remoteFrame;
+	Directus::TimeHistory m_remoteHistory_frame;
 };
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =======================
 #include "Widget_ProgressDialog.h"
 #include "Resource/ProgressReport.h"
+#include "../ImportQueue.h"
 //==================================
 
 //= NAMESPACES ==========
@@ -31,7 +32,8 @@ using namespace Directus;
 
 namespace _Widget_ProgressDialog
 {
-	static float width = 500.0f;
+	static float width			= 500.0f;
+	static float cancelWidth	= 70.0f;
 }
 
 Widget_ProgressDialog::Widget_ProgressDialog(Context* contex) : Widget(contex)
@@ -41,7 +43,7 @@ Widget_ProgressDialog::Widget_ProgressDialog(Context* contex) : Widget(contex)
 	m_progress		= 0.0f;
 	m_xMin			= _Widget_ProgressDialog::width;
 	m_yMin			= 83.0f;
-	m_windowFlags	|= ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoScrollbar;
+	m_windowFlags	|= ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_AlwaysAutoResize;
 }
 
 bool Widget_ProgressDialog::Begin()
@@ -50,7 +52,8 @@ bool Widget_ProgressDialog::Begin()
 	ProgressReport& progressReport = ProgressReport::Get();
 	bool isLoadingModel				= progressReport.GetIsLoading(g_progress_ModelImporter);
 	bool isLoadingScene				= progressReport.GetIsLoading(g_progress_Scene);
-	bool inProgress					= isLoadingModel || isLoadingScene;
+	m_jobs							= progressReport.Job_GetAll();
+	bool inProgress					= isLoadingModel || isLoadingScene || !m_jobs.empty();
 
 	// Acquire progress
 	if (isLoadingModel)
@@ -63,6 +66,10 @@ bool Widget_ProgressDialog::Begin()
 		m_progress = progressReport.GetPercentage(Directus::g_progress_Scene);
 		m_progressStatus = progressReport.GetStatus(Directus::g_progress_Scene);
 	}
+	else
+	{
+		m_progressStatus.clear();
+	}
 
 	// Show only if an operation is in progress
 	m_isVisible = inProgress;
@@ -75,10 +82,34 @@ void Widget_ProgressDialog::Tick(float deltaTime)
 	if (!m_isVisible)
 		return;
 
-	// Show dialog
-	ImGui::SetWindowFocus();
-	ImGui::PushItemWidth(_Widget_ProgressDialog::width - ImGui::GetStyle().WindowPadding.x * 2.0f);
-	ImGui::ProgressBar(m_progress, ImVec2(0.0f, 0.0f));
-	ImGui::Text(m_progressStatus.c_str());
-	ImGui::PopItemWidth();
+	// Show dialog, it only takes the focus for the loads that block the editor
+	float width = _Widget_ProgressDialog::width - ImGui::GetStyle().WindowPadding.x * 2.0f;
+	if (!m_progressStatus.empty())
+	{
+		ImGui::SetWindowFocus();
+		ImGui::PushItemWidth(width);
+		ImGui::ProgressBar(m_progress, ImVec2(0.0f, 0.0f));
+		ImGui::Text(m_progressStatus.c_str());
+		ImGui::PopItemWidth();
+	}
+
+	// Background imports, each can be cancelled on its own
+	for (const auto& job : m_jobs)
+	{
+		ImGui::PushID(job.progressID);
+		ImGui::PushItemWidth(width - _Widget_ProgressDialog::cancelWidth - ImGui::GetStyle().ItemSpacing.x);
+		ImGui::ProgressBar(job.percentage, ImVec2(0.0f, 0.0f));
+		ImGui::PopItemWidth();
+		ImGui::SameLine();
+		if (job.isCancelled)
+		{
+			ImGui::Text("Cancelling");
+		}
+		else if (ImGui::Button("Cancel", ImVec2(_Widget_ProgressDialog::cancelWidth, 0.0f)))
+		{
+			ImportQueue::Get().Cancel(job.progressID);
+		}
+		ImGui::Text(job.status.c_str());
+		ImGui::PopID();
+	}
 }
\ No newline at end of file
@@ -21,10 +21,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ======
+//= INCLUDES =====================
 #include <string>
+#include <vector>
 #include "Widget.h"
-//=================
+#include "Resource/ProgressReport.h"
+//================================
 
 namespace Directus { class Context;}
 
@@ -39,4 +41,5 @@ public:
 private:
 	float m_progress;
 	std::string m_progressStatus;
+	std::vector<Directus::ProgressReport::Job> m_jobs;
 };
\ No newline at end of file
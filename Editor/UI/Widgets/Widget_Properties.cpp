@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Widget_World.h"
 #include "../DragDrop.h"
 #include "../ButtonColorPicker.h"
+#include "../UndoHistory.h"
 #include "../../ImGui/imgui_stdlib.h"
 #include "World/Actor.h"
 #include "World/Components/Transform.h"
@@ -34,9 +35,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "World/Components/Light.h"
 #include "World/Components/AudioSource.h"
 #include "World/Components/AudioListener.h"
+#include "World/Components/ParticleEmitter.h"
+#include "World/Components/Terrain.h"
+#include "World/Components/LightProbeVolume.h"
+#include "World/Components/ReflectionProbe.h"
 #include "World/Components/Camera.h"
 #include "World/Components/Script.h"
 #include "Rendering/Deferred/ShaderVariation.h"
+#include "Core/EventSystem.h"
 //=============================================
 
 //= NAMESPACES ==========
@@ -54,10 +60,81 @@ namespace _Widget_Properties
 	static World* scene;
 	static Vector3 rotationHint;
 
+	// The inspected actor's components, looked up again only when they change instead of every frame
+	struct Components
+	{
+		shared_ptr<Transform> transform;
+		shared_ptr<Light> light;
+		shared_ptr<Camera> camera;
+		shared_ptr<AudioSource> audioSource;
+		shared_ptr<AudioListener> audioListener;
+		shared_ptr<ParticleEmitter> particleEmitter;
+		shared_ptr<Terrain> terrain;
+		shared_ptr<LightProbeVolume> lightProbeVolume;
+		shared_ptr<ReflectionProbe> reflectionProbe;
+		shared_ptr<Renderable> renderable;
+		shared_ptr<RigidBody> rigidBody;
+		shared_ptr<Collider> collider;
+		shared_ptr<Constraint> constraint;
+		vector<shared_ptr<Script>> scripts;
+	};
+	static Components components;
+	static bool componentsDirty = true;
+
+	inline void Components_Refresh(Actor* actor)
+	{
+		components.transform		= actor->GetComponent<Transform>();
+		components.light			= actor->GetComponent<Light>();
+		components.camera			= actor->GetComponent<Camera>();
+		components.audioSource		= actor->GetComponent<AudioSource>();
+		components.audioListener	= actor->GetComponent<AudioListener>();
+		components.particleEmitter	= actor->GetComponent<ParticleEmitter>();
+		components.terrain			= actor->GetComponent<Terrain>();
+		components.lightProbeVolume	= actor->GetComponent<LightProbeVolume>();
+		components.reflectionProbe	= actor->GetComponent<ReflectionProbe>();
+		components.renderable		= actor->GetComponent<Renderable>();
+		components.rigidBody		= actor->GetComponent<RigidBody>();
+		components.collider			= actor->GetComponent<Collider>();
+		components.constraint		= actor->GetComponent<Constraint>();
+		components.scripts			= actor->GetComponents<Script>();
+		componentsDirty				= false;
+	}
+
+	// Property ids in the undo history
+	struct UndoProperties
+	{
+		unsigned int position, rotation, scale, isStatic;
+		unsigned int lightType, lightColor, lightIntensity, lightShadows, lightRange, lightAngle, lightSplit1, lightSplit2;
+		unsigned int cameraProjection, cameraFov, cameraNear, cameraFar, cameraClearColor;
+	};
+	static UndoProperties undo;
+
+	// Undoing calls the same setter the inspector does
+	template <typename TComponent, typename T>
+	inline unsigned int Undo_Register(const char* name, void (TComponent::*setter)(T))
+	{
+		typedef typename decay<T>::type Value;
+		return UndoHistory::Get().Property_Register(name, sizeof(Value), [setter](Actor* actor, const void* value)
+		{
+			if (auto component = actor->GetComponent<TComponent>())
+			{
+				(component.get()->*setter)(*(const Value*)value);
+			}
+		});
+	}
+
+	template <typename T>
+	inline void Undo_Record(IComponent* component, unsigned int property, const T& before, const T& after)
+	{
+		UndoHistory::Get().Record(component->GetActor_PtrRaw()->GetID(), property, before, after);
+	}
+
 	//= COLOR PICKERS =============================================
 	static unique_ptr<ButtonColorPicker> materialButtonColorPicker;
 	static unique_ptr<ButtonColorPicker> lightButtonColorPicker;
 	static unique_ptr<ButtonColorPicker> cameraButtonColorPicker;
+	static unique_ptr<ButtonColorPicker> particleStartButtonColorPicker;
+	static unique_ptr<ButtonColorPicker> particleEndButtonColorPicker;
 	//=============================================================
 }
 
@@ -81,6 +158,7 @@ namespace ComponentProperty
 						if (component)
 						{
 							actor->RemoveComponentByID(component->GetID());
+							_Widget_Properties::componentsDirty = true;
 						}
 					}
 				}
@@ -147,10 +225,59 @@ Widget_Properties::Widget_Properties(Context* context) : Widget(context)
 	_Widget_Properties::lightButtonColorPicker		= make_unique<ButtonColorPicker>("Light Color Picker");
 	_Widget_Properties::materialButtonColorPicker	= make_unique<ButtonColorPicker>("Material Color Picker");
 	_Widget_Properties::cameraButtonColorPicker		= make_unique<ButtonColorPicker>("Camera Color Picker");
+	_Widget_Properties::particleStartButtonColorPicker	= make_unique<ButtonColorPicker>("Particle Start Color Picker");
+	_Widget_Properties::particleEndButtonColorPicker	= make_unique<ButtonColorPicker>("Particle End Color Picker");
 
 	_Widget_Properties::resourceManager = m_context->GetSubsystem<ResourceManager>();
 	_Widget_Properties::scene			= m_context->GetSubsystem<World>();
 	m_xMin								= 500; // min width
+
+	// Undoable edits
+	auto& undo			= _Widget_Properties::undo;
+	auto& history		= UndoHistory::Get();
+	undo.position		= _Widget_Properties::Undo_Register("Position", &Transform::SetPositionLocal);
+	undo.scale			= _Widget_Properties::Undo_Register("Scale", &Transform::SetScaleLocal);
+	undo.rotation		= history.Property_Register("Rotation", sizeof(Quaternion), [](Actor* actor, const void* value)
+	{
+		auto& rotation = *(const Quaternion*)value;
+		actor->GetTransform_PtrRaw()->SetRotationLocal(rotation);
+		if (actor == _Widget_Properties::actorInspected.lock().get())
+		{
+			_Widget_Properties::rotationHint = rotation.ToEulerAngles();
+		}
+	});
+	undo.isStatic		= history.Property_Register("Static", sizeof(bool), [](Actor* actor, const void* value) { actor->SetStatic(*(const bool*)value); });
+	undo.lightType		= _Widget_Properties::Undo_Register("Light Type", &Light::SetLightType);
+	undo.lightIntensity	= _Widget_Properties::Undo_Register("Light Intensity", &Light::SetIntensity);
+	undo.lightShadows	= _Widget_Properties::Undo_Register("Light Shadows", &Light::SetCastShadows);
+	undo.lightRange		= _Widget_Properties::Undo_Register("Light Range", &Light::SetRange);
+	undo.lightAngle		= _Widget_Properties::Undo_Register("Light Angle", &Light::SetAngle);
+	undo.lightColor		= history.Property_Register("Light Color", sizeof(Vector4), [](Actor* actor, const void* value)
+	{
+		if (auto light = actor->GetComponent<Light>()) light->SetColor(*(const Vector4*)value);
+	});
+	undo.lightSplit1	= history.Property_Register("Light Split 1", sizeof(float), [](Actor* actor, const void* value)
+	{
+		if (auto light = actor->GetComponent<Light>()) light->ShadowMap_SetSplit(*(const float*)value, 0);
+	});
+	undo.lightSplit2	= history.Property_Register("Light Split 2", sizeof(float), [](Actor* actor, const void* value)
+	{
+		if (auto light = actor->GetComponent<Light>()) light->ShadowMap_SetSplit(*(const float*)value, 1);
+	});
+	undo.cameraProjection	= _Widget_Properties::Undo_Register("Camera Projection", &Camera::SetProjection);
+	undo.cameraFov			= _Widget_Properties::Undo_Register("Camera Field of View", &Camera::SetFOV_Horizontal_Deg);
+	undo.cameraNear			= _Widget_Properties::Undo_Register("Camera Near Plane", &Camera::SetNearPlane);
+	undo.cameraFar			= _Widget_Properties::Undo_Register("Camera Far Plane", &Camera::SetFarPlane);
+	undo.cameraClearColor	= _Widget_Properties::Undo_Register("Camera Background", &Camera::SetClearColor);
+
+	// Components added to or removed from the inspected actor, by anyone
+	SUBSCRIBE_TO_EVENT(EVENT_WORLD_ACTOR_CHANGED, [](const weak_ptr<Actor>& actor)
+	{
+		if (actor.lock() == _Widget_Properties::actorInspected.lock())
+		{
+			_Widget_Properties::componentsDirty = true;
+		}
+	});
 }
 
 void Widget_Properties::Tick(float deltaTime)
@@ -159,31 +286,30 @@ void Widget_Properties::Tick(float deltaTime)
 
 	if (!_Widget_Properties::actorInspected.expired())
 	{
-		auto actorPtr = _Widget_Properties::actorInspected.lock().get();
-
-		auto transform		= actorPtr->GetComponent<Transform>();
-		auto light			= actorPtr->GetComponent<Light>();
-		auto camera			= actorPtr->GetComponent<Camera>();
-		auto audioSource	= actorPtr->GetComponent<AudioSource>();
-		auto audioListener	= actorPtr->GetComponent<AudioListener>();
-		auto renderable		= actorPtr->GetComponent<Renderable>();
-		auto material		= renderable ? renderable->Material_Ptr() : nullptr;
-		auto rigidBody		= actorPtr->GetComponent<RigidBody>();
-		auto collider		= actorPtr->GetComponent<Collider>();
-		auto constraint		= actorPtr->GetComponent<Constraint>();
-		auto scripts		= actorPtr->GetComponents<Script>();
-
-		ShowTransform(transform);
-		ShowLight(light);
-		ShowCamera(camera);
-		ShowAudioSource(audioSource);
-		ShowAudioListener(audioListener);
-		ShowRenderable(renderable);
+		auto& components = _Widget_Properties::components;
+		if (_Widget_Properties::componentsDirty)
+		{
+			_Widget_Properties::Components_Refresh(_Widget_Properties::actorInspected.lock().get());
+		}
+
+		// Materials can be swapped without the components changing
+		auto material = components.renderable ? components.renderable->Material_Ptr() : nullptr;
+
+		ShowTransform(components.transform);
+		ShowLight(components.light);
+		ShowCamera(components.camera);
+		ShowAudioSource(components.audioSource);
+		ShowAudioListener(components.audioListener);
+		ShowParticleEmitter(components.particleEmitter);
+		ShowTerrain(components.terrain);
+		ShowLightProbeVolume(components.lightProbeVolume);
+		ShowReflectionProbe(components.reflectionProbe);
+		ShowRenderable(components.renderable);
 		ShowMaterial(material);
-		ShowRigidBody(rigidBody);
-		ShowCollider(collider);
-		ShowConstraint(constraint);
-		for (auto& script : scripts)
+		ShowRigidBody(components.rigidBody);
+		ShowCollider(components.collider);
+		ShowConstraint(components.constraint);
+		for (auto& script : components.scripts)
 		{
 			ShowScript(script);
 		}
@@ -201,7 +327,9 @@ void Widget_Properties::Tick(float deltaTime)
 
 void Widget_Properties::Inspect(weak_ptr<Actor> actor)
 {
-	_Widget_Properties::actorInspected = actor;
+	_Widget_Properties::actorInspected	= actor;
+	_Widget_Properties::components		= _Widget_Properties::Components();
+	_Widget_Properties::componentsDirty	= true;
 
 	if (auto sharedPtr = actor.lock())
 	{
@@ -223,6 +351,7 @@ void Widget_Properties::Inspect(weak_ptr<Actor> actor)
 void Widget_Properties::Inspect(weak_ptr<Material> material)
 {
 	_Widget_Properties::actorInspected.reset();
+	_Widget_Properties::components = _Widget_Properties::Components();
 	_Widget_Properties::inspectedMaterial = material;
 }
 
@@ -236,6 +365,7 @@ void Widget_Properties::ShowTransform(shared_ptr<Transform>& transform)
 		Vector3 position	= transform->GetPositionLocal();
 		Vector3 rotation	= !isPlaying ? _Widget_Properties::rotationHint : transform->GetRotationLocal().ToEulerAngles();
 		Vector3 scale		= transform->GetScaleLocal();
+		bool isStatic		= transform->GetActor_PtrRaw()->IsStatic();
 		//==================================================================================================================
 		
 		float startColumn = ComponentProperty::g_column - 70.0f;
@@ -273,15 +403,26 @@ void Widget_Properties::ShowTransform(shared_ptr<Transform>& transform)
 		ImGui::SameLine();				showFloat("TraScaY", "Y", &scale.y);
 		ImGui::SameLine();				showFloat("TraScaZ", "Z", &scale.z);
 
+		// Static
+		ImGui::Text("Static");
+		ImGui::SameLine(startColumn);	ImGui::Checkbox("##TraStatic", &isStatic);
+
 		//= MAP ===================================================================
 		if (!isPlaying)
 		{
+			auto& undo = _Widget_Properties::undo;
+			_Widget_Properties::Undo_Record(transform.get(), undo.position, transform->GetPositionLocal(), position);
+			_Widget_Properties::Undo_Record(transform.get(), undo.scale, transform->GetScaleLocal(), scale);
+			_Widget_Properties::Undo_Record(transform.get(), undo.isStatic, transform->GetActor_PtrRaw()->IsStatic(), isStatic);
 			transform->SetPositionLocal(position);
 			transform->SetScaleLocal(scale);
+			transform->GetActor_PtrRaw()->SetStatic(isStatic);
 
 			if (rotation != _Widget_Properties::rotationHint)
 			{
-				transform->SetRotationLocal(Quaternion::FromEulerAngles(rotation));
+				auto rotationNew = Quaternion::FromEulerAngles(rotation);
+				_Widget_Properties::Undo_Record(transform.get(), undo.rotation, transform->GetRotationLocal(), rotationNew);
+				transform->SetRotationLocal(rotationNew);
 				_Widget_Properties::rotationHint = rotation;
 			}
 		}
@@ -374,14 +515,16 @@ void Widget_Properties::ShowLight(shared_ptr<Light>& light)
 		}
 
 		//= MAP ====================================================================================================================================================
-		if ((LightType)typeInt != light->GetLightType())									light->SetLightType((LightType)typeInt);
-		if (intensity != light->GetIntensity())												light->SetIntensity(intensity);
-		if (castsShadows != light->GetCastShadows())										light->SetCastShadows(castsShadows);
-		if (angle / 179.0f != light->GetAngle())											light->SetAngle(angle / 179.0f);
-		if (range != light->GetRange())														light->SetRange(range);
-		if (split1 != light->ShadowMap_GetSplit(0))											light->ShadowMap_SetSplit(split1, 0);
-		if (split2 != light->ShadowMap_GetSplit(1))											light->ShadowMap_SetSplit(split2, 1);
-		if (_Widget_Properties::lightButtonColorPicker->GetColor() != light->GetColor())	light->SetColor(_Widget_Properties::lightButtonColorPicker->GetColor());
+		auto& undo	= _Widget_Properties::undo;
+		auto color	= _Widget_Properties::lightButtonColorPicker->GetColor();
+		if ((LightType)typeInt != light->GetLightType())	{ _Widget_Properties::Undo_Record(light.get(), undo.lightType, light->GetLightType(), (LightType)typeInt);	light->SetLightType((LightType)typeInt); }
+		if (intensity != light->GetIntensity())				{ _Widget_Properties::Undo_Record(light.get(), undo.lightIntensity, light->GetIntensity(), intensity);		light->SetIntensity(intensity); }
+		if (castsShadows != light->GetCastShadows())		{ _Widget_Properties::Undo_Record(light.get(), undo.lightShadows, light->GetCastShadows(), castsShadows);	light->SetCastShadows(castsShadows); }
+		if (angle / 179.0f != light->GetAngle())			{ _Widget_Properties::Undo_Record(light.get(), undo.lightAngle, light->GetAngle(), angle / 179.0f);		light->SetAngle(angle / 179.0f); }
+		if (range != light->GetRange())						{ _Widget_Properties::Undo_Record(light.get(), undo.lightRange, light->GetRange(), range);					light->SetRange(range); }
+		if (split1 != light->ShadowMap_GetSplit(0))			{ _Widget_Properties::Undo_Record(light.get(), undo.lightSplit1, light->ShadowMap_GetSplit(0), split1);	light->ShadowMap_SetSplit(split1, 0); }
+		if (split2 != light->ShadowMap_GetSplit(1))			{ _Widget_Properties::Undo_Record(light.get(), undo.lightSplit2, light->ShadowMap_GetSplit(1), split2);	light->ShadowMap_SetSplit(split2, 1); }
+		if (color != light->GetColor())						{ _Widget_Properties::Undo_Record(light.get(), undo.lightColor, light->GetColor(), color);					light->SetColor(color); }
 		//==========================================================================================================================================================
 	}
 	ComponentProperty::End();
@@ -528,7 +671,8 @@ void Widget_Properties::ShowCollider(shared_ptr<Collider>& collider)
 			"Cylinder",
 			"Capsule",
 			"Cone",
-			"Mesh"
+			"Mesh",
+			"Terrain"
 		};
 		auto shapeInt				= (int)collider->GetShapeType();
 		const char* shapeCharPtr	= type[shapeInt];
@@ -883,11 +1027,13 @@ void Widget_Properties::ShowCamera(shared_ptr<Camera>& camera)
 		ImGui::SetCursorPosX(ComponentProperty::g_column);	ImGui::PushItemWidth(130); ImGui::InputFloat("Far", &farPlane, 0.1f, 0.1f, "%.3f", inputTextFlags); ImGui::PopItemWidth();
 
 		//= MAP =====================================================================================================================================
-		if ((ProjectionType)projectionInt != camera->GetProjection())									camera->SetProjection((ProjectionType)projectionInt);
-		if (fov != camera->GetFOV_Horizontal_Deg())														camera->SetFOV_Horizontal_Deg(fov);
-		if (nearPlane != camera->GetNearPlane())														camera->SetNearPlane(nearPlane);
-		if (farPlane != camera->GetFarPlane())															camera->SetFarPlane(farPlane);
-		if (_Widget_Properties::cameraButtonColorPicker->GetColor() != camera->GetClearColor())	camera->SetClearColor(_Widget_Properties::cameraButtonColorPicker->GetColor());
+		auto& undo		= _Widget_Properties::undo;
+		auto clearColor	= _Widget_Properties::cameraButtonColorPicker->GetColor();
+		if ((ProjectionType)projectionInt != camera->GetProjection())	{ _Widget_Properties::Undo_Record(camera.get(), undo.cameraProjection, camera->GetProjection(), (ProjectionType)projectionInt);	camera->SetProjection((ProjectionType)projectionInt); }
+		if (fov != camera->GetFOV_Horizontal_Deg())						{ _Widget_Properties::Undo_Record(camera.get(), undo.cameraFov, camera->GetFOV_Horizontal_Deg(), fov);							camera->SetFOV_Horizontal_Deg(fov); }
+		if (nearPlane != camera->GetNearPlane())						{ _Widget_Properties::Undo_Record(camera.get(), undo.cameraNear, camera->GetNearPlane(), nearPlane);							camera->SetNearPlane(nearPlane); }
+		if (farPlane != camera->GetFarPlane())							{ _Widget_Properties::Undo_Record(camera.get(), undo.cameraFar, camera->GetFarPlane(), farPlane);								camera->SetFarPlane(farPlane); }
+		if (clearColor != camera->GetClearColor())						{ _Widget_Properties::Undo_Record(camera.get(), undo.cameraClearColor, camera->GetClearColor(), clearColor);					camera->SetClearColor(clearColor); }
 		//===========================================================================================================================================
 	}
 	ComponentProperty::End();
@@ -976,6 +1122,244 @@ void Widget_Properties::ShowAudioListener(shared_ptr<AudioListener>& audioListen
 	ComponentProperty::End();
 }
 
+void Widget_Properties::ShowParticleEmitter(shared_ptr<ParticleEmitter>& particleEmitter)
+{
+	if (!particleEmitter)
+		return;
+
+	if (ComponentProperty::Begin("Particle Emitter", Icon_Component_Light, particleEmitter))
+	{
+		//= REFLECT ===============================================================================
+		bool emitting		= particleEmitter->IsEmitting();
+		int capacity		= (int)particleEmitter->GetCapacity();
+		float rate			= particleEmitter->GetRate();
+		float lifetime		= particleEmitter->GetLifetime();
+		float speed			= particleEmitter->GetSpeed();
+		float spread		= particleEmitter->GetSpread();
+		float gravity		= particleEmitter->GetGravity();
+		float sizeStart		= particleEmitter->GetSizeStart();
+		float sizeEnd		= particleEmitter->GetSizeEnd();
+		bool collisions		= particleEmitter->GetCollisions();
+		float bounce		= particleEmitter->GetBounce();
+		_Widget_Properties::particleStartButtonColorPicker->SetColor(particleEmitter->GetColorStart());
+		_Widget_Properties::particleEndButtonColorPicker->SetColor(particleEmitter->GetColorEnd());
+		//=========================================================================================
+
+		// Emitting
+		ImGui::Text("Emitting");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::Checkbox("##particleEmitting", &emitting);
+
+		// Capacity
+		ImGui::Text("Capacity");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderInt("##particleCapacity", &capacity, 1, 65536);
+
+		// Rate
+		ImGui::Text("Rate");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleRate", &rate, 0.0f, 10000.0f);
+
+		// Lifetime
+		ImGui::Text("Lifetime");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleLifetime", &lifetime, 0.01f, 30.0f);
+
+		// Speed
+		ImGui::Text("Speed");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleSpeed", &speed, 0.0f, 50.0f);
+
+		// Spread
+		ImGui::Text("Spread");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleSpread", &spread, 0.0f, 180.0f);
+
+		// Gravity
+		ImGui::Text("Gravity");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleGravity", &gravity, -2.0f, 2.0f);
+
+		// Size
+		ImGui::Text("Size Start");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleSizeStart", &sizeStart, 0.0f, 5.0f);
+		ImGui::Text("Size End");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleSizeEnd", &sizeEnd, 0.0f, 5.0f);
+
+		// Color
+		ImGui::Text("Color Start");
+		ImGui::SameLine(ComponentProperty::g_column); _Widget_Properties::particleStartButtonColorPicker->Update();
+		ImGui::Text("Color End");
+		ImGui::SameLine(ComponentProperty::g_column); _Widget_Properties::particleEndButtonColorPicker->Update();
+
+		// Collisions
+		ImGui::Text("Collisions");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::Checkbox("##particleCollisions", &collisions);
+		ImGui::Text("Bounce");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##particleBounce", &bounce, 0.0f, 1.0f);
+
+		//= MAP =============================================================================================================
+		auto colorStart	= _Widget_Properties::particleStartButtonColorPicker->GetColor();
+		auto colorEnd	= _Widget_Properties::particleEndButtonColorPicker->GetColor();
+		if (emitting != particleEmitter->IsEmitting())						particleEmitter->SetEmitting(emitting);
+		if ((unsigned int)capacity != particleEmitter->GetCapacity())		particleEmitter->SetCapacity((unsigned int)capacity);
+		if (rate != particleEmitter->GetRate())								particleEmitter->SetRate(rate);
+		if (lifetime != particleEmitter->GetLifetime())						particleEmitter->SetLifetime(lifetime);
+		if (speed != particleEmitter->GetSpeed())							particleEmitter->SetSpeed(speed);
+		if (spread != particleEmitter->GetSpread())							particleEmitter->SetSpread(spread);
+		if (gravity != particleEmitter->GetGravity())						particleEmitter->SetGravity(gravity);
+		if (sizeStart != particleEmitter->GetSizeStart())					particleEmitter->SetSizeStart(sizeStart);
+		if (sizeEnd != particleEmitter->GetSizeEnd())						particleEmitter->SetSizeEnd(sizeEnd);
+		if (colorStart != particleEmitter->GetColorStart())					particleEmitter->SetColorStart(colorStart);
+		if (colorEnd != particleEmitter->GetColorEnd())						particleEmitter->SetColorEnd(colorEnd);
+		if (collisions != particleEmitter->GetCollisions())					particleEmitter->SetCollisions(collisions);
+		if (bounce != particleEmitter->GetBounce())							particleEmitter->SetBounce(bounce);
+		//===================================================================================================================
+	}
+	ComponentProperty::End();
+}
+
+void Widget_Properties::ShowTerrain(shared_ptr<Terrain>& terrain)
+{
+	if (!terrain)
+		return;
+
+	if (ComponentProperty::Begin("Terrain", Icon_Component_Renderable, terrain))
+	{
+		//= REFLECT =========================================================================
+		string heightMapName	= FileSystem::GetFileNameFromFilePath(terrain->GetHeightMap());
+		float size				= terrain->GetSize();
+		float height			= terrain->GetHeight();
+		float lodDistance		= terrain->GetLodDistance();
+		//===================================================================================
+
+		// Height map, building it's chunks takes a while for large ones
+		ImGui::Text("Height Map");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::PushItemWidth(250.0f);
+		ImGui::InputText("##terrainHeightMap", &heightMapName, ImGuiInputTextFlags_ReadOnly);
+		ImGui::PopItemWidth();
+		if (auto payload = DragDrop::Get().GetPayload(DragPayload_Texture))
+		{
+			terrain->SetHeightMap(get<const char*>(payload->data));
+		}
+
+		// Size
+		ImGui::Text("Size");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::InputFloat("##terrainSize", &size, 1.0f, 10.0f, "%.1f", ImGuiInputTextFlags_EnterReturnsTrue);
+
+		// Height
+		ImGui::Text("Height");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::InputFloat("##terrainHeight", &height, 1.0f, 10.0f, "%.1f", ImGuiInputTextFlags_EnterReturnsTrue);
+
+		// LOD distance
+		ImGui::Text("LOD Distance");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderFloat("##terrainLodDistance", &lodDistance, 0.5f, 8.0f);
+
+		//= MAP ===========================================================================
+		if (size != terrain->GetSize())					terrain->SetSize(size);
+		if (height != terrain->GetHeight())				terrain->SetHeight(height);
+		if (lodDistance != terrain->GetLodDistance())	terrain->SetLodDistance(lodDistance);
+		//=================================================================================
+	}
+	ComponentProperty::End();
+}
+
+void Widget_Properties::ShowLightProbeVolume(shared_ptr<LightProbeVolume>& lightProbeVolume)
+{
+	if (!lightProbeVolume)
+		return;
+
+	if (ComponentProperty::Begin("Light Probe Volume", Icon_Component_Light, lightProbeVolume))
+	{
+		//= REFLECT ====================================================
+		float spacing	= lightProbeVolume->GetSpacing();
+		int rays		= (int)lightProbeVolume->GetRays();
+		int bounces		= (int)lightProbeVolume->GetBounces();
+		auto count		= lightProbeVolume->GetCount();
+		//==============================================================
+
+		// The box is the actor's scale
+		ImGui::Text("Spacing");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::InputFloat("##probeSpacing", &spacing, 0.1f, 1.0f, "%.2f", ImGuiInputTextFlags_EnterReturnsTrue);
+
+		ImGui::Text("Rays");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderInt("##probeRays", &rays, 16, 4096);
+
+		ImGui::Text("Bounces");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::SliderInt("##probeBounces", &bounces, 0, 8);
+
+		// Takes a while, the editor stalls until it's done
+		ImGui::Text("Probes");
+		ImGui::SameLine(ComponentProperty::g_column);
+		if (lightProbeVolume->IsBaked())
+		{
+			ImGui::Text("%u x %u x %u", count[0], count[1], count[2]);
+		}
+		else
+		{
+			ImGui::Text("Not baked");
+		}
+		ImGui::SetCursorPosX(ComponentProperty::g_column);
+		if (ImGui::Button("Bake"))
+		{
+			lightProbeVolume->Bake();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+		{
+			lightProbeVolume->Clear();
+		}
+
+		//= MAP ==============================================================================================
+		if (spacing != lightProbeVolume->GetSpacing())				lightProbeVolume->SetSpacing(spacing);
+		if ((unsigned int)rays != lightProbeVolume->GetRays())		lightProbeVolume->SetRays((unsigned int)rays);
+		if ((unsigned int)bounces != lightProbeVolume->GetBounces())	lightProbeVolume->SetBounces((unsigned int)bounces);
+		//====================================================================================================
+	}
+	ComponentProperty::End();
+}
+
+void Widget_Properties::ShowReflectionProbe(shared_ptr<ReflectionProbe>& reflectionProbe)
+{
+	if (!reflectionProbe)
+		return;
+
+	if (ComponentProperty::Begin("Reflection Probe", Icon_Component_Light, reflectionProbe))
+	{
+		//= REFLECT ==========================================================
+		static vector<const char*> updates = { "Static", "Realtime" };
+		int updateInt				= (int)reflectionProbe->GetUpdate();
+		const char* updateCharPtr	= updates[updateInt];
+		//====================================================================
+
+		// The box is the actor's scale, static ones are captured again when something static moves
+		ImGui::Text("Update");
+		ImGui::PushItemWidth(110.0f);
+		ImGui::SameLine(ComponentProperty::g_column); if (ImGui::BeginCombo("##probeUpdate", updateCharPtr))
+		{
+			for (unsigned int i = 0; i < (unsigned int)updates.size(); i++)
+			{
+				bool is_selected = (updateCharPtr == updates[i]);
+				if (ImGui::Selectable(updates[i], is_selected))
+				{
+					updateCharPtr = updates[i];
+					updateInt = i;
+				}
+				if (is_selected)
+				{
+					ImGui::SetItemDefaultFocus();
+				}
+			}
+			ImGui::EndCombo();
+		}
+		ImGui::PopItemWidth();
+
+		ImGui::SetCursorPosX(ComponentProperty::g_column);
+		if (ImGui::Button("Capture"))
+		{
+			reflectionProbe->Capture();
+		}
+
+		//= MAP ===========================================================================================================
+		if ((ReflectionProbe_Update)updateInt != reflectionProbe->GetUpdate()) reflectionProbe->SetUpdate((ReflectionProbe_Update)updateInt);
+		//=================================================================================================================
+	}
+	ComponentProperty::End();
+}
+
 void Widget_Properties::ShowScript(shared_ptr<Script>& script)
 {
 	if (!script)
@@ -1013,6 +1397,9 @@ void Widget_Properties::ComponentContextMenu_Add()
 {
 	if (ImGui::BeginPopup("##ComponentContextMenu_Add"))
 	{
+		// Whatever gets added shows up right away, not only once the World dispatches the change
+		_Widget_Properties::componentsDirty = true;
+
 		if (auto actor = Widget_World::GetActorSelected().lock())
 		{
 			// CAMERA
@@ -1073,6 +1460,41 @@ void Widget_Properties::ComponentContextMenu_Add()
 
 				ImGui::EndMenu();
 			}
+
+			// EFFECTS
+			if (ImGui::BeginMenu("Effects"))
+			{
+				if (ImGui::MenuItem("Particle Emitter"))
+				{
+					actor->AddComponent<ParticleEmitter>();
+				}
+
+				ImGui::EndMenu();
+			}
+
+			// ENVIRONMENT
+			if (ImGui::BeginMenu("Environment"))
+			{
+				if (ImGui::MenuItem("Terrain"))
+				{
+					// Drawn with the material of a Renderable
+					actor->AddComponent<Terrain>();
+					if (!actor->HasComponent<Renderable>())
+					{
+						actor->AddComponent<Renderable>()->Material_UseDefault();
+					}
+				}
+				else if (ImGui::MenuItem("Light Probe Volume"))
+				{
+					actor->AddComponent<LightProbeVolume>();
+				}
+				else if (ImGui::MenuItem("Reflection Probe"))
+				{
+					actor->AddComponent<ReflectionProbe>();
+				}
+
+				ImGui::EndMenu();
+			}
 		}
 
 		ImGui::EndPopup();
@@ -1086,6 +1508,7 @@ void Widget_Properties::Drop_AutoAddComponents()
 		if (auto scriptComponent = _Widget_Properties::actorInspected.lock()->AddComponent<Script>())
 		{
 			scriptComponent->SetScript(get<const char*>(payload->data));
+			_Widget_Properties::componentsDirty = true;
 		}
 	}
 }
@@ -39,6 +39,10 @@ namespace Directus
 	class Camera;
 	class AudioSource;
 	class AudioListener;
+	class ParticleEmitter;
+	class Terrain;
+	class LightProbeVolume;
+	class ReflectionProbe;
 	class Script;
 	class IComponent;
 }
@@ -63,6 +67,10 @@ private:
 	void ShowCamera(std::shared_ptr<Directus::Camera>& camera);
 	void ShowAudioSource(std::shared_ptr<Directus::AudioSource>& audioSource);
 	void ShowAudioListener(std::shared_ptr<Directus::AudioListener>& audioListener);
+	void ShowParticleEmitter(std::shared_ptr<Directus::ParticleEmitter>& particleEmitter);
+	void ShowTerrain(std::shared_ptr<Directus::Terrain>& terrain);
+	void ShowLightProbeVolume(std::shared_ptr<Directus::LightProbeVolume>& lightProbeVolume);
+	void ShowReflectionProbe(std::shared_ptr<Directus::ReflectionProbe>& reflectionProbe);
 	void ShowScript(std::shared_ptr<Directus::Script>& script);
 
 	void ShowAddComponentButton();
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include "Widget_ResourceCache.h"
 #include "Resource/ResourceManager.h"
+#include "Rendering/Renderer.h"
+#include "RHI/RHI_Device.h"
 #include "../../ImGui/imgui.h"
 //===================================
 
@@ -49,6 +51,29 @@ void Widget_ResourceCache::Tick(float deltaTime)
 
 	ImGui::Text("Resource count: %d, Total memory usage: %d Mb", (int)resources.size(), (int)totalMemoryUsage);
 	ImGui::Separator();
+
+	// Video memory, by what it's held for
+	auto rhiDevice = m_context->GetSubsystem<Renderer>()->GetRHIDevice();
+	auto ToMb = [](unsigned long long bytes) { return (int)(bytes / 1000 / 1000); };
+	ImGui::Text("GPU memory - Meshes: %d Mb, Textures: %d Mb, Render targets: %d Mb, Shadows: %d Mb, Buffers: %d Mb",
+		ToMb(rhiDevice->Memory_GetUsage(Memory_Meshes)),
+		ToMb(rhiDevice->Memory_GetUsage(Memory_Textures)),
+		ToMb(rhiDevice->Memory_GetUsage(Memory_RenderTargets)),
+		ToMb(rhiDevice->Memory_GetUsage(Memory_Shadows)),
+		ToMb(rhiDevice->Memory_GetUsage(Memory_Buffers))
+	);
+	unsigned long long budget	= 0;
+	unsigned long long usage	= 0;
+	if (rhiDevice->Memory_GetBudget(&budget, &usage))
+	{
+		ImGui::Text("GPU memory - Tracked: %d Mb, Process: %d Mb, Budget: %d Mb", ToMb(rhiDevice->Memory_GetUsage()), ToMb(usage), ToMb(budget));
+		ImGui::ProgressBar(budget ? (float)((double)usage / (double)budget) : 0.0f);
+	}
+	else
+	{
+		ImGui::Text("GPU memory - Tracked: %d Mb, Budget: N/A", ToMb(rhiDevice->Memory_GetUsage()));
+	}
+	ImGui::Separator();
 	ImGui::Columns(5, "##MenuBar::ShowResourceCacheColumns");
 	ImGui::Text("Type"); ImGui::NextColumn();
 	ImGui::Text("ID"); ImGui::NextColumn();
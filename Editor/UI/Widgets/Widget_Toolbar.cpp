@@ -175,20 +175,50 @@ void Widget_Toolbar::ShowRendererOptions()
 		bool bloom					= Renderer::RenderFlags_IsSet(Render_Bloom);
 		bool correction				= Renderer::RenderFlags_IsSet(Render_Correction);
 		bool fxaa					= Renderer::RenderFlags_IsSet(Render_FXAA);
+		bool taa					= Renderer::RenderFlags_IsSet(Render_TAA);
 		bool sharpening				= Renderer::RenderFlags_IsSet(Render_Sharpening);
 		bool chromaticAberration	= Renderer::RenderFlags_IsSet(Render_ChromaticAberration);
+		bool dynamicResolution		= Renderer::RenderFlags_IsSet(Render_DynamicResolution);
+		bool gpuDriven				= Renderer::RenderFlags_IsSet(Render_GPUDriven);
+		bool reverseZ				= Renderer::RenderFlags_IsSet(Render_ReverseZ);
+		bool checkerboard			= Renderer::RenderFlags_IsSet(Render_Checkerboard);
+		bool depthPrepass			= Renderer::RenderFlags_IsSet(Render_DepthPrepass);
+		bool textureArrays			= Renderer::RenderFlags_IsSet(Render_TextureArrays);
+		bool cameraRelative			= Renderer::RenderFlags_IsSet(Render_CameraRelative);
+		bool ssr					= Renderer::RenderFlags_IsSet(Render_SSR);
+		bool impostors				= Renderer::RenderFlags_IsSet(Render_Impostors);
 		
 		ImGui::Checkbox("Bloom", &bloom);
 		ImGui::Checkbox("Tone-mapping & Gamma correction", &correction);
 		ImGui::Checkbox("FXAA", &fxaa);
+		ImGui::Checkbox("TAA", &taa);
 		ImGui::Checkbox("Chromatic Aberration", &chromaticAberration);
 		ImGui::Checkbox("Sharpening", &sharpening);
+		ImGui::Checkbox("Dynamic Resolution", &dynamicResolution);
+		ImGui::Checkbox("GPU Driven Culling", &gpuDriven);
+		ImGui::Checkbox("Reverse-Z Depth", &reverseZ);
+		ImGui::Checkbox("Checkerboard Lighting", &checkerboard);
+		ImGui::Checkbox("Depth Pre-Pass", &depthPrepass);
+		ImGui::Checkbox("Material Texture Arrays", &textureArrays);
+		ImGui::Checkbox("Camera Relative", &cameraRelative);
+		ImGui::Checkbox("Screen Space Reflections", &ssr);
+		ImGui::Checkbox("Impostors", &impostors);
 			
 		bloom				? Renderer::RenderFlags_Enable(Render_Bloom)				: Renderer::RenderFlags_Disable(Render_Bloom);
 		correction			? Renderer::RenderFlags_Enable(Render_Correction)			: Renderer::RenderFlags_Disable(Render_Correction);
 		fxaa				? Renderer::RenderFlags_Enable(Render_FXAA)					: Renderer::RenderFlags_Disable(Render_FXAA);
+		taa					? Renderer::RenderFlags_Enable(Render_TAA)					: Renderer::RenderFlags_Disable(Render_TAA);
 		sharpening			? Renderer::RenderFlags_Enable(Render_Sharpening)			: Renderer::RenderFlags_Disable(Render_Sharpening);
-		chromaticAberration	? Renderer::RenderFlags_Enable(Render_ChromaticAberration)	: Renderer::RenderFlags_Disable(Render_ChromaticAberration);	
+		chromaticAberration	? Renderer::RenderFlags_Enable(Render_ChromaticAberration)	: Renderer::RenderFlags_Disable(Render_ChromaticAberration);
+		dynamicResolution	? Renderer::RenderFlags_Enable(Render_DynamicResolution)	: Renderer::RenderFlags_Disable(Render_DynamicResolution);
+		gpuDriven			? Renderer::RenderFlags_Enable(Render_GPUDriven)			: Renderer::RenderFlags_Disable(Render_GPUDriven);
+		reverseZ			? Renderer::RenderFlags_Enable(Render_ReverseZ)				: Renderer::RenderFlags_Disable(Render_ReverseZ);
+		checkerboard		? Renderer::RenderFlags_Enable(Render_Checkerboard)			: Renderer::RenderFlags_Disable(Render_Checkerboard);
+		depthPrepass		? Renderer::RenderFlags_Enable(Render_DepthPrepass)			: Renderer::RenderFlags_Disable(Render_DepthPrepass);
+		textureArrays		? Renderer::RenderFlags_Enable(Render_TextureArrays)		: Renderer::RenderFlags_Disable(Render_TextureArrays);
+		cameraRelative		? Renderer::RenderFlags_Enable(Render_CameraRelative)		: Renderer::RenderFlags_Disable(Render_CameraRelative);
+		ssr					? Renderer::RenderFlags_Enable(Render_SSR)					: Renderer::RenderFlags_Disable(Render_SSR);
+		impostors			? Renderer::RenderFlags_Enable(Render_Impostors)			: Renderer::RenderFlags_Disable(Render_Impostors);
 	}
 
 	ImGui::Separator();
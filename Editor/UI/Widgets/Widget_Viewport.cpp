@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Widget_Viewport.h"
 #include "Rendering/Renderer.h"
 #include "World/Actor.h"
+#include "World/World.h"
+#include "World/TransformationGizmo.h"
 #include "World/Components/Camera.h"
 #include "Widget_World.h"
 #include "Core/Settings.h"
@@ -40,6 +42,7 @@ namespace Widget_Viewport_Properties
 	static Renderer* g_renderer	= nullptr;
 	static World* g_scene		= nullptr;
 	static Vector2 g_framePos;
+	static Vector2 g_frameSize;
 }
 
 Widget_Viewport::Widget_Viewport(Context* context) : Widget(context)
@@ -82,7 +85,8 @@ void Widget_Viewport::ShowFrame(float deltaTime)
 	height	-= (height	% 2 != 0) ? 1 : 0;
 
 	// Display frame
-	Widget_Viewport_Properties::g_framePos = EditorHelper::ToVector2(ImGui::GetCursorPos()) + EditorHelper::ToVector2(ImGui::GetWindowPos());
+	Widget_Viewport_Properties::g_framePos	= EditorHelper::ToVector2(ImGui::GetCursorPos()) + EditorHelper::ToVector2(ImGui::GetWindowPos());
+	Widget_Viewport_Properties::g_frameSize	= Vector2((float)width, (float)height);
 	ImGui::Image(
 		Widget_Viewport_Properties::g_renderer->GetFrameShaderResource(),
 		ImVec2((float)width, (float)height),
@@ -114,12 +118,38 @@ void Widget_Viewport::ShowFrame(float deltaTime)
 
 void Widget_Viewport::MousePicking()
 {
+	auto renderer	= Widget_Viewport_Properties::g_renderer;
+	auto camera		= renderer->GetCamera();
+
+	// The GPU answers a few frames after the click
+	unsigned int actorID = 0;
+	if (m_pickPending && renderer->Pick_Get(&actorID))
+	{
+		m_pickPending = false;
+
+		auto& picked = Widget_Viewport_Properties::g_scene->Actor_GetByID(actorID);
+		if (camera)
+		{
+			camera->GetTransformationGizmo()->Pick(picked);
+		}
+		Widget_World::SetSelectedActor(picked);
+	}
+
 	if (!ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByPopup | ImGuiHoveredFlags_AllowWhenBlockedByActiveItem) || !ImGui::IsMouseClicked(0))
 		return;
 
-	if (auto camera = Widget_Viewport_Properties::g_renderer->GetCamera())
+	if (camera)
 	{
 		Vector2 mousePosRelative = EditorHelper::ToVector2(ImGui::GetMousePos()) - Widget_Viewport_Properties::g_framePos;
+
+		// The frame can be shown at a different size than it's rendered at, while the resolution catches up
+		if (renderer->Pick_IsSupported() && Widget_Viewport_Properties::g_frameSize.x > 0.0f && Widget_Viewport_Properties::g_frameSize.y > 0.0f)
+		{
+			renderer->Pick_Request(mousePosRelative * Settings::Get().Resolution_Get() / Widget_Viewport_Properties::g_frameSize);
+			m_pickPending = true;
+			return;
+		}
+
 		if (auto picked = camera->Pick(mousePosRelative))
 		{
 			Widget_World::SetSelectedActor(picked);
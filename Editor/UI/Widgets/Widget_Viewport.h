@@ -36,4 +36,5 @@ private:
 	void ShowFrame(float deltaTime);
 	void MousePicking();
 	float m_timeSinceLastResChange;
+	bool m_pickPending = false;
 };
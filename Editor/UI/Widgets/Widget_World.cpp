@@ -73,12 +73,8 @@ Widget_World::Widget_World(Context* context) : Widget(context)
 
 void Widget_World::Tick(float deltaTime)
 {
-	// If something is being loaded, don't parse the hierarchy
-	ProgressReport& progressReport	= ProgressReport::Get();
-	bool isLoadingModel				= progressReport.GetIsLoading(g_progress_ModelImporter);
-	bool isLoadingScene				= progressReport.GetIsLoading(g_progress_Scene);
-	bool isLoading					= isLoadingModel || isLoadingScene;
-	if (isLoading)
+	// If something is being loaded (a model, a scene or a background import), don't parse the hierarchy
+	if (ProgressReport::Get().GetIsLoadingAny())
 		return;
 	
 	Tree_Show();
@@ -117,10 +113,20 @@ void Widget_World::Tree_Show()
 			}
 		}
 
-		auto rootActors = SceneHelper::g_scene->Actors_GetRoots();
-		for (const auto& actor : rootActors)
+		// Actors are added, removed and re-parented by the World's thread, the rows
+		// point to them so they are rebuilt before they are shown if anything changed
+		if (m_treeDirty || m_treeVersion != Transform::GetHierarchyVersion())
 		{
-			Tree_AddActor(actor.get());
+			Tree_Build();
+		}
+
+		ImGuiListClipper clipper((int)m_treeRows.size());
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+			{
+				Tree_AddActor(m_treeRows[i]);
+			}
 		}
 
 		ImGui::TreePop();
@@ -129,6 +135,56 @@ void Widget_World::Tree_Show()
 	OnTreeEnd();
 }
 
+void Widget_World::Tree_Build()
+{
+	m_treeVersion	= Transform::GetHierarchyVersion();
+	m_treeDirty		= false;
+	m_treeRows.clear();
+
+	auto hasVisibleChildren = [](Actor* actor)
+	{
+		for (const auto& child : actor->GetTransform_PtrRaw()->GetChildren())
+		{
+			if (child->GetActor_PtrRaw()->IsVisibleInHierarchy())
+				return true;
+		}
+		return false;
+	};
+
+	// Depth first, the children of an actor pushed in reverse so they come out in order
+	vector<pair<Actor*, unsigned int>> stack;
+	auto roots = SceneHelper::g_scene->Actors_GetRoots();
+	for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+	{
+		stack.emplace_back(it->get(), 0);
+	}
+
+	while (!stack.empty())
+	{
+		auto [actor, depth] = stack.back();
+		stack.pop_back();
+
+		// Don't show invisible actors
+		if (!actor || !actor->IsVisibleInHierarchy())
+			continue;
+
+		Tree_Row row;
+		row.actor		= actor;
+		row.depth		= depth;
+		row.hasChildren	= hasVisibleChildren(actor);
+		m_treeRows.emplace_back(row);
+
+		if (!row.hasChildren || !m_treeExpanded.count(actor->GetID()))
+			continue;
+
+		const auto& children = actor->GetTransform_PtrRaw()->GetChildren();
+		for (auto it = children.rbegin(); it != children.rend(); ++it)
+		{
+			stack.emplace_back((*it)->GetActor_PtrRaw(), depth + 1);
+		}
+	}
+}
+
 void Widget_World::OnTreeBegin()
 {
 	SceneHelper::g_actorHovered = nullptr;
@@ -141,63 +197,39 @@ void Widget_World::OnTreeEnd()
 	Popups();
 }
 
-void Widget_World::Tree_AddActor(Actor* actor)
+void Widget_World::Tree_AddActor(const Tree_Row& row)
 {
-	if (!actor)
-		return;
-
-	bool isVisibleInHierarchy	= actor->IsVisibleInHierarchy();
-	bool hasParent				= actor->GetTransform_PtrRaw()->HasParent();
-	bool hasVisibleChildren		= false;
+	Actor* actor	= row.actor;
+	float indent	= row.depth * ImGui::GetStyle().IndentSpacing;
+	if (indent > 0.0f) ImGui::Indent(indent);
 
-	// Don't draw invisible actors
-	if (!isVisibleInHierarchy)
-		return;
-
-	// Determine children visibility
-	auto children = actor->GetTransform_PtrRaw()->GetChildren();
-	for (const auto& child : children)
-	{
-		if (child->GetActor_PtrRaw()->IsVisibleInHierarchy())
-		{
-			hasVisibleChildren = true;
-			break;
-		}
-	}
-
-	ImGuiTreeNodeFlags node_flags	= ImGuiTreeNodeFlags_AllowItemOverlap;
-	node_flags						|= hasVisibleChildren ? ImGuiTreeNodeFlags_OpenOnArrow : ImGuiTreeNodeFlags_Leaf; // Expandable?	
+	// The rows are flat, nodes don't push (nor indent) for their children
+	ImGuiTreeNodeFlags node_flags	= ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+	node_flags						|= row.hasChildren ? ImGuiTreeNodeFlags_OpenOnArrow : ImGuiTreeNodeFlags_Leaf; // Expandable?	
 	if (!m_actorSelected.expired()) // Selected?
 	{
 		node_flags |= (m_actorSelected.lock()->GetID() == actor->GetID()) ? ImGuiTreeNodeFlags_Selected : 0;
 	}
+	bool isExpanded = m_treeExpanded.count(actor->GetID()) != 0;
+	ImGui::SetNextTreeNodeOpen(isExpanded);
 	bool isNodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)actor->GetID(), node_flags, actor->GetName().c_str());
 
+	// Expanding or collapsing changes which rows there are, from the next frame
+	if (row.hasChildren && isNodeOpen != isExpanded)
+	{
+		if (isNodeOpen) m_treeExpanded.insert(actor->GetID()); else m_treeExpanded.erase(actor->GetID());
+		m_treeDirty = true;
+	}
+
 	// Manually detect some useful states
 	if (ImGui::IsItemHovered(ImGuiHoveredFlags_RectOnly))
 	{
 		SceneHelper::g_actorHovered = actor;
 	}
 
-	Actor_HandleDragDrop(actor);	
-
-	// Recursively show all child nodes
-	if (isNodeOpen)
-	{
-		if (hasVisibleChildren)
-		{
-			for (const auto& child : children)
-			{
-				if (!child->GetActor_PtrRaw()->IsVisibleInHierarchy())
-					continue;
+	Actor_HandleDragDrop(actor);
 
-				Tree_AddActor(child->GetActor_PtrRaw());
-			}
-		}
-
-		// Pop if isNodeOpen
-		ImGui::TreePop();
-	}
+	if (indent > 0.0f) ImGui::Unindent(indent);
 }
 
 void Widget_World::HandleClicking()
@@ -21,10 +21,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ======
+//= INCLUDES ==========
 #include "Widget.h"
 #include <memory>
-//=================
+#include <vector>
+#include <unordered_set>
+//=====================
 
 namespace Directus { class Actor; }
 
@@ -38,11 +40,19 @@ public:
 	static void SetSelectedActor(std::weak_ptr<Directus::Actor> actor) ;
 
 private:
-	// Tree
+	// Tree, flattened into the rows which are shown (the children of expanded actors) and
+	// rebuilt only when the hierarchy changes, so only the rows on screen cost anything
+	struct Tree_Row
+	{
+		Directus::Actor* actor	= nullptr;
+		unsigned int depth		= 0;
+		bool hasChildren		= false; // visible ones
+	};
 	void Tree_Show();
+	void Tree_Build();
 	void OnTreeBegin();
 	void OnTreeEnd();
-	void Tree_AddActor(Directus::Actor* actor);
+	void Tree_AddActor(const Tree_Row& row);
 	void HandleClicking();
 	void Actor_HandleDragDrop(Directus::Actor* actorPtr);
 
@@ -71,4 +81,8 @@ private:
 	void Action_actor_CreateAudioListener();
 	
 	static std::weak_ptr<Directus::Actor> m_actorSelected;
+	std::vector<Tree_Row> m_treeRows;
+	std::unordered_set<unsigned int> m_treeExpanded;	// actor IDs
+	unsigned int m_treeVersion	= 0;					// the Transform hierarchy version the rows were built for
+	bool m_treeDirty			= true;
 };
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Core/Engine.h"
 #include "Rendering/Renderer.h"
 #include "Input/Input.h"
+#include "Profiling/MemoryTracker.h"
 //=================================
 
 //= NAMESPACES ==========
@@ -34,6 +35,9 @@ using namespace Directus;
 using namespace Math;
 //=======================
 
+// The editor frees what the engine allocates, so with MEMORY_TRACKING both go through the same new and delete
+MEMORY_TRACKING_OPERATORS()
+
 static std::unique_ptr<Editor> g_editor;
 static std::unique_ptr<Engine> g_engine;
 static Context* g_engineContext	= nullptr;
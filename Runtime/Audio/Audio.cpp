@@ -21,9 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =============================
 #include "Audio.h"
+#include "AudioSampleCache.h"
 #include <fmod.hpp>
 #include <fmod_errors.h>
 #include <sstream>
+#include <algorithm>
 #include "../Logging/Log.h"
 #include "../Core/Engine.h"
 #include "../Core/EventSystem.h"
@@ -37,18 +39,21 @@ using namespace std;
 using namespace FMOD;
 //===================
 
+static const int VOICES_VIRTUAL			= 1024;		// channels FMOD tracks, only Settings::AudioVoicesReal_Get() of them are mixed
+static const float VOICE_VIRTUAL_VOLUME	= 0.001f;	// audibility (volume after attenuation) below which a channel goes virtual
+
 namespace Directus
 {
 	Audio::Audio(Context* context) : Subsystem(context)
 	{
 		m_resultFMOD		= FMOD_OK;
 		m_systemFMOD		= nullptr;
-		m_maxChannels		= 32;
+		m_maxChannels		= VOICES_VIRTUAL;
 		m_distanceFactor	= 1.0f;
 		m_initialized		= false;
 		m_listener			= nullptr;
 
-		SUBSCRIBE_TO_EVENT(EVENT_WORLD_UNLOAD, [this](Variant) { m_listener = nullptr; });
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_UNLOAD, [this](const auto&) { m_listener = nullptr; });
 		SUBSCRIBE_TO_EVENT(EVENT_TICK, EVENT_HANDLER(Update));
 	}
 
@@ -57,6 +62,9 @@ namespace Directus
 		if (!m_systemFMOD)
 			return;
 
+		Thread_Stop();
+		m_sampleCache.reset();
+
 		// Close FMOD
 		m_resultFMOD = m_systemFMOD->close();
 		if (m_resultFMOD != FMOD_OK)
@@ -107,8 +115,34 @@ namespace Directus
 			return false;
 		}
 
+		// Limit the voices that are actually decoded and mixed, has to be set before init
+		m_resultFMOD = m_systemFMOD->setSoftwareChannels((int)Settings::Get().AudioVoicesReal_Get());
+		if (m_resultFMOD != FMOD_OK)
+		{
+			LogErrorFMOD(m_resultFMOD);
+			return false;
+		}
+
+		// Inaudible channels (silent or attenuated by distance) go virtual, they keep their position
+		// and resume from it when they become audible again, without being decoded or mixed meanwhile.
+		FMOD_ADVANCEDSETTINGS advancedSettings = {};
+		advancedSettings.cbSize			= sizeof(FMOD_ADVANCEDSETTINGS);
+		advancedSettings.vol0virtualvol	= VOICE_VIRTUAL_VOLUME;
+		// Every real voice can play a compressed sample, FMOD allows 255 decoders of each codec
+		int codecs = (int)min(Settings::Get().AudioVoicesReal_Get(), 255u);
+		advancedSettings.maxMPEGCodecs		= codecs;
+		advancedSettings.maxADPCMCodecs		= codecs;
+		advancedSettings.maxVorbisCodecs	= codecs;
+		advancedSettings.maxFADPCMCodecs	= codecs;
+		m_resultFMOD = m_systemFMOD->setAdvancedSettings(&advancedSettings);
+		if (m_resultFMOD != FMOD_OK)
+		{
+			LogErrorFMOD(m_resultFMOD);
+			return false;
+		}
+
 		// Initialize FMOD
-		m_resultFMOD = m_systemFMOD->init(m_maxChannels, FMOD_INIT_NORMAL, nullptr);
+		m_resultFMOD = m_systemFMOD->init(m_maxChannels, FMOD_INIT_NORMAL | FMOD_INIT_VOL0_BECOMES_VIRTUAL, nullptr);
 		if (m_resultFMOD != FMOD_OK)
 		{
 			LogErrorFMOD(m_resultFMOD);
@@ -131,6 +165,9 @@ namespace Directus
 		string rev		= ss.str().erase(0, 3);
 		Settings::Get().m_versionFMOD = major + "." + minor + "." + rev;
 
+		m_sampleCache = make_unique<AudioSampleCache>(m_systemFMOD);
+		m_sampleCache->SetBudget((unsigned long long)Settings::Get().AudioSampleCacheBudget_Get() * 1024 * 1024);
+
 		m_initialized = true;
 		return true;
 	}
@@ -144,48 +181,135 @@ namespace Directus
 		if (!m_initialized)
 			return false;
 
-		TIME_BLOCK_START_CPU();
+		TIME_BLOCK_SCOPED_CPU();
 
-		// Update FMOD
-		m_resultFMOD = m_systemFMOD->update();
-		if (m_resultFMOD != FMOD_OK)
+		// Queue the listener, FMOD itself is updated on the audio thread
+		if (m_listener)
 		{
-			LogErrorFMOD(m_resultFMOD);
-			return false;
+			lock_guard<mutex> lock(m_threadMutex);
+			m_listenerQueued.position	= m_listener->GetPosition();
+			m_listenerQueued.forward	= m_listener->GetForward();
+			m_listenerQueued.up			= m_listener->GetUp();
+			m_listenerQueuedValid		= true;
 		}
 
-		//= 3D Attributes =============================================
-		if (m_listener)
+		Thread_Kick();
+
+		return true;
+	}
+
+	void Audio::SetListenerTransform(Transform* transform)
+	{
+		m_listener = transform;
+	}
+
+	void Audio::Voice_SetPosition(Channel* channel, const Math::Vector3& position)
+	{
+		if (!channel)
+			return;
+
+		lock_guard<mutex> lock(m_threadMutex);
+		m_voicesQueued.push_back({ channel, position });
+	}
+
+	void Audio::Thread_Loop()
+	{
+		while (true)
+		{
+			Listener_Attributes listener;
+			bool listenerValid = false;
+			{
+				unique_lock<mutex> lock(m_threadMutex);
+				m_threadCondition.wait(lock, [this] { return m_threadPending || m_threadStopping; });
+				if (m_threadStopping)
+					return;
+
+				// Take everything queued so far, the main thread keeps queueing into the other vector
+				m_threadPending			= false;
+				m_voicesApplying.swap(m_voicesQueued);
+				listener				= m_listenerQueued;
+				listenerValid			= m_listenerQueuedValid;
+				m_listenerQueuedValid	= false;
+			}
+
+			Thread_Update(listenerValid ? &listener : nullptr);
+			m_voicesApplying.clear();
+		}
+	}
+
+	void Audio::Thread_Kick()
+	{
+		if (!m_thread.joinable())
+		{
+			m_thread = thread(&Audio::Thread_Loop, this);
+		}
+
+		// If the audio thread is still busy with the last frame, it will pick this one up right after
+		{
+			lock_guard<mutex> lock(m_threadMutex);
+			m_threadPending = true;
+		}
+		m_threadCondition.notify_one();
+	}
+
+	void Audio::Thread_Stop()
+	{
+		if (!m_thread.joinable())
+			return;
+
+		{
+			lock_guard<mutex> lock(m_threadMutex);
+			m_threadStopping = true;
+		}
+		m_threadCondition.notify_one();
+		m_thread.join();
+	}
+
+	void Audio::Thread_Update(const Listener_Attributes* listener)
+	{
+		TIME_BLOCK_SCOPED_CPU();
+
+		FMOD_VECTOR velocity = { 0, 0, 0 };
+
+		// Voices that moved, a stopped channel's handle is invalid by now, which is expected
+		for (const auto& voice : m_voicesApplying)
 		{
-			Math::Vector3 position = m_listener->GetPosition();
-			Math::Vector3 velocity = Math::Vector3::Zero;
-			Math::Vector3 forward = m_listener->GetForward();
-			Math::Vector3 up = m_listener->GetUp();
+			voice.channel->set3DAttributes((FMOD_VECTOR*)&voice.position, &velocity);
+		}
 
-			// Set 3D attributes
+		// Listener
+		if (listener)
+		{
 			m_resultFMOD = m_systemFMOD->set3DListenerAttributes(
-				0, 
-				(FMOD_VECTOR*)&position, 
-				(FMOD_VECTOR*)&velocity, 
-				(FMOD_VECTOR*)&forward, 
-				(FMOD_VECTOR*)&up
+				0,
+				(FMOD_VECTOR*)&listener->position,
+				&velocity,
+				(FMOD_VECTOR*)&listener->forward,
+				(FMOD_VECTOR*)&listener->up
 			);
 			if (m_resultFMOD != FMOD_OK)
 			{
 				LogErrorFMOD(m_resultFMOD);
-				return false;
 			}
 		}
-		//=============================================================
 
-		TIME_BLOCK_END_CPU();
-
-		return true;
-	}
+		// Update FMOD
+		m_resultFMOD = m_systemFMOD->update();
+		if (m_resultFMOD != FMOD_OK)
+		{
+			LogErrorFMOD(m_resultFMOD);
+			return;
+		}
 
-	void Audio::SetListenerTransform(Transform* transform)
-	{
-		m_listener = transform;
+		// Voices
+		int voices		= 0;
+		int voicesReal	= 0;
+		if (m_systemFMOD->getChannelsPlaying(&voices, &voicesReal) == FMOD_OK)
+		{
+			Profiler::Get().m_audioVoices		= (unsigned int)voices;
+			Profiler::Get().m_audioVoicesReal	= (unsigned int)voicesReal;
+		}
+		Profiler::Get().m_audioSampleBytes = m_sampleCache->GetMemoryUsage();
 	}
 
 	void Audio::LogErrorFMOD(int error)
@@ -22,19 +22,27 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =================
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <memory>
 #include "../Core/SubSystem.h"
+#include "../Math/Vector3.h"
 //============================
 
 //= FORWARD DECLARATIONS =
 namespace FMOD
 {
 	class System;
+	class Channel;
 }
 //========================
 
 namespace Directus
 {
 	class Transform;
+	class AudioSampleCache;
 
 	class Audio : public Subsystem
 	{
@@ -48,9 +56,35 @@ namespace Directus
 
 		bool Update();
 		FMOD::System* GetSystemFMOD() { return m_systemFMOD; }
+		// Null when Audio isn't initialized (headless)
+		AudioSampleCache* GetSampleCache() { return m_sampleCache.get(); }
 		void SetListenerTransform(Transform* transform);
 
+		// Queues a channel's new position, the audio thread applies every queued one when it next updates FMOD.
+		// The channel can stop meanwhile, FMOD validates it's handles so that's harmless.
+		void Voice_SetPosition(FMOD::Channel* channel, const Math::Vector3& position);
+
 	private:
+		// The channel and listener attributes queued on the main thread, applied on the audio thread
+		struct Voice_Position
+		{
+			FMOD::Channel* channel;
+			Math::Vector3 position;
+		};
+
+		struct Listener_Attributes
+		{
+			Math::Vector3 position;
+			Math::Vector3 forward;
+			Math::Vector3 up;
+		};
+
+		//= AUDIO THREAD =======
+		void Thread_Loop();
+		void Thread_Kick();
+		void Thread_Stop();
+		void Thread_Update(const Listener_Attributes* listener);
+		//======================
 		void LogErrorFMOD(int error);
 
 		int m_resultFMOD;
@@ -59,5 +93,17 @@ namespace Directus
 		float m_distanceFactor;
 		bool m_initialized;
 		Transform* m_listener;
+		std::unique_ptr<AudioSampleCache> m_sampleCache;
+
+		// Audio thread, every frame is handed the positions that changed, applies them and updates FMOD
+		std::thread m_thread;
+		std::mutex m_threadMutex;
+		std::condition_variable m_threadCondition;
+		bool m_threadPending	= false;
+		bool m_threadStopping	= false;
+		std::vector<Voice_Position> m_voicesQueued;		// filled by the main thread
+		std::vector<Voice_Position> m_voicesApplying;	// drained by the audio thread, swapped with the above
+		Listener_Attributes m_listenerQueued;
+		bool m_listenerQueuedValid = false;
 	};
 }
\ No newline at end of file
@@ -25,6 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <fmod_errors.h>
 #include "../World/Components/Transform.h"
 #include "Audio.h"
+#include "AudioSampleCache.h"
+#include "../Core/Settings.h"
+#include "../FileSystem/FileSystem.h"
 //========================================
 
 //= NAMESPACES ================
@@ -38,12 +41,16 @@ namespace Directus
 	AudioClip::AudioClip(Context* context) : IResource(context, Resource_Audio)
 	{
 		// AudioClip
-		m_transform		= nullptr;
-		m_systemFMOD	= (System*)context->GetSubsystem<Audio>()->GetSystemFMOD();
+		m_transform			= nullptr;
+		m_transformRevision	= 0;
+		m_audio				= context->GetSubsystem<Audio>();
+		m_systemFMOD		= (System*)m_audio->GetSystemFMOD(); // null when Audio isn't initialized (headless)
 		m_result		= FMOD_OK;
 		m_soundFMOD		= nullptr;
 		m_channelFMOD	= nullptr;
-		m_playMode		= Play_Memory;
+		m_playMode			= Play_Memory;
+		m_sampleFormat		= Sample_Decoded;
+		m_sampleFormatSet	= false;
 		m_minDistance	= 1.0f;
 		m_maxDistance	= 10000.0f;
 		m_modeRolloff	= FMOD_3D_LINEARROLLOFF;
@@ -52,27 +59,54 @@ namespace Directus
 
 	AudioClip::~AudioClip()
 	{
-		if (!m_soundFMOD)
-			return;
-
-		m_result = m_soundFMOD->release();
-		if (m_result != FMOD_OK)
-		{
-			LogErrorFMOD(m_result);
-		}
+		// Released with the last clip holding it, a sample can stay in the cache after that
+		m_soundFMOD = nullptr;
+		m_sound.reset();
 	}
 
 	bool AudioClip::LoadFromFile(const std::string& filePath)
 	{
 		m_soundFMOD = nullptr;
+		m_sound.reset();
 		m_channelFMOD = nullptr;
 
+		if (!m_systemFMOD)
+			return false;
+
+		// Files that are compressed stay compressed in memory, unless told otherwise
+		if (!m_sampleFormatSet)
+		{
+			string extension	= FileSystem::GetExtensionFromFilePath(filePath);
+			m_sampleFormat		= (extension == ".ogg" || extension == ".mp3") ? Sample_Compressed : Sample_Decoded;
+		}
+
+		// Long clips (music, ambience) are streamed, decoding them whole would cost more memory than it saves in reads
+		unsigned long long streamThreshold = (unsigned long long)Settings::Get().AudioStreamThreshold_Get() * 1024;
+		if (m_playMode == Play_Memory && FileSystem::GetFileSize(filePath) > streamThreshold)
+		{
+			m_playMode = Play_Stream;
+		}
+
 		return m_playMode == Play_Memory ? CreateSound(filePath) : CreateStream(filePath);
 	}
 
 	unsigned int AudioClip::GetMemoryUsage()
 	{
-		return 0; // have to find a way to get that
+		// A stream only has it's buffer
+		return m_playMode == Play_Memory ? AudioSampleCache::GetSampleSize(m_soundFMOD) : 0;
+	}
+
+	bool AudioClip::SetSampleFormat(SampleFormat format)
+	{
+		bool reload			= m_sampleFormat != format && m_soundFMOD && m_playMode == Play_Memory;
+		m_sampleFormat		= format;
+		m_sampleFormatSet	= true;
+
+		if (!reload)
+			return true;
+
+		Stop();
+		return LoadFromFile(GetResourceFilePath());
 	}
 
 	bool AudioClip::Play()
@@ -94,7 +128,30 @@ namespace Directus
 		}
 
 		// Start playing the sound
-		m_result = m_systemFMOD->playSound(m_soundFMOD, nullptr, false, &m_channelFMOD);
+		if (!m_systemFMOD || !m_soundFMOD)
+			return false;
+
+		// Start paused, so it's first samples already play at the source's position
+		m_result = m_systemFMOD->playSound(m_soundFMOD, nullptr, true, &m_channelFMOD);
+		if (m_result != FMOD_OK)
+		{
+			LogErrorFMOD(m_result);
+			return false;
+		}
+
+		if (m_transform)
+		{
+			Vector3 pos			= m_transform->GetPosition();
+			FMOD_VECTOR fModPos	= { pos.x, pos.y, pos.z };
+			FMOD_VECTOR fModVel	= { 0, 0, 0 };
+			m_channelFMOD->set3DAttributes(&fModPos, &fModVel);
+			m_transformRevision = m_transform->GetRevision();
+		}
+
+		// The sample is shared, looping and rolloff are per channel
+		ApplyChannelMode();
+
+		m_result = m_channelFMOD->setPaused(false);
 		if (m_result != FMOD_OK)
 		{
 			LogErrorFMOD(m_result);
@@ -163,21 +220,18 @@ namespace Directus
 		if (!m_soundFMOD)
 			return false;
 
-		// Infite loops
-		if (loop)
+		// A stream is this clip's own, it's buffering depends on whether it loops
+		if (m_playMode == Play_Stream)
 		{
-			m_soundFMOD->setLoopCount(-1);
-		}
-
-		// Set the channel with the new mode
-		m_result = m_soundFMOD->setMode(GetSoundMode());
-		if (m_result != FMOD_OK)
-		{
-			LogErrorFMOD(m_result);
-			return false;
+			m_result = m_soundFMOD->setMode(GetSoundMode());
+			if (m_result != FMOD_OK)
+			{
+				LogErrorFMOD(m_result);
+				return false;
+			}
 		}
 
-		return true;
+		return IsChannelValid() ? ApplyChannelMode() : true;
 	}
 
 	bool AudioClip::SetVolume(float volume)
@@ -261,6 +315,7 @@ namespace Directus
 			return false;
 
 		SetRolloff(Custom);
+		ApplyChannelMode();
 
 		// Convert Vector3 to FMOD_VECTOR
 		vector<FMOD_VECTOR> fmodCurve;
@@ -298,22 +353,17 @@ namespace Directus
 
 	bool AudioClip::Update()
 	{
-		if (!IsChannelValid() || !m_transform)
+		// No FMOD calls here, querying the channel every frame would contend with the audio thread
+		if (!m_channelFMOD || !m_transform)
 			return true;
 
-		Vector3 pos = m_transform->GetPosition();
+		// Only sources that moved are queued, the audio thread applies them all in one go
+		Matrix& world = m_transform->GetWorldTransform();
+		if (m_transform->GetRevision() == m_transformRevision)
+			return true;
 
-		FMOD_VECTOR fModPos = { pos.x, pos.y, pos.z };
-		FMOD_VECTOR fModVel = { 0, 0, 0 };
-
-		// Set 3D attributes
-		m_result = m_channelFMOD->set3DAttributes(&fModPos, &fModVel);
-		if (m_result != FMOD_OK)
-		{
-			m_channelFMOD = nullptr;
-			LogErrorFMOD(m_result);
-			return false;
-		}
+		m_transformRevision = m_transform->GetRevision();
+		m_audio->Voice_SetPosition(m_channelFMOD, world.GetTranslation());
 
 		return true;
 	}
@@ -337,13 +387,16 @@ namespace Directus
 	//= CREATION ================================================
 	bool AudioClip::CreateSound(const string& filePath)
 	{
-		// Create sound
-		m_result = m_systemFMOD->createSound(filePath.c_str(), GetSoundMode(), nullptr, &m_soundFMOD);
-		if (m_result != FMOD_OK)
-		{
-			LogErrorFMOD(m_result);
+		auto sampleCache = m_audio->GetSampleCache();
+		if (!sampleCache)
+			return false;
+
+		// Shared with every clip of the file, so only what can't vary by channel goes in the mode
+		unsigned int mode = FMOD_3D | (m_sampleFormat == Sample_Compressed ? FMOD_CREATECOMPRESSEDSAMPLE : FMOD_CREATESAMPLE);
+		m_sound = sampleCache->Get(filePath, mode);
+		m_soundFMOD = m_sound.get();
+		if (!m_soundFMOD)
 			return false;
-		}
 
 		// Set 3D min max disance
 		m_result = m_soundFMOD->set3DMinMaxDistance(m_minDistance, m_maxDistance);
@@ -358,13 +411,14 @@ namespace Directus
 
 	bool AudioClip::CreateStream(const string& filePath)
 	{
-		// Create sound
+		// Create sound, a stream has a single read position so it's never shared
 		m_result = m_systemFMOD->createStream(filePath.c_str(), GetSoundMode(), nullptr, &m_soundFMOD);
 		if (m_result != FMOD_OK)
 		{
 			LogErrorFMOD(m_result);
 			return false;
 		}
+		m_sound = AudioSampleCache::Own(m_soundFMOD);
 
 		// Set 3D min max disance
 		m_result = m_soundFMOD->set3DMinMaxDistance(m_minDistance, m_maxDistance);
@@ -382,6 +436,26 @@ namespace Directus
 		return FMOD_3D | m_modeLoop | m_modeRolloff;
 	}
 
+	bool AudioClip::ApplyChannelMode()
+	{
+		m_result = m_channelFMOD->setMode(m_modeLoop | m_modeRolloff);
+		if (m_result != FMOD_OK)
+		{
+			LogErrorFMOD(m_result);
+			return false;
+		}
+
+		// Infinite loops
+		m_result = m_channelFMOD->setLoopCount(m_modeLoop == FMOD_LOOP_NORMAL ? -1 : 0);
+		if (m_result != FMOD_OK)
+		{
+			LogErrorFMOD(m_result);
+			return false;
+		}
+
+		return true;
+	}
+
 	void AudioClip::LogErrorFMOD(int error)
 	{
 		LOG_ERROR("AudioClip::FMOD: " + string(FMOD_ErrorString((FMOD_RESULT)error)));
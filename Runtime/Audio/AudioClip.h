@@ -38,6 +38,7 @@ namespace FMOD
 namespace Directus
 {
 	class Transform;
+	class Audio;
 
 	enum PlayMode
 	{
@@ -45,6 +46,13 @@ namespace Directus
 		Play_Stream
 	};
 
+	// How a sample is kept in memory, streams are read from disk instead
+	enum SampleFormat
+	{
+		Sample_Decoded,		// PCM, the cheapest to play
+		Sample_Compressed	// as it's in the file (Vorbis, ADPCM, MP3), decoded as it plays, PCM files stay PCM
+	};
+
 	enum Rolloff
 	{
 		Linear,
@@ -60,9 +68,14 @@ namespace Directus
 		//= IResource ========================================================
 		bool LoadFromFile(const std::string& filePath) override;
 		bool SaveToFile(const std::string& filePath) override { return true; }
+		// Of the sample it plays, which other clips of the same file share
 		unsigned int GetMemoryUsage() override;
 		//====================================================================
 
+		// Defaults to compressed for compressed files (.ogg, .mp3), reloads the sample if the clip is loaded
+		bool SetSampleFormat(SampleFormat format);
+		SampleFormat GetSampleFormat() { return m_sampleFormat; }
+
 		bool Play();
 		bool Pause();
 		bool Stop();
@@ -92,7 +105,7 @@ namespace Directus
 		// Makes the audio use the 3D attributes of the transform
 		void SetTransform(Transform* transform) { m_transform = transform; }
 
-		// Should be called per frame to update the 3D attributes of the sound
+		// Should be called per frame, queues the 3D attributes of the sound when it's transform moved
 		bool Update();
 
 		bool IsPlaying();
@@ -103,14 +116,20 @@ namespace Directus
 		bool CreateStream(const std::string& filePath);
 		//=============================================
 		int GetSoundMode();
+		bool ApplyChannelMode();
 		void LogErrorFMOD(int error);
 		bool IsChannelValid();
 
 		Transform* m_transform;
+		unsigned int m_transformRevision;	// of the transform, when it's position was last queued
+		Audio* m_audio;
 		FMOD::System* m_systemFMOD;
 		FMOD::Sound* m_soundFMOD;
+		std::shared_ptr<FMOD::Sound> m_sound; // owns m_soundFMOD, with the sample cache when it's not a stream
 		FMOD::Channel* m_channelFMOD;	
 		PlayMode m_playMode;
+		SampleFormat m_sampleFormat;
+		bool m_sampleFormatSet;
 		int m_modeLoop;
 		float m_minDistance;
 		float m_maxDistance;
@@ -0,0 +1,127 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "AudioSampleCache.h"
+#include <vector>
+#include <algorithm>
+#include <fmod.hpp>
+#include <fmod_errors.h>
+#include "../Logging/Log.h"
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace FMOD;
+//==================
+
+namespace Directus
+{
+	AudioSampleCache::~AudioSampleCache()
+	{
+		// Clips still holding a sample release it when they go
+		m_samples.clear();
+	}
+
+	shared_ptr<Sound> AudioSampleCache::Get(const string& filePath, unsigned int mode)
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		string key = filePath + "|" + to_string(mode);
+		auto it = m_samples.find(key);
+		if (it != m_samples.end())
+		{
+			it->second.lastUsed = ++m_uses;
+			return it->second.sound;
+		}
+
+		Sound* sound = nullptr;
+		FMOD_RESULT result = m_system->createSound(filePath.c_str(), (FMOD_MODE)mode, nullptr, &sound);
+		if (result != FMOD_OK)
+		{
+			LOGF_ERROR("AudioSampleCache::Get: %s, %s", FMOD_ErrorString(result), filePath.c_str());
+			return nullptr;
+		}
+
+		Sample sample;
+		sample.sound	= Own(sound);
+		sample.size		= GetSampleSize(sound);
+		sample.lastUsed	= ++m_uses;
+		m_memoryUsage += sample.size;
+		m_samples[key] = sample;
+
+		Trim();
+
+		return sample.sound;
+	}
+
+	shared_ptr<Sound> AudioSampleCache::Own(Sound* sound)
+	{
+		return shared_ptr<Sound>(sound, [](Sound* sound)
+		{
+			FMOD_RESULT result = sound->release();
+			if (result != FMOD_OK)
+			{
+				LOGF_ERROR("AudioSampleCache::Own: %s", FMOD_ErrorString(result));
+			}
+		});
+	}
+
+	unsigned int AudioSampleCache::GetSampleSize(Sound* sound)
+	{
+		if (!sound)
+			return 0;
+
+		// A compressed sample stays as it was in the file, a decoded one is PCM
+		FMOD_MODE mode = 0;
+		sound->getMode(&mode);
+		unsigned int size = 0;
+		sound->getLength(&size, (mode & FMOD_CREATECOMPRESSEDSAMPLE) ? FMOD_TIMEUNIT_RAWBYTES : FMOD_TIMEUNIT_PCMBYTES);
+
+		return size;
+	}
+
+	void AudioSampleCache::Trim()
+	{
+		if (m_memoryUsage <= m_budget)
+			return;
+
+		// The samples only the cache holds, least recently used first
+		vector<unordered_map<string, Sample>::iterator> unused;
+		for (auto it = m_samples.begin(); it != m_samples.end(); it++)
+		{
+			if (it->second.sound.use_count() == 1)
+			{
+				unused.emplace_back(it);
+			}
+		}
+		sort(unused.begin(), unused.end(), [](const auto& a, const auto& b) { return a->second.lastUsed < b->second.lastUsed; });
+
+		for (const auto& it : unused)
+		{
+			if (m_memoryUsage <= m_budget)
+				break;
+
+			m_memoryUsage -= it->second.size;
+			m_samples.erase(it);
+		}
+	}
+}
@@ -0,0 +1,78 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =============
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+//========================
+
+//= FORWARD DECLARATIONS =
+namespace FMOD
+{
+	class System;
+	class Sound;
+}
+//========================
+
+namespace Directus
+{
+	// The sample data of a file, decoded or left compressed, shared by every clip that plays it. Samples no clip
+	// holds anymore stay resident while everything fits the budget, so a clip that comes back doesn't load again.
+	// Past the budget the least recently used of those go first, the ones clips hold are never released.
+	class AudioSampleCache
+	{
+	public:
+		AudioSampleCache(FMOD::System* system) { m_system = system; }
+		~AudioSampleCache();
+
+		// The sample of a file, as created with these FMOD_MODE flags, loaded if it's not resident
+		std::shared_ptr<FMOD::Sound> Get(const std::string& filePath, unsigned int mode);
+
+		void SetBudget(unsigned long long bytes)	{ m_budget = bytes; }
+		unsigned long long GetMemoryUsage()			{ std::lock_guard<std::mutex> lock(m_mutex); return m_memoryUsage; }
+
+		// Owns a sound created elsewhere (a stream), releasing it with the last reference
+		static std::shared_ptr<FMOD::Sound> Own(FMOD::Sound* sound);
+		// Bytes a sound's sample takes in memory, compressed or not
+		static unsigned int GetSampleSize(FMOD::Sound* sound);
+
+	private:
+		struct Sample
+		{
+			std::shared_ptr<FMOD::Sound> sound;
+			unsigned int size;
+			unsigned long long lastUsed;
+		};
+
+		void Trim();
+
+		FMOD::System* m_system;
+		std::unordered_map<std::string, Sample> m_samples; // by file path and mode
+		unsigned long long m_budget			= 0;
+		unsigned long long m_memoryUsage	= 0;
+		unsigned long long m_uses			= 0;
+		std::mutex m_mutex;
+	};
+}
@@ -21,18 +21,27 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==========
+//= INCLUDES ==============
 #include <vector>
+#include <atomic>
 #include "EngineDefs.h"
 #include "SubSystem.h"
-//=====================
+#include "FrameAllocator.h"
+//=========================
+
+// Subsystem types that get a slot, lookups of any past these walk the subsystems every time
+#define CONTEXT_SUBSYSTEM_SLOTS 128
 
 namespace Directus
 {
 	class ENGINE_CLASS Context
 	{
 	public:
-		Context() {}
+		Context()
+		{
+			for (auto& slot : m_slots)
+				slot = nullptr;
+		}
 
 		~Context()
 		{
@@ -53,20 +62,44 @@ namespace Directus
 			m_subsystems.emplace_back(subsystem);
 		}
 
-		// Get a subsystem
+		// Get a subsystem, the first lookup of a type compares it with every subsystem, the rest index it's slot
 		template <class T> T* GetSubsystem();
+
+		// Memory for data that doesn't outlive the next frame (see FrameAllocator)
+		FrameAllocator* GetFrameAllocator() { return &m_frameAllocator; }
+		template <typename T>
+		FrameAllocatorSTL<T> GetFrameAllocatorSTL() { return FrameAllocatorSTL<T>(&m_frameAllocator); }
+
 	private:
+		// Every module that instantiates GetSubsystem<T> (the engine, the editor) gives the type a slot of it's own,
+		// they are handed out by the engine so they never collide
+		static unsigned int Slot_Allocate();
+		template <class T> static unsigned int Slot_Get() { static const unsigned int slot = Slot_Allocate(); return slot; }
+
 		std::vector<Subsystem*> m_subsystems;
+		std::atomic<Subsystem*> m_slots[CONTEXT_SUBSYSTEM_SLOTS]; // by slot, filled on the first lookup
+		FrameAllocator m_frameAllocator;
 	};
 
 	template <class T>
 	T* Context::GetSubsystem()
 	{
+		// Found before
+		unsigned int slot = Slot_Get<T>();
+		if (slot < CONTEXT_SUBSYSTEM_SLOTS)
+		{
+			if (auto subsystem = m_slots[slot].load(std::memory_order_acquire))
+				return static_cast<T*>(subsystem);
+		}
+
 		// Compare T with subsystem types
 		for (const auto& subsystem : m_subsystems)
 		{
 			if (typeid(T) == typeid(*subsystem))
+			{
+				if (slot < CONTEXT_SUBSYSTEM_SLOTS) m_slots[slot].store(subsystem, std::memory_order_release);
 				return static_cast<T*>(subsystem);
+			}
 		}
 
 		return nullptr;
@@ -25,15 +25,22 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Settings.h"
 #include "Stopwatch.h"
 #include "../Rendering/Renderer.h"
+#include "../RHI/RHI_Device.h"
 #include "../Core/EventSystem.h"
 #include "../Logging/Log.h"
 #include "../Threading/Threading.h"
+#include "../World/World.h"
+#include "../World/Components/Transform.h"
 #include "../Resource/ResourceManager.h"
+#include "../FileSystem/FileIndex.h"
+#include "../IO/AsyncIO.h"
+#include "../Resource/TextureStreaming.h"
 #include "../Scripting/Scripting.h"
 #include "../Audio/Audio.h"
 #include "../Physics/Physics.h"
 #include "../World/World.h"
 #include "../Profiling/Profiler.h"
+#include "../Profiling/ProfilerRemote.h"
 #include "../Input/Input.h"
 //======================================
 
@@ -51,12 +58,17 @@ namespace Directus
 
 	Engine::Engine(Context* context) : Subsystem(context)
 	{
+		bool headless = EngineMode_IsSet(Engine_Headless);
 		m_flags |= Engine_Update;
-		m_flags |= Engine_Render;
 		m_flags |= Engine_Physics;
 		m_flags |= Engine_Game;
+		if (!headless)
+		{
+			m_flags |= Engine_Render;
+		}
 
 		m_timer			= nullptr;
+		m_renderer		= nullptr;
 		g_stopwatch		= make_unique<Stopwatch>();
 
 		// Register self as a subsystem
@@ -67,12 +79,19 @@ namespace Directus
 		FileSystem::Initialize();
 		Settings::Get().Initialize();
 
-		// Register subsystems
+		// Register subsystems. Headless, there is no Renderer (nor TextureStreaming, which feeds it), while
+		// Input and Audio are registered but never initialized, so scripts and components find them idle.
 		m_context->RegisterSubsystem(new Timer(m_context));
 		m_context->RegisterSubsystem(new Input(m_context));
 		m_context->RegisterSubsystem(new Threading(m_context));
 		m_context->RegisterSubsystem(new ResourceManager(m_context));
-		m_context->RegisterSubsystem(new Renderer(m_context, m_drawHandle));
+		m_context->RegisterSubsystem(new FileIndex(m_context));
+		m_context->RegisterSubsystem(new AsyncIO(m_context));
+		if (!headless)
+		{
+			m_context->RegisterSubsystem(new TextureStreaming(m_context));
+			m_context->RegisterSubsystem(new Renderer(m_context, m_drawHandle));
+		}
 		m_context->RegisterSubsystem(new Audio(m_context));
 		m_context->RegisterSubsystem(new Physics(m_context));
 		m_context->RegisterSubsystem(new Scripting(m_context));
@@ -81,6 +100,8 @@ namespace Directus
 
 	bool Engine::Initialize()
 	{
+		bool headless = EngineMode_IsSet(Engine_Headless);
+
 		// Timer
 		m_timer = m_context->GetSubsystem<Timer>();
 		if (!m_timer->Initialize())
@@ -90,7 +111,7 @@ namespace Directus
 		}
 	
 		// Input
-		if (!m_context->GetSubsystem<Input>()->Initialize())
+		if (!headless && !m_context->GetSubsystem<Input>()->Initialize())
 		{
 			LOG_ERROR("Engine::Initialize: Failed to initialize Input");
 			return false;
@@ -103,47 +124,64 @@ namespace Directus
 			return false;
 		}
 
-		// ResourceManager
-		if (!m_context->GetSubsystem<ResourceManager>()->Initialize())
+		// AsyncIO, the rest reads through it
+		if (!m_context->GetSubsystem<AsyncIO>()->Initialize())
 		{
-			LOG_ERROR("Engine::Initialize: Failed to initialize ResourceManager");
+			LOG_ERROR("Engine::Initialize: Failed to initialize AsyncIO");
 			return false;
 		}
 
-		// Renderer
-		if (!m_context->GetSubsystem<Renderer>()->Initialize())
+		// The rest is mostly independent (shader compilation, the Bullet world, the AngelScript engine), each starts on the
+		// pool as soon as what it needs is done. The RHI device and swap chain already exist, the Renderer created them.
+		Stopwatch stopwatch;
+		auto threading		= m_context->GetSubsystem<Threading>();
+		atomic<bool> failed	= false;
+		auto Initialize_Timed = [&failed](const char* name, Subsystem* subsystem)
 		{
-			LOG_ERROR("Engine::Initialize: Failed to initialize Renderer");
-			return false;
-		}
+			// Nothing depending on a failed one runs
+			if (failed)
+				return;
 
-		// Audio
-		if (!m_context->GetSubsystem<Audio>()->Initialize())
+			Stopwatch stopwatch;
+			if (!subsystem->Initialize())
+			{
+				LOGF_ERROR("Engine::Initialize: Failed to initialize %s", name);
+				failed = true;
+				return;
+			}
+			LOGF_INFO("Engine::Initialize: %s initialized in %.1f ms", name, stopwatch.GetElapsedTimeMs());
+		};
+		auto Initialize_Async = [&threading, &Initialize_Timed](const char* name, Subsystem* subsystem, const vector<JobHandle>& dependencies)
 		{
-			LOG_ERROR("Engine::Initialize: Failed to initialize Audio");
-			return false;
-		}
+			if (!subsystem)
+				return JobHandle();
+
+			return threading->Job_Add([&Initialize_Timed, name, subsystem]() { Initialize_Timed(name, subsystem); }, dependencies);
+		};
+
+		m_renderer				= m_context->GetSubsystem<Renderer>(); // not there when headless
+		JobHandle resources		= Initialize_Async("ResourceManager",	m_context->GetSubsystem<ResourceManager>(),		{});
+		JobHandle streaming		= Initialize_Async("TextureStreaming",	m_context->GetSubsystem<TextureStreaming>(),	{});
+		JobHandle renderer		= Initialize_Async("Renderer",			m_renderer,										{ resources, streaming });
+		JobHandle physics		= Initialize_Async("Physics",			m_context->GetSubsystem<Physics>(),				{});
+		JobHandle scripting		= Initialize_Async("Scripting",			m_context->GetSubsystem<Scripting>(),			{});
 
-		// Physics
-		if (!m_context->GetSubsystem<Physics>()->Initialize())
+		// Audio stays on this thread, FMOD sets up it's output through COM on the thread that initializes it. It runs meanwhile.
+		if (!headless)
 		{
-			LOG_ERROR("Engine::Initialize: Failed to initialize Physics");
-			return false;
+			Initialize_Timed("Audio", m_context->GetSubsystem<Audio>());
 		}
 
-		// Scripting
-		if (!m_context->GetSubsystem<Scripting>()->Initialize())
-		{
-			LOG_ERROR("Engine::Initialize: Failed to initialize Scripting");
+		threading->Job_Wait(threading->Job_Group({ resources, streaming, renderer, physics, scripting }));
+		if (failed)
 			return false;
-		}
 
-		// Scene
-		if (!m_context->GetSubsystem<World>()->Initialize())
-		{
-			LOG_ERROR("Engine::Initialize: Failed to initialize Scene");
+		// Last, it creates actors whose components use all of the above
+		Initialize_Timed("World", m_context->GetSubsystem<World>());
+		if (failed)
 			return false;
-		}
+
+		LOGF_INFO("Engine::Initialize: Subsystems initialized in %.1f ms", stopwatch.GetElapsedTimeMs());
 
 		Profiler::Get().Initialize(m_context);
 		g_stopwatch->Start();
@@ -153,24 +191,87 @@ namespace Directus
 
 	void Engine::Tick()
 	{
+		// With low latency the frame starts once the swap chain can take it, so input and simulation are as late as they can be
+		if (EngineMode_IsSet(Engine_Render) && m_renderer)
+		{
+			m_renderer->GetRHIDevice()->Present_Wait();
+		}
 		m_timer->Tick();
+		m_context->GetFrameAllocator()->Frame_Begin();
+		EventSystem::Get().Dispatch();
 		FIRE_EVENT(EVENT_FRAME_START);
 
+		bool pipelined = EngineMode_IsSet(Engine_Pipelined) && EngineMode_IsSet(Engine_Render) && m_renderer;
+		if (!pipelined)
+		{
+			// A frame might still be rendering from before pipelining got disabled
+			RenderThread_Wait();
+			if (m_renderer)
+			{
+				m_renderer->Pipelined_Set(false);
+			}
+
+			if (EngineMode_IsSet(Engine_Update))
+			{
+				Simulate();
+			}
+
+			if (EngineMode_IsSet(Engine_Render))
+			{
+				FIRE_EVENT(EVENT_RENDER);
+			}
+
+			FIRE_EVENT(EVENT_FRAME_END);
+			return;
+		}
+
+		// Simulate the next frame while the previous one renders, the renderer reads transforms and the camera from
+		// the snapshot it's handed at the end of this tick, and defers a world submission to before the next frame.
+		m_renderer->Pipelined_Set(true);
 		if (EngineMode_IsSet(Engine_Update))
 		{
+			Simulate();
+		}
+		m_renderer->Snapshot_Capture();
+
+		// Nothing but the render thread touches the device while it renders, whatever runs on
+		// frame end (e.g. texture streaming) can, so that has to wait for the previous frame.
+		RenderThread_Wait();
+		FIRE_EVENT(EVENT_FRAME_END);
+
+		m_renderer->Snapshot_Swap();
+		RenderThread_Kick();
+	}
+
+	void Engine::Simulate()
+	{
+		World* world = m_context->GetSubsystem<World>();
+
+		if (!EngineMode_IsSet(Engine_FixedStep))
+		{
+			Transform::Tick_Begin();
 			FIRE_EVENT_DATA(EVENT_TICK, m_timer->GetDeltaTimeSec());
+			if (world) world->Transforms_Interpolate(1.0f);
+			return;
 		}
 
-		if (EngineMode_IsSet(Engine_Render))
+		// A frame can take zero steps (rendering faster than the step) or several (slower), either
+		// way what's rendered is blended between the last two steps by how far past the last one it is.
+		unsigned int steps = m_timer->FixedStep_Accumulate();
+		for (unsigned int i = 0; i < steps; i++)
 		{
-			FIRE_EVENT(EVENT_RENDER);
+			Transform::Tick_Begin();
+			FIRE_EVENT_DATA(EVENT_TICK, m_timer->FixedStep_Get());
 		}
 
-		FIRE_EVENT(EVENT_FRAME_END);
+		if (world) world->Transforms_Interpolate(m_timer->FixedStep_GetAlpha());
 	}
 
 	void Engine::Shutdown()
 	{
+		RenderThread_Stop();
+		ProfilerRemote::Server_Stop();
+
 		// The context will deallocate the subsystems
 		// in the reverse order in which they were registered.
 		SafeDelete(m_context);
@@ -190,4 +291,61 @@ namespace Directus
 	{
 		return m_timer->GetDeltaTimeSec();
 	}
+
+	void Engine::RenderThread_Loop()
+	{
+		while (true)
+		{
+			unique_lock<mutex> lock(m_renderMutex);
+			m_renderCondition.wait(lock, [this] { return m_renderPending || m_renderStopping; });
+			if (m_renderStopping)
+				return;
+			lock.unlock();
+
+			FIRE_EVENT(EVENT_RENDER);
+			m_renderer->Present();
+
+			lock.lock();
+			m_renderPending = false;
+			lock.unlock();
+			m_renderCondition.notify_all();
+		}
+	}
+
+	void Engine::RenderThread_Kick()
+	{
+		if (!m_renderThread.joinable())
+		{
+			m_renderThread = thread(&Engine::RenderThread_Loop, this);
+		}
+
+		{
+			lock_guard<mutex> lock(m_renderMutex);
+			m_renderPending = true;
+		}
+		m_renderCondition.notify_all();
+	}
+
+	void Engine::RenderThread_Wait()
+	{
+		if (!m_renderThread.joinable())
+			return;
+
+		unique_lock<mutex> lock(m_renderMutex);
+		m_renderCondition.wait(lock, [this] { return !m_renderPending; });
+	}
+
+	void Engine::RenderThread_Stop()
+	{
+		if (!m_renderThread.joinable())
+			return;
+
+		RenderThread_Wait();
+		{
+			lock_guard<mutex> lock(m_renderMutex);
+			m_renderStopping = true;
+		}
+		m_renderCondition.notify_all();
+		m_renderThread.join();
+	}
 }
\ No newline at end of file
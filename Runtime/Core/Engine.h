@@ -16,10 +16,13 @@ DEALINGS IN THE SOFTWARE. */
 
 #pragma once
 
-//= INCLUDES =========
+//= INCLUDES ==============
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "Context.h"
 #include "SubSystem.h"
-//====================
+//=========================
 
 namespace Directus
 {
@@ -29,9 +32,14 @@ namespace Directus
 		Engine_Physics	= 1UL << 1, // Should the physics update?	
 		Engine_Render	= 1UL << 2,	// Should the engine render?
 		Engine_Game		= 1UL << 3,	// Is the engine running in game or editor mode?
+		Engine_Pipelined = 1UL << 4,	// Should the next frame simulate while this one renders? (the render thread presents)
+		Engine_Headless	= 1UL << 5,	// No renderer (or device), audio or input, the world ticks at a fixed rate. Has to be set before the engine is created.
+		Engine_FixedStep = 1UL << 6,	// Should the simulation tick in fixed steps? (rendering blends transforms between the last two)
+		Engine_Benchmark = 1UL << 7,	// Ticks as fast as it can, but every frame advances by the same time so each run simulates the same frames
 	};
 
 	class Timer;
+	class Renderer;
 
 	class ENGINE_CLASS Engine : public Subsystem
 	{
@@ -43,7 +51,8 @@ namespace Directus
 		bool Initialize() override;
 		//=========================
 
-		// Performs a complete simulation cycle
+		// Performs a complete simulation cycle. When pipelined it returns as soon as the frame is handed to the render
+		// thread, which also presents it, so a host that draws on top of the frame (e.g. the editor) can't pipeline.
 		void Tick();
 		// Shuts down the engine
 		void Shutdown();
@@ -80,5 +89,25 @@ namespace Directus
 		static void* m_windowInstance;
 		static unsigned long m_flags;
 		Timer* m_timer;
+		Renderer* m_renderer;
+
+		// Ticks the simulation, once or as many fixed steps as the frame's time adds up to (see Engine_FixedStep)
+		void Simulate();
+
+		//= RENDER THREAD ==================================================================
+		// Renders and presents a frame, while the next one simulates (see Engine_Pipelined)
+		void RenderThread_Loop();
+		// Hands the render thread a frame, starting it if needed
+		void RenderThread_Kick();
+		// Blocks until the render thread is done with the frame it was handed
+		void RenderThread_Wait();
+		void RenderThread_Stop();
+
+		std::thread m_renderThread;
+		std::mutex m_renderMutex;
+		std::condition_variable m_renderCondition;
+		bool m_renderPending	= false;
+		bool m_renderStopping	= false;
+		//==================================================================================
 	};
 }
\ No newline at end of file
@@ -21,49 +21,71 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ===============
-#include <map>
+//= INCLUDES ==========
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <functional>
-#include "../Core/Variant.h"
-//==========================
+#include <atomic>
+#include "EngineDefs.h"
+#include "RingQueue.h"
+//=====================
 
 /*
 HOW TO USE
 =============================================================================
 To subscribe a function to an event	-> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
 To fire an event					-> FIRE_EVENT(EVENT_ID);
-To fire an event with data			-> FIRE_EVENT_DATA(EVENT_ID, Variant)
+To fire an event with data			-> FIRE_EVENT_DATA(EVENT_ID, data)
+To fire from any thread				-> QUEUE_EVENT(EVENT_ID) or QUEUE_EVENT_DATA(EVENT_ID, data),
+									   dispatched on the main thread when the next frame starts
 =============================================================================
 */
 
 //= EVENTS =============================================================================================
 #define EVENT_FRAME_START			0	// Signifies that a frame begins
 #define EVENT_FRAME_END				1	// Signifies that that a frame ends
-#define EVENT_TICK					2	// Signifies that subsystems should tick
+#define EVENT_TICK					2	// Signifies that subsystems should tick (data: float, delta time in seconds)
 #define EVENT_RENDER				3	// Signifies that Renderer should output a frame
 
 #define EVENT_WORLD_SAVED			4	// Signifies that the World finished saving to file
 #define EVENT_WORLD_LOADED			5	// Signifies that the World finished loading from file
 #define EVENT_WORLD_UNLOAD			6	// Signifies that the World should clear everything
 #define EVENT_WORLD_RESOLVE			7	// Signifies that the World should resolve
-#define EVENT_WORLD_SUBMIT			8	// Signifies that the World is submitting actors to the Renderer
+#define EVENT_WORLD_SUBMIT			8	// Signifies that the World is submitting actors to the Renderer (data: vector<shared_ptr<Actor>>)
 #define EVENT_WORLD_STOP			9	// Signifies that The World should stop ticking
 #define EVENT_WORLD_START			10	// Signifies that The World should start ticking
+#define EVENT_WORLD_ACTOR_CHANGED	11	// Signifies that an actor's components have changed (data: weak_ptr<Actor>)
+#define EVENT_WORLD_ACTOR_REMOVED	12	// Signifies that an actor is being removed from the World (data: weak_ptr<Actor>)
+#define EVENT_MATERIAL_CHANGED		13	// Signifies that a material changed in a way that affects how it's sorted (e.g. opacity)
+#define EVENT_COUNT					14
 //======================================================================================================
 
+#define EVENT_QUEUE_SIZE 256 // events queued between two dispatches without taking a lock, more go to a locked overflow
+
 //= MACROS ===============================================================================================
-#define EVENT_HANDLER_STATIC(function)			[](Directus::Variant var)		{ function(); }
-#define EVENT_HANDLER(function)					[this](Directus::Variant var)	{ function(); }
-#define EVENT_HANDLER_VARIANT(function)			[this](Directus::Variant var)	{ function(var); }
-#define EVENT_HANDLER_VARIANT_STATIC(function)	[](Directus::Variant var)		{ function(var); }
-#define SUBSCRIBE_TO_EVENT(eventID, function)	Directus::EventSystem::Get().Subscribe(eventID, function);
-#define FIRE_EVENT(eventID)						Directus::EventSystem::Get().Fire(eventID)
-#define FIRE_EVENT_DATA(eventID, data)			Directus::EventSystem::Get().Fire(eventID, data)
+#define EVENT_HANDLER_STATIC(function)			[](const auto&)				{ function(); }
+#define EVENT_HANDLER(function)					[this](const auto&)			{ function(); }
+#define EVENT_HANDLER_DATA(function)			[this](const auto& data)	{ function(data); }
+#define EVENT_HANDLER_DATA_STATIC(function)		[](const auto& data)		{ function(data); }
+#define SUBSCRIBE_TO_EVENT(eventID, function)	Directus::EventSystem::Get().Subscribe<eventID>(function);
+#define FIRE_EVENT(eventID)						Directus::EventSystem::Get().Fire<eventID>()
+#define FIRE_EVENT_DATA(eventID, data)			Directus::EventSystem::Get().Fire<eventID>(data)
+#define QUEUE_EVENT(eventID)					Directus::EventSystem::Get().Queue<eventID>()
+#define QUEUE_EVENT_DATA(eventID, data)			Directus::EventSystem::Get().Queue<eventID>(data)
 //========================================================================================================
 
 namespace Directus
 {
+	class Actor;
+
+	// What an event carries, resolved at compile time from the event's ID
+	template <int eventID> struct EventData									{ typedef std::nullptr_t Type; };
+	template <> struct EventData<EVENT_TICK>								{ typedef float Type; };
+	template <> struct EventData<EVENT_WORLD_SUBMIT>						{ typedef std::vector<std::shared_ptr<Actor>> Type; };
+	template <> struct EventData<EVENT_WORLD_ACTOR_CHANGED>					{ typedef std::weak_ptr<Actor> Type; };
+	template <> struct EventData<EVENT_WORLD_ACTOR_REMOVED>					{ typedef std::weak_ptr<Actor> Type; };
+
 	class ENGINE_CLASS EventSystem
 	{
 	public:
@@ -73,26 +95,121 @@ namespace Directus
 			return instance;
 		}
 
-		typedef std::function<void(Variant)> subscriber;
+		template <int eventID>
+		using Subscriber = std::function<void(const typename EventData<eventID>::Type&)>;
 
-		void Subscribe(int eventID, subscriber&& func)
+		template <int eventID>
+		void Subscribe(Subscriber<eventID>&& subscriber)
 		{
-			m_subscribers[eventID].push_back(std::forward<subscriber>(func));
+			Subscribers<eventID>(true)->emplace_back(std::forward<Subscriber<eventID>>(subscriber));
 		}
 
-		void Fire(int eventID, const Variant& data = 0)
+		// Hands the data to every subscriber by reference, nothing gets copied or looked up
+		template <int eventID>
+		void Fire(const typename EventData<eventID>::Type& data = typename EventData<eventID>::Type())
 		{
-			if (m_subscribers.find(eventID) == m_subscribers.end())
+			auto subscribers = Subscribers<eventID>(false);
+			if (!subscribers)
 				return;
 
-			for (const auto& subscriber : m_subscribers[eventID])
+			for (const auto& subscriber : *subscribers)
 			{
 				subscriber(data);
 			}
 		}
-		void Clear() { m_subscribers.clear(); }
+
+		// Fires on the main thread when the next frame starts (see Dispatch), safe to call from any thread
+		template <int eventID>
+		void Queue(const typename EventData<eventID>::Type& data = typename EventData<eventID>::Type())
+		{
+			std::function<void()> event = [this, data]() { Fire<eventID>(data); };
+
+			// Once something overflowed, the rest follows it until the next dispatch, so a thread's events stay in order
+			if (!m_overflowing.load(std::memory_order_acquire) && m_queue.Push(std::move(event)))
+				return;
+
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_overflowing.store(true, std::memory_order_release);
+			m_overflow.emplace_back(std::move(event));
+		}
+
+		// Fires the queued events (in the order they were queued), events they queue wait for the next dispatch
+		void Dispatch()
+		{
+			// What's in the queue now was queued before any of the overflow
+			std::function<void()> event;
+			while (m_queue.Pop(event))
+			{
+				m_queueDispatching.emplace_back(std::move(event));
+			}
+
+			if (m_overflowing.load(std::memory_order_acquire))
+			{
+				std::lock_guard<std::mutex> lock(m_queueMutex);
+				while (m_queue.Pop(event))
+				{
+					m_queueDispatching.emplace_back(std::move(event));
+				}
+				for (auto& overflow : m_overflow)
+				{
+					m_queueDispatching.emplace_back(std::move(overflow));
+				}
+				m_overflow.clear();
+				m_overflowing.store(false, std::memory_order_release);
+			}
+
+			for (const auto& event : m_queueDispatching)
+			{
+				event();
+			}
+			m_queueDispatching.clear();
+		}
+
+		void Clear()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_subscribersMutex);
+				for (auto& subscribers : m_subscribers)
+				{
+					subscribers.reset();
+				}
+			}
+
+			while (m_queue.Front())
+			{
+				m_queue.Pop();
+			}
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_overflow.clear();
+			m_overflowing = false;
+		}
 
 	private:
-		std::map<uint8_t, std::vector<subscriber>> m_subscribers;
+		// A flat array per event, created by the first subscriber. They are kept by the instance (not in statics of the
+		// templates), the engine's DLL and whatever links against it fire to and subscribe the same ones.
+		template <int eventID>
+		std::vector<Subscriber<eventID>>* Subscribers(bool create)
+		{
+			static_assert(eventID >= 0 && eventID < EVENT_COUNT, "EventSystem: Unknown event ID");
+
+			auto& subscribers = m_subscribers[eventID];
+			if (!subscribers && create)
+			{
+				std::lock_guard<std::mutex> lock(m_subscribersMutex);
+				if (!subscribers)
+				{
+					subscribers = std::make_shared<std::vector<Subscriber<eventID>>>();
+				}
+			}
+			return static_cast<std::vector<Subscriber<eventID>>*>(subscribers.get());
+		}
+
+		std::shared_ptr<void> m_subscribers[EVENT_COUNT]; // a std::vector<Subscriber<eventID>> each
+		std::mutex m_subscribersMutex;
+		RingQueue_MPSC<std::function<void()>, EVENT_QUEUE_SIZE> m_queue; // dispatching is the only consumer
+		std::vector<std::function<void()>> m_queueDispatching; // kept around so it's memory gets reused
+		std::vector<std::function<void()>> m_overflow;
+		std::atomic<bool> m_overflowing = false;
+		std::mutex m_queueMutex; // guards the overflow
 	};
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "FrameAllocator.h"
+#include <cstdlib>
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	namespace _FrameAllocator
+	{
+		void* Heap_Allocate(size_t size, size_t alignment)
+		{
+#ifdef _MSC_VER
+			return _aligned_malloc(size, alignment);
+#else
+			return aligned_alloc(alignment, size);
+#endif
+		}
+
+		void Heap_Free(void* memory)
+		{
+#ifdef _MSC_VER
+			_aligned_free(memory);
+#else
+			free(memory);
+#endif
+		}
+	}
+
+	FrameAllocator::FrameAllocator()
+	{
+		for (auto& buffer : m_buffers)
+		{
+			buffer.capacity	= FRAME_ALLOCATOR_CAPACITY;
+			buffer.memory	= make_unique<std::byte[]>(buffer.capacity);
+		}
+	}
+
+	FrameAllocator::~FrameAllocator()
+	{
+		for (auto& buffer : m_buffers)
+		{
+			for (auto memory : buffer.overflow)
+			{
+				_FrameAllocator::Heap_Free(memory);
+			}
+		}
+	}
+
+	void* FrameAllocator::Allocate(size_t size, size_t alignment /*= alignof(max_align_t)*/)
+	{
+		auto& buffer = m_buffers[m_current];
+
+		// Bump the offset, past whatever aligns the allocation, unless someone else bumped it first
+		auto base	= reinterpret_cast<uintptr_t>(buffer.memory.get());
+		auto offset	= buffer.offset.load();
+		size_t aligned;
+		do
+		{
+			aligned = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+			if (aligned + size > buffer.capacity)
+				break;
+		} while (!buffer.offset.compare_exchange_weak(offset, aligned + size));
+
+		if (aligned + size <= buffer.capacity)
+			return buffer.memory.get() + aligned;
+
+		// Out of space, fall back to the heap until the buffer grows
+		size_t sizeAligned = (size + alignment - 1) & ~(alignment - 1);
+		void* memory = _FrameAllocator::Heap_Allocate(sizeAligned, alignment);
+		lock_guard<mutex> lock(buffer.overflowMutex);
+		buffer.overflow.emplace_back(memory);
+		buffer.overflowSize += sizeAligned + alignment;
+		return memory;
+	}
+
+	void FrameAllocator::Frame_Begin()
+	{
+		unsigned int next = (m_current + 1) % 2;
+		Reset(m_buffers[next]);
+		m_current = next;
+	}
+
+	void FrameAllocator::Reset(Buffer& buffer)
+	{
+		lock_guard<mutex> lock(buffer.overflowMutex);
+		for (auto memory : buffer.overflow)
+		{
+			_FrameAllocator::Heap_Free(memory);
+		}
+		buffer.overflow.clear();
+
+		// Grow to what the frame needed, so it fits next time
+		if (buffer.overflowSize)
+		{
+			buffer.capacity		= buffer.offset + buffer.overflowSize;
+			buffer.memory		= make_unique<std::byte[]>(buffer.capacity);
+			buffer.overflowSize	= 0;
+		}
+		buffer.offset = 0;
+	}
+}
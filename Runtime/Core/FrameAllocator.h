@@ -0,0 +1,96 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "EngineDefs.h"
+//===================
+
+// What each of the two buffers starts with, a buffer which ran out grows to what it needed once it's reset
+#define FRAME_ALLOCATOR_CAPACITY (4 * 1024 * 1024)
+
+namespace Directus
+{
+	// Hands out memory that lives until the end of the next frame, so a frame's data is still around while the render
+	// thread draws it (see Engine_Pipelined). Allocating is a bump of an offset (from any thread) and nothing is freed
+	// individually, two buffers take turns and the one from two frames ago is reset as a whole when a frame begins.
+	class ENGINE_CLASS FrameAllocator
+	{
+	public:
+		FrameAllocator();
+		~FrameAllocator();
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+		// Switches to the other buffer, resetting it, called once per frame before anything allocates
+		void Frame_Begin();
+
+		size_t GetUsed()		{ return m_buffers[m_current].offset; }
+		size_t GetCapacity()	{ return m_buffers[m_current].capacity; }
+
+	private:
+		struct Buffer
+		{
+			std::unique_ptr<std::byte[]> memory;
+			size_t capacity = 0;
+			std::atomic<size_t> offset = 0;
+			// Whatever didn't fit, freed when the buffer is reset
+			std::vector<void*> overflow;
+			size_t overflowSize = 0;
+			std::mutex overflowMutex;
+		};
+
+		void Reset(Buffer& buffer);
+
+		Buffer m_buffers[2];
+		std::atomic<unsigned int> m_current = 0;
+	};
+
+	// Lets STL containers allocate from a FrameAllocator, deallocating is a no-op
+	template <typename T>
+	class FrameAllocatorSTL
+	{
+	public:
+		typedef T value_type;
+
+		FrameAllocatorSTL(FrameAllocator* allocator) : m_allocator(allocator) {}
+		template <typename U>
+		FrameAllocatorSTL(const FrameAllocatorSTL<U>& other) : m_allocator(other.m_allocator) {}
+
+		T* allocate(size_t count)		{ return static_cast<T*>(m_allocator->Allocate(count * sizeof(T), alignof(T))); }
+		void deallocate(T*, size_t)		{}
+
+		template <typename U> bool operator==(const FrameAllocatorSTL<U>& other) const { return m_allocator == other.m_allocator; }
+		template <typename U> bool operator!=(const FrameAllocatorSTL<U>& other) const { return m_allocator != other.m_allocator; }
+
+		FrameAllocator* m_allocator;
+	};
+
+	template <typename T>
+	using FrameVector = std::vector<T, FrameAllocatorSTL<T>>;
+	using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocatorSTL<char>>;
+}
@@ -0,0 +1,237 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES ========
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+//===================
+
+namespace Directus
+{
+	// Bounded queues that hand data from one thread to another without locks. The capacity is fixed (a power of two) and
+	// the elements live inside the queue, pushing to a full queue fails rather than allocating. What's written by the
+	// producers and what's written by the consumer sit on different cache lines, so the two sides don't invalidate each
+	// other's on every element.
+
+	//= SPSC =================================================================================================
+	// One producer thread, one consumer thread
+	template <typename T, size_t Capacity>
+	class RingQueue_SPSC
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "RingQueue_SPSC: the capacity has to be a power of two");
+
+	public:
+		RingQueue_SPSC() = default;
+		~RingQueue_SPSC()
+		{
+			while (Front())
+			{
+				Pop();
+			}
+		}
+
+		RingQueue_SPSC(const RingQueue_SPSC&)				= delete;
+		RingQueue_SPSC& operator=(const RingQueue_SPSC&)	= delete;
+
+		// Producer only, false if it's full
+		template <typename U>
+		bool Push(U&& value)
+		{
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_headCached == Capacity)
+			{
+				m_headCached = m_head.load(std::memory_order_acquire);
+				if (tail - m_headCached == Capacity)
+					return false;
+			}
+
+			new (Slot(tail)) T(std::forward<U>(value));
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only, false if it's empty
+		bool Pop(T& value)
+		{
+			T* front = Front();
+			if (!front)
+				return false;
+
+			value = std::move(*front);
+			Pop();
+			return true;
+		}
+
+		// Consumer only, removes the element Front returned
+		void Pop()
+		{
+			size_t head = m_head.load(std::memory_order_relaxed);
+			Slot(head)->~T();
+			m_head.store(head + 1, std::memory_order_release);
+		}
+
+		// Consumer only, the oldest element (left in the queue) or nullptr if it's empty
+		T* Front()
+		{
+			size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tailCached)
+			{
+				m_tailCached = m_tail.load(std::memory_order_acquire);
+				if (head == m_tailCached)
+					return nullptr;
+			}
+
+			return Slot(head);
+		}
+
+		// Exact only when called from one of the two threads while the other isn't using the queue
+		bool IsEmpty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+	private:
+		T* Slot(size_t index) { return reinterpret_cast<T*>(&m_slots[(index & (Capacity - 1)) * sizeof(T)]); }
+
+		// Consumer
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+		size_t m_tailCached = 0;
+
+		// Producer
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+		size_t m_headCached = 0;
+
+		alignas(64) alignas(T) unsigned char m_slots[Capacity * sizeof(T)];
+	};
+	//========================================================================================================
+
+	//= MPSC =================================================================================================
+	// Any number of producer threads, one consumer thread. Every slot has a sequence number that says whose turn it is,
+	// producers claim a slot by moving the tail forward and hand it over by bumping the sequence (Vyukov's bounded queue).
+	template <typename T, size_t Capacity>
+	class RingQueue_MPSC
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "RingQueue_MPSC: the capacity has to be a power of two");
+
+	public:
+		RingQueue_MPSC()
+		{
+			for (size_t i = 0; i < Capacity; i++)
+			{
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+		~RingQueue_MPSC()
+		{
+			while (Front())
+			{
+				Pop();
+			}
+		}
+
+		RingQueue_MPSC(const RingQueue_MPSC&)				= delete;
+		RingQueue_MPSC& operator=(const RingQueue_MPSC&)	= delete;
+
+		// Any thread, false if it's full
+		template <typename U>
+		bool Push(U&& value)
+		{
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Slot& slot			= m_slots[tail & (Capacity - 1)];
+				size_t sequence		= slot.sequence.load(std::memory_order_acquire);
+				intptr_t difference	= (intptr_t)sequence - (intptr_t)tail;
+
+				// Free, try to claim it
+				if (difference == 0)
+				{
+					if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+					{
+						new (slot.value) T(std::forward<U>(value));
+						slot.sequence.store(tail + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				// Still holds what was pushed a lap ago
+				else if (difference < 0)
+				{
+					return false;
+				}
+				// Another producer claimed it first
+				else
+				{
+					tail = m_tail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// Consumer only, false if it's empty (or the oldest element is still being written)
+		bool Pop(T& value)
+		{
+			T* front = Front();
+			if (!front)
+				return false;
+
+			value = std::move(*front);
+			Pop();
+			return true;
+		}
+
+		// Consumer only, removes the element Front returned
+		void Pop()
+		{
+			size_t head	= m_head.load(std::memory_order_relaxed);
+			Slot& slot	= m_slots[head & (Capacity - 1)];
+			reinterpret_cast<T*>(slot.value)->~T();
+			slot.sequence.store(head + Capacity, std::memory_order_release);
+			m_head.store(head + 1, std::memory_order_relaxed);
+		}
+
+		// Consumer only, the oldest element (left in the queue) or nullptr if there is none yet
+		T* Front()
+		{
+			size_t head	= m_head.load(std::memory_order_relaxed);
+			Slot& slot	= m_slots[head & (Capacity - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+				return nullptr;
+
+			return reinterpret_cast<T*>(slot.value);
+		}
+
+	private:
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			alignas(T) unsigned char value[sizeof(T)];
+		};
+
+		// Consumer
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+
+		// Producers
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+
+		alignas(64) Slot m_slots[Capacity];
+	};
+	//========================================================================================================
+}
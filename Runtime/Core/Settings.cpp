@@ -37,7 +37,7 @@ namespace SettingsIO
 {
 	ofstream fout;
 	ifstream fin;
-	string fileName;
+	string fileName = "Directus.ini";
 }
 
 namespace Directus
@@ -64,6 +64,20 @@ namespace Directus
 		}
 	}
 
+	// Names (a GPU's), as they were written
+	void ReadSetting(ifstream& fin, const string& name, string& value)
+	{
+		for (string line; getline(fin, line); )
+		{
+			auto firstIndex = line.find_first_of('=');
+			if (name == line.substr(0, firstIndex))
+			{
+				value = line.substr(firstIndex + 1, line.length());
+				return;
+			}
+		}
+	}
+
 	Settings::Settings()
 	{
 		m_maxThreadCount = thread::hardware_concurrency();
@@ -89,6 +103,30 @@ namespace Directus
 			ReadSetting(SettingsIO::fin, "iAnisotropy",				m_anisotropy);
 			ReadSetting(SettingsIO::fin, "fFPSLimit",				m_maxFPS_game);
 			ReadSetting(SettingsIO::fin, "iMaxThreadCount",			m_maxThreadCount);
+			ReadSetting(SettingsIO::fin, "iFramesInFlight",			m_framesInFlight);
+			ReadSetting(SettingsIO::fin, "bFibers",					m_fibers);
+			ReadSetting(SettingsIO::fin, "iProfilerPort",			m_profilerPort);
+			ReadSetting(SettingsIO::fin, "bPhysicsMultithreaded",	m_physicsMultithreaded);
+			ReadSetting(SettingsIO::fin, "fPhysicsRate",			m_physicsRate);
+			ReadSetting(SettingsIO::fin, "fPhysicsLodDistanceReduced",	m_physicsLodDistanceReduced);
+			ReadSetting(SettingsIO::fin, "fPhysicsLodDistanceFrozen",	m_physicsLodDistanceFrozen);
+			ReadSetting(SettingsIO::fin, "iAudioVoicesReal",		m_audioVoicesReal);
+			ReadSetting(SettingsIO::fin, "iAudioStreamThresholdKb",	m_audioStreamThresholdKb);
+			ReadSetting(SettingsIO::fin, "iAudioSampleCacheMb",		m_audioSampleCacheMb);
+			ReadSetting(SettingsIO::fin, "fScriptBudgetMs",			m_scriptBudgetMs);
+			ReadSetting(SettingsIO::fin, "iFileCompression",		m_fileCompression);
+			ReadSetting(SettingsIO::fin, "bMetadataXml",			m_metadataXml);
+			ReadSetting(SettingsIO::fin, "bRenderOnDemand",			m_renderOnDemand);
+			ReadSetting(SettingsIO::fin, "fRenderOnDemandRefreshSec",	m_renderOnDemandRefreshSec);
+			ReadSetting(SettingsIO::fin, "bLowLatency",				m_lowLatency);
+			ReadSetting(SettingsIO::fin, "bTearing",				m_tearing);
+			ReadSetting(SettingsIO::fin, "iQuality",				m_quality);
+			ReadSetting(SettingsIO::fin, "sQualityGpu",				m_qualityGpu);
+			ReadSetting(SettingsIO::fin, "fQualityBudgetMs",		m_qualityBudgetMs);
+			ReadSetting(SettingsIO::fin, "bQualityDynamicResolution",	m_qualityDynamicResolution);
+			FramesInFlight_Set(m_framesInFlight);
+			PhysicsRate_Set(m_physicsRate);
+			AudioVoicesReal_Set(m_audioVoicesReal);
 			
 			m_resolution = Vector2(resolutionX, resolutionY);
 
@@ -97,22 +135,7 @@ namespace Directus
 		}
 		else
 		{
-			// Create a settings file
-			SettingsIO::fout.open(SettingsIO::fileName, ofstream::out);
-
-			// Write the settings
-			WriteSetting(SettingsIO::fout, "bFullScreen",			m_isFullScreen);
-			WriteSetting(SettingsIO::fout, "iVSync",				m_vsync);
-			WriteSetting(SettingsIO::fout, "bIsMouseVisible",		m_isMouseVisible);
-			WriteSetting(SettingsIO::fout, "fResolutionWidth",		m_resolution.x);
-			WriteSetting(SettingsIO::fout, "fResolutionHeight",		m_resolution.y);
-			WriteSetting(SettingsIO::fout, "iShadowMapResolution",	m_shadowMapResolution);
-			WriteSetting(SettingsIO::fout, "iAnisotropy",			m_anisotropy);
-			WriteSetting(SettingsIO::fout, "fFPSLimit",				m_maxFPS_game);
-			WriteSetting(SettingsIO::fout, "iMaxThreadCount",		m_maxThreadCount);
-
-			// Close the file.
-			SettingsIO::fout.close();
+			Save();
 		}
 
 		LOGF_INFO("Settings::Initialize: Resolution: %dx%d",		(int)m_resolution.x, (int)m_resolution.y);
@@ -120,6 +143,63 @@ namespace Directus
 		LOGF_INFO("Settings::Initialize: Anisotropy: %d",			m_anisotropy);
 		LOGF_INFO("Settings::Initialize: Max fps: %f",				m_maxFPS_game);
 		LOGF_INFO("Settings::Initialize: Max threads: %d",			m_maxThreadCount);
+		LOGF_INFO("Settings::Initialize: Frames in flight: %d",	m_framesInFlight);
+		LOGF_INFO("Settings::Initialize: Fibers: %d",				m_fibers);
+		LOGF_INFO("Settings::Initialize: Multithreaded physics: %d",	m_physicsMultithreaded);
+	}
+
+	void Settings::Save()
+	{
+		// Create a settings file
+		SettingsIO::fout.open(SettingsIO::fileName, ofstream::out | ofstream::trunc);
+		if (!SettingsIO::fout.is_open())
+		{
+			LOGF_WARNING("Settings::Save: Failed to write \"%s\"", SettingsIO::fileName.c_str());
+			return;
+		}
+
+		// Write the settings
+		WriteSetting(SettingsIO::fout, "bFullScreen",			m_isFullScreen);
+		WriteSetting(SettingsIO::fout, "iVSync",				m_vsync);
+		WriteSetting(SettingsIO::fout, "bIsMouseVisible",		m_isMouseVisible);
+		WriteSetting(SettingsIO::fout, "fResolutionWidth",		m_resolution.x);
+		WriteSetting(SettingsIO::fout, "fResolutionHeight",		m_resolution.y);
+		WriteSetting(SettingsIO::fout, "iShadowMapResolution",	m_shadowMapResolution);
+		WriteSetting(SettingsIO::fout, "iAnisotropy",			m_anisotropy);
+		WriteSetting(SettingsIO::fout, "fFPSLimit",				m_maxFPS_game);
+		WriteSetting(SettingsIO::fout, "iMaxThreadCount",		m_maxThreadCount);
+		WriteSetting(SettingsIO::fout, "iFramesInFlight",		m_framesInFlight);
+		WriteSetting(SettingsIO::fout, "bFibers",				m_fibers);
+		WriteSetting(SettingsIO::fout, "iProfilerPort",			m_profilerPort);
+		WriteSetting(SettingsIO::fout, "bPhysicsMultithreaded",	m_physicsMultithreaded);
+		WriteSetting(SettingsIO::fout, "fPhysicsRate",			m_physicsRate);
+		WriteSetting(SettingsIO::fout, "fPhysicsLodDistanceReduced",	m_physicsLodDistanceReduced);
+		WriteSetting(SettingsIO::fout, "fPhysicsLodDistanceFrozen",		m_physicsLodDistanceFrozen);
+		WriteSetting(SettingsIO::fout, "iAudioVoicesReal",		m_audioVoicesReal);
+		WriteSetting(SettingsIO::fout, "iAudioStreamThresholdKb",	m_audioStreamThresholdKb);
+		WriteSetting(SettingsIO::fout, "iAudioSampleCacheMb",		m_audioSampleCacheMb);
+		WriteSetting(SettingsIO::fout, "fScriptBudgetMs",			m_scriptBudgetMs);
+		WriteSetting(SettingsIO::fout, "iFileCompression",		m_fileCompression);
+		WriteSetting(SettingsIO::fout, "bMetadataXml",			m_metadataXml);
+		WriteSetting(SettingsIO::fout, "bRenderOnDemand",		m_renderOnDemand);
+		WriteSetting(SettingsIO::fout, "fRenderOnDemandRefreshSec",	m_renderOnDemandRefreshSec);
+		WriteSetting(SettingsIO::fout, "bLowLatency",			m_lowLatency);
+		WriteSetting(SettingsIO::fout, "bTearing",				m_tearing);
+		WriteSetting(SettingsIO::fout, "iQuality",				m_quality);
+		WriteSetting(SettingsIO::fout, "sQualityGpu",			m_qualityGpu);
+		WriteSetting(SettingsIO::fout, "fQualityBudgetMs",		m_qualityBudgetMs);
+		WriteSetting(SettingsIO::fout, "bQualityDynamicResolution",	m_qualityDynamicResolution);
+
+		// Close the file.
+		SettingsIO::fout.close();
+	}
+
+	void Settings::Quality_Set(Quality quality, float budgetMs, bool dynamicResolution)
+	{
+		m_quality					= (int)quality;
+		m_qualityGpu				= m_primaryAdapter ? m_primaryAdapter->name : "";
+		m_qualityBudgetMs			= budgetMs;
+		m_qualityDynamicResolution	= dynamicResolution;
 	}
 
 	void Settings::DisplayMode_Add(unsigned int width, unsigned int height, unsigned int refreshRateNumerator, unsigned int refreshRateDenominator)
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Math/Vector2.h"
 #include "../Math/Vector4.h"
 #include <vector>
+#include <string>
 //==========================
 
 namespace Directus
@@ -37,6 +38,24 @@ namespace Directus
 		Every_Second_VBlank
 	};
 
+	// Presets of render flags, shadow and texture filtering quality (see Renderer::Quality_Apply), from the cheapest
+	enum Quality
+	{
+		Quality_Low,
+		Quality_Medium,
+		Quality_High,
+		Quality_Ultra,
+		Quality_Count
+	};
+
+	// Native files that can be written compressed (see FileStreamMode_WriteCompressed), a bit each
+	enum FileCompression
+	{
+		FileCompression_Model	= 1 << 0,
+		FileCompression_Texture	= 1 << 1,
+		FileCompression_World	= 1 << 2
+	};
+
 	struct DisplayMode
 	{
 		DisplayMode(unsigned int width, unsigned int height, unsigned int refreshRateNumerator, unsigned int refreshRateDenominator)
@@ -87,6 +106,8 @@ namespace Directus
 		Settings();
 
 		void Initialize();
+		// Writes every setting to the settings file, read by the next Initialize
+		void Save();
 
 		//= VIEWPORT ===========================================================================================================
 		unsigned int Viewport_GetWidth()							{ return (unsigned int)m_viewport.x; }
@@ -119,16 +140,78 @@ namespace Directus
 		bool FullScreen_Get()										{ return m_isFullScreen; }
 		bool MousVisible_Get()										{ return m_isMouseVisible; }
 		VSync VSync_Get()											{ return (VSync)m_vsync; }	
+		// Directional lights re-create their shadow maps when it changes
+		void Shadows_SetResolution(unsigned int resolution)			{ m_shadowMapResolution = resolution; }
 		unsigned int Shadows_GetResolution()						{ return m_shadowMapResolution; }
+		// Samplers created after it changes use it
+		void Anisotropy_Set(unsigned int anisotropy)				{ m_anisotropy = anisotropy; }
 		unsigned int Anisotropy_Get()								{ return m_anisotropy; }
 		float MaxFps_GetGame()										{ return m_maxFPS_game;}
 		float MaxFps_GetEditor()									{ return m_maxFPS_editor; }
 		void ThreadCountMax_Set(unsigned int maxThreadCount)		{ m_maxThreadCount = maxThreadCount; }
 		unsigned int ThreadCountMax_Get()							{ return m_maxThreadCount; }	
+		// Workers waiting inside a task park it's fiber and move on to other tasks, instead of running them on top of the wait
+		void Fibers_Set(bool fibers)								{ m_fibers = fibers; }
+		bool Fibers_Get()											{ return m_fibers; }
+		// Frames the CPU can queue ahead of the GPU (1 to 3), fewer lower the input latency, more smooth out spikes
+		void FramesInFlight_Set(unsigned int frames)				{ m_framesInFlight = frames < 1 ? 1 : (frames > 3 ? 3 : frames); }
+		unsigned int FramesInFlight_Get()							{ return m_framesInFlight; }
+		// The port the profiler streams to a remote viewer on (see ProfilerRemote), 0 doesn't listen
+		void ProfilerPort_Set(unsigned int port)					{ m_profilerPort = port; }
+		unsigned int ProfilerPort_Get()								{ return m_profilerPort; }
+		// Steps Bullet with it's multithreaded world and a pool of solvers, on the Threading workers. Read at startup.
+		void PhysicsMultithreaded_Set(bool multithreaded)			{ m_physicsMultithreaded = multithreaded; }
+		bool PhysicsMultithreaded_Get()								{ return m_physicsMultithreaded; }
+		// Steps per second Bullet runs at when the engine doesn't tick at a fixed rate, bodies are rendered between the last two
+		void PhysicsRate_Set(float rate)							{ m_physicsRate = rate < 1.0f ? 1.0f : rate; }
+		float PhysicsRate_Get()										{ return m_physicsRate; }
+		// Bodies further from every viewer than these are stepped every few steps, or frozen (0 turns either off)
+		void PhysicsLodDistance_Set(float reduced, float frozen)	{ m_physicsLodDistanceReduced = reduced; m_physicsLodDistanceFrozen = frozen; }
+		float PhysicsLodDistance_GetReduced()						{ return m_physicsLodDistanceReduced; }
+		float PhysicsLodDistance_GetFrozen()						{ return m_physicsLodDistanceFrozen; }
+		// Voices FMOD mixes at once, the quietest of the rest go virtual (tracked, not decoded or mixed). Read at startup.
+		void AudioVoicesReal_Set(unsigned int voices)				{ m_audioVoicesReal = voices < 1 ? 1 : voices; }
+		unsigned int AudioVoicesReal_Get()							{ return m_audioVoicesReal; }
+		// Clips larger than this (in KB) are streamed from disk instead of decoded into memory, 0 streams everything
+		void AudioStreamThreshold_Set(unsigned int kb)				{ m_audioStreamThresholdKb = kb; }
+		unsigned int AudioStreamThreshold_Get()						{ return m_audioStreamThresholdKb; }
+		// Memory (in MB) audio samples no clip plays anymore can keep taking, so they don't load again when they're back
+		void AudioSampleCacheBudget_Set(unsigned int mb)			{ m_audioSampleCacheMb = mb; }
+		unsigned int AudioSampleCacheBudget_Get()					{ return m_audioSampleCacheMb; }
+		// How long (in ms) a script call can run before it's aborted and the script suspended, 0 doesn't limit. Read at startup.
+		void ScriptBudget_Set(float ms)								{ m_scriptBudgetMs = ms; }
+		float ScriptBudget_Get()									{ return m_scriptBudgetMs; }
+		// Which native files are saved compressed, loading reads either. Textures are off by default, their mips mostly are already.
+		void FileCompression_Set(FileCompression type, bool enabled)	{ m_fileCompression = enabled ? m_fileCompression | type : m_fileCompression & ~type; }
+		bool FileCompression_Get(FileCompression type)				{ return (m_fileCompression & type) != 0; }
+		// Materials are saved as XML rather than binary, to be read or diffed. Loading takes either.
+		void MetadataXml_Set(bool xml)								{ m_metadataXml = xml; }
+		bool MetadataXml_Get()										{ return m_metadataXml; }
+		// Outside of game mode, the world only renders when something changed (the camera, the world, resources, input), or every refresh seconds
+		void RenderOnDemand_Set(bool onDemand, float refreshSec = 1.0f)	{ m_renderOnDemand = onDemand; m_renderOnDemandRefreshSec = refreshSec; }
+		bool RenderOnDemand_Get()									{ return m_renderOnDemand; }
+		float RenderOnDemand_GetRefresh()							{ return m_renderOnDemandRefreshSec; }
+		// Frames wait on the swap chain before they start (see RHI_Device::Present_Wait) and the frame limiter spins out it's
+		// last stretch instead of oversleeping, for the least input to photon latency. Read at startup.
+		void LowLatency_Set(bool lowLatency)						{ m_lowLatency = lowLatency; }
+		bool LowLatency_Get()										{ return m_lowLatency; }
+		// Without vsync, windowed frames are presented as soon as they are done (tearing), which variable refresh rate displays need
+		void Tearing_Set(bool tearing)								{ m_tearing = tearing; }
+		bool Tearing_Get()											{ return m_tearing; }
 		const std::string& Gpu_GetName()							{ return m_primaryAdapter->name; }
 		unsigned int Gpu_GetMemory()								{ return m_primaryAdapter->memory; }
 		//================================================================================================
 
+		//= QUALITY ==============================================================================================================
+		// The preset a calibration run (Benchmark -calibrate) measured to fit the frame budget on the GPU, dynamic resolution
+		// makes up for the little headroom it may have left. The renderer applies it when it starts, on that GPU only.
+		void Quality_Set(Quality quality, float budgetMs, bool dynamicResolution);
+		bool Quality_IsCalibrated()									{ return m_quality >= 0 && m_primaryAdapter && m_qualityGpu == m_primaryAdapter->name; }
+		Quality Quality_Get()										{ return m_quality >= 0 ? (Quality)m_quality : Quality_High; }
+		float Quality_GetBudget()									{ return m_qualityBudgetMs; }
+		bool Quality_GetDynamicResolution()							{ return m_qualityDynamicResolution; }
+		//========================================================================================================================
+
 		// Third party lib versions
 		std::string m_versionAngelScript;
 		std::string m_versionAssimp;
@@ -151,6 +234,27 @@ namespace Directus
 		float m_maxFPS_game						= FLT_MAX;
 		float m_maxFPS_editor					= 165.0f;
 		unsigned int m_maxThreadCount			= 0;
+		unsigned int m_framesInFlight			= 2;
+		bool m_fibers							= true;
+		unsigned int m_profilerPort				= 0;
+		bool m_physicsMultithreaded				= true;
+		float m_physicsRate						= 60.0f;
+		float m_physicsLodDistanceReduced		= 0.0f;
+		float m_physicsLodDistanceFrozen		= 0.0f;
+		unsigned int m_audioVoicesReal			= 64;
+		unsigned int m_audioStreamThresholdKb	= 1024;
+		unsigned int m_audioSampleCacheMb		= 64;
+		float m_scriptBudgetMs					= 0.0f;
+		unsigned int m_fileCompression			= FileCompression_Model | FileCompression_World;
+		bool m_metadataXml						= false;
+		bool m_renderOnDemand					= false;
+		float m_renderOnDemandRefreshSec		= 1.0f;
+		bool m_lowLatency						= false;
+		bool m_tearing							= true;
+		int m_quality							= -1; // not calibrated
+		std::string m_qualityGpu;
+		float m_qualityBudgetMs					= 16.6f;
+		bool m_qualityDynamicResolution			= false;
 		const DisplayAdapter* m_primaryAdapter	= nullptr;
 
 		std::vector<DisplayMode> m_displayModes;
@@ -0,0 +1,85 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========
+#include "StringId.h"
+#include <cstring>
+#ifdef DEBUG
+#include <mutex>
+#include <unordered_map>
+#include "../Logging/Log.h"
+#endif
+//=====================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+#ifdef DEBUG
+	namespace _StringId
+	{
+		mutex tableMutex;
+		unordered_map<uint64_t, string> table; // nodes never move, so the strings can be handed out
+
+		void Intern(uint64_t hash, const char* str, size_t length)
+		{
+			lock_guard<mutex> lock(tableMutex);
+			auto it = table.find(hash);
+			if (it == table.end())
+			{
+				table.emplace(hash, string(str, length));
+			}
+			else if (it->second.compare(0, string::npos, str, length) != 0)
+			{
+				LOGF_ERROR("StringId::StringId: \"%s\" and \"%s\" share a hash, they will compare equal", it->second.c_str(), string(str, length).c_str());
+			}
+		}
+	}
+#endif
+
+	StringId::StringId(const char* str) : StringId(str, str ? strlen(str) : 0) {}
+
+	StringId::StringId(const string& str) : StringId(str.c_str(), str.size()) {}
+
+	StringId::StringId(const char* str, size_t length)
+	{
+		m_hash = Hash(str, length);
+#ifdef DEBUG
+		if (m_hash != 0)
+		{
+			_StringId::Intern(m_hash, str, length);
+		}
+#endif
+	}
+
+	const char* StringId::c_str() const
+	{
+#ifdef DEBUG
+		lock_guard<mutex> lock(_StringId::tableMutex);
+		auto it = _StringId::table.find(m_hash);
+		if (it != _StringId::table.end())
+			return it->second.c_str();
+#endif
+		return "";
+	}
+}
@@ -0,0 +1,80 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======
+#include <string>
+#include <cstdint>
+#include <functional>
+#include "EngineDefs.h"
+//=================
+
+namespace Directus
+{
+	// A string reduced to a 64-bit hash (FNV-1a), so comparing and hashing one is an integer operation and making one from
+	// a string allocates nothing. Debug builds also intern every string in a global table, which reports collisions and
+	// gives the string back (see c_str), release builds keep no strings at all.
+	class ENGINE_CLASS StringId
+	{
+	public:
+		constexpr StringId() : m_hash(0) {}
+		StringId(const char* str);
+		StringId(const std::string& str);
+
+		// An empty string hashes to 0, like a default constructed ID
+		static constexpr uint64_t Hash(const char* str, size_t length)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			for (size_t i = 0; i < length; i++)
+			{
+				hash ^= (uint8_t)str[i];
+				hash *= 1099511628211ull;
+			}
+
+			return length ? hash : 0;
+		}
+
+		uint64_t GetHash() const	{ return m_hash; }
+		bool IsEmpty() const		{ return m_hash == 0; }
+
+		// The string it was made from in debug builds, an empty one in release builds
+		const char* c_str() const;
+
+		bool operator==(const StringId& other) const	{ return m_hash == other.m_hash; }
+		bool operator!=(const StringId& other) const	{ return m_hash != other.m_hash; }
+		bool operator<(const StringId& other) const		{ return m_hash < other.m_hash; }
+
+	private:
+		StringId(const char* str, size_t length);
+
+		uint64_t m_hash;
+	};
+}
+
+namespace std
+{
+	template <>
+	struct hash<Directus::StringId>
+	{
+		size_t operator()(const Directus::StringId& id) const { return (size_t)id.GetHash(); }
+	};
+}
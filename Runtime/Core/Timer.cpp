@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Engine.h"
 #include "Settings.h"
 #include <thread>
+#include <cmath>
 //===================
 
 //= NAMESPACES ========
@@ -31,6 +32,11 @@ using namespace std;
 using namespace chrono;
 //=====================
 
+#define HEADLESS_TICK_RATE 60.0 // how many times a second a headless engine ticks
+#define FIXED_STEP_SEC (1.0f / 60.0f) // the default fixed step
+#define FIXED_STEP_MAX 8 // more steps than that in a frame drop the rest of the time, so a slow frame doesn't make the next one slower
+#define TIMER_SLEEP_STEP_DECAY 0.99 // how fast the longest sleep step seen is forgotten, per step
+
 namespace Directus
 {
 	Timer::Timer(Context* context) : Subsystem(context)
@@ -38,6 +44,8 @@ namespace Directus
 		time_a			= high_resolution_clock::now();
 		time_b			= high_resolution_clock::now();
 		m_deltaTimeMs	= 0.0f;
+		m_frameTimeMs	= 0.0f;
+		m_fixedStepSec	= FIXED_STEP_SEC;
 	}
 
 	void Timer::Tick()
@@ -48,20 +56,74 @@ namespace Directus
 		
 		// Compute sleep time (fps limiting)
 		bool isEditor		= !Engine::EngineMode_IsSet(Engine_Game);
+		bool isHeadless		= Engine::EngineMode_IsSet(Engine_Headless);
+		bool isBenchmark	= Engine::EngineMode_IsSet(Engine_Benchmark);
 		auto maxFPS_editor	= (double)Settings::Get().MaxFps_GetEditor();
 		auto maxFPS_game	= (double)Settings::Get().MaxFps_GetGame();
-		double maxFPS		= isEditor ? maxFPS_editor : maxFPS_game;
+		double maxFPS		= (isHeadless || isBenchmark) ? HEADLESS_TICK_RATE : (isEditor ? maxFPS_editor : maxFPS_game);
 		double maxMs		= (1.0 / maxFPS) * 1000;
-		if (time_work.count() < maxMs)
+		if (time_work.count() < maxMs && !isBenchmark)
 		{
 			duration<double, milli> time_ms(maxMs - time_work.count());
-			auto time_ms_duration = duration_cast<milliseconds>(time_ms);
-			this_thread::sleep_for(milliseconds(time_ms_duration.count()));
+			if (Settings::Get().LowLatency_Get())
+			{
+				// To the sub-millisecond, a frame that ends late pushes every later one back
+				Sleep_Until(time_a + duration_cast<high_resolution_clock::duration>(time_ms));
+			}
+			else
+			{
+				auto time_ms_duration = duration_cast<milliseconds>(time_ms);
+				this_thread::sleep_for(milliseconds(time_ms_duration.count()));
+			}
 		}
 
 		// Compute delta
 		time_b								= high_resolution_clock::now();
 		duration<double, milli> time_sleep	= time_b - time_a;
-		m_deltaTimeMs						= (time_work + time_sleep).count();
+		// Headless, the simulation steps by a fixed amount however long the frame took, so it behaves the same on any server
+		m_frameTimeMs						= (time_work + time_sleep).count();
+		m_deltaTimeMs						= (isHeadless || isBenchmark) ? maxMs : m_frameTimeMs;
+	}
+
+	void Timer::Sleep_Until(const high_resolution_clock::time_point& deadline)
+	{
+		// Sleep while a step still fits, the longest one seen so far is what a step can take
+		while (duration<double, milli>(deadline - high_resolution_clock::now()).count() > m_sleepStepMs)
+		{
+			auto start = high_resolution_clock::now();
+			this_thread::sleep_for(duration<double, milli>(TIMER_SLEEP_STEP_MS));
+			double slept	= duration<double, milli>(high_resolution_clock::now() - start).count();
+			m_sleepStepMs	= slept > m_sleepStepMs ? slept : TIMER_SLEEP_STEP_MS + (m_sleepStepMs - TIMER_SLEEP_STEP_MS) * TIMER_SLEEP_STEP_DECAY;
+		}
+
+		// Spin the rest, yielding lets other threads of the engine have the core meanwhile
+		while (high_resolution_clock::now() < deadline)
+		{
+			this_thread::yield();
+		}
+	}
+
+	float Timer::GetTickDeltaSec()
+	{
+		return Engine::EngineMode_IsSet(Engine_FixedStep) ? m_fixedStepSec : GetDeltaTimeSec();
+	}
+
+	unsigned int Timer::FixedStep_Accumulate()
+	{
+		m_fixedStepAccumulatedSec += GetDeltaTimeSec();
+
+		unsigned int steps = 0;
+		while (m_fixedStepAccumulatedSec >= m_fixedStepSec && steps < FIXED_STEP_MAX)
+		{
+			m_fixedStepAccumulatedSec -= m_fixedStepSec;
+			steps++;
+		}
+
+		if (steps == FIXED_STEP_MAX)
+		{
+			m_fixedStepAccumulatedSec = fmod(m_fixedStepAccumulatedSec, (double)m_fixedStepSec);
+		}
+
+		return steps;
 	}
-}
+}
\ No newline at end of file
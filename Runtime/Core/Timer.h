@@ -26,6 +26,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <chrono>
 //====================
 
+// What a sleeping frame limiter asks the OS for at a time, in ms
+#define TIMER_SLEEP_STEP_MS 1.0
+
 namespace Directus
 {
 	class ENGINE_CLASS Timer : public Subsystem
@@ -37,10 +40,30 @@ namespace Directus
 		void Tick();
 		float GetDeltaTimeMs()	{ return (float)m_deltaTimeMs; }
 		float GetDeltaTimeSec() { return (float)m_deltaTimeMs / 1000.0f; }
+		// How long the last frame really took, which the delta isn't when headless or benchmarking (it's fixed)
+		float GetFrameTimeMs()	{ return (float)m_frameTimeMs; }
+		// What a simulation tick advances by, the fixed step when the engine ticks in fixed steps (see Engine_FixedStep)
+		float GetTickDeltaSec();
+
+		//= FIXED STEP ===============================================================================
+		// Adds the frame's time to what's accumulated, returns how many steps it adds up to
+		unsigned int FixedStep_Accumulate();
+		void FixedStep_Set(float seconds)	{ m_fixedStepSec = seconds; }
+		float FixedStep_Get()				{ return m_fixedStepSec; }
+		// How far past the last step the frame is, in steps, rendering blends the last two states by it
+		float FixedStep_GetAlpha()			{ return (float)(m_fixedStepAccumulatedSec / m_fixedStepSec); }
+		//============================================================================================
+
+	private:
+		// Sleeps most of the way and spins the rest, the OS wakes a sleeping thread up late by up to it's scheduling period
+		void Sleep_Until(const std::chrono::high_resolution_clock::time_point& deadline);
 
-	private:		
 		std::chrono::high_resolution_clock::time_point time_a;
 		std::chrono::high_resolution_clock::time_point time_b;
 		double m_deltaTimeMs;
+		double m_frameTimeMs;
+		float m_fixedStepSec;
+		double m_fixedStepAccumulatedSec = 0.0;
+		double m_sleepStepMs = TIMER_SLEEP_STEP_MS; // how long a sleep of a single step takes, a slowly decaying maximum
 	};
 }
\ No newline at end of file
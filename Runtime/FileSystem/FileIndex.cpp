@@ -0,0 +1,194 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "FileIndex.h"
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include "FileSystem.h"
+#include "FileWatcher.h"
+#include "../Core/Context.h"
+#include "../Core/EventSystem.h"
+#include "../Threading/Threading.h"
+//================================
+
+//= NAMESPACES =================
+using namespace std;
+using namespace std::filesystem;
+//==============================
+
+namespace Directus
+{
+	FileIndex::FileIndex(Context* context) : Subsystem(context)
+	{
+		SUBSCRIBE_TO_EVENT(EVENT_FRAME_START, EVENT_HANDLER(Changes_Apply));
+	}
+
+	FileIndex::~FileIndex()
+	{
+		m_watcher.reset();
+
+		// Scans in flight write into the directories
+		while (m_scansPending > 0)
+		{
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+	}
+
+	vector<FileIndexEntry> FileIndex::GetEntries(const string& directory)
+	{
+		// Changes are only seen where the index is used
+		if (!m_watcher)
+		{
+			m_watcher = make_unique<FileWatcher>(FileSystem::GetWorkingDirectory());
+		}
+
+		auto key = GetKey(directory);
+		{
+			lock_guard<mutex> lock(m_directoriesMutex);
+			auto it = m_directories.find(key);
+			if (it != m_directories.end())
+				return it->second.entries;
+		}
+
+		Scan(key, directory);
+		return vector<FileIndexEntry>();
+	}
+
+	void FileIndex::Refresh(const string& directory)
+	{
+		Scan(GetKey(directory), directory);
+	}
+
+	FileType FileIndex::Classify(const string& filePath, bool isDirectory /*= false*/)
+	{
+		if (isDirectory)								return FileType_Directory;
+		if (FileSystem::IsSupportedModelFile(filePath))	return FileType_Model;
+		if (FileSystem::IsSupportedImageFile(filePath))	return FileType_Image;
+		if (FileSystem::IsEngineTextureFile(filePath))	return FileType_Texture;
+		if (FileSystem::IsSupportedAudioFile(filePath))	return FileType_Audio;
+		if (FileSystem::IsEngineMaterialFile(filePath))	return FileType_Material;
+		if (FileSystem::IsSupportedShaderFile(filePath))	return FileType_Shader;
+		if (FileSystem::IsEngineSceneFile(filePath))	return FileType_Scene;
+		if (FileSystem::IsEngineScriptFile(filePath))	return FileType_Script;
+		if (FileSystem::IsSupportedFontFile(filePath))	return FileType_Font;
+		return FileType_Other;
+	}
+
+	void FileIndex::Changes_Apply()
+	{
+		if (!m_watcher)
+			return;
+
+		// A change is in the directory that contains it, that's only scanned again if it was scanned before
+		for (const auto& filePath : m_watcher->GetChanges())
+		{
+			auto directory	= FileSystem::GetDirectoryFromFilePath(filePath);
+			auto key		= GetKey(directory);
+			bool indexed	= false;
+			{
+				lock_guard<mutex> lock(m_directoriesMutex);
+				indexed = m_directories.count(key) != 0;
+			}
+
+			if (indexed)
+			{
+				Scan(key, directory);
+			}
+		}
+	}
+
+	void FileIndex::Scan(const string& key, const string& directory)
+	{
+		{
+			lock_guard<mutex> lock(m_directoriesMutex);
+			auto& entry = m_directories[key];
+			if (entry.scanning)
+			{
+				entry.scanAgain = true;
+				return;
+			}
+			entry.scanning = true;
+		}
+
+		m_scansPending++;
+		m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_IO, [this, key, directory]()
+		{
+			bool scanAgain = true;
+			while (scanAgain)
+			{
+				vector<FileIndexEntry> entries;
+				error_code error;
+				for (directory_iterator it(directory.empty() ? "." : directory, error), end; !error && it != end; it.increment(error))
+				{
+					FileIndexEntry entry;
+					bool isDirectory	= it->is_directory(error);
+					entry.path			= it->path().generic_string();
+					entry.name			= it->path().filename().generic_string();
+					entry.extension		= isDirectory ? "" : FileSystem::GetExtensionFromFilePath(entry.path);
+					entry.type			= Classify(entry.path, isDirectory);
+					entry.size			= isDirectory ? 0 : (unsigned long long)it->file_size(error);
+					entry.timeModified	= (long long)it->last_write_time(error).time_since_epoch().count();
+					error.clear();
+					entries.emplace_back(move(entry));
+				}
+
+				// Directories first, then by name
+				sort(entries.begin(), entries.end(), [](const FileIndexEntry& a, const FileIndexEntry& b)
+				{
+					bool aIsDirectory = a.type == FileType_Directory;
+					bool bIsDirectory = b.type == FileType_Directory;
+					return aIsDirectory != bIsDirectory ? aIsDirectory : a.name < b.name;
+				});
+
+				lock_guard<mutex> lock(m_directoriesMutex);
+				auto& cached = m_directories[key];
+				bool changed = !cached.scanned || cached.entries.size() != entries.size() || !equal(entries.begin(), entries.end(), cached.entries.begin(), [](const FileIndexEntry& a, const FileIndexEntry& b)
+				{
+					return a.path == b.path && a.size == b.size && a.timeModified == b.timeModified;
+				});
+				if (changed)
+				{
+					cached.entries = move(entries);
+					m_revision++;
+				}
+				cached.scanned		= true;
+				scanAgain			= cached.scanAgain;
+				cached.scanAgain	= false;
+				cached.scanning		= scanAgain;
+			}
+			m_scansPending--;
+		});
+	}
+
+	string FileIndex::GetKey(const string& directory)
+	{
+		error_code error;
+		auto key = absolute(directory.empty() ? "." : directory, error).lexically_normal().generic_string();
+		while (!key.empty() && key.back() == '/')
+		{
+			key.pop_back();
+		}
+		transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)tolower(c); });
+		return key;
+	}
+}
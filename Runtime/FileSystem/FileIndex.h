@@ -0,0 +1,102 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include "../Core/SubSystem.h"
+#include "../Core/EngineDefs.h"
+//=============================
+
+namespace Directus
+{
+	class FileWatcher;
+
+	enum FileType
+	{
+		FileType_Directory,
+		FileType_Model,
+		FileType_Image,
+		FileType_Texture,
+		FileType_Audio,
+		FileType_Material,
+		FileType_Shader,
+		FileType_Scene,
+		FileType_Script,
+		FileType_Font,
+		FileType_Other
+	};
+
+	struct FileIndexEntry
+	{
+		std::string path; // like the ones FileSystem::GetFilesInDirectory() returns
+		std::string name;
+		std::string extension;
+		FileType type				= FileType_Other;
+		unsigned long long size		= 0;
+		long long timeModified		= 0; // comparable with the time of other entries only
+	};
+
+	// What's in the directories that were asked for, with sizes, times and what kind of file each entry is. The file system is only read on worker
+	// threads, the first time a directory is asked for, when it's refreshed and when the watcher (of the working directory) sees something in it change.
+	class ENGINE_CLASS FileIndex : public Subsystem
+	{
+	public:
+		FileIndex(Context* context);
+		~FileIndex();
+
+		// The entries of a directory, directories first, as they were last scanned (empty until the first scan is done)
+		std::vector<FileIndexEntry> GetEntries(const std::string& directory);
+		// Scans a directory again, the watcher doesn't see directories outside the working directory
+		void Refresh(const std::string& directory);
+		// Increments whenever a scan finds something different, a view of the entries is up to date for as long as it stays the same
+		unsigned int GetRevision() { return m_revision; }
+
+		static FileType Classify(const std::string& filePath, bool isDirectory = false);
+
+	private:
+		struct Directory
+		{
+			std::vector<FileIndexEntry> entries;
+			bool scanned		= false;
+			bool scanning		= false;
+			bool scanAgain		= false; // something changed while it was being scanned
+		};
+
+		// Applies what the watcher saw, on frame start
+		void Changes_Apply();
+		void Scan(const std::string& key, const std::string& directory);
+		// Directories are looked up by their absolute, lowercase path
+		static std::string GetKey(const std::string& directory);
+
+		std::unordered_map<std::string, Directory> m_directories;
+		std::mutex m_directoriesMutex;
+		std::atomic<unsigned int> m_revision	= 0;
+		std::atomic<int> m_scansPending		= 0;
+		std::unique_ptr<FileWatcher> m_watcher;
+	};
+}
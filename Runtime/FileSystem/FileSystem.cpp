@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "FileSystem.h"
 #include <filesystem>
 #include <regex>
+#include "PackFile.h"
 #include "../Logging/Log.h"
 #include <Windows.h>
 #include <shellapi.h>
@@ -240,6 +241,9 @@ namespace Directus
 
 	bool FileSystem::FileExists(const string& filePath)
 	{
+		if (PackFile::Find(filePath))
+			return true;
+
 		bool result;
 		try
 		{
@@ -253,6 +257,21 @@ namespace Directus
 		return result;
 	}
 
+	unsigned long long FileSystem::GetFileSize(const string& filePath)
+	{
+		unsigned long long size = 0;
+		try
+		{
+			size = exists(filePath) ? (unsigned long long)file_size(filePath) : 0;
+		}
+		catch (filesystem_error& e)
+		{
+			LOGF_ERROR("FileSystem::GetFileSize: %s, %s", e.what(), filePath.c_str());
+		}
+
+		return size;
+	}
+
 	bool FileSystem::DeleteFile_(const string& filePath)
 	{
 		// If this is a directory path, return
@@ -589,7 +608,8 @@ namespace Directus
 
 	bool FileSystem::IsEngineSceneFile(const string& filePath)
 	{
-		return GetExtensionFromFilePath(filePath) == EXTENSION_WORLD;
+		auto extension = GetExtensionFromFilePath(filePath);
+		return extension == EXTENSION_WORLD || extension == EXTENSION_WORLD_SNAPSHOT;
 	}
 
 	bool FileSystem::IsEngineTextureFile(const string& filePath)
@@ -597,6 +617,11 @@ namespace Directus
 		return GetExtensionFromFilePath(filePath) == EXTENSION_TEXTURE;
 	}
 
+	bool FileSystem::IsEngineFile(const string& filePath)
+	{
+		return IsEngineMaterialFile(filePath) || IsEngineModelFile(filePath) || IsEngineMeshFile(filePath) || IsEngineTextureFile(filePath) || IsEnginePrefabFile(filePath);
+	}
+
 	bool FileSystem::IsEngineShaderFile(const string& filePath)
 	{
 		return GetExtensionFromFilePath(filePath) == EXTENSION_SHADER;
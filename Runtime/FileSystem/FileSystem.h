@@ -35,12 +35,19 @@ static const char* METADATA_TYPE_TEXTURE	= "Texture";
 static const char* METADATA_TYPE_AUDIOCLIP	= "Audio_Clip";
 // Engine file extensions
 static const char* EXTENSION_WORLD			= ".world";
+static const char* EXTENSION_WORLD_CELL		= ".cell";
+static const char* EXTENSION_WORLD_CELLS	= ".cells";
+static const char* EXTENSION_WORLD_SNAPSHOT	= ".snapshot";
 static const char* EXTENSION_MATERIAL		= ".mat";
 static const char* EXTENSION_MODEL			= ".model";
 static const char* EXTENSION_PREFAB			= ".prefab";
 static const char* EXTENSION_SHADER			= ".shader";
 static const char* EXTENSION_TEXTURE		= ".texture";
 static const char* EXTENSION_MESH			= ".mesh";
+static const char* EXTENSION_FONT_ATLAS		= ".fontatlas";
+static const char* EXTENSION_COLLISION		= ".collision";
+static const char* EXTENSION_TERRAIN		= ".terrain";
+static const char* EXTENSION_BYTECODE		= ".bytecode";
 //=========================================================
 
 namespace Directus
@@ -60,6 +67,8 @@ namespace Directus
 
 		//= FILES ============================================================================
 		static bool FileExists(const std::string& filePath);
+		// In bytes, 0 if it doesn't exist
+		static unsigned long long GetFileSize(const std::string& filePath);
 		static bool DeleteFile_(const std::string& filePath);
 		static bool CopyFileFromTo(const std::string& source, const std::string& destination);
 		//====================================================================================
@@ -102,6 +111,8 @@ namespace Directus
 		static bool IsEngineTextureFile(const std::string& filePath);
 		static bool IsEngineShaderFile(const std::string& filePath);
 		static bool IsEngineMetadataFile(const std::string& filePath);
+		// Any of the resource files the engine writes itself
+		static bool IsEngineFile(const std::string& filePath);
 		//=============================================================
 
 		//= STRING PARSING =============================================================================================================================
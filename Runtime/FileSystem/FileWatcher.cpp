@@ -0,0 +1,180 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "FileWatcher.h"
+#include <algorithm>
+#include "FileSystem.h"
+#include "../Logging/Log.h"
+#include <Windows.h>
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+#define FILE_WATCHER_BUFFER_SIZE 64 * 1024 // the notifications of one read, more than that and they are lost
+#define FILE_WATCHER_RETRY_MS 100 // how often the watcher tries again to hand over changes that didn't fit in the queue
+
+namespace Directus
+{
+	FileWatcher::FileWatcher(const string& directory)
+	{
+		m_directory = directory;
+
+		m_directoryHandle = CreateFileW(
+			FileSystem::StringToWString(directory).c_str(),
+			FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+			nullptr
+		);
+		if (m_directoryHandle == INVALID_HANDLE_VALUE)
+		{
+			LOGF_ERROR("FileWatcher::FileWatcher: Failed to open \"%s\"", directory.c_str());
+			m_directoryHandle = nullptr;
+			return;
+		}
+
+		m_stopEvent	= CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		m_watching	= true;
+		m_thread	= thread(&FileWatcher::Watch, this);
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		if (m_thread.joinable())
+		{
+			SetEvent((HANDLE)m_stopEvent);
+			m_thread.join();
+		}
+
+		if (m_stopEvent)		CloseHandle((HANDLE)m_stopEvent);
+		if (m_directoryHandle)	CloseHandle((HANDLE)m_directoryHandle);
+	}
+
+	vector<string> FileWatcher::GetChanges(float quietSec /*= 0.25f*/)
+	{
+		vector<string> changes;
+		auto now = chrono::steady_clock::now();
+
+		Change change;
+		while (m_queue.Pop(change))
+		{
+			m_changes[change.first] = change.second;
+		}
+
+		for (auto it = m_changes.begin(); it != m_changes.end();)
+		{
+			if (chrono::duration<float>(now - it->second).count() < quietSec)
+			{
+				++it;
+				continue;
+			}
+
+			changes.emplace_back(it->first);
+			it = m_changes.erase(it);
+		}
+
+		return changes;
+	}
+
+	string FileWatcher::NormalizePath(const string& filePath)
+	{
+		string path = FileSystem::GetRelativeFilePath(filePath);
+		replace(path.begin(), path.end(), '\\', '/');
+		path.erase(unique(path.begin(), path.end(), [](char a, char b) { return a == '/' && b == '/'; }), path.end());
+		if (path.compare(0, 2, "./") == 0)
+		{
+			path.erase(0, 2);
+		}
+		return path;
+	}
+
+	void FileWatcher::Watch()
+	{
+		vector<DWORD> buffer(FILE_WATCHER_BUFFER_SIZE / sizeof(DWORD)); // notifications have to be DWORD aligned
+		OVERLAPPED overlapped	= {};
+		overlapped.hEvent		= CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		HANDLE events[2]		= { overlapped.hEvent, (HANDLE)m_stopEvent };
+
+		// What didn't fit in the queue, in the order it happened
+		vector<Change> pending;
+		auto Hand_Over = [this, &pending]()
+		{
+			size_t handed = 0;
+			while (handed < pending.size() && m_queue.Push(move(pending[handed])))
+			{
+				handed++;
+			}
+			pending.erase(pending.begin(), pending.begin() + handed);
+		};
+
+		while (m_watching)
+		{
+			ResetEvent(overlapped.hEvent);
+			DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE;
+			if (!ReadDirectoryChangesW((HANDLE)m_directoryHandle, buffer.data(), (DWORD)(buffer.size() * sizeof(DWORD)), TRUE, filter, nullptr, &overlapped, nullptr))
+			{
+				LOGF_ERROR("FileWatcher::Watch: Failed to watch \"%s\"", m_directory.c_str());
+				break;
+			}
+
+			// Wait for changes or to be told to stop, meanwhile handing over what didn't fit before
+			DWORD result;
+			while ((result = WaitForMultipleObjects(2, events, FALSE, pending.empty() ? INFINITE : FILE_WATCHER_RETRY_MS)) == WAIT_TIMEOUT)
+			{
+				Hand_Over();
+			}
+			if (result != WAIT_OBJECT_0)
+			{
+				CancelIo((HANDLE)m_directoryHandle);
+				WaitForSingleObject(overlapped.hEvent, INFINITE);
+				break;
+			}
+
+			DWORD bytes = 0;
+			if (!GetOverlappedResult((HANDLE)m_directoryHandle, &overlapped, &bytes, FALSE) || bytes == 0)
+				continue; // the buffer overflowed, what changed meanwhile is lost
+
+			auto now = chrono::steady_clock::now();
+			auto info = (FILE_NOTIFY_INFORMATION*)buffer.data();
+			while (true)
+			{
+				wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+				int length = WideCharToMultiByte(CP_ACP, 0, name.c_str(), (int)name.size(), nullptr, 0, nullptr, nullptr);
+				string path(length, 0);
+				WideCharToMultiByte(CP_ACP, 0, name.c_str(), (int)name.size(), &path[0], length, nullptr, nullptr);
+				pending.emplace_back(NormalizePath(m_directory + "/" + path), now);
+
+				if (info->NextEntryOffset == 0)
+					break;
+				info = (FILE_NOTIFY_INFORMATION*)((BYTE*)info + info->NextEntryOffset);
+			}
+			Hand_Over();
+		}
+
+		CloseHandle(overlapped.hEvent);
+		m_watching = false;
+	}
+}
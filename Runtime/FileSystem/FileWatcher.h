@@ -0,0 +1,68 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include "../Core/EngineDefs.h"
+#include "../Core/RingQueue.h"
+//=============================
+
+#define FILE_WATCHER_QUEUE_SIZE 1024 // changes handed over between two GetChanges calls, the watcher holds on to the rest
+
+namespace Directus
+{
+	// Watches a directory (and everything in it) on a thread of its own and queues the files (and directories) that change, appear or go away in it.
+	// Editors tend to write a file in a few steps, so a change is only reported once the file has been quiet for a while.
+	class ENGINE_CLASS FileWatcher
+	{
+	public:
+		FileWatcher(const std::string& directory);
+		~FileWatcher();
+
+		bool IsWatching() { return m_watching; }
+		// The paths that changed and have been quiet for at least that long (see NormalizePath), each is reported once and might not exist anymore.
+		// Call it from one thread at a time.
+		std::vector<std::string> GetChanges(float quietSec = 0.25f);
+
+		// Relative to the engine with single forward slashes, how changes are reported (compare them ignoring case)
+		static std::string NormalizePath(const std::string& filePath);
+
+	private:
+		void Watch();
+
+		std::string m_directory;
+		std::thread m_thread;
+		std::atomic<bool> m_watching	= false;
+		void* m_directoryHandle			= nullptr;
+		void* m_stopEvent				= nullptr;
+
+		typedef std::pair<std::string, std::chrono::steady_clock::time_point> Change;
+		RingQueue_SPSC<Change, FILE_WATCHER_QUEUE_SIZE> m_queue; // from the watcher thread to GetChanges
+		std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_changes; // when each file last changed, GetChanges' only
+	};
+}
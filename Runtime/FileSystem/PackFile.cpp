@@ -0,0 +1,270 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "PackFile.h"
+#include <memory>
+#include <shared_mutex>
+#include <fstream>
+#include <algorithm>
+#include "FileSystem.h"
+#include "../IO/FileStream.h"
+#include "../Logging/Log.h"
+#include <Windows.h>
+//===============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+#define PACK_MAGIC		0x4B415044 // "DPAK"
+#define PACK_VERSION	1
+#define PACK_ALIGNMENT	4096 // a page, so an entry starts where a read of it would anyway
+
+namespace Directus
+{
+	namespace _PackFile
+	{
+		vector<unique_ptr<PackFile>> packs;	// later mounted packs override earlier ones
+		shared_mutex packsMutex;
+	}
+
+	PackFile::~PackFile()
+	{
+		Close();
+	}
+
+	bool PackFile::Create(const string& packFilePath, const vector<string>& filePaths)
+	{
+		auto file = make_unique<FileStream>(packFilePath, FileStreamMode_Write);
+		if (!file->IsOpen())
+			return false;
+
+		file->Write((unsigned int)PACK_MAGIC);
+		file->Write((unsigned int)PACK_VERSION);
+		uint64_t position = sizeof(unsigned int) * 2;
+
+		vector<pair<string, Entry>> entries;
+		vector<std::byte> padding(PACK_ALIGNMENT);
+		for (const auto& filePath : filePaths)
+		{
+			ifstream in(filePath, ios::in | ios::binary | ios::ate);
+			if (in.fail())
+			{
+				LOGF_ERROR("PackFile::Create: Failed to read \"%s\", it's left out", filePath.c_str());
+				continue;
+			}
+
+			vector<char> bytes((size_t)in.tellg());
+			in.seekg(0);
+			in.read(bytes.data(), bytes.size());
+
+			uint64_t aligned = (position + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+			file->WriteBytes(padding.data(), (size_t)(aligned - position));
+			file->WriteBytes(bytes.data(), bytes.size());
+
+			Entry entry;
+			entry.offset	= aligned;
+			entry.size		= bytes.size();
+			entries.emplace_back(NormalizePath(FileSystem::GetRelativeFilePath(filePath)), entry);
+			position		= aligned + bytes.size();
+		}
+
+		// Table of contents, then where it starts
+		file->Write((unsigned int)entries.size());
+		for (const auto& entry : entries)
+		{
+			file->Write(entry.first);
+			file->Write(entry.second.offset);
+			file->Write(entry.second.size);
+			file->Write((unsigned int)entry.second.compression);
+		}
+		file->Write(position);
+
+		LOGF_INFO("PackFile::Create: Packed %d files into \"%s\"", (int)entries.size(), packFilePath.c_str());
+		return true;
+	}
+
+	bool PackFile::Mount(const string& packFilePath)
+	{
+		auto pack = make_unique<PackFile>();
+		if (!pack->Open(packFilePath))
+			return false;
+
+		LOGF_INFO("PackFile::Mount: Mounted \"%s\", %d files", packFilePath.c_str(), (int)pack->m_entries.size());
+		unique_lock<shared_mutex> lock(_PackFile::packsMutex);
+		_PackFile::packs.emplace_back(move(pack));
+		return true;
+	}
+
+	void PackFile::Mount_Directory(const string& directory)
+	{
+		if (!FileSystem::DirectoryExists(directory))
+			return;
+
+		for (const auto& filePath : FileSystem::GetFilesInDirectory(directory))
+		{
+			if (FileSystem::GetExtensionFromFilePath(filePath) == EXTENSION_PACK)
+			{
+				Mount(filePath);
+			}
+		}
+	}
+
+	void PackFile::Unmount_All()
+	{
+		unique_lock<shared_mutex> lock(_PackFile::packsMutex);
+		_PackFile::packs.clear();
+	}
+
+	bool PackFile::Find(const string& filePath, const std::byte** data, size_t* size)
+	{
+		shared_lock<shared_mutex> lock(_PackFile::packsMutex);
+		if (_PackFile::packs.empty())
+			return false;
+
+		auto path = NormalizePath(FileSystem::GetRelativeFilePath(filePath));
+		for (auto it = _PackFile::packs.rbegin(); it != _PackFile::packs.rend(); ++it)
+		{
+			auto& pack	= *it;
+			auto entry	= pack->m_entries.find(path);
+			if (entry == pack->m_entries.end())
+				continue;
+
+			if (data)	*data = pack->m_data + entry->second.offset;
+			if (size)	*size = (size_t)entry->second.size;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool PackFile::Locate(const string& filePath, string* packFilePath, uint64_t* offset, uint64_t* size)
+	{
+		shared_lock<shared_mutex> lock(_PackFile::packsMutex);
+		if (_PackFile::packs.empty())
+			return false;
+
+		auto path = NormalizePath(FileSystem::GetRelativeFilePath(filePath));
+		for (auto it = _PackFile::packs.rbegin(); it != _PackFile::packs.rend(); ++it)
+		{
+			auto& pack	= *it;
+			auto entry	= pack->m_entries.find(path);
+			if (entry == pack->m_entries.end())
+				continue;
+
+			*packFilePath	= pack->m_filePath;
+			*offset			= entry->second.offset;
+			*size			= entry->second.size;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool PackFile::Open(const string& packFilePath)
+	{
+		m_filePath	= packFilePath;
+		m_file		= CreateFileA(packFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+		{
+			m_file = nullptr;
+			LOGF_ERROR("PackFile::Open: Failed to open \"%s\"", packFilePath.c_str());
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		GetFileSizeEx(m_file, &size);
+		m_size		= (uint64_t)size.QuadPart;
+		m_mapping	= m_size != 0 ? CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+		m_data		= m_mapping ? static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+		if (!m_data)
+		{
+			LOGF_ERROR("PackFile::Open: Failed to map \"%s\"", packFilePath.c_str());
+			Close();
+			return false;
+		}
+
+		// Header
+		auto file = make_unique<FileStream>(m_data, (size_t)m_size);
+		unsigned int magic		= file->ReadUInt();
+		unsigned int version	= file->ReadUInt();
+		if (magic != PACK_MAGIC || version != PACK_VERSION || m_size < sizeof(unsigned int) * 2 + sizeof(uint64_t))
+		{
+			LOGF_ERROR("PackFile::Open: \"%s\" isn't a pack, or one of an unsupported version", packFilePath.c_str());
+			Close();
+			return false;
+		}
+
+		// Table of contents
+		uint64_t tocOffset = 0;
+		file->Seek(m_size - sizeof(uint64_t));
+		file->Read(&tocOffset);
+		file->Seek(tocOffset);
+
+		unsigned int count = file->ReadUInt();
+		for (unsigned int i = 0; i < count; i++)
+		{
+			string path;
+			Entry entry;
+			file->Read(&path);
+			file->Read(&entry.offset);
+			file->Read(&entry.size);
+			entry.compression = (PackCompression)file->ReadUInt();
+
+			if (entry.offset + entry.size > m_size || entry.compression != PackCompression_None)
+			{
+				LOGF_ERROR("PackFile::Open: \"%s\" in \"%s\" is invalid, it's skipped", path.c_str(), packFilePath.c_str());
+				continue;
+			}
+			m_entries[path] = entry;
+		}
+
+		return true;
+	}
+
+	void PackFile::Close()
+	{
+		if (m_data)		UnmapViewOfFile(m_data);
+		if (m_mapping)	CloseHandle(m_mapping);
+		if (m_file)		CloseHandle(m_file);
+		m_data		= nullptr;
+		m_mapping	= nullptr;
+		m_file		= nullptr;
+		m_entries.clear();
+	}
+
+	string PackFile::NormalizePath(const string& filePath)
+	{
+		string path;
+		path.reserve(filePath.size());
+		for (char c : filePath)
+		{
+			c = c == '\\' ? '/' : (char)tolower((unsigned char)c);
+			if (c == '/' && !path.empty() && path.back() == '/')
+				continue;
+
+			path += c;
+		}
+
+		return path;
+	}
+}
@@ -0,0 +1,84 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "../Core/EngineDefs.h"
+//==============================
+
+namespace Directus
+{
+	static const char* EXTENSION_PACK = ".pak";
+
+	enum PackCompression : unsigned int
+	{
+		PackCompression_None	// stored as is, the mapped bytes are read directly
+	};
+
+	// Many files in one, memory mapped, so shipping builds don't open thousands of small files. The layout is a header, every
+	// file (each aligned to PACK_ALIGNMENT in the pack), the table of contents and where it starts. A mounted pack is looked up
+	// before loose files by the FileStream, the XmlDocument and FileSystem::FileExists, by path relative to the engine.
+	class ENGINE_CLASS PackFile
+	{
+	public:
+		PackFile() = default;
+		~PackFile();
+
+		// Writes the files into a pack, their paths in it are the ones given (made relative to the engine)
+		static bool Create(const std::string& packFilePath, const std::vector<std::string>& filePaths);
+
+		//= MOUNTING ================================================================================
+		static bool Mount(const std::string& packFilePath);
+		// Mounts every pack in a directory
+		static void Mount_Directory(const std::string& directory);
+		// Nothing may be reading from a pack when it unmounts, the memory it was mapped to goes away
+		static void Unmount_All();
+		// Finds a file in the mounted packs, the data stays valid for as long as the pack is mounted
+		static bool Find(const std::string& filePath, const std::byte** data = nullptr, size_t* size = nullptr);
+		// Where a file is in the pack it's found in, for reads that go to the pack's file instead of its memory (see AsyncIO)
+		static bool Locate(const std::string& filePath, std::string* packFilePath, uint64_t* offset, uint64_t* size);
+		//===========================================================================================
+
+	private:
+		struct Entry
+		{
+			uint64_t offset		= 0;
+			uint64_t size		= 0;
+			PackCompression compression = PackCompression_None;
+		};
+
+		bool Open(const std::string& packFilePath);
+		void Close();
+		// Lowercase with forward slashes, how paths are stored and looked up
+		static std::string NormalizePath(const std::string& filePath);
+
+		std::string m_filePath;
+		std::unordered_map<std::string, Entry> m_entries;
+		const std::byte* m_data	= nullptr;
+		uint64_t m_size			= 0;
+		void* m_file			= nullptr;
+		void* m_mapping			= nullptr;
+	};
+}
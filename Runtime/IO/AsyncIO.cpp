@@ -0,0 +1,323 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "AsyncIO.h"
+#include <algorithm>
+#include <cstring>
+#include "../Core/Context.h"
+#include "../FileSystem/PackFile.h"
+#include "../Logging/Log.h"
+#include <Windows.h>
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	// Requests read by one ReadFile, into the buffer of the only one or into staging they are copied out of
+	struct AsyncIO::Batch
+	{
+		HANDLE file				= nullptr;
+		OVERLAPPED overlapped	= {};
+		uint64_t offset			= 0;
+		uint64_t size			= 0;
+		vector<Request> requests;
+		vector<std::byte> staging;
+	};
+
+	AsyncIO::AsyncIO(Context* context) : Subsystem(context)
+	{
+		m_threading = m_context->GetSubsystem<Threading>();
+	}
+
+	AsyncIO::~AsyncIO()
+	{
+		if (m_thread.joinable())
+		{
+			{
+				lock_guard<mutex> lock(m_mutex);
+				m_stopping = true;
+			}
+			SetEvent((HANDLE)m_wake);
+			m_thread.join();
+		}
+
+		for (auto& file : m_files)
+		{
+			CloseHandle((HANDLE)file.second.handle);
+		}
+		if (m_wake) CloseHandle((HANDLE)m_wake);
+	}
+
+	bool AsyncIO::Initialize()
+	{
+		m_wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+		if (!m_wake)
+		{
+			LOG_ERROR("AsyncIO::Initialize: Failed to create event");
+			return false;
+		}
+
+		m_thread = thread(&AsyncIO::Loop, this);
+		return true;
+	}
+
+	void AsyncIO::Read(const string& filePath, uint64_t offset, uint64_t size, void* buffer, IO_Priority priority, function<void(bool)>&& done, ThreadGroup group /*= ThreadGroup_Background*/)
+	{
+		Request request;
+		request.filePath	= filePath;
+		request.offset		= offset;
+		request.size		= size;
+		request.buffer		= static_cast<std::byte*>(buffer);
+		request.done		= move(done);
+		request.group		= group;
+
+		// A file in a pack is read from the pack's file
+		string packFilePath;
+		uint64_t entryOffset	= 0;
+		uint64_t entrySize		= 0;
+		bool valid = size != 0 && size <= 0xFFFFFFFF && m_thread.joinable();
+		if (valid && PackFile::Locate(filePath, &packFilePath, &entryOffset, &entrySize))
+		{
+			valid				= offset + size <= entrySize;
+			request.filePath	= packFilePath;
+			request.offset		= entryOffset + offset;
+		}
+
+		m_pending++;
+		if (!valid)
+		{
+			LOGF_ERROR("AsyncIO::Read: Can't read %llu bytes at %llu of \"%s\"", size, offset, filePath.c_str());
+			Batch batch;
+			batch.requests.emplace_back(move(request));
+			Batch_Complete(&batch, false);
+			return;
+		}
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_requests[priority].emplace_back(move(request));
+		}
+		SetEvent((HANDLE)m_wake);
+	}
+
+	void AsyncIO::Loop()
+	{
+		while (true)
+		{
+			{
+				lock_guard<mutex> lock(m_mutex);
+				if (m_stopping)
+					break;
+			}
+
+			// Keep the disk busy
+			while (m_inFlight.size() < ASYNC_IO_IN_FLIGHT)
+			{
+				auto batch = Batch_Next();
+				if (!batch)
+					break;
+
+				if (Batch_Issue(batch.get()))
+				{
+					m_inFlight.emplace_back(move(batch));
+				}
+				else
+				{
+					LOGF_ERROR("AsyncIO::Loop: Failed to read \"%s\"", batch->requests.front().filePath.c_str());
+					Batch_Complete(batch.get(), false);
+				}
+			}
+
+			// Wait for a read to finish or for more to read
+			HANDLE events[ASYNC_IO_IN_FLIGHT + 1] = { (HANDLE)m_wake };
+			for (size_t i = 0; i < m_inFlight.size(); i++)
+			{
+				events[i + 1] = m_inFlight[i]->overlapped.hEvent;
+			}
+			DWORD result = WaitForMultipleObjects((DWORD)m_inFlight.size() + 1, events, FALSE, INFINITE);
+			size_t index = (size_t)(result - WAIT_OBJECT_0);
+			if (index == 0 || index > m_inFlight.size())
+				continue;
+
+			auto& batch	= m_inFlight[index - 1];
+			DWORD bytes	= 0;
+			bool read	= GetOverlappedResult(batch->file, &batch->overlapped, &bytes, FALSE) && bytes == batch->size; // past the end of the file reads short
+			Batch_Complete(batch.get(), read);
+			m_inFlight.erase(m_inFlight.begin() + (index - 1));
+		}
+
+		// Nothing that was asked for is left waiting
+		for (auto& batch : m_inFlight)
+		{
+			CancelIo(batch->file);
+			WaitForSingleObject(batch->overlapped.hEvent, INFINITE);
+			Batch_Complete(batch.get(), false);
+		}
+		m_inFlight.clear();
+		while (auto batch = Batch_Next())
+		{
+			Batch_Complete(batch.get(), false);
+		}
+	}
+
+	unique_ptr<AsyncIO::Batch> AsyncIO::Batch_Next()
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		auto batch = make_unique<Batch>();
+		for (auto& requests : m_requests)
+		{
+			if (requests.empty())
+				continue;
+
+			batch->offset	= requests.front().offset;
+			batch->size		= requests.front().size;
+			batch->requests.emplace_back(move(requests.front()));
+			requests.pop_front();
+			break;
+		}
+		if (batch->requests.empty())
+			return nullptr;
+
+		// Whatever is next to it in the same file, however urgent, comes along
+		const auto& filePath = batch->requests.front().filePath;
+		for (bool merged = true; merged;)
+		{
+			merged = false;
+			for (auto& requests : m_requests)
+			{
+				for (auto it = requests.begin(); it != requests.end();)
+				{
+					uint64_t start	= min(batch->offset, it->offset);
+					uint64_t end	= max(batch->offset + batch->size, it->offset + it->size);
+					bool near		= it->offset <= batch->offset + batch->size + ASYNC_IO_MERGE_GAP && batch->offset <= it->offset + it->size + ASYNC_IO_MERGE_GAP;
+					if (it->filePath != filePath || !near || end - start > ASYNC_IO_MERGE_MAX)
+					{
+						++it;
+						continue;
+					}
+
+					batch->offset	= start;
+					batch->size		= end - start;
+					batch->requests.emplace_back(move(*it));
+					it		= requests.erase(it);
+					merged	= true;
+				}
+			}
+		}
+
+		return batch;
+	}
+
+	bool AsyncIO::Batch_Issue(Batch* batch)
+	{
+		batch->file = (HANDLE)File_Open(batch->requests.front().filePath);
+		if (!batch->file)
+			return false;
+
+		std::byte* target = batch->requests.front().buffer;
+		if (batch->requests.size() > 1)
+		{
+			batch->staging.resize((size_t)batch->size);
+			target = batch->staging.data();
+		}
+
+		batch->overlapped.Offset		= (DWORD)(batch->offset & 0xFFFFFFFF);
+		batch->overlapped.OffsetHigh	= (DWORD)(batch->offset >> 32);
+		batch->overlapped.hEvent		= CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		if (!batch->overlapped.hEvent)
+			return false;
+
+		// It may finish right away, the event is set either way
+		if (!ReadFile(batch->file, target, (DWORD)batch->size, nullptr, &batch->overlapped) && GetLastError() != ERROR_IO_PENDING)
+		{
+			CloseHandle(batch->overlapped.hEvent);
+			batch->overlapped.hEvent = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+
+	void AsyncIO::Batch_Complete(Batch* batch, bool success)
+	{
+		if (batch->overlapped.hEvent)
+		{
+			CloseHandle(batch->overlapped.hEvent);
+			batch->overlapped.hEvent = nullptr;
+		}
+
+		for (auto& request : batch->requests)
+		{
+			if (success && !batch->staging.empty())
+			{
+				memcpy(request.buffer, batch->staging.data() + (request.offset - batch->offset), (size_t)request.size);
+			}
+
+			m_pending--;
+			m_threading->AddTask(request.group, [done = move(request.done), success]() { done(success); });
+		}
+	}
+
+	void* AsyncIO::File_Open(const string& filePath)
+	{
+		auto it = m_files.find(filePath);
+		if (it == m_files.end())
+		{
+			// Shared for writing too, the editor saves over files that are being streamed
+			HANDLE handle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+			if (handle == INVALID_HANDLE_VALUE)
+				return nullptr;
+
+			File_Trim();
+			it = m_files.emplace(filePath, File{ handle, 0 }).first;
+		}
+
+		it->second.used = ++m_reads;
+		return it->second.handle;
+	}
+
+	void AsyncIO::File_Trim()
+	{
+		// Closes the least recently read files that no read is using
+		while (m_files.size() >= ASYNC_IO_FILES_MAX)
+		{
+			auto oldest = m_files.end();
+			for (auto it = m_files.begin(); it != m_files.end(); ++it)
+			{
+				bool reading = any_of(m_inFlight.begin(), m_inFlight.end(), [&it](const unique_ptr<Batch>& batch) { return batch->file == it->second.handle; });
+				if (!reading && (oldest == m_files.end() || it->second.used < oldest->second.used))
+				{
+					oldest = it;
+				}
+			}
+			if (oldest == m_files.end())
+				return;
+
+			CloseHandle((HANDLE)oldest->second.handle);
+			m_files.erase(oldest);
+		}
+	}
+}
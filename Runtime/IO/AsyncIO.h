@@ -0,0 +1,111 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES ===========================
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include "../Core/SubSystem.h"
+#include "../Threading/Threading.h"
+//======================================
+
+#define ASYNC_IO_IN_FLIGHT		8					// reads the disk is given at once, enough to keep its queue from running dry
+#define ASYNC_IO_MERGE_MAX		(1024 * 1024)		// reads of the same file next to each other are merged into one up to this size
+#define ASYNC_IO_MERGE_GAP		(16 * 1024)			// and that far apart, reading over a gap costs less than a seek
+#define ASYNC_IO_FILES_MAX		32					// files kept open between reads
+
+namespace Directus
+{
+	// Most urgent first, a read starts once every more urgent one has
+	enum IO_Priority
+	{
+		IO_Priority_Audio,		// a stream running dry is heard
+		IO_Priority_Streaming,	// mips something on screen is waiting for
+		IO_Priority_World,		// cells coming into range
+		IO_Priority_Background,	// previews and anything else nothing waits for
+		IO_Priority_Count
+	};
+
+	// Reads files without blocking the threads that want them. A thread of its own keeps a few overlapped reads in flight,
+	// picked by priority, merges the ones that are next to each other in a file (files in a mounted pack are reads of the
+	// pack's file, so neighbours in it merge too) and hands each completion to the job system as a task.
+	class ENGINE_CLASS AsyncIO : public Subsystem
+	{
+	public:
+		AsyncIO(Context* context);
+		~AsyncIO();
+
+		//= Subsystem =============
+		bool Initialize() override;
+		//=========================
+
+		// Reads bytes from an offset of a file into the buffer, which has to stay valid until done(success) runs as a task of
+		// the group. A read past the end of the file fails. Thread safe.
+		void Read(const std::string& filePath, uint64_t offset, uint64_t size, void* buffer, IO_Priority priority, std::function<void(bool)>&& done, ThreadGroup group = ThreadGroup_Background);
+		// Reads waiting or in flight
+		unsigned int GetPending() { return m_pending; }
+
+	private:
+		struct Request
+		{
+			std::string filePath;
+			uint64_t offset		= 0;
+			uint64_t size		= 0;
+			std::byte* buffer	= nullptr;
+			std::function<void(bool)> done;
+			ThreadGroup group	= ThreadGroup_Background;
+		};
+		struct Batch;
+
+		void Loop();
+		// The most urgent request and whatever merges with it, null if none is waiting
+		std::unique_ptr<Batch> Batch_Next();
+		bool Batch_Issue(Batch* batch);
+		void Batch_Complete(Batch* batch, bool success);
+		void* File_Open(const std::string& filePath);
+		void File_Trim();
+
+		std::deque<Request> m_requests[IO_Priority_Count];
+		std::vector<std::unique_ptr<Batch>> m_inFlight;
+		std::mutex m_mutex;
+		std::thread m_thread;
+		void* m_wake						= nullptr;
+		bool m_stopping						= false;
+		std::atomic<unsigned int> m_pending	= 0;
+		Threading* m_threading				= nullptr;
+
+		// Opened for overlapped reads, by path, with the last read they served
+		struct File
+		{
+			void* handle	= nullptr;
+			uint64_t used	= 0;
+		};
+		std::unordered_map<std::string, File> m_files;
+		uint64_t m_reads = 0;
+	};
+}
@@ -0,0 +1,546 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+//= INCLUDES ========================
+#include "BinaryDocument.h"
+#include <functional>
+#include <algorithm>
+#include "pugixml.hpp"
+#include "FileStream.h"
+#include "../Logging/Log.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+#include "../Math/Vector4.h"
+#include "../FileSystem/FileSystem.h"
+#include "../FileSystem/PackFile.h"
+//===================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace pugi;
+using namespace Directus::Math;
+//=============================
+
+#define BINARY_DOCUMENT_MAGIC	0x434F4442 // "BDOC"
+#define BINARY_DOCUMENT_VERSION	1
+
+namespace Directus
+{
+	//= NODES =======================================================================
+	void BinaryDocument::AddNode(const string& nodeName)
+	{
+		m_nodesByName.emplace(nodeName, (unsigned int)m_nodes.size());
+		m_nodes.emplace_back();
+		m_nodes.back().name = nodeName;
+	}
+
+	bool BinaryDocument::AddChildNode(const string& parentNodeName, const string& childNodeName)
+	{
+		auto it = m_nodesByName.find(parentNodeName);
+		if (it == m_nodesByName.end())
+		{
+			LOG_WARNING("BinaryDocument: Can't add child node \"" + childNodeName + "\", parent node \"" + parentNodeName + "\" doesn't exist.");
+			return false;
+		}
+
+		AddNode(childNodeName);
+		m_nodes.back().parent = (int)it->second;
+
+		return true;
+	}
+	//===============================================================================
+
+	//= ADD ATTRIBUTE ================================================================================================
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, const string& value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Text);
+		if (attribute)
+		{
+			attribute->text = value;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, bool value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Bool);
+		if (attribute)
+		{
+			attribute->values[0] = value ? 1.0 : 0.0;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, int value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Int);
+		if (attribute)
+		{
+			attribute->values[0] = value;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, unsigned int value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_UInt);
+		if (attribute)
+		{
+			attribute->values[0] = value;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, float value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Float);
+		if (attribute)
+		{
+			attribute->values[0] = value;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, double value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Double);
+		if (attribute)
+		{
+			attribute->values[0] = value;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, const Vector2& value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Vector2);
+		if (attribute)
+		{
+			attribute->values[0] = value.x;
+			attribute->values[1] = value.y;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, const Vector3& value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Vector3);
+		if (attribute)
+		{
+			attribute->values[0] = value.x;
+			attribute->values[1] = value.y;
+			attribute->values[2] = value.z;
+		}
+		return attribute != nullptr;
+	}
+
+	bool BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, const Vector4& value)
+	{
+		auto attribute = AddAttribute(nodeName, attributeName, Attribute_Vector4);
+		if (attribute)
+		{
+			attribute->values[0] = value.x;
+			attribute->values[1] = value.y;
+			attribute->values[2] = value.z;
+			attribute->values[3] = value.w;
+		}
+		return attribute != nullptr;
+	}
+	//================================================================================================================
+
+	//= GET ATTRIBUTE ===================================================================================
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, string* value)
+	{
+		auto attribute = GetAttribute(nodeName, attributeName);
+		if (!attribute)
+			return false;
+
+		*value = attribute->type == Attribute_Text ? attribute->text : ToText(*attribute);
+		return true;
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, int* value)
+	{
+		double number	= 0.0;
+		auto attribute	= GetAttribute(nodeName, attributeName);
+		if (!attribute || !GetNumber(*attribute, &number))
+			return false;
+
+		*value = (int)number;
+		return true;
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, unsigned int* value)
+	{
+		double number	= 0.0;
+		auto attribute	= GetAttribute(nodeName, attributeName);
+		if (!attribute || !GetNumber(*attribute, &number))
+			return false;
+
+		*value = (unsigned int)number;
+		return true;
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, bool* value)
+	{
+		auto attribute = GetAttribute(nodeName, attributeName);
+		if (!attribute)
+			return false;
+
+		// Text reads the way pugixml's as_bool() does
+		if (attribute->type == Attribute_Text)
+		{
+			char first	= attribute->text.empty() ? '\0' : attribute->text[0];
+			*value		= first == '1' || first == 't' || first == 'T' || first == 'y' || first == 'Y';
+			return true;
+		}
+
+		double number = 0.0;
+		if (!GetNumber(*attribute, &number))
+			return false;
+
+		*value = number != 0.0;
+		return true;
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, float* value)
+	{
+		double number	= 0.0;
+		auto attribute	= GetAttribute(nodeName, attributeName);
+		if (!attribute || !GetNumber(*attribute, &number))
+			return false;
+
+		*value = (float)number;
+		return true;
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, double* value)
+	{
+		auto attribute = GetAttribute(nodeName, attributeName);
+		return attribute && GetNumber(*attribute, value);
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, Vector2* value)
+	{
+		double values[2];
+		auto attribute = GetAttribute(nodeName, attributeName);
+		if (!attribute || !GetVector(*attribute, values, 2))
+			return false;
+
+		*value = Vector2((float)values[0], (float)values[1]);
+		return true;
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, Vector3* value)
+	{
+		double values[3];
+		auto attribute = GetAttribute(nodeName, attributeName);
+		if (!attribute || !GetVector(*attribute, values, 3))
+			return false;
+
+		*value = Vector3((float)values[0], (float)values[1], (float)values[2]);
+		return true;
+	}
+
+	bool BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName, Vector4* value)
+	{
+		double values[4];
+		auto attribute = GetAttribute(nodeName, attributeName);
+		if (!attribute || !GetVector(*attribute, values, 4))
+			return false;
+
+		*value = Vector4((float)values[0], (float)values[1], (float)values[2], (float)values[3]);
+		return true;
+	}
+	//====================================================================================================
+
+	//= IO ==============================================================================
+	bool BinaryDocument::Load(const string& filePath)
+	{
+		m_nodes.clear();
+		m_nodesByName.clear();
+
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_ReadMapped);
+		if (!file->IsOpen())
+			return false;
+
+		if (file->ReadUInt() != BINARY_DOCUMENT_MAGIC)
+		{
+			file.reset();
+			return Load_Xml(filePath);
+		}
+
+		if (file->ReadUInt() != BINARY_DOCUMENT_VERSION)
+		{
+			LOG_ERROR("BinaryDocument: \"" + filePath + "\" was written by a different version.");
+			return false;
+		}
+
+		unsigned int nodeCount = file->ReadUInt();
+		m_nodes.resize(nodeCount);
+		for (unsigned int i = 0; i < nodeCount; i++)
+		{
+			auto& node = m_nodes[i];
+			file->Read(&node.name);
+			node.parent = file->ReadInt();
+			node.attributes.resize(file->ReadUInt());
+			for (auto& attribute : node.attributes)
+			{
+				unsigned char type = 0;
+				file->Read(&attribute.name);
+				file->Read(&type);
+				attribute.type = (Attribute_Type)type;
+
+				bool boolean	= false;
+				int integer		= 0;
+				unsigned int natural = 0;
+				float floats[4]	= { 0.0f, 0.0f, 0.0f, 0.0f };
+				switch (attribute.type)
+				{
+					case Attribute_Text:	file->Read(&attribute.text); break;
+					case Attribute_Bool:	file->Read(&boolean);	attribute.values[0] = boolean ? 1.0 : 0.0; break;
+					case Attribute_Int:		file->Read(&integer);	attribute.values[0] = integer; break;
+					case Attribute_UInt:	file->Read(&natural);	attribute.values[0] = natural; break;
+					case Attribute_Double:	file->Read(&attribute.values[0]); break;
+					case Attribute_Float:
+					case Attribute_Vector2:
+					case Attribute_Vector3:
+					case Attribute_Vector4:
+					{
+						unsigned int count = attribute.type == Attribute_Float ? 1 : attribute.type - Attribute_Vector2 + 2;
+						file->ReadBytes(floats, sizeof(float) * count);
+						for (unsigned int j = 0; j < count; j++)
+						{
+							attribute.values[j] = floats[j];
+						}
+						break;
+					}
+					default:
+						LOG_ERROR("BinaryDocument: \"" + filePath + "\" is corrupt.");
+						m_nodes.clear();
+						return false;
+				}
+			}
+			m_nodesByName.emplace(node.name, i);
+		}
+
+		return true;
+	}
+
+	bool BinaryDocument::Save(const string& filePath)
+	{
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_WriteBuffered);
+		if (!file->IsOpen())
+			return false;
+
+		file->Write((unsigned int)BINARY_DOCUMENT_MAGIC);
+		file->Write((unsigned int)BINARY_DOCUMENT_VERSION);
+		file->Write((unsigned int)m_nodes.size());
+		for (const auto& node : m_nodes)
+		{
+			file->Write(node.name);
+			file->Write(node.parent);
+			file->Write((unsigned int)node.attributes.size());
+			for (const auto& attribute : node.attributes)
+			{
+				file->Write(attribute.name);
+				file->Write((unsigned char)attribute.type);
+				switch (attribute.type)
+				{
+					case Attribute_Text:	file->Write(attribute.text); break;
+					case Attribute_Bool:	file->Write(attribute.values[0] != 0.0); break;
+					case Attribute_Int:		file->Write((int)attribute.values[0]); break;
+					case Attribute_UInt:	file->Write((unsigned int)attribute.values[0]); break;
+					case Attribute_Double:	file->Write(attribute.values[0]); break;
+					default:
+					{
+						unsigned int count = attribute.type == Attribute_Float ? 1 : attribute.type - Attribute_Vector2 + 2;
+						for (unsigned int j = 0; j < count; j++)
+						{
+							file->Write((float)attribute.values[j]);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool BinaryDocument::Save_Xml(const string& filePath)
+	{
+		xml_document document;
+		auto declarationNode = document.append_child(node_declaration);
+		declarationNode.append_attribute("version")		= "1.0";
+		declarationNode.append_attribute("encoding")	= "ISO-8859-1";
+		declarationNode.append_attribute("standalone")	= "yes";
+
+		// Parents always come before their children
+		vector<xml_node> nodes;
+		for (const auto& node : m_nodes)
+		{
+			auto parent = node.parent >= 0 && node.parent < (int)nodes.size() ? nodes[node.parent] : document;
+			nodes.emplace_back(parent.append_child(node.name.c_str()));
+			for (const auto& attribute : node.attributes)
+			{
+				nodes.back().append_attribute(attribute.name.c_str()) = attribute.type == Attribute_Text ? attribute.text.c_str() : ToText(attribute).c_str();
+			}
+		}
+
+		return document.save_file(filePath.c_str());
+	}
+	//===================================================================================
+
+	//= PRIVATE =======================================================
+	BinaryDocument::Attribute* BinaryDocument::AddAttribute(const string& nodeName, const string& attributeName, Attribute_Type type)
+	{
+		auto it = m_nodesByName.find(nodeName);
+		if (it == m_nodesByName.end())
+		{
+			LOG_WARNING("BinaryDocument: Can't add attribute \"" + attributeName + "\", node \"" + nodeName + "\" doesn't exist.");
+			return nullptr;
+		}
+
+		// Adding it again replaces it
+		auto& attributes	= m_nodes[it->second].attributes;
+		auto attribute		= find_if(attributes.begin(), attributes.end(), [&attributeName](const Attribute& attribute) { return attribute.name == attributeName; });
+		if (attribute == attributes.end())
+		{
+			attributes.emplace_back();
+			attribute		= attributes.end() - 1;
+			attribute->name	= attributeName;
+		}
+		attribute->type = type;
+
+		return &(*attribute);
+	}
+
+	const BinaryDocument::Attribute* BinaryDocument::GetAttribute(const string& nodeName, const string& attributeName)
+	{
+		auto it = m_nodesByName.find(nodeName);
+		if (it == m_nodesByName.end())
+		{
+			LOG_WARNING("BinaryDocument: Can't get attribute \"" + attributeName + "\", node \"" + nodeName + "\" doesn't exist.");
+			return nullptr;
+		}
+
+		for (const auto& attribute : m_nodes[it->second].attributes)
+		{
+			if (attribute.name == attributeName)
+				return &attribute;
+		}
+
+		LOG_WARNING("BinaryDocument: Can't get attribute, attribute \"" + attributeName + "\" doesn't exist.");
+		return nullptr;
+	}
+
+	bool BinaryDocument::GetNumber(const Attribute& attribute, double* value)
+	{
+		if (attribute.type == Attribute_Text)
+		{
+			*value = atof(attribute.text.c_str());
+			return true;
+		}
+
+		if (attribute.type >= Attribute_Vector2)
+			return false;
+
+		*value = attribute.values[0];
+		return true;
+	}
+
+	bool BinaryDocument::GetVector(const Attribute& attribute, double* values, unsigned int count)
+	{
+		// As Vector::ToString() writes it, "X:1.0, Y:2.0"
+		if (attribute.type == Attribute_Text)
+		{
+			static const char* labels[] = { "X:", "Y:", "Z:", "W:" };
+			for (unsigned int i = 0; i < count; i++)
+			{
+				values[i] = atof((i + 1 < count ? FileSystem::GetStringBetweenExpressions(attribute.text, labels[i], ",") : FileSystem::GetStringAfterExpression(attribute.text, labels[i])).c_str());
+			}
+			return true;
+		}
+
+		if (attribute.type < Attribute_Vector2)
+			return false;
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			values[i] = attribute.values[i];
+		}
+		return true;
+	}
+
+	string BinaryDocument::ToText(const Attribute& attribute)
+	{
+		const double* v = attribute.values;
+		switch (attribute.type)
+		{
+			case Attribute_Bool:	return v[0] != 0.0 ? "true" : "false";
+			case Attribute_Int:		return to_string((int)v[0]);
+			case Attribute_UInt:	return to_string((unsigned int)v[0]);
+			case Attribute_Float:	return to_string((float)v[0]);
+			case Attribute_Double:	return to_string(v[0]);
+			case Attribute_Vector2:	return Vector2((float)v[0], (float)v[1]).ToString();
+			case Attribute_Vector3:	return Vector3((float)v[0], (float)v[1], (float)v[2]).ToString();
+			case Attribute_Vector4:	return Vector4((float)v[0], (float)v[1], (float)v[2], (float)v[3]).ToString();
+			default:				return attribute.text;
+		}
+	}
+
+	bool BinaryDocument::Load_Xml(const string& filePath)
+	{
+		xml_document document;
+		const std::byte* data	= nullptr;
+		size_t size				= 0;
+		xml_parse_result result = PackFile::Find(filePath, &data, &size) ? document.load_buffer(data, size) : document.load_file(filePath.c_str());
+		if (result.status != status_ok)
+		{
+			LOG_ERROR("BinaryDocument: \"" + filePath + "\" is neither binary nor XML (" + string(result.description()) + ").");
+			return false;
+		}
+
+		// Depth first, the order XmlDocument looks nodes up in
+		function<void(const xml_node&, int)> addNodes = [this, &addNodes](const xml_node& parent, int parentIndex)
+		{
+			for (auto child = parent.first_child(); child; child = child.next_sibling())
+			{
+				if (child.type() != node_element)
+					continue;
+
+				auto index = (int)m_nodes.size();
+				AddNode(child.name());
+				m_nodes.back().parent = parentIndex;
+				for (auto attribute = child.first_attribute(); attribute; attribute = attribute.next_attribute())
+				{
+					m_nodes[index].attributes.emplace_back();
+					m_nodes[index].attributes.back().name = attribute.name();
+					m_nodes[index].attributes.back().text = attribute.value();
+				}
+				addNodes(child, index);
+			}
+		};
+		addNodes(document, -1);
+
+		return true;
+	}
+}
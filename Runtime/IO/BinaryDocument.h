@@ -0,0 +1,137 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES ==================
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "../Core/EngineDefs.h"
+//=============================
+
+namespace Directus
+{
+	//= FORWARD DECLARATIONS =
+	namespace Math
+	{
+		class Vector2;
+		class Vector3;
+		class Vector4;
+	}
+	//========================
+
+	// The node and attribute model of the XmlDocument, stored typed and written as binary, so reading it back is a copy per
+	// value instead of a DOM parse and string conversions. Loading takes either format, a text attribute (what XML holds)
+	// is converted when it's read, so XML stays an import and export option (see Save_Xml).
+	class ENGINE_CLASS BinaryDocument
+	{
+	public:
+		BinaryDocument() = default;
+		~BinaryDocument() = default;
+
+		//= NODES =============================================================================
+		void AddNode(const std::string& nodeName);
+		bool AddChildNode(const std::string& parentNodeName, const std::string& childNodeName);
+		//=====================================================================================
+
+		//= ADD ATTRIBUTE ===============================================================================================
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, const std::string& value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, const char* value) { return AddAttribute(nodeName, attributeName, std::string(value)); }
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, bool value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, int value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, unsigned int value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, float value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, double value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, const Math::Vector2& value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, const Math::Vector3& value);
+		bool AddAttribute(const std::string& nodeName, const std::string& attributeName, const Math::Vector4& value);
+		//===============================================================================================================
+
+		//= GET ATTRIBUTE ===================================================================================
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, std::string* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, int* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, unsigned int* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, bool* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, float* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, double* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, Math::Vector2* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, Math::Vector3* value);
+		bool GetAttribute(const std::string& nodeName, const std::string& attributeName, Math::Vector4* value);
+
+		template <class T>
+		T GetAttributeAs(const std::string& nodeName, const std::string& attributeName)
+		{
+			T value = T();
+			GetAttribute(nodeName, attributeName, &value);
+			return value;
+		}
+		//====================================================================================================
+
+		//= IO ==============================================================================
+		// Either format, told apart by the first bytes
+		bool Load(const std::string& filePath);
+		bool Save(const std::string& filePath);
+		// The same nodes and attributes as an XmlDocument would write them
+		bool Save_Xml(const std::string& filePath);
+		//===================================================================================
+
+	private:
+		enum Attribute_Type : unsigned char
+		{
+			Attribute_Text,		// loaded from XML, converted to whatever it's read as
+			Attribute_Bool,
+			Attribute_Int,
+			Attribute_UInt,
+			Attribute_Float,
+			Attribute_Double,
+			Attribute_Vector2,
+			Attribute_Vector3,
+			Attribute_Vector4
+		};
+
+		struct Attribute
+		{
+			std::string name;
+			Attribute_Type type = Attribute_Text;
+			std::string text;
+			double values[4] = { 0.0, 0.0, 0.0, 0.0 };
+		};
+
+		struct Node
+		{
+			std::string name;
+			int parent = -1;
+			std::vector<Attribute> attributes;
+		};
+
+		Attribute* AddAttribute(const std::string& nodeName, const std::string& attributeName, Attribute_Type type);
+		// Null (and a warning) if either doesn't exist
+		const Attribute* GetAttribute(const std::string& nodeName, const std::string& attributeName);
+		static bool GetNumber(const Attribute& attribute, double* value);
+		static bool GetVector(const Attribute& attribute, double* values, unsigned int count);
+		static std::string ToText(const Attribute& attribute);
+		bool Load_Xml(const std::string& filePath);
+
+		std::vector<Node> m_nodes;
+		// The first node of every name, how nodes are looked up
+		std::unordered_map<std::string, unsigned int> m_nodesByName;
+	};
+}
@@ -0,0 +1,234 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========
+#include "Compression.h"
+#include <cstring>
+#include <vector>
+//=====================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+#define COMPRESSION_HASH_BITS		12
+#define COMPRESSION_MIN_MATCH		4
+#define COMPRESSION_LAST_LITERALS	5	// the format wants a block to end with literals
+#define COMPRESSION_MATCH_LIMIT		12	// and no match to start closer to the end than this
+#define COMPRESSION_MAX_OFFSET		65535
+
+namespace Directus
+{
+	namespace _Compression
+	{
+		inline uint32_t Read32(const uint8_t* data)
+		{
+			uint32_t value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		inline uint32_t Hash(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - COMPRESSION_HASH_BITS);
+		}
+
+		// A length of 15 or more continues in bytes of 255 and a remainder
+		inline uint8_t* WriteLength(uint8_t* output, size_t length)
+		{
+			for (; length >= 255; length -= 255)
+			{
+				*output++ = 255;
+			}
+			*output++ = (uint8_t)length;
+			return output;
+		}
+
+		inline bool ReadLength(const uint8_t*& input, const uint8_t* inputEnd, size_t* length)
+		{
+			uint8_t value;
+			do
+			{
+				if (input >= inputEnd)
+					return false;
+				value = *input++;
+				*length += value;
+			} while (value == 255);
+			return true;
+		}
+	}
+
+	size_t Compression::Compress(const byte* source, size_t size, byte* destination, size_t capacity)
+	{
+		const auto input		= reinterpret_cast<const uint8_t*>(source);
+		const auto inputEnd		= input + size;
+		auto output				= reinterpret_cast<uint8_t*>(destination);
+		const auto outputEnd	= output + capacity;
+		const uint8_t* anchor	= input;
+
+		// Emits the literals since the anchor, then the match (if any), false if it doesn't fit
+		auto emit = [&](size_t literals, size_t offset, size_t matchLength, bool last)
+		{
+			size_t needed = 1 + literals + literals / 255 + 1 + (last ? 0 : 2 + matchLength / 255 + 1);
+			if (needed > (size_t)(outputEnd - output))
+				return false;
+
+			uint8_t* token	= output++;
+			*token			= (uint8_t)((literals >= 15 ? 15 : literals) << 4);
+			if (literals >= 15)
+			{
+				output = _Compression::WriteLength(output, literals - 15);
+			}
+			memcpy(output, anchor, literals);
+			output += literals;
+
+			if (last)
+				return true;
+
+			*output++	= (uint8_t)(offset & 0xFF);
+			*output++	= (uint8_t)(offset >> 8);
+			*token		|= (uint8_t)(matchLength >= 15 ? 15 : matchLength);
+			if (matchLength >= 15)
+			{
+				output = _Compression::WriteLength(output, matchLength - 15);
+			}
+			return true;
+		};
+
+		if (size > COMPRESSION_MATCH_LIMIT)
+		{
+			vector<uint32_t> table(1 << COMPRESSION_HASH_BITS, 0);
+			const uint8_t* matchEnd	= inputEnd - COMPRESSION_LAST_LITERALS;
+			const uint8_t* scanEnd	= inputEnd - COMPRESSION_MATCH_LIMIT;
+			const uint8_t* position	= input;
+
+			while (position < scanEnd)
+			{
+				uint32_t sequence		= _Compression::Read32(position);
+				uint32_t& entry			= table[_Compression::Hash(sequence)];
+				const uint8_t* match	= input + entry;
+				entry					= (uint32_t)(position - input);
+
+				if (match >= position || position - match > COMPRESSION_MAX_OFFSET || _Compression::Read32(match) != sequence)
+				{
+					position++;
+					continue;
+				}
+
+				size_t offset		= position - match;
+				const uint8_t* end	= position + COMPRESSION_MIN_MATCH;
+				for (match += COMPRESSION_MIN_MATCH; end < matchEnd && *end == *match; end++, match++);
+
+				if (!emit(position - anchor, offset, end - position - COMPRESSION_MIN_MATCH, false))
+					return 0;
+
+				position	= end;
+				anchor		= position;
+			}
+		}
+
+		if (!emit(inputEnd - anchor, 0, 0, true))
+			return 0;
+
+		return output - reinterpret_cast<uint8_t*>(destination);
+	}
+
+	bool Compression::Decompress(const byte* source, size_t size, byte* destination, size_t destinationSize)
+	{
+		auto input				= reinterpret_cast<const uint8_t*>(source);
+		const auto inputEnd		= input + size;
+		const auto outputStart	= reinterpret_cast<uint8_t*>(destination);
+		auto output				= outputStart;
+		const auto outputEnd	= output + destinationSize;
+
+		while (input < inputEnd)
+		{
+			uint8_t token	= *input++;
+			size_t literals	= token >> 4;
+			if (literals == 15 && !_Compression::ReadLength(input, inputEnd, &literals))
+				return false;
+
+			if (literals > (size_t)(inputEnd - input) || literals > (size_t)(outputEnd - output))
+				return false;
+			memcpy(output, input, literals);
+			input	+= literals;
+			output	+= literals;
+
+			// The last sequence is only literals
+			if (input == inputEnd)
+				break;
+
+			if (inputEnd - input < 2)
+				return false;
+			size_t offset = input[0] | (input[1] << 8);
+			input += 2;
+			if (offset == 0 || offset > (size_t)(output - outputStart))
+				return false;
+
+			size_t length = token & 15;
+			if (length == 15 && !_Compression::ReadLength(input, inputEnd, &length))
+				return false;
+			length += COMPRESSION_MIN_MATCH;
+			if (length > (size_t)(outputEnd - output))
+				return false;
+
+			// Matches can overlap what they write (a run), those are copied a byte at a time
+			const uint8_t* match = output - offset;
+			if (offset >= length)
+			{
+				memcpy(output, match, length);
+				output += length;
+			}
+			else
+			{
+				for (size_t i = 0; i < length; i++)
+				{
+					*output++ = *match++;
+				}
+			}
+		}
+
+		return output == outputEnd;
+	}
+
+	uint32_t Compression::Checksum(const byte* data, size_t size)
+	{
+		auto bytes			= reinterpret_cast<const uint8_t*>(data);
+		uint32_t a			= 1;
+		uint32_t b			= 0;
+
+		// 5552 bytes is the most that can be summed before the modulo has to be taken
+		while (size > 0)
+		{
+			size_t chunk = size < 5552 ? size : 5552;
+			size -= chunk;
+			for (size_t i = 0; i < chunk; i++)
+			{
+				a += *bytes++;
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+
+		return (b << 16) | a;
+	}
+}
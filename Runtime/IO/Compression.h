@@ -0,0 +1,43 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==============
+#include <cstddef>
+#include <cstdint>
+//=========================
+
+namespace Directus
+{
+	// LZ4 block format (greedy, single pass), fast enough to decompress faster than a disk reads. Blocks are independent,
+	// so FileStream compresses them in parallel and decompresses only the ones it's read from.
+	class Compression
+	{
+	public:
+		// The compressed size, 0 if it doesn't fit in the capacity (store the block as is then)
+		static size_t Compress(const std::byte* source, size_t size, std::byte* destination, size_t capacity);
+		// False if the data is corrupt or doesn't decompress to exactly the destination size
+		static bool Decompress(const std::byte* source, size_t size, std::byte* destination, size_t destinationSize);
+		// Adler-32, what each block is checked against before it's used
+		static uint32_t Checksum(const std::byte* data, size_t size);
+	};
+}
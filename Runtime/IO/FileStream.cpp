@@ -30,6 +30,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Actor.h"
 #include "../Logging/Log.h"
 #include "../RHI/RHI_Vertex.h"
+#include "../FileSystem/PackFile.h"
+#include "../Threading/Threading.h"
+#include "Compression.h"
+#include <Windows.h>
 //==============================
 
 //= NAMESPACES ================
@@ -37,14 +41,40 @@ using namespace std;
 using namespace Directus::Math;
 //=============================
 
+#define FILESTREAM_COMPRESSED_MAGIC		0x5A4D4344	// "DCMZ"
+#define FILESTREAM_COMPRESSED_VERSION	1
+#define FILESTREAM_BLOCK_SIZE			(64 * 1024)	// as far back as a match can reach
+#define FILESTREAM_BLOCK_STORED			0x80000000	// set on the size of a block that didn't compress
+
 namespace Directus
 {
-	FileStream::FileStream(const string& path, FileStreamMode mode)
+	namespace _FileStream
+	{
+		// A compressed file is the header, a BlockEntry per block and the blocks, one after the other
+		struct Header
+		{
+			uint32_t magic		= FILESTREAM_COMPRESSED_MAGIC;
+			uint32_t version	= FILESTREAM_COMPRESSED_VERSION;
+			uint64_t size		= 0;	// uncompressed
+			uint32_t blockSize	= FILESTREAM_BLOCK_SIZE;
+			uint32_t blockCount	= 0;
+		};
+
+		struct BlockEntry
+		{
+			uint32_t size		= 0;
+			uint32_t checksum	= 0;
+		};
+	}
+
+	FileStream::FileStream(const string& path, FileStreamMode mode, Threading* threading /*= nullptr*/)
 	{
-		m_isOpen = false;
-		m_mode = mode;
+		m_isOpen	= false;
+		m_mode		= mode;
+		m_threading	= threading;
+		m_path		= path;
 
-		if (mode == FileStreamMode_Write)
+		if (mode == FileStreamMode_Write || mode == FileStreamMode_WriteBuffered || mode == FileStreamMode_WriteCompressed)
 		{
 			out.open(path, ios::out | ios::binary);
 			if (out.fail())
@@ -52,22 +82,107 @@ namespace Directus
 				LOGF_ERROR("StreamIO: Failed to open \"%s\" for writing", path.c_str());
 				return;
 			}
+
+			// Written out in one go when the stream closes
+			if (mode == FileStreamMode_WriteBuffered || mode == FileStreamMode_WriteCompressed)
+			{
+				m_buffer = &m_writeBuffer;
+			}
 		}
-		else if (mode == FileStreamMode_Read)
+		else if (mode == FileStreamMode_Read || mode == FileStreamMode_ReadMapped)
 		{
+			if (PackFile::Find(path, &m_memory, &m_memorySize))
+			{
+				m_isOpen = Blocks_Open();
+				return;
+			}
+
+			if (mode == FileStreamMode_ReadMapped)
+			{
+				m_isOpen = Map(path);
+				if (!m_isOpen)
+				{
+					LOGF_ERROR("StreamIO: Failed to open \"%s\" for reading", path.c_str());
+					return;
+				}
+				m_isOpen = Blocks_Open();
+				return;
+			}
+
 			in.open(path, ios::in | ios::binary);
 			if(in.fail())
 			{
 				LOGF_ERROR("StreamIO: Failed to open \"%s\" for reading", path.c_str());
 				return;
 			}
+
+			// A compressed file is read whole, the blocks are decompressed from memory
+			uint32_t magic = 0;
+			in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+			in.clear();
+			in.seekg(0, ios::end);
+			auto size = (size_t)in.tellg();
+			in.seekg(0);
+			if (magic == FILESTREAM_COMPRESSED_MAGIC)
+			{
+				m_fileBuffer.resize(size);
+				in.read(reinterpret_cast<char*>(m_fileBuffer.data()), size);
+				in.close();
+				m_memory		= m_fileBuffer.data();
+				m_memorySize	= size;
+				m_isOpen		= Blocks_Open();
+				return;
+			}
 		}
 
 		m_isOpen = true;
 	}
 
+	FileStream::FileStream(const std::byte* data, size_t size)
+	{
+		m_mode			= FileStreamMode_Read;
+		m_memory		= data;
+		m_memorySize	= size;
+		m_isOpen		= data != nullptr && Blocks_Open();
+	}
+
+	FileStream::FileStream(vector<std::byte>* buffer)
+	{
+		m_mode		= FileStreamMode_Write;
+		m_buffer	= buffer;
+		m_isOpen	= buffer != nullptr;
+	}
+
 	FileStream::~FileStream()
 	{
+		if (m_mapping)
+		{
+			UnmapViewOfFile(m_mapView);
+			CloseHandle(m_mapping);
+		}
+		if (m_mapFile)
+		{
+			CloseHandle(m_mapFile);
+		}
+
+		if (m_buffer == &m_writeBuffer)
+		{
+			if (m_mode == FileStreamMode_WriteCompressed)
+			{
+				Blocks_Write();
+			}
+			else
+			{
+				out.write(reinterpret_cast<const char*>(m_writeBuffer.data()), m_writeBuffer.size());
+			}
+			out.flush();
+			out.close();
+			return;
+		}
+
+		if (m_memory || m_buffer)
+			return;
+
 		if (m_mode == FileStreamMode_Write)
 		{
 			out.flush();
@@ -80,12 +195,300 @@ namespace Directus
 		}
 	}
 
+	bool FileStream::Map(const string& path)
+	{
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		GetFileSizeEx(file, &size);
+		m_mapFile		= file;
+		m_memorySize	= (size_t)size.QuadPart;
+
+		// An empty file can't be mapped, it reads as nothing
+		if (m_memorySize == 0)
+		{
+			m_fileBuffer.resize(1);
+			m_memory = m_fileBuffer.data();
+			return true;
+		}
+
+		m_mapping	= CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_mapView	= m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		m_memory	= static_cast<const std::byte*>(m_mapView);
+		if (m_memory)
+			return true;
+
+		// Mapping can fail (e.g. out of address space), the file is read whole instead
+		if (m_mapping)
+		{
+			CloseHandle(m_mapping);
+			m_mapping = nullptr;
+		}
+
+		m_fileBuffer.resize(m_memorySize);
+		DWORD read = 0;
+		bool result = ReadFile(file, m_fileBuffer.data(), (DWORD)m_memorySize, &read, nullptr) && read == (DWORD)m_memorySize;
+		m_memory = m_fileBuffer.data();
+
+		return result;
+	}
+
+	bool FileStream::Blocks_Open()
+	{
+		_FileStream::Header header;
+		if (m_memorySize < sizeof(header))
+			return true;
+
+		memcpy(&header, m_memory, sizeof(header));
+		if (header.magic != FILESTREAM_COMPRESSED_MAGIC)
+			return true;
+
+		uint64_t offset = sizeof(header) + (uint64_t)header.blockCount * sizeof(_FileStream::BlockEntry);
+		bool valid =
+			header.version == FILESTREAM_COMPRESSED_VERSION &&
+			header.blockSize != 0 &&
+			header.blockCount == (header.size + header.blockSize - 1) / header.blockSize &&
+			offset <= m_memorySize;
+
+		m_blocks.resize(valid ? header.blockCount : 0);
+		auto entries = m_memory + sizeof(header);
+		for (auto& block : m_blocks)
+		{
+			_FileStream::BlockEntry entry;
+			memcpy(&entry, entries, sizeof(entry));
+			entries += sizeof(entry);
+
+			block.offset	= offset;
+			block.size		= entry.size & ~FILESTREAM_BLOCK_STORED;
+			block.checksum	= entry.checksum;
+			block.stored	= (entry.size & FILESTREAM_BLOCK_STORED) != 0;
+			offset			+= block.size;
+		}
+
+		if (!valid || offset > m_memorySize)
+		{
+			LOGF_ERROR("StreamIO: \"%s\" isn't a valid compressed file", m_path.c_str());
+			m_blocks.clear();
+			return false;
+		}
+
+		// An empty file still reads from memory
+		m_decompressed.resize(header.size > 0 ? (size_t)header.size : 1);
+		m_compressed		= m_memory;
+		m_blockSize			= header.blockSize;
+		m_memory			= m_decompressed.data();
+		m_memorySize		= (size_t)header.size;
+		m_memoryPosition	= 0;
+
+		return true;
+	}
+
+	void FileStream::Blocks_Decompress(size_t position, size_t size)
+	{
+		if (size == 0 || position >= m_memorySize)
+			return;
+
+		auto first	= (unsigned int)(position / m_blockSize);
+		auto last	= (unsigned int)((std::min(position + size, m_memorySize) - 1) / m_blockSize);
+		vector<unsigned int> pending;
+		for (unsigned int i = first; i <= last; i++)
+		{
+			if (!m_blocks[i].decompressed)
+			{
+				pending.emplace_back(i);
+			}
+		}
+
+		auto decompress = [this, &pending](unsigned int start, unsigned int end)
+		{
+			for (unsigned int i = start; i < end; i++)
+			{
+				auto index			= pending[i];
+				auto& block			= m_blocks[index];
+				size_t offset		= (size_t)index * m_blockSize;
+				size_t size			= std::min(m_blockSize, m_memorySize - offset);
+				auto destination	= m_decompressed.data() + offset;
+				auto source			= m_compressed + block.offset;
+
+				bool valid = block.stored ? block.size == size : Compression::Decompress(source, block.size, destination, size);
+				if (valid && block.stored)
+				{
+					memcpy(destination, source, size);
+				}
+
+				// What's corrupt reads as zeros, rather than as garbage
+				if (!valid || Compression::Checksum(destination, size) != block.checksum)
+				{
+					memset(destination, 0, size);
+					LOGF_ERROR("StreamIO: Block %u of \"%s\" is corrupt", index, m_path.c_str());
+				}
+				block.decompressed = true;
+			}
+		};
+
+		if (m_threading && pending.size() > 1)
+		{
+			m_threading->Parallel_For(0, (unsigned int)pending.size(), 1, decompress);
+		}
+		else
+		{
+			decompress(0, (unsigned int)pending.size());
+		}
+	}
+
+	void FileStream::Blocks_Write()
+	{
+		_FileStream::Header header;
+		header.size			= m_writeBuffer.size();
+		header.blockCount	= (uint32_t)((header.size + FILESTREAM_BLOCK_SIZE - 1) / FILESTREAM_BLOCK_SIZE);
+
+		// Every block compresses into its own slot, so they can in parallel. One that doesn't get smaller is stored.
+		vector<_FileStream::BlockEntry> entries(header.blockCount);
+		vector<std::byte> compressed(m_writeBuffer.size());
+		auto compress = [this, &entries, &compressed](unsigned int start, unsigned int end)
+		{
+			for (unsigned int i = start; i < end; i++)
+			{
+				size_t offset	= (size_t)i * FILESTREAM_BLOCK_SIZE;
+				size_t size		= std::min((size_t)FILESTREAM_BLOCK_SIZE, m_writeBuffer.size() - offset);
+				auto source		= m_writeBuffer.data() + offset;
+				size_t result	= size > 1 ? Compression::Compress(source, size, compressed.data() + offset, size - 1) : 0;
+
+				entries[i].size		= result != 0 ? (uint32_t)result : (uint32_t)size | FILESTREAM_BLOCK_STORED;
+				entries[i].checksum	= Compression::Checksum(source, size);
+			}
+		};
+
+		if (m_threading && header.blockCount > 1)
+		{
+			m_threading->Parallel_For(0, header.blockCount, 1, compress);
+		}
+		else
+		{
+			compress(0, header.blockCount);
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(_FileStream::BlockEntry));
+		for (unsigned int i = 0; i < header.blockCount; i++)
+		{
+			size_t offset	= (size_t)i * FILESTREAM_BLOCK_SIZE;
+			bool stored		= (entries[i].size & FILESTREAM_BLOCK_STORED) != 0;
+			auto data		= stored ? m_writeBuffer.data() + offset : compressed.data() + offset;
+			out.write(reinterpret_cast<const char*>(data), entries[i].size & ~FILESTREAM_BLOCK_STORED);
+		}
+	}
+
+	void FileStream::Chunk_Begin(uint32_t type, uint32_t version)
+	{
+		Write((unsigned int)type);
+		Write((unsigned int)version);
+		Write((uint64_t)0); // patched by Chunk_End()
+
+		m_chunksWritten.emplace_back(m_buffer ? (uint64_t)m_buffer->size() : (uint64_t)out.tellp());
+	}
+
+	void FileStream::Chunk_End()
+	{
+		if (m_chunksWritten.empty())
+		{
+			LOG_ERROR("StreamIO: Chunk_End() without a Chunk_Begin()");
+			return;
+		}
+
+		uint64_t start = m_chunksWritten.back();
+		m_chunksWritten.pop_back();
+
+		uint64_t offset = start - sizeof(uint64_t);
+		if (m_buffer)
+		{
+			uint64_t size = m_buffer->size() - start;
+			memcpy(m_buffer->data() + offset, &size, sizeof(size));
+			return;
+		}
+
+		auto end		= out.tellp();
+		uint64_t size	= (uint64_t)end - start;
+		out.seekp((streamoff)offset);
+		out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		out.seekp(end);
+	}
+
+	bool FileStream::Chunk_Read(FileStreamChunk* chunk)
+	{
+		const uint64_t headerSize	= sizeof(unsigned int) * 2 + sizeof(uint64_t);
+		uint64_t position			= GetPosition();
+		uint64_t limit				= m_chunksRead.empty() ? (m_memory ? (uint64_t)m_memorySize : UINT64_MAX) : m_chunksRead.back().end;
+		if (position > limit || limit - position < headerSize)
+			return false;
+
+		chunk->type		= ReadUInt();
+		chunk->version	= ReadUInt();
+		Read(&chunk->size);
+		chunk->end		= position + headerSize + chunk->size;
+
+		// A size that doesn't fit is what's left of a corrupt file, or of one that has no chunks
+		bool valid = (m_memory || !in.fail()) && chunk->size <= limit - position - headerSize;
+		if (!valid)
+		{
+			in.clear();
+			Seek(position);
+			return false;
+		}
+
+		m_chunksRead.emplace_back(*chunk);
+		return true;
+	}
+
+	bool FileStream::Chunk_Find(uint32_t type, FileStreamChunk* chunk)
+	{
+		while (Chunk_Read(chunk))
+		{
+			if (chunk->type == type)
+				return true;
+
+			Chunk_Leave(*chunk);
+		}
+
+		return false;
+	}
+
+	bool FileStream::Chunk_Enter(uint32_t type, FileStreamChunk* chunk)
+	{
+		uint64_t position = GetPosition();
+		if (!Chunk_Read(chunk))
+			return false;
+
+		if (chunk->type == type)
+			return true;
+
+		m_chunksRead.pop_back();
+		Seek(position);
+		return false;
+	}
+
+	void FileStream::Chunk_Leave(const FileStreamChunk& chunk)
+	{
+		// Any chunk it holds that's still open is left too
+		while (!m_chunksRead.empty())
+		{
+			bool found = m_chunksRead.back().end == chunk.end && m_chunksRead.back().type == chunk.type;
+			m_chunksRead.pop_back();
+			if (found)
+				break;
+		}
+
+		Seek(chunk.end);
+	}
+
 	void FileStream::Write(const string& value)
 	{
 		auto length = (unsigned int)value.length();
 		Write(length);
 
-		out.write(const_cast<char*>(value.c_str()), length);
+		WriteBytes(const_cast<char*>(value.c_str()), length);
 	}
 
 	void FileStream::Write(const vector<string>& value)
@@ -101,55 +504,69 @@ namespace Directus
 
 	void FileStream::Write(const Vector2& value)
 	{
-		out.write(reinterpret_cast<const char*>(&value), sizeof(Vector2));
+		WriteBytes(reinterpret_cast<const char*>(&value), sizeof(Vector2));
 	}
 
 	void FileStream::Write(const Vector3& value)
 	{
-		out.write(reinterpret_cast<const char*>(&value), sizeof(Vector3));
+		WriteBytes(reinterpret_cast<const char*>(&value), sizeof(Vector3));
 	}
 
 	void FileStream::Write(const Vector4& value)
 	{
-		out.write(reinterpret_cast<const char*>(&value), sizeof(Vector4));
+		WriteBytes(reinterpret_cast<const char*>(&value), sizeof(Vector4));
 	}
 
 	void FileStream::Write(const Quaternion& value)
 	{
-		out.write(reinterpret_cast<const char*>(&value), sizeof(Quaternion));
+		WriteBytes(reinterpret_cast<const char*>(&value), sizeof(Quaternion));
 	}
 
 	void FileStream::Write(const BoundingBox& value)
 	{
-		out.write(reinterpret_cast<const char*>(&value), sizeof(BoundingBox));
+		WriteBytes(reinterpret_cast<const char*>(&value), sizeof(BoundingBox));
 	}
 
 	void FileStream::Write(const vector<RHI_Vertex_PosUVTBN>& value)
 	{
 		auto length = (unsigned int)value.size();
 		Write(length);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosUVTBN) * length);
+		WriteBytes(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosUVTBN) * length);
+	}
+
+	void FileStream::Write(const vector<RHI_Vertex_PosUVTBNPacked>& value)
+	{
+		auto length = (unsigned int)value.size();
+		Write(length);
+		WriteBytes(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosUVTBNPacked) * length);
 	}
 
 	void FileStream::Write(const vector<unsigned int>& value)
 	{
 		auto length = (unsigned int)value.size();
 		Write(length);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned int) * length);
+		WriteBytes(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned int) * length);
+	}
+
+	void FileStream::Write(const vector<uint16_t>& value)
+	{
+		auto length = (unsigned int)value.size();
+		Write(length);
+		WriteBytes(reinterpret_cast<const char*>(&value[0]), sizeof(uint16_t) * length);
 	}
 
 	void FileStream::Write(const vector<unsigned char>& value)
 	{
 		auto size = (unsigned int)value.size();
 		Write(size);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+		WriteBytes(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
 	}
 
 	void FileStream::Write(const vector<std::byte>& value)
 	{
 		auto size = (unsigned int)value.size();
 		Write(size);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+		WriteBytes(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
 	}
 
 	void FileStream::Read(string* value)
@@ -158,32 +575,32 @@ namespace Directus
 		Read(&length);
 
 		value->resize(length);
-		in.read(const_cast<char*>(value->c_str()), length);
+		ReadBytes(const_cast<char*>(value->c_str()), length);
 	}
 
 	void FileStream::Read(Vector2* value)
 	{
-		in.read(reinterpret_cast<char*>(value), sizeof(Vector2));
+		ReadBytes(reinterpret_cast<char*>(value), sizeof(Vector2));
 	}
 
 	void FileStream::Read(Vector3* value)
 	{
-		in.read(reinterpret_cast<char*>(value), sizeof(Vector3));
+		ReadBytes(reinterpret_cast<char*>(value), sizeof(Vector3));
 	}
 
 	void FileStream::Read(Vector4* value)
 	{
-		in.read(reinterpret_cast<char*>(value), sizeof(Vector4));
+		ReadBytes(reinterpret_cast<char*>(value), sizeof(Vector4));
 	}
 
 	void FileStream::Read(Quaternion* value)
 	{
-		in.read(reinterpret_cast<char*>(value), sizeof(Quaternion));
+		ReadBytes(reinterpret_cast<char*>(value), sizeof(Quaternion));
 	}
 
 	void FileStream::Read(BoundingBox* value)
 	{
-		in.read(reinterpret_cast<char*>(value), sizeof(BoundingBox));
+		ReadBytes(reinterpret_cast<char*>(value), sizeof(BoundingBox));
 	}
 
 	void FileStream::Read(vector<string>* vec)
@@ -210,15 +627,21 @@ namespace Directus
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
-
 		unsigned int length = ReadUInt();
+		vec->resize(length);
+
+		ReadBytes(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosUVTBN) * length);
+	}
 
-		vec->reserve(length);
+	void FileStream::Read(vector<RHI_Vertex_PosUVTBNPacked>* vec)
+	{
+		if (!vec)
+			return;
+
+		unsigned int length = ReadUInt();
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosUVTBN) * length);
+		ReadBytes(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosUVTBNPacked) * length);
 	}
 
 	void FileStream::Read(vector<unsigned int>* vec)
@@ -226,15 +649,21 @@ namespace Directus
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
-
 		unsigned int length = ReadUInt();
+		vec->resize(length);
+
+		ReadBytes(reinterpret_cast<char*>(vec->data()), sizeof(unsigned int) * length);
+	}
+
+	void FileStream::Read(vector<uint16_t>* vec)
+	{
+		if (!vec)
+			return;
 
-		vec->reserve(length);
+		unsigned int length = ReadUInt();
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned int) * length);
+		ReadBytes(reinterpret_cast<char*>(vec->data()), sizeof(uint16_t) * length);
 	}
 
 	void FileStream::Read(vector<unsigned char>* vec)
@@ -242,15 +671,10 @@ namespace Directus
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
-
 		unsigned int length = ReadUInt();
-
-		vec->reserve(length);
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+		ReadBytes(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
 	}
 
 	void FileStream::Read(vector<std::byte>* vec)
@@ -258,14 +682,9 @@ namespace Directus
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
-
 		unsigned int length = ReadUInt();
-
-		vec->reserve(length);
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+		ReadBytes(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
 	}
 }
@@ -24,12 +24,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====
 #include <vector>
 #include <fstream>
+#include <cstring>
+#include <algorithm>
 //================
 
 namespace Directus
 {
 	class Actor;
+	class Threading;
 	struct RHI_Vertex_PosUVTBN;
+	struct RHI_Vertex_PosUVTBNPacked;
 	namespace Math
 	{
 		class Vector2;
@@ -42,22 +46,46 @@ namespace Directus
 	enum FileStreamMode
 	{
 		FileStreamMode_Read,
-		FileStreamMode_Write
+		FileStreamMode_Write,
+		FileStreamMode_ReadMapped,		// maps the whole file, reads copy from the mapping and spans point into it
+		FileStreamMode_WriteBuffered,	// accumulates everything in memory, the file is written at once when the stream closes
+		FileStreamMode_WriteCompressed	// buffered, then written as compressed blocks, reading decompresses them transparently
+	};
+
+	// A tagged, sized run of bytes (see FileStream::Chunk_Begin), readers skip what they don't know or don't need
+	struct FileStreamChunk
+	{
+		uint32_t type		= 0;
+		uint32_t version	= 0;
+		uint64_t size		= 0; // of what follows the header
+		uint64_t end		= 0; // where the stream is once the chunk is left
 	};
 
 	class FileStream
 	{
 	public:
-		FileStream(const std::string& path, FileStreamMode mode);
+		// Reading, a file in a mounted pack is read from the pack's memory (see PackFile). A compressed file is read in any
+		// read mode, the blocks a read touches are decompressed as it happens. Threading is optional, it spreads compressing
+		// on close, and decompressing reads that span many blocks, over the workers.
+		FileStream(const std::string& path, FileStreamMode mode, Threading* threading = nullptr);
+		// Reads from memory instead of a file, the data has to outlive the stream. Compressed data is read like a compressed file.
+		FileStream(const std::byte* data, size_t size);
+		// Writes to memory instead of a file, appending to the buffer
+		FileStream(std::vector<std::byte>* buffer);
 		~FileStream();
 
 		bool IsOpen() { return m_isOpen; }
+		// Reads come from memory (a mapped file, a pack or a buffer), so spans can be read
+		bool IsMemory() { return m_memory != nullptr; }
+		// The file is a compressed container, what is read isn't where it is in the file
+		bool IsCompressed() { return !m_blocks.empty(); }
 
 		//= WRITING ==================================================
 		template <class T, class = typename std::enable_if<
 			std::is_same<T, int>::value || 
 			std::is_same<T, unsigned int>::value ||
 			std::is_same<T, unsigned long>::value ||
+			std::is_same<T, uint64_t>::value ||
 			std::is_same<T, unsigned char>::value ||
 			std::is_same<T, std::byte>::value ||
 			std::is_same<T, float>::value ||
@@ -66,7 +94,7 @@ namespace Directus
 		>::type>
 		void Write(T value)
 		{
-			out.write(reinterpret_cast<char*>(&value), sizeof(value));
+			WriteBytes(&value, sizeof(value));
 		}
 
 		void Write(const std::string& value);
@@ -77,7 +105,9 @@ namespace Directus
 		void Write(const Math::BoundingBox& value);
 		void Write(const std::vector<std::string>& value);
 		void Write(const std::vector<RHI_Vertex_PosUVTBN>& value);
+		void Write(const std::vector<RHI_Vertex_PosUVTBNPacked>& value);
 		void Write(const std::vector<unsigned int>& value);
+		void Write(const std::vector<uint16_t>& value);
 		void Write(const std::vector<unsigned char>& value);
 		void Write(const std::vector<std::byte>& value);
 		//===========================================================
@@ -87,6 +117,7 @@ namespace Directus
 			std::is_same<T, int>::value ||
 			std::is_same<T, unsigned int>::value ||
 			std::is_same<T, unsigned long>::value ||
+			std::is_same<T, uint64_t>::value ||
 			std::is_same<T, unsigned char>::value ||
 			std::is_same<T, std::byte>::value ||
 			std::is_same<T, float>::value ||
@@ -95,7 +126,7 @@ namespace Directus
 		>::type>
 			void Read(T* value)
 		{
-			in.read(reinterpret_cast<char*>(value), sizeof(T));
+			ReadBytes(value, sizeof(T));
 		}
 
 		void Read(std::string* value);	
@@ -106,7 +137,9 @@ namespace Directus
 		void Read(Math::BoundingBox* value);
 		void Read(std::vector<std::string>* vec);
 		void Read(std::vector<RHI_Vertex_PosUVTBN>* vec);
+		void Read(std::vector<RHI_Vertex_PosUVTBNPacked>* vec);
 		void Read(std::vector<unsigned int>* vec);
+		void Read(std::vector<uint16_t>* vec);
 		void Read(std::vector<unsigned char>* vec);
 		void Read(std::vector<std::byte>* vec);
 
@@ -124,12 +157,148 @@ namespace Directus
 			Read(&value);
 			return value;
 		}
+
+		// The next bytes, without copying them, valid as long as the stream is. Null if the stream doesn't read from memory
+		// (nothing is consumed then) or if there aren't that many bytes left. What's written isn't padded, so a span of a
+		// type can be unaligned, which the vertex and index types in it don't mind on the platforms the engine runs on.
+		const std::byte* ReadSpan(size_t size)
+		{
+			if (!m_memory || m_memoryPosition > m_memorySize || size > m_memorySize - m_memoryPosition)
+				return nullptr;
+
+			if (!m_blocks.empty())
+			{
+				Blocks_Decompress(m_memoryPosition, size);
+			}
+
+			auto span = m_memory + m_memoryPosition;
+			m_memoryPosition += size;
+			return span;
+		}
+
+		template <class T>
+		const T* ReadSpan(size_t count) { return reinterpret_cast<const T*>(ReadSpan(count * sizeof(T))); }
+
+		// An array as Write() writes a vector, its length first
+		template <class T>
+		const T* ReadArraySpan(unsigned int* count)
+		{
+			if (!m_memory)
+				return nullptr;
+
+			auto position	= m_memoryPosition;
+			*count			= ReadUInt();
+			if (auto span = ReadSpan<T>(*count))
+				return span;
+
+			m_memoryPosition = position;
+			*count = 0;
+			return nullptr;
+		}
+
+		//= CHUNKS ==================================================================================================
+		// Everything written until the matching Chunk_End() goes in a chunk of a type and a version, chunks nest. A type is a
+		// four character code, or anything else that's unique among the chunks next to it (e.g. a component type).
+		void Chunk_Begin(uint32_t type, uint32_t version);
+		void Chunk_End();
+		// Enters the next chunk, false (and nothing consumed) if there is none before the end of the one being read
+		bool Chunk_Read(FileStreamChunk* chunk);
+		// Enters the next chunk of a type, skipping any other in the way
+		bool Chunk_Find(uint32_t type, FileStreamChunk* chunk);
+		// Enters the next chunk if it's of a type, false (and nothing consumed) otherwise, e.g. for data from before chunks
+		bool Chunk_Enter(uint32_t type, FileStreamChunk* chunk);
+		// Continues after the chunk, however much of it was read (an older reader stops short of newer fields)
+		void Chunk_Leave(const FileStreamChunk& chunk);
+		// Of the chunk being read, readers branch on it to load what older versions wrote. 0 outside of any.
+		uint32_t Chunk_GetVersion() { return m_chunksRead.empty() ? 0 : m_chunksRead.back().version; }
+		//=============================================================================================================
+
+		// Lets a reader jump over (or back to) data it doesn't need yet
+		uint64_t GetPosition()				{ return m_memory ? (uint64_t)m_memoryPosition : (uint64_t)in.tellg(); }
+		void Seek(uint64_t position)		{ if (m_memory) m_memoryPosition = (size_t)position; else in.seekg((std::streamoff)position); }
+		void Skip(uint64_t size)			{ if (m_memory) m_memoryPosition += (size_t)size; else in.seekg((std::streamoff)size, std::ios::cur); }
 		//==========================================================
 
+		//= RAW BYTES =================================================================
+		void WriteBytes(const void* data, size_t size)
+		{
+			if (m_buffer)
+			{
+				auto bytes = reinterpret_cast<const std::byte*>(data);
+				m_buffer->insert(m_buffer->end(), bytes, bytes + size);
+				return;
+			}
+
+			out.write(reinterpret_cast<const char*>(data), size);
+		}
+
+		void ReadBytes(void* data, size_t size)
+		{
+			if (m_memory)
+			{
+				size = m_memoryPosition < m_memorySize ? std::min(size, m_memorySize - m_memoryPosition) : 0;
+				if (!m_blocks.empty())
+				{
+					Blocks_Decompress(m_memoryPosition, size);
+				}
+				memcpy(data, m_memory + m_memoryPosition, size);
+				m_memoryPosition += size;
+				return;
+			}
+
+			in.read(reinterpret_cast<char*>(data), size);
+		}
+		//=============================================================================
+
 	private:
+		bool Map(const std::string& path);
+
+		//= COMPRESSION =============================================================
+		// Called once the file's bytes are in memory, does nothing if they aren't compressed. False if the header is corrupt.
+		bool Blocks_Open();
+		// Decompresses the blocks in the range that haven't been yet
+		void Blocks_Decompress(size_t position, size_t size);
+		void Blocks_Write();
+
+		struct Block
+		{
+			uint64_t offset		= 0; // in the compressed data
+			uint32_t size		= 0; // compressed, the block's uncompressed size if it's stored as is
+			uint32_t checksum	= 0; // of the uncompressed bytes
+			bool stored			= false;
+			bool decompressed	= false;
+		};
+		//===========================================================================
+
 		std::ofstream out;
 		std::ifstream in;
 		FileStreamMode m_mode;
 		bool m_isOpen;
+
+		// Memory, instead of a file
+		const std::byte* m_memory			= nullptr;
+		size_t m_memorySize					= 0;
+		size_t m_memoryPosition				= 0;
+		std::vector<std::byte>* m_buffer	= nullptr;
+
+		// FileStreamMode_ReadMapped, a file read whole into memory if it can't be mapped
+		void* m_mapFile						= nullptr;
+		void* m_mapping						= nullptr;
+		const void* m_mapView				= nullptr;
+		std::vector<std::byte> m_fileBuffer;
+		// FileStreamMode_WriteBuffered and FileStreamMode_WriteCompressed
+		std::vector<std::byte> m_writeBuffer;
+
+		// Where the chunks being written start, and the ones being read
+		std::vector<uint64_t> m_chunksWritten;
+		std::vector<FileStreamChunk> m_chunksRead;
+
+		// A compressed file, m_memory points to what it decompresses to
+		std::vector<Block> m_blocks;
+		size_t m_blockSize					= 0;
+		std::vector<std::byte> m_decompressed;
+		const std::byte* m_compressed		= nullptr;
+		Threading* m_threading				= nullptr;
+		std::string m_path;
 	};
 }
@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
 #include "../FileSystem/FileSystem.h"
+#include "../FileSystem/PackFile.h"
 //===================================
 
 //= NAMESPACES ================
@@ -257,7 +258,9 @@ namespace Directus
 	bool XmlDocument::Load(const string& filePath)
 	{
 		m_document = make_unique<xml_document>();
-		xml_parse_result result = m_document->load_file(filePath.c_str());
+		const std::byte* data	= nullptr;
+		size_t size				= 0;
+		xml_parse_result result = PackFile::Find(filePath, &data, &size) ? m_document->load_buffer(data, size) : m_document->load_file(filePath.c_str());
 
 		if (result.status != status_ok)
 		{
@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Input_Implementation.h"
 #include "../Input.h"
 #include <sstream>
+#include <chrono>
+#include <algorithm>
 #include "dinput.h"
 #include "xinput.h"
 #include "../../Logging/Log.h"
@@ -37,15 +39,95 @@ using namespace Directus::Math;
 using namespace Helper;
 //=============================
 
+#define INPUT_DEVICE_BUFFER_SIZE	256		// events DirectInput buffers per device between two reads of the input thread
+#define INPUT_GAMEPAD_POLL_MS		4		// XInput doesn't signal, a connected gamepad is sampled this often (as far as the system timer allows)
+#define INPUT_GAMEPAD_SEARCH_SEC	1.0		// how often to look for a gamepad while none is connected
+#define INPUT_LAG_MAX_SEC			0.25	// how far the ticks' clock may fall behind now, older events are applied at once
+
 namespace Directus
 {
+	namespace _Input
+	{
+		// The DirectInput key of every Button_Keyboard
+		static const unsigned char keyboard_keys[] =
+		{
+			// FUNCTION
+			DIK_F1, DIK_F2, DIK_F3, DIK_F4, DIK_F5, DIK_F6, DIK_F7, DIK_F8, DIK_F9, DIK_F10, DIK_F11, DIK_F12, DIK_F13, DIK_F14, DIK_F15,
+			// NUMBERS
+			DIK_0, DIK_1, DIK_2, DIK_3, DIK_4, DIK_5, DIK_6, DIK_7, DIK_8, DIK_9,
+			// KEYPAD
+			DIK_NUMPAD0, DIK_NUMPAD1, DIK_NUMPAD2, DIK_NUMPAD3, DIK_NUMPAD4, DIK_NUMPAD5, DIK_NUMPAD6, DIK_NUMPAD7, DIK_NUMPAD8, DIK_NUMPAD9,
+			// LETTERS
+			DIK_Q, DIK_W, DIK_E, DIK_R, DIK_T, DIK_Y, DIK_U, DIK_I, DIK_O, DIK_P,
+			DIK_A, DIK_S, DIK_D, DIK_F, DIK_G, DIK_H, DIK_J, DIK_K, DIK_L,
+			DIK_Z, DIK_X, DIK_C, DIK_V, DIK_B, DIK_N, DIK_M,
+			// CONTROLS
+			DIK_ESCAPE, DIK_TAB,
+			DIK_LSHIFT, DIK_RSHIFT,
+			DIK_LCONTROL, DIK_RCONTROL,
+			DIK_LALT, DIK_RALT,
+			DIK_SPACE, DIK_CAPSLOCK, DIK_BACKSPACE, DIK_RETURN, DIK_DELETE,
+			DIK_LEFTARROW, DIK_RIGHTARROW, DIK_UPARROW, DIK_DOWNARROW,
+			DIK_PGUP, DIK_PGDN,
+			DIK_HOME, DIK_END,
+			DIK_INSERT
+		};
+		static const int keyboard_buttons = (int)(sizeof(keyboard_keys) / sizeof(keyboard_keys[0]));
+
+		// The XInput button of every Button_Gamepad
+		static const WORD gamepad_masks[] =
+		{
+			XINPUT_GAMEPAD_DPAD_UP, XINPUT_GAMEPAD_DPAD_DOWN, XINPUT_GAMEPAD_DPAD_LEFT, XINPUT_GAMEPAD_DPAD_RIGHT,
+			XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_B, XINPUT_GAMEPAD_X, XINPUT_GAMEPAD_Y,
+			XINPUT_GAMEPAD_START, XINPUT_GAMEPAD_BACK,
+			XINPUT_GAMEPAD_LEFT_THUMB, XINPUT_GAMEPAD_RIGHT_THUMB,
+			XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER
+		};
+		static const int gamepad_buttons = (int)(sizeof(gamepad_masks) / sizeof(gamepad_masks[0]));
+
+		inline Input_Event Event(Input_EventType type, int button, bool pressed, const Vector2& value, double timeSec)
+		{
+			Input_Event event;
+			event.timeSec	= timeSec;
+			event.type		= type;
+			event.button	= button;
+			event.pressed	= pressed;
+			event.value		= value;
+			return event;
+		}
+
+		// An event only if the button is now up when it was down (or the other way around)
+		inline void Button_Set(vector<Input_Event>& events, Input_EventType type, int button, bool pressed, bool* held, double timeSec)
+		{
+			if (held[button] == pressed)
+				return;
+
+			held[button] = pressed;
+			events.emplace_back(Event(type, button, pressed, Vector2::Zero, timeSec));
+		}
+
+		// Convert [-32768, 32767] to [-1, 1]
+		inline float Thumbstick(SHORT value) { return value < 0 ? value / 32768.0f : value / 32767.0f; }
+	}
+
 	IDirectInput8*			g_directInput;
 	IDirectInputDevice8*	g_keyboard;
 	IDirectInputDevice8*	g_mouse;
 	XINPUT_STATE			g_gamepad;
 	unsigned int			g_gamepadNum;
-	DIMOUSESTATE			g_mouseState;
 	unsigned char			g_keyboardState[256];
+	int						g_keyboardButtons[256];	// the Button_Keyboard of every DirectInput key, -1 if it has none
+
+	// The input thread's
+	void*	g_keyboardEvent;
+	void*	g_mouseEvent;
+	void*	g_stopEvent;
+	bool	g_keyboardHeld[_Input::keyboard_buttons];
+	bool	g_mouseHeld[3];
+	bool	g_gamepadConnected;
+
+	static_assert(_Input::keyboard_buttons == 83, "Input: every Button_Keyboard needs a DirectInput key");
+	static_assert(_Input::gamepad_buttons == 14, "Input: every Button_Gamepad needs an XInput button");
 
 	Input::Input(Context* context) : Subsystem(context)
 	{
@@ -53,16 +135,27 @@ namespace Directus
 		g_keyboard			= nullptr;
 		g_mouse				= nullptr;
 		g_gamepadNum		= 0;
+		g_keyboardEvent		= nullptr;
+		g_mouseEvent		= nullptr;
+		g_stopEvent			= nullptr;
+		g_gamepadConnected	= false;
+		ZeroMemory(&g_gamepad, sizeof(XINPUT_STATE));
+		ZeroMemory(g_keyboardHeld, sizeof(g_keyboardHeld));
+		ZeroMemory(g_mouseHeld, sizeof(g_mouseHeld));
 
-		SUBSCRIBE_TO_EVENT(EVENT_TICK, EVENT_HANDLER(Tick));
+		SUBSCRIBE_TO_EVENT(EVENT_TICK, EVENT_HANDLER_DATA(Tick));
 	}
 
 	Input::~Input()
 	{
+		// Nothing reads the devices anymore
+		Thread_Stop();
+
 		// Release the mouse.
 		if (g_mouse)
 		{
 			g_mouse->Unacquire();
+			g_mouse->SetEventNotification(nullptr);
 			g_mouse->Release();
 			g_mouse = nullptr;
 		}
@@ -71,6 +164,7 @@ namespace Directus
 		if (g_keyboard)
 		{
 			g_keyboard->Unacquire();
+			g_keyboard->SetEventNotification(nullptr);
 			g_keyboard->Release();
 			g_keyboard = nullptr;
 		}
@@ -81,6 +175,10 @@ namespace Directus
 			g_directInput->Release();
 			g_directInput = nullptr;
 		}
+
+		if (g_keyboardEvent)	CloseHandle((HANDLE)g_keyboardEvent);
+		if (g_mouseEvent)		CloseHandle((HANDLE)g_mouseEvent);
+		if (g_stopEvent)		CloseHandle((HANDLE)g_stopEvent);
 	}
 
 	bool Input::Initialize()
@@ -95,6 +193,29 @@ namespace Directus
 		// Make sure the window has focus, otherwise the mouse and keyboard won't be able to be acquired.
 		SetForegroundWindow(windowHandle);
 
+		// DirectInput signals these when a device has something buffered, the input thread waits on them
+		g_keyboardEvent	= CreateEventW(nullptr, FALSE, FALSE, nullptr);
+		g_mouseEvent	= CreateEventW(nullptr, FALSE, FALSE, nullptr);
+		g_stopEvent		= CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+		fill(begin(g_keyboardButtons), end(g_keyboardButtons), -1);
+		for (int button = 0; button < _Input::keyboard_buttons; button++)
+		{
+			g_keyboardButtons[_Input::keyboard_keys[button]] = button;
+		}
+
+		// The device keeps what happens until it's read, rather than only how things are when it's read, and signals the event.
+		// Both have to be set while it's not acquired.
+		auto Device_Buffer = [](IDirectInputDevice8* device, void* event)
+		{
+			DIPROPDWORD property		= {};
+			property.diph.dwSize		= sizeof(DIPROPDWORD);
+			property.diph.dwHeaderSize	= sizeof(DIPROPHEADER);
+			property.diph.dwHow			= DIPH_DEVICE;
+			property.dwData				= INPUT_DEVICE_BUFFER_SIZE;
+			return SUCCEEDED(device->SetProperty(DIPROP_BUFFERSIZE, &property.diph)) && SUCCEEDED(device->SetEventNotification((HANDLE)event));
+		};
+
 		// Initialize the main direct input interface.
 		auto result = DirectInput8Create(windowInstance, DIRECTINPUT_VERSION, IID_IDirectInput8, (void**)&g_directInput, nullptr);
 		if (FAILED(result))
@@ -128,6 +249,11 @@ namespace Directus
 				LOG_ERROR("DInput: Failed to set DirectInput keyboard's cooperative level.");
 			}
 
+			if (!Device_Buffer(g_keyboard, g_keyboardEvent))
+			{
+				LOG_ERROR("DInput: Failed to set DirectInput keyboard's buffer.");
+			}
+
 			// Acquire the keyboard.
 			if (!SUCCEEDED(g_keyboard->Acquire()))
 			{
@@ -157,6 +283,11 @@ namespace Directus
 			{
 				LOG_ERROR("DInput: Failed to set DirectInput mouse's cooperative level.");
 			}
+
+			if (!Device_Buffer(g_mouse, g_mouseEvent))
+			{
+				LOG_ERROR("DInput: Failed to set DirectInput mouse's buffer.");
+			}
 		
 			// Acquire the mouse.
 			if (!SUCCEEDED(g_mouse->Acquire()))
@@ -178,214 +309,273 @@ namespace Directus
 			auto minor = ss.str().erase(0, 1);
 		}
 
+		m_timeSec	= GetTimeSec();
+		m_thread	= thread(&Input::Thread_Loop, this);
+
 		return success;
 	}
 
-	void Input::Tick()
+	void Input::Tick(float deltaTime)
 	{
-		if (ReadMouse())
+		// Not initialized (headless)
+		if (!m_thread.joinable())
+			return;
+
+		m_mouseDelta		= Vector2::Zero;
+		m_mouseWheelDelta	= 0;
+		m_events.clear();
+
+		// The ticks' clock can't run ahead of now, and falls behind by no more than INPUT_LAG_MAX_SEC (steps the timer dropped)
+		double now	= GetTimeSec();
+		m_timeSec	= Clamp(m_timeSec + (double)deltaTime, now - INPUT_LAG_MAX_SEC, now);
+
+		while (Input_Event* event = m_queue.Front())
 		{
-			// COMPUTE DELTA
-			m_mouseDelta.x		= (float)g_mouseState.lX; // lX = x
-			m_mouseDelta.y		= (float)g_mouseState.lY; // lY = y
-			m_mouseWheelDelta	= (float)g_mouseState.lZ; // lZ = wheel
-
-			// COMPUTE POSITION
-			m_mousePos.x = Clamp(m_mousePos.x + m_mouseDelta.x, 0.0f, (float)Settings::Get().Viewport_GetWidth());
-			m_mousePos.y = Clamp(m_mousePos.y + m_mouseDelta.y, 0.0f, (float)Settings::Get().Viewport_GetHeight());
-			m_mouseWheel += m_mouseWheelDelta;
-
-			// COMPUTE BUTTON STATE
-			m_mouseButtons[0] = g_mouseState.rgbButtons[0] & 0x80; // Left Button
-			m_mouseButtons[1] = g_mouseState.rgbButtons[3] & 0x80; // Middle Button
-			m_mouseButtons[2] = g_mouseState.rgbButtons[1] & 0x80; // Right Button
-			// DInput: [4,7] -> Side buttons
+			if (event->timeSec > m_timeSec)
+				break;
+
+			Apply(*event);
+			m_events.emplace_back(*event);
+			m_queue.Pop();
 		}
-		else
+	}
+
+	double Input::GetTimeSec()
+	{
+		return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Input::Apply(const Input_Event& event)
+	{
+		switch (event.type)
 		{
-			m_mouseDelta.x		= 0;
-			m_mouseDelta.y		= 0;
-			m_mouseWheelDelta	= 0;
-
-			m_mouseButtons[0] = false;
-			m_mouseButtons[1] = false;
-			m_mouseButtons[2] = false;
-		}	
-			
-		if(ReadKeyboard())
+			case InputEvent_Keyboard:
+				m_keyboardButtons[event.button] = event.pressed;
+				break;
+
+			case InputEvent_Mouse:
+				m_mouseButtons[event.button] = event.pressed;
+				break;
+
+			case InputEvent_MouseMove:
+				m_mouseDelta	+= event.value;
+				m_mousePos.x	= Clamp(m_mousePos.x + event.value.x, 0.0f, (float)Settings::Get().Viewport_GetWidth());
+				m_mousePos.y	= Clamp(m_mousePos.y + event.value.y, 0.0f, (float)Settings::Get().Viewport_GetHeight());
+				break;
+
+			case InputEvent_MouseWheel:
+				m_mouseWheelDelta	+= event.value.x;
+				m_mouseWheel		+= event.value.x;
+				break;
+
+			case InputEvent_Gamepad:
+				m_gamepadButtons[event.button] = event.pressed;
+				break;
+
+			case InputEvent_GamepadAxes:
+				if (event.button == 0)		m_thumbstickLeft	= event.value;
+				else if (event.button == 1)	m_thumbstickRight	= event.value;
+				else
+				{
+					m_triggerLeft	= event.value.x;
+					m_triggerRight	= event.value.y;
+				}
+				break;
+
+			case InputEvent_GamepadConnection:
+				m_isGamepadConnected = event.pressed;
+				break;
+		}
+	}
+
+	void Input::Thread_Loop()
+	{
+		HANDLE handles[3]	= { (HANDLE)g_keyboardEvent, (HANDLE)g_mouseEvent, (HANDLE)g_stopEvent };
+		double gamepadSec	= 0.0;
+
+		// What didn't fit in the queue, in the order it happened
+		vector<Input_Event> pending;
+		while (WaitForMultipleObjects(3, handles, FALSE, INPUT_GAMEPAD_POLL_MS) != WAIT_OBJECT_0 + 2)
 		{
-			// FUNCTION
-			m_keyboardButtons[0] = g_keyboardState[DIK_F1] & 0x80;
-			m_keyboardButtons[1] = g_keyboardState[DIK_F2] & 0x80;
-			m_keyboardButtons[2] = g_keyboardState[DIK_F3] & 0x80;
-			m_keyboardButtons[3] = g_keyboardState[DIK_F4] & 0x80;
-			m_keyboardButtons[4] = g_keyboardState[DIK_F5] & 0x80;
-			m_keyboardButtons[5] = g_keyboardState[DIK_F6] & 0x80;
-			m_keyboardButtons[6] = g_keyboardState[DIK_F7] & 0x80;
-			m_keyboardButtons[7] = g_keyboardState[DIK_F8] & 0x80;
-			m_keyboardButtons[8] = g_keyboardState[DIK_F9] & 0x80;
-			m_keyboardButtons[9] = g_keyboardState[DIK_F10] & 0x80;
-			m_keyboardButtons[10] = g_keyboardState[DIK_F11] & 0x80;
-			m_keyboardButtons[11] = g_keyboardState[DIK_F12] & 0x80;
-			m_keyboardButtons[12] = g_keyboardState[DIK_F13] & 0x80;
-			m_keyboardButtons[13] = g_keyboardState[DIK_F14] & 0x80;
-			m_keyboardButtons[14] = g_keyboardState[DIK_F15] & 0x80;
-			// NUMBERS
-			m_keyboardButtons[15] = g_keyboardState[DIK_0] & 0x80;
-			m_keyboardButtons[16] = g_keyboardState[DIK_1] & 0x80;
-			m_keyboardButtons[17] = g_keyboardState[DIK_2] & 0x80;
-			m_keyboardButtons[18] = g_keyboardState[DIK_3] & 0x80;
-			m_keyboardButtons[19] = g_keyboardState[DIK_4] & 0x80;
-			m_keyboardButtons[20] = g_keyboardState[DIK_5] & 0x80;
-			m_keyboardButtons[21] = g_keyboardState[DIK_6] & 0x80;
-			m_keyboardButtons[22] = g_keyboardState[DIK_7] & 0x80;
-			m_keyboardButtons[23] = g_keyboardState[DIK_8] & 0x80;
-			m_keyboardButtons[24] = g_keyboardState[DIK_9] & 0x80;
-			// KEYPAD
-			m_keyboardButtons[25] = g_keyboardState[DIK_NUMPAD0] & 0x80;
-			m_keyboardButtons[26] = g_keyboardState[DIK_NUMPAD1] & 0x80;
-			m_keyboardButtons[27] = g_keyboardState[DIK_NUMPAD2] & 0x80;
-			m_keyboardButtons[28] = g_keyboardState[DIK_NUMPAD3] & 0x80;
-			m_keyboardButtons[29] = g_keyboardState[DIK_NUMPAD4] & 0x80;
-			m_keyboardButtons[30] = g_keyboardState[DIK_NUMPAD5] & 0x80;
-			m_keyboardButtons[31] = g_keyboardState[DIK_NUMPAD6] & 0x80;
-			m_keyboardButtons[32] = g_keyboardState[DIK_NUMPAD7] & 0x80;
-			m_keyboardButtons[33] = g_keyboardState[DIK_NUMPAD8] & 0x80;
-			m_keyboardButtons[34] = g_keyboardState[DIK_NUMPAD9] & 0x80;
-			// LETTERS
-			m_keyboardButtons[35] = g_keyboardState[DIK_Q] & 0x80;
-			m_keyboardButtons[36] = g_keyboardState[DIK_W] & 0x80;
-			m_keyboardButtons[37] = g_keyboardState[DIK_E] & 0x80;
-			m_keyboardButtons[38] = g_keyboardState[DIK_R] & 0x80;
-			m_keyboardButtons[39] = g_keyboardState[DIK_T] & 0x80;
-			m_keyboardButtons[40] = g_keyboardState[DIK_Y] & 0x80;
-			m_keyboardButtons[41] = g_keyboardState[DIK_U] & 0x80;
-			m_keyboardButtons[42] = g_keyboardState[DIK_I] & 0x80;
-			m_keyboardButtons[43] = g_keyboardState[DIK_O] & 0x80;
-			m_keyboardButtons[44] = g_keyboardState[DIK_P] & 0x80;
-			m_keyboardButtons[45] = g_keyboardState[DIK_A] & 0x80;
-			m_keyboardButtons[46] = g_keyboardState[DIK_S] & 0x80;
-			m_keyboardButtons[47] = g_keyboardState[DIK_D] & 0x80;
-			m_keyboardButtons[48] = g_keyboardState[DIK_F] & 0x80;
-			m_keyboardButtons[49] = g_keyboardState[DIK_G] & 0x80;
-			m_keyboardButtons[50] = g_keyboardState[DIK_H] & 0x80;
-			m_keyboardButtons[51] = g_keyboardState[DIK_J] & 0x80;
-			m_keyboardButtons[52] = g_keyboardState[DIK_K] & 0x80;
-			m_keyboardButtons[53] = g_keyboardState[DIK_L] & 0x80;
-			m_keyboardButtons[54] = g_keyboardState[DIK_Z] & 0x80;
-			m_keyboardButtons[55] = g_keyboardState[DIK_X] & 0x80;
-			m_keyboardButtons[56] = g_keyboardState[DIK_C] & 0x80;
-			m_keyboardButtons[57] = g_keyboardState[DIK_V] & 0x80;
-			m_keyboardButtons[58] = g_keyboardState[DIK_B] & 0x80;
-			m_keyboardButtons[59] = g_keyboardState[DIK_N] & 0x80;
-			m_keyboardButtons[60] = g_keyboardState[DIK_M] & 0x80;
-			// CONTROLS
-			m_keyboardButtons[61] = g_keyboardState[DIK_ESCAPE] & 0x80;
-			m_keyboardButtons[62] = g_keyboardState[DIK_TAB] & 0x80;
-			m_keyboardButtons[63] = g_keyboardState[DIK_LSHIFT] & 0x80;
-			m_keyboardButtons[64] = g_keyboardState[DIK_RSHIFT] & 0x80;
-			m_keyboardButtons[65] = g_keyboardState[DIK_LCONTROL] & 0x80;
-			m_keyboardButtons[66] = g_keyboardState[DIK_RCONTROL] & 0x80;
-			m_keyboardButtons[67] = g_keyboardState[DIK_LALT] & 0x80;
-			m_keyboardButtons[68] = g_keyboardState[DIK_RALT] & 0x80;
-			m_keyboardButtons[69] = g_keyboardState[DIK_SPACE] & 0x80;
-			m_keyboardButtons[70] = g_keyboardState[DIK_CAPSLOCK] & 0x80;
-			m_keyboardButtons[71] = g_keyboardState[DIK_BACKSPACE] & 0x80;
-			m_keyboardButtons[72] = g_keyboardState[DIK_RETURN] & 0x80;
-			m_keyboardButtons[73] = g_keyboardState[DIK_DELETE] & 0x80;
-			m_keyboardButtons[74] = g_keyboardState[DIK_LEFTARROW] & 0x80;
-			m_keyboardButtons[75] = g_keyboardState[DIK_RIGHTARROW] & 0x80;
-			m_keyboardButtons[76] = g_keyboardState[DIK_UPARROW] & 0x80;
-			m_keyboardButtons[77] = g_keyboardState[DIK_DOWNARROW] & 0x80;
-			m_keyboardButtons[78] = g_keyboardState[DIK_PGUP] & 0x80;
-			m_keyboardButtons[79] = g_keyboardState[DIK_PGDN] & 0x80;
-			m_keyboardButtons[80] = g_keyboardState[DIK_HOME] & 0x80;
-			m_keyboardButtons[81] = g_keyboardState[DIK_END] & 0x80;
-			m_keyboardButtons[82] = g_keyboardState[DIK_INSERT] & 0x80;
+			// The thread wakes as soon as DirectInput signals, so when it reads an event is when it happened
+			double timeSec = GetTimeSec();
+			ReadKeyboard(pending, timeSec);
+			ReadMouse(pending, timeSec);
+
+			// Asking XInput about a gamepad that isn't connected takes long, so that's only done once in a while
+			if (g_gamepadConnected || timeSec - gamepadSec >= INPUT_GAMEPAD_SEARCH_SEC)
+			{
+				ReadGamepad(pending, timeSec);
+				gamepadSec = timeSec;
+			}
+
+			size_t handed = 0;
+			while (handed < pending.size() && m_queue.Push(pending[handed]))
+			{
+				handed++;
+			}
+			pending.erase(pending.begin(), pending.begin() + handed);
+
+			// Nothing ticks (the engine doesn't update), the oldest go
+			if (pending.size() > INPUT_EVENT_QUEUE_SIZE)
+			{
+				pending.erase(pending.begin(), pending.end() - INPUT_EVENT_QUEUE_SIZE);
+			}
 		}
-		else
+	}
+
+	void Input::Thread_Stop()
+	{
+		if (!m_thread.joinable())
+			return;
+
+		SetEvent((HANDLE)g_stopEvent);
+		m_thread.join();
+	}
+
+	void Input::ReadMouse(vector<Input_Event>& events, double timeSec)
+	{
+		// Not initialized (headless)
+		if (!g_mouse)
+			return;
+
+		DIDEVICEOBJECTDATA data[INPUT_DEVICE_BUFFER_SIZE];
+		DWORD count	= INPUT_DEVICE_BUFFER_SIZE;
+		auto result	= g_mouse->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), data, &count, 0);
+		if (FAILED(result))
 		{
-			for (bool& i : m_keyboardButtons)
+			// If the mouse lost focus or was not acquired then try to get control back, what was held counts as released.
+			if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED) || (result == DIERR_OTHERAPPHASPRIO))
 			{
-				i = false;
+				for (int button = 0; button < 3; button++)
+				{
+					_Input::Button_Set(events, InputEvent_Mouse, button, false, g_mouseHeld, timeSec);
+				}
+				g_mouse->Acquire();
 			}
+			return;
 		}
 
-		if (ReadGamepad())
+		// Movement is summed up, it all arrived at once anyway
+		Vector2 movement	= Vector2::Zero;
+		float wheel			= 0.0f;
+		for (DWORD i = 0; i < count; i++)
 		{
-			m_gamepadButtons[0]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_DPAD_UP;
-			m_gamepadButtons[1]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_DPAD_DOWN;
-			m_gamepadButtons[2]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_DPAD_LEFT;
-			m_gamepadButtons[3]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_DPAD_RIGHT;
-			m_gamepadButtons[4]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_A;
-			m_gamepadButtons[5]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_B;
-			m_gamepadButtons[6]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_X;
-			m_gamepadButtons[7]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_Y;
-			m_gamepadButtons[6]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_START;
-			m_gamepadButtons[7]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_BACK;
-			m_gamepadButtons[8]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_LEFT_THUMB;
-			m_gamepadButtons[9]		= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_RIGHT_THUMB;
-			m_gamepadButtons[10]	= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_LEFT_SHOULDER;
-			m_gamepadButtons[11]	= g_gamepad.Gamepad.wButtons & XINPUT_GAMEPAD_RIGHT_SHOULDER;
-			m_triggerLeft			= (float)g_gamepad.Gamepad.bLeftTrigger;
-			m_triggerRight			= (float)g_gamepad.Gamepad.bRightTrigger;
-			m_thumbstickLeft.x		= (float)g_gamepad.Gamepad.sThumbLX;
-			m_thumbstickLeft.y		= (float)g_gamepad.Gamepad.sThumbLY;
-			m_thumbstickRight.x		= (float)g_gamepad.Gamepad.sThumbRX;
-			m_thumbstickRight.y		= (float)g_gamepad.Gamepad.sThumbRY;
-
-			if (m_triggerLeft != 0)			m_triggerLeft	/= 255.0f;	// Convert [0, 255] to [0, 1]
-			if (m_triggerRight != 0)		m_triggerRight	/= 255.0f;	// Convert [0, 255] to [0, 1]
-			if (m_thumbstickLeft.x != 0)	m_thumbstickLeft.x	= m_thumbstickLeft.x	< 0 ? m_thumbstickLeft.x	/ 32768.0f : m_thumbstickLeft.x		/ 32767.0f; // Convert [-32768, 32767] to [-1, 1]
-			if (m_thumbstickLeft.y != 0)	m_thumbstickLeft.y	= m_thumbstickLeft.y	< 0 ? m_thumbstickLeft.y	/ 32768.0f : m_thumbstickLeft.y		/ 32767.0f; // Convert [-32768, 32767] to [-1, 1]
-			if (m_thumbstickRight.x != 0)	m_thumbstickRight.x = m_thumbstickRight.x	< 0 ? m_thumbstickRight.x	/ 32768.0f : m_thumbstickRight.x	/ 32767.0f; // Convert [-32768, 32767] to [-1, 1]
-			if (m_thumbstickRight.y != 0)	m_thumbstickRight.y = m_thumbstickRight.y	< 0 ? m_thumbstickRight.y	/ 32768.0f : m_thumbstickRight.y	/ 32767.0f; // Convert [-32768, 32767] to [-1, 1]
-
-			m_isGamepadConnected	= true;
+			auto value = (int)data[i].dwData;
+			switch (data[i].dwOfs)
+			{
+				case DIMOFS_X:			movement.x	+= (float)value; break;
+				case DIMOFS_Y:			movement.y	+= (float)value; break;
+				case DIMOFS_Z:			wheel		+= (float)value; break;
+				// DInput: [4,7] -> Side buttons
+				case DIMOFS_BUTTON0:	_Input::Button_Set(events, InputEvent_Mouse, Click_Left,	value & 0x80, g_mouseHeld, timeSec); break;
+				case DIMOFS_BUTTON3:	_Input::Button_Set(events, InputEvent_Mouse, Click_Middle,	value & 0x80, g_mouseHeld, timeSec); break;
+				case DIMOFS_BUTTON1:	_Input::Button_Set(events, InputEvent_Mouse, Click_Right,	value & 0x80, g_mouseHeld, timeSec); break;
+			}
+		}
 
+		if (movement != Vector2::Zero)
+		{
+			events.emplace_back(_Input::Event(InputEvent_MouseMove, 0, false, movement, timeSec));
 		}
-		else
+
+		if (wheel != 0.0f)
 		{
-			m_isGamepadConnected = false;
+			events.emplace_back(_Input::Event(InputEvent_MouseWheel, 0, false, Vector2(wheel, 0.0f), timeSec));
 		}
 	}
 
-	bool Input::ReadMouse()
+	void Input::ReadKeyboard(vector<Input_Event>& events, double timeSec)
 	{
-		// Get mouse state
-		auto result = g_mouse->GetDeviceState(sizeof(DIMOUSESTATE), (LPVOID)&g_mouseState);
-		if (SUCCEEDED(result))
-			return true;
+		// Not initialized (headless)
+		if (!g_keyboard)
+			return;
+
+		DIDEVICEOBJECTDATA data[INPUT_DEVICE_BUFFER_SIZE];
+		DWORD count	= INPUT_DEVICE_BUFFER_SIZE;
+		auto result	= g_keyboard->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), data, &count, 0);
+		if (FAILED(result))
+		{
+			// If the keyboard lost focus or was not acquired then try to get control back, what was held counts as released.
+			if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
+			{
+				for (int button = 0; button < _Input::keyboard_buttons; button++)
+				{
+					_Input::Button_Set(events, InputEvent_Keyboard, button, false, g_keyboardHeld, timeSec);
+				}
+				g_keyboard->Acquire();
+			}
+			return;
+		}
 
-		// If the mouse lost focus or was not acquired then try to get control back.
-		if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED) || (result == DIERR_OTHERAPPHASPRIO))
+		for (DWORD i = 0; i < count; i++)
 		{
-			g_mouse->Acquire();
+			int button = g_keyboardButtons[data[i].dwOfs & 0xFF];
+			if (button != -1)
+			{
+				_Input::Button_Set(events, InputEvent_Keyboard, button, data[i].dwData & 0x80, g_keyboardHeld, timeSec);
+			}
 		}
 
-		return false;
+		// Some of it didn't fit in the buffer, whatever changed with it is picked up from the keyboard's state
+		if (result == DI_BUFFEROVERFLOW && SUCCEEDED(g_keyboard->GetDeviceState(sizeof(g_keyboardState), (LPVOID)&g_keyboardState)))
+		{
+			for (int button = 0; button < _Input::keyboard_buttons; button++)
+			{
+				_Input::Button_Set(events, InputEvent_Keyboard, button, g_keyboardState[_Input::keyboard_keys[button]] & 0x80, g_keyboardHeld, timeSec);
+			}
+		}
 	}
 
-	bool Input::ReadKeyboard()
+	void Input::ReadGamepad(vector<Input_Event>& events, double timeSec)
 	{
-		// Get keyboard state
-		auto result = g_keyboard->GetDeviceState(sizeof(g_keyboardState), (LPVOID)&g_keyboardState);
-		if (SUCCEEDED(result))
-			return true;
+		XINPUT_STATE state;
+		ZeroMemory(&state, sizeof(XINPUT_STATE));
+		bool connected = XInputGetState(g_gamepadNum, &state) == ERROR_SUCCESS;
+
+		// Nothing changed since the last time
+		if (connected == g_gamepadConnected && (!connected || state.dwPacketNumber == g_gamepad.dwPacketNumber))
+			return;
 
-		// If the keyboard lost focus or was not acquired then try to get control back.
-		if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
+		// Disconnected, everything goes back to rest
+		if (!connected)
 		{
-			g_keyboard->Acquire();
+			ZeroMemory(&state, sizeof(XINPUT_STATE));
 		}
 
-		return false;
-	}
+		const XINPUT_GAMEPAD& now		= state.Gamepad;
+		const XINPUT_GAMEPAD& before	= g_gamepad.Gamepad;
+		for (int button = 0; button < _Input::gamepad_buttons; button++)
+		{
+			WORD mask = _Input::gamepad_masks[button];
+			if ((now.wButtons & mask) != (before.wButtons & mask))
+			{
+				events.emplace_back(_Input::Event(InputEvent_Gamepad, button, (now.wButtons & mask) != 0, Vector2::Zero, timeSec));
+			}
+		}
 
-	bool Input::ReadGamepad()
-	{
-		ZeroMemory(&g_gamepad, sizeof(XINPUT_STATE));
-		return XInputGetState(g_gamepadNum, &g_gamepad) == ERROR_SUCCESS;
+		if (now.sThumbLX != before.sThumbLX || now.sThumbLY != before.sThumbLY)
+		{
+			events.emplace_back(_Input::Event(InputEvent_GamepadAxes, 0, false, Vector2(_Input::Thumbstick(now.sThumbLX), _Input::Thumbstick(now.sThumbLY)), timeSec));
+		}
+
+		if (now.sThumbRX != before.sThumbRX || now.sThumbRY != before.sThumbRY)
+		{
+			events.emplace_back(_Input::Event(InputEvent_GamepadAxes, 1, false, Vector2(_Input::Thumbstick(now.sThumbRX), _Input::Thumbstick(now.sThumbRY)), timeSec));
+		}
+
+		if (now.bLeftTrigger != before.bLeftTrigger || now.bRightTrigger != before.bRightTrigger)
+		{
+			events.emplace_back(_Input::Event(InputEvent_GamepadAxes, 2, false, Vector2(now.bLeftTrigger / 255.0f, now.bRightTrigger / 255.0f), timeSec)); // Convert [0, 255] to [0, 1]
+		}
+
+		if (connected != g_gamepadConnected)
+		{
+			events.emplace_back(_Input::Event(InputEvent_GamepadConnection, 0, connected, Vector2::Zero, timeSec));
+		}
+
+		g_gamepad			= state;
+		g_gamepadConnected	= connected;
 	}
 
 	bool Input::VibrateGamepad(float leftMotorSpeed, float rightMotorSpeed)
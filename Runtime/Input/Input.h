@@ -22,10 +22,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =================
+#include <vector>
+#include <thread>
 #include "../Math/Vector2.h"
 #include "../Core/SubSystem.h"
+#include "../Core/RingQueue.h"
 //============================
 
+#define INPUT_EVENT_QUEUE_SIZE 4096 // events handed over from the input thread between two ticks, it holds on to the rest
+
 namespace Directus
 {
 	enum Button_Mouse
@@ -83,6 +88,27 @@ namespace Directus
 		Right_Shoulder	
 	};
 
+	enum Input_EventType
+	{
+		InputEvent_Keyboard,			// button is a Button_Keyboard
+		InputEvent_Mouse,				// button is a Button_Mouse
+		InputEvent_MouseMove,			// value is how far it moved
+		InputEvent_MouseWheel,			// value.x is how far the wheel turned
+		InputEvent_Gamepad,				// button is a Button_Gamepad
+		InputEvent_GamepadAxes,			// button is 0 the left thumbstick, 1 the right one, 2 the triggers (x left, y right), value is where it is now
+		InputEvent_GamepadConnection	// pressed is whether it's connected now
+	};
+
+	// Something that happened on a device, as the input thread saw it
+	struct Input_Event
+	{
+		double timeSec			= 0.0; // when, on Input::GetTimeSec's clock
+		Input_EventType type	= InputEvent_Keyboard;
+		int button				= 0;
+		bool pressed			= false;
+		Math::Vector2 value		= Math::Vector2::Zero;
+	};
+
 	class ENGINE_CLASS Input : public Subsystem
 	{
 	public:
@@ -93,7 +119,14 @@ namespace Directus
 		bool Initialize() override;
 		//=========================
 
-		void Tick();
+		// Applies what happened on the devices up to this tick's point in time. Fixed steps run back to back once a frame,
+		// each sees the share of the frame's input that falls within it rather than the first one seeing all of it.
+		void Tick(float deltaTime);
+
+		// What the last tick applied, oldest first. Presses that were released before the tick are only seen here.
+		const std::vector<Input_Event>& GetEvents()		{ return m_events; }
+		// The clock events are timestamped with, in seconds
+		static double GetTimeSec();
 		
 		bool GetButtonKeyboard(Button_Keyboard button)	{ return m_keyboardButtons[(int)button]; }
 		bool GetButtonMouse(Button_Mouse button)		{ return m_mouseButtons[(int)button]; }
@@ -101,9 +134,14 @@ namespace Directus
 		const Math::Vector2& GetMouseDelta()			{ return m_mouseDelta; }
 
 	private:
-		bool ReadMouse();
-		bool ReadKeyboard();
-		bool ReadGamepad();
+		// The input thread sleeps until DirectInput signals that a device has something buffered (or it's time to sample the gamepad),
+		// reads it and hands it over to Tick as timestamped events.
+		void Thread_Loop();
+		void Thread_Stop();
+		void ReadMouse(std::vector<Input_Event>& events, double timeSec);
+		void ReadKeyboard(std::vector<Input_Event>& events, double timeSec);
+		void ReadGamepad(std::vector<Input_Event>& events, double timeSec);
+		void Apply(const Input_Event& event);
 
 		// Vibrate the gamepad. Motor speed range is from 0.0 to 1.0f
 		// The left motor is the low-frequency rumble motor. The right motor is the high-frequency rumble motor. 
@@ -121,11 +159,17 @@ namespace Directus
 		bool m_keyboardButtons[83] = { false };
 
 		// Gamepad
-		bool m_isGamepadConnected;
-		bool m_gamepadButtons[13] = { false };
-		Math::Vector2 m_thumbstickLeft;
-		Math::Vector2 m_thumbstickRight;
-		float m_triggerLeft;
-		float m_triggerRight;
+		bool m_isGamepadConnected			= false;
+		bool m_gamepadButtons[14]			= { false };
+		Math::Vector2 m_thumbstickLeft		= Math::Vector2::Zero;
+		Math::Vector2 m_thumbstickRight		= Math::Vector2::Zero;
+		float m_triggerLeft					= 0.0f;
+		float m_triggerRight				= 0.0f;
+
+		// Events
+		std::thread m_thread;
+		RingQueue_SPSC<Input_Event, INPUT_EVENT_QUEUE_SIZE> m_queue;	// from the input thread to Tick
+		std::vector<Input_Event> m_events;								// what the last tick applied
+		double m_timeSec = 0.0;											// how far in time the ticks have taken input
 	};
 }
\ No newline at end of file
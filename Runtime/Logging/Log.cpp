@@ -25,6 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ILogger.h"
 #include "../World/Actor.h"
 #include "../FileSystem/FileSystem.h"
+#include "../Core/RingQueue.h"
+#include <thread>
+#include <chrono>
 #include <stdarg.h>
 //===================================
 
@@ -34,9 +37,29 @@ using namespace Directus::Math;
 //=============================
 
 #define LOG_FILE "log.txt"
+#define LOG_QUEUE_SIZE 1024 // messages waiting for the writer, a thread finding it full waits for room
+#define LOG_HISTORY_SIZE 512 // the last messages kept for History_Get
+#define LOG_WRITER_SLEEP_MS 5 // how long the writer sleeps when there is nothing to write
 
 namespace Directus
 {
+	namespace _Log
+	{
+		// Logging threads only push, the writer pops
+		RingQueue_MPSC<Log_Record, LOG_QUEUE_SIZE> queue;
+		atomic<unsigned long long> queued	= 0;
+		atomic<unsigned long long> written	= 0;
+
+		thread writer;
+		atomic<bool> writing = false;
+
+		Log_Record history[LOG_HISTORY_SIZE];
+		unsigned long long historyCount = 0;
+		mutex historyMutex;
+
+		long long NowMs() { return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count(); }
+	}
+
 	weak_ptr<ILogger> Log::m_logger;
 	ofstream Log::m_fout;
 	bool Log::m_firstLog = true;
@@ -44,24 +67,135 @@ namespace Directus
 
 	void Log::Initialize()
 	{
+		if (_Log::writing)
+			return;
+
+		// Delete the previous log file (if it exists)
+		{
+			lock_guard<mutex> guard(m_mutex);
+			if (m_firstLog)
+			{
+				FileSystem::DeleteFile_(LOG_FILE);
+				m_firstLog = false;
+			}
+			m_fout.open(LOG_FILE, ofstream::out | ofstream::app);
+		}
 
+		_Log::writing	= true;
+		_Log::writer	= thread(&Log::Writer);
 	}
 
 	void Log::Release()
 	{
+		if (!_Log::writing)
+			return;
+
+		Flush();
+		_Log::writing = false;
+		_Log::writer.join();
 
+		lock_guard<mutex> guard(m_mutex);
+		m_fout.close();
 	}
 
 	void Log::SetLogger(const weak_ptr<ILogger>& logger)
 	{
+		Flush();
+		lock_guard<mutex> guard(m_mutex);
 		m_logger = logger;
 	}
 
+	void Log::Flush()
+	{
+		if (!_Log::writing)
+			return;
+
+		unsigned long long queued = _Log::queued.load();
+		while (_Log::written.load() < queued)
+		{
+			this_thread::yield();
+		}
+	}
+
+	void Log::History_Get(unsigned long long* sequence, vector<Log_Record>* records)
+	{
+		lock_guard<mutex> guard(_Log::historyMutex);
+		unsigned long long first = _Log::historyCount > LOG_HISTORY_SIZE ? _Log::historyCount - LOG_HISTORY_SIZE : 0;
+		for (unsigned long long i = max(*sequence, first); i < _Log::historyCount; i++)
+		{
+			records->emplace_back(_Log::history[i % LOG_HISTORY_SIZE]);
+		}
+		*sequence = _Log::historyCount;
+	}
+
+	bool Log::Site_Allow(Log_Site* site)
+	{
+		// A new second, the site starts over (racing threads might both start it, it's only a limit)
+		long long now = _Log::NowMs();
+		if (now - site->secondStart.load(memory_order_relaxed) >= 1000)
+		{
+			site->secondStart.store(now, memory_order_relaxed);
+			site->count.store(0, memory_order_relaxed);
+			if (unsigned int dropped = site->dropped.exchange(0, memory_order_relaxed))
+			{
+				WriteFWarning("Log: %u messages like the next one were dropped during the last second", dropped);
+			}
+		}
+
+		if (site->count.fetch_add(1, memory_order_relaxed) < LOG_SITE_RATE)
+			return true;
+
+		site->dropped.fetch_add(1, memory_order_relaxed);
+		return false;
+	}
+
+	void Log::Writer()
+	{
+		Log_Record record;
+		while (true)
+		{
+			if (_Log::queue.Pop(record))
+			{
+				Write_Record(record);
+				_Log::written++;
+				continue;
+			}
+
+			// Stops once it's empty
+			if (!_Log::writing)
+				return;
+
+			{
+				lock_guard<mutex> guard(m_mutex);
+				m_fout.flush();
+			}
+			this_thread::sleep_for(chrono::milliseconds(LOG_WRITER_SLEEP_MS));
+		}
+	}
+
+	void Log::Write_Record(const Log_Record& record)
+	{
+		{
+			lock_guard<mutex> guard(_Log::historyMutex);
+			_Log::history[_Log::historyCount % LOG_HISTORY_SIZE] = record;
+			_Log::historyCount++;
+		}
+
+		lock_guard<mutex> guard(m_mutex);
+		const char* prefix = (record.type == Log_Info) ? "Info: " : (record.type == Log_Warning) ? "Warning: " : "Error: ";
+		m_fout << prefix << record.text << "\n";
+
+		if (auto logger = m_logger.lock())
+		{
+			logger->Log(record.text, record.type);
+		}
+	}
+
 	//= LOGGING ==========================================================================
 	void Log::Write(const char* text, Log_Type type) // all functions resolve to that one
 	{
-		// if a logger is available use it, if not, write to file
-		!m_logger.expired() ? LogString(text, type) : LogToFile(text, type);
+		// Queued for the writer while there is one, straight to the file otherwise
+		_Log::writing ? LogString(text, type) : LogToFile(text, type);
 	}
 
 	void Log::WriteFInfo(const char* text, ...)
@@ -159,31 +293,35 @@ namespace Directus
 
 	void Log::LogString(const char* text, Log_Type type)
 	{
-		lock_guard<mutex> guard(m_mutex);
-		m_logger.lock()->Log(string(text), type);
+		// Counted first, so a flush never returns before it's written
+		_Log::queued++;
+		Log_Record record{ text, type };
+		while (!_Log::queue.Push(move(record)))
+		{
+			this_thread::yield();
+		}
 	}
 
 	void Log::LogToFile(const char* text, Log_Type type)
 	{
-		lock_guard<mutex> guard(m_mutex);
+		{
+			lock_guard<mutex> guard(m_mutex);
 
-		string prefix = (type == Log_Info) ? "Info:" : (type == Log_Warning) ? "Warning:" : "Error:";
-		string finalText = prefix + " " + text;
+			// Delete the previous log file (if it exists)
+			if (m_firstLog)
+			{
+				FileSystem::DeleteFile_(LOG_FILE);
+				m_firstLog = false;
+			}
 
-		// Delete the previous log file (if it exists)
-		if (m_firstLog)
-		{
-			FileSystem::DeleteFile_(LOG_FILE);
-			m_firstLog = false;
+			// Open/Create a log file to write the error message to.
+			m_fout.open(LOG_FILE, ofstream::out | ofstream::app);
 		}
 
-		// Open/Create a log file to write the error message to.
-		m_fout.open(LOG_FILE, ofstream::out | ofstream::app);
-
-		// Write out the error message.
-		m_fout << finalText << endl;
+		Write_Record(Log_Record{ text, type });
 
 		// Close the file.
+		lock_guard<mutex> guard(m_mutex);
 		m_fout.close();
 	}
 
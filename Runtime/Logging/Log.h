@@ -26,17 +26,23 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <vector>
 //=============================
 
+#define LOG_SITE_RATE 20 // messages a call site of the macros logs per second, the rest of that second is counted and dropped
+
 namespace Directus
 {
-	#define LOG_INFO(text)		Directus::Log::Write(text, Directus::Log_Type::Log_Info)
-	#define LOG_WARNING(text)	Directus::Log::Write(text, Directus::Log_Type::Log_Warning)
-	#define LOG_ERROR(text)		Directus::Log::Write(text, Directus::Log_Type::Log_Error)
+	// Each use gets a Log_Site of it's own, what a muted site would log isn't even formatted
+	#define LOG_SITE()			[]() { static Directus::Log_Site site; return &site; }()
+	#define LOG_INFO(text)		(Directus::Log::Site_Allow(LOG_SITE()) ? Directus::Log::Write(text, Directus::Log_Type::Log_Info) : (void)0)
+	#define LOG_WARNING(text)	(Directus::Log::Site_Allow(LOG_SITE()) ? Directus::Log::Write(text, Directus::Log_Type::Log_Warning) : (void)0)
+	#define LOG_ERROR(text)		(Directus::Log::Site_Allow(LOG_SITE()) ? Directus::Log::Write(text, Directus::Log_Type::Log_Error) : (void)0)
 
-	#define LOGF_INFO(text, ...)		Directus::Log::WriteFInfo(text,		__VA_ARGS__)
-	#define LOGF_WARNING(text, ...)		Directus::Log::WriteFWarning(text,	__VA_ARGS__)
-	#define LOGF_ERROR(text, ...)		Directus::Log::WriteFError(text,	__VA_ARGS__)
+	#define LOGF_INFO(text, ...)		(Directus::Log::Site_Allow(LOG_SITE()) ? Directus::Log::WriteFInfo(text,		__VA_ARGS__) : (void)0)
+	#define LOGF_WARNING(text, ...)		(Directus::Log::Site_Allow(LOG_SITE()) ? Directus::Log::WriteFWarning(text,	__VA_ARGS__) : (void)0)
+	#define LOGF_ERROR(text, ...)		(Directus::Log::Site_Allow(LOG_SITE()) ? Directus::Log::WriteFError(text,		__VA_ARGS__) : (void)0)
 
 	class Actor;
 
@@ -55,6 +61,22 @@ namespace Directus
 		Log_Error
 	};
 
+	struct Log_Site
+	{
+		std::atomic<long long> secondStart	= 0; // ms on the steady clock
+		std::atomic<unsigned int> count		= 0;
+		std::atomic<unsigned int> dropped	= 0;
+	};
+
+	struct Log_Record
+	{
+		std::string text;
+		Log_Type type;
+	};
+
+	// Writing formats the message and queues it, without locking. A thread of it's own writes it to the file, to the
+	// logger (if there is one, called from that thread) and to a history of the last ones (see History_Get).
+	// Before Initialize and after Release, messages are written to the file right away instead.
 	class ENGINE_CLASS Log
 	{
 		friend class ILogger;
@@ -62,6 +84,12 @@ namespace Directus
 		static void Initialize();
 		static void Release();
 		static void SetLogger(const std::weak_ptr<ILogger>& logger);
+		// Returns once what was logged so far is written
+		static void Flush();
+		// The records after sequence (a few might have dropped out of the history), sequence moves past them
+		static void History_Get(unsigned long long* sequence, std::vector<Log_Record>* records);
+		// false if the site is muted for the rest of this second, the first message after that says how many it dropped
+		static bool Site_Allow(Log_Site* site);
 
 		// Text	
 		static void Write(const char* text, Log_Type type);
@@ -95,6 +123,9 @@ namespace Directus
 		static void LogToFile(const char* text, Log_Type type);
 
 	private:
+		static void Writer();
+		static void Write_Record(const Log_Record& record);
+
 		static std::weak_ptr<ILogger> m_logger;
 		static std::ofstream m_fout;
 		static std::string m_logFileName;
@@ -97,10 +97,16 @@ namespace Directus::Math
 		}
 	}
 
-	BoundingBox BoundingBox::Transformed(const Matrix& transform)
+	BoundingBox BoundingBox::Transformed(const Matrix& transform) const
 	{
-		Vector3 newCenter = transform * GetCenter();
-		Vector3 oldEdge = GetSize() * 0.5f;
+		Vector3 oldCenter = GetCenter();
+		Vector3 newCenter = Vector3
+		(
+			transform.m00 * oldCenter.x + transform.m10 * oldCenter.y + transform.m20 * oldCenter.z + transform.m30,
+			transform.m01 * oldCenter.x + transform.m11 * oldCenter.y + transform.m21 * oldCenter.z + transform.m31,
+			transform.m02 * oldCenter.x + transform.m12 * oldCenter.y + transform.m22 * oldCenter.z + transform.m32
+		);
+		Vector3 oldEdge = GetExtents();
 		Vector3 newEdge = Vector3
 		(
 			Abs(transform.m00) * oldEdge.x + Abs(transform.m10) * oldEdge.y + Abs(transform.m20) * oldEdge.z,
@@ -72,8 +72,9 @@ namespace Directus
 			// Test if a bounding box is inside
 			Helper::Intersection IsInside (const BoundingBox& box) const;
 
-			// Returns a transformed bounding box
-			BoundingBox Transformed(const Matrix& transform);
+			// Returns the box that encloses this one transformed by an affine matrix. The center gets transformed and
+			// the extents are projected on the matrix's absolute axes (Arvo), no corners are needed.
+			BoundingBox Transformed(const Matrix& transform) const;
 
 			// Merge with another bounding box
 			void Merge(const BoundingBox& box);
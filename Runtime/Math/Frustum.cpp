@@ -22,6 +22,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =======
 #include "Frustum.h"
 #include "Plane.h"
+#include "BoundingBox.h"
+#include "SIMD.h"
 //==================
 
 //= NAMESPACES ========================
@@ -30,6 +32,19 @@ using namespace Directus::Math::Helper;
 
 namespace Directus::Math
 {
+	void Frustum::Construct(const BoundingBox& box)
+	{
+		const Vector3& min = box.GetMin();
+		const Vector3& max = box.GetMax();
+
+		m_planes[0] = Plane(Vector3( 1.0f, 0.0f, 0.0f), -min.x);
+		m_planes[1] = Plane(Vector3(-1.0f, 0.0f, 0.0f),  max.x);
+		m_planes[2] = Plane(Vector3(0.0f,  1.0f, 0.0f), -min.y);
+		m_planes[3] = Plane(Vector3(0.0f, -1.0f, 0.0f),  max.y);
+		m_planes[4] = Plane(Vector3(0.0f, 0.0f,  1.0f), -min.z);
+		m_planes[5] = Plane(Vector3(0.0f, 0.0f, -1.0f),  max.z);
+	}
+
 	void Frustum::Construct(const Matrix& mView, const Matrix& mProjection, float screenDepth)
 	{
 		// Calculate the minimum Z distance in the frustum.
@@ -114,6 +129,79 @@ namespace Directus::Math
 		return result;
 	}
 
+	void Frustum::CheckCubes(const BoundingBoxSoA& boxes, size_t start, size_t end, uint64_t* visible) const
+	{
+		using namespace SIMD;
+
+		for (size_t i = start / 64; i < (end + 63) / 64; i++)
+		{
+			visible[i] = 0;
+		}
+
+		// Same test as CheckCube, without telling inside from intersecting: a box is out when
+		// dot(center, normal) + dot(extent, |normal|) + d < 0 for any plane
+		Float4 normalX[6], normalY[6], normalZ[6], absX[6], absY[6], absZ[6], distance[6];
+		for (int i = 0; i < 6; i++)
+		{
+			const Plane& plane = m_planes[i];
+			normalX[i]	= Splat(plane.normal.x);
+			normalY[i]	= Splat(plane.normal.y);
+			normalZ[i]	= Splat(plane.normal.z);
+			absX[i]		= Splat(Helper::Abs(plane.normal.x));
+			absY[i]		= Splat(Helper::Abs(plane.normal.y));
+			absZ[i]		= Splat(Helper::Abs(plane.normal.z));
+			distance[i]	= Splat(plane.d);
+		}
+		Float4 zero = Splat(0.0f);
+
+		size_t i = start;
+		for (; i + 4 <= end; i += 4)
+		{
+			Float4 centerX = Load(&boxes.centerX[i]);
+			Float4 centerY = Load(&boxes.centerY[i]);
+			Float4 centerZ = Load(&boxes.centerZ[i]);
+			Float4 extentX = Load(&boxes.extentX[i]);
+			Float4 extentY = Load(&boxes.extentY[i]);
+			Float4 extentZ = Load(&boxes.extentZ[i]);
+
+			Float4 outside = zero;
+			for (int p = 0; p < 6; p++)
+			{
+				Float4 value = MulAdd(extentZ, absZ[p], distance[p]);
+				value = MulAdd(extentY, absY[p], value);
+				value = MulAdd(extentX, absX[p], value);
+				value = MulAdd(centerZ, normalZ[p], value);
+				value = MulAdd(centerY, normalY[p], value);
+				value = MulAdd(centerX, normalX[p], value);
+				outside = Or(outside, Less(value, zero));
+			}
+
+			// Four boxes never straddle a word, start is a multiple of 64
+			visible[i / 64] |= (uint64_t)(~Mask(outside) & 0xF) << (i % 64);
+		}
+
+		for (; i < end; i++)
+		{
+			bool outside = false;
+			for (const auto& plane : m_planes)
+			{
+				float value =
+					boxes.centerX[i] * plane.normal.x + boxes.centerY[i] * plane.normal.y + boxes.centerZ[i] * plane.normal.z +
+					boxes.extentX[i] * Helper::Abs(plane.normal.x) + boxes.extentY[i] * Helper::Abs(plane.normal.y) + boxes.extentZ[i] * Helper::Abs(plane.normal.z);
+				if (value + plane.d < 0.0f)
+				{
+					outside = true;
+					break;
+				}
+			}
+
+			if (!outside)
+			{
+				visible[i / 64] |= 1ull << (i % 64);
+			}
+		}
+	}
+
 	Intersection Frustum::CheckSphere(const Vector3& center, float radius)
 	{
 		// calculate our distances to each of the planes
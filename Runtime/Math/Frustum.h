@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =============
+#include <vector>
 #include "../Math/Plane.h"
 #include "Matrix.h"
 #include "Vector3.h"
@@ -29,6 +30,29 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Directus::Math
 {
+	class BoundingBox;
+
+	// Boxes stored component by component, so a run of them can be culled a few at a time
+	struct BoundingBoxSoA
+	{
+		void Clear()
+		{
+			centerX.clear(); centerY.clear(); centerZ.clear();
+			extentX.clear(); extentY.clear(); extentZ.clear();
+		}
+
+		void Add(const Vector3& center, const Vector3& extent)
+		{
+			centerX.emplace_back(center.x); centerY.emplace_back(center.y); centerZ.emplace_back(center.z);
+			extentX.emplace_back(extent.x); extentY.emplace_back(extent.y); extentZ.emplace_back(extent.z);
+		}
+
+		size_t Size() const { return centerX.size(); }
+
+		std::vector<float> centerX, centerY, centerZ;
+		std::vector<float> extentX, extentY, extentZ;
+	};
+
 	class Frustum
 	{
 	public:
@@ -36,9 +60,15 @@ namespace Directus::Math
 		~Frustum() {}
 
 		void Construct(const Matrix& mView, const Matrix&  mProjection, float screenDepth);
+		// The six faces of a box, what an orthographic projection sees
+		void Construct(const BoundingBox& box);
 		Intersection CheckCube(const Vector3& center, const Vector3& extent);
 		Intersection CheckSphere(const Vector3& center, float radius);
 
+		// Sets bit i % 64 of visible[i / 64] for every box in [start, end) that isn't outside, clearing the rest of those words.
+		// Start has to be a multiple of 64 (and so has end, unless it's the last box) for ranges to be culled in parallel.
+		void CheckCubes(const BoundingBoxSoA& boxes, size_t start, size_t end, uint64_t* visible) const;
+
 	private:
 		Plane m_planes[6];
 	};
@@ -102,4 +102,18 @@ namespace Directus::Math::Helper
 
 		return angle;
 	}
+
+	// Returns the index-th (starting at 1) element of the Halton sequence of the given base, a well spread 0-1 value
+	inline float Halton(unsigned int index, unsigned int base)
+	{
+		float fraction	= 1.0f;
+		float result	= 0.0f;
+		while (index > 0)
+		{
+			fraction	/= (float)base;
+			result		+= fraction * (index % base);
+			index		/= base;
+		}
+		return result;
+	}
 }
\ No newline at end of file
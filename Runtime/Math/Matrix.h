@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Quaternion.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "SIMD.h"
 //=====================
 
 //= NAMESPACES ========================
@@ -33,7 +34,7 @@ using namespace Directus::Math::Helper;
 
 namespace Directus::Math
 {
-	class ENGINE_CLASS Matrix
+	class ENGINE_CLASS MATH_MATRIX_ALIGNMENT Matrix
 	{
 	public:
 		Matrix()
@@ -271,6 +272,32 @@ namespace Directus::Math
 				0, 0, -zn * zf / (zf - zn), 0
 			);
 		}
+
+		// Same as above with the far plane at infinity
+		static Matrix CreatePerspectiveFieldOfViewInfiniteLH(float fieldOfView, float aspectRatio, float nearPlaneDistance)
+		{
+			float yScale = CotF(fieldOfView / 2);
+			float xScale = yScale / aspectRatio;
+
+			return Matrix(
+				xScale, 0, 0, 0,
+				0, yScale, 0, 0,
+				0, 0, 1, 1,
+				0, 0, -nearPlaneDistance, 0
+			);
+		}
+
+		// Multiplied after a projection, maps the near plane to a depth of 1 and the far plane to 0 (reverse-z).
+		// Applying it twice gives back the original projection.
+		static Matrix CreateReverseZ()
+		{
+			return Matrix(
+				1, 0, 0, 0,
+				0, 1, 0, 0,
+				0, 0, -1, 0,
+				0, 0, 1, 1
+			);
+		}
 		//=================================================================================================================================
 
 		//= TRANSPOSE ====================================================================================
@@ -278,12 +305,21 @@ namespace Directus::Math
 		void Transpose() { *this = Transpose(*this); }
 		static Matrix Transpose(const Matrix& matrix)
 		{
-			return Matrix(
-				matrix.m00, matrix.m10, matrix.m20, matrix.m30,
-				matrix.m01, matrix.m11, matrix.m21, matrix.m31,
-				matrix.m02, matrix.m12, matrix.m22, matrix.m32,
-				matrix.m03, matrix.m13, matrix.m23, matrix.m33
-			);
+			using namespace SIMD;
+
+			const float* data	= matrix.Data();
+			Float4 c0			= Load(data);
+			Float4 c1			= Load(data + 4);
+			Float4 c2			= Load(data + 8);
+			Float4 c3			= Load(data + 12);
+			SIMD::Transpose(c0, c1, c2, c3);
+
+			Matrix result;
+			Store(result.Data(), c0);
+			Store(result.Data() + 4, c1);
+			Store(result.Data() + 8, c2);
+			Store(result.Data() + 12, c3);
+			return result;
 		}
 		//================================================================================================
 
@@ -291,6 +327,10 @@ namespace Directus::Math
 		Matrix Inverted() const { return Invert(*this); }
 		static Matrix Invert(const Matrix& matrix)
 		{
+			// Anything but a projection, i.e. every transform, takes the cheaper way
+			if (matrix.IsAffine())
+				return InvertAffine(matrix);
+
 			float v0 = matrix.m20 * matrix.m31 - matrix.m21 * matrix.m30;
 			float v1 = matrix.m20 * matrix.m32 - matrix.m22 * matrix.m30;
 			float v2 = matrix.m20 * matrix.m33 - matrix.m23 *matrix.m30;
@@ -345,6 +385,34 @@ namespace Directus::Math
 				i20, i21, i22, i23,
 				i30, i31, i32, i33);
 		}
+
+		// Rotation, scale (and shear) and translation only. The rows of the 3x3 part crossed with each other are the columns
+		// of it's inverse (scaled by the determinant), the translation is undone by them.
+		Matrix InvertedAffine() const { return InvertAffine(*this); }
+		static Matrix InvertAffine(const Matrix& matrix)
+		{
+			Vector3 r0(matrix.m00, matrix.m01, matrix.m02);
+			Vector3 r1(matrix.m10, matrix.m11, matrix.m12);
+			Vector3 r2(matrix.m20, matrix.m21, matrix.m22);
+			Vector3 t(matrix.m30, matrix.m31, matrix.m32);
+
+			Vector3 c0		= Vector3::Cross(r1, r2);
+			Vector3 c1		= Vector3::Cross(r2, r0);
+			Vector3 c2		= Vector3::Cross(r0, r1);
+			float invDet	= 1.0f / Vector3::Dot(r0, c0);
+			c0 *= invDet;
+			c1 *= invDet;
+			c2 *= invDet;
+
+			return Matrix(
+				c0.x, c1.x, c2.x, 0.0f,
+				c0.y, c1.y, c2.y, 0.0f,
+				c0.z, c1.z, c2.z, 0.0f,
+				-Vector3::Dot(t, c0), -Vector3::Dot(t, c1), -Vector3::Dot(t, c2), 1.0f
+			);
+		}
+
+		bool IsAffine() const { return m03 == 0.0f && m13 == 0.0f && m23 == 0.0f && m33 == 1.0f; }
 		//================================================================================================
 
 		void Decompose(Vector3& scale, Quaternion& rotation, Vector3& translation)
@@ -363,26 +431,28 @@ namespace Directus::Math
 		}
 
 		//= MULTIPLICATION ================================================================================================================
+		// Columns are contiguous (see below), so a column of the result is this matrix's columns weighted by a column of rhs
 		Matrix operator*(const Matrix& rhs) const
 		{
-			return Matrix(
-				m00 * rhs.m00 + m01 * rhs.m10 + m02 * rhs.m20 + m03 * rhs.m30,
-				m00 * rhs.m01 + m01 * rhs.m11 + m02 * rhs.m21 + m03 * rhs.m31,
-				m00 * rhs.m02 + m01 * rhs.m12 + m02 * rhs.m22 + m03 * rhs.m32,
-				m00 * rhs.m03 + m01 * rhs.m13 + m02 * rhs.m23 + m03 * rhs.m33,
-				m10 * rhs.m00 + m11 * rhs.m10 + m12 * rhs.m20 + m13 * rhs.m30,
-				m10 * rhs.m01 + m11 * rhs.m11 + m12 * rhs.m21 + m13 * rhs.m31,
-				m10 * rhs.m02 + m11 * rhs.m12 + m12 * rhs.m22 + m13 * rhs.m32,
-				m10 * rhs.m03 + m11 * rhs.m13 + m12 * rhs.m23 + m13 * rhs.m33,
-				m20 * rhs.m00 + m21 * rhs.m10 + m22 * rhs.m20 + m23 * rhs.m30,
-				m20 * rhs.m01 + m21 * rhs.m11 + m22 * rhs.m21 + m23 * rhs.m31,
-				m20 * rhs.m02 + m21 * rhs.m12 + m22 * rhs.m22 + m23 * rhs.m32,
-				m20 * rhs.m03 + m21 * rhs.m13 + m22 * rhs.m23 + m23 * rhs.m33,
-				m30 * rhs.m00 + m31 * rhs.m10 + m32 * rhs.m20 + m33 * rhs.m30,
-				m30 * rhs.m01 + m31 * rhs.m11 + m32 * rhs.m21 + m33 * rhs.m31,
-				m30 * rhs.m02 + m31 * rhs.m12 + m32 * rhs.m22 + m33 * rhs.m32,
-				m30 * rhs.m03 + m31 * rhs.m13 + m32 * rhs.m23 + m33 * rhs.m33
-			);
+			using namespace SIMD;
+
+			const float* data	= Data();
+			Float4 c0			= Load(data);
+			Float4 c1			= Load(data + 4);
+			Float4 c2			= Load(data + 8);
+			Float4 c3			= Load(data + 12);
+
+			Matrix result;
+			for (unsigned int i = 0; i < 4; i++)
+			{
+				Float4 column	= Load(rhs.Data() + i * 4);
+				Float4 value	= Mul(c0, Splat<0>(column));
+				value			= MulAdd(c1, Splat<1>(column), value);
+				value			= MulAdd(c2, Splat<2>(column), value);
+				value			= MulAdd(c3, Splat<3>(column), value);
+				Store(result.Data() + i * 4, value);
+			}
+			return result;
 		}
 
 		void operator*=(const Matrix& rhs) { (*this) = (*this) * rhs; }
@@ -398,6 +468,52 @@ namespace Directus::Math
 
 			return Vector3(vWorking.x * vWorking.w, vWorking.y * vWorking.w, vWorking.z * vWorking.w);
 		}
+
+		// Batches, the rows are set up once for all of them. Points and vectors are transformed by an affine matrix (no
+		// divide by w, unlike the operator above), vectors ignore the translation. The output can be the input.
+		static void TransformPoints(const Matrix& matrix, const Vector3* points, Vector3* output, size_t count)
+		{
+			using namespace SIMD;
+
+			Float4 r0, r1, r2, r3;
+			matrix.GetRows(r0, r1, r2, r3);
+			float result[4];
+			for (size_t i = 0; i < count; i++)
+			{
+				Float4 value = MulAdd(Splat(points[i].x), r0, MulAdd(Splat(points[i].y), r1, MulAdd(Splat(points[i].z), r2, r3)));
+				Store(result, value);
+				output[i] = Vector3(result[0], result[1], result[2]);
+			}
+		}
+
+		static void TransformVectors(const Matrix& matrix, const Vector3* vectors, Vector3* output, size_t count)
+		{
+			using namespace SIMD;
+
+			Float4 r0, r1, r2, r3;
+			matrix.GetRows(r0, r1, r2, r3);
+			float result[4];
+			for (size_t i = 0; i < count; i++)
+			{
+				Float4 value = MulAdd(Splat(vectors[i].x), r0, MulAdd(Splat(vectors[i].y), r1, Mul(Splat(vectors[i].z), r2)));
+				Store(result, value);
+				output[i] = Vector3(result[0], result[1], result[2]);
+			}
+		}
+
+		static void Transform(const Matrix& matrix, const Vector4* vectors, Vector4* output, size_t count)
+		{
+			using namespace SIMD;
+
+			Float4 r0, r1, r2, r3;
+			matrix.GetRows(r0, r1, r2, r3);
+			for (size_t i = 0; i < count; i++)
+			{
+				const auto& v	= vectors[i];
+				Float4 value	= MulAdd(Splat(v.x), r0, MulAdd(Splat(v.y), r1, MulAdd(Splat(v.z), r2, Mul(Splat(v.w), r3))));
+				Store(&output[i].x, value);
+			}
+		}
 		//=================================================================================================================================
 
 		//= COMPARISON =================================================
@@ -419,8 +535,19 @@ namespace Directus::Math
 		//==============================================================
 
 		const float* Data() const { return &m00; }
+		float* Data() { return &m00; }
 		std::string ToString() const;
 
+		// m00 m01 m02 m03 and so on, what a vector is multiplied by component by component
+		void GetRows(SIMD::Float4& r0, SIMD::Float4& r1, SIMD::Float4& r2, SIMD::Float4& r3) const
+		{
+			r0 = SIMD::Load(Data());
+			r1 = SIMD::Load(Data() + 4);
+			r2 = SIMD::Load(Data() + 8);
+			r3 = SIMD::Load(Data() + 12);
+			SIMD::Transpose(r0, r1, r2, r3);
+		}
+
 		// Column-major memory representation 
 		float m00{}, m10{}, m20{}, m30{};
 		float m01{}, m11{}, m21{}, m31{};
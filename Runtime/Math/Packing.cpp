@@ -0,0 +1,168 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+//= INCLUDES =====
+#include "Packing.h"
+#include "SIMD.h"
+//================
+
+//= NAMESPACES ========================
+using namespace Directus::Math::SIMD;
+//=====================================
+
+namespace Directus::Math::Packing
+{
+	//= HALF FLOATS ================================================================================================
+	void FloatToHalf(const float* values, uint16_t* output, size_t count)
+	{
+		size_t i = 0;
+#if defined(MATH_SIMD_F16C)
+		for (; i + 4 <= count; i += 4)
+		{
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&output[i]), _mm_cvtps_ph(_mm_loadu_ps(&values[i]), _MM_FROUND_TO_NEAREST_INT));
+		}
+#elif defined(MATH_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+		for (; i + 4 <= count; i += 4)
+		{
+			vst1_u16(&output[i], vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(&values[i]))));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			output[i] = FloatToHalf(values[i]);
+		}
+	}
+
+	void HalfToFloat(const uint16_t* values, float* output, size_t count)
+	{
+		size_t i = 0;
+#if defined(MATH_SIMD_F16C)
+		for (; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_ps(&output[i], _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&values[i]))));
+		}
+#elif defined(MATH_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+		for (; i + 4 <= count; i += 4)
+		{
+			vst1q_f32(&output[i], vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(&values[i]))));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			output[i] = HalfToFloat(values[i]);
+		}
+	}
+	//==============================================================================================================
+
+	//= UNORM/SNORM ================================================================================================
+	void PackUnorm4x8(const Vector4* values, uint32_t* output, size_t count)
+	{
+		// A vector4 is four floats, one load each
+		Float4 zero		= Splat(0.0f);
+		Float4 one		= Splat(1.0f);
+		Float4 scale	= Splat(255.0f);
+		Float4 half		= Splat(0.5f);
+		int32_t integers[4];
+		for (size_t i = 0; i < count; i++)
+		{
+			Float4 value = Min(Max(Load(&values[i].x), zero), one);
+			StoreInt(integers, MulAdd(value, scale, half));
+			output[i] = (uint32_t)integers[0] | ((uint32_t)integers[1] << 8) | ((uint32_t)integers[2] << 16) | ((uint32_t)integers[3] << 24);
+		}
+	}
+	//==============================================================================================================
+
+	//= OCTAHEDRAL UNIT VECTORS ====================================================================================
+	void PackOctahedral(const Vector3* normals, uint32_t* output, size_t count)
+	{
+		// Four normals at a time, component by component
+		Float4 zero			= Splat(0.0f);
+		Float4 one			= Splat(1.0f);
+		Float4 minusOne		= Splat(-1.0f);
+		Float4 half			= Splat(0.5f);
+		Float4 minusHalf	= Splat(-0.5f);
+		Float4 epsilon		= Splat(Helper::M_EPSILON);
+		Float4 scale		= Splat(32767.0f);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const Vector3* n = &normals[i];
+			Float4 x = Set(n[0].x, n[1].x, n[2].x, n[3].x);
+			Float4 y = Set(n[0].y, n[1].y, n[2].y, n[3].y);
+			Float4 z = Set(n[0].z, n[1].z, n[2].z, n[3].z);
+
+			Float4 length	= Max(Add(Add(Abs(x), Abs(y)), Abs(z)), epsilon);
+			Float4 octX		= Div(x, length);
+			Float4 octY		= Div(y, length);
+			Float4 signX	= Select(Less(octX, zero), minusOne, one);
+			Float4 signY	= Select(Less(octY, zero), minusOne, one);
+			Float4 back		= Less(z, zero);
+			Float4 foldX	= Mul(Sub(one, Abs(octY)), signX);
+			Float4 foldY	= Mul(Sub(one, Abs(octX)), signY);
+			octX			= Select(back, foldX, octX);
+			octY			= Select(back, foldY, octY);
+
+			// Same rounding as PackSnorm, away from zero
+			octX = MulAdd(Min(Max(octX, minusOne), one), scale, Select(Less(octX, zero), minusHalf, half));
+			octY = MulAdd(Min(Max(octY, minusOne), one), scale, Select(Less(octY, zero), minusHalf, half));
+
+			int32_t integersX[4], integersY[4];
+			StoreInt(integersX, octX);
+			StoreInt(integersY, octY);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				output[i + lane] = ((uint32_t)integersX[lane] & 0xffff) | (((uint32_t)integersY[lane] & 0xffff) << 16);
+			}
+		}
+
+		for (; i < count; i++)
+		{
+			output[i] = PackOctahedral(normals[i]);
+		}
+	}
+
+	void UnpackOctahedral(const uint32_t* values, Vector3* output, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output[i] = UnpackOctahedral(values[i]);
+		}
+	}
+	//==============================================================================================================
+
+	//= SMALLEST THREE QUATERNIONS =================================================================================
+	// The dropped component differs per quaternion, lanes would diverge, so these stay scalar
+	void PackQuaternion(const Quaternion* rotations, uint32_t* output, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output[i] = PackQuaternion(rotations[i]);
+		}
+	}
+
+	void UnpackQuaternion(const uint32_t* values, Quaternion* output, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output[i] = UnpackQuaternion(values[i]);
+		}
+	}
+	//==============================================================================================================
+}
@@ -0,0 +1,237 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES ===========
+#include <cstdint>
+#include <cstring>
+#include "MathHelper.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Quaternion.h"
+//======================
+
+// Conversions to the compact formats the GPU, the disk and the network get: halfs, unorm/snorm integers,
+// octahedral unit vectors and smallest three quaternions. Single values are inline, the batches (SIMD where
+// the format allows it) are in the .cpp. Unpacking gives back what the GPU's format conversion would.
+namespace Directus::Math::Packing
+{
+	//= HALF FLOATS ================================================================================================
+	// Rounds to nearest, too large values become infinity
+	inline uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign		= (bits >> 16) & 0x8000;
+		int32_t exponent	= (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+		uint32_t mantissa	= bits & 0x7fffff;
+
+		if (((bits >> 23) & 0xff) == 0xff)	// inf and nan
+			return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+		if (exponent >= 31)					// too large, clamp to inf
+			return (uint16_t)(sign | 0x7c00);
+		if (exponent <= 0)					// denormal or too small
+		{
+			if (exponent < -10)
+				return (uint16_t)sign;
+			mantissa |= 0x800000;
+			uint32_t shift = (uint32_t)(14 - exponent);
+			return (uint16_t)(sign | ((mantissa + (1u << (shift - 1))) >> shift));
+		}
+
+		// Round to nearest, a carry into the exponent is still the right value
+		return (uint16_t)(sign | (((uint32_t)exponent << 10) + ((mantissa + 0x1000) >> 13)));
+	}
+
+	inline float HalfToFloat(uint16_t value)
+	{
+		uint32_t sign		= (uint32_t)(value & 0x8000) << 16;
+		uint32_t exponent	= (value >> 10) & 0x1f;
+		uint32_t mantissa	= value & 0x3ff;
+
+		uint32_t bits;
+		if (exponent == 0)
+		{
+			float result = mantissa / 16777216.0f; // mantissa * 2^-24
+			return sign ? -result : result;
+		}
+		else if (exponent == 31)
+		{
+			bits = sign | 0x7f800000 | (mantissa << 13);
+		}
+		else
+		{
+			bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+		}
+
+		float result;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	ENGINE_CLASS void FloatToHalf(const float* values, uint16_t* output, size_t count);
+	ENGINE_CLASS void HalfToFloat(const uint16_t* values, float* output, size_t count);
+	//==============================================================================================================
+
+	//= UNORM/SNORM ================================================================================================
+	// [0, 1] and [-1, 1] in the low bits of an integer (up to 16), rounded to nearest and clamped
+	inline uint32_t PackUnorm(float value, unsigned int bits)
+	{
+		float max = (float)((1u << bits) - 1);
+		return (uint32_t)(Helper::Clamp(value, 0.0f, 1.0f) * max + 0.5f);
+	}
+
+	inline float UnpackUnorm(uint32_t value, unsigned int bits)
+	{
+		return (float)(value & ((1u << bits) - 1)) / (float)((1u << bits) - 1);
+	}
+
+	// Two's complement, both the lowest and the one after it mean -1
+	inline uint32_t PackSnorm(float value, unsigned int bits)
+	{
+		float max		= (float)((1u << (bits - 1)) - 1);
+		value			= Helper::Clamp(value, -1.0f, 1.0f) * max;
+		int32_t integer	= (int32_t)(value + (value < 0.0f ? -0.5f : 0.5f));
+		return (uint32_t)integer & ((1u << bits) - 1);
+	}
+
+	inline float UnpackSnorm(uint32_t value, unsigned int bits)
+	{
+		int32_t integer = (int32_t)(value << (32 - bits)) >> (32 - bits);
+		return Helper::Max((float)integer / (float)((1u << (bits - 1)) - 1), -1.0f);
+	}
+
+	// RGBA8, x in the lowest byte
+	inline uint32_t PackUnorm4x8(const Vector4& value)
+	{
+		return PackUnorm(value.x, 8) | (PackUnorm(value.y, 8) << 8) | (PackUnorm(value.z, 8) << 16) | (PackUnorm(value.w, 8) << 24);
+	}
+
+	inline Vector4 UnpackUnorm4x8(uint32_t value)
+	{
+		return Vector4(UnpackUnorm(value, 8), UnpackUnorm(value >> 8, 8), UnpackUnorm(value >> 16, 8), UnpackUnorm(value >> 24, 8));
+	}
+
+	ENGINE_CLASS void PackUnorm4x8(const Vector4* values, uint32_t* output, size_t count);
+	//==============================================================================================================
+
+	//= OCTAHEDRAL UNIT VECTORS ====================================================================================
+	// A unit vector projected on an octahedron which is then unfolded to a square, [-1, 1] on both axes.
+	// Error is spread evenly over the sphere, unlike storing two components and deriving the third.
+	inline Vector2 OctahedralEncode(const Vector3& normal)
+	{
+		float length	= Helper::Max(Helper::Abs(normal.x) + Helper::Abs(normal.y) + Helper::Abs(normal.z), Helper::M_EPSILON);
+		float x			= normal.x / length;
+		float y			= normal.y / length;
+		if (normal.z < 0.0f)
+		{
+			float foldX = (1.0f - Helper::Abs(y)) * (x < 0.0f ? -1.0f : 1.0f);
+			float foldY = (1.0f - Helper::Abs(x)) * (y < 0.0f ? -1.0f : 1.0f);
+			x = foldX;
+			y = foldY;
+		}
+
+		return Vector2(x, y);
+	}
+
+	inline Vector3 OctahedralDecode(const Vector2& value)
+	{
+		Vector3 normal(value.x, value.y, 1.0f - Helper::Abs(value.x) - Helper::Abs(value.y));
+		if (normal.z < 0.0f)
+		{
+			normal.x = (1.0f - Helper::Abs(value.y)) * (value.x < 0.0f ? -1.0f : 1.0f);
+			normal.y = (1.0f - Helper::Abs(value.x)) * (value.y < 0.0f ? -1.0f : 1.0f);
+		}
+
+		return normal.Normalized();
+	}
+
+	// Two 16 bit snorms (R16G16_SNORM), x in the low half
+	inline uint32_t PackOctahedral(const Vector3& normal)
+	{
+		Vector2 value = OctahedralEncode(normal);
+		return PackSnorm(value.x, 16) | (PackSnorm(value.y, 16) << 16);
+	}
+
+	inline Vector3 UnpackOctahedral(uint32_t value)
+	{
+		return OctahedralDecode(Vector2(UnpackSnorm(value, 16), UnpackSnorm(value >> 16, 16)));
+	}
+
+	ENGINE_CLASS void PackOctahedral(const Vector3* normals, uint32_t* output, size_t count);
+	ENGINE_CLASS void UnpackOctahedral(const uint32_t* values, Vector3* output, size_t count);
+	//==============================================================================================================
+
+	//= SMALLEST THREE QUATERNIONS =================================================================================
+	// The largest component is dropped (it's recomputed from the rest) and the sign is flipped so it's positive,
+	// the other three lie in [-1/sqrt(2), 1/sqrt(2)] and get 10 bits each. The top 2 bits are the dropped index.
+	inline uint32_t PackQuaternion(const Quaternion& rotation)
+	{
+		float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+		uint32_t largest = 0;
+		for (uint32_t i = 1; i < 4; i++)
+		{
+			if (Helper::Abs(components[i]) > Helper::Abs(components[largest]))
+				largest = i;
+		}
+		float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+		uint32_t packed		= largest << 30;
+		unsigned int shift	= 0;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (i == largest)
+				continue;
+
+			// * sqrt(2) / 2 maps [-1/sqrt(2), 1/sqrt(2)] to [-0.5, 0.5]
+			packed |= PackUnorm(components[i] * sign * 0.70710678f + 0.5f, 10) << shift;
+			shift += 10;
+		}
+
+		return packed;
+	}
+
+	inline Quaternion UnpackQuaternion(uint32_t value)
+	{
+		uint32_t largest	= value >> 30;
+		float components[4];
+		float sum			= 0.0f;
+		unsigned int shift	= 0;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (i == largest)
+				continue;
+
+			components[i]	= (UnpackUnorm(value >> shift, 10) - 0.5f) * 1.41421356f;
+			sum				+= components[i] * components[i];
+			shift			+= 10;
+		}
+		components[largest] = Helper::Sqrt(Helper::Max(1.0f - sum, 0.0f));
+
+		return Quaternion(components[0], components[1], components[2], components[3]);
+	}
+
+	ENGINE_CLASS void PackQuaternion(const Quaternion* rotations, uint32_t* output, size_t count);
+	ENGINE_CLASS void UnpackQuaternion(const uint32_t* values, Quaternion* output, size_t count);
+	//==============================================================================================================
+}
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =======
 #include "Vector3.h"
+#include "SIMD.h"
 //==================
 
 namespace Directus::Math
@@ -244,39 +245,23 @@ namespace Directus::Math
 		//===========================================
 
 		//= MULTIPLICATION ==============================================================================
+		// rhs weighted by each of this quaternion's components, shuffled and signed so every lane is a row of the product
 		Quaternion operator*(const Quaternion& rhs) const
 		{
-			float num4	= rhs.x;
-			float num3	= rhs.y;
-			float num2	= rhs.z;
-			float num	= rhs.w;
-			float num12 = (y * num2) - (z * num3);
-			float num11 = (z * num4) - (x * num2);
-			float num10 = (x * num3) - (y * num4);
-			float num9 = ((x * num4) + (y * num3)) + (z * num2);
+			using namespace SIMD;
+
+			Float4 q		= Load(&rhs.x);
+			Float4 value	= Mul(Splat(w), q);
+			value			= MulAdd(Mul(Splat(x), Set(1.0f, -1.0f, 1.0f, -1.0f)), Swizzle_WZYX(q), value);
+			value			= MulAdd(Mul(Splat(y), Set(1.0f, 1.0f, -1.0f, -1.0f)), Swizzle_ZWXY(q), value);
+			value			= MulAdd(Mul(Splat(z), Set(-1.0f, 1.0f, 1.0f, -1.0f)), Swizzle_YXWZ(q), value);
+
 			Quaternion quaternion;
-			quaternion.x = ((x * num) + (num4 * w)) + num12;
-			quaternion.y = ((y * num) + (num3 * w)) + num11;
-			quaternion.z = ((z * num) + (num2 * w)) + num10;
-			quaternion.w = (w * num) - num9;
+			Store(&quaternion.x, value);
 			return quaternion;
 		}
 
-		void operator*=(const Quaternion& rhs)
-		{
-			float num4 = rhs.x;
-			float num3 = rhs.y;
-			float num2 = rhs.z;
-			float num = rhs.w;
-			float num12 = (y * num2) - (z * num3);
-			float num11 = (z * num4) - (x * num2);
-			float num10 = (x * num3) - (y * num4);
-			float num9 = ((x * num4) + (y * num3)) + (z * num2);
-			x	= ((x * num) + (num4 * w)) + num12;
-			y	= ((y * num) + (num3 * w)) + num11;
-			z	= ((z * num) + (num2 * w)) + num10;
-			w	= (w * num) - num9;
-		}
+		void operator*=(const Quaternion& rhs) { *this = *this * rhs; }
 
 		Vector3 operator*(const Vector3& rhs) const
 		{
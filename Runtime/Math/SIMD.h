@@ -0,0 +1,193 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+// The instructions the math classes are built with follow what the compiler targets (SSE on every x64 build, AVX and
+// FMA with /arch:AVX2, NEON on ARM). MATH_SIMD_SCALAR builds them with plain floats, to compare against or to debug.
+//#define MATH_SIMD_SCALAR
+
+// Aligns matrices to 16 bytes. Off by default, matrices are part of constant buffer layouts and other packed structs,
+// and unaligned loads of aligned data cost the same as aligned ones on anything since Nehalem.
+//#define MATH_MATRIX_ALIGNED
+
+//= INCLUDES ===================================================================================================
+#include <cstdint>
+#include <cmath>
+#if !defined(MATH_SIMD_SCALAR) && (defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+	#define MATH_SIMD_SSE
+	#include <emmintrin.h>
+	#if defined(__AVX2__) || defined(__FMA__)
+		#define MATH_SIMD_FMA
+		#include <immintrin.h>
+	#endif
+	#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)) // MSVC doesn't tell, every AVX2 CPU has it
+		#define MATH_SIMD_F16C
+		#include <immintrin.h>
+	#endif
+#elif !defined(MATH_SIMD_SCALAR) && (defined(__ARM_NEON) || defined(_M_ARM64))
+	#define MATH_SIMD_NEON
+	#include <arm_neon.h>
+#endif
+//==============================================================================================================
+
+#ifdef MATH_MATRIX_ALIGNED
+	#define MATH_MATRIX_ALIGNMENT alignas(16)
+#else
+	#define MATH_MATRIX_ALIGNMENT
+#endif
+
+// Four floats at once, x in the first lane. Just what the math classes use, loads and stores don't need alignment.
+namespace Directus::Math::SIMD
+{
+#if defined(MATH_SIMD_SSE)
+	typedef __m128 Float4;
+
+	inline Float4 Load(const float* data)					{ return _mm_loadu_ps(data); }
+	inline void Store(float* data, Float4 value)			{ _mm_storeu_ps(data, value); }
+	inline Float4 Set(float x, float y, float z, float w)	{ return _mm_set_ps(w, z, y, x); }
+	inline Float4 Splat(float value)						{ return _mm_set1_ps(value); }
+	template<int lane>
+	inline Float4 Splat(Float4 value)						{ return _mm_shuffle_ps(value, value, _MM_SHUFFLE(lane, lane, lane, lane)); }
+	inline Float4 Add(Float4 a, Float4 b)					{ return _mm_add_ps(a, b); }
+	inline Float4 Sub(Float4 a, Float4 b)					{ return _mm_sub_ps(a, b); }
+	inline Float4 Mul(Float4 a, Float4 b)					{ return _mm_mul_ps(a, b); }
+	inline Float4 Min(Float4 a, Float4 b)					{ return _mm_min_ps(a, b); }
+	inline Float4 Max(Float4 a, Float4 b)					{ return _mm_max_ps(a, b); }
+	inline Float4 Div(Float4 a, Float4 b)					{ return _mm_div_ps(a, b); }
+	inline Float4 Abs(Float4 value)							{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+	inline Float4 Sqrt(Float4 value)						{ return _mm_sqrt_ps(value); }
+	// Truncates toward zero
+	inline void StoreInt(int32_t* data, Float4 value)		{ _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_cvttps_epi32(value)); }
+	// a * b + c
+	#if defined(MATH_SIMD_FMA)
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)		{ return _mm_fmadd_ps(a, b, c); }
+	#else
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)		{ return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	#endif
+	// Comparisons give a lane mask, Mask() packs it to a bit per lane, x in bit 0
+	inline Float4 Less(Float4 a, Float4 b)					{ return _mm_cmplt_ps(a, b); }
+	inline Float4 Or(Float4 a, Float4 b)					{ return _mm_or_ps(a, b); }
+	inline int Mask(Float4 value)							{ return _mm_movemask_ps(value); }
+	// a where the mask is set, b elsewhere
+	inline Float4 Select(Float4 mask, Float4 a, Float4 b)	{ return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	// y x w z, z w x y and w z y x
+	inline Float4 Swizzle_YXWZ(Float4 value)				{ return _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)); }
+	inline Float4 Swizzle_ZWXY(Float4 value)				{ return _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)); }
+	inline Float4 Swizzle_WZYX(Float4 value)				{ return _mm_shuffle_ps(value, value, _MM_SHUFFLE(0, 1, 2, 3)); }
+	inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+#elif defined(MATH_SIMD_NEON)
+	typedef float32x4_t Float4;
+
+	inline Float4 Load(const float* data)					{ return vld1q_f32(data); }
+	inline void Store(float* data, Float4 value)			{ vst1q_f32(data, value); }
+	inline Float4 Set(float x, float y, float z, float w)	{ float values[4] = { x, y, z, w }; return vld1q_f32(values); }
+	inline Float4 Splat(float value)						{ return vdupq_n_f32(value); }
+	template<int lane>
+	inline Float4 Splat(Float4 value)						{ return vdupq_n_f32(vgetq_lane_f32(value, lane)); }
+	inline Float4 Add(Float4 a, Float4 b)					{ return vaddq_f32(a, b); }
+	inline Float4 Sub(Float4 a, Float4 b)					{ return vsubq_f32(a, b); }
+	inline Float4 Mul(Float4 a, Float4 b)					{ return vmulq_f32(a, b); }
+	inline Float4 Min(Float4 a, Float4 b)					{ return vminq_f32(a, b); }
+	inline Float4 Max(Float4 a, Float4 b)					{ return vmaxq_f32(a, b); }
+	#if defined(__aarch64__) || defined(_M_ARM64)
+	inline Float4 Div(Float4 a, Float4 b)					{ return vdivq_f32(a, b); }
+	#else
+	inline Float4 Div(Float4 a, Float4 b)
+	{
+		// Two Newton-Raphson steps on the estimate, close to a divide
+		float32x4_t inverse = vrecpeq_f32(b);
+		inverse = vmulq_f32(vrecpsq_f32(b, inverse), inverse);
+		inverse = vmulq_f32(vrecpsq_f32(b, inverse), inverse);
+		return vmulq_f32(a, inverse);
+	}
+	#endif
+	inline Float4 Abs(Float4 value)							{ return vabsq_f32(value); }
+	#if defined(__aarch64__) || defined(_M_ARM64)
+	inline Float4 Sqrt(Float4 value)						{ return vsqrtq_f32(value); }
+	#else
+	inline Float4 Sqrt(Float4 value)
+	{
+		// Two Newton-Raphson steps on the reciprocal estimate, zero isn't handled
+		float32x4_t inverse = vrsqrteq_f32(value);
+		inverse = vmulq_f32(vrsqrtsq_f32(vmulq_f32(value, inverse), inverse), inverse);
+		inverse = vmulq_f32(vrsqrtsq_f32(vmulq_f32(value, inverse), inverse), inverse);
+		return vmulq_f32(value, inverse);
+	}
+	#endif
+	inline void StoreInt(int32_t* data, Float4 value)		{ vst1q_s32(data, vcvtq_s32_f32(value)); }
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)		{ return vmlaq_f32(c, a, b); }
+	inline Float4 Less(Float4 a, Float4 b)					{ return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+	inline Float4 Or(Float4 a, Float4 b)					{ return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+	inline int Mask(Float4 value)
+	{
+		uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(value), 31);
+		return (int)(vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3));
+	}
+	inline Float4 Select(Float4 mask, Float4 a, Float4 b)	{ return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+	inline Float4 Swizzle_YXWZ(Float4 value)				{ return vrev64q_f32(value); }
+	inline Float4 Swizzle_ZWXY(Float4 value)				{ return vextq_f32(value, value, 2); }
+	inline Float4 Swizzle_WZYX(Float4 value)				{ return Swizzle_ZWXY(vrev64q_f32(value)); }
+	inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+	{
+		float32x4x2_t t0 = vtrnq_f32(r0, r1);
+		float32x4x2_t t1 = vtrnq_f32(r2, r3);
+		r0 = vcombine_f32(vget_low_f32(t0.val[0]), vget_low_f32(t1.val[0]));
+		r1 = vcombine_f32(vget_low_f32(t0.val[1]), vget_low_f32(t1.val[1]));
+		r2 = vcombine_f32(vget_high_f32(t0.val[0]), vget_high_f32(t1.val[0]));
+		r3 = vcombine_f32(vget_high_f32(t0.val[1]), vget_high_f32(t1.val[1]));
+	}
+#else
+	struct Float4 { float v[4]; };
+
+	inline Float4 Load(const float* data)					{ return { { data[0], data[1], data[2], data[3] } }; }
+	inline void Store(float* data, Float4 value)			{ for (int i = 0; i < 4; i++) data[i] = value.v[i]; }
+	inline Float4 Set(float x, float y, float z, float w)	{ return { { x, y, z, w } }; }
+	inline Float4 Splat(float value)						{ return { { value, value, value, value } }; }
+	template<int lane>
+	inline Float4 Splat(Float4 value)						{ return Splat(value.v[lane]); }
+	inline Float4 Add(Float4 a, Float4 b)					{ return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+	inline Float4 Sub(Float4 a, Float4 b)					{ return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+	inline Float4 Mul(Float4 a, Float4 b)					{ return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+	inline Float4 Min(Float4 a, Float4 b)					{ Float4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+	inline Float4 Max(Float4 a, Float4 b)					{ Float4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+	inline Float4 Div(Float4 a, Float4 b)					{ return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } }; }
+	inline Float4 Abs(Float4 value)							{ Float4 r; for (int i = 0; i < 4; i++) r.v[i] = value.v[i] < 0.0f ? -value.v[i] : value.v[i]; return r; }
+	inline Float4 Sqrt(Float4 value)						{ Float4 r; for (int i = 0; i < 4; i++) r.v[i] = std::sqrt(value.v[i]); return r; }
+	inline void StoreInt(int32_t* data, Float4 value)		{ for (int i = 0; i < 4; i++) data[i] = (int32_t)value.v[i]; }
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)		{ return Add(Mul(a, b), c); }
+	// A lane mask is 1 or 0 here
+	inline Float4 Less(Float4 a, Float4 b)					{ Float4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] < b.v[i] ? 1.0f : 0.0f; return r; }
+	inline Float4 Or(Float4 a, Float4 b)					{ Float4 r; for (int i = 0; i < 4; i++) r.v[i] = (a.v[i] != 0.0f || b.v[i] != 0.0f) ? 1.0f : 0.0f; return r; }
+	inline int Mask(Float4 value)							{ int mask = 0; for (int i = 0; i < 4; i++) mask |= (value.v[i] != 0.0f ? 1 : 0) << i; return mask; }
+	inline Float4 Select(Float4 mask, Float4 a, Float4 b)	{ Float4 r; for (int i = 0; i < 4; i++) r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i]; return r; }
+	inline Float4 Swizzle_YXWZ(Float4 value)				{ return { { value.v[1], value.v[0], value.v[3], value.v[2] } }; }
+	inline Float4 Swizzle_ZWXY(Float4 value)				{ return { { value.v[2], value.v[3], value.v[0], value.v[1] } }; }
+	inline Float4 Swizzle_WZYX(Float4 value)				{ return { { value.v[3], value.v[2], value.v[1], value.v[0] } }; }
+	inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+	{
+		Float4 t0 = { { r0.v[0], r1.v[0], r2.v[0], r3.v[0] } };
+		Float4 t1 = { { r0.v[1], r1.v[1], r2.v[1], r3.v[1] } };
+		Float4 t2 = { { r0.v[2], r1.v[2], r2.v[2], r3.v[2] } };
+		Float4 t3 = { { r0.v[3], r1.v[3], r2.v[3], r3.v[3] } };
+		r0 = t0; r1 = t1; r2 = t2; r3 = t3;
+	}
+#endif
+}
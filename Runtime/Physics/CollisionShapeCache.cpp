@@ -0,0 +1,105 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+//= INCLUDES ========================================================
+#include "CollisionShapeCache.h"
+#include "../IO/FileStream.h"
+#include "../Logging/Log.h"
+#pragma warning(push, 0) // Hide warnings which belong to Bullet
+#include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#pragma warning(pop)
+//===================================================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+// Bumped when what's cooked changes, older files are cooked again
+static const unsigned int HULL_COOK_VERSION = 1;
+
+namespace Directus
+{
+	shared_ptr<btCollisionShape> CollisionShapeCache::Get(size_t key, const function<btCollisionShape*()>& build)
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		if (auto shape = m_shapes[key].lock())
+			return shape;
+
+		// Forget the shapes no one holds anymore, before the map grows by another one
+		for (auto it = m_shapes.begin(); it != m_shapes.end();)
+		{
+			it = it->second.expired() && it->first != key ? m_shapes.erase(it) : next(it);
+		}
+
+		shared_ptr<btCollisionShape> shape(build());
+		if (shape)
+		{
+			m_shapes[key] = shape;
+		}
+
+		return shape;
+	}
+
+	bool CollisionShapeCache::Hull_Load(const string& filePath, size_t key, vector<float>* points)
+	{
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Read);
+		if (!file->IsOpen())
+			return false;
+
+		unsigned int version	= 0;
+		uint64_t keyCooked		= 0;
+		unsigned int count		= 0;
+		file->Read(&version);
+		file->Read(&keyCooked);
+		file->Read(&count);
+		if (version != HULL_COOK_VERSION || keyCooked != (uint64_t)key || count == 0)
+			return false;
+
+		points->resize(count * 3);
+		file->ReadBytes(points->data(), points->size() * sizeof(float));
+
+		return true;
+	}
+
+	bool CollisionShapeCache::Hull_Save(const string& filePath, size_t key, const btConvexHullShape* hull)
+	{
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Write);
+		if (!file->IsOpen())
+		{
+			LOGF_WARNING("CollisionShapeCache::Hull_Save: Failed to create \"%s\"", filePath.c_str());
+			return false;
+		}
+
+		auto count = (unsigned int)hull->getNumPoints();
+		file->Write(HULL_COOK_VERSION);
+		file->Write((uint64_t)key);
+		file->Write(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const btVector3& point = hull->getUnscaledPoints()[i];
+			file->Write((float)point.getX());
+			file->Write((float)point.getY());
+			file->Write((float)point.getZ());
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,55 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES =============
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+//========================
+
+class btCollisionShape;
+class btConvexHullShape;
+
+namespace Directus
+{
+	// A collision shape doesn't change once built, colliders that ask for the same one (by a key of
+	// everything it's built from) share it. It's released when the last of them lets go of it.
+	class CollisionShapeCache
+	{
+	public:
+		// The shape of a key, built if no collider holds it already
+		std::shared_ptr<btCollisionShape> Get(size_t key, const std::function<btCollisionShape*()>& build);
+
+		// The unscaled points of a hull cooked to a file, false if there is none or it was cooked from something else
+		static bool Hull_Load(const std::string& filePath, size_t key, std::vector<float>* points);
+		static bool Hull_Save(const std::string& filePath, size_t key, const btConvexHullShape* hull);
+
+		static void HashCombine(size_t& seed, size_t value) { seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2); }
+
+	private:
+		std::unordered_map<size_t, std::weak_ptr<btCollisionShape>> m_shapes;
+		std::mutex m_mutex;
+	};
+}
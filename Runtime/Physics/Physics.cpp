@@ -24,16 +24,29 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/Engine.h"
 #include "../Core/EventSystem.h"
 #include "../Core/Settings.h"
+#include "../Logging/Log.h"
 #include "../Profiling/Profiler.h"
+#include "../Profiling/MemoryTracker.h"
 #include "PhysicsDebugDraw.h"
+#include "CollisionShapeCache.h"
 #include "BulletPhysicsHelper.h"
 #include "../Rendering/Renderer.h"
+#include "../Threading/Threading.h"
+#include "../World/Components/RigidBody.h"
+#include "../World/Components/Camera.h"
+#include "../World/Components/Transform.h"
+#include <climits>
+#include <chrono>
+#include <algorithm>
 #pragma warning(push, 0) // Hide warnings which belong to Bullet
 #include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
 #include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 #include <BulletDynamics/ConstraintSolver/btConstraintSolver.h>
+#include <LinearMath/btThreads.h>
 #pragma warning(pop)
 //==============================================================================
 
@@ -43,18 +56,63 @@ using namespace Directus::Math;
 //=============================
 
 static const int MAX_SOLVER_ITERATIONS	= 256;
-static const float INTERNAL_FPS			= 60.0f;
 static const Vector3 GRAVITY			= Vector3(0.0f, -9.81f, 0.0f);
+static const int DISPATCH_GRAIN_SIZE	= 40; // collision pairs per task, Bullet's default
+static const int LOD_BODIES_PER_TICK	= 1024;	// bodies whose simulation lod is reconsidered per tick
+static const int LOD_REDUCED_INTERVAL	= 4;	// a reduced body is stepped once every this many steps
+static const float LOD_HYSTERESIS		= 0.1f;	// of the distance, a body has to be this much further to go to a lower lod
 
 namespace Directus
 { 
+	namespace _Physics
+	{
+		// Bullet's parallel loops run as Parallel_For, the thread that steps the world takes part
+		class TaskScheduler : public btITaskScheduler
+		{
+		public:
+			TaskScheduler(Threading* threading) : btITaskScheduler("Directus"), m_threading(threading) {}
+
+			int getMaxNumThreads() const override			{ return Min((int)m_threading->GetThreadCount() + 1, (int)BT_MAX_THREAD_COUNT); }
+			int getNumThreads() const override				{ return m_threadCount != 0 ? m_threadCount : getMaxNumThreads(); }
+			void setNumThreads(int numThreads) override		{ m_threadCount = Clamp(numThreads, 1, getMaxNumThreads()); }
+
+			void parallelFor(int begin, int end, int grainSize, const btIParallelForBody& body) override
+			{
+				if (getNumThreads() <= 1)
+				{
+					body.forLoop(begin, end);
+					return;
+				}
+
+				m_threading->Parallel_For((unsigned int)begin, (unsigned int)end, (unsigned int)Max(grainSize, 1), [&body](unsigned int start, unsigned int stop)
+				{
+					body.forLoop((int)start, (int)stop);
+				});
+			}
+
+		private:
+			Threading* m_threading;
+			int m_threadCount = 0; // 0 follows the pool
+		};
+	}
+
 	Physics::Physics(Context* context) : Subsystem(context)
 	{
 		m_maxSubSteps = 1;
 		m_simulating = false;
+		m_shapeCache = new CollisionShapeCache();
+
+		// Bullet takes the thread that sets the task scheduler as it's main one, initialization runs on a worker
+		if (Settings::Get().PhysicsMultithreaded_Get())
+		{
+			m_taskScheduler = new _Physics::TaskScheduler(m_context->GetSubsystem<Threading>());
+			btSetTaskScheduler(m_taskScheduler);
+		}
 
 		// Subscribe to events
-		SUBSCRIBE_TO_EVENT(EVENT_TICK, EVENT_HANDLER_VARIANT(Step));
+		SUBSCRIBE_TO_EVENT(EVENT_TICK, EVENT_HANDLER_DATA(Step));
+		SUBSCRIBE_TO_EVENT(EVENT_FRAME_END, EVENT_HANDLER(DebugDraw_Submit));
+		SUBSCRIBE_TO_EVENT(EVENT_FRAME_END, EVENT_HANDLER(Stats_Publish));
 	}
 
 	Physics::~Physics()
@@ -65,16 +123,40 @@ namespace Directus
 		SafeDelete(m_collisionConfiguration);
 		SafeDelete(m_broadphase);
 		SafeDelete(m_debugDraw);
+		SafeDelete(m_shapeCache);
+
+		if (m_taskScheduler)
+		{
+			btSetTaskScheduler(btGetSequentialTaskScheduler());
+			SafeDelete(m_taskScheduler);
+		}
 	}
 
 	bool Physics::Initialize()
 	{
+		// A pool without workers has nothing to spread the work over
+		auto threading	= m_context->GetSubsystem<Threading>();
+		m_multithreaded	= m_taskScheduler && threading->GetThreadCount() > 0;
+
 		m_broadphase				= new btDbvtBroadphase();
 		m_collisionConfiguration	= new btDefaultCollisionConfiguration();
-		m_dispatcher				= new btCollisionDispatcher(m_collisionConfiguration);
-		m_constraintSolver			= new btSequentialImpulseConstraintSolver();
-		m_debugDraw					= new PhysicsDebugDraw(m_context->GetSubsystem<Renderer>());
-		m_world						= new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_constraintSolver, m_collisionConfiguration);
+		auto renderer				= m_context->GetSubsystem<Renderer>();
+		m_debugDraw					= renderer ? new PhysicsDebugDraw(renderer) : nullptr; // nothing to draw with when headless
+		if (m_multithreaded)
+		{
+			// Narrowphase pairs, islands and integration are split over the workers, each island gets a solver from the pool
+			auto solverPool		= new btConstraintSolverPoolMt(m_taskScheduler->getNumThreads());
+			m_dispatcher		= new btCollisionDispatcherMt(m_collisionConfiguration, DISPATCH_GRAIN_SIZE);
+			m_constraintSolver	= solverPool;
+			m_world				= new btDiscreteDynamicsWorldMt(m_dispatcher, m_broadphase, solverPool, m_collisionConfiguration);
+			LOGF_INFO("Physics::Initialize: Multithreaded, %d solvers", m_taskScheduler->getNumThreads());
+		}
+		else
+		{
+			m_dispatcher		= new btCollisionDispatcher(m_collisionConfiguration);
+			m_constraintSolver	= new btSequentialImpulseConstraintSolver();
+			m_world				= new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_constraintSolver, m_collisionConfiguration);
+		}
 
 		// Setup world
 		m_world->setGravity(ToBtVector3(GRAVITY));
@@ -91,46 +173,186 @@ namespace Directus
 		return true;
 	}
 
-	void Physics::Step(const Variant& deltaTime)
+	void Physics::Step(float deltaTime)
 	{
 		if (!m_world)
 			return;
-		
-		// Debug draw
-		if (Renderer::RenderFlags_IsSet(Render_Physics))
-		{
-			m_world->debugDrawWorld();
-		}
 
 		// Don't simulate physics if they are turned off or the we are in editor mode
 		if (!Engine::EngineMode_IsSet(Engine_Physics) || !Engine::EngineMode_IsSet(Engine_Game))
 			return;
 
-		TIME_BLOCK_START_CPU();
+		TIME_BLOCK_SCOPED_CPU();
+		MEMORY_TAG(MemoryTag_Physics);
+
+		m_simulating	= true;
+		auto timeStart	= chrono::steady_clock::now();
 
-		float timeStep = deltaTime.Get<float>();
+		Lod_Update();
 
-		// This equation must be met: timeStep < maxSubSteps * fixedTimeStep
-		float internalTimeStep = 1.0f / INTERNAL_FPS;
-		int maxSubsteps = (int)(timeStep * INTERNAL_FPS) + 1;
-		if (m_maxSubSteps < 0)
+		// The engine already steps at a fixed rate, so one step per tick keeps the two in lockstep
+		m_interpolating = m_maxSubSteps >= 0 && !Engine::EngineMode_IsSet(Engine_FixedStep);
+		if (!m_interpolating)
 		{
-			internalTimeStep = timeStep;
-			maxSubsteps = 1;
+			m_accumulator			= 0.0f;
+			m_interpolationAlpha	= 1.0f;
+			Lod_StepBegin();
+			m_world->stepSimulation(deltaTime, 1, deltaTime);
+			Lod_StepEnd();
 		}
-		else if (m_maxSubSteps > 0)
+		else
 		{
-			maxSubsteps = Min(maxSubsteps, m_maxSubSteps);
+			// Step at the physics rate, whatever the frame rate. Each step is taken whole (Bullet
+			// doesn't sub step or extrapolate it), what's left over places the bodies between the last two.
+			float fixedStep		= 1.0f / Settings::Get().PhysicsRate_Get();
+			int maxSteps		= m_maxSubSteps > 0 ? m_maxSubSteps : INT_MAX;
+			int steps			= 0;
+			m_accumulator		+= deltaTime;
+			while (m_accumulator >= fixedStep && steps < maxSteps)
+			{
+				for (const auto& body : m_bodiesMoving)
+				{
+					body->Pose_Store();
+				}
+				Lod_StepBegin();
+				m_world->stepSimulation(fixedStep, 0, fixedStep);
+				Lod_StepEnd();
+				m_accumulator -= fixedStep;
+				steps++;
+			}
+
+			// Out of steps for this tick, the simulation falls behind rather than spiralling
+			m_accumulator			= Min(m_accumulator, fixedStep);
+			m_interpolationAlpha	= m_accumulator / fixedStep;
+
+			// Only what Bullet moved gets written, the hierarchy below is resolved with the rest by World::Transforms_Update
+			auto resting = remove_if(m_bodiesMoving.begin(), m_bodiesMoving.end(), [this](RigidBody* body) { return !body->Pose_Interpolate(m_interpolationAlpha); });
+			m_bodiesMoving.erase(resting, m_bodiesMoving.end());
 		}
 
-		m_simulating = true;
+		m_frameMs		+= chrono::duration<float, milli>(chrono::steady_clock::now() - timeStart).count();
+		m_simulating	= false;
+	}
 
-		// Step the physics world. 
-		m_world->stepSimulation(timeStep, maxSubsteps, internalTimeStep);
+	void Physics::Lod_Update()
+	{
+		float distanceReduced	= Settings::Get().PhysicsLodDistance_GetReduced();
+		float distanceFrozen	= Settings::Get().PhysicsLodDistance_GetFrozen();
+		bool enabled			= distanceReduced > 0.0f || distanceFrozen > 0.0f;
+		if (!enabled && m_lodBodiesReduced.empty() && m_lodBodiesFrozen == 0)
+			return;
 
-		m_simulating = false;
+		// The camera is always a viewer, the game adds the rest (e.g. the players)
+		m_lodViewersStep.assign(m_lodViewers.begin(), m_lodViewers.end());
+		if (auto camera = m_context->GetSubsystem<Renderer>()->GetCamera())
+		{
+			m_lodViewersStep.emplace_back(camera->GetTransform()->GetPosition());
+		}
+		if (enabled && m_lodViewersStep.empty())
+			return;
 
-		TIME_BLOCK_END_CPU();
+		// A slice of the bodies per tick, a body changes lod a little late but crowds cost the same every tick
+		const btCollisionObjectArray& objects	= m_world->getCollisionObjectArray();
+		int count								= Min(objects.size(), LOD_BODIES_PER_TICK);
+		for (int i = 0; i < count; i++)
+		{
+			m_lodCursor = m_lodCursor + 1 < objects.size() ? m_lodCursor + 1 : 0;
+			btRigidBody* bodyBullet = btRigidBody::upcast(objects[m_lodCursor]);
+			if (!bodyBullet || bodyBullet->isStaticOrKinematicObject() || !bodyBullet->getUserPointer())
+				continue;
+
+			// Distance squared to the nearest viewer
+			Vector3 position	= ToVector3(bodyBullet->getWorldTransform().getOrigin());
+			float distance		= FLT_MAX;
+			for (const auto& viewer : m_lodViewersStep)
+			{
+				distance = Min(distance, (position - viewer).LengthSquared());
+			}
+
+			// A body has to go a bit further than where it came closer to change back, it doesn't flicker at the boundary
+			auto body		= static_cast<RigidBody*>(bodyBullet->getUserPointer());
+			auto current	= body->Lod_Get();
+			auto beyond		= [distance](float boundary, bool fartherAlready)
+			{
+				boundary *= fartherAlready ? 1.0f : 1.0f + LOD_HYSTERESIS;
+				return boundary > 0.0f && distance > boundary * boundary;
+			};
+			SimulationLod lod = SimulationLod_Full;
+			if (enabled && beyond(distanceFrozen, current == SimulationLod_Frozen))
+			{
+				lod = SimulationLod_Frozen;
+			}
+			else if (enabled && beyond(distanceReduced, current != SimulationLod_Full))
+			{
+				lod = SimulationLod_Reduced;
+			}
+
+			if (lod == current)
+				continue;
+
+			if (current == SimulationLod_Reduced)	m_lodBodiesReduced.erase(remove(m_lodBodiesReduced.begin(), m_lodBodiesReduced.end(), body), m_lodBodiesReduced.end());
+			if (current == SimulationLod_Frozen)	m_lodBodiesFrozen--;
+			if (lod == SimulationLod_Reduced)		m_lodBodiesReduced.emplace_back(body);
+			if (lod == SimulationLod_Frozen)		m_lodBodiesFrozen++;
+			body->Lod_Set(lod);
+		}
+	}
+
+	void Physics::Lod_StepBegin()
+	{
+		// Every reduced body takes one step in LOD_REDUCED_INTERVAL, they're spread over them so each step gets a share
+		m_lodStep++;
+		for (unsigned int i = 0; i < (unsigned int)m_lodBodiesReduced.size(); i++)
+		{
+			if ((m_lodStep + i) % LOD_REDUCED_INTERVAL == 0)
+			{
+				m_lodBodiesReduced[i]->Lod_StepBegin((float)LOD_REDUCED_INTERVAL);
+			}
+		}
+	}
+
+	void Physics::Lod_StepEnd()
+	{
+		for (unsigned int i = 0; i < (unsigned int)m_lodBodiesReduced.size(); i++)
+		{
+			if ((m_lodStep + i) % LOD_REDUCED_INTERVAL == 0)
+			{
+				m_lodBodiesReduced[i]->Lod_StepEnd((float)LOD_REDUCED_INTERVAL);
+			}
+		}
+	}
+
+	void Physics::DebugDraw_Submit()
+	{
+		// Once a frame however many steps it took, near the camera
+		if (!m_world || !m_debugDraw || !Renderer::RenderFlags_IsSet(Render_Physics))
+			return;
+
+		auto camera = m_context->GetSubsystem<Renderer>()->GetCamera();
+		if (!camera)
+			return;
+
+		TIME_BLOCK_SCOPED_CPU();
+		m_debugDraw->DrawWorld(m_world, camera->GetTransform()->GetPosition());
+	}
+
+	void Physics::Stats_Publish()
+	{
+		// Of the frame that's ending, the profiler samples them when the next one starts
+		Profiler::Get().m_physicsMs				= m_frameMs;
+		Profiler::Get().m_physicsBodiesReduced	= (unsigned int)m_lodBodiesReduced.size();
+		Profiler::Get().m_physicsBodiesFrozen	= m_lodBodiesFrozen;
+		m_frameMs = 0.0f;
+	}
+
+	void Physics::Body_Forget(RigidBody* body)
+	{
+		m_bodiesMoving.erase(remove(m_bodiesMoving.begin(), m_bodiesMoving.end(), body), m_bodiesMoving.end());
+		m_lodBodiesReduced.erase(remove(m_lodBodiesReduced.begin(), m_lodBodiesReduced.end(), body), m_lodBodiesReduced.end());
+		if (body->Lod_Get() == SimulationLod_Frozen)
+		{
+			m_lodBodiesFrozen--;
+		}
 	}
 
 	Vector3 Physics::GetGravity()
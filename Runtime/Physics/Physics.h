@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================
 #include "../Core/SubSystem.h"
+#include <vector>
+#include "../Math/Vector3.h"
 //============================
 
 class btBroadphaseInterface;
@@ -30,16 +32,14 @@ class btCollisionDispatcher;
 class btConstraintSolver;
 class btDefaultCollisionConfiguration;
 class btDiscreteDynamicsWorld;
+class btITaskScheduler;
 
 namespace Directus
 {
-	class Variant;
 	class PhysicsDebugDraw;
+	class CollisionShapeCache;
+	class RigidBody;
 
-	namespace Math
-	{
-		class Vector3;
-	}	
 
 	class Physics : public Subsystem
 	{
@@ -51,23 +51,56 @@ namespace Directus
 		bool Initialize() override;
 		//=========================
 
-		void Step(const Variant& deltaTime);
+		void Step(float deltaTime);
 		Math::Vector3 GetGravity();
 		btDiscreteDynamicsWorld* GetWorld()		{ return m_world; }
 		PhysicsDebugDraw* GetPhysicsDebugDraw() { return m_debugDraw; }
+		CollisionShapeCache* GetShapeCache()	{ return m_shapeCache; }
 		bool IsSimulating()						{ return m_simulating; }
+		bool IsMultithreaded()					{ return m_multithreaded; }
+		// Bodies are placed between their last two steps, alpha of the way
+		bool IsInterpolating()					{ return m_interpolating; }
+		float GetInterpolationAlpha()			{ return m_interpolationAlpha; }
+
+		// Bodies report moving from their motion state, sleeping ones never do and so cost nothing after a step
+		void Body_Moved(RigidBody* body)		{ m_bodiesMoving.emplace_back(body); }
+		void Body_Forget(RigidBody* body);
+
+		// Where bodies are seen from (e.g. the players), besides the camera. Bodies far from all of them are stepped less
+		// often or not at all, past PhysicsLodDistance_GetReduced() and PhysicsLodDistance_GetFrozen() (see Settings).
+		void Lod_SetViewers(const std::vector<Math::Vector3>& viewers) { m_lodViewers = viewers; }
 
 	private:
+		void Lod_Update();
+		void Lod_StepBegin();
+		void Lod_StepEnd();
+		void DebugDraw_Submit();
+		void Stats_Publish();
+
 		btBroadphaseInterface* m_broadphase;
 		btCollisionDispatcher* m_dispatcher;
 		btConstraintSolver* m_constraintSolver;
 		btDefaultCollisionConfiguration* m_collisionConfiguration;
 		btDiscreteDynamicsWorld* m_world;
 		PhysicsDebugDraw* m_debugDraw;
+		CollisionShapeCache* m_shapeCache;
+		btITaskScheduler* m_taskScheduler = nullptr; // Bullet's parallel loops on the Threading workers
+		std::vector<RigidBody*> m_bodiesMoving;		// moved in the last step, or still blending towards it
+		std::vector<RigidBody*> m_lodBodiesReduced;
+		unsigned int m_lodBodiesFrozen = 0;
+		std::vector<Math::Vector3> m_lodViewers;
+		std::vector<Math::Vector3> m_lodViewersStep;	// the viewers and the camera, of the tick
+		int m_lodCursor = 0;							// where the next slice of bodies starts
+		unsigned int m_lodStep = 0;
+		float m_frameMs = 0.0f;							// stepping this frame
 
 		//= PROPERTIES ===
 		int m_maxSubSteps;
 		bool m_simulating;
+		bool m_multithreaded = false;
+		bool m_interpolating = false;
+		float m_interpolationAlpha = 1.0f;
+		float m_accumulator = 0.0f;
 		//================
 	};
 }
\ No newline at end of file
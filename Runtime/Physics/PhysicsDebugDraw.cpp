@@ -19,19 +19,49 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//================================
+//= INCLUDES ==========================================================
 #include "PhysicsDebugDraw.h"
 #include "BulletPhysicsHelper.h"
 #include "../Rendering/Renderer.h"
+#include "../Rendering/DebugDraw.h"
 #include "../Logging/Log.h"
-//================================
+#include "../Math/Matrix.h"
+#include <vector>
+#include <set>
+#pragma warning(push, 0) // Hide warnings which belong to Bullet
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <BulletDynamics/ConstraintSolver/btTypedConstraint.h>
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
+#include <BulletCollision/CollisionShapes/btSphereShape.h>
+#include <BulletCollision/CollisionShapes/btCylinderShape.h>
+#include <BulletCollision/CollisionShapes/btCapsuleShape.h>
+#include <BulletCollision/CollisionShapes/btConeShape.h>
+#include <BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <BulletCollision/CollisionShapes/btConvexPolyhedron.h>
+#include <BulletCollision/CollisionShapes/btPolyhedralConvexShape.h>
+#pragma warning(pop)
+//=====================================================================
 
-//= NAMESPACES =====
+//= NAMESPACES ================
 using namespace std;
-//==================
+using namespace Directus::Math;
+//=============================
+
+#define PHYSICS_DEBUG_DRAW_DISTANCE		150.0f	// shapes further than this from the eye aren't drawn
+#define PHYSICS_DEBUG_WIREFRAME_FRAMES	120		// frames a hull's wireframe stays on the GPU after it was last drawn
 
 namespace Directus
 {
+	namespace _PhysicsDebugDraw
+	{
+		inline Matrix ToMatrix(const btTransform& transform)
+		{
+			return Matrix(ToVector3(transform.getOrigin()), ToQuaternion(transform.getRotation()), Vector3::One);
+		}
+
+		inline void HashCombine(uint64_t& seed, uint64_t value) { seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2); }
+	}
+
 	PhysicsDebugDraw::PhysicsDebugDraw(Renderer* renderer)
 	{
 		m_renderer	= renderer;
@@ -54,4 +84,236 @@ namespace Directus
 	{
 		LOGF_WARNING("Physics: %s", error_warning);
 	}
+
+	void PhysicsDebugDraw::DrawWorld(btDiscreteDynamicsWorld* world, const Vector3& eye)
+	{
+		m_frame++;
+		btVector3 eyeBt					= ToBtVector3(eye);
+		auto colors						= getDefaultColors();
+		const float distanceMax			= PHYSICS_DEBUG_DRAW_DISTANCE;
+		auto InRange = [&eyeBt, distanceMax](const btVector3& center, float radius)
+		{
+			float range = distanceMax + radius;
+			return (center - eyeBt).length2() <= range * range;
+		};
+
+		if (m_debugMode & DBG_DrawContactPoints)
+		{
+			auto dispatcher = world->getDispatcher();
+			for (int i = 0; i < dispatcher->getNumManifolds(); i++)
+			{
+				btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+				for (int j = 0; j < manifold->getNumContacts(); j++)
+				{
+					const btManifoldPoint& point = manifold->getContactPoint(j);
+					if (InRange(point.m_positionWorldOnB, 0.0f))
+					{
+						drawContactPoint(point.m_positionWorldOnB, point.m_normalWorldOnB, point.getDistance(), point.getLifeTime(), colors.m_contactPoint);
+					}
+				}
+			}
+		}
+
+		if (m_debugMode & DBG_DrawWireframe)
+		{
+			const btCollisionObjectArray& objects = world->getCollisionObjectArray();
+			for (int i = 0; i < objects.size(); i++)
+			{
+				const btCollisionObject* object = objects[i];
+				if (object->getCollisionFlags() & btCollisionObject::CF_DISABLE_VISUALIZE_OBJECT)
+					continue;
+
+				// Culled by the bounding sphere
+				const btTransform& transform = object->getWorldTransform();
+				btVector3 center;
+				btScalar radius;
+				object->getCollisionShape()->getBoundingSphere(center, radius);
+				if (!InRange(transform * center, radius))
+					continue;
+
+				// Colored by activation, like Bullet does
+				btVector3 color;
+				switch (object->getActivationState())
+				{
+					case ACTIVE_TAG:			color = colors.m_activeObject;					break;
+					case ISLAND_SLEEPING:		color = colors.m_deactivatedObject;				break;
+					case WANTS_DEACTIVATION:	color = colors.m_wantsDeactivationObject;		break;
+					case DISABLE_DEACTIVATION:	color = colors.m_disabledDeactivationObject;	break;
+					case DISABLE_SIMULATION:	color = colors.m_disabledSimulationObject;		break;
+					default:					color = btVector3(0.3f, 0.3f, 0.3f);			break;
+				}
+				object->getCustomDebugColor(color);
+
+				DrawShape(world, transform, object->getCollisionShape(), color);
+			}
+		}
+
+		if (m_debugMode & (DBG_DrawConstraints | DBG_DrawConstraintLimits))
+		{
+			for (int i = 0; i < world->getNumConstraints(); i++)
+			{
+				btTypedConstraint* constraint = world->getConstraint(i);
+				if (InRange(constraint->getRigidBodyA().getWorldTransform().getOrigin(), 0.0f))
+				{
+					world->debugDrawConstraint(constraint);
+				}
+			}
+		}
+
+		if (m_frame % PHYSICS_DEBUG_WIREFRAME_FRAMES == 0)
+		{
+			Wireframes_ReleaseUnused();
+		}
+	}
+
+	void PhysicsDebugDraw::DrawShape(btDiscreteDynamicsWorld* world, const btTransform& transform, const btCollisionShape* shape, const btVector3& colorBt)
+	{
+		auto debugDraw	= m_renderer->GetDebugDraw();
+		Vector4 color	= ToVector4(colorBt);
+		Matrix matrix	= _PhysicsDebugDraw::ToMatrix(transform);
+
+		// With the scaling in the dimensions Bullet reports, the primitives are unit ones
+		switch (shape->getShapeType())
+		{
+			case COMPOUND_SHAPE_PROXYTYPE:
+			{
+				auto compound = static_cast<const btCompoundShape*>(shape);
+				for (int i = compound->getNumChildShapes() - 1; i >= 0; i--)
+				{
+					DrawShape(world, transform * compound->getChildTransform(i), compound->getChildShape(i), colorBt);
+				}
+				return;
+			}
+
+			case BOX_SHAPE_PROXYTYPE:
+			{
+				btVector3 extents = static_cast<const btBoxShape*>(shape)->getHalfExtentsWithMargin();
+				debugDraw->Box(Matrix::CreateScale(ToVector3(extents)) * matrix, color);
+				return;
+			}
+
+			case SPHERE_SHAPE_PROXYTYPE:
+			{
+				debugDraw->Sphere(ToVector3(transform.getOrigin()), static_cast<const btSphereShape*>(shape)->getRadius(), color);
+				return;
+			}
+
+			case CYLINDER_SHAPE_PROXYTYPE:
+			{
+				auto cylinder = static_cast<const btCylinderShape*>(shape);
+				if (cylinder->getUpAxis() != 1)
+					break;
+
+				debugDraw->Cylinder(Matrix::CreateScale(ToVector3(cylinder->getHalfExtentsWithMargin())) * matrix, color);
+				return;
+			}
+
+			case CAPSULE_SHAPE_PROXYTYPE:
+			{
+				auto capsule = static_cast<const btCapsuleShape*>(shape);
+				if (capsule->getUpAxis() != 1)
+					break;
+
+				float radius		= capsule->getRadius();
+				float halfHeight	= capsule->getHalfHeight();
+				debugDraw->Cylinder(Matrix::CreateScale(Vector3(radius, halfHeight, radius)) * matrix, color);
+				debugDraw->Sphere(ToVector3(transform * btVector3(0.0f, halfHeight, 0.0f)), radius, color);
+				debugDraw->Sphere(ToVector3(transform * btVector3(0.0f, -halfHeight, 0.0f)), radius, color);
+				return;
+			}
+
+			case CONE_SHAPE_PROXYTYPE:
+			{
+				auto cone = static_cast<const btConeShape*>(shape);
+				if (cone->getConeUpIndex() != 1)
+					break;
+
+				float radius = cone->getRadius();
+				debugDraw->Cone(Matrix::CreateScale(Vector3(radius, cone->getHeight() * 0.5f, radius)) * matrix, color);
+				return;
+			}
+
+			case CONVEX_HULL_SHAPE_PROXYTYPE:
+			{
+				if (uint64_t key = Wireframe_Get(shape))
+				{
+					debugDraw->Wireframe(key, matrix, color);
+					return;
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		// One line at a time
+		world->debugDrawObject(transform, shape, colorBt);
+	}
+
+	uint64_t PhysicsDebugDraw::Wireframe_Get(const btCollisionShape* shape)
+	{
+		const btConvexPolyhedron* polyhedron = static_cast<const btPolyhedralConvexShape*>(shape)->getConvexPolyhedron();
+		if (!polyhedron || polyhedron->m_vertices.size() == 0)
+			return 0;
+
+		// A shape that's freed and another one allocated in it's place doesn't pick up the old wireframe
+		uint64_t key = (uint64_t)(uintptr_t)shape;
+		_PhysicsDebugDraw::HashCombine(key, (uint64_t)polyhedron->m_vertices.size());
+		_PhysicsDebugDraw::HashCombine(key, (uint64_t)polyhedron->m_faces.size());
+		_PhysicsDebugDraw::HashCombine(key, hash<float>()(polyhedron->m_vertices[0].getX() + polyhedron->m_vertices[0].getY() + polyhedron->m_vertices[0].getZ()));
+		key = key ? key : 1;
+
+		auto it = m_wireframes.find(key);
+		if (it != m_wireframes.end())
+		{
+			it->second = m_frame;
+			return key;
+		}
+
+		// The edges of the faces, once each
+		vector<Vector3> points;
+		points.reserve(polyhedron->m_vertices.size());
+		for (int i = 0; i < polyhedron->m_vertices.size(); i++)
+		{
+			points.emplace_back(ToVector3(polyhedron->m_vertices[i]));
+		}
+
+		set<pair<int, int>> edges;
+		vector<unsigned int> indices;
+		for (int i = 0; i < polyhedron->m_faces.size(); i++)
+		{
+			const auto& face = polyhedron->m_faces[i].m_indices;
+			for (int j = 0; j < face.size(); j++)
+			{
+				int a = face[j];
+				int b = face[(j + 1) % face.size()];
+				if (edges.emplace(min(a, b), max(a, b)).second)
+				{
+					indices.emplace_back((unsigned int)a);
+					indices.emplace_back((unsigned int)b);
+				}
+			}
+		}
+
+		m_renderer->GetDebugDraw()->Wireframe_Create(key, points, indices);
+		m_wireframes[key] = m_frame;
+		return key;
+	}
+
+	void PhysicsDebugDraw::Wireframes_ReleaseUnused()
+	{
+		for (auto it = m_wireframes.begin(); it != m_wireframes.end();)
+		{
+			if (m_frame - it->second >= PHYSICS_DEBUG_WIREFRAME_FRAMES)
+			{
+				m_renderer->GetDebugDraw()->Wireframe_Release(it->first);
+				it = m_wireframes.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
 }
@@ -22,12 +22,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ==========================
+#include <unordered_map>
+#include "../Math/Vector3.h"
 // Hide warnings which belong to Bullet
 #pragma warning(push, 0)   
 #include <LinearMath/btIDebugDraw.h>
 #pragma warning(pop)
 //=====================================
 
+class btCollisionShape;
+class btDiscreteDynamicsWorld;
+class btTransform;
+
 namespace Directus
 {
 	class Renderer;
@@ -48,8 +54,18 @@ namespace Directus
 		int getDebugMode() const override			{ return m_debugMode; }
 		//=============================================================================================================================================
 
+		// Draws the world near the eye as instanced primitives (see DebugDraw), shapes without one are drawn through drawLine()
+		void DrawWorld(btDiscreteDynamicsWorld* world, const Math::Vector3& eye);
+
 	private:
+		void DrawShape(btDiscreteDynamicsWorld* world, const btTransform& transform, const btCollisionShape* shape, const btVector3& color);
+		// The key of the wireframe of a convex hull, created the first time it's drawn. 0 if it has no polyhedral features.
+		uint64_t Wireframe_Get(const btCollisionShape* shape);
+		void Wireframes_ReleaseUnused();
+
 		Renderer* m_renderer;
 		int m_debugMode;
+		std::unordered_map<uint64_t, unsigned int> m_wireframes; // the frame each was last drawn in
+		unsigned int m_frame = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+//= INCLUDES ==============
+#include "MemoryTracker.h"
+#include <atomic>
+#include <malloc.h>
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	namespace _MemoryTracker
+	{
+		// Kept apart so threads allocating under different tags don't share a cache line
+		struct alignas(64) Counters
+		{
+			atomic<size_t> bytesLive			= 0;
+			atomic<size_t> bytesPeak			= 0;
+			atomic<uint64_t> allocations		= 0;
+			atomic<unsigned int> frameAllocations	= 0;
+			atomic<size_t> frameBytes			= 0;
+			// What the last frame allocated, set when the next one starts
+			atomic<unsigned int> lastFrameAllocations	= 0;
+			atomic<size_t> lastFrameBytes				= 0;
+		};
+
+		// Right in front of the allocation, 16 bytes so what follows it keeps the default alignment
+		struct Header
+		{
+			size_t size;
+			uint32_t tag;
+			uint32_t offset; // from the start of the block to the allocation
+		};
+		static_assert(sizeof(Header) == 16, "The header has to keep allocations 16 byte aligned");
+
+		Counters counters[MemoryTag_Count];
+		thread_local MemoryTag tag = MemoryTag_Untagged;
+
+		const char* names[MemoryTag_Count] =
+		{
+			"Untagged",
+			"Renderer",
+			"World",
+			"Physics",
+			"Scripting",
+			"Resource"
+		};
+	}
+
+	bool MemoryTracker::IsEnabled()
+	{
+#ifdef MEMORY_TRACKING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void* MemoryTracker::Allocate(size_t size, size_t alignment)
+	{
+		// Nothing in here may allocate, it would come right back
+		alignment		= alignment > sizeof(_MemoryTracker::Header) ? alignment : sizeof(_MemoryTracker::Header);
+		auto block		= (char*)_aligned_malloc(size + alignment, alignment);
+		if (!block)
+			return nullptr;
+
+		auto allocation	= block + alignment;
+		auto header		= (_MemoryTracker::Header*)allocation - 1;
+		header->size	= size;
+		header->tag		= (uint32_t)_MemoryTracker::tag;
+		header->offset	= (uint32_t)alignment;
+
+		auto& counters	= _MemoryTracker::counters[header->tag];
+		size_t live		= counters.bytesLive.fetch_add(size, memory_order_relaxed) + size;
+		size_t peak		= counters.bytesPeak.load(memory_order_relaxed);
+		while (live > peak && !counters.bytesPeak.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+		counters.allocations.fetch_add(1, memory_order_relaxed);
+		counters.frameAllocations.fetch_add(1, memory_order_relaxed);
+		counters.frameBytes.fetch_add(size, memory_order_relaxed);
+
+		return allocation;
+	}
+
+	void MemoryTracker::Free(void* ptr)
+	{
+		if (!ptr)
+			return;
+
+		// Taken off the tag it was allocated under, whichever thread frees it
+		auto header = (_MemoryTracker::Header*)ptr - 1;
+		_MemoryTracker::counters[header->tag].bytesLive.fetch_sub(header->size, memory_order_relaxed);
+		_aligned_free((char*)ptr - header->offset);
+	}
+
+	void MemoryTracker::Frame_Begin()
+	{
+		for (auto& counters : _MemoryTracker::counters)
+		{
+			counters.lastFrameAllocations	= counters.frameAllocations.exchange(0, memory_order_relaxed);
+			counters.lastFrameBytes			= counters.frameBytes.exchange(0, memory_order_relaxed);
+		}
+	}
+
+	MemoryTag_Stats MemoryTracker::GetStats(MemoryTag tag)
+	{
+		MemoryTag_Stats stats;
+		if (tag >= MemoryTag_Count)
+			return stats;
+
+		const auto& counters	= _MemoryTracker::counters[tag];
+		stats.bytesLive			= counters.bytesLive.load(memory_order_relaxed);
+		stats.bytesPeak			= counters.bytesPeak.load(memory_order_relaxed);
+		stats.allocations		= counters.allocations.load(memory_order_relaxed);
+		stats.allocationsFrame	= counters.lastFrameAllocations.load(memory_order_relaxed);
+		stats.bytesFrame		= counters.lastFrameBytes.load(memory_order_relaxed);
+		return stats;
+	}
+
+	const char* MemoryTracker::GetTagName(MemoryTag tag)
+	{
+		return tag < MemoryTag_Count ? _MemoryTracker::names[tag] : "Unknown";
+	}
+
+	MemoryTag MemoryTracker::GetTag()
+	{
+		return _MemoryTracker::tag;
+	}
+
+	void MemoryTracker::SetTag(MemoryTag tag)
+	{
+		_MemoryTracker::tag = tag < MemoryTag_Count ? tag : MemoryTag_Untagged;
+	}
+}
+
+// The engine's new and delete, any module that frees what the engine allocates (or the other way around) replaces them too
+MEMORY_TRACKING_OPERATORS()
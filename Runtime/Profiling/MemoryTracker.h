@@ -0,0 +1,132 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES ==================
+#include "../Core/EngineDefs.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+//=============================
+
+// Uncomment to replace the engine's global new and delete with ones that count every allocation per tag. The engine
+// is a DLL and each module has it's own, so a module that shares allocations with the engine (the editor deletes what
+// the engine creates) adds MEMORY_TRACKING_OPERATORS() to one of it's source files. Third party DLLs keep their own.
+//#define MEMORY_TRACKING
+
+#ifdef MEMORY_TRACKING
+// Attributes the calling thread's allocations to a subsystem until the end of the scope
+#define MEMORY_TAG(tag) Directus::MemoryTag_Scoped memoryTagScoped(tag);
+
+// Replaces the module's global new and delete, a failed allocation throws like the standard ones do (but the nothrow ones)
+#define MEMORY_TRACKING_OPERATORS()																																		\
+	static void* MemoryTracker_New(size_t size, size_t alignment)																										\
+	{																																									\
+		if (auto ptr = Directus::MemoryTracker::Allocate(size ? size : 1, alignment))																					\
+			return ptr;																																					\
+		throw std::bad_alloc();																																			\
+	}																																									\
+	void* operator new(size_t size)																		{ return MemoryTracker_New(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }		\
+	void* operator new[](size_t size)																	{ return MemoryTracker_New(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }		\
+	void* operator new(size_t size, std::align_val_t alignment)											{ return MemoryTracker_New(size, (size_t)alignment); }						\
+	void* operator new[](size_t size, std::align_val_t alignment)										{ return MemoryTracker_New(size, (size_t)alignment); }						\
+	void* operator new(size_t size, const std::nothrow_t&) noexcept										{ return Directus::MemoryTracker::Allocate(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }	\
+	void* operator new[](size_t size, const std::nothrow_t&) noexcept									{ return Directus::MemoryTracker::Allocate(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }	\
+	void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept			{ return Directus::MemoryTracker::Allocate(size ? size : 1, (size_t)alignment); }	\
+	void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept		{ return Directus::MemoryTracker::Allocate(size ? size : 1, (size_t)alignment); }	\
+	void operator delete(void* ptr) noexcept															{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete[](void* ptr) noexcept															{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete(void* ptr, size_t) noexcept													{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete[](void* ptr, size_t) noexcept													{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete(void* ptr, std::align_val_t) noexcept											{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete[](void* ptr, std::align_val_t) noexcept										{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete(void* ptr, size_t, std::align_val_t) noexcept									{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete[](void* ptr, size_t, std::align_val_t) noexcept								{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete(void* ptr, const std::nothrow_t&) noexcept										{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete[](void* ptr, const std::nothrow_t&) noexcept									{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept					{ Directus::MemoryTracker::Free(ptr); }		\
+	void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept					{ Directus::MemoryTracker::Free(ptr); }
+#else
+#define MEMORY_TAG(tag)
+#define MEMORY_TRACKING_OPERATORS()
+#endif
+
+namespace Directus
+{
+	enum MemoryTag
+	{
+		MemoryTag_Untagged,
+		MemoryTag_Renderer,
+		MemoryTag_World,
+		MemoryTag_Physics,
+		MemoryTag_Scripting,
+		MemoryTag_Resource,
+		MemoryTag_Count
+	};
+
+	struct MemoryTag_Stats
+	{
+		size_t bytesLive				= 0;
+		size_t bytesPeak				= 0;	// the most that was live at once
+		uint64_t allocations			= 0;	// since startup
+		unsigned int allocationsFrame	= 0;	// during the last frame
+		size_t bytesFrame				= 0;
+	};
+
+	class ENGINE_CLASS MemoryTracker
+	{
+	public:
+		// Whether the engine was built with MEMORY_TRACKING, there is nothing to show otherwise
+		static bool IsEnabled();
+
+		// Every allocation carries it's size and tag in front of it, so frees know what to take off
+		static void* Allocate(size_t size, size_t alignment);
+		static void Free(void* ptr);
+
+		// Closes the frame's allocation counts, the profiler calls it when a frame starts
+		static void Frame_Begin();
+
+		static MemoryTag_Stats GetStats(MemoryTag tag);
+		static const char* GetTagName(MemoryTag tag);
+
+		// The calling thread's tag, see MEMORY_TAG
+		static MemoryTag GetTag();
+		static void SetTag(MemoryTag tag);
+	};
+
+	class MemoryTag_Scoped
+	{
+	public:
+		MemoryTag_Scoped(MemoryTag tag)
+		{
+			m_previous = MemoryTracker::GetTag();
+			MemoryTracker::SetTag(tag);
+		}
+
+		~MemoryTag_Scoped()
+		{
+			MemoryTracker::SetTag(m_previous);
+		}
+
+	private:
+		MemoryTag m_previous;
+	};
+}
@@ -26,11 +26,20 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/EventSystem.h"
 #include "../World/World.h"
 #include "../Rendering/Renderer.h"
-#include <iomanip>
-#include <sstream>
+#include <cstring>
+#include <cstdio>
 #include "../RHI/RHI_Device.h"
 #include "../Core/Variant.h"
+#include "../Core/Context.h"
+#include "../World/PoolAllocator.h"
 #include "../Resource/ResourceManager.h"
+#include "../Threading/Threading.h"
+#include "MemoryTracker.h"
+#include "ProfilerRemote.h"
+#include "../Logging/Log.h"
+#include <fstream>
+#include <algorithm>
+#include <cmath>
 //======================================
 
 //= NAMESPACES =============
@@ -40,16 +49,80 @@ using namespace std::chrono;
 
 namespace Directus
 {
+	namespace _Profiler
+	{
+		thread_local shared_ptr<TimeBlocks_Thread> timeBlocks;
+
+		inline int64_t Microseconds(steady_clock::duration duration) { return duration_cast<microseconds>(duration).count(); }
+
+		// In Stat order
+		const char* statNames[] =
+		{
+			"FPS",
+			"Frame time (ms)",
+			"CPU time (ms)",
+			"GPU time (ms)",
+			"Meshes rendered",
+			"Draw calls",
+			"Index buffer bindings",
+			"Vertex buffer bindings",
+			"Constant buffer bindings",
+			"Sampler bindings",
+			"Texture bindings",
+			"Vertex shader bindings",
+			"Pixel shader bindings",
+			"Render target bindings",
+			"GPU memory (MB)",
+			"Heap (MB)",
+			"Allocations per frame",
+			"Tasks",
+			"Tasks stolen",
+			"Task latency avg (ms)",
+			"Task latency max (ms)",
+			"Task queue depth",
+			"Workers busy (%)",
+			"Physics (ms)",
+			"Physics bodies reduced",
+			"Physics bodies frozen",
+			"Audio voices",
+			"Audio voices real"
+		};
+		static_assert(sizeof(statNames) / sizeof(statNames[0]) == Stat_Count, "A stat is missing it's name");
+
+		// Function names don't need it, but a named scope could have anything in it
+		void AppendEscaped(string& json, const char* text)
+		{
+			for (; *text; text++)
+			{
+				if (*text == '"' || *text == '\\') json += '\\';
+				if ((unsigned char)*text >= 0x20) json += *text;
+			}
+		}
+	}
+
 	Profiler::Profiler()
 	{
 		m_metrics					= NOT_ASSIGNED;
 		m_scene						= nullptr;
 		m_timer						= nullptr;
 		m_resourceManager			= nullptr;
-		m_gpuProfiling				= true;	// expensive
+		m_threading					= nullptr;
+		m_threadingStats			= make_shared<ThreadingStats>();
+		m_remoteFrame				= make_shared<ProfilerRemote_Frame>();
+		m_gpuProfiling				= true;	// cheap, read back a few frames late
 		m_cpuProfiling				= true;	// cheap
 		m_profilingFrequencySec		= 0.0f;
 		m_profilingLastUpdateTime	= 0;
+		m_frame						= 0;
+		m_capturing					= false;
+		m_captureFrameCount			= 0;
+		m_captureRecording			= false;
+		m_spikeBudgetMs				= 0.0f;
+		m_spikesCaptured			= 0;
+		m_timelineStart				= steady_clock::now();
+		m_timelineFrameStart		= 0;
+		m_timelineFrameNext			= 0;
+		m_timelineFrameCount		= 0;
 		m_fps						= 0.0f;
 		m_timePassed				= 0.0f;
 		m_frameCount				= 0;
@@ -57,13 +130,23 @@ namespace Directus
 
 	void Profiler::Initialize(Context* context)
 	{
+		m_context					= context;
 		m_scene						= context->GetSubsystem<World>();
 		m_timer						= context->GetSubsystem<Timer>();
 		m_resourceManager			= context->GetSubsystem<ResourceManager>();
-		m_rhiDevice					= context->GetSubsystem<Renderer>()->GetRHIDevice();
+		m_threading					= context->GetSubsystem<Threading>();
+		auto renderer				= context->GetSubsystem<Renderer>();
+		m_rhiDevice					= renderer ? renderer->GetRHIDevice() : nullptr;
+		m_gpuProfiling				= m_gpuProfiling && m_rhiDevice; // headless, there is no GPU to profile
 		m_profilingFrequencySec		= 0.35f;
 		m_profilingLastUpdateTime	= m_profilingFrequencySec;
 
+		// Builds without the editor can be profiled from another machine
+		if (unsigned int port = Settings::Get().ProfilerPort_Get())
+		{
+			ProfilerRemote::Server_Start((unsigned short)port);
+		}
+
 		// Subscribe to events
 		SUBSCRIBE_TO_EVENT(EVENT_FRAME_START, EVENT_HANDLER(OnFrameStart));
 		SUBSCRIBE_TO_EVENT(EVENT_FRAME_END, EVENT_HANDLER(OnFrameEnd));
@@ -71,27 +154,503 @@ namespace Directus
 
 	void Profiler::TimeBlockStart_CPU(const char* funcName)
 	{
-		if (!m_cpuProfiling || !m_shouldUpdate)
+		if (!m_cpuProfiling)
 			return;
 
-		m_timeBlocks_cpu[funcName].start = high_resolution_clock::now();
+		auto& timeBlocks = GetTimeBlocks_Thread();
+		if (timeBlocks.depth < TIME_BLOCK_DEPTH_MAX)
+		{
+			timeBlocks.stack[timeBlocks.depth++] = make_pair(funcName, steady_clock::now());
+		}
 	}
 
 	void Profiler::TimeBlockEnd_CPU(const char* funcName)
 	{
-		if (!m_cpuProfiling || !m_shouldUpdate)
+		if (!m_cpuProfiling)
 			return;
 
-		auto timeBlock = &m_timeBlocks_cpu[funcName];
+		auto end			= steady_clock::now();
+		auto& timeBlocks	= GetTimeBlocks_Thread();
+
+		// Unwinds to the matching start, so a start that never got it's end (an early return) doesn't misplace the rest
+		unsigned int depth = timeBlocks.depth;
+		while (depth > 0 && timeBlocks.stack[depth - 1].first != funcName)
+		{
+			depth--;
+		}
+		if (depth == 0)
+			return;
+
+		depth--;
+		auto start			= timeBlocks.stack[depth].second;
+		timeBlocks.depth	= depth;
+
+		// Every frame is recorded, the history needs each of them
+		lock_guard<mutex> lock(timeBlocks.mutex);
+		{
+			// Repeated calls add up, the first call of a frame starts over
+			auto& timeBlock = timeBlocks.blocks[funcName];
+			uint64_t frame	= m_frame;
+			if (timeBlock.frame != frame)
+			{
+				timeBlock.duration	= 0.0f;
+				timeBlock.calls		= 0;
+				timeBlock.frame		= frame;
+			}
+
+			duration<double, milli> ms	= end - start;
+			timeBlock.start				= start;
+			timeBlock.end				= end;
+			timeBlock.duration			+= (float)ms.count();
+			timeBlock.calls++;
+			timeBlock.depth				= depth;
+			timeBlock.parent			= depth ? timeBlocks.stack[depth - 1].first : nullptr;
+		}
+
+		if (m_capturing && timeBlocks.events.size() < TIME_BLOCK_CAPTURE_EVENTS_MAX)
+		{
+			timeBlocks.events.push_back({ funcName, _Profiler::Microseconds(start - m_captureStart), _Profiler::Microseconds(end - start), depth });
+		}
+
+		// The timeline, this thread is its only writer
+		uint64_t head = timeBlocks.timelineHead.load(memory_order_relaxed);
+		timeBlocks.timeline[head % PROFILER_TIMELINE_EVENTS] = { funcName, _Profiler::Microseconds(start - m_timelineStart), _Profiler::Microseconds(end - start), depth };
+		timeBlocks.timelineHead.store(head + 1, memory_order_release);
+	}
+
+	void Profiler::Timeline_Copy(int64_t from, int64_t to, vector<Timeline_Thread>& threads)
+	{
+		lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+		threads.resize(m_timeBlocks_cpu.size());
+		for (size_t i = 0; i < m_timeBlocks_cpu.size(); i++)
+		{
+			const auto& timeBlocks	= *m_timeBlocks_cpu[i];
+			auto& thread			= threads[i];
+			thread.thread			= timeBlocks.thread;
+			thread.name				= timeBlocks.name;
+			thread.events.clear();
+
+			// The slot at head - PROFILER_TIMELINE_EVENTS is the one the thread writes next, so it's skipped
+			uint64_t head = timeBlocks.timelineHead.load(memory_order_acquire);
+			uint64_t tail = head >= PROFILER_TIMELINE_EVENTS ? head - PROFILER_TIMELINE_EVENTS + 1 : 0;
+			for (uint64_t index = tail; index < head; index++)
+			{
+				TimeBlock_Event event = timeBlocks.timeline[index % PROFILER_TIMELINE_EVENTS];
+
+				// Read before the head is, if it moved a lap past the event it may have been written over while it was read
+				atomic_thread_fence(memory_order_acquire);
+				if (timeBlocks.timelineHead.load(memory_order_relaxed) - index >= PROFILER_TIMELINE_EVENTS)
+					continue;
+
+				if (event.start <= to && event.start + event.duration >= from)
+				{
+					thread.events.push_back(event);
+				}
+			}
+		}
+	}
+
+	float Profiler::GetTimeBlockMs_CPU(const char* funcName)
+	{
+		float duration = 0.0f;
+		lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+		for (const auto& timeBlocks : m_timeBlocks_cpu)
+		{
+			lock_guard<mutex> lockThread(timeBlocks->mutex);
+			auto it = timeBlocks->blocks.find(funcName);
+			if (it != timeBlocks->blocks.end())
+			{
+				duration = max(duration, it->second.duration);
+			}
+		}
+
+		return duration;
+	}
+
+	vector<TimeBlocks_ThreadCopy> Profiler::GetTimeBlocks_CPU()
+	{
+		vector<TimeBlocks_ThreadCopy> blocks;
+		lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+		for (const auto& timeBlocks : m_timeBlocks_cpu)
+		{
+			lock_guard<mutex> lockThread(timeBlocks->mutex);
+			blocks.push_back({ timeBlocks->thread, timeBlocks->name, timeBlocks->blocks });
+		}
+
+		return blocks;
+	}
+
+	TimeBlocks_Thread& Profiler::GetTimeBlocks_Thread()
+	{
+		// Registered on the thread's first block, the profiler keeps them after the thread exits
+		if (!_Profiler::timeBlocks)
+		{
+			_Profiler::timeBlocks			= make_shared<TimeBlocks_Thread>();
+			_Profiler::timeBlocks->timeline	= make_unique<TimeBlock_Event[]>(PROFILER_TIMELINE_EVENTS);
+			lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+			_Profiler::timeBlocks->thread	= (unsigned int)m_timeBlocks_cpu.size();
+			_Profiler::timeBlocks->name		= Threading::GetThreadName();
+			if (_Profiler::timeBlocks->name.empty())
+			{
+				_Profiler::timeBlocks->name = "Thread " + to_string(_Profiler::timeBlocks->thread);
+			}
+			m_timeBlocks_cpu.emplace_back(_Profiler::timeBlocks);
+		}
+
+		return *_Profiler::timeBlocks;
+	}
 
-		timeBlock->end				= high_resolution_clock::now();
-		duration<double, milli> ms	= timeBlock->end - timeBlock->start;
-		timeBlock->duration			= (float)ms.count();
+	bool Profiler::Capture_Start(unsigned int frames, const string& filePath)
+	{
+		if (frames == 0 || Capture_IsRunning())
+			return false;
+
+		m_captureFrameCount	= frames;
+		m_capturePath		= filePath;
+		return true;
+	}
+
+	void Profiler::Capture_Frame()
+	{
+		if (m_capturing && ProfilerRemote::Server_HasClient())
+		{
+			Remote_Send();
+		}
+
+		if (m_capturing)
+		{
+			if (m_captureRecording)
+			{
+				// Ends once the requested frames have been recorded, the scopes that are still open go without
+				if (m_captureFrames.size() >= m_captureFrameCount)
+				{
+					Capture_Write(m_capturePath);
+					m_captureRecording	= false;
+					m_captureFrameCount	= 0;
+				}
+			}
+			else if (m_spikeBudgetMs > 0.0f && m_frameTime > m_spikeBudgetMs && m_spikesCaptured < PROFILER_SPIKE_CAPTURES_MAX)
+			{
+				// Watching for spikes, only what was recorded since the last frame started is there
+				Capture_Write("profiler_spike_" + to_string(m_frame) + ".json");
+				m_spikesCaptured++;
+			}
+
+			if (!m_captureRecording)
+			{
+				Capture_Clear();
+			}
+		}
+
+		// A requested capture starts clean, even if the frame before was watched for spikes
+		if (m_captureFrameCount && !m_captureRecording)
+		{
+			Capture_Clear();
+			m_captureRecording = true;
+		}
+
+		bool capturing = m_captureRecording || m_spikeBudgetMs > 0.0f || ProfilerRemote::Server_HasClient();
+		if (capturing && !m_capturing)
+		{
+			m_captureStart = steady_clock::now();
+		}
+		m_capturing = capturing;
+
+		if (m_capturing)
+		{
+			m_captureFrames.emplace_back(_Profiler::Microseconds(steady_clock::now() - m_captureStart));
+		}
+	}
+
+	void Profiler::Capture_Clear()
+	{
+		lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+		for (const auto& timeBlocks : m_timeBlocks_cpu)
+		{
+			lock_guard<mutex> lockThread(timeBlocks->mutex);
+			timeBlocks->events.clear();
+			timeBlocks->eventsStreamed = 0;
+		}
+		m_captureFrames.clear();
+	}
+
+	void Profiler::Remote_Send()
+	{
+		// The frame that just ended, what was recorded since the last one was sent (a requested capture keeps it's events)
+		auto& frame			= *m_remoteFrame;
+		int64_t frameStart	= m_captureFrames.empty() ? 0 : m_captureFrames.back();
+		frame.frame			= m_frame;
+		for (unsigned int i = 0; i < Stat_Count; i++)
+		{
+			frame.stats[i] = m_stats[i].GetLast();
+		}
+
+		{
+			lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+			frame.threads.resize(m_timeBlocks_cpu.size());
+			for (unsigned int i = 0; i < (unsigned int)m_timeBlocks_cpu.size(); i++)
+			{
+				auto& timeBlocks	= *m_timeBlocks_cpu[i];
+				auto& thread		= frame.threads[i];
+				thread.thread		= timeBlocks.thread;
+				thread.name			= ProfilerRemote::Server_GetNameID(timeBlocks.name.c_str());
+				thread.events.clear();
+
+				lock_guard<mutex> lockThread(timeBlocks.mutex);
+				for (size_t j = timeBlocks.eventsStreamed; j < timeBlocks.events.size(); j++)
+				{
+					const auto& event = timeBlocks.events[j];
+					thread.events.push_back({ ProfilerRemote::Server_GetNameID(event.name), event.start - frameStart, event.duration, event.depth });
+				}
+				timeBlocks.eventsStreamed = timeBlocks.events.size();
+			}
+		}
+
+		ProfilerRemote::Server_Send(frame);
+	}
+
+	void Profiler::Capture_Write(const string& filePath)
+	{
+		string json;
+		json.reserve(1024 * 1024);
+		char line[128];
+		unsigned int events = 0;
+
+		// Frames are instant events across every thread, scopes are complete events (a start and a duration)
+		json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		for (unsigned int i = 0; i < (unsigned int)m_captureFrames.size(); i++)
+		{
+			snprintf(line, sizeof(line), "{\"name\":\"Frame %u\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%lld},\n", i, (long long)m_captureFrames[i]);
+			json += line;
+		}
+
+		{
+			lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+			for (const auto& timeBlocks : m_timeBlocks_cpu)
+			{
+				lock_guard<mutex> lockThread(timeBlocks->mutex);
+				if (timeBlocks->events.empty())
+					continue;
+
+				json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" + to_string(timeBlocks->thread) + ",\"args\":{\"name\":\"";
+				_Profiler::AppendEscaped(json, timeBlocks->name.c_str());
+				json += "\"}},\n";
+
+				for (const auto& event : timeBlocks->events)
+				{
+					json += "{\"name\":\"";
+					_Profiler::AppendEscaped(json, event.name);
+					snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%lld,\"dur\":%lld},\n", timeBlocks->thread, (long long)event.start, (long long)event.duration);
+					json += line;
+				}
+				events += (unsigned int)timeBlocks->events.size();
+			}
+		}
+
+		// Drop the dangling comma
+		if (json.size() >= 2 && json[json.size() - 2] == ',')
+		{
+			json.erase(json.size() - 2, 1);
+		}
+		json += "]}\n";
+
+		ofstream file(filePath, ios::out | ios::binary | ios::trunc);
+		if (!file.is_open())
+		{
+			LOGF_ERROR("Profiler::Capture_Write: Failed to write \"%s\"", filePath.c_str());
+			return;
+		}
+		file.write(json.data(), json.size());
+		LOGF_INFO("Profiler::Capture_Write: %u scopes over %u frames written to \"%s\"", events, (unsigned int)m_captureFrames.size(), filePath.c_str());
+	}
+
+	void Profiler::History_Update()
+	{
+		m_history_frame.Add(m_frameTime);
+		m_history_cpu.Add(m_cpuTime);
+		m_history_gpu.Add(m_gpuTime);
+
+		// The blocks of the frame that just ended, a block that didn't run in it adds nothing
+		uint64_t frame = m_frame;
+		{
+			lock_guard<mutex> lock(m_timeBlocksMutex_cpu);
+			for (const auto& timeBlocks : m_timeBlocks_cpu)
+			{
+				lock_guard<mutex> lockThread(timeBlocks->mutex);
+				for (const auto& block : timeBlocks->blocks)
+				{
+					if (block.second.frame != frame)
+						continue;
+
+					auto& longest	= m_history_blocks[block.first].first;
+					longest			= max(longest, block.second.duration);
+				}
+			}
+		}
+
+		// Blocks timed on the GPU as well, before the longest times reset for the next frame
+		m_statsPasses.clear();
+		for (const auto& entry : m_timeBlocks_gpu)
+		{
+			auto it = m_history_blocks.find(entry.first);
+			m_statsPasses.push_back({ entry.first, it != m_history_blocks.end() ? it->second.first : 0.0f, entry.second.duration });
+		}
+
+		for (auto& entry : m_history_blocks)
+		{
+			auto& longest = entry.second.first;
+			if (longest > 0.0f)
+			{
+				entry.second.second.Add(longest);
+				longest = 0.0f;
+			}
+		}
+	}
+
+	void Profiler::Timeline_Update()
+	{
+		int64_t now		= _Profiler::Microseconds(steady_clock::now() - m_timelineStart);
+		auto& frame		= m_timelineFrames[m_timelineFrameNext];
+		frame.frame		= m_frame;
+		frame.start		= m_timelineFrameStart;
+		frame.duration	= now - m_timelineFrameStart;
+		frame.cpuMs		= m_cpuTime;
+		frame.gpuMs		= m_gpuTime;
+		frame.passCount	= 0;
+		for (const auto& pass : m_statsPasses)
+		{
+			if (frame.passCount == PROFILER_TIMELINE_PASSES_MAX)
+				break;
+
+			frame.passes[frame.passCount++] = { pass.name, pass.gpuMs };
+		}
+
+		m_timelineFrameNext		= (m_timelineFrameNext + 1) % PROFILER_TIMELINE_FRAMES;
+		m_timelineFrameCount	= m_timelineFrameCount < PROFILER_TIMELINE_FRAMES ? m_timelineFrameCount + 1 : m_timelineFrameCount;
+		m_timelineFrameStart	= now;
+	}
+
+	void Profiler::Stats_Update()
+	{
+		auto ToMB = [](unsigned long long bytes) { return (float)((double)bytes / (1024.0 * 1024.0)); };
+
+		// Time
+		m_stats[Stat_Fps].Add(m_fps);
+		m_stats[Stat_FrameMs].Add(m_frameTime);
+		m_stats[Stat_CpuMs].Add(m_cpuTime);
+		m_stats[Stat_GpuMs].Add(m_gpuTime);
+
+		// Renderer, the counters reset when rendering starts so they still hold the last frame's
+		m_stats[Stat_MeshesRendered].Add((float)m_rendererMeshesRendered.load());
+		m_stats[Stat_DrawCalls].Add((float)m_rhiDrawCalls.load());
+		m_stats[Stat_BindingsIndexBuffer].Add((float)m_rhiBindingsBufferIndex.load());
+		m_stats[Stat_BindingsVertexBuffer].Add((float)m_rhiBindingsBufferVertex.load());
+		m_stats[Stat_BindingsConstantBuffer].Add((float)m_rhiBindingsBufferConstant.load());
+		m_stats[Stat_BindingsSampler].Add((float)m_rhiBindingsSampler.load());
+		m_stats[Stat_BindingsTexture].Add((float)m_rhiBindingsTexture.load());
+		m_stats[Stat_BindingsVertexShader].Add((float)m_rhiBindingsVertexShader.load());
+		m_stats[Stat_BindingsPixelShader].Add((float)m_rhiBindingsPixelShader.load());
+		m_stats[Stat_BindingsRenderTarget].Add((float)m_rhiBindingsRenderTarget.load());
+
+		// Memory
+		size_t bytesLive				= 0;
+		unsigned int allocationsFrame	= 0;
+		if (MemoryTracker::IsEnabled())
+		{
+			for (unsigned int tag = 0; tag < MemoryTag_Count; tag++)
+			{
+				auto stats			= MemoryTracker::GetStats((MemoryTag)tag);
+				bytesLive			+= stats.bytesLive;
+				allocationsFrame	+= stats.allocationsFrame;
+			}
+		}
+		m_stats[Stat_MemoryGpuMb].Add(m_rhiDevice ? ToMB(m_rhiDevice->Memory_GetUsage()) : 0.0f);
+		m_stats[Stat_MemoryHeapMb].Add(ToMB(bytesLive));
+		m_stats[Stat_AllocationsFrame].Add((float)allocationsFrame);
+
+		// Threading
+		const auto& threading	= *m_threadingStats;
+		unsigned int tasks		= 0;
+		unsigned int steals		= 0;
+		unsigned int depth		= 0;
+		float busyMs			= 0.0f;
+		float elapsedMs			= 0.0f;
+		for (const auto& worker : threading.workers)
+		{
+			tasks		+= worker.tasks;
+			steals		+= worker.steals;
+			busyMs		+= worker.busyMs;
+			elapsedMs	+= worker.busyMs + worker.idleMs;
+		}
+		for (unsigned int group = 0; group < ThreadGroup_Count; group++)
+		{
+			depth = max(depth, threading.queueDepthMax[group]);
+		}
+		m_stats[Stat_Tasks].Add((float)tasks);
+		m_stats[Stat_TaskSteals].Add((float)steals);
+		m_stats[Stat_TaskLatencyAvgMs].Add(threading.latencyAvgMs);
+		m_stats[Stat_TaskLatencyMaxMs].Add(threading.latencyMaxMs);
+		m_stats[Stat_TaskQueueDepth].Add((float)depth);
+		m_stats[Stat_WorkersBusy].Add(elapsedMs > 0.0f ? busyMs / elapsedMs * 100.0f : 0.0f);
+
+		// Physics
+		m_stats[Stat_PhysicsMs].Add(m_physicsMs);
+		m_stats[Stat_PhysicsBodiesReduced].Add((float)m_physicsBodiesReduced);
+		m_stats[Stat_PhysicsBodiesFrozen].Add((float)m_physicsBodiesFrozen);
+
+		// Audio
+		m_stats[Stat_AudioVoices].Add((float)m_audioVoices);
+		m_stats[Stat_AudioVoicesReal].Add((float)m_audioVoicesReal);
+	}
+
+	const char* Profiler::GetStatName(Stat stat)
+	{
+		return stat < Stat_Count ? _Profiler::statNames[stat] : "Unknown";
+	}
+
+	TimePercentiles Profiler::GetPercentiles_Block(const char* funcName)
+	{
+		auto it = m_history_blocks.find(funcName);
+		return it != m_history_blocks.end() ? it->second.second.GetPercentiles() : TimePercentiles();
+	}
+
+	void TimeHistory::UpdatePercentiles()
+	{
+		if (m_count == 0)
+			return;
+
+		float sorted[PROFILER_HISTORY_FRAMES];
+		copy(m_samples, m_samples + m_count, sorted);
+		sort(sorted, sorted + m_count);
+
+		// Nearest rank
+		auto Percentile = [this, &sorted](float percentile)
+		{
+			auto rank = (unsigned int)ceil(percentile * m_count);
+			return sorted[rank > 0 ? rank - 1 : 0];
+		};
+		m_percentiles.p50	= Percentile(0.50f);
+		m_percentiles.p95	= Percentile(0.95f);
+		m_percentiles.p99	= Percentile(0.99f);
+		m_percentiles.max	= sorted[m_count - 1];
+	}
+
+	void TimeHistory::GetHistogram(float* buckets, unsigned int bucketCount, float maxMs) const
+	{
+		if (!buckets || bucketCount == 0 || maxMs <= 0.0f)
+			return;
+
+		fill(buckets, buckets + bucketCount, 0.0f);
+		for (unsigned int i = 0; i < m_count; i++)
+		{
+			auto bucket = (unsigned int)(m_samples[i] / maxMs * bucketCount);
+			buckets[bucket < bucketCount ? bucket : bucketCount - 1] += 1.0f;
+		}
 	}
 
 	void Profiler::TimeBlockStart_GPU(const char* funcName)
 	{
-		if (!m_gpuProfiling || !m_shouldUpdate)
+		if (!m_gpuProfiling)
 			return;
 
 		auto timeBlock = &m_timeBlocks_gpu[funcName];
@@ -111,15 +670,34 @@ namespace Directus
 
 	void Profiler::TimeBlockEnd_GPU(const char* funcName)
 	{
-		if (!m_gpuProfiling || !m_shouldUpdate)
+		if (!m_gpuProfiling)
 			return;
 
 		auto timeBlock = &m_timeBlocks_gpu[funcName];
+		if (!timeBlock->started)
+			return;
 
 		m_rhiDevice->Profiling_GetTimeStamp(timeBlock->time_end);
 		m_rhiDevice->Profiling_QueryEnd(timeBlock->query);
 	}
 
+	void Profiler::MarkerBegin(const char* funcName)
+	{
+		if (!m_rhiDevice)
+			return;
+
+		auto name = strrchr(funcName, ':');
+		m_rhiDevice->EventBegin(name ? name + 1 : funcName);
+	}
+
+	void Profiler::MarkerEnd()
+	{
+		if (!m_rhiDevice)
+			return;
+
+		m_rhiDevice->EventEnd();
+	}
+
 	void Profiler::TimeBlockStart_Multi(const char* funcName)
 	{
 		TimeBlockStart_CPU(funcName);
@@ -134,32 +712,42 @@ namespace Directus
 
 	void Profiler::OnFrameStart()
 	{
-		// Get delta time
-		m_frameTime			= m_timer->GetDeltaTimeMs();
-		float frameTimeSec	= m_timer->GetDeltaTimeSec();
+		// Get frame time, as it was rather than as the simulation saw it (fixed when headless or benchmarking)
+		m_frameTime			= m_timer->GetFrameTimeMs();
+		float frameTimeSec	= m_frameTime / 1000.0f;
 
 		// Compute FPS
 		ComputeFPS(frameTimeSec);
+		// What was allocated during the last frame
+		MemoryTracker::Frame_Begin();
+		// What the workers did during the last frame
+		if (m_threading)
+		{
+			m_threading->Stats_Collect(m_threadingStats.get());
+		}
 		// Get GPU render time
 		m_cpuTime = GetTimeBlockMs_CPU("Directus::Renderer::Render");
 		// Get CPU render time
 		m_gpuTime = GetTimeBlockMs_GPU("Directus::Renderer::Render");
+		// The frame that just ended, before the blocks move on to the next one
+		History_Update();
+		Stats_Update();
+		Timeline_Update();
+		Capture_Frame();
+		m_frame++;
 
 		// Below this point, update every m_profilingFrequencyMs
 		m_profilingLastUpdateTime += frameTimeSec;
 		if (m_profilingLastUpdateTime >= m_profilingFrequencySec)
 		{
 			UpdateMetrics(m_fps);
-			m_shouldUpdate				= true;
 			m_profilingLastUpdateTime	= 0.0f;
 		}
 	}
 
 	void Profiler::OnFrameEnd()
 	{
-		if (!m_shouldUpdate)
-			return;
-
+		// Reading back doesn't wait for the GPU, so it's done every frame (a frame the GPU isn't done with yet keeps the last duration)
 		for (auto& entry : m_timeBlocks_gpu)
 		{
 			auto& timeBlock = entry.second;
@@ -170,8 +758,6 @@ namespace Directus
 			}
 			timeBlock.started = false;
 		}
-
-		m_shouldUpdate = false;
 	}
 
 	void Profiler::UpdateMetrics(float fps)
@@ -180,32 +766,141 @@ namespace Directus
 		int materials	= m_resourceManager->GetResourceCountByType(Resource_Material);
 		int shaders		= m_resourceManager->GetResourceCountByType(Resource_Shader);
 
-		m_metrics =
-			// Performance
-			"FPS:\t\t\t\t\t\t\t"	+ to_string_precision(fps, 2) + "\n"
-			"Frame time:\t\t\t\t\t" + to_string_precision(m_frameTime, 2) + " ms\n"
-			"CPU time:\t\t\t\t\t\t" + to_string_precision(m_cpuTime, 2) + " ms\n"
-			"GPU time:\t\t\t\t\t\t" + to_string_precision(m_gpuTime, 2) + " ms\n"
-			"GPU:\t\t\t\t\t\t\t"	+ Settings::Get().Gpu_GetName() + "\n"
-			"VRAM:\t\t\t\t\t\t\t"	+ to_string(Settings::Get().Gpu_GetMemory()) + " MB\n"
-
-			// Renderer
-			"Resolution:\t\t\t\t\t"				+ to_string(int(Settings::Get().Resolution_GetWidth())) + "x" + to_string(int(Settings::Get().Resolution_GetHeight())) + "\n"
-			"Meshes rendered:\t\t\t\t"			+ to_string(m_rendererMeshesRendered) + "\n"
-			"Textures:\t\t\t\t\t\t"				+ to_string(textures) + "\n"
-			"Materials:\t\t\t\t\t\t"			+ to_string(materials) + "\n"
-			"Shaders:\t\t\t\t\t\t"				+ to_string(shaders) + "\n"
-
-			// RHI
-			"RHI Draw calls:\t\t\t\t\t"			+ to_string(m_rhiDrawCalls) + "\n"
-			"RHI Index buffer bindings:\t\t"	+ to_string(m_rhiBindingsBufferIndex) + "\n"
-			"RHI Vertex buffer bindings:\t"		+ to_string(m_rhiBindingsBufferVertex) + "\n"
-			"RHI Constant buffer bindings:\t"	+ to_string(m_rhiBindingsBufferConstant) + "\n"
-			"RHI Sampler bindings:\t\t\t"		+ to_string(m_rhiBindingsSampler) + "\n"
-			"RHI Texture bindings:\t\t\t"		+ to_string(m_rhiBindingsTexture) + "\n"
-			"RHI Vertex Shader bindings:\t"		+ to_string(m_rhiBindingsVertexShader) + "\n"
-			"RHI Pixel Shader bindings:\t\t"	+ to_string(m_rhiBindingsPixelShader) + "\n"
-			"RHI Render Target bindings:\t"		+ to_string(m_rhiBindingsRenderTarget) + "\n";
+		// Video memory, as tracked by the engine and as budgeted by the OS
+		auto ToMB = [](unsigned long long bytes) { return (double)bytes / (1024.0 * 1024.0); };
+		unsigned long long budget	= 0;
+		unsigned long long usage	= 0;
+		bool hasBudget				= m_rhiDevice && m_rhiDevice->Memory_GetBudget(&budget, &usage);
+
+		// Formatted into frame memory and copied over once, instead of concatenating dozens of temporary strings
+		FrameString metrics(m_context->GetFrameAllocatorSTL<char>());
+		metrics.reserve(2048);
+		char line[256];
+		auto Append = [&metrics, &line](const char* format, auto... values)
+		{
+			snprintf(line, sizeof(line), format, values...);
+			metrics += line;
+		};
+
+		// Performance
+		m_history_frame.UpdatePercentiles();
+		m_history_cpu.UpdatePercentiles();
+		m_history_gpu.UpdatePercentiles();
+		for (auto& entry : m_history_blocks)
+		{
+			entry.second.second.UpdatePercentiles();
+		}
+		for (auto& stat : m_stats)
+		{
+			stat.UpdatePercentiles();
+		}
+		auto AppendTime = [&Append](const char* format, float ms, const TimePercentiles& percentiles)
+		{
+			Append(format, ms, percentiles.p50, percentiles.p95, percentiles.p99, percentiles.max);
+		};
+		Append("FPS:\t\t\t\t\t\t\t%.2f\n", fps);
+		AppendTime("Frame time:\t\t\t\t\t%.2f ms (p50 %.2f, p95 %.2f, p99 %.2f, max %.2f)\n", m_frameTime, m_history_frame.GetPercentiles());
+		AppendTime("CPU time:\t\t\t\t\t\t%.2f ms (p50 %.2f, p95 %.2f, p99 %.2f, max %.2f)\n", m_cpuTime, m_history_cpu.GetPercentiles());
+		AppendTime("GPU time:\t\t\t\t\t\t%.2f ms (p50 %.2f, p95 %.2f, p99 %.2f, max %.2f)\n", m_gpuTime, m_history_gpu.GetPercentiles());
+		Append("GPU:\t\t\t\t\t\t\t%s\n", Settings::Get().Gpu_GetName().c_str());
+		Append("VRAM:\t\t\t\t\t\t\t%d MB\n", (int)Settings::Get().Gpu_GetMemory());
+
+		// Renderer
+		Append("Resolution:\t\t\t\t\t%dx%d\n", (int)Settings::Get().Resolution_GetWidth(), (int)Settings::Get().Resolution_GetHeight());
+		Append("Meshes rendered:\t\t\t\t%d\n", (int)m_rendererMeshesRendered.load());
+		Append("Textures:\t\t\t\t\t\t%d\n", textures);
+		Append("Materials:\t\t\t\t\t\t%d\n", materials);
+		Append("Shaders:\t\t\t\t\t\t%d\n", shaders);
+
+		// Physics
+		Append("Physics:\t\t\t\t\t\t%.2f ms (%d bodies reduced, %d frozen)\n", m_physicsMs, (int)m_physicsBodiesReduced, (int)m_physicsBodiesFrozen);
+
+		// Audio
+		Append("Audio voices:\t\t\t\t\t%d (%d real)\n", (int)m_audioVoices, (int)m_audioVoicesReal);
+		Append("Audio samples:\t\t\t\t\t%.1f MB\n", ToMB(m_audioSampleBytes.load()));
+
+		// Memory
+		if (m_rhiDevice)
+		{
+			Append("Memory meshes:\t\t\t\t\t%.1f MB\n", ToMB(m_rhiDevice->Memory_GetUsage(Memory_Meshes)));
+			Append("Memory textures:\t\t\t\t%.1f MB\n", ToMB(m_rhiDevice->Memory_GetUsage(Memory_Textures)));
+			Append("Memory render targets:\t\t\t%.1f MB\n", ToMB(m_rhiDevice->Memory_GetUsage(Memory_RenderTargets)));
+			Append("Memory shadows:\t\t\t\t\t%.1f MB\n", ToMB(m_rhiDevice->Memory_GetUsage(Memory_Shadows)));
+			Append("Memory buffers:\t\t\t\t\t%.1f MB\n", ToMB(m_rhiDevice->Memory_GetUsage(Memory_Buffers)));
+			Append("Memory total:\t\t\t\t\t%.1f MB\n", ToMB(m_rhiDevice->Memory_GetUsage()));
+		}
+		if (hasBudget)
+		{
+			Append("Memory budget:\t\t\t\t\t%.1f MB of %.1f MB\n", ToMB(usage), ToMB(budget));
+		}
+		else
+		{
+			Append("Memory budget:\t\t\t\t\tN/A\n");
+		}
+
+		// Heap, when the engine was built to track it
+		if (MemoryTracker::IsEnabled())
+		{
+			unsigned int allocationsFrame	= 0;
+			size_t bytesFrame				= 0;
+			size_t bytesLive				= 0;
+			for (unsigned int tag = 0; tag < MemoryTag_Count; tag++)
+			{
+				auto stats			= MemoryTracker::GetStats((MemoryTag)tag);
+				allocationsFrame	+= stats.allocationsFrame;
+				bytesFrame			+= stats.bytesFrame;
+				bytesLive			+= stats.bytesLive;
+			}
+			Append("Memory heap:\t\t\t\t\t%.1f MB\n", ToMB(bytesLive));
+			Append("Allocations per frame:\t\t\t%u (%.1f KB)\n", allocationsFrame, (double)bytesFrame / 1024.0);
+		}
+
+		// Actor and component pools
+		unsigned int poolBlocksUsed			= 0;
+		unsigned int poolBlocksAllocated	= 0;
+		size_t poolBytes					= 0;
+		for (const auto& pool : PoolRegistry::GetStatistics())
+		{
+			poolBlocksUsed		+= pool.blocksUsed;
+			poolBlocksAllocated	+= pool.blocksAllocated;
+			poolBytes			+= pool.blocksAllocated * pool.blockSize;
+		}
+		Append("Pooled objects:\t\t\t\t\t%u of %u\n", poolBlocksUsed, poolBlocksAllocated);
+		Append("Memory pools:\t\t\t\t\t%.1f MB\n", ToMB(poolBytes));
+
+		// RHI
+		Append("RHI Draw calls:\t\t\t\t\t%d\n", (int)m_rhiDrawCalls.load());
+		Append("RHI Index buffer bindings:\t\t%d\n", (int)m_rhiBindingsBufferIndex.load());
+		Append("RHI Vertex buffer bindings:\t%d\n", (int)m_rhiBindingsBufferVertex.load());
+		Append("RHI Constant buffer bindings:\t%d\n", (int)m_rhiBindingsBufferConstant.load());
+		Append("RHI Sampler bindings:\t\t\t%d\n", (int)m_rhiBindingsSampler.load());
+		Append("RHI Texture bindings:\t\t\t%d\n", (int)m_rhiBindingsTexture.load());
+		Append("RHI Vertex Shader bindings:\t%d\n", (int)m_rhiBindingsVertexShader.load());
+		Append("RHI Pixel Shader bindings:\t\t%d\n", (int)m_rhiBindingsPixelShader.load());
+		Append("RHI Render Target bindings:\t%d\n", (int)m_rhiBindingsRenderTarget.load());
+
+		// Threading
+		if (m_threading)
+		{
+			const auto& stats = *m_threadingStats;
+			Append("Task latency:\t\t\t\t\t%.3f ms avg, %.3f ms max\n", stats.latencyAvgMs, stats.latencyMaxMs);
+			Append("Queue depth:\t\t\t\t\t%u frame, %u background, %u IO\n", stats.queueDepthMax[ThreadGroup_Frame], stats.queueDepthMax[ThreadGroup_Background], stats.queueDepthMax[ThreadGroup_IO]);
+			for (const auto& worker : stats.workers)
+			{
+				float elapsedMs = worker.busyMs + worker.idleMs;
+				if (elapsedMs > 0.0f)
+				{
+					Append("%s:\t\t\t\t%.0f%% busy, %u tasks, %u stolen\n", worker.name.c_str(), worker.busyMs / elapsedMs * 100.0f, worker.tasks, worker.steals);
+				}
+				else
+				{
+					Append("%s:\t\t\t\t%u tasks\n", worker.name.c_str(), worker.tasks);
+				}
+			}
+		}
+
+		// Keeps it's capacity, so after the first update this doesn't allocate either
+		m_metrics.assign(metrics.data(), metrics.size());
 	}
 
 	void Profiler::ComputeFPS(float deltaTime)
@@ -224,11 +919,4 @@ namespace Directus
 			m_timePassed = 0;
 		}
 	}
-
-	string Profiler::to_string_precision(float value, int decimals)
-	{
-		ostringstream out;
-		out << fixed << setprecision(decimals) << value;
-		return out.str();
-	}
 }
@@ -27,6 +27,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <map>
 #include <chrono>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <vector>
 //=============================
 
 // Multi (CPU + GPU)
@@ -38,6 +41,26 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 // GPU
 #define TIME_BLOCK_START_GPU()		Directus::Profiler::Get().TimeBlockStart_CPU(__FUNCTION__);
 #define TIME_BLOCK_END_GPU()		Directus::Profiler::Get().TimeBlockEnd_GPU(__FUNCTION__);
+// Scoped (CPU + GPU), also marks the scope for graphics debuggers
+#define TIME_BLOCK_SCOPED_MULTI()	Directus::TimeBlock_Scoped timeBlockScoped(__FUNCTION__);
+// Scoped CPU, nests under whatever scope is open on the thread. A name has to be a string literal, blocks are keyed by it's address.
+#define TIME_BLOCK_SCOPED_CPU()				Directus::TimeBlock_Scoped_CPU timeBlockScopedCPU(__FUNCTION__);
+#define TIME_BLOCK_SCOPED_CPU_NAMED(name)	Directus::TimeBlock_Scoped_CPU timeBlockScopedCPU(name);
+
+// Scopes open at once on a thread, deeper ones aren't recorded
+#define TIME_BLOCK_DEPTH_MAX			32
+// Scopes a thread records during a capture, the rest of the capture goes without them
+#define TIME_BLOCK_CAPTURE_EVENTS_MAX	262144
+// Frames the percentiles are computed over
+#define PROFILER_HISTORY_FRAMES			512
+// Spikes written per session, so a bad stretch doesn't flood the disk
+#define PROFILER_SPIKE_CAPTURES_MAX		16
+// Scopes a thread keeps for the timeline, the oldest are overwritten
+#define PROFILER_TIMELINE_EVENTS		16384
+// Frames the timeline keeps
+#define PROFILER_TIMELINE_FRAMES		128
+// GPU passes a timeline frame keeps
+#define PROFILER_TIMELINE_PASSES_MAX	32
 
 namespace Directus
 {
@@ -47,12 +70,169 @@ namespace Directus
 	class ResourceManager;
 	class RHI_Device;
 	class Variant;
+	class Threading;
+	struct ThreadingStats;
+	struct ProfilerRemote_Frame;
 
 	struct TimeBlock_CPU
 	{
 		std::chrono::steady_clock::time_point start;
 		std::chrono::steady_clock::time_point end;
-		float duration = 0.0f;
+		float duration		= 0.0f;		// of every call during the last profiled frame
+		unsigned int calls	= 0;
+		unsigned int depth	= 0;		// scopes that enclosed the last call
+		const char* parent	= nullptr;	// the innermost of them
+		uint64_t frame		= 0;
+	};
+
+	// A scope recorded during a capture, in microseconds since the capture started (the profiler, on the timeline)
+	struct TimeBlock_Event
+	{
+		const char* name;
+		int64_t start;
+		int64_t duration;
+		unsigned int depth;
+	};
+
+	// A thread's CPU time blocks, only that thread records into them. The lock is there for whoever reads them.
+	struct TimeBlocks_Thread
+	{
+		unsigned int thread = 0; // in the order threads recorded their first block
+		std::string name;
+		std::mutex mutex;
+		std::map<const char*, TimeBlock_CPU> blocks;
+		std::vector<TimeBlock_Event> events;
+		size_t eventsStreamed = 0; // the events a remote viewer got already
+
+		// The last PROFILER_TIMELINE_EVENTS scopes, in microseconds since the profiler started. Allocated once when the thread
+		// registers and written without the lock, the head moves past an event only once it's in place.
+		std::unique_ptr<TimeBlock_Event[]> timeline;
+		std::atomic<uint64_t> timelineHead = 0;
+
+		// Open scopes, innermost last. Only the thread touches them, so they go without the lock.
+		std::pair<const char*, std::chrono::steady_clock::time_point> stack[TIME_BLOCK_DEPTH_MAX];
+		unsigned int depth = 0;
+	};
+
+	struct TimePercentiles
+	{
+		float p50	= 0.0f;
+		float p95	= 0.0f;
+		float p99	= 0.0f;
+		float max	= 0.0f;
+	};
+
+	// The last PROFILER_HISTORY_FRAMES samples of a value, times are in milliseconds
+	class ENGINE_CLASS TimeHistory
+	{
+	public:
+		void Add(float ms)
+		{
+			m_samples[m_next]	= ms;
+			m_next				= (m_next + 1) % PROFILER_HISTORY_FRAMES;
+			m_count				= m_count < PROFILER_HISTORY_FRAMES ? m_count + 1 : m_count;
+		}
+
+		// Sorts a copy of the samples, so it's done when the metrics update rather than whenever they are read
+		void UpdatePercentiles();
+		const TimePercentiles& GetPercentiles() const { return m_percentiles; }
+		// Counts the samples into buckets of equal width from 0 to maxMs, the last bucket also takes anything longer
+		void GetHistogram(float* buckets, unsigned int bucketCount, float maxMs) const;
+		unsigned int GetCount() const { return m_count; }
+		float GetLast() const { return m_count ? m_samples[(m_next + PROFILER_HISTORY_FRAMES - 1) % PROFILER_HISTORY_FRAMES] : 0.0f; }
+		// A ring buffer, once full the oldest sample is at the offset (what ImGui::PlotLines takes)
+		const float* GetSamples() const	{ return m_samples; }
+		unsigned int GetOffset() const	{ return m_count < PROFILER_HISTORY_FRAMES ? 0 : m_next; }
+
+	private:
+		float m_samples[PROFILER_HISTORY_FRAMES] = {};
+		unsigned int m_count	= 0;
+		unsigned int m_next		= 0;
+		TimePercentiles m_percentiles;
+	};
+
+	// Counters sampled at the start of every frame, of the frame that just ended. Read by ID, so the editor, the overlay
+	// and telemetry don't have to parse the metrics text.
+	enum Stat
+	{
+		// Time
+		Stat_Fps,
+		Stat_FrameMs,
+		Stat_CpuMs,
+		Stat_GpuMs,
+		// Renderer
+		Stat_MeshesRendered,
+		Stat_DrawCalls,
+		Stat_BindingsIndexBuffer,
+		Stat_BindingsVertexBuffer,
+		Stat_BindingsConstantBuffer,
+		Stat_BindingsSampler,
+		Stat_BindingsTexture,
+		Stat_BindingsVertexShader,
+		Stat_BindingsPixelShader,
+		Stat_BindingsRenderTarget,
+		// Memory
+		Stat_MemoryGpuMb,
+		Stat_MemoryHeapMb,			// with MEMORY_TRACKING only
+		Stat_AllocationsFrame,		// with MEMORY_TRACKING only
+		// Threading
+		Stat_Tasks,
+		Stat_TaskSteals,
+		Stat_TaskLatencyAvgMs,
+		Stat_TaskLatencyMaxMs,
+		Stat_TaskQueueDepth,		// the most tasks queued at once, of every group
+		Stat_WorkersBusy,			// percent, of the time every worker had
+		// Physics
+		Stat_PhysicsMs,
+		Stat_PhysicsBodiesReduced,	// stepped every few steps, see Physics::Lod_SetViewers
+		Stat_PhysicsBodiesFrozen,
+		// Audio
+		Stat_AudioVoices,			// every playing channel, real or virtual
+		Stat_AudioVoicesReal,		// the ones actually decoded and mixed, see Settings::AudioVoicesReal_Set
+		Stat_Count
+	};
+
+	// A block timed on both the CPU and the GPU (the render passes), during the last frame
+	struct PassStats
+	{
+		const char* name;
+		float cpuMs;
+		float gpuMs;
+	};
+
+	// A copy of a thread's blocks, see Profiler::GetTimeBlocks_CPU
+	struct TimeBlocks_ThreadCopy
+	{
+		unsigned int thread;
+		std::string name;
+		std::map<const char*, TimeBlock_CPU> blocks;
+	};
+
+	// A thread's scopes that overlap a span of the timeline, see Profiler::Timeline_Copy
+	struct Timeline_Thread
+	{
+		unsigned int thread;
+		std::string name;
+		std::vector<TimeBlock_Event> events; // in the order they ended
+	};
+
+	struct Timeline_Pass
+	{
+		const char* name;
+		float gpuMs;
+	};
+
+	// A frame of the timeline, in microseconds since the profiler started. The GPU times are the ones read back by then,
+	// a few frames late, and there is no GPU clock to place them by.
+	struct Timeline_Frame
+	{
+		uint64_t frame		= 0;
+		int64_t start		= 0;
+		int64_t duration	= 0;
+		float cpuMs			= 0.0f;
+		float gpuMs			= 0.0f;
+		unsigned int passCount = 0;
+		Timeline_Pass passes[PROFILER_TIMELINE_PASSES_MAX];
 	};
 
 	struct TimeBlock_GPU
@@ -82,25 +262,59 @@ namespace Directus
 		void TimeBlockStart_Multi(const char* funcName);
 		void TimeBlockEnd_Multi(const char* funcName);
 
-		// CPU timing
+		// CPU timing, an end closes the latest start of the same name (and any scope opened after it, that never ended)
 		void TimeBlockStart_CPU(const char* funcName);
 		void TimeBlockEnd_CPU(const char* funcName);
 
-		// GPU timing
+		// GPU timing, the results are read back a few frames later so the CPU never waits for them
 		void TimeBlockStart_GPU(const char* funcName);
 		void TimeBlockEnd_GPU(const char* funcName);
 
+		// GPU markers, named after the function without its scope
+		void MarkerBegin(const char* funcName);
+		void MarkerEnd();
+
+		// Records every CPU scope of every thread over the next frames, then writes them to a Chrome trace (JSON) which
+		// chrome://tracing, Perfetto and Tracy's importer can open. Starts and stops with a frame, false if one is running.
+		bool Capture_Start(unsigned int frames, const std::string& filePath);
+		bool Capture_IsRunning() { return m_captureFrameCount != 0; }
+		// Keeps the capture of any frame longer than the budget, written to "profiler_spike_<frame>.json". 0 stops watching.
+		void Capture_SetSpikeBudget(float budgetMs)	{ m_spikeBudgetMs = budgetMs; }
+		float Capture_GetSpikeBudget()				{ return m_spikeBudgetMs; }
+
+		// The scopes of every thread that overlap from-to, into the caller's vectors so it can reuse them. Scopes the
+		// threads overwrote while they were copied are left out.
+		void Timeline_Copy(int64_t from, int64_t to, std::vector<Timeline_Thread>& threads);
+		// The last PROFILER_TIMELINE_FRAMES frames, oldest first (main thread)
+		unsigned int Timeline_GetFrameCount()						{ return m_timelineFrameCount; }
+		const Timeline_Frame& Timeline_GetFrame(unsigned int index)	{ return m_timelineFrames[(m_timelineFrameNext + PROFILER_TIMELINE_FRAMES - m_timelineFrameCount + index) % PROFILER_TIMELINE_FRAMES]; }
+
 		// Events
 		void OnFrameStart();
 		void OnFrameEnd();
 
 		void SetProfilingEnabled_CPU(bool enabled)		{ m_cpuProfiling = enabled; }
-		void SetProfilingEnabled_GPU(bool enabled)		{ m_gpuProfiling = enabled; }
+		void SetProfilingEnabled_GPU(bool enabled)		{ m_gpuProfiling = enabled && m_rhiDevice; }
 		const std::string& GetMetrics()					{ return m_metrics; }
-		float GetTimeBlockMs_CPU(const char* funcName)	{ return m_timeBlocks_cpu[funcName].duration; }
+		// Counters of the last frame and their history, their percentiles update with the metrics (main thread, at the start of a frame)
+		float GetStat(Stat stat)						{ return m_stats[stat].GetLast(); }
+		const TimeHistory& GetHistory_Stat(Stat stat)	{ return m_stats[stat]; }
+		static const char* GetStatName(Stat stat);
+		const std::vector<PassStats>& GetStats_Passes()	{ return m_statsPasses; }
+		// Per frame times over the last PROFILER_HISTORY_FRAMES frames, the percentiles update with the metrics
+		const TimeHistory& GetHistory_Frame()			{ return m_history_frame; }
+		const TimeHistory& GetHistory_CPU()				{ return m_history_cpu; }
+		const TimeHistory& GetHistory_GPU()				{ return m_history_gpu; }
+		// Of the frames a block ran in, the longest of the threads that recorded it
+		TimePercentiles GetPercentiles_Block(const char* funcName);
+		// The longest of the threads that recorded it
+		float GetTimeBlockMs_CPU(const char* funcName);
 		float GetTimeBlockMs_GPU(const char* funcName)	{ return m_timeBlocks_gpu[funcName].duration; }
-		const auto& GetTimeBlocks_CPU()					{ return m_timeBlocks_cpu; }
+		// A copy of every thread's blocks
+		std::vector<TimeBlocks_ThreadCopy> GetTimeBlocks_CPU();
 		const auto& GetTimeBlocks_GPU()					{ return m_timeBlocks_gpu; }
+		// Per worker busy/idle time, steals, queue depth and latency of the last frame
+		const ThreadingStats& GetThreadingStats()		{ return *m_threadingStats; }
 		float GetRenderTime_CPU()						{ return m_cpuTime; }
 		float GetRenderTime_GPU()						{ return m_gpuTime; }
 
@@ -118,19 +332,29 @@ namespace Directus
 			m_rhiBindingsRenderTarget	= 0;
 		}
 
-		// Metrics - RHI
-		unsigned int m_rhiDrawCalls;
-		unsigned int m_rhiBindingsBufferIndex;
-		unsigned int m_rhiBindingsBufferVertex;
-		unsigned int m_rhiBindingsBufferConstant;
-		unsigned int m_rhiBindingsSampler;
-		unsigned int m_rhiBindingsTexture;
-		unsigned int m_rhiBindingsVertexShader;
-		unsigned int m_rhiBindingsPixelShader;
-		unsigned int m_rhiBindingsRenderTarget;
+		// Metrics - RHI (atomic as command lists can be recorded from multiple threads)
+		std::atomic<unsigned int> m_rhiDrawCalls;
+		std::atomic<unsigned int> m_rhiBindingsBufferIndex;
+		std::atomic<unsigned int> m_rhiBindingsBufferVertex;
+		std::atomic<unsigned int> m_rhiBindingsBufferConstant;
+		std::atomic<unsigned int> m_rhiBindingsSampler;
+		std::atomic<unsigned int> m_rhiBindingsTexture;
+		std::atomic<unsigned int> m_rhiBindingsVertexShader;
+		std::atomic<unsigned int> m_rhiBindingsPixelShader;
+		std::atomic<unsigned int> m_rhiBindingsRenderTarget;
 
 		// Metrics - Renderer
-		unsigned int m_rendererMeshesRendered;
+		std::atomic<unsigned int> m_rendererMeshesRendered;
+
+		// Metrics - Physics (of the last frame, set by Physics when it ends)
+		float m_physicsMs						= 0.0f;
+		unsigned int m_physicsBodiesReduced		= 0;
+		unsigned int m_physicsBodiesFrozen		= 0;
+
+		// Metrics - Audio (set by the audio thread when it updates FMOD)
+		std::atomic<unsigned int> m_audioVoices		= 0;
+		std::atomic<unsigned int> m_audioVoicesReal	= 0;
+		std::atomic<unsigned long long> m_audioSampleBytes = 0;	// resident in the sample cache
 
 		// Metrics - Time
 		float m_frameTime;
@@ -140,22 +364,62 @@ namespace Directus
 	private:
 		void UpdateMetrics(float fps);
 		void ComputeFPS(float deltaTime);
-		// Converts float to string with specified precision
-		std::string to_string_precision(float value, int decimals);
+		TimeBlocks_Thread& GetTimeBlocks_Thread();
+		void Capture_Frame();
+		void Capture_Clear();
+		void Capture_Write(const std::string& filePath);
+		void History_Update();
+		void Stats_Update();
+		void Timeline_Update();
+		void Remote_Send();
 
 		// Profiling options
 		bool m_gpuProfiling;
-		bool m_cpuProfiling;
+		std::atomic<bool> m_cpuProfiling;
 		float m_profilingFrequencySec;
 		float m_profilingLastUpdateTime;
 
 		// Time blocks
-		std::map<const char*, TimeBlock_CPU> m_timeBlocks_cpu;
+		std::vector<std::shared_ptr<TimeBlocks_Thread>> m_timeBlocks_cpu;
+		std::mutex m_timeBlocksMutex_cpu; // guards m_timeBlocks_cpu, not the blocks
 		std::map<const char*, TimeBlock_GPU> m_timeBlocks_gpu;
 
+		// Capture
+		std::atomic<bool> m_capturing;
+		unsigned int m_captureFrameCount;
+		std::string m_capturePath;
+		bool m_captureRecording; // a requested capture, as opposed to watching for spikes
+		std::chrono::steady_clock::time_point m_captureStart;
+		std::vector<int64_t> m_captureFrames; // the microsecond each frame started at
+		float m_spikeBudgetMs;
+		unsigned int m_spikesCaptured;
+
+		// Timeline
+		std::chrono::steady_clock::time_point m_timelineStart;
+		int64_t m_timelineFrameStart;
+		Timeline_Frame m_timelineFrames[PROFILER_TIMELINE_FRAMES];
+		unsigned int m_timelineFrameNext;
+		unsigned int m_timelineFrameCount;
+
+		// History
+		TimeHistory m_history_frame;
+		TimeHistory m_history_cpu;
+		TimeHistory m_history_gpu;
+		std::map<const char*, std::pair<float, TimeHistory>> m_history_blocks; // the longest it took on a thread last frame, and it's history
+
+		// Stats
+		TimeHistory m_stats[Stat_Count];
+		std::vector<PassStats> m_statsPasses;
+
+		// Threading
+		std::shared_ptr<ThreadingStats> m_threadingStats;
+
+		// Remote, see ProfilerRemote
+		std::shared_ptr<ProfilerRemote_Frame> m_remoteFrame;
+
 		// Misc
 		std::string m_metrics;
-		bool m_shouldUpdate;
+		std::atomic<uint64_t> m_frame;
 	
 		//= FPS ===========
 		float m_fps;
@@ -164,9 +428,49 @@ namespace Directus
 		//=================
 
 		// Dependencies
+		Context* m_context = nullptr;
 		World* m_scene;
 		Timer* m_timer;
 		ResourceManager* m_resourceManager;
+		Threading* m_threading;
 		std::shared_ptr<RHI_Device> m_rhiDevice;
 	};
+
+	class TimeBlock_Scoped
+	{
+	public:
+		TimeBlock_Scoped(const char* funcName)
+		{
+			m_funcName = funcName;
+			Profiler::Get().TimeBlockStart_Multi(m_funcName);
+			Profiler::Get().MarkerBegin(m_funcName);
+		}
+
+		~TimeBlock_Scoped()
+		{
+			Profiler::Get().MarkerEnd();
+			Profiler::Get().TimeBlockEnd_Multi(m_funcName);
+		}
+
+	private:
+		const char* m_funcName;
+	};
+
+	class TimeBlock_Scoped_CPU
+	{
+	public:
+		TimeBlock_Scoped_CPU(const char* name)
+		{
+			m_name = name;
+			Profiler::Get().TimeBlockStart_CPU(m_name);
+		}
+
+		~TimeBlock_Scoped_CPU()
+		{
+			Profiler::Get().TimeBlockEnd_CPU(m_name);
+		}
+
+	private:
+		const char* m_name;
+	};
 }
@@ -0,0 +1,551 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+//= INCLUDES ==================
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "ProfilerRemote.h"
+#include "../Logging/Log.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#pragma comment(lib, "Ws2_32.lib")
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+// A frame bigger than this is taken for a broken stream
+#define PROFILER_REMOTE_FRAME_MAX (64 * 1024 * 1024)
+
+namespace Directus
+{
+	namespace _ProfilerRemote
+	{
+		// Server
+		SOCKET serverListen				= INVALID_SOCKET;
+		SOCKET serverClient				= INVALID_SOCKET;
+		thread serverThread;
+		atomic<bool> serverRunning		= false;
+		atomic<bool> serverHasClient	= false;
+		bool serverNamesResend			= false;	// a new client, it hasn't seen any names
+		mutex serverMutex;							// guards the queue and the client's state
+		condition_variable serverCondition;
+		deque<vector<char>> serverQueue;
+		map<const char*, unsigned int> serverNameIDs;
+		vector<const char*> serverNames;
+		unsigned int serverNamesSent	= 0;
+
+		// Client
+		SOCKET client					= INVALID_SOCKET;
+		thread clientThread;
+		atomic<bool> clientConnected	= false;
+		atomic<uint64_t> clientFrames	= 0;
+		mutex clientMutex;							// guards the frame and the names
+		ProfilerRemote_Frame clientFrame;
+		bool clientFrameNew				= false;
+		vector<string> clientNames;
+
+		// Whichever starts first initializes Winsock, for the rest of the process
+		bool Socket_Initialize()
+		{
+			static bool initialized = []()
+			{
+				WSADATA data;
+				return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+			}();
+			return initialized;
+		}
+
+		bool Socket_Send(SOCKET socket, const char* data, size_t size)
+		{
+			while (size > 0)
+			{
+				int sent = send(socket, data, (int)size, 0);
+				if (sent == SOCKET_ERROR || sent == 0)
+					return false;
+
+				data += sent;
+				size -= sent;
+			}
+			return true;
+		}
+
+		bool Socket_Receive(SOCKET socket, char* data, size_t size)
+		{
+			while (size > 0)
+			{
+				int received = recv(socket, data, (int)size, 0);
+				if (received == SOCKET_ERROR || received == 0)
+					return false;
+
+				data += received;
+				size -= received;
+			}
+			return true;
+		}
+
+		//= ENCODING ==============================================================================
+		void Write_Varint(vector<char>& buffer, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.push_back((char)(value | 0x80));
+				value >>= 7;
+			}
+			buffer.push_back((char)value);
+		}
+
+		// Small negative numbers stay small
+		void Write_Zigzag(vector<char>& buffer, int64_t value)	{ Write_Varint(buffer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63)); }
+		void Write_Float(vector<char>& buffer, float value)
+		{
+			char bytes[sizeof(float)];
+			memcpy(bytes, &value, sizeof(float));
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(float));
+		}
+
+		bool Read_Varint(const char*& data, const char* end, uint64_t* value)
+		{
+			*value = 0;
+			for (unsigned int shift = 0; shift < 64 && data < end; shift += 7)
+			{
+				auto byte = (unsigned char)*data++;
+				*value |= (uint64_t)(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return true;
+			}
+			return false;
+		}
+
+		bool Read_Zigzag(const char*& data, const char* end, int64_t* value)
+		{
+			uint64_t encoded = 0;
+			if (!Read_Varint(data, end, &encoded))
+				return false;
+
+			*value = (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+			return true;
+		}
+
+		bool Read_Float(const char*& data, const char* end, float* value)
+		{
+			if (end - data < (ptrdiff_t)sizeof(float))
+				return false;
+
+			memcpy(value, data, sizeof(float));
+			data += sizeof(float);
+			return true;
+		}
+		//=========================================================================================
+
+		// Decodes a frame, the names it brings along go straight to the client's
+		bool Decode(const vector<char>& packet, ProfilerRemote_Frame* frame)
+		{
+			const char* data	= packet.data();
+			const char* end		= data + packet.size();
+			uint64_t value		= 0;
+
+			if (!Read_Varint(data, end, &value) || value != PROFILER_REMOTE_VERSION)
+				return false;
+
+			// Names
+			uint64_t names = 0;
+			if (!Read_Varint(data, end, &names))
+				return false;
+			for (uint64_t i = 0; i < names; i++)
+			{
+				uint64_t id		= 0;
+				uint64_t length	= 0;
+				if (!Read_Varint(data, end, &id) || !Read_Varint(data, end, &length) || (uint64_t)(end - data) < length || id > PROFILER_REMOTE_FRAME_MAX)
+					return false;
+
+				lock_guard<mutex> lock(clientMutex);
+				if (id >= clientNames.size()) clientNames.resize((size_t)id + 1);
+				clientNames[(size_t)id].assign(data, (size_t)length);
+				data += length;
+			}
+
+			// Counters, a server with more of them than this client knows of sends a few it skips
+			uint64_t stats = 0;
+			if (!Read_Varint(data, end, &frame->frame) || !Read_Varint(data, end, &stats))
+				return false;
+			for (uint64_t i = 0; i < stats; i++)
+			{
+				float stat = 0.0f;
+				if (!Read_Float(data, end, &stat))
+					return false;
+
+				if (i < Stat_Count) frame->stats[i] = stat;
+			}
+
+			// Threads
+			uint64_t threads = 0;
+			if (!Read_Varint(data, end, &threads) || threads > PROFILER_REMOTE_FRAME_MAX)
+				return false;
+			frame->threads.resize((size_t)threads);
+			for (auto& thread : frame->threads)
+			{
+				uint64_t id		= 0;
+				uint64_t name	= 0;
+				uint64_t events	= 0;
+				if (!Read_Varint(data, end, &id) || !Read_Varint(data, end, &name) || !Read_Varint(data, end, &events) || events > (uint64_t)(end - data))
+					return false;
+
+				thread.thread	= (unsigned int)id;
+				thread.name		= (unsigned int)name;
+				thread.events.resize((size_t)events);
+				int64_t start = 0;
+				for (auto& event : thread.events)
+				{
+					int64_t delta		= 0;
+					uint64_t eventName	= 0;
+					uint64_t duration	= 0;
+					uint64_t depth		= 0;
+					if (!Read_Varint(data, end, &eventName) || !Read_Zigzag(data, end, &delta) || !Read_Varint(data, end, &duration) || !Read_Varint(data, end, &depth))
+						return false;
+
+					start			+= delta;
+					event.name		= (unsigned int)eventName;
+					event.start		= start;
+					event.duration	= (int64_t)duration;
+					event.depth		= (unsigned int)depth;
+				}
+			}
+
+			return true;
+		}
+
+		void Server_Loop()
+		{
+			while (serverRunning)
+			{
+				// Waiting for a viewer, a little at a time so stopping doesn't hang on accept
+				if (serverClient == INVALID_SOCKET)
+				{
+					fd_set sockets;
+					FD_ZERO(&sockets);
+					FD_SET(serverListen, &sockets);
+					timeval timeout = { 0, 100000 };
+					if (select(0, &sockets, nullptr, nullptr, &timeout) <= 0)
+						continue;
+
+					SOCKET socket = accept(serverListen, nullptr, nullptr);
+					if (socket == INVALID_SOCKET)
+						continue;
+
+					// Frames are sent as they end, there is nothing to gain by holding them back
+					BOOL noDelay = TRUE;
+					setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+					lock_guard<mutex> lock(serverMutex);
+					serverQueue.clear();
+					serverClient		= socket;
+					serverNamesResend	= true;
+					serverHasClient		= true;
+					LOG_INFO("ProfilerRemote: A viewer connected");
+					continue;
+				}
+
+				vector<char> packet;
+				{
+					unique_lock<mutex> lock(serverMutex);
+					serverCondition.wait_for(lock, chrono::milliseconds(100), []() { return !serverQueue.empty() || !serverRunning; });
+					if (serverQueue.empty())
+						continue;
+
+					packet = move(serverQueue.front());
+					serverQueue.pop_front();
+				}
+
+				if (!Socket_Send(serverClient, packet.data(), packet.size()))
+				{
+					lock_guard<mutex> lock(serverMutex);
+					closesocket(serverClient);
+					serverClient	= INVALID_SOCKET;
+					serverHasClient	= false;
+					serverQueue.clear();
+					LOG_INFO("ProfilerRemote: The viewer disconnected");
+				}
+			}
+		}
+
+		void Client_Loop()
+		{
+			vector<char> packet;
+			ProfilerRemote_Frame frame;
+			while (clientConnected)
+			{
+				uint32_t size = 0;
+				if (!Socket_Receive(client, (char*)&size, sizeof(size)) || size > PROFILER_REMOTE_FRAME_MAX)
+					break;
+
+				packet.resize(size);
+				if (!Socket_Receive(client, packet.data(), size))
+					break;
+
+				if (!Decode(packet, &frame))
+				{
+					LOG_ERROR("ProfilerRemote: Failed to decode a frame, the server might be of another version");
+					break;
+				}
+
+				lock_guard<mutex> lock(clientMutex);
+				swap(clientFrame, frame);
+				clientFrameNew = true;
+				clientFrames++;
+			}
+			clientConnected = false;
+		}
+	}
+
+	bool ProfilerRemote::Server_Start(unsigned short port)
+	{
+		using namespace _ProfilerRemote;
+
+		if (serverRunning)
+			return true;
+
+		if (!Socket_Initialize())
+		{
+			LOG_ERROR("ProfilerRemote::Server_Start: Failed to initialize Winsock");
+			return false;
+		}
+
+		SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (listener == INVALID_SOCKET)
+		{
+			LOGF_ERROR("ProfilerRemote::Server_Start: Failed to create a socket, error %d", WSAGetLastError());
+			return false;
+		}
+
+		sockaddr_in address		= {};
+		address.sin_family		= AF_INET;
+		address.sin_port		= htons(port);
+		address.sin_addr.s_addr	= htonl(INADDR_ANY);
+		if (::bind(listener, (const sockaddr*)&address, sizeof(address)) == SOCKET_ERROR || listen(listener, 1) == SOCKET_ERROR)
+		{
+			LOGF_ERROR("ProfilerRemote::Server_Start: Failed to listen on port %u, error %d", (unsigned int)port, WSAGetLastError());
+			closesocket(listener);
+			return false;
+		}
+
+		serverListen	= listener;
+		serverRunning	= true;
+		serverThread	= thread(&Server_Loop);
+		LOGF_INFO("ProfilerRemote::Server_Start: Listening on port %u", (unsigned int)port);
+		return true;
+	}
+
+	void ProfilerRemote::Server_Stop()
+	{
+		using namespace _ProfilerRemote;
+
+		if (!serverRunning)
+			return;
+
+		serverRunning = false;
+		serverCondition.notify_one();
+		serverThread.join();
+
+		if (serverClient != INVALID_SOCKET) closesocket(serverClient);
+		closesocket(serverListen);
+		serverClient	= INVALID_SOCKET;
+		serverListen	= INVALID_SOCKET;
+		serverHasClient	= false;
+		serverQueue.clear();
+	}
+
+	bool ProfilerRemote::Server_IsRunning()	{ return _ProfilerRemote::serverRunning; }
+	bool ProfilerRemote::Server_HasClient()	{ return _ProfilerRemote::serverHasClient; }
+
+	unsigned int ProfilerRemote::Server_GetNameID(const char* name)
+	{
+		using namespace _ProfilerRemote;
+
+		// Names are string literals or live as long as their thread's blocks, so the address will do
+		auto it = serverNameIDs.find(name);
+		if (it != serverNameIDs.end())
+			return it->second;
+
+		auto id				= (unsigned int)serverNames.size();
+		serverNameIDs[name]	= id;
+		serverNames.emplace_back(name);
+		return id;
+	}
+
+	void ProfilerRemote::Server_Send(const ProfilerRemote_Frame& frame)
+	{
+		using namespace _ProfilerRemote;
+
+		// Encoded under the lock, so a viewer connecting meanwhile gets every name with it's first frame
+		lock_guard<mutex> lock(serverMutex);
+		if (!serverHasClient || serverQueue.size() >= PROFILER_REMOTE_QUEUE_MAX)
+			return;
+
+		if (serverNamesResend)
+		{
+			serverNamesSent		= 0;
+			serverNamesResend	= false;
+		}
+
+		vector<char> packet;
+		packet.reserve(4096);
+		packet.resize(sizeof(uint32_t)); // the size, once it's known
+		Write_Varint(packet, PROFILER_REMOTE_VERSION);
+
+		// Names
+		Write_Varint(packet, serverNames.size() - serverNamesSent);
+		for (unsigned int id = serverNamesSent; id < (unsigned int)serverNames.size(); id++)
+		{
+			size_t length = strlen(serverNames[id]);
+			Write_Varint(packet, id);
+			Write_Varint(packet, length);
+			packet.insert(packet.end(), serverNames[id], serverNames[id] + length);
+		}
+		serverNamesSent = (unsigned int)serverNames.size();
+
+		// Counters
+		Write_Varint(packet, frame.frame);
+		Write_Varint(packet, Stat_Count);
+		for (float stat : frame.stats)
+		{
+			Write_Float(packet, stat);
+		}
+
+		// Threads, the scopes went in as they ended so their starts are close together
+		Write_Varint(packet, frame.threads.size());
+		for (const auto& thread : frame.threads)
+		{
+			Write_Varint(packet, thread.thread);
+			Write_Varint(packet, thread.name);
+			Write_Varint(packet, thread.events.size());
+			int64_t start = 0;
+			for (const auto& event : thread.events)
+			{
+				Write_Varint(packet, event.name);
+				Write_Zigzag(packet, event.start - start);
+				Write_Varint(packet, (uint64_t)max<int64_t>(event.duration, 0));
+				Write_Varint(packet, event.depth);
+				start = event.start;
+			}
+		}
+
+		auto size = (uint32_t)(packet.size() - sizeof(uint32_t));
+		memcpy(packet.data(), &size, sizeof(uint32_t));
+		serverQueue.emplace_back(move(packet));
+		serverCondition.notify_one();
+	}
+
+	bool ProfilerRemote::Client_Connect(const string& host, unsigned short port)
+	{
+		using namespace _ProfilerRemote;
+
+		Client_Disconnect();
+		if (!Socket_Initialize())
+		{
+			LOG_ERROR("ProfilerRemote::Client_Connect: Failed to initialize Winsock");
+			return false;
+		}
+
+		addrinfo hints		= {};
+		hints.ai_family		= AF_UNSPEC;
+		hints.ai_socktype	= SOCK_STREAM;
+		hints.ai_protocol	= IPPROTO_TCP;
+		addrinfo* addresses	= nullptr;
+		if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &addresses) != 0)
+		{
+			LOGF_ERROR("ProfilerRemote::Client_Connect: Failed to resolve \"%s\"", host.c_str());
+			return false;
+		}
+
+		SOCKET connection = INVALID_SOCKET;
+		for (auto address = addresses; address && connection == INVALID_SOCKET; address = address->ai_next)
+		{
+			connection = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+			if (connection != INVALID_SOCKET && connect(connection, address->ai_addr, (int)address->ai_addrlen) == SOCKET_ERROR)
+			{
+				closesocket(connection);
+				connection = INVALID_SOCKET;
+			}
+		}
+		freeaddrinfo(addresses);
+
+		if (connection == INVALID_SOCKET)
+		{
+			LOGF_ERROR("ProfilerRemote::Client_Connect: Failed to connect to %s:%u", host.c_str(), (unsigned int)port);
+			return false;
+		}
+
+		{
+			lock_guard<mutex> lock(clientMutex);
+			clientNames.clear();
+			clientFrame		= ProfilerRemote_Frame();
+			clientFrameNew	= false;
+			clientFrames	= 0;
+		}
+		client			= connection;
+		clientConnected	= true;
+		clientThread	= thread(&Client_Loop);
+		return true;
+	}
+
+	void ProfilerRemote::Client_Disconnect()
+	{
+		using namespace _ProfilerRemote;
+
+		// Shutting the socket down wakes the client's thread up, if it's waiting on the server
+		clientConnected = false;
+		if (client != INVALID_SOCKET) shutdown(client, SD_BOTH);
+		if (clientThread.joinable()) clientThread.join();
+		if (client != INVALID_SOCKET) closesocket(client);
+		client = INVALID_SOCKET;
+	}
+
+	bool ProfilerRemote::Client_IsConnected() { return _ProfilerRemote::clientConnected; }
+
+	bool ProfilerRemote::Client_GetFrame(ProfilerRemote_Frame* frame)
+	{
+		using namespace _ProfilerRemote;
+
+		lock_guard<mutex> lock(clientMutex);
+		if (!clientFrameNew)
+			return false;
+
+		*frame			= clientFrame;
+		clientFrameNew	= false;
+		return true;
+	}
+
+	string ProfilerRemote::Client_GetName(unsigned int id)
+	{
+		using namespace _ProfilerRemote;
+
+		lock_guard<mutex> lock(clientMutex);
+		return id < clientNames.size() ? clientNames[id] : "Unknown";
+	}
+
+	uint64_t ProfilerRemote::Client_GetFramesReceived() { return _ProfilerRemote::clientFrames; }
+}
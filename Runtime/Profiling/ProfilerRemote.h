@@ -0,0 +1,88 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+//= INCLUDES ===========
+#include "Profiler.h"
+#include <string>
+#include <vector>
+//======================
+
+// The port the server listens on, unless told otherwise (see Settings::ProfilerPort_Set)
+#define PROFILER_REMOTE_PORT		28960
+// Encoded frames waiting to be sent, past that frames are dropped rather than waiting on a slow viewer
+#define PROFILER_REMOTE_QUEUE_MAX	120
+// Bumped whenever the encoding changes, a client only reads frames of it's own version
+#define PROFILER_REMOTE_VERSION		1
+
+namespace Directus
+{
+	struct ProfilerRemote_Event
+	{
+		unsigned int name;		// see ProfilerRemote::Client_GetName
+		int64_t start;			// microseconds since the frame started
+		int64_t duration;
+		unsigned int depth;
+	};
+
+	struct ProfilerRemote_Thread
+	{
+		unsigned int thread;
+		unsigned int name;
+		std::vector<ProfilerRemote_Event> events;
+	};
+
+	struct ProfilerRemote_Frame
+	{
+		uint64_t frame			= 0;
+		float stats[Stat_Count]	= {};
+		std::vector<ProfilerRemote_Thread> threads;
+	};
+
+	// Streams the profiler to a viewer over TCP, so builds without the editor can be profiled from another machine.
+	// The server (the engine) takes one client at a time. While one is connected, the profiler records every CPU scope
+	// and sends each frame's scopes and counters as the next frame starts. A frame is a size followed by varints: the
+	// names the client hasn't seen yet (once per connection), the counters, then per thread it's scopes, each start a
+	// delta from the one before. The client (Widget_Profiler) receives and decodes them on a thread of it's own.
+	class ENGINE_CLASS ProfilerRemote
+	{
+	public:
+		//= SERVER ===========================================================================================
+		static bool Server_Start(unsigned short port = PROFILER_REMOTE_PORT);
+		static void Server_Stop();
+		static bool Server_IsRunning();
+		static bool Server_HasClient();
+		// The ID a name goes by, sent along with the next frame the first time. Main thread only, as is Server_Send.
+		static unsigned int Server_GetNameID(const char* name);
+		static void Server_Send(const ProfilerRemote_Frame& frame);
+		//====================================================================================================
+
+		//= CLIENT ===========================================================================================
+		static bool Client_Connect(const std::string& host, unsigned short port = PROFILER_REMOTE_PORT);
+		static void Client_Disconnect();
+		static bool Client_IsConnected();
+		// The latest frame received, false if none came since the last call
+		static bool Client_GetFrame(ProfilerRemote_Frame* frame);
+		static std::string Client_GetName(unsigned int id);
+		static uint64_t Client_GetFramesReceived();
+		//====================================================================================================
+	};
+}
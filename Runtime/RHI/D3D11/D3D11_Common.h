@@ -61,7 +61,7 @@ inline D3D11_DEPTH_STENCIL_DESC Desc_DepthReverseEnabled()
 {
 	D3D11_DEPTH_STENCIL_DESC dsDesc;
 	dsDesc.DepthEnable					= true;
-	dsDesc.DepthWriteMask				= D3D11_DEPTH_WRITE_MASK_ZERO;
+	dsDesc.DepthWriteMask				= D3D11_DEPTH_WRITE_MASK_ALL;
 	dsDesc.DepthFunc					= D3D11_COMPARISON_GREATER_EQUAL;
 	dsDesc.StencilEnable				= false;
 	dsDesc.StencilReadMask				= D3D11_DEFAULT_STENCIL_READ_MASK;
@@ -129,6 +129,15 @@ inline D3D11_RASTERIZER_DESC Desc_RasterizerCullBack()
 	return rastDesc;
 }
 
+// Scissored drawing is 2D (the UI), so it doesn't cull either
+inline D3D11_RASTERIZER_DESC Desc_RasterizerScissor()
+{
+	D3D11_RASTERIZER_DESC rastDesc = Desc_RasterizerCullNone();
+	rastDesc.ScissorEnable = true;
+
+	return rastDesc;
+}
+
 
 inline D3D11_BLEND_DESC Desc_BlendDisabled()
 {
@@ -172,6 +181,33 @@ inline D3D11_BLEND_DESC Desc_BlendAlpha()
 	return blendDesc;
 }
 
+inline D3D11_BLEND_DESC Desc_BlendWeightedOIT()
+{
+	D3D11_BLEND_DESC blendDesc;
+	blendDesc.AlphaToCoverageEnable		= false;
+	blendDesc.IndependentBlendEnable	= true;
+	for (UINT i = 0; i < 8; ++i)
+	{
+		// Accumulation, premultiplied and weighted color plus weighted alpha are summed
+		blendDesc.RenderTarget[i].BlendEnable			= true;
+		blendDesc.RenderTarget[i].BlendOp				= D3D11_BLEND_OP_ADD;
+		blendDesc.RenderTarget[i].BlendOpAlpha			= D3D11_BLEND_OP_ADD;
+		blendDesc.RenderTarget[i].DestBlend				= D3D11_BLEND_ONE;
+		blendDesc.RenderTarget[i].DestBlendAlpha		= D3D11_BLEND_ONE;
+		blendDesc.RenderTarget[i].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+		blendDesc.RenderTarget[i].SrcBlend				= D3D11_BLEND_ONE;
+		blendDesc.RenderTarget[i].SrcBlendAlpha			= D3D11_BLEND_ONE;
+	}
+
+	// Revealage, the product of (1 - alpha) of every surface
+	blendDesc.RenderTarget[1].DestBlend			= D3D11_BLEND_INV_SRC_COLOR;
+	blendDesc.RenderTarget[1].DestBlendAlpha	= D3D11_BLEND_INV_SRC_ALPHA;
+	blendDesc.RenderTarget[1].SrcBlend			= D3D11_BLEND_ZERO;
+	blendDesc.RenderTarget[1].SrcBlendAlpha		= D3D11_BLEND_ZERO;
+
+	return blendDesc;
+}
+
 inline D3D11_BLEND_DESC Desc_BlendColorWriteDisabled()
 {
 	D3D11_BLEND_DESC blendDesc;
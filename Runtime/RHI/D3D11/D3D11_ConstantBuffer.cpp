@@ -19,11 +19,18 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
 //= INCLUDES =====================
 #include "../RHI_ConstantBuffer.h"
 #include <d3d11.h>
 #include "../../Logging/Log.h"
 #include "../RHI_Device.h"
+#include "../RHI_Capture.h"
+#include <algorithm>
 //================================
 
 //= NAMESPACES =====
@@ -34,8 +41,10 @@ namespace Directus
 {
 	RHI_ConstantBuffer::RHI_ConstantBuffer(shared_ptr<RHI_Device> rhiDevice)
 	{
-		m_rhiDevice = rhiDevice;
-		m_buffer	= nullptr;
+		m_rhiDevice		= rhiDevice;
+		m_buffer		= nullptr;
+		m_elementSize	= 0;
+		m_elementCount	= 1;
 	}
 
 	RHI_ConstantBuffer::~RHI_ConstantBuffer()
@@ -49,14 +58,15 @@ namespace Directus
 
 	bool RHI_ConstantBuffer::Create(unsigned int size, unsigned int slot, Buffer_Scope scope)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_ConstantBuffer::Create: Invalid RHI device");
 			return false;
 		}
 
-		m_slot	= slot;
-		m_scope = scope;
+		m_slot			= slot;
+		m_scope			= scope;
+		m_elementSize	= size;
 
 		D3D11_BUFFER_DESC bufferDesc;
 		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
@@ -67,19 +77,48 @@ namespace Directus
 		bufferDesc.MiscFlags			= 0;
 		bufferDesc.StructureByteStride	= 0;
 
-		HRESULT result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateBuffer(&bufferDesc, nullptr, (ID3D11Buffer**)&m_buffer);
+		HRESULT result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, nullptr, (ID3D11Buffer**)&m_buffer);
 		if FAILED(result)
 		{
 			LOG_ERROR("RHI_ConstantBuffer::Create: Failed to create constant buffer");
 			return false;
 		}
 
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, size);
 		return true;
 	}
 
-	void* RHI_ConstantBuffer::Map()
+	bool RHI_ConstantBuffer::CreateRing(unsigned int elementSize, unsigned int elementCount, unsigned int slot, Buffer_Scope scope)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		if (!m_rhiDevice)
+		{
+			LOG_ERROR("RHI_ConstantBuffer::CreateRing: Invalid RHI device");
+			return false;
+		}
+
+		// Offsets are expressed in constants and have to land on 256 byte boundaries, a shader sees at most 4096 constants
+		if (elementSize % 256 != 0 || elementSize / 16 > D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT)
+		{
+			LOGF_ERROR("RHI_ConstantBuffer::CreateRing: Element size of %d bytes can't be bound at an offset", elementSize);
+			return false;
+		}
+
+		if (!m_rhiDevice->IsConstantBufferOffsettingSupported())
+		{
+			elementCount = 1;
+		}
+
+		if (!Create(elementSize * elementCount, slot, scope))
+			return false;
+
+		m_elementSize	= elementSize;
+		m_elementCount	= elementCount;
+		return true;
+	}
+
+	void* RHI_ConstantBuffer::Map(unsigned int* firstConstant /*= nullptr*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_ConstantBuffer::Map: Invalid RHI device");
 			return nullptr;
@@ -91,20 +130,58 @@ namespace Directus
 			return nullptr;
 		}
 
+		// Pick the next element, discarding only when starting a new command list or wrapping around
+		D3D11_MAP mapType		= D3D11_MAP_WRITE_DISCARD;
+		unsigned int element	= 0;
+		if (IsRing())
+		{
+			auto commandList = m_rhiDevice->CommandList_GetID();
+
+			lock_guard<mutex> lock(m_ringMutex);
+			auto it = find_if(m_ringCursors.begin(), m_ringCursors.end(), [commandList](const RingCursor& cursor) { return cursor.commandList == commandList; });
+			if (it == m_ringCursors.end())
+			{
+				// Finished command lists never come back, so only the most recent ones are worth tracking
+				if (m_ringCursors.size() >= 16)
+				{
+					m_ringCursors.erase(m_ringCursors.begin());
+				}
+				m_ringCursors.emplace_back(RingCursor{ commandList, 0 });
+				it = m_ringCursors.end() - 1;
+			}
+			else if (it->element < m_elementCount)
+			{
+				mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+			}
+
+			if (it->element >= m_elementCount)
+			{
+				it->element = 0;
+			}
+			element = it->element++;
+		}
+
 		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		HRESULT result = m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->Map((ID3D11Buffer*)m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		HRESULT result = RHI_Backend::GetContext()->Map((ID3D11Buffer*)m_buffer, 0, mapType, 0, &mappedResource);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_ConstantBuffer::Map: Failed to map constant buffer.");
 			return nullptr;
 		}
 
-		return mappedResource.pData;
+		if (firstConstant)
+		{
+			*firstConstant = element * GetConstantCount();
+		}
+
+		auto mapped = (void*)((char*)mappedResource.pData + element * m_elementSize);
+		RHI_CAPTURE(Record_Map(Capture_UpdateConstantBuffer, this, m_buffer, mapped, m_elementSize, element * GetConstantCount()));
+		return mapped;
 	}
 
 	bool RHI_ConstantBuffer::Unmap()
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_ConstantBuffer::Unmap: Invalid RHI device");
 			return false;
@@ -116,8 +193,10 @@ namespace Directus
 			return false;
 		}
 
-		m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->Unmap((ID3D11Buffer*)m_buffer, 0);
+		RHI_CAPTURE(Record_Unmap(this));
+		RHI_Backend::GetContext()->Unmap((ID3D11Buffer*)m_buffer, 0);
 
 		return true;
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -27,9 +27,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===========================
 #include "D3D11_Common.h"
 #include "../RHI_Device.h"
+#include "../RHI_Capture.h"
 #include "../../Logging/Log.h"
 #include "../../FileSystem/FileSystem.h"
 #include "../../Profiling/Profiler.h"
+#include <d3d11_1.h>
+#include <vector>
+#include <mutex>
+#include <atomic>
 //======================================
 
 //= NAMESPACES ================
@@ -66,21 +71,71 @@ namespace Directus
 		};
 
 		// All the pointers that we need
-		ID3D11Device* m_device;
-		ID3D11DeviceContext* m_deviceContext;
+		// The device and the immediate context are RHI_Backend's, so the other resources reach them directly
 		IDXGISwapChain* m_swapChain;
 		ID3D11RenderTargetView* m_renderTargetView;
 		ID3D11Texture2D* m_depthStencilBuffer;
 		ID3D11DepthStencilState* m_depthStencilStateEnabled;
 		ID3D11DepthStencilState* m_depthStencilStateDisabled;
+		ID3D11DepthStencilState* m_depthStencilStateReadOnly;
+		ID3D11DepthStencilState* m_depthStencilStateReverseEnabled;
+		ID3D11DepthStencilState* m_depthStencilStateReverseReadOnly;
 		ID3D11DepthStencilView* m_depthStencilView;
 		ID3D11RasterizerState* m_rasterStateCullFront;
 		ID3D11RasterizerState* m_rasterStateCullBack;
 		ID3D11RasterizerState* m_rasterStateCullNone;
+		ID3D11RasterizerState* m_rasterStateScissor;
 		ID3D11BlendState* m_blendStateAlphaEnabled;
 		ID3D11BlendState* m_blendStateAlphaDisabled;
+		ID3D11BlendState* m_blendStateWeightedOIT;
 		ID3DUserDefinedAnnotation* m_eventReporter;	
 
+		// Deferred contexts, a thread which is recording redirects all of its commands to one of them (RHI_Backend::contextDeferred)
+		vector<ID3D11DeviceContext*> m_deferredContextsFree;
+		mutex m_deferredContextsMutex;
+
+		// D3D11.1 constant buffer offsetting, null when the runtime doesn't support it
+		bool m_constantBufferOffsetting = false;
+		ID3D11DeviceContext1* m_deviceContext1 = nullptr;
+		thread_local ID3D11DeviceContext1* m_deferredContext1Thread = nullptr;
+
+		// DXGI 1.4 adapter, reports the video memory budget, null on older runtimes
+		IDXGIAdapter3* m_adapter3 = nullptr;
+
+		// Command list identifiers, a new one is handed out per recording and per execution on the immediate context
+		atomic<unsigned long long> m_commandListSerial(0);
+		atomic<unsigned long long> m_commandListImmediate(0);
+		thread_local unsigned long long m_commandListThread = 0;
+
+		// Timestamps have a query per frame the GPU can be behind, so reading one back never waits for it
+		const static unsigned int query_latency = 3;
+		struct Query
+		{
+			Query_Type type;
+			ID3D11Query* queries[query_latency]			= {};
+			unsigned long long frames[query_latency]	= {}; // issued during, 0 if never
+			float duration								= 0.0f; // disjoint only, the last one read back
+		};
+		unsigned long long m_frameIndex = 1; // advanced by every present
+		unsigned int m_frameLatency		= 0; // frames DXGI lets the CPU queue ahead, 0 until the setting is applied
+
+		// Low latency (see Settings::LowLatency_Set), the swap chain signals when it can take another frame
+		UINT m_swapchainFlags					= swapchainFlags;
+		IDXGISwapChain2* m_swapChain2			= nullptr;
+		HANDLE m_frameLatencyWaitable			= nullptr;
+		bool m_tearingSupported					= false;
+
+		// Returns the context the calling thread should issue commands to
+		inline ID3D11DeviceContext* GetContext()
+		{
+			return RHI_Backend::GetContext();
+		}
+
+		inline ID3D11DeviceContext1* GetContext1()
+		{
+			return RHI_Backend::contextDeferred ? m_deferredContext1Thread : m_deviceContext1;
+		}
+
 		inline const char* DxgiErrorToString(HRESULT errorCode)
 		{
 			switch (errorCode)
@@ -115,7 +170,7 @@ namespace Directus
 
 		inline bool CreateDepthStencilView(UINT width, UINT height)
 		{
-			if (!m_device)
+			if (!RHI_Backend::device)
 				return false;
 
 			D3D11_TEXTURE2D_DESC depthBufferDesc;
@@ -133,7 +188,7 @@ namespace Directus
 			depthBufferDesc.MiscFlags			= 0;
 
 			// Create the texture for the depth buffer using the filled out description.
-			auto result = m_device->CreateTexture2D(&depthBufferDesc, nullptr, &m_depthStencilBuffer);
+			auto result = RHI_Backend::device->CreateTexture2D(&depthBufferDesc, nullptr, &m_depthStencilBuffer);
 			if (FAILED(result))
 			{
 				LOGF_ERROR("RHI_Device::CreateDepthStencilView: Failed to create depth stencil buffer, %s.", DxgiErrorToString(result));
@@ -147,7 +202,7 @@ namespace Directus
 			depthStencilViewDesc.Texture2D.MipSlice = 0;
 
 			// Create the depth stencil view.
-			result = m_device->CreateDepthStencilView(m_depthStencilBuffer, &depthStencilViewDesc, &m_depthStencilView);
+			result = RHI_Backend::device->CreateDepthStencilView(m_depthStencilBuffer, &depthStencilViewDesc, &m_depthStencilView);
 			if (FAILED(result))
 			{
 				LOGF_ERROR("RHI_Device::CreateDepthStencilView: Failed to create depth stencil view, %s.", DxgiErrorToString(result));
@@ -176,7 +231,8 @@ namespace Directus
 	{
 		m_format				= Texture_Format_R8G8B8A8_UNORM;
 		m_depthEnabled			= true;
-		m_alphaBlendingEnabled	= false;
+		m_depthWriteEnabled		= true;
+		m_blendMode				= Blend_Disabled;
 		m_initialized			= false;
 
 		if (!IsWindow((HWND)drawHandle))
@@ -288,7 +344,8 @@ namespace Directus
 			swapChainDesc.BufferDesc.ScanlineOrdering	= DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
 			swapChainDesc.BufferDesc.Scaling			= DXGI_MODE_SCALING_UNSPECIFIED;
 			swapChainDesc.SwapEffect					= _D3D11_Device::swapEffect;
-			swapChainDesc.Flags							= _D3D11_Device::swapchainFlags;
+			_D3D11_Device::m_swapchainFlags				= _D3D11_Device::swapchainFlags | (Settings::Get().LowLatency_Get() ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0);
+			swapChainDesc.Flags							= _D3D11_Device::m_swapchainFlags;
 
 			// Create the swap chain, Direct3D device, and Direct3D device context.
 			auto result = D3D11CreateDeviceAndSwapChain(
@@ -301,9 +358,9 @@ namespace Directus
 				_D3D11_Device::sdkVersion,				// always set this to D3D11_SDK_VERSION
 				&swapChainDesc,
 				&_D3D11_Device::m_swapChain,
-				&_D3D11_Device::m_device,
+				&RHI_Backend::device,
 				nullptr,
-				&_D3D11_Device::m_deviceContext
+				&RHI_Backend::contextImmediate
 			);
 
 			if (FAILED(result))
@@ -317,7 +374,7 @@ namespace Directus
 		if (_D3D11_Device::multithreadProtection)
 		{
 			ID3D11Multithread* multithread = nullptr;
-			if (SUCCEEDED(_D3D11_Device::m_deviceContext->QueryInterface(__uuidof(ID3D11Multithread), (void**)&multithread)))
+			if (SUCCEEDED(RHI_Backend::contextImmediate->QueryInterface(__uuidof(ID3D11Multithread), (void**)&multithread)))
 			{		
 				multithread->SetMultithreadProtected(TRUE);
 				multithread->Release();
@@ -328,6 +385,77 @@ namespace Directus
 			}
 		}
 
+		// Constant buffer offsetting, lets many small updates share one large buffer
+		{
+			D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+			if (SUCCEEDED(RHI_Backend::device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+			{
+				_D3D11_Device::m_constantBufferOffsetting = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+			}
+
+			if (_D3D11_Device::m_constantBufferOffsetting && FAILED(RHI_Backend::contextImmediate->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&_D3D11_Device::m_deviceContext1)))
+			{
+				_D3D11_Device::m_constantBufferOffsetting = false;
+			}
+
+			if (!_D3D11_Device::m_constantBufferOffsetting)
+			{
+				LOG_INFO("RHI_Device::RHI_Device: Constant buffer offsetting is not supported, per object data will be discarded on every update");
+			}
+		}
+
+		// Resources are created straight from their initial data on whichever thread loads them, the device (unlike the immediate context) is
+		// free threaded. Drivers which can't create concurrently still work, the runtime serializes the creation calls for them.
+		{
+			D3D11_FEATURE_DATA_THREADING threading = {};
+			if (FAILED(RHI_Backend::device->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading))) || !threading.DriverConcurrentCreates)
+			{
+				LOG_INFO("RHI_Device::RHI_Device: The driver doesn't support concurrent resource creation, uploads from worker threads will be serialized");
+			}
+		}
+
+		// PRESENTATION
+		{
+			// Presenting without waiting for a vertical blank, variable refresh rate displays show frames as they come
+			IDXGIFactory5* factory5 = nullptr;
+			if (SUCCEEDED(_D3D11_Device::m_swapChain->GetParent(IID_PPV_ARGS(&factory5))))
+			{
+				BOOL allowTearing = FALSE;
+				_D3D11_Device::m_tearingSupported = SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))) && allowTearing;
+			}
+			SafeRelease(factory5);
+
+			// The waitable object, frames then queue on it (Present_Wait) instead of blocking in Present
+			if (_D3D11_Device::m_swapchainFlags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT)
+			{
+				if (SUCCEEDED(_D3D11_Device::m_swapChain->QueryInterface(IID_PPV_ARGS(&_D3D11_Device::m_swapChain2))))
+				{
+					_D3D11_Device::m_swapChain2->SetMaximumFrameLatency(Settings::Get().FramesInFlight_Get());
+					_D3D11_Device::m_frameLatencyWaitable	= _D3D11_Device::m_swapChain2->GetFrameLatencyWaitableObject();
+					_D3D11_Device::m_frameLatency			= Settings::Get().FramesInFlight_Get();
+				}
+				else
+				{
+					LOG_INFO("RHI_Device::RHI_Device: DXGI 1.3 is not available, frames won't wait on the swap chain");
+				}
+			}
+		}
+
+		// MEMORY BUDGET
+		{
+			IDXGIDevice* dxgiDevice	= nullptr;
+			IDXGIAdapter* adapter	= nullptr;
+			if (SUCCEEDED(RHI_Backend::device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgiDevice)) && SUCCEEDED(dxgiDevice->GetAdapter(&adapter)))
+			{
+				if (FAILED(adapter->QueryInterface(__uuidof(IDXGIAdapter3), (void**)&_D3D11_Device::m_adapter3)))
+				{
+					LOG_INFO("RHI_Device::RHI_Device: DXGI 1.4 is not available, the video memory budget won't be reported");
+				}
+			}
+			SafeRelease(adapter);
+			SafeRelease(dxgiDevice);
+		}
+
 		// RENDER TARGET VIEW
 		{
 			// Get the pointer to the back buffer.
@@ -340,7 +468,7 @@ namespace Directus
 			}
 
 			// Create the render target view with the back buffer pointer.
-			result = _D3D11_Device::m_device->CreateRenderTargetView(backBufferPtr, nullptr, &_D3D11_Device::m_renderTargetView);
+			result = RHI_Backend::device->CreateRenderTargetView(backBufferPtr, nullptr, &_D3D11_Device::m_renderTargetView);
 			SafeRelease(backBufferPtr);
 			if (FAILED(result))
 			{
@@ -355,19 +483,41 @@ namespace Directus
 
 		// DEPTH STATES
 		auto desc = Desc_DepthEnabled();
-		if (FAILED(_D3D11_Device::m_device->CreateDepthStencilState(&desc, &_D3D11_Device::m_depthStencilStateEnabled)))
+		if (FAILED(RHI_Backend::device->CreateDepthStencilState(&desc, &_D3D11_Device::m_depthStencilStateEnabled)))
 		{
 			LOG_ERROR("RHI_Device::RHI_Device: Failed to create depth stencil enabled state.");
 			return;
 		}
 
 		desc = Desc_DepthDisabled();
-		if (FAILED(_D3D11_Device::m_device->CreateDepthStencilState(&desc, &_D3D11_Device::m_depthStencilStateDisabled)))
+		if (FAILED(RHI_Backend::device->CreateDepthStencilState(&desc, &_D3D11_Device::m_depthStencilStateDisabled)))
 		{
 			LOG_ERROR("RHI_Device::RHI_Device: Failed to create depth stencil disabled state.");
 			return;
 		}
 
+		desc = Desc_DepthEnabled();
+		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+		if (FAILED(RHI_Backend::device->CreateDepthStencilState(&desc, &_D3D11_Device::m_depthStencilStateReadOnly)))
+		{
+			LOG_ERROR("RHI_Device::RHI_Device: Failed to create depth stencil read only state.");
+			return;
+		}
+
+		desc = Desc_DepthReverseEnabled();
+		if (FAILED(RHI_Backend::device->CreateDepthStencilState(&desc, &_D3D11_Device::m_depthStencilStateReverseEnabled)))
+		{
+			LOG_ERROR("RHI_Device::RHI_Device: Failed to create depth stencil reverse enabled state.");
+			return;
+		}
+
+		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+		if (FAILED(RHI_Backend::device->CreateDepthStencilState(&desc, &_D3D11_Device::m_depthStencilStateReverseReadOnly)))
+		{
+			LOG_ERROR("RHI_Device::RHI_Device: Failed to create depth stencil reverse read only state.");
+			return;
+		}
+
 		// DEPTH STENCIL VIEW
 		if (!_D3D11_Device::CreateDepthStencilView((UINT)Settings::Get().Resolution_GetWidth(), (UINT)Settings::Get().Resolution_GetHeight()))
 		{
@@ -378,35 +528,42 @@ namespace Directus
 		// RASTERIZER STATES
 		{
 			auto desc = Desc_RasterizerCullBack();
-			if (FAILED(_D3D11_Device::m_device->CreateRasterizerState(&desc, &_D3D11_Device::m_rasterStateCullBack)))
+			if (FAILED(RHI_Backend::device->CreateRasterizerState(&desc, &_D3D11_Device::m_rasterStateCullBack)))
 			{
 				LOG_ERROR("RHI_Device::RHI_Device: Failed to create the rasterizer cull back state.");
 				return;
 			}
 
 			desc = Desc_RasterizerCullFront();
-			if (FAILED(_D3D11_Device::m_device->CreateRasterizerState(&desc, &_D3D11_Device::m_rasterStateCullFront)))
+			if (FAILED(RHI_Backend::device->CreateRasterizerState(&desc, &_D3D11_Device::m_rasterStateCullFront)))
 			{
 				LOG_ERROR("RHI_Device::RHI_Device: Failed to create the rasterizer cull front state.");
 				return;
 			}
 
 			desc = Desc_RasterizerCullNone();
-			if (FAILED(_D3D11_Device::m_device->CreateRasterizerState(&desc, &_D3D11_Device::m_rasterStateCullNone)))
+			if (FAILED(RHI_Backend::device->CreateRasterizerState(&desc, &_D3D11_Device::m_rasterStateCullNone)))
 			{
 				LOG_ERROR("RHI_Device::RHI_Device: Failed to create the rasterizer cull non state.");
 				return;
 			}
 
+			desc = Desc_RasterizerScissor();
+			if (FAILED(RHI_Backend::device->CreateRasterizerState(&desc, &_D3D11_Device::m_rasterStateScissor)))
+			{
+				LOG_ERROR("RHI_Device::RHI_Device: Failed to create the rasterizer scissor state.");
+				return;
+			}
+
 			// Set default rasterizer state
-			_D3D11_Device::m_deviceContext->RSSetState(_D3D11_Device::m_rasterStateCullBack);
+			RHI_Backend::contextImmediate->RSSetState(_D3D11_Device::m_rasterStateCullBack);
 		}
 
 		// BLEND STATES
 		{
 			// Create a blending state with alpha blending enabled
 			auto desc = Desc_BlendAlpha();
-			if (FAILED(_D3D11_Device::m_device->CreateBlendState(&desc, &_D3D11_Device::m_blendStateAlphaEnabled)))
+			if (FAILED(RHI_Backend::device->CreateBlendState(&desc, &_D3D11_Device::m_blendStateAlphaEnabled)))
 			{
 				LOG_ERROR("RHI_Device::RHI_Device: Failed to create blend alpha state.");
 				return;
@@ -414,16 +571,24 @@ namespace Directus
 
 			// Create a blending state with alpha blending disabled
 			desc = Desc_BlendDisabled();
-			if (FAILED(_D3D11_Device::m_device->CreateBlendState(&desc, &_D3D11_Device::m_blendStateAlphaDisabled)))
+			if (FAILED(RHI_Backend::device->CreateBlendState(&desc, &_D3D11_Device::m_blendStateAlphaDisabled)))
 			{
 				LOG_ERROR("RHI_Device::RHI_Device: Failed to create blend disabled state.");
 				return;
 			}
+
+			// Create a blending state for weighted blended order-independent transparency
+			desc = Desc_BlendWeightedOIT();
+			if (FAILED(RHI_Backend::device->CreateBlendState(&desc, &_D3D11_Device::m_blendStateWeightedOIT)))
+			{
+				LOG_ERROR("RHI_Device::RHI_Device: Failed to create blend weighted OIT state.");
+				return;
+			}
 		}
 
 		// EVENT REPORTER
 		_D3D11_Device::m_eventReporter = nullptr;
-		result = _D3D11_Device::m_deviceContext->QueryInterface(IID_PPV_ARGS(&_D3D11_Device::m_eventReporter));
+		result = RHI_Backend::contextImmediate->QueryInterface(IID_PPV_ARGS(&_D3D11_Device::m_eventReporter));
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_Device::RHI_Device: Failed to create ID3DUserDefinedAnnotation for event reporting");
@@ -431,7 +596,7 @@ namespace Directus
 		}
 
 		// Log feature level and adapter info
-		D3D_FEATURE_LEVEL featureLevel = _D3D11_Device::m_device->GetFeatureLevel();
+		D3D_FEATURE_LEVEL featureLevel = RHI_Backend::device->GetFeatureLevel();
 		string featureLevelStr;
 		switch (featureLevel)
 		{
@@ -464,8 +629,8 @@ namespace Directus
 			break;
 		}
 
-		m_device						= (void*)_D3D11_Device::m_device;
-		m_deviceContext					= (void*)_D3D11_Device::m_deviceContext;
+		m_device						= (void*)RHI_Backend::device;
+		m_deviceContext					= (void*)RHI_Backend::contextImmediate;
 		m_initialized					= true;
 	}
 
@@ -480,66 +645,126 @@ namespace Directus
 
 		SafeRelease(_D3D11_Device::m_blendStateAlphaEnabled);
 		SafeRelease(_D3D11_Device::m_blendStateAlphaDisabled);
+		SafeRelease(_D3D11_Device::m_blendStateWeightedOIT);
 		SafeRelease(_D3D11_Device::m_rasterStateCullFront);
 		SafeRelease(_D3D11_Device::m_rasterStateCullBack);
 		SafeRelease(_D3D11_Device::m_rasterStateCullNone);
+		SafeRelease(_D3D11_Device::m_rasterStateScissor);
 		SafeRelease(_D3D11_Device::m_depthStencilView);
 		SafeRelease(_D3D11_Device::m_depthStencilStateEnabled);
 		SafeRelease(_D3D11_Device::m_depthStencilStateDisabled);
+		SafeRelease(_D3D11_Device::m_depthStencilStateReadOnly);
+		SafeRelease(_D3D11_Device::m_depthStencilStateReverseEnabled);
+		SafeRelease(_D3D11_Device::m_depthStencilStateReverseReadOnly);
 		SafeRelease(_D3D11_Device::m_depthStencilBuffer);
 		SafeRelease(_D3D11_Device::m_renderTargetView);
-		SafeRelease(_D3D11_Device::m_deviceContext);
-		SafeRelease(_D3D11_Device::m_device);
+		for (auto& deferredContext : _D3D11_Device::m_deferredContextsFree)
+		{
+			SafeRelease(deferredContext);
+		}
+		_D3D11_Device::m_deferredContextsFree.clear();
+		SafeRelease(_D3D11_Device::m_adapter3);
+		SafeRelease(_D3D11_Device::m_deviceContext1);
+		SafeRelease(RHI_Backend::contextImmediate);
+		SafeRelease(RHI_Backend::device);
+		if (_D3D11_Device::m_frameLatencyWaitable)
+		{
+			CloseHandle(_D3D11_Device::m_frameLatencyWaitable);
+			_D3D11_Device::m_frameLatencyWaitable = nullptr;
+		}
+		SafeRelease(_D3D11_Device::m_swapChain2);
 		SafeRelease(_D3D11_Device::m_swapChain);
 	}
 
-	void RHI_Device::Draw(unsigned int vertexCount)
+	void RHI_Device::Draw(unsigned int vertexCount, unsigned int vertexOffset /*= 0*/)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_Draw, { vertexCount, vertexOffset }));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->Draw(vertexCount, 0);
+		_D3D11_Device::GetContext()->Draw(vertexCount, vertexOffset);
 		Profiler::Get().m_rhiDrawCalls++;
 	}
 
 	void RHI_Device::DrawIndexed(unsigned int indexCount, unsigned int indexOffset, unsigned int vertexOffset)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_DrawIndexed, { indexCount, indexOffset, vertexOffset }));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->DrawIndexed(indexCount, indexOffset, vertexOffset);
+		_D3D11_Device::GetContext()->DrawIndexed(indexCount, indexOffset, vertexOffset);
 		Profiler::Get().m_rhiDrawCalls++;
 	}
 
+	void RHI_Device::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int indexOffset, unsigned int vertexOffset)
+	{
+		RHI_CAPTURE(Record(Capture_DrawIndexedInstanced, { indexCount, instanceCount, indexOffset, vertexOffset }));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		_D3D11_Device::GetContext()->DrawIndexedInstanced(indexCount, instanceCount, indexOffset, vertexOffset, 0);
+		Profiler::Get().m_rhiDrawCalls++;
+	}
+
+	void RHI_Device::DrawIndexedInstancedIndirect(void* argumentsBuffer, unsigned int argumentsOffset)
+	{
+		RHI_CAPTURE(Record(Capture_DrawIndexedInstancedIndirect, { argumentsOffset }, { argumentsBuffer }));
+
+		if (!RHI_Backend::contextImmediate || !argumentsBuffer)
+			return;
+
+		_D3D11_Device::GetContext()->DrawIndexedInstancedIndirect((ID3D11Buffer*)argumentsBuffer, argumentsOffset);
+		Profiler::Get().m_rhiDrawCalls++;
+	}
+
+	void RHI_Device::Dispatch(unsigned int threadGroupCountX, unsigned int threadGroupCountY, unsigned int threadGroupCountZ)
+	{
+		RHI_CAPTURE(Record(Capture_Dispatch, { threadGroupCountX, threadGroupCountY, threadGroupCountZ }));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		_D3D11_Device::GetContext()->Dispatch(threadGroupCountX, threadGroupCountY, threadGroupCountZ);
+	}
+
 	void RHI_Device::ClearBackBuffer(const Vector4& color)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_ClearBackBuffer, { RHI_Capture::Bits(color.x), RHI_Capture::Bits(color.y), RHI_Capture::Bits(color.z), RHI_Capture::Bits(color.w) }));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->ClearRenderTargetView(_D3D11_Device::m_renderTargetView, color.Data()); // back buffer
+		_D3D11_Device::GetContext()->ClearRenderTargetView(_D3D11_Device::m_renderTargetView, color.Data()); // back buffer
 		if (m_depthEnabled)
 		{
-			_D3D11_Device::m_deviceContext->ClearDepthStencilView(_D3D11_Device::m_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, m_viewport.GetMaxDepth(), 0); // depth buffer
+			_D3D11_Device::GetContext()->ClearDepthStencilView(_D3D11_Device::m_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, Get_DepthFar(m_viewport), 0); // depth buffer
 		}
 	}
 
 	void RHI_Device::ClearRenderTarget(void* renderTarget, const Math::Vector4& color)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_ClearRenderTarget, { RHI_Capture::Bits(color.x), RHI_Capture::Bits(color.y), RHI_Capture::Bits(color.z), RHI_Capture::Bits(color.w) }, { renderTarget }));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->ClearRenderTargetView((ID3D11RenderTargetView*)renderTarget, color.Data());
+		_D3D11_Device::GetContext()->ClearRenderTargetView((ID3D11RenderTargetView*)renderTarget, color.Data());
 	}
 
 	void RHI_Device::ClearDepthStencil(void* depthStencil, unsigned int flags, float depth, uint8_t stencil)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_ClearDepthStencil, { flags, RHI_Capture::Bits(depth), stencil }, { depthStencil }));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
 		unsigned int clearFlags = 0;
 		clearFlags |= flags & Clear_Depth ? D3D11_CLEAR_DEPTH : 0;
 		clearFlags |= flags & Clear_Stencil ? D3D11_CLEAR_STENCIL : 0;
-		_D3D11_Device::m_deviceContext->ClearDepthStencilView((ID3D11DepthStencilView*)depthStencil, clearFlags, depth, stencil);
+		_D3D11_Device::GetContext()->ClearDepthStencilView((ID3D11DepthStencilView*)depthStencil, clearFlags, depth, stencil);
 	}
 
 	void RHI_Device::Present()
@@ -547,72 +772,199 @@ namespace Directus
 		if (!_D3D11_Device::m_swapChain)
 			return;
 
-		_D3D11_Device::m_swapChain->Present(Settings::Get().VSync_Get(), 0);
+		// Tearing is only allowed windowed (borderless full screen included) and without vsync
+		bool vsync		= Settings::Get().VSync_Get() != Off;
+		bool tearing	= Settings::Get().Tearing_Get() && _D3D11_Device::m_tearingSupported && !vsync && !Settings::Get().FullScreen_Get();
+		_D3D11_Device::m_swapChain->Present(Settings::Get().VSync_Get(), tearing ? DXGI_PRESENT_ALLOW_TEARING : 0);
+		_D3D11_Device::m_frameIndex++;
+
+		// Present blocks once the CPU is that many frames ahead of the GPU, the setting can change at any time.
+		// With the waitable object it's the swap chain's latency, Present_Wait blocks instead.
+		auto framesInFlight = Settings::Get().FramesInFlight_Get();
+		if (_D3D11_Device::m_frameLatency != framesInFlight)
+		{
+			if (_D3D11_Device::m_swapChain2)
+			{
+				_D3D11_Device::m_swapChain2->SetMaximumFrameLatency(framesInFlight);
+			}
+			else
+			{
+				IDXGIDevice1* dxgiDevice = nullptr;
+				if (SUCCEEDED(RHI_Backend::device->QueryInterface(__uuidof(IDXGIDevice1), (void**)&dxgiDevice)))
+				{
+					dxgiDevice->SetMaximumFrameLatency(framesInFlight);
+				}
+				SafeRelease(dxgiDevice);
+			}
+			_D3D11_Device::m_frameLatency = framesInFlight;
+		}
+	}
+
+	void RHI_Device::Present_Wait()
+	{
+		if (!_D3D11_Device::m_frameLatencyWaitable)
+			return;
+
+		// A second at most, a lost device never signals
+		TIME_BLOCK_SCOPED_CPU();
+		WaitForSingleObjectEx(_D3D11_Device::m_frameLatencyWaitable, 1000, TRUE);
 	}
 
 	void RHI_Device::Set_BackBufferAsRenderTarget()
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetBackBufferAsRenderTarget));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->OMSetRenderTargets(1, &_D3D11_Device::m_renderTargetView, m_depthEnabled ? _D3D11_Device::m_depthStencilView : nullptr);
+		_D3D11_Device::GetContext()->OMSetRenderTargets(1, &_D3D11_Device::m_renderTargetView, m_depthEnabled ? _D3D11_Device::m_depthStencilView : nullptr);
 	}
 
 	void RHI_Device::Set_VertexShader(void* buffer)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetVertexShader, {}, { buffer }));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->VSSetShader((ID3D11VertexShader*)buffer, nullptr, 0);
+		_D3D11_Device::GetContext()->VSSetShader((ID3D11VertexShader*)buffer, nullptr, 0);
 	}
 
 	void RHI_Device::Set_PixelShader(void* buffer)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetPixelShader, {}, { buffer }));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->PSSetShader((ID3D11PixelShader*)buffer, nullptr, 0);
+		_D3D11_Device::GetContext()->PSSetShader((ID3D11PixelShader*)buffer, nullptr, 0);
 	}
 
 	void RHI_Device::Set_ConstantBuffers(unsigned int startSlot, unsigned int bufferCount, Buffer_Scope scope, void* const* buffer)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetConstantBuffers, { startSlot, bufferCount, (uint32_t)scope }, buffer, bufferCount));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
 		auto d3d11buffer = (ID3D11Buffer*const*)buffer;
 		if (scope == Buffer_VertexShader || scope == Buffer_Global)
 		{
-			_D3D11_Device::m_deviceContext->VSSetConstantBuffers(startSlot, bufferCount, d3d11buffer);
+			_D3D11_Device::GetContext()->VSSetConstantBuffers(startSlot, bufferCount, d3d11buffer);
 		}
 
 		if (scope == Buffer_PixelShader || scope == Buffer_Global)
 		{
-			_D3D11_Device::m_deviceContext->PSSetConstantBuffers(startSlot, bufferCount, d3d11buffer);
+			_D3D11_Device::GetContext()->PSSetConstantBuffers(startSlot, bufferCount, d3d11buffer);
+		}
+
+		if (scope == Buffer_ComputeShader)
+		{
+			_D3D11_Device::GetContext()->CSSetConstantBuffers(startSlot, bufferCount, d3d11buffer);
+		}
+	}
+
+	void RHI_Device::Set_ConstantBufferRange(unsigned int slot, Buffer_Scope scope, void* buffer, unsigned int firstConstant, unsigned int constantCount)
+	{
+		RHI_CAPTURE(Record(Capture_SetConstantBufferRange, { slot, (uint32_t)scope, firstConstant, constantCount }, { buffer }));
+
+		auto context = _D3D11_Device::GetContext1();
+		if (!context)
+		{
+			LOG_ERROR("RHI_Device::Set_ConstantBufferRange: Constant buffer offsetting is not supported");
+			return;
+		}
+
+		auto d3d11buffer = (ID3D11Buffer*)buffer;
+		if (scope == Buffer_VertexShader || scope == Buffer_Global)
+		{
+			context->VSSetConstantBuffers1(slot, 1, &d3d11buffer, &firstConstant, &constantCount);
+		}
+
+		if (scope == Buffer_PixelShader || scope == Buffer_Global)
+		{
+			context->PSSetConstantBuffers1(slot, 1, &d3d11buffer, &firstConstant, &constantCount);
 		}
 	}
 
 	void RHI_Device::Set_Samplers(unsigned int startSlot, unsigned int samplerCount, void* const* samplers)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetSamplers, { startSlot, samplerCount }, samplers, samplerCount));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->PSSetSamplers(startSlot, samplerCount, (ID3D11SamplerState* const*)samplers);
+		_D3D11_Device::GetContext()->PSSetSamplers(startSlot, samplerCount, (ID3D11SamplerState* const*)samplers);
 	}
 
 	void RHI_Device::Set_RenderTargets(unsigned int renderTargetCount, void* const* renderTargets, void* depthStencil)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record_RenderTargets(renderTargetCount, renderTargets, depthStencil));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->OMSetRenderTargets(renderTargetCount, (ID3D11RenderTargetView* const*)renderTargets, (ID3D11DepthStencilView*)depthStencil);
+		_D3D11_Device::GetContext()->OMSetRenderTargets(renderTargetCount, (ID3D11RenderTargetView* const*)renderTargets, (ID3D11DepthStencilView*)depthStencil);
 	}
 
 	void RHI_Device::Set_Textures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetTextures, { startSlot, resourceCount }, shaderResources, resourceCount));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		_D3D11_Device::GetContext()->PSSetShaderResources(startSlot, resourceCount, (ID3D11ShaderResourceView* const*)shaderResources);
+	}
+
+	void RHI_Device::Set_VertexTextures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources)
+	{
+		RHI_CAPTURE(Record(Capture_SetVertexTextures, { startSlot, resourceCount }, shaderResources, resourceCount));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		_D3D11_Device::GetContext()->VSSetShaderResources(startSlot, resourceCount, (ID3D11ShaderResourceView* const*)shaderResources);
+	}
+
+	void RHI_Device::Set_ComputeShader(void* buffer)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeShader, {}, { buffer }));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		_D3D11_Device::GetContext()->CSSetShader((ID3D11ComputeShader*)buffer, nullptr, 0);
+	}
+
+	void RHI_Device::Set_ComputeSamplers(unsigned int startSlot, unsigned int samplerCount, void* const* samplers)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeSamplers, { startSlot, samplerCount }, samplers, samplerCount));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		_D3D11_Device::GetContext()->CSSetSamplers(startSlot, samplerCount, (ID3D11SamplerState* const*)samplers);
+	}
+
+	void RHI_Device::Set_ComputeTextures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeTextures, { startSlot, resourceCount }, shaderResources, resourceCount));
+
+		if (!RHI_Backend::contextImmediate)
 			return;
 
-		_D3D11_Device::m_deviceContext->PSSetShaderResources(startSlot, resourceCount, (ID3D11ShaderResourceView* const*)shaderResources);
+		_D3D11_Device::GetContext()->CSSetShaderResources(startSlot, resourceCount, (ID3D11ShaderResourceView* const*)shaderResources);
+	}
+
+	void RHI_Device::Set_ComputeUnorderedAccessViews(unsigned int startSlot, unsigned int viewCount, void* const* unorderedAccessViews)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeUnorderedAccessViews, { startSlot, viewCount }, unorderedAccessViews, viewCount));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		_D3D11_Device::GetContext()->CSSetUnorderedAccessViews(startSlot, viewCount, (ID3D11UnorderedAccessView* const*)unorderedAccessViews, nullptr);
 	}
 
 	bool RHI_Device::Set_Resolution(unsigned int width, unsigned int height)
@@ -659,7 +1011,7 @@ namespace Directus
 			width,
 			height,
 			dxgiModeDesc.Format,
-			_D3D11_Device::swapchainFlags
+			_D3D11_Device::m_swapchainFlags
 		);
 		if (FAILED(result))
 		{
@@ -678,7 +1030,7 @@ namespace Directus
 		SafeRelease(backBuffer);
 
 		// Create render target view
-		result = _D3D11_Device::m_device->CreateRenderTargetView(backBuffer, nullptr, &_D3D11_Device::m_renderTargetView);
+		result = RHI_Backend::device->CreateRenderTargetView(backBuffer, nullptr, &_D3D11_Device::m_renderTargetView);
 		if (FAILED(result))
 		{
 			LOGF_ERROR("RHI_Device::SetResolution:  Failed to create render target view, %s.", _D3D11_Device::DxgiErrorToString(result));
@@ -693,161 +1045,413 @@ namespace Directus
 
 	void RHI_Device::Set_Viewport(const RHI_Viewport& viewport)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetViewport, { RHI_Capture::Bits(viewport.GetTopLeftX()), RHI_Capture::Bits(viewport.GetTopLeftY()), RHI_Capture::Bits(viewport.GetWidth()), RHI_Capture::Bits(viewport.GetHeight()), RHI_Capture::Bits(viewport.GetMinDepth()), RHI_Capture::Bits(viewport.GetMaxDepth()) }));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		// Recording threads don't touch the device's state, it belongs to the immediate context
+		if (RHI_Backend::contextDeferred)
+		{
+			RHI_Backend::contextDeferred->RSSetViewports(1, (D3D11_VIEWPORT*)&viewport);
 			return;
+		}
 
 		m_viewport = viewport;
-		_D3D11_Device::m_deviceContext->RSSetViewports(1, (D3D11_VIEWPORT*)&m_viewport);
+		_D3D11_Device::GetContext()->RSSetViewports(1, (D3D11_VIEWPORT*)&m_viewport);
 	}
 
-	bool RHI_Device::Set_DepthEnabled(bool enable)
+	bool RHI_Device::Set_DepthEnabled(bool enable, bool write /*= true*/)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetDepthEnabled, { enable, write }));
+
+		if (!RHI_Backend::contextImmediate)
 		{
 			LOG_WARNING("D3D11_Device::EnableDepth: Device context is uninitialized.");
 			return false;
 		}
 
-		if (m_depthEnabled == enable)
+		auto state = _D3D11_Device::m_depthStencilStateDisabled;
+		if (enable)
+		{
+			state = m_depthReverse ?
+				(write ? _D3D11_Device::m_depthStencilStateReverseEnabled : _D3D11_Device::m_depthStencilStateReverseReadOnly) :
+				(write ? _D3D11_Device::m_depthStencilStateEnabled : _D3D11_Device::m_depthStencilStateReadOnly);
+		}
+
+		// Recording threads don't touch the device's state, it belongs to the immediate context
+		if (RHI_Backend::contextDeferred)
+		{
+			RHI_Backend::contextDeferred->OMSetDepthStencilState(state, 1);
+			return true;
+		}
+
+		if (m_depthEnabled == enable && (!enable || (m_depthWriteEnabled == write && m_depthReverseBound == m_depthReverse)))
 			return true;
 
-		_D3D11_Device::m_deviceContext->OMSetDepthStencilState(enable ? _D3D11_Device::m_depthStencilStateEnabled : _D3D11_Device::m_depthStencilStateDisabled, 1);
-		m_depthEnabled = enable;
+		_D3D11_Device::GetContext()->OMSetDepthStencilState(state, 1);
+		m_depthEnabled		= enable;
+		m_depthWriteEnabled	= write;
+		m_depthReverseBound	= m_depthReverse;
 
 		return true;
 	}
 
-	bool RHI_Device::Set_AlphaBlendingEnabled(bool enable)
+	bool RHI_Device::Set_BlendMode(Blend_Mode blendMode)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetBlendMode, { (uint32_t)blendMode }));
+
+		if (!RHI_Backend::contextImmediate)
 		{
-			LOG_WARNING("D3D11_Device::EnableAlphaBlending: Device context is uninitialized.");
+			LOG_WARNING("D3D11_Device::Set_BlendMode: Device context is uninitialized.");
 			return false;
 		}
 
+		ID3D11BlendState* blendState = _D3D11_Device::m_blendStateAlphaDisabled;
+		if (blendMode == Blend_Alpha)		blendState = _D3D11_Device::m_blendStateAlphaEnabled;
+		if (blendMode == Blend_WeightedOIT)	blendState = _D3D11_Device::m_blendStateWeightedOIT;
+
 		// Set blend state
 		float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-		_D3D11_Device::m_deviceContext->OMSetBlendState(enable ? _D3D11_Device::m_blendStateAlphaEnabled : _D3D11_Device::m_blendStateAlphaDisabled, blendFactor, 0xffffffff);
+		_D3D11_Device::GetContext()->OMSetBlendState(blendState, blendFactor, 0xffffffff);
+		m_blendMode = blendMode;
 
 		return true;
 	}
 
 	void RHI_Device::EventBegin(const std::string& name)
 	{
+		RHI_CAPTURE(Record_Event(name));
+
+		// The event reporter belongs to the immediate context
+		if (RHI_Backend::contextDeferred)
+			return;
+
 		// Not safe to convert to wstring like that, but it's fast and it looks like it works okay
 		_D3D11_Device::m_eventReporter->BeginEvent(LPCWSTR(name.c_str()));
 	}
 
 	void RHI_Device::EventEnd()
 	{
+		RHI_CAPTURE(Record(Capture_EventEnd));
+
+		if (RHI_Backend::contextDeferred)
+			return;
+
 		_D3D11_Device::m_eventReporter->EndEvent();
 	}
 
+	bool RHI_Device::Memory_GetBudget(unsigned long long* budget, unsigned long long* usage)
+	{
+		if (!_D3D11_Device::m_adapter3)
+			return false;
+
+		DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+		if (FAILED(_D3D11_Device::m_adapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+			return false;
+
+		if (budget) *budget	= info.Budget;
+		if (usage)	*usage	= info.CurrentUsage;
+		return true;
+	}
+
 	bool RHI_Device::Profiling_CreateQuery(void** query, Query_Type type)
 	{
-		if (!_D3D11_Device::m_device)
+		if (!RHI_Backend::device)
 			return false;
 
 		D3D11_QUERY_DESC desc;
 		ZeroMemory(&desc, sizeof(desc));
 		desc.Query		= (type == Query_Timestamp_Disjoint) ? D3D11_QUERY_TIMESTAMP_DISJOINT : D3D11_QUERY_TIMESTAMP;
 		desc.MiscFlags	= 0;
-		auto result		= _D3D11_Device::m_device->CreateQuery(&desc, (ID3D11Query**)query);
-		if (FAILED(result))
+
+		auto d3dQuery	= new _D3D11_Device::Query();
+		d3dQuery->type	= type;
+		for (auto& slot : d3dQuery->queries)
 		{
-			LOG_ERROR("Failed to create ID3D11Query");
-			return false;
+			if (FAILED(RHI_Backend::device->CreateQuery(&desc, &slot)))
+			{
+				LOG_ERROR("Failed to create ID3D11Query");
+				for (auto& created : d3dQuery->queries)
+				{
+					SafeRelease(created);
+				}
+				delete d3dQuery;
+				return false;
+			}
 		}
 
+		*query = (void*)d3dQuery;
 		return true;
 	}
 
 	void RHI_Device::Profiling_QueryStart(void* queryObject)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		auto query = (_D3D11_Device::Query*)queryObject;
+		if (!RHI_Backend::contextImmediate || !query)
 			return;
 
-		_D3D11_Device::m_deviceContext->Begin((ID3D11Query*)queryObject);
+		RHI_Backend::contextImmediate->Begin(query->queries[_D3D11_Device::m_frameIndex % _D3D11_Device::query_latency]);
 	}
 
 	void RHI_Device::Profiling_QueryEnd(void* queryObject)
 	{ 
-		if (!_D3D11_Device::m_deviceContext)
+		auto query = (_D3D11_Device::Query*)queryObject;
+		if (!RHI_Backend::contextImmediate || !query)
 			return;
 
-		_D3D11_Device::m_deviceContext->End((ID3D11Query*)queryObject);
+		auto slot = _D3D11_Device::m_frameIndex % _D3D11_Device::query_latency;
+		RHI_Backend::contextImmediate->End(query->queries[slot]);
+		query->frames[slot] = _D3D11_Device::m_frameIndex;
 	}
 
 	void RHI_Device::Profiling_GetTimeStamp(void* queryObject)
 	{
-		if (!_D3D11_Device::m_deviceContext)
-			return;
-
-		_D3D11_Device::m_deviceContext->End((ID3D11Query*)queryObject);
+		Profiling_QueryEnd(queryObject);
 	}
 
 	float RHI_Device::Profiling_GetDuration(void* queryDisjoint, void* queryStart, void* queryEnd)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		auto disjoint	= (_D3D11_Device::Query*)queryDisjoint;
+		auto start		= (_D3D11_Device::Query*)queryStart;
+		auto end		= (_D3D11_Device::Query*)queryEnd;
+		if (!RHI_Backend::contextImmediate || !disjoint || !start || !end)
 			return 0.0f;
 
-		// Wait for data to be available	
-		while (_D3D11_Device::m_deviceContext->GetData((ID3D11Query*)queryDisjoint, NULL, 0, 0) == S_FALSE){}
+		// The latest earlier frame the GPU is done with, until there is a newer one the last duration stands
+		unsigned long long latest = 0;
+		for (unsigned int slot = 0; slot < _D3D11_Device::query_latency; slot++)
+		{
+			auto frame = disjoint->frames[slot];
+			if (frame == 0 || frame != start->frames[slot] || frame != end->frames[slot] || frame >= _D3D11_Device::m_frameIndex || frame <= latest)
+				continue;
 
-		// Check whether timestamps were disjoint during the last frame
-		D3D10_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
-		_D3D11_Device::m_deviceContext->GetData((ID3D11Query*)queryDisjoint, &disjointData, sizeof(disjointData), 0);
-		if (disjointData.Disjoint)
-			return 0.0f;
+			// Don't flush, the queries were submitted with their frame
+			D3D10_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
+			UINT64 startTime	= 0;
+			UINT64 endTime		= 0;
+			auto context		= RHI_Backend::contextImmediate;
+			if (context->GetData(disjoint->queries[slot], &disjointData, sizeof(disjointData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+				context->GetData(start->queries[slot], &startTime, sizeof(startTime), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+				context->GetData(end->queries[slot], &endTime, sizeof(endTime), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+				continue;
 
-		// Get the query data		
-		UINT64 startTime	= 0;
-		UINT64 endTime		= 0;
-		_D3D11_Device::m_deviceContext->GetData((ID3D11Query*)queryStart, &startTime, sizeof(startTime), 0);
-		_D3D11_Device::m_deviceContext->GetData((ID3D11Query*)queryEnd,	&endTime, sizeof(endTime), 0);
+			// Timestamps are meaningless if the frequency changed in between
+			latest = frame;
+			if (disjointData.Disjoint)
+				continue;
 
-		// Compute delta in milliseconds
-		UINT64 delta		= endTime - startTime;
-		float durationMs	= (delta * 1000.0f) / (float)disjointData.Frequency;
+			// Compute delta in milliseconds
+			disjoint->duration = (float)((endTime - startTime) * 1000.0 / (double)disjointData.Frequency);
+		}
 
-		return durationMs;
+		return disjoint->duration;
+	}
+
+	bool RHI_Device::CommandList_Begin()
+	{
+		if (!RHI_Backend::device)
+			return false;
+
+		if (RHI_Backend::contextDeferred)
+		{
+			LOG_WARNING("RHI_Device::CommandList_Begin: The calling thread is already recording");
+			return false;
+		}
+
+		// Acquire a free deferred context, or create one
+		ID3D11DeviceContext* deferredContext = nullptr;
+		{
+			lock_guard<mutex> lock(_D3D11_Device::m_deferredContextsMutex);
+			if (!_D3D11_Device::m_deferredContextsFree.empty())
+			{
+				deferredContext = _D3D11_Device::m_deferredContextsFree.back();
+				_D3D11_Device::m_deferredContextsFree.pop_back();
+			}
+		}
+		if (!deferredContext)
+		{
+			auto result = RHI_Backend::device->CreateDeferredContext(0, &deferredContext);
+			if (FAILED(result))
+			{
+				LOGF_ERROR("RHI_Device::CommandList_Begin: Failed to create deferred context, %s.", _D3D11_Device::DxgiErrorToString(result));
+				return false;
+			}
+		}
+
+		// Deferred contexts start from the default pipeline state, so match what the immediate context was initialized with
+		float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		deferredContext->RSSetState(_D3D11_Device::m_rasterStateCullBack);
+		deferredContext->OMSetBlendState(_D3D11_Device::m_blendStateAlphaDisabled, blendFactor, 0xffffffff);
+		deferredContext->OMSetDepthStencilState(m_depthReverse ? _D3D11_Device::m_depthStencilStateReverseEnabled : _D3D11_Device::m_depthStencilStateEnabled, 1);
+
+		// Holds a reference for as long as the recording lasts
+		if (_D3D11_Device::m_constantBufferOffsetting)
+		{
+			deferredContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&_D3D11_Device::m_deferredContext1Thread);
+		}
+
+		RHI_Backend::contextDeferred	= deferredContext;
+		_D3D11_Device::m_commandListThread		= ++_D3D11_Device::m_commandListSerial;
+		RHI_CAPTURE(CommandList_Begin());
+		return true;
+	}
+
+	void* RHI_Device::CommandList_End()
+	{
+		auto deferredContext = RHI_Backend::contextDeferred;
+		if (!deferredContext)
+		{
+			LOG_WARNING("RHI_Device::CommandList_End: The calling thread is not recording");
+			return nullptr;
+		}
+		RHI_Backend::contextDeferred = nullptr;
+		SafeRelease(_D3D11_Device::m_deferredContext1Thread);
+
+		ID3D11CommandList* commandList = nullptr;
+		auto result = deferredContext->FinishCommandList(FALSE, &commandList);
+		if (FAILED(result))
+		{
+			LOGF_ERROR("RHI_Device::CommandList_End: Failed to finish command list, %s.", _D3D11_Device::DxgiErrorToString(result));
+		}
+
+		// Return the deferred context to the pool
+		lock_guard<mutex> lock(_D3D11_Device::m_deferredContextsMutex);
+		_D3D11_Device::m_deferredContextsFree.emplace_back(deferredContext);
+
+		RHI_CAPTURE(CommandList_End((void*)commandList));
+		return (void*)commandList;
+	}
+
+	void RHI_Device::CommandList_Execute(void* commandList)
+	{
+		RHI_CAPTURE(CommandList_Execute(commandList));
+
+		if (!RHI_Backend::contextImmediate || !commandList)
+			return;
+
+		// Restore the immediate context's state afterwards, RHI_Pipeline assumes it's still bound
+		auto d3d11CommandList = (ID3D11CommandList*)commandList;
+		RHI_Backend::contextImmediate->ExecuteCommandList(d3d11CommandList, TRUE);
+		d3d11CommandList->Release();
+
+		// The list may have renamed buffers the immediate context was appending to
+		_D3D11_Device::m_commandListImmediate = ++_D3D11_Device::m_commandListSerial;
+	}
+
+	bool RHI_Device::CommandList_IsRecording()
+	{
+		return RHI_Backend::contextDeferred != nullptr;
+	}
+
+	unsigned long long RHI_Device::CommandList_GetID()
+	{
+		return RHI_Backend::contextDeferred ? _D3D11_Device::m_commandListThread : _D3D11_Device::m_commandListImmediate.load();
+	}
+
+	// D3D11 has a single queue, compute sections run in order with the rest of the frame
+	void RHI_Device::Compute_Begin()
+	{
+		RHI_CAPTURE(Record(Capture_ComputeBegin));
+
+	}
+
+	void RHI_Device::Compute_End()
+	{
+		RHI_CAPTURE(Record(Capture_ComputeEnd));
+
+	}
+
+	void RHI_Device::Compute_Wait()
+	{
+		RHI_CAPTURE(Record(Capture_ComputeWait));
+
+	}
+
+	bool RHI_Device::Compute_IsAsync()
+	{
+		return false;
+	}
+
+	bool RHI_Device::IsConstantBufferOffsettingSupported()
+	{
+		return _D3D11_Device::m_constantBufferOffsetting;
+	}
+
+	void* RHI_Device::GetDeviceContextCurrent()
+	{
+		return (void*)_D3D11_Device::GetContext();
 	}
 
 	bool RHI_Device::Set_PrimitiveTopology(PrimitiveTopology_Mode primitiveTopology)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetPrimitiveTopology, { (uint32_t)primitiveTopology }));
+
+		if (!RHI_Backend::contextImmediate)
 		{
 			LOG_ERROR("D3D11_Device::Set_InputLayout: Invalid device context");
 			return false;
 		}
 
 		// Set primitive topology
-		_D3D11_Device::m_deviceContext->IASetPrimitiveTopology(d3d11_primitive_topology[primitiveTopology]);
+		_D3D11_Device::GetContext()->IASetPrimitiveTopology(d3d11_primitive_topology[primitiveTopology]);
 		return true;
 	}
 
 	bool RHI_Device::Set_FillMode(Fill_Mode fillMode)
 	{
+		RHI_CAPTURE(Record(Capture_SetFillMode, { (uint32_t)fillMode }));
+
 		return true;
 	}
 
 	bool RHI_Device::Set_InputLayout(void* inputLayout)
 	{
-		if (!_D3D11_Device::m_deviceContext)
+		RHI_CAPTURE(Record(Capture_SetInputLayout, {}, { inputLayout }));
+
+		if (!RHI_Backend::contextImmediate)
 		{
 			LOG_ERROR("D3D11_Device::Set_InputLayout: Invalid device context");
 			return false;
 		}
 
-		_D3D11_Device::m_deviceContext->IASetInputLayout((ID3D11InputLayout*)inputLayout);
+		_D3D11_Device::GetContext()->IASetInputLayout((ID3D11InputLayout*)inputLayout);
+		return true;
+	}
+
+	bool RHI_Device::Set_ScissorEnabled(bool enabled)
+	{
+		RHI_CAPTURE(Record(Capture_SetScissorEnabled, { enabled }));
+
+		if (!RHI_Backend::contextImmediate)
+		{
+			LOG_WARNING("D3D11_Device::Set_ScissorEnabled: Device context is uninitialized.");
+			return false;
+		}
+
+		// Culling isn't switched (see Set_CullMode), so disabling goes back to what's always bound
+		_D3D11_Device::GetContext()->RSSetState(enabled ? _D3D11_Device::m_rasterStateScissor : _D3D11_Device::m_rasterStateCullBack);
 		return true;
 	}
 
+	void RHI_Device::Set_ScissorRectangle(int left, int top, int right, int bottom)
+	{
+		RHI_CAPTURE(Record(Capture_SetScissorRectangle, { (uint32_t)left, (uint32_t)top, (uint32_t)right, (uint32_t)bottom }));
+
+		if (!RHI_Backend::contextImmediate)
+			return;
+
+		D3D11_RECT rectangle = { (LONG)left, (LONG)top, (LONG)right, (LONG)bottom };
+		_D3D11_Device::GetContext()->RSSetScissorRects(1, &rectangle);
+	}
+
 	bool RHI_Device::Set_CullMode(Cull_Mode cullMode)
 	{
+		RHI_CAPTURE(Record(Capture_SetCullMode, { (uint32_t)cullMode }));
+
 		return true;
 
-		if (!_D3D11_Device::m_deviceContext)
+		if (!RHI_Backend::contextImmediate)
 		{
 			LOG_WARNING("D3D11_Device::SetCullMode: Device context is uninitialized.");
 			return false;
@@ -855,15 +1459,15 @@ namespace Directus
 
 		if (cullMode == Cull_Mode::Cull_None)
 		{
-			_D3D11_Device::m_deviceContext->RSSetState(_D3D11_Device::m_rasterStateCullNone);
+			_D3D11_Device::GetContext()->RSSetState(_D3D11_Device::m_rasterStateCullNone);
 		}
 		else if (cullMode == Cull_Mode::Cull_Front)
 		{
-			_D3D11_Device::m_deviceContext->RSSetState(_D3D11_Device::m_rasterStateCullFront);
+			_D3D11_Device::GetContext()->RSSetState(_D3D11_Device::m_rasterStateCullFront);
 		}
 		else if (cullMode == Cull_Mode::Cull_Back)
 		{
-			_D3D11_Device::m_deviceContext->RSSetState(_D3D11_Device::m_rasterStateCullBack);
+			_D3D11_Device::GetContext()->RSSetState(_D3D11_Device::m_rasterStateCullBack);
 		}
 
 		return true;
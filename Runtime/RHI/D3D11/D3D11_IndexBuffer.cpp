@@ -19,10 +19,15 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ========================
+//= IMPLEMENTATION ===============
 #include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES ========================
 #include "../RHI_Device.h"
 #include "../RHI_IndexBuffer.h"
+#include "../RHI_Capture.h"
 #include "../../Logging/Log.h"
 //===================================
 
@@ -41,12 +46,14 @@ namespace Directus
 
 	RHI_IndexBuffer::~RHI_IndexBuffer()
 	{
+		SafeRelease((ID3D11ShaderResourceView*)m_shaderResourceView);
+		SafeRelease((ID3D11UnorderedAccessView*)m_unorderedAccessView);
 		SafeRelease((ID3D11Buffer*)m_buffer);
 	}
 
-	bool RHI_IndexBuffer::Create(const vector<unsigned int>& indices)
+	bool RHI_IndexBuffer::Create(const vector<unsigned int>& indices, Index_Format format /*= Index_Format_UInt32*/, bool shaderResource /*= false*/)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_IndexBuffer::Create: Invalid RHI device");
 			return false;
@@ -58,47 +65,86 @@ namespace Directus
 			return false;
 		}
 
-		unsigned int stride		= sizeof(unsigned int);
-		unsigned int size		= (unsigned int)indices.size();
+		if (format == Index_Format_UInt16 && GetFormat(indices) != Index_Format_UInt16)
+		{
+			LOG_ERROR("RHI_IndexBuffer::Create: Indices don't fit in 16 bits");
+			return false;
+		}
+
+		// Raw views address whole 32 bit words, so narrowed indices are padded to an even count
+		vector<uint16_t> indices16;
+		if (format == Index_Format_UInt16)
+		{
+			indices16 = vector<uint16_t>(indices.begin(), indices.end());
+			if (shaderResource && indices16.size() % 2 != 0)
+			{
+				indices16.emplace_back(0);
+			}
+		}
+
+		m_format				= format;
+		m_indexCount			= (unsigned int)indices.size();
+		unsigned int stride		= format == Index_Format_UInt16 ? sizeof(uint16_t) : sizeof(unsigned int);
+		unsigned int size		= format == Index_Format_UInt16 ? (unsigned int)indices16.size() : (unsigned int)indices.size();
 		unsigned int finalSize	= stride * size;
 
 		D3D11_BUFFER_DESC bufferDesc;
 		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
 		bufferDesc.ByteWidth			= finalSize;
 		bufferDesc.Usage				= D3D11_USAGE_IMMUTABLE;
-		bufferDesc.BindFlags			= D3D11_BIND_INDEX_BUFFER;
+		bufferDesc.BindFlags			= D3D11_BIND_INDEX_BUFFER | (shaderResource ? D3D11_BIND_SHADER_RESOURCE : 0);
 		bufferDesc.CPUAccessFlags		= 0;
-		bufferDesc.MiscFlags			= 0;
+		bufferDesc.MiscFlags			= shaderResource ? D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS : 0;
 		bufferDesc.StructureByteStride	= 0;
 
 		D3D11_SUBRESOURCE_DATA initData;
-		initData.pSysMem = indices.data();
+		initData.pSysMem = format == Index_Format_UInt16 ? (const void*)indices16.data() : (const void*)indices.data();
 		initData.SysMemPitch = 0;
 		initData.SysMemSlicePitch = 0;
 
 		auto ptr = (ID3D11Buffer**)&m_buffer;
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateBuffer(&bufferDesc, &initData, ptr);
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, &initData, ptr);
 		if FAILED(result)
 		{
 			LOG_ERROR("D3D11IndexBuffer: Failed to create index buffer");
 			return false;
 		}
 
+		if (shaderResource)
+		{
+			D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+			ZeroMemory(&viewDesc, sizeof(viewDesc));
+			viewDesc.Format					= DXGI_FORMAT_R32_TYPELESS;
+			viewDesc.ViewDimension			= D3D11_SRV_DIMENSION_BUFFEREX;
+			viewDesc.BufferEx.FirstElement	= 0;
+			viewDesc.BufferEx.NumElements	= finalSize / 4;
+			viewDesc.BufferEx.Flags			= D3D11_BUFFEREX_SRV_FLAG_RAW;
+
+			result = RHI_Backend::GetDevice()->CreateShaderResourceView((ID3D11Buffer*)m_buffer, &viewDesc, (ID3D11ShaderResourceView**)&m_shaderResourceView);
+			if FAILED(result)
+			{
+				LOG_ERROR("D3D11IndexBuffer: Failed to create shader resource view");
+				return false;
+			}
+		}
+
 		// Compute memory usage
-		m_memoryUsage = (unsigned int)(sizeof(unsigned int) * indices.size());
+		m_memoryUsage = finalSize;
 
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
 		return true;
 	}
 
 	bool RHI_IndexBuffer::CreateDynamic(unsigned int initialSize)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_IndexBuffer::Unmap: Invalid RHI device");
 			return false;
 		}
 
-		unsigned int byteWidth = sizeof(unsigned int) * initialSize;
+		m_format				= Index_Format_UInt32;
+		unsigned int byteWidth	= sizeof(unsigned int) * initialSize;
 
 		D3D11_BUFFER_DESC bufferDesc;
 		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
@@ -110,19 +156,74 @@ namespace Directus
 		bufferDesc.StructureByteStride	= 0;
 
 		auto ptr = (ID3D11Buffer**)&m_buffer;
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateBuffer(&bufferDesc, nullptr, ptr);
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, nullptr, ptr);
 		if FAILED(result)
 		{
 			LOG_ERROR("D3D11IndexBuffer: Failed to create dynamic index buffer");
 			return false;
 		}
 
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, byteWidth);
 		return true;
 	}
 
-	void* RHI_IndexBuffer::Map()
+	bool RHI_IndexBuffer::CreateUnorderedAccess(unsigned int indexCount)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_IndexBuffer::CreateUnorderedAccess: Invalid RHI device");
+			return false;
+		}
+
+		if (indexCount == 0)
+		{
+			LOG_ERROR("RHI_IndexBuffer::CreateUnorderedAccess: Invalid parameter");
+			return false;
+		}
+
+		m_format				= Index_Format_UInt32;
+		m_indexCount			= indexCount;
+		unsigned int byteWidth	= sizeof(unsigned int) * indexCount;
+
+		D3D11_BUFFER_DESC bufferDesc;
+		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+		bufferDesc.ByteWidth			= byteWidth;
+		bufferDesc.Usage				= D3D11_USAGE_DEFAULT;
+		bufferDesc.BindFlags			= D3D11_BIND_INDEX_BUFFER | D3D11_BIND_UNORDERED_ACCESS;
+		bufferDesc.CPUAccessFlags		= 0;
+		bufferDesc.MiscFlags			= D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+		bufferDesc.StructureByteStride	= 0;
+
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, nullptr, (ID3D11Buffer**)&m_buffer);
+		if FAILED(result)
+		{
+			LOG_ERROR("D3D11IndexBuffer: Failed to create unordered access index buffer");
+			return false;
+		}
+
+		D3D11_UNORDERED_ACCESS_VIEW_DESC accessDesc;
+		ZeroMemory(&accessDesc, sizeof(accessDesc));
+		accessDesc.Format				= DXGI_FORMAT_R32_TYPELESS;
+		accessDesc.ViewDimension		= D3D11_UAV_DIMENSION_BUFFER;
+		accessDesc.Buffer.FirstElement	= 0;
+		accessDesc.Buffer.NumElements	= indexCount;
+		accessDesc.Buffer.Flags			= D3D11_BUFFER_UAV_FLAG_RAW;
+
+		result = RHI_Backend::GetDevice()->CreateUnorderedAccessView((ID3D11Buffer*)m_buffer, &accessDesc, (ID3D11UnorderedAccessView**)&m_unorderedAccessView);
+		if FAILED(result)
+		{
+			LOG_ERROR("D3D11IndexBuffer: Failed to create unordered access view");
+			return false;
+		}
+
+		m_memoryUsage = byteWidth;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, byteWidth);
+		return true;
+	}
+
+	void* RHI_IndexBuffer::Map(bool discard /*= true*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_IndexBuffer::Unmap: Invalid RHI device");
 			return false;
@@ -135,19 +236,20 @@ namespace Directus
 		}
 
 		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		auto result = m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->Map((ID3D11Resource*)m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		auto result = RHI_Backend::GetContext()->Map((ID3D11Resource*)m_buffer, 0, discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_IndexBuffer: Failed to map index buffer.");
 			return nullptr;
 		}
 
+		RHI_CAPTURE(Record_Map(Capture_UpdateIndexBuffer, this, m_buffer, mappedResource.pData, m_memoryUsage, discard));
 		return mappedResource.pData;
 	}
 
 	bool RHI_IndexBuffer::Unmap()
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_IndexBuffer::Unmap: Invalid RHI device");
 			return false;
@@ -159,14 +261,17 @@ namespace Directus
 			return nullptr;
 		}
 
-		m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->Unmap((ID3D11Resource*)m_buffer, 0);
+		RHI_CAPTURE(Record_Unmap(this));
+		RHI_Backend::GetContext()->Unmap((ID3D11Resource*)m_buffer, 0);
 
 		return true;
 	}
 
 	bool RHI_IndexBuffer::Bind()
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		RHI_CAPTURE(Record(Capture_BindIndexBuffer, {}, { this }));
+
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_IndexBuffer::Bind: Invalid device context");
 			return false;
@@ -178,7 +283,8 @@ namespace Directus
 			return nullptr;
 		}
 
-		m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->IASetIndexBuffer((ID3D11Buffer*)m_buffer, DXGI_FORMAT_R32_UINT, 0);
+		RHI_Backend::GetContext()->IASetIndexBuffer((ID3D11Buffer*)m_buffer, m_format == Index_Format_UInt16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
 		return true;
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -19,8 +19,12 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =====================
+//= IMPLEMENTATION ===============
 #include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES =====================
 #include "../RHI_InputLayout.h"
 #include "../RHI_Device.h"
 #include "../../Logging/Log.h"
@@ -158,6 +162,84 @@ namespace Directus
 			bitangentDesc.InstanceDataStepRate = 0;
 			layout->push_back(bitangentDesc);
 		}
+
+		inline void CreatePosTBNPackedDesc(ID3D10Blob* VSBlob, vector<any>* layout)
+		{
+			D3D11_INPUT_ELEMENT_DESC positionDesc;
+			positionDesc.SemanticName = "POSITION";
+			positionDesc.SemanticIndex = 0;
+			positionDesc.Format = DXGI_FORMAT_R32G32B32_FLOAT;
+			positionDesc.InputSlot = 0;
+			positionDesc.AlignedByteOffset = 0;
+			positionDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			positionDesc.InstanceDataStepRate = 0;
+			layout->push_back(positionDesc);
+
+			D3D11_INPUT_ELEMENT_DESC texCoordDesc;
+			texCoordDesc.SemanticName = "TEXCOORD";
+			texCoordDesc.SemanticIndex = 0;
+			texCoordDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
+			texCoordDesc.InputSlot = 0;
+			texCoordDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			texCoordDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			texCoordDesc.InstanceDataStepRate = 0;
+			layout->push_back(texCoordDesc);
+
+			D3D11_INPUT_ELEMENT_DESC normalDesc;
+			normalDesc.SemanticName = "NORMAL";
+			normalDesc.SemanticIndex = 0;
+			normalDesc.Format = DXGI_FORMAT_R10G10B10A2_UNORM;
+			normalDesc.InputSlot = 0;
+			normalDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			normalDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			normalDesc.InstanceDataStepRate = 0;
+			layout->push_back(normalDesc);
+
+			// w holds the bitangent sign
+			D3D11_INPUT_ELEMENT_DESC tangentDesc;
+			tangentDesc.SemanticName = "TANGENT";
+			tangentDesc.SemanticIndex = 0;
+			tangentDesc.Format = DXGI_FORMAT_R10G10B10A2_UNORM;
+			tangentDesc.InputSlot = 0;
+			tangentDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			tangentDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			tangentDesc.InstanceDataStepRate = 0;
+			layout->push_back(tangentDesc);
+		}
+
+		// 2D, the color is packed (what ImGui hands over)
+		inline void CreatePos2DTexCol8Desc(ID3D10Blob* VSBlob, vector<any>* layout)
+		{
+			D3D11_INPUT_ELEMENT_DESC positionDesc;
+			positionDesc.SemanticName = "POSITION";
+			positionDesc.SemanticIndex = 0;
+			positionDesc.Format = DXGI_FORMAT_R32G32_FLOAT;
+			positionDesc.InputSlot = 0;
+			positionDesc.AlignedByteOffset = 0;
+			positionDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			positionDesc.InstanceDataStepRate = 0;
+			layout->push_back(positionDesc);
+
+			D3D11_INPUT_ELEMENT_DESC texCoordDesc;
+			texCoordDesc.SemanticName = "TEXCOORD";
+			texCoordDesc.SemanticIndex = 0;
+			texCoordDesc.Format = DXGI_FORMAT_R32G32_FLOAT;
+			texCoordDesc.InputSlot = 0;
+			texCoordDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			texCoordDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			texCoordDesc.InstanceDataStepRate = 0;
+			layout->push_back(texCoordDesc);
+
+			D3D11_INPUT_ELEMENT_DESC colorDesc;
+			colorDesc.SemanticName = "COLOR";
+			colorDesc.SemanticIndex = 0;
+			colorDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			colorDesc.InputSlot = 0;
+			colorDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			colorDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			colorDesc.InstanceDataStepRate = 0;
+			layout->push_back(colorDesc);
+		}
 	}
 
 	RHI_InputLayout::RHI_InputLayout(shared_ptr<RHI_Device> rhiDevice)
@@ -202,6 +284,16 @@ namespace Directus
 			D3D11_InputLayout::CreatePosTBNDesc((ID3D10Blob*)vsBlob, &m_layoutDesc);
 		}
 
+		if (m_inputLayout == Input_PositionTextureTBNPacked)
+		{
+			D3D11_InputLayout::CreatePosTBNPackedDesc((ID3D10Blob*)vsBlob, &m_layoutDesc);
+		}
+
+		if (m_inputLayout == Input_Position2DTextureColor8)
+		{
+			D3D11_InputLayout::CreatePos2DTexCol8Desc((ID3D10Blob*)vsBlob, &m_layoutDesc);
+		}
+
 		std::vector<D3D11_INPUT_ELEMENT_DESC> layoutDesc;
 		for (const auto& desc : m_layoutDesc)
 		{
@@ -209,11 +301,12 @@ namespace Directus
 		}
 
 		return D3D11_InputLayout::Create(
-			m_rhiDevice->GetDevice<ID3D11Device>(),
+			RHI_Backend::GetDevice(),
 			(ID3D11InputLayout**)&m_buffer,
 			(ID3D10Blob*)vsBlob,
 			layoutDesc.data(),
 			(unsigned int)m_layoutDesc.size()
 		);
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
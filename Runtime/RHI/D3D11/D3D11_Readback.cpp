@@ -0,0 +1,117 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES ===========================
+#include "../RHI_Readback.h"
+#include "../RHI_RenderTexture.h"
+#include "../RHI_StructuredBuffer.h"
+#include "../../Logging/Log.h"
+//======================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	bool RHI_Readback::Staging_Create(Staging& staging)
+	{
+		auto device = RHI_Backend::GetDevice();
+		if (!device)
+			return false;
+
+		if (staging.texture)
+		{
+			D3D11_TEXTURE2D_DESC textureDesc;
+			ZeroMemory(&textureDesc, sizeof(textureDesc));
+			textureDesc.Width				= staging.width;
+			textureDesc.Height				= staging.height;
+			textureDesc.MipLevels			= 1;
+			textureDesc.ArraySize			= 1;
+			textureDesc.Format				= d3d11_dxgi_format[staging.format];
+			textureDesc.SampleDesc.Count	= 1;
+			textureDesc.Usage				= D3D11_USAGE_STAGING;
+			textureDesc.CPUAccessFlags		= D3D11_CPU_ACCESS_READ;
+
+			return SUCCEEDED(device->CreateTexture2D(&textureDesc, nullptr, (ID3D11Texture2D**)&staging.resource));
+		}
+
+		D3D11_BUFFER_DESC bufferDesc;
+		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+		bufferDesc.ByteWidth		= staging.width;
+		bufferDesc.Usage			= D3D11_USAGE_STAGING;
+		bufferDesc.CPUAccessFlags	= D3D11_CPU_ACCESS_READ;
+
+		return SUCCEEDED(device->CreateBuffer(&bufferDesc, nullptr, (ID3D11Buffer**)&staging.resource));
+	}
+
+	void RHI_Readback::Staging_Destroy(Staging& staging)
+	{
+		if (staging.resource)
+		{
+			((ID3D11Resource*)staging.resource)->Release();
+			staging.resource = nullptr;
+		}
+	}
+
+	bool RHI_Readback::Copy_Texture(Staging& staging, RHI_RenderTexture* texture, unsigned int x, unsigned int y)
+	{
+		auto source = (ID3D11Resource*)texture->GetRenderTargetTexture();
+		if (!source)
+			return false;
+
+		D3D11_BOX box = { x, y, 0, x + staging.width, y + staging.height, 1 };
+		RHI_Backend::GetContext()->CopySubresourceRegion((ID3D11Resource*)staging.resource, 0, 0, 0, 0, source, 0, &box);
+		return true;
+	}
+
+	bool RHI_Readback::Copy_Buffer(Staging& staging, RHI_StructuredBuffer* buffer, unsigned int offset)
+	{
+		D3D11_BOX box = { offset, 0, 0, offset + staging.width, 1, 1 };
+		RHI_Backend::GetContext()->CopySubresourceRegion((ID3D11Resource*)staging.resource, 0, 0, 0, 0, (ID3D11Resource*)buffer->GetBuffer(), 0, &box);
+		return true;
+	}
+
+	bool RHI_Readback::Staging_Read(Staging& staging, vector<unsigned char>& data)
+	{
+		// Only the immediate context maps, and it doesn't wait for the copy, the GPU is still on it if mapping doesn't succeed right away
+		auto context = RHI_Backend::contextImmediate;
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		if (!context || context->Map((ID3D11Resource*)staging.resource, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource) != S_OK)
+			return false;
+
+		auto rowSize = staging.texture ? staging.width * Texture_Format_GetBytes(staging.format) : staging.width;
+		data.resize(rowSize * staging.height);
+		for (unsigned int y = 0; y < staging.height; y++)
+		{
+			memcpy(&data[y * rowSize], (unsigned char*)mappedResource.pData + y * mappedResource.RowPitch, rowSize);
+		}
+		context->Unmap((ID3D11Resource*)staging.resource, 0);
+
+		return true;
+	}
+}
+#endif
@@ -19,8 +19,12 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ========================
+//= IMPLEMENTATION ===============
 #include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES ========================
 #include "../RHI_RenderTexture.h"
 #include "../RHI_Device.h"
 #include "../../Core/GUIDGenerator.h"
@@ -32,15 +36,18 @@ using namespace Directus::Math;
 using namespace std;
 //=============================
 
+#define READBACK_LATENCY 3 // staging textures in flight, mapping one any sooner would stall
+
 namespace Directus
 {
-	RHI_RenderTexture::RHI_RenderTexture(shared_ptr<RHI_Device> rhiDevice, int width, int height, Texture_Format textureFormat, bool depth, Texture_Format depthFormat)
+	RHI_RenderTexture::RHI_RenderTexture(shared_ptr<RHI_Device> rhiDevice, int width, int height, Texture_Format textureFormat, bool depth, Texture_Format depthFormat, bool unorderedAccess)
 	{
 		m_renderTargetTexture	= nullptr;
 		m_renderTargetView		= nullptr;
 		m_shaderResourceView	= nullptr;
 		m_depthStencilBuffer	= nullptr;
 		m_depthStencilView		= nullptr;
+		m_unorderedAccessView	= nullptr;
 		m_rhiDevice				= rhiDevice;
 		m_depthEnabled			= depth;
 		m_nearPlane				= 0.0f;
@@ -50,7 +57,7 @@ namespace Directus
 		m_width					= width;
 		m_height				= height;
 
-		if (!m_rhiDevice || !m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("D3D11_RenderTexture::RHI_RenderTexture: Invalid device.");
 			return;
@@ -68,15 +75,16 @@ namespace Directus
 			textureDesc.SampleDesc.Count	= 1;
 			textureDesc.SampleDesc.Quality	= 0;
 			textureDesc.Usage				= D3D11_USAGE_DEFAULT;
-			textureDesc.BindFlags			= D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+			textureDesc.BindFlags			= D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE | (unorderedAccess ? D3D11_BIND_UNORDERED_ACCESS : 0);
 			textureDesc.CPUAccessFlags		= 0;
 			textureDesc.MiscFlags			= 0;
 			auto ptr = (ID3D11Texture2D**)&m_renderTargetTexture;
-			if (FAILED(m_rhiDevice->GetDevice<ID3D11Device>()->CreateTexture2D(&textureDesc, nullptr, ptr)))
+			if (FAILED(RHI_Backend::GetDevice()->CreateTexture2D(&textureDesc, nullptr, ptr)))
 			{
 				LOG_ERROR("D3D11_RenderTexture::Construct: CreateTexture2D() failed.");
 				return;
 			}
+			m_memoryTracker.Set(m_rhiDevice, Memory_RenderTargets, (long long)m_width * m_height * Texture_Format_GetBytes(m_format));
 		}
 
 		// RENDER TARGET VIEW
@@ -87,7 +95,7 @@ namespace Directus
 			renderTargetViewDesc.Texture2D.MipSlice = 0;
 
 			auto ptr = (ID3D11RenderTargetView**)&m_renderTargetView;
-			if (FAILED(m_rhiDevice->GetDevice<ID3D11Device>()->CreateRenderTargetView((ID3D11Resource*)m_renderTargetTexture, &renderTargetViewDesc, ptr)))
+			if (FAILED(RHI_Backend::GetDevice()->CreateRenderTargetView((ID3D11Resource*)m_renderTargetTexture, &renderTargetViewDesc, ptr)))
 			{
 				LOG_ERROR("D3D11_RenderTexture::Construct: CreateRenderTargetView() failed.");
 				return;
@@ -103,13 +111,29 @@ namespace Directus
 			shaderResourceViewDesc.Texture2D.MipLevels			= 1;
 
 			auto ptr = (ID3D11ShaderResourceView**)&m_shaderResourceView;
-			if (FAILED(m_rhiDevice->GetDevice<ID3D11Device>()->CreateShaderResourceView((ID3D11Texture2D*)m_renderTargetTexture, &shaderResourceViewDesc, ptr)))
+			if (FAILED(RHI_Backend::GetDevice()->CreateShaderResourceView((ID3D11Texture2D*)m_renderTargetTexture, &shaderResourceViewDesc, ptr)))
 			{
 				LOG_ERROR("D3D11_RenderTexture::Construct: CreateShaderResourceView() failed.");
 				return;
 			}
 		}
 
+		// UNORDERED ACCESS VIEW
+		if (unorderedAccess)
+		{
+			D3D11_UNORDERED_ACCESS_VIEW_DESC unorderedAccessViewDesc;
+			unorderedAccessViewDesc.Format				= d3d11_dxgi_format[m_format];
+			unorderedAccessViewDesc.ViewDimension		= D3D11_UAV_DIMENSION_TEXTURE2D;
+			unorderedAccessViewDesc.Texture2D.MipSlice	= 0;
+
+			auto ptr = (ID3D11UnorderedAccessView**)&m_unorderedAccessView;
+			if (FAILED(RHI_Backend::GetDevice()->CreateUnorderedAccessView((ID3D11Resource*)m_renderTargetTexture, &unorderedAccessViewDesc, ptr)))
+			{
+				LOG_ERROR("D3D11_RenderTexture::Construct: CreateUnorderedAccessView() failed.");
+				return;
+			}
+		}
+
 		if (!m_depthEnabled)
 			return;
 
@@ -130,11 +154,12 @@ namespace Directus
 			depthTexDesc.MiscFlags			= 0;
 
 			auto ptr = (ID3D11Texture2D**)&m_depthStencilBuffer;
-			if (FAILED(m_rhiDevice->GetDevice<ID3D11Device>()->CreateTexture2D(&depthTexDesc, nullptr, ptr)))
+			if (FAILED(RHI_Backend::GetDevice()->CreateTexture2D(&depthTexDesc, nullptr, ptr)))
 			{
 				LOG_ERROR("D3D11_RenderTexture::Construct: CreateTexture2D() failed.");
 				return;
 			}
+			m_memoryTracker.Set(m_memoryTracker.GetBytes() + (long long)m_width * m_height * Texture_Format_GetBytes(depthFormat));
 		}
 
 		// DEPTH STENCIL VIEW
@@ -146,7 +171,7 @@ namespace Directus
 			depthStencilViewDesc.Texture2D.MipSlice = 0;
 
 			auto ptr = (ID3D11DepthStencilView**)&m_depthStencilView;
-			auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateDepthStencilView((ID3D11Texture2D*)m_depthStencilBuffer, &depthStencilViewDesc, ptr);
+			auto result = RHI_Backend::GetDevice()->CreateDepthStencilView((ID3D11Texture2D*)m_depthStencilBuffer, &depthStencilViewDesc, ptr);
 			if (FAILED(result))
 			{
 				LOG_ERROR("D3D11_RenderTexture::Construct: CreateDepthStencilView() failed.");
@@ -162,6 +187,11 @@ namespace Directus
 		SafeRelease((ID3D11ShaderResourceView*)m_shaderResourceView);
 		SafeRelease((ID3D11Texture2D*)m_depthStencilBuffer);
 		SafeRelease((ID3D11DepthStencilView*)m_depthStencilView);
+		SafeRelease((ID3D11UnorderedAccessView*)m_unorderedAccessView);
+		for (auto& texture : m_readbackTextures)
+		{
+			SafeRelease((ID3D11Texture2D*)texture);
+		}
 	}
 
 	bool RHI_RenderTexture::Clear(const Vector4& clearColor)
@@ -175,8 +205,8 @@ namespace Directus
 		// Clear depth buffer.
 		if (m_depthEnabled)
 		{
-			float maxDepth = m_rhiDevice->Get_Viewport().GetMaxDepth();
-			m_rhiDevice->ClearDepthStencil(m_depthStencilView, Clear_Depth, maxDepth, 0); 
+			float farDepth = m_rhiDevice->Get_DepthFar(m_viewport);
+			m_rhiDevice->ClearDepthStencil(m_depthStencilView, Clear_Depth, farDepth, 0); 
 		}
 
 		return true;
@@ -187,6 +217,164 @@ namespace Directus
 		return Clear(Vector4(red, green, blue, alpha));
 	}
 
+	bool RHI_RenderTexture::CopyFrom(const shared_ptr<RHI_RenderTexture>& source)
+	{
+		if (!m_rhiDevice || !source)
+			return false;
+
+		if (source->m_width != m_width || source->m_height != m_height || source->m_format != m_format || source->m_depthEnabled != m_depthEnabled)
+		{
+			LOG_ERROR("D3D11_RenderTexture::CopyFrom: Incompatible source.");
+			return false;
+		}
+
+		// Goes through the current context, so the copy can be part of a command list
+		auto context = RHI_Backend::GetContext();
+		context->CopyResource((ID3D11Resource*)m_renderTargetTexture, (ID3D11Resource*)source->m_renderTargetTexture);
+		if (m_depthEnabled)
+		{
+			context->CopyResource((ID3D11Resource*)m_depthStencilBuffer, (ID3D11Resource*)source->m_depthStencilBuffer);
+		}
+
+		return true;
+	}
+
+	bool RHI_RenderTexture::CopyRegionFrom(const shared_ptr<RHI_RenderTexture>& source, unsigned int x, unsigned int y)
+	{
+		if (!m_rhiDevice || !source)
+			return false;
+
+		if (source->m_format != m_format || x + source->m_width > m_width || y + source->m_height > m_height)
+		{
+			LOG_ERROR("D3D11_RenderTexture::CopyRegionFrom: Incompatible source.");
+			return false;
+		}
+
+		auto context = RHI_Backend::GetContext();
+		context->CopySubresourceRegion((ID3D11Resource*)m_renderTargetTexture, 0, x, y, 0, (ID3D11Resource*)source->m_renderTargetTexture, 0, nullptr);
+
+		return true;
+	}
+
+	bool RHI_RenderTexture::Readback_Request(unsigned int x /*= 0*/, unsigned int y /*= 0*/, unsigned int width /*= 0*/, unsigned int height /*= 0*/, unsigned int* request /*= nullptr*/)
+	{
+		if (!m_rhiDevice || !m_renderTargetTexture)
+			return false;
+
+		if (width == 0 || height == 0)
+		{
+			x = y	= 0;
+			width	= m_width;
+			height	= m_height;
+		}
+
+		if (x + width > m_width || y + height > m_height || (!m_readbackTextures.empty() && (width != m_readbackWidth || height != m_readbackHeight)))
+		{
+			LOG_ERROR("D3D11_RenderTexture::Readback_Request: Invalid region.");
+			return false;
+		}
+
+		// Create the staging textures the first time a readback is requested
+		if (m_readbackTextures.empty())
+		{
+			D3D11_TEXTURE2D_DESC textureDesc;
+			((ID3D11Texture2D*)m_renderTargetTexture)->GetDesc(&textureDesc);
+			textureDesc.Width			= width;
+			textureDesc.Height			= height;
+			textureDesc.Usage			= D3D11_USAGE_STAGING;
+			textureDesc.BindFlags		= 0;
+			textureDesc.CPUAccessFlags	= D3D11_CPU_ACCESS_READ;
+			textureDesc.MiscFlags		= 0;
+
+			for (unsigned int i = 0; i < READBACK_LATENCY; i++)
+			{
+				ID3D11Texture2D* texture = nullptr;
+				if (FAILED(RHI_Backend::GetDevice()->CreateTexture2D(&textureDesc, nullptr, &texture)))
+				{
+					LOG_ERROR("D3D11_RenderTexture::Readback_Request: CreateTexture2D() failed.");
+					return false;
+				}
+				m_readbackTextures.emplace_back(texture);
+			}
+			m_readbackRequests.assign(READBACK_LATENCY, 0);
+			m_readbackWidth		= width;
+			m_readbackHeight	= height;
+		}
+
+		// Use an idle staging texture, or overwrite the oldest request if they are all in flight
+		unsigned int index = 0;
+		for (unsigned int i = 1; i < (unsigned int)m_readbackRequests.size(); i++)
+		{
+			if (m_readbackRequests[i] < m_readbackRequests[index])
+			{
+				index = i;
+			}
+		}
+
+		m_readbackRequests[index] = ++m_readbackCount;
+		if (request)
+		{
+			*request = m_readbackCount;
+		}
+		auto context = RHI_Backend::GetContext();
+		if (width == m_width && height == m_height)
+		{
+			context->CopyResource((ID3D11Resource*)m_readbackTextures[index], (ID3D11Resource*)m_renderTargetTexture);
+		}
+		else
+		{
+			D3D11_BOX box = { x, y, 0, x + width, y + height, 1 };
+			context->CopySubresourceRegion((ID3D11Resource*)m_readbackTextures[index], 0, 0, 0, 0, (ID3D11Resource*)m_renderTargetTexture, 0, &box);
+		}
+		return true;
+	}
+
+	bool RHI_RenderTexture::Readback_Get(vector<unsigned char>& data, unsigned int* request /*= nullptr*/)
+	{
+		if (!m_rhiDevice || m_readbackTextures.empty())
+			return false;
+
+		auto context	= RHI_Backend::GetContext();
+		auto rowSize	= m_readbackWidth * Texture_Format_GetBytes(m_format);
+		bool found		= false;
+
+		// Requests finish in order, so stop at the first one the GPU is still working on
+		while (true)
+		{
+			unsigned int index = (unsigned int)m_readbackRequests.size();
+			for (unsigned int i = 0; i < (unsigned int)m_readbackRequests.size(); i++)
+			{
+				if (m_readbackRequests[i] != 0 && (index == m_readbackRequests.size() || m_readbackRequests[i] < m_readbackRequests[index]))
+				{
+					index = i;
+				}
+			}
+
+			if (index == m_readbackRequests.size())
+				break;
+
+			D3D11_MAPPED_SUBRESOURCE mappedResource;
+			if (context->Map((ID3D11Resource*)m_readbackTextures[index], 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource) != S_OK)
+				break;
+
+			data.resize(rowSize * m_readbackHeight);
+			for (unsigned int y = 0; y < m_readbackHeight; y++)
+			{
+				memcpy(&data[y * rowSize], (unsigned char*)mappedResource.pData + y * mappedResource.RowPitch, rowSize);
+			}
+			context->Unmap((ID3D11Resource*)m_readbackTextures[index], 0);
+
+			if (request)
+			{
+				*request = m_readbackRequests[index];
+			}
+			m_readbackRequests[index]	= 0;
+			found						= true;
+		}
+
+		return found;
+	}
+
 	void RHI_RenderTexture::ComputeOrthographicProjectionMatrix(float nearPlane, float farPlane)
 	{
 		if (m_nearPlane == nearPlane && m_farPlane == farPlane)
@@ -211,4 +399,5 @@ namespace Directus
 	{
 		return m_depthStencilView;
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
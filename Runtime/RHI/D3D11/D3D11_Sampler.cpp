@@ -19,8 +19,12 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =====================
+//= IMPLEMENTATION ===============
 #include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES =====================
 #include "../RHI_Sampler.h"
 #include <winerror.h>
 #include "../RHI_Device.h"
@@ -42,7 +46,7 @@ namespace Directus
 		m_textureAddressMode	= textureAddressMode;
 		m_comparisonFunction	= comparisonFunction;
 
-		if (!rhiDevice || !rhiDevice->GetDevice<ID3D11Device>())
+		if (!rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("D3D11_Sampler::RHI_Sampler: Invalid device.");
 			return;
@@ -64,7 +68,7 @@ namespace Directus
 		samplerDesc.MaxLOD			= FLT_MAX;
 
 		// Create sampler state.
-		if (FAILED(rhiDevice->GetDevice<ID3D11Device>()->CreateSamplerState(&samplerDesc, (ID3D11SamplerState**)&m_buffer)))
+		if (FAILED(RHI_Backend::GetDevice()->CreateSamplerState(&samplerDesc, (ID3D11SamplerState**)&m_buffer)))
 		{
 			LOG_ERROR("RHI_Sampler::RHI_Sampler: Failed to create sampler state");
 		}
@@ -78,4 +82,5 @@ namespace Directus
 			m_buffer = nullptr;
 		}
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -19,13 +19,20 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ===========================
+//= IMPLEMENTATION ===============
 #include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES ===========================
 #include "../RHI_Device.h"
 #include "../RHI_Shader.h"
 #include "../RHI_InputLayout.h"
 #include <d3dcompiler.h>
 #include <sstream> 
+#include <fstream>
+#include <set>
+#include <functional>
 #include "../../Logging/Log.h"
 #include "../../FileSystem/FileSystem.h"
 #include "../../Core/GUIDGenerator.h"
@@ -59,13 +66,76 @@ namespace Directus
 			}
 		}
 
-		inline bool CompileShader(const string& filePath, D3D_SHADER_MACRO* macros, const char* entryPoint, const char* shaderModel, ID3DBlob** shaderBlobOut)
+		// Appends the file and everything it includes, so editing a shared header invalidates its users
+		inline void GatherSource(const string& filePath, set<string>& visited, string& source)
+		{
+			if (!visited.insert(filePath).second)
+				return;
+
+			ifstream file(filePath, ios::binary);
+			if (!file.is_open())
+				return;
+
+			string line;
+			while (getline(file, line))
+			{
+				source += line;
+				source += '\n';
+
+				auto include = line.find("#include");
+				if (include == string::npos)
+					continue;
+
+				auto open	= line.find('"', include);
+				auto close	= open != string::npos ? line.find('"', open + 1) : string::npos;
+				if (close != string::npos)
+				{
+					GatherSource(FileSystem::GetDirectoryFromFilePath(filePath) + line.substr(open + 1, close - open - 1), visited, source);
+				}
+			}
+		}
+
+		// Returns the bytecode path for this exact compilation, empty when caching is disabled
+		inline string GetCachePath(const string& filePath, D3D_SHADER_MACRO* macros, const char* entryPoint, const char* shaderModel, unsigned compileFlags)
+		{
+			if (RHI_Shader::GetCacheDirectory().empty())
+				return "";
+
+			string key;
+			set<string> visited;
+			GatherSource(filePath, visited, key);
+			if (key.empty())
+				return "";
+
+			for (auto macro = macros; macro && macro->Name; macro++)
+			{
+				key += string(macro->Name) + "=" + (macro->Definition ? macro->Definition : "") + ";";
+			}
+			key += string(entryPoint) + ";" + shaderModel + ";" + to_string(compileFlags);
+
+			stringstream name;
+			name << FileSystem::GetFileNameNoExtensionFromFilePath(filePath) << "_" << hex << hash<string>()(key) << ".cso";
+			return RHI_Shader::GetCacheDirectory() + name.str();
+		}
+
+		inline bool CompileShader(const string& filePath, D3D_SHADER_MACRO* macros, const char* entryPoint, const char* shaderModel, ID3DBlob** shaderBlobOut, string* cachePathOut = nullptr)
 		{
 			unsigned compileFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
 			#ifdef DEBUG
 			compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_PREFER_FLOW_CONTROL;
 			#endif
 
+			// Load from the bytecode cache
+			string cachePath = GetCachePath(filePath, macros, entryPoint, shaderModel, compileFlags);
+			if (!cachePath.empty() && FileSystem::FileExists(cachePath))
+			{
+				if (SUCCEEDED(D3DReadFileToBlob(FileSystem::StringToWString(cachePath).c_str(), shaderBlobOut)))
+				{
+					if (cachePathOut) *cachePathOut = cachePath;
+					return true;
+				}
+			}
+
 			// Load and compile from file
 			ID3DBlob* errorBlob		= nullptr;
 			ID3DBlob* shaderBlob	= nullptr;
@@ -101,6 +171,14 @@ namespace Directus
 					LOGF_ERROR("D3D11_Shader::CompileShader: An error occured when trying to load and compile \"%s\"", shaderName.c_str());
 				}
 			}
+			else if (!cachePath.empty())
+			{
+				// Store for the next launch
+				if (FAILED(D3DWriteBlobToFile(shaderBlob, FileSystem::StringToWString(cachePath).c_str(), TRUE)))
+				{
+					LOGF_WARNING("D3D11_Shader::CompileShader: Failed to cache \"%s\"", cachePath.c_str());
+				}
+			}
 
 			// Write to blob out
 			*shaderBlobOut = shaderBlob;
@@ -116,12 +194,24 @@ namespace Directus
 				return false;
 			}
 			// Compile shader
-			if (!CompileShader(path, macros, entrypoint, shaderModel, vsBlob))
+			string cachePath;
+			if (!CompileShader(path, macros, entrypoint, shaderModel, vsBlob, &cachePath))
 				return false;
 
-			// Create the shader from the buffer.
+			// Create the shader from the buffer, a cached blob which the device rejects is discarded and compiled again
 			ID3D10Blob* vsb = *vsBlob;
-			if (FAILED(device->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vertexShader)))
+			auto result = device->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vertexShader);
+			if (FAILED(result) && !cachePath.empty())
+			{
+				SafeRelease(*vsBlob);
+				FileSystem::DeleteFile_(cachePath);
+				if (!CompileShader(path, macros, entrypoint, shaderModel, vsBlob))
+					return false;
+				vsb = *vsBlob;
+				result = device->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vertexShader);
+			}
+
+			if (FAILED(result))
 			{
 				LOG_ERROR("D3D11_Shader::CompileVertexShader: Failed to create vertex shader.");
 				return false;
@@ -139,12 +229,24 @@ namespace Directus
 			}
 
 			// Compile the shader
-			if (!CompileShader(path, macros, entrypoint, shaderModel, psBlob))
+			string cachePath;
+			if (!CompileShader(path, macros, entrypoint, shaderModel, psBlob, &cachePath))
 				return false;
 
-			// Create the shader from the buffer.
+			// Create the shader from the buffer, a cached blob which the device rejects is discarded and compiled again
 			ID3D10Blob* psb = *psBlob;
-			if (FAILED(device->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, pixelShader)))
+			auto result = device->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, pixelShader);
+			if (FAILED(result) && !cachePath.empty())
+			{
+				SafeRelease(*psBlob);
+				FileSystem::DeleteFile_(cachePath);
+				if (!CompileShader(path, macros, entrypoint, shaderModel, psBlob))
+					return false;
+				psb = *psBlob;
+				result = device->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, pixelShader);
+			}
+
+			if (FAILED(result))
 			{
 				LOG_ERROR("D3D11_Shader::CompilePixelShader: Failed to create pixel shader.");
 				return false;
@@ -153,6 +255,41 @@ namespace Directus
 			return true;
 		}
 
+		inline bool CompileComputeShader(ID3D11Device* device, ID3D10Blob** csBlob, ID3D11ComputeShader** computeShader, const string& path, const char* entrypoint, const char* shaderModel, D3D_SHADER_MACRO* macros)
+		{
+			if (!device)
+			{
+				LOG_ERROR("D3D11_Shader::CompileComputeShader: Invalid device.");
+				return false;
+			}
+
+			// Compile the shader
+			string cachePath;
+			if (!CompileShader(path, macros, entrypoint, shaderModel, csBlob, &cachePath))
+				return false;
+
+			// Create the shader from the buffer, a cached blob which the device rejects is discarded and compiled again
+			ID3D10Blob* csb = *csBlob;
+			auto result = device->CreateComputeShader(csb->GetBufferPointer(), csb->GetBufferSize(), nullptr, computeShader);
+			if (FAILED(result) && !cachePath.empty())
+			{
+				SafeRelease(*csBlob);
+				FileSystem::DeleteFile_(cachePath);
+				if (!CompileShader(path, macros, entrypoint, shaderModel, csBlob))
+					return false;
+				csb = *csBlob;
+				result = device->CreateComputeShader(csb->GetBufferPointer(), csb->GetBufferSize(), nullptr, computeShader);
+			}
+
+			if (FAILED(result))
+			{
+				LOG_ERROR("D3D11_Shader::CompileComputeShader: Failed to create compute shader.");
+				return false;
+			}
+
+			return true;
+		}
+
 		inline vector<D3D_SHADER_MACRO> GetD3DMacros(const map<string, string>& macros)
 		{
 			vector<D3D_SHADER_MACRO> d3dMacros;	
@@ -177,6 +314,7 @@ namespace Directus
 	{
 		SafeRelease((ID3D11VertexShader*)m_vertexShader);
 		SafeRelease((ID3D11PixelShader*)m_pixelShader);
+		SafeRelease((ID3D11ComputeShader*)m_computeShader);
 	}
 
 	bool RHI_Shader::Compile_Vertex(const string& filePath, Input_Layout inputLayout)
@@ -188,34 +326,34 @@ namespace Directus
 		vsMacros.push_back(D3D_SHADER_MACRO{ "COMPILE_PS", "0" });
 		vsMacros.push_back(D3D_SHADER_MACRO{ nullptr, nullptr });
 
-		ID3D10Blob* blobVS	= nullptr;
-		auto shaderPtr		= (ID3D11VertexShader**)&m_vertexShader;
+		ID3D10Blob* blobVS				= nullptr;
+		ID3D11VertexShader* shader		= nullptr;
 
-		// Compile the shader
+		// Compile the shader, a shader that is compiled again is only replaced if that succeeds
 		if (D3D11_Shader::CompileVertexShader(
-			m_rhiDevice->GetDevice<ID3D11Device>(),
+			RHI_Backend::GetDevice(),
 			&blobVS,
-			shaderPtr,
+			&shader,
 			m_filePath,
 			VERTEX_SHADER_ENTRYPOINT,
 			VERTEX_SHADER_MODEL,
 			&vsMacros.front()))
 		{
-			// Create input layout
-			if (!m_inputLayout->Create(blobVS, inputLayout))
+			// Create input layout, it only depends on the layout so it's kept when the shader is compiled again
+			if (!m_inputLayout->GetBuffer() && !m_inputLayout->Create(blobVS, inputLayout))
 			{
 				LOGF_ERROR("D3D11_Shader::SetInputLayout: Failed to create vertex input layout for %s", FileSystem::GetFileNameFromFilePath(m_filePath).data());
 			}
 
 			SafeRelease(blobVS);
+			SafeRelease((ID3D11VertexShader*)m_vertexShader);
+			m_vertexShader		= shader;
 			m_hasVertexShader	= true;
-		}
-		else
-		{
-			m_hasVertexShader	= false;
+			return true;
 		}
 
-		return m_hasVertexShader;
+		m_hasVertexShader = m_vertexShader != nullptr;
+		return false;
 	}
 
 	bool RHI_Shader::Compile_Pixel(const string& filePath)
@@ -227,13 +365,13 @@ namespace Directus
 		psMacros.push_back(D3D_SHADER_MACRO{ "COMPILE_PS", "1" });
 		psMacros.push_back(D3D_SHADER_MACRO{ nullptr, nullptr });
 
-		ID3D10Blob* blobPS	= nullptr;
-		auto shaderPtr		= (ID3D11PixelShader**)&m_pixelShader;	
+		ID3D10Blob* blobPS			= nullptr;
+		ID3D11PixelShader* shader	= nullptr;
 
 		if (D3D11_Shader::CompilePixelShader(
-			m_rhiDevice->GetDevice<ID3D11Device>(),
+			RHI_Backend::GetDevice(),
 			&blobPS,
-			shaderPtr,
+			&shader,
 			m_filePath,
 			PIXEL_SHADER_ENTRYPOINT,
 			PIXEL_SHADER_MODEL,
@@ -241,13 +379,53 @@ namespace Directus
 		))
 		{
 			SafeRelease(blobPS);
-			m_hasPixelShader = true;
+			SafeRelease((ID3D11PixelShader*)m_pixelShader);
+			m_pixelShader		= shader;
+			m_hasPixelShader	= true;
+			return true;
+		}
+
+		m_hasPixelShader = m_pixelShader != nullptr;
+		return false;
+	}
+
+	bool RHI_Shader::Compile_Compute(const string& filePath)
+	{
+		m_filePath		= filePath;
+		m_shaderState	= Shader_Compiling;
+
+		vector<D3D_SHADER_MACRO> csMacros = D3D11_Shader::GetD3DMacros(m_macros);
+		csMacros.push_back(D3D_SHADER_MACRO{ "COMPILE_VS", "0" });
+		csMacros.push_back(D3D_SHADER_MACRO{ "COMPILE_PS", "0" });
+		csMacros.push_back(D3D_SHADER_MACRO{ "COMPILE_CS", "1" });
+		csMacros.push_back(D3D_SHADER_MACRO{ nullptr, nullptr });
+
+		ID3D10Blob* blobCS	= nullptr;
+		auto shaderPtr		= (ID3D11ComputeShader**)&m_computeShader;
+
+		if (D3D11_Shader::CompileComputeShader(
+			RHI_Backend::GetDevice(),
+			&blobCS,
+			shaderPtr,
+			m_filePath,
+			COMPUTE_SHADER_ENTRYPOINT,
+			COMPUTE_SHADER_MODEL,
+			&csMacros.front()
+		))
+		{
+			SafeRelease(blobCS);
+			m_hasComputeShader	= true;
+			m_shaderState		= Shader_Built;
+			LOGF_INFO("RHI_Shader::Compile_Compute: Successfully compiled %s", filePath.c_str());
 		}
 		else
 		{
-			m_hasPixelShader = false;
+			m_hasComputeShader	= false;
+			m_shaderState		= Shader_Failed;
+			LOGF_ERROR("RHI_Shader::Compile_Compute: Failed to compile %s", filePath.c_str());
 		}
 
-		return m_hasPixelShader;
+		return m_hasComputeShader;
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,232 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES =======================
+#include "../RHI_StructuredBuffer.h"
+#include <d3d11.h>
+#include "../../Logging/Log.h"
+#include "../RHI_Device.h"
+#include "../RHI_Capture.h"
+//==================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	RHI_StructuredBuffer::RHI_StructuredBuffer(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice				= rhiDevice;
+		m_buffer				= nullptr;
+		m_shaderResourceView	= nullptr;
+		m_unorderedAccessView	= nullptr;
+		m_stride				= 0;
+		m_elementCount			= 0;
+	}
+
+	RHI_StructuredBuffer::~RHI_StructuredBuffer()
+	{
+		if (m_unorderedAccessView)
+		{
+			((ID3D11UnorderedAccessView*)m_unorderedAccessView)->Release();
+			m_unorderedAccessView = nullptr;
+		}
+
+		if (m_shaderResourceView)
+		{
+			((ID3D11ShaderResourceView*)m_shaderResourceView)->Release();
+			m_shaderResourceView = nullptr;
+		}
+
+		if (m_buffer)
+		{
+			((ID3D11Buffer*)m_buffer)->Release();
+			m_buffer = nullptr;
+		}
+	}
+
+	bool RHI_StructuredBuffer::Create(unsigned int stride, unsigned int elementCount, const void* data /*= nullptr*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Create: Invalid RHI device");
+			return false;
+		}
+
+		m_stride		= stride;
+		m_elementCount	= elementCount;
+
+		D3D11_BUFFER_DESC bufferDesc;
+		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+		bufferDesc.ByteWidth			= stride * elementCount;
+		bufferDesc.Usage				= data ? D3D11_USAGE_IMMUTABLE : D3D11_USAGE_DYNAMIC;
+		bufferDesc.BindFlags			= D3D11_BIND_SHADER_RESOURCE;
+		bufferDesc.CPUAccessFlags		= data ? 0 : D3D11_CPU_ACCESS_WRITE;
+		bufferDesc.MiscFlags			= D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		bufferDesc.StructureByteStride	= stride;
+
+		D3D11_SUBRESOURCE_DATA initData;
+		ZeroMemory(&initData, sizeof(initData));
+		initData.pSysMem = data;
+
+		HRESULT result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, data ? &initData : nullptr, (ID3D11Buffer**)&m_buffer);
+		if FAILED(result)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Create: Failed to create structured buffer");
+			return false;
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+		ZeroMemory(&viewDesc, sizeof(viewDesc));
+		viewDesc.Format					= DXGI_FORMAT_UNKNOWN;
+		viewDesc.ViewDimension			= D3D11_SRV_DIMENSION_BUFFER;
+		viewDesc.Buffer.FirstElement	= 0;
+		viewDesc.Buffer.NumElements		= elementCount;
+
+		result = RHI_Backend::GetDevice()->CreateShaderResourceView((ID3D11Buffer*)m_buffer, &viewDesc, (ID3D11ShaderResourceView**)&m_shaderResourceView);
+		if FAILED(result)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Create: Failed to create shader resource view");
+			return false;
+		}
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, stride * elementCount);
+		return true;
+	}
+
+	bool RHI_StructuredBuffer::CreateUnorderedAccess(unsigned int stride, unsigned int elementCount, bool drawArguments /*= false*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_StructuredBuffer::CreateUnorderedAccess: Invalid RHI device");
+			return false;
+		}
+
+		m_stride		= stride;
+		m_elementCount	= elementCount;
+
+		// Indirect arguments can't live in a structured buffer, they go in a raw one
+		D3D11_BUFFER_DESC bufferDesc;
+		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+		bufferDesc.ByteWidth			= stride * elementCount;
+		bufferDesc.Usage				= D3D11_USAGE_DEFAULT;
+		bufferDesc.BindFlags			= D3D11_BIND_UNORDERED_ACCESS | (drawArguments ? 0 : D3D11_BIND_SHADER_RESOURCE);
+		bufferDesc.CPUAccessFlags		= 0;
+		bufferDesc.MiscFlags			= drawArguments ? (D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS | D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS) : D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		bufferDesc.StructureByteStride	= drawArguments ? 0 : stride;
+
+		HRESULT result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, nullptr, (ID3D11Buffer**)&m_buffer);
+		if FAILED(result)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::CreateUnorderedAccess: Failed to create structured buffer");
+			return false;
+		}
+
+		D3D11_UNORDERED_ACCESS_VIEW_DESC accessDesc;
+		ZeroMemory(&accessDesc, sizeof(accessDesc));
+		accessDesc.Format				= drawArguments ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_UNKNOWN;
+		accessDesc.ViewDimension		= D3D11_UAV_DIMENSION_BUFFER;
+		accessDesc.Buffer.FirstElement	= 0;
+		accessDesc.Buffer.NumElements	= drawArguments ? bufferDesc.ByteWidth / 4 : elementCount;
+		accessDesc.Buffer.Flags			= drawArguments ? D3D11_BUFFER_UAV_FLAG_RAW : 0;
+
+		result = RHI_Backend::GetDevice()->CreateUnorderedAccessView((ID3D11Buffer*)m_buffer, &accessDesc, (ID3D11UnorderedAccessView**)&m_unorderedAccessView);
+		if FAILED(result)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::CreateUnorderedAccess: Failed to create unordered access view");
+			return false;
+		}
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, stride * elementCount);
+
+		if (drawArguments)
+			return true;
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+		ZeroMemory(&viewDesc, sizeof(viewDesc));
+		viewDesc.Format					= DXGI_FORMAT_UNKNOWN;
+		viewDesc.ViewDimension			= D3D11_SRV_DIMENSION_BUFFER;
+		viewDesc.Buffer.FirstElement	= 0;
+		viewDesc.Buffer.NumElements		= elementCount;
+
+		result = RHI_Backend::GetDevice()->CreateShaderResourceView((ID3D11Buffer*)m_buffer, &viewDesc, (ID3D11ShaderResourceView**)&m_shaderResourceView);
+		if FAILED(result)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::CreateUnorderedAccess: Failed to create shader resource view");
+			return false;
+		}
+
+		return true;
+	}
+
+	void* RHI_StructuredBuffer::Map()
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Map: Invalid RHI device");
+			return nullptr;
+		}
+
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Map: Invalid buffer");
+			return nullptr;
+		}
+
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		HRESULT result = RHI_Backend::GetContext()->Map((ID3D11Buffer*)m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Map: Failed to map structured buffer.");
+			return nullptr;
+		}
+
+		RHI_CAPTURE(Record_Map(Capture_UpdateStructuredBuffer, this, m_buffer, mappedResource.pData, m_stride * m_elementCount));
+		return mappedResource.pData;
+	}
+
+	bool RHI_StructuredBuffer::Unmap()
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Unmap: Invalid RHI device");
+			return false;
+		}
+
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Unmap: Invalid buffer");
+			return false;
+		}
+
+		RHI_CAPTURE(Record_Unmap(this));
+		RHI_Backend::GetContext()->Unmap((ID3D11Buffer*)m_buffer, 0);
+
+		return true;
+	}
+}
+#endif
\ No newline at end of file
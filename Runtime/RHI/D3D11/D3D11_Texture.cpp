@@ -19,11 +19,16 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =====================
+//= IMPLEMENTATION ===============
 #include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES =====================
 #include "../RHI_Device.h"
 #include "../RHI_Texture.h"
 #include "../../Math/MathHelper.h"
+#include <thread>
 //================================
 
 //= NAMESPAECES =======================
@@ -35,7 +40,7 @@ namespace Directus
 {
 	bool RHI_Texture::ShaderResource_Create2D(unsigned int width, unsigned int height, unsigned int channels, Texture_Format format, const vector<vector<std::byte>>& data, bool generateMimaps /*= false*/)
 	{
-		if (!m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_Texture::ShaderResource_Create: Invalid device.");
 			return false;
@@ -86,7 +91,7 @@ namespace Directus
 
 			vec_subresourceData.emplace_back(D3D11_SUBRESOURCE_DATA{});
 			vec_subresourceData.back().pSysMem			= data[i].data();
-			vec_subresourceData.back().SysMemPitch		= (mipWidth * channels) * sizeof(std::byte);
+			vec_subresourceData.back().SysMemPitch		= Format_GetRowPitch(format, mipWidth, channels);
 			vec_subresourceData.back().SysMemSlicePitch = 0;
 
 			// Compute size of next mip-map
@@ -105,7 +110,7 @@ namespace Directus
 		shaderResourceDesc.Texture2D.MipLevels			= textureDesc.MipLevels;
 
 		// Create texture
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateTexture2D(&textureDesc, generateMimaps ? nullptr : vec_subresourceData.data(), &texture);
+		auto result = RHI_Backend::GetDevice()->CreateTexture2D(&textureDesc, generateMimaps ? nullptr : vec_subresourceData.data(), &texture);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_Texture::ShaderResource_Create2D: Failed to create ID3D11Texture2D. Invalid CreateTexture2D() parameters.");
@@ -113,21 +118,29 @@ namespace Directus
 		}
 
 		// Create shader resource
-		result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateShaderResourceView(texture, &shaderResourceDesc, &shaderResourceView);
+		result = RHI_Backend::GetDevice()->CreateShaderResourceView(texture, &shaderResourceDesc, &shaderResourceView);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_Texture::ShaderResource_Create2D: Failed to create the ID3D11ShaderResourceView.");
+			SafeRelease(texture);
 			return false;
 		}
 
 		// Generate mip-maps
 		if (generateMimaps)
 		{
-			m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->UpdateSubresource(texture, 0, nullptr, data[0].data(), (width * channels) * sizeof(std::byte), 0);
-			m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->GenerateMips(shaderResourceView);
+			RHI_Backend::GetContext()->UpdateSubresource(texture, 0, nullptr, data[0].data(), (width * channels) * sizeof(std::byte), 0);
+			RHI_Backend::GetContext()->GenerateMips(shaderResourceView);
 		}
 
-		m_shaderResource = shaderResourceView;
+		// The view keeps the texture alive, so releasing the view releases both (streaming replaces textures often)
+		SafeRelease(texture);
+
+		m_shaderResource		= shaderResourceView;
+		m_shaderResourceWidth	= width;
+		m_shaderResourceHeight	= height;
+		m_shaderResourceMips	= textureDesc.MipLevels;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Textures, m_memoryUsage);
 		return true;
 	}
 
@@ -181,7 +194,7 @@ namespace Directus
 				// D3D11_SUBRESOURCE_DATA
 				vec_subresourceData.emplace_back(D3D11_SUBRESOURCE_DATA{});
 				vec_subresourceData.back().pSysMem			= mip.data();									// Pointer to the pixel data			
-				vec_subresourceData.back().SysMemPitch		= (mipWidth * channels) * sizeof(std::byte);	// Line width in bytes
+				vec_subresourceData.back().SysMemPitch		= Format_GetRowPitch(format, mipWidth, channels);	// Line width in bytes
 				vec_subresourceData.back().SysMemSlicePitch = 0;											// This is only used for 3D textures.
 
 				// Compute size of next mip-map
@@ -203,14 +216,14 @@ namespace Directus
 		shaderResourceDesc.TextureCube.MostDetailedMip	= 0;
 
 		// Validate device before usage
-		if (!m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_Texture::ShaderResource_CreateCubemap: Invalid RHI device.");
 			return false;
 		}
 
 		// Create the Texture Resource
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateTexture2D(vec_textureDesc.data(), vec_subresourceData.data(), &cubeTexture);
+		auto result = RHI_Backend::GetDevice()->CreateTexture2D(vec_textureDesc.data(), vec_subresourceData.data(), &cubeTexture);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_Texture::ShaderResource_CreateCubemap: Failed to create ID3D11Texture2D. Invalid CreateTexture2D() parameters.");
@@ -218,19 +231,166 @@ namespace Directus
 		}
 
 		// If we have created the texture resource for the six faces we create the Shader Resource View to use in our shaders.
-		result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateShaderResourceView(cubeTexture, &shaderResourceDesc, &shaderResourceView);
+		result = RHI_Backend::GetDevice()->CreateShaderResourceView(cubeTexture, &shaderResourceDesc, &shaderResourceView);
+		SafeRelease(cubeTexture);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_Texture::ShaderResource_CreateCubemap: Failed to create the ID3D11ShaderResourceView.");
 			return false;
 		}
 
-		m_shaderResource = shaderResourceView;
+		m_shaderResource		= shaderResourceView;
+		m_shaderResourceWidth	= width;
+		m_shaderResourceHeight	= height;
+		m_shaderResourceMips	= mipLevels;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Textures, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_Texture::ShaderResource_GenerateMips(unsigned int width, unsigned int height, unsigned int channels)
+	{
+		auto device = m_rhiDevice ? RHI_Backend::GetDevice() : nullptr;
+		if (!device || m_data.empty() || channels != 4 || m_data[0].size() != width * height * channels)
+			return false;
+
+		// The same chain the importer generates on the CPU, it stops once either side is a single pixel
+		UINT mipLevels = 1;
+		for (unsigned int w = width, h = height; w > 1 && h > 1; w /= 2, h /= 2)
+		{
+			mipLevels++;
+		}
+
+		// Typeless, so the chain can be generated through an sRGB view (which filters in linear space) and sampled through a plain one
+		D3D11_TEXTURE2D_DESC textureDesc;
+		textureDesc.Width				= width;
+		textureDesc.Height				= height;
+		textureDesc.MipLevels			= mipLevels;
+		textureDesc.ArraySize			= 1;
+		textureDesc.Format				= DXGI_FORMAT_R8G8B8A8_TYPELESS;
+		textureDesc.SampleDesc.Count	= 1;
+		textureDesc.SampleDesc.Quality	= 0;
+		textureDesc.Usage				= D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags			= D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET; // D3D11_RESOURCE_MISC_GENERATE_MIPS flag requires D3D11_BIND_RENDER_TARGET
+		textureDesc.MiscFlags			= D3D11_RESOURCE_MISC_GENERATE_MIPS;
+		textureDesc.CPUAccessFlags		= 0;
+
+		ID3D11Texture2D* texture = nullptr;
+		if (FAILED(device->CreateTexture2D(&textureDesc, nullptr, &texture)))
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_GenerateMips: Failed to create ID3D11Texture2D.");
+			return false;
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceDesc;
+		shaderResourceDesc.Format						= m_isSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+		shaderResourceDesc.ViewDimension				= D3D11_SRV_DIMENSION_TEXTURE2D;
+		shaderResourceDesc.Texture2D.MostDetailedMip	= 0;
+		shaderResourceDesc.Texture2D.MipLevels			= mipLevels;
+
+		ID3D11ShaderResourceView* generateView			= nullptr;
+		ID3D11ShaderResourceView* shaderResourceView	= nullptr;
+		auto result = device->CreateShaderResourceView(texture, &shaderResourceDesc, &generateView);
+		shaderResourceDesc.Format = d3d11_dxgi_format[Texture_Format_R8G8B8A8_UNORM];
+		if (SUCCEEDED(result))
+		{
+			result = device->CreateShaderResourceView(texture, &shaderResourceDesc, &shaderResourceView);
+		}
+		if (FAILED(result))
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_GenerateMips: Failed to create the ID3D11ShaderResourceView.");
+			SafeRelease(generateView);
+			SafeRelease(texture);
+			return false;
+		}
+
+		// The immediate context is multithread protected and neither call depends on bound state, so importing threads can issue them
+		auto context = RHI_Backend::GetContext();
+		context->UpdateSubresource(texture, 0, nullptr, m_data[0].data(), Format_GetRowPitch(Texture_Format_R8G8B8A8_UNORM, width, channels), 0);
+		context->GenerateMips(generateView);
+		SafeRelease(generateView);
+		SafeRelease(texture);
+
+		// Rough estimation, the chain adds a third
+		ShaderResource_Release();
+		m_memoryUsage			= (unsigned int)(m_data[0].size() + m_data[0].size() / 3);
+		m_shaderResource		= shaderResourceView;
+		m_shaderResourceWidth	= width;
+		m_shaderResourceHeight	= height;
+		m_shaderResourceMips	= mipLevels;
+		m_mipsOnGPU				= true;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Textures, m_memoryUsage);
 		return true;
 	}
 
+	bool RHI_Texture::ShaderResource_ReadMips(vector<Mipmap>* mips)
+	{
+		auto shaderResourceView = (ID3D11ShaderResourceView*)m_shaderResource;
+		if (!mips || !shaderResourceView || !m_mipsOnGPU)
+			return false;
+
+		ID3D11Resource* resource = nullptr;
+		shaderResourceView->GetResource(&resource);
+		auto texture = (ID3D11Texture2D*)resource;
+
+		// Copy into a texture the CPU can read
+		D3D11_TEXTURE2D_DESC textureDesc;
+		texture->GetDesc(&textureDesc);
+		textureDesc.Usage			= D3D11_USAGE_STAGING;
+		textureDesc.BindFlags		= 0;
+		textureDesc.MiscFlags		= 0;
+		textureDesc.CPUAccessFlags	= D3D11_CPU_ACCESS_READ;
+
+		ID3D11Texture2D* staging = nullptr;
+		if (FAILED(RHI_Backend::GetDevice()->CreateTexture2D(&textureDesc, nullptr, &staging)))
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_ReadMips: Failed to create the staging texture.");
+			SafeRelease(resource);
+			return false;
+		}
+
+		auto context = RHI_Backend::GetContext();
+		context->CopyResource(staging, texture);
+		context->Flush();
+		SafeRelease(resource);
+
+		mips->clear();
+		bool result = true;
+		for (UINT i = 0; i < textureDesc.MipLevels && result; i++)
+		{
+			// Without waiting inside Map(), other threads would be locked out of the context until the GPU is done
+			D3D11_MAPPED_SUBRESOURCE mapped;
+			HRESULT mapResult;
+			while ((mapResult = context->Map(staging, i, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped)) == DXGI_ERROR_WAS_STILL_DRAWING)
+			{
+				this_thread::yield();
+			}
+			if (FAILED(mapResult))
+			{
+				LOGF_ERROR("RHI_Texture::ShaderResource_ReadMips: Failed to map mip %d.", i);
+				result = false;
+				break;
+			}
+
+			// The mapped rows may be padded
+			unsigned int width		= Max(textureDesc.Width >> i, 1u);
+			unsigned int height		= Max(textureDesc.Height >> i, 1u);
+			unsigned int rowPitch	= Format_GetRowPitch(Texture_Format_R8G8B8A8_UNORM, width, 4);
+			auto& mip = mips->emplace_back(Mipmap(rowPitch * height));
+			for (unsigned int row = 0; row < height; row++)
+			{
+				memcpy(&mip[row * rowPitch], (std::byte*)mapped.pData + row * mapped.RowPitch, rowPitch);
+			}
+			context->Unmap(staging, i);
+		}
+		SafeRelease(staging);
+
+		return result;
+	}
+
 	void RHI_Texture::ShaderResource_Release()
 	{
 		SafeRelease((ID3D11ShaderResourceView*)m_shaderResource);
+		m_shaderResource = nullptr;
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
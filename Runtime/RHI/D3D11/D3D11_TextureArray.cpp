@@ -0,0 +1,198 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES =====================
+#include "../RHI_TextureArray.h"
+#include "../RHI_Texture.h"
+#include "../RHI_Device.h"
+#include "../../Logging/Log.h"
+#include "../../Math/MathHelper.h"
+//================================
+
+//= NAMESPACES =======================
+using namespace std;
+using namespace Directus::Math::Helper;
+//====================================
+
+namespace Directus
+{
+	RHI_TextureArray::RHI_TextureArray(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice			= rhiDevice;
+		m_texture			= nullptr;
+		m_shaderResource	= nullptr;
+		m_width				= 0;
+		m_height			= 0;
+		m_mipCount			= 0;
+		m_sliceCount		= 0;
+		m_format			= Texture_Format_R8G8B8A8_UNORM;
+		m_cubemap			= false;
+		m_bytes				= 0;
+	}
+
+	RHI_TextureArray::~RHI_TextureArray()
+	{
+		SafeRelease((ID3D11ShaderResourceView*)m_shaderResource);
+		SafeRelease((ID3D11Texture2D*)m_texture);
+	}
+
+	bool RHI_TextureArray::Create(unsigned int width, unsigned int height, unsigned int mipCount, Texture_Format format, unsigned int sliceCount, bool cubemap /*= false*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_TextureArray::Create: Invalid RHI device");
+			return false;
+		}
+
+		// A cubemap's faces are consecutive slices of the resource
+		unsigned int faces = cubemap ? 6 : 1;
+
+		D3D11_TEXTURE2D_DESC textureDesc;
+		textureDesc.Width				= width;
+		textureDesc.Height				= height;
+		textureDesc.MipLevels			= mipCount;
+		textureDesc.ArraySize			= sliceCount * faces;
+		textureDesc.Format				= d3d11_dxgi_format[format];
+		textureDesc.SampleDesc.Count	= 1;
+		textureDesc.SampleDesc.Quality	= 0;
+		textureDesc.Usage				= D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags			= D3D11_BIND_SHADER_RESOURCE;
+		textureDesc.MiscFlags			= cubemap ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+		textureDesc.CPUAccessFlags		= 0;
+
+		auto result = RHI_Backend::GetDevice()->CreateTexture2D(&textureDesc, nullptr, (ID3D11Texture2D**)&m_texture);
+		if (FAILED(result))
+		{
+			LOG_ERROR("RHI_TextureArray::Create: Failed to create ID3D11Texture2D");
+			return false;
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceDesc;
+		shaderResourceDesc.Format = textureDesc.Format;
+		if (cubemap)
+		{
+			shaderResourceDesc.ViewDimension						= D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+			shaderResourceDesc.TextureCubeArray.MostDetailedMip		= 0;
+			shaderResourceDesc.TextureCubeArray.MipLevels			= mipCount;
+			shaderResourceDesc.TextureCubeArray.First2DArrayFace	= 0;
+			shaderResourceDesc.TextureCubeArray.NumCubes			= sliceCount;
+		}
+		else
+		{
+			shaderResourceDesc.ViewDimension					= D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+			shaderResourceDesc.Texture2DArray.MostDetailedMip	= 0;
+			shaderResourceDesc.Texture2DArray.MipLevels			= mipCount;
+			shaderResourceDesc.Texture2DArray.FirstArraySlice	= 0;
+			shaderResourceDesc.Texture2DArray.ArraySize			= sliceCount;
+		}
+
+		result = RHI_Backend::GetDevice()->CreateShaderResourceView((ID3D11Texture2D*)m_texture, &shaderResourceDesc, (ID3D11ShaderResourceView**)&m_shaderResource);
+		if (FAILED(result))
+		{
+			LOG_ERROR("RHI_TextureArray::Create: Failed to create the ID3D11ShaderResourceView");
+			return false;
+		}
+
+		// Every slice has the same mip chain (a rough estimation, like the textures' own)
+		unsigned long long sliceBytes = 0;
+		for (unsigned int mip = 0; mip < mipCount; mip++)
+		{
+			unsigned int mipWidth	= Max(width >> mip, 1u);
+			unsigned int mipHeight	= Max(height >> mip, 1u);
+			unsigned int rows		= RHI_Texture::Format_IsCompressed(format) ? Max((mipHeight + 3) / 4, 1u) : mipHeight;
+			sliceBytes += (unsigned long long)RHI_Texture::Format_GetRowPitch(format, mipWidth, 4) * rows * faces;
+		}
+
+		m_width			= width;
+		m_height		= height;
+		m_mipCount		= mipCount;
+		m_sliceCount	= sliceCount;
+		m_format		= format;
+		m_cubemap		= cubemap;
+		m_bytes			= sliceBytes * sliceCount;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Textures, m_bytes);
+		return true;
+	}
+
+	bool RHI_TextureArray::Slice_Copy(unsigned int slice, const RHI_Texture* texture)
+	{
+		auto context = m_rhiDevice ? RHI_Backend::GetContext() : nullptr;
+		if (!context || !m_texture || !texture || !texture->GetShaderResource() || slice >= m_sliceCount)
+			return false;
+
+		ID3D11Resource* source = nullptr;
+		((ID3D11ShaderResourceView*)texture->GetShaderResource())->GetResource(&source);
+		if (!source)
+			return false;
+
+		// Both have to agree, or the copy silently reads the wrong mips
+		D3D11_TEXTURE2D_DESC sourceDesc;
+		((ID3D11Texture2D*)source)->GetDesc(&sourceDesc);
+		unsigned int faces = m_cubemap ? 6 : 1;
+		if (sourceDesc.Width != m_width || sourceDesc.Height != m_height || sourceDesc.MipLevels != m_mipCount || sourceDesc.Format != d3d11_dxgi_format[m_format] || sourceDesc.ArraySize != faces)
+		{
+			LOG_ERROR("RHI_TextureArray::Slice_Copy: The texture doesn't match the array");
+			source->Release();
+			return false;
+		}
+
+		for (unsigned int face = 0; face < faces; face++)
+		{
+			for (unsigned int mip = 0; mip < m_mipCount; mip++)
+			{
+				context->CopySubresourceRegion((ID3D11Resource*)m_texture, D3D11CalcSubresource(mip, slice * faces + face, m_mipCount), 0, 0, 0, source, D3D11CalcSubresource(mip, face, m_mipCount), nullptr);
+			}
+		}
+		source->Release();
+		return true;
+	}
+
+	bool RHI_TextureArray::Slices_Copy(const RHI_TextureArray* source)
+	{
+		auto context = m_rhiDevice ? RHI_Backend::GetContext() : nullptr;
+		if (!context || !m_texture || !source || !source->m_texture)
+			return false;
+
+		if (source->m_width != m_width || source->m_height != m_height || source->m_mipCount != m_mipCount || source->m_format != m_format || source->m_cubemap != m_cubemap)
+		{
+			LOG_ERROR("RHI_TextureArray::Slices_Copy: The arrays don't match");
+			return false;
+		}
+
+		// A cubemap's faces are slices too
+		unsigned int faces = m_cubemap ? 6 : 1;
+		for (unsigned int slice = 0; slice < Min(m_sliceCount, source->m_sliceCount) * faces; slice++)
+		{
+			for (unsigned int mip = 0; mip < m_mipCount; mip++)
+			{
+				auto subresource = D3D11CalcSubresource(mip, slice, m_mipCount);
+				context->CopySubresourceRegion((ID3D11Resource*)m_texture, subresource, 0, 0, 0, (ID3D11Resource*)source->m_texture, subresource, nullptr);
+			}
+		}
+		return true;
+	}
+}
+#endif
@@ -19,10 +19,15 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =====================
+//= IMPLEMENTATION ===============
 #include "../RHI_Implementation.h"
+#ifdef API_D3D11
+//================================
+
+//= INCLUDES =====================
 #include "../RHI_Device.h"
 #include "../RHI_VertexBuffer.h"
+#include "../RHI_Capture.h"
 #include "../RHI_Vertex.h"
 #include "../../Logging/Log.h"
 //================================
@@ -36,19 +41,21 @@ namespace Directus
 	RHI_VertexBuffer::RHI_VertexBuffer(std::shared_ptr<RHI_Device> rhiDevice)
 	{
 		m_rhiDevice		= rhiDevice;
-		m_buffer		= nullptr;
-		m_stride		= 0;
-		m_memoryUsage	= 0;
+		m_buffer				= nullptr;
+		m_unorderedAccessView	= nullptr;
+		m_stride				= 0;
+		m_memoryUsage			= 0;
 	}
 
 	RHI_VertexBuffer::~RHI_VertexBuffer()
 	{
+		SafeRelease((ID3D11UnorderedAccessView*)m_unorderedAccessView);
 		SafeRelease((ID3D11Buffer*)m_buffer);
 	}
 
 	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosCol>& vertices)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_VertexBuffer::Create: Invalid RHI device");
 			return false;
@@ -84,19 +91,20 @@ namespace Directus
 		m_memoryUsage = (unsigned int)(sizeof(RHI_Vertex_PosCol) * vertices.size());
 
 		auto ptr = (ID3D11Buffer**)&m_buffer;
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateBuffer(&bufferDesc, &initData, ptr);
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, &initData, ptr);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_VertexBuffer::Create: Failed to create vertex buffer");
 			return false;
 		}
 
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
 		return true;
 	}
 
 	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosUV>& vertices)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDevice<ID3D11Device>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_VertexBuffer::Create: Invalid RHI device");
 			return false;
@@ -132,19 +140,20 @@ namespace Directus
 		m_memoryUsage = (unsigned int)(sizeof(RHI_Vertex_PosUV) * vertices.size());
 
 		auto ptr = (ID3D11Buffer**)&m_buffer;
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateBuffer(&bufferDesc, &initData, ptr);
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, &initData, ptr);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_VertexBuffer::Create: Failed to create vertex buffer");
 			return false;
 		}
 
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
 		return true;
 	}
 
 	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosUVTBN>& vertices)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDevice<ID3D11Device>() || vertices.empty())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice() || vertices.empty())
 			return false;
 
 		m_stride = sizeof(RHI_Vertex_PosUVTBN);
@@ -171,19 +180,60 @@ namespace Directus
 		m_memoryUsage = (unsigned int)(sizeof(RHI_Vertex_PosUVTBN) * vertices.size());
 
 		auto ptr = (ID3D11Buffer**)&m_buffer;
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateBuffer(&bufferDesc, &initData, ptr);
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, &initData, ptr);
+		if (FAILED(result))
+		{
+			LOG_ERROR("RHI_VertexBuffer::Create: Failed to create vertex buffer");
+			return false;
+		}
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosUVTBNPacked>& vertices)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice() || vertices.empty())
+			return false;
+
+		m_stride = sizeof(RHI_Vertex_PosUVTBNPacked);
+		unsigned int size		= (unsigned int)vertices.size();
+		unsigned int byteWidth	= m_stride * size;
+
+		// fill in a buffer description.
+		D3D11_BUFFER_DESC bufferDesc;
+		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+		bufferDesc.ByteWidth			= byteWidth;
+		bufferDesc.Usage				= D3D11_USAGE_IMMUTABLE;
+		bufferDesc.BindFlags			= D3D11_BIND_VERTEX_BUFFER;
+		bufferDesc.CPUAccessFlags		= 0;
+		bufferDesc.MiscFlags			= 0;
+		bufferDesc.StructureByteStride	= 0;
+
+		// fill in the subresource data.
+		D3D11_SUBRESOURCE_DATA initData;
+		initData.pSysMem			= vertices.data();
+		initData.SysMemPitch		= 0;
+		initData.SysMemSlicePitch	= 0;
+
+		// Compute memory usage
+		m_memoryUsage = (unsigned int)(sizeof(RHI_Vertex_PosUVTBNPacked) * vertices.size());
+
+		auto ptr = (ID3D11Buffer**)&m_buffer;
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, &initData, ptr);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_VertexBuffer::Create: Failed to create vertex buffer");
 			return false;
 		}
 
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
 		return true;
 	}
 
 	bool RHI_VertexBuffer::CreateDynamic(unsigned int stride, unsigned int initialSize)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11Device>())
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
 		{
 			LOG_ERROR("RHI_VertexBuffer::CreateDynamic: Invalid RHI device");
 			return false;
@@ -203,19 +253,67 @@ namespace Directus
 		bufferDesc.StructureByteStride	= 0;
 
 		auto ptr = (ID3D11Buffer**)&m_buffer;
-		auto result = m_rhiDevice->GetDevice<ID3D11Device>()->CreateBuffer(&bufferDesc, nullptr, ptr);
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, nullptr, ptr);
 		if FAILED(result)
 		{
 			LOG_ERROR("RHI_VertexBuffer::Bind: Failed to create dynamic vertex buffer");
 			return false;
 		}
 
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, byteWidth);
+		return true;
+	}
+
+	bool RHI_VertexBuffer::CreateUnorderedAccess(unsigned int stride, unsigned int vertexCount)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_VertexBuffer::CreateUnorderedAccess: Invalid RHI device");
+			return false;
+		}
+
+		m_stride		= stride;
+		m_memoryUsage	= m_stride * vertexCount;
+
+		// Vertex buffers can't be structured, compute writes them through a raw view
+		D3D11_BUFFER_DESC bufferDesc;
+		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+		bufferDesc.ByteWidth			= m_memoryUsage;
+		bufferDesc.Usage				= D3D11_USAGE_DEFAULT;
+		bufferDesc.BindFlags			= D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_UNORDERED_ACCESS;
+		bufferDesc.CPUAccessFlags		= 0;
+		bufferDesc.MiscFlags			= D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+		bufferDesc.StructureByteStride	= 0;
+
+		auto result = RHI_Backend::GetDevice()->CreateBuffer(&bufferDesc, nullptr, (ID3D11Buffer**)&m_buffer);
+		if (FAILED(result))
+		{
+			LOG_ERROR("RHI_VertexBuffer::CreateUnorderedAccess: Failed to create vertex buffer");
+			return false;
+		}
+
+		D3D11_UNORDERED_ACCESS_VIEW_DESC accessDesc;
+		ZeroMemory(&accessDesc, sizeof(accessDesc));
+		accessDesc.Format				= DXGI_FORMAT_R32_TYPELESS;
+		accessDesc.ViewDimension		= D3D11_UAV_DIMENSION_BUFFER;
+		accessDesc.Buffer.FirstElement	= 0;
+		accessDesc.Buffer.NumElements	= m_memoryUsage / 4;
+		accessDesc.Buffer.Flags			= D3D11_BUFFER_UAV_FLAG_RAW;
+
+		result = RHI_Backend::GetDevice()->CreateUnorderedAccessView((ID3D11Buffer*)m_buffer, &accessDesc, (ID3D11UnorderedAccessView**)&m_unorderedAccessView);
+		if (FAILED(result))
+		{
+			LOG_ERROR("RHI_VertexBuffer::CreateUnorderedAccess: Failed to create unordered access view");
+			return false;
+		}
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, m_memoryUsage);
 		return true;
 	}
 
-	void* RHI_VertexBuffer::Map()
+	void* RHI_VertexBuffer::Map(bool discard /*= true*/)
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_VertexBuffer::Map: Invalid RHI device");
 			return false;
@@ -229,19 +327,20 @@ namespace Directus
 
 		// disable GPU access to the vertex buffer data.
 		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		HRESULT result = m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->Map((ID3D11Resource*)m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		HRESULT result = RHI_Backend::GetContext()->Map((ID3D11Resource*)m_buffer, 0, discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource);
 		if (FAILED(result))
 		{
 			LOG_ERROR("RHI_VertexBuffer::Map: Failed to map vertex buffer");
 			return nullptr;
 		}
 
+		RHI_CAPTURE(Record_Map(Capture_UpdateVertexBuffer, this, m_buffer, mappedResource.pData, m_memoryUsage, discard));
 		return mappedResource.pData;
 	}
 
 	bool RHI_VertexBuffer::Unmap()
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_VertexBuffer::Unmap: Invalid RHI device");
 			return false;
@@ -253,15 +352,18 @@ namespace Directus
 			return false;
 		}
 
+		RHI_CAPTURE(Record_Unmap(this));
 		// re-enable GPU access to the vertex buffer data.
-		m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->Unmap((ID3D11Resource*)m_buffer, 0);
+		RHI_Backend::GetContext()->Unmap((ID3D11Resource*)m_buffer, 0);
 
 		return true;
 	}
 
 	bool RHI_VertexBuffer::Bind()
 	{
-		if (!m_rhiDevice || !m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>())
+		RHI_CAPTURE(Record(Capture_BindVertexBuffer, {}, { this }));
+
+		if (!m_rhiDevice || !RHI_Backend::GetContext())
 		{
 			LOG_ERROR("RHI_VertexBuffer::Bind: Invalid RHI device");
 			return false;
@@ -275,7 +377,8 @@ namespace Directus
 
 		unsigned int offset = 0;
 		auto ptr = (ID3D11Buffer*const*)&m_buffer;
-		m_rhiDevice->GetDeviceContext<ID3D11DeviceContext>()->IASetVertexBuffers(0, 1, ptr, &m_stride, &offset);
+		RHI_Backend::GetContext()->IASetVertexBuffers(0, 1, ptr, &m_stride, &offset);
 		return true;
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,376 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "RHI_Capture.h"
+#include "RHI_Device.h"
+#include "RHI_ConstantBuffer.h"
+#include "RHI_VertexBuffer.h"
+#include "RHI_IndexBuffer.h"
+#include "RHI_StructuredBuffer.h"
+#include "../IO/FileStream.h"
+#include "../Math/Vector4.h"
+#include "../Logging/Log.h"
+#include <algorithm>
+//=================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+//=============================
+
+#define CHUNK_CAPTURE 0x50414352 // "RCAP"
+
+namespace Directus
+{
+	void RHI_Capture::Begin(unsigned int frames)
+	{
+		Clear();
+		m_framesRequested	= max(frames, 1U);
+		m_state				= State_Requested;
+	}
+
+	void RHI_Capture::Frame()
+	{
+		if (m_state == State_Requested)
+		{
+			m_framesRecorded	= 0;
+			m_state				= State_Recording;
+			m_recording			= true;
+			return;
+		}
+
+		if (m_state == State_Recording && ++m_framesRecorded >= m_framesRequested)
+		{
+			m_recording	= false;
+			m_state		= State_Done;
+
+			// Whatever wasn't executed never reached the GPU
+			lock_guard<mutex> lock(m_mutex);
+			m_commandLists.clear();
+			LOGF_INFO("RHI_Capture::Frame: Recorded %d commands over %d frames", (int)m_commands.size(), (int)m_framesRecorded);
+		}
+	}
+
+	void RHI_Capture::Clear()
+	{
+		m_recording	= false;
+		m_state		= State_Idle;
+
+		lock_guard<mutex> lock(m_mutex);
+		m_commands.clear();
+		m_commands.shrink_to_fit();
+		m_commandLists.clear();
+		m_framesRecorded = 0;
+	}
+
+	void RHI_Capture::Record(Capture_Op op, initializer_list<uint32_t> values /*= {}*/, void* const* resources /*= nullptr*/, unsigned int resourceCount /*= 0*/)
+	{
+		Command command;
+		command.op = op;
+		copy_n(values.begin(), min(values.size(), size(command.values)), command.values);
+		if (resources && resourceCount)
+		{
+			command.resources.assign(resources, resources + resourceCount);
+		}
+		Push(move(command));
+	}
+
+	void RHI_Capture::Record(Capture_Op op, initializer_list<uint32_t> values, initializer_list<void*> resources)
+	{
+		Record(op, values, resources.begin(), (unsigned int)resources.size());
+	}
+
+	void RHI_Capture::Record_Event(const string& name)
+	{
+		Command command;
+		command.op	= Capture_EventBegin;
+		auto data	= reinterpret_cast<const std::byte*>(name.data());
+		command.data.assign(data, data + name.size());
+		Push(move(command));
+	}
+
+	void RHI_Capture::Record_RenderTargets(unsigned int renderTargetCount, void* const* renderTargets, void* depthStencil)
+	{
+		Command command;
+		command.op			= Capture_SetRenderTargets;
+		command.values[0]	= renderTargetCount;
+		if (renderTargets && renderTargetCount)
+		{
+			command.resources.assign(renderTargets, renderTargets + renderTargetCount);
+		}
+		command.resources.emplace_back(depthStencil);
+		Push(move(command));
+	}
+
+	void RHI_Capture::Record_Map(Capture_Op op, void* object, void* buffer, const void* mapped, unsigned int size, uint32_t value /*= 0*/)
+	{
+		if (!mapped)
+			return;
+
+		// Buffers are mapped by the thread that writes them, one map at a time
+		auto it = find_if(m_threadMaps.begin(), m_threadMaps.end(), [object](const Map& map) { return map.object == object; });
+		if (it == m_threadMaps.end())
+		{
+			it = m_threadMaps.emplace(m_threadMaps.end());
+		}
+		*it = Map{ object, buffer, mapped, size, value, op };
+	}
+
+	void RHI_Capture::Record_Unmap(void* object)
+	{
+		auto it = find_if(m_threadMaps.begin(), m_threadMaps.end(), [object](const Map& map) { return map.object == object; });
+		if (it == m_threadMaps.end())
+			return;
+
+		// Still mapped, what got written is all there
+		Command command;
+		command.op			= it->op;
+		command.values[0]	= it->value;
+		command.resources	= { it->object, it->buffer };
+		auto data			= reinterpret_cast<const std::byte*>(it->mapped);
+		command.data.assign(data, data + it->size);
+		m_threadMaps.erase(it);
+		Push(move(command));
+	}
+
+	void RHI_Capture::CommandList_Begin()
+	{
+		m_threadCommands.clear();
+		m_threadRecording = true;
+	}
+
+	void RHI_Capture::CommandList_End(void* commandList)
+	{
+		m_threadRecording = false;
+		if (!commandList)
+			return;
+
+		lock_guard<mutex> lock(m_mutex);
+		m_commandLists[commandList] = move(m_threadCommands);
+		m_threadCommands.clear();
+	}
+
+	void RHI_Capture::CommandList_Execute(void* commandList)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		auto it = m_commandLists.find(commandList);
+		if (it == m_commandLists.end())
+			return;
+
+		m_commands.emplace_back(Command{ Capture_CommandListBegin });
+		m_commands.insert(m_commands.end(), make_move_iterator(it->second.begin()), make_move_iterator(it->second.end()));
+		m_commands.emplace_back(Command{ Capture_CommandListEnd });
+		m_commandLists.erase(it);
+	}
+
+	void RHI_Capture::Push(Command&& command)
+	{
+		if (m_threadRecording)
+		{
+			m_threadCommands.emplace_back(move(command));
+			return;
+		}
+
+		lock_guard<mutex> lock(m_mutex);
+		m_commands.emplace_back(move(command));
+	}
+
+	void RHI_Capture::Replay(RHI_Device* rhiDevice)
+	{
+		if (!rhiDevice || m_recording)
+			return;
+
+		// Ring buffers hand out elements of their own, the ranges bound have to follow where the data went this time
+		unordered_map<void*, unordered_map<uint32_t, uint32_t>> ringConstants;
+
+		for (const auto& command : m_commands)
+		{
+			const auto& v	= command.values;
+			auto resources	= command.resources.empty() ? nullptr : command.resources.data();
+			void* resource	= command.resources.empty() ? nullptr : command.resources.front();
+			auto color		= Vector4(Float(v[0]), Float(v[1]), Float(v[2]), Float(v[3]));
+
+			switch (command.op)
+			{
+				case Capture_Draw:							rhiDevice->Draw(v[0], v[1]); break;
+				case Capture_DrawIndexed:					rhiDevice->DrawIndexed(v[0], v[1], v[2]); break;
+				case Capture_DrawIndexedInstanced:			rhiDevice->DrawIndexedInstanced(v[0], v[1], v[2], v[3]); break;
+				case Capture_DrawIndexedInstancedIndirect:	rhiDevice->DrawIndexedInstancedIndirect(resource, v[0]); break;
+				case Capture_Dispatch:						rhiDevice->Dispatch(v[0], v[1], v[2]); break;
+				case Capture_ClearBackBuffer:				rhiDevice->ClearBackBuffer(color); break;
+				case Capture_ClearRenderTarget:				rhiDevice->ClearRenderTarget(resource, color); break;
+				case Capture_ClearDepthStencil:				rhiDevice->ClearDepthStencil(resource, v[0], Float(v[1]), (uint8_t)v[2]); break;
+				case Capture_SetBackBufferAsRenderTarget:	rhiDevice->Set_BackBufferAsRenderTarget(); break;
+				case Capture_SetVertexShader:				rhiDevice->Set_VertexShader(resource); break;
+				case Capture_SetPixelShader:				rhiDevice->Set_PixelShader(resource); break;
+				case Capture_SetConstantBuffers:			rhiDevice->Set_ConstantBuffers(v[0], v[1], (Buffer_Scope)v[2], resources); break;
+				case Capture_SetConstantBufferRange:
+				{
+					uint32_t firstConstant	= v[2];
+					auto ring				= ringConstants.find(resource);
+					if (ring != ringConstants.end())
+					{
+						auto element	= ring->second.find(firstConstant);
+						firstConstant	= element != ring->second.end() ? element->second : firstConstant;
+					}
+					rhiDevice->Set_ConstantBufferRange(v[0], (Buffer_Scope)v[1], resource, firstConstant, v[3]);
+					break;
+				}
+				case Capture_SetSamplers:					rhiDevice->Set_Samplers(v[0], v[1], resources); break;
+				case Capture_SetRenderTargets:				rhiDevice->Set_RenderTargets(v[0], v[0] ? resources : nullptr, command.resources.back()); break;
+				case Capture_SetTextures:					rhiDevice->Set_Textures(v[0], v[1], resources); break;
+				case Capture_SetVertexTextures:				rhiDevice->Set_VertexTextures(v[0], v[1], resources); break;
+				case Capture_SetComputeShader:				rhiDevice->Set_ComputeShader(resource); break;
+				case Capture_SetComputeSamplers:			rhiDevice->Set_ComputeSamplers(v[0], v[1], resources); break;
+				case Capture_SetComputeTextures:			rhiDevice->Set_ComputeTextures(v[0], v[1], resources); break;
+				case Capture_SetComputeUnorderedAccessViews: rhiDevice->Set_ComputeUnorderedAccessViews(v[0], v[1], resources); break;
+				case Capture_SetViewport:					rhiDevice->Set_Viewport(RHI_Viewport(Float(v[0]), Float(v[1]), Float(v[2]), Float(v[3]), Float(v[4]), Float(v[5]))); break;
+				case Capture_SetDepthEnabled:				rhiDevice->Set_DepthEnabled(v[0] != 0, v[1] != 0); break;
+				case Capture_SetBlendMode:					rhiDevice->Set_BlendMode((Blend_Mode)v[0]); break;
+				case Capture_SetCullMode:					rhiDevice->Set_CullMode((Cull_Mode)v[0]); break;
+				case Capture_SetScissorEnabled:				rhiDevice->Set_ScissorEnabled(v[0] != 0); break;
+				case Capture_SetScissorRectangle:			rhiDevice->Set_ScissorRectangle((int)v[0], (int)v[1], (int)v[2], (int)v[3]); break;
+				case Capture_SetPrimitiveTopology:			rhiDevice->Set_PrimitiveTopology((PrimitiveTopology_Mode)v[0]); break;
+				case Capture_SetFillMode:					rhiDevice->Set_FillMode((Fill_Mode)v[0]); break;
+				case Capture_SetInputLayout:				rhiDevice->Set_InputLayout(resource); break;
+				case Capture_ComputeBegin:					rhiDevice->Compute_Begin(); break;
+				case Capture_ComputeEnd:					rhiDevice->Compute_End(); break;
+				case Capture_ComputeWait:					rhiDevice->Compute_Wait(); break;
+				case Capture_EventBegin:					rhiDevice->EventBegin(string(reinterpret_cast<const char*>(command.data.data()), command.data.size())); break;
+				case Capture_EventEnd:						rhiDevice->EventEnd(); break;
+				case Capture_CommandListBegin:				rhiDevice->CommandList_Begin(); break;
+				case Capture_CommandListEnd:				rhiDevice->CommandList_Execute(rhiDevice->CommandList_End()); break;
+				case Capture_BindVertexBuffer:				if (resource) ((RHI_VertexBuffer*)resource)->Bind(); break;
+				case Capture_BindIndexBuffer:				if (resource) ((RHI_IndexBuffer*)resource)->Bind(); break;
+				case Capture_UpdateConstantBuffer:
+				{
+					auto buffer					= (RHI_ConstantBuffer*)resource;
+					unsigned int firstConstant	= 0;
+					auto mapped					= buffer ? buffer->Map(&firstConstant) : nullptr;
+					if (!mapped)
+						break;
+
+					memcpy(mapped, command.data.data(), command.data.size());
+					buffer->Unmap();
+					if (buffer->IsRing())
+					{
+						ringConstants[buffer->GetBuffer()][v[0]] = firstConstant;
+					}
+					break;
+				}
+				case Capture_UpdateVertexBuffer:
+				{
+					auto buffer = (RHI_VertexBuffer*)resource;
+					if (auto mapped = buffer ? buffer->Map(v[0] != 0) : nullptr)
+					{
+						memcpy(mapped, command.data.data(), command.data.size());
+						buffer->Unmap();
+					}
+					break;
+				}
+				case Capture_UpdateIndexBuffer:
+				{
+					auto buffer = (RHI_IndexBuffer*)resource;
+					if (auto mapped = buffer ? buffer->Map(v[0] != 0) : nullptr)
+					{
+						memcpy(mapped, command.data.data(), command.data.size());
+						buffer->Unmap();
+					}
+					break;
+				}
+				case Capture_UpdateStructuredBuffer:
+				{
+					auto buffer = (RHI_StructuredBuffer*)resource;
+					if (auto mapped = buffer ? buffer->Map() : nullptr)
+					{
+						memcpy(mapped, command.data.data(), command.data.size());
+						buffer->Unmap();
+					}
+					break;
+				}
+				default: break;
+			}
+		}
+	}
+
+	bool RHI_Capture::Save(const string& filePath)
+	{
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_WriteBuffered);
+		if (!file->IsOpen())
+		{
+			LOGF_ERROR("RHI_Capture::Save: Failed to create \"%s\"", filePath.c_str());
+			return false;
+		}
+
+		// Addresses differ from run to run, the order resources get referenced in doesn't (0 is none)
+		unordered_map<void*, unsigned int> resourceIndices;
+		resourceIndices[nullptr] = 0;
+
+		file->Chunk_Begin(CHUNK_CAPTURE, 1);
+		file->Write(m_framesRecorded);
+		file->Write((unsigned int)m_commands.size());
+		for (const auto& command : m_commands)
+		{
+			file->Write((unsigned int)command.op);
+			for (auto value : command.values)
+			{
+				file->Write((unsigned int)value);
+			}
+
+			vector<unsigned int> indices;
+			for (auto resource : command.resources)
+			{
+				auto it = resourceIndices.emplace(resource, (unsigned int)resourceIndices.size()).first;
+				indices.emplace_back(it->second);
+			}
+			file->Write(indices);
+			file->Write(command.data);
+		}
+		file->Chunk_End();
+
+		return true;
+	}
+
+	unsigned int RHI_Capture::GetCount(Capture_Op op)
+	{
+		return (unsigned int)count_if(m_commands.begin(), m_commands.end(), [op](const Command& command) { return command.op == op; });
+	}
+
+	const char* RHI_Capture::GetName(Capture_Op op)
+	{
+		static const char* names[Capture_Op_Count] =
+		{
+			"Draw", "DrawIndexed", "DrawIndexedInstanced", "DrawIndexedInstancedIndirect", "Dispatch",
+			"ClearBackBuffer", "ClearRenderTarget", "ClearDepthStencil",
+			"SetBackBufferAsRenderTarget", "SetVertexShader", "SetPixelShader", "SetConstantBuffers", "SetConstantBufferRange",
+			"SetSamplers", "SetRenderTargets", "SetTextures", "SetVertexTextures",
+			"SetComputeShader", "SetComputeSamplers", "SetComputeTextures", "SetComputeUnorderedAccessViews",
+			"SetViewport", "SetDepthEnabled", "SetBlendMode", "SetCullMode", "SetScissorEnabled", "SetScissorRectangle",
+			"SetPrimitiveTopology", "SetFillMode", "SetInputLayout",
+			"ComputeBegin", "ComputeEnd", "ComputeWait", "EventBegin", "EventEnd", "CommandListBegin", "CommandListEnd",
+			"BindVertexBuffer", "BindIndexBuffer",
+			"UpdateConstantBuffer", "UpdateVertexBuffer", "UpdateIndexBuffer", "UpdateStructuredBuffer"
+		};
+
+		return op < Capture_Op_Count ? names[op] : "Unknown";
+	}
+}
@@ -0,0 +1,189 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+#include <initializer_list>
+#include "RHI_Definition.h"
+#include "..\Core\EngineDefs.h"
+//==============================
+
+// Records a call into the capture, only when one is recording (the backends call it first thing, see RHI_Capture)
+#define RHI_CAPTURE(call) if (Directus::RHI_Capture::IsRecording()) { Directus::RHI_Capture::Get().call; }
+
+namespace Directus
+{
+	class RHI_Device;
+
+	enum Capture_Op : uint32_t
+	{
+		// RHI_Device
+		Capture_Draw,
+		Capture_DrawIndexed,
+		Capture_DrawIndexedInstanced,
+		Capture_DrawIndexedInstancedIndirect,
+		Capture_Dispatch,
+		Capture_ClearBackBuffer,
+		Capture_ClearRenderTarget,
+		Capture_ClearDepthStencil,
+		Capture_SetBackBufferAsRenderTarget,
+		Capture_SetVertexShader,
+		Capture_SetPixelShader,
+		Capture_SetConstantBuffers,
+		Capture_SetConstantBufferRange,
+		Capture_SetSamplers,
+		Capture_SetRenderTargets,
+		Capture_SetTextures,
+		Capture_SetVertexTextures,
+		Capture_SetComputeShader,
+		Capture_SetComputeSamplers,
+		Capture_SetComputeTextures,
+		Capture_SetComputeUnorderedAccessViews,
+		Capture_SetViewport,
+		Capture_SetDepthEnabled,
+		Capture_SetBlendMode,
+		Capture_SetCullMode,
+		Capture_SetScissorEnabled,
+		Capture_SetScissorRectangle,
+		Capture_SetPrimitiveTopology,
+		Capture_SetFillMode,
+		Capture_SetInputLayout,
+		Capture_ComputeBegin,
+		Capture_ComputeEnd,
+		Capture_ComputeWait,
+		Capture_EventBegin,
+		Capture_EventEnd,
+		// An executed command list's commands are between these, a replay records and executes them as one again
+		Capture_CommandListBegin,
+		Capture_CommandListEnd,
+		// Buffers, the first resource is the RHI object
+		Capture_BindVertexBuffer,
+		Capture_BindIndexBuffer,
+		Capture_UpdateConstantBuffer,	// the first constant it was mapped at, the buffer's native one is the second resource
+		Capture_UpdateVertexBuffer,		// whether it discarded
+		Capture_UpdateIndexBuffer,		// whether it discarded
+		Capture_UpdateStructuredBuffer,
+		Capture_Op_Count
+	};
+
+	// Records what the renderer asks of the RHI over a range of frames, every RHI_Device call and every buffer bind or
+	// update (with the data written), so it can be replayed against the device as often as needed, without the world
+	// or the renderer. Command lists are recorded per thread and spliced in where they get executed, a replay records
+	// them again on it's own thread, in the order the GPU saw them. The resources are referenced as they are, they
+	// have to outlive the capture, and what was bound before it started carries over into every replay. Copies between
+	// resources and texture uploads aren't part of it. The capture file is for diffing one stream against another.
+	class ENGINE_CLASS RHI_Capture
+	{
+	public:
+		static RHI_Capture& Get()
+		{
+			static RHI_Capture instance;
+			return instance;
+		}
+
+		struct Command
+		{
+			Capture_Op op;
+			uint32_t values[6] = {};		// counts, slots, enums, floats as their bits
+			std::vector<void*> resources;	// native views, buffers and shaders (or the RHI objects of buffers)
+			std::vector<std::byte> data;	// what got written into a buffer, the name of an event
+		};
+
+		//= RECORDING ===================================================================================================
+		// Records the next frames, starting with the next one
+		void Begin(unsigned int frames);
+		// Called as every frame starts, before anything is recorded into command lists
+		void Frame();
+		static bool IsRecording()	{ return m_recording; }
+		bool IsDone()				{ return m_state == State_Done; }
+		void Clear();
+
+		// Value arguments and an array of resources
+		void Record(Capture_Op op, std::initializer_list<uint32_t> values = {}, void* const* resources = nullptr, unsigned int resourceCount = 0);
+		void Record(Capture_Op op, std::initializer_list<uint32_t> values, std::initializer_list<void*> resources);
+		void Record_Event(const std::string& name);
+		// The render targets, then the depth stencil
+		void Record_RenderTargets(unsigned int renderTargetCount, void* const* renderTargets, void* depthStencil);
+		// A map hands out memory the data will be in once it's unmapped (the size is what the map covers)
+		void Record_Map(Capture_Op op, void* object, void* buffer, const void* mapped, unsigned int size, uint32_t value = 0);
+		void Record_Unmap(void* object);
+		void CommandList_Begin();
+		void CommandList_End(void* commandList);
+		void CommandList_Execute(void* commandList);
+
+		static uint32_t Bits(float value)	{ uint32_t bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+		static float Float(uint32_t bits)	{ float value; memcpy(&value, &bits, sizeof(value)); return value; }
+		//===============================================================================================================
+
+		//= REPLAY ======================================================================================================
+		// Issues the whole capture once, on the calling thread, which has to be the one that renders
+		void Replay(RHI_Device* rhiDevice);
+		// The commands, the resources by the order they first appear in, and the data, for diffing one capture against another
+		bool Save(const std::string& filePath);
+		const std::vector<Command>& GetCommands()	{ return m_commands; }
+		unsigned int GetFrameCount()				{ return m_framesRecorded; }
+		unsigned int GetCount(Capture_Op op);
+		static const char* GetName(Capture_Op op);
+		//===============================================================================================================
+
+	private:
+		RHI_Capture() = default;
+		// Into the command list the calling thread records, otherwise the immediate context's
+		void Push(Command&& command);
+
+		enum Capture_State
+		{
+			State_Idle,
+			State_Requested,
+			State_Recording,
+			State_Done
+		};
+
+		struct Map
+		{
+			void* object;
+			void* buffer;
+			const void* mapped;
+			unsigned int size;
+			uint32_t value;
+			Capture_Op op;
+		};
+
+		static inline std::atomic<bool> m_recording = false;
+		std::atomic<Capture_State> m_state			= State_Idle;
+		unsigned int m_framesRequested				= 0;
+		unsigned int m_framesRecorded				= 0;
+		std::vector<Command> m_commands;									// the immediate context's, and the executed command lists
+		std::unordered_map<void*, std::vector<Command>> m_commandLists;	// recorded but not executed yet
+		std::mutex m_mutex;
+		// The command list the calling thread records, and it's buffers that are mapped
+		static inline thread_local std::vector<Command> m_threadCommands;
+		static inline thread_local bool m_threadRecording = false;
+		static inline thread_local std::vector<Map> m_threadMaps;
+	};
+}
@@ -28,8 +28,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/Camera.h"
 //=====================================
 
+// Maximum number of instances a single instanced draw can carry, must match Common.hlsl
+#define INSTANCE_BATCH_MAX 256
+// Number of batches the instance buffer holds before it has to be discarded (16 KB each)
+#define INSTANCE_RING_SIZE 64
+
 namespace Directus
 {
+	struct Struct_Instances
+	{
+		Math::Matrix m_world[INSTANCE_BATCH_MAX];
+	};
+
 	struct Struct_Matrix
 	{
 		Struct_Matrix(const Math::Matrix& matrix)
@@ -114,7 +124,8 @@ namespace Directus
 			m_nearPlane				= camera->GetNearPlane();
 			m_farPlane				= camera->GetFarPlane();
 			m_doShadowMapping		= dirLight->GetCastShadows();
-			m_padding				= Math::Vector3::Zero;
+			m_reverseZ				= camera->IsReverseZ() ? 1.0f : 0.0f;
+			m_padding				= Math::Vector2::Zero;
 		}
 
 		Math::Matrix m_wvpOrtho;
@@ -127,7 +138,8 @@ namespace Directus
 		float m_nearPlane;
 		float m_farPlane;
 		float m_doShadowMapping;
-		Math::Vector3 m_padding;
+		float m_reverseZ;
+		Math::Vector2 m_padding;
 	};
 
 	struct Struct_Matrix_Matrix_Matrix
@@ -171,7 +183,8 @@ namespace Directus
 			const Math::Vector4& color,
 			const Math::Vector3& cameraPos,
 			const Math::Vector3& lightDir,
-			float roughness = 0.0f
+			float roughness	= 0.0f,
+			bool reverseZ	= false
 		)
 		{
 			m_world			= world;
@@ -182,7 +195,7 @@ namespace Directus
 			m_cameraPos		= cameraPos;
 			m_lightDir		= lightDir;
 			m_roughness		= roughness;
-			m_padding		= 0.0f;
+			m_reverseZ		= reverseZ ? 1.0f : 0.0f;
 		}
 
 		Math::Matrix m_world;
@@ -193,6 +206,307 @@ namespace Directus
 		Math::Vector3 m_cameraPos;
 		float m_roughness;
 		Math::Vector3 m_lightDir;
+		float m_reverseZ;
+	};
+
+	struct Struct_TemporalAntialiasing
+	{
+		Struct_TemporalAntialiasing
+		(
+			const Math::Matrix& mWVPortho,
+			const Math::Vector2& jitter,
+			float resolutionScale,
+			bool historyValid,
+			const Math::Vector2& resolution
+		)
+		{
+			m_wvpOrtho			= mWVPortho;
+			m_jitter			= jitter;
+			m_resolutionScale	= resolutionScale;
+			m_historyValid		= historyValid ? 1.0f : 0.0f;
+			m_resolution		= resolution;
+			m_padding			= Math::Vector2::Zero;
+		}
+
+		Math::Matrix m_wvpOrtho;
+		Math::Vector2 m_jitter;
+		float m_resolutionScale;
+		float m_historyValid;
+		Math::Vector2 m_resolution;
+		Math::Vector2 m_padding;
+	};
+
+	struct Struct_Checkerboard
+	{
+		Struct_Checkerboard
+		(
+			const Math::Matrix& mWVPortho,
+			const Math::Vector2& resolution,
+			float resolutionScale,
+			bool historyValid,
+			unsigned int parity
+		)
+		{
+			m_wvpOrtho			= mWVPortho;
+			m_resolution		= resolution;
+			m_resolutionScale	= resolutionScale;
+			m_historyValid		= historyValid ? 1.0f : 0.0f;
+			m_parity			= (float)parity;
+			m_padding			= Math::Vector3::Zero;
+		}
+
+		Math::Matrix m_wvpOrtho;
+		Math::Vector2 m_resolution;
+		float m_resolutionScale;
+		float m_historyValid;
+		float m_parity;
+		Math::Vector3 m_padding;
+	};
+
+	struct Struct_ScreenSpaceReflections
+	{
+		Struct_ScreenSpaceReflections
+		(
+			const Math::Matrix& mWVPortho,
+			const Math::Matrix& viewProjection,
+			const Math::Matrix& viewProjectionInverse,
+			const Math::Vector3& cameraPosition,
+			const Math::Vector2& resolution,
+			float resolutionScale,
+			float farPlane,
+			unsigned int levelCount,
+			unsigned int rayCount,
+			unsigned int stepCount,
+			float roughnessMax,
+			float thickness,
+			unsigned int frame,
+			bool sourceGamma,
+			bool historyValid
+		)
+		{
+			m_wvpOrtho				= mWVPortho;
+			m_viewProjection		= viewProjection;
+			m_viewProjectionInverse	= viewProjectionInverse;
+			m_cameraPosition		= Math::Vector4(cameraPosition.x, cameraPosition.y, cameraPosition.z, 1.0f);
+			m_resolution			= resolution;
+			m_resolutionScale		= resolutionScale;
+			m_farPlane				= farPlane;
+			m_levelCount			= (float)levelCount;
+			m_rayCount				= (float)rayCount;
+			m_stepCount				= (float)stepCount;
+			m_roughnessMax			= roughnessMax;
+			m_thickness				= thickness;
+			m_frame					= (float)frame;
+			m_sourceGamma			= sourceGamma ? 1.0f : 0.0f;
+			m_historyValid			= historyValid ? 1.0f : 0.0f;
+		}
+
+		Math::Matrix m_wvpOrtho;
+		Math::Matrix m_viewProjection;
+		Math::Matrix m_viewProjectionInverse;
+		Math::Vector4 m_cameraPosition;
+		Math::Vector2 m_resolution;
+		float m_resolutionScale;
+		float m_farPlane;
+		float m_levelCount;
+		float m_rayCount;
+		float m_stepCount;
+		float m_roughnessMax;
+		float m_thickness;
+		float m_frame;
+		float m_sourceGamma;
+		float m_historyValid;
+	};
+
+	struct Struct_Bloom
+	{
+		Struct_Bloom(const Math::Vector2& resolution, float threshold)
+		{
+			m_resolution	= resolution;
+			m_threshold		= threshold;
+			m_padding		= 0.0f;
+		}
+
+		Math::Vector2 m_resolution;
+		float m_threshold;
 		float m_padding;
 	};
-}
\ No newline at end of file
+
+	struct Struct_Culling
+	{
+		Struct_Culling(const Math::Matrix& viewProjection, const Math::Matrix& occluderViewProjection, const Math::Vector3& cameraPosition, float projectionScale, float occluderFarPlane, unsigned int objectCount, unsigned int argumentCount, unsigned int levelCount, const Math::Vector3& origin)
+		{
+			m_viewProjection			= viewProjection;
+			m_occluderViewProjection	= occluderViewProjection;
+			m_cameraPosition			= cameraPosition;
+			m_projectionScale			= projectionScale;
+			m_occluderFarPlane			= occluderFarPlane;
+			m_objectCount				= objectCount;
+			m_argumentCount				= argumentCount;
+			m_levelCount				= levelCount;
+			m_origin					= origin;
+			m_clusterDraw				= 0;
+			m_clusterOffset				= 0;
+			m_clusterCount				= 0;
+			m_padding[0]				= 0;
+			m_padding[1]				= 0;
+		}
+
+		Math::Matrix m_viewProjection;
+		Math::Matrix m_occluderViewProjection;
+		Math::Vector3 m_cameraPosition;
+		float m_projectionScale;
+		float m_occluderFarPlane;
+		unsigned int m_objectCount;
+		unsigned int m_argumentCount;
+		unsigned int m_levelCount;
+		Math::Vector3 m_origin;
+		unsigned int m_clusterDraw; // set for each dispatch of the cluster pass
+		unsigned int m_clusterOffset;
+		unsigned int m_clusterCount;
+		unsigned int m_padding[2];
+	};
+
+	// A ring element, so only the first constant is used
+	struct Struct_IndirectDraw
+	{
+		Struct_IndirectDraw(unsigned int instanceOffset)
+		{
+			m_instanceOffset = instanceOffset;
+		}
+
+		unsigned int m_instanceOffset;
+		unsigned int m_padding[63];
+	};
+
+	// The camera as the G-Buffer shaders see it, once per frame (PerFrameBuffer in GBuffer.hlsl)
+	struct Struct_GBufferFrame
+	{
+		Struct_GBufferFrame(const Math::Vector3& cameraPosition, const Math::Vector2& planes, const Math::Vector2& resolution)
+		{
+			m_cameraPosition	= cameraPosition;
+			m_padding			= 0.0f;
+			m_planes			= planes;
+			m_resolution		= resolution;
+		}
+
+		Math::Vector3 m_cameraPosition;
+		float m_padding;
+		Math::Vector2 m_planes;
+		Math::Vector2 m_resolution;
+	};
+
+	// Impostors as the G-Buffer sees them (Impostor.hlsl), the matrices and the camera are relative to the origin like the G-Buffer's
+	struct Struct_Impostors
+	{
+		Struct_Impostors(
+			const Math::Matrix& view,
+			const Math::Matrix& projection,
+			const Math::Matrix& viewProjectionUnjittered,
+			const Math::Matrix& viewProjectionPrevious,
+			const Math::Vector3& cameraPosition,
+			float farPlane
+		)
+		{
+			m_view						= view;
+			m_projection				= projection;
+			m_viewProjectionUnjittered	= viewProjectionUnjittered;
+			m_viewProjectionPrevious	= viewProjectionPrevious;
+			m_cameraPosition			= cameraPosition;
+			m_farPlane					= farPlane;
+		}
+
+		Math::Matrix m_view;
+		Math::Matrix m_projection;
+		Math::Matrix m_viewProjectionUnjittered;
+		Math::Matrix m_viewProjectionPrevious;
+		Math::Vector3 m_cameraPosition;
+		float m_farPlane;
+	};
+
+	// The procedural grid (Grid.hlsl), the matrices are camera relative
+	struct Struct_Grid
+	{
+		Struct_Grid
+		(
+			const Math::Matrix& wvpOrtho,
+			const Math::Matrix& viewProjection,
+			const Math::Vector3& cameraPosition,
+			const Math::Vector2& cameraWrapped,
+			float spacing,
+			float majorSpacing,
+			float fadeDistance,
+			bool reverseZ
+		)
+		{
+			m_wvpOrtho				= wvpOrtho;
+			m_viewProjection		= viewProjection;
+			m_viewProjectionInverse	= viewProjection.Inverted();
+			m_cameraPosition		= cameraPosition;
+			m_reverseZ				= reverseZ ? 1.0f : 0.0f;
+			m_cameraWrapped			= cameraWrapped;
+			m_spacing				= spacing;
+			m_majorSpacing			= majorSpacing;
+			m_fadeDistance			= fadeDistance;
+			m_padding				= Math::Vector3::Zero;
+		}
+
+		Math::Matrix m_wvpOrtho;
+		Math::Matrix m_viewProjection;
+		Math::Matrix m_viewProjectionInverse;
+		Math::Vector3 m_cameraPosition;
+		float m_reverseZ;
+		Math::Vector2 m_cameraWrapped;
+		float m_spacing;
+		float m_majorSpacing;
+		float m_fadeDistance;
+		Math::Vector3 m_padding;
+	};
+
+	struct Struct_Skinning
+	{
+		Struct_Skinning(unsigned int instanceOffset)
+		{
+			m_instanceOffset = instanceOffset;
+		}
+
+		unsigned int m_instanceOffset;
+		unsigned int m_padding[3];
+	};
+
+	struct Struct_Particles
+	{
+		Struct_Particles(
+			const Math::Matrix& view,
+			const Math::Matrix& viewProjection,
+			const Math::Vector3& lightColor,
+			float ambient,
+			float clusterSliceScale,
+			float nearPlane,
+			float farPlane,
+			bool reverseZ
+		)
+		{
+			m_viewProjection	= viewProjection;
+			m_cameraRight		= Math::Vector3(view.m00, view.m10, view.m20);	// the quads face the camera
+			m_cameraUp			= Math::Vector3(view.m01, view.m11, view.m21);
+			m_lightColor		= lightColor;
+			m_ambient			= ambient;
+			m_clusterSliceScale	= clusterSliceScale;
+			m_nearPlane			= nearPlane;
+			m_farPlane			= farPlane;
+			m_reverseZ			= reverseZ ? 1.0f : 0.0f;
+		}
+
+		Math::Matrix m_viewProjection;
+		Math::Vector3 m_cameraRight;
+		float m_ambient;
+		Math::Vector3 m_cameraUp;
+		float m_clusterSliceScale;
+		Math::Vector3 m_lightColor;
+		float m_nearPlane;
+		float m_farPlane;
+		float m_reverseZ;
+		Math::Vector2 m_padding;
+	};
+}
@@ -24,7 +24,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==================
 #include "RHI_Object.h"
 #include "RHI_Definition.h"
+#include "RHI_Device.h"
 #include <memory>
+#include <vector>
+#include <mutex>
 #include "..\Core\EngineDefs.h"
 //=============================
 
@@ -37,16 +40,34 @@ namespace Directus
 		~RHI_ConstantBuffer();
 
 		bool Create(unsigned int size, unsigned int slot, Buffer_Scope scope);
-		void* Map();
+		// A buffer which holds many elements, each map appends one and returns its first constant (in 16 byte units).
+		// Only the first map per command list discards, so updates don't allocate a new buffer every time.
+		// The element size must be a multiple of 256 bytes, falls back to a single element without offsetting support.
+		bool CreateRing(unsigned int elementSize, unsigned int elementCount, unsigned int slot, Buffer_Scope scope);
+		void* Map(unsigned int* firstConstant = nullptr);
 		bool Unmap();
-		void* GetBuffer()		{ return m_buffer; }
-		unsigned int GetSlot()	{ return m_slot; }
-		Buffer_Scope GetScope()	{ return m_scope; }
+		void* GetBuffer()				{ return m_buffer; }
+		unsigned int GetSlot()			{ return m_slot; }
+		Buffer_Scope GetScope()			{ return m_scope; }
+		bool IsRing()					{ return m_elementCount > 1; }
+		unsigned int GetConstantCount()	{ return m_elementSize / 16; }
 
 	private:
+		// Where the next element goes, per command list being recorded
+		struct RingCursor
+		{
+			unsigned long long commandList;
+			unsigned int element;
+		};
+
 		std::shared_ptr<RHI_Device> m_rhiDevice;
 		void* m_buffer;
 		unsigned int m_slot;
 		Buffer_Scope m_scope;
+		unsigned int m_elementSize;
+		unsigned int m_elementCount;
+		std::vector<RingCursor> m_ringCursors;
+		std::mutex m_ringMutex;
+		RHI_MemoryTracker m_memoryTracker;
 	};
 }
\ No newline at end of file
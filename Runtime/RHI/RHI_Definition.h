@@ -32,17 +32,22 @@ namespace Directus
 	class RHI_VertexBuffer;
 	class RHI_IndexBuffer;
 	class RHI_ConstantBuffer;
+	class RHI_StructuredBuffer;
 	class RHI_Sampler;
 	class RHI_Pipeline;
 	class RHI_Viewport;
 	class RHI_RenderTexture;
 	class RHI_Texture;
+	class RHI_TextureArray;
 	class RHI_Shader;
 	class RHI_InputLayout;
+	class RHI_Readback;
 	struct RHI_Vertex_PosUVTBN;
+	struct RHI_Vertex_PosUVTBNPacked;
 	struct RHI_Vertex_PosUVNor;
 	struct RHI_Vertex_PosUV;
 	struct RHI_Vertex_PosCol;
+	struct RHI_Vertex_Skin;
 
 	enum Query_Type
 	{
@@ -56,11 +61,36 @@ namespace Directus
 		Clear_Stencil	= 1 << 1
 	};
 
+	enum Index_Format
+	{
+		Index_Format_UInt32,
+		Index_Format_UInt16 // half the memory, for buffers whose indices stay below 65536
+	};
+
+	// What video memory is held for, resources report to the device under one of these (see RHI_MemoryTracker)
+	enum Memory_Category
+	{
+		Memory_Meshes,
+		Memory_Textures,
+		Memory_RenderTargets,
+		Memory_Shadows,
+		Memory_Buffers, // constant, structured and dynamic buffers
+		Memory_Category_Count
+	};
+
 	enum Buffer_Scope
 	{
 		Buffer_VertexShader,
 		Buffer_PixelShader,
-		Buffer_Global
+		Buffer_Global,
+		Buffer_ComputeShader // bound through RHI_Device::Set_ConstantBuffers, the pipeline only tracks the graphics stages
+	};
+
+	enum Blend_Mode
+	{
+		Blend_Disabled,
+		Blend_Alpha,
+		Blend_WeightedOIT // weighted blended order-independent transparency, adds into the first target (accumulation), multiplies into the second (revealage)
 	};
 
 	enum PrimitiveTopology_Mode
@@ -76,6 +106,8 @@ namespace Directus
 		Input_PositionColor,
 		Input_PositionTexture,
 		Input_PositionTextureTBN,
+		Input_PositionTextureTBNPacked,
+		Input_Position2DTextureColor8,
 		Input_NotAssigned
 	};
 
@@ -129,10 +161,23 @@ namespace Directus
 		Texture_Format_R8G8B8A8_UNORM,
 		Texture_Format_R16_FLOAT,
 		Texture_Format_R32_FLOAT,
+		Texture_Format_R16G16_FLOAT,
 		Texture_Format_R32G32_FLOAT,
 		Texture_Format_R32G32B32_FLOAT,
 		Texture_Format_R16G16B16A16_FLOAT,
 		Texture_Format_R32G32B32A32_FLOAT,
-		Texture_Format_D32_FLOAT
+		Texture_Format_D32_FLOAT,
+		// Block compressed, 4x4 pixels per block
+		Texture_Format_BC1_UNORM,
+		Texture_Format_BC3_UNORM,
+		Texture_Format_BC5_UNORM,
+		Texture_Format_BC7_UNORM
 	};
+
+	// Bytes per pixel, per 4x4 block for the block compressed formats
+	inline unsigned int Texture_Format_GetBytes(Texture_Format format)
+	{
+		static const unsigned int bytes[] = { 1, 4, 2, 4, 4, 8, 12, 8, 16, 4, 8, 16, 16, 16 }; // Texture_Format order
+		return bytes[format];
+	}
 }
\ No newline at end of file
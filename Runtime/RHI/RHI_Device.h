@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============
 #include "RHI_Definition.h"
 #include "RHI_Viewport.h"
+#include <memory>
+#include <atomic>
 //=========================
 
 namespace Directus
@@ -35,12 +37,19 @@ namespace Directus
 		~RHI_Device();
 
 		//= DRAW ========================================================================================
-		void Draw(unsigned int vertexCount);
+		void Draw(unsigned int vertexCount, unsigned int vertexOffset = 0);
 		void DrawIndexed(unsigned int indexCount, unsigned int indexOffset, unsigned int vertexOffset);
+		void DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int indexOffset, unsigned int vertexOffset);
+		// The arguments (index count, instance count, index offset, vertex offset, instance offset) come from a GPU buffer
+		void DrawIndexedInstancedIndirect(void* argumentsBuffer, unsigned int argumentsOffset);
+		void Dispatch(unsigned int threadGroupCountX, unsigned int threadGroupCountY, unsigned int threadGroupCountZ = 1);
 		void ClearBackBuffer(const Math::Vector4& color);
 		void ClearRenderTarget(void* renderTarget, const Math::Vector4& color);
 		void ClearDepthStencil(void* depthStencil, unsigned int flags, float depth, uint8_t stencil = 0);
 		void Present();
+		// Blocks until the swap chain can take another frame, with Settings::LowLatency_Set. Called as a frame starts, it
+		// starts as late as it can while still making the next vertical blank, so what it reads (input) is as fresh as it gets.
+		void Present_Wait();
 		//===============================================================================================
 
 		//= BIND ============================================================================================================
@@ -48,9 +57,21 @@ namespace Directus
 		void Set_VertexShader(void* buffer);
 		void Set_PixelShader(void* buffer);
 		void Set_ConstantBuffers(unsigned int startSlot, unsigned int bufferCount, Buffer_Scope scope, void* const* buffer);
+		// Binds a window of a buffer, in 16 byte constants, requires constant buffer offsetting
+		void Set_ConstantBufferRange(unsigned int slot, Buffer_Scope scope, void* buffer, unsigned int firstConstant, unsigned int constantCount);
 		void Set_Samplers(unsigned int startSlot, unsigned int samplerCount, void* const* samplers);
 		void Set_RenderTargets(unsigned int renderTargetCount, void* const* renderTargets, void* depthStencil);
 		void Set_Textures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources);
+		// The pipeline only tracks pixel shader resources, these bind straight to the vertex stage
+		void Set_VertexTextures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources);
+		//===================================================================================================================
+
+		//= BIND - COMPUTE ==================================================================================================
+		// Compute has no pipeline state, these bind straight to the compute stage. Constant buffers go through Set_ConstantBuffers (Buffer_ComputeShader).
+		void Set_ComputeShader(void* buffer);
+		void Set_ComputeSamplers(unsigned int startSlot, unsigned int samplerCount, void* const* samplers);
+		void Set_ComputeTextures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources);
+		void Set_ComputeUnorderedAccessViews(unsigned int startSlot, unsigned int viewCount, void* const* unorderedAccessViews);
 		//===================================================================================================================
 
 		//= RESOLUTION ==============================================
@@ -63,19 +84,67 @@ namespace Directus
 		//================================================
 
 		//= MISC ============================================================
-		bool Set_DepthEnabled(bool enable);
-		bool Set_AlphaBlendingEnabled(bool enable);
+		// Depth testing, write disabled tests without updating the depth
+		bool Set_DepthEnabled(bool enable, bool write = true);
+		// Reverse-z, closer is greater and depth buffers clear to the viewport's minimum
+		void Set_DepthReverse(bool reverse)							{ m_depthReverse = reverse; }
+		bool Get_DepthReverse()										{ return m_depthReverse; }
+		float Get_DepthFar(const RHI_Viewport& viewport)			{ return m_depthReverse ? viewport.GetMinDepth() : viewport.GetMaxDepth(); }
+		bool Set_BlendMode(Blend_Mode blendMode);
 		bool Set_CullMode(Cull_Mode cullMode);
+		// Discards what's drawn outside of the rectangle (in pixels) for as long as it's enabled, scissored drawing doesn't cull
+		bool Set_ScissorEnabled(bool enabled);
+		void Set_ScissorRectangle(int left, int top, int right, int bottom);
 		bool Set_PrimitiveTopology(PrimitiveTopology_Mode primitiveTopology);
 		bool Set_FillMode(Fill_Mode fillMode);
 		bool Set_InputLayout(void* inputLayout);
 		//===================================================================
 
+		//= COMMAND LISTS ===============================================================================
+		// Redirects all commands issued by the calling thread into a deferred context
+		bool CommandList_Begin();
+		// Stops recording on the calling thread and returns the recorded command list
+		void* CommandList_End();
+		// Executes (and releases) a recorded command list on the immediate context
+		void CommandList_Execute(void* commandList);
+		bool CommandList_IsRecording();
+		// Identifies what the calling thread is recording into, changes with every recording and every execution
+		unsigned long long CommandList_GetID();
+		//===============================================================================================
+
+		//= ASYNC COMPUTE ===============================================================================
+		// Dispatches issued by the calling thread between Begin and End go to a compute queue, they start once everything
+		// executed before Begin is done and run alongside whatever is executed until Wait. One section per frame, later ones
+		// (and every section on a device without a spare queue) run in order with the rest of the frame.
+		void Compute_Begin();
+		void Compute_End();
+		// Everything executed from here on sees the results of the compute section
+		void Compute_Wait();
+		bool Compute_IsAsync();
+		//===============================================================================================
+
 		//= EVENTS ==============================
 		void EventBegin(const std::string& name);
 		void EventEnd();
 		//=======================================
 
+		//= MEMORY ======================================================================================
+		// Video memory held by the resources created through the device, as they report it
+		void Memory_Track(Memory_Category category, long long bytes)	{ m_memoryUsage[category] += bytes; }
+		unsigned long long Memory_GetUsage(Memory_Category category)	{ return (unsigned long long)m_memoryUsage[category].load(); }
+		unsigned long long Memory_GetUsage()
+		{
+			unsigned long long usage = 0;
+			for (unsigned int i = 0; i < Memory_Category_Count; i++)
+			{
+				usage += Memory_GetUsage((Memory_Category)i);
+			}
+			return usage;
+		}
+		// What the OS budgets for the process and what the process uses (all of it, tracked or not), false if the backend can't tell
+		bool Memory_GetBudget(unsigned long long* budget, unsigned long long* usage);
+		//===============================================================================================
+
 		//= PROFILING ====================================================================
 		bool Profiling_CreateQuery(void** buffer, Query_Type type);
 		void Profiling_QueryStart(void* queryObject);
@@ -85,19 +154,73 @@ namespace Directus
 		//=================================================================================
 
 		bool IsInitialized()	{ return m_initialized; }
+		// Whether constant buffers can be bound at an offset and mapped without overwriting (D3D11.1)
+		bool IsConstantBufferOffsettingSupported();
 
 		template <typename T>
 		T* GetDevice()			{ return (T*)m_device; }
+		// Returns the context of the calling thread, which is a deferred one while recording
 		template <typename T>
-		T* GetDeviceContext()	{ return (T*)m_deviceContext; }
+		T* GetDeviceContext()	{ return (T*)GetDeviceContextCurrent(); }
 
 	private:
+		void* GetDeviceContextCurrent();
+
 		Texture_Format m_format;
 		RHI_Viewport m_viewport;
 		bool m_depthEnabled;
-		bool m_alphaBlendingEnabled;
+		bool m_depthWriteEnabled;
+		bool m_depthReverse			= false;
+		bool m_depthReverseBound	= false;
+		Blend_Mode m_blendMode;
 		bool m_initialized		= false;
 		void* m_device			= nullptr;
 		void* m_deviceContext	= nullptr;
+		std::atomic<long long> m_memoryUsage[Memory_Category_Count] = {};
+	};
+
+	// A resource's share of the device's memory usage, every change is reported and the share goes away with the tracker.
+	// Copies start out empty, they don't hold the memory of the resource they were copied from.
+	class RHI_MemoryTracker
+	{
+	public:
+		RHI_MemoryTracker() = default;
+		RHI_MemoryTracker(const RHI_MemoryTracker&) {}
+		RHI_MemoryTracker& operator=(const RHI_MemoryTracker&) { return *this; }
+		~RHI_MemoryTracker() { Set(0); }
+
+		void Set(const std::shared_ptr<RHI_Device>& rhiDevice, Memory_Category category, unsigned long long bytes)
+		{
+			Set(0);
+			m_rhiDevice	= rhiDevice;
+			m_category	= category;
+			Set(bytes);
+		}
+
+		// Keeps the category
+		void Set(unsigned long long bytes)
+		{
+			if (m_rhiDevice)
+			{
+				m_rhiDevice->Memory_Track(m_category, (long long)bytes - (long long)m_bytes);
+			}
+			m_bytes = bytes;
+		}
+
+		void SetCategory(Memory_Category category)
+		{
+			auto bytes = m_bytes;
+			Set(0);
+			m_category = category;
+			Set(bytes);
+		}
+
+		unsigned long long GetBytes()	{ return m_bytes; }
+		Memory_Category GetCategory()	{ return m_category; }
+
+	private:
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		Memory_Category m_category	= Memory_Buffers;
+		unsigned long long m_bytes	= 0;
 	};
 }
\ No newline at end of file
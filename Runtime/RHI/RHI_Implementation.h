@@ -27,7 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #ifdef COMPILING_LIB // Only compile this for the engine
 
-//#ifdef API_D3D11 // Deactivate this for now as Vulkan is not ready
+#ifdef API_D3D11
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3dcompiler.lib")
@@ -59,11 +59,16 @@ static const DXGI_FORMAT d3d11_dxgi_format[]
 	DXGI_FORMAT_R8G8B8A8_UNORM,
 	DXGI_FORMAT_R16_FLOAT,
 	DXGI_FORMAT_R32_FLOAT,
+	DXGI_FORMAT_R16G16_FLOAT,
 	DXGI_FORMAT_R32G32_FLOAT,
 	DXGI_FORMAT_R32G32B32_FLOAT,
 	DXGI_FORMAT_R16G16B16A16_FLOAT,
 	DXGI_FORMAT_R32G32B32A32_FLOAT,
-	DXGI_FORMAT_D32_FLOAT
+	DXGI_FORMAT_D32_FLOAT,
+	DXGI_FORMAT_BC1_UNORM,
+	DXGI_FORMAT_BC3_UNORM,
+	DXGI_FORMAT_BC5_UNORM,
+	DXGI_FORMAT_BC7_UNORM
 };
 
 static const D3D11_TEXTURE_ADDRESS_MODE d3d11_texture_address_mode[]
@@ -94,10 +99,105 @@ static const D3D11_FILTER d3d11_filter[] =
 	D3D11_FILTER_MIN_MAG_MIP_LINEAR,
 	D3D11_FILTER_ANISOTROPIC
 };
-//#endif
+
+// The native device and the context of the calling thread, resolved at compile time so the backend's
+// resources reach them without going through RHI_Device (see D3D11_Device.cpp, which owns them)
+struct RHI_Backend_D3D11
+{
+	using Device	= ID3D11Device;
+	using Context	= ID3D11DeviceContext;
+
+	static Device* GetDevice()		{ return device; }
+	// The deferred context of a thread which is recording, otherwise the immediate one
+	static Context* GetContext()	{ return contextDeferred ? contextDeferred : contextImmediate; }
+
+	static inline Device* device							= nullptr;
+	static inline Context* contextImmediate					= nullptr;
+	static inline thread_local Context* contextDeferred	= nullptr;
+};
+using RHI_Backend = RHI_Backend_D3D11;
+#endif
 
 #ifdef API_VULKAN
 #pragma comment(lib, "vulkan-1.lib")
+#pragma comment(lib, "dxcompiler.lib")
+#define VK_USE_PLATFORM_WIN32_KHR
+#include <vulkan/vulkan.h>
+
+static const VkCullModeFlags vulkan_cull_mode[] =
+{
+	VK_CULL_MODE_NONE,
+	VK_CULL_MODE_FRONT_BIT,
+	VK_CULL_MODE_BACK_BIT
+};
+
+static const VkPolygonMode vulkan_polygon_mode[] =
+{
+	VK_POLYGON_MODE_FILL,
+	VK_POLYGON_MODE_LINE
+};
+
+static const VkPrimitiveTopology vulkan_primitive_topology[] =
+{
+	VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+	VK_PRIMITIVE_TOPOLOGY_LINE_LIST
+};
+
+static const VkFormat vulkan_format[] =
+{
+	VK_FORMAT_R8_UNORM,
+	VK_FORMAT_R8G8B8A8_UNORM,
+	VK_FORMAT_R16_SFLOAT,
+	VK_FORMAT_R32_SFLOAT,
+	VK_FORMAT_R16G16_SFLOAT,
+	VK_FORMAT_R32G32_SFLOAT,
+	VK_FORMAT_R32G32B32_SFLOAT,
+	VK_FORMAT_R16G16B16A16_SFLOAT,
+	VK_FORMAT_R32G32B32A32_SFLOAT,
+	VK_FORMAT_D32_SFLOAT,
+	VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+	VK_FORMAT_BC3_UNORM_BLOCK,
+	VK_FORMAT_BC5_UNORM_BLOCK,
+	VK_FORMAT_BC7_UNORM_BLOCK
+};
+
+static const VkSamplerAddressMode vulkan_sampler_address_mode[] =
+{
+	VK_SAMPLER_ADDRESS_MODE_REPEAT,
+	VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT,
+	VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+	VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+	VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE
+};
+
+static const VkCompareOp vulkan_compare_operator[] =
+{
+	VK_COMPARE_OP_NEVER,
+	VK_COMPARE_OP_LESS,
+	VK_COMPARE_OP_EQUAL,
+	VK_COMPARE_OP_LESS_OR_EQUAL,
+	VK_COMPARE_OP_GREATER,
+	VK_COMPARE_OP_NOT_EQUAL,
+	VK_COMPARE_OP_GREATER_OR_EQUAL,
+	VK_COMPARE_OP_ALWAYS
+};
+
+// Min/mag filter and mip-map mode, Texture_Sampler_Filter order
+static const VkFilter vulkan_filter[] =
+{
+	VK_FILTER_NEAREST,
+	VK_FILTER_LINEAR,
+	VK_FILTER_LINEAR,
+	VK_FILTER_LINEAR
+};
+
+static const VkSamplerMipmapMode vulkan_mipmap_mode[] =
+{
+	VK_SAMPLER_MIPMAP_MODE_NEAREST,
+	VK_SAMPLER_MIPMAP_MODE_NEAREST,
+	VK_SAMPLER_MIPMAP_MODE_LINEAR,
+	VK_SAMPLER_MIPMAP_MODE_LINEAR
+};
 #endif
 
 #endif
\ No newline at end of file
@@ -24,7 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============
 #include "RHI_Definition.h"
 #include "RHI_Object.h"
+#include "RHI_Device.h"
 #include <vector>
+#include <algorithm>
 //=========================
 
 namespace Directus
@@ -35,19 +37,41 @@ namespace Directus
 		RHI_IndexBuffer(std::shared_ptr<RHI_Device> rhiDevice);
 		~RHI_IndexBuffer();
 	
-		bool Create(const std::vector<unsigned int>& indices);
+		// Index_Format_UInt16 narrows the indices, they all have to be below 65536. A shader resource
+		// lets compute shaders read them, as a raw buffer.
+		bool Create(const std::vector<unsigned int>& indices, Index_Format format = Index_Format_UInt32, bool shaderResource = false);
 		bool CreateDynamic(unsigned int initialSize);
-		void* Map();
+		// 32 bit indices that only compute shaders write, through a raw unordered access view
+		bool CreateUnorderedAccess(unsigned int indexCount);
+		// Discarding hands out fresh memory, otherwise the caller promises not to touch anything the GPU may still read (append only)
+		void* Map(bool discard = true);
 		bool Unmap();
 		bool Bind();
 
-		unsigned int GetMemoryUsage() { return m_memoryUsage; }
+		void* GetBuffer()				{ return m_buffer; }
+		void* GetShaderResource()		{ return m_shaderResourceView; }
+		void* GetUnorderedAccessView()	{ return m_unorderedAccessView; }
+		unsigned int GetIndexCount()	{ return m_indexCount; }
+		unsigned int GetMemoryUsage()	{ return m_memoryUsage; }
+		Index_Format GetFormat()		{ return m_format; }
+
+		// The narrowest format that can hold these indices
+		static Index_Format GetFormat(const std::vector<unsigned int>& indices)
+		{
+			return (indices.empty() || *std::max_element(indices.begin(), indices.end()) <= 0xFFFF) ? Index_Format_UInt16 : Index_Format_UInt32;
+		}
 
 	protected:
 		unsigned int m_memoryUsage;
+		Index_Format m_format = Index_Format_UInt32;
 		std::shared_ptr<RHI_Device> m_rhiDevice;
 
+		unsigned int m_indexCount = 0;
+
 		// D3D11
 		void* m_buffer;
+		void* m_shaderResourceView		= nullptr;
+		void* m_unorderedAccessView		= nullptr;
+		RHI_MemoryTracker m_memoryTracker;
 	};
 }
\ No newline at end of file
@@ -30,9 +30,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Texture.h"
 #include "RHI_Shader.h"
 #include "RHI_ConstantBuffer.h"
+#include "RHI_StructuredBuffer.h"
 #include "RHI_InputLayout.h"
 #include "..\Logging\Log.h"
 #include "../Profiling/Profiler.h"
+#include <algorithm>
 //================================
 
 //= NAMESPACES ================
@@ -42,19 +44,79 @@ using namespace Directus::Math;
 
 namespace Directus
 {
+	namespace _RHI_Pipeline
+	{
+		// Forwards the slots which differ from what's bound, one call per run of consecutive changed slots
+		template <typename Setter>
+		inline unsigned int Bind_Changed(const vector<void*>& slots, vector<void*>& boundSlots, Setter set)
+		{
+			unsigned int calls	= 0;
+			unsigned int count	= (unsigned int)slots.size();
+			unsigned int i		= 0;
+			while (i < count)
+			{
+				if (i < (unsigned int)boundSlots.size() && boundSlots[i] == slots[i])
+				{
+					i++;
+					continue;
+				}
+
+				unsigned int start = i;
+				while (i < count && !(i < (unsigned int)boundSlots.size() && boundSlots[i] == slots[i])) { i++; }
+				set(start, i - start, &slots[start]);
+				calls++;
+			}
+
+			if (boundSlots.size() < slots.size())
+			{
+				boundSlots.resize(slots.size());
+			}
+			copy(slots.begin(), slots.end(), boundSlots.begin());
+
+			return calls;
+		}
+
+		inline bool IsBound(const vector<ConstantBufferBinding>& boundSlots, unsigned int slot, void* buffer, unsigned int firstConstant)
+		{
+			return slot < (unsigned int)boundSlots.size() && boundSlots[slot].buffer == buffer && boundSlots[slot].firstConstant == firstConstant;
+		}
+
+		inline void SetBound(vector<ConstantBufferBinding>& boundSlots, unsigned int slot, void* buffer, unsigned int firstConstant)
+		{
+			if (slot >= (unsigned int)boundSlots.size())
+			{
+				boundSlots.resize(slot + 1, ConstantBufferBinding{ nullptr, 0 });
+			}
+			boundSlots[slot] = ConstantBufferBinding{ buffer, firstConstant };
+		}
+	}
+
 	RHI_Pipeline::RHI_Pipeline(shared_ptr<RHI_Device> rhiDevice)
 	{
 		m_rhiDevice	= rhiDevice;
 		Clear();
 	}
 
-	bool RHI_Pipeline::SetState(RHI_PipelineState& pipelineState)
+	bool RHI_Pipeline::SetState(const RHI_PipelineState& pipelineState)
 	{
-		SetPrimitiveTopology(pipelineState.primitiveTopology);
-		SetCullMode(pipelineState.cullMode);
-		SetFillMode(pipelineState.fillMode);
-		if (pipelineState.vertexShader)		SetVertexShader(pipelineState.vertexShader);
-		if (pipelineState.pixelShader)		SetPixelShader(pipelineState.pixelShader);
+		// Fixed part
+		if (pipelineState.hash == 0 || pipelineState.hash != m_stateHash)
+		{
+			auto vertexShader	= pipelineState.vertexShader;
+			auto pixelShader	= pipelineState.pixelShader;
+			if (pipelineState.primitiveTopology != PrimitiveTopology_NotAssigned)	SetPrimitiveTopology(pipelineState.primitiveTopology);
+			if (pipelineState.cullMode != Cull_NotAssigned)							SetCullMode(pipelineState.cullMode);
+			if (pipelineState.fillMode != Fill_NotAssigned)							SetFillMode(pipelineState.fillMode);
+			SetBlendMode(pipelineState.blendMode);
+			SetDepthWrite(pipelineState.depthWrite);
+			if (vertexShader)	SetVertexShader(vertexShader);
+			if (pixelShader)	SetPixelShader(pixelShader);
+			m_stateHash = pipelineState.hash;
+		}
+
+		// Resources
+		if (pipelineState.vertexBuffer)		SetVertexBuffer(pipelineState.vertexBuffer);
+		if (pipelineState.indexBuffer)		SetIndexBuffer(pipelineState.indexBuffer);
 		if (pipelineState.constantBuffer)	SetConstantBuffer(pipelineState.constantBuffer);
 		if (pipelineState.sampler)			SetSampler(pipelineState.sampler);
 
@@ -81,6 +143,7 @@ namespace Directus
 			m_vertexShader			= shader;
 			m_boundVertexShaderID	= m_vertexShader->RHI_GetID();
 			m_vertexShaderDirty		= true;
+			m_stateHash				= 0;
 		}
 
 		return true;
@@ -99,6 +162,7 @@ namespace Directus
 			m_pixelShader			= shader;
 			m_boundPixelShaderID	= m_pixelShader->RHI_GetID();
 			m_pixelShaderDirty		= true;
+			m_stateHash				= 0;
 		}
 
 		return true;
@@ -173,6 +237,24 @@ namespace Directus
 		return true;
 	}
 
+	bool RHI_Pipeline::SetShaderResource(void* shaderResource)
+	{
+		// allow for null texture to be bound so we can maintain slot order
+		m_textures.emplace_back(shaderResource);
+		m_texturesDirty = true;
+
+		return true;
+	}
+
+	bool RHI_Pipeline::SetStructuredBuffer(const shared_ptr<RHI_StructuredBuffer>& structuredBuffer)
+	{
+		// allow for null buffer to be bound so we can maintain slot order
+		m_textures.emplace_back(structuredBuffer ? structuredBuffer->GetShaderResource() : nullptr);
+		m_texturesDirty = true;
+
+		return true;
+	}
+
 	bool RHI_Pipeline::SetRenderTarget(const shared_ptr<RHI_RenderTexture>& renderTarget, void* depthStencilView /*= nullptr*/, bool clear /*= false*/)
 	{
 		if (!renderTarget)
@@ -208,7 +290,7 @@ namespace Directus
 		return true;
 	}
 
-	bool RHI_Pipeline::SetConstantBuffer(const shared_ptr<RHI_ConstantBuffer>& constantBuffer)
+	bool RHI_Pipeline::SetConstantBuffer(const shared_ptr<RHI_ConstantBuffer>& constantBuffer, unsigned int firstConstant /*= 0*/)
 	{
 		if (!constantBuffer)
 		{
@@ -218,17 +300,7 @@ namespace Directus
 
 		m_constantBuffers.buffers.emplace_back(constantBuffer);
 		m_constantBuffers.buffersLowLevel.emplace_back(constantBuffer->GetBuffer());
-
-		Buffer_Scope scope				= constantBuffer->GetScope();
-		m_constantBuffers.sharedScope	= true;
-		for (const auto& buffer : m_constantBuffers.buffers)
-		{
-			if (scope != buffer->GetScope())
-			{
-				m_constantBuffers.sharedScope = false;
-				break;
-			}
-		}
+		m_constantBuffers.firstConstants.emplace_back(firstConstant);
 		m_constantBufferDirty = true;
 
 		return true;
@@ -241,6 +313,7 @@ namespace Directus
 	
 		m_primitiveTopology			= primitiveTopology;
 		m_primitiveTopologyDirty	= true;
+		m_stateHash					= 0;
 	}
 
 	bool RHI_Pipeline::SetInputLayout(const shared_ptr<RHI_InputLayout>& inputLayout)
@@ -262,6 +335,7 @@ namespace Directus
 
 		m_cullMode		= cullMode;
 		m_cullModeDirty = true;
+		m_stateHash		= 0;
 	}
 
 	void RHI_Pipeline::SetFillMode(Fill_Mode fillMode)
@@ -271,6 +345,27 @@ namespace Directus
 
 		m_fillMode		= fillMode;
 		m_fillModeDirty = true;
+		m_stateHash		= 0;
+	}
+
+	void RHI_Pipeline::SetBlendMode(Blend_Mode blendMode)
+	{
+		if (m_blendMode == blendMode && !m_blendModeDirty)
+			return;
+
+		m_blendMode			= blendMode;
+		m_blendModeDirty	= true;
+		m_stateHash			= 0;
+	}
+
+	void RHI_Pipeline::SetDepthWrite(bool depthWrite)
+	{
+		if (m_depthWrite == depthWrite)
+			return;
+
+		m_depthWrite		= depthWrite;
+		m_depthWriteDirty	= true;
+		m_stateHash			= 0;
 	}
 
 	void RHI_Pipeline::SetViewport(float width, float height)
@@ -305,11 +400,15 @@ namespace Directus
 			}
 
 			// Enable or disable depth
-			m_rhiDevice->Set_DepthEnabled(m_depthStencil != nullptr);
+			m_rhiDevice->Set_DepthEnabled(m_depthStencil != nullptr, m_depthWrite);
+			m_depthWriteDirty = false;
 
 			m_rhiDevice->Set_RenderTargets((unsigned int)m_renderTargetViews.size(), &m_renderTargetViews[0], m_depthStencil);
 			Profiler::Get().m_rhiBindingsRenderTarget++;
 
+			// The device unbinds any texture that is now being rendered to
+			m_boundTextures.clear();
+
 			if (m_renderTargetsClear)
 			{
 				for (const auto& renderTargetView : m_renderTargetViews)
@@ -319,7 +418,7 @@ namespace Directus
 
 				if (m_depthStencil)
 				{
-					m_rhiDevice->ClearDepthStencil(m_depthStencil, Clear_Depth, m_viewport.GetMaxDepth(), 1);
+					m_rhiDevice->ClearDepthStencil(m_depthStencil, Clear_Depth, m_rhiDevice->Get_DepthFar(m_viewport), 1);
 				}
 			}
 
@@ -379,12 +478,27 @@ namespace Directus
 			m_fillModeDirty = false;
 		}
 
+		// Blending
+		if (m_blendModeDirty)
+		{
+			m_rhiDevice->Set_BlendMode(m_blendMode);
+			m_blendModeDirty = false;
+		}
+
+		// Depth write, with unchanged render targets
+		if (m_depthWriteDirty)
+		{
+			m_rhiDevice->Set_DepthEnabled(m_depthStencil != nullptr, m_depthWrite);
+			m_depthWriteDirty = false;
+		}
+
 		// Sampler
 		if (m_samplersDirty)
 		{
-			unsigned int startSlot = 0;
-			m_rhiDevice->Set_Samplers(startSlot, (unsigned int)m_samplers.size(), &m_samplers[0]);
-			Profiler::Get().m_rhiBindingsSampler++;
+			Profiler::Get().m_rhiBindingsSampler += _RHI_Pipeline::Bind_Changed(m_samplers, m_boundSamplers, [this](unsigned int startSlot, unsigned int count, void* const* samplers)
+			{
+				m_rhiDevice->Set_Samplers(startSlot, count, samplers);
+			});
 			m_samplers.clear();
 			m_samplersDirty = false;
 		}
@@ -392,10 +506,11 @@ namespace Directus
 		// Textures
 		if (m_texturesDirty)
 		{
-			unsigned int startSlot = 0;
-			m_rhiDevice->Set_Textures(startSlot, (unsigned int)m_textures.size(), &m_textures[0]);
+			Profiler::Get().m_rhiBindingsTexture += _RHI_Pipeline::Bind_Changed(m_textures, m_boundTextures, [this](unsigned int startSlot, unsigned int count, void* const* textures)
+			{
+				m_rhiDevice->Set_Textures(startSlot, count, textures);
+			});
 			m_textures.clear();
-			Profiler::Get().m_rhiBindingsTexture++;
 			m_texturesDirty = false;
 		}
 
@@ -403,8 +518,12 @@ namespace Directus
 		bool resultIndexBuffer = true;
 		if (m_indexBufferDirty)
 		{
-			resultIndexBuffer = m_indexBuffer->Bind();
-			Profiler::Get().m_rhiBindingsBufferIndex++;
+			if (m_boundIndexBuffer != m_indexBuffer->GetBuffer())
+			{
+				resultIndexBuffer	= m_indexBuffer->Bind();
+				m_boundIndexBuffer	= resultIndexBuffer ? m_indexBuffer->GetBuffer() : nullptr;
+				Profiler::Get().m_rhiBindingsBufferIndex++;
+			}
 			m_indexBufferDirty = false;
 		}
 
@@ -412,31 +531,68 @@ namespace Directus
 		bool resultVertexBuffer = true;
 		if (m_vertexBufferDirty)
 		{
-			resultVertexBuffer = m_vertexBuffer->Bind();
-			Profiler::Get().m_rhiBindingsBufferVertex++;
+			if (m_boundVertexBuffer != m_vertexBuffer->GetBuffer())
+			{
+				resultVertexBuffer	= m_vertexBuffer->Bind();
+				m_boundVertexBuffer	= resultVertexBuffer ? m_vertexBuffer->GetBuffer() : nullptr;
+				Profiler::Get().m_rhiBindingsBufferVertex++;
+			}
 			m_vertexBufferDirty = false;
 		}
 
 		// Constant buffer
 		if (m_constantBufferDirty)
 		{
-			// Check to see if we can set them in one go
-			if (m_constantBuffers.buffers.size() > 1 && m_constantBuffers.sharedScope)
+			auto isBound = [this](const shared_ptr<RHI_ConstantBuffer>& constantBuffer, unsigned int firstConstant)
 			{
-				auto buffer = m_constantBuffers.buffers.front();
-				unsigned int startSlot = buffer->GetSlot();
-				Buffer_Scope scope = buffer->GetScope();
-				m_rhiDevice->Set_ConstantBuffers(startSlot, (unsigned int)m_constantBuffers.buffers.size(), scope, (void*const*)&m_constantBuffers.buffersLowLevel[0]);
-				Profiler::Get().m_rhiBindingsBufferConstant += buffer->GetScope() == Buffer_Global ? 2 : 1;
-			}
-			else // Set them one by one
+				auto scope	= constantBuffer->GetScope();
+				auto slot	= constantBuffer->GetSlot();
+				auto buffer	= constantBuffer->GetBuffer();
+				bool vs		= scope == Buffer_PixelShader	|| _RHI_Pipeline::IsBound(m_boundConstantBuffersVS, slot, buffer, firstConstant);
+				bool ps		= scope == Buffer_VertexShader	|| _RHI_Pipeline::IsBound(m_boundConstantBuffersPS, slot, buffer, firstConstant);
+				return vs && ps;
+			};
+
+			// Changed buffers which share scope and occupy consecutive slots are set in one go, rings are bound at an offset
+			unsigned int count	= (unsigned int)m_constantBuffers.buffers.size();
+			unsigned int i		= 0;
+			while (i < count)
 			{
-				for (const auto& constantBuffer : m_constantBuffers.buffers)
+				const auto& constantBuffer	= m_constantBuffers.buffers[i];
+				unsigned int firstConstant	= m_constantBuffers.firstConstants[i];
+				if (isBound(constantBuffer, firstConstant))
 				{
-					auto ptr = constantBuffer->GetBuffer();
-					m_rhiDevice->Set_ConstantBuffers(constantBuffer->GetSlot(), 1, constantBuffer->GetScope(), (void*const*)&ptr);
-					Profiler::Get().m_rhiBindingsBufferConstant += constantBuffer->GetScope() == Buffer_Global ? 2 : 1;
+					i++;
+					continue;
 				}
+
+				if (constantBuffer->IsRing())
+				{
+					m_rhiDevice->Set_ConstantBufferRange(constantBuffer->GetSlot(), constantBuffer->GetScope(), constantBuffer->GetBuffer(), firstConstant, constantBuffer->GetConstantCount());
+					i++;
+				}
+				else
+				{
+					unsigned int start = i++;
+					while (i < count)
+					{
+						const auto& next = m_constantBuffers.buffers[i];
+						bool contiguous = next->GetScope() == constantBuffer->GetScope() && next->GetSlot() == m_constantBuffers.buffers[i - 1]->GetSlot() + 1;
+						if (!contiguous || next->IsRing() || isBound(next, m_constantBuffers.firstConstants[i]))
+							break;
+						i++;
+					}
+					m_rhiDevice->Set_ConstantBuffers(constantBuffer->GetSlot(), i - start, constantBuffer->GetScope(), (void*const*)&m_constantBuffers.buffersLowLevel[start]);
+				}
+				Profiler::Get().m_rhiBindingsBufferConstant += constantBuffer->GetScope() == Buffer_Global ? 2 : 1;
+			}
+
+			for (i = 0; i < count; i++)
+			{
+				const auto& constantBuffer	= m_constantBuffers.buffers[i];
+				auto scope					= constantBuffer->GetScope();
+				if (scope != Buffer_PixelShader)	_RHI_Pipeline::SetBound(m_boundConstantBuffersVS, constantBuffer->GetSlot(), constantBuffer->GetBuffer(), m_constantBuffers.firstConstants[i]);
+				if (scope != Buffer_VertexShader)	_RHI_Pipeline::SetBound(m_boundConstantBuffersPS, constantBuffer->GetSlot(), constantBuffer->GetBuffer(), m_constantBuffers.firstConstants[i]);
 			}
 
 			m_constantBuffers.Clear();
@@ -454,6 +610,13 @@ namespace Directus
 		m_fillMode = Fill_NotAssigned;
 		m_fillModeDirty = false;
 
+		// Unknown after a clear, so the first bind forwards it
+		m_blendMode			= Blend_Disabled;
+		m_blendModeDirty	= true;
+		m_depthWrite		= true;
+		m_depthWriteDirty	= false; // goes along with the next render targets
+		m_stateHash				= 0;
+
 		m_inputLayout		= Input_NotAssigned;
 		m_inputLayoutDirty	= false;
 
@@ -462,12 +625,15 @@ namespace Directus
 
 		m_inputLayoutBuffer	= nullptr;
 
+		m_viewport		= RHI_Viewport(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
 		m_viewportDirty	= false;
 
 		m_vertexShader			= nullptr;	
 		m_pixelShader			= nullptr;	
 		m_vertexShaderDirty		= false;
 		m_pixelShaderDirty		= false;
+		m_boundVertexShaderID	= 0;
+		m_boundPixelShaderID	= 0;
 
 		m_indexBufferDirty	= false;
 		m_vertexBufferDirty	= false;
@@ -484,5 +650,12 @@ namespace Directus
 
 		m_constantBuffers.Clear();
 		m_constantBufferDirty = false;
+
+		m_boundTextures.clear();
+		m_boundSamplers.clear();
+		m_boundConstantBuffersVS.clear();
+		m_boundConstantBuffersPS.clear();
+		m_boundIndexBuffer	= nullptr;
+		m_boundVertexBuffer	= nullptr;
 	}
 }
\ No newline at end of file
@@ -36,23 +36,31 @@ namespace Directus
 	{
 		std::vector<std::shared_ptr<RHI_ConstantBuffer>> buffers;
 		std::vector<void*> buffersLowLevel;
-		bool sharedScope;
+		std::vector<unsigned int> firstConstants;
 
 		void Clear()
 		{
 			buffers.clear();
 			buffersLowLevel.clear();
-			sharedScope = false;
+			firstConstants.clear();
 		}
 	};
 
+	// A constant buffer as it was last handed to the device for a given slot
+	struct ConstantBufferBinding
+	{
+		void* buffer;
+		unsigned int firstConstant;
+	};
+
 	class ENGINE_CLASS RHI_Pipeline
 	{
 	public:
 		RHI_Pipeline(std::shared_ptr<RHI_Device> rhiDevice);
 		~RHI_Pipeline(){}
 
-		bool SetState(RHI_PipelineState& pipelineState);
+		// Skips the fixed part of states from RHI_PipelineCache which are already bound
+		bool SetState(const RHI_PipelineState& pipelineState);
 
 		// Shader
 		void SetShader(std::shared_ptr<RHI_Shader>& shader);
@@ -63,13 +71,17 @@ namespace Directus
 		bool SetTexture(const std::shared_ptr<RHI_RenderTexture>& texture);
 		bool SetTexture(const std::shared_ptr<RHI_Texture>& texture);
 		bool SetTexture(const RHI_Texture* texture);
+		// A view the caller already has, e.g. an ImGui texture id
+		bool SetShaderResource(void* shaderResource);
+		// Structured buffers share the texture slots, they occupy the next one in order
+		bool SetStructuredBuffer(const std::shared_ptr<RHI_StructuredBuffer>& structuredBuffer);
 
 		// Render targets
 		bool SetRenderTarget(const std::shared_ptr<RHI_RenderTexture>& renderTarget, void* depthStencilView = nullptr, bool clear = false);
 		bool SetRenderTargets(const std::vector<void*>& renderTargetViews, void* depthStencilView = nullptr, bool clear = false);
 
 		// Constant, vertex & index buffers
-		bool SetConstantBuffer(const std::shared_ptr<RHI_ConstantBuffer>& constantBuffer);
+		bool SetConstantBuffer(const std::shared_ptr<RHI_ConstantBuffer>& constantBuffer, unsigned int firstConstant = 0);
 		bool SetIndexBuffer(const std::shared_ptr<RHI_IndexBuffer>& indexBuffer);
 		bool SetVertexBuffer(const std::shared_ptr<RHI_VertexBuffer>& vertexBuffer);
 		
@@ -88,6 +100,12 @@ namespace Directus
 		// Fill mode
 		void SetFillMode(Fill_Mode filleMode);
 
+		// Blending
+		void SetBlendMode(Blend_Mode blendMode);
+
+		// Whether the depth-stencil view (if any) gets written to, or only tested against
+		void SetDepthWrite(bool depthWrite);
+
 		// Viewport
 		void SetViewport(float width, float height);
 		void SetViewport(const RHI_Viewport& viewport);
@@ -95,8 +113,10 @@ namespace Directus
 		// Bind to the GPU
 		bool Bind();
 
-		// Clears all currently set settings
+		// Clears all currently set settings and forgets what the device has bound
 		void Clear();
+		// Binding a texture for writing outside of the pipeline (compute) unbinds it everywhere, so the next bind can't skip any
+		void InvalidateTextures() { m_boundTextures.clear(); }
 
 	private:
 		// Primitive topology
@@ -116,6 +136,17 @@ namespace Directus
 		Fill_Mode m_fillMode;
 		bool m_fillModeDirty;
 
+		// Blending
+		Blend_Mode m_blendMode;
+		bool m_blendModeDirty;
+
+		// Depth write
+		bool m_depthWrite;
+		bool m_depthWriteDirty;
+
+		// Hash of the last cached state set, any change by hand resets it
+		unsigned int m_stateHash;
+
 		// Samplers
 		std::vector<void*> m_samplers;
 		bool m_samplersDirty;
@@ -160,5 +191,13 @@ namespace Directus
 		// IDs
 		unsigned int m_boundVertexShaderID;
 		unsigned int m_boundPixelShaderID;
+
+		// What the device currently has bound, slots past the end are unknown
+		std::vector<void*> m_boundTextures;
+		std::vector<void*> m_boundSamplers;
+		std::vector<ConstantBufferBinding> m_boundConstantBuffersVS;
+		std::vector<ConstantBufferBinding> m_boundConstantBuffersPS;
+		void* m_boundIndexBuffer;
+		void* m_boundVertexBuffer;
 	};
 }
\ No newline at end of file
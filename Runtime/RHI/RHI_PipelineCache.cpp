@@ -0,0 +1,123 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "RHI_PipelineCache.h"
+#include "RHI_Shader.h"
+#include "..\Logging\Log.h"
+#include <functional>
+//===============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	namespace _RHI_PipelineCache
+	{
+		template <typename T>
+		inline void Hash_Combine(size_t& seed, const T& value)
+		{
+			seed ^= hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+
+		inline bool Equals(const RHI_PipelineState& a, const RHI_PipelineState& b)
+		{
+			return
+				a.primitiveTopology	== b.primitiveTopology	&&
+				a.cullMode			== b.cullMode			&&
+				a.fillMode			== b.fillMode			&&
+				a.blendMode			== b.blendMode			&&
+				a.depthWrite		== b.depthWrite			&&
+				a.vertexShader		== b.vertexShader		&&
+				a.pixelShader		== b.pixelShader		&&
+				a.vertexBuffer		== b.vertexBuffer		&&
+				a.indexBuffer		== b.indexBuffer		&&
+				a.sampler			== b.sampler			&&
+				a.constantBuffer	== b.constantBuffer		&&
+				a.viewport			== b.viewport;
+		}
+	}
+
+	RHI_PipelineCache::RHI_PipelineCache(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+	}
+
+	shared_ptr<RHI_PipelineState> RHI_PipelineCache::GetState(const RHI_PipelineState& description)
+	{
+		unsigned int hash = ComputeHash(description);
+
+		lock_guard<mutex> lock(m_mutex);
+		auto it = m_states.find(hash);
+		if (it != m_states.end())
+		{
+			if (_RHI_PipelineCache::Equals(*it->second, description))
+				return it->second;
+
+			// A collision, hand out an unhashed copy so it's never mistaken for the cached one
+			LOG_WARNING("RHI_PipelineCache::GetState: Hash collision, the state will not be cached");
+			auto state	= make_shared<RHI_PipelineState>(description);
+			state->hash	= 0;
+			return state;
+		}
+
+		auto state	= make_shared<RHI_PipelineState>(description);
+		state->hash	= hash;
+		m_states[hash] = state;
+
+		return state;
+	}
+
+	unsigned int RHI_PipelineCache::GetStateCount()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		return (unsigned int)m_states.size();
+	}
+
+	void RHI_PipelineCache::Clear()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_states.clear();
+	}
+
+	unsigned int RHI_PipelineCache::ComputeHash(const RHI_PipelineState& description)
+	{
+		size_t seed = 0;
+		_RHI_PipelineCache::Hash_Combine(seed, (int)description.primitiveTopology);
+		_RHI_PipelineCache::Hash_Combine(seed, (int)description.cullMode);
+		_RHI_PipelineCache::Hash_Combine(seed, (int)description.fillMode);
+		_RHI_PipelineCache::Hash_Combine(seed, (int)description.blendMode);
+		_RHI_PipelineCache::Hash_Combine(seed, description.depthWrite);
+		_RHI_PipelineCache::Hash_Combine(seed, description.vertexShader ? description.vertexShader->RHI_GetID() : 0);
+		_RHI_PipelineCache::Hash_Combine(seed, description.pixelShader ? description.pixelShader->RHI_GetID() : 0);
+		_RHI_PipelineCache::Hash_Combine(seed, (void*)description.vertexBuffer.get());
+		_RHI_PipelineCache::Hash_Combine(seed, (void*)description.indexBuffer.get());
+		_RHI_PipelineCache::Hash_Combine(seed, (void*)description.sampler.get());
+		_RHI_PipelineCache::Hash_Combine(seed, (void*)description.constantBuffer.get());
+		_RHI_PipelineCache::Hash_Combine(seed, (void*)description.viewport.get());
+
+		// Zero is reserved for states which didn't come from the cache
+		auto hash = (unsigned int)((uint64_t)seed ^ ((uint64_t)seed >> 32));
+		return hash != 0 ? hash : 1;
+	}
+}
@@ -0,0 +1,54 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "..\Core\EngineDefs.h"
+#include "RHI_PipelineState.h"
+//=============================
+
+namespace Directus
+{
+	// Hands out immutable pipeline states, identical descriptions share one state and one hash.
+	// States are meant to be created up front, binding one whose hash is already bound skips its fixed part.
+	class ENGINE_CLASS RHI_PipelineCache
+	{
+	public:
+		RHI_PipelineCache(std::shared_ptr<RHI_Device> rhiDevice);
+		~RHI_PipelineCache() { Clear(); }
+
+		// Returns the state matching the description, creating it on first request
+		std::shared_ptr<RHI_PipelineState> GetState(const RHI_PipelineState& description);
+		unsigned int GetStateCount();
+		void Clear();
+
+		static unsigned int ComputeHash(const RHI_PipelineState& description);
+
+	private:
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		std::unordered_map<unsigned int, std::shared_ptr<RHI_PipelineState>> m_states;
+		std::mutex m_mutex;
+	};
+}
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==============
 #include "RHI_Definition.h"
+#include <memory>
 //=========================
 
 namespace Directus
@@ -31,15 +32,23 @@ namespace Directus
 	{
 		RHI_PipelineState() {}
 
-		PrimitiveTopology_Mode primitiveTopology;
-		Cull_Mode cullMode;
-		Fill_Mode fillMode;
+		// Fixed once the state is handed out by RHI_PipelineCache, part of the hash
+		PrimitiveTopology_Mode primitiveTopology	= PrimitiveTopology_NotAssigned;
+		Cull_Mode cullMode							= Cull_NotAssigned;
+		Fill_Mode fillMode							= Fill_NotAssigned;
+		Blend_Mode blendMode						= Blend_Disabled;
+		bool depthWrite								= true;	// when there is a depth-stencil view to test against
 		std::shared_ptr<RHI_Shader> vertexShader;
 		std::shared_ptr<RHI_Shader> pixelShader;
+
+		// Resources which are bound along with the state
 		std::shared_ptr<RHI_VertexBuffer> vertexBuffer;
 		std::shared_ptr<RHI_IndexBuffer> indexBuffer;
 		std::shared_ptr<RHI_Sampler> sampler;
 		std::shared_ptr<RHI_ConstantBuffer> constantBuffer;
 		std::shared_ptr<RHI_Viewport> viewport;
+
+		// Assigned by RHI_PipelineCache, zero for states which were put together by hand
+		unsigned int hash = 0;
 	};
 }
\ No newline at end of file
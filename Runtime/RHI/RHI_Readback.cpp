@@ -0,0 +1,262 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "RHI_Readback.h"
+#include "RHI_RenderTexture.h"
+#include "RHI_StructuredBuffer.h"
+#include "../Logging/Log.h"
+#include <algorithm>
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+#define READBACK_STAGING_MAX 16 // staging resources in flight, requests beyond them fail rather than stall
+
+namespace Directus
+{
+	RHI_Readback::RHI_Readback(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, 0);
+	}
+
+	RHI_Readback::~RHI_Readback()
+	{
+		for (auto& staging : m_staging)
+		{
+			Staging_Destroy(*staging);
+		}
+		m_staging.clear();
+	}
+
+	unsigned int RHI_Readback::Request(RHI_RenderTexture* texture, const Callback& callback /*= nullptr*/, unsigned int x /*= 0*/, unsigned int y /*= 0*/, unsigned int width /*= 0*/, unsigned int height /*= 0*/)
+	{
+		if (!m_rhiDevice || !texture)
+			return 0;
+
+		if (width == 0 || height == 0)
+		{
+			x = y	= 0;
+			width	= texture->GetWidth();
+			height	= texture->GetHeight();
+		}
+
+		if (x + width > texture->GetWidth() || y + height > texture->GetHeight())
+		{
+			LOG_ERROR("RHI_Readback::Request: Invalid region.");
+			return 0;
+		}
+
+		auto staging = Staging_Acquire(true, texture->GetFormat(), width, height);
+		if (!staging || !Copy_Texture(*staging, texture, x, y))
+			return 0;
+
+		return Staging_Issue(staging, callback);
+	}
+
+	unsigned int RHI_Readback::Request(RHI_StructuredBuffer* buffer, const Callback& callback /*= nullptr*/, unsigned int offset /*= 0*/, unsigned int size /*= 0*/)
+	{
+		if (!m_rhiDevice || !buffer || !buffer->GetBuffer())
+			return 0;
+
+		unsigned int bufferSize = buffer->GetStride() * buffer->GetElementCount();
+		if (size == 0 && offset < bufferSize)
+		{
+			size = bufferSize - offset;
+		}
+
+		if (size == 0 || offset + size > bufferSize)
+		{
+			LOG_ERROR("RHI_Readback::Request: Invalid range.");
+			return 0;
+		}
+
+		auto staging = Staging_Acquire(false, Texture_Format_R8G8B8A8_UNORM, size, 1);
+		if (!staging || !Copy_Buffer(*staging, buffer, offset))
+			return 0;
+
+		return Staging_Issue(staging, callback);
+	}
+
+	void RHI_Readback::Poll()
+	{
+		// Older requests first, so callbacks see them in order
+		vector<Staging*> inFlight;
+		for (auto& staging : m_staging)
+		{
+			if (staging->request != 0)
+			{
+				inFlight.emplace_back(staging.get());
+			}
+		}
+		sort(inFlight.begin(), inFlight.end(), [](Staging* a, Staging* b) { return a->request < b->request; });
+
+		// The staging resources are idle again before any callback runs, a callback can request the next readback right away
+		struct Finished
+		{
+			unsigned int request;
+			Callback callback;
+			vector<unsigned char> data;
+		};
+		vector<Finished> finished;
+		for (auto staging : inFlight)
+		{
+			vector<unsigned char> data;
+			if (!Staging_Read(*staging, data))
+				continue;
+
+			if (!staging->canceled)
+			{
+				if (staging->callback)
+				{
+					finished.push_back({ staging->request, move(staging->callback), move(data) });
+				}
+				else
+				{
+					m_finished[staging->request] = move(data);
+				}
+			}
+
+			staging->request	= 0;
+			staging->canceled	= false;
+			staging->callback	= nullptr;
+		}
+
+		for (auto& request : finished)
+		{
+			request.callback(request.request, request.data);
+		}
+	}
+
+	bool RHI_Readback::Get(unsigned int request, vector<unsigned char>& data)
+	{
+		auto it = m_finished.find(request);
+		if (it == m_finished.end())
+			return false;
+
+		data = move(it->second);
+		m_finished.erase(it);
+		return true;
+	}
+
+	void RHI_Readback::Cancel(unsigned int request)
+	{
+		m_finished.erase(request);
+		for (auto& staging : m_staging)
+		{
+			if (staging->request == request)
+			{
+				staging->canceled = true;
+				staging->callback = nullptr;
+			}
+		}
+	}
+
+	bool RHI_Readback::IsPending(unsigned int request)
+	{
+		for (auto& staging : m_staging)
+		{
+			if (staging->request == request && !staging->canceled)
+				return true;
+		}
+
+		return false;
+	}
+
+	unsigned int RHI_Readback::GetPendingCount()
+	{
+		unsigned int count = 0;
+		for (auto& staging : m_staging)
+		{
+			count += (staging->request != 0 && !staging->canceled) ? 1 : 0;
+		}
+
+		return count;
+	}
+
+	RHI_Readback::Staging* RHI_Readback::Staging_Acquire(bool texture, Texture_Format format, unsigned int width, unsigned int height)
+	{
+		auto matches = [&](const Staging& staging)
+		{
+			return staging.texture == texture && staging.width == width && staging.height == height && (!texture || staging.format == format);
+		};
+
+		// An idle one of the same size, or the room for a new one
+		Staging* idle = nullptr;
+		for (auto& staging : m_staging)
+		{
+			if (staging->request != 0)
+				continue;
+
+			if (matches(*staging))
+				return staging.get();
+
+			idle = idle ? idle : staging.get();
+		}
+
+		if (m_staging.size() < READBACK_STAGING_MAX)
+		{
+			m_staging.emplace_back(make_unique<Staging>());
+			idle = m_staging.back().get();
+		}
+
+		if (!idle)
+		{
+			LOG_WARNING("RHI_Readback::Staging_Acquire: Every staging resource is in flight, the request is dropped.");
+			return nullptr;
+		}
+
+		// Re-create an idle one of another size
+		m_stagingBytes -= idle->resource ? (unsigned long long)idle->width * idle->height * (idle->texture ? Texture_Format_GetBytes(idle->format) : 1) : 0;
+		Staging_Destroy(*idle);
+		idle->texture	= texture;
+		idle->format	= format;
+		idle->width		= width;
+		idle->height	= height;
+		if (!Staging_Create(*idle))
+		{
+			idle->width = 0; // matches nothing
+			LOG_ERROR("RHI_Readback::Staging_Acquire: Failed to create staging resource.");
+			return nullptr;
+		}
+		m_stagingBytes += (unsigned long long)width * height * (texture ? Texture_Format_GetBytes(format) : 1);
+		m_memoryTracker.Set(m_stagingBytes);
+
+		return idle;
+	}
+
+	unsigned int RHI_Readback::Staging_Issue(Staging* staging, const Callback& callback)
+	{
+		// 0 is reserved for idle
+		if (++m_requestCount == 0)
+		{
+			m_requestCount = 1;
+		}
+
+		staging->request	= m_requestCount;
+		staging->canceled	= false;
+		staging->callback	= callback;
+		return staging->request;
+	}
+}
@@ -0,0 +1,99 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include "RHI_Object.h"
+#include "RHI_Definition.h"
+#include "RHI_Device.h"
+#include "..\Core\EngineDefs.h"
+//=============================
+
+namespace Directus
+{
+	// Copies GPU resources into CPU readable memory without ever waiting on the GPU. A request records a copy into one of a
+	// ring of staging resources and the data comes back a few frames later, once the GPU got to it, through the request's
+	// callback (called by Poll) or through Get. Staging resources are reused by whatever asks for the same size next.
+	// Everything here happens on the rendering thread.
+	class ENGINE_CLASS RHI_Readback : public RHI_Object
+	{
+	public:
+		// Textures come back with tightly packed rows
+		typedef std::function<void(unsigned int request, const std::vector<unsigned char>& data)> Callback;
+
+		RHI_Readback(std::shared_ptr<RHI_Device> rhiDevice);
+		~RHI_Readback();
+
+		// A region of a render texture's color, a width or height of 0 is the whole texture. Returns the request, or 0 when
+		// the copy wasn't recorded (every staging resource is in flight, rather than waiting for one to come back).
+		unsigned int Request(RHI_RenderTexture* texture, const Callback& callback = nullptr, unsigned int x = 0, unsigned int y = 0, unsigned int width = 0, unsigned int height = 0);
+		// A range of a structured buffer the GPU writes (see RHI_StructuredBuffer::CreateUnorderedAccess), in bytes, a size of 0 is the rest of it
+		unsigned int Request(RHI_StructuredBuffer* buffer, const Callback& callback = nullptr, unsigned int offset = 0, unsigned int size = 0);
+		// Hands the requests the GPU has finished to their callbacks, in the order they were made, the ones without a callback
+		// wait for Get. Call it once a frame.
+		void Poll();
+		// Moves out the data of a finished request that has no callback, false while it's in flight (or unknown)
+		bool Get(unsigned int request, std::vector<unsigned char>& data);
+		// The request's data is thrown away when it arrives, a callback isn't called
+		void Cancel(unsigned int request);
+		bool IsPending(unsigned int request);
+		unsigned int GetPendingCount();
+
+	private:
+		struct Staging
+		{
+			void* resource			= nullptr;	// native, see the backend
+			Texture_Format format	= Texture_Format_R8G8B8A8_UNORM;
+			bool texture			= false;
+			unsigned int width		= 0;		// bytes for buffers
+			unsigned int height		= 1;
+			unsigned int request	= 0;		// 0 when idle
+			unsigned long long frame = 0;		// the copy was recorded during
+			bool canceled			= false;
+			Callback callback;
+		};
+
+		// An idle staging resource of the given size, created if there is none, null if they are all in flight
+		Staging* Staging_Acquire(bool texture, Texture_Format format, unsigned int width, unsigned int height);
+		unsigned int Staging_Issue(Staging* staging, const Callback& callback);
+
+		//= BACKEND ==========================================================================================
+		bool Staging_Create(Staging& staging);
+		void Staging_Destroy(Staging& staging);
+		bool Copy_Texture(Staging& staging, RHI_RenderTexture* texture, unsigned int x, unsigned int y);
+		bool Copy_Buffer(Staging& staging, RHI_StructuredBuffer* buffer, unsigned int offset);
+		// Copies out the staging resource's data, false (without waiting) while the GPU hasn't finished the copy
+		bool Staging_Read(Staging& staging, std::vector<unsigned char>& data);
+		//====================================================================================================
+
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		std::vector<std::unique_ptr<Staging>> m_staging;
+		std::unordered_map<unsigned int, std::vector<unsigned char>> m_finished; // requests without a callback
+		unsigned int m_requestCount = 0;
+		unsigned long long m_stagingBytes = 0;
+		RHI_MemoryTracker m_memoryTracker;
+	};
+}
@@ -22,7 +22,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ==============
+#include <vector>
 #include "RHI_Definition.h"
+#include "RHI_Device.h"
 #include "RHI_Viewport.h"
 #include "RHI_Object.h"
 #include "..\Math\Matrix.h"
@@ -39,21 +41,38 @@ namespace Directus
 			int height						= Settings::Get().Resolution_GetHeight(),
 			Texture_Format textureFormat	= Texture_Format_R8G8B8A8_UNORM,
 			bool depth						= false,
-			Texture_Format depthFormat		= Texture_Format_D32_FLOAT
+			Texture_Format depthFormat		= Texture_Format_D32_FLOAT,
+			bool unorderedAccess			= false // allows compute shaders to write into it
 		);
 		~RHI_RenderTexture();
 
 		bool Clear(const Math::Vector4& clearColor);
 		bool Clear(float red, float green, float blue, float alpha);
+		// Copies the color and depth of a render texture with identical dimensions and formats
+		bool CopyFrom(const std::shared_ptr<RHI_RenderTexture>& source);
+		// Copies all of a smaller render texture's color (same format) into this one, with it's top left corner at x, y
+		bool CopyRegionFrom(const std::shared_ptr<RHI_RenderTexture>& source, unsigned int x, unsigned int y);
+		// Queues a copy into CPU readable memory, the data becomes available a few frames later. A region (a width or height
+		// of 0 is the whole texture) has to be as large as the first one requested, that's the size of the staging memory.
+		// The request is the number Readback_Get reports the copy's data with.
+		bool Readback_Request(unsigned int x = 0, unsigned int y = 0, unsigned int width = 0, unsigned int height = 0, unsigned int* request = nullptr);
+		// Copies out (tightly packed) the latest request the GPU has finished, without stalling. Returns false if none has.
+		bool Readback_Get(std::vector<unsigned char>& data, unsigned int* request = nullptr);
 		void ComputeOrthographicProjectionMatrix(float nearPlane, float farPlane);
 		void* GetRenderTargetView();
 		void* GetShaderResource();
 		void* GetDepthStencilView();
+		void* GetUnorderedAccessView()							{ return m_unorderedAccessView; }
+		// The native color texture (an image in Vulkan), for whatever copies out of it
+		void* GetRenderTargetTexture()							{ return m_renderTargetTexture; }
 		const Math::Matrix& GetOrthographicProjectionMatrix()	{ return m_orthographicProjectionMatrix; }
 		const RHI_Viewport& GetViewport()						{ return m_viewport; }
 		bool GetDepthEnabled()									{ return m_depthEnabled; }
 		unsigned int GetWidth()									{ return m_width; }
 		unsigned int GetHeight()								{ return m_height; }
+		Texture_Format GetFormat()								{ return m_format; }
+		// Render targets by default, whoever acquires one for something else (shadow maps) says so
+		void SetMemoryCategory(Memory_Category category)		{ m_memoryTracker.SetCategory(category); }
 
 	protected:
 		bool m_depthEnabled = false;
@@ -71,5 +90,15 @@ namespace Directus
 		void* m_shaderResourceView;	
 		void* m_depthStencilBuffer;
 		void* m_depthStencilView;
+		void* m_unorderedAccessView;
+
+		// Readback
+		std::vector<void*> m_readbackTextures;
+		std::vector<unsigned int> m_readbackRequests; // per staging texture, 0 when idle
+		unsigned int m_readbackCount	= 0;
+		unsigned int m_readbackWidth	= 0;
+		unsigned int m_readbackHeight	= 0;
+
+		RHI_MemoryTracker m_memoryTracker;
 	};
 }
\ No newline at end of file
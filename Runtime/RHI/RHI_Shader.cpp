@@ -23,6 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Shader.h"
 #include "RHI_ConstantBuffer.h"
 #include "..\Logging\Log.h"
+#include "..\FileSystem\FileSystem.h"
+#include "..\FileSystem\FileWatcher.h"
+#include <fstream>
+#include <set>
+#include <algorithm>
 //=============================
 
 //= NAMESPACES =====
@@ -31,11 +36,72 @@ using namespace std;
 
 namespace Directus
 {
+	namespace _RHI_Shader
+	{
+		// Paths are compared ignoring case, like the file system does
+		inline string ToLower(string path)
+		{
+			transform(path.begin(), path.end(), path.begin(), [](unsigned char c) { return (char)tolower(c); });
+			return path;
+		}
+
+		// The file and everything it includes, as normalized paths
+		inline void GatherFiles(const string& filePath, set<string>& files)
+		{
+			if (!files.insert(ToLower(FileWatcher::NormalizePath(filePath))).second)
+				return;
+
+			ifstream file(filePath, ios::binary);
+			string line;
+			while (getline(file, line))
+			{
+				auto include = line.find("#include");
+				if (include == string::npos)
+					continue;
+
+				auto open	= line.find('"', include);
+				auto close	= open != string::npos ? line.find('"', open + 1) : string::npos;
+				if (close != string::npos)
+				{
+					GatherFiles(FileSystem::GetDirectoryFromFilePath(filePath) + line.substr(open + 1, close - open - 1), files);
+				}
+			}
+		}
+	}
+
+	string RHI_Shader::m_cacheDirectory;
+
+	void RHI_Shader::SetCacheDirectory(const string& directory)
+	{
+		if (!directory.empty() && !FileSystem::DirectoryExists(directory))
+		{
+			if (!FileSystem::CreateDirectory_(directory))
+			{
+				LOGF_WARNING("RHI_Shader::SetCacheDirectory: Failed to create \"%s\", shaders will not be cached", directory.c_str());
+				m_cacheDirectory.clear();
+				return;
+			}
+		}
+
+		m_cacheDirectory = directory;
+	}
+
 	void RHI_Shader::AddDefine(const std::string& define, const std::string& value /*= "1"*/)
 	{
 		m_macros[define] = value;
 	}
 
+	bool RHI_Shader::DependsOn(const string& filePathNormalized)
+	{
+		if (m_filePath.empty())
+			return false;
+
+		// Read again every time, an edit could have just changed what's included
+		set<string> files;
+		_RHI_Shader::GatherFiles(m_filePath, files);
+		return files.count(_RHI_Shader::ToLower(filePathNormalized)) != 0;
+	}
+
 	void RHI_Shader::UpdateBuffer(void* data)
 	{
 		if (!m_constantBuffer)
@@ -37,8 +37,10 @@ namespace Directus
 {
 	static const char* VERTEX_SHADER_ENTRYPOINT = "mainVS";
 	static const char* PIXEL_SHADER_ENTRYPOINT	= "mainPS";
+	static const char* COMPUTE_SHADER_ENTRYPOINT	= "mainCS";
 	static const char* VERTEX_SHADER_MODEL		= "vs_5_0";
 	static const char* PIXEL_SHADER_MODEL		= "ps_5_0";
+	static const char* COMPUTE_SHADER_MODEL		= "cs_5_0";
 
 	enum Shader_State
 	{
@@ -56,6 +58,8 @@ namespace Directus
 		~RHI_Shader();	
 		virtual bool Compile_Vertex(const std::string& filePath, Input_Layout inputLayout);
 		virtual bool Compile_Pixel(const std::string& filePath);
+		// A compute shader is a shader of its own, this also sets the state
+		virtual bool Compile_Compute(const std::string& filePath);
 		//=================================================================================
 
 		virtual void Compile_VertexPixel(const std::string& filePath, Input_Layout inputLayout, Context* context)
@@ -78,7 +82,7 @@ namespace Directus
 
 		virtual void Compile_VertexPixel_Async(const std::string& filePath, Input_Layout inputLayout, Context* context)
 		{
-			context->GetSubsystem<Threading>()->AddTask([this, filePath, inputLayout, context]()
+			context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [this, filePath, inputLayout, context]()
 			{
 				Compile_VertexPixel(filePath, inputLayout, context);
 			});
@@ -86,6 +90,14 @@ namespace Directus
 
 		void AddDefine(const std::string& define, const std::string& value = "1");
 
+		const std::string& GetFilePath() { return m_filePath; }
+		// Whether the file is the shader's source or something it includes (directly or not), see FileWatcher::NormalizePath
+		bool DependsOn(const std::string& filePathNormalized);
+
+		// Where compiled bytecode is kept between launches, keyed by source, defines and profile. Empty disables caching.
+		static void SetCacheDirectory(const std::string& directory);
+		static const std::string& GetCacheDirectory() { return m_cacheDirectory; }
+
 		template <typename T>
 		void AddBuffer(unsigned int slot, Buffer_Scope scope)
 		{
@@ -95,10 +107,12 @@ namespace Directus
 		void UpdateBuffer(void* data);
 		void* GetVertexShaderBuffer()								{ return m_vertexShader; }
 		void* GetPixelShaderBuffer()								{ return m_pixelShader; }
+		void* GetComputeShaderBuffer()								{ return m_computeShader; }
 		std::shared_ptr<RHI_ConstantBuffer>& GetConstantBuffer()	{ return m_constantBuffer; }
 		void SetName(const std::string& name)						{ m_name = name; }
 		bool HasVertexShader()										{ return m_hasVertexShader; }
 		bool HasPixelShader()										{ return m_hasPixelShader; }
+		bool HasComputeShader()										{ return m_hasComputeShader; }
 		std::shared_ptr<RHI_InputLayout> GetInputLayout()			{ return m_inputLayout; }
 		Shader_State GetState()										{ return m_shaderState; }
 
@@ -118,10 +132,14 @@ namespace Directus
 		std::shared_ptr<RHI_InputLayout> m_inputLayout;	
 		bool m_hasVertexShader		= false;
 		bool m_hasPixelShader		= false;
+		bool m_hasComputeShader		= false;
 		Shader_State m_shaderState	= Shader_Uninitialized;
 
 		// D3D11
 		void* m_vertexShader	= nullptr;
 		void* m_pixelShader		= nullptr;
+		void* m_computeShader	= nullptr;
+
+		static std::string m_cacheDirectory;
 	};
 }
\ No newline at end of file
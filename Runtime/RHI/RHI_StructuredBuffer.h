@@ -0,0 +1,62 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include "RHI_Object.h"
+#include "RHI_Definition.h"
+#include "RHI_Device.h"
+#include <memory>
+#include "..\Core\EngineDefs.h"
+//=============================
+
+namespace Directus
+{
+	// An array of structures, read by shaders through a shader resource slot. Created with Create it's
+	// CPU writable (or, given its data, immutable), created with CreateUnorderedAccess only the GPU (compute) writes to it.
+	class ENGINE_CLASS RHI_StructuredBuffer : public RHI_Object
+	{
+	public:
+		RHI_StructuredBuffer(std::shared_ptr<RHI_Device> rhiDevice);
+		~RHI_StructuredBuffer();
+
+		bool Create(unsigned int stride, unsigned int elementCount, const void* data = nullptr);
+		// Draw arguments makes it a raw buffer that indirect draws can read their arguments from
+		bool CreateUnorderedAccess(unsigned int stride, unsigned int elementCount, bool drawArguments = false);
+		void* Map();
+		bool Unmap();
+		void* GetBuffer()				{ return m_buffer; }
+		void* GetShaderResource()		{ return m_shaderResourceView; }
+		void* GetUnorderedAccessView()	{ return m_unorderedAccessView; }
+		unsigned int GetStride()		{ return m_stride; }
+		unsigned int GetElementCount()	{ return m_elementCount; }
+
+	private:
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		void* m_buffer;
+		void* m_shaderResourceView;
+		void* m_unorderedAccessView;
+		unsigned int m_stride;
+		unsigned int m_elementCount;
+		RHI_MemoryTracker m_memoryTracker;
+	};
+}
@@ -23,21 +23,58 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Texture.h"
 #include "RHI_Device.h"
 #include "../IO/FileStream.h"
+#include "../Core/Settings.h"
+#include "../Threading/Threading.h"
 #include "../Rendering/Renderer.h"
 #include "../Resource/ResourceManager.h"
+#include "../Resource/TextureStreaming.h"
+#include "../Math/MathHelper.h"
 //======================================
 
-//= NAMESPACES =====
+//= NAMESPACES ================
 using namespace std;
-//==================
+using namespace Directus::Math::Helper;
+//=============================
 
 namespace Directus
 {
+	// Where a mip starts in an engine texture file, the mip count comes first and every mip is prefixed by its size
+	static uint64_t GetMipOffset(const vector<unsigned int>& mipSizes, unsigned int mip)
+	{
+		uint64_t offset = sizeof(unsigned int);
+		for (unsigned int i = 0; i < mip; i++)
+		{
+			offset += sizeof(unsigned int) + mipSizes[i];
+		}
+		return offset;
+	}
+
+	// Reads the chain from the given mip down, the file is where it starts
+	static bool ReadMips(FileStream* file, const vector<unsigned int>& mipSizes, unsigned int firstMip, vector<Mipmap>* mips, const string& filePath)
+	{
+		mips->clear();
+		for (unsigned int i = firstMip; i < (unsigned int)mipSizes.size(); i++)
+		{
+			auto& mip = mips->emplace_back(Mipmap());
+			file->Read(&mip);
+
+			// The file changed since it was loaded
+			if (mip.size() != mipSizes[i])
+			{
+				LOGF_WARNING("RHI_Texture::Streaming_Load: \"%s\" doesn't match the mips it was loaded with.", filePath.c_str());
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	RHI_Texture::RHI_Texture(Context* context) : IResource(context, Resource_Texture)
 	{
 		m_isUsingMipmaps	= true;
 		m_format			= Texture_Format_R8G8B8A8_UNORM;
-		m_rhiDevice			= context->GetSubsystem<Renderer>()->GetRHIDevice();
+		auto renderer		= context->GetSubsystem<Renderer>();
+		m_rhiDevice			= renderer ? renderer->GetRHIDevice() : nullptr;
 		m_shaderResource	= nullptr;
 		m_memoryUsage		= 0;
 	}
@@ -52,11 +89,29 @@ namespace Directus
 	{
 		m_data.clear();
 		m_data.shrink_to_fit();
+		m_mipsOnGPU = false;
 		SetLoadState(LoadState_Started);
 
 		// Make the path, relative to the engine
 		auto filePath = FileSystem::GetRelativeFilePath(rawFilePath);
 
+		// An image imported before (same content, path and import settings) is read from what that import produced
+		string derivedKey;
+		auto ddc = m_resourceManager ? m_resourceManager->GetDerivedDataCache() : nullptr;
+		if (ddc && FileSystem::IsSupportedImageFile(filePath))
+		{
+			size_t settings = hash<unsigned int>()(m_width) ^ (hash<unsigned int>()(m_height) << 1) ^ (hash<bool>()(m_isUsingMipmaps) << 2) ^ (hash<unsigned int>()((unsigned int)GetCompression()) << 3) ^ (hash<bool>()(m_isSRGB) << 4);
+			derivedKey		= ddc->GetKey(filePath, "Texture", ImageImporter::GetVersion(), settings);
+
+			string nativeFilePath = FileSystem::GetFilePathWithoutExtension(filePath) + EXTENSION_TEXTURE;
+			if (ddc->Fetch(derivedKey, nativeFilePath))
+			{
+				filePath	= nativeFilePath;
+				derivedKey.clear();
+				Resource_MarkClean();
+			}
+		}
+
 		// engine format (binary)
 		if (FileSystem::IsEngineTextureFile(filePath)) 
 		{
@@ -65,7 +120,12 @@ namespace Directus
 		// foreign format (most known image formats)
 		else if (FileSystem::IsSupportedImageFile(filePath))
 		{
-			LoadFromForeignFormat(filePath);
+			// The engine texture is written now rather than when the project saves, so it can be cached
+			if (LoadFromForeignFormat(filePath) && !derivedKey.empty() && Serialize(GetResourceFilePath()))
+			{
+				ddc->Store(derivedKey, GetResourceFilePath());
+				Resource_MarkClean();
+			}
 		}
 		else
 		{
@@ -74,18 +134,47 @@ namespace Directus
 			return false;
 		}
 
-		bool generateMipmaps = !m_isUsingMipmaps;
-		if (ShaderResource_Create2D(m_width, m_height, m_channels, m_format, m_data, generateMipmaps))
+		// Without a device (headless) there is nothing to upload to, the bits of an engine file can be read again if need be
+		if (!m_rhiDevice)
+		{
+			if (FileSystem::IsEngineTextureFile(filePath))
+			{
+				ClearTextureBytes();
+			}
+			SetLoadState(LoadState_Completed);
+			return true;
+		}
+
+		// An import which had the GPU generate the mips has uploaded already, unless the chain was block compressed since
+		bool uploaded = m_mipsOnGPU && m_shaderResource && !Format_IsCompressed(m_format);
+		if (m_mipsOnGPU && !uploaded)
+		{
+			ShaderResource_Release();
+			m_memoryUsage	= 0;
+			m_mipsOnGPU		= false;
+		}
+
+		bool generateMipmaps	= !m_isUsingMipmaps;
+		auto width				= Max(m_width >> m_streamingMipResident, 1u);
+		auto height				= Max(m_height >> m_streamingMipResident, 1u);
+		if (uploaded || ShaderResource_Create2D(width, height, m_channels, m_format, m_data, generateMipmaps))
 		{
 			// If the texture was loaded from an image file, it's not 
 			// saved yet, hence we have to maintain it's texture bits.
 			// However, if the texture was deserialized (engine format) 
-			// then we no longer need the texture bits. 
-			// We free them here to free up some memory.
-			if (FileSystem::IsEngineTextureFile(filePath))
+			// then they can be read again, so unless the residency policy
+			// keeps them we free them here. A streamed texture only has
+			// part of its chain in memory, which is never worth keeping.
+			if (FileSystem::IsEngineTextureFile(filePath) && (Data_IsReleasedAfterUpload() || m_streamingMipResident != 0))
 			{
 				ClearTextureBytes();
 			}
+
+			// Streamed textures start with their low mips, the rest comes in once they are seen
+			if (m_streamingMipResident != 0)
+			{
+				m_context->GetSubsystem<TextureStreaming>()->Texture_Add(static_pointer_cast<RHI_Texture>(GetSharedPtr()));
+			}
 		}
 		else
 		{
@@ -131,24 +220,43 @@ namespace Directus
 		m_data.shrink_to_fit();
 	}
 
-	void RHI_Texture::GetTextureBytes(vector<vector<std::byte>>* textureBytes)
+	bool RHI_Texture::Data_Load()
 	{
-		if (!m_data.empty())
+		// The rest of the chain is only on the GPU, it's read back the first time it's needed
+		if (m_mipsOnGPU && m_data.size() == 1 && m_shaderResourceMips > 1)
 		{
-			textureBytes = &m_data;
-			return;
+			vector<Mipmap> mips;
+			if (!ShaderResource_ReadMips(&mips))
+			{
+				LOGF_ERROR("RHI_Texture::Data_Load: Failed to read the mips of \"%s\" back from the GPU.", m_resourceFilePath.c_str());
+				return false;
+			}
+			m_data = move(mips);
+			return true;
 		}
 
-		auto file = make_unique<FileStream>(m_resourceFilePath, FileStreamMode_Read);
-		if (!file->IsOpen())
-			return;
+		if (!m_data.empty())
+			return true;
 
-		unsigned int mipCount = file->ReadUInt();
-		for (unsigned int i = 0; i < mipCount; i++)
+		// Nothing to read from, the texture never came from (or went to) an engine file
+		if (m_streamingMipSizes.empty())
+			return false;
+
+		vector<Mipmap> mips;
+		if (!Streaming_Load(0, &mips))
 		{
-			textureBytes->emplace_back(vector<std::byte>());
-			file->Read(&m_data[i]);
+			LOGF_ERROR("RHI_Texture::Data_Load: Failed to read the texture bits of \"%s\".", m_streamingFilePath.c_str());
+			return false;
 		}
+		m_data = move(mips);
+
+		return true;
+	}
+
+	bool RHI_Texture::Data_IsReleasedAfterUpload()
+	{
+		auto resourceManager = m_context->GetSubsystem<ResourceManager>();
+		return resourceManager && resourceManager->GetResidency(Resource_Texture) == Residency_ReleaseAfterUpload;
 	}
 
 	bool RHI_Texture::LoadFromForeignFormat(const string& filePath)
@@ -178,9 +286,15 @@ namespace Directus
 		// If the texture bits has been cleared, load it again
 		// as we don't want to replaced existing data with nothing.
 		// If the texture bits are not cleared, no loading will take place.
-		GetTextureBytes(&m_data);
+		if (!Data_Load())
+		{
+			LOGF_ERROR("RHI_Texture::Serialize: No texture bits to save to \"%s\".", filePath.c_str());
+			return false;
+		}
 
-		auto file = make_unique<FileStream>(filePath, FileStreamMode_Write);
+		// Compressing buffers the whole file, writing as is doesn't
+		auto mode = Settings::Get().FileCompression_Get(FileCompression_Texture) ? FileStreamMode_WriteCompressed : FileStreamMode_Write;
+		auto file = make_unique<FileStream>(filePath, mode, m_context->GetSubsystem<Threading>());
 		if (!file->IsOpen())
 			return false;
 
@@ -202,25 +316,40 @@ namespace Directus
 		file->Write(m_resourceID);
 		file->Write(m_resourceName);
 		file->Write(m_resourceFilePath);
+		file->Write((unsigned int)m_format);
 
-		ClearTextureBytes();
+		// From now on the bits can be read back from this file
+		m_streamingFilePath		= filePath;
+		m_streamingCompressed	= mode == FileStreamMode_WriteCompressed;
+		m_streamingMipSizes.clear();
+		for (const auto& mip : m_data)
+		{
+			m_streamingMipSizes.emplace_back((unsigned int)mip.size());
+		}
+
+		if (Data_IsReleasedAfterUpload() && m_shaderResource)
+		{
+			ClearTextureBytes();
+		}
 
 		return true;
 	}
 
 	bool RHI_Texture::Deserialize(const string& filePath)
 	{
-		auto file = make_unique<FileStream>(filePath, FileStreamMode_Read);
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_ReadMapped);
 		if (!file->IsOpen())
 			return false;
 
-		// Read texture bits
+		// Skip texture bits, which of them are needed depends on the properties after them
 		ClearTextureBytes();
+		m_streamingMipSizes.clear();
 		unsigned int mipCount = file->ReadUInt();
 		for (unsigned int i = 0; i < mipCount; i++)
 		{
-			m_data.emplace_back(vector<std::byte>());
-			file->Read(&m_data[i]);
+			auto size = file->ReadUInt();
+			m_streamingMipSizes.emplace_back(size);
+			file->Skip(size);
 		}
 
 		// Read properties
@@ -235,6 +364,121 @@ namespace Directus
 		file->Read(&m_resourceName);
 		file->Read(&m_resourceFilePath);
 
+		// Files written before the format was stored end here
+		auto format = (unsigned int)Texture_Format_R8G8B8A8_UNORM;
+		file->Read(&format);
+		m_format = (Texture_Format)format;
+
+		// Streamed textures leave out the mips larger than TEXTURE_STREAMING_RESIDENT_SIZE, block
+		// compressed ones stop earlier if need be since the largest mip has to be made of whole blocks
+		auto streaming			= m_context->GetSubsystem<TextureStreaming>();
+		m_streamingFilePath		= filePath;
+		m_streamingCompressed	= file->IsCompressed();
+		m_streamingMipDefault	= 0;
+		if (streaming && streaming->IsEnabled() && Streaming_IsStreamable() && !weak_from_this().expired())
+		{
+			auto blockAligned = [this](unsigned int mip) { return !Format_IsCompressed(m_format) || ((m_width >> mip) % 4 == 0 && (m_height >> mip) % 4 == 0); };
+			while (m_streamingMipDefault < mipCount - 1 && Max(m_width >> m_streamingMipDefault, m_height >> m_streamingMipDefault) > TEXTURE_STREAMING_RESIDENT_SIZE && blockAligned(m_streamingMipDefault + 1))
+			{
+				m_streamingMipDefault++;
+			}
+		}
+		m_streamingMipResident	= m_streamingMipDefault;
+		m_streamingRequest		= mipCount;
+
+		// Read texture bits
+		file->Seek(GetMipOffset(m_streamingMipSizes, m_streamingMipDefault));
+		for (unsigned int i = m_streamingMipDefault; i < mipCount; i++)
+		{
+			file->Read(&m_data.emplace_back(vector<std::byte>()));
+		}
+
+		return true;
+	}
+
+	unsigned int RHI_Texture::Format_GetRowPitch(Texture_Format format, unsigned int width, unsigned int channels)
+	{
+		if (!Format_IsCompressed(format))
+			return width * channels * sizeof(std::byte);
+
+		unsigned int blockSize = format == Texture_Format_BC1_UNORM ? 8 : 16;
+		return Max((width + 3) / 4, 1u) * blockSize;
+	}
+
+	//= STREAMING ==============================================================================
+	unsigned int RHI_Texture::Streaming_GetBytes(unsigned int firstMip)
+	{
+		unsigned int size = 0;
+		for (unsigned int i = firstMip; i < (unsigned int)m_streamingMipSizes.size(); i++)
+		{
+			size += m_streamingMipSizes[i];
+		}
+		return size;
+	}
+
+	void RHI_Texture::Streaming_Request(unsigned int mip)
+	{
+		auto current = m_streamingRequest.load();
+		while (mip < current && !m_streamingRequest.compare_exchange_weak(current, mip)) {}
+	}
+
+	bool RHI_Texture::Streaming_Load(unsigned int firstMip, vector<Mipmap>* mips)
+	{
+		if (!mips || firstMip >= Streaming_GetMipCount())
+			return false;
+
+		auto file = make_unique<FileStream>(m_streamingFilePath, FileStreamMode_ReadMapped);
+		if (!file->IsOpen())
+			return false;
+
+		file->Seek(GetMipOffset(m_streamingMipSizes, firstMip));
+		return ReadMips(file.get(), m_streamingMipSizes, firstMip, mips, m_streamingFilePath);
+	}
+
+	bool RHI_Texture::Streaming_GetRange(unsigned int firstMip, uint64_t* offset, uint64_t* size)
+	{
+		if (m_streamingCompressed || firstMip >= Streaming_GetMipCount())
+			return false;
+
+		*offset	= GetMipOffset(m_streamingMipSizes, firstMip);
+		*size	= GetMipOffset(m_streamingMipSizes, Streaming_GetMipCount()) - *offset;
+		return true;
+	}
+
+	bool RHI_Texture::Streaming_Load(unsigned int firstMip, const std::byte* data, size_t size, vector<Mipmap>* mips)
+	{
+		if (!mips || !data || firstMip >= Streaming_GetMipCount())
+			return false;
+
+		auto file = make_unique<FileStream>(data, size);
+		return ReadMips(file.get(), m_streamingMipSizes, firstMip, mips, m_streamingFilePath);
+	}
+
+	bool RHI_Texture::Streaming_Apply(unsigned int firstMip, const vector<Mipmap>& mips)
+	{
+		if (mips.empty() || firstMip + mips.size() != Streaming_GetMipCount())
+			return false;
+
+		// Create the new shader resource before letting go of the current one, it stays if that fails
+		auto previous		= m_shaderResource;
+		auto previousMemory	= m_memoryUsage;
+		m_shaderResource	= nullptr;
+		m_memoryUsage		= 0;
+		if (!ShaderResource_Create2D(Max(m_width >> firstMip, 1u), Max(m_height >> firstMip, 1u), m_channels, m_format, mips))
+		{
+			ShaderResource_Release();
+			m_shaderResource	= previous;
+			m_memoryUsage		= previousMemory;
+			return false;
+		}
+
+		auto created		= m_shaderResource;
+		m_shaderResource	= previous;
+		ShaderResource_Release();
+		m_shaderResource		= created;
+		m_streamingMipResident	= firstMip;
+
 		return true;
 	}
+	//=========================================================================================
 }
@@ -23,8 +23,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <memory>
+#include <atomic>
 #include "RHI_Object.h"
 #include "RHI_Definition.h"
+#include "RHI_Device.h"
 #include "../Resource/IResource.h"
 //================================
 
@@ -53,9 +55,18 @@ namespace Directus
 		bool ShaderResource_Create2D(unsigned int width, unsigned int height, unsigned int channels, Texture_Format format, const std::vector<Mipmap>& data, bool generateMimaps = false);
 		// Generates a cube-map shader resource. 6 textures containing mip-levels have to be provided (vector<textures<mip>>).
 		bool ShaderResource_CreateCubemap(unsigned int width, unsigned int height, unsigned int channels, Texture_Format format, const std::vector<std::vector<Mipmap>>& data);
+		// Uploads the first mip of the data (R8G8B8A8) and has the GPU generate the rest of the chain, which
+		// Data_Load() reads back once the bits are needed. False if the GPU can't, the data is left as is.
+		bool ShaderResource_GenerateMips(unsigned int width, unsigned int height, unsigned int channels);
+		// Copies every mip of a shader resource ShaderResource_GenerateMips() created back into memory
+		bool ShaderResource_ReadMips(std::vector<Mipmap>* mips);
 		
 		void ShaderResource_Release();
 		void* GetShaderResource() const { return m_shaderResource; }
+		// What the shader resource holds, less than the texture while streaming hasn't brought in its sharpest mips
+		unsigned int GetShaderResourceWidth() const		{ return m_shaderResourceWidth; }
+		unsigned int GetShaderResourceHeight() const	{ return m_shaderResourceHeight; }
+		unsigned int GetShaderResourceMips() const		{ return m_shaderResourceMips; }
 		//================================================================================================================================================================================
 
 		//= PROPERTIES ===============================================================================
@@ -81,18 +92,58 @@ namespace Directus
 		bool IsUsingMimmaps()								{ return m_isUsingMipmaps; }
 
 		Texture_Format GetFormat()							{ return m_format; }
+		void SetFormat(Texture_Format format)				{ m_format = format; }
 
-		const std::vector<Mipmap>& Data_Get()				{ return m_data; }
-		void Data_Set(const std::vector<Mipmap>& dataRGBA)	{ m_data = dataRGBA; }
-		Mipmap* Data_AddMipMap()							{ return &m_data.emplace_back(Mipmap()); }
+		// Color data is stored gamma encoded, mips generated on the GPU are filtered in linear space then
+		bool IsSRGB()										{ return m_isSRGB; }
+		void SetSRGB(bool isSRGB)							{ m_isSRGB = isSRGB; }
+
+		// The block compressed format an image file gets when imported, Texture_Format_R8G8B8A8_UNORM leaves it as is
+		Texture_Format GetCompression()						{ return m_compression; }
+		void SetCompression(Texture_Format format)			{ m_compression = format; }
+
+		// Re-reads the mip chain from the engine file if it was released after upload
+		const std::vector<Mipmap>& Data_Get()				{ Data_Load(); return m_data; }
+		void Data_Set(const std::vector<Mipmap>& dataRGBA)	{ m_data = dataRGBA; Resource_MarkDirty(); }
+		Mipmap* Data_AddMipMap()							{ Resource_MarkDirty(); return &m_data.emplace_back(Mipmap()); }
 		Mipmap* Data_GetMip(unsigned int index);
 		//============================================================================================
 
 		//= TEXTURE BITS =======================================
 		void ClearTextureBytes();
-		void GetTextureBytes(std::vector<Mipmap>* textureBytes);
+		// Reads the full mip chain back from the engine file, in case it's not in memory
+		bool Data_Load();
 		//======================================================
 
+		//= FORMAT =========================================================================================
+		static bool Format_IsCompressed(Texture_Format format) { return format >= Texture_Format_BC1_UNORM && format <= Texture_Format_BC7_UNORM; }
+		// Bytes per row of pixels, or per row of blocks when compressed
+		static unsigned int Format_GetRowPitch(Texture_Format format, unsigned int width, unsigned int channels);
+		//==================================================================================================
+
+		//= STREAMING ====================================================================================================
+		// Engine textures with a mip chain load their low mips only, TextureStreaming brings the rest in once they are seen
+		bool Streaming_IsStreamable()					{ return m_streamingMipSizes.size() > 1; }
+		unsigned int Streaming_GetMipCount()			{ return (unsigned int)m_streamingMipSizes.size(); }
+		unsigned int Streaming_GetMipResident()			{ return m_streamingMipResident; }
+		unsigned int Streaming_GetMipDefault()			{ return m_streamingMipDefault; }
+		const std::string& Streaming_GetFilePath()		{ return m_streamingFilePath; }
+		// Size of the chain from the given mip down to 1x1
+		unsigned int Streaming_GetBytes(unsigned int firstMip);
+		// Called for every visible use, the sharpest mip requested during a frame wins (thread safe)
+		void Streaming_Request(unsigned int mip);
+		// Returns the sharpest mip requested since the last call, the mip count if there was none
+		unsigned int Streaming_ConsumeRequest()			{ return m_streamingRequest.exchange(Streaming_GetMipCount()); }
+		// Reads the chain from the given mip down out of the engine file (thread safe)
+		bool Streaming_Load(unsigned int firstMip, std::vector<Mipmap>* mips);
+		// Where that chain is in the engine file, for reading it elsewhere, false if the file is compressed (thread safe)
+		bool Streaming_GetRange(unsigned int firstMip, uint64_t* offset, uint64_t* size);
+		// Reads the chain from the given mip down out of the bytes of its range (thread safe)
+		bool Streaming_Load(unsigned int firstMip, const std::byte* data, size_t size, std::vector<Mipmap>* mips);
+		// Replaces the shader resource with a chain which Streaming_Load() read
+		bool Streaming_Apply(unsigned int firstMip, const std::vector<Mipmap>& mips);
+		//================================================================================================================
+
 	protected:
 		//= NATIVE TEXTURE HANDLING (BINARY) =========
 		bool Serialize(const std::string& filePath);
@@ -100,6 +151,8 @@ namespace Directus
 		//============================================
 
 		bool LoadFromForeignFormat(const std::string& filePath);
+		// Whether the ResourceManager wants texture bytes to go once the GPU has them
+		bool Data_IsReleasedAfterUpload();
 		
 		//= DATA =======================
 		unsigned int m_bpp		= 0;
@@ -109,13 +162,29 @@ namespace Directus
 		bool m_isGrayscale		= false;
 		bool m_isTransparent	= false;
 		bool m_isUsingMipmaps	= false;
+		bool m_isSRGB			= false;
+		bool m_mipsOnGPU		= false;	// the shader resource has a chain the GPU generated, the data may only have the first mip
 		Texture_Format m_format;
+		Texture_Format m_compression = Texture_Format_R8G8B8A8_UNORM;
 		std::vector<Mipmap> m_data;
 		//==============================
 
+		//= STREAMING =====================================
+		std::string m_streamingFilePath;					// the engine file, Data_Load() reads from it too
+		std::vector<unsigned int> m_streamingMipSizes;		// of every mip in the engine file
+		bool m_streamingCompressed			= false;		// the engine file is, mips have no offset in it
+		unsigned int m_streamingMipResident	= 0;			// the sharpest mip the shader resource has
+		unsigned int m_streamingMipDefault	= 0;			// the one it's loaded with
+		std::atomic<unsigned int> m_streamingRequest = 0;
+		//=================================================
+
 		// D3D11
 		std::shared_ptr<RHI_Device> m_rhiDevice;
 		void* m_shaderResource;
+		unsigned int m_shaderResourceWidth	= 0;
+		unsigned int m_shaderResourceHeight	= 0;
+		unsigned int m_shaderResourceMips	= 0;
 		unsigned int m_memoryUsage;
+		RHI_MemoryTracker m_memoryTracker; // of the shader resource
 	};
 }
\ No newline at end of file
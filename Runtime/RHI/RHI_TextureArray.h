@@ -0,0 +1,70 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include "RHI_Object.h"
+#include "RHI_Definition.h"
+#include "RHI_Device.h"
+#include <memory>
+#include "..\Core\EngineDefs.h"
+//=============================
+
+namespace Directus
+{
+	// Textures of one size, format and mip count in a single resource, shaders pick them by slice.
+	// The slices are copied on the GPU from textures that already have a shader resource of their own.
+	// An array of cubemaps has six faces per slice, and is sampled as a cubemap array.
+	class ENGINE_CLASS RHI_TextureArray : public RHI_Object
+	{
+	public:
+		RHI_TextureArray(std::shared_ptr<RHI_Device> rhiDevice);
+		~RHI_TextureArray();
+
+		bool Create(unsigned int width, unsigned int height, unsigned int mipCount, Texture_Format format, unsigned int sliceCount, bool cubemap = false);
+		// Copies every mip (and face) of the texture into the slice, it has to match the array's size, format, mip count and kind
+		bool Slice_Copy(unsigned int slice, const RHI_Texture* texture);
+		// Copies the slices both arrays have from another one of the same size, format and mip count
+		bool Slices_Copy(const RHI_TextureArray* source);
+		void* GetShaderResource() const	{ return m_shaderResource; }
+		unsigned int GetWidth() const		{ return m_width; }
+		unsigned int GetHeight() const		{ return m_height; }
+		unsigned int GetMipCount() const	{ return m_mipCount; }
+		unsigned int GetSliceCount() const	{ return m_sliceCount; }
+		Texture_Format GetFormat() const	{ return m_format; }
+		bool IsCubemap() const				{ return m_cubemap; }
+		unsigned long long GetBytes() const	{ return m_bytes; }
+
+	private:
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		void* m_texture;
+		void* m_shaderResource;
+		unsigned int m_width;
+		unsigned int m_height;
+		unsigned int m_mipCount;
+		unsigned int m_sliceCount;
+		Texture_Format m_format;
+		bool m_cubemap;
+		unsigned long long m_bytes;
+		RHI_MemoryTracker m_memoryTracker;
+	};
+}
@@ -22,9 +22,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ===============
+#include <cstdint>
+#include <type_traits>
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
+#include "../Math/Packing.h"
 //==========================
 
 namespace Directus
@@ -66,6 +69,62 @@ namespace Directus
 		float bitangent[3]	= { 0 };
 	};
 
+	// RHI_Vertex_PosUVTBN in 24 bytes instead of 56, what models hand to the GPU and keep on disk
+	// uv:		half floats (R16G16_FLOAT)
+	// normal:	xyz remapped to [0, 1] in 10 bits each (R10G10B10A2_UNORM)
+	// tangent:	same, plus the bitangent's side in the 2 bit w, the shader derives it as cross(normal, tangent) * sign
+	struct RHI_Vertex_PosUVTBNPacked
+	{
+		RHI_Vertex_PosUVTBNPacked(){}
+		RHI_Vertex_PosUVTBNPacked(const RHI_Vertex_PosUVTBN& vertex)
+		{
+			pos[0]	= vertex.pos[0];
+			pos[1]	= vertex.pos[1];
+			pos[2]	= vertex.pos[2];
+
+			uv[0]	= Math::Packing::FloatToHalf(vertex.uv[0]);
+			uv[1]	= Math::Packing::FloatToHalf(vertex.uv[1]);
+
+			Math::Vector3 n(vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+			Math::Vector3 t(vertex.tangent[0], vertex.tangent[1], vertex.tangent[2]);
+			Math::Vector3 b(vertex.bitangent[0], vertex.bitangent[1], vertex.bitangent[2]);
+			normal	= PackUnitVector(n, 0.0f);
+			tangent	= PackUnitVector(t, Math::Vector3::Dot(Math::Vector3::Cross(n, t), b) < 0.0f ? 0.0f : 1.0f);
+		}
+
+		RHI_Vertex_PosUVTBN Unpack() const
+		{
+			float sign;
+			Math::Vector3 n = UnpackUnitVector(normal, &sign);
+			Math::Vector3 t = UnpackUnitVector(tangent, &sign);
+			Math::Vector3 b = Math::Vector3::Cross(n, t) * (sign * 2.0f - 1.0f);
+
+			return RHI_Vertex_PosUVTBN(Math::Vector3(pos[0], pos[1], pos[2]), Math::Vector2(Math::Packing::HalfToFloat(uv[0]), Math::Packing::HalfToFloat(uv[1])), n, t, b);
+		}
+
+		static uint32_t PackUnitVector(const Math::Vector3& v, float w)
+		{
+			using namespace Math::Packing;
+			return PackUnorm(v.x * 0.5f + 0.5f, 10) | (PackUnorm(v.y * 0.5f + 0.5f, 10) << 10) | (PackUnorm(v.z * 0.5f + 0.5f, 10) << 20) | (PackUnorm(w, 2) << 30);
+		}
+
+		static Math::Vector3 UnpackUnitVector(uint32_t value, float* w)
+		{
+			using namespace Math::Packing;
+			*w = UnpackUnorm(value >> 30, 2);
+			return Math::Vector3(
+				UnpackUnorm(value, 10) * 2.0f - 1.0f,
+				UnpackUnorm(value >> 10, 10) * 2.0f - 1.0f,
+				UnpackUnorm(value >> 20, 10) * 2.0f - 1.0f
+			);
+		}
+
+		float pos[3]		= { 0 };
+		uint16_t uv[2]		= { 0 };
+		uint32_t normal		= 0;
+		uint32_t tangent	= 0;
+	};
+
 	struct RHI_Vertex_PosUVNor
 	{
 		RHI_Vertex_PosUVNor(){}
@@ -135,8 +194,32 @@ namespace Directus
 		float color[4]	= {0};
 	};
 
+	// Laid out like ImDrawVert, so the editor's draw lists are copied as they are
+	struct RHI_Vertex_Pos2DUVCol8
+	{
+		RHI_Vertex_Pos2DUVCol8(){}
+
+		float pos[2]	= {0};
+		float uv[2]		= {0};
+		uint32_t color	= 0; // RGBA, 8 bits each
+	};
+
+	// The bones (up to four) a skinned vertex follows, it sits next to the vertex rather than in it so
+	// geometry that isn't skinned doesn't pay for it. The weights are unorm and add up to 255.
+	struct RHI_Vertex_Skin
+	{
+		uint8_t bones[4]	= {0};
+		uint8_t weights[4]	= {0};
+	};
+
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosUVTBN>::value,	"RI_Vertex_PosUVTBN is not trivially copyable");
+	static_assert(std::is_trivially_copyable<RHI_Vertex_PosUVTBNPacked>::value,	"RHI_Vertex_PosUVTBNPacked is not trivially copyable");
+	static_assert(sizeof(RHI_Vertex_PosUVTBNPacked) == 24,							"RHI_Vertex_PosUVTBNPacked is not tightly packed");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosUVNor>::value,	"RI_Vertex_PosUVNor is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosUV>::value,		"RI_Vertex_PosUV is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosCol>::value,		"RI_Vertex_PosCol is not trivially copyable");
+	static_assert(std::is_trivially_copyable<RHI_Vertex_Pos2DUVCol8>::value,	"RHI_Vertex_Pos2DUVCol8 is not trivially copyable");
+	static_assert(sizeof(RHI_Vertex_Pos2DUVCol8) == 20,							"RHI_Vertex_Pos2DUVCol8 is not tightly packed");
+	static_assert(std::is_trivially_copyable<RHI_Vertex_Skin>::value,			"RHI_Vertex_Skin is not trivially copyable");
+	static_assert(sizeof(RHI_Vertex_Skin) == 8,									"RHI_Vertex_Skin is not tightly packed");
 }
\ No newline at end of file
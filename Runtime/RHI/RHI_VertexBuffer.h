@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============
 #include "RHI_Definition.h"
 #include "RHI_Object.h"
+#include "RHI_Device.h"
 #include <vector>
 //=========================
 
@@ -38,12 +39,19 @@ namespace Directus
 		bool Create(const std::vector<RHI_Vertex_PosCol>& vertices);
 		bool Create(const std::vector<RHI_Vertex_PosUV>& vertices);
 		bool Create(const std::vector<RHI_Vertex_PosUVTBN>& vertices);
+		bool Create(const std::vector<RHI_Vertex_PosUVTBNPacked>& vertices);
 		bool CreateDynamic(unsigned int stride, unsigned int initialSize);
-		void* Map();
+		// Written by compute shaders (as a raw buffer) and drawn from, the GPU owns it entirely
+		bool CreateUnorderedAccess(unsigned int stride, unsigned int vertexCount);
+		// Discarding hands out fresh memory, otherwise the caller promises not to touch anything the GPU may still read (append only)
+		void* Map(bool discard = true);
 		bool Unmap();
 		bool Bind();
 
-		unsigned int GetMemoryUsage() { return m_memoryUsage; }
+		void* GetBuffer()				{ return m_buffer; }
+		void* GetUnorderedAccessView()	{ return m_unorderedAccessView; }
+		unsigned int GetMemoryUsage()	{ return m_memoryUsage; }
+		unsigned int GetStride()		{ return m_stride; }
 
 	protected:
 		unsigned int m_memoryUsage;
@@ -51,6 +59,8 @@ namespace Directus
 
 		// D3D11
 		void* m_buffer;
+		void* m_unorderedAccessView;
 		unsigned int m_stride;
+		RHI_MemoryTracker m_memoryTracker;
 	};
 }
\ No newline at end of file
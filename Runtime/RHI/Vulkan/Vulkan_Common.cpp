@@ -0,0 +1,1115 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN
+//================================
+
+//= INCLUDES ==================
+#include "Vulkan_Common.h"
+#include "../../Logging/Log.h"
+#include <algorithm>
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	namespace Vulkan_Common
+	{
+		Context context;
+		thread_local Recorder* threadRecorder = nullptr;
+
+		inline VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		//= MEMORY ALLOCATOR ===========================================================================================
+		void MemoryAllocator::Initialize(VkDevice device, VkPhysicalDevice physicalDevice)
+		{
+			m_device = device;
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_properties);
+
+			// Buffers and optimally tiled images which share a block must not share a page
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+			m_granularity = max(properties.limits.bufferImageGranularity, (VkDeviceSize)1);
+		}
+
+		void MemoryAllocator::Shutdown()
+		{
+			lock_guard<mutex> lock(m_mutex);
+			for (auto& block : m_blocks)
+			{
+				if (block.memory == VK_NULL_HANDLE)
+					continue;
+
+				if (block.mapped) vkUnmapMemory(m_device, block.memory);
+				vkFreeMemory(m_device, block.memory, nullptr);
+			}
+			m_blocks.clear();
+			m_usedBytes = 0;
+		}
+
+		int MemoryAllocator::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties)
+		{
+			for (uint32_t i = 0; i < m_properties.memoryTypeCount; i++)
+			{
+				if ((typeBits & (1 << i)) && (m_properties.memoryTypes[i].propertyFlags & properties) == properties)
+					return (int)i;
+			}
+
+			return -1;
+		}
+
+		bool MemoryAllocator::AllocateBlock(uint32_t type, VkDeviceSize size, bool dedicated, uint32_t* index)
+		{
+			VkMemoryAllocateInfo allocateInfo	= {};
+			allocateInfo.sType					= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocateInfo.allocationSize			= size;
+			allocateInfo.memoryTypeIndex		= type;
+
+			Block block;
+			if (vkAllocateMemory(m_device, &allocateInfo, nullptr, &block.memory) != VK_SUCCESS)
+			{
+				LOGF_ERROR("Vulkan_Common::MemoryAllocator: Failed to allocate %llu bytes of device memory", (unsigned long long)size);
+				return false;
+			}
+
+			if (m_properties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+			{
+				vkMapMemory(m_device, block.memory, 0, VK_WHOLE_SIZE, 0, &block.mapped);
+			}
+
+			block.size		= size;
+			block.type		= type;
+			block.dedicated	= dedicated;
+			block.free.push_back(Range{ 0, size });
+
+			// Reuse the slot of a freed dedicated block
+			for (uint32_t i = 0; i < (uint32_t)m_blocks.size(); i++)
+			{
+				if (m_blocks[i].memory == VK_NULL_HANDLE)
+				{
+					m_blocks[i]	= move(block);
+					*index		= i;
+					return true;
+				}
+			}
+
+			m_blocks.emplace_back(move(block));
+			*index = (uint32_t)m_blocks.size() - 1;
+			return true;
+		}
+
+		bool MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, Allocation* allocation)
+		{
+			int type = FindMemoryType(requirements.memoryTypeBits, properties);
+			if (type == -1)
+			{
+				LOG_ERROR("Vulkan_Common::MemoryAllocator: No memory type has the requested properties");
+				return false;
+			}
+
+			VkDeviceSize alignment	= max(requirements.alignment, m_granularity);
+			VkDeviceSize size		= AlignUp(requirements.size, m_granularity);
+
+			lock_guard<mutex> lock(m_mutex);
+
+			auto take = [this, allocation, size](uint32_t index, size_t rangeIndex, VkDeviceSize offset)
+			{
+				auto& block		= m_blocks[index];
+				auto range		= block.free[rangeIndex];
+				block.free.erase(block.free.begin() + rangeIndex);
+
+				// Give back what alignment skipped and what's left after the allocation
+				auto end = range.offset + range.size;
+				if (offset + size < end)		block.free.insert(block.free.begin() + rangeIndex, Range{ offset + size, end - (offset + size) });
+				if (offset > range.offset)		block.free.insert(block.free.begin() + rangeIndex, Range{ range.offset, offset - range.offset });
+
+				allocation->memory	= block.memory;
+				allocation->offset	= offset;
+				allocation->size	= size;
+				allocation->mapped	= block.mapped ? (char*)block.mapped + offset : nullptr;
+				allocation->block	= index;
+				m_usedBytes			+= size;
+			};
+
+			// Large enough to have a block of its own
+			if (size > memory_block_size / 2)
+			{
+				uint32_t index = 0;
+				if (!AllocateBlock((uint32_t)type, size, true, &index))
+					return false;
+
+				take(index, 0, 0);
+				return true;
+			}
+
+			// First fit
+			for (uint32_t i = 0; i < (uint32_t)m_blocks.size(); i++)
+			{
+				auto& block = m_blocks[i];
+				if (block.memory == VK_NULL_HANDLE || block.dedicated || block.type != (uint32_t)type)
+					continue;
+
+				for (size_t r = 0; r < block.free.size(); r++)
+				{
+					auto& range		= block.free[r];
+					auto offset		= AlignUp(range.offset, alignment);
+					if (offset + size <= range.offset + range.size)
+					{
+						take(i, r, offset);
+						return true;
+					}
+				}
+			}
+
+			uint32_t index = 0;
+			if (!AllocateBlock((uint32_t)type, memory_block_size, false, &index))
+				return false;
+
+			take(index, 0, 0);
+			return true;
+		}
+
+		void MemoryAllocator::Free(Allocation& allocation)
+		{
+			if (allocation.memory == VK_NULL_HANDLE)
+				return;
+
+			lock_guard<mutex> lock(m_mutex);
+			auto& block = m_blocks[allocation.block];
+			m_usedBytes -= allocation.size;
+
+			if (block.dedicated)
+			{
+				if (block.mapped) vkUnmapMemory(m_device, block.memory);
+				vkFreeMemory(m_device, block.memory, nullptr);
+				block = Block();
+			}
+			else
+			{
+				// Insert in offset order and merge with the neighbours
+				auto it = lower_bound(block.free.begin(), block.free.end(), allocation.offset, [](const Range& range, VkDeviceSize offset) { return range.offset < offset; });
+				it = block.free.insert(it, Range{ allocation.offset, allocation.size });
+				if (it + 1 != block.free.end() && it->offset + it->size == (it + 1)->offset)
+				{
+					it->size += (it + 1)->size;
+					block.free.erase(it + 1);
+				}
+				if (it != block.free.begin() && (it - 1)->offset + (it - 1)->size == it->offset)
+				{
+					(it - 1)->size += it->size;
+					block.free.erase(it);
+				}
+			}
+
+			allocation = Allocation();
+		}
+		//==============================================================================================================
+
+		//= CONTEXT ====================================================================================================
+		void Context::Release(function<void()>&& release)
+		{
+			lock_guard<mutex> lock(releaseMutex);
+			frames[GetFrameSlot()].releases.emplace_back(move(release));
+		}
+
+		Recorder* GetRecorder()
+		{
+			return threadRecorder ? threadRecorder : (context.recorders.empty() ? nullptr : context.recorders.front().get());
+		}
+
+		void SetThreadRecorder(Recorder* recorder)
+		{
+			threadRecorder = recorder;
+		}
+		//==============================================================================================================
+
+		//= RECORDER ===================================================================================================
+		void Recorder::Invalidate()
+		{
+			renderPassActive		= false;
+			renderPass				= VK_NULL_HANDLE;
+			pipeline				= VK_NULL_HANDLE;
+			pipelineHash			= 0;
+			pipelineLayout			= VK_NULL_HANDLE;
+			computePipeline			= VK_NULL_HANDLE;
+			computePipelineLayout	= VK_NULL_HANDLE;
+			vertexBufferBound		= VK_NULL_HANDLE;
+			indexBufferBound		= VK_NULL_HANDLE;
+			renderTargetsDirty		= true;
+			viewportDirty			= true;
+			scissorDirty			= true;
+			for (auto& stage : stages)
+			{
+				stage.boundHash = 0;
+			}
+		}
+
+		void Recorder::Reset(bool reverse)
+		{
+			vertexShader		= nullptr;
+			pixelShader			= nullptr;
+			computeShader		= nullptr;
+			inputLayout			= nullptr;
+			topology			= PrimitiveTopology_TriangleList;
+			cullMode			= Cull_Back;
+			fillMode			= Fill_Solid;
+			blendMode			= Blend_Disabled;
+			depthEnabled		= true;
+			depthWrite			= true;
+			depthReverse		= reverse;
+			scissorEnabled		= false;
+			renderTargetCount	= 0;
+			depthStencil		= nullptr;
+			vertexBuffer		= BufferBinding();
+			indexBuffer			= BufferBinding();
+			vertexStride		= 0;
+			for (auto& stage : stages)
+			{
+				stage = StageBindings();
+			}
+			versions.clear();
+			Invalidate();
+		}
+		//==============================================================================================================
+
+		//= BUFFER =====================================================================================================
+		inline bool CreateVkBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer* buffer, Allocation* allocation)
+		{
+			VkBufferCreateInfo bufferInfo	= {};
+			bufferInfo.sType				= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size					= size;
+			bufferInfo.usage				= usage;
+			bufferInfo.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+			if (vkCreateBuffer(context.device, &bufferInfo, nullptr, buffer) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Common::Buffer_Create: Failed to create buffer");
+				return false;
+			}
+
+			VkMemoryRequirements requirements;
+			vkGetBufferMemoryRequirements(context.device, *buffer, &requirements);
+			if (!context.allocator.Allocate(requirements, properties, allocation))
+			{
+				vkDestroyBuffer(context.device, *buffer, nullptr);
+				*buffer = VK_NULL_HANDLE;
+				return false;
+			}
+
+			vkBindBufferMemory(context.device, *buffer, allocation->memory, allocation->offset);
+			return true;
+		}
+
+		bool Buffer_Create(Buffer* buffer, VkDeviceSize size, VkBufferUsageFlags usage, bool dynamic, const void* data /*= nullptr*/)
+		{
+			buffer->type	= Resource_Buffer;
+			buffer->size	= size;
+			buffer->usage	= usage;
+			buffer->dynamic	= dynamic;
+
+			// Versions are created on demand
+			if (dynamic)
+				return true;
+
+			if (!CreateVkBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &buffer->buffer, &buffer->allocation))
+				return false;
+
+			// Device local memory is filled through staging memory, buffers the GPU writes start out zeroed (like D3D11's do)
+			auto vkBuffer = buffer->buffer;
+			return Upload([vkBuffer, data, size](VkCommandBuffer commandBuffer, const Staging& staging)
+			{
+				if (data)
+				{
+					memcpy(staging.mapped, data, (size_t)size);
+					VkBufferCopy region = { staging.offset, 0, size };
+					vkCmdCopyBuffer(commandBuffer, staging.buffer, vkBuffer, 1, &region);
+				}
+				else
+				{
+					vkCmdFillBuffer(commandBuffer, vkBuffer, 0, VK_WHOLE_SIZE, 0);
+				}
+			}, data ? size : 0) != 0;
+		}
+
+		void Buffer_Destroy(Buffer* buffer)
+		{
+			if (!buffer)
+				return;
+
+			// Whatever is still in flight keeps its memory until its frame is done
+			auto vkBuffer	= buffer->buffer;
+			auto allocation	= buffer->allocation;
+			vector<pair<VkBuffer, Allocation>> versions;
+			for (auto& version : buffer->versions)
+			{
+				versions.emplace_back(version->buffer, version->allocation);
+			}
+
+			// Command lists hold on to the versions they mapped until their next reset
+			{
+				lock_guard<mutex> lock(context.recordersMutex);
+				for (auto& recorder : context.recorders)
+				{
+					recorder->versions.erase(buffer);
+				}
+			}
+
+			context.Release([vkBuffer, allocation, versions]() mutable
+			{
+				if (vkBuffer != VK_NULL_HANDLE)
+				{
+					vkDestroyBuffer(context.device, vkBuffer, nullptr);
+					context.allocator.Free(allocation);
+				}
+
+				for (auto& version : versions)
+				{
+					vkDestroyBuffer(context.device, version.first, nullptr);
+					context.allocator.Free(version.second);
+				}
+			});
+
+			buffer->buffer = VK_NULL_HANDLE;
+			buffer->allocation = Allocation();
+			buffer->versions.clear();
+			buffer->latest = nullptr;
+		}
+
+		bool Buffer_CreateStaging(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer* buffer, Allocation* allocation)
+		{
+			return CreateVkBuffer(size, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, allocation);
+		}
+
+		void Buffer_DestroyStaging(VkBuffer buffer, Allocation& allocation)
+		{
+			if (buffer == VK_NULL_HANDLE)
+				return;
+
+			vkDestroyBuffer(context.device, buffer, nullptr);
+			context.allocator.Free(allocation);
+		}
+
+		inline BufferVersion* Buffer_Discard(Buffer* buffer)
+		{
+			// Look for a version no frame in flight reads, starting with the oldest one
+			BufferVersion* version = nullptr;
+			for (size_t i = 0; i < buffer->versions.size(); i++)
+			{
+				auto index = (buffer->cursor + i) % buffer->versions.size();
+				if (context.IsFrameComplete(buffer->versions[index]->frame))
+				{
+					version			= buffer->versions[index].get();
+					buffer->cursor	= index + 1;
+					break;
+				}
+			}
+
+			if (!version)
+			{
+				auto newVersion = make_unique<BufferVersion>();
+				if (!CreateVkBuffer(buffer->size, buffer->usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &newVersion->buffer, &newVersion->allocation))
+					return nullptr;
+
+				version = newVersion.get();
+				buffer->versions.emplace_back(move(newVersion));
+				buffer->cursor = 0;
+			}
+
+			version->frame	= context.frameIndex.load();
+			buffer->latest	= version;
+			return version;
+		}
+
+		void* Buffer_Map(Buffer* buffer, bool discard)
+		{
+			if (!buffer || !buffer->dynamic)
+			{
+				LOG_ERROR("Vulkan_Common::Buffer_Map: The buffer is not dynamic");
+				return nullptr;
+			}
+
+			lock_guard<mutex> lock(buffer->mutex);
+			auto recorder			= GetRecorder();
+			BufferVersion* version	= nullptr;
+
+			// Appending goes to whatever this recorder (or anyone) mapped last
+			if (!discard)
+			{
+				if (recorder)
+				{
+					auto it = recorder->versions.find(buffer);
+					version = it != recorder->versions.end() ? it->second : nullptr;
+				}
+				version = version ? version : buffer->latest;
+				if (version)
+				{
+					version->frame = context.frameIndex.load();
+				}
+			}
+
+			if (!version)
+			{
+				version = Buffer_Discard(buffer);
+			}
+
+			if (!version)
+				return nullptr;
+
+			if (recorder)
+			{
+				recorder->versions[buffer] = version;
+			}
+
+			return version->allocation.mapped;
+		}
+
+		VkBuffer Buffer_Resolve(Recorder* recorder, Buffer* buffer)
+		{
+			if (!buffer)
+				return VK_NULL_HANDLE;
+
+			if (!buffer->dynamic)
+				return buffer->buffer;
+
+			lock_guard<mutex> lock(buffer->mutex);
+			auto it			= recorder->versions.find(buffer);
+			auto version	= it != recorder->versions.end() ? it->second : buffer->latest;
+			if (!version)
+			{
+				version = Buffer_Discard(buffer);
+				if (!version)
+					return VK_NULL_HANDLE;
+			}
+
+			// Whoever discards next has to leave this one alone until the frame is done
+			version->frame = context.frameIndex.load();
+			return version->buffer;
+		}
+		//==============================================================================================================
+
+		//= IMAGE ======================================================================================================
+		bool Image_IsDepth(VkFormat format)
+		{
+			return format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+		}
+
+		bool Image_Create(Image* image, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers, VkFormat format, VkImageUsageFlags usage, bool cube /*= false*/)
+		{
+			image->type			= Resource_Image;
+			image->width		= width;
+			image->height		= height;
+			image->mipLevels	= mipLevels;
+			image->layers		= layers;
+			image->format		= format;
+			image->aspect		= Image_IsDepth(format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+
+			VkImageCreateInfo imageInfo	= {};
+			imageInfo.sType				= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.flags				= cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+			imageInfo.imageType			= VK_IMAGE_TYPE_2D;
+			imageInfo.format			= format;
+			imageInfo.extent			= { width, height, 1 };
+			imageInfo.mipLevels			= mipLevels;
+			imageInfo.arrayLayers		= layers;
+			imageInfo.samples			= VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.tiling			= VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.usage				= usage;
+			imageInfo.sharingMode		= VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.initialLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
+			if (vkCreateImage(context.device, &imageInfo, nullptr, &image->image) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Common::Image_Create: Failed to create image");
+				return false;
+			}
+
+			VkMemoryRequirements requirements;
+			vkGetImageMemoryRequirements(context.device, image->image, &requirements);
+			if (!context.allocator.Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &image->allocation))
+				return false;
+			vkBindImageMemory(context.device, image->image, image->allocation.memory, image->allocation.offset);
+
+			VkImageViewCreateInfo viewInfo				= {};
+			viewInfo.sType								= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image								= image->image;
+			viewInfo.viewType							= cube ? (layers > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE) : (layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D);
+			viewInfo.format								= format;
+			viewInfo.subresourceRange.aspectMask		= image->aspect;
+			viewInfo.subresourceRange.baseMipLevel		= 0;
+			viewInfo.subresourceRange.levelCount		= mipLevels;
+			viewInfo.subresourceRange.baseArrayLayer	= 0;
+			viewInfo.subresourceRange.layerCount		= layers;
+			if (vkCreateImageView(context.device, &viewInfo, nullptr, &image->view) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Common::Image_Create: Failed to create image view");
+				return false;
+			}
+
+			return true;
+		}
+
+		void Image_Destroy(Image* image)
+		{
+			if (!image)
+				return;
+
+			// Framebuffers which point to the image go with it
+			vector<VkFramebuffer> framebuffers;
+			{
+				lock_guard<mutex> lock(context.cacheMutex);
+				for (auto it = context.framebuffers.begin(); it != context.framebuffers.end();)
+				{
+					if (find(it->second.attachments.begin(), it->second.attachments.end(), image) != it->second.attachments.end())
+					{
+						framebuffers.emplace_back(it->second.framebuffer);
+						it = context.framebuffers.erase(it);
+						continue;
+					}
+					it++;
+				}
+			}
+
+			auto vkImage	= image->owned ? image->image : VK_NULL_HANDLE;
+			auto view		= image->view;
+			auto allocation	= image->allocation;
+			context.Release([vkImage, view, allocation, framebuffers]() mutable
+			{
+				for (auto framebuffer : framebuffers)
+				{
+					vkDestroyFramebuffer(context.device, framebuffer, nullptr);
+				}
+				if (view != VK_NULL_HANDLE)		vkDestroyImageView(context.device, view, nullptr);
+				if (vkImage != VK_NULL_HANDLE)	vkDestroyImage(context.device, vkImage, nullptr);
+				context.allocator.Free(allocation);
+			});
+
+			image->image		= VK_NULL_HANDLE;
+			image->view			= VK_NULL_HANDLE;
+			image->allocation	= Allocation();
+		}
+
+		void ImageLayout(VkCommandBuffer commandBuffer, Image* image, VkImageLayout from, VkImageLayout to)
+		{
+			VkImageMemoryBarrier barrier			= {};
+			barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask					= VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask					= VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.oldLayout						= from;
+			barrier.newLayout						= to;
+			barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			barrier.image							= image->image;
+			barrier.subresourceRange.aspectMask		= image->aspect;
+			barrier.subresourceRange.baseMipLevel	= 0;
+			barrier.subresourceRange.levelCount		= VK_REMAINING_MIP_LEVELS;
+			barrier.subresourceRange.baseArrayLayer	= 0;
+			barrier.subresourceRange.layerCount		= VK_REMAINING_ARRAY_LAYERS;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+		//==============================================================================================================
+
+		//= UPLOADS ====================================================================================================
+		bool Uploader::Initialize(VkQueue queue, uint32_t queueFamily)
+		{
+			m_queue			= queue;
+			m_queueMutex	= queue == context.queue ? &context.queueMutex : &m_ownQueueMutex;
+
+			VkCommandPoolCreateInfo poolInfo	= {};
+			poolInfo.sType						= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.flags						= VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			poolInfo.queueFamilyIndex			= queueFamily;
+			if (vkCreateCommandPool(context.device, &poolInfo, nullptr, &m_pool) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Common::Uploader::Initialize: Failed to create command pool");
+				return false;
+			}
+
+			if (!Buffer_CreateStaging(upload_ring_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &m_ring, &m_ringAllocation))
+			{
+				LOG_ERROR("Vulkan_Common::Uploader::Initialize: Failed to create staging ring");
+				return false;
+			}
+
+			return true;
+		}
+
+		void Uploader::Shutdown()
+		{
+			// The device is idle, whatever is left is done (or never going to run)
+			lock_guard<mutex> lock(m_mutex);
+			if (m_recording)
+			{
+				vkEndCommandBuffer(m_recording->commandBuffer);
+				m_inFlight.emplace_back(move(m_recording));
+			}
+			while (!m_inFlight.empty())
+			{
+				Complete(m_inFlight.front().get());
+				m_free.emplace_back(move(m_inFlight.front()));
+				m_inFlight.pop_front();
+			}
+
+			for (auto& batch : m_free)
+			{
+				vkDestroyFence(context.device, batch->fence, nullptr);
+			}
+			m_free.clear();
+			for (auto semaphore : m_semaphores)
+			{
+				vkDestroySemaphore(context.device, semaphore, nullptr);
+			}
+			m_semaphores.clear();
+
+			Buffer_DestroyStaging(m_ring, m_ringAllocation);
+			m_ring = VK_NULL_HANDLE;
+			vkDestroyCommandPool(context.device, m_pool, nullptr);
+			m_pool = VK_NULL_HANDLE;
+		}
+
+		uint64_t Uploader::Upload(VkDeviceSize size, const function<void(VkCommandBuffer, const Staging&)>& record)
+		{
+			if (m_pool == VK_NULL_HANDLE)
+				return 0;
+
+			// Staging and recording go together, a batch must not be submitted in between
+			lock_guard<mutex> lock(m_mutex);
+			Retire();
+
+			Staging staging;
+			if (!Begin() || !Stage(size, &staging))
+				return 0;
+
+			record(m_recording->commandBuffer, staging);
+			m_recording->staged += size;
+			auto serial = m_recording->serial;
+
+			// Large uploads (level loading) are submitted as they go rather than all at once with the frame
+			if (m_recording->staged >= upload_batch_size)
+			{
+				Flush();
+			}
+
+			return serial;
+		}
+
+		void Uploader::Submit(vector<VkSemaphore>* semaphores /*= nullptr*/)
+		{
+			lock_guard<mutex> lock(m_mutex);
+			Flush();
+			Retire();
+
+			if (semaphores)
+			{
+				semaphores->insert(semaphores->end(), m_semaphores.begin(), m_semaphores.end());
+				m_semaphores.clear();
+			}
+		}
+
+		bool Uploader::IsComplete(uint64_t serial)
+		{
+			lock_guard<mutex> lock(m_mutex);
+			Retire();
+			return serial <= m_completed;
+		}
+
+		void Uploader::Wait(uint64_t serial)
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (m_recording && m_recording->serial <= serial)
+			{
+				Flush();
+			}
+
+			for (auto& batch : m_inFlight)
+			{
+				if (batch->serial > serial)
+					break;
+
+				vkWaitForFences(context.device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+			}
+			Retire();
+		}
+
+		bool Uploader::Begin()
+		{
+			if (m_recording)
+				return true;
+
+			if (!m_free.empty())
+			{
+				m_recording = move(m_free.back());
+				m_free.pop_back();
+			}
+			else
+			{
+				auto batch = make_unique<Batch>();
+
+				VkCommandBufferAllocateInfo allocateInfo	= {};
+				allocateInfo.sType							= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocateInfo.commandPool					= m_pool;
+				allocateInfo.level							= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocateInfo.commandBufferCount				= 1;
+				VkFenceCreateInfo fenceInfo					= {};
+				fenceInfo.sType								= VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+				if (vkAllocateCommandBuffers(context.device, &allocateInfo, &batch->commandBuffer) != VK_SUCCESS ||
+					vkCreateFence(context.device, &fenceInfo, nullptr, &batch->fence) != VK_SUCCESS)
+				{
+					LOG_ERROR("Vulkan_Common::Uploader::Begin: Failed to create upload batch");
+					if (batch->commandBuffer != VK_NULL_HANDLE)
+					{
+						vkFreeCommandBuffers(context.device, m_pool, 1, &batch->commandBuffer);
+					}
+					return false;
+				}
+				m_recording = move(batch);
+			}
+
+			m_recording->serial		= ++m_serial;
+			m_recording->staged		= 0;
+			m_recording->ringBytes	= 0;
+
+			VkCommandBufferBeginInfo beginInfo	= {};
+			beginInfo.sType						= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags						= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkBeginCommandBuffer(m_recording->commandBuffer, &beginInfo);
+			return true;
+		}
+
+		bool Uploader::Stage(VkDeviceSize size, Staging* staging)
+		{
+			if (size == 0)
+				return true;
+
+			// Nothing in flight, start over at the beginning
+			if (m_ringUsed == 0)
+			{
+				m_ringHead = 0;
+				m_ringTail = 0;
+			}
+
+			// Copy offsets have to be aligned to the texel size (and 4)
+			bool full				= m_ringUsed != 0 && m_ringHead == m_ringTail;
+			VkDeviceSize offset		= AlignUp(m_ringHead, 16);
+			VkDeviceSize consumed	= 0;
+			bool fits				= false;
+			if (!full && m_ringHead >= m_ringTail)
+			{
+				if (offset + size <= upload_ring_size)
+				{
+					fits		= true;
+					consumed	= offset + size - m_ringHead;
+				}
+				else if (size <= m_ringTail)
+				{
+					// Wrap around, what's left at the end is skipped
+					fits		= true;
+					consumed	= upload_ring_size - m_ringHead + size;
+					offset		= 0;
+				}
+			}
+			else if (!full && offset + size <= m_ringTail)
+			{
+				fits		= true;
+				consumed	= offset + size - m_ringHead;
+			}
+
+			if (fits)
+			{
+				staging->buffer				= m_ring;
+				staging->offset				= offset;
+				staging->mapped				= (std::byte*)m_ringAllocation.mapped + offset;
+				m_ringHead					= offset + size;
+				m_ringUsed					+= consumed;
+				m_recording->ringBytes		+= consumed;
+				m_recording->ringEnd		= m_ringHead;
+				return true;
+			}
+
+			// The ring is busy (or too small), rather than waiting for it the upload gets a staging buffer of its own
+			Allocation allocation;
+			if (!Buffer_CreateStaging(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &staging->buffer, &allocation))
+			{
+				LOG_ERROR("Vulkan_Common::Uploader::Stage: Failed to create staging buffer");
+				return false;
+			}
+			staging->offset = 0;
+			staging->mapped = allocation.mapped;
+
+			auto buffer = staging->buffer;
+			m_recording->releases.emplace_back([buffer, allocation]() mutable { Buffer_DestroyStaging(buffer, allocation); });
+			return true;
+		}
+
+		void Uploader::Flush()
+		{
+			if (!m_recording)
+				return;
+
+			vkEndCommandBuffer(m_recording->commandBuffer);
+
+			// The next frame waits for the batch on the GPU
+			VkSemaphoreCreateInfo semaphoreInfo	= {};
+			semaphoreInfo.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			VkSemaphore semaphore				= VK_NULL_HANDLE;
+			VkResult result						= vkCreateSemaphore(context.device, &semaphoreInfo, nullptr, &semaphore);
+			if (result == VK_SUCCESS)
+			{
+				VkSubmitInfo submitInfo			= {};
+				submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+				submitInfo.commandBufferCount	= 1;
+				submitInfo.pCommandBuffers		= &m_recording->commandBuffer;
+				submitInfo.signalSemaphoreCount	= 1;
+				submitInfo.pSignalSemaphores	= &semaphore;
+				lock_guard<mutex> lock(*m_queueMutex);
+				result = vkQueueSubmit(m_queue, 1, &submitInfo, m_recording->fence);
+			}
+			m_inFlight.emplace_back(move(m_recording));
+
+			if (result == VK_SUCCESS)
+			{
+				m_semaphores.emplace_back(semaphore);
+				return;
+			}
+
+			// The device is most likely lost, wait for what made it to the queue and drop the rest
+			LOG_ERROR("Vulkan_Common::Uploader::Flush: Failed to submit command buffer");
+			vkDestroySemaphore(context.device, semaphore, nullptr);
+			{
+				lock_guard<mutex> lock(*m_queueMutex);
+				vkQueueWaitIdle(m_queue);
+			}
+			while (!m_inFlight.empty())
+			{
+				Complete(m_inFlight.front().get());
+				m_free.emplace_back(move(m_inFlight.front()));
+				m_inFlight.pop_front();
+			}
+		}
+
+		void Uploader::Retire()
+		{
+			while (!m_inFlight.empty() && vkGetFenceStatus(context.device, m_inFlight.front()->fence) == VK_SUCCESS)
+			{
+				Complete(m_inFlight.front().get());
+				m_free.emplace_back(move(m_inFlight.front()));
+				m_inFlight.pop_front();
+			}
+		}
+
+		void Uploader::Complete(Batch* batch)
+		{
+			for (auto& release : batch->releases)
+			{
+				release();
+			}
+			batch->releases.clear();
+
+			// Batches finish in the order they took from the ring
+			if (batch->ringBytes != 0)
+			{
+				m_ringTail = batch->ringEnd;
+				m_ringUsed -= batch->ringBytes;
+			}
+			m_completed = max(m_completed, batch->serial);
+
+			vkResetFences(context.device, 1, &batch->fence);
+			vkResetCommandBuffer(batch->commandBuffer, 0);
+		}
+		//==============================================================================================================
+
+		//= COMMANDS ===================================================================================================
+		uint64_t Upload(const function<void(VkCommandBuffer, const Staging&)>& record, VkDeviceSize stagingSize /*= 0*/)
+		{
+			return context.uploader.Upload(stagingSize, record);
+		}
+
+		void Recorder_Transfer(Recorder* recorder)
+		{
+			if (recorder->renderPassActive)
+			{
+				vkCmdEndRenderPass(recorder->commandBuffer);
+				recorder->renderPassActive = false;
+			}
+			Barrier(recorder->commandBuffer);
+		}
+
+		void Barrier(VkCommandBuffer commandBuffer)
+		{
+			VkMemoryBarrier barrier	= {};
+			barrier.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask	= VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask	= VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+		//==============================================================================================================
+
+		//= SHADER REFLECTION ==========================================================================================
+		bool Shader_Reflect(const vector<uint32_t>& spirv, Shader* shader)
+		{
+			enum Opcode
+			{
+				Op_EntryPoint		= 15,
+				Op_TypeImage		= 25,
+				Op_TypeSampler		= 26,
+				Op_TypeSampledImage	= 27,
+				Op_TypeArray		= 28,
+				Op_TypeRuntimeArray	= 29,
+				Op_TypeStruct		= 30,
+				Op_TypePointer		= 32,
+				Op_Variable			= 59,
+				Op_Decorate			= 71
+			};
+
+			enum Decoration
+			{
+				Decoration_Block		= 2,
+				Decoration_BufferBlock	= 3,
+				Decoration_Binding		= 33,
+				Decoration_DescriptorSet = 34
+			};
+
+			enum StorageClass
+			{
+				StorageClass_UniformConstant	= 0,
+				StorageClass_Uniform			= 2,
+				StorageClass_StorageBuffer		= 12
+			};
+
+			struct Id
+			{
+				uint32_t opcode		= 0;
+				uint32_t operand[3]	= {}; // image: sampled, pointer: storage class and type, array: element type, variable: type and storage class
+				uint32_t set		= 0;
+				uint32_t binding	= ~0u;
+				bool block			= false;
+				bool bufferBlock	= false;
+			};
+
+			if (spirv.size() < 5 || spirv[0] != 0x07230203)
+			{
+				LOG_ERROR("Vulkan_Common::Shader_Reflect: Invalid SPIR-V");
+				return false;
+			}
+
+			vector<Id> ids(spirv[3]);
+			uint32_t executionModel = 0;
+			for (size_t i = 5; i < spirv.size();)
+			{
+				uint32_t wordCount	= spirv[i] >> 16;
+				uint32_t opcode		= spirv[i] & 0xFFFF;
+				if (wordCount == 0 || i + wordCount > spirv.size())
+				{
+					LOG_ERROR("Vulkan_Common::Shader_Reflect: Truncated SPIR-V");
+					return false;
+				}
+				const uint32_t* words = &spirv[i];
+
+				switch (opcode)
+				{
+				case Op_EntryPoint:
+					executionModel = words[1];
+					break;
+
+				case Op_Decorate:
+					if (words[1] < ids.size())
+					{
+						auto& id = ids[words[1]];
+						if (words[2] == Decoration_Block)			id.block		= true;
+						if (words[2] == Decoration_BufferBlock)		id.bufferBlock	= true;
+						if (words[2] == Decoration_Binding)			id.binding		= words[3];
+						if (words[2] == Decoration_DescriptorSet)	id.set			= words[3];
+					}
+					break;
+
+				case Op_TypeImage:			ids[words[1]].opcode = opcode; ids[words[1]].operand[0] = words[7]; break;
+				case Op_TypeSampler:
+				case Op_TypeSampledImage:
+				case Op_TypeStruct:			ids[words[1]].opcode = opcode; break;
+				case Op_TypeArray:
+				case Op_TypeRuntimeArray:	ids[words[1]].opcode = opcode; ids[words[1]].operand[0] = words[2]; break;
+				case Op_TypePointer:		ids[words[1]].opcode = opcode; ids[words[1]].operand[0] = words[2]; ids[words[1]].operand[1] = words[3]; break;
+				case Op_Variable:			ids[words[2]].opcode = opcode; ids[words[2]].operand[0] = words[1]; ids[words[2]].operand[1] = words[3]; break;
+				}
+
+				i += wordCount;
+			}
+
+			shader->stage = executionModel == 4 ? VK_SHADER_STAGE_FRAGMENT_BIT : (executionModel == 5 ? VK_SHADER_STAGE_COMPUTE_BIT : VK_SHADER_STAGE_VERTEX_BIT);
+			shader->bindings.clear();
+			for (auto& variable : ids)
+			{
+				if (variable.opcode != Op_Variable || variable.binding == ~0u)
+					continue;
+
+				uint32_t storageClass = variable.operand[1];
+				if (storageClass != StorageClass_UniformConstant && storageClass != StorageClass_Uniform && storageClass != StorageClass_StorageBuffer)
+					continue;
+
+				// Pointer, then arrays, then what's actually bound
+				auto type = &ids[ids[variable.operand[0]].operand[1]];
+				while (type->opcode == Op_TypeArray || type->opcode == Op_TypeRuntimeArray)
+				{
+					type = &ids[type->operand[0]];
+				}
+
+				VkDescriptorType descriptorType;
+				if (type->opcode == Op_TypeImage)
+				{
+					descriptorType = type->operand[0] == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				}
+				else if (type->opcode == Op_TypeSampler)
+				{
+					descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+				}
+				else if (type->opcode == Op_TypeStruct)
+				{
+					// Constant buffers take their offset at bind time, so one descriptor set serves every element of a ring
+					bool storage	= storageClass == StorageClass_StorageBuffer || type->bufferBlock;
+					descriptorType	= storage ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+				}
+				else
+				{
+					LOGF_WARNING("Vulkan_Common::Shader_Reflect: Binding %d has an unsupported type, combined image samplers are not used by the engine", variable.binding);
+					continue;
+				}
+
+				uint32_t expectedSet = shader->stage == VK_SHADER_STAGE_FRAGMENT_BIT ? set_pixel : (shader->stage == VK_SHADER_STAGE_COMPUTE_BIT ? set_compute : set_vertex);
+				if (variable.set != expectedSet)
+				{
+					LOGF_WARNING("Vulkan_Common::Shader_Reflect: Binding %d is in descriptor set %d instead of %d", variable.binding, variable.set, expectedSet);
+				}
+
+				shader->bindings.emplace_back(ShaderBinding{ variable.binding, descriptorType });
+			}
+
+			sort(shader->bindings.begin(), shader->bindings.end(), [](const ShaderBinding& a, const ShaderBinding& b) { return a.binding < b.binding; });
+			return true;
+		}
+		//==============================================================================================================
+	}
+}
+#endif
@@ -0,0 +1,509 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include "../RHI_Definition.h"
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+//=============================
+
+// Shared by the Vulkan implementation of the RHI, only included after RHI_Implementation.h (with API_VULKAN defined)
+namespace Directus
+{
+	namespace Vulkan_Common
+	{
+		// Frames the CPU can record ahead of the GPU, whatever a frame used is only reused (or destroyed) once it's done
+		static const uint32_t frames_in_flight		= 3;
+		// Device memory is sub-allocated from blocks of this size, anything larger gets a block of its own
+		static const VkDeviceSize memory_block_size	= 64 * 1024 * 1024;
+		// Staging memory uploads copy out of, anything the ring can't fit gets a staging buffer of its own
+		static const VkDeviceSize upload_ring_size	= 32 * 1024 * 1024;
+		// An upload batch is submitted once it stages this much, otherwise when the frame is
+		static const VkDeviceSize upload_batch_size	= 8 * 1024 * 1024;
+
+		// SPIR-V has no register classes, the shader compiler moves each one into its own binding range
+		// (dxc -fvk-b-shift 0 ... -fvk-t-shift 16 ... -fvk-s-shift 48 ... -fvk-u-shift 64 ...)
+		static const uint32_t binding_shift_b	= 0;
+		static const uint32_t binding_shift_t	= 16;
+		static const uint32_t binding_shift_s	= 48;
+		static const uint32_t binding_shift_u	= 64;
+		static const uint32_t slot_count_b		= binding_shift_t - binding_shift_b;
+		static const uint32_t slot_count_t		= binding_shift_s - binding_shift_t;
+		static const uint32_t slot_count_s		= binding_shift_u - binding_shift_s;
+		static const uint32_t slot_count_u		= 8;
+		// D3D11 binds per stage, so the vertex shader's resources live in the first set and the pixel shader's in the second (dxc -auto-binding-space 1)
+		static const uint32_t set_vertex		= 0;
+		static const uint32_t set_pixel			= 1;
+		static const uint32_t set_compute		= 0;
+
+		//= MEMORY =======================================================================================
+		struct Allocation
+		{
+			VkDeviceMemory memory	= VK_NULL_HANDLE;
+			VkDeviceSize offset		= 0;
+			VkDeviceSize size		= 0;
+			void* mapped			= nullptr; // host visible memory stays mapped for its whole life
+			uint32_t block			= 0;
+		};
+
+		// Hands out ranges of a few large device memory blocks (first fit), drivers limit the number of allocations
+		class MemoryAllocator
+		{
+		public:
+			void Initialize(VkDevice device, VkPhysicalDevice physicalDevice);
+			void Shutdown();
+			bool Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, Allocation* allocation);
+			void Free(Allocation& allocation);
+			VkDeviceSize GetUsedBytes() { return m_usedBytes; }
+			// Size of the largest device local heap, what the device has to offer as video memory
+			VkDeviceSize GetDeviceLocalBytes()
+			{
+				VkDeviceSize size = 0;
+				for (uint32_t i = 0; i < m_properties.memoryHeapCount; i++)
+				{
+					if (m_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+					{
+						size = m_properties.memoryHeaps[i].size > size ? m_properties.memoryHeaps[i].size : size;
+					}
+				}
+				return size;
+			}
+
+		private:
+			struct Range
+			{
+				VkDeviceSize offset;
+				VkDeviceSize size;
+			};
+
+			struct Block
+			{
+				VkDeviceMemory memory	= VK_NULL_HANDLE;
+				VkDeviceSize size		= 0;
+				uint32_t type			= 0;
+				void* mapped			= nullptr;
+				bool dedicated			= false;
+				std::vector<Range> free; // sorted by offset
+			};
+
+			int FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties);
+			bool AllocateBlock(uint32_t type, VkDeviceSize size, bool dedicated, uint32_t* index);
+
+			VkDevice m_device							= VK_NULL_HANDLE;
+			VkPhysicalDeviceMemoryProperties m_properties;
+			VkDeviceSize m_granularity					= 1;
+			VkDeviceSize m_usedBytes					= 0;
+			std::vector<Block> m_blocks;
+			std::mutex m_mutex;
+		};
+		//================================================================================================
+
+		//= UPLOADS ======================================================================================
+		// Where an upload's data goes before the GPU copies it, empty if nothing was staged
+		struct Staging
+		{
+			VkBuffer buffer		= VK_NULL_HANDLE;
+			VkDeviceSize offset	= 0;
+			void* mapped		= nullptr;
+		};
+
+		// Records uploads into batches which go to the copy queue (a queue of its own if the device has one to spare) without the
+		// CPU waiting for them, the frame submitted next waits for them on the GPU instead. Staging memory comes out of a persistently
+		// mapped ring, which the batches give back in the order they finish.
+		class Uploader
+		{
+		public:
+			bool Initialize(VkQueue queue, uint32_t queueFamily);
+			void Shutdown();
+			// Stages the given number of bytes and records into the current batch, returns the batch's serial (0 if it failed)
+			uint64_t Upload(VkDeviceSize size, const std::function<void(VkCommandBuffer, const Staging&)>& record);
+			// Submits the current batch, the semaphores of the batches submitted since the last call go to whoever waits for them (and destroys them)
+			void Submit(std::vector<VkSemaphore>* semaphores = nullptr);
+			bool IsComplete(uint64_t serial);
+			// Blocks until the serial's batch is done, for loaders which need the data on the GPU before they continue
+			void Wait(uint64_t serial);
+
+		private:
+			struct Batch
+			{
+				VkCommandBuffer commandBuffer	= VK_NULL_HANDLE;
+				VkFence fence					= VK_NULL_HANDLE;
+				uint64_t serial					= 0;
+				VkDeviceSize staged				= 0;
+				VkDeviceSize ringBytes			= 0; // taken from the ring, including what was skipped when it wrapped
+				VkDeviceSize ringEnd			= 0;
+				std::vector<std::function<void()>> releases; // staging buffers of their own
+			};
+
+			bool Begin();
+			bool Stage(VkDeviceSize size, Staging* staging);
+			void Flush();
+			void Retire();
+			void Complete(Batch* batch);
+
+			VkQueue m_queue						= VK_NULL_HANDLE;
+			std::mutex* m_queueMutex			= nullptr; // the context's if the queue is shared
+			std::mutex m_ownQueueMutex;
+			VkCommandPool m_pool				= VK_NULL_HANDLE;
+			VkBuffer m_ring						= VK_NULL_HANDLE;
+			Allocation m_ringAllocation;
+			VkDeviceSize m_ringHead				= 0;
+			VkDeviceSize m_ringTail				= 0;
+			VkDeviceSize m_ringUsed				= 0;
+			std::unique_ptr<Batch> m_recording;
+			std::deque<std::unique_ptr<Batch>> m_inFlight; // in submission order, which is the order they finish in
+			std::vector<std::unique_ptr<Batch>> m_free;
+			std::vector<VkSemaphore> m_semaphores;
+			uint64_t m_serial					= 0;
+			uint64_t m_completed				= 0;
+			std::mutex m_mutex;
+		};
+		//================================================================================================
+
+		//= RESOURCES ====================================================================================
+		// What the RHI hands around as shader resources, render targets and unordered access views
+		enum Resource_Type
+		{
+			Resource_Buffer,
+			Resource_Image
+		};
+
+		struct Resource
+		{
+			Resource_Type type;
+		};
+
+		// Dynamic buffers are renamed on every discarding map (like D3D11 does), a version is reused once the frames that read it are done
+		struct BufferVersion
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			Allocation allocation;
+			std::atomic<uint64_t> frame;
+		};
+
+		struct Buffer : Resource
+		{
+			VkBuffer buffer	= VK_NULL_HANDLE; // static buffers only
+			Allocation allocation;
+			VkDeviceSize size			= 0;
+			VkBufferUsageFlags usage	= 0;
+			bool dynamic				= false;
+			// Dynamic buffers only
+			std::vector<std::unique_ptr<BufferVersion>> versions;
+			BufferVersion* latest	= nullptr;
+			size_t cursor			= 0; // versions retire in the order they were handed out, the search for a free one starts here
+			std::mutex mutex;
+		};
+
+		struct Image : Resource
+		{
+			VkImage image				= VK_NULL_HANDLE;
+			VkImageView view			= VK_NULL_HANDLE;
+			Allocation allocation;
+			VkFormat format				= VK_FORMAT_UNDEFINED;
+			VkImageAspectFlags aspect	= VK_IMAGE_ASPECT_COLOR_BIT;
+			VkImageLayout layout		= VK_IMAGE_LAYOUT_GENERAL; // render textures never leave the general layout
+			uint32_t width				= 0;
+			uint32_t height				= 0;
+			uint32_t mipLevels			= 1;
+			uint32_t layers				= 1;
+			bool owned					= true; // swapchain images belong to the swapchain
+		};
+
+		// Caches key on these rather than on pointers, which get reused once an object is deleted
+		inline uint64_t NewObjectId()
+		{
+			static std::atomic<uint64_t> id = 0;
+			return ++id;
+		}
+
+		struct ShaderBinding
+		{
+			uint32_t binding;
+			VkDescriptorType type;
+		};
+
+		struct Shader
+		{
+			VkShaderModule module				= VK_NULL_HANDLE;
+			VkShaderStageFlagBits stage			= VK_SHADER_STAGE_VERTEX_BIT;
+			const char* entryPoint				= nullptr;
+			std::vector<ShaderBinding> bindings; // sorted by binding
+			VkDescriptorSetLayout setLayout		= VK_NULL_HANDLE;
+			VkPipelineLayout pipelineLayout		= VK_NULL_HANDLE; // compute only
+			uint64_t id							= NewObjectId();
+		};
+
+		struct InputLayout
+		{
+			uint32_t stride = 0;
+			std::vector<VkVertexInputAttributeDescription> attributes;
+			uint64_t id		= NewObjectId();
+		};
+
+		// Timestamps have a query per frame in flight, so reading one back never waits for the GPU
+		struct Query
+		{
+			Query_Type type;
+			VkQueryPool pool					= VK_NULL_HANDLE;
+			uint64_t frames[frames_in_flight]	= {}; // written during, 0 if never
+			float duration						= 0.0f; // disjoint only, the last one read back
+		};
+		//================================================================================================
+
+		//= RECORDING ====================================================================================
+		struct BufferBinding
+		{
+			Buffer* buffer		= nullptr;
+			VkDeviceSize offset	= 0;
+			VkDeviceSize range	= 0; // 0 for the whole buffer
+		};
+
+		enum Stage
+		{
+			Stage_Vertex,
+			Stage_Pixel,
+			Stage_Compute,
+			Stage_Count
+		};
+
+		struct StageBindings
+		{
+			BufferBinding constantBuffers[slot_count_b];
+			Resource* textures[slot_count_t]		= {};
+			VkSampler samplers[slot_count_s]		= {};
+			Resource* unorderedAccess[slot_count_u]	= {};
+			size_t boundHash						= 0; // of the descriptor set bound last, 0 if none
+		};
+
+		// Everything one thread records into. The immediate recorder records the frame, command
+		// lists are recorded by worker threads into recorders of their own (D3D11's deferred contexts).
+		struct Recorder
+		{
+			// Command and descriptor pools are per frame in flight, they are reset when their frame comes around again
+			struct Frame
+			{
+				VkCommandPool commandPool = VK_NULL_HANDLE;
+				std::vector<VkCommandBuffer> commandBuffers;
+				uint32_t commandBufferCount = 0;
+				std::vector<VkDescriptorPool> descriptorPools;
+				uint32_t descriptorPoolIndex = 0;
+				std::unordered_map<size_t, VkDescriptorSet> descriptorSets; // cached by the resources they point to
+			};
+			Frame frames[frames_in_flight];
+			VkCommandBuffer commandBuffer	= VK_NULL_HANDLE;
+			unsigned long long id			= 0;
+
+			// Pipeline state
+			Shader* vertexShader			= nullptr;
+			Shader* pixelShader				= nullptr;
+			Shader* computeShader			= nullptr;
+			InputLayout* inputLayout		= nullptr;
+			PrimitiveTopology_Mode topology	= PrimitiveTopology_TriangleList;
+			Cull_Mode cullMode				= Cull_Back;
+			Fill_Mode fillMode				= Fill_Solid;
+			Blend_Mode blendMode			= Blend_Disabled;
+			bool depthEnabled				= true;
+			bool depthWrite					= true;
+			bool depthReverse				= false;
+			VkViewport viewport				= {};
+			VkRect2D scissor				= {};
+			bool scissorEnabled				= false;
+
+			// Outputs
+			Image* renderTargets[8]			= {};
+			uint32_t renderTargetCount		= 0;
+			Image* depthStencil				= nullptr;
+
+			// Inputs
+			StageBindings stages[Stage_Count];
+			BufferBinding vertexBuffer;
+			uint32_t vertexStride			= 0;
+			BufferBinding indexBuffer;
+			VkIndexType indexType			= VK_INDEX_TYPE_UINT32;
+			// Dynamic buffer versions this recorder mapped, they take precedence over the latest ones
+			std::unordered_map<Buffer*, BufferVersion*> versions;
+
+			// What the command buffer currently has
+			bool renderPassActive					= false;
+			VkRenderPass renderPass					= VK_NULL_HANDLE;
+			VkExtent2D renderPassExtent				= {};
+			VkPipeline pipeline						= VK_NULL_HANDLE;
+			size_t pipelineHash						= 0;
+			VkPipelineLayout pipelineLayout			= VK_NULL_HANDLE;
+			VkPipeline computePipeline				= VK_NULL_HANDLE;
+			VkPipelineLayout computePipelineLayout	= VK_NULL_HANDLE;
+			VkBuffer vertexBufferBound				= VK_NULL_HANDLE;
+			VkBuffer indexBufferBound				= VK_NULL_HANDLE;
+			bool renderTargetsDirty					= true;
+			bool viewportDirty						= true;
+			bool scissorDirty						= true;
+
+			// Forgets what the command buffer has, a new one starts without any state
+			void Invalidate();
+			// Back to the state a new command list starts with
+			void Reset(bool depthReverse);
+		};
+		//================================================================================================
+
+		// Device wide objects, what the D3D11 implementation keeps in its device namespace
+		struct Context
+		{
+			VkInstance instance					= VK_NULL_HANDLE;
+			VkPhysicalDevice physicalDevice		= VK_NULL_HANDLE;
+			VkPhysicalDeviceProperties properties;
+			VkDevice device						= VK_NULL_HANDLE;
+			uint32_t queueFamily				= 0;
+			VkQueue queue						= VK_NULL_HANDLE;
+			std::mutex queueMutex;
+			MemoryAllocator allocator;
+
+			// Swapchain
+			VkSurfaceKHR surface				= VK_NULL_HANDLE;
+			VkSwapchainKHR swapchain			= VK_NULL_HANDLE;
+			VkFormat swapchainFormat			= VK_FORMAT_B8G8R8A8_UNORM;
+			std::vector<std::unique_ptr<Image>> backBuffers;
+			std::unique_ptr<Image> backBufferDepth;
+			uint32_t backBufferIndex			= 0;
+			bool backBufferAcquired				= false;
+
+			// Frames in flight
+			struct Frame
+			{
+				VkFence fence						= VK_NULL_HANDLE;
+				VkSemaphore imageAcquired			= VK_NULL_HANDLE;
+				VkSemaphore renderFinished			= VK_NULL_HANDLE;
+				VkSemaphore computeStart			= VK_NULL_HANDLE; // the frame's queue got to the compute section
+				VkSemaphore computeFinished			= VK_NULL_HANDLE;
+				std::vector<std::function<void()>> releases;
+			};
+			Frame frames[frames_in_flight];
+			std::atomic<uint64_t> frameIndex	= 1;
+			std::mutex releaseMutex;
+			// Command buffers submitted at the end of the frame, in execution order
+			std::vector<VkCommandBuffer> submissions;
+
+			// Recorders, the first one is the immediate one
+			std::vector<std::unique_ptr<Recorder>> recorders;
+			std::vector<Recorder*> recordersFree;
+			std::mutex recordersMutex;
+			std::atomic<unsigned long long> commandListSerial = 0;
+
+			// Caches, keyed by hashes of what they were created from
+			VkPipelineCache pipelineCache		= VK_NULL_HANDLE;
+			std::unordered_map<size_t, VkPipeline> pipelines;
+			std::unordered_map<size_t, VkPipelineLayout> pipelineLayouts;
+			std::unordered_map<size_t, VkRenderPass> renderPasses;
+			struct Framebuffer
+			{
+				VkFramebuffer framebuffer;
+				std::vector<Image*> attachments;
+			};
+			std::unordered_map<size_t, Framebuffer> framebuffers;
+			std::mutex cacheMutex;
+			VkDescriptorSetLayout emptySetLayout = VK_NULL_HANDLE;
+
+			// Bound in place of null resources, Vulkan doesn't allow empty descriptors
+			std::unique_ptr<Image> dummyImage;
+			std::unique_ptr<Image> dummyStorageImage;
+			std::unique_ptr<Buffer> dummyBuffer;
+			VkSampler dummySampler = VK_NULL_HANDLE;
+
+			// Resource creation, asynchronous to the frame
+			Uploader uploader;
+
+			// Async compute, a queue of the frame's family so resources don't change hands. The frame's submissions
+			// before computeFork run before the compute section, the ones from computeJoin on wait for it.
+			VkQueue computeQueue				= VK_NULL_HANDLE; // null without a spare queue
+			Recorder* computeRecorder			= nullptr;
+			std::vector<VkCommandBuffer> computeSubmissions;
+			size_t computeFork					= 0;
+			size_t computeJoin					= 0;
+			bool computeRecording				= false;
+			bool computeJoined					= false;
+
+			// Debug labels
+			PFN_vkCmdBeginDebugUtilsLabelEXT cmdBeginDebugLabel	= nullptr;
+			PFN_vkCmdEndDebugUtilsLabelEXT cmdEndDebugLabel		= nullptr;
+
+			uint32_t GetFrameSlot()						{ return (uint32_t)(frameIndex % frames_in_flight); }
+			// Whether the GPU is done with everything a frame submitted
+			bool IsFrameComplete(uint64_t frame)		{ return frame + frames_in_flight <= frameIndex; }
+			// Destroys something once the frames which may still use it are done
+			void Release(std::function<void()>&& release);
+		};
+		extern Context context;
+
+		// Recorder of the calling thread, the immediate one unless the thread records a command list
+		Recorder* GetRecorder();
+		void SetThreadRecorder(Recorder* recorder);
+
+		//= HELPERS ======================================================================================
+		bool Buffer_Create(Buffer* buffer, VkDeviceSize size, VkBufferUsageFlags usage, bool dynamic, const void* data = nullptr);
+		void Buffer_Destroy(Buffer* buffer);
+		// Discarding hands out a version the GPU doesn't read, otherwise the one the calling recorder (or anyone) mapped last
+		void* Buffer_Map(Buffer* buffer, bool discard);
+		// The version a draw recorded now reads, stamped with the current frame
+		VkBuffer Buffer_Resolve(Recorder* recorder, Buffer* buffer);
+		// Host visible, mapped memory for copies to (or from) the GPU, the caller destroys it once the copy is done
+		bool Buffer_CreateStaging(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer* buffer, Allocation* allocation);
+		void Buffer_DestroyStaging(VkBuffer buffer, Allocation& allocation);
+
+		bool Image_Create(Image* image, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers, VkFormat format, VkImageUsageFlags usage, bool cube = false);
+		void Image_Destroy(Image* image);
+		bool Image_IsDepth(VkFormat format);
+
+		// Ends the recorder's render pass and waits for everything recorded before, copies (and clears) can follow
+		void Recorder_Transfer(Recorder* recorder);
+		// Records into the current upload batch, copying from staging memory of the given size if there is any (see Uploader)
+		uint64_t Upload(const std::function<void(VkCommandBuffer, const Staging&)>& record, VkDeviceSize stagingSize = 0);
+		// Full memory barrier, everything recorded before is done (and visible) before anything recorded after starts
+		void Barrier(VkCommandBuffer commandBuffer);
+		void ImageLayout(VkCommandBuffer commandBuffer, Image* image, VkImageLayout from, VkImageLayout to);
+
+		// Reads the descriptor bindings out of a SPIR-V module
+		bool Shader_Reflect(const std::vector<uint32_t>& spirv, Shader* shader);
+
+		inline void HashCombine(size_t& seed, size_t value)
+		{
+			seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+		//================================================================================================
+	}
+}
+
+// The device and the recorder of the calling thread, resolved at compile time like RHI_Backend_D3D11
+struct RHI_Backend_Vulkan
+{
+	using Device	= VkDevice_T;
+	using Context	= Directus::Vulkan_Common::Recorder;
+
+	static Device* GetDevice()		{ return Directus::Vulkan_Common::context.device; }
+	static Context* GetContext()	{ return Directus::Vulkan_Common::GetRecorder(); }
+};
+using RHI_Backend = RHI_Backend_Vulkan;
@@ -0,0 +1,180 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =====================
+#include "Vulkan_Common.h"
+#include "../RHI_ConstantBuffer.h"
+#include "../RHI_Device.h"
+#include "../RHI_Capture.h"
+#include "../../Logging/Log.h"
+#include <algorithm>
+//================================
+
+//= NAMESPACES ===================
+using namespace std;
+using namespace Directus::Vulkan_Common;
+//================================
+
+namespace Directus
+{
+	RHI_ConstantBuffer::RHI_ConstantBuffer(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice		= rhiDevice;
+		m_buffer		= nullptr;
+		m_elementSize	= 0;
+		m_elementCount	= 1;
+	}
+
+	RHI_ConstantBuffer::~RHI_ConstantBuffer()
+	{
+		if (auto buffer = (Buffer*)m_buffer)
+		{
+			Buffer_Destroy(buffer);
+			delete buffer;
+			m_buffer = nullptr;
+		}
+	}
+
+	bool RHI_ConstantBuffer::Create(unsigned int size, unsigned int slot, Buffer_Scope scope)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_ConstantBuffer::Create: Invalid RHI device");
+			return false;
+		}
+
+		m_slot			= slot;
+		m_scope			= scope;
+		m_elementSize	= size;
+
+		// Uniform buffers are dynamic, every discarding map renames them
+		auto buffer = new Buffer();
+		if (!Buffer_Create(buffer, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, true))
+		{
+			LOG_ERROR("RHI_ConstantBuffer::Create: Failed to create constant buffer");
+			delete buffer;
+			return false;
+		}
+
+		m_buffer = (void*)buffer;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, size);
+		return true;
+	}
+
+	bool RHI_ConstantBuffer::CreateRing(unsigned int elementSize, unsigned int elementCount, unsigned int slot, Buffer_Scope scope)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_ConstantBuffer::CreateRing: Invalid RHI device");
+			return false;
+		}
+
+		// Elements are bound with dynamic offsets, which have to respect the device's alignment and range
+		auto& limits = context.properties.limits;
+		if (elementSize % 256 != 0 || elementSize % limits.minUniformBufferOffsetAlignment != 0 || elementSize > limits.maxUniformBufferRange)
+		{
+			LOGF_ERROR("RHI_ConstantBuffer::CreateRing: Element size of %d bytes can't be bound at an offset", elementSize);
+			return false;
+		}
+
+		if (!Create(elementSize * elementCount, slot, scope))
+			return false;
+
+		m_elementSize	= elementSize;
+		m_elementCount	= elementCount;
+		return true;
+	}
+
+	void* RHI_ConstantBuffer::Map(unsigned int* firstConstant /*= nullptr*/)
+	{
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_ConstantBuffer::Map: Invalid buffer");
+			return nullptr;
+		}
+
+		// Pick the next element, discarding only when starting a new command list or wrapping around
+		bool discard			= true;
+		unsigned int element	= 0;
+		if (IsRing())
+		{
+			auto commandList = m_rhiDevice->CommandList_GetID();
+
+			lock_guard<mutex> lock(m_ringMutex);
+			auto it = find_if(m_ringCursors.begin(), m_ringCursors.end(), [commandList](const RingCursor& cursor) { return cursor.commandList == commandList; });
+			if (it == m_ringCursors.end())
+			{
+				// Finished command lists never come back, so only the most recent ones are worth tracking
+				if (m_ringCursors.size() >= 16)
+				{
+					m_ringCursors.erase(m_ringCursors.begin());
+				}
+				m_ringCursors.emplace_back(RingCursor{ commandList, 0 });
+				it = m_ringCursors.end() - 1;
+			}
+			else if (it->element < m_elementCount)
+			{
+				discard = false;
+			}
+
+			if (it->element >= m_elementCount)
+			{
+				it->element = 0;
+			}
+			element = it->element++;
+		}
+
+		auto data = Buffer_Map((Buffer*)m_buffer, discard);
+		if (!data)
+		{
+			LOG_ERROR("RHI_ConstantBuffer::Map: Failed to map constant buffer.");
+			return nullptr;
+		}
+
+		if (firstConstant)
+		{
+			*firstConstant = element * GetConstantCount();
+		}
+
+		auto mapped = (void*)((char*)data + element * m_elementSize);
+		RHI_CAPTURE(Record_Map(Capture_UpdateConstantBuffer, this, m_buffer, mapped, m_elementSize, element * GetConstantCount()));
+		return mapped;
+	}
+
+	bool RHI_ConstantBuffer::Unmap()
+	{
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_ConstantBuffer::Unmap: Invalid buffer");
+			return false;
+		}
+		RHI_CAPTURE(Record_Unmap(this));
+
+		// Host coherent memory, the writes are visible to the next submission
+		return true;
+	}
+}
+#endif
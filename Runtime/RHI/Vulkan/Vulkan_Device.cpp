@@ -25,17 +25,24 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //================================
 
 //= INCLUDES ==================
+#include "Vulkan_Common.h"
 #include "../RHI_Device.h"
+#include "../RHI_Capture.h"
 #include "../../Math/Vector4.h"
 #include "../../Logging/Log.h"
-#include <vulkan/vulkan.h>
+#include "../../Profiling/Profiler.h"
+#include "../../Core/Settings.h"
 #include <string>
+#include <algorithm>
 //=============================
 
-//= NAMESPACES ================
+//= NAMESPACES ===================
 using namespace std;
 using namespace Directus::Math;
-//=============================
+using namespace Directus::Vulkan_Common;
+//================================
+
+#define DESCRIPTOR_POOL_SETS 1024 // descriptor sets per pool, a recorder adds pools when a frame needs more
 
 namespace Directus
 {
@@ -94,289 +101,2326 @@ namespace Directus
 			return VK_FALSE;
 		}
 
-		inline bool isDeviceSuitable(VkPhysicalDevice device) 
+		// Returns the queue family which can draw, dispatch and present, -1 if there is none
+		inline int GetQueueFamily(VkPhysicalDevice device, VkSurfaceKHR surface)
+		{
+			uint32_t familyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+			vector<VkQueueFamilyProperties> families(familyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+
+			for (uint32_t i = 0; i < familyCount; i++)
+			{
+				VkBool32 present = VK_FALSE;
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present);
+				if (present && (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT))
+					return (int)i;
+			}
+
+			return -1;
+		}
+
+		inline bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface, bool discrete)
 		{
 			VkPhysicalDeviceProperties deviceProperties;
-			VkPhysicalDeviceFeatures deviceFeatures;
 			vkGetPhysicalDeviceProperties(device, &deviceProperties);
-			vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
 
-			return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU || VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU || VK_PHYSICAL_DEVICE_TYPE_CPU;
+			if (discrete && deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+				return false;
+
+			return GetQueueFamily(device, surface) != -1;
+		}
+
+		inline VkViewport ToVkViewport(const RHI_Viewport& viewport)
+		{
+			// A negative height flips y, so clip space matches D3D11's
+			VkViewport vkViewport;
+			vkViewport.x		= viewport.GetTopLeftX();
+			vkViewport.y		= viewport.GetTopLeftY() + viewport.GetHeight();
+			vkViewport.width	= viewport.GetWidth();
+			vkViewport.height	= -viewport.GetHeight();
+			vkViewport.minDepth	= viewport.GetMinDepth();
+			vkViewport.maxDepth	= viewport.GetMaxDepth();
+			return vkViewport;
 		}
 
-		VkInstance instance;
-		VkPhysicalDevice device;
 		vector<const char*> validationLayers	= { "VK_LAYER_LUNARG_standard_validation" };
 		#ifdef DEBUG
 		const bool validationLayerEnabled		= true;
-		vector<const char*> extensions			= { "VK_KHR_win32_surface", VK_EXT_DEBUG_UTILS_EXTENSION_NAME };
 		#else
-		const bool validationLayerEnabled = false;
-		vector<const char*> extensions			= { "VK_KHR_win32_surface", VK_EXT_DEBUG_UTILS_EXTENSION_NAME };
+		const bool validationLayerEnabled		= false;
 		#endif
-		VkDebugUtilsMessengerEXT callback;
-	}
+		vector<const char*> extensions			= { VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_EXTENSION_NAME, VK_EXT_DEBUG_UTILS_EXTENSION_NAME };
+		VkDebugUtilsMessengerEXT callback		= VK_NULL_HANDLE;
+		bool fillModeNonSolid					= false;
 
-	RHI_Device::RHI_Device(void* drawHandle)
-	{
-		m_format				= Texture_Format_R8G8B8A8_UNORM;
-		m_depthEnabled			= true;
-		m_alphaBlendingEnabled	= false;
-		m_initialized			= false;
-		m_device				= nullptr;
-		m_deviceContext			= nullptr;
+		//= RECORDERS ==================================================================================================
+		inline Recorder* Recorder_Create()
+		{
+			auto recorder = make_unique<Recorder>();
+			for (auto& frame : recorder->frames)
+			{
+				VkCommandPoolCreateInfo poolInfo	= {};
+				poolInfo.sType						= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+				poolInfo.queueFamilyIndex			= context.queueFamily;
+				if (vkCreateCommandPool(context.device, &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS)
+				{
+					LOG_ERROR("Vulkan_Device::Recorder_Create: Failed to create command pool");
+					return nullptr;
+				}
+			}
 
-		Settings::Get().m_versionVulkan = to_string(VK_API_VERSION_1_0);
-		LOG_INFO(Settings::Get().m_versionVulkan);
+			lock_guard<mutex> lock(context.recordersMutex);
+			context.recorders.emplace_back(move(recorder));
+			return context.recorders.back().get();
+		}
 
-		// Validation layer
-		bool validationLayerAvailable = false;
-		if (Vulkan_Device::validationLayerEnabled)
+		inline void Recorder_Destroy(Recorder* recorder)
 		{
-			validationLayerAvailable = Vulkan_Device::AcquireValidationLayers(Vulkan_Device::validationLayers);
+			for (auto& frame : recorder->frames)
+			{
+				for (auto pool : frame.descriptorPools)
+				{
+					vkDestroyDescriptorPool(context.device, pool, nullptr);
+				}
+				vkDestroyCommandPool(context.device, frame.commandPool, nullptr);
+			}
 		}
-		
-		// Create instance
-		{
-			VkApplicationInfo appInfo	= {};
-			appInfo.sType				= VK_STRUCTURE_TYPE_APPLICATION_INFO;
-			appInfo.pApplicationName	= ENGINE_VERSION;
-			appInfo.applicationVersion	= VK_MAKE_VERSION(1, 0, 0);
-			appInfo.pEngineName			= ENGINE_VERSION;
-			appInfo.engineVersion		= VK_MAKE_VERSION(1, 0, 0);
-			appInfo.apiVersion			= VK_API_VERSION_1_1;
 
-			VkInstanceCreateInfo createInfo		= {};
-			createInfo.sType					= VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-			createInfo.pApplicationInfo			= &appInfo;
-			createInfo.enabledExtensionCount	= (uint32_t)Vulkan_Device::extensions.size();
-			createInfo.ppEnabledExtensionNames	= Vulkan_Device::extensions.data();
-			if (validationLayerAvailable) 
+		// Command buffers and descriptor sets of a frame the GPU is done with
+		inline void Recorder_ResetFrame(Recorder* recorder, uint32_t slot)
+		{
+			auto& frame = recorder->frames[slot];
+			vkResetCommandPool(context.device, frame.commandPool, 0);
+			frame.commandBufferCount = 0;
+			for (auto pool : frame.descriptorPools)
 			{
-				createInfo.enabledLayerCount	= (uint32_t)Vulkan_Device::validationLayers.size();
-				createInfo.ppEnabledLayerNames	= Vulkan_Device::validationLayers.data();
+				vkResetDescriptorPool(context.device, pool, 0);
 			}
-			else 
+			frame.descriptorPoolIndex = 0;
+			frame.descriptorSets.clear();
+		}
+
+		inline bool Recorder_Begin(Recorder* recorder)
+		{
+			auto& frame = recorder->frames[context.GetFrameSlot()];
+			if (frame.commandBufferCount == (uint32_t)frame.commandBuffers.size())
 			{
-				createInfo.enabledLayerCount = 0;
+				VkCommandBufferAllocateInfo allocateInfo	= {};
+				allocateInfo.sType							= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocateInfo.commandPool					= frame.commandPool;
+				allocateInfo.level							= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocateInfo.commandBufferCount				= 1;
+				VkCommandBuffer commandBuffer				= VK_NULL_HANDLE;
+				if (vkAllocateCommandBuffers(context.device, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+				{
+					LOG_ERROR("Vulkan_Device::Recorder_Begin: Failed to allocate command buffer");
+					return false;
+				}
+				frame.commandBuffers.emplace_back(commandBuffer);
 			}
+			recorder->commandBuffer = frame.commandBuffers[frame.commandBufferCount++];
 
-			auto result = vkCreateInstance(&createInfo, nullptr, &Vulkan_Device::instance);
-			if (result != VK_SUCCESS)
-			{
-				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create instance.");
+			VkCommandBufferBeginInfo beginInfo	= {};
+			beginInfo.sType						= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags						= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkBeginCommandBuffer(recorder->commandBuffer, &beginInfo);
+
+			recorder->Invalidate();
+			return true;
+		}
+
+		inline void RenderPass_End(Recorder* recorder)
+		{
+			if (!recorder->renderPassActive)
 				return;
-			}
+
+			vkCmdEndRenderPass(recorder->commandBuffer);
+			recorder->renderPassActive = false;
 		}
-		
-		// Get available extensions
+
+		inline VkCommandBuffer Recorder_End(Recorder* recorder)
 		{
-			uint32_t extensionCount = 0;
-			vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
-			std::vector<VkExtensionProperties> extensions(extensionCount);
-			vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
-			for (const auto& extension : extensions)
+			auto commandBuffer = recorder->commandBuffer;
+			if (commandBuffer == VK_NULL_HANDLE)
+				return VK_NULL_HANDLE;
+
+			RenderPass_End(recorder);
+			if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
 			{
-				LOGF_INFO("Vulkan_Device::RHI_Device: Available extension: %s", extension.extensionName);
+				LOG_ERROR("Vulkan_Device::Recorder_End: Failed to record command buffer");
 			}
+			recorder->commandBuffer = VK_NULL_HANDLE;
+			return commandBuffer;
 		}
+		//==============================================================================================================
 
-		// Callback
-		if (Vulkan_Device::validationLayerEnabled)
+		//= FRAMES =====================================================================================================
+		inline void RunReleases(Vulkan_Common::Context::Frame& frame)
 		{
-			VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
-			createInfo.sType			= VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-			createInfo.messageSeverity	= VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-			createInfo.messageType		= VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-			createInfo.pfnUserCallback	= Vulkan_Device::debugCallback;
-			createInfo.pUserData		= nullptr; // Optional
+			vector<function<void()>> releases;
+			{
+				lock_guard<mutex> lock(context.releaseMutex);
+				releases.swap(frame.releases);
+			}
 
-			if (Vulkan_Device::CreateDebugUtilsMessengerEXT(Vulkan_Device::instance, &createInfo, nullptr, &Vulkan_Device::callback) != VK_SUCCESS) 
+			for (auto& release : releases)
 			{
-				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to setup callback");
+				release();
 			}
 		}
 
-		// Device
+		// Waits for the frame which used the slot before, then starts recording into the immediate recorder
+		inline void Frame_Begin()
 		{
-			Vulkan_Device::device	= VK_NULL_HANDLE;
-			uint32_t deviceCount	= 0;
-			vkEnumeratePhysicalDevices(Vulkan_Device::instance, &deviceCount, nullptr);
-			if (deviceCount == 0) 
+			auto slot	= context.GetFrameSlot();
+			auto& frame	= context.frames[slot];
+			vkWaitForFences(context.device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+			vkResetFences(context.device, 1, &frame.fence);
+			RunReleases(frame);
+
+			// With fewer frames in flight than there are slots, the CPU also waits for the frame that many behind
+			uint64_t framesInFlight = Settings::Get().FramesInFlight_Get();
+			if (framesInFlight < frames_in_flight && context.frameIndex > framesInFlight)
 			{
-				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to enumerate physical devices.");
-				return;
+				auto& behind = context.frames[(context.frameIndex - framesInFlight) % frames_in_flight];
+				vkWaitForFences(context.device, 1, &behind.fence, VK_TRUE, UINT64_MAX);
 			}
-			std::vector<VkPhysicalDevice> devices(deviceCount);
-			vkEnumeratePhysicalDevices(Vulkan_Device::instance, &deviceCount, devices.data());
-			
-			for (const auto& device : devices) 
+
 			{
-				if (Vulkan_Device::isDeviceSuitable(device))
+				lock_guard<mutex> lock(context.recordersMutex);
+				for (auto& recorder : context.recorders)
 				{
-					Vulkan_Device::device = device;
-					break;
+					Recorder_ResetFrame(recorder.get(), slot);
 				}
 			}
 
-			if (Vulkan_Device::device == VK_NULL_HANDLE) 
+			context.backBufferAcquired = false;
+			if (context.swapchain != VK_NULL_HANDLE)
 			{
-				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to find a suitable device.");
-				return;
+				auto result = vkAcquireNextImageKHR(context.device, context.swapchain, UINT64_MAX, frame.imageAcquired, VK_NULL_HANDLE, &context.backBufferIndex);
+				context.backBufferAcquired = result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+				if (!context.backBufferAcquired)
+				{
+					LOG_WARNING("Vulkan_Device::Frame_Begin: Failed to acquire a swapchain image, the resolution has to be set again.");
+				}
+			}
+
+			auto immediate = context.recorders.front().get();
+			immediate->versions.clear();
+			Recorder_Begin(immediate);
+			if (context.backBufferAcquired)
+			{
+				ImageLayout(immediate->commandBuffer, context.backBuffers[context.backBufferIndex].get(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
 			}
 		}
 
-		//LOGF_INFO("Vulkan_Device::RHI_Device: Feature level %s - %s", featureLevelStr.data(), D3D11_Device::GetAdapterDescription(adapter).data());
-		m_device		= nullptr;
-		m_deviceContext = nullptr;
-		m_initialized	= false;
-	}
+		// Submits everything recorded this frame, in the order it was executed. With a compute section the frame's
+		// queue gets three submits: up to the section (which starts the compute queue), alongside it and after it.
+		inline void Frame_Submit(bool present)
+		{
+			auto slot		= context.GetFrameSlot();
+			auto& frame		= context.frames[slot];
+			auto immediate	= context.recorders.front().get();
 
-	RHI_Device::~RHI_Device()
-	{	
-		if (Vulkan_Device::validationLayerEnabled) Vulkan_Device::DestroyDebugUtilsMessengerEXT(Vulkan_Device::instance, Vulkan_Device::callback, nullptr);
-		vkDestroyInstance(Vulkan_Device::instance, nullptr);
-	}
+			// A section nobody ended, or waited for, ends with the frame
+			if (context.computeRecording)
+			{
+				SetThreadRecorder(nullptr);
+				context.computeSubmissions.emplace_back(Recorder_End(context.computeRecorder));
+				context.computeRecording = false;
+			}
 
-	void RHI_Device::Draw(unsigned int vertexCount)
-	{
-		
-	}
+			RenderPass_End(immediate);
+			if (context.backBufferAcquired)
+			{
+				ImageLayout(immediate->commandBuffer, context.backBuffers[context.backBufferIndex].get(), VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+			}
+			context.submissions.emplace_back(Recorder_End(immediate));
 
-	void RHI_Device::DrawIndexed(unsigned int indexCount, unsigned int indexOffset, unsigned int vertexOffset)
-	{
-		
-	}
+			bool compute		= !context.computeSubmissions.empty();
+			size_t fork			= compute ? context.computeFork : 0;
+			size_t join			= compute && context.computeJoined ? context.computeJoin : context.submissions.size();
+			bool signalPresent	= context.backBufferAcquired && present;
 
-	void RHI_Device::ClearBackBuffer(const Vector4& color)
-	{
+			// Whatever was uploaded since the last frame goes to the copy queue first, the frame waits for it on the GPU
+			vector<VkSemaphore> waitSemaphores;
+			if (context.backBufferAcquired)
+			{
+				waitSemaphores.emplace_back(frame.imageAcquired);
+			}
+			auto uploadsBegin = waitSemaphores.size();
+			context.uploader.Submit(&waitSemaphores);
+			vector<VkPipelineStageFlags> waitStages(waitSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			VkPipelineStageFlags computeStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 
-	}
+			// Up to the compute section, or everything
+			VkSubmitInfo submitBefore			= {};
+			submitBefore.sType					= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitBefore.waitSemaphoreCount		= (uint32_t)waitSemaphores.size();
+			submitBefore.pWaitSemaphores		= waitSemaphores.data();
+			submitBefore.pWaitDstStageMask		= waitStages.data();
+			submitBefore.commandBufferCount		= (uint32_t)(compute ? fork : context.submissions.size());
+			submitBefore.pCommandBuffers		= context.submissions.data();
+			submitBefore.signalSemaphoreCount	= compute ? 1 : (signalPresent ? 1 : 0);
+			submitBefore.pSignalSemaphores		= compute ? &frame.computeStart : &frame.renderFinished;
 
-	void RHI_Device::ClearRenderTarget(void* renderTarget, const Math::Vector4& color)
-	{
-		
-	}
+			// The compute section, once the frame's queue got to it
+			VkSubmitInfo submitCompute			= {};
+			submitCompute.sType					= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitCompute.waitSemaphoreCount	= 1;
+			submitCompute.pWaitSemaphores		= &frame.computeStart;
+			submitCompute.pWaitDstStageMask		= &computeStage;
+			submitCompute.commandBufferCount	= (uint32_t)context.computeSubmissions.size();
+			submitCompute.pCommandBuffers		= context.computeSubmissions.data();
+			submitCompute.signalSemaphoreCount	= 1;
+			submitCompute.pSignalSemaphores		= &frame.computeFinished;
 
-	void RHI_Device::ClearDepthStencil(void* depthStencil, unsigned int flags, float depth, uint8_t stencil)
-	{
-		
-	}
+			// Alongside the section, then after it. The fence is signaled last, so it covers the compute queue too.
+			VkSubmitInfo submitAfter[2]			= {};
+			submitAfter[0].sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitAfter[0].commandBufferCount	= (uint32_t)(join - fork);
+			submitAfter[0].pCommandBuffers		= context.submissions.data() + fork;
+			submitAfter[1].sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitAfter[1].waitSemaphoreCount	= 1;
+			submitAfter[1].pWaitSemaphores		= &frame.computeFinished;
+			submitAfter[1].pWaitDstStageMask	= &computeStage;
+			submitAfter[1].commandBufferCount	= (uint32_t)(context.submissions.size() - join);
+			submitAfter[1].pCommandBuffers		= context.submissions.data() + join;
+			submitAfter[1].signalSemaphoreCount	= signalPresent ? 1 : 0;
+			submitAfter[1].pSignalSemaphores	= &frame.renderFinished;
+			{
+				lock_guard<mutex> lock(context.queueMutex);
+				bool submitted = false;
+				if (!compute)
+				{
+					submitted = vkQueueSubmit(context.queue, 1, &submitBefore, frame.fence) == VK_SUCCESS;
+				}
+				else
+				{
+					// Binary semaphores have to be signaled by something submitted before their wait is
+					submitted =
+						vkQueueSubmit(context.queue, 1, &submitBefore, VK_NULL_HANDLE) == VK_SUCCESS &&
+						vkQueueSubmit(context.computeQueue, 1, &submitCompute, VK_NULL_HANDLE) == VK_SUCCESS &&
+						vkQueueSubmit(context.queue, 2, submitAfter, frame.fence) == VK_SUCCESS;
+				}
 
-	void RHI_Device::Present()
-	{
-		
-	}
+				if (!submitted)
+				{
+					LOG_ERROR("Vulkan_Device::Frame_Submit: Failed to submit command buffers");
+				}
 
-	void RHI_Device::Set_BackBufferAsRenderTarget()
-	{
-		
-	}
+				if (signalPresent)
+				{
+					VkPresentInfoKHR presentInfo	= {};
+					presentInfo.sType				= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+					presentInfo.waitSemaphoreCount	= 1;
+					presentInfo.pWaitSemaphores		= &frame.renderFinished;
+					presentInfo.swapchainCount		= 1;
+					presentInfo.pSwapchains			= &context.swapchain;
+					presentInfo.pImageIndices		= &context.backBufferIndex;
+					vkQueuePresentKHR(context.queue, &presentInfo);
+				}
+			}
+			context.submissions.clear();
+			context.computeSubmissions.clear();
+			context.computeJoined = false;
 
-	void RHI_Device::Set_VertexShader(void* buffer)
-	{
-		
-	}
+			// The upload semaphores are done with once this frame is
+			for (auto i = uploadsBegin; i < waitSemaphores.size(); i++)
+			{
+				auto semaphore = waitSemaphores[i];
+				context.Release([semaphore]() { vkDestroySemaphore(context.device, semaphore, nullptr); });
+			}
+			context.frameIndex++;
+		}
+		//==============================================================================================================
 
-	void RHI_Device::Set_PixelShader(void* buffer)
-	{
-		
-	}
+		//= SWAPCHAIN ==================================================================================================
+		inline void Swapchain_DestroyTargets()
+		{
+			for (auto& backBuffer : context.backBuffers)
+			{
+				Image_Destroy(backBuffer.get());
+			}
+			context.backBuffers.clear();
+			Image_Destroy(context.backBufferDepth.get());
+			context.backBufferDepth.reset();
+		}
 
-	void RHI_Device::Set_ConstantBuffers(unsigned int startSlot, unsigned int bufferCount, Buffer_Scope scope, void* const* buffer)
-	{
-		
-	}
+		inline bool Swapchain_Create(uint32_t width, uint32_t height)
+		{
+			VkSurfaceCapabilitiesKHR capabilities;
+			vkGetPhysicalDeviceSurfaceCapabilitiesKHR(context.physicalDevice, context.surface, &capabilities);
 
-	void RHI_Device::Set_Samplers(unsigned int startSlot, unsigned int samplerCount, void* const* samplers)
-	{
-		
-	}
+			uint32_t formatCount = 0;
+			vkGetPhysicalDeviceSurfaceFormatsKHR(context.physicalDevice, context.surface, &formatCount, nullptr);
+			vector<VkSurfaceFormatKHR> formats(formatCount);
+			vkGetPhysicalDeviceSurfaceFormatsKHR(context.physicalDevice, context.surface, &formatCount, formats.data());
+			if (formats.empty())
+			{
+				LOG_ERROR("Vulkan_Device::Swapchain_Create: The surface has no formats");
+				return false;
+			}
 
-	void RHI_Device::Set_RenderTargets(unsigned int renderTargetCount, void* const* renderTargets, void* depthStencil)
-	{
-		
-	}
+			VkSurfaceFormatKHR format = formats.front();
+			for (const auto& candidate : formats)
+			{
+				if (candidate.format == VK_FORMAT_R8G8B8A8_UNORM || candidate.format == VK_FORMAT_B8G8R8A8_UNORM)
+				{
+					format = candidate;
+					break;
+				}
+			}
 
-	void RHI_Device::Set_Textures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources)
-	{
-		
-	}
+			uint32_t modeCount = 0;
+			vkGetPhysicalDeviceSurfacePresentModesKHR(context.physicalDevice, context.surface, &modeCount, nullptr);
+			vector<VkPresentModeKHR> modes(modeCount);
+			vkGetPhysicalDeviceSurfacePresentModesKHR(context.physicalDevice, context.surface, &modeCount, modes.data());
 
-	bool RHI_Device::Set_Resolution(int width, int height)
-	{
-		return true;
-	}
+			// FIFO is always there, without vsync prefer not to block
+			VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+			if (!Settings::Get().VSync_Get())
+			{
+				for (auto mode : modes)
+				{
+					if (mode == VK_PRESENT_MODE_MAILBOX_KHR)										presentMode = mode;
+					if (mode == VK_PRESENT_MODE_IMMEDIATE_KHR && presentMode != VK_PRESENT_MODE_MAILBOX_KHR)	presentMode = mode;
+				}
+			}
 
-	void RHI_Device::Set_Viewport(const RHI_Viewport& viewport)
-	{
-		
-	}
+			VkExtent2D extent = { width, height };
+			extent.width	= max(capabilities.minImageExtent.width, min(capabilities.maxImageExtent.width, extent.width));
+			extent.height	= max(capabilities.minImageExtent.height, min(capabilities.maxImageExtent.height, extent.height));
 
-	bool RHI_Device::Set_DepthEnabled(bool enable)
-	{
-		return true;
-	}
+			uint32_t imageCount = capabilities.minImageCount + 1;
+			if (capabilities.maxImageCount > 0)
+			{
+				imageCount = min(imageCount, capabilities.maxImageCount);
+			}
 
-	bool RHI_Device::Set_AlphaBlendingEnabled(bool enable)
-	{
-		return true;
-	}
+			VkSwapchainCreateInfoKHR createInfo	= {};
+			createInfo.sType					= VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+			createInfo.surface					= context.surface;
+			createInfo.minImageCount			= imageCount;
+			createInfo.imageFormat				= format.format;
+			createInfo.imageColorSpace			= format.colorSpace;
+			createInfo.imageExtent				= extent;
+			createInfo.imageArrayLayers			= 1;
+			createInfo.imageUsage				= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+			createInfo.imageSharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+			createInfo.preTransform				= capabilities.currentTransform;
+			createInfo.compositeAlpha			= VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+			createInfo.presentMode				= presentMode;
+			createInfo.clipped					= VK_TRUE;
+			createInfo.oldSwapchain				= context.swapchain;
 
-	void RHI_Device::EventBegin(const std::string& name)
-	{
-		
-	}
+			VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+			if (vkCreateSwapchainKHR(context.device, &createInfo, nullptr, &swapchain) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::Swapchain_Create: Failed to create swapchain");
+				return false;
+			}
 
-	void RHI_Device::EventEnd()
-	{
-		
-	}
+			if (context.swapchain != VK_NULL_HANDLE)
+			{
+				vkDestroySwapchainKHR(context.device, context.swapchain, nullptr);
+			}
+			context.swapchain		= swapchain;
+			context.swapchainFormat	= format.format;
 
-	bool RHI_Device::Profiling_CreateQuery(void** query, Query_Type type)
-	{
-		return true;
-	}
+			// Back buffers
+			vkGetSwapchainImagesKHR(context.device, swapchain, &imageCount, nullptr);
+			vector<VkImage> images(imageCount);
+			vkGetSwapchainImagesKHR(context.device, swapchain, &imageCount, images.data());
+			for (auto vkImage : images)
+			{
+				auto image		= make_unique<Image>();
+				image->type		= Resource_Image;
+				image->image	= vkImage;
+				image->format	= format.format;
+				image->width	= extent.width;
+				image->height	= extent.height;
+				image->owned	= false;
 
-	void RHI_Device::Profiling_QueryStart(void* queryObject)
-	{
-		
-	}
+				VkImageViewCreateInfo viewInfo			= {};
+				viewInfo.sType							= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				viewInfo.image							= vkImage;
+				viewInfo.viewType						= VK_IMAGE_VIEW_TYPE_2D;
+				viewInfo.format							= format.format;
+				viewInfo.subresourceRange.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+				viewInfo.subresourceRange.levelCount	= 1;
+				viewInfo.subresourceRange.layerCount	= 1;
+				if (vkCreateImageView(context.device, &viewInfo, nullptr, &image->view) != VK_SUCCESS)
+				{
+					LOG_ERROR("Vulkan_Device::Swapchain_Create: Failed to create back buffer view");
+					return false;
+				}
+				context.backBuffers.emplace_back(move(image));
+			}
 
-	void RHI_Device::Profiling_QueryEnd(void* queryObject)
-	{
-		
-	}
+			// Depth buffer
+			context.backBufferDepth = make_unique<Image>();
+			auto depth = context.backBufferDepth.get();
+			if (!Image_Create(depth, extent.width, extent.height, 1, 1, VK_FORMAT_D32_SFLOAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+				return false;
 
-	void RHI_Device::Profiling_GetTimeStamp(void* queryObject)
-	{
-		
-	}
+			return Upload([depth](VkCommandBuffer commandBuffer, const Staging&) { ImageLayout(commandBuffer, depth, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL); }) != 0;
+		}
+		//==============================================================================================================
 
-	float RHI_Device::Profiling_GetDuration(void* queryDisjoint, void* queryStart, void* queryEnd)
-	{
-		return 0.0f;
-	}
+		//= RENDER PASSES ==============================================================================================
+		// Attachments stay in the general layout and keep their contents, clears are separate commands
+		inline VkRenderPass GetRenderPass(Recorder* recorder)
+		{
+			size_t hash = 0;
+			for (uint32_t i = 0; i < recorder->renderTargetCount; i++)
+			{
+				HashCombine(hash, recorder->renderTargets[i] ? recorder->renderTargets[i]->format : VK_FORMAT_UNDEFINED);
+			}
+			HashCombine(hash, recorder->depthStencil ? recorder->depthStencil->format : VK_FORMAT_UNDEFINED);
 
-	bool RHI_Device::Set_PrimitiveTopology(PrimitiveTopology_Mode primitiveTopology)
-	{
-		return true;
-	}
+			lock_guard<mutex> lock(context.cacheMutex);
+			auto it = context.renderPasses.find(hash);
+			if (it != context.renderPasses.end())
+				return it->second;
 
-	bool RHI_Device::Set_FillMode(Fill_Mode fillMode)
-	{
-		return true;
-	}
+			vector<VkAttachmentDescription> attachments;
+			vector<VkAttachmentReference> colorReferences;
+			VkAttachmentReference depthReference = { VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_GENERAL };
+			auto addAttachment = [&attachments](VkFormat format)
+			{
+				VkAttachmentDescription attachment	= {};
+				attachment.format					= format;
+				attachment.samples					= VK_SAMPLE_COUNT_1_BIT;
+				attachment.loadOp					= VK_ATTACHMENT_LOAD_OP_LOAD;
+				attachment.storeOp					= VK_ATTACHMENT_STORE_OP_STORE;
+				attachment.stencilLoadOp			= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				attachment.stencilStoreOp			= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				attachment.initialLayout			= VK_IMAGE_LAYOUT_GENERAL;
+				attachment.finalLayout				= VK_IMAGE_LAYOUT_GENERAL;
+				attachments.emplace_back(attachment);
+				return (uint32_t)attachments.size() - 1;
+			};
 
-	bool RHI_Device::Set_InputLayout(void* inputLayout)
-	{
-		return true;
-	}
+			for (uint32_t i = 0; i < recorder->renderTargetCount; i++)
+			{
+				auto target = recorder->renderTargets[i];
+				colorReferences.push_back({ target ? addAttachment(target->format) : VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_GENERAL });
+			}
+			if (recorder->depthStencil)
+			{
+				depthReference.attachment = addAttachment(recorder->depthStencil->format);
+			}
+
+			VkSubpassDescription subpass	= {};
+			subpass.pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpass.colorAttachmentCount	= (uint32_t)colorReferences.size();
+			subpass.pColorAttachments		= colorReferences.data();
+			subpass.pDepthStencilAttachment	= recorder->depthStencil ? &depthReference : nullptr;
+
+			VkRenderPassCreateInfo createInfo	= {};
+			createInfo.sType					= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			createInfo.attachmentCount			= (uint32_t)attachments.size();
+			createInfo.pAttachments				= attachments.data();
+			createInfo.subpassCount				= 1;
+			createInfo.pSubpasses				= &subpass;
+
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			if (vkCreateRenderPass(context.device, &createInfo, nullptr, &renderPass) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::GetRenderPass: Failed to create render pass");
+				return VK_NULL_HANDLE;
+			}
+
+			context.renderPasses[hash] = renderPass;
+			return renderPass;
+		}
+
+		inline VkFramebuffer GetFramebuffer(Recorder* recorder, VkRenderPass renderPass, const VkExtent2D& extent)
+		{
+			vector<Image*> images;
+			vector<VkImageView> views;
+			for (uint32_t i = 0; i < recorder->renderTargetCount; i++)
+			{
+				if (recorder->renderTargets[i])
+				{
+					images.emplace_back(recorder->renderTargets[i]);
+					views.emplace_back(recorder->renderTargets[i]->view);
+				}
+			}
+			if (recorder->depthStencil)
+			{
+				images.emplace_back(recorder->depthStencil);
+				views.emplace_back(recorder->depthStencil->view);
+			}
+
+			size_t hash = (size_t)renderPass;
+			for (auto view : views)
+			{
+				HashCombine(hash, (size_t)view);
+			}
+			HashCombine(hash, extent.width);
+			HashCombine(hash, extent.height);
+
+			lock_guard<mutex> lock(context.cacheMutex);
+			auto it = context.framebuffers.find(hash);
+			if (it != context.framebuffers.end())
+				return it->second.framebuffer;
+
+			VkFramebufferCreateInfo createInfo	= {};
+			createInfo.sType					= VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+			createInfo.renderPass				= renderPass;
+			createInfo.attachmentCount			= (uint32_t)views.size();
+			createInfo.pAttachments				= views.data();
+			createInfo.width					= extent.width;
+			createInfo.height					= extent.height;
+			createInfo.layers					= 1;
+
+			VkFramebuffer framebuffer = VK_NULL_HANDLE;
+			if (vkCreateFramebuffer(context.device, &createInfo, nullptr, &framebuffer) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::GetFramebuffer: Failed to create framebuffer");
+				return VK_NULL_HANDLE;
+			}
+
+			context.framebuffers[hash] = Vulkan_Common::Context::Framebuffer{ framebuffer, images };
+			return framebuffer;
+		}
+
+		// Starts a render pass with the current render targets, unless one already is
+		inline bool RenderPass_Begin(Recorder* recorder)
+		{
+			if (recorder->renderPassActive && !recorder->renderTargetsDirty)
+				return true;
+
+			RenderPass_End(recorder);
+			recorder->renderTargetsDirty = false;
+
+			// The render area is what all the attachments cover
+			VkExtent2D extent = { UINT32_MAX, UINT32_MAX };
+			for (uint32_t i = 0; i < recorder->renderTargetCount; i++)
+			{
+				if (auto target = recorder->renderTargets[i])
+				{
+					extent = { min(extent.width, target->width), min(extent.height, target->height) };
+				}
+			}
+			if (recorder->depthStencil)
+			{
+				extent = { min(extent.width, recorder->depthStencil->width), min(extent.height, recorder->depthStencil->height) };
+			}
+			if (extent.width == UINT32_MAX)
+			{
+				LOG_WARNING("Vulkan_Device::RenderPass_Begin: No render targets are set");
+				return false;
+			}
+
+			auto renderPass		= GetRenderPass(recorder);
+			auto framebuffer	= renderPass ? GetFramebuffer(recorder, renderPass, extent) : VK_NULL_HANDLE;
+			if (!framebuffer)
+				return false;
+
+			// Whatever wrote the attachments (or reads what this pass writes) before is done
+			Barrier(recorder->commandBuffer);
+
+			VkRenderPassBeginInfo beginInfo	= {};
+			beginInfo.sType					= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			beginInfo.renderPass			= renderPass;
+			beginInfo.framebuffer			= framebuffer;
+			beginInfo.renderArea			= { { 0, 0 }, extent };
+			vkCmdBeginRenderPass(recorder->commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			VkRect2D scissor = { { 0, 0 }, extent };
+			vkCmdSetScissor(recorder->commandBuffer, 0, 1, &scissor);
+
+			recorder->renderPass		= renderPass;
+			recorder->renderPassExtent	= extent;
+			recorder->renderPassActive	= true;
+			recorder->scissorDirty		= recorder->scissorEnabled;
+			return true;
+		}
+		//==============================================================================================================
+
+		//= PIPELINES ==================================================================================================
+		inline VkPipelineLayout GetPipelineLayout(Shader* vertexShader, Shader* pixelShader)
+		{
+			VkDescriptorSetLayout setLayouts[2];
+			setLayouts[set_vertex]	= vertexShader->setLayout ? vertexShader->setLayout : context.emptySetLayout;
+			setLayouts[set_pixel]	= (pixelShader && pixelShader->setLayout) ? pixelShader->setLayout : context.emptySetLayout;
+
+			size_t hash = (size_t)vertexShader->id;
+			HashCombine(hash, pixelShader ? (size_t)pixelShader->id : 0);
+
+			lock_guard<mutex> lock(context.cacheMutex);
+			auto it = context.pipelineLayouts.find(hash);
+			if (it != context.pipelineLayouts.end())
+				return it->second;
+
+			VkPipelineLayoutCreateInfo createInfo	= {};
+			createInfo.sType						= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			createInfo.setLayoutCount				= 2;
+			createInfo.pSetLayouts					= setLayouts;
+
+			VkPipelineLayout layout = VK_NULL_HANDLE;
+			if (vkCreatePipelineLayout(context.device, &createInfo, nullptr, &layout) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::GetPipelineLayout: Failed to create pipeline layout");
+				return VK_NULL_HANDLE;
+			}
+
+			context.pipelineLayouts[hash] = layout;
+			return layout;
+		}
+
+		inline void BlendAttachment(Blend_Mode mode, uint32_t index, VkPipelineColorBlendAttachmentState* state)
+		{
+			*state						= {};
+			state->colorWriteMask		= VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+			state->colorBlendOp			= VK_BLEND_OP_ADD;
+			state->alphaBlendOp			= VK_BLEND_OP_ADD;
+			state->blendEnable			= mode != Blend_Disabled;
+			state->srcColorBlendFactor	= VK_BLEND_FACTOR_SRC_ALPHA;
+			state->dstColorBlendFactor	= VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			state->srcAlphaBlendFactor	= VK_BLEND_FACTOR_ONE;
+			state->dstAlphaBlendFactor	= VK_BLEND_FACTOR_ONE;
+
+			// Same as the D3D11 blend states, accumulation into the first target and revealage into the second
+			if (mode == Blend_WeightedOIT)
+			{
+				state->srcColorBlendFactor	= index == 1 ? VK_BLEND_FACTOR_ZERO : VK_BLEND_FACTOR_ONE;
+				state->dstColorBlendFactor	= index == 1 ? VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR : VK_BLEND_FACTOR_ONE;
+				state->srcAlphaBlendFactor	= index == 1 ? VK_BLEND_FACTOR_ZERO : VK_BLEND_FACTOR_ONE;
+				state->dstAlphaBlendFactor	= index == 1 ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+			}
+		}
+
+		inline bool BindGraphicsPipeline(Recorder* recorder, VkPipelineLayout layout)
+		{
+			auto vertexStride	= recorder->vertexStride ? recorder->vertexStride : (recorder->inputLayout ? recorder->inputLayout->stride : 0);
+			auto fillMode		= fillModeNonSolid ? recorder->fillMode : Fill_Solid;
+
+			size_t hash = (size_t)recorder->vertexShader->id;
+			HashCombine(hash, recorder->pixelShader ? (size_t)recorder->pixelShader->id : 0);
+			HashCombine(hash, recorder->inputLayout ? (size_t)recorder->inputLayout->id : 0);
+			HashCombine(hash, vertexStride);
+			HashCombine(hash, recorder->topology);
+			HashCombine(hash, recorder->cullMode);
+			HashCombine(hash, fillMode);
+			HashCombine(hash, recorder->blendMode);
+			HashCombine(hash, recorder->depthEnabled);
+			HashCombine(hash, recorder->depthWrite);
+			HashCombine(hash, recorder->depthReverse);
+			HashCombine(hash, (size_t)recorder->renderPass);
+			HashCombine(hash, (size_t)layout);
+
+			if (hash == recorder->pipelineHash && recorder->pipeline)
+				return true;
+
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			{
+				lock_guard<mutex> lock(context.cacheMutex);
+				auto it = context.pipelines.find(hash);
+				if (it != context.pipelines.end())
+				{
+					pipeline = it->second;
+				}
+			}
+
+			if (!pipeline)
+			{
+				VkPipelineShaderStageCreateInfo stages[2]	= {};
+				uint32_t stageCount							= 0;
+				for (auto shader : { recorder->vertexShader, recorder->pixelShader })
+				{
+					if (!shader)
+						continue;
+
+					stages[stageCount].sType	= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+					stages[stageCount].stage	= shader->stage;
+					stages[stageCount].module	= shader->module;
+					stages[stageCount].pName	= shader->entryPoint;
+					stageCount++;
+				}
+
+				VkVertexInputBindingDescription vertexBinding			= { 0, vertexStride, VK_VERTEX_INPUT_RATE_VERTEX };
+				VkPipelineVertexInputStateCreateInfo vertexInput		= {};
+				vertexInput.sType										= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+				if (recorder->inputLayout && !recorder->inputLayout->attributes.empty())
+				{
+					vertexInput.vertexBindingDescriptionCount	= 1;
+					vertexInput.pVertexBindingDescriptions		= &vertexBinding;
+					vertexInput.vertexAttributeDescriptionCount	= (uint32_t)recorder->inputLayout->attributes.size();
+					vertexInput.pVertexAttributeDescriptions	= recorder->inputLayout->attributes.data();
+				}
+
+				VkPipelineInputAssemblyStateCreateInfo inputAssembly	= {};
+				inputAssembly.sType										= VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+				inputAssembly.topology									= vulkan_primitive_topology[recorder->topology == PrimitiveTopology_NotAssigned ? PrimitiveTopology_TriangleList : recorder->topology];
+
+				VkPipelineViewportStateCreateInfo viewportState	= {};
+				viewportState.sType								= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+				viewportState.viewportCount						= 1;
+				viewportState.scissorCount						= 1;
+
+				// The negative viewport height keeps D3D11's clockwise front faces
+				VkPipelineRasterizationStateCreateInfo rasterization	= {};
+				rasterization.sType										= VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+				rasterization.polygonMode								= vulkan_polygon_mode[fillMode == Fill_NotAssigned ? Fill_Solid : fillMode];
+				rasterization.cullMode									= vulkan_cull_mode[recorder->cullMode == Cull_NotAssigned ? Cull_Back : recorder->cullMode];
+				rasterization.frontFace									= VK_FRONT_FACE_CLOCKWISE;
+				rasterization.lineWidth									= 1.0f;
+
+				VkPipelineMultisampleStateCreateInfo multisample	= {};
+				multisample.sType									= VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+				multisample.rasterizationSamples					= VK_SAMPLE_COUNT_1_BIT;
+
+				VkPipelineDepthStencilStateCreateInfo depthStencil	= {};
+				depthStencil.sType									= VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+				depthStencil.depthTestEnable						= recorder->depthEnabled;
+				depthStencil.depthWriteEnable						= recorder->depthEnabled && recorder->depthWrite;
+				depthStencil.depthCompareOp							= recorder->depthReverse ? VK_COMPARE_OP_GREATER_OR_EQUAL : VK_COMPARE_OP_LESS_OR_EQUAL;
+
+				VkPipelineColorBlendAttachmentState blendAttachments[8];
+				for (uint32_t i = 0; i < recorder->renderTargetCount; i++)
+				{
+					BlendAttachment(recorder->blendMode, i, &blendAttachments[i]);
+				}
+				VkPipelineColorBlendStateCreateInfo blend	= {};
+				blend.sType									= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+				blend.attachmentCount						= recorder->renderTargetCount;
+				blend.pAttachments							= blendAttachments;
+
+				VkDynamicState dynamicStates[]				= { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+				VkPipelineDynamicStateCreateInfo dynamic	= {};
+				dynamic.sType								= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+				dynamic.dynamicStateCount					= 2;
+				dynamic.pDynamicStates						= dynamicStates;
+
+				VkGraphicsPipelineCreateInfo createInfo	= {};
+				createInfo.sType						= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+				createInfo.stageCount					= stageCount;
+				createInfo.pStages						= stages;
+				createInfo.pVertexInputState			= &vertexInput;
+				createInfo.pInputAssemblyState			= &inputAssembly;
+				createInfo.pViewportState				= &viewportState;
+				createInfo.pRasterizationState			= &rasterization;
+				createInfo.pMultisampleState			= &multisample;
+				createInfo.pDepthStencilState			= &depthStencil;
+				createInfo.pColorBlendState				= &blend;
+				createInfo.pDynamicState				= &dynamic;
+				createInfo.layout						= layout;
+				createInfo.renderPass					= recorder->renderPass;
+				createInfo.subpass						= 0;
+
+				if (vkCreateGraphicsPipelines(context.device, context.pipelineCache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+				{
+					LOG_ERROR("Vulkan_Device::BindGraphicsPipeline: Failed to create pipeline");
+					return false;
+				}
+
+				// Another thread may have created the same one meanwhile, keep the first
+				lock_guard<mutex> lock(context.cacheMutex);
+				auto it = context.pipelines.find(hash);
+				if (it != context.pipelines.end())
+				{
+					vkDestroyPipeline(context.device, pipeline, nullptr);
+					pipeline = it->second;
+				}
+				else
+				{
+					context.pipelines[hash] = pipeline;
+				}
+			}
+
+			vkCmdBindPipeline(recorder->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+			recorder->pipeline		= pipeline;
+			recorder->pipelineHash	= hash;
+			return true;
+		}
+
+		inline bool BindComputePipeline(Recorder* recorder)
+		{
+			auto shader		= recorder->computeShader;
+			size_t hash		= (size_t)shader->id;
+			HashCombine(hash, VK_PIPELINE_BIND_POINT_COMPUTE);
+
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			{
+				lock_guard<mutex> lock(context.cacheMutex);
+				auto it = context.pipelines.find(hash);
+				if (it != context.pipelines.end())
+				{
+					pipeline = it->second;
+				}
+			}
+
+			if (!pipeline)
+			{
+				VkComputePipelineCreateInfo createInfo	= {};
+				createInfo.sType						= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+				createInfo.stage.sType					= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+				createInfo.stage.stage					= VK_SHADER_STAGE_COMPUTE_BIT;
+				createInfo.stage.module					= shader->module;
+				createInfo.stage.pName					= shader->entryPoint;
+				createInfo.layout						= shader->pipelineLayout;
+				if (vkCreateComputePipelines(context.device, context.pipelineCache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+				{
+					LOG_ERROR("Vulkan_Device::BindComputePipeline: Failed to create pipeline");
+					return false;
+				}
+
+				lock_guard<mutex> lock(context.cacheMutex);
+				auto it = context.pipelines.find(hash);
+				if (it != context.pipelines.end())
+				{
+					vkDestroyPipeline(context.device, pipeline, nullptr);
+					pipeline = it->second;
+				}
+				else
+				{
+					context.pipelines[hash] = pipeline;
+				}
+			}
+
+			if (recorder->computePipeline != pipeline)
+			{
+				vkCmdBindPipeline(recorder->commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+				recorder->computePipeline = pipeline;
+			}
+			return true;
+		}
+		//==============================================================================================================
+
+		//= DESCRIPTOR SETS ============================================================================================
+		inline VkDescriptorSet AllocateDescriptorSet(Recorder* recorder, VkDescriptorSetLayout layout)
+		{
+			auto& frame = recorder->frames[context.GetFrameSlot()];
+			while (true)
+			{
+				if (frame.descriptorPoolIndex == (uint32_t)frame.descriptorPools.size())
+				{
+					VkDescriptorPoolSize sizes[] =
+					{
+						{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,	DESCRIPTOR_POOL_SETS * 4 },
+						{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,				DESCRIPTOR_POOL_SETS * 8 },
+						{ VK_DESCRIPTOR_TYPE_SAMPLER,					DESCRIPTOR_POOL_SETS * 4 },
+						{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,				DESCRIPTOR_POOL_SETS },
+						{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			DESCRIPTOR_POOL_SETS * 2 }
+					};
+
+					VkDescriptorPoolCreateInfo createInfo	= {};
+					createInfo.sType						= VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+					createInfo.maxSets						= DESCRIPTOR_POOL_SETS;
+					createInfo.poolSizeCount				= (uint32_t)(sizeof(sizes) / sizeof(sizes[0]));
+					createInfo.pPoolSizes					= sizes;
+
+					VkDescriptorPool pool = VK_NULL_HANDLE;
+					if (vkCreateDescriptorPool(context.device, &createInfo, nullptr, &pool) != VK_SUCCESS)
+					{
+						LOG_ERROR("Vulkan_Device::AllocateDescriptorSet: Failed to create descriptor pool");
+						return VK_NULL_HANDLE;
+					}
+					frame.descriptorPools.emplace_back(pool);
+				}
+
+				VkDescriptorSetAllocateInfo allocateInfo	= {};
+				allocateInfo.sType							= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+				allocateInfo.descriptorPool					= frame.descriptorPools[frame.descriptorPoolIndex];
+				allocateInfo.descriptorSetCount				= 1;
+				allocateInfo.pSetLayouts					= &layout;
+
+				VkDescriptorSet set = VK_NULL_HANDLE;
+				auto result = vkAllocateDescriptorSets(context.device, &allocateInfo, &set);
+				if (result == VK_SUCCESS)
+					return set;
+
+				// Full, move on to the next pool
+				if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+				{
+					LOG_ERROR("Vulkan_Device::AllocateDescriptorSet: Failed to allocate descriptor set");
+					return VK_NULL_HANDLE;
+				}
+				frame.descriptorPoolIndex++;
+			}
+		}
+
+		// Resolves what the shader reads from the stage's slots, reusing the frame's descriptor set for the same resources
+		inline bool BindDescriptorSet(Recorder* recorder, StageBindings& stage, Shader* shader, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex)
+		{
+			auto count = shader->bindings.size();
+			if (count == 0)
+				return true;
+
+			vector<VkWriteDescriptorSet> writes(count);
+			vector<VkDescriptorBufferInfo> bufferInfos(count);
+			vector<VkDescriptorImageInfo> imageInfos(count);
+			vector<uint32_t> dynamicOffsets;
+			size_t hash = (size_t)shader->id;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				auto& binding			= shader->bindings[i];
+				auto& write				= writes[i];
+				write					= {};
+				write.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				write.dstBinding		= binding.binding;
+				write.descriptorCount	= 1;
+				write.descriptorType	= binding.type;
+				write.pBufferInfo		= &bufferInfos[i];
+				write.pImageInfo		= &imageInfos[i];
+
+				// Which D3D register the binding came from
+				auto slotB = binding.binding - binding_shift_b;
+				auto slotT = binding.binding - binding_shift_t;
+				auto slotS = binding.binding - binding_shift_s;
+				auto slotU = binding.binding - binding_shift_u;
+				bool isB = binding.binding < binding_shift_t;
+				bool isT = binding.binding >= binding_shift_t && binding.binding < binding_shift_s;
+				bool isS = binding.binding >= binding_shift_s && binding.binding < binding_shift_u;
+				bool isU = binding.binding >= binding_shift_u && slotU < slot_count_u;
+
+				Resource* resource = nullptr;
+				if (isT) resource = stage.textures[slotT];
+				if (isU) resource = stage.unorderedAccess[slotU];
+
+				switch (binding.type)
+				{
+				case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+				{
+					auto bufferBinding	= isB ? stage.constantBuffers[slotB] : BufferBinding();
+					auto buffer			= bufferBinding.buffer ? bufferBinding.buffer : context.dummyBuffer.get();
+					bufferInfos[i]		= { Buffer_Resolve(recorder, buffer), 0, bufferBinding.range ? bufferBinding.range : min(buffer->size, (VkDeviceSize)context.properties.limits.maxUniformBufferRange) };
+					dynamicOffsets.emplace_back((uint32_t)bufferBinding.offset);
+					break;
+				}
+
+				case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+				{
+					auto buffer		= (resource && resource->type == Resource_Buffer) ? (Buffer*)resource : context.dummyBuffer.get();
+					bufferInfos[i]	= { Buffer_Resolve(recorder, buffer), 0, VK_WHOLE_SIZE };
+					break;
+				}
+
+				case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+				{
+					auto image		= (resource && resource->type == Resource_Image) ? (Image*)resource : context.dummyImage.get();
+					imageInfos[i]	= { VK_NULL_HANDLE, image->view, image->layout };
+					break;
+				}
+
+				case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+				{
+					auto image		= (resource && resource->type == Resource_Image) ? (Image*)resource : context.dummyStorageImage.get();
+					imageInfos[i]	= { VK_NULL_HANDLE, image->view, VK_IMAGE_LAYOUT_GENERAL };
+					break;
+				}
+
+				case VK_DESCRIPTOR_TYPE_SAMPLER:
+				{
+					auto sampler	= (isS && stage.samplers[slotS]) ? stage.samplers[slotS] : context.dummySampler;
+					imageInfos[i]	= { sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED };
+					break;
+				}
+
+				default:
+					break;
+				}
+
+				HashCombine(hash, (size_t)bufferInfos[i].buffer);
+				HashCombine(hash, (size_t)bufferInfos[i].range);
+				HashCombine(hash, (size_t)imageInfos[i].imageView);
+				HashCombine(hash, (size_t)imageInfos[i].sampler);
+			}
+
+			// Same set and same offsets as the last draw
+			size_t boundHash = hash;
+			HashCombine(boundHash, (size_t)layout);
+			for (auto offset : dynamicOffsets)
+			{
+				HashCombine(boundHash, offset);
+			}
+			if (boundHash == stage.boundHash)
+				return true;
+
+			auto& frame = recorder->frames[context.GetFrameSlot()];
+			VkDescriptorSet set = VK_NULL_HANDLE;
+			auto it = frame.descriptorSets.find(hash);
+			if (it != frame.descriptorSets.end())
+			{
+				set = it->second;
+			}
+			else
+			{
+				set = AllocateDescriptorSet(recorder, shader->setLayout);
+				if (!set)
+					return false;
+
+				for (auto& write : writes)
+				{
+					write.dstSet = set;
+				}
+				vkUpdateDescriptorSets(context.device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+				frame.descriptorSets[hash] = set;
+			}
+
+			vkCmdBindDescriptorSets(recorder->commandBuffer, bindPoint, layout, setIndex, 1, &set, (uint32_t)dynamicOffsets.size(), dynamicOffsets.data());
+			stage.boundHash = boundHash;
+			return true;
+		}
+		//==============================================================================================================
+
+		//= FLUSH ======================================================================================================
+		// Brings the command buffer up to date with the recorder's state, right before a draw
+		inline bool FlushGraphics(Recorder* recorder, bool indexed)
+		{
+			if (!recorder->commandBuffer || !recorder->vertexShader)
+				return false;
+
+			if (!RenderPass_Begin(recorder))
+				return false;
+
+			auto layout = GetPipelineLayout(recorder->vertexShader, recorder->pixelShader);
+			if (!layout || !BindGraphicsPipeline(recorder, layout))
+				return false;
+
+			if (layout != recorder->pipelineLayout)
+			{
+				recorder->stages[Stage_Vertex].boundHash	= 0;
+				recorder->stages[Stage_Pixel].boundHash		= 0;
+				recorder->pipelineLayout					= layout;
+			}
+
+			if (!BindDescriptorSet(recorder, recorder->stages[Stage_Vertex], recorder->vertexShader, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set_vertex))
+				return false;
+
+			if (recorder->pixelShader && !BindDescriptorSet(recorder, recorder->stages[Stage_Pixel], recorder->pixelShader, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set_pixel))
+				return false;
+
+			// Dynamic buffers may have been renamed since they were bound
+			if (recorder->vertexBuffer.buffer)
+			{
+				auto buffer = Buffer_Resolve(recorder, recorder->vertexBuffer.buffer);
+				if (buffer != recorder->vertexBufferBound)
+				{
+					vkCmdBindVertexBuffers(recorder->commandBuffer, 0, 1, &buffer, &recorder->vertexBuffer.offset);
+					recorder->vertexBufferBound = buffer;
+				}
+			}
+
+			if (indexed)
+			{
+				auto buffer = Buffer_Resolve(recorder, recorder->indexBuffer.buffer);
+				if (!buffer)
+				{
+					LOG_WARNING("Vulkan_Device::FlushGraphics: No index buffer is set");
+					return false;
+				}
+
+				if (buffer != recorder->indexBufferBound)
+				{
+					vkCmdBindIndexBuffer(recorder->commandBuffer, buffer, recorder->indexBuffer.offset, recorder->indexType);
+					recorder->indexBufferBound = buffer;
+				}
+			}
+
+			if (recorder->viewportDirty)
+			{
+				vkCmdSetViewport(recorder->commandBuffer, 0, 1, &recorder->viewport);
+				recorder->viewportDirty = false;
+			}
+
+			if (recorder->scissorDirty)
+			{
+				auto scissor = recorder->scissorEnabled ? recorder->scissor : VkRect2D{ { 0, 0 }, recorder->renderPassExtent };
+				vkCmdSetScissor(recorder->commandBuffer, 0, 1, &scissor);
+				recorder->scissorDirty = false;
+			}
+
+			return true;
+		}
+
+		inline bool FlushCompute(Recorder* recorder)
+		{
+			if (!recorder->commandBuffer || !recorder->computeShader)
+				return false;
+
+			// Dispatches don't happen inside render passes, and they see everything recorded before them
+			RenderPass_End(recorder);
+			Barrier(recorder->commandBuffer);
+
+			if (!BindComputePipeline(recorder))
+				return false;
+
+			auto layout = recorder->computeShader->pipelineLayout;
+			if (layout != recorder->computePipelineLayout)
+			{
+				recorder->stages[Stage_Compute].boundHash	= 0;
+				recorder->computePipelineLayout				= layout;
+			}
+
+			return BindDescriptorSet(recorder, recorder->stages[Stage_Compute], recorder->computeShader, VK_PIPELINE_BIND_POINT_COMPUTE, layout, set_compute);
+		}
+		//==============================================================================================================
+
+		inline void ClearImage(Recorder* recorder, Image* image, const VkClearColorValue* color, float depth, uint8_t stencil, VkImageAspectFlags aspect)
+		{
+			if (!recorder || !recorder->commandBuffer || !image)
+				return;
+
+			Recorder_Transfer(recorder);
+
+			VkImageSubresourceRange range	= {};
+			range.aspectMask				= aspect;
+			range.levelCount				= VK_REMAINING_MIP_LEVELS;
+			range.layerCount				= VK_REMAINING_ARRAY_LAYERS;
+			if (color)
+			{
+				vkCmdClearColorImage(recorder->commandBuffer, image->image, image->layout, color, 1, &range);
+			}
+			else if (aspect)
+			{
+				VkClearDepthStencilValue value = { depth, stencil };
+				vkCmdClearDepthStencilImage(recorder->commandBuffer, image->image, image->layout, &value, 1, &range);
+			}
+		}
+
+		inline void DestroyCaches()
+		{
+			for (auto& pipeline : context.pipelines)			vkDestroyPipeline(context.device, pipeline.second, nullptr);
+			for (auto& layout : context.pipelineLayouts)		vkDestroyPipelineLayout(context.device, layout.second, nullptr);
+			for (auto& framebuffer : context.framebuffers)		vkDestroyFramebuffer(context.device, framebuffer.second.framebuffer, nullptr);
+			for (auto& renderPass : context.renderPasses)		vkDestroyRenderPass(context.device, renderPass.second, nullptr);
+			context.pipelines.clear();
+			context.pipelineLayouts.clear();
+			context.framebuffers.clear();
+			context.renderPasses.clear();
+		}
+
+		inline bool CreateDummies()
+		{
+			// An empty set layout stands in for stages without resources
+			VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+			layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			vkCreateDescriptorSetLayout(context.device, &layoutInfo, nullptr, &context.emptySetLayout);
+
+			context.dummyBuffer = make_unique<Buffer>();
+			if (!Buffer_Create(context.dummyBuffer.get(), 256, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false))
+				return false;
+
+			context.dummyImage			= make_unique<Image>();
+			context.dummyStorageImage	= make_unique<Image>();
+			auto image					= context.dummyImage.get();
+			auto storageImage			= context.dummyStorageImage.get();
+			if (!Image_Create(image, 1, 1, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT) ||
+				!Image_Create(storageImage, 1, 1, 1, 1, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+				return false;
+			image->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			Upload([image, storageImage](VkCommandBuffer commandBuffer, const Staging&)
+			{
+				VkClearColorValue black			= {};
+				VkImageSubresourceRange range	= { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+				ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+				vkCmdClearColorImage(commandBuffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &black, 1, &range);
+				ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				ImageLayout(commandBuffer, storageImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+			});
+
+			VkSamplerCreateInfo samplerInfo	= {};
+			samplerInfo.sType				= VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+			samplerInfo.magFilter			= VK_FILTER_LINEAR;
+			samplerInfo.minFilter			= VK_FILTER_LINEAR;
+			samplerInfo.maxLod				= VK_LOD_CLAMP_NONE;
+			return vkCreateSampler(context.device, &samplerInfo, nullptr, &context.dummySampler) == VK_SUCCESS;
+		}
+
+		inline bool IsRecording()
+		{
+			return !context.recorders.empty() && GetRecorder() != context.recorders.front().get();
+		}
+
+		template <typename T>
+		inline void SetSlots(T* slots, uint32_t slotCount, unsigned int startSlot, unsigned int count, void* const* values)
+		{
+			for (unsigned int i = 0; i < count && startSlot + i < slotCount; i++)
+			{
+				slots[startSlot + i] = values ? (T)values[i] : T();
+			}
+		}
+	}
+
+	RHI_Device::RHI_Device(void* drawHandle)
+	{
+		m_format				= Texture_Format_R8G8B8A8_UNORM;
+		m_depthEnabled			= true;
+		m_depthWriteEnabled		= true;
+		m_blendMode				= Blend_Disabled;
+		m_initialized			= false;
+		m_device				= nullptr;
+		m_deviceContext			= nullptr;
+
+		Settings::Get().m_versionVulkan = to_string(VK_API_VERSION_1_0);
+		LOG_INFO(Settings::Get().m_versionVulkan);
+
+		if (!drawHandle)
+		{
+			LOG_ERROR("Vulkan_Device::RHI_Device: Invalid draw handle.");
+			return;
+		}
+
+		// Validation layer
+		bool validationLayerAvailable = false;
+		if (Vulkan_Device::validationLayerEnabled)
+		{
+			validationLayerAvailable = Vulkan_Device::AcquireValidationLayers(Vulkan_Device::validationLayers);
+		}
+		
+		// Create instance
+		{
+			VkApplicationInfo appInfo	= {};
+			appInfo.sType				= VK_STRUCTURE_TYPE_APPLICATION_INFO;
+			appInfo.pApplicationName	= ENGINE_VERSION;
+			appInfo.applicationVersion	= VK_MAKE_VERSION(1, 0, 0);
+			appInfo.pEngineName			= ENGINE_VERSION;
+			appInfo.engineVersion		= VK_MAKE_VERSION(1, 0, 0);
+			appInfo.apiVersion			= VK_API_VERSION_1_1;
+
+			VkInstanceCreateInfo createInfo		= {};
+			createInfo.sType					= VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+			createInfo.pApplicationInfo			= &appInfo;
+			createInfo.enabledExtensionCount	= (uint32_t)Vulkan_Device::extensions.size();
+			createInfo.ppEnabledExtensionNames	= Vulkan_Device::extensions.data();
+			if (validationLayerAvailable) 
+			{
+				createInfo.enabledLayerCount	= (uint32_t)Vulkan_Device::validationLayers.size();
+				createInfo.ppEnabledLayerNames	= Vulkan_Device::validationLayers.data();
+			}
+			else 
+			{
+				createInfo.enabledLayerCount = 0;
+			}
+
+			auto result = vkCreateInstance(&createInfo, nullptr, &context.instance);
+			if (result != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create instance.");
+				return;
+			}
+		}
+
+		// Callback
+		if (validationLayerAvailable)
+		{
+			VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
+			createInfo.sType			= VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+			createInfo.messageSeverity	= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+			createInfo.messageType		= VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+			createInfo.pfnUserCallback	= Vulkan_Device::debugCallback;
+			createInfo.pUserData		= nullptr; // Optional
+
+			if (Vulkan_Device::CreateDebugUtilsMessengerEXT(context.instance, &createInfo, nullptr, &Vulkan_Device::callback) != VK_SUCCESS) 
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to setup callback");
+			}
+		}
+
+		// Surface
+		{
+			VkWin32SurfaceCreateInfoKHR createInfo	= {};
+			createInfo.sType						= VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
+			createInfo.hinstance					= GetModuleHandle(nullptr);
+			createInfo.hwnd							= (HWND)drawHandle;
+			if (vkCreateWin32SurfaceKHR(context.instance, &createInfo, nullptr, &context.surface) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create surface.");
+				return;
+			}
+		}
+
+		// Physical device, a discrete one if there is one
+		{
+			uint32_t deviceCount = 0;
+			vkEnumeratePhysicalDevices(context.instance, &deviceCount, nullptr);
+			vector<VkPhysicalDevice> devices(deviceCount);
+			vkEnumeratePhysicalDevices(context.instance, &deviceCount, devices.data());
+
+			for (auto discrete : { true, false })
+			{
+				for (auto device : devices)
+				{
+					if (!context.physicalDevice && Vulkan_Device::isDeviceSuitable(device, context.surface, discrete))
+					{
+						context.physicalDevice = device;
+					}
+				}
+			}
+
+			if (!context.physicalDevice)
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Couldn't find a device which can draw to the window.");
+				return;
+			}
+
+			vkGetPhysicalDeviceProperties(context.physicalDevice, &context.properties);
+			LOGF_INFO("Vulkan_Device::RHI_Device: %s", context.properties.deviceName);
+		}
+
+		// Logical device
+		VkQueue uploadQueue = VK_NULL_HANDLE;
+		{
+			context.queueFamily = (uint32_t)Vulkan_Device::GetQueueFamily(context.physicalDevice, context.surface);
+
+			// Uploads get a second queue of the same family if it has one and async compute a third, so resources never change hands between families
+			uint32_t familyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(context.physicalDevice, &familyCount, nullptr);
+			vector<VkQueueFamilyProperties> families(familyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(context.physicalDevice, &familyCount, families.data());
+			uint32_t queueCount = min(families[context.queueFamily].queueCount, 3u);
+
+			float priorities[]						= { 1.0f, 0.5f, 1.0f };
+			VkDeviceQueueCreateInfo queueInfo		= {};
+			queueInfo.sType							= VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+			queueInfo.queueFamilyIndex				= context.queueFamily;
+			queueInfo.queueCount					= queueCount;
+			queueInfo.pQueuePriorities				= priorities;
+
+			VkPhysicalDeviceFeatures supported;
+			vkGetPhysicalDeviceFeatures(context.physicalDevice, &supported);
+			VkPhysicalDeviceFeatures features		= {};
+			features.samplerAnisotropy				= supported.samplerAnisotropy;
+			features.fillModeNonSolid				= supported.fillModeNonSolid;
+			features.drawIndirectFirstInstance		= supported.drawIndirectFirstInstance;
+			Vulkan_Device::fillModeNonSolid			= supported.fillModeNonSolid == VK_TRUE;
+
+			// Negative viewport heights are core since 1.1
+			vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+			if (context.properties.apiVersion < VK_API_VERSION_1_1)
+			{
+				deviceExtensions.emplace_back(VK_KHR_MAINTENANCE1_EXTENSION_NAME);
+			}
+
+			VkDeviceCreateInfo createInfo		= {};
+			createInfo.sType					= VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+			createInfo.queueCreateInfoCount		= 1;
+			createInfo.pQueueCreateInfos		= &queueInfo;
+			createInfo.pEnabledFeatures			= &features;
+			createInfo.enabledExtensionCount	= (uint32_t)deviceExtensions.size();
+			createInfo.ppEnabledExtensionNames	= deviceExtensions.data();
+			if (vkCreateDevice(context.physicalDevice, &createInfo, nullptr, &context.device) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create device.");
+				return;
+			}
+
+			vkGetDeviceQueue(context.device, context.queueFamily, 0, &context.queue);
+			uploadQueue = context.queue;
+			if (queueCount > 1)
+			{
+				vkGetDeviceQueue(context.device, context.queueFamily, 1, &uploadQueue);
+			}
+			if (queueCount > 2)
+			{
+				vkGetDeviceQueue(context.device, context.queueFamily, 2, &context.computeQueue);
+			}
+			context.allocator.Initialize(context.device, context.physicalDevice);
+		}
+
+		// Frames in flight, the fences start signaled so the first frames don't wait
+		for (auto& frame : context.frames)
+		{
+			VkFenceCreateInfo fenceInfo			= {};
+			fenceInfo.sType						= VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			fenceInfo.flags						= VK_FENCE_CREATE_SIGNALED_BIT;
+			VkSemaphoreCreateInfo semaphoreInfo	= {};
+			semaphoreInfo.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			if (vkCreateFence(context.device, &fenceInfo, nullptr, &frame.fence) != VK_SUCCESS ||
+				vkCreateSemaphore(context.device, &semaphoreInfo, nullptr, &frame.imageAcquired) != VK_SUCCESS ||
+				vkCreateSemaphore(context.device, &semaphoreInfo, nullptr, &frame.renderFinished) != VK_SUCCESS ||
+				vkCreateSemaphore(context.device, &semaphoreInfo, nullptr, &frame.computeStart) != VK_SUCCESS ||
+				vkCreateSemaphore(context.device, &semaphoreInfo, nullptr, &frame.computeFinished) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create frame synchronization objects.");
+				return;
+			}
+		}
+
+		// Uploads and caches
+		{
+			VkPipelineCacheCreateInfo cacheInfo	= {};
+			cacheInfo.sType						= VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			if (!context.uploader.Initialize(uploadQueue, context.queueFamily) ||
+				vkCreatePipelineCache(context.device, &cacheInfo, nullptr, &context.pipelineCache) != VK_SUCCESS)
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create uploader and pipeline cache.");
+				return;
+			}
+
+			if (!Vulkan_Device::CreateDummies())
+			{
+				LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create default resources.");
+				return;
+			}
+		}
+
+		// Debug labels, only there with the debug utils extension
+		context.cmdBeginDebugLabel	= (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(context.instance, "vkCmdBeginDebugUtilsLabelEXT");
+		context.cmdEndDebugLabel	= (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(context.instance, "vkCmdEndDebugUtilsLabelEXT");
+
+		// Swapchain
+		if (!Vulkan_Device::Swapchain_Create(Settings::Get().Resolution_GetWidth(), Settings::Get().Resolution_GetHeight()))
+		{
+			LOG_ERROR("Vulkan_Device::RHI_Device: Failed to create swapchain.");
+			return;
+		}
+
+		// Immediate recorder
+		auto immediate = Vulkan_Device::Recorder_Create();
+		if (!immediate)
+			return;
+
+		// Async compute recorder, compute stays on the frame's queue if there is no spare queue (or recorder)
+		if (context.computeQueue)
+		{
+			context.computeRecorder = Vulkan_Device::Recorder_Create();
+			if (!context.computeRecorder)
+			{
+				context.computeQueue = VK_NULL_HANDLE;
+			}
+		}
+		LOGF_INFO("Vulkan_Device::RHI_Device: Async compute is %s", context.computeQueue ? "enabled" : "not available");
+
+		m_viewport = RHI_Viewport((float)Settings::Get().Resolution_GetWidth(), (float)Settings::Get().Resolution_GetHeight());
+		immediate->Reset(m_depthReverse);
+		immediate->viewport	= Vulkan_Device::ToVkViewport(m_viewport);
+		immediate->id		= ++context.commandListSerial;
+		Vulkan_Device::Frame_Begin();
+
+		m_device		= (void*)context.device;
+		m_deviceContext	= (void*)immediate;
+		m_initialized	= true;
+	}
+
+	RHI_Device::~RHI_Device()
+	{
+		if (context.device)
+		{
+			vkDeviceWaitIdle(context.device);
+
+			// Everything is idle, releases don't have to wait for their frames
+			Vulkan_Device::Swapchain_DestroyTargets();
+			Image_Destroy(context.dummyImage.get());
+			Image_Destroy(context.dummyStorageImage.get());
+			Buffer_Destroy(context.dummyBuffer.get());
+			for (auto& frame : context.frames)
+			{
+				Vulkan_Device::RunReleases(frame);
+			}
+			context.dummyImage.reset();
+			context.dummyStorageImage.reset();
+			context.dummyBuffer.reset();
+
+			Vulkan_Device::DestroyCaches();
+			for (auto& recorder : context.recorders)
+			{
+				Vulkan_Device::Recorder_Destroy(recorder.get());
+			}
+			context.recorders.clear();
+			context.recordersFree.clear();
+			context.computeRecorder = nullptr;
+
+			for (auto& frame : context.frames)
+			{
+				vkDestroyFence(context.device, frame.fence, nullptr);
+				vkDestroySemaphore(context.device, frame.imageAcquired, nullptr);
+				vkDestroySemaphore(context.device, frame.renderFinished, nullptr);
+				vkDestroySemaphore(context.device, frame.computeStart, nullptr);
+				vkDestroySemaphore(context.device, frame.computeFinished, nullptr);
+			}
+			vkDestroySampler(context.device, context.dummySampler, nullptr);
+			vkDestroyDescriptorSetLayout(context.device, context.emptySetLayout, nullptr);
+			vkDestroyPipelineCache(context.device, context.pipelineCache, nullptr);
+			context.uploader.Shutdown();
+			vkDestroySwapchainKHR(context.device, context.swapchain, nullptr);
+			context.allocator.Shutdown();
+			vkDestroyDevice(context.device, nullptr);
+			context.device = VK_NULL_HANDLE;
+		}
+
+		if (context.instance)
+		{
+			vkDestroySurfaceKHR(context.instance, context.surface, nullptr);
+			if (Vulkan_Device::callback)
+			{
+				Vulkan_Device::DestroyDebugUtilsMessengerEXT(context.instance, Vulkan_Device::callback, nullptr);
+			}
+			vkDestroyInstance(context.instance, nullptr);
+			context.instance = VK_NULL_HANDLE;
+		}
+	}
+
+	void RHI_Device::Draw(unsigned int vertexCount, unsigned int vertexOffset /*= 0*/)
+	{
+		RHI_CAPTURE(Record(Capture_Draw, { vertexCount, vertexOffset }));
+
+		auto recorder = GetRecorder();
+		if (!recorder || !Vulkan_Device::FlushGraphics(recorder, false))
+			return;
+
+		vkCmdDraw(recorder->commandBuffer, vertexCount, 1, vertexOffset, 0);
+		Profiler::Get().m_rhiDrawCalls++;
+	}
+
+	void RHI_Device::DrawIndexed(unsigned int indexCount, unsigned int indexOffset, unsigned int vertexOffset)
+	{
+		RHI_CAPTURE(Record(Capture_DrawIndexed, { indexCount, indexOffset, vertexOffset }));
+
+		auto recorder = GetRecorder();
+		if (!recorder || !Vulkan_Device::FlushGraphics(recorder, true))
+			return;
+
+		vkCmdDrawIndexed(recorder->commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+		Profiler::Get().m_rhiDrawCalls++;
+	}
+
+	void RHI_Device::DrawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount, unsigned int indexOffset, unsigned int vertexOffset)
+	{
+		RHI_CAPTURE(Record(Capture_DrawIndexedInstanced, { indexCount, instanceCount, indexOffset, vertexOffset }));
+
+		auto recorder = GetRecorder();
+		if (!recorder || !Vulkan_Device::FlushGraphics(recorder, true))
+			return;
+
+		vkCmdDrawIndexed(recorder->commandBuffer, indexCount, instanceCount, indexOffset, vertexOffset, 0);
+		Profiler::Get().m_rhiDrawCalls++;
+	}
+
+	void RHI_Device::DrawIndexedInstancedIndirect(void* argumentsBuffer, unsigned int argumentsOffset)
+	{
+		RHI_CAPTURE(Record(Capture_DrawIndexedInstancedIndirect, { argumentsOffset }, { argumentsBuffer }));
+
+		auto recorder = GetRecorder();
+		if (!recorder || !argumentsBuffer || !Vulkan_Device::FlushGraphics(recorder, true))
+			return;
+
+		// Same layout as D3D11's, five 32 bit arguments
+		auto buffer = Buffer_Resolve(recorder, (Buffer*)argumentsBuffer);
+		vkCmdDrawIndexedIndirect(recorder->commandBuffer, buffer, argumentsOffset, 1, sizeof(uint32_t) * 5);
+		Profiler::Get().m_rhiDrawCalls++;
+	}
+
+	void RHI_Device::Dispatch(unsigned int threadGroupCountX, unsigned int threadGroupCountY, unsigned int threadGroupCountZ)
+	{
+		RHI_CAPTURE(Record(Capture_Dispatch, { threadGroupCountX, threadGroupCountY, threadGroupCountZ }));
+
+		auto recorder = GetRecorder();
+		if (!recorder || !Vulkan_Device::FlushCompute(recorder))
+			return;
+
+		vkCmdDispatch(recorder->commandBuffer, threadGroupCountX, threadGroupCountY, threadGroupCountZ);
+	}
+
+	void RHI_Device::ClearBackBuffer(const Vector4& color)
+	{
+		RHI_CAPTURE(Record(Capture_ClearBackBuffer, { RHI_Capture::Bits(color.x), RHI_Capture::Bits(color.y), RHI_Capture::Bits(color.z), RHI_Capture::Bits(color.w) }));
+
+		if (!context.device || !context.backBufferAcquired)
+			return;
+
+		VkClearColorValue value;
+		memcpy(value.float32, color.Data(), sizeof(float) * 4);
+		Vulkan_Device::ClearImage(GetRecorder(), context.backBuffers[context.backBufferIndex].get(), &value, 0.0f, 0, VK_IMAGE_ASPECT_COLOR_BIT); // back buffer
+		if (m_depthEnabled)
+		{
+			Vulkan_Device::ClearImage(GetRecorder(), context.backBufferDepth.get(), nullptr, Get_DepthFar(m_viewport), 0, VK_IMAGE_ASPECT_DEPTH_BIT); // depth buffer
+		}
+	}
+
+	void RHI_Device::ClearRenderTarget(void* renderTarget, const Math::Vector4& color)
+	{
+		RHI_CAPTURE(Record(Capture_ClearRenderTarget, { RHI_Capture::Bits(color.x), RHI_Capture::Bits(color.y), RHI_Capture::Bits(color.z), RHI_Capture::Bits(color.w) }, { renderTarget }));
+
+		if (!context.device)
+			return;
+
+		VkClearColorValue value;
+		memcpy(value.float32, color.Data(), sizeof(float) * 4);
+		Vulkan_Device::ClearImage(GetRecorder(), (Image*)renderTarget, &value, 0.0f, 0, VK_IMAGE_ASPECT_COLOR_BIT);
+	}
+
+	void RHI_Device::ClearDepthStencil(void* depthStencil, unsigned int flags, float depth, uint8_t stencil)
+	{
+		RHI_CAPTURE(Record(Capture_ClearDepthStencil, { flags, RHI_Capture::Bits(depth), stencil }, { depthStencil }));
+
+		auto image = (Image*)depthStencil;
+		if (!context.device || !image)
+			return;
+
+		VkImageAspectFlags aspect = 0;
+		aspect |= flags & Clear_Depth ? VK_IMAGE_ASPECT_DEPTH_BIT : 0;
+		aspect |= flags & Clear_Stencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0;
+		Vulkan_Device::ClearImage(GetRecorder(), image, nullptr, depth, stencil, aspect & image->aspect);
+	}
+
+	void RHI_Device::Present()
+	{
+		if (!context.swapchain)
+			return;
+
+		Vulkan_Device::Frame_Submit(true);
+		Vulkan_Device::Frame_Begin();
+	}
+
+	void RHI_Device::Present_Wait()
+	{
+		// Frame_Begin already waits for the frame's fence, there is no waitable swap chain to wait on
+	}
+
+	void RHI_Device::Set_BackBufferAsRenderTarget()
+	{
+		RHI_CAPTURE(Record(Capture_SetBackBufferAsRenderTarget));
+
+		auto recorder = GetRecorder();
+		if (!recorder || !context.backBufferAcquired)
+			return;
+
+		recorder->renderTargets[0]		= context.backBuffers[context.backBufferIndex].get();
+		recorder->renderTargetCount		= 1;
+		recorder->depthStencil			= m_depthEnabled ? context.backBufferDepth.get() : nullptr;
+		recorder->renderTargetsDirty	= true;
+	}
+
+	void RHI_Device::Set_VertexShader(void* buffer)
+	{
+		RHI_CAPTURE(Record(Capture_SetVertexShader, {}, { buffer }));
+
+		if (auto recorder = GetRecorder())
+		{
+			recorder->vertexShader = (Shader*)buffer;
+		}
+	}
+
+	void RHI_Device::Set_PixelShader(void* buffer)
+	{
+		RHI_CAPTURE(Record(Capture_SetPixelShader, {}, { buffer }));
+
+		if (auto recorder = GetRecorder())
+		{
+			recorder->pixelShader = (Shader*)buffer;
+		}
+	}
+
+	void RHI_Device::Set_ConstantBuffers(unsigned int startSlot, unsigned int bufferCount, Buffer_Scope scope, void* const* buffer)
+	{
+		RHI_CAPTURE(Record(Capture_SetConstantBuffers, { startSlot, bufferCount, (uint32_t)scope }, buffer, bufferCount));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+			return;
+
+		for (unsigned int i = 0; i < bufferCount && startSlot + i < slot_count_b; i++)
+		{
+			BufferBinding binding;
+			binding.buffer = buffer ? (Buffer*)buffer[i] : nullptr;
+
+			if (scope == Buffer_VertexShader || scope == Buffer_Global)
+			{
+				recorder->stages[Stage_Vertex].constantBuffers[startSlot + i] = binding;
+			}
+
+			if (scope == Buffer_PixelShader || scope == Buffer_Global)
+			{
+				recorder->stages[Stage_Pixel].constantBuffers[startSlot + i] = binding;
+			}
+
+			if (scope == Buffer_ComputeShader)
+			{
+				recorder->stages[Stage_Compute].constantBuffers[startSlot + i] = binding;
+			}
+		}
+	}
+
+	void RHI_Device::Set_ConstantBufferRange(unsigned int slot, Buffer_Scope scope, void* buffer, unsigned int firstConstant, unsigned int constantCount)
+	{
+		RHI_CAPTURE(Record(Capture_SetConstantBufferRange, { slot, (uint32_t)scope, firstConstant, constantCount }, { buffer }));
+
+		auto recorder = GetRecorder();
+		if (!recorder || slot >= slot_count_b)
+			return;
+
+		// The window becomes a dynamic offset, constants are 16 bytes
+		BufferBinding binding;
+		binding.buffer	= (Buffer*)buffer;
+		binding.offset	= (VkDeviceSize)firstConstant * 16;
+		binding.range	= (VkDeviceSize)constantCount * 16;
+
+		if (scope == Buffer_VertexShader || scope == Buffer_Global)
+		{
+			recorder->stages[Stage_Vertex].constantBuffers[slot] = binding;
+		}
+
+		if (scope == Buffer_PixelShader || scope == Buffer_Global)
+		{
+			recorder->stages[Stage_Pixel].constantBuffers[slot] = binding;
+		}
+	}
+
+	void RHI_Device::Set_Samplers(unsigned int startSlot, unsigned int samplerCount, void* const* samplers)
+	{
+		RHI_CAPTURE(Record(Capture_SetSamplers, { startSlot, samplerCount }, samplers, samplerCount));
+
+		if (auto recorder = GetRecorder())
+		{
+			Vulkan_Device::SetSlots(recorder->stages[Stage_Pixel].samplers, slot_count_s, startSlot, samplerCount, samplers);
+		}
+	}
+
+	void RHI_Device::Set_RenderTargets(unsigned int renderTargetCount, void* const* renderTargets, void* depthStencil)
+	{
+		RHI_CAPTURE(Record_RenderTargets(renderTargetCount, renderTargets, depthStencil));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+			return;
+
+		recorder->renderTargetCount = min(renderTargetCount, 8u);
+		Vulkan_Device::SetSlots(recorder->renderTargets, 8, 0, recorder->renderTargetCount, renderTargets);
+		recorder->depthStencil			= (Image*)depthStencil;
+		recorder->renderTargetsDirty	= true;
+	}
+
+	void RHI_Device::Set_Textures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources)
+	{
+		RHI_CAPTURE(Record(Capture_SetTextures, { startSlot, resourceCount }, shaderResources, resourceCount));
+
+		if (auto recorder = GetRecorder())
+		{
+			Vulkan_Device::SetSlots(recorder->stages[Stage_Pixel].textures, slot_count_t, startSlot, resourceCount, shaderResources);
+		}
+	}
+
+	void RHI_Device::Set_VertexTextures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources)
+	{
+		RHI_CAPTURE(Record(Capture_SetVertexTextures, { startSlot, resourceCount }, shaderResources, resourceCount));
+
+		if (auto recorder = GetRecorder())
+		{
+			Vulkan_Device::SetSlots(recorder->stages[Stage_Vertex].textures, slot_count_t, startSlot, resourceCount, shaderResources);
+		}
+	}
+
+	void RHI_Device::Set_ComputeShader(void* buffer)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeShader, {}, { buffer }));
+
+		if (auto recorder = GetRecorder())
+		{
+			recorder->computeShader = (Shader*)buffer;
+		}
+	}
+
+	void RHI_Device::Set_ComputeSamplers(unsigned int startSlot, unsigned int samplerCount, void* const* samplers)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeSamplers, { startSlot, samplerCount }, samplers, samplerCount));
+
+		if (auto recorder = GetRecorder())
+		{
+			Vulkan_Device::SetSlots(recorder->stages[Stage_Compute].samplers, slot_count_s, startSlot, samplerCount, samplers);
+		}
+	}
+
+	void RHI_Device::Set_ComputeTextures(unsigned int startSlot, unsigned int resourceCount, void* const* shaderResources)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeTextures, { startSlot, resourceCount }, shaderResources, resourceCount));
+
+		if (auto recorder = GetRecorder())
+		{
+			Vulkan_Device::SetSlots(recorder->stages[Stage_Compute].textures, slot_count_t, startSlot, resourceCount, shaderResources);
+		}
+	}
+
+	void RHI_Device::Set_ComputeUnorderedAccessViews(unsigned int startSlot, unsigned int viewCount, void* const* unorderedAccessViews)
+	{
+		RHI_CAPTURE(Record(Capture_SetComputeUnorderedAccessViews, { startSlot, viewCount }, unorderedAccessViews, viewCount));
+
+		if (auto recorder = GetRecorder())
+		{
+			Vulkan_Device::SetSlots(recorder->stages[Stage_Compute].unorderedAccess, slot_count_u, startSlot, viewCount, unorderedAccessViews);
+		}
+	}
+
+	bool RHI_Device::Set_Resolution(unsigned int width, unsigned int height)
+	{
+		if (width == 0 || height == 0)
+		{
+			LOGF_ERROR("RHI_Device::SetResolution: Resolution %dx%d is invalid", width, height);
+			return false;
+		}
+
+		if (!context.swapchain)
+		{
+			LOG_ERROR("RHI_Device::SetResolution: Invalid swapchain");
+			return false;
+		}
+
+		// Finish the frame without presenting and wait for the GPU, the back buffers are about to go
+		Vulkan_Device::Frame_Submit(false);
+		vkDeviceWaitIdle(context.device);
+		Vulkan_Device::Swapchain_DestroyTargets();
+		for (auto& frame : context.frames)
+		{
+			Vulkan_Device::RunReleases(frame);
+		}
+
+		// Whatever pointed at the old back buffers
+		auto immediate = context.recorders.front().get();
+		immediate->renderTargetCount	= 0;
+		immediate->depthStencil			= nullptr;
+
+		auto result = Vulkan_Device::Swapchain_Create(width, height);
+		if (!result)
+		{
+			LOG_ERROR("RHI_Device::SetResolution: Failed to create swapchain");
+		}
+		Vulkan_Device::Frame_Begin();
+
+		return result;
+	}
+
+	void RHI_Device::Set_Viewport(const RHI_Viewport& viewport)
+	{
+		RHI_CAPTURE(Record(Capture_SetViewport, { RHI_Capture::Bits(viewport.GetTopLeftX()), RHI_Capture::Bits(viewport.GetTopLeftY()), RHI_Capture::Bits(viewport.GetWidth()), RHI_Capture::Bits(viewport.GetHeight()), RHI_Capture::Bits(viewport.GetMinDepth()), RHI_Capture::Bits(viewport.GetMaxDepth()) }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+			return;
+
+		recorder->viewport		= Vulkan_Device::ToVkViewport(viewport);
+		recorder->viewportDirty	= true;
+
+		// Recording threads don't touch the device's state, it belongs to the immediate recorder
+		if (!Vulkan_Device::IsRecording())
+		{
+			m_viewport = viewport;
+		}
+	}
+
+	bool RHI_Device::Set_DepthEnabled(bool enable, bool write /*= true*/)
+	{
+		RHI_CAPTURE(Record(Capture_SetDepthEnabled, { enable, write }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+		{
+			LOG_WARNING("Vulkan_Device::Set_DepthEnabled: Device is uninitialized.");
+			return false;
+		}
+
+		recorder->depthEnabled	= enable;
+		recorder->depthWrite	= write;
+		recorder->depthReverse	= m_depthReverse;
+
+		if (!Vulkan_Device::IsRecording())
+		{
+			m_depthEnabled		= enable;
+			m_depthWriteEnabled	= write;
+			m_depthReverseBound	= m_depthReverse;
+		}
+
+		return true;
+	}
+
+	bool RHI_Device::Set_BlendMode(Blend_Mode blendMode)
+	{
+		RHI_CAPTURE(Record(Capture_SetBlendMode, { (uint32_t)blendMode }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+		{
+			LOG_WARNING("Vulkan_Device::Set_BlendMode: Device is uninitialized.");
+			return false;
+		}
+
+		recorder->blendMode = blendMode;
+		if (!Vulkan_Device::IsRecording())
+		{
+			m_blendMode = blendMode;
+		}
+
+		return true;
+	}
+
+	void RHI_Device::EventBegin(const std::string& name)
+	{
+		RHI_CAPTURE(Record_Event(name));
+
+		// Like D3D11, events belong to the immediate recorder
+		if (!context.cmdBeginDebugLabel || Vulkan_Device::IsRecording())
+			return;
+
+		auto recorder = GetRecorder();
+		if (!recorder || !recorder->commandBuffer)
+			return;
+
+		VkDebugUtilsLabelEXT label	= {};
+		label.sType					= VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+		label.pLabelName			= name.c_str();
+		context.cmdBeginDebugLabel(recorder->commandBuffer, &label);
+	}
+
+	void RHI_Device::EventEnd()
+	{
+		RHI_CAPTURE(Record(Capture_EventEnd));
+
+		if (!context.cmdEndDebugLabel || Vulkan_Device::IsRecording())
+			return;
+
+		auto recorder = GetRecorder();
+		if (!recorder || !recorder->commandBuffer)
+			return;
+
+		context.cmdEndDebugLabel(recorder->commandBuffer);
+	}
+
+	bool RHI_Device::Memory_GetBudget(unsigned long long* budget, unsigned long long* usage)
+	{
+		// No budget without VK_EXT_memory_budget, the heap is as much as the process could ever get
+		auto heapSize = context.allocator.GetDeviceLocalBytes();
+		if (heapSize == 0)
+			return false;
+
+		if (budget) *budget	= heapSize;
+		if (usage)	*usage	= context.allocator.GetUsedBytes();
+		return true;
+	}
+
+	bool RHI_Device::Profiling_CreateQuery(void** query, Query_Type type)
+	{
+		if (!context.device)
+			return false;
+
+		auto vkQuery	= new Query();
+		vkQuery->type	= type;
+		if (type == Query_Timestamp)
+		{
+			VkQueryPoolCreateInfo createInfo	= {};
+			createInfo.sType					= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			createInfo.queryType				= VK_QUERY_TYPE_TIMESTAMP;
+			createInfo.queryCount				= frames_in_flight;
+			if (vkCreateQueryPool(context.device, &createInfo, nullptr, &vkQuery->pool) != VK_SUCCESS)
+			{
+				LOG_ERROR("Failed to create VkQueryPool");
+				delete vkQuery;
+				return false;
+			}
+		}
+
+		*query = (void*)vkQuery;
+		return true;
+	}
+
+	void RHI_Device::Profiling_QueryStart(void* queryObject)
+	{
+		// Vulkan timestamps are never disjoint, the disjoint query only holds the last duration
+	}
+
+	void RHI_Device::Profiling_QueryEnd(void* queryObject)
+	{
+
+	}
+
+	void RHI_Device::Profiling_GetTimeStamp(void* queryObject)
+	{
+		auto query = (Query*)queryObject;
+		if (!context.device || !query || !query->pool)
+			return;
+
+		// Queries can't be reset inside a render pass
+		auto immediate	= context.recorders.front().get();
+		auto slot		= context.GetFrameSlot();
+		Vulkan_Device::RenderPass_End(immediate);
+		vkCmdResetQueryPool(immediate->commandBuffer, query->pool, slot, 1);
+		vkCmdWriteTimestamp(immediate->commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query->pool, slot);
+		query->frames[slot] = context.frameIndex;
+	}
+
+	float RHI_Device::Profiling_GetDuration(void* queryDisjoint, void* queryStart, void* queryEnd)
+	{
+		auto disjoint	= (Query*)queryDisjoint;
+		auto start		= (Query*)queryStart;
+		auto end		= (Query*)queryEnd;
+		if (!context.device || !disjoint || !start || !end || !start->pool || !end->pool)
+			return 0.0f;
+
+		// The latest submitted frame the GPU is done with, until there is a newer one the last duration stands
+		uint64_t latest = 0;
+		for (uint32_t slot = 0; slot < frames_in_flight; slot++)
+		{
+			auto frame = start->frames[slot];
+			if (frame == 0 || frame != end->frames[slot] || frame >= context.frameIndex || frame <= latest)
+				continue;
+
+			uint64_t startTime	= 0;
+			uint64_t endTime	= 0;
+			if (vkGetQueryPoolResults(context.device, start->pool, slot, 1, sizeof(startTime), &startTime, sizeof(startTime), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS ||
+				vkGetQueryPoolResults(context.device, end->pool, slot, 1, sizeof(endTime), &endTime, sizeof(endTime), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+				continue;
+
+			// Compute delta in milliseconds
+			latest				= frame;
+			disjoint->duration	= (float)((endTime - startTime) * (double)context.properties.limits.timestampPeriod / 1000000.0);
+		}
+
+		return disjoint->duration;
+	}
+
+	bool RHI_Device::CommandList_Begin()
+	{
+		if (!context.device)
+			return false;
+
+		if (Vulkan_Device::IsRecording())
+		{
+			LOG_WARNING("RHI_Device::CommandList_Begin: The calling thread is already recording");
+			return false;
+		}
+
+		// Acquire a free recorder, or create one
+		Recorder* recorder = nullptr;
+		{
+			lock_guard<mutex> lock(context.recordersMutex);
+			if (!context.recordersFree.empty())
+			{
+				recorder = context.recordersFree.back();
+				context.recordersFree.pop_back();
+			}
+		}
+		if (!recorder)
+		{
+			recorder = Vulkan_Device::Recorder_Create();
+			if (!recorder)
+				return false;
+		}
+
+		// Command lists start from the default pipeline state, like D3D11's deferred contexts
+		recorder->Reset(m_depthReverse);
+		recorder->viewport	= Vulkan_Device::ToVkViewport(m_viewport);
+		recorder->id		= ++context.commandListSerial;
+		if (!Vulkan_Device::Recorder_Begin(recorder))
+		{
+			lock_guard<mutex> lock(context.recordersMutex);
+			context.recordersFree.emplace_back(recorder);
+			return false;
+		}
+
+		SetThreadRecorder(recorder);
+		RHI_CAPTURE(CommandList_Begin());
+		return true;
+	}
+
+	void* RHI_Device::CommandList_End()
+	{
+		if (!Vulkan_Device::IsRecording())
+		{
+			LOG_WARNING("RHI_Device::CommandList_End: The calling thread is not recording");
+			return nullptr;
+		}
+		auto recorder = GetRecorder();
+		SetThreadRecorder(nullptr);
+
+		auto commandBuffer = Vulkan_Device::Recorder_End(recorder);
+
+		// Return the recorder to the pool, its command buffer lives until its frame comes around again
+		lock_guard<mutex> lock(context.recordersMutex);
+		context.recordersFree.emplace_back(recorder);
+
+		RHI_CAPTURE(CommandList_End((void*)commandBuffer));
+		return (void*)commandBuffer;
+	}
+
+	void RHI_Device::CommandList_Execute(void* commandList)
+	{
+		RHI_CAPTURE(CommandList_Execute(commandList));
+
+		if (!context.device || !commandList)
+			return;
+
+		// Split the immediate command buffer around the list, so everything is submitted in the order it was executed
+		auto immediate = context.recorders.front().get();
+		context.submissions.emplace_back(Vulkan_Device::Recorder_End(immediate));
+		context.submissions.emplace_back((VkCommandBuffer)commandList);
+		Vulkan_Device::Recorder_Begin(immediate);
+
+		// The list may have renamed buffers the immediate recorder was appending to
+		immediate->versions.clear();
+		immediate->id = ++context.commandListSerial;
+	}
+
+	void RHI_Device::Compute_Begin()
+	{
+		RHI_CAPTURE(Record(Capture_ComputeBegin));
+
+		// One section per frame, recorded by the thread which records the frame
+		if (!context.computeQueue || context.computeRecording || !context.computeSubmissions.empty() || Vulkan_Device::IsRecording())
+			return;
+
+		// Split the immediate command buffer, what was executed so far is what the section waits for
+		auto immediate = context.recorders.front().get();
+		context.submissions.emplace_back(Vulkan_Device::Recorder_End(immediate));
+		Vulkan_Device::Recorder_Begin(immediate);
+		context.computeFork = context.submissions.size();
+
+		auto recorder = context.computeRecorder;
+		recorder->Reset(m_depthReverse);
+		recorder->versions.clear();
+		recorder->id = ++context.commandListSerial;
+		if (!Vulkan_Device::Recorder_Begin(recorder))
+			return;
+
+		SetThreadRecorder(recorder);
+		context.computeRecording = true;
+	}
+
+	void RHI_Device::Compute_End()
+	{
+		RHI_CAPTURE(Record(Capture_ComputeEnd));
+
+		if (!context.computeRecording || GetRecorder() != context.computeRecorder)
+			return;
+
+		SetThreadRecorder(nullptr);
+		context.computeSubmissions.emplace_back(Vulkan_Device::Recorder_End(context.computeRecorder));
+		context.computeRecording = false;
+	}
+
+	void RHI_Device::Compute_Wait()
+	{
+		RHI_CAPTURE(Record(Capture_ComputeWait));
+
+		if (context.computeSubmissions.empty() || context.computeJoined)
+			return;
+
+		// Split the immediate command buffer again, everything after waits for the section
+		auto immediate = context.recorders.front().get();
+		context.submissions.emplace_back(Vulkan_Device::Recorder_End(immediate));
+		Vulkan_Device::Recorder_Begin(immediate);
+		context.computeJoin		= context.submissions.size();
+		context.computeJoined	= true;
+	}
+
+	bool RHI_Device::Compute_IsAsync()
+	{
+		return context.computeQueue != VK_NULL_HANDLE;
+	}
+
+	bool RHI_Device::CommandList_IsRecording()
+	{
+		return Vulkan_Device::IsRecording();
+	}
+
+	unsigned long long RHI_Device::CommandList_GetID()
+	{
+		auto recorder = GetRecorder();
+		return recorder ? recorder->id : 0;
+	}
+
+	bool RHI_Device::IsConstantBufferOffsettingSupported()
+	{
+		// Uniform buffers are bound with dynamic offsets
+		return true;
+	}
+
+	void* RHI_Device::GetDeviceContextCurrent()
+	{
+		return (void*)GetRecorder();
+	}
+
+	bool RHI_Device::Set_PrimitiveTopology(PrimitiveTopology_Mode primitiveTopology)
+	{
+		RHI_CAPTURE(Record(Capture_SetPrimitiveTopology, { (uint32_t)primitiveTopology }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+		{
+			LOG_ERROR("Vulkan_Device::Set_PrimitiveTopology: Invalid device");
+			return false;
+		}
+
+		recorder->topology = primitiveTopology;
+		return true;
+	}
+
+	bool RHI_Device::Set_FillMode(Fill_Mode fillMode)
+	{
+		RHI_CAPTURE(Record(Capture_SetFillMode, { (uint32_t)fillMode }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+		{
+			LOG_ERROR("Vulkan_Device::Set_FillMode: Invalid device");
+			return false;
+		}
+
+		recorder->fillMode = fillMode;
+		return true;
+	}
+
+	bool RHI_Device::Set_InputLayout(void* inputLayout)
+	{
+		RHI_CAPTURE(Record(Capture_SetInputLayout, {}, { inputLayout }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+		{
+			LOG_ERROR("Vulkan_Device::Set_InputLayout: Invalid device");
+			return false;
+		}
+
+		recorder->inputLayout = (InputLayout*)inputLayout;
+		return true;
+	}
 
 	bool RHI_Device::Set_CullMode(Cull_Mode cullMode)
 	{
+		RHI_CAPTURE(Record(Capture_SetCullMode, { (uint32_t)cullMode }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+		{
+			LOG_WARNING("Vulkan_Device::Set_CullMode: Device is uninitialized.");
+			return false;
+		}
+
+		recorder->cullMode = cullMode;
+		return true;
+	}
+
+	bool RHI_Device::Set_ScissorEnabled(bool enabled)
+	{
+		RHI_CAPTURE(Record(Capture_SetScissorEnabled, { enabled }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+		{
+			LOG_WARNING("Vulkan_Device::Set_ScissorEnabled: Device is uninitialized.");
+			return false;
+		}
+
+		recorder->scissorEnabled	= enabled;
+		recorder->scissorDirty		= true;
 		return true;
 	}
-}
 
-#endif
\ No newline at end of file
+	void RHI_Device::Set_ScissorRectangle(int left, int top, int right, int bottom)
+	{
+		RHI_CAPTURE(Record(Capture_SetScissorRectangle, { (uint32_t)left, (uint32_t)top, (uint32_t)right, (uint32_t)bottom }));
+
+		auto recorder = GetRecorder();
+		if (!recorder)
+			return;
+
+		recorder->scissor		= { { left, top }, { (uint32_t)max(right - left, 0), (uint32_t)max(bottom - top, 0) } };
+		recorder->scissorDirty	= true;
+	}
+}
+#endif
@@ -0,0 +1,178 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =====================
+#include "Vulkan_Common.h"
+#include "../RHI_Device.h"
+#include "../RHI_IndexBuffer.h"
+#include "../RHI_Capture.h"
+#include "../../Logging/Log.h"
+//================================
+
+//= NAMESPACES ===================
+using namespace std;
+using namespace Directus::Vulkan_Common;
+//================================
+
+namespace Directus
+{
+	RHI_IndexBuffer::RHI_IndexBuffer(std::shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice		= rhiDevice;
+		m_buffer		= nullptr;
+		m_memoryUsage	= 0;
+	}
+
+	RHI_IndexBuffer::~RHI_IndexBuffer()
+	{
+		if (auto buffer = (Buffer*)m_buffer)
+		{
+			Buffer_Destroy(buffer);
+			delete buffer;
+		}
+	}
+
+	bool RHI_IndexBuffer::Create(const vector<unsigned int>& indices, Index_Format format /*= Index_Format_UInt32*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_IndexBuffer::Create: Invalid RHI device");
+			return false;
+		}
+
+		if (indices.empty())
+		{
+			LOG_ERROR("RHI_IndexBuffer::Create: Invalid parameter");
+			return false;
+		}
+
+		if (format == Index_Format_UInt16 && GetFormat(indices) != Index_Format_UInt16)
+		{
+			LOG_ERROR("RHI_IndexBuffer::Create: Indices don't fit in 16 bits");
+			return false;
+		}
+
+		vector<uint16_t> indices16;
+		if (format == Index_Format_UInt16)
+		{
+			indices16 = vector<uint16_t>(indices.begin(), indices.end());
+		}
+
+		m_format		= format;
+		m_memoryUsage	= (unsigned int)((format == Index_Format_UInt16 ? sizeof(uint16_t) : sizeof(unsigned int)) * indices.size());
+		auto buffer		= new Buffer();
+		auto data		= format == Index_Format_UInt16 ? (const void*)indices16.data() : (const void*)indices.data();
+		if (!Buffer_Create(buffer, m_memoryUsage, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, false, data))
+		{
+			LOG_ERROR("RHI_IndexBuffer::Create: Failed to create index buffer");
+			delete buffer;
+			return false;
+		}
+
+		m_buffer = (void*)buffer;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_IndexBuffer::CreateDynamic(unsigned int initialSize)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_IndexBuffer::CreateDynamic: Invalid RHI device");
+			return false;
+		}
+
+		m_format		= Index_Format_UInt32;
+		m_memoryUsage	= sizeof(unsigned int) * initialSize;
+		auto buffer		= new Buffer();
+		if (!Buffer_Create(buffer, m_memoryUsage, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, true))
+		{
+			LOG_ERROR("RHI_IndexBuffer::CreateDynamic: Failed to create dynamic index buffer");
+			delete buffer;
+			return false;
+		}
+
+		m_buffer = (void*)buffer;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, m_memoryUsage);
+		return true;
+	}
+
+	void* RHI_IndexBuffer::Map(bool discard /*= true*/)
+	{
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_IndexBuffer::Map: Invalid buffer.");
+			return nullptr;
+		}
+
+		auto data = Buffer_Map((Buffer*)m_buffer, discard);
+		if (!data)
+		{
+			LOG_ERROR("RHI_IndexBuffer::Map: Failed to map index buffer.");
+		}
+
+		RHI_CAPTURE(Record_Map(Capture_UpdateIndexBuffer, this, m_buffer, data, m_memoryUsage, discard));
+		return data;
+	}
+
+	bool RHI_IndexBuffer::Unmap()
+	{
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_IndexBuffer::Unmap: Invalid buffer");
+			return false;
+		}
+		RHI_CAPTURE(Record_Unmap(this));
+
+		// Host coherent memory, the writes are visible to the next submission
+		return true;
+	}
+
+	bool RHI_IndexBuffer::Bind()
+	{
+		RHI_CAPTURE(Record(Capture_BindIndexBuffer, {}, { this }));
+
+		auto recorder = m_rhiDevice ? RHI_Backend::GetContext() : nullptr;
+		if (!recorder)
+		{
+			LOG_ERROR("RHI_IndexBuffer::Bind: Invalid device context");
+			return false;
+		}
+
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_IndexBuffer::Bind: Invalid buffer");
+			return false;
+		}
+
+		recorder->indexBuffer.buffer	= (Buffer*)m_buffer;
+		recorder->indexBuffer.offset	= 0;
+		recorder->indexType				= m_format == Index_Format_UInt16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		recorder->indexBufferBound		= VK_NULL_HANDLE;
+		return true;
+	}
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =====================
+#include "Vulkan_Common.h"
+#include "../RHI_InputLayout.h"
+#include "../RHI_Device.h"
+#include "../../Logging/Log.h"
+//================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Vulkan_Common;
+//=============================
+
+namespace Directus
+{
+	namespace Vulkan_InputLayout
+	{
+		// Locations follow the order the semantics are declared in the shaders, all in one interleaved binding
+		inline void AddAttribute(InputLayout* layout, VkFormat format, uint32_t size)
+		{
+			VkVertexInputAttributeDescription attribute	= {};
+			attribute.location	= (uint32_t)layout->attributes.size();
+			attribute.binding	= 0;
+			attribute.format	= format;
+			attribute.offset	= layout->stride;
+			layout->attributes.emplace_back(attribute);
+			layout->stride += size;
+		}
+	}
+
+	RHI_InputLayout::RHI_InputLayout(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice		= rhiDevice;
+		m_buffer		= nullptr;
+		m_inputLayout	= Input_PositionTextureTBN;
+	}
+
+	RHI_InputLayout::~RHI_InputLayout()
+	{
+		delete (InputLayout*)m_buffer;
+	}
+
+	bool RHI_InputLayout::Create(void* vsBlob, Input_Layout layout)
+	{
+		if (!vsBlob || layout == Input_NotAssigned)
+		{
+			LOG_ERROR("RHI_InputLayout::Create: Invalid parameters");
+			return false;
+		}
+
+		m_inputLayout	= layout;
+		auto vkLayout	= new InputLayout();
+
+		// POSITION
+		if (m_inputLayout == Input_Position2DTextureColor8)
+		{
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32_SFLOAT, 8);
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32_SFLOAT, 8);		// TEXCOORD
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R8G8B8A8_UNORM, 4);		// COLOR
+		}
+		else
+		{
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32B32_SFLOAT, 12);
+		}
+
+		if (m_inputLayout == Input_PositionColor)
+		{
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32B32A32_SFLOAT, 16);	// COLOR
+		}
+
+		if (m_inputLayout == Input_PositionTexture || m_inputLayout == Input_PositionTextureTBN)
+		{
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32_SFLOAT, 8);			// TEXCOORD
+		}
+
+		if (m_inputLayout == Input_PositionTextureTBN)
+		{
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32B32_SFLOAT, 12);		// NORMAL
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32B32_SFLOAT, 12);		// TANGENT
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R32G32B32_SFLOAT, 12);		// BITANGENT
+		}
+
+		if (m_inputLayout == Input_PositionTextureTBNPacked)
+		{
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_R16G16_SFLOAT, 4);				// TEXCOORD
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_A2B10G10R10_UNORM_PACK32, 4);	// NORMAL
+			Vulkan_InputLayout::AddAttribute(vkLayout, VK_FORMAT_A2B10G10R10_UNORM_PACK32, 4);	// TANGENT (w is the bitangent sign)
+		}
+
+		delete (InputLayout*)m_buffer;
+		m_buffer = vkLayout;
+		return true;
+	}
+}
+#endif
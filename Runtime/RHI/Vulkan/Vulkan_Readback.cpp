@@ -0,0 +1,132 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES ===========================
+#include "Vulkan_Common.h"
+#include "../RHI_Readback.h"
+#include "../RHI_RenderTexture.h"
+#include "../RHI_StructuredBuffer.h"
+#include "../../Logging/Log.h"
+//======================================
+
+//= NAMESPACES ===================
+using namespace std;
+using namespace Directus::Vulkan_Common;
+//================================
+
+namespace Directus
+{
+	namespace Vulkan_Readback
+	{
+		struct Staging
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			Allocation allocation;
+		};
+	}
+
+	bool RHI_Readback::Staging_Create(Staging& staging)
+	{
+		// Textures are copied into buffers too, with tightly packed rows
+		VkDeviceSize size	= (VkDeviceSize)staging.width * staging.height * (staging.texture ? Texture_Format_GetBytes(staging.format) : 1);
+		auto vkStaging		= new Vulkan_Readback::Staging();
+		if (!Buffer_CreateStaging(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, &vkStaging->buffer, &vkStaging->allocation))
+		{
+			delete vkStaging;
+			return false;
+		}
+
+		staging.resource = vkStaging;
+		return true;
+	}
+
+	void RHI_Readback::Staging_Destroy(Staging& staging)
+	{
+		auto vkStaging = (Vulkan_Readback::Staging*)staging.resource;
+		if (!vkStaging)
+			return;
+
+		// A copy may still be in flight
+		auto buffer		= vkStaging->buffer;
+		auto allocation	= vkStaging->allocation;
+		context.Release([buffer, allocation]() mutable { Buffer_DestroyStaging(buffer, allocation); });
+		delete vkStaging;
+		staging.resource = nullptr;
+	}
+
+	bool RHI_Readback::Copy_Texture(Staging& staging, RHI_RenderTexture* texture, unsigned int x, unsigned int y)
+	{
+		auto recorder	= RHI_Backend::GetContext();
+		auto image		= (Image*)texture->GetRenderTargetTexture();
+		if (!recorder || !recorder->commandBuffer || !image)
+			return false;
+
+		VkBufferImageCopy region	= {};
+		region.imageSubresource		= { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageOffset			= { (int32_t)x, (int32_t)y, 0 };
+		region.imageExtent			= { staging.width, staging.height, 1 };
+		Recorder_Transfer(recorder);
+		vkCmdCopyImageToBuffer(recorder->commandBuffer, image->image, VK_IMAGE_LAYOUT_GENERAL, ((Vulkan_Readback::Staging*)staging.resource)->buffer, 1, &region);
+
+		staging.frame = context.frameIndex;
+		return true;
+	}
+
+	bool RHI_Readback::Copy_Buffer(Staging& staging, RHI_StructuredBuffer* buffer, unsigned int offset)
+	{
+		auto recorder = RHI_Backend::GetContext();
+		if (!recorder || !recorder->commandBuffer)
+			return false;
+
+		// Only the buffers the GPU writes are copied from, the ones the CPU writes are renamed and were never created for it
+		auto vkBuffer = (Buffer*)buffer->GetBuffer();
+		if (vkBuffer->dynamic)
+		{
+			LOG_ERROR("Vulkan_Readback::Copy_Buffer: The GPU doesn't write to this buffer.");
+			return false;
+		}
+
+		VkBufferCopy region = { offset, 0, staging.width };
+		Recorder_Transfer(recorder);
+		vkCmdCopyBuffer(recorder->commandBuffer, vkBuffer->buffer, ((Vulkan_Readback::Staging*)staging.resource)->buffer, 1, &region);
+
+		staging.frame = context.frameIndex;
+		return true;
+	}
+
+	bool RHI_Readback::Staging_Read(Staging& staging, vector<unsigned char>& data)
+	{
+		// The memory is coherent and stays mapped, it only has to be finished
+		if (!context.IsFrameComplete(staging.frame))
+			return false;
+
+		auto size = (size_t)staging.width * staging.height * (staging.texture ? Texture_Format_GetBytes(staging.format) : 1);
+		data.resize(size);
+		memcpy(data.data(), ((Vulkan_Readback::Staging*)staging.resource)->allocation.mapped, size);
+		return true;
+	}
+}
+#endif
@@ -0,0 +1,365 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES ========================
+#include "Vulkan_Common.h"
+#include "../RHI_RenderTexture.h"
+#include "../RHI_Device.h"
+#include "../../Logging/Log.h"
+//===================================
+
+//= NAMESPACES ================
+using namespace Directus::Math;
+using namespace Directus::Vulkan_Common;
+using namespace std;
+//=============================
+
+#define READBACK_LATENCY 3 // staging buffers in flight, reading one any sooner would stall
+
+namespace Directus
+{
+	namespace Vulkan_RenderTexture
+	{
+		struct Readback
+		{
+			VkBuffer buffer	= VK_NULL_HANDLE;
+			Allocation allocation;
+			uint64_t frame	= 0; // the copy was recorded during
+		};
+
+		inline Image* Create(unsigned int width, unsigned int height, Texture_Format format, VkImageUsageFlags usage)
+		{
+			auto image = new Image();
+			if (!Image_Create(image, width, height, 1, 1, vulkan_format[format], usage | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT) ||
+				!Upload([image](VkCommandBuffer commandBuffer, const Staging&) { ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL); }))
+			{
+				Image_Destroy(image);
+				delete image;
+				return nullptr;
+			}
+
+			return image;
+		}
+
+		inline void Destroy(void* image)
+		{
+			if (auto vkImage = (Image*)image)
+			{
+				Image_Destroy(vkImage);
+				delete vkImage;
+			}
+		}
+	}
+
+	RHI_RenderTexture::RHI_RenderTexture(shared_ptr<RHI_Device> rhiDevice, int width, int height, Texture_Format textureFormat, bool depth, Texture_Format depthFormat, bool unorderedAccess)
+	{
+		m_renderTargetTexture	= nullptr;
+		m_renderTargetView		= nullptr;
+		m_shaderResourceView	= nullptr;
+		m_depthStencilBuffer	= nullptr;
+		m_depthStencilView		= nullptr;
+		m_unorderedAccessView	= nullptr;
+		m_rhiDevice				= rhiDevice;
+		m_depthEnabled			= depth;
+		m_nearPlane				= 0.0f;
+		m_farPlane				= 0.0f;
+		m_format				= textureFormat;
+		m_viewport				= RHI_Viewport((float)width, (float)height, m_rhiDevice->Get_Viewport().GetMaxDepth());
+		m_width					= width;
+		m_height				= height;
+
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("Vulkan_RenderTexture::RHI_RenderTexture: Invalid device.");
+			return;
+		}
+
+		// RENDER TARGET, the image is its own render target, shader resource and unordered access view
+		auto usage	= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (unorderedAccess ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
+		auto image	= Vulkan_RenderTexture::Create(m_width, m_height, m_format, usage);
+		if (!image)
+		{
+			LOG_ERROR("Vulkan_RenderTexture::RHI_RenderTexture: Failed to create render target.");
+			return;
+		}
+		m_renderTargetTexture	= image;
+		m_renderTargetView		= image;
+		m_shaderResourceView	= image;
+		m_unorderedAccessView	= unorderedAccess ? image : nullptr;
+		m_memoryTracker.Set(m_rhiDevice, Memory_RenderTargets, (long long)m_width * m_height * Texture_Format_GetBytes(m_format));
+
+		if (!m_depthEnabled)
+			return;
+
+		// DEPTH BUFFER
+		auto depthImage = Vulkan_RenderTexture::Create(m_width, m_height, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		if (!depthImage)
+		{
+			LOG_ERROR("Vulkan_RenderTexture::RHI_RenderTexture: Failed to create depth buffer.");
+			return;
+		}
+		m_depthStencilBuffer	= depthImage;
+		m_depthStencilView		= depthImage;
+		m_memoryTracker.Set(m_memoryTracker.GetBytes() + (long long)m_width * m_height * Texture_Format_GetBytes(depthFormat));
+	}
+
+	RHI_RenderTexture::~RHI_RenderTexture()
+	{
+		Vulkan_RenderTexture::Destroy(m_renderTargetTexture);
+		Vulkan_RenderTexture::Destroy(m_depthStencilBuffer);
+		for (auto& readback : m_readbackTextures)
+		{
+			// A copy may still be in flight
+			auto vkReadback = (Vulkan_RenderTexture::Readback*)readback;
+			auto buffer		= vkReadback->buffer;
+			auto allocation	= vkReadback->allocation;
+			context.Release([buffer, allocation]() mutable { Buffer_DestroyStaging(buffer, allocation); });
+			delete vkReadback;
+		}
+	}
+
+	bool RHI_RenderTexture::Clear(const Vector4& clearColor)
+	{
+		if (!m_rhiDevice)
+			return false;
+
+		// Clear back buffer
+		m_rhiDevice->ClearRenderTarget(m_renderTargetView, clearColor); 
+
+		// Clear depth buffer.
+		if (m_depthEnabled)
+		{
+			float farDepth = m_rhiDevice->Get_DepthFar(m_viewport);
+			m_rhiDevice->ClearDepthStencil(m_depthStencilView, Clear_Depth, farDepth, 0); 
+		}
+
+		return true;
+	}
+
+	bool RHI_RenderTexture::Clear(float red, float green, float blue, float alpha)
+	{
+		return Clear(Vector4(red, green, blue, alpha));
+	}
+
+	bool RHI_RenderTexture::CopyFrom(const shared_ptr<RHI_RenderTexture>& source)
+	{
+		if (!m_rhiDevice || !source || !m_renderTargetTexture || !source->m_renderTargetTexture)
+			return false;
+
+		if (source->m_width != m_width || source->m_height != m_height || source->m_format != m_format || source->m_depthEnabled != m_depthEnabled)
+		{
+			LOG_ERROR("Vulkan_RenderTexture::CopyFrom: Incompatible source.");
+			return false;
+		}
+
+		// Goes through the current recorder, so the copy can be part of a command list
+		auto recorder = RHI_Backend::GetContext();
+		if (!recorder || !recorder->commandBuffer)
+			return false;
+
+		auto copy = [recorder](Image* destination, Image* source)
+		{
+			VkImageCopy region		= {};
+			region.srcSubresource	= { source->aspect, 0, 0, 1 };
+			region.dstSubresource	= { destination->aspect, 0, 0, 1 };
+			region.extent			= { destination->width, destination->height, 1 };
+			vkCmdCopyImage(recorder->commandBuffer, source->image, VK_IMAGE_LAYOUT_GENERAL, destination->image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+		};
+
+		Recorder_Transfer(recorder);
+		copy((Image*)m_renderTargetTexture, (Image*)source->m_renderTargetTexture);
+		if (m_depthEnabled && m_depthStencilBuffer && source->m_depthStencilBuffer)
+		{
+			copy((Image*)m_depthStencilBuffer, (Image*)source->m_depthStencilBuffer);
+		}
+
+		return true;
+	}
+
+	bool RHI_RenderTexture::CopyRegionFrom(const shared_ptr<RHI_RenderTexture>& source, unsigned int x, unsigned int y)
+	{
+		if (!m_rhiDevice || !source || !m_renderTargetTexture || !source->m_renderTargetTexture)
+			return false;
+
+		if (source->m_format != m_format || x + source->m_width > m_width || y + source->m_height > m_height)
+		{
+			LOG_ERROR("Vulkan_RenderTexture::CopyRegionFrom: Incompatible source.");
+			return false;
+		}
+
+		auto recorder = RHI_Backend::GetContext();
+		if (!recorder || !recorder->commandBuffer)
+			return false;
+
+		auto destination		= (Image*)m_renderTargetTexture;
+		auto sourceImage		= (Image*)source->m_renderTargetTexture;
+		VkImageCopy region		= {};
+		region.srcSubresource	= { sourceImage->aspect, 0, 0, 1 };
+		region.dstSubresource	= { destination->aspect, 0, 0, 1 };
+		region.dstOffset		= { (int32_t)x, (int32_t)y, 0 };
+		region.extent			= { sourceImage->width, sourceImage->height, 1 };
+
+		Recorder_Transfer(recorder);
+		vkCmdCopyImage(recorder->commandBuffer, sourceImage->image, VK_IMAGE_LAYOUT_GENERAL, destination->image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+
+		return true;
+	}
+
+	bool RHI_RenderTexture::Readback_Request(unsigned int x /*= 0*/, unsigned int y /*= 0*/, unsigned int width /*= 0*/, unsigned int height /*= 0*/, unsigned int* request /*= nullptr*/)
+	{
+		auto recorder = m_rhiDevice ? RHI_Backend::GetContext() : nullptr;
+		if (!recorder || !recorder->commandBuffer || !m_renderTargetTexture)
+			return false;
+
+		if (width == 0 || height == 0)
+		{
+			x = y	= 0;
+			width	= m_width;
+			height	= m_height;
+		}
+
+		if (x + width > m_width || y + height > m_height || (!m_readbackTextures.empty() && (width != m_readbackWidth || height != m_readbackHeight)))
+		{
+			LOG_ERROR("Vulkan_RenderTexture::Readback_Request: Invalid region.");
+			return false;
+		}
+
+		// Create the staging buffers the first time a readback is requested
+		if (m_readbackTextures.empty())
+		{
+			VkDeviceSize size = (VkDeviceSize)width * height * Texture_Format_GetBytes(m_format);
+			for (unsigned int i = 0; i < READBACK_LATENCY; i++)
+			{
+				auto readback = new Vulkan_RenderTexture::Readback();
+				if (!Buffer_CreateStaging(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, &readback->buffer, &readback->allocation))
+				{
+					LOG_ERROR("Vulkan_RenderTexture::Readback_Request: Failed to create staging buffer.");
+					delete readback;
+					return false;
+				}
+				m_readbackTextures.emplace_back(readback);
+			}
+			m_readbackRequests.assign(READBACK_LATENCY, 0);
+			m_readbackWidth		= width;
+			m_readbackHeight	= height;
+		}
+
+		// Use an idle staging buffer, or overwrite the oldest request if they are all in flight
+		unsigned int index = 0;
+		for (unsigned int i = 1; i < (unsigned int)m_readbackRequests.size(); i++)
+		{
+			if (m_readbackRequests[i] < m_readbackRequests[index])
+			{
+				index = i;
+			}
+		}
+
+		auto image		= (Image*)m_renderTargetTexture;
+		auto readback	= (Vulkan_RenderTexture::Readback*)m_readbackTextures[index];
+		readback->frame	= context.frameIndex;
+		m_readbackRequests[index] = ++m_readbackCount;
+		if (request)
+		{
+			*request = m_readbackCount;
+		}
+
+		// Tightly packed rows
+		VkBufferImageCopy region	= {};
+		region.imageSubresource		= { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageOffset			= { (int32_t)x, (int32_t)y, 0 };
+		region.imageExtent			= { width, height, 1 };
+		Recorder_Transfer(recorder);
+		vkCmdCopyImageToBuffer(recorder->commandBuffer, image->image, VK_IMAGE_LAYOUT_GENERAL, readback->buffer, 1, &region);
+		return true;
+	}
+
+	bool RHI_RenderTexture::Readback_Get(vector<unsigned char>& data, unsigned int* request /*= nullptr*/)
+	{
+		if (!m_rhiDevice || m_readbackTextures.empty())
+			return false;
+
+		auto size	= m_readbackWidth * m_readbackHeight * Texture_Format_GetBytes(m_format);
+		bool found	= false;
+
+		// Requests finish in order, so stop at the first one the GPU is still working on
+		while (true)
+		{
+			unsigned int index = (unsigned int)m_readbackRequests.size();
+			for (unsigned int i = 0; i < (unsigned int)m_readbackRequests.size(); i++)
+			{
+				if (m_readbackRequests[i] != 0 && (index == m_readbackRequests.size() || m_readbackRequests[i] < m_readbackRequests[index]))
+				{
+					index = i;
+				}
+			}
+
+			if (index == m_readbackRequests.size())
+				break;
+
+			auto readback = (Vulkan_RenderTexture::Readback*)m_readbackTextures[index];
+			if (!context.IsFrameComplete(readback->frame))
+				break;
+
+			data.resize(size);
+			memcpy(data.data(), readback->allocation.mapped, size);
+
+			if (request)
+			{
+				*request = m_readbackRequests[index];
+			}
+			m_readbackRequests[index]	= 0;
+			found						= true;
+		}
+
+		return found;
+	}
+
+	void RHI_RenderTexture::ComputeOrthographicProjectionMatrix(float nearPlane, float farPlane)
+	{
+		if (m_nearPlane == nearPlane && m_farPlane == farPlane)
+			return;
+
+		m_nearPlane						= nearPlane;
+		m_farPlane						= farPlane;
+		m_orthographicProjectionMatrix	= Matrix::CreateOrthographicLH(m_viewport.GetWidth(), m_viewport.GetHeight(), nearPlane, farPlane);
+	}
+
+	void* RHI_RenderTexture::GetRenderTargetView()
+	{
+		return m_renderTargetView;
+	}
+
+	void* RHI_RenderTexture::GetShaderResource()
+	{
+		return m_shaderResourceView;
+	}
+
+	void* RHI_RenderTexture::GetDepthStencilView()
+	{
+		return m_depthStencilView;
+	}
+}
+#endif
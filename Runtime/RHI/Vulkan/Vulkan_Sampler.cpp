@@ -0,0 +1,95 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =====================
+#include "Vulkan_Common.h"
+#include "../RHI_Sampler.h"
+#include "../RHI_Device.h"
+#include "../../Logging/Log.h"
+//================================
+
+//= NAMESPACES ===================
+using namespace Directus::Vulkan_Common;
+//================================
+
+namespace Directus
+{
+	RHI_Sampler::RHI_Sampler(
+		std::shared_ptr<RHI_Device> rhiDevice,
+		Texture_Sampler_Filter filter					/*= Texture_Sampler_Anisotropic*/,
+		Texture_Address_Mode textureAddressMode			/*= Texture_Address_Wrap*/, 
+		Texture_Comparison_Function comparisonFunction	/*= Texture_Comparison_Always*/
+	)
+	{	
+		m_buffer				= nullptr;
+		m_rhiDevice				= rhiDevice;
+		m_filter				= filter;
+		m_textureAddressMode	= textureAddressMode;
+		m_comparisonFunction	= comparisonFunction;
+
+		if (!rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("Vulkan_Sampler::RHI_Sampler: Invalid device.");
+			return;
+		}
+
+		VkPhysicalDeviceFeatures features;
+		vkGetPhysicalDeviceFeatures(context.physicalDevice, &features);
+
+		// Like the D3D11 samplers, these don't compare (the comparison function only matters to comparison filters)
+		VkSamplerCreateInfo samplerInfo	= {};
+		samplerInfo.sType				= VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter			= vulkan_filter[filter];
+		samplerInfo.minFilter			= vulkan_filter[filter];
+		samplerInfo.mipmapMode			= vulkan_mipmap_mode[filter];
+		samplerInfo.addressModeU		= vulkan_sampler_address_mode[textureAddressMode];
+		samplerInfo.addressModeV		= vulkan_sampler_address_mode[textureAddressMode];
+		samplerInfo.addressModeW		= vulkan_sampler_address_mode[textureAddressMode];
+		samplerInfo.mipLodBias			= 0.0f;
+		samplerInfo.anisotropyEnable	= filter == Texture_Sampler_Anisotropic && features.samplerAnisotropy && Settings::Get().Anisotropy_Get() > 1;
+		samplerInfo.maxAnisotropy		= (float)Settings::Get().Anisotropy_Get();
+		samplerInfo.compareEnable		= VK_FALSE;
+		samplerInfo.compareOp			= vulkan_compare_operator[comparisonFunction];
+		samplerInfo.borderColor			= VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+		samplerInfo.minLod				= 0.0f;
+		samplerInfo.maxLod				= VK_LOD_CLAMP_NONE;
+
+		if (vkCreateSampler(context.device, &samplerInfo, nullptr, (VkSampler*)&m_buffer) != VK_SUCCESS)
+		{
+			LOG_ERROR("RHI_Sampler::RHI_Sampler: Failed to create sampler state");
+		}
+	}
+
+	RHI_Sampler::~RHI_Sampler()
+	{
+		if (auto sampler = (VkSampler)m_buffer)
+		{
+			context.Release([sampler]() { vkDestroySampler(context.device, sampler, nullptr); });
+			m_buffer = nullptr;
+		}
+	}
+}
+#endif
@@ -0,0 +1,483 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES ===========================
+#include "Vulkan_Common.h"
+#include "../RHI_Device.h"
+#include "../RHI_Shader.h"
+#include "../RHI_InputLayout.h"
+#include <sstream> 
+#include <fstream>
+#include <set>
+#include <functional>
+#include <cstring>
+#include <dxcapi.h>
+#include "../../Logging/Log.h"
+#include "../../FileSystem/FileSystem.h"
+//======================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Vulkan_Common;
+//=============================
+
+namespace Directus
+{
+	namespace Vulkan_Shader
+	{
+		// The D3D11 profiles of RHI_Shader.h, dxc only emits SPIR-V from shader model 6
+		static const char* VERTEX_SHADER_MODEL_SPIRV	= "vs_6_0";
+		static const char* PIXEL_SHADER_MODEL_SPIRV		= "ps_6_0";
+		static const char* COMPUTE_SHADER_MODEL_SPIRV	= "cs_6_0";
+
+		// Register shifts keep b#, t#, s# and u# apart since Vulkan has one binding namespace per set
+		static const char* DXC_FLAGS = "-spirv -fspv-target-env=vulkan1.0 -fvk-b-shift 0 all -fvk-t-shift 16 all -fvk-s-shift 48 all -fvk-u-shift 64 all -O3";
+
+		// Appends the file and everything it includes, so editing a shared header invalidates its users
+		inline void GatherSource(const string& filePath, set<string>& visited, string& source)
+		{
+			if (!visited.insert(filePath).second)
+				return;
+
+			ifstream file(filePath, ios::binary);
+			if (!file.is_open())
+				return;
+
+			string line;
+			while (getline(file, line))
+			{
+				source += line;
+				source += '\n';
+
+				auto include = line.find("#include");
+				if (include == string::npos)
+					continue;
+
+				auto open	= line.find('"', include);
+				auto close	= open != string::npos ? line.find('"', open + 1) : string::npos;
+				if (close != string::npos)
+				{
+					GatherSource(FileSystem::GetDirectoryFromFilePath(filePath) + line.substr(open + 1, close - open - 1), visited, source);
+				}
+			}
+		}
+
+		// Returns where the SPIR-V of this exact compilation is cached (just it's name when caching is disabled), empty if the shader can't be read
+		inline string GetOutputPath(const string& filePath, const map<string, string>& macros, const char* entryPoint, const char* shaderModel, bool* cached)
+		{
+			string key;
+			set<string> visited;
+			GatherSource(filePath, visited, key);
+			if (key.empty())
+				return "";
+
+			for (const auto& macro : macros)
+			{
+				key += macro.first + "=" + macro.second + ";";
+			}
+			key += string(entryPoint) + ";" + shaderModel + ";" + DXC_FLAGS;
+
+			stringstream name;
+			name << FileSystem::GetFileNameNoExtensionFromFilePath(filePath) << "_" << hex << hash<string>()(key) << ".spv";
+
+			*cached = !RHI_Shader::GetCacheDirectory().empty();
+			return *cached ? RHI_Shader::GetCacheDirectory() + name.str() : name.str();
+		}
+
+		inline bool ReadSpirv(const string& path, vector<uint32_t>* spirv)
+		{
+			ifstream file(path, ios::binary | ios::ate);
+			if (!file.is_open())
+				return false;
+
+			auto size = (size_t)file.tellg();
+			if (size == 0 || size % sizeof(uint32_t) != 0)
+				return false;
+
+			spirv->resize(size / sizeof(uint32_t));
+			file.seekg(0);
+			file.read((char*)spirv->data(), size);
+			return file.good();
+		}
+
+		// HLSL has no notion of descriptor sets, so every binding dxc emits is moved to the one of its stage
+		inline void AssignDescriptorSet(vector<uint32_t>& spirv, uint32_t set)
+		{
+			const uint32_t Op_Decorate				= 71;
+			const uint32_t Decoration_DescriptorSet	= 34;
+
+			for (size_t i = 5; i < spirv.size();)
+			{
+				uint32_t wordCount = spirv[i] >> 16;
+				if (wordCount == 0)
+					return;
+
+				if ((spirv[i] & 0xFFFF) == Op_Decorate && wordCount == 4 && spirv[i + 2] == Decoration_DescriptorSet)
+				{
+					spirv[i + 3] = set;
+				}
+				i += wordCount;
+			}
+		}
+
+		inline bool WriteSpirv(const string& path, const vector<uint32_t>& spirv)
+		{
+			ofstream file(path, ios::binary);
+			if (!file.is_open())
+				return false;
+
+			file.write((const char*)spirv.data(), spirv.size() * sizeof(uint32_t));
+			return file.good();
+		}
+
+		// Compiles through dxcompiler, whatever it reports (warnings too) gets logged
+		inline bool Compile(const string& filePath, const map<string, string>& macros, const char* entryPoint, const char* shaderModel, vector<uint32_t>* spirv)
+		{
+			IDxcLibrary* library			= nullptr;
+			IDxcCompiler* compiler			= nullptr;
+			IDxcIncludeHandler* includes	= nullptr;
+			IDxcBlobEncoding* source		= nullptr;
+			IDxcOperationResult* result		= nullptr;
+			auto release = [&]()
+			{
+				if (result)		result->Release();
+				if (source)		source->Release();
+				if (includes)	includes->Release();
+				if (compiler)	compiler->Release();
+				if (library)	library->Release();
+			};
+
+			wstring path = FileSystem::StringToWString(filePath);
+			if (FAILED(DxcCreateInstance(CLSID_DxcLibrary, __uuidof(IDxcLibrary), (void**)&library)) ||
+				FAILED(DxcCreateInstance(CLSID_DxcCompiler, __uuidof(IDxcCompiler), (void**)&compiler)) ||
+				FAILED(library->CreateIncludeHandler(&includes)))
+			{
+				LOG_ERROR("Vulkan_Shader::Compile: Failed to create the compiler, dxcompiler.dll may be missing.");
+				release();
+				return false;
+			}
+
+			if (FAILED(library->CreateBlobFromFile(path.c_str(), nullptr, &source)))
+			{
+				LOGF_ERROR("Vulkan_Shader::Compile: Failed to read \"%s\".", filePath.c_str());
+				release();
+				return false;
+			}
+
+			// The same flags the cache key is made of, one argument each
+			vector<wstring> arguments;
+			stringstream flags(DXC_FLAGS);
+			string flag;
+			while (flags >> flag)
+			{
+				arguments.emplace_back(FileSystem::StringToWString(flag));
+			}
+			vector<LPCWSTR> argumentPointers;
+			for (const auto& argument : arguments)
+			{
+				argumentPointers.emplace_back(argument.c_str());
+			}
+
+			// Reserved, so the defines keep pointing at the strings
+			vector<wstring> defineStrings;
+			vector<DxcDefine> defines;
+			defineStrings.reserve(macros.size() * 2);
+			for (const auto& macro : macros)
+			{
+				const auto& name	= defineStrings.emplace_back(FileSystem::StringToWString(macro.first));
+				const auto& value	= defineStrings.emplace_back(FileSystem::StringToWString(macro.second));
+				defines.push_back({ name.c_str(), value.c_str() });
+			}
+
+			wstring entry	= FileSystem::StringToWString(entryPoint);
+			wstring profile	= FileSystem::StringToWString(shaderModel);
+			HRESULT status	= E_FAIL;
+			if (SUCCEEDED(compiler->Compile(source, path.c_str(), entry.c_str(), profile.c_str(), argumentPointers.data(), (UINT32)argumentPointers.size(), defines.data(), (UINT32)defines.size(), includes, &result)))
+			{
+				result->GetStatus(&status);
+			}
+
+			IDxcBlobEncoding* errors = nullptr;
+			if (result && SUCCEEDED(result->GetErrorBuffer(&errors)) && errors)
+			{
+				if (errors->GetBufferSize() != 0)
+				{
+					string message((const char*)errors->GetBufferPointer(), errors->GetBufferSize());
+					if (FAILED(status))
+					{
+						LOGF_ERROR("Vulkan_Shader::Compile: \"%s\"\n%s", FileSystem::GetFileNameFromFilePath(filePath).c_str(), message.c_str());
+					}
+					else
+					{
+						LOGF_WARNING("Vulkan_Shader::Compile: \"%s\"\n%s", FileSystem::GetFileNameFromFilePath(filePath).c_str(), message.c_str());
+					}
+				}
+				errors->Release();
+			}
+
+			IDxcBlob* code	= nullptr;
+			bool compiled	= SUCCEEDED(status) && SUCCEEDED(result->GetResult(&code)) && code && code->GetBufferSize() != 0 && code->GetBufferSize() % sizeof(uint32_t) == 0;
+			if (compiled)
+			{
+				spirv->resize(code->GetBufferSize() / sizeof(uint32_t));
+				memcpy(spirv->data(), code->GetBufferPointer(), code->GetBufferSize());
+			}
+
+			if (code) code->Release();
+			release();
+			return compiled;
+		}
+
+		inline bool CompileShader(const string& filePath, map<string, string> macros, const char* entryPoint, const char* shaderModel, vector<uint32_t>* spirv, string* cachePathOut)
+		{
+			bool cached		= false;
+			string output	= GetOutputPath(filePath, macros, entryPoint, shaderModel, &cached);
+			if (output.empty())
+			{
+				LOGF_ERROR("Vulkan_Shader::CompileShader: Failed to find shader \"%s\" with path \"%s\".", FileSystem::GetFileNameFromFilePath(filePath).c_str(), filePath.c_str());
+				return false;
+			}
+
+			// Load from the SPIR-V cache
+			if (cached && FileSystem::FileExists(output) && ReadSpirv(output, spirv))
+			{
+				*cachePathOut = output;
+				return true;
+			}
+
+			if (!Compile(filePath, macros, entryPoint, shaderModel, spirv))
+			{
+				LOGF_ERROR("Vulkan_Shader::CompileShader: An error occured when trying to load and compile \"%s\"", FileSystem::GetFileNameFromFilePath(filePath).c_str());
+				return false;
+			}
+
+			if (cached && WriteSpirv(output, *spirv))
+			{
+				*cachePathOut = output;
+			}
+
+			return true;
+		}
+
+		inline void Destroy(Shader* shader)
+		{
+			if (!shader)
+				return;
+
+			auto module			= shader->module;
+			auto setLayout		= shader->setLayout;
+			auto pipelineLayout	= shader->pipelineLayout;
+			context.Release([module, setLayout, pipelineLayout]()
+			{
+				if (pipelineLayout)	vkDestroyPipelineLayout(context.device, pipelineLayout, nullptr);
+				if (setLayout)		vkDestroyDescriptorSetLayout(context.device, setLayout, nullptr);
+				if (module)			vkDestroyShaderModule(context.device, module, nullptr);
+			});
+			delete shader;
+		}
+
+		inline bool CreateShader(VkDevice device, vector<uint32_t>& spirv, uint32_t set, const char* entryPoint, Shader* shader)
+		{
+			AssignDescriptorSet(spirv, set);
+			if (!Shader_Reflect(spirv, shader))
+				return false;
+
+			VkShaderModuleCreateInfo moduleInfo	= {};
+			moduleInfo.sType					= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			moduleInfo.codeSize					= spirv.size() * sizeof(uint32_t);
+			moduleInfo.pCode					= spirv.data();
+			if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shader->module) != VK_SUCCESS)
+				return false;
+			shader->entryPoint = entryPoint;
+
+			vector<VkDescriptorSetLayoutBinding> bindings;
+			for (const auto& binding : shader->bindings)
+			{
+				VkDescriptorSetLayoutBinding layoutBinding	= {};
+				layoutBinding.binding						= binding.binding;
+				layoutBinding.descriptorType				= binding.type;
+				layoutBinding.descriptorCount				= 1;
+				layoutBinding.stageFlags					= shader->stage;
+				bindings.emplace_back(layoutBinding);
+			}
+
+			VkDescriptorSetLayoutCreateInfo setInfo	= {};
+			setInfo.sType							= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			setInfo.bindingCount					= (uint32_t)bindings.size();
+			setInfo.pBindings						= bindings.data();
+			if (vkCreateDescriptorSetLayout(device, &setInfo, nullptr, &shader->setLayout) != VK_SUCCESS)
+				return false;
+
+			// Graphics pipeline layouts pair a vertex and a pixel shader, so only compute owns one
+			if (shader->stage == VK_SHADER_STAGE_COMPUTE_BIT)
+			{
+				VkPipelineLayoutCreateInfo layoutInfo	= {};
+				layoutInfo.sType						= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+				layoutInfo.setLayoutCount				= 1;
+				layoutInfo.pSetLayouts					= &shader->setLayout;
+				if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &shader->pipelineLayout) != VK_SUCCESS)
+					return false;
+			}
+
+			return true;
+		}
+
+		inline Shader* Compile(VkDevice device, const string& path, map<string, string> macros, const char* entryPoint, const char* shaderModel, uint32_t set)
+		{
+			if (!device)
+			{
+				LOG_ERROR("Vulkan_Shader::Compile: Invalid device.");
+				return nullptr;
+			}
+
+			string cachePath;
+			vector<uint32_t> spirv;
+			if (!CompileShader(path, macros, entryPoint, shaderModel, &spirv, &cachePath))
+				return nullptr;
+
+			// A cached module which the device rejects is discarded and compiled again
+			auto shader = new Shader();
+			if (!CreateShader(device, spirv, set, entryPoint, shader) && !cachePath.empty())
+			{
+				Destroy(shader);
+				FileSystem::DeleteFile_(cachePath);
+				shader = new Shader();
+				if (!CompileShader(path, macros, entryPoint, shaderModel, &spirv, &cachePath) || !CreateShader(device, spirv, set, entryPoint, shader))
+				{
+					Destroy(shader);
+					shader = nullptr;
+				}
+			}
+			else if (!shader->module || !shader->setLayout)
+			{
+				Destroy(shader);
+				shader = nullptr;
+			}
+
+			if (!shader)
+			{
+				LOGF_ERROR("Vulkan_Shader::Compile: Failed to create shader module for \"%s\".", FileSystem::GetFileNameFromFilePath(path).c_str());
+			}
+
+			return shader;
+		}
+	}
+
+	RHI_Shader::RHI_Shader(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice			= rhiDevice;
+		m_inputLayout		= make_shared<RHI_InputLayout>(m_rhiDevice);
+	}
+
+	RHI_Shader::~RHI_Shader()
+	{
+		Vulkan_Shader::Destroy((Shader*)m_vertexShader);
+		Vulkan_Shader::Destroy((Shader*)m_pixelShader);
+		Vulkan_Shader::Destroy((Shader*)m_computeShader);
+	}
+
+	bool RHI_Shader::Compile_Vertex(const string& filePath, Input_Layout inputLayout)
+	{
+		m_filePath = filePath;
+
+		auto macros				= m_macros;
+		macros["COMPILE_VS"]	= "1";
+		macros["COMPILE_PS"]	= "0";
+
+		auto shader = Vulkan_Shader::Compile(RHI_Backend::GetDevice(), m_filePath, macros, VERTEX_SHADER_ENTRYPOINT, Vulkan_Shader::VERTEX_SHADER_MODEL_SPIRV, set_vertex);
+		if (shader)
+		{
+			// Create input layout
+			if (!m_inputLayout->Create(shader, inputLayout))
+			{
+				LOGF_ERROR("Vulkan_Shader::SetInputLayout: Failed to create vertex input layout for %s", FileSystem::GetFileNameFromFilePath(m_filePath).data());
+			}
+
+			Vulkan_Shader::Destroy((Shader*)m_vertexShader);
+			m_vertexShader		= shader;
+			m_hasVertexShader	= true;
+		}
+		else
+		{
+			m_hasVertexShader	= false;
+		}
+
+		return m_hasVertexShader;
+	}
+
+	bool RHI_Shader::Compile_Pixel(const string& filePath)
+	{
+		m_filePath = filePath;
+
+		auto macros				= m_macros;
+		macros["COMPILE_VS"]	= "0";
+		macros["COMPILE_PS"]	= "1";
+
+		auto shader = Vulkan_Shader::Compile(RHI_Backend::GetDevice(), m_filePath, macros, PIXEL_SHADER_ENTRYPOINT, Vulkan_Shader::PIXEL_SHADER_MODEL_SPIRV, set_pixel);
+		if (shader)
+		{
+			Vulkan_Shader::Destroy((Shader*)m_pixelShader);
+			m_pixelShader		= shader;
+			m_hasPixelShader	= true;
+		}
+		else
+		{
+			m_hasPixelShader	= false;
+		}
+
+		return m_hasPixelShader;
+	}
+
+	bool RHI_Shader::Compile_Compute(const string& filePath)
+	{
+		m_filePath		= filePath;
+		m_shaderState	= Shader_Compiling;
+
+		auto macros				= m_macros;
+		macros["COMPILE_VS"]	= "0";
+		macros["COMPILE_PS"]	= "0";
+		macros["COMPILE_CS"]	= "1";
+
+		auto shader = Vulkan_Shader::Compile(RHI_Backend::GetDevice(), m_filePath, macros, COMPUTE_SHADER_ENTRYPOINT, Vulkan_Shader::COMPUTE_SHADER_MODEL_SPIRV, set_compute);
+		if (shader)
+		{
+			Vulkan_Shader::Destroy((Shader*)m_computeShader);
+			m_computeShader		= shader;
+			m_hasComputeShader	= true;
+			m_shaderState		= Shader_Built;
+			LOGF_INFO("RHI_Shader::Compile_Compute: Successfully compiled %s", filePath.c_str());
+		}
+		else
+		{
+			m_hasComputeShader	= false;
+			m_shaderState		= Shader_Failed;
+			LOGF_ERROR("RHI_Shader::Compile_Compute: Failed to compile %s", filePath.c_str());
+		}
+
+		return m_hasComputeShader;
+	}
+}
+#endif
@@ -0,0 +1,150 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =======================
+#include "Vulkan_Common.h"
+#include "../RHI_StructuredBuffer.h"
+#include "../../Logging/Log.h"
+#include "../RHI_Device.h"
+#include "../RHI_Capture.h"
+//==================================
+
+//= NAMESPACES ===================
+using namespace std;
+using namespace Directus::Vulkan_Common;
+//================================
+
+namespace Directus
+{
+	RHI_StructuredBuffer::RHI_StructuredBuffer(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice				= rhiDevice;
+		m_buffer				= nullptr;
+		m_shaderResourceView	= nullptr;
+		m_unorderedAccessView	= nullptr;
+		m_stride				= 0;
+		m_elementCount			= 0;
+	}
+
+	RHI_StructuredBuffer::~RHI_StructuredBuffer()
+	{
+		// The views are the buffer itself
+		if (auto buffer = (Buffer*)m_buffer)
+		{
+			Buffer_Destroy(buffer);
+			delete buffer;
+		}
+		m_buffer				= nullptr;
+		m_shaderResourceView	= nullptr;
+		m_unorderedAccessView	= nullptr;
+	}
+
+	bool RHI_StructuredBuffer::Create(unsigned int stride, unsigned int elementCount, const void* data /*= nullptr*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Create: Invalid RHI device");
+			return false;
+		}
+
+		m_stride		= stride;
+		m_elementCount	= elementCount;
+
+		auto buffer = new Buffer();
+		if (!Buffer_Create(buffer, stride * elementCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, data == nullptr, data))
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Create: Failed to create structured buffer");
+			delete buffer;
+			return false;
+		}
+
+		m_buffer				= (void*)buffer;
+		m_shaderResourceView	= m_buffer;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, stride * elementCount);
+		return true;
+	}
+
+	bool RHI_StructuredBuffer::CreateUnorderedAccess(unsigned int stride, unsigned int elementCount, bool drawArguments /*= false*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_StructuredBuffer::CreateUnorderedAccess: Invalid RHI device");
+			return false;
+		}
+
+		m_stride		= stride;
+		m_elementCount	= elementCount;
+
+		// Storage buffers can hold indirect arguments as they are, no raw view needed. RHI_Readback copies out of them.
+		VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | (drawArguments ? VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT : 0);
+		auto buffer = new Buffer();
+		if (!Buffer_Create(buffer, stride * elementCount, usage, false))
+		{
+			LOG_ERROR("RHI_StructuredBuffer::CreateUnorderedAccess: Failed to create structured buffer");
+			delete buffer;
+			return false;
+		}
+
+		m_buffer				= (void*)buffer;
+		m_unorderedAccessView	= m_buffer;
+		m_shaderResourceView	= drawArguments ? nullptr : m_buffer;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, stride * elementCount);
+		return true;
+	}
+
+	void* RHI_StructuredBuffer::Map()
+	{
+		auto buffer = (Buffer*)m_buffer;
+		if (!buffer || !buffer->dynamic)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Map: Invalid buffer");
+			return nullptr;
+		}
+
+		auto data = Buffer_Map(buffer, true);
+		if (!data)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Map: Failed to map structured buffer.");
+		}
+
+		RHI_CAPTURE(Record_Map(Capture_UpdateStructuredBuffer, this, m_buffer, data, m_stride * m_elementCount));
+		return data;
+	}
+
+	bool RHI_StructuredBuffer::Unmap()
+	{
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_StructuredBuffer::Unmap: Invalid buffer");
+			return false;
+		}
+		RHI_CAPTURE(Record_Unmap(this));
+
+		// Host coherent memory, the writes are visible to the next submission
+		return true;
+	}
+}
+#endif
@@ -0,0 +1,269 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =====================
+#include "Vulkan_Common.h"
+#include "../RHI_Device.h"
+#include "../RHI_Texture.h"
+#include "../../Math/MathHelper.h"
+//================================
+
+//= NAMESPAECES =======================
+using namespace std;
+using namespace Directus::Math::Helper;
+using namespace Directus::Vulkan_Common;
+//=====================================
+
+namespace Directus
+{
+	namespace Vulkan_Texture
+	{
+		inline void MipBarrier(VkCommandBuffer commandBuffer, Image* image, uint32_t mip, VkImageLayout from, VkImageLayout to)
+		{
+			VkImageMemoryBarrier barrier			= {};
+			barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask					= VK_ACCESS_TRANSFER_READ_BIT;
+			barrier.oldLayout						= from;
+			barrier.newLayout						= to;
+			barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			barrier.image							= image->image;
+			barrier.subresourceRange.aspectMask		= image->aspect;
+			barrier.subresourceRange.baseMipLevel	= mip;
+			barrier.subresourceRange.levelCount		= 1;
+			barrier.subresourceRange.baseArrayLayer	= 0;
+			barrier.subresourceRange.layerCount		= image->layers;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		// Copies each layer's mips (as many as there are) into a new image, generating the rest by blitting if asked to
+		inline Image* Create(unsigned int width, unsigned int height, Texture_Format format, const vector<const vector<Mipmap>*>& layers, bool generateMipmaps, unsigned int* memoryUsage)
+		{
+			auto& mips			= *layers.front();
+			bool cube			= layers.size() == 6;
+			uint32_t mipLevels	= generateMipmaps ? (uint32_t)(log2(Max(width, height))) + 1 : (uint32_t)mips.size();
+
+			// Staging, copy offsets have to be aligned to the texel size (and 4)
+			VkDeviceSize stagingSize = 0;
+			for (auto layer : layers)
+			{
+				for (uint32_t mip = 0; mip < (generateMipmaps ? 1 : (uint32_t)layer->size()); mip++)
+				{
+					stagingSize = (stagingSize + 15) & ~(VkDeviceSize)15;
+					stagingSize += (*layer)[mip].size();
+				}
+			}
+
+			if (stagingSize == 0)
+			{
+				LOG_ERROR("Vulkan_Texture::Create: Invalid data.");
+				return nullptr;
+			}
+
+			// Where each mip goes in the staging memory, relative to its start
+			vector<const vector<std::byte>*> sources;
+			vector<VkBufferImageCopy> regions;
+			VkDeviceSize offset = 0;
+			for (uint32_t layer = 0; layer < (uint32_t)layers.size(); layer++)
+			{
+				uint32_t mipWidth	= width;
+				uint32_t mipHeight	= height;
+				for (uint32_t mip = 0; mip < (generateMipmaps ? 1 : (uint32_t)layers[layer]->size()); mip++)
+				{
+					auto& data	= (*layers[layer])[mip];
+					offset		= (offset + 15) & ~(VkDeviceSize)15;
+					if (data.empty())
+					{
+						LOGF_ERROR("Vulkan_Texture::Create: Mip level %d has invalid data.", mip);
+					}
+					else
+					{
+						VkBufferImageCopy region	= {};
+						region.bufferOffset			= offset;
+						region.imageSubresource		= { VK_IMAGE_ASPECT_COLOR_BIT, mip, layer, 1 };
+						region.imageExtent			= { mipWidth, mipHeight, 1 };
+						regions.emplace_back(region);
+						sources.emplace_back(&data);
+
+						// Compute memory usage (rough estimation)
+						*memoryUsage += (unsigned int)(sizeof(std::byte) * data.size());
+					}
+
+					// Compute size of next mip-map
+					offset		+= data.size();
+					mipWidth	= Max(mipWidth / 2, (uint32_t)1);
+					mipHeight	= Max(mipHeight / 2, (uint32_t)1);
+				}
+			}
+
+			auto image = new Image();
+			// A transfer source for the mip generation and for texture arrays to copy from (see RHI_TextureArray)
+			VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+			bool result = Image_Create(image, width, height, mipLevels, (uint32_t)layers.size(), vulkan_format[format], usage, cube);
+			if (result)
+			{
+				result = Upload([image, &regions, &sources, mipLevels, generateMipmaps](VkCommandBuffer commandBuffer, const Staging& staging)
+				{
+					for (size_t i = 0; i < regions.size(); i++)
+					{
+						memcpy((std::byte*)staging.mapped + regions[i].bufferOffset, sources[i]->data(), sources[i]->size());
+						regions[i].bufferOffset += staging.offset;
+					}
+
+					ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+					vkCmdCopyBufferToImage(commandBuffer, staging.buffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+					if (!generateMipmaps)
+					{
+						ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+						return;
+					}
+
+					// Each mip is a linear downsample of the one above it
+					int32_t mipWidth	= (int32_t)image->width;
+					int32_t mipHeight	= (int32_t)image->height;
+					for (uint32_t mip = 1; mip < mipLevels; mip++)
+					{
+						MipBarrier(commandBuffer, image, mip - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+						VkImageBlit blit		= {};
+						blit.srcSubresource		= { VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, 0, image->layers };
+						blit.srcOffsets[1]		= { mipWidth, mipHeight, 1 };
+						mipWidth				= Max(mipWidth / 2, 1);
+						mipHeight				= Max(mipHeight / 2, 1);
+						blit.dstSubresource		= { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, image->layers };
+						blit.dstOffsets[1]		= { mipWidth, mipHeight, 1 };
+						vkCmdBlitImage(commandBuffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+					}
+					MipBarrier(commandBuffer, image, mipLevels - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+					ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				}, stagingSize) != 0;
+			}
+
+			if (!result)
+			{
+				LOG_ERROR("Vulkan_Texture::Create: Failed to create image.");
+				Image_Destroy(image);
+				delete image;
+				return nullptr;
+			}
+
+			image->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			return image;
+		}
+	}
+
+	bool RHI_Texture::ShaderResource_Create2D(unsigned int width, unsigned int height, unsigned int channels, Texture_Format format, const vector<vector<std::byte>>& data, bool generateMimaps /*= false*/)
+	{
+		if (!RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_Create: Invalid device.");
+			return false;
+		}
+
+		if (data.empty())
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_Create2D: Invalid data.");
+			return false;
+		}
+
+		auto image = Vulkan_Texture::Create(width, height, format, { &data }, generateMimaps, &m_memoryUsage);
+		if (!image)
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_Create2D: Failed to create texture.");
+			return false;
+		}
+
+		m_shaderResource		= (void*)image;
+		m_shaderResourceWidth	= image->width;
+		m_shaderResourceHeight	= image->height;
+		m_shaderResourceMips	= image->mipLevels;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Textures, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_Texture::ShaderResource_CreateCubemap(unsigned int width, unsigned int height, unsigned int channels, Texture_Format format, const vector<vector<vector<std::byte>>>& data)
+	{
+		if (!RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_CreateCubemap: Invalid RHI device.");
+			return false;
+		}
+
+		if (data.size() != 6)
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_CreateCubemap: Invalid data.");
+			return false;
+		}
+
+		vector<const vector<Mipmap>*> sides;
+		for (const auto& side : data)
+		{
+			if (side.empty() || side.size() != data[0].size())
+			{
+				LOG_ERROR("RHI_Texture::ShaderResource_CreateCubemap: A side containts invalid data.");
+				return false;
+			}
+			sides.emplace_back(&side);
+		}
+
+		auto image = Vulkan_Texture::Create(width, height, format, sides, false, &m_memoryUsage);
+		if (!image)
+		{
+			LOG_ERROR("RHI_Texture::ShaderResource_CreateCubemap: Failed to create texture.");
+			return false;
+		}
+
+		m_shaderResource		= (void*)image;
+		m_shaderResourceWidth	= image->width;
+		m_shaderResourceHeight	= image->height;
+		m_shaderResourceMips	= image->mipLevels;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Textures, m_memoryUsage);
+		return true;
+	}
+
+	// Not implemented yet, the importer generates the mips on the CPU instead
+	bool RHI_Texture::ShaderResource_GenerateMips(unsigned int width, unsigned int height, unsigned int channels)
+	{
+		return false;
+	}
+
+	bool RHI_Texture::ShaderResource_ReadMips(vector<Mipmap>* mips)
+	{
+		return false;
+	}
+
+	void RHI_Texture::ShaderResource_Release()
+	{
+		if (auto image = (Image*)m_shaderResource)
+		{
+			Image_Destroy(image);
+			delete image;
+			m_shaderResource = nullptr;
+		}
+	}
+}
+#endif
@@ -0,0 +1,194 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =====================
+#include "Vulkan_Common.h"
+#include "../RHI_TextureArray.h"
+#include "../RHI_Texture.h"
+#include "../RHI_Device.h"
+#include "../../Logging/Log.h"
+#include "../../Math/MathHelper.h"
+//================================
+
+//= NAMESPACES =======================
+using namespace std;
+using namespace Directus::Math::Helper;
+using namespace Directus::Vulkan_Common;
+//====================================
+
+namespace Directus
+{
+	RHI_TextureArray::RHI_TextureArray(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice			= rhiDevice;
+		m_texture			= nullptr;
+		m_shaderResource	= nullptr;
+		m_width				= 0;
+		m_height			= 0;
+		m_mipCount			= 0;
+		m_sliceCount		= 0;
+		m_format			= Texture_Format_R8G8B8A8_UNORM;
+		m_cubemap			= false;
+		m_bytes				= 0;
+	}
+
+	RHI_TextureArray::~RHI_TextureArray()
+	{
+		// The view is the image itself
+		if (auto image = (Image*)m_texture)
+		{
+			Image_Destroy(image);
+			delete image;
+		}
+		m_texture			= nullptr;
+		m_shaderResource	= nullptr;
+	}
+
+	bool RHI_TextureArray::Create(unsigned int width, unsigned int height, unsigned int mipCount, Texture_Format format, unsigned int sliceCount, bool cubemap /*= false*/)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_TextureArray::Create: Invalid RHI device");
+			return false;
+		}
+
+		auto image = new Image();
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		// A cubemap's faces are consecutive layers of the image
+		unsigned int faces	= cubemap ? 6 : 1;
+		bool result			= Image_Create(image, width, height, mipCount, sliceCount * faces, vulkan_format[format], usage, cubemap);
+		if (result)
+		{
+			// Slices that were never copied into read as whatever the memory held, but are never sampled
+			result = Upload([image](VkCommandBuffer commandBuffer, const Staging&)
+			{
+				ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			}) != 0;
+		}
+
+		if (!result)
+		{
+			LOG_ERROR("RHI_TextureArray::Create: Failed to create image");
+			Image_Destroy(image);
+			delete image;
+			return false;
+		}
+		image->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		// Every slice has the same mip chain (a rough estimation, like the textures' own)
+		unsigned long long sliceBytes = 0;
+		for (unsigned int mip = 0; mip < mipCount; mip++)
+		{
+			unsigned int mipWidth	= Max(width >> mip, 1u);
+			unsigned int mipHeight	= Max(height >> mip, 1u);
+			unsigned int rows		= RHI_Texture::Format_IsCompressed(format) ? Max((mipHeight + 3) / 4, 1u) : mipHeight;
+			sliceBytes += (unsigned long long)RHI_Texture::Format_GetRowPitch(format, mipWidth, 4) * rows * faces;
+		}
+
+		m_texture			= (void*)image;
+		m_shaderResource	= m_texture;
+		m_width				= width;
+		m_height			= height;
+		m_mipCount			= mipCount;
+		m_sliceCount		= sliceCount;
+		m_format			= format;
+		m_cubemap		= cubemap;
+		m_bytes				= sliceBytes * sliceCount;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Textures, m_bytes);
+		return true;
+	}
+
+	bool RHI_TextureArray::Slice_Copy(unsigned int slice, const RHI_Texture* texture)
+	{
+		auto image	= (Image*)m_texture;
+		auto source	= texture ? (Image*)texture->GetShaderResource() : nullptr;
+		if (!image || !source || slice >= m_sliceCount)
+			return false;
+
+		// Both have to agree, or the copy reads the wrong mips
+		uint32_t faces = m_cubemap ? 6 : 1;
+		if (source->width != m_width || source->height != m_height || source->mipLevels != m_mipCount || source->format != image->format || source->layers != faces)
+		{
+			LOG_ERROR("RHI_TextureArray::Slice_Copy: The texture doesn't match the array");
+			return false;
+		}
+
+		vector<VkImageCopy> regions;
+		for (uint32_t mip = 0; mip < m_mipCount; mip++)
+		{
+			VkImageCopy region		= {};
+			region.srcSubresource	= { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, faces };
+			region.dstSubresource	= { VK_IMAGE_ASPECT_COLOR_BIT, mip, slice * faces, faces };
+			region.extent			= { Max(m_width >> mip, 1u), Max(m_height >> mip, 1u), 1 };
+			regions.emplace_back(region);
+		}
+
+		return Upload([image, source, &regions](VkCommandBuffer commandBuffer, const Staging&)
+		{
+			ImageLayout(commandBuffer, source, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+			ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+			vkCmdCopyImage(commandBuffer, source->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+			ImageLayout(commandBuffer, source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}) != 0;
+	}
+
+	bool RHI_TextureArray::Slices_Copy(const RHI_TextureArray* source)
+	{
+		auto image			= (Image*)m_texture;
+		auto sourceImage	= source ? (Image*)source->m_texture : nullptr;
+		if (!image || !sourceImage)
+			return false;
+
+		if (source->m_width != m_width || source->m_height != m_height || source->m_mipCount != m_mipCount || source->m_format != m_format || source->m_cubemap != m_cubemap)
+		{
+			LOG_ERROR("RHI_TextureArray::Slices_Copy: The arrays don't match");
+			return false;
+		}
+
+		// One region per mip covers all the slices both have
+		uint32_t slices = Min(m_sliceCount, source->m_sliceCount) * (m_cubemap ? 6 : 1);
+		vector<VkImageCopy> regions;
+		for (uint32_t mip = 0; mip < m_mipCount; mip++)
+		{
+			VkImageCopy region		= {};
+			region.srcSubresource	= { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, slices };
+			region.dstSubresource	= { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, slices };
+			region.extent			= { Max(m_width >> mip, 1u), Max(m_height >> mip, 1u), 1 };
+			regions.emplace_back(region);
+		}
+
+		return Upload([image, sourceImage, &regions](VkCommandBuffer commandBuffer, const Staging&)
+		{
+			ImageLayout(commandBuffer, sourceImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+			ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+			vkCmdCopyImage(commandBuffer, sourceImage->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+			ImageLayout(commandBuffer, sourceImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			ImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}) != 0;
+	}
+}
+#endif
@@ -0,0 +1,238 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_VULKAN 
+//================================
+
+//= INCLUDES =====================
+#include "Vulkan_Common.h"
+#include "../RHI_Device.h"
+#include "../RHI_VertexBuffer.h"
+#include "../RHI_Capture.h"
+#include "../RHI_Vertex.h"
+#include "../../Logging/Log.h"
+//================================
+
+//= NAMESPACES ===================
+using namespace std;
+using namespace Directus::Vulkan_Common;
+//================================
+
+namespace Directus
+{
+	namespace Vulkan_VertexBuffer
+	{
+		inline bool Create(void** buffer, VkDeviceSize size, bool dynamic, const void* data, VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+		{
+			auto vkBuffer = new Buffer();
+			if (!Buffer_Create(vkBuffer, size, usage, dynamic, data))
+			{
+				LOG_ERROR("RHI_VertexBuffer::Create: Failed to create vertex buffer");
+				delete vkBuffer;
+				return false;
+			}
+
+			*buffer = (void*)vkBuffer;
+			return true;
+		}
+	}
+
+	RHI_VertexBuffer::RHI_VertexBuffer(std::shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice		= rhiDevice;
+		m_buffer				= nullptr;
+		m_unorderedAccessView	= nullptr;
+		m_stride				= 0;
+		m_memoryUsage			= 0;
+	}
+
+	RHI_VertexBuffer::~RHI_VertexBuffer()
+	{
+		if (auto buffer = (Buffer*)m_buffer)
+		{
+			Buffer_Destroy(buffer);
+			delete buffer;
+		}
+	}
+
+	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosCol>& vertices)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice() || vertices.empty())
+		{
+			LOG_ERROR("RHI_VertexBuffer::Create: Invalid parameter");
+			return false;
+		}
+
+		m_stride		= sizeof(RHI_Vertex_PosCol);
+		m_memoryUsage	= (unsigned int)(m_stride * vertices.size());
+		if (!Vulkan_VertexBuffer::Create(&m_buffer, m_memoryUsage, false, vertices.data()))
+			return false;
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosUV>& vertices)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice() || vertices.empty())
+		{
+			LOG_ERROR("RHI_VertexBuffer::Create: Invalid parameter");
+			return false;
+		}
+
+		m_stride		= sizeof(RHI_Vertex_PosUV);
+		m_memoryUsage	= (unsigned int)(m_stride * vertices.size());
+		if (!Vulkan_VertexBuffer::Create(&m_buffer, m_memoryUsage, false, vertices.data()))
+			return false;
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosUVTBN>& vertices)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice() || vertices.empty())
+		{
+			LOG_ERROR("RHI_VertexBuffer::Create: Invalid parameter");
+			return false;
+		}
+
+		m_stride		= sizeof(RHI_Vertex_PosUVTBN);
+		m_memoryUsage	= (unsigned int)(m_stride * vertices.size());
+		if (!Vulkan_VertexBuffer::Create(&m_buffer, m_memoryUsage, false, vertices.data()))
+			return false;
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_VertexBuffer::Create(const vector<RHI_Vertex_PosUVTBNPacked>& vertices)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice() || vertices.empty())
+		{
+			LOG_ERROR("RHI_VertexBuffer::Create: Invalid parameter");
+			return false;
+		}
+
+		m_stride		= sizeof(RHI_Vertex_PosUVTBNPacked);
+		m_memoryUsage	= (unsigned int)(m_stride * vertices.size());
+		if (!Vulkan_VertexBuffer::Create(&m_buffer, m_memoryUsage, false, vertices.data()))
+			return false;
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Meshes, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_VertexBuffer::CreateDynamic(unsigned int stride, unsigned int initialSize)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_VertexBuffer::CreateDynamic: Invalid RHI device");
+			return false;
+		}
+
+		m_stride		= stride;
+		m_memoryUsage	= m_stride * initialSize;
+		if (!Vulkan_VertexBuffer::Create(&m_buffer, m_memoryUsage, true, nullptr))
+			return false;
+
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, m_memoryUsage);
+		return true;
+	}
+
+	bool RHI_VertexBuffer::CreateUnorderedAccess(unsigned int stride, unsigned int vertexCount)
+	{
+		if (!m_rhiDevice || !RHI_Backend::GetDevice())
+		{
+			LOG_ERROR("RHI_VertexBuffer::CreateUnorderedAccess: Invalid RHI device");
+			return false;
+		}
+
+		// A storage buffer is as good as a raw view, compute writes it and draws read it as vertices
+		m_stride		= stride;
+		m_memoryUsage	= m_stride * vertexCount;
+		if (!Vulkan_VertexBuffer::Create(&m_buffer, m_memoryUsage, false, nullptr, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+			return false;
+
+		m_unorderedAccessView = m_buffer;
+		m_memoryTracker.Set(m_rhiDevice, Memory_Buffers, m_memoryUsage);
+		return true;
+	}
+
+	void* RHI_VertexBuffer::Map(bool discard /*= true*/)
+	{
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_VertexBuffer::Map: Invalid buffer");
+			return nullptr;
+		}
+
+		// Dynamic buffers are persistently mapped, discarding renames them
+		auto data = Buffer_Map((Buffer*)m_buffer, discard);
+		if (!data)
+		{
+			LOG_ERROR("RHI_VertexBuffer::Map: Failed to map vertex buffer");
+		}
+
+		RHI_CAPTURE(Record_Map(Capture_UpdateVertexBuffer, this, m_buffer, data, m_memoryUsage, discard));
+		return data;
+	}
+
+	bool RHI_VertexBuffer::Unmap()
+	{
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_VertexBuffer::Unmap: Invalid buffer");
+			return false;
+		}
+		RHI_CAPTURE(Record_Unmap(this));
+
+		// Host coherent memory, the writes are visible to the next submission
+		return true;
+	}
+
+	bool RHI_VertexBuffer::Bind()
+	{
+		RHI_CAPTURE(Record(Capture_BindVertexBuffer, {}, { this }));
+
+		auto recorder = m_rhiDevice ? RHI_Backend::GetContext() : nullptr;
+		if (!recorder)
+		{
+			LOG_ERROR("RHI_VertexBuffer::Bind: Invalid RHI device");
+			return false;
+		}
+
+		if (!m_buffer)
+		{
+			LOG_ERROR("RHI_VertexBuffer::Bind: Invalid buffer");
+			return false;
+		}
+
+		recorder->vertexBuffer.buffer	= (Buffer*)m_buffer;
+		recorder->vertexBuffer.offset	= 0;
+		recorder->vertexStride			= m_stride;
+		recorder->vertexBufferBound		= VK_NULL_HANDLE;
+		return true;
+	}
+}
+#endif
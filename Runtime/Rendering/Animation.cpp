@@ -19,13 +19,207 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========
+//= INCLUDES ==================
 #include "Animation.h"
-//====================
+#include "../IO/FileStream.h"
+#include "../Math/MathHelper.h"
+#include <algorithm>
+//=============================
 
-//= NAMESPACES =====
+//= NAMESPACES ================
 using namespace std;
-//==================
+using namespace Directus::Math;
+//=============================
+
+// How many keys the search for one walks forward from where the last ended, before it takes a binary search
+#define ANIMATION_CURSOR_STEPS 4
+
+namespace _Animation
+{
+	// The last key at or before the tick. The search walks forward from the cursor (the key found last time) for
+	// as far as a few frames usually advance, anything else (a loop back, a jump) falls back to a binary search.
+	unsigned int Key_Find(const Directus::AnimationKeys& keys, float tick, unsigned int* cursor)
+	{
+		unsigned int count	= keys.Count();
+		unsigned int key	= *cursor < count ? *cursor : 0;
+		if (keys.Time(key) <= tick)
+		{
+			for (unsigned int step = 0; step < ANIMATION_CURSOR_STEPS && key + 1 < count && keys.Time(key + 1) <= tick; step++)
+			{
+				key++;
+			}
+		}
+
+		if (keys.Time(key) > tick || (key + 1 < count && keys.Time(key + 1) <= tick))
+		{
+			auto next	= upper_bound(keys.time.begin(), keys.time.end(), tick, [&keys](float tick, uint16_t time) { return tick < keys.timeMin + time * keys.timeScale; });
+			key			= next == keys.time.begin() ? 0 : (unsigned int)(next - keys.time.begin()) - 1;
+		}
+
+		*cursor = key;
+		return key;
+	}
+
+	// Writes the keys around the tick into the pose and the next pose (from the first of its components on), and how far toward
+	// the second the tick is. Before the first key and after the last the track holds still.
+	void Track_Sample(const Directus::AnimationKeys& keys, unsigned int components, float tick, unsigned int* cursor, float* pose, float* next, unsigned int stride, float* weight)
+	{
+		unsigned int count = keys.Count();
+		if (count == 0)
+			return;
+
+		unsigned int a	= Key_Find(keys, tick, cursor);
+		unsigned int b	= a + 1 < count && keys.Time(a) <= tick ? a + 1 : a;
+		float timeA		= keys.Time(a);
+		float timeB		= keys.Time(b);
+		*weight			= timeB > timeA ? (tick - timeA) / (timeB - timeA) : 0.0f;
+
+		for (unsigned int i = 0; i < components; i++)
+		{
+			pose[i * stride] = keys.Value(i, a);
+			next[i * stride] = keys.Value(i, b);
+		}
+	}
+
+	//= KEY REDUCTION =========================================================================================================
+	float Key_Component(const Vector3& value, unsigned int component)		{ return component == 0 ? value.x : component == 1 ? value.y : value.z; }
+	float Key_Component(const Quaternion& value, unsigned int component)	{ return component == 0 ? value.x : component == 1 ? value.y : component == 2 ? value.z : value.w; }
+
+	// How far a key is from where the keys around it would interpolate to
+	float Key_Error(const Vector3& a, const Vector3& b, float t, const Vector3& value)
+	{
+		return (Helper::Lerp(a, b, t) - value).Length();
+	}
+
+	// In radians, along the shorter arc like sampling
+	float Key_Error(const Quaternion& a, const Quaternion& b, float t, const Quaternion& value)
+	{
+		float sign = (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w) < 0.0f ? -1.0f : 1.0f;
+		Quaternion interpolated = Quaternion(
+			Helper::Lerp(a.x, b.x * sign, t),
+			Helper::Lerp(a.y, b.y * sign, t),
+			Helper::Lerp(a.z, b.z * sign, t),
+			Helper::Lerp(a.w, b.w * sign, t)
+		).Normalized();
+
+		float dot = Helper::Abs(interpolated.x * value.x + interpolated.y * value.y + interpolated.z * value.z + interpolated.w * value.w);
+		return 2.0f * acos(Helper::Min(dot, 1.0f));
+	}
+
+	// Grows every run of keys for as long as interpolating between its ends keeps the keys inside it within the tolerance
+	template <typename T>
+	vector<T> Keys_Reduce(const vector<T>& keys, float tolerance)
+	{
+		if (keys.size() < 2)
+			return keys;
+
+		vector<T> kept		= { keys[0] };
+		unsigned int anchor	= 0;
+		for (unsigned int end = 2; end < (unsigned int)keys.size(); end++)
+		{
+			bool fits		= true;
+			double duration	= keys[end].time - keys[anchor].time;
+			for (unsigned int i = anchor + 1; i < end && fits; i++)
+			{
+				float t	= duration > 0.0 ? (float)((keys[i].time - keys[anchor].time) / duration) : 0.0f;
+				fits	= Key_Error(keys[anchor].value, keys[end].value, t, keys[i].value) <= tolerance;
+			}
+
+			if (!fits)
+			{
+				anchor = end - 1;
+				kept.emplace_back(keys[anchor]);
+			}
+		}
+		kept.emplace_back(keys.back());
+
+		// A track that holds still is a single key
+		if (kept.size() == 2 && Key_Error(kept[0].value, kept[0].value, 0.0f, kept[1].value) <= tolerance)
+		{
+			kept.pop_back();
+		}
+
+		return kept;
+	}
+	//=========================================================================================================================
+
+	//= QUANTIZATION ==========================================================================================================
+	// A value's step (and so scale) between min and max divided into 16 bits
+	uint16_t Quantize(float value, float min, float scale)
+	{
+		return scale > 0.0f ? (uint16_t)Helper::Clamp((value - min) / scale + 0.5f, 0.0f, 65535.0f) : 0;
+	}
+
+	template <typename T>
+	void Keys_Quantize(const vector<T>& keys, unsigned int components, Directus::AnimationKeys* quantized)
+	{
+		auto range = [&keys](auto get, float* min, float* scale)
+		{
+			float max	= -FLT_MAX;
+			*min		= FLT_MAX;
+			for (const auto& key : keys)
+			{
+				*min	= Helper::Min(*min, get(key));
+				max		= Helper::Max(max, get(key));
+			}
+			*scale = keys.empty() ? 0.0f : (max - *min) / 65535.0f;
+		};
+
+		range([](const T& key) { return (float)key.time; }, &quantized->timeMin, &quantized->timeScale);
+		quantized->time.resize(keys.size());
+		for (unsigned int i = 0; i < (unsigned int)keys.size(); i++)
+		{
+			quantized->time[i] = Quantize((float)keys[i].time, quantized->timeMin, quantized->timeScale);
+		}
+
+		for (unsigned int c = 0; c < components; c++)
+		{
+			range([c](const T& key) { return Key_Component(key.value, c); }, &quantized->valueMin[c], &quantized->valueScale[c]);
+			quantized->values[c].resize(keys.size());
+			for (unsigned int i = 0; i < (unsigned int)keys.size(); i++)
+			{
+				quantized->values[c][i] = Quantize(Key_Component(keys[i].value, c), quantized->valueMin[c], quantized->valueScale[c]);
+			}
+		}
+	}
+	//=========================================================================================================================
+
+	void Values_Write(Directus::FileStream* stream, float min, float scale, const vector<uint16_t>& values)
+	{
+		stream->Write(min);
+		stream->Write(scale);
+		stream->WriteBytes(values.data(), values.size() * sizeof(uint16_t));
+	}
+
+	void Values_Read(Directus::FileStream* stream, float* min, float* scale, vector<uint16_t>* values, unsigned int count)
+	{
+		stream->Read(min);
+		stream->Read(scale);
+		values->resize(count);
+		stream->ReadBytes(values->data(), count * sizeof(uint16_t));
+	}
+
+	// The key count, then the range and the array of every component in a row
+	void Keys_Write(Directus::FileStream* stream, const Directus::AnimationKeys& keys, unsigned int components)
+	{
+		stream->Write(keys.Count());
+		Values_Write(stream, keys.timeMin, keys.timeScale, keys.time);
+		for (unsigned int c = 0; c < components; c++)
+		{
+			Values_Write(stream, keys.valueMin[c], keys.valueScale[c], keys.values[c]);
+		}
+	}
+
+	void Keys_Read(Directus::FileStream* stream, Directus::AnimationKeys* keys, unsigned int components)
+	{
+		unsigned int count = stream->ReadUInt();
+		Values_Read(stream, &keys->timeMin, &keys->timeScale, &keys->time, count);
+		for (unsigned int c = 0; c < components; c++)
+		{
+			Values_Read(stream, &keys->valueMin[c], &keys->valueScale[c], &keys->values[c], count);
+		}
+	}
+}
 
 namespace Directus
 {
@@ -50,4 +244,78 @@ namespace Directus
 	{
 		return true;
 	}
+
+	void Animation::AddChannel(const AnimationNode& node, const AnimationTolerance& tolerance /* AnimationTolerance() */)
+	{
+		AnimationChannel channel;
+		channel.name = node.name;
+		_Animation::Keys_Quantize(_Animation::Keys_Reduce(node.positionFrames, tolerance.position), 3, &channel.position);
+		_Animation::Keys_Quantize(_Animation::Keys_Reduce(node.rotationFrames, tolerance.rotation), 4, &channel.rotation);
+		_Animation::Keys_Quantize(_Animation::Keys_Reduce(node.scaleFrames, tolerance.scale), 3, &channel.scale);
+
+		m_channels.emplace_back(move(channel));
+	}
+
+	void Animation::Sample(double tick, const vector<int>& channelBones, AnimationCursor* cursor, AnimationPose* pose) const
+	{
+		if (!cursor || !pose)
+			return;
+
+		unsigned int stride = pose->GetStride();
+		if (cursor->keys.size() != m_channels.size() * 3)
+		{
+			cursor->keys.assign(m_channels.size() * 3, 0);
+		}
+		cursor->weightPosition.assign(stride, 0.0f);
+		cursor->weightRotation.assign(stride, 0.0f);
+		cursor->weightScale.assign(stride, 0.0f);
+		cursor->next = *pose;
+
+		// Gather the keys around the tick of every bone, then interpolate them together
+		float tickKeys = (float)tick;
+		for (unsigned int i = 0; i < (unsigned int)m_channels.size() && i < (unsigned int)channelBones.size(); i++)
+		{
+			int bone = channelBones[i];
+			if (bone < 0 || (unsigned int)bone >= pose->GetBoneCount())
+				continue;
+
+			const AnimationChannel& channel = m_channels[i];
+			unsigned int* keys				= &cursor->keys[i * 3];
+			_Animation::Track_Sample(channel.position, 3, tickKeys, &keys[0], pose->GetComponent(AnimationPose::Position_X) + bone, cursor->next.GetComponent(AnimationPose::Position_X) + bone, stride, &cursor->weightPosition[bone]);
+			_Animation::Track_Sample(channel.rotation, 4, tickKeys, &keys[1], pose->GetComponent(AnimationPose::Rotation_X) + bone, cursor->next.GetComponent(AnimationPose::Rotation_X) + bone, stride, &cursor->weightRotation[bone]);
+			_Animation::Track_Sample(channel.scale, 3, tickKeys, &keys[2], pose->GetComponent(AnimationPose::Scale_X) + bone, cursor->next.GetComponent(AnimationPose::Scale_X) + bone, stride, &cursor->weightScale[bone]);
+		}
+
+		AnimationPose::Interpolate(*pose, cursor->next, cursor->weightPosition.data(), cursor->weightRotation.data(), cursor->weightScale.data(), pose);
+	}
+
+	void Animation::Serialize(FileStream* stream)
+	{
+		stream->Write(m_name);
+		stream->Write(m_duration);
+		stream->Write(m_ticksPerSec);
+		stream->Write((unsigned int)m_channels.size());
+		for (const auto& channel : m_channels)
+		{
+			stream->Write(channel.name);
+			_Animation::Keys_Write(stream, channel.position, 3);
+			_Animation::Keys_Write(stream, channel.rotation, 4);
+			_Animation::Keys_Write(stream, channel.scale, 3);
+		}
+	}
+
+	void Animation::Deserialize(FileStream* stream)
+	{
+		stream->Read(&m_name);
+		stream->Read(&m_duration);
+		stream->Read(&m_ticksPerSec);
+		m_channels.resize(stream->ReadUInt());
+		for (auto& channel : m_channels)
+		{
+			stream->Read(&channel.name);
+			_Animation::Keys_Read(stream, &channel.position, 3);
+			_Animation::Keys_Read(stream, &channel.rotation, 4);
+			_Animation::Keys_Read(stream, &channel.scale, 3);
+		}
+	}
 }
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include "../Resource/IResource.h"
 #include "../Math/Matrix.h"
+#include "AnimationPose.h"
 //================================
 
 namespace Directus
@@ -61,6 +62,54 @@ namespace Directus
 		std::vector<KeyVector> scaleFrames;
 	};
 
+	// The keys of one track in SoA layout, each component quantized to 16 bits over the range it spans in the track.
+	// w is only there for rotations.
+	struct AnimationKeys
+	{
+		unsigned int Count() const											{ return (unsigned int)time.size(); }
+		float Time(unsigned int key) const									{ return timeMin + time[key] * timeScale; }
+		float Value(unsigned int component, unsigned int key) const			{ return valueMin[component] + values[component][key] * valueScale[component]; }
+
+		std::vector<uint16_t> time;
+		std::vector<uint16_t> values[4];
+		float timeMin		= 0.0f;
+		float timeScale		= 0.0f;
+		float valueMin[4]	= { 0.0f, 0.0f, 0.0f, 0.0f };
+		float valueScale[4]	= { 0.0f, 0.0f, 0.0f, 0.0f };
+	};
+
+	// How far a channel may stray from its imported keys, the keys interpolating their neighbours within it are
+	// dropped. Zero only drops the ones that change nothing (e.g. all but one key of a track that holds still).
+	struct AnimationTolerance
+	{
+		float position	= 0.0f;
+		float rotation	= 0.0f; // radians
+		float scale		= 0.0f;
+	};
+
+	// An imported AnimationNode rearranged for sampling
+	struct AnimationChannel
+	{
+		std::string name;
+		AnimationKeys position;
+		AnimationKeys rotation;
+		AnimationKeys scale;
+	};
+
+	// What sampling an animation remembers between calls, one for each character playing it. Ticks tend to
+	// advance by a little every frame, so the search for the keys around one starts where the last ended.
+	struct AnimationCursor
+	{
+		std::vector<unsigned int> keys; // three per channel, the last position, rotation and scale key found
+		// Scratch for sampling, the poses of the keys after the tick and how far the tick is toward them
+		AnimationPose next;
+		std::vector<float> weightPosition;
+		std::vector<float> weightRotation;
+		std::vector<float> weightScale;
+	};
+
+	class FileStream;
+
 	class ENGINE_CLASS Animation : public IResource
 	{
 	public:
@@ -75,6 +124,21 @@ namespace Directus
 		void SetName(const std::string& name) { m_name = name; }
 		void SetDuration(double duration) { m_duration = duration; }
 		void SetTicksPerSec(double ticksPerSec) { m_ticksPerSec = ticksPerSec; }
+		void AddChannel(const AnimationNode& node, const AnimationTolerance& tolerance = AnimationTolerance());
+
+		const std::string& GetName() const { return m_name; }
+		// In ticks
+		double GetDuration() const { return m_duration; }
+		double GetTicksPerSec() const { return m_ticksPerSec; }
+		const std::vector<AnimationChannel>& GetChannels() const { return m_channels; }
+
+		// The pose at a tick, channelBones maps each channel to the bone of the pose it moves (-1 for none). What the
+		// channels have no keys for is left as it was in the pose.
+		void Sample(double tick, const std::vector<int>& channelBones, AnimationCursor* cursor, AnimationPose* pose) const;
+
+		// Animations are written into the model file they came with
+		void Serialize(FileStream* stream);
+		void Deserialize(FileStream* stream);
 
 	private:
 		std::string m_name;
@@ -82,6 +146,6 @@ namespace Directus
 		double m_ticksPerSec;
 
 		// Each channel controls a single node
-		std::vector<AnimationNode> m_channels;
+		std::vector<AnimationChannel> m_channels;
 	};
 }
\ No newline at end of file
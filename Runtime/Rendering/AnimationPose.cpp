@@ -0,0 +1,168 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "AnimationPose.h"
+#include "../Math/SIMD.h"
+#include "../Math/MathHelper.h"
+//=========================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Directus::Math::SIMD;
+//=============================
+
+namespace _AnimationPose
+{
+	// A single weight is splatted, otherwise there's one per bone
+	template <bool uniform>
+	inline Float4 Weight(const float* weight, unsigned int i) { return uniform ? Splat(weight[0]) : Load(weight + i); }
+
+	template <bool uniform>
+	void Lerp(const float* a, const float* b, const float* weight, float* out, unsigned int stride, unsigned int components)
+	{
+		for (unsigned int c = 0; c < components; c++)
+		{
+			for (unsigned int i = 0; i < stride; i += 4)
+			{
+				Float4 from = Load(a + c * stride + i);
+				Store(out + c * stride + i, MulAdd(Sub(Load(b + c * stride + i), from), Weight<uniform>(weight, i), from));
+			}
+		}
+	}
+
+	// Normalized lerp, through the shorter arc
+	template <bool uniform>
+	void Nlerp(const float* a, const float* b, const float* weight, float* out, unsigned int stride)
+	{
+		const Float4 zero = Splat(0.0f);
+		for (unsigned int i = 0; i < stride; i += 4)
+		{
+			Float4 ax = Load(a + i), ay = Load(a + stride + i), az = Load(a + stride * 2 + i), aw = Load(a + stride * 3 + i);
+			Float4 bx = Load(b + i), by = Load(b + stride + i), bz = Load(b + stride * 2 + i), bw = Load(b + stride * 3 + i);
+
+			Float4 dot		= MulAdd(ax, bx, MulAdd(ay, by, MulAdd(az, bz, Mul(aw, bw))));
+			Float4 flip		= Less(dot, zero);
+			bx				= Select(flip, Sub(zero, bx), bx);
+			by				= Select(flip, Sub(zero, by), by);
+			bz				= Select(flip, Sub(zero, bz), bz);
+			bw				= Select(flip, Sub(zero, bw), bw);
+
+			Float4 t		= Weight<uniform>(weight, i);
+			Float4 x		= MulAdd(Sub(bx, ax), t, ax);
+			Float4 y		= MulAdd(Sub(by, ay), t, ay);
+			Float4 z		= MulAdd(Sub(bz, az), t, az);
+			Float4 w		= MulAdd(Sub(bw, aw), t, aw);
+			Float4 length	= Sqrt(MulAdd(x, x, MulAdd(y, y, MulAdd(z, z, Mul(w, w)))));
+
+			Store(out + i,				Div(x, length));
+			Store(out + stride + i,		Div(y, length));
+			Store(out + stride * 2 + i,	Div(z, length));
+			Store(out + stride * 3 + i,	Div(w, length));
+		}
+	}
+
+	template <bool uniform>
+	void Pose_Interpolate(const Directus::AnimationPose& a, const Directus::AnimationPose& b, const float* weightPosition, const float* weightRotation, const float* weightScale, Directus::AnimationPose* out)
+	{
+		using Pose				= Directus::AnimationPose;
+		unsigned int stride		= a.GetStride();
+		if (out->GetBoneCount() != a.GetBoneCount())
+		{
+			out->Resize(a.GetBoneCount());
+		}
+
+		Lerp<uniform>(a.GetComponent(Pose::Position_X), b.GetComponent(Pose::Position_X), weightPosition, out->GetComponent(Pose::Position_X), stride, 3);
+		Nlerp<uniform>(a.GetComponent(Pose::Rotation_X), b.GetComponent(Pose::Rotation_X), weightRotation, out->GetComponent(Pose::Rotation_X), stride);
+		Lerp<uniform>(a.GetComponent(Pose::Scale_X), b.GetComponent(Pose::Scale_X), weightScale, out->GetComponent(Pose::Scale_X), stride, 3);
+	}
+}
+
+namespace Directus
+{
+	void AnimationPose::Resize(unsigned int boneCount)
+	{
+		// The padding is in the identity transform too, so it normalizes like any other rotation
+		unsigned int stride = (boneCount + 3) & ~3u;
+		m_boneCount			= boneCount;
+		if (stride == m_stride)
+			return;
+
+		vector<float> components(stride * Component_Count, 0.0f);
+		for (unsigned int i = 0; i < stride; i++)
+		{
+			components[Rotation_W * stride + i]	= 1.0f;
+			components[Scale_X * stride + i]	= 1.0f;
+			components[Scale_Y * stride + i]	= 1.0f;
+			components[Scale_Z * stride + i]	= 1.0f;
+		}
+		for (unsigned int c = 0; c < Component_Count; c++)
+		{
+			for (unsigned int i = 0; i < Helper::Min(stride, m_stride); i++)
+			{
+				components[c * stride + i] = m_components[c * m_stride + i];
+			}
+		}
+
+		m_components	= move(components);
+		m_stride		= stride;
+	}
+
+	void AnimationPose::Set(unsigned int bone, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+	{
+		float* data = &m_components[bone];
+		data[Position_X * m_stride] = position.x;
+		data[Position_Y * m_stride] = position.y;
+		data[Position_Z * m_stride] = position.z;
+		data[Rotation_X * m_stride] = rotation.x;
+		data[Rotation_Y * m_stride] = rotation.y;
+		data[Rotation_Z * m_stride] = rotation.z;
+		data[Rotation_W * m_stride] = rotation.w;
+		data[Scale_X * m_stride]	= scale.x;
+		data[Scale_Y * m_stride]	= scale.y;
+		data[Scale_Z * m_stride]	= scale.z;
+	}
+
+	void AnimationPose::Get(unsigned int bone, Vector3* position, Quaternion* rotation, Vector3* scale) const
+	{
+		const float* data	= &m_components[bone];
+		*position			= Vector3(data[Position_X * m_stride], data[Position_Y * m_stride], data[Position_Z * m_stride]);
+		*rotation			= Quaternion(data[Rotation_X * m_stride], data[Rotation_Y * m_stride], data[Rotation_Z * m_stride], data[Rotation_W * m_stride]);
+		*scale				= Vector3(data[Scale_X * m_stride], data[Scale_Y * m_stride], data[Scale_Z * m_stride]);
+	}
+
+	void AnimationPose::Blend(const AnimationPose& a, const AnimationPose& b, float weight, AnimationPose* out)
+	{
+		if (a.GetBoneCount() != b.GetBoneCount())
+			return;
+
+		_AnimationPose::Pose_Interpolate<true>(a, b, &weight, &weight, &weight, out);
+	}
+
+	void AnimationPose::Interpolate(const AnimationPose& a, const AnimationPose& b, const float* weightPosition, const float* weightRotation, const float* weightScale, AnimationPose* out)
+	{
+		if (a.GetBoneCount() != b.GetBoneCount())
+			return;
+
+		_AnimationPose::Pose_Interpolate<false>(a, b, weightPosition, weightRotation, weightScale, out);
+	}
+}
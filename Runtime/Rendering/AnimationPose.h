@@ -0,0 +1,68 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <vector>
+#include "../Core/EngineDefs.h"
+#include "../Math/Vector3.h"
+#include "../Math/Quaternion.h"
+//===============================
+
+namespace Directus
+{
+	// A skeleton's local transforms (see ModelBone) in SoA layout, every component in an array of its own and
+	// each array padded to a multiple of four bones, so poses are interpolated and blended four bones at a time.
+	class ENGINE_CLASS AnimationPose
+	{
+	public:
+		enum Component
+		{
+			Position_X, Position_Y, Position_Z,
+			Rotation_X, Rotation_Y, Rotation_Z, Rotation_W,
+			Scale_X, Scale_Y, Scale_Z,
+			Component_Count
+		};
+
+		// Bones added by resizing are in the identity transform
+		void Resize(unsigned int boneCount);
+		unsigned int GetBoneCount() const	{ return m_boneCount; }
+		// How many floats apart two components of a bone are
+		unsigned int GetStride() const		{ return m_stride; }
+
+		void Set(unsigned int bone, const Math::Vector3& position, const Math::Quaternion& rotation, const Math::Vector3& scale);
+		void Get(unsigned int bone, Math::Vector3* position, Math::Quaternion* rotation, Math::Vector3* scale) const;
+
+		float* GetComponent(Component component)				{ return &m_components[component * m_stride]; }
+		const float* GetComponent(Component component) const	{ return &m_components[component * m_stride]; }
+
+		// From a toward b by a weight (0 is a), rotations take the shorter arc. The output can be either input.
+		static void Blend(const AnimationPose& a, const AnimationPose& b, float weight, AnimationPose* out);
+		// Like Blend with a weight per bone and track, one array (of the padded bone count) each for positions, rotations and scales
+		static void Interpolate(const AnimationPose& a, const AnimationPose& b, const float* weightPosition, const float* weightRotation, const float* weightScale, AnimationPose* out);
+
+	private:
+		std::vector<float> m_components;
+		unsigned int m_boneCount	= 0;
+		unsigned int m_stride		= 0;
+	};
+}
@@ -0,0 +1,423 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "DebugDraw.h"
+#include <cstring>
+#include <cmath>
+#include "../RHI/RHI_Device.h"
+#include "../RHI/RHI_Pipeline.h"
+#include "../RHI/RHI_VertexBuffer.h"
+#include "../RHI/RHI_IndexBuffer.h"
+#include "../RHI/RHI_ConstantBuffer.h"
+#include "../RHI/RHI_Shader.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/MathHelper.h"
+//==============================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+#define DEBUG_SPHERE_SEGMENTS 32 // per circle, a sphere is three of them
+
+namespace Directus
+{
+	DebugDraw::DebugDraw(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+
+		m_lineCapacity	= DEBUG_LINE_CAPACITY;
+		m_lineCursor	= m_lineCapacity; // a new buffer has to be discarded before it can be appended to
+		m_lineBuffer	= make_shared<RHI_VertexBuffer>(m_rhiDevice);
+		m_lineBuffer->CreateDynamic(sizeof(RHI_Vertex_PosCol), m_lineCapacity);
+
+		m_instanceBuffer = make_shared<RHI_ConstantBuffer>(m_rhiDevice);
+		m_instanceBuffer->CreateRing(sizeof(Struct_Instances), DEBUG_INSTANCE_RING_SIZE, 1, Buffer_VertexShader);
+
+		Primitives_Create();
+	}
+
+	void DebugDraw::Line(const Vector3& from, const Vector3& to, const Vector4& colorFrom, const Vector4& colorTo)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_lines.emplace_back(from, colorFrom);
+		m_lines.emplace_back(to, colorTo);
+	}
+
+	void DebugDraw::Box(const BoundingBox& box, const Vector4& color)
+	{
+		Box(Matrix::CreateScale(box.GetExtents()) * Matrix::CreateTranslation(box.GetCenter()), color);
+	}
+
+	void DebugDraw::Box(const Matrix& transform, const Vector4& color)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_instances[Primitive_Box].push_back({ transform, color });
+	}
+
+	void DebugDraw::Sphere(const Vector3& center, float radius, const Vector4& color)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_instances[Primitive_Sphere].push_back({ Matrix::CreateScale(radius) * Matrix::CreateTranslation(center), color });
+	}
+
+	void DebugDraw::Frustum(const Matrix& viewProjection, const Vector4& color)
+	{
+		// The unit frustum is the clip space volume, the inverse takes it back to the world
+		lock_guard<mutex> lock(m_mutex);
+		m_instances[Primitive_Frustum].push_back({ viewProjection.Inverted(), color });
+	}
+
+	void DebugDraw::Cylinder(const Matrix& transform, const Vector4& color)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_instances[Primitive_Cylinder].push_back({ transform, color });
+	}
+
+	void DebugDraw::Cone(const Matrix& transform, const Vector4& color)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_instances[Primitive_Cone].push_back({ transform, color });
+	}
+
+	bool DebugDraw::Wireframe_Has(uint64_t key)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		return m_wireframes.find(key) != m_wireframes.end();
+	}
+
+	void DebugDraw::Wireframe_Create(uint64_t key, const vector<Vector3>& points, const vector<unsigned int>& lineIndices)
+	{
+		auto wireframe = make_shared<Wireframe_Mesh>();
+		wireframe->vertices.reserve(points.size());
+		for (const auto& point : points)
+		{
+			wireframe->vertices.emplace_back(point, Vector4::One);
+		}
+		wireframe->indices = lineIndices;
+
+		lock_guard<mutex> lock(m_mutex);
+		m_wireframes[key] = wireframe;
+	}
+
+	void DebugDraw::Wireframe_Release(uint64_t key)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_wireframes.erase(key);
+	}
+
+	void DebugDraw::Wireframe(uint64_t key, const Matrix& transform, const Vector4& color)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		auto it = m_wireframes.find(key);
+		if (it != m_wireframes.end())
+		{
+			it->second->instances.push_back({ transform, color });
+		}
+	}
+
+	void DebugDraw::Discard()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_lines.clear();
+		for (auto& instances : m_instances)
+		{
+			instances.clear();
+		}
+		for (const auto& wireframe : m_wireframes)
+		{
+			wireframe.second->instances.clear();
+		}
+	}
+
+	bool DebugDraw::IsEmpty()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (!m_lines.empty())
+			return false;
+
+		for (const auto& instances : m_instances)
+		{
+			if (!instances.empty())
+				return false;
+		}
+
+		for (const auto& wireframe : m_wireframes)
+		{
+			if (!wireframe.second->instances.empty())
+				return false;
+		}
+
+		return true;
+	}
+
+	void DebugDraw::Render(shared_ptr<RHI_Pipeline>& pipeline, const shared_ptr<RHI_ConstantBuffer>& viewProjection, shared_ptr<RHI_Shader>& shaderInstanced)
+	{
+		// Take what was submitted, the capacity stays with the lists so nothing gets reallocated in the steady state
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_linesRendering.swap(m_lines);
+			for (unsigned int i = 0; i < Primitive_Count; i++)
+			{
+				m_instancesRendering[i].swap(m_instances[i]);
+			}
+
+			for (const auto& wireframe : m_wireframes)
+			{
+				if (!wireframe.second->instances.empty())
+				{
+					wireframe.second->instancesRendering.swap(wireframe.second->instances);
+					m_wireframesRendering.emplace_back(wireframe.second);
+				}
+			}
+		}
+
+		Render_Lines(pipeline);
+		Render_Primitives(pipeline, viewProjection, shaderInstanced);
+		Render_Wireframes(pipeline, viewProjection, shaderInstanced);
+
+		m_linesRendering.clear();
+		for (auto& instances : m_instancesRendering)
+		{
+			instances.clear();
+		}
+		for (auto& wireframe : m_wireframesRendering)
+		{
+			wireframe->instancesRendering.clear();
+		}
+		m_wireframesRendering.clear();
+	}
+
+	void DebugDraw::Render_Lines(shared_ptr<RHI_Pipeline>& pipeline)
+	{
+		auto count = (unsigned int)m_linesRendering.size();
+		if (count == 0)
+			return;
+
+		// Grow, rarely, to fit the whole frame
+		if (count > m_lineCapacity)
+		{
+			while (m_lineCapacity < count) { m_lineCapacity *= 2; }
+			m_lineBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
+			m_lineBuffer->CreateDynamic(sizeof(RHI_Vertex_PosCol), m_lineCapacity);
+			m_lineCursor = m_lineCapacity;
+		}
+
+		// Append after what the GPU may still be drawing, start over (discarding) once the ring is full
+		bool discard = m_lineCursor + count > m_lineCapacity;
+		if (discard)
+		{
+			m_lineCursor = 0;
+		}
+
+		auto vertices = (RHI_Vertex_PosCol*)m_lineBuffer->Map(discard);
+		if (!vertices)
+			return;
+		memcpy(vertices + m_lineCursor, &m_linesRendering[0], sizeof(RHI_Vertex_PosCol) * count);
+		m_lineBuffer->Unmap();
+
+		pipeline->SetVertexBuffer(m_lineBuffer);
+		pipeline->Bind();
+		m_rhiDevice->Draw(count, m_lineCursor);
+		m_lineCursor += count;
+	}
+
+	void DebugDraw::Render_Primitives(shared_ptr<RHI_Pipeline>& pipeline, const shared_ptr<RHI_ConstantBuffer>& viewProjection, shared_ptr<RHI_Shader>& shaderInstanced)
+	{
+		bool shaderSet = false;
+		for (unsigned int type = 0; type < Primitive_Count; type++)
+		{
+			const auto& instances = m_instancesRendering[type];
+			if (instances.empty())
+				continue;
+
+			if (!shaderSet)
+			{
+				pipeline->SetShader(shaderInstanced);
+				pipeline->SetVertexBuffer(m_primitiveVertices);
+				pipeline->SetIndexBuffer(m_primitiveIndices);
+				shaderSet = true;
+			}
+
+			if (!Render_Instances(pipeline, viewProjection, instances, m_primitiveRanges[type].indexOffset, m_primitiveRanges[type].indexCount))
+				return;
+		}
+	}
+
+	void DebugDraw::Render_Wireframes(shared_ptr<RHI_Pipeline>& pipeline, const shared_ptr<RHI_ConstantBuffer>& viewProjection, shared_ptr<RHI_Shader>& shaderInstanced)
+	{
+		if (m_wireframesRendering.empty())
+			return;
+
+		pipeline->SetShader(shaderInstanced);
+		for (const auto& wireframe : m_wireframesRendering)
+		{
+			// Uploaded the first time it's drawn
+			if (!wireframe->vertexBuffer)
+			{
+				if (wireframe->vertices.empty() || wireframe->indices.empty())
+					continue;
+
+				wireframe->vertexBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
+				wireframe->vertexBuffer->Create(wireframe->vertices);
+				wireframe->indexBuffer = make_shared<RHI_IndexBuffer>(m_rhiDevice);
+				wireframe->indexBuffer->Create(wireframe->indices);
+				wireframe->indexCount = (unsigned int)wireframe->indices.size();
+				wireframe->vertices.clear();
+				wireframe->vertices.shrink_to_fit();
+				wireframe->indices.clear();
+				wireframe->indices.shrink_to_fit();
+			}
+
+			pipeline->SetVertexBuffer(wireframe->vertexBuffer);
+			pipeline->SetIndexBuffer(wireframe->indexBuffer);
+			if (!Render_Instances(pipeline, viewProjection, wireframe->instancesRendering, 0, wireframe->indexCount))
+				return;
+		}
+	}
+
+	bool DebugDraw::Render_Instances(shared_ptr<RHI_Pipeline>& pipeline, const shared_ptr<RHI_ConstantBuffer>& viewProjection, const vector<Instance>& instances, unsigned int indexOffset, unsigned int indexCount)
+	{
+		for (unsigned int offset = 0; offset < (unsigned int)instances.size(); offset += DEBUG_INSTANCE_BATCH_MAX)
+		{
+			auto count = Min((unsigned int)instances.size() - offset, (unsigned int)DEBUG_INSTANCE_BATCH_MAX);
+
+			unsigned int firstConstant = 0;
+			auto buffer = (Struct_Instances*)m_instanceBuffer->Map(&firstConstant);
+			if (!buffer)
+				return false;
+			for (unsigned int i = 0; i < count; i++)
+			{
+				buffer->m_transform[i]	= instances[offset + i].transform;
+				buffer->m_color[i]		= instances[offset + i].color;
+			}
+			m_instanceBuffer->Unmap();
+
+			// The pipeline forgets constant buffers on every bind
+			pipeline->SetConstantBuffer(viewProjection);
+			pipeline->SetConstantBuffer(m_instanceBuffer, firstConstant);
+			pipeline->Bind();
+
+			m_rhiDevice->DrawIndexedInstanced(indexCount, count, indexOffset, 0);
+		}
+
+		return true;
+	}
+
+	void DebugDraw::Primitives_Create()
+	{
+		vector<RHI_Vertex_PosCol> vertices;
+		vector<unsigned int> indices;
+
+		// The 12 edges of a box with the given depth range, corners are indexed by their (x, y, z) bits
+		auto AddBox = [&vertices, &indices](float zMin, float zMax)
+		{
+			auto first = (unsigned int)vertices.size();
+			for (unsigned int corner = 0; corner < 8; corner++)
+			{
+				vertices.emplace_back(Vector3((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? zMax : zMin), Vector4::One);
+			}
+
+			const unsigned int edges[24] = { 0,1, 2,3, 4,5, 6,7, 0,2, 1,3, 4,6, 5,7, 0,4, 1,5, 2,6, 3,7 };
+			for (auto edge : edges)
+			{
+				indices.emplace_back(first + edge);
+			}
+		};
+
+		// Box
+		m_primitiveRanges[Primitive_Box].indexOffset = (unsigned int)indices.size();
+		AddBox(-1.0f, 1.0f);
+		m_primitiveRanges[Primitive_Box].indexCount = (unsigned int)indices.size() - m_primitiveRanges[Primitive_Box].indexOffset;
+
+		// Sphere, a unit circle around each axis
+		m_primitiveRanges[Primitive_Sphere].indexOffset = (unsigned int)indices.size();
+		for (unsigned int axis = 0; axis < 3; axis++)
+		{
+			auto first = (unsigned int)vertices.size();
+			for (unsigned int i = 0; i < DEBUG_SPHERE_SEGMENTS; i++)
+			{
+				float angle = PI_2 * i / DEBUG_SPHERE_SEGMENTS;
+				float a		= cos(angle);
+				float b		= sin(angle);
+				Vector3 position = axis == 0 ? Vector3(0.0f, a, b) : (axis == 1 ? Vector3(a, 0.0f, b) : Vector3(a, b, 0.0f));
+				vertices.emplace_back(position, Vector4::One);
+				indices.emplace_back(first + i);
+				indices.emplace_back(first + (i + 1) % DEBUG_SPHERE_SEGMENTS);
+			}
+		}
+		m_primitiveRanges[Primitive_Sphere].indexCount = (unsigned int)indices.size() - m_primitiveRanges[Primitive_Sphere].indexOffset;
+
+		// Frustum, the clip space volume
+		m_primitiveRanges[Primitive_Frustum].indexOffset = (unsigned int)indices.size();
+		AddBox(0.0f, 1.0f);
+		m_primitiveRanges[Primitive_Frustum].indexCount = (unsigned int)indices.size() - m_primitiveRanges[Primitive_Frustum].indexOffset;
+
+		// A circle around the y axis at a height, the first index of it is returned
+		auto AddCircle = [&vertices, &indices](float y)
+		{
+			auto first = (unsigned int)vertices.size();
+			for (unsigned int i = 0; i < DEBUG_SPHERE_SEGMENTS; i++)
+			{
+				float angle = PI_2 * i / DEBUG_SPHERE_SEGMENTS;
+				vertices.emplace_back(Vector3(cos(angle), y, sin(angle)), Vector4::One);
+				indices.emplace_back(first + i);
+				indices.emplace_back(first + (i + 1) % DEBUG_SPHERE_SEGMENTS);
+			}
+			return first;
+		};
+
+		// Cylinder, two circles joined at the four sides
+		m_primitiveRanges[Primitive_Cylinder].indexOffset = (unsigned int)indices.size();
+		{
+			auto bottom	= AddCircle(-1.0f);
+			auto top	= AddCircle(1.0f);
+			for (unsigned int i = 0; i < DEBUG_SPHERE_SEGMENTS; i += DEBUG_SPHERE_SEGMENTS / 4)
+			{
+				indices.emplace_back(bottom + i);
+				indices.emplace_back(top + i);
+			}
+		}
+		m_primitiveRanges[Primitive_Cylinder].indexCount = (unsigned int)indices.size() - m_primitiveRanges[Primitive_Cylinder].indexOffset;
+
+		// Cone, the base circle joined to the apex at the four sides
+		m_primitiveRanges[Primitive_Cone].indexOffset = (unsigned int)indices.size();
+		{
+			auto base = AddCircle(-1.0f);
+			auto apex = (unsigned int)vertices.size();
+			vertices.emplace_back(Vector3(0.0f, 1.0f, 0.0f), Vector4::One);
+			for (unsigned int i = 0; i < DEBUG_SPHERE_SEGMENTS; i += DEBUG_SPHERE_SEGMENTS / 4)
+			{
+				indices.emplace_back(base + i);
+				indices.emplace_back(apex);
+			}
+		}
+		m_primitiveRanges[Primitive_Cone].indexCount = (unsigned int)indices.size() - m_primitiveRanges[Primitive_Cone].indexOffset;
+
+		m_primitiveVertices = make_shared<RHI_VertexBuffer>(m_rhiDevice);
+		m_primitiveVertices->Create(vertices);
+		m_primitiveIndices = make_shared<RHI_IndexBuffer>(m_rhiDevice);
+		m_primitiveIndices->Create(indices);
+	}
+}
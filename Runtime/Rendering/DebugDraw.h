@@ -0,0 +1,151 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include "../RHI/RHI_Definition.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../Math/Matrix.h"
+#include "../Math/Vector4.h"
+//===============================
+
+// Must match Line.hlsl
+#define DEBUG_INSTANCE_BATCH_MAX	256
+// Line vertices the ring holds up front, it doubles whenever a frame needs more
+#define DEBUG_LINE_CAPACITY			65536
+// Number of instance batches the instance ring holds before it has to be discarded (20 KB each)
+#define DEBUG_INSTANCE_RING_SIZE	16
+
+namespace Directus
+{
+	namespace Math { class BoundingBox; }
+
+	// Collects lines and wireframe primitives from any thread and draws them in a handful of draw calls.
+	// Lines get appended to a ring buffer, boxes, spheres, frustums, cylinders, cones and wireframes are a single instance each.
+	class DebugDraw
+	{
+	public:
+		DebugDraw(std::shared_ptr<RHI_Device> rhiDevice);
+		~DebugDraw() {}
+
+		//= SUBMISSION (thread safe) =========================================================================================
+		void Line(const Math::Vector3& from, const Math::Vector3& to, const Math::Vector4& colorFrom, const Math::Vector4& colorTo);
+		void Box(const Math::BoundingBox& box, const Math::Vector4& color);
+		// A box of two units (-1 to 1 on every axis) moved into place by the transform
+		void Box(const Math::Matrix& transform, const Math::Vector4& color);
+		void Sphere(const Math::Vector3& center, float radius, const Math::Vector4& color);
+		// The volume a view projection sees
+		void Frustum(const Math::Matrix& viewProjection, const Math::Vector4& color);
+		// A cylinder of radius 1 around the y axis, from -1 to 1, moved into place by the transform
+		void Cylinder(const Math::Matrix& transform, const Math::Vector4& color);
+		// A cone with a base of radius 1 at y -1 and it's apex at y 1, moved into place by the transform
+		void Cone(const Math::Matrix& transform, const Math::Vector4& color);
+		// Wireframes of any shape, kept on the GPU under a key until released and drawn instanced wherever they're placed
+		bool Wireframe_Has(uint64_t key);
+		void Wireframe_Create(uint64_t key, const std::vector<Math::Vector3>& points, const std::vector<unsigned int>& lineIndices);
+		void Wireframe_Release(uint64_t key);
+		void Wireframe(uint64_t key, const Math::Matrix& transform, const Math::Vector4& color);
+		//====================================================================================================================
+
+		// Draws and clears everything submitted so far. The pipeline has to be set up for line lists, with the
+		// view projection in the constant buffer, the instanced shader has to expect it in the same slot.
+		void Render(std::shared_ptr<RHI_Pipeline>& pipeline, const std::shared_ptr<RHI_ConstantBuffer>& viewProjection, std::shared_ptr<RHI_Shader>& shaderInstanced);
+		// Clears everything submitted so far without drawing it, for frames that aren't rendered
+		void Discard();
+		bool IsEmpty();
+
+	private:
+		enum Primitive_Type
+		{
+			Primitive_Box,
+			Primitive_Sphere,
+			Primitive_Frustum,
+			Primitive_Cylinder,
+			Primitive_Cone,
+			Primitive_Count
+		};
+
+		struct Instance
+		{
+			Math::Matrix transform;
+			Math::Vector4 color;
+		};
+
+		struct Struct_Instances
+		{
+			Math::Matrix m_transform[DEBUG_INSTANCE_BATCH_MAX];
+			Math::Vector4 m_color[DEBUG_INSTANCE_BATCH_MAX];
+		};
+
+		struct PrimitiveRange
+		{
+			unsigned int indexOffset	= 0;
+			unsigned int indexCount		= 0;
+		};
+
+		struct Wireframe_Mesh
+		{
+			// Until the render thread creates the buffers from them
+			std::vector<RHI_Vertex_PosCol> vertices;
+			std::vector<unsigned int> indices;
+			std::shared_ptr<RHI_VertexBuffer> vertexBuffer;
+			std::shared_ptr<RHI_IndexBuffer> indexBuffer;
+			unsigned int indexCount = 0;
+			std::vector<Instance> instances;
+			std::vector<Instance> instancesRendering;
+		};
+
+		void Primitives_Create();
+		void Render_Lines(std::shared_ptr<RHI_Pipeline>& pipeline);
+		void Render_Primitives(std::shared_ptr<RHI_Pipeline>& pipeline, const std::shared_ptr<RHI_ConstantBuffer>& viewProjection, std::shared_ptr<RHI_Shader>& shaderInstanced);
+		void Render_Wireframes(std::shared_ptr<RHI_Pipeline>& pipeline, const std::shared_ptr<RHI_ConstantBuffer>& viewProjection, std::shared_ptr<RHI_Shader>& shaderInstanced);
+		// Draws instances of what's bound in batches, false if the instance ring couldn't be mapped
+		bool Render_Instances(std::shared_ptr<RHI_Pipeline>& pipeline, const std::shared_ptr<RHI_ConstantBuffer>& viewProjection, const std::vector<Instance>& instances, unsigned int indexOffset, unsigned int indexCount);
+
+		// Submitted, swapped with the lists below when rendering so submission only waits for the swap
+		std::mutex m_mutex;
+		std::vector<RHI_Vertex_PosCol> m_lines;
+		std::vector<Instance> m_instances[Primitive_Count];
+		std::vector<RHI_Vertex_PosCol> m_linesRendering;
+		std::vector<Instance> m_instancesRendering[Primitive_Count];
+		// Shared so one can be released while the render thread draws it
+		std::unordered_map<uint64_t, std::shared_ptr<Wireframe_Mesh>> m_wireframes;
+		std::vector<std::shared_ptr<Wireframe_Mesh>> m_wireframesRendering;
+
+		// Line ring
+		std::shared_ptr<RHI_VertexBuffer> m_lineBuffer;
+		unsigned int m_lineCapacity	= 0;
+		unsigned int m_lineCursor	= 0;
+
+		// Unit primitives, white so the instance color comes through as is
+		std::shared_ptr<RHI_VertexBuffer> m_primitiveVertices;
+		std::shared_ptr<RHI_IndexBuffer> m_primitiveIndices;
+		PrimitiveRange m_primitiveRanges[Primitive_Count];
+		std::shared_ptr<RHI_ConstantBuffer> m_instanceBuffer;
+
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
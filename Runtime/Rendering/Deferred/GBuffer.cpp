@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../RHI/RHI_Device.h"
 #include "../../RHI/RHI_Pipeline.h"
 #include "../../RHI/RHI_RenderTexture.h"
+#include "../RenderTexturePool.h"
 //======================================
 
 //= NAMESPACES ================
@@ -33,12 +34,17 @@ using namespace Directus::Math;
 
 namespace Directus
 {
-	GBuffer::GBuffer(const shared_ptr<RHI_Device>& rhiDevice, int width, int height)
+	GBuffer::GBuffer(const shared_ptr<RenderTexturePool>& pool, int width, int height)
 	{
-		m_renderTargets[GBuffer_Target_Albedo]		= make_shared<RHI_RenderTexture>(rhiDevice, width, height, Texture_Format_R8G8B8A8_UNORM,	false);
-		m_renderTargets[GBuffer_Target_Normal]		= make_shared<RHI_RenderTexture>(rhiDevice, width, height, Texture_Format_R8G8B8A8_UNORM,	false);
-		m_renderTargets[GBuffer_Target_Specular]	= make_shared<RHI_RenderTexture>(rhiDevice, width, height, Texture_Format_R8G8B8A8_UNORM,	false);
-		m_renderTargets[GBuffer_Target_Depth]		= make_shared<RHI_RenderTexture>(rhiDevice, width, height, Texture_Format_R32G32_FLOAT,		true, Texture_Format_D32_FLOAT);
+		m_pool		= pool;
+		m_width		= width;
+		m_height	= height;
+
+		m_renderTargets[GBuffer_Target_Albedo]		= m_pool->Acquire(width, height, Texture_Format_R8G8B8A8_UNORM);
+		m_renderTargets[GBuffer_Target_Normal]		= m_pool->Acquire(width, height, Texture_Format_R8G8B8A8_UNORM);
+		m_renderTargets[GBuffer_Target_Specular]	= m_pool->Acquire(width, height, Texture_Format_R8G8B8A8_UNORM);
+		m_renderTargets[GBuffer_Target_Depth]		= m_pool->Acquire(width, height, Texture_Format_R32G32_FLOAT, true, Texture_Format_D32_FLOAT);
+		m_renderTargets[GBuffer_Target_Velocity]	= m_pool->Acquire(width, height, Texture_Format_R16G16_FLOAT);
 
 		for (const auto& renderTarget : m_renderTargets)
 		{
@@ -48,13 +54,16 @@ namespace Directus
 
 	GBuffer::~GBuffer()
 	{
+		for (const auto& renderTarget : m_renderTargets)
+		{
+			m_pool->Release(renderTarget.second);
+		}
 		m_renderTargets.clear();
 		m_renderTargetViews.clear();
 	}
 
-	void GBuffer::SetAsRenderTarget(const std::shared_ptr<RHI_Pipeline>& pipelineState)
+	void GBuffer::SetAsRenderTarget(const std::shared_ptr<RHI_Pipeline>& pipelineState, bool clear /*= true*/)
 	{
-		bool clear = true;
 		pipelineState->SetRenderTargets(m_renderTargetViews, m_renderTargets[GBuffer_Target_Depth]->GetDepthStencilView(), clear);
 
 		// Grab the viewport from one of the render targets and set it
@@ -63,6 +72,12 @@ namespace Directus
 
 	const shared_ptr<RHI_RenderTexture>& GBuffer::GetTexture(GBuffer_Texture_Type type)
 	{
-		return m_renderTargets[type];
+		auto& renderTarget = m_renderTargets[type];
+		if (!renderTarget && type == GBuffer_Target_Id)
+		{
+			renderTarget = m_pool->Acquire(m_width, m_height, Texture_Format_R32_FLOAT, true, Texture_Format_D32_FLOAT);
+		}
+
+		return renderTarget;
 	}
 }
\ No newline at end of file
@@ -31,26 +31,34 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Directus
 {
+	class RenderTexturePool;
+
 	enum GBuffer_Texture_Type
 	{
 		GBuffer_Target_Unknown,
 		GBuffer_Target_Albedo,
 		GBuffer_Target_Normal,
 		GBuffer_Target_Specular,
-		GBuffer_Target_Depth
+		GBuffer_Target_Depth,
+		GBuffer_Target_Velocity,	// screen space motion since the previous frame, in texture coordinates
+		GBuffer_Target_Id			// which opaque renderable covers a pixel (see Renderer::Pick_Request), with a depth buffer of its own
 	};
 
 	class ENGINE_CLASS GBuffer
 	{
 	public:
-		GBuffer(const std::shared_ptr<RHI_Device>& rhiDevice, int width = Settings::Get().Resolution_GetWidth(), int height = Settings::Get().Resolution_GetHeight());
+		GBuffer(const std::shared_ptr<RenderTexturePool>& pool, int width = Settings::Get().Resolution_GetWidth(), int height = Settings::Get().Resolution_GetHeight());
 		~GBuffer();
 
-		void SetAsRenderTarget(const std::shared_ptr<RHI_Pipeline>& pipelineState);
+		void SetAsRenderTarget(const std::shared_ptr<RHI_Pipeline>& pipelineState, bool clear = true);
+		// The ID target isn't part of the G-Buffer pass, it's acquired the first time it's asked for
 		const std::shared_ptr<RHI_RenderTexture>& GetTexture(GBuffer_Texture_Type type);
 
 	private:
+		int m_width;
+		int m_height;
 		std::map<GBuffer_Texture_Type, std::shared_ptr<RHI_RenderTexture>> m_renderTargets;
 		std::vector<void*> m_renderTargetViews;
+		std::shared_ptr<RenderTexturePool> m_pool;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================================
+#include "GPUCulling.h"
+#include <cstring>
+#include "../Material.h"
+#include "../../World/Components/Renderable.h"
+#include "../../RHI/RHI_IndexBuffer.h"
+#include "../../RHI/RHI_StructuredBuffer.h"
+#include "../../RHI/RHI_ConstantBuffer.h"
+#include "../../RHI/RHI_CommonBuffers.h"
+#include "../../Math/MathHelper.h"
+#include "../../Logging/Log.h"
+//================================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace Directus
+{
+	GPUCulling::GPUCulling(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+
+		m_drawConstantBuffer = make_shared<RHI_ConstantBuffer>(rhiDevice);
+		m_drawConstantBuffer->CreateRing(sizeof(Struct_IndirectDraw), GPU_CULLING_DRAW_RING_SIZE, 2, Buffer_VertexShader);
+	}
+
+	void GPUCulling::Clear()
+	{
+		m_objects.clear();
+		m_draws.clear();
+		m_clusters.clear();
+		m_clusteredDraws.clear();
+		m_instanceCount		= 0;
+		m_compactedCount	= 0;
+	}
+
+	unsigned int GPUCulling::Draw_Add(Renderable* renderable, unsigned int objectCount, bool clusters /*= false*/)
+	{
+		Draw draw		= {};
+		auto lods		= renderable->Geometry_Model()->Geometry_Lods(renderable->Geometry_IndexOffset());
+		draw.lodCount	= lods ? Min((unsigned int)lods->size() + 1, (unsigned int)MODEL_LODS_MAX) : 1;
+
+		// Simplified levels share the full detail geometry's vertices
+		for (unsigned int lod = 0; lod < draw.lodCount; lod++)
+		{
+			draw.indexOffset[lod]	= lod == 0 ? renderable->Geometry_IndexOffset() : (*lods)[lod - 1].indexOffset;
+			draw.indexCount[lod]	= lod == 0 ? renderable->Geometry_IndexCount()	: (*lods)[lod - 1].indexCount;
+			draw.lodScreenSize[lod]	= lod + 1 < draw.lodCount ? (*lods)[lod].screenSize : 0.0f;
+		}
+		draw.vertexOffset	= (int)renderable->Geometry_VertexOffset();
+		draw.objectCount	= objectCount;
+		draw.instanceOffset	= m_instanceCount;
+		m_instanceCount		+= objectCount * draw.lodCount;
+
+		// The compute shader reads the model's indices, that takes a shader resource
+		Model* model		= renderable->Geometry_Model();
+		auto modelClusters	= model->Geometry_Clusters(renderable->Geometry_IndexOffset());
+		if (clusters && objectCount == 1 && modelClusters && model->GetIndexBuffer()->GetShaderResource())
+		{
+			draw.clusterOffset		= (unsigned int)m_clusters.size();
+			draw.clusterCount		= (unsigned int)modelClusters->size();
+			draw.compactedOffset	= m_compactedCount;
+			draw.flags				|= model->GetIndexBuffer()->GetFormat() == Index_Format_UInt16 ? 1 : 0;
+			draw.flags				|= renderable->Material_Ptr()->GetCullMode() == Cull_Back ? 2 : 0; // only those that don't show back faces can skip them
+			m_compactedCount		+= draw.indexCount[0];
+			for (const auto& modelCluster : *modelClusters)
+			{
+				Cluster cluster;
+				cluster.center		= modelCluster.center;
+				cluster.indexOffset	= modelCluster.indexOffset;
+				cluster.extents		= modelCluster.extents;
+				cluster.indexCount	= modelCluster.indexCount;
+				cluster.coneApex	= modelCluster.coneApex;
+				cluster.coneCutoff	= modelCluster.coneCutoff;
+				cluster.coneAxis	= modelCluster.coneAxis;
+				cluster.padding		= 0.0f;
+				m_clusters.emplace_back(cluster);
+			}
+			m_clusteredDraws.emplace_back((unsigned int)m_draws.size());
+		}
+
+		m_draws.emplace_back(draw);
+		return (unsigned int)m_draws.size() - 1;
+	}
+
+	void GPUCulling::Object_Add(const Matrix& world, const BoundingBox& box, unsigned int draw)
+	{
+		Object object;
+		object.world	= world;
+		object.center	= box.GetCenter();
+		object.extents	= box.GetExtents();
+		object.draw		= draw;
+		object.padding	= 0.0f;
+		m_objects.emplace_back(object);
+	}
+
+	bool GPUCulling::Upload()
+	{
+		if (m_objects.empty())
+			return false;
+
+		if (!Buffer_Fit(m_objectBuffer,		sizeof(Object),			GetObjectCount(),	true)	||
+			!Buffer_Fit(m_drawBuffer,		sizeof(Draw),			GetDrawCount(),		true)	||
+			!Buffer_Fit(m_instanceBuffer,	sizeof(unsigned int),	m_instanceCount,	false)	||
+			!Buffer_Fit(m_argumentBuffer,	sizeof(Arguments),		GetArgumentCount(),	false, true))
+			return false;
+
+		// Like the other buffers the compacted indices only grow, by doubling
+		if (!m_clusters.empty())
+		{
+			if (!Buffer_Fit(m_clusterBuffer, sizeof(Cluster), (unsigned int)m_clusters.size(), true))
+				return false;
+
+			if (!m_compactedIndexBuffer || m_compactedIndexBuffer->GetIndexCount() < m_compactedCount)
+			{
+				unsigned int capacity = m_compactedIndexBuffer ? m_compactedIndexBuffer->GetIndexCount() : MODEL_CLUSTER_TRIANGLES * 3;
+				while (capacity < m_compactedCount) { capacity *= 2; }
+
+				m_compactedIndexBuffer = make_shared<RHI_IndexBuffer>(m_rhiDevice);
+				if (!m_compactedIndexBuffer->CreateUnorderedAccess(capacity))
+				{
+					LOG_ERROR("GPUCulling::Upload: Failed to create the compacted index buffer");
+					m_compactedIndexBuffer = nullptr;
+					return false;
+				}
+			}
+		}
+
+		auto upload = [](const shared_ptr<RHI_StructuredBuffer>& buffer, const void* data, size_t size)
+		{
+			void* mapped = buffer->Map();
+			if (!mapped)
+				return false;
+			memcpy(mapped, data, size);
+			return buffer->Unmap();
+		};
+
+		return
+			upload(m_objectBuffer,	&m_objects[0],	m_objects.size() * sizeof(Object)) &&
+			upload(m_drawBuffer,	&m_draws[0],	m_draws.size() * sizeof(Draw)) &&
+			(m_clusters.empty() || upload(m_clusterBuffer, &m_clusters[0], m_clusters.size() * sizeof(Cluster)));
+	}
+
+	bool GPUCulling::Buffer_Fit(shared_ptr<RHI_StructuredBuffer>& buffer, unsigned int stride, unsigned int elementCount, bool cpuWritable, bool drawArguments /*= false*/)
+	{
+		if (buffer && buffer->GetElementCount() >= elementCount)
+			return true;
+
+		// Grow by doubling, so a scene that keeps growing doesn't re-create the buffers every frame
+		unsigned int capacity = buffer ? buffer->GetElementCount() : GPU_CULLING_THREAD_GROUP_SIZE;
+		while (capacity < elementCount) { capacity *= 2; }
+
+		buffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+		bool created = cpuWritable ? buffer->Create(stride, capacity) : buffer->CreateUnorderedAccess(stride, capacity, drawArguments);
+		if (!created)
+		{
+			LOG_ERROR("GPUCulling::Buffer_Fit: Failed to create buffer");
+			buffer = nullptr;
+		}
+
+		return created;
+	}
+}
@@ -0,0 +1,166 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/Vector3.h"
+#include "../Model.h"
+//===============================
+
+// Must match Culling.hlsl (as must MODEL_LODS_MAX)
+#define GPU_CULLING_THREAD_GROUP_SIZE	64
+#define GPU_CULLING_HIZ_LEVELS_MAX		8
+#define GPU_CULLING_CLUSTER_DISPATCH_WIDTH 1024 // thread groups (one per cluster) in a row of a dispatch
+// Indirect draws the per draw constants hold before they have to be discarded
+#define GPU_CULLING_DRAW_RING_SIZE		1024
+
+namespace Directus
+{
+	class Renderable;
+	class RHI_IndexBuffer;
+	namespace Math { class BoundingBox; }
+
+	// Keeps the bounding boxes and world matrices of the opaque renderables in GPU buffers, a compute
+	// shader culls them against the frustum and the depth pyramid of the previous frame and writes the
+	// arguments of one indirect draw per instanced mesh and level of detail. The CPU never looks at
+	// individual objects to decide visibility, it only issues a draw per mesh.
+	// A draw of a single object whose geometry has clusters (see ModelCluster) draws it's full detail from one more set of
+	// arguments, a compute shader culls the clusters one by one and compacts the indices of those left to an index buffer.
+
+	class GPUCulling
+	{
+	public:
+		GPUCulling(std::shared_ptr<RHI_Device> rhiDevice);
+		~GPUCulling() {}
+
+		//= BUILDING (every frame) ==========================================================================
+		void Clear();
+		// Starts a draw (a run of instances of the renderable's mesh), returns it's index. Clusters are
+		// only culled for a single object, instances are cheaper to cull whole.
+		unsigned int Draw_Add(Renderable* renderable, unsigned int objectCount, bool clusters = false);
+		// The world matrix is what it's drawn with (relative to the camera, see Render_CameraRelative), the box is what it's culled by
+		void Object_Add(const Math::Matrix& world, const Math::BoundingBox& box, unsigned int draw);
+		// Uploads what was added, growing the buffers when needed, returns false if there is nothing to draw
+		bool Upload();
+		//===================================================================================================
+
+		// What the depth pyramid was rendered with, the next frame tests against it
+		void Occluder_Set(const Math::Matrix& viewProjection, float farPlane) { m_occluderViewProjection = viewProjection; m_occluderFarPlane = farPlane; }
+		const Math::Matrix& Occluder_GetViewProjection()	{ return m_occluderViewProjection; }
+		float Occluder_GetFarPlane()						{ return m_occluderFarPlane; }
+
+		const std::shared_ptr<RHI_StructuredBuffer>& GetObjectBuffer()		{ return m_objectBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetDrawBuffer()		{ return m_drawBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetInstanceBuffer()	{ return m_instanceBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetArgumentBuffer()	{ return m_argumentBuffer; }
+		const std::shared_ptr<RHI_ConstantBuffer>& GetDrawConstantBuffer()	{ return m_drawConstantBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetClusterBuffer()		{ return m_clusterBuffer; }
+		const std::shared_ptr<RHI_IndexBuffer>& GetCompactedIndexBuffer()	{ return m_compactedIndexBuffer; }
+		unsigned int GetObjectCount()										{ return (unsigned int)m_objects.size(); }
+		unsigned int GetDrawCount()											{ return (unsigned int)m_draws.size(); }
+		// One set of arguments per draw and level of detail, and one for the clusters
+		unsigned int GetArgumentCount()										{ return GetDrawCount() * (MODEL_LODS_MAX + 1); }
+		unsigned int GetLodCount(unsigned int draw)							{ return m_draws[draw].lodCount; }
+		unsigned int GetArgumentsOffset(unsigned int draw, unsigned int lod)	{ return (draw * (MODEL_LODS_MAX + 1) + lod) * sizeof(Arguments); }
+		// The full detail of a clustered draw is drawn from these, with the compacted indices
+		unsigned int GetClusterArgumentsOffset(unsigned int draw)			{ return GetArgumentsOffset(draw, MODEL_LODS_MAX); }
+		bool IsClustered(unsigned int draw)									{ return m_draws[draw].clusterCount != 0; }
+		// The draws with clusters, each is culled by a dispatch of it's own as it reads the indices of it's model
+		const std::vector<unsigned int>& GetClusteredDraws()				{ return m_clusteredDraws; }
+		unsigned int GetClusterOffset(unsigned int draw)					{ return m_draws[draw].clusterOffset; }
+		unsigned int GetClusterCount(unsigned int draw)						{ return m_draws[draw].clusterCount; }
+		// Where the visible instances of a draw's level of detail start in the instance buffer
+		unsigned int GetInstanceOffset(unsigned int draw, unsigned int lod)	{ return m_draws[draw].instanceOffset + lod * m_draws[draw].objectCount; }
+
+	private:
+		struct Object
+		{
+			Math::Matrix world;
+			Math::Vector3 center;
+			unsigned int draw;
+			Math::Vector3 extents;
+			float padding;
+		};
+
+		struct Draw
+		{
+			unsigned int indexCount[MODEL_LODS_MAX];
+			unsigned int indexOffset[MODEL_LODS_MAX];
+			float lodScreenSize[MODEL_LODS_MAX];	// a level of detail is left once the object gets smaller than this
+			unsigned int instanceOffset;				// each level of detail gets room for all of the draw's objects
+			unsigned int objectCount;
+			unsigned int lodCount;
+			int vertexOffset;
+			unsigned int clusterOffset;				// in the cluster buffer
+			unsigned int clusterCount;
+			unsigned int compactedOffset;			// where the visible clusters' indices go in the compacted index buffer
+			unsigned int flags;						// see Culling.hlsl
+		};
+
+		// ModelCluster, as the compute shader reads it
+		struct Cluster
+		{
+			Math::Vector3 center;
+			unsigned int indexOffset;
+			Math::Vector3 extents;
+			unsigned int indexCount;
+			Math::Vector3 coneApex;
+			float coneCutoff;
+			Math::Vector3 coneAxis;
+			float padding;
+		};
+
+		// D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS
+		struct Arguments
+		{
+			unsigned int indexCount;
+			unsigned int instanceCount;
+			unsigned int indexOffset;
+			int vertexOffset;
+			unsigned int instanceOffset;
+		};
+
+		bool Buffer_Fit(std::shared_ptr<RHI_StructuredBuffer>& buffer, unsigned int stride, unsigned int elementCount, bool cpuWritable, bool drawArguments = false);
+
+		std::vector<Object> m_objects;
+		std::vector<Draw> m_draws;
+		std::vector<Cluster> m_clusters;
+		std::vector<unsigned int> m_clusteredDraws;
+		unsigned int m_instanceCount	= 0;
+		unsigned int m_compactedCount	= 0;
+		Math::Matrix m_occluderViewProjection;
+		float m_occluderFarPlane = 0.0f;
+
+		std::shared_ptr<RHI_StructuredBuffer> m_objectBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_drawBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_instanceBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_argumentBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_clusterBuffer;
+		std::shared_ptr<RHI_IndexBuffer> m_compactedIndexBuffer;
+		std::shared_ptr<RHI_ConstantBuffer> m_drawConstantBuffer;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
@@ -0,0 +1,297 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================================
+#include "GPUParticles.h"
+#include <cstring>
+#include <algorithm>
+#include "../../World/Components/ParticleEmitter.h"
+#include "../../RHI/RHI_StructuredBuffer.h"
+#include "../../RHI/RHI_VertexBuffer.h"
+#include "../../RHI/RHI_IndexBuffer.h"
+#include "../../RHI/RHI_Vertex.h"
+#include "../../Math/MathHelper.h"
+#include "../../Logging/Log.h"
+//===================================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+// Particles the pool holds at least, it grows by doubling from here
+#define GPU_PARTICLES_POOL_MIN	(1 << 16)
+
+namespace Directus
+{
+	static const Vector3 GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
+
+	GPUParticles::GPUParticles(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+
+		for (unsigned int i = 0; i < GPU_PARTICLES_EMITTERS_MAX; i++)
+		{
+			m_slotsFree.emplace_back(GPU_PARTICLES_EMITTERS_MAX - 1 - i);
+		}
+
+		// The arguments of a single indexed draw of the quad, the instance count is what the simulation counts
+		m_argumentBuffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+		if (!m_argumentBuffer->CreateUnorderedAccess(sizeof(unsigned int), 5, true))
+		{
+			LOG_ERROR("GPUParticles::GPUParticles: Failed to create argument buffer");
+		}
+
+		m_emitters.resize(GPU_PARTICLES_EMITTERS_MAX);
+		m_emitterBuffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+		if (!m_emitterBuffer->Create(sizeof(Emitter), GPU_PARTICLES_EMITTERS_MAX))
+		{
+			LOG_ERROR("GPUParticles::GPUParticles: Failed to create emitter buffer");
+		}
+
+		vector<RHI_Vertex_PosUV> vertices;
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(-0.5f, 0.5f, 0.0f),	Vector2(0.0f, 0.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(0.5f, 0.5f, 0.0f),	Vector2(1.0f, 0.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(0.5f, -0.5f, 0.0f),	Vector2(1.0f, 1.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(-0.5f, -0.5f, 0.0f),	Vector2(0.0f, 1.0f)));
+		vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+
+		m_vertexBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
+		if (!m_vertexBuffer->Create(vertices))
+		{
+			LOG_ERROR("GPUParticles::GPUParticles: Failed to create vertex buffer");
+		}
+
+		m_indexBuffer = make_shared<RHI_IndexBuffer>(m_rhiDevice);
+		if (!m_indexBuffer->Create(indices))
+		{
+			LOG_ERROR("GPUParticles::GPUParticles: Failed to create index buffer");
+		}
+	}
+
+	void GPUParticles::Clear()
+	{
+		m_simulations.clear();
+		m_frame++;
+	}
+
+	void GPUParticles::Emitter_Add(ParticleEmitter* emitter, const Matrix& world, float deltaTime)
+	{
+		if (!emitter)
+			return;
+
+		auto it = m_states.find(emitter);
+
+		// A new capacity is a new range
+		if (it != m_states.end() && it->second.capacity != emitter->GetCapacity())
+		{
+			Range_Free(it->second.offset, it->second.capacity);
+			m_slotsFree.emplace_back(it->second.slot);
+			m_states.erase(it);
+			it = m_states.end();
+		}
+
+		if (it == m_states.end())
+		{
+			State state;
+			state.capacity = emitter->GetCapacity();
+			if (m_slotsFree.empty() || !Range_Allocate(state.capacity, &state.offset))
+			{
+				if (!m_limitReported)
+				{
+					LOG_WARNING("GPUParticles::Emitter_Add: Out of particles or emitters, some emitters won't be simulated");
+					m_limitReported = true;
+				}
+				return;
+			}
+			state.slot = m_slotsFree.back();
+			m_slotsFree.pop_back();
+			it = m_states.emplace(emitter, state).first;
+		}
+
+		State& state = it->second;
+		state.frame = m_frame;
+
+		// Emit what the rate owes since the last frame, never more than the range holds (the ring would overwrite them anyway)
+		unsigned int emitCount = 0;
+		if (emitter->IsEmitting())
+		{
+			state.accumulated += double(emitter->GetRate()) * double(deltaTime);
+			emitCount = (unsigned int)Min(state.accumulated, double(state.capacity));
+			state.accumulated = emitCount == state.capacity ? 0.0 : state.accumulated - double(emitCount);
+		}
+		else
+		{
+			state.accumulated = 0.0;
+		}
+
+		Simulation simulation;
+		simulation.world		= world;
+		simulation.gravity		= GRAVITY * emitter->GetGravity();
+		simulation.deltaTime	= deltaTime;
+		simulation.speed		= emitter->GetSpeed();
+		simulation.spread		= cos(Clamp(emitter->GetSpread(), 0.0f, 180.0f) * DEG_TO_RAD);
+		simulation.lifetime		= Max(emitter->GetLifetime(), 0.001f);
+		simulation.bounce		= emitter->GetBounce();
+		simulation.rangeOffset	= state.offset;
+		simulation.rangeSize	= state.capacity;
+		simulation.emitStart	= state.cursor;
+		simulation.emitCount	= emitCount;
+		simulation.emitter		= state.slot;
+		simulation.seed			= (unsigned int)(m_frame * 0x9E3779B9u) ^ (state.slot * 0x85EBCA6Bu);
+		simulation.reset		= state.reset ? 1 : 0;
+		simulation.collisions	= emitter->GetCollisions() ? 1 : 0;
+		m_simulations.emplace_back(simulation);
+
+		state.cursor	= (state.cursor + emitCount) % state.capacity;
+		state.reset		= false;
+
+		Emitter& data	= m_emitters[state.slot];
+		data.colorStart	= emitter->GetColorStart();
+		data.colorEnd	= emitter->GetColorEnd();
+		data.sizeStart	= emitter->GetSizeStart();
+		data.sizeEnd	= emitter->GetSizeEnd();
+	}
+
+	bool GPUParticles::Upload(const Matrix& viewProjection, float farPlane, float resolutionScale)
+	{
+		// Emitters that weren't added this frame are gone (or disabled), their particles with them
+		for (auto it = m_states.begin(); it != m_states.end();)
+		{
+			if (it->second.frame != m_frame)
+			{
+				Range_Free(it->second.offset, it->second.capacity);
+				m_slotsFree.emplace_back(it->second.slot);
+				it = m_states.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		if (m_simulations.empty() || !m_argumentBuffer || !m_emitterBuffer)
+			return false;
+
+		// A new pool holds nothing worth keeping, every emitter starts over
+		unsigned int poolSize = m_particleBuffer ? m_particleBuffer->GetElementCount() : 0;
+		if (!Buffer_Fit(m_particleBuffer, sizeof(Particle), m_rangesEnd) || !Buffer_Fit(m_aliveBuffer, sizeof(unsigned int), m_rangesEnd))
+			return false;
+
+		if (m_particleBuffer->GetElementCount() != poolSize)
+		{
+			for (auto& simulation : m_simulations)
+			{
+				simulation.reset = 1;
+			}
+		}
+
+		for (auto& simulation : m_simulations)
+		{
+			simulation.viewProjection	= viewProjection;
+			simulation.farPlane			= farPlane;
+			simulation.resolutionScale	= resolutionScale;
+		}
+
+		void* mapped = m_emitterBuffer->Map();
+		if (!mapped)
+			return false;
+		memcpy(mapped, &m_emitters[0], m_emitters.size() * sizeof(Emitter));
+		return m_emitterBuffer->Unmap();
+	}
+
+	bool GPUParticles::Range_Allocate(unsigned int size, unsigned int* offset)
+	{
+		// First fit, emitters rarely come and go so the pool doesn't fragment much
+		for (auto it = m_rangesFree.begin(); it != m_rangesFree.end(); ++it)
+		{
+			if (it->size < size)
+				continue;
+
+			*offset = it->offset;
+			it->offset	+= size;
+			it->size	-= size;
+			if (it->size == 0)
+			{
+				m_rangesFree.erase(it);
+			}
+			return true;
+		}
+
+		if (m_rangesEnd + size > GPU_PARTICLES_MAX)
+			return false;
+
+		*offset = m_rangesEnd;
+		m_rangesEnd += size;
+		return true;
+	}
+
+	void GPUParticles::Range_Free(unsigned int offset, unsigned int size)
+	{
+		auto it = upper_bound(m_rangesFree.begin(), m_rangesFree.end(), offset, [](unsigned int offset, const Range& range) { return offset < range.offset; });
+		it = m_rangesFree.insert(it, Range{ offset, size });
+
+		// Merge with the neighbours
+		auto next = it + 1;
+		if (next != m_rangesFree.end() && it->offset + it->size == next->offset)
+		{
+			it->size += next->size;
+			m_rangesFree.erase(next);
+		}
+		if (it != m_rangesFree.begin())
+		{
+			auto previous = it - 1;
+			if (previous->offset + previous->size == it->offset)
+			{
+				previous->size += it->size;
+				it = m_rangesFree.erase(it) - 1;
+			}
+		}
+
+		// A free range at the end gives the space back
+		if (it->offset + it->size == m_rangesEnd)
+		{
+			m_rangesEnd = it->offset;
+			m_rangesFree.erase(it);
+		}
+	}
+
+	bool GPUParticles::Buffer_Fit(shared_ptr<RHI_StructuredBuffer>& buffer, unsigned int stride, unsigned int elementCount)
+	{
+		if (buffer && buffer->GetElementCount() >= elementCount)
+			return true;
+
+		// Grow by doubling, so emitters that keep coming don't re-create the pool (and reset every emitter) every frame
+		unsigned int capacity = buffer ? buffer->GetElementCount() : GPU_PARTICLES_POOL_MIN;
+		while (capacity < elementCount) { capacity *= 2; }
+
+		buffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+		if (!buffer->CreateUnorderedAccess(stride, capacity))
+		{
+			LOG_ERROR("GPUParticles::Buffer_Fit: Failed to create buffer");
+			buffer = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+}
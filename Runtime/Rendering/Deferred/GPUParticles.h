@@ -0,0 +1,155 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/Vector4.h"
+//===============================
+
+// Must match Particles.hlsl
+#define GPU_PARTICLES_THREAD_GROUP_SIZE	256
+#define GPU_PARTICLES_MAX				(1 << 20)	// alive at once, across all emitters
+#define GPU_PARTICLES_EMITTERS_MAX		256
+
+namespace Directus
+{
+	class ParticleEmitter;
+
+	// Particles live in one pool on the GPU, every emitter gets a range of it as large as it's capacity. A compute shader
+	// emits into the range like into a ring (the CPU only keeps the cursor), moves the particles, bounces them off the
+	// depth buffer and lists the ones still alive, along with the arguments of a single indirect draw of all of them.
+	class GPUParticles
+	{
+	public:
+		GPUParticles(std::shared_ptr<RHI_Device> rhiDevice);
+		~GPUParticles() {}
+
+		// Must match Particles.hlsl, a dispatch per emitter with a thread per particle of it's range
+		struct Simulation
+		{
+			Math::Matrix world;
+			Math::Matrix viewProjection;	// what the depth buffer particles collide with was rendered with
+			Math::Vector3 gravity;
+			float deltaTime;
+			float speed;
+			float spread;					// cosine of half the cone's angle
+			float lifetime;
+			float bounce;
+			unsigned int rangeOffset;
+			unsigned int rangeSize;
+			unsigned int emitStart;			// in the range
+			unsigned int emitCount;
+			unsigned int emitter;
+			unsigned int seed;
+			unsigned int reset;				// the range's particles are left overs, kill them first
+			unsigned int collisions;
+			float farPlane;
+			float resolutionScale;
+			float padding[2];
+		};
+
+		//= BUILDING (every frame) ==========================================================================
+		void Clear();
+		// The world matrix is the emitter's, emitters that aren't added for a frame lose their particles
+		void Emitter_Add(ParticleEmitter* emitter, const Math::Matrix& world, float deltaTime);
+		// Uploads the emitters, growing the pool when needed (which starts every emitter over). Returns false if there
+		// is nothing to simulate.
+		bool Upload(const Math::Matrix& viewProjection, float farPlane, float resolutionScale);
+		//===================================================================================================
+
+		const std::vector<Simulation>& GetSimulations()						{ return m_simulations; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetParticleBuffer()	{ return m_particleBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetAliveBuffer()		{ return m_aliveBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetArgumentBuffer()	{ return m_argumentBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetEmitterBuffer()		{ return m_emitterBuffer; }
+		// A quad, every particle is an instance of it
+		const std::shared_ptr<RHI_VertexBuffer>& GetVertexBuffer()			{ return m_vertexBuffer; }
+		const std::shared_ptr<RHI_IndexBuffer>& GetIndexBuffer()			{ return m_indexBuffer; }
+
+	private:
+		// Must match Particles.hlsl
+		struct Particle
+		{
+			Math::Vector3 position;
+			float age;
+			Math::Vector3 velocity;
+			float lifetime;
+			unsigned int emitter;
+			float scale;		// of the emitter's size, it varies a little per particle
+			float padding[2];
+		};
+
+		// Must match Particles.hlsl, what drawing a particle takes from it's emitter
+		struct Emitter
+		{
+			Math::Vector4 colorStart;
+			Math::Vector4 colorEnd;
+			float sizeStart;
+			float sizeEnd;
+			float padding[2];
+		};
+
+		// An emitter's range and ring, kept from frame to frame
+		struct State
+		{
+			unsigned int offset		= 0;
+			unsigned int capacity	= 0;
+			unsigned int cursor		= 0;
+			unsigned int slot		= 0;	// in the emitter buffer, particles know their emitter by it
+			double accumulated		= 0.0;	// particles owed, emission carries fractions over to the next frame
+			uint64_t frame			= 0;	// the last one it was added in
+			bool reset				= true;
+		};
+
+		struct Range
+		{
+			unsigned int offset;
+			unsigned int size;
+		};
+
+		bool Range_Allocate(unsigned int size, unsigned int* offset);
+		void Range_Free(unsigned int offset, unsigned int size);
+		bool Buffer_Fit(std::shared_ptr<RHI_StructuredBuffer>& buffer, unsigned int stride, unsigned int elementCount);
+
+		std::unordered_map<const ParticleEmitter*, State> m_states;
+		std::vector<Range> m_rangesFree;	// sorted by offset
+		unsigned int m_rangesEnd = 0;
+		std::vector<unsigned int> m_slotsFree;
+		std::vector<Simulation> m_simulations;
+		std::vector<Emitter> m_emitters;
+		uint64_t m_frame			= 0;
+		bool m_limitReported		= false;
+
+		std::shared_ptr<RHI_StructuredBuffer> m_particleBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_aliveBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_argumentBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_emitterBuffer;
+		std::shared_ptr<RHI_VertexBuffer> m_vertexBuffer;
+		std::shared_ptr<RHI_IndexBuffer> m_indexBuffer;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
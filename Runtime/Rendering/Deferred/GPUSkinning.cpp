@@ -0,0 +1,324 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================================
+#include "GPUSkinning.h"
+#include <cstring>
+#include "../Model.h"
+#include "../../World/Actor.h"
+#include "../../World/Components/Renderable.h"
+#include "../../World/Components/Transform.h"
+#include "../../RHI/RHI_StructuredBuffer.h"
+#include "../../RHI/RHI_VertexBuffer.h"
+#include "../../RHI/RHI_Vertex.h"
+#include "../../Threading/Threading.h"
+#include "../../Math/MathHelper.h"
+#include "../../Logging/Log.h"
+//================================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+//=============================
+
+#define GPU_SKINNING_CHARACTERS_PER_TASK	4		// characters animated by a task before it's worth splitting further
+#define GPU_SKINNING_PHASE_SECONDS			10.0	// characters start a pseudo random time apart, up to this, so crowds don't move in lockstep
+
+namespace Directus
+{
+	GPUSkinning::GPUSkinning(shared_ptr<RHI_Device> rhiDevice, Threading* threading)
+	{
+		m_rhiDevice = rhiDevice;
+		m_threading = threading;
+
+		m_lodFull	= SkinningLod{ 1.0f, 1, true };
+		m_lods		=
+		{
+			SkinningLod{ 0.1f,		2, true },
+			SkinningLod{ 0.04f,		4, false },
+			SkinningLod{ 0.015f,	8, false }
+		};
+	}
+
+	void GPUSkinning::Lod_Set(unsigned int level, const SkinningLod& lod)
+	{
+		if (m_lods.size() <= level)
+		{
+			m_lods.resize(level + 1, m_lods.empty() ? m_lodFull : m_lods.back());
+		}
+		m_lods[level]			= lod;
+		m_lods[level].interval	= Helper::Max(lod.interval, 1u);
+	}
+
+	const SkinningLod& GPUSkinning::Lod_Get(float screenSize) const
+	{
+		unsigned int level = 0;
+		while (level < (unsigned int)m_lods.size() && screenSize < m_lods[level].screenSize) { level++; }
+		return level == 0 ? m_lodFull : m_lods[level - 1];
+	}
+
+	void GPUSkinning::Clear()
+	{
+		m_instances.clear();
+		m_actors.clear();
+		m_batches.clear();
+		m_instanceIndices.clear();
+		m_palette.clear();
+		m_vertexCount = 0;
+
+		for (Character* character : m_charactersActive)
+		{
+			character->instances.clear();
+		}
+		m_charactersActive.clear();
+	}
+
+	void GPUSkinning::Instance_Add(Actor* actor, Renderable* renderable, float screenSize, bool visible)
+	{
+		Model* model = renderable->Geometry_Model();
+		if (!model || !model->Skin_GetVertexBuffer() || m_instanceIndices.find(actor) != m_instanceIndices.end())
+			return;
+
+		Instance instance;
+		instance.vertexOffset	= renderable->Geometry_VertexOffset();
+		instance.vertexCount	= renderable->Geometry_VertexCount();
+		instance.outputOffset	= m_vertexCount;
+		instance.paletteOffset	= (unsigned int)m_palette.size();
+		m_vertexCount			+= instance.vertexCount;
+		m_palette.resize(m_palette.size() + model->Skin_GetBones().size());
+
+		if (m_batches.empty() || m_batches.back().model != model)
+		{
+			m_batches.emplace_back(Batch{ model, (unsigned int)m_instances.size(), 0, 0 });
+		}
+		m_batches.back().instanceCount++;
+		m_batches.back().vertexCountMax = Math::Helper::Max(m_batches.back().vertexCountMax, instance.vertexCount);
+
+		// The character it's part of, a new one starts its first animation
+		Transform* root			= actor->GetTransform_PtrRaw()->GetRoot();
+		auto inserted			= m_characters.emplace(CharacterKey(root, model), Character());
+		Character& character	= inserted.first->second;
+		if (inserted.second)
+		{
+			unsigned int hash	= root->GetActor_PtrRaw()->GetID() * 2654435761u;
+			character.model		= model;
+			character.time		= (double)(hash % 1000u) / 1000.0 * GPU_SKINNING_PHASE_SECONDS;
+			character.phase		= hash >> 16;
+		}
+		if (character.instances.empty())
+		{
+			m_charactersActive.emplace_back(&character);
+			character.screenSize	= 0.0f;
+			character.visible		= false;
+		}
+		character.instances.emplace_back((unsigned int)m_instances.size());
+		character.screenSize	= Helper::Max(character.screenSize, screenSize);
+		character.visible		= character.visible || visible;
+
+		m_instanceIndices[actor] = (unsigned int)m_instances.size();
+		m_instances.emplace_back(instance);
+		m_actors.emplace_back(actor);
+	}
+
+	void GPUSkinning::Character_Play(Actor* actor, unsigned int animation, float fadeSeconds)
+	{
+		if (!actor)
+			return;
+
+		Renderable* renderable	= actor->GetRenderable_PtrRaw();
+		CharacterKey key		= CharacterKey(actor->GetTransform_PtrRaw()->GetRoot(), renderable ? renderable->Geometry_Model() : nullptr);
+
+		lock_guard<mutex> lock(m_playMutex);
+		m_playRequests.emplace_back(PlayRequest{ key, animation, fadeSeconds });
+	}
+
+	void GPUSkinning::Character_Sample(Character* character, float ahead, bool leafBones, AnimationPose* pose)
+	{
+		Model* model = character->model;
+		model->Skin_Sample(character->animation, character->time + ahead, &character->cursor, pose, leafBones);
+
+		// From the previous animation to this one, both keep playing until the fade ends
+		float fade = character->fade - ahead;
+		if (fade > 0.0f)
+		{
+			model->Skin_Sample(character->previous, character->previousTime + ahead, &character->cursorPrevious, &character->posePrevious, leafBones);
+			AnimationPose::Blend(character->posePrevious, *pose, 1.0f - fade / character->fadeDuration, pose);
+		}
+	}
+
+	void GPUSkinning::Character_Update(Character* character, float deltaTime)
+	{
+		Model* model		= character->model;
+		unsigned int bones	= (unsigned int)model->Skin_GetBones().size();
+
+		// Out of view it pauses, holding the palettes it was last posed with (as long as its instances are the same)
+		bool held = character->paletteVertexOffsets.size() == character->instances.size();
+		for (unsigned int i = 0; held && i < (unsigned int)character->instances.size(); i++)
+		{
+			held = character->paletteVertexOffsets[i] == m_instances[character->instances[i]].vertexOffset;
+		}
+		if (!character->visible && held)
+		{
+			for (unsigned int i = 0; i < (unsigned int)character->instances.size(); i++)
+			{
+				copy_n(&character->palette[i * bones], bones, &m_palette[m_instances[character->instances[i]].paletteOffset]);
+			}
+			return;
+		}
+
+		character->time			+= deltaTime;
+		character->previousTime	+= deltaTime;
+		character->fade			= Helper::Max(character->fade - deltaTime, 0.0f);
+
+		// Sample where the animation will be by the next sample's frame and ease from the pose shown toward it,
+		// that frame is on a grid of the interval (shifted by the phase) so characters of a level take turns
+		if (++character->sampleStep >= character->sampleSteps)
+		{
+			const SkinningLod& lod		= Lod_Get(character->screenSize);
+			character->sampleSteps		= lod.interval - (unsigned int)((m_frame + character->phase) % lod.interval);
+			character->sampleStep		= 0;
+			Character_Sample(character, (character->sampleSteps - 1) * deltaTime, lod.leafBones, &character->poseTo);
+			character->poseFrom			= character->pose.GetBoneCount() == bones ? character->pose : character->poseTo;
+		}
+		if (character->sampleSteps == 1)
+		{
+			character->pose = character->poseTo;
+		}
+		else
+		{
+			AnimationPose::Blend(character->poseFrom, character->poseTo, (float)(character->sampleStep + 1) / character->sampleSteps, &character->pose);
+		}
+
+		character->palette.resize(character->instances.size() * bones);
+		character->paletteVertexOffsets.resize(character->instances.size());
+		for (unsigned int i = 0; i < (unsigned int)character->instances.size(); i++)
+		{
+			const Instance& instance = m_instances[character->instances[i]];
+			model->Skin_ComputePalette(instance.vertexOffset, character->pose, &m_palette[instance.paletteOffset]);
+			copy_n(&m_palette[instance.paletteOffset], bones, &character->palette[i * bones]);
+			character->paletteVertexOffsets[i] = instance.vertexOffset;
+		}
+	}
+
+	bool GPUSkinning::Upload(float deltaTime)
+	{
+		// Forget the characters that are gone
+		for (auto it = m_characters.begin(); it != m_characters.end();)
+		{
+			it = it->second.instances.empty() ? m_characters.erase(it) : next(it);
+		}
+
+		if (m_instances.empty())
+			return false;
+
+		// The animations asked for since the last frame, a fade starts where the one playing is
+		vector<PlayRequest> requests;
+		{
+			lock_guard<mutex> lock(m_playMutex);
+			requests.swap(m_playRequests);
+		}
+		for (const auto& request : requests)
+		{
+			for (auto it = m_characters.lower_bound(CharacterKey(request.key.first, nullptr)); it != m_characters.end() && it->first.first == request.key.first; it++)
+			{
+				Character& character = it->second;
+				if ((request.key.second && it->first.second != request.key.second) || request.animation >= character.model->Skin_GetAnimationCount())
+					continue;
+
+				character.fade				= request.fadeSeconds;
+				character.fadeDuration		= request.fadeSeconds;
+				character.previous			= character.animation;
+				character.previousTime		= character.time;
+				character.animation			= request.animation;
+				character.time				= 0.0;
+				swap(character.cursor, character.cursorPrevious);
+				character.sampleSteps		= 0; // samples on the next update, whatever the level of detail
+			}
+		}
+
+		// Every character samples and blends its own poses, and writes the slices of the palette of its instances
+		m_threading->Parallel_For(0, (unsigned int)m_charactersActive.size(), GPU_SKINNING_CHARACTERS_PER_TASK, [this, deltaTime](unsigned int start, unsigned int end)
+		{
+			for (unsigned int i = start; i < end; i++)
+			{
+				Character_Update(m_charactersActive[i], deltaTime);
+			}
+		});
+		m_frame++;
+
+		// Grow by doubling, like the structured buffers
+		if (!m_vertexBuffer || m_vertexBuffer->GetMemoryUsage() < m_vertexCount * sizeof(RHI_Vertex_PosUVTBNPacked))
+		{
+			unsigned int capacity = m_vertexBuffer ? m_vertexBuffer->GetMemoryUsage() / sizeof(RHI_Vertex_PosUVTBNPacked) : GPU_SKINNING_THREAD_GROUP_SIZE;
+			while (capacity < m_vertexCount) { capacity *= 2; }
+
+			m_vertexBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
+			if (!m_vertexBuffer->CreateUnorderedAccess(sizeof(RHI_Vertex_PosUVTBNPacked), capacity))
+			{
+				LOG_ERROR("GPUSkinning::Upload: Failed to create vertex buffer");
+				m_vertexBuffer = nullptr;
+				return false;
+			}
+		}
+
+		if (!Buffer_Fit(m_paletteBuffer,	sizeof(Matrix),		(unsigned int)m_palette.size()) ||
+			!Buffer_Fit(m_instanceBuffer,	sizeof(Instance),	(unsigned int)m_instances.size()))
+			return false;
+
+		auto upload = [](const shared_ptr<RHI_StructuredBuffer>& buffer, const void* data, size_t size)
+		{
+			void* mapped = buffer->Map();
+			if (!mapped)
+				return false;
+			memcpy(mapped, data, size);
+			return buffer->Unmap();
+		};
+
+		return
+			upload(m_paletteBuffer,		&m_palette[0],		m_palette.size() * sizeof(Matrix)) &&
+			upload(m_instanceBuffer,	&m_instances[0],	m_instances.size() * sizeof(Instance));
+	}
+
+	int GPUSkinning::Instance_GetVertexOffset(const Actor* actor) const
+	{
+		auto it = m_instanceIndices.find(actor);
+		return it != m_instanceIndices.end() ? (int)m_instances[it->second].outputOffset : -1;
+	}
+
+	bool GPUSkinning::Buffer_Fit(shared_ptr<RHI_StructuredBuffer>& buffer, unsigned int stride, unsigned int elementCount)
+	{
+		if (buffer && buffer->GetElementCount() >= elementCount)
+			return true;
+
+		unsigned int capacity = buffer ? buffer->GetElementCount() : GPU_SKINNING_THREAD_GROUP_SIZE;
+		while (capacity < elementCount) { capacity *= 2; }
+
+		buffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+		if (!buffer->Create(stride, capacity))
+		{
+			LOG_ERROR("GPUSkinning::Buffer_Fit: Failed to create buffer");
+			buffer = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+}
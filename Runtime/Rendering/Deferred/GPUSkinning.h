@@ -0,0 +1,175 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <mutex>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Matrix.h"
+#include "../Animation.h"
+//===============================
+
+// Must match Skinning.hlsl
+#define GPU_SKINNING_THREAD_GROUP_SIZE 64
+
+namespace Directus
+{
+	class Actor;
+	class Model;
+	class Renderable;
+	class Threading;
+	class Transform;
+
+	// Smaller on screen, characters cost less to animate. They sample their animations every few frames and ease from
+	// one sample to the next in between, and the smallest leave their leaf bones (fingers, toes) in the bind pose.
+	struct SkinningLod
+	{
+		float screenSize;		// used once a character is smaller than this fraction of the screen height
+		unsigned int interval;	// frames from one sample to the next
+		bool leafBones;
+	};
+
+	// Poses skinned renderables once a frame, before anything draws them. The CPU only evaluates the
+	// bone palettes, a compute shader blends the bind pose vertices between them and writes the result
+	// to one vertex buffer, in the same packed layout as any model's, so every pass (shadows, the depth
+	// pre-pass, the G-Buffer) draws the posed vertices without knowing they were skinned.
+	class GPUSkinning
+	{
+	public:
+		GPUSkinning(std::shared_ptr<RHI_Device> rhiDevice, Threading* threading);
+		~GPUSkinning() {}
+
+		//= BUILDING (every frame) ==========================================================================
+		void Clear();
+		// Instances of the same model should be added one after the other, they are skinned by the same dispatch. The screen
+		// size picks the level of detail of the character the instance is part of, characters with no instance in view pause.
+		void Instance_Add(Actor* actor, Renderable* renderable, float screenSize, bool visible);
+		// Advances every character's animations by a delta (in seconds) and poses its instances, a job per character,
+		// then uploads the palettes along with the instances, growing the buffers when needed. Returns false if there
+		// is nothing to skin. Characters that weren't added since the last Clear() are forgotten.
+		bool Upload(float deltaTime);
+		//===================================================================================================
+
+		// Crossfades the character an actor belongs to (see Character) into one of its model's animations, from the
+		// start. Thread safe, it takes effect on the next Upload() and only if the character was added by then.
+		void Character_Play(Actor* actor, unsigned int animation, float fadeSeconds);
+
+		// The levels after full detail, each for a smaller screen size than the one before
+		void Lod_Set(unsigned int level, const SkinningLod& lod);
+
+		// Where an actor's posed vertices start in the vertex buffer, -1 if it isn't skinned this frame
+		int Instance_GetVertexOffset(const Actor* actor) const;
+		const std::vector<Actor*>& GetActors() { return m_actors; }
+
+		// A dispatch per batch, a batch is a run of instances of one model
+		struct Batch
+		{
+			Model* model;
+			unsigned int instanceOffset;
+			unsigned int instanceCount;
+			unsigned int vertexCountMax;
+		};
+		const std::vector<Batch>& GetBatches() { return m_batches; }
+
+		const std::shared_ptr<RHI_VertexBuffer>& GetVertexBuffer()			{ return m_vertexBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetPaletteBuffer()		{ return m_paletteBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetInstanceBuffer()	{ return m_instanceBuffer; }
+
+	private:
+		struct Instance
+		{
+			unsigned int vertexOffset;	// in the model's bind pose
+			unsigned int vertexCount;
+			unsigned int outputOffset;	// in the vertex buffer
+			unsigned int paletteOffset;
+		};
+
+		// What the renderables of a model under one root actor share, they are posed together. Animations play on
+		// from frame to frame, and while a fade lasts the one before keeps playing underneath.
+		struct Character
+		{
+			Model* model				= nullptr;
+			unsigned int animation		= 0;
+			double time					= 0.0;
+			unsigned int previous		= 0;
+			double previousTime			= 0.0;
+			float fade					= 0.0f; // seconds left
+			float fadeDuration			= 0.0f;
+			AnimationCursor cursor;
+			AnimationCursor cursorPrevious;
+			AnimationPose pose;
+			AnimationPose posePrevious;
+			std::vector<unsigned int> instances; // this frame's
+			// Level of detail, see SkinningLod
+			float screenSize				= 0.0f;		// this frame's, the largest of its instances
+			bool visible					= false;	// this frame's
+			unsigned int phase				= 0;		// staggers samples, so characters don't all sample in the same frame
+			unsigned int sampleSteps		= 0;		// frames from the last sample to the next
+			unsigned int sampleStep			= 0;		// frames since the last sample
+			AnimationPose poseFrom;
+			AnimationPose poseTo;
+			// The palettes of the instances it was last posed with, what it holds while it's paused
+			std::vector<Math::Matrix> palette;
+			std::vector<unsigned int> paletteVertexOffsets;
+		};
+		typedef std::pair<const Transform*, const Model*> CharacterKey;
+
+		struct PlayRequest
+		{
+			CharacterKey key; // without a model every character under the root
+			unsigned int animation;
+			float fadeSeconds;
+		};
+
+		void Character_Update(Character* character, float deltaTime);
+		// The pose some seconds ahead, crossfaded like the character's own
+		void Character_Sample(Character* character, float ahead, bool leafBones, AnimationPose* pose);
+		const SkinningLod& Lod_Get(float screenSize) const;
+		bool Buffer_Fit(std::shared_ptr<RHI_StructuredBuffer>& buffer, unsigned int stride, unsigned int elementCount);
+
+		std::vector<Instance> m_instances;
+		std::vector<Actor*> m_actors;	// by instance
+		std::vector<Batch> m_batches;
+		std::unordered_map<const Actor*, unsigned int> m_instanceIndices;
+		std::vector<Math::Matrix> m_palette;
+		unsigned int m_vertexCount = 0;
+
+		// Characters outlive the frame, std::map so the ones of this frame can be pointed to
+		std::map<CharacterKey, Character> m_characters;
+		std::vector<Character*> m_charactersActive;
+		std::vector<PlayRequest> m_playRequests;
+		std::mutex m_playMutex;
+		std::vector<SkinningLod> m_lods;
+		SkinningLod m_lodFull;
+		uint64_t m_frame = 0;
+
+		std::shared_ptr<RHI_VertexBuffer> m_vertexBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_paletteBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_instanceBuffer;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		Threading* m_threading;
+	};
+}
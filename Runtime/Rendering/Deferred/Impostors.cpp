@@ -0,0 +1,255 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============================
+#include "Impostors.h"
+#include "../RenderTexturePool.h"
+#include "../Model.h"
+#include "../Material.h"
+#include "../../World/Actor.h"
+#include "../../World/Components/Renderable.h"
+#include "../../RHI/RHI_RenderTexture.h"
+#include "../../RHI/RHI_VertexBuffer.h"
+#include "../../RHI/RHI_IndexBuffer.h"
+#include "../../RHI/RHI_Vertex.h"
+#include "../../Math/MathHelper.h"
+#include "../../Logging/Log.h"
+//==========================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace Directus
+{
+	Impostors::Impostors(shared_ptr<RHI_Device> rhiDevice, shared_ptr<RenderTexturePool> pool)
+	{
+		m_rhiDevice	= rhiDevice;
+		m_pool		= pool;
+
+		for (unsigned int i = 0; i < IMPOSTORS_MAX; i++)
+		{
+			m_slotBaked[i]	= false;
+			m_slotFrames[i]	= 0;
+		}
+
+		// Like the particles' quad, the texture coordinates are the ones within a view
+		vector<RHI_Vertex_PosUV> vertices;
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(-0.5f, 0.5f, 0.0f),	Vector2(0.0f, 0.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(0.5f, 0.5f, 0.0f),	Vector2(1.0f, 0.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(0.5f, -0.5f, 0.0f),	Vector2(1.0f, 1.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(-0.5f, -0.5f, 0.0f),	Vector2(0.0f, 1.0f)));
+		vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+
+		m_vertexBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
+		if (!m_vertexBuffer->Create(vertices))
+		{
+			LOG_ERROR("Impostors::Impostors: Failed to create vertex buffer");
+		}
+
+		m_indexBuffer = make_shared<RHI_IndexBuffer>(m_rhiDevice);
+		if (!m_indexBuffer->Create(indices))
+		{
+			LOG_ERROR("Impostors::Impostors: Failed to create index buffer");
+		}
+	}
+
+	Impostors::~Impostors()
+	{
+		for (const auto& atlas : m_atlas)
+		{
+			m_pool->Release(atlas.second);
+		}
+	}
+
+	int Impostors::Get(Renderable* renderable)
+	{
+		Key key;
+		if (!GetKey(renderable, &key))
+			return -1;
+
+		auto it = m_slots.find(key);
+		if (it != m_slots.end())
+		{
+			m_slotFrames[it->second] = m_frame;
+			return (int)it->second;
+		}
+
+		lock_guard<mutex> lock(m_requestsMutex);
+		m_requests.insert(key);
+		return -1;
+	}
+
+	bool Impostors::Bake_Next(const vector<Actor*>& actors, Renderable** renderable, unsigned int* slot)
+	{
+		m_frame++;
+
+		// What's still far away gets requested again, every frame
+		unordered_set<Key, KeyHash> requests;
+		{
+			lock_guard<mutex> lock(m_requestsMutex);
+			requests.swap(m_requests);
+		}
+
+		if (requests.empty() || !renderable || !slot)
+			return false;
+
+		// An empty slot, otherwise the one that was drawn the longest ago, as long as that's a while
+		int chosen = -1;
+		for (unsigned int i = 0; i < IMPOSTORS_MAX; i++)
+		{
+			if (!m_slotBaked[i])
+			{
+				chosen = i;
+				break;
+			}
+
+			if (m_frame - m_slotFrames[i] >= IMPOSTOR_EVICT_FRAMES && (chosen == -1 || m_slotFrames[i] < m_slotFrames[chosen]))
+			{
+				chosen = i;
+			}
+		}
+
+		if (chosen == -1 || !Atlas_Create())
+			return false;
+
+		// The actors might have changed since the request, so the renderable is looked up again
+		for (const auto& actor : actors)
+		{
+			Key key;
+			Renderable* candidate = actor->GetRenderable_PtrRaw();
+			if (!GetKey(candidate, &key) || candidate->Geometry_IsSkinned() || requests.find(key) == requests.end())
+				continue;
+
+			*renderable	= candidate;
+			*slot		= (unsigned int)chosen;
+			return true;
+		}
+
+		return false;
+	}
+
+	void Impostors::Bake_Store(Renderable* renderable, unsigned int slot, GBuffer* gbuffer)
+	{
+		Key key;
+		if (slot >= IMPOSTORS_MAX || !gbuffer || !GetKey(renderable, &key))
+			return;
+
+		// Whatever was in the slot before isn't drawn anymore
+		if (m_slotBaked[slot])
+		{
+			m_slots.erase(m_slotKeys[slot]);
+			m_slotBaked[slot] = false;
+		}
+
+		unsigned int x = (slot % IMPOSTOR_ATLAS_TILES) * IMPOSTOR_TILE_SIZE;
+		unsigned int y = (slot / IMPOSTOR_ATLAS_TILES) * IMPOSTOR_TILE_SIZE;
+		for (auto& atlas : m_atlas)
+		{
+			if (!atlas.second->CopyRegionFrom(gbuffer->GetTexture(atlas.first), x, y))
+				return;
+		}
+
+		m_slotKeys[slot]	= key;
+		m_slotBaked[slot]	= true;
+		m_slotFrames[slot]	= m_frame;
+		m_slots[key]		= slot;
+	}
+
+	void Impostors::Clear()
+	{
+		m_slots.clear();
+		for (auto& baked : m_slotBaked) { baked = false; }
+
+		lock_guard<mutex> lock(m_requestsMutex);
+		m_requests.clear();
+	}
+
+	Vector3 Impostors::GetViewDirection(unsigned int x, unsigned int y)
+	{
+		// Where the cell's centre is on the octahedron, folded onto the upper hemisphere
+		float u		= (float(x) + 0.5f) / IMPOSTOR_GRID * 2.0f - 1.0f;
+		float v		= (float(y) + 0.5f) / IMPOSTOR_GRID * 2.0f - 1.0f;
+		float dx	= (u + v) * 0.5f;
+		float dz	= (u - v) * 0.5f;
+		return Vector3::Normalize(Vector3(dx, 1.0f - Abs(dx) - Abs(dz), dz));
+	}
+
+	Matrix Impostors::GetView(const Vector3& center, float radius, const Vector3& direction)
+	{
+		// Looking straight down, up can't be the world's (must match Impostor.hlsl)
+		Vector3 up = Abs(direction.y) > 0.999f ? Vector3(0.0f, 0.0f, 1.0f) : Vector3::Up;
+		return Matrix::CreateLookAtLH(center + direction * radius, center, up);
+	}
+
+	Matrix Impostors::GetProjection(float radius, bool reverseZ)
+	{
+		return reverseZ ? Matrix::CreateOrthographicLH(radius * 2.0f, radius * 2.0f, radius * 2.0f, 0.0f) : Matrix::CreateOrthographicLH(radius * 2.0f, radius * 2.0f, 0.0f, radius * 2.0f);
+	}
+
+	Matrix Impostors::GetTransform(const BoundingBox& aabb, const Matrix& world, unsigned int slot)
+	{
+		Matrix transform	= Matrix::CreateScale(aabb.GetExtents().Length()) * Matrix::CreateTranslation(aabb.GetCenter()) * world;
+		transform.m03		= float(slot);
+		return transform;
+	}
+
+	bool Impostors::GetKey(Renderable* renderable, Key* key)
+	{
+		auto model		= renderable ? renderable->Geometry_Model() : nullptr;
+		auto material	= renderable ? renderable->Material_Ptr() : nullptr;
+		if (!model || !material)
+			return false;
+
+		key->model		= model->Resource_GetID();
+		key->geometry	= renderable->Geometry_IndexOffset();
+		key->material	= material->Resource_GetID();
+		return true;
+	}
+
+	bool Impostors::Atlas_Create()
+	{
+		if (!m_atlas.empty())
+			return true;
+
+		// The same formats as the G-Buffer's, so the views copy straight in
+		unsigned int size					= IMPOSTOR_TILE_SIZE * IMPOSTOR_ATLAS_TILES;
+		m_atlas[GBuffer_Target_Albedo]		= m_pool->Acquire(size, size, Texture_Format_R8G8B8A8_UNORM);
+		m_atlas[GBuffer_Target_Normal]		= m_pool->Acquire(size, size, Texture_Format_R8G8B8A8_UNORM);
+		m_atlas[GBuffer_Target_Specular]	= m_pool->Acquire(size, size, Texture_Format_R8G8B8A8_UNORM);
+		m_atlas[GBuffer_Target_Depth]		= m_pool->Acquire(size, size, Texture_Format_R32G32_FLOAT);
+
+		for (const auto& atlas : m_atlas)
+		{
+			if (!atlas.second)
+			{
+				LOG_ERROR("Impostors::Atlas_Create: Failed to create the atlas");
+				for (const auto& created : m_atlas) { if (created.second) m_pool->Release(created.second); }
+				m_atlas.clear();
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
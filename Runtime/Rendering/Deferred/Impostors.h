@@ -0,0 +1,127 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========================
+#include <memory>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include "GBuffer.h"
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Vector3.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/BoundingBox.h"
+//=====================================
+
+#define IMPOSTOR_GRID			8	// views per side of the hemi-octahedral grid, must match Impostor.hlsl
+#define IMPOSTOR_CELL_SIZE		64	// texels per side of a view, must match Impostor.hlsl
+#define IMPOSTOR_TILE_SIZE		(IMPOSTOR_GRID * IMPOSTOR_CELL_SIZE)
+#define IMPOSTOR_ATLAS_TILES	4	// tiles per side of the atlas, must match Impostor.hlsl
+#define IMPOSTORS_MAX			(IMPOSTOR_ATLAS_TILES * IMPOSTOR_ATLAS_TILES)
+#define IMPOSTOR_EVICT_FRAMES	120	// an impostor that wasn't drawn for this long makes room for a requested one
+
+namespace Directus
+{
+	class Actor;
+	class Renderable;
+	class RenderTexturePool;
+
+	// Far away, opaque static geometry is drawn as a camera facing quad. Out of IMPOSTOR_GRID x IMPOSTOR_GRID directions
+	// over the upper hemisphere (a hemi-octahedral grid), the renderer bakes the G-Buffer of a renderable into a tile of
+	// atlases, the first time one is asked for. The quads are drawn out of the view closest to the camera's direction,
+	// with the depth and the normal each texel saw, so they light and occlude like the geometry they stand in for.
+	// Renderables are told apart by their model, their geometry within it and their material, instances share one.
+	class Impostors
+	{
+	public:
+		Impostors(std::shared_ptr<RHI_Device> rhiDevice, std::shared_ptr<RenderTexturePool> pool);
+		~Impostors();
+
+		// The slot of the renderable's impostor, or -1 until it's baked, in which case it gets requested.
+		// Safe to call while the command lists are recorded.
+		int Get(Renderable* renderable);
+
+		//= BAKING (render thread, ahead of the G-Buffer) ===========================================================
+		// Once per frame, the first requested renderable still among the actors along with the slot it goes into,
+		// evicting what hasn't been drawn for a while when the atlas is full. False if there is nothing to bake.
+		bool Bake_Next(const std::vector<Actor*>& actors, Renderable** renderable, unsigned int* slot);
+		// Copies the views out of the G-Buffer they were rendered into, the renderable is drawn out of the slot from now on
+		void Bake_Store(Renderable* renderable, unsigned int slot, GBuffer* gbuffer);
+		//===========================================================================================================
+
+		// Forgets every impostor, e.g. when materials change. They get baked again as they are needed.
+		void Clear();
+
+		// The direction a view looks at the renderable from, out of where it's cell is in the grid
+		static Math::Vector3 GetViewDirection(unsigned int x, unsigned int y);
+		// Looking at the bounding sphere from the direction (as far as it's radius), and an orthographic projection that fits it
+		static Math::Matrix GetView(const Math::Vector3& center, float radius, const Math::Vector3& direction);
+		static Math::Matrix GetProjection(float radius, bool reverseZ);
+		// What an instance is drawn with, the unit sphere scaled and moved onto the bounding sphere and then into the
+		// world, with the slot in it's otherwise unused m03
+		static Math::Matrix GetTransform(const Math::BoundingBox& aabb, const Math::Matrix& world, unsigned int slot);
+
+		// Albedo, normal, specular and depth, in the formats of the G-Buffer's
+		const std::shared_ptr<RHI_RenderTexture>& GetAtlas(GBuffer_Texture_Type type)	{ return m_atlas[type]; }
+		// A quad, every impostor is an instance of it
+		const std::shared_ptr<RHI_VertexBuffer>& GetVertexBuffer()						{ return m_vertexBuffer; }
+		const std::shared_ptr<RHI_IndexBuffer>& GetIndexBuffer()						{ return m_indexBuffer; }
+
+	private:
+		struct Key
+		{
+			unsigned int model		= 0;
+			unsigned int geometry	= 0; // index offset
+			unsigned int material	= 0;
+
+			bool operator==(const Key& rhs) const { return model == rhs.model && geometry == rhs.geometry && material == rhs.material; }
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const { return (size_t(key.model) * 73856093u) ^ (size_t(key.geometry) * 19349663u) ^ (size_t(key.material) * 83492791u); }
+		};
+
+		static bool GetKey(Renderable* renderable, Key* key);
+		bool Atlas_Create();
+
+		// Read while the command lists are recorded, only written by the baking in between
+		std::unordered_map<Key, unsigned int, KeyHash> m_slots;
+		Key m_slotKeys[IMPOSTORS_MAX];
+		bool m_slotBaked[IMPOSTORS_MAX];
+		std::atomic<uint64_t> m_slotFrames[IMPOSTORS_MAX]; // the last one it was drawn in
+		uint64_t m_frame = 0;
+
+		std::unordered_set<Key, KeyHash> m_requests;
+		std::mutex m_requestsMutex;
+
+		std::map<GBuffer_Texture_Type, std::shared_ptr<RHI_RenderTexture>> m_atlas;
+		std::shared_ptr<RHI_VertexBuffer> m_vertexBuffer;
+		std::shared_ptr<RHI_IndexBuffer> m_indexBuffer;
+		std::shared_ptr<RenderTexturePool> m_pool;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
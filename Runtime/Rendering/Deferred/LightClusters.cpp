@@ -0,0 +1,236 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "LightClusters.h"
+#include "ShadowAtlas.h"
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include "../../World/Actor.h"
+#include "../../World/Components/Camera.h"
+#include "../../World/Components/Light.h"
+#include "../../World/Components/Transform.h"
+#include "../../RHI/RHI_StructuredBuffer.h"
+#include "../../Math/MathHelper.h"
+#include "../../Math/Vector2.h"
+#include "../../Logging/Log.h"
+//==============================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace Directus
+{
+	LightClusters::LightClusters(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+
+		m_lightBuffer = make_shared<RHI_StructuredBuffer>(rhiDevice);
+		m_lightBuffer->Create(sizeof(ClusterLight), CLUSTER_LIGHTS_MAX);
+
+		m_gridBuffer = make_shared<RHI_StructuredBuffer>(rhiDevice);
+		m_gridBuffer->Create(sizeof(unsigned int) * 2, CLUSTER_COUNT);
+
+		m_indexBuffer = make_shared<RHI_StructuredBuffer>(rhiDevice);
+		m_indexBuffer->Create(sizeof(unsigned int), CLUSTER_LIGHT_INDICES_MAX);
+
+		m_lights.reserve(CLUSTER_LIGHTS_MAX);
+		m_ranges.reserve(CLUSTER_LIGHTS_MAX);
+		m_clusterCounts.resize(CLUSTER_COUNT);
+		m_clusterOffsets.resize(CLUSTER_COUNT);
+	}
+
+	bool LightClusters::Build(const vector<Actor*>& lights, Camera* camera, const Matrix& mView, const Matrix& mProjection, ShadowAtlas* shadowAtlas /*= nullptr*/)
+	{
+		m_lightCount = 0;
+
+		// Without a camera nothing gets binned, the grid is still uploaded (empty) so the light pass doesn't shade with the last one
+		static const vector<Actor*> none;
+		float nearPlane	= camera ? camera->GetNearPlane() : 0.0f;
+		float farPlane	= camera ? camera->GetFarPlane() : 0.0f;
+		if (camera)
+		{
+			m_sliceScale = (float)CLUSTER_SLICES / log(farPlane / nearPlane);
+		}
+
+		// Gather the point and spot lights which are in front of the camera
+		m_lights.clear();
+		m_ranges.clear();
+		for (const auto& actor : camera ? lights : none)
+		{
+			auto light = actor->GetComponent_PtrRaw<Light>();
+			if (!light || light->GetLightType() == LightType_Directional)
+				continue;
+
+			if (m_lights.size() == CLUSTER_LIGHTS_MAX)
+			{
+				if (!m_limitReported)
+				{
+					LOGF_WARNING("LightClusters::Build: Only %d point and spot lights are supported, the rest will be ignored", CLUSTER_LIGHTS_MAX);
+					m_limitReported = true;
+				}
+				break;
+			}
+
+			// Spot lights are bounded by a sphere as well, it's conservative but cheap
+			Vector3 position = actor->GetTransform_PtrRaw()->GetPosition();
+			ClusterRange range;
+			if (!ComputeRange(position * mView, light->GetRange(), mProjection, nearPlane, farPlane, range))
+				continue;
+
+			Vector4 color		= light->GetColor();
+			Vector3 direction	= light->GetDirection();
+
+			ClusterLight clusterLight;
+			clusterLight.positionRange	= Vector4(position.x, position.y, position.z, light->GetRange());
+			clusterLight.colorIntensity	= Vector4(color.x, color.y, color.z, light->GetIntensity());
+			clusterLight.directionAngle	= Vector4(direction.x, direction.y, direction.z, light->GetAngle());
+			clusterLight.type			= Vector4(light->GetLightType() == LightType_Spot ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f);
+			clusterLight.shadow			= Vector4(shadowAtlas ? (float)shadowAtlas->Light_GetTile(light) : -1.0f, light->GetBias(), 0.0f, 0.0f);
+
+			m_lights.emplace_back(clusterLight);
+			m_ranges.emplace_back(range);
+		}
+		m_lightCount = (unsigned int)m_lights.size();
+
+		// Count the lights of each cluster
+		fill(m_clusterCounts.begin(), m_clusterCounts.end(), 0);
+		for (const auto& range : m_ranges)
+		{
+			for (unsigned int z = range.minZ; z <= range.maxZ; z++)
+			{
+				for (unsigned int y = range.minY; y <= range.maxY; y++)
+				{
+					for (unsigned int x = range.minX; x <= range.maxX; x++)
+					{
+						m_clusterCounts[x + y * CLUSTER_TILES_X + z * CLUSTER_TILES_X * CLUSTER_TILES_Y]++;
+					}
+				}
+			}
+		}
+
+		// Turn the counts into offsets, anything past the end of the index buffer gets dropped
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < CLUSTER_COUNT; i++)
+		{
+			m_clusterCounts[i]	= Min(m_clusterCounts[i], (unsigned int)CLUSTER_LIGHT_INDICES_MAX - offset);
+			m_clusterOffsets[i]	= offset;
+			offset				+= m_clusterCounts[i];
+		}
+
+		// Upload the grid
+		auto grid = (unsigned int*)m_gridBuffer->Map();
+		if (!grid)
+			return false;
+		for (unsigned int i = 0; i < CLUSTER_COUNT; i++)
+		{
+			grid[i * 2]		= m_clusterOffsets[i];
+			grid[i * 2 + 1]	= m_clusterCounts[i];
+		}
+		m_gridBuffer->Unmap();
+
+		if (m_lightCount == 0)
+			return false;
+
+		// Upload the light indices, the offsets double as write cursors from here on
+		auto indices = (unsigned int*)m_indexBuffer->Map();
+		if (!indices)
+			return false;
+		for (unsigned int lightIndex = 0; lightIndex < m_lightCount; lightIndex++)
+		{
+			const auto& range = m_ranges[lightIndex];
+			for (unsigned int z = range.minZ; z <= range.maxZ; z++)
+			{
+				for (unsigned int y = range.minY; y <= range.maxY; y++)
+				{
+					for (unsigned int x = range.minX; x <= range.maxX; x++)
+					{
+						unsigned int cluster = x + y * CLUSTER_TILES_X + z * CLUSTER_TILES_X * CLUSTER_TILES_Y;
+						if (m_clusterCounts[cluster] == 0)
+							continue;
+
+						indices[m_clusterOffsets[cluster]++] = lightIndex;
+						m_clusterCounts[cluster]--;
+					}
+				}
+			}
+		}
+		m_indexBuffer->Unmap();
+
+		// Upload the lights
+		auto lightData = (ClusterLight*)m_lightBuffer->Map();
+		if (!lightData)
+			return false;
+		memcpy(lightData, m_lights.data(), m_lightCount * sizeof(ClusterLight));
+		m_lightBuffer->Unmap();
+
+		return true;
+	}
+
+	bool LightClusters::ComputeRange(const Vector3& positionVS, float radius, const Matrix& mProjection, float nearPlane, float farPlane, ClusterRange& range)
+	{
+		float zMin = positionVS.z - radius;
+		float zMax = positionVS.z + radius;
+		if (zMax < nearPlane || zMin > farPlane)
+			return false;
+
+		zMin = Max(zMin, nearPlane);
+		zMax = Min(zMax, farPlane);
+
+		// Depth slices are distributed exponentially
+		auto ToSlice = [this, nearPlane](float z) { return (unsigned int)Clamp((int)(log(z / nearPlane) * m_sliceScale), 0, CLUSTER_SLICES - 1); };
+		range.minZ = ToSlice(zMin);
+		range.maxZ = ToSlice(zMax);
+
+		// Project the corners of the sphere's view space box, the part behind the near plane was clipped above
+		Vector2 ndcMin = Vector2(FLT_MAX, FLT_MAX);
+		Vector2 ndcMax = Vector2(-FLT_MAX, -FLT_MAX);
+		for (unsigned int i = 0; i < 8; i++)
+		{
+			Vector3 corner = Vector3
+			(
+				positionVS.x + ((i & 1) ? radius : -radius),
+				positionVS.y + ((i & 2) ? radius : -radius),
+				(i & 4) ? zMax : zMin
+			);
+
+			Vector3 ndc	= corner * mProjection;
+			ndcMin		= Vector2(Min(ndcMin.x, ndc.x), Min(ndcMin.y, ndc.y));
+			ndcMax		= Vector2(Max(ndcMax.x, ndc.x), Max(ndcMax.y, ndc.y));
+		}
+
+		if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+			return false;
+
+		// NDC to tiles, tiles go top to bottom
+		auto ToTile = [](float uv, int tileCount) { return (unsigned int)Clamp((int)(uv * tileCount), 0, tileCount - 1); };
+		range.minX = ToTile(ndcMin.x * 0.5f + 0.5f, CLUSTER_TILES_X);
+		range.maxX = ToTile(ndcMax.x * 0.5f + 0.5f, CLUSTER_TILES_X);
+		range.minY = ToTile(0.5f - ndcMax.y * 0.5f, CLUSTER_TILES_Y);
+		range.maxY = ToTile(0.5f - ndcMin.y * 0.5f, CLUSTER_TILES_Y);
+
+		return true;
+	}
+}
@@ -0,0 +1,98 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/Vector4.h"
+//===============================
+
+// Must match Light.hlsl
+#define CLUSTER_TILES_X				16
+#define CLUSTER_TILES_Y				9
+#define CLUSTER_SLICES				24
+#define CLUSTER_COUNT				(CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES)
+#define CLUSTER_LIGHTS_MAX			1024
+#define CLUSTER_LIGHT_INDICES_MAX	(CLUSTER_COUNT * 32)
+
+namespace Directus
+{
+	class Actor;
+	class Camera;
+	class ShadowAtlas;
+
+	// Bins point and spot lights into view space froxels, so the light pass
+	// only has to evaluate the lights that can actually reach a given pixel
+	class LightClusters
+	{
+	public:
+		LightClusters(std::shared_ptr<RHI_Device> rhiDevice);
+		~LightClusters() {}
+
+		// Builds the clusters on the CPU and uploads them, returns false if there is nothing to shade.
+		// The shadow atlas is optional, it tells the lights where their shadows are.
+		bool Build(const std::vector<Actor*>& lights, Camera* camera, const Math::Matrix& mView, const Math::Matrix& mProjection, ShadowAtlas* shadowAtlas = nullptr);
+
+		const std::shared_ptr<RHI_StructuredBuffer>& GetLightBuffer()	{ return m_lightBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetGridBuffer()	{ return m_gridBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetIndexBuffer()	{ return m_indexBuffer; }
+		unsigned int GetLightCount()									{ return m_lightCount; }
+		// Multiplier that turns log(z / near) into a depth slice
+		float GetSliceScale()											{ return m_sliceScale; }
+
+	private:
+		struct ClusterLight
+		{
+			Math::Vector4 positionRange;	// xyz: world position, w: range
+			Math::Vector4 colorIntensity;	// rgb: color, a: intensity
+			Math::Vector4 directionAngle;	// xyz: world direction, w: spot angle
+			Math::Vector4 type;				// x: 0 for point, 1 for spot
+			Math::Vector4 shadow;			// x: first shadow atlas tile or -1, y: depth bias
+		};
+
+		// The inclusive cluster range that a light overlaps
+		struct ClusterRange
+		{
+			unsigned int minX, maxX;
+			unsigned int minY, maxY;
+			unsigned int minZ, maxZ;
+		};
+
+		bool ComputeRange(const Math::Vector3& positionVS, float radius, const Math::Matrix& mProjection, float nearPlane, float farPlane, ClusterRange& range);
+
+		std::vector<ClusterLight> m_lights;
+		std::vector<ClusterRange> m_ranges;
+		std::vector<unsigned int> m_clusterCounts;
+		std::vector<unsigned int> m_clusterOffsets;
+		unsigned int m_lightCount	= 0;
+		float m_sliceScale			= 0.0f;
+		bool m_limitReported		= false;
+
+		std::shared_ptr<RHI_StructuredBuffer> m_lightBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_gridBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_indexBuffer;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
@@ -21,8 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ================================
 #include "LightShader.h"
+#include "LightClusters.h"
 #include "../../World/Components/Transform.h"
 #include "../../World/Actor.h"
+#include "../../World/Components/Skybox.h"
+#include "../../World/Components/LightProbeVolume.h"
 #include "../../Core/Settings.h"
 #include "../../RHI/RHI_Shader.h"
 #include "../../RHI/RHI_ConstantBuffer.h"
@@ -50,18 +53,22 @@ namespace Directus
 
 	void LightShader::UpdateConstantBuffer(
 		const Matrix& mWorld,
-		const Matrix& mView,
+		const Matrix& mViewProjectionInverse,
 		const Matrix& mBaseView,
-		const Matrix& mPerspectiveProjection,
 		const Matrix& mOrthographicProjection,
 		const vector<Actor*>& lights,
-		Camera* camera
+		LightClusters* clusters,
+		Camera* camera,
+		Skybox* skybox,
+		LightProbeVolume* probes,
+		float resolutionScale,
+		unsigned int checkerboardParity /*= 0*/
 	)
 	{
 		if (GetState() != Shader_Built)
 			return;
 
-		if (!camera || lights.empty())
+		if (!camera || !clusters || lights.empty())
 			return;
 
 		// Get a pointer to the data in the constant buffer.
@@ -75,26 +82,17 @@ namespace Directus
 		Vector3 camPos					= camera->GetTransform()->GetPosition();
 		buffer->cameraPosition			= Vector4(camPos.x, camPos.y, camPos.z, 1.0f);
 		buffer->wvp						= mWorld * mBaseView * mOrthographicProjection;
-		buffer->viewProjectionInverse	= (mView * mPerspectiveProjection).Inverted();
+		buffer->viewProjectionInverse	= mViewProjectionInverse;
 
 		// Reset any light buffer values because the shader will still use them
 		buffer->dirLightColor = Vector4::Zero;
 		buffer->dirLightDirection = Vector4::Zero;
 		buffer->dirLightIntensity = Vector4::Zero;
-		for (int i = 0; i < maxLights; i++)
-		{
-			buffer->pointLightPosition[i]		= Vector4::Zero;
-			buffer->pointLightColor[i]			= Vector4::Zero;
-			buffer->pointLightIntenRange[i]		= Vector4::Zero;
-			buffer->spotLightPosition[i]		= Vector4::Zero;
-			buffer->spotLightColor[i]			= Vector4::Zero;
-			buffer->spotLightIntenRangeAngle[i] = Vector4::Zero;
-		}
 
 		// Fill with directional lights
 		for (const auto& light : lights)
 		{
-			auto component = light->GetComponent<Light>();
+			auto component = light->GetComponent_PtrRaw<Light>();
 
 			if (component->GetLightType() != LightType_Directional)
 				continue;
@@ -106,50 +104,34 @@ namespace Directus
 			buffer->dirLightDirection = Vector4(direction.x, direction.y, direction.z, 0.0f);
 		}
 
-		// Fill with point lights
-		int pointIndex = 0;
-		for (const auto& light : lights)
+		buffer->clusterSliceScale	= clusters->GetSliceScale();
+		buffer->clusterLightCount	= (float)clusters->GetLightCount();
+		buffer->nearPlane			= camera->GetNearPlane();
+		buffer->farPlane			= camera->GetFarPlane();
+		buffer->viewport			= Settings::Get().Resolution_Get();
+		buffer->resolutionScale		= resolutionScale;
+		buffer->checkerboardParity	= (float)checkerboardParity;
+		buffer->padding				= Vector3::Zero;
+
+		// Without a prefiltered environment the irradiance is zero and the specular samples the skybox as is
+		auto irradianceSH				= skybox ? skybox->GetEnvironmentIrradianceSH() : nullptr;
+		buffer->environmentMipCount		= skybox ? (float)skybox->GetEnvironmentMipCount() : 1.0f;
+		for (unsigned int i = 0; i < 9; i++)
 		{
-			auto component = light->GetComponent<Light>();
-
-			if (component->GetLightType() != LightType_Point)
-				continue;
-
-			Vector3 pos = light->GetTransform_PtrRaw()->GetPosition();
-
-			buffer->pointLightPosition[pointIndex]		= Vector4(pos.x, pos.y, pos.z, 1.0f);
-			buffer->pointLightColor[pointIndex]			= component->GetColor();
-			buffer->pointLightIntenRange[pointIndex]	= Vector4(component->GetIntensity(), component->GetRange(), 0.0f, 0.0f);
-
-			pointIndex++;
+			buffer->environmentSH[i] = irradianceSH ? irradianceSH[i] : Vector4::Zero;
 		}
 
-		// Fill with spot lights
-		int spotIndex = 0;
-		for (const auto& light : lights)
+		if (probes && probes->IsBaked())
 		{
-			auto component = light->GetComponent<Light>();
-
-			if (component->GetLightType() != LightType_Spot)
-				continue;
-
-			Vector3 direction	= component->GetDirection();
-			Vector3 pos			= light->GetTransform_PtrRaw()->GetPosition();
-
-			buffer->spotLightColor[spotIndex]			= component->GetColor();
-			buffer->spotLightPosition[spotIndex]		= Vector4(pos.x, pos.y, pos.z, 1.0f);
-			buffer->spotLightDirection[spotIndex]		= Vector4(direction.x, direction.y, direction.z, 0.0f);
-			buffer->spotLightIntenRangeAngle[spotIndex] = Vector4(component->GetIntensity(), component->GetRange(), component->GetAngle(), 0.0f);
-
-			spotIndex++;
+			auto count				= probes->GetCount();
+			buffer->probeOrigin		= Vector4(probes->GetOrigin(), probes->GetSpacingBaked());
+			buffer->probeCount		= Vector4((float)count[0], (float)count[1], (float)count[2], 1.0f);
+		}
+		else
+		{
+			buffer->probeOrigin		= Vector4::Zero;
+			buffer->probeCount		= Vector4::Zero;
 		}
-
-		buffer->pointLightCount = (float)pointIndex;
-		buffer->spotLightCount	= (float)spotIndex;
-		buffer->nearPlane		= camera->GetNearPlane();
-		buffer->farPlane		= camera->GetFarPlane();
-		buffer->viewport		= Settings::Get().Resolution_Get();
-		buffer->padding			= Vector2::Zero;
 
 		// Unmap buffer
 		m_cbuffer->Unmap();
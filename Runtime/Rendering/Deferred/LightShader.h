@@ -33,6 +33,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Directus
 {
+	class LightClusters;
+	class Skybox;
+	class LightProbeVolume;
+
 	class LightShader : public RHI_Shader
 	{
 	public:
@@ -42,18 +46,21 @@ namespace Directus
 		void Compile(const std::string& filePath, Context* context);
 		void UpdateConstantBuffer(
 			const Math::Matrix& mWorld,
-			const Math::Matrix& mView,
+			const Math::Matrix& mViewProjectionInverse,
 			const Math::Matrix& mBaseView,
-			const Math::Matrix& mPerspectiveProjection,
 			const Math::Matrix& mOrthographicProjection,
 			const std::vector<Actor*>& lights,
-			Camera* camera
+			LightClusters* clusters,
+			Camera* camera,
+			Skybox* skybox,
+			LightProbeVolume* probes,
+			float resolutionScale,
+			unsigned int checkerboardParity = 0
 		);
 
 		std::shared_ptr<RHI_ConstantBuffer> GetConstantBuffer()	{ return m_cbuffer; }
 
 	private:
-		const static int maxLights = 64;
 		struct LightBuffer
 		{
 			Math::Matrix wvp;
@@ -66,25 +73,26 @@ namespace Directus
 			Math::Vector4 dirLightDirection;
 			//==============================
 
-			//= POINT LIGHTS =============================
-			Math::Vector4 pointLightPosition[maxLights];
-			Math::Vector4 pointLightColor[maxLights];
-			Math::Vector4 pointLightIntenRange[maxLights];
-			//============================================
-
-			//= SPOT LIGHTS ==================================
-			Math::Vector4 spotLightColor[maxLights];
-			Math::Vector4 spotLightPosition[maxLights];
-			Math::Vector4 spotLightDirection[maxLights];
-			Math::Vector4 spotLightIntenRangeAngle[maxLights];
-			//================================================
-
-			float pointLightCount;
-			float spotLightCount;
+			// Point and spot lights live in the cluster buffers
+			float clusterSliceScale;
+			float clusterLightCount;
 			float nearPlane;
 			float farPlane;
 			Math::Vector2 viewport;
-			Math::Vector2 padding;
+			float resolutionScale;
+			float environmentMipCount;
+
+			// Which half of the checkerboard gets lit, only read by the CHECKERBOARD variation
+			float checkerboardParity;
+			Math::Vector3 padding;
+
+			// Diffuse irradiance of the skybox, see ImageBasedLighting
+			Math::Vector4 environmentSH[9];
+
+			// Diffuse irradiance inside the light probe volume, xyz is the first probe and w the spacing
+			Math::Vector4 probeOrigin;
+			// xyz is probes per axis, w is 1 when there are any
+			Math::Vector4 probeCount;
 		};
 
 		std::shared_ptr<RHI_ConstantBuffer> m_cbuffer;
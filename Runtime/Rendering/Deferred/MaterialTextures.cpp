@@ -0,0 +1,216 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================================
+#include "MaterialTextures.h"
+#include "../../RHI/RHI_Texture.h"
+#include "../../RHI/RHI_TextureArray.h"
+#include "../../Logging/Log.h"
+//================================================
+
+//= NAMESPACES ================
+using namespace std;
+//=============================
+
+namespace Directus
+{
+	MaterialTextures::MaterialTextures(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+	}
+
+	MaterialTextures::~MaterialTextures()
+	{
+		Clear();
+	}
+
+	void MaterialTextures::Update()
+	{
+		for (auto it = m_textures.begin(); it != m_textures.end();)
+		{
+			it = m_arrays[it->second.array].slices[it->second.slice].expired() ? m_textures.erase(it) : next(it);
+		}
+
+		// Arrays nothing is left in
+		for (auto& array : m_arrays)
+		{
+			if (!array.array)
+				continue;
+
+			bool empty = true;
+			for (const auto& slice : array.slices)
+			{
+				empty = empty && slice.expired();
+			}
+
+			if (empty)
+			{
+				m_bytes -= array.array->GetBytes();
+				array.array.reset();
+				array.slices.clear();
+			}
+		}
+	}
+
+	void MaterialTextures::Material_Add(Material* material)
+	{
+		if (!material)
+			return;
+
+		for (unsigned int i = 0; i < MATERIAL_GBUFFER_TEXTURES; i++)
+		{
+			auto texture = material->GetTextureSlotByType(TextureType(TextureType_Albedo + i)).ptr_weak.lock();
+			if (texture)
+			{
+				Texture_Add(texture);
+			}
+		}
+	}
+
+	bool MaterialTextures::Material_Get(Material* material, void** arrays, unsigned int* slices) const
+	{
+		if (!material)
+			return false;
+
+		for (unsigned int i = 0; i < MATERIAL_GBUFFER_TEXTURES; i++)
+		{
+			arrays[i] = nullptr;
+			slices[i] = 0;
+
+			// Textures the material doesn't have aren't sampled
+			auto texture = material->GetTextureSlotByType(TextureType(TextureType_Albedo + i)).ptr_raw;
+			if (!texture)
+				continue;
+
+			// Missing, or copied from a shader resource streaming has since replaced
+			auto it = m_textures.find(texture);
+			if (it == m_textures.end() || it->second.shaderResource != texture->GetShaderResource())
+				return false;
+
+			arrays[i] = m_arrays[it->second.array].array->GetShaderResource();
+			slices[i] = it->second.slice;
+		}
+
+		return true;
+	}
+
+	void MaterialTextures::Clear()
+	{
+		m_textures.clear();
+		m_arrays.clear();
+		m_bytes = 0;
+	}
+
+	bool MaterialTextures::Texture_Add(const shared_ptr<RHI_Texture>& texture)
+	{
+		if (!texture->GetShaderResource())
+			return false;
+
+		// Already there, or in the array of its previous size
+		auto it = m_textures.find(texture.get());
+		if (it != m_textures.end())
+		{
+			if (it->second.shaderResource == texture->GetShaderResource())
+				return true;
+
+			m_arrays[it->second.array].slices[it->second.slice].reset();
+			m_textures.erase(it);
+		}
+
+		int index = Array_Find(texture.get());
+		if (index == -1)
+			return false;
+
+		auto& array = m_arrays[index];
+		unsigned int slice = 0;
+		while (!array.slices[slice].expired()) { slice++; }
+
+		if (!array.array->Slice_Copy(slice, texture.get()))
+			return false;
+
+		array.slices[slice]			= texture;
+		m_textures[texture.get()]	= { (unsigned int)index, slice, texture->GetShaderResource() };
+		return true;
+	}
+
+	int MaterialTextures::Array_Find(RHI_Texture* texture)
+	{
+		auto width	= texture->GetShaderResourceWidth();
+		auto height	= texture->GetShaderResourceHeight();
+		auto mips	= texture->GetShaderResourceMips();
+		auto format	= texture->GetFormat();
+
+		// The array of the same kind, if there is one with room the texture goes there
+		int match = -1;
+		int unused = -1;
+		for (unsigned int i = 0; i < (unsigned int)m_arrays.size(); i++)
+		{
+			auto& array = m_arrays[i];
+			if (!array.array)
+			{
+				unused = unused == -1 ? (int)i : unused;
+				continue;
+			}
+
+			if (array.array->GetWidth() != width || array.array->GetHeight() != height || array.array->GetMipCount() != mips || array.array->GetFormat() != format)
+				continue;
+
+			match = (int)i;
+			for (const auto& slice : array.slices)
+			{
+				if (slice.expired())
+					return match;
+			}
+		}
+
+		// A new array, or one twice as large that the full one is copied into
+		unsigned int sliceCount					= match != -1 ? m_arrays[match].array->GetSliceCount() * 2 : MATERIAL_TEXTURES_SLICES_MIN;
+		unsigned long long bytesReplaced		= match != -1 ? m_arrays[match].array->GetBytes() : 0;
+		auto created							= make_unique<RHI_TextureArray>(m_rhiDevice);
+		if (!created->Create(width, height, mips, format, sliceCount))
+			return -1;
+
+		if (m_bytes - bytesReplaced + created->GetBytes() > MATERIAL_TEXTURES_BUDGET)
+			return -1;
+
+		if (match != -1)
+		{
+			if (!created->Slices_Copy(m_arrays[match].array.get()))
+				return -1;
+
+			m_bytes -= bytesReplaced;
+			m_bytes += created->GetBytes();
+			m_arrays[match].array = move(created);
+			m_arrays[match].slices.resize(sliceCount);
+			return match;
+		}
+
+		int index = unused != -1 ? unused : (int)m_arrays.size();
+		if (index == (int)m_arrays.size())
+		{
+			m_arrays.emplace_back();
+		}
+		m_bytes += created->GetBytes();
+		m_arrays[index].array = move(created);
+		m_arrays[index].slices.resize(sliceCount);
+		return index;
+	}
+}
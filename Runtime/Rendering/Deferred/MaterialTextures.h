@@ -0,0 +1,83 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "../../RHI/RHI_Definition.h"
+#include "../Material.h"
+//===============================
+
+// Slices an array starts with, it doubles whenever it runs out
+#define MATERIAL_TEXTURES_SLICES_MIN	8
+// Bytes all the arrays together may take, the textures that don't fit are bound one by one
+#define MATERIAL_TEXTURES_BUDGET		(512ULL * 1024 * 1024)
+
+namespace Directus
+{
+	// Copies of the opaque materials' textures in arrays, one per size, format and mip count. The G-Buffer
+	// binds the arrays and the materials pick their slices out of them, so draws of different materials
+	// whose textures share arrays rebind no textures. A texture streaming replaced the mips of is copied
+	// again, into the array of its new size.
+	class MaterialTextures
+	{
+	public:
+		MaterialTextures(std::shared_ptr<RHI_Device> rhiDevice);
+		~MaterialTextures();
+
+		// Frees the slices of textures that are gone, before any Material_Add
+		void Update();
+		// Copies in the material's textures that aren't in an array yet, before any command list samples them
+		void Material_Add(Material* material);
+		// The arrays and slices of the material's textures (MATERIAL_GBUFFER_TEXTURES of each), false if one of them
+		// isn't in an array. Only reads, so command lists can call it while they record.
+		bool Material_Get(Material* material, void** arrays, unsigned int* slices) const;
+		// Releases all the arrays
+		void Clear();
+		unsigned long long GetBytes() const { return m_bytes; }
+
+	private:
+		bool Texture_Add(const std::shared_ptr<RHI_Texture>& texture);
+		// An array of the texture's size, format and mip count with a free slice, -1 if there can't be one
+		int Array_Find(RHI_Texture* texture);
+
+		struct Array
+		{
+			std::unique_ptr<RHI_TextureArray> array; // empty once all of its textures are gone, the index gets reused
+			std::vector<std::weak_ptr<RHI_Texture>> slices;
+		};
+
+		struct Entry
+		{
+			unsigned int array;
+			unsigned int slice;
+			void* shaderResource; // the one it was copied from, streaming replaces it
+		};
+
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		std::vector<Array> m_arrays;
+		std::unordered_map<const RHI_Texture*, Entry> m_textures;
+		unsigned long long m_bytes = 0;
+	};
+}
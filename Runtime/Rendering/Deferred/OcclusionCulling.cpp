@@ -0,0 +1,206 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "OcclusionCulling.h"
+#include <cfloat>
+#include "../../RHI/RHI_RenderTexture.h"
+#include "../../Math/BoundingBox.h"
+#include "../../Math/MathHelper.h"
+#include "../../Math/Vector2.h"
+//======================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace Directus
+{
+	OcclusionCulling::OcclusionCulling(shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+	}
+
+	void OcclusionCulling::Resize(unsigned int width, unsigned int height)
+	{
+		m_levels.clear();
+		m_requestCount	= 0;
+		m_valid			= false;
+		for (auto& request : m_requests)
+		{
+			request.id = 0;
+		}
+
+		// Halve (rounding up) until a level is small enough to be read back every frame, and there are enough of them
+		m_readbackLevel = 0;
+		bool readback	= false;
+		do
+		{
+			width	= Max((width + 1) / 2, 1u);
+			height	= Max((height + 1) / 2, 1u);
+			m_levels.emplace_back(make_shared<RHI_RenderTexture>(m_rhiDevice, width, height, Texture_Format_R32G32_FLOAT));
+			if (!readback && width <= OCCLUSION_READBACK_WIDTH_MAX)
+			{
+				m_readbackLevel	= (unsigned int)m_levels.size() - 1;
+				readback		= true;
+			}
+		} while (!readback || (m_levels.size() < OCCLUSION_LEVELS_MIN && (width > 1 || height > 1)));
+	}
+
+	void OcclusionCulling::Readback_Request(const Matrix& viewProjection, float farPlane)
+	{
+		if (m_levels.empty() || !m_levels[m_readbackLevel]->Readback_Request())
+			return;
+
+		// The RHI numbers it's requests the same way
+		auto& request			= m_requests[++m_requestCount % OCCLUSION_REQUESTS_MAX];
+		request.id				= m_requestCount;
+		request.viewProjection	= viewProjection;
+		request.farPlane		= farPlane;
+	}
+
+	void OcclusionCulling::Readback_Update()
+	{
+		if (m_levels.empty())
+			return;
+
+		unsigned int id = 0;
+		if (!m_levels[m_readbackLevel]->Readback_Get(m_readback, &id))
+			return;
+
+		const auto& request = m_requests[id % OCCLUSION_REQUESTS_MAX];
+		if (request.id != id)
+			return;
+
+		// The first CPU level is the one read back, only the farthest depth of it
+		auto width	= m_levels[m_readbackLevel]->GetWidth();
+		auto height	= m_levels[m_readbackLevel]->GetHeight();
+		m_pyramid.resize(1);
+		m_pyramid[0].width	= width;
+		m_pyramid[0].height	= height;
+		m_pyramid[0].depth.resize(width * height);
+		auto texels = (const float*)m_readback.data();
+		for (unsigned int i = 0; i < width * height; i++)
+		{
+			m_pyramid[0].depth[i] = texels[i * 2];
+		}
+
+		// Complete the pyramid down to a single texel, the same way PostProcess.hlsl does it
+		while (width > 1 || height > 1)
+		{
+			const Level& source = m_pyramid.back();
+			Level level;
+			level.width		= (width + 1) / 2;
+			level.height	= (height + 1) / 2;
+			level.depth.resize(level.width * level.height);
+
+			unsigned int extraX = width & 1;
+			unsigned int extraY = height & 1;
+			for (unsigned int y = 0; y < level.height; y++)
+			{
+				for (unsigned int x = 0; x < level.width; x++)
+				{
+					float depthMax = 0.0f;
+					for (unsigned int j = 0; j <= 1 + extraY; j++)
+					{
+						for (unsigned int i = 0; i <= 1 + extraX; i++)
+						{
+							unsigned int sx = Min(x * 2 + i, width - 1);
+							unsigned int sy = Min(y * 2 + j, height - 1);
+							depthMax = Max(depthMax, source.depth[sy * width + sx]);
+						}
+					}
+					level.depth[y * level.width + x] = depthMax;
+				}
+			}
+
+			width	= level.width;
+			height	= level.height;
+			m_pyramid.emplace_back(move(level));
+		}
+
+		m_viewProjection	= request.viewProjection;
+		m_farPlane			= request.farPlane;
+		m_valid				= true;
+	}
+
+	bool OcclusionCulling::IsOccluded(const BoundingBox& box) const
+	{
+		if (!m_valid || m_farPlane <= 0.0f)
+			return false;
+
+		// Project the corners with the view projection the depth was rendered with
+		const Vector3& boxMin = box.GetMin();
+		const Vector3& boxMax = box.GetMax();
+		const Matrix& m		= m_viewProjection;
+		Vector2 uvMin		= Vector2(FLT_MAX, FLT_MAX);
+		Vector2 uvMax		= Vector2(-FLT_MAX, -FLT_MAX);
+		float depthMin		= FLT_MAX;
+		for (unsigned int i = 0; i < 8; i++)
+		{
+			Vector3 corner = Vector3((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+			float x = corner.x * m.m00 + corner.y * m.m10 + corner.z * m.m20 + m.m30;
+			float y = corner.x * m.m01 + corner.y * m.m11 + corner.z * m.m21 + m.m31;
+			float w = corner.x * m.m03 + corner.y * m.m13 + corner.z * m.m23 + m.m33;
+
+			// Boxes that reach behind the camera can't be bounded on screen
+			if (w <= M_EPSILON)
+				return false;
+
+			Vector2 uv	= Vector2(x / w * 0.5f + 0.5f, -y / w * 0.5f + 0.5f);
+			uvMin		= Vector2(Min(uvMin.x, uv.x), Min(uvMin.y, uv.y));
+			uvMax		= Vector2(Max(uvMax.x, uv.x), Max(uvMax.y, uv.y));
+			depthMin	= Min(depthMin, w / m_farPlane); // linear depth, like the G-Buffer
+		}
+
+		// Off screen, that's for frustum culling to decide
+		if (uvMax.x < 0.0f || uvMax.y < 0.0f || uvMin.x > 1.0f || uvMin.y > 1.0f)
+			return false;
+
+		// The texel range on the first level
+		const Level& first	= m_pyramid.front();
+		unsigned int x0		= Min((unsigned int)(Max(uvMin.x, 0.0f) * first.width), first.width - 1);
+		unsigned int x1		= Min((unsigned int)(Min(uvMax.x, 1.0f) * first.width), first.width - 1);
+		unsigned int y0		= Min((unsigned int)(Max(uvMin.y, 0.0f) * first.height), first.height - 1);
+		unsigned int y1		= Min((unsigned int)(Min(uvMax.y, 1.0f) * first.height), first.height - 1);
+
+		// Pick the finest level where that range spans at most 2x2 texels (a level's texel covers it's parent texels at index >> 1)
+		unsigned int levelIndex = 0;
+		while (levelIndex + 1 < (unsigned int)m_pyramid.size() && ((x1 >> levelIndex) - (x0 >> levelIndex) > 1 || (y1 >> levelIndex) - (y0 >> levelIndex) > 1))
+		{
+			levelIndex++;
+		}
+
+		const Level& level	= m_pyramid[levelIndex];
+		float depthMax		= 0.0f;
+		for (unsigned int y = y0 >> levelIndex; y <= Min(y1 >> levelIndex, level.height - 1); y++)
+		{
+			for (unsigned int x = x0 >> levelIndex; x <= Min(x1 >> levelIndex, level.width - 1); x++)
+			{
+				depthMax = Max(depthMax, level.depth[y * level.width + x]);
+			}
+		}
+
+		return depthMin > depthMax;
+	}
+}
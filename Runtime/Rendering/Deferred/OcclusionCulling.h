@@ -0,0 +1,86 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Matrix.h"
+//===============================
+
+#define OCCLUSION_READBACK_WIDTH_MAX	256	// the first level that's at most this wide is read back
+#define OCCLUSION_LEVELS_MIN			8	// the GPU pyramid goes on past the readback until it has this many, screen space reflections step over the coarse ones
+#define OCCLUSION_REQUESTS_MAX			8	// must exceed the number of readbacks the RHI keeps in flight
+
+namespace Directus
+{
+	namespace Math { class BoundingBox; }
+
+	// Hierarchical-Z occlusion culling against the depth of a previous frame. The GPU reduces the
+	// G-Buffer depth into a pyramid of the farthest (r) and closest (g) depth, a coarse level is read
+	// back a few frames late and the pyramid is completed on the CPU, where bounding boxes get tested
+	// before they are drawn. Screen space reflections trace against the closest depth of this frame's.
+	class OcclusionCulling
+	{
+	public:
+		OcclusionCulling(std::shared_ptr<RHI_Device> rhiDevice);
+		~OcclusionCulling() {}
+
+		// Creates the GPU pyramid for a given resolution, previous results are discarded
+		void Resize(unsigned int width, unsigned int height);
+		// Each level is half the size of the previous one, the first one is half the G-Buffer size
+		const std::vector<std::shared_ptr<RHI_RenderTexture>>& GetLevels() { return m_levels; }
+		// Queues the coarsest GPU level for readback, along with what the depth was rendered with
+		void Readback_Request(const Math::Matrix& viewProjection, float farPlane);
+		// Picks up the latest finished readback (if any) and rebuilds the CPU pyramid from it
+		void Readback_Update();
+		// Returns true if the box is entirely behind the depth of the frame the CPU pyramid comes from
+		bool IsOccluded(const Math::BoundingBox& box) const;
+
+	private:
+		struct Level
+		{
+			unsigned int width	= 0;
+			unsigned int height	= 0;
+			std::vector<float> depth;
+		};
+
+		struct Request
+		{
+			unsigned int id = 0;
+			Math::Matrix viewProjection;
+			float farPlane	= 0.0f;
+		};
+
+		std::vector<std::shared_ptr<RHI_RenderTexture>> m_levels;
+		unsigned int m_readbackLevel = 0;
+		std::vector<Level> m_pyramid;
+		std::vector<unsigned char> m_readback;
+		Request m_requests[OCCLUSION_REQUESTS_MAX];
+		unsigned int m_requestCount = 0;
+		Math::Matrix m_viewProjection;
+		float m_farPlane	= 0.0f;
+		bool m_valid		= false;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
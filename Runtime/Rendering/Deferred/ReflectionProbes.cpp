@@ -0,0 +1,443 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "ReflectionProbes.h"
+#include <algorithm>
+#include <cmath>
+#include "ShadowAtlas.h"
+#include "../ImageBasedLighting.h"
+#include "../../Core/Context.h"
+#include "../../Threading/Threading.h"
+#include "../../Resource/ResourceManager.h"
+#include "../../World/Actor.h"
+#include "../../World/Components/Transform.h"
+#include "../../RHI/RHI_RenderTexture.h"
+#include "../../RHI/RHI_StructuredBuffer.h"
+#include "../../RHI/RHI_TextureArray.h"
+#include "../../RHI/RHI_Texture.h"
+#include "../../Math/MathHelper.h"
+#include "../../Math/Vector4.h"
+#include "../../Math/Packing.h"
+#include "../../Logging/Log.h"
+//==============================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace _ReflectionProbes
+{
+	// Must match Light.hlsl
+	struct ProbeData
+	{
+		Directus::Math::Vector4 position;	// xyz: where it was captured, w: slice
+		Directus::Math::Vector4 boxMin;		// w: mips
+		Directus::Math::Vector4 boxMax;
+	};
+
+	static const unsigned int facesAll = (1 << 6) - 1;
+
+	// Cubemap face order, the ups keep the render's right then down along the face's u then v
+	static const Directus::Math::Vector3 faceDirections[6]	= { Directus::Math::Vector3::Right, Directus::Math::Vector3::Left, Directus::Math::Vector3::Up, Directus::Math::Vector3::Down, Directus::Math::Vector3::Forward, Directus::Math::Vector3::Back };
+	static const Directus::Math::Vector3 faceUps[6]			= { Directus::Math::Vector3::Up, Directus::Math::Vector3::Up, Directus::Math::Vector3::Back, Directus::Math::Vector3::Forward, Directus::Math::Vector3::Up, Directus::Math::Vector3::Up };
+
+	inline float Volume(const Directus::Math::BoundingBox& box)
+	{
+		Directus::Math::Vector3 size = box.GetMax() - box.GetMin();
+		return size.x * size.y * size.z;
+	}
+}
+
+namespace Directus
+{
+	ReflectionProbes::ReflectionProbes(Context* context, shared_ptr<RHI_Device> rhiDevice)
+	{
+		m_context	= context;
+		m_rhiDevice	= rhiDevice;
+		m_slices.resize(REFLECTION_PROBES_MAX, false);
+
+		// Same layout as the prefiltered cubemaps, so a finished one is a copy away from being sampled
+		m_array = make_unique<RHI_TextureArray>(rhiDevice);
+		if (!m_array->Create(REFLECTION_PROBE_SIZE, REFLECTION_PROBE_SIZE, REFLECTION_PROBE_MIPS, Texture_Format_R8G8B8A8_UNORM, REFLECTION_PROBES_MAX, true))
+		{
+			LOG_ERROR("ReflectionProbes::ReflectionProbes: Failed to create the cubemap array");
+		}
+		m_captureTexture = make_shared<RHI_RenderTexture>(rhiDevice, REFLECTION_PROBE_SIZE, REFLECTION_PROBE_SIZE, Texture_Format_R16G16B16A16_FLOAT);
+	}
+
+	ReflectionProbes::~ReflectionProbes()
+	{
+		m_faces.clear();
+		m_order.clear();
+		m_probes.clear();
+	}
+
+	ReflectionProbes::Capture ReflectionProbes::Update(const vector<shared_ptr<Actor>>& actors)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_updateCount++;
+
+		// What static probes see, static geometry that moves (or comes and goes) changes it
+		uint64_t staticHash = 0;
+		for (const auto& actor : actors)
+		{
+			if (!actor->IsActive() || !actor->IsStatic() || !actor->GetRenderable_PtrRaw())
+				continue;
+
+			staticHash += (((uint64_t)(uintptr_t)actor.get() ^ 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull) ^ ShadowAtlas::Hash(actor->GetTransform_PtrRaw()->GetWorldTransform());
+		}
+
+		for (const auto& probe : m_order)
+		{
+			probe->seen = false;
+		}
+
+		for (const auto& actor : actors)
+		{
+			auto component = actor->IsActive() ? actor->GetComponent_PtrRaw<ReflectionProbe>() : nullptr;
+			if (!component)
+				continue;
+
+			Vector3 position				= actor->GetTransform_PtrRaw()->GetPosition();
+			unsigned int captureRequests	= component->GetCaptureRequests();
+			auto& probe						= m_probes[component->GetID()];
+			if (!probe)
+			{
+				// Beyond the array's slices, it reflects the skybox
+				auto slice = find(m_slices.begin(), m_slices.end(), false);
+				if (slice == m_slices.end())
+				{
+					m_probes.erase(component->GetID());
+					continue;
+				}
+				*slice = true;
+
+				probe					= make_shared<Probe>();
+				probe->id				= component->GetID();
+				probe->slice			= (unsigned int)(slice - m_slices.begin());
+				probe->update			= component->GetUpdate();
+				probe->faces.resize(6);
+				m_order.emplace_back(probe);
+
+				// A static one was likely cached the last time the world was saved, only then it gets captured
+				Capture_Begin(*probe, position, staticHash, captureRequests);
+				if (probe->update == ReflectionProbe_Static)
+				{
+					probe->facesPending = 0;
+					Prefilter(probe, true);
+				}
+			}
+
+			probe->seen		= true;
+			probe->update	= component->GetUpdate();
+			BoundingBox box = component->GetBox();
+			if (box.GetMin() != probe->box.GetMin() || box.GetMax() != probe->box.GetMax())
+			{
+				probe->box		= box;
+				m_uploadDirty	= true;
+			}
+
+			bool captured	= !probe->facesPending && !probe->facesInFlight && !probe->facesReceived && probe->state == State_Idle;
+			bool outdated	= probe->update == ReflectionProbe_Realtime ? captured : (position != probe->position || staticHash != probe->staticHash);
+			if (probe->state == State_Failed)
+			{
+				probe->state	= State_Idle;
+				outdated		= true;
+			}
+			if (outdated || captureRequests != probe->captureRequests)
+			{
+				Capture_Begin(*probe, position, staticHash, captureRequests);
+			}
+		}
+
+		// Removed ones give their slice back, their faces in flight are dropped once they arrive
+		for (unsigned int i = 0; i < (unsigned int)m_order.size();)
+		{
+			auto& probe = m_order[i];
+			if (probe->seen)
+			{
+				i++;
+				continue;
+			}
+
+			m_slices[probe->slice] = false;
+			m_probes.erase(probe->id);
+			m_order.erase(m_order.begin() + i);
+			m_uploadDirty = true;
+		}
+
+		// One probe at a time, so the first ones are done after six frames instead of all of them after many more
+		Capture capture;
+		for (unsigned int i = 0; i < (unsigned int)m_order.size(); i++)
+		{
+			unsigned int index	= (m_cursor + i) % (unsigned int)m_order.size();
+			auto& probe			= m_order[index];
+			if (!probe->facesPending)
+				continue;
+
+			unsigned int face = 0;
+			while (!(probe->facesPending & (1 << face))) { face++; }
+			probe->facesPending		&= ~(1 << face);
+			probe->facesInFlight	|= 1 << face;
+			m_faces.emplace_back(FaceInFlight{ probe, face, probe->captureGeneration, ++m_ticket, m_updateCount, 0 });
+
+			capture.ticket		= m_ticket;
+			capture.position	= probe->position;
+			capture.face		= face;
+			m_cursor			= probe->facesPending ? index : index + 1;
+			break;
+		}
+
+		Capturing_Update();
+		return capture;
+	}
+
+	Matrix ReflectionProbes::GetFaceView(const Vector3& position, unsigned int face)
+	{
+		return Matrix::CreateLookAtLH(position, position + _ReflectionProbes::faceDirections[face % 6], _ReflectionProbes::faceUps[face % 6]);
+	}
+
+	const shared_ptr<RHI_RenderTexture>& ReflectionProbes::GetFaceTexture(unsigned int width, unsigned int height)
+	{
+		if (!m_faceTexture || m_faceTexture->GetWidth() != width || m_faceTexture->GetHeight() != height)
+		{
+			m_faceTexture = make_shared<RHI_RenderTexture>(m_rhiDevice, width, height, Texture_Format_R16G16B16A16_FLOAT);
+		}
+
+		return m_faceTexture;
+	}
+
+	void ReflectionProbes::Capture_Readback(unsigned int ticket)
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		for (auto& face : m_faces)
+		{
+			if (face.ticket != ticket)
+				continue;
+
+			// A failed request leaves the face to the timeout
+			m_captureTexture->Readback_Request(0, 0, 0, 0, &face.request);
+			return;
+		}
+	}
+
+	void ReflectionProbes::Collect()
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		// Only the latest finished readback is reported, whatever was requested before it is lost
+		unsigned int request = 0;
+		bool received = !m_faces.empty() && m_captureTexture->Readback_Get(m_readback, &request);
+		for (unsigned int i = 0; i < (unsigned int)m_faces.size();)
+		{
+			auto& face		= m_faces[i];
+			bool rendered	= face.request != 0;
+			if (received && rendered && face.request == request)
+			{
+				Face_Receive(face);
+			}
+			else if ((received && rendered && face.request < request) || m_updateCount - face.update > REFLECTION_PROBE_FACE_TIMEOUT)
+			{
+				// Never rendered (the frame got resized) or never read back
+				Face_Lost(face);
+			}
+			else
+			{
+				i++;
+				continue;
+			}
+			m_faces.erase(m_faces.begin() + i);
+		}
+
+		for (const auto& probe : m_order)
+		{
+			// All six faces are in
+			if (probe->facesReceived == _ReflectionProbes::facesAll && probe->state == State_Idle)
+			{
+				Prefilter(probe, false);
+			}
+
+			// The previous capture stays in the slice until the new one is prefiltered
+			if (probe->state == State_Prefiltered)
+			{
+				if (m_array->Slice_Copy(probe->slice, probe->ibl->GetSpecularTexture().get()))
+				{
+					probe->ready			= true;
+					probe->positionReady	= probe->position;
+					m_uploadDirty			= true;
+				}
+				probe->ibl.reset();
+				probe->state = State_Idle;
+			}
+		}
+
+		Upload();
+		Capturing_Update();
+	}
+
+	void* ReflectionProbes::GetArray()
+	{
+		return m_array ? m_array->GetShaderResource() : nullptr;
+	}
+
+	void ReflectionProbes::Capture_Begin(Probe& probe, const Vector3& position, uint64_t staticHash, unsigned int captureRequests)
+	{
+		// Faces of the previous capture that are still in flight get ignored when they arrive
+		probe.captureGeneration++;
+		probe.position			= position;
+		probe.staticHash		= staticHash;
+		probe.captureRequests	= captureRequests;
+		probe.facesPending		= _ReflectionProbes::facesAll;
+		probe.facesInFlight		= 0;
+		probe.facesReceived		= 0;
+	}
+
+	void ReflectionProbes::Face_Receive(FaceInFlight& face)
+	{
+		auto& probe = *face.probe;
+		if (face.generation != probe.captureGeneration)
+			return;
+
+		// Half floats to what the prefilter takes, gamma encoded 8-bit. Brighter than white gets clamped.
+		unsigned int texels = REFLECTION_PROBE_SIZE * REFLECTION_PROBE_SIZE;
+		if (m_readback.size() < texels * 4 * sizeof(uint16_t))
+		{
+			Face_Lost(face);
+			return;
+		}
+
+		auto& data = probe.faces[face.face];
+		data.resize(texels * 4);
+		const uint16_t* halves = (const uint16_t*)m_readback.data();
+		float color[4];
+		for (unsigned int i = 0; i < texels; i++)
+		{
+			Packing::HalfToFloat(&halves[i * 4], color, 4);
+			for (unsigned int channel = 0; channel < 3; channel++)
+			{
+				data[i * 4 + channel] = (std::byte)(unsigned char)(powf(Clamp(color[channel], 0.0f, 1.0f), 1.0f / 2.2f) * 255.0f + 0.5f);
+			}
+			data[i * 4 + 3] = (std::byte)255;
+		}
+
+		probe.facesInFlight &= ~(1 << face.face);
+		probe.facesReceived |= 1 << face.face;
+	}
+
+	void ReflectionProbes::Face_Lost(FaceInFlight& face)
+	{
+		auto& probe = *face.probe;
+		if (face.generation != probe.captureGeneration)
+			return;
+
+		probe.facesInFlight &= ~(1 << face.face);
+		probe.facesPending	|= 1 << face.face;
+	}
+
+	void ReflectionProbes::Prefilter(const shared_ptr<Probe>& probe, bool fromCache)
+	{
+		// The faces move to the task, the next capture fills new ones
+		vector<vector<std::byte>> faces;
+		if (!fromCache)
+		{
+			faces.swap(probe->faces);
+			probe->faces.resize(6);
+			probe->facesReceived = 0;
+		}
+
+		string filePath		= probe->update == ReflectionProbe_Static ? GetCacheFilePath(probe->id) : "";
+		Context* context	= m_context;
+		probe->state		= State_Prefiltering;
+		m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [probe, faces, filePath, context, fromCache]()
+		{
+			auto ibl	= make_unique<ImageBasedLighting>(context);
+			bool done	= fromCache ? (!filePath.empty() && ibl->Load(filePath, REFLECTION_PROBE_SIZE)) : ibl->Generate(faces, REFLECTION_PROBE_SIZE, filePath, false);
+			if (done && ibl->GetSpecularMipCount() == REFLECTION_PROBE_MIPS)
+			{
+				probe->ibl		= move(ibl);
+				probe->state	= State_Prefiltered;
+				return;
+			}
+
+			probe->state = fromCache ? State_Failed : State_Idle;
+		});
+	}
+
+	void ReflectionProbes::Upload()
+	{
+		if (!m_uploadDirty)
+			return;
+		m_uploadDirty = false;
+
+		// Largest first, the light pass blends the smaller (nested) ones over them
+		vector<const Probe*> ready;
+		for (const auto& probe : m_order)
+		{
+			if (probe->ready)
+			{
+				ready.emplace_back(probe.get());
+			}
+		}
+		sort(ready.begin(), ready.end(), [](const Probe* a, const Probe* b) { return _ReflectionProbes::Volume(a->box) > _ReflectionProbes::Volume(b->box); });
+
+		m_buffer.reset();
+		if (ready.empty())
+			return;
+
+		vector<_ReflectionProbes::ProbeData> data;
+		data.reserve(ready.size());
+		for (const auto probe : ready)
+		{
+			data.emplace_back(_ReflectionProbes::ProbeData
+			{
+				Vector4(probe->positionReady.x, probe->positionReady.y, probe->positionReady.z, (float)probe->slice),
+				Vector4(probe->box.GetMin().x, probe->box.GetMin().y, probe->box.GetMin().z, (float)REFLECTION_PROBE_MIPS),
+				Vector4(probe->box.GetMax().x, probe->box.GetMax().y, probe->box.GetMax().z, 0.0f)
+			});
+		}
+
+		m_buffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+		if (!m_buffer->Create(sizeof(_ReflectionProbes::ProbeData), (unsigned int)data.size(), data.data()))
+		{
+			LOG_ERROR("ReflectionProbes::Upload: Failed to create the probe buffer");
+			m_buffer.reset();
+		}
+	}
+
+	void ReflectionProbes::Capturing_Update()
+	{
+		bool capturing = false;
+		for (const auto& probe : m_order)
+		{
+			capturing = capturing || probe->facesPending || probe->facesInFlight || probe->facesReceived || probe->state != State_Idle;
+		}
+		m_capturing = capturing;
+	}
+
+	string ReflectionProbes::GetCacheFilePath(unsigned int id)
+	{
+		return m_context->GetSubsystem<ResourceManager>()->GetProjectDirectory() + "ReflectionProbe_" + to_string(id) + ".ibl";
+	}
+}
@@ -0,0 +1,158 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========================================
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Vector3.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/BoundingBox.h"
+#include "../../World/Components/ReflectionProbe.h"
+//=====================================================
+
+#define REFLECTION_PROBES_MAX			16	// slices of the cubemap array, probes beyond them aren't captured
+#define REFLECTION_PROBE_SIZE			128	// texels per side of a face, at most IBL_SPECULAR_SIZE
+#define REFLECTION_PROBE_MIPS			8	// log2(REFLECTION_PROBE_SIZE) + 1, prefiltered for roughness like the skybox's
+#define REFLECTION_PROBE_FACE_TIMEOUT	16	// updates a rendered face waits for it's readback before it's rendered again
+
+namespace Directus
+{
+	class Actor;
+	class Context;
+	class ImageBasedLighting;
+
+	// The cubemaps of the reflection probes, slices of one cubemap array. A face of one probe is rendered per frame (as a view
+	// of the renderer), downsampled and read back. Once all six are in, a background thread prefilters them (see ImageBasedLighting)
+	// and the result is copied into the probe's slice, which keeps the previous capture until then. Static probes are cached on
+	// disk by their component's ID, loading a world doesn't capture them again.
+	class ReflectionProbes
+	{
+	public:
+		ReflectionProbes(Context* context, std::shared_ptr<RHI_Device> rhiDevice);
+		~ReflectionProbes();
+
+		// A face to render, none when the ticket is 0
+		struct Capture
+		{
+			unsigned int ticket		= 0;
+			Math::Vector3 position;
+			unsigned int face		= 0; // in cubemap face order
+		};
+
+		// Finds the probes among the actors, and whether the static ones are up to date, then picks the next face to render
+		Capture Update(const std::vector<std::shared_ptr<Actor>>& actors);
+		// Looking along the face from the position, with the up vector that lines the render up with the cubemap's face
+		static Math::Matrix GetFaceView(const Math::Vector3& position, unsigned int face);
+		// Renders are the size of the frame, a face gets downsampled into the capture texture before it's read back
+		const std::shared_ptr<RHI_RenderTexture>& GetFaceTexture(unsigned int width, unsigned int height);
+		const std::shared_ptr<RHI_RenderTexture>& GetCaptureTexture() { return m_captureTexture; }
+		// Call once the face of the ticket is in the capture texture
+		void Capture_Readback(unsigned int ticket);
+		// Collects the faces the GPU read back and copies prefiltered cubemaps into the array, then uploads
+		// what the light pass samples. Once per frame, before rendering.
+		void Collect();
+		// Whether faces are still to be rendered (or prefiltered), the frame can't be skipped
+		bool IsCapturing() { return m_capturing; }
+
+		void* GetArray();
+		unsigned int GetMipCount() { return REFLECTION_PROBE_MIPS; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetBuffer() { return m_buffer; }
+
+	private:
+		enum State
+		{
+			State_Idle,
+			State_Prefiltering,	// on a background thread
+			State_Prefiltered,	// waits to be copied into the array
+			State_Failed		// loading the cache failed, it has to be captured
+		};
+
+		struct Probe
+		{
+			unsigned int id					= 0;	// the component's
+			unsigned int slice				= 0;
+			ReflectionProbe_Update update	= ReflectionProbe_Static;
+			Math::BoundingBox box;
+			bool seen						= false;
+
+			// The capture in progress, or the last one
+			Math::Vector3 position;
+			uint64_t staticHash				= 0;
+			unsigned int captureRequests	= 0;
+			unsigned int captureGeneration	= 0;	// readbacks of an earlier capture are ignored
+			unsigned int facesPending		= 0;	// to render, a bit per face
+			unsigned int facesInFlight		= 0;
+			unsigned int facesReceived		= 0;
+			std::vector<std::vector<std::byte>> faces;
+
+			std::atomic<int> state			= State_Idle;
+			std::unique_ptr<ImageBasedLighting> ibl;
+
+			// What the slice holds
+			bool ready						= false;
+			Math::Vector3 positionReady;
+		};
+
+		struct FaceInFlight
+		{
+			std::shared_ptr<Probe> probe;
+			unsigned int face;
+			unsigned int generation;
+			unsigned int ticket;
+			unsigned int update;	// the one that picked it
+			unsigned int request;	// the readback's, 0 until the face was rendered
+		};
+
+		void Capture_Begin(Probe& probe, const Math::Vector3& position, uint64_t staticHash, unsigned int captureRequests);
+		void Face_Receive(FaceInFlight& face);
+		void Face_Lost(FaceInFlight& face);
+		void Prefilter(const std::shared_ptr<Probe>& probe, bool fromCache);
+		void Upload();
+		void Capturing_Update();
+		std::string GetCacheFilePath(unsigned int id);
+
+		std::unordered_map<unsigned int, std::shared_ptr<Probe>> m_probes;
+		std::vector<std::shared_ptr<Probe>> m_order;	// round-robin for the faces
+		unsigned int m_cursor					= 0;
+		std::vector<bool> m_slices;						// in use
+		std::vector<FaceInFlight> m_faces;
+		unsigned int m_ticket					= 0;
+		unsigned int m_updateCount				= 0;
+		std::atomic<bool> m_capturing			= false;
+		bool m_uploadDirty						= true;
+		std::vector<unsigned char> m_readback;
+		std::mutex m_mutex;								// updated when the World is captured, collected when rendering
+
+		std::unique_ptr<RHI_TextureArray> m_array;
+		std::shared_ptr<RHI_RenderTexture> m_faceTexture;
+		std::shared_ptr<RHI_RenderTexture> m_captureTexture;
+		std::shared_ptr<RHI_StructuredBuffer> m_buffer;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+		Context* m_context;
+	};
+}
@@ -22,13 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ================================
 #include "ShaderVariation.h"
 #include "../Renderer.h"
-#include "../Material.h"
 #include "../../RHI/RHI_Implementation.h"
 #include "../../RHI/RHI_Shader.h"
 #include "../../RHI/RHI_ConstantBuffer.h"
-#include "../../World/Components/Transform.h"
-#include "../../World/Components/Camera.h"
-#include "../../Core/Settings.h"
+#include "../../RHI/RHI_Device.h"
 //===========================================
 
 //= NAMESPACES ================
@@ -43,94 +40,75 @@ namespace Directus
 		m_shaderFlags = 0;
 	}
 
-	void ShaderVariation::Compile(const string& filePath, unsigned long shaderFlags)
+	void ShaderVariation::Compile(const string& filePath, unsigned long shaderFlags, bool async /*= true*/)
 	{
 		m_shaderFlags = shaderFlags;
 
-		// Load and compile the vertex and the pixel shader
-		AddDefinesBasedOnMaterial();
-		Compile_VertexPixel_Async(filePath, Input_PositionTextureTBN, m_context);
-
-		// The buffers below have to match GBuffer.hlsl
-
-		// Material Buffer
-		m_materialBuffer = make_shared<RHI_ConstantBuffer>(m_rhiDevice);
-		m_materialBuffer->Create(sizeof(PerMaterialBufferType), 0, Buffer_PixelShader);
+		// The buffer below has to match GBuffer.hlsl, it's created first as the renderer
+		// may use it as soon as the shader reports it's built (materials keep their own, see Material::UpdateConstantBuffer)
 
 		// Object Buffer
 		m_perObjectBuffer = make_shared<RHI_ConstantBuffer>(m_rhiDevice);
 		m_perObjectBuffer->Create(sizeof(PerObjectBufferType), 1, Buffer_VertexShader);
-	}
 
-	void ShaderVariation::UpdatePerMaterialBuffer(Camera* camera, Material* material)
-	{
-		if (!camera || !material)
+		// Load and compile the vertex and the pixel shader
+		AddDefinesBasedOnMaterial();
+		if (!async)
 		{
-			LOG_ERROR("ShaderVariation::UpdatePerMaterialBuffer: Invalid parameters.");
+			Compile_VertexPixel(filePath, Input_PositionTextureTBNPacked, m_context);
 			return;
 		}
 
-		if (GetState() != Shader_Built)
-			return;
-
-		Vector2 planes = Vector2(camera->GetNearPlane(), camera->GetFarPlane());
-
-		// Determine if the material buffer needs to update
-		bool update = false;
-		update = perMaterialBufferCPU.matAlbedo			!= material->GetColorAlbedo()				? true : update;
-		update = perMaterialBufferCPU.matTilingUV		!= material->GetTiling()					? true : update;
-		update = perMaterialBufferCPU.matOffsetUV		!= material->GetOffset()					? true : update;
-		update = perMaterialBufferCPU.matRoughnessMul	!= material->GetRoughnessMultiplier()		? true : update;
-		update = perMaterialBufferCPU.matMetallicMul	!= material->GetMetallicMultiplier()		? true : update;
-		update = perMaterialBufferCPU.matNormalMul		!= material->GetNormalMultiplier()			? true : update;
-		update = perMaterialBufferCPU.matShadingMode	!= float(material->GetShadingMode())		? true : update;
-		update = perMaterialBufferCPU.cameraPos			!= camera->GetTransform()->GetPosition()	? true : update;
-		update = perMaterialBufferCPU.resolution		!= Settings::Get().Resolution_Get()			? true : update;
-		update = perMaterialBufferCPU.planes			!= planes									? true : update;
+		// Keep the variation alive until the worker is done with it
+		auto self = static_pointer_cast<ShaderVariation>(GetSharedPtr());
+		m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [self, filePath]()
+		{
+			self->Compile_VertexPixel(filePath, Input_PositionTextureTBNPacked, self->m_context);
+		});
+	}
 
-		if (update)
+	bool ShaderVariation::Recompile()
+	{
+		if (GetState() == Shader_Compiling || GetFilePath().empty())
+			return false;
+
+		// The buffers and defines stay, only the source changed
+		string filePath	= GetFilePath();
+		bool vertex		= Compile_Vertex(filePath, Input_PositionTextureTBNPacked);
+		bool pixel		= Compile_Pixel(filePath);
+		if (vertex && pixel)
 		{
-			//= BUFFER UPDATE ======================================================================================
-			auto buffer = (PerMaterialBufferType*)m_materialBuffer->Map();
-
-			buffer->matAlbedo		= perMaterialBufferCPU.matAlbedo		= material->GetColorAlbedo();
-			buffer->matTilingUV		= perMaterialBufferCPU.matTilingUV		= material->GetTiling();
-			buffer->matOffsetUV		= perMaterialBufferCPU.matOffsetUV		= material->GetOffset();
-			buffer->matRoughnessMul = perMaterialBufferCPU.matRoughnessMul	= material->GetRoughnessMultiplier();
-			buffer->matMetallicMul	= perMaterialBufferCPU.matMetallicMul	= material->GetMetallicMultiplier();
-			buffer->matNormalMul	= perMaterialBufferCPU.matNormalMul		= material->GetNormalMultiplier();
-			buffer->matHeightMul	= perMaterialBufferCPU.matNormalMul		= material->GetHeightMultiplier();
-			buffer->matShadingMode	= perMaterialBufferCPU.matShadingMode	= float(material->GetShadingMode());
-			buffer->cameraPos		= perMaterialBufferCPU.cameraPos		= camera->GetTransform()->GetPosition();
-			buffer->resolution		= perMaterialBufferCPU.resolution		= Settings::Get().Resolution_Get();
-			buffer->planes			= perMaterialBufferCPU.planes			= planes;
-			buffer->padding			= perMaterialBufferCPU.padding			= 0.0f;
-			buffer->padding2		= perMaterialBufferCPU.padding2			= Vector3::Zero;
-
-			m_materialBuffer->Unmap();
-			//======================================================================================================
+			LOGF_INFO("ShaderVariation::Recompile: Recompiled %s (flags %lu)", filePath.c_str(), m_shaderFlags);
+			return true;
 		}
+
+		LOGF_ERROR("ShaderVariation::Recompile: Failed to recompile %s (flags %lu)", filePath.c_str(), m_shaderFlags);
+		return false;
 	}
 
-	void ShaderVariation::UpdatePerObjectBuffer(const Matrix& mWorld, const Matrix& mView, const Matrix& mProjection)
+	void ShaderVariation::UpdatePerObjectBuffer(const Matrix& mView, const Matrix& mProjection, const Matrix& mViewProjectionUnjittered, const Matrix& mViewProjectionPrevious)
 	{
 		if (GetState() != Shader_Built)
 			return;
 
+		lock_guard<mutex> lock(m_bufferMutex);
+
 		// Determine if the buffer actually needs to update
-		bool update = false;
-		update = perObjectBufferCPU.mWorld		!= mWorld ? true : update;
+		bool update = m_rhiDevice->CommandList_IsRecording();
 		update = perObjectBufferCPU.mView		!= mView ? true : update;
 		update = perObjectBufferCPU.mProjection	!= mProjection ? true : update;
+		update = perObjectBufferCPU.mViewProjectionUnjittered	!= mViewProjectionUnjittered ? true : update;
+		update = perObjectBufferCPU.mViewProjectionPrevious		!= mViewProjectionPrevious ? true : update;
 
 		if (update)
 		{
 			//= BUFFER UPDATE ================================================================================
 			auto* buffer = (PerObjectBufferType*)m_perObjectBuffer->Map();
 
-			buffer->mWorld		= perObjectBufferCPU.mWorld			= mWorld;
 			buffer->mView		= perObjectBufferCPU.mView			= mView;
 			buffer->mProjection	= perObjectBufferCPU.mProjection	= mProjection;
+			buffer->mViewProjectionUnjittered	= perObjectBufferCPU.mViewProjectionUnjittered	= mViewProjectionUnjittered;
+			buffer->mViewProjectionPrevious		= perObjectBufferCPU.mViewProjectionPrevious	= mViewProjectionPrevious;
 
 			m_perObjectBuffer->Unmap();
 			//================================================================================================
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =========================
 #include <memory>
+#include <mutex>
 #include "../../Resource/IResource.h"
 #include "../../Math/Vector2.h"
 #include "../../Math/Matrix.h"
@@ -55,12 +56,17 @@ namespace Directus
 		ShaderVariation(std::shared_ptr<RHI_Device> device, Context* context);
 		~ShaderVariation(){}
 
-		void Compile(const std::string& filePath, unsigned long shaderFlags);
+		// Compiles on a worker thread unless told otherwise, GetState() reports when it's ready
+		void Compile(const std::string& filePath, unsigned long shaderFlags, bool async = true);
+		// Compiles the same permutation again on the calling thread, it keeps working with what it had if that fails
+		bool Recompile();
 
-		void UpdatePerMaterialBuffer(Camera* camera, Material* material);
-		void UpdatePerObjectBuffer(const Math::Matrix& mWorld, const Math::Matrix& mView, const Math::Matrix& mProjection);
+		// The un-jittered view projections of this and the previous frame go into the velocity
+		void UpdatePerObjectBuffer(const Math::Matrix& mView, const Math::Matrix& mProjection, const Math::Matrix& mViewProjectionUnjittered, const Math::Matrix& mViewProjectionPrevious);
 
 		unsigned long GetShaderFlags()	{ return m_shaderFlags; }
+		// What a variation of the given flags is cached as, so that the cache's name index finds it
+		static std::string GetName(unsigned long shaderFlags) { return "ShaderVariation_" + std::to_string(shaderFlags); }
 		bool HasAlbedoTexture()			{ return m_shaderFlags & Variaton_Albedo; }
 		bool HasRoughnessTexture()		{ return m_shaderFlags & Variaton_Roughness; }
 		bool HasMetallicTexture()		{ return m_shaderFlags & Variaton_Metallic; }
@@ -72,7 +78,6 @@ namespace Directus
 		bool HasCubeMapTexture()		{ return m_shaderFlags & Variaton_Cubemap; }
 
 		std::shared_ptr<RHI_ConstantBuffer>& GetPerObjectBuffer()	{ return m_perObjectBuffer; }
-		std::shared_ptr<RHI_ConstantBuffer>& GetMaterialBuffer()	{ return m_materialBuffer; }
 
 	private:
 		void AddDefinesBasedOnMaterial();
@@ -81,33 +86,16 @@ namespace Directus
 		unsigned long m_shaderFlags;
 
 		// MISC
-		std::shared_ptr<RHI_ConstantBuffer> m_materialBuffer;
 		std::shared_ptr<RHI_ConstantBuffer> m_perObjectBuffer;
+		std::mutex m_bufferMutex;
 
 		// BUFFERS
-		struct PerMaterialBufferType
-		{
-			Math::Vector4 matAlbedo;
-			Math::Vector2 matTilingUV;
-			Math::Vector2 matOffsetUV;
-			float matRoughnessMul;
-			float matMetallicMul;
-			float matNormalMul;
-			float matHeightMul;		
-			Math::Vector3 cameraPos;
-			float padding;
-			Math::Vector2 planes;
-			Math::Vector2 resolution;		
-			float matShadingMode;
-			Math::Vector3 padding2;
-		};
-		PerMaterialBufferType perMaterialBufferCPU;
-
 		struct PerObjectBufferType
 		{
-			Math::Matrix mWorld;
 			Math::Matrix mView;
 			Math::Matrix mProjection;
+			Math::Matrix mViewProjectionUnjittered;
+			Math::Matrix mViewProjectionPrevious;
 		};
 		PerObjectBufferType perObjectBufferCPU;
 	};
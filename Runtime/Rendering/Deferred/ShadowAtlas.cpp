@@ -0,0 +1,380 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "ShadowAtlas.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "../RenderTexturePool.h"
+#include "../../World/Actor.h"
+#include "../../World/Components/Camera.h"
+#include "../../World/Components/Light.h"
+#include "../../World/Components/Transform.h"
+#include "../../RHI/RHI_RenderTexture.h"
+#include "../../RHI/RHI_StructuredBuffer.h"
+#include "../../Math/MathHelper.h"
+#include "../../Math/Vector4.h"
+//==============================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace _ShadowAtlas
+{
+	// Must match Light.hlsl
+	struct TileData
+	{
+		Directus::Math::Matrix viewProjection;
+		Directus::Math::Vector4 rect; // xy: top left texel, z: size in texels, w: 1 for reverse-z
+	};
+
+	// Cube faces in the order the light pass picks them, by the major axis of the direction from the light
+	static const Directus::Math::Vector3 faceDirections[6]	= { Directus::Math::Vector3::Right, Directus::Math::Vector3::Left, Directus::Math::Vector3::Up, Directus::Math::Vector3::Down, Directus::Math::Vector3::Forward, Directus::Math::Vector3::Back };
+	static const Directus::Math::Vector3 faceUps[6]			= { Directus::Math::Vector3::Up, Directus::Math::Vector3::Up, Directus::Math::Vector3::Back, Directus::Math::Vector3::Forward, Directus::Math::Vector3::Up, Directus::Math::Vector3::Up };
+
+	// Every other bit of a Morton code, tiles sorted by size fill the atlas along that curve without overlapping
+	inline unsigned int Compact(unsigned int value)
+	{
+		value &= 0x55555555;
+		value = (value ^ (value >> 1)) & 0x33333333;
+		value = (value ^ (value >> 2)) & 0x0F0F0F0F;
+		value = (value ^ (value >> 4)) & 0x00FF00FF;
+		value = (value ^ (value >> 8)) & 0x0000FFFF;
+		return value;
+	}
+
+	inline unsigned int Cells(unsigned int size, unsigned int faces)
+	{
+		unsigned int side = size / SHADOW_ATLAS_TILE_MIN;
+		return side * side * faces;
+	}
+
+	inline bool Intersects(const Directus::Math::BoundingBox& box, const Directus::Math::Vector3& center, float radius)
+	{
+		const auto& min = box.GetMin();
+		const auto& max = box.GetMax();
+		Directus::Math::Vector3 closest(Clamp(center.x, min.x, max.x), Clamp(center.y, min.y, max.y), Clamp(center.z, min.z, max.z));
+		return (closest - center).LengthSquared() <= radius * radius;
+	}
+
+	inline uint64_t Mix(uint64_t hash, uint64_t value)
+	{
+		return (hash ^ value) * 0x100000001B3ull;
+	}
+
+	inline uint64_t Hash(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+}
+
+namespace Directus
+{
+	ShadowAtlas::ShadowAtlas(shared_ptr<RHI_Device> rhiDevice, shared_ptr<RenderTexturePool> pool)
+	{
+		m_rhiDevice	= rhiDevice;
+		m_pool		= pool;
+
+		m_tileBuffer = make_shared<RHI_StructuredBuffer>(rhiDevice);
+		m_tileBuffer->Create(sizeof(_ShadowAtlas::TileData), SHADOW_ATLAS_TILES_MAX);
+	}
+
+	ShadowAtlas::~ShadowAtlas()
+	{
+		if (m_atlas && m_pool)
+		{
+			m_pool->Release(m_atlas);
+		}
+	}
+
+	void ShadowAtlas::Update(const vector<Actor*>& lights, Camera* camera, bool reverseZ)
+	{
+		m_entries.clear();
+		m_dirty.clear();
+		m_tilesPrevious.swap(m_tiles);
+		m_tiles.clear();
+		m_firstTilesPrevious.swap(m_firstTiles);
+		m_firstTiles.clear();
+		if (!camera)
+			return;
+
+		for (const auto& actor : lights)
+		{
+			auto light = actor->GetComponent_PtrRaw<Light>();
+			if (!light || light->GetLightType() == LightType_Directional || !light->GetCastShadows())
+				continue;
+
+			Entry entry;
+			if (Entry_Create(light, camera, entry))
+			{
+				m_entries.emplace_back(entry);
+			}
+		}
+		stable_sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) { return a.importance > b.importance; });
+
+		Layout();
+		m_sizes.clear();
+		for (const auto& entry : m_entries)
+		{
+			m_sizes[entry.light]		= entry.size;
+			m_firstTiles[entry.light]	= entry.firstTile;
+		}
+
+		if (m_tiles.empty())
+			return;
+
+		// The atlas is only allocated once there is something to put in it, and then kept
+		if (!m_atlas)
+		{
+			m_atlas = m_pool->Acquire(SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE, Texture_Format_R32_FLOAT);
+			m_atlas->SetMemoryCategory(Memory_Shadows);
+		}
+
+		for (auto& entry : m_entries)
+		{
+			Light* light		= entry.light;
+			Vector3 position	= light->GetTransform()->GetPosition();
+			float range			= light->GetRange();
+
+			// A caster outside of the light's sphere can't shadow anything the light reaches
+			uint64_t castersHash = 0;
+			for (const auto& caster : m_casters)
+			{
+				if (!_ShadowAtlas::Intersects(caster.box, position, range))
+					continue;
+
+				entry.casters.emplace_back(caster.actor);
+				castersHash += caster.key;
+			}
+
+			uint64_t lightHash = Hash(light->GetTransform()->GetWorldTransform());
+			lightHash = _ShadowAtlas::Mix(lightHash, _ShadowAtlas::Hash(range));
+			lightHash = _ShadowAtlas::Mix(lightHash, _ShadowAtlas::Hash(light->GetAngle()));
+			lightHash = _ShadowAtlas::Mix(lightHash, reverseZ ? 1 : 0);
+			lightHash = _ShadowAtlas::Mix(lightHash, castersHash);
+
+			for (unsigned int face = 0; face < entry.faces; face++)
+			{
+				auto& tile		= m_tiles[entry.firstTile + face];
+				tile.reverseZ	= reverseZ;
+				tile.signature	= lightHash;
+				Tile_Compute(tile);
+
+				// What was rendered stays usable for as long as the tile doesn't move
+				auto previous = m_firstTilesPrevious.find(light);
+				if (previous != m_firstTilesPrevious.end())
+				{
+					const auto& tilePrevious = m_tilesPrevious[previous->second + face];
+					if (tilePrevious.rendered && tilePrevious.x == tile.x && tilePrevious.y == tile.y && tilePrevious.size == tile.size)
+					{
+						tile.viewProjectionRendered	= tilePrevious.viewProjectionRendered;
+						tile.signatureRendered		= tilePrevious.signatureRendered;
+						tile.reverseZRendered		= tilePrevious.reverseZRendered;
+						tile.rendered				= true;
+					}
+				}
+			}
+		}
+
+		// The most important lights catch up first
+		for (const auto& entry : m_entries)
+		{
+			for (unsigned int face = 0; face < entry.faces && m_dirty.size() < SHADOW_ATLAS_UPDATES_MAX; face++)
+			{
+				const auto& tile = m_tiles[entry.firstTile + face];
+				if (!tile.rendered || tile.signatureRendered != tile.signature)
+				{
+					m_dirty.emplace_back(entry.firstTile + face);
+				}
+			}
+		}
+	}
+
+	void ShadowAtlas::Tile_Rendered(unsigned int index)
+	{
+		auto& tile					= m_tiles[index];
+		tile.viewProjectionRendered	= tile.viewProjection;
+		tile.signatureRendered		= tile.signature;
+		tile.reverseZRendered		= tile.reverseZ;
+		tile.rendered				= true;
+	}
+
+	void ShadowAtlas::Upload()
+	{
+		m_lightTiles.clear();
+		if (m_tiles.empty())
+			return;
+
+		auto data = (_ShadowAtlas::TileData*)m_tileBuffer->Map();
+		if (!data)
+			return;
+		for (unsigned int i = 0; i < (unsigned int)m_tiles.size(); i++)
+		{
+			const auto& tile		= m_tiles[i];
+			data[i].viewProjection	= tile.viewProjectionRendered;
+			data[i].rect			= Vector4((float)tile.x, (float)tile.y, (float)tile.size, tile.reverseZRendered ? 1.0f : 0.0f);
+		}
+		m_tileBuffer->Unmap();
+
+		// A point light only gets shadows once all of it's faces have something in them
+		for (const auto& entry : m_entries)
+		{
+			bool rendered = true;
+			for (unsigned int face = 0; face < entry.faces; face++)
+			{
+				rendered = rendered && m_tiles[entry.firstTile + face].rendered;
+			}
+
+			if (rendered)
+			{
+				m_lightTiles[entry.light] = (int)entry.firstTile;
+			}
+		}
+	}
+
+	int ShadowAtlas::Light_GetTile(Light* light)
+	{
+		auto it = m_lightTiles.find(light);
+		return it != m_lightTiles.end() ? it->second : -1;
+	}
+
+	uint64_t ShadowAtlas::Hash(const Matrix& matrix)
+	{
+		const auto bytes	= (const unsigned char*)&matrix;
+		uint64_t hash		= 0xCBF29CE484222325ull;
+		for (size_t i = 0; i < sizeof(Matrix); i++)
+		{
+			hash = _ShadowAtlas::Mix(hash, bytes[i]);
+		}
+		return hash;
+	}
+
+	bool ShadowAtlas::Entry_Create(Light* light, Camera* camera, Entry& entry)
+	{
+		Vector3 position	= light->GetTransform()->GetPosition();
+		float range			= light->GetRange();
+		if (range <= 0.0f || camera->GetFrustum().CheckSphere(position, range) == Outside)
+			return false;
+
+		// Roughly the fraction of the screen's width the light's sphere covers
+		float distance	= (position - camera->GetTransform()->GetPosition()).Length();
+		float fraction	= distance <= range ? 1.0f : Min(range / (distance * tan(camera->GetFOV_Horizontal_Deg() * DEG_TO_RAD * 0.5f)), 1.0f);
+		float ideal		= fraction * SHADOW_ATLAS_TILE_MAX;
+
+		unsigned int size = SHADOW_ATLAS_TILE_MIN;
+		while (size < SHADOW_ATLAS_TILE_MAX && size * 2 <= ideal) { size *= 2; }
+
+		// Don't flip between two sizes, that would re-render the light every time
+		auto previous = m_sizes.find(light);
+		if (previous != m_sizes.end() && previous->second > size && ideal >= previous->second * SHADOW_ATLAS_HYSTERESIS)
+		{
+			size = previous->second;
+		}
+
+		entry.light			= light;
+		entry.importance	= fraction;
+		entry.size			= size;
+		entry.faces			= light->GetLightType() == LightType_Point ? 6 : 1;
+		entry.firstTile		= 0;
+		return true;
+	}
+
+	void ShadowAtlas::Layout()
+	{
+		// Over budget, the least important lights get smaller tiles first and are dropped once even the smallest don't fit
+		unsigned int cells = 0;
+		for (const auto& entry : m_entries)
+		{
+			cells += _ShadowAtlas::Cells(entry.size, entry.faces);
+		}
+		while (cells > SHADOW_ATLAS_TILES_MAX)
+		{
+			auto it = find_if(m_entries.rbegin(), m_entries.rend(), [](const Entry& entry) { return entry.size > SHADOW_ATLAS_TILE_MIN; });
+			if (it != m_entries.rend())
+			{
+				cells		-= _ShadowAtlas::Cells(it->size, it->faces);
+				it->size	/= 2;
+				cells		+= _ShadowAtlas::Cells(it->size, it->faces);
+			}
+			else
+			{
+				cells -= _ShadowAtlas::Cells(m_entries.back().size, m_entries.back().faces);
+				m_entries.pop_back();
+			}
+		}
+
+		// Largest first, so every tile starts at a multiple of it's own size along the curve
+		m_order.resize(m_entries.size());
+		for (unsigned int i = 0; i < (unsigned int)m_order.size(); i++) { m_order[i] = i; }
+		stable_sort(m_order.begin(), m_order.end(), [this](unsigned int a, unsigned int b) { return m_entries[a].size > m_entries[b].size; });
+
+		unsigned int cursor = 0;
+		for (auto index : m_order)
+		{
+			auto& entry		= m_entries[index];
+			entry.firstTile	= (unsigned int)m_tiles.size();
+			for (unsigned int face = 0; face < entry.faces; face++)
+			{
+				Tile tile;
+				tile.light	= entry.light;
+				tile.face	= face;
+				tile.x		= _ShadowAtlas::Compact(cursor) * SHADOW_ATLAS_TILE_MIN;
+				tile.y		= _ShadowAtlas::Compact(cursor >> 1) * SHADOW_ATLAS_TILE_MIN;
+				tile.size	= entry.size;
+				tile.entry	= index;
+				m_tiles.emplace_back(tile);
+				cursor += _ShadowAtlas::Cells(entry.size, 1);
+			}
+		}
+	}
+
+	void ShadowAtlas::Tile_Compute(Tile& tile)
+	{
+		Light* light		= tile.light;
+		Vector3 position	= light->GetTransform()->GetPosition();
+		float range			= light->GetRange();
+		float nearPlane		= Min(Max(range * 0.01f, 0.05f), range * 0.5f);
+
+		Matrix view;
+		float fov = PI_DIV_2;
+		if (light->GetLightType() == LightType_Point)
+		{
+			view = Matrix::CreateLookAtLH(position, position + _ShadowAtlas::faceDirections[tile.face], _ShadowAtlas::faceUps[tile.face]);
+		}
+		else
+		{
+			// The cone's cutoff is a cosine (see Light.hlsl)
+			Vector3 direction	= light->GetDirection();
+			Vector3 up			= Abs(direction.y) > 0.99f ? Vector3::Forward : Vector3::Up;
+			view				= Matrix::CreateLookAtLH(position, position + direction, up);
+			fov					= Clamp(2.0f * acos(Clamp(1.0f - light->GetAngle(), -1.0f, 1.0f)), 1.0f * DEG_TO_RAD, 170.0f * DEG_TO_RAD);
+		}
+
+		Matrix projection = Matrix::CreatePerspectiveFieldOfViewLH(fov, 1.0f, nearPlane, range);
+		tile.viewProjection = view * (tile.reverseZ ? projection * Matrix::CreateReverseZ() : projection);
+	}
+}
@@ -0,0 +1,138 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/BoundingBox.h"
+//===============================
+
+#define SHADOW_ATLAS_SIZE			4096	// texels per side, all the memory point and spot light shadows get
+#define SHADOW_ATLAS_TILE_MAX		1024
+#define SHADOW_ATLAS_TILE_MIN		128
+#define SHADOW_ATLAS_CELLS			(SHADOW_ATLAS_SIZE / SHADOW_ATLAS_TILE_MIN) // per side, in tiles of the smallest size
+#define SHADOW_ATLAS_TILES_MAX		(SHADOW_ATLAS_CELLS * SHADOW_ATLAS_CELLS)
+#define SHADOW_ATLAS_UPDATES_MAX	12		// tiles re-rendered per frame, the rest keep what they have until a later one
+#define SHADOW_ATLAS_HYSTERESIS		0.75f	// a tile only shrinks once the size it needs is below this fraction of it's own
+
+namespace Directus
+{
+	class Actor;
+	class Camera;
+	class Light;
+	class RenderTexturePool;
+
+	// One shadow map shared by every point and spot light that casts shadows. Each light gets tiles of it (a point light
+	// one per cube face) sized by how much of the screen it covers, when they don't all fit the least important ones get
+	// smaller first. A tile keeps it's place while the layout holds, and is only re-rendered when it's light or a caster
+	// within the light's range changes.
+	class ShadowAtlas
+	{
+	public:
+		ShadowAtlas(std::shared_ptr<RHI_Device> rhiDevice, std::shared_ptr<RenderTexturePool> pool);
+		~ShadowAtlas();
+
+		struct Tile
+		{
+			Light* light				= nullptr;
+			unsigned int face			= 0;
+			unsigned int x				= 0;	// texels, in the atlas
+			unsigned int y				= 0;
+			unsigned int size			= 0;
+			unsigned int entry			= 0;
+			Math::Matrix viewProjection;		// as of this frame
+			uint64_t signature			= 0;	// of the light and the casters within it's range, as of this frame
+			bool reverseZ				= false;
+
+			// What the atlas holds was rendered with
+			Math::Matrix viewProjectionRendered;
+			uint64_t signatureRendered	= 0;
+			bool reverseZRendered		= false;
+			bool rendered				= false;
+		};
+
+		// This frame's shadow casters, in the opaque list's order so that every light's casters keep their instancing runs.
+		// The key has to change with the caster's transform (or every frame, for skinned ones), the box is in world space.
+		void Casters_Clear()															{ m_casters.clear(); }
+		void Caster_Add(Actor* actor, const Math::BoundingBox& box, uint64_t key)		{ m_casters.emplace_back(Caster{ actor, box, key }); }
+
+		// Sizes and packs the tiles of the lights and finds the ones that are out of date
+		void Update(const std::vector<Actor*>& lights, Camera* camera, bool reverseZ);
+		// Up to SHADOW_ATLAS_UPDATES_MAX tiles to re-render, most important first
+		const std::vector<unsigned int>& Tiles_GetDirty()					{ return m_dirty; }
+		const Tile& Tile_Get(unsigned int index)							{ return m_tiles[index]; }
+		const std::vector<Actor*>& Tile_GetCasters(unsigned int index)		{ return m_entries[m_tiles[index].entry].casters; }
+		// Call once a dirty tile has been rendered into the atlas
+		void Tile_Rendered(unsigned int index);
+		// Uploads what the light pass samples the tiles with
+		void Upload();
+
+		// The first of a light's tiles, -1 until all of them have been rendered
+		int Light_GetTile(Light* light);
+		const std::shared_ptr<RHI_RenderTexture>& GetAtlas()			{ return m_atlas; }
+		const std::shared_ptr<RHI_StructuredBuffer>& GetTileBuffer()	{ return m_tileBuffer; }
+
+		static uint64_t Hash(const Math::Matrix& matrix);
+
+	private:
+		struct Caster
+		{
+			Actor* actor;
+			Math::BoundingBox box;
+			uint64_t key;
+		};
+
+		struct Entry
+		{
+			Light* light;
+			float importance;
+			unsigned int size;
+			unsigned int faces;
+			unsigned int firstTile;
+			std::vector<Actor*> casters;
+		};
+
+		bool Entry_Create(Light* light, Camera* camera, Entry& entry);
+		void Layout();
+		void Tile_Compute(Tile& tile);
+
+		std::vector<Caster> m_casters;
+		std::vector<Entry> m_entries;
+		std::vector<unsigned int> m_order;
+		std::vector<Tile> m_tiles;
+		std::vector<Tile> m_tilesPrevious;
+		std::vector<unsigned int> m_dirty;
+		std::unordered_map<Light*, unsigned int> m_sizes;	// last frame's, for the hysteresis
+		std::unordered_map<Light*, unsigned int> m_firstTiles;
+		std::unordered_map<Light*, unsigned int> m_firstTilesPrevious;
+		std::unordered_map<Light*, int> m_lightTiles;	// the lights all tiles of which have been rendered
+
+		std::shared_ptr<RHI_RenderTexture> m_atlas;
+		std::shared_ptr<RHI_StructuredBuffer> m_tileBuffer;
+		std::shared_ptr<RenderTexturePool> m_pool;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
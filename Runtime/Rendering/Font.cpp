@@ -25,7 +25,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/Stopwatch.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_VertexBuffer.h"
-#include "../RHI/RHI_IndexBuffer.h"
 #include "../RHI/RHI_Vertex.h"
 #include "../RHI/RHI_Texture.h"
 #include "../Resource/ResourceManager.h"
@@ -39,12 +38,39 @@ using namespace Directus::Math;
 #define ASCII_TAB		9
 #define ASCII_NEW_LINE	10
 #define ASCII_SPACE		32
+#define FONT_VERTEX_CAPACITY 6 * 4096 // glyph quads the vertex buffer holds up front, it doubles when a frame needs more
 
 namespace Directus
 {
+	namespace _Font
+	{
+		// Decodes the UTF-8 sequence at index and moves past it, a malformed byte is returned as is
+		inline unsigned int Utf8_Next(const string& text, size_t& index)
+		{
+			auto lead = (unsigned char)text[index++];
+			unsigned int length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+			if (length == 0 || index + length > text.size())
+				return lead;
+
+			unsigned int codepoint = lead & (0x3F >> length);
+			for (unsigned int i = 0; i < length; i++)
+			{
+				auto continuation = (unsigned char)text[index + i];
+				if ((continuation & 0xC0) != 0x80)
+					return lead;
+
+				codepoint = (codepoint << 6) | (continuation & 0x3F);
+			}
+			index += length;
+
+			return codepoint;
+		}
+	}
+
 	Font::Font(Context* context, const string& filePath, int fontSize, const Vector4& color) : IResource(context, Resource_Font)
 	{
 		m_rhiDevice		= m_context->GetSubsystem<Renderer>()->GetRHIDevice();
+		m_atlas			= make_unique<FontAtlas>();
 		m_charMaxWidth	= 0;
 		m_charMaxHeight = 0;
 		m_fontColor		= color;
@@ -70,58 +96,123 @@ namespace Directus
 		Stopwatch timer;
 
 		// Load font
-		vector<std::byte> atlasBuffer;
-		unsigned int texAtlasWidth = 0;
-		unsigned int texAtlasHeight = 0;
-		if (!m_context->GetSubsystem<ResourceManager>()->GetFontImporter()->LoadFromFile(filePath, m_fontSize, atlasBuffer, texAtlasWidth, texAtlasHeight, m_glyphs))
+		if (!m_context->GetSubsystem<ResourceManager>()->GetFontImporter()->LoadFromFile(filePath, m_fontSize, m_atlas.get()))
 		{
 			LOGF_ERROR("Font::LoadFromFile Failed to load font \"%s\"", filePath.c_str());
-			atlasBuffer.clear();
 			return false;
 		}
+		m_filePath = filePath;
+		m_layouts.clear();
+		m_layoutsPrevious.clear();
 
 		// Find max character height (todo, actually get spacing from FreeType)
-		for (const auto& charInfo : m_glyphs)
+		for (const auto& charInfo : m_atlas->glyphs)
 		{
 			m_charMaxWidth	= Max<int>(charInfo.second.width, m_charMaxWidth);
 			m_charMaxHeight = Max<int>(charInfo.second.height, m_charMaxHeight);
 		}
 
 		// Create a font texture atlas form the provided data
-		m_textureAtlas = make_shared<RHI_Texture>(m_context);
-		vector<vector<std::byte>> mipmaps;
-		mipmaps.emplace_back(atlasBuffer);
-		bool generateMimaps = false;
-		if (!m_textureAtlas->ShaderResource_Create2D(texAtlasWidth, texAtlasHeight, 1, Texture_Format_R8_UNORM, mipmaps, generateMimaps))
-		{
-			LOG_ERROR("Font: Failed to create shader resource.");
-		}
+		Atlas_Upload();
 		LOG_INFO("Font: Loading \"" + FileSystem::GetFileNameFromFilePath(filePath) + "\" took " + to_string((int)timer.GetElapsedTimeMs()) + " ms");
 
 		return true;
 	}
 
-	void Font::SetText(const string& text, const Vector2& position)
+	void Font::AddText(const string& text, const Vector2& position)
 	{
-		if (text == m_currentText)
-			return;
+		for (const auto& vertex : Layout_Get(text).vertices)
+		{
+			m_vertices.emplace_back(vertex.pos[0] + position.x, vertex.pos[1] + position.y, vertex.pos[2], vertex.uv[0], vertex.uv[1]);
+		}
+	}
+
+	bool Font::UpdateBuffers()
+	{
+		// Layouts survive as long as they keep getting drawn
+		m_layoutsPrevious.swap(m_layouts);
+		m_layouts.clear();
 
-		Vector2 pen = position;
-		m_currentText = text;
+		m_vertexCount = (unsigned int)m_vertices.size();
+		if (m_vertexCount == 0)
+			return false;
+
+		// The buffer only gets recreated when it has to grow
+		if (!m_vertexBuffer || m_vertexCount > m_vertexCapacity)
+		{
+			m_vertexCapacity = Max<unsigned int>(m_vertexCapacity, FONT_VERTEX_CAPACITY);
+			while (m_vertexCapacity < m_vertexCount) { m_vertexCapacity *= 2; }
+
+			m_vertexBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
+			if (!m_vertexBuffer->CreateDynamic(sizeof(RHI_Vertex_PosUV), m_vertexCapacity))
+			{
+				LOG_ERROR("Font: Failed to create vertex buffer.");
+				m_vertexBuffer		= nullptr;
+				m_vertexCapacity	= 0;
+				m_vertexCount		= 0;
+				m_vertices.clear();
+				return false;
+			}
+		}
+
+		void* data = m_vertexBuffer->Map();
+		if (data)
+		{
+			memcpy(data, &m_vertices[0], sizeof(RHI_Vertex_PosUV) * m_vertexCount);
+			m_vertexBuffer->Unmap();
+		}
 		m_vertices.clear();
-		m_vertices.shrink_to_fit();
+
+		return data != nullptr;
+	}
+
+	const Font::TextLayout& Font::Layout_Get(const string& text)
+	{
+		auto key = hash<string>{}(text);
+
+		// Used this frame already
+		auto it = m_layouts.find(key);
+		if (it != m_layouts.end() && it->second.text == text)
+			return it->second;
+
+		// Used last frame, keep it around
+		auto& layout = m_layouts[key];
+		auto itPrevious = m_layoutsPrevious.find(key);
+		if (itPrevious != m_layoutsPrevious.end() && itPrevious->second.text == text)
+		{
+			layout = move(itPrevious->second);
+			m_layoutsPrevious.erase(itPrevious);
+			return layout;
+		}
+
+		Layout_Create(text, layout);
+		return layout;
+	}
+
+	void Font::Layout_Create(const string& text, TextLayout& layout)
+	{
+		layout.text = text;
+		layout.vertices.clear();
+		Vector2 pen = Vector2::Zero;
+
+		Atlas_AddGlyphs(text);
 		
 		// Draw each letter onto a quad.
-		for (char textChar : m_currentText)
+		for (size_t i = 0; i < text.size();)
 		{
-			auto glyph = m_glyphs[textChar];
+			auto textChar	= _Font::Utf8_Next(text, i);
+			auto it			= m_atlas->glyphs.find(textChar);
+			if (it == m_atlas->glyphs.end())
+				continue;
+			const auto& glyph = it->second;
 
 			if (textChar == ASCII_TAB)
 			{
-				int spaceOffset = m_glyphs[ASCII_SPACE].horizontalOffset;
+				auto space		= m_atlas->glyphs.find(ASCII_SPACE);
+				int spaceOffset = space != m_atlas->glyphs.end() ? space->second.horizontalOffset : 0;
 				int spaceCount = 8; // spaces in a typical terminal
 				int tabSpacing = spaceOffset * spaceCount;
-				int columnHeader = int(pen.x - position.x); // -position.x because it has to be zero based so we can do the mod below
+				int columnHeader = int(pen.x); // zero based so we can do the mod below
 				int offsetToNextTabStop = tabSpacing - (columnHeader % (tabSpacing != 0 ? tabSpacing : 1));
 				pen.x += offsetToNextTabStop;
 				continue;
@@ -130,7 +221,7 @@ namespace Directus
 			if (textChar == ASCII_NEW_LINE)
 			{
 				pen.y = pen.y - m_charMaxHeight;
-				pen.x = position.x;
+				pen.x = 0.0f;
 				continue;
 			}
 
@@ -141,66 +232,70 @@ namespace Directus
 			}
 
 			// First triangle in quad.		
-			m_vertices.emplace_back(pen.x,					pen.y - glyph.descent,					0.0f, glyph.uvXLeft, glyph.uvYTop);		// Top left
-			m_vertices.emplace_back((pen.x + glyph.width),	(pen.y - glyph.height - glyph.descent), 0.0f, glyph.uvXRight, glyph.uvYBottom);	// Bottom right
-			m_vertices.emplace_back(pen.x,					(pen.y - glyph.height - glyph.descent), 0.0f, glyph.uvXLeft, glyph.uvYBottom);	// Bottom left
+			layout.vertices.emplace_back(pen.x,					pen.y - glyph.descent,					0.0f, glyph.uvXLeft, glyph.uvYTop);		// Top left
+			layout.vertices.emplace_back((pen.x + glyph.width),	(pen.y - glyph.height - glyph.descent), 0.0f, glyph.uvXRight, glyph.uvYBottom);	// Bottom right
+			layout.vertices.emplace_back(pen.x,					(pen.y - glyph.height - glyph.descent), 0.0f, glyph.uvXLeft, glyph.uvYBottom);	// Bottom left
 			// Second triangle in quad.
-			m_vertices.emplace_back(pen.x,					pen.y - glyph.descent,					0.0f, glyph.uvXLeft, glyph.uvYTop);		// Top left
-			m_vertices.emplace_back((pen.x	+ glyph.width),	pen.y - glyph.descent,					0.0f, glyph.uvXRight, glyph.uvYTop);	// Top right
-			m_vertices.emplace_back((pen.x	+ glyph.width),	(pen.y - glyph.height - glyph.descent), 0.0f, glyph.uvXRight, glyph.uvYBottom);	// Bottom right
+			layout.vertices.emplace_back(pen.x,					pen.y - glyph.descent,					0.0f, glyph.uvXLeft, glyph.uvYTop);		// Top left
+			layout.vertices.emplace_back((pen.x	+ glyph.width),	pen.y - glyph.descent,					0.0f, glyph.uvXRight, glyph.uvYTop);	// Top right
+			layout.vertices.emplace_back((pen.x	+ glyph.width),	(pen.y - glyph.height - glyph.descent), 0.0f, glyph.uvXRight, glyph.uvYBottom);	// Bottom right
 
 			// Update the x location for drawing by the size of the letter and one pixel.
 			pen.x = pen.x + glyph.width;
 		}
+	}
 
-		m_indices.clear();
-		m_indices.shrink_to_fit();
+	void Font::Atlas_AddGlyphs(const string& text)
+	{
+		vector<unsigned int> missing;
+		for (size_t i = 0; i < text.size();)
+		{
+			auto textChar = _Font::Utf8_Next(text, i);
+			if (textChar != ASCII_TAB && textChar != ASCII_NEW_LINE && m_atlas->glyphs.find(textChar) == m_atlas->glyphs.end())
+			{
+				missing.emplace_back(textChar);
+			}
+		}
+
+		unsigned int heightPrevious = m_atlas->height;
+		if (missing.empty() || !m_context->GetSubsystem<ResourceManager>()->GetFontImporter()->AddGlyphs(m_filePath, m_fontSize, missing, m_atlas.get()))
+			return;
 
-		for (unsigned int i = 0; i < m_vertices.size(); i++)
+		// The atlas grew downwards, vertices made before have their vertical uvs scaled to match
+		if (m_atlas->height != heightPrevious && heightPrevious != 0)
 		{
-			m_indices.emplace_back(i);
+			float scale = (float)heightPrevious / (float)m_atlas->height;
+			auto Rescale = [scale](vector<RHI_Vertex_PosUV>& vertices) { for (auto& vertex : vertices) { vertex.uv[1] *= scale; } };
+			Rescale(m_vertices);
+			for (auto& layout : m_layouts)			{ Rescale(layout.second.vertices); }
+			for (auto& layout : m_layoutsPrevious)	{ Rescale(layout.second.vertices); }
 		}
-		UpdateBuffers(m_vertices, m_indices);
-	}
 
-	void Font::SetSize(int size)
-	{
-		m_fontSize = Clamp<int>(size, 8, 50);
+		Atlas_Upload();
 	}
 
-	bool Font::UpdateBuffers(vector<RHI_Vertex_PosUV>& vertices, vector<unsigned int>& indices)
+	bool Font::Atlas_Upload()
 	{
-		if (!m_context)
+		if (m_atlas->buffer.empty())
 			return false;
 
-		// Vertex buffer
-		if (!m_vertexBuffer)
-		{
-			m_vertexBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
-			if (!m_vertexBuffer->CreateDynamic(sizeof(RHI_Vertex_PosUV), (unsigned int)vertices.size()))
-			{
-				LOG_ERROR("Font: Failed to create vertex buffer.");
-				return false;
-			}	
-		}
-		void* data = m_vertexBuffer->Map();
-		memcpy(data, &vertices[0], sizeof(RHI_Vertex_PosUV) * vertices.size());
-		m_vertexBuffer->Unmap();
-
-		// Index buffer
-		if (!m_indexBuffer)
+		// A new texture, the one that's replaced might still be bound
+		auto texture = make_shared<RHI_Texture>(m_context);
+		vector<vector<std::byte>> mipmaps;
+		mipmaps.emplace_back(m_atlas->buffer);
+		bool generateMimaps = false;
+		if (!texture->ShaderResource_Create2D(m_atlas->width, m_atlas->height, 1, Texture_Format_R8_UNORM, mipmaps, generateMimaps))
 		{
-			m_indexBuffer = make_shared<RHI_IndexBuffer>(m_rhiDevice);
-			if (!m_indexBuffer->CreateDynamic((unsigned int)indices.size()))
-			{
-				LOG_ERROR("Font: Failed to create index buffer.");
-				return false;
-			}
+			LOG_ERROR("Font: Failed to create shader resource.");
+			return false;
 		}
-		data = m_indexBuffer->Map();
-		memcpy(data, &indices[0], sizeof(unsigned int) * indices.size());
-		m_indexBuffer->Unmap();
 
+		m_textureAtlas = texture;
 		return true;
 	}
-}
+
+	void Font::SetSize(int size)
+	{
+		m_fontSize = Clamp<int>(size, 8, 50);
+	}
+}
\ No newline at end of file
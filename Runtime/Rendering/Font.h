@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <map>
+#include <vector>
+#include <unordered_map>
 #include "../RHI/RHI_Definition.h"
 #include "../Core/EngineDefs.h"
 #include "../Resource/IResource.h"
@@ -37,7 +39,7 @@ namespace Directus
 		class Vector2;
 	}
 
-	struct Glyph;
+	struct FontAtlas;
 
 	class ENGINE_CLASS Font : IResource
 	{
@@ -50,31 +52,46 @@ namespace Directus
 		bool LoadFromFile(const std::string& filePath) override;
 		//======================================================
 
-		void SetText(const std::string& text, const Math::Vector2& position);
+		// Queues text for this frame, every call ends up in the same vertex buffer and draw
+		void AddText(const std::string& text, const Math::Vector2& position);
+		// Uploads what was queued since the last update, returns false if there is nothing to draw
+		bool UpdateBuffers();
 		void SetSize(int size);
 
 		const Math::Vector4& GetColor()				{ return m_fontColor; }
 		void SetColor(const Math::Vector4& color)	{ m_fontColor = color; }
 
 		const std::shared_ptr<RHI_Texture>& GetTexture()	{ return m_textureAtlas; }
-		std::shared_ptr<RHI_IndexBuffer> GetIndexBuffer()	{ return m_indexBuffer; }
 		std::shared_ptr<RHI_VertexBuffer> GetVertexBuffer()	{ return m_vertexBuffer; }
-		unsigned int GetIndexCount()						{ return (unsigned int)m_indices.size(); }
+		unsigned int GetVertexCount()						{ return m_vertexCount; }
 			
-	private:	
-		bool UpdateBuffers(std::vector<RHI_Vertex_PosUV>& vertices, std::vector<unsigned int>& indices);
+	private:
+		// Glyph quads relative to the pen's starting position
+		struct TextLayout
+		{
+			std::string text;
+			std::vector<RHI_Vertex_PosUV> vertices;
+		};
+		const TextLayout& Layout_Get(const std::string& text);
+		void Layout_Create(const std::string& text, TextLayout& layout);
+		// Adds any characters of the text the atlas is missing, re-uploading it
+		void Atlas_AddGlyphs(const std::string& text);
+		bool Atlas_Upload();
 
-		std::map<unsigned int, Glyph> m_glyphs;
+		std::unique_ptr<FontAtlas> m_atlas;
+		std::string m_filePath;
 		std::shared_ptr<RHI_Texture> m_textureAtlas;
 		int m_fontSize;
 		int m_charMaxWidth;
 		int m_charMaxHeight;
 		Math::Vector4 m_fontColor;
 		std::shared_ptr<RHI_VertexBuffer> m_vertexBuffer;
-		std::shared_ptr<RHI_IndexBuffer> m_indexBuffer;
+		unsigned int m_vertexCapacity	= 0;
+		unsigned int m_vertexCount		= 0;
 		std::vector<RHI_Vertex_PosUV> m_vertices;
-		std::vector<unsigned int> m_indices;
-		std::string m_currentText;
+		// Keyed by the hash of the text, layouts that weren't used for a frame get dropped
+		std::unordered_map<std::size_t, TextLayout> m_layouts;
+		std::unordered_map<std::size_t, TextLayout> m_layoutsPrevious;
 		std::shared_ptr<RHI_Device> m_rhiDevice;
 	};
 }
\ No newline at end of file
@@ -21,6 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================
 #include "GeometryUtility.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
 #include "..\RHI\RHI_Vertex.h"
 //============================
 
@@ -32,6 +37,39 @@ using namespace Helper;
 
 namespace Directus
 {
+	namespace _GeometryUtility
+	{
+		// Vertex scoring of "Linear-Speed Vertex Cache Optimisation" (Tom Forsyth)
+		static const int cacheSize					= 32;
+		static const float cacheDecayPower			= 1.5f;
+		static const float lastTriangleScore		= 0.75f;
+		static const float valenceBoostScale		= 2.0f;
+		static const float valenceBoostPower		= 0.5f;
+		// The FIFO cache simulated when looking for clusters, it's the size of typical hardware
+		static const unsigned int fifoSize			= 16;
+
+		inline float VertexScore(int cachePosition, unsigned int trianglesLeft)
+		{
+			if (trianglesLeft == 0)
+				return -1.0f;
+
+			float score = 0.0f;
+			if (cachePosition >= 0 && cachePosition < cacheSize)
+			{
+				// The vertices of the last triangle get a fixed score, so that the next triangle doesn't just reuse them in a strip
+				score = cachePosition < 3 ? lastTriangleScore : pow(1.0f - (cachePosition - 3) / float(cacheSize - 3), cacheDecayPower);
+			}
+
+			// Vertices with only a few triangles left are prioritized, so that they don't linger around
+			return score + valenceBoostScale * pow((float)trianglesLeft, -valenceBoostPower);
+		}
+
+		inline bool IndicesValid(const vector<unsigned int>& indices, unsigned int vertexCount)
+		{
+			return all_of(indices.begin(), indices.end(), [vertexCount](unsigned int index) { return index < vertexCount; });
+		}
+	}
+
 	void GeometryUtility::CreateCube(vector<RHI_Vertex_PosUVTBN>* vertices, vector<unsigned int>* indices)
 	{
 		// front
@@ -289,4 +327,315 @@ namespace Directus
 	{
 		CreateCylinder(vertices, indices, 0.0f, radius, height);
 	}
+
+	void GeometryUtility::Simplify(const vector<RHI_Vertex_PosUVTBN>& vertices, const vector<unsigned int>& indices, unsigned int cells, vector<unsigned int>* indicesSimplified)
+	{
+		indicesSimplified->clear();
+		if (vertices.empty() || indices.empty() || cells == 0)
+			return;
+
+		// Bounds of the geometry
+		Vector3 boundsMin = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vector3 boundsMax = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (const auto& vertex : vertices)
+		{
+			boundsMin = Vector3(Min(boundsMin.x, vertex.pos[0]), Min(boundsMin.y, vertex.pos[1]), Min(boundsMin.z, vertex.pos[2]));
+			boundsMax = Vector3(Max(boundsMax.x, vertex.pos[0]), Max(boundsMax.y, vertex.pos[1]), Max(boundsMax.z, vertex.pos[2]));
+		}
+		Vector3 extent		= boundsMax - boundsMin;
+		float cellSize		= Max(Max(extent.x, extent.y), Max(extent.z, M_EPSILON)) / (float)cells;
+
+		// Assign every vertex to a cell, the normal's octant is part of the cell so that
+		// opposite sides of thin surfaces and hard edges don't collapse into each other
+		vector<unsigned long long> vertexCells(vertices.size());
+		unordered_map<unsigned long long, Vector3> cellCentroids;
+		unordered_map<unsigned long long, unsigned int> cellCounts;
+		for (unsigned int i = 0; i < (unsigned int)vertices.size(); i++)
+		{
+			const auto& vertex	= vertices[i];
+			auto x				= (unsigned long long)Min((unsigned int)((vertex.pos[0] - boundsMin.x) / cellSize), cells - 1);
+			auto y				= (unsigned long long)Min((unsigned int)((vertex.pos[1] - boundsMin.y) / cellSize), cells - 1);
+			auto z				= (unsigned long long)Min((unsigned int)((vertex.pos[2] - boundsMin.z) / cellSize), cells - 1);
+			auto octant			= (unsigned long long)((vertex.normal[0] < 0.0f ? 1 : 0) | (vertex.normal[1] < 0.0f ? 2 : 0) | (vertex.normal[2] < 0.0f ? 4 : 0));
+			vertexCells[i]		= (((x * cells + y) * cells + z) << 3) | octant;
+
+			cellCentroids[vertexCells[i]] += Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+			cellCounts[vertexCells[i]]++;
+		}
+
+		// Each cell is represented by its vertex that is closest to the cell's centroid
+		unordered_map<unsigned long long, unsigned int> cellVertex;
+		for (unsigned int i = 0; i < (unsigned int)vertices.size(); i++)
+		{
+			auto cell			= vertexCells[i];
+			Vector3 centroid	= cellCentroids[cell] / (float)cellCounts[cell];
+			auto it				= cellVertex.find(cell);
+			if (it == cellVertex.end())
+			{
+				cellVertex[cell] = i;
+				continue;
+			}
+
+			const auto& current = vertices[it->second];
+			float distance		= Vector3::LengthSquared(Vector3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]), centroid);
+			float distanceBest	= Vector3::LengthSquared(Vector3(current.pos[0], current.pos[1], current.pos[2]), centroid);
+			if (distance < distanceBest)
+			{
+				it->second = i;
+			}
+		}
+
+		// Re-index the triangles, dropping the ones that collapsed or became duplicates (the key packs 21 bits per index)
+		bool removeDuplicates = vertices.size() < (1ull << 21);
+		unordered_set<unsigned long long> triangles;
+		for (unsigned int i = 0; i + 2 < (unsigned int)indices.size(); i += 3)
+		{
+			unsigned int a = cellVertex[vertexCells[indices[i]]];
+			unsigned int b = cellVertex[vertexCells[indices[i + 1]]];
+			unsigned int c = cellVertex[vertexCells[indices[i + 2]]];
+			if (a == b || b == c || a == c)
+				continue;
+
+			// Rotate the smallest index first (keeps the winding) so duplicates share a key
+			while (a > b || a > c) { auto t = a; a = b; b = c; c = t; }
+			if (removeDuplicates && !triangles.insert((unsigned long long)a | ((unsigned long long)b << 21) | ((unsigned long long)c << 42)).second)
+				continue;
+
+			indicesSimplified->emplace_back(a);
+			indicesSimplified->emplace_back(b);
+			indicesSimplified->emplace_back(c);
+		}
+	}
+
+	void GeometryUtility::OptimizeVertexCache(vector<unsigned int>* indices, unsigned int vertexCount)
+	{
+		using namespace _GeometryUtility;
+
+		auto triangleCount = (unsigned int)indices->size() / 3;
+		if (triangleCount == 0 || !IndicesValid(*indices, vertexCount))
+			return;
+
+		// The triangles of every vertex, as ranges in one array
+		vector<unsigned int> trianglesLeft(vertexCount, 0);
+		for (unsigned int i = 0; i < triangleCount * 3; i++)
+		{
+			trianglesLeft[(*indices)[i]]++;
+		}
+		vector<unsigned int> vertexTrianglesOffset(vertexCount, 0);
+		for (unsigned int i = 1; i < vertexCount; i++)
+		{
+			vertexTrianglesOffset[i] = vertexTrianglesOffset[i - 1] + trianglesLeft[i - 1];
+		}
+		vector<unsigned int> vertexTriangles(triangleCount * 3);
+		{
+			vector<unsigned int> filled(vertexCount, 0);
+			for (unsigned int i = 0; i < triangleCount * 3; i++)
+			{
+				unsigned int vertex = (*indices)[i];
+				vertexTriangles[vertexTrianglesOffset[vertex] + filled[vertex]++] = i / 3;
+			}
+		}
+
+		vector<int> cachePosition(vertexCount, -1);
+		vector<float> vertexScore(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			vertexScore[i] = VertexScore(-1, trianglesLeft[i]);
+		}
+		vector<unsigned int> optimized;
+		optimized.reserve(triangleCount * 3);
+		vector<bool> emitted(triangleCount, false);
+		vector<unsigned int> cache, cacheNext;
+		cache.reserve(cacheSize + 3);
+		cacheNext.reserve(cacheSize + 3);
+		unsigned int cursor	= 0; // the next triangle to fall back to, when the cache has nothing left
+		int best			= -1;
+		while (optimized.size() < triangleCount * 3)
+		{
+			if (best < 0)
+			{
+				while (emitted[cursor]) { cursor++; }
+				best = (int)cursor;
+			}
+
+			// Emit the triangle and detach it from its vertices
+			emitted[best] = true;
+			cacheNext.clear();
+			for (unsigned int i = 0; i < 3; i++)
+			{
+				unsigned int vertex = (*indices)[best * 3 + i];
+				optimized.emplace_back(vertex);
+				cacheNext.emplace_back(vertex);
+
+				auto triangles		= &vertexTriangles[vertexTrianglesOffset[vertex]];
+				auto& count			= trianglesLeft[vertex];
+				auto it				= find(triangles, triangles + count, (unsigned int)best);
+				*it					= triangles[count - 1];
+				count--;
+			}
+
+			// The triangle's vertices move to the front of the cache, the rest shifts back
+			for (auto vertex : cache)
+			{
+				if (vertex != cacheNext[0] && vertex != cacheNext[1] && vertex != cacheNext[2])
+				{
+					cacheNext.emplace_back(vertex);
+				}
+			}
+			swap(cache, cacheNext);
+
+			// Rescore what was touched and pick the best triangle that uses a cached vertex
+			best				= -1;
+			float bestScore		= -FLT_MAX;
+			for (unsigned int i = 0; i < (unsigned int)cache.size(); i++)
+			{
+				unsigned int vertex		= cache[i];
+				cachePosition[vertex]	= i < (unsigned int)cacheSize ? (int)i : -1;
+				vertexScore[vertex]		= VertexScore(cachePosition[vertex], trianglesLeft[vertex]);
+			}
+			for (unsigned int i = 0; i < (unsigned int)cache.size(); i++)
+			{
+				unsigned int vertex	= cache[i];
+				auto triangles		= &vertexTriangles[vertexTrianglesOffset[vertex]];
+				for (unsigned int j = 0; j < trianglesLeft[vertex]; j++)
+				{
+					unsigned int triangle	= triangles[j];
+					float score				= vertexScore[(*indices)[triangle * 3]] + vertexScore[(*indices)[triangle * 3 + 1]] + vertexScore[(*indices)[triangle * 3 + 2]];
+					if (score > bestScore)
+					{
+						bestScore	= score;
+						best		= (int)triangle;
+					}
+				}
+			}
+
+			// Vertices that fell out of the cache have been rescored, they can go now
+			if (cache.size() > (unsigned int)cacheSize)
+			{
+				cache.resize(cacheSize);
+			}
+		}
+
+		*indices = move(optimized);
+	}
+
+	void GeometryUtility::OptimizeOverdraw(vector<unsigned int>* indices, const vector<RHI_Vertex_PosUVTBN>& vertices, float threshold /*=1.05f*/)
+	{
+		using namespace _GeometryUtility;
+
+		auto triangleCount = (unsigned int)indices->size() / 3;
+		if (triangleCount == 0 || !IndicesValid(*indices, (unsigned int)vertices.size()))
+			return;
+
+		// Simulate a FIFO cache to know how many vertices every triangle misses
+		vector<unsigned int> misses(triangleCount, 0);
+		vector<unsigned int> fifoStamp(vertices.size(), 0);
+		unsigned int fifoTime	= fifoSize + 1;
+		for (unsigned int i = 0; i < triangleCount; i++)
+		{
+			for (unsigned int j = 0; j < 3; j++)
+			{
+				unsigned int vertex = (*indices)[i * 3 + j];
+				if (fifoTime - fifoStamp[vertex] > fifoSize)
+				{
+					fifoStamp[vertex] = fifoTime++;
+					misses[i]++;
+				}
+			}
+		}
+		float acmr = (fifoTime - (fifoSize + 1)) / (float)triangleCount;
+
+		// A cluster starts where the cache had to restart (every vertex missed), or where the cluster
+		// so far is still cheap enough, restarting there costs a few misses but it's order can change
+		vector<unsigned int> clusters; // the first triangle of each
+		unsigned int clusterMisses = 0;
+		for (unsigned int i = 0; i < triangleCount; i++)
+		{
+			bool restart	= misses[i] == 3;
+			bool cheap		= !clusters.empty() && misses[i] >= 2 && clusterMisses <= acmr * threshold * (i - clusters.back());
+			if (clusters.empty() || restart || cheap)
+			{
+				clusters.emplace_back(i);
+				clusterMisses = 0;
+			}
+			clusterMisses += misses[i];
+		}
+		clusters.emplace_back(triangleCount);
+
+		auto Position		= [&vertices](unsigned int index) { return Vector3(vertices[index].pos[0], vertices[index].pos[1], vertices[index].pos[2]); };
+		auto clusterCount	= (unsigned int)clusters.size() - 1;
+		vector<Vector3> clusterCentroid(clusterCount, Vector3::Zero);
+		vector<Vector3> clusterNormal(clusterCount, Vector3::Zero);
+		Vector3 meshCentroid = Vector3::Zero;
+		for (unsigned int c = 0; c < clusterCount; c++)
+		{
+			for (unsigned int i = clusters[c]; i < clusters[c + 1]; i++)
+			{
+				Vector3 a = Position((*indices)[i * 3]);
+				Vector3 b = Position((*indices)[i * 3 + 1]);
+				Vector3 d = Position((*indices)[i * 3 + 2]);
+
+				// The cross product is twice the area, the normal and centroid are area weighted through it
+				Vector3 normal	= Vector3::Cross(b - a, d - a);
+				float area		= normal.Length();
+				Vector3 center	= (a + b + d) / 3.0f;
+				clusterCentroid[c]	+= center * area;
+				clusterNormal[c]	+= normal;
+				meshCentroid		+= center * area;
+			}
+		}
+
+		// Sort the clusters by how much they face away from the center of the geometry, those occlude the rest
+		float meshArea = 0.0f;
+		for (unsigned int c = 0; c < clusterCount; c++)
+		{
+			meshArea += clusterNormal[c].Length();
+		}
+		meshCentroid = meshArea > M_EPSILON ? meshCentroid / meshArea : Vector3::Zero;
+
+		vector<float> clusterSort(clusterCount);
+		for (unsigned int c = 0; c < clusterCount; c++)
+		{
+			float area		= clusterNormal[c].Length();
+			Vector3 centroid	= area > M_EPSILON ? clusterCentroid[c] / area : clusterCentroid[c];
+			Vector3 normal		= area > M_EPSILON ? clusterNormal[c] / area : Vector3::Zero;
+			clusterSort[c]		= Vector3::Dot(centroid - meshCentroid, normal);
+		}
+
+		vector<unsigned int> order(clusterCount);
+		for (unsigned int c = 0; c < clusterCount; c++) { order[c] = c; }
+		stable_sort(order.begin(), order.end(), [&clusterSort](unsigned int a, unsigned int b) { return clusterSort[a] > clusterSort[b]; });
+
+		vector<unsigned int> optimized;
+		optimized.reserve(triangleCount * 3);
+		for (auto c : order)
+		{
+			optimized.insert(optimized.end(), indices->begin() + clusters[c] * 3, indices->begin() + clusters[c + 1] * 3);
+		}
+		optimized.insert(optimized.end(), indices->begin() + triangleCount * 3, indices->end()); // leftovers of an incomplete triangle
+
+		*indices = move(optimized);
+	}
+
+	void GeometryUtility::OptimizeVertexFetch(vector<RHI_Vertex_PosUVTBN>* vertices, vector<unsigned int>* indices)
+	{
+		static const unsigned int unused = 0xFFFFFFFF;
+		if (!_GeometryUtility::IndicesValid(*indices, (unsigned int)vertices->size()))
+			return;
+
+		vector<unsigned int> remap(vertices->size(), unused);
+		vector<RHI_Vertex_PosUVTBN> optimized;
+		optimized.reserve(vertices->size());
+		for (auto& index : *indices)
+		{
+			if (remap[index] == unused)
+			{
+				remap[index] = (unsigned int)optimized.size();
+				optimized.emplace_back((*vertices)[index]);
+			}
+			index = remap[index];
+		}
+
+		*vertices = move(optimized);
+	}
 }
@@ -37,5 +37,18 @@ namespace Directus
 		static void CreateSphere(std::vector<RHI_Vertex_PosUVTBN>* vertices, std::vector<unsigned int>* indices, float radius = 1.0f, int slices = 15, int stacks = 15);
 		static void CreateCylinder(std::vector<RHI_Vertex_PosUVTBN>* vertices, std::vector<unsigned int>* indices, float radiusTop = 1.0f, float radiusBottom = 1.0f, float height = 1.0f, int slices = 15, int stacks = 15);
 		static void CreateCone(std::vector<RHI_Vertex_PosUVTBN>* vertices, std::vector<unsigned int>* indices, float radius = 1.0f, float height = 2.0f);
+		// Simplifies geometry by clustering its vertices into a grid (cells per axis), the simplified indices reference the same vertices
+		static void Simplify(const std::vector<RHI_Vertex_PosUVTBN>& vertices, const std::vector<unsigned int>& indices, unsigned int cells, std::vector<unsigned int>* indicesSimplified);
+
+		//= OPTIMIZATION ===============================================================================================================
+		// Meant to run in this order, once at import. The geometry draws the same, only faster.
+		// Reorders triangles so that they reuse the vertices the GPU has recently transformed (post-transform cache)
+		static void OptimizeVertexCache(std::vector<unsigned int>* indices, unsigned int vertexCount);
+		// Reorders clusters of triangles (keeping most of the cache locality) so that the outward facing ones draw first and occlude the rest,
+		// a cluster is split as long as it's cache miss ratio stays within threshold times the one of the whole geometry
+		static void OptimizeOverdraw(std::vector<unsigned int>* indices, const std::vector<RHI_Vertex_PosUVTBN>& vertices, float threshold = 1.05f);
+		// Reorders vertices in the order the indices first use them (pre-transform cache/memory locality), unused vertices are dropped
+		static void OptimizeVertexFetch(std::vector<RHI_Vertex_PosUVTBN>* vertices, std::vector<unsigned int>* indices);
+		//==============================================================================================================================
 	};
 }
\ No newline at end of file
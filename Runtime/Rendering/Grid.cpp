@@ -21,11 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =============================
 #include "Grid.h"
-#include "../Logging/Log.h"
 #include "../World/Components/Transform.h"
-#include "../RHI/RHI_VertexBuffer.h"
-#include "../RHI/RHI_IndexBuffer.h"
-#include "../RHI/RHI_Vertex.h"
 //========================================
 
 //= NAMESPACES ================
@@ -35,117 +31,23 @@ using namespace Directus::Math;
 
 namespace Directus
 {
-	Grid::Grid(shared_ptr<RHI_Device> rhiDevice)
+	Grid::Grid()
 	{
-		m_indexCount	= 0;
-		m_terrainHeight = 200;
-		m_terrainWidth	= 200;
-
-		vector<RHI_Vertex_PosCol> vertices;
-		vector<unsigned> indices;
-		BuildGrid(&vertices, &indices);
-		CreateBuffers(vertices, indices, rhiDevice);
-	}
-
-	const Matrix& Grid::ComputeWorldMatrix(Transform* camera)
-	{
-		// To get the grid to feel infinite, it has to follow the camera,
-		// but only by increments of the grid's spacing size. This gives the illusion 
-		// that the grid never moves and if the grid is large enough, the user can't tell.
-		float gridSpacing = 1.0f;
-		Vector3 translation = Vector3
-		(
-			(int)(camera->GetPosition().x / gridSpacing) * gridSpacing, 
-			0.0f, 
-			(int)(camera->GetPosition().z / gridSpacing) * gridSpacing
-		);
-	
-		m_world = Matrix::CreateScale(gridSpacing) * Matrix::CreateTranslation(translation);
-
-		return m_world;
-	}
-
-	void Grid::BuildGrid(vector<RHI_Vertex_PosCol>* vertices, vector<unsigned int>* indices)
-	{
-		int halfSizeW = int(m_terrainWidth * 0.5f);
-		int halfSizeH = int(m_terrainHeight * 0.5f);
-
-		for (int j = -halfSizeH; j < halfSizeH; j++)
-		{
-			for (int i = -halfSizeW; i < halfSizeW; i++)
-			{
-				// LINE 1
-				// Upper left.
-				auto positionX = (float)i;
-				auto positionZ = (float)(j + 1);
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-
-				// Upper right.
-				positionX = (float)(i + 1);
-				positionZ = (float)(j + 1);
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-
-				// LINE 2
-				// Upper right.
-				positionX = (float)(i + 1);
-				positionZ = (float)(j + 1);
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-
-				// Bottom right.
-				positionX = (float)(i + 1);
-				positionZ = (float)j;
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-
-				// LINE 3
-				// Bottom right.
-				positionX = (float)(i + 1);
-				positionZ = (float)j;
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-
-				// Bottom left.
-				positionX = (float)i;
-				positionZ = (float)j;
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-
-				// LINE 4
-				// Bottom left.
-				positionX = (float)i;
-				positionZ = (float)j;
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-
-				// Upper left.
-				positionX = (float)i;
-				positionZ = (float)(j + 1);
-				vertices->emplace_back(Vector3(positionX, 0.0f, positionZ), Vector4(1.0f, 1.0f, 1.0f, 1.0f));
-			}
-		}
-
-		for (unsigned int i = 0; i < vertices->size(); i++)
-		{
-			indices->emplace_back(i);
-		}
-		m_indexCount = (unsigned int)indices->size();
+		m_spacing		= GRID_SPACING;
+		m_majorEvery	= GRID_MAJOR_EVERY;
+		m_fadeDistance	= GRID_FADE_DISTANCE;
 	}
 
-	bool Grid::CreateBuffers(vector<RHI_Vertex_PosCol>& vertices, vector<unsigned>& indices, shared_ptr<RHI_Device> rhiDevice)
+	Struct_Grid Grid::ComputeBuffer(Camera* camera, const Matrix& wvpOrtho)
 	{
-		m_vertexBuffer.reset();
-		m_indexBuffer.reset();
-
-		m_vertexBuffer = make_shared<RHI_VertexBuffer>(rhiDevice);
-		if (!m_vertexBuffer->Create(vertices))
-		{
-			LOG_ERROR("Grid::CreateBuffers: Failed to create vertex buffer.");
-			return false;
-		}
-
-		m_indexBuffer = make_shared<RHI_IndexBuffer>(rhiDevice);
-		if (!m_indexBuffer->Create(indices))
-		{
-			LOG_ERROR("Grid::CreateBuffers: Failed to create index buffer.");
-			return false;
-		}
-
-		return true;
+		// The shader works relative to the camera, so the view keeps only it's rotation and the
+		// pattern is offset by the camera's position wrapped to the major spacing, which stays
+		// small and precise however far the camera is from the origin.
+		Vector3 position		= camera->GetTransform()->GetPosition();
+		float majorSpacing		= m_spacing * m_majorEvery;
+		Vector2 wrapped			= Vector2(fmod(position.x, majorSpacing), fmod(position.z, majorSpacing));
+		Matrix viewProjection	= Matrix::CreateTranslation(position) * camera->GetViewMatrix() * camera->GetProjectionMatrix();
+
+		return Struct_Grid(wvpOrtho, viewProjection, position, wrapped, m_spacing, majorSpacing, m_fadeDistance, camera->IsReverseZ());
 	}
 }
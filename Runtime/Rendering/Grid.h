@@ -21,40 +21,38 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ======================
-#include <vector>
-#include <memory>
-#include "../Math/Matrix.h"
+//= INCLUDES =========================
 #include "../Core/EngineDefs.h"
-#include "../RHI/RHI_Definition.h"
-//================================
+#include "../RHI/RHI_CommonBuffers.h"
+//====================================
+
+// World units between two lines
+#define GRID_SPACING		1.0f
+// Every how many lines one is a major line
+#define GRID_MAJOR_EVERY	10
+// Distance from the camera at which the grid has faded out
+#define GRID_FADE_DISTANCE	100.0f
 
 namespace Directus
 {
-	class Context;
-	class Transform;
-
+	// The scene grid, drawn analytically over a full screen quad (Grid.hlsl),
+	// so it costs the same at any size and needs no geometry of it's own.
 	class ENGINE_CLASS Grid
 	{
 	public:
-		Grid(std::shared_ptr<RHI_Device> rhiDevice);
+		Grid();
 		~Grid(){}
-		
-		const Math::Matrix& ComputeWorldMatrix(Transform* camera);
-		
-		std::shared_ptr<RHI_IndexBuffer> GetIndexBuffer()	{ return m_indexBuffer; }
-		std::shared_ptr<RHI_VertexBuffer> GetVertexBuffer()	{ return m_vertexBuffer; }
-		unsigned int GetIndexCount()						{ return m_indexCount; }
+
+		Struct_Grid ComputeBuffer(Camera* camera, const Math::Matrix& wvpOrtho);
+
+		float GetSpacing()						{ return m_spacing; }
+		void SetSpacing(float spacing)			{ m_spacing = spacing; }
+		float GetFadeDistance()					{ return m_fadeDistance; }
+		void SetFadeDistance(float distance)	{ m_fadeDistance = distance; }
 
 	private:
-		void BuildGrid(std::vector<RHI_Vertex_PosCol>* vertices, std::vector<unsigned int>* indices);
-		bool CreateBuffers(std::vector<RHI_Vertex_PosCol>& vertices, std::vector<unsigned int>& indices, std::shared_ptr<RHI_Device> rhiDevice);
-
-		unsigned int m_indexCount;
-		unsigned int m_terrainHeight;
-		unsigned int m_terrainWidth;
-		std::shared_ptr<RHI_VertexBuffer> m_vertexBuffer;
-		std::shared_ptr<RHI_IndexBuffer> m_indexBuffer;
-		Math::Matrix m_world;
+		float m_spacing;
+		unsigned int m_majorEvery;
+		float m_fadeDistance;
 	};
-}
\ No newline at end of file
+}
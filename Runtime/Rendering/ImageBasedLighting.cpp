@@ -0,0 +1,453 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "ImageBasedLighting.h"
+#include <cmath>
+#include "../RHI/RHI_Texture.h"
+#include "../IO/FileStream.h"
+#include "../FileSystem/FileSystem.h"
+#include "../Math/MathHelper.h"
+#include "../Logging/Log.h"
+//=====================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace _ImageBasedLighting
+{
+	using namespace Directus::Math;
+
+	// Cubemap face order, u and v in [-1, 1]
+	inline Vector3 FaceToDirection(unsigned int face, float u, float v)
+	{
+		switch (face)
+		{
+			case 0:		return Vector3(1.0f, -v, -u);
+			case 1:		return Vector3(-1.0f, -v, u);
+			case 2:		return Vector3(u, 1.0f, v);
+			case 3:		return Vector3(u, -1.0f, -v);
+			case 4:		return Vector3(u, -v, 1.0f);
+			default:	return Vector3(-u, -v, -1.0f);
+		}
+	}
+
+	inline unsigned int DirectionToFace(const Vector3& d, float* u, float* v)
+	{
+		float ax = fabsf(d.x);
+		float ay = fabsf(d.y);
+		float az = fabsf(d.z);
+
+		if (ax >= ay && ax >= az)
+		{
+			*u = (d.x > 0.0f ? -d.z : d.z) / ax;
+			*v = -d.y / ax;
+			return d.x > 0.0f ? 0 : 1;
+		}
+
+		if (ay >= az)
+		{
+			*u = d.x / ay;
+			*v = (d.y > 0.0f ? d.z : -d.z) / ay;
+			return d.y > 0.0f ? 2 : 3;
+		}
+
+		*u = (d.z > 0.0f ? d.x : -d.x) / az;
+		*v = -d.y / az;
+		return d.z > 0.0f ? 4 : 5;
+	}
+
+	inline float RadicalInverse(unsigned int bits)
+	{
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+		return float(bits) * 2.3283064365386963e-10f;
+	}
+
+	// The shaders expect gamma encoded texels, same as the skybox they replace
+	inline std::byte Encode(float value)
+	{
+		return (std::byte)(unsigned char)(Directus::Math::Helper::Clamp(powf(value, 1.0f / 2.2f), 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+namespace Directus
+{
+	ImageBasedLighting::ImageBasedLighting(Context* context)
+	{
+		m_context			= context;
+		m_specularTexture	= make_shared<RHI_Texture>(context);
+		m_specularSize		= 0;
+		m_specularMipCount	= 0;
+		m_isReady			= false;
+	}
+
+	bool ImageBasedLighting::Generate(const vector<vector<std::byte>>& sides, unsigned int size, const string& cacheFilePath, bool reuseCache /*= true*/)
+	{
+		if (sides.size() != 6 || size == 0)
+		{
+			LOG_ERROR("ImageBasedLighting::Generate: Expected six sides.");
+			return false;
+		}
+
+		if (!reuseCache || !LoadFromCache(cacheFilePath, size))
+		{
+			Downsample(sides, size);
+			PrefilterSpecular();
+			ProjectIrradiance();
+			m_source.clear();
+			m_source.shrink_to_fit();
+			if (!cacheFilePath.empty())
+			{
+				SaveToCache(cacheFilePath, size);
+				LOGF_INFO("ImageBasedLighting::Generate: Prefiltered %dx%d environment, cached to \"%s\".", m_specularSize, m_specularSize, cacheFilePath.c_str());
+			}
+		}
+
+		if (!CreateTexture())
+			return false;
+
+		m_isReady = true;
+		return true;
+	}
+
+	bool ImageBasedLighting::Load(const string& cacheFilePath, unsigned int size)
+	{
+		if (!LoadFromCache(cacheFilePath, size) || !CreateTexture())
+			return false;
+
+		m_isReady = true;
+		return true;
+	}
+
+	void ImageBasedLighting::Downsample(const vector<vector<std::byte>>& sides, unsigned int size)
+	{
+		float toLinear[256];
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			toLinear[i] = powf(i / 255.0f, 2.2f);
+		}
+
+		m_specularSize		= Helper::Min(size, (unsigned int)IBL_SPECULAR_SIZE);
+		m_specularMipCount	= (unsigned int)log2f((float)m_specularSize) + 1;
+
+		// Box filter the source down to the most detailed mip
+		unsigned int step	= size / m_specularSize;
+		float weight		= 1.0f / (step * step);
+		m_source.clear();
+		m_source.emplace_back(Level(6, Face(m_specularSize * m_specularSize)));
+		for (unsigned int face = 0; face < 6; face++)
+		{
+			const auto& side = sides[face];
+			if (side.size() < size * size * 4)
+				continue;
+
+			for (unsigned int y = 0; y < m_specularSize; y++)
+			{
+				for (unsigned int x = 0; x < m_specularSize; x++)
+				{
+					Vector3 color = Vector3::Zero;
+					for (unsigned int sy = 0; sy < step; sy++)
+					{
+						for (unsigned int sx = 0; sx < step; sx++)
+						{
+							auto texel = &side[((y * step + sy) * size + (x * step + sx)) * 4];
+							color += Vector3(toLinear[(unsigned char)texel[0]], toLinear[(unsigned char)texel[1]], toLinear[(unsigned char)texel[2]]);
+						}
+					}
+					m_source[0][face][y * m_specularSize + x] = color * weight;
+				}
+			}
+		}
+
+		// Box filter the rest of the chain, prefiltering samples it by solid angle
+		for (unsigned int level = 1, levelSize = m_specularSize / 2; levelSize >= 1; level++, levelSize /= 2)
+		{
+			unsigned int parentSize = levelSize * 2;
+			m_source.emplace_back(Level(6, Face(levelSize * levelSize)));
+			for (unsigned int face = 0; face < 6; face++)
+			{
+				const Face& parent	= m_source[level - 1][face];
+				Face& child			= m_source[level][face];
+				for (unsigned int y = 0; y < levelSize; y++)
+				{
+					for (unsigned int x = 0; x < levelSize; x++)
+					{
+						unsigned int i	= (y * 2) * parentSize + x * 2;
+						child[y * levelSize + x] = (parent[i] + parent[i + 1] + parent[i + parentSize] + parent[i + parentSize + 1]) * 0.25f;
+					}
+				}
+			}
+		}
+	}
+
+	void ImageBasedLighting::PrefilterSpecular()
+	{
+		struct SampleDirection
+		{
+			Vector3 tangent; // around +Z
+			float NdotL;
+			float lod;
+		};
+
+		float texelSolidAngle = 4.0f * PI / (6.0f * m_specularSize * m_specularSize);
+
+		m_specularData.assign(6, vector<vector<std::byte>>(m_specularMipCount));
+		for (unsigned int mip = 0; mip < m_specularMipCount; mip++)
+		{
+			unsigned int mipSize	= Helper::Max(m_specularSize >> mip, 1u);
+			float roughness			= m_specularMipCount > 1 ? mip / float(m_specularMipCount - 1) : 0.0f;
+			float a					= roughness * roughness;
+			float a2				= a * a;
+
+			// Importance sample GGX with N = V = R, the same set is rotated to every texel
+			vector<SampleDirection> directions;
+			if (mip == 0)
+			{
+				directions.emplace_back(SampleDirection{ Vector3(0.0f, 0.0f, 1.0f), 1.0f, 0.0f });
+			}
+			else
+			{
+				for (unsigned int i = 0; i < IBL_SPECULAR_SAMPLES; i++)
+				{
+					float phi		= PI_2 * i / float(IBL_SPECULAR_SAMPLES);
+					float xi		= _ImageBasedLighting::RadicalInverse(i);
+					float cosTheta	= sqrtf((1.0f - xi) / (1.0f + (a2 - 1.0f) * xi));
+					float sinTheta	= sqrtf(1.0f - cosTheta * cosTheta);
+					Vector3 h		= Vector3(sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta);
+					Vector3 l		= h * (2.0f * h.z) - Vector3(0.0f, 0.0f, 1.0f);
+					if (l.z <= 0.0f)
+						continue;
+
+					// Sample a mip whose texels cover the sample's solid angle, this keeps the low sample count free of fireflies
+					float d				= cosTheta * cosTheta * (a2 - 1.0f) + 1.0f;
+					float pdf			= a2 / (PI * d * d) * 0.25f;
+					float sampleAngle	= 1.0f / (IBL_SPECULAR_SAMPLES * pdf + 0.0001f);
+					float lod			= Helper::Max(0.5f * log2f(sampleAngle / texelSolidAngle) + 1.0f, 0.0f);
+					directions.emplace_back(SampleDirection{ l, l.z, lod });
+				}
+			}
+
+			for (unsigned int face = 0; face < 6; face++)
+			{
+				auto& data = m_specularData[face][mip];
+				data.resize(mipSize * mipSize * 4);
+				for (unsigned int y = 0; y < mipSize; y++)
+				{
+					for (unsigned int x = 0; x < mipSize; x++)
+					{
+						float u			= (x + 0.5f) / mipSize * 2.0f - 1.0f;
+						float v			= (y + 0.5f) / mipSize * 2.0f - 1.0f;
+						Vector3 n		= _ImageBasedLighting::FaceToDirection(face, u, v).Normalized();
+						Vector3 up		= fabsf(n.z) < 0.999f ? Vector3(0.0f, 0.0f, 1.0f) : Vector3(1.0f, 0.0f, 0.0f);
+						Vector3 tangentX = Vector3::Cross(up, n).Normalized();
+						Vector3 tangentY = Vector3::Cross(n, tangentX);
+
+						Vector3 color	= Vector3::Zero;
+						float weight	= 0.0f;
+						for (const auto& direction : directions)
+						{
+							Vector3 l = tangentX * direction.tangent.x + tangentY * direction.tangent.y + n * direction.tangent.z;
+							color	+= Sample(l, direction.lod) * direction.NdotL;
+							weight	+= direction.NdotL;
+						}
+						color = color * (1.0f / Helper::Max(weight, 0.0001f));
+
+						auto texel	= &data[(y * mipSize + x) * 4];
+						texel[0]	= _ImageBasedLighting::Encode(color.x);
+						texel[1]	= _ImageBasedLighting::Encode(color.y);
+						texel[2]	= _ImageBasedLighting::Encode(color.z);
+						texel[3]	= (std::byte)255;
+					}
+				}
+			}
+		}
+	}
+
+	void ImageBasedLighting::ProjectIrradiance()
+	{
+		// Project the radiance onto the first three SH bands
+		unsigned int levelSize	= Helper::Min(m_specularSize, (unsigned int)IBL_IRRADIANCE_SIZE);
+		unsigned int level		= (unsigned int)log2f(float(m_specularSize / levelSize));
+		Vector3 sh[9];
+		for (auto& coefficient : sh) { coefficient = Vector3::Zero; }
+		float solidAngleSum = 0.0f;
+
+		for (unsigned int face = 0; face < 6; face++)
+		{
+			const Face& texels = m_source[level][face];
+			for (unsigned int y = 0; y < levelSize; y++)
+			{
+				for (unsigned int x = 0; x < levelSize; x++)
+				{
+					float u				= (x + 0.5f) / levelSize * 2.0f - 1.0f;
+					float v				= (y + 0.5f) / levelSize * 2.0f - 1.0f;
+					float r2			= 1.0f + u * u + v * v;
+					float solidAngle	= 4.0f / (levelSize * levelSize * r2 * sqrtf(r2));
+					Vector3 n			= _ImageBasedLighting::FaceToDirection(face, u, v).Normalized();
+					Vector3 radiance	= texels[y * levelSize + x] * solidAngle;
+
+					sh[0] += radiance * 0.282095f;
+					sh[1] += radiance * (0.488603f * n.y);
+					sh[2] += radiance * (0.488603f * n.z);
+					sh[3] += radiance * (0.488603f * n.x);
+					sh[4] += radiance * (1.092548f * n.x * n.y);
+					sh[5] += radiance * (1.092548f * n.y * n.z);
+					sh[6] += radiance * (0.315392f * (3.0f * n.z * n.z - 1.0f));
+					sh[7] += radiance * (1.092548f * n.x * n.z);
+					sh[8] += radiance * (0.546274f * (n.x * n.x - n.y * n.y));
+					solidAngleSum += solidAngle;
+				}
+			}
+		}
+
+		// Convolve with the cosine lobe [Ramamoorthi 2001] and fold in the basis constants and 1/PI,
+		// so that the shader only has to evaluate the polynomial
+		float normalization	= 4.0f * PI / solidAngleSum;
+		float band[9]		= { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+		float basis[9]		= { 0.282095f, 0.488603f, 0.488603f, 0.488603f, 1.092548f, 1.092548f, 0.315392f, 1.092548f, 0.546274f };
+		for (unsigned int i = 0; i < 9; i++)
+		{
+			m_irradianceSH[i] = Vector4(sh[i] * (normalization * band[i] * basis[i]), 0.0f);
+		}
+	}
+
+	Vector3 ImageBasedLighting::Sample(const Vector3& direction, float lod)
+	{
+		float u, v;
+		unsigned int face = _ImageBasedLighting::DirectionToFace(direction, &u, &v);
+
+		auto fetch = [this, face, u, v](unsigned int level)
+		{
+			const Face& texels	= m_source[level][face];
+			unsigned int size	= Helper::Max(m_specularSize >> level, 1u);
+			float x				= Helper::Clamp((u * 0.5f + 0.5f) * size - 0.5f, 0.0f, float(size - 1));
+			float y				= Helper::Clamp((v * 0.5f + 0.5f) * size - 0.5f, 0.0f, float(size - 1));
+			unsigned int x0		= (unsigned int)x;
+			unsigned int y0		= (unsigned int)y;
+			unsigned int x1		= Helper::Min(x0 + 1, size - 1);
+			unsigned int y1		= Helper::Min(y0 + 1, size - 1);
+			float fx			= x - x0;
+			float fy			= y - y0;
+
+			Vector3 top		= texels[y0 * size + x0] * (1.0f - fx) + texels[y0 * size + x1] * fx;
+			Vector3 bottom	= texels[y1 * size + x0] * (1.0f - fx) + texels[y1 * size + x1] * fx;
+			return top * (1.0f - fy) + bottom * fy;
+		};
+
+		lod					= Helper::Clamp(lod, 0.0f, float(m_source.size() - 1));
+		unsigned int level0	= (unsigned int)lod;
+		unsigned int level1	= Helper::Min(level0 + 1, (unsigned int)m_source.size() - 1);
+		float blend			= lod - level0;
+
+		return blend == 0.0f ? fetch(level0) : fetch(level0) * (1.0f - blend) + fetch(level1) * blend;
+	}
+
+	bool ImageBasedLighting::LoadFromCache(const string& filePath, unsigned int sourceSize)
+	{
+		if (!FileSystem::FileExists(filePath))
+			return false;
+
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Read);
+		if (!file->IsOpen())
+			return false;
+
+		// A different version or source resolution means the cache belongs to something else
+		if (file->ReadUInt() != IBL_CACHE_VERSION || file->ReadUInt() != sourceSize)
+			return false;
+
+		m_specularSize		= file->ReadUInt();
+		m_specularMipCount	= file->ReadUInt();
+		for (auto& coefficient : m_irradianceSH)
+		{
+			file->Read(&coefficient);
+		}
+
+		m_specularData.assign(6, vector<vector<std::byte>>(m_specularMipCount));
+		for (auto& face : m_specularData)
+		{
+			for (auto& mip : face)
+			{
+				file->Read(&mip);
+				if (mip.empty())
+				{
+					LOGF_WARNING("ImageBasedLighting::LoadFromCache: \"%s\" is incomplete, regenerating.", filePath.c_str());
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void ImageBasedLighting::SaveToCache(const string& filePath, unsigned int sourceSize)
+	{
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Write);
+		if (!file->IsOpen())
+		{
+			LOGF_WARNING("ImageBasedLighting::SaveToCache: Failed to write \"%s\", the environment will be prefiltered again next time.", filePath.c_str());
+			return;
+		}
+
+		file->Write((unsigned int)IBL_CACHE_VERSION);
+		file->Write(sourceSize);
+		file->Write(m_specularSize);
+		file->Write(m_specularMipCount);
+		for (const auto& coefficient : m_irradianceSH)
+		{
+			file->Write(coefficient);
+		}
+
+		for (const auto& face : m_specularData)
+		{
+			for (const auto& mip : face)
+			{
+				file->Write(mip);
+			}
+		}
+	}
+
+	bool ImageBasedLighting::CreateTexture()
+	{
+		if (!m_specularTexture->ShaderResource_CreateCubemap(m_specularSize, m_specularSize, 4, Texture_Format_R8G8B8A8_UNORM, m_specularData))
+		{
+			LOG_ERROR("ImageBasedLighting::CreateTexture: Failed to create the prefiltered cubemap.");
+			return false;
+		}
+
+		m_specularTexture->SetResourceName("Cubemap_Prefiltered");
+		m_specularTexture->SetWidth(m_specularSize);
+		m_specularTexture->SetHeight(m_specularSize);
+		m_specularTexture->SetGrayscale(false);
+
+		// The GPU has it now
+		m_specularData.clear();
+		m_specularData.shrink_to_fit();
+
+		return true;
+	}
+}
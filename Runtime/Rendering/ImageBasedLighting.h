@@ -0,0 +1,91 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include <string>
+#include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Definition.h"
+#include "../Math/Vector3.h"
+#include "../Math/Vector4.h"
+//=============================
+
+// Resolution of the most detailed prefiltered mip, the environment is downsampled to it first
+#define IBL_SPECULAR_SIZE		128
+// GGX samples per prefiltered texel
+#define IBL_SPECULAR_SAMPLES	64
+// Resolution the irradiance is projected from
+#define IBL_IRRADIANCE_SIZE		32
+// Bump when the cache layout or the filtering changes, older caches get regenerated
+#define IBL_CACHE_VERSION		1
+
+namespace Directus
+{
+	class Context;
+
+	// Pre-integrates a cubemap for image based lighting. Each mip of the specular cubemap is the environment
+	// convolved with GGX for roughness = mip / (mips - 1), so shading is a single lookup. The diffuse irradiance
+	// is projected onto 9 spherical harmonics. Both are expensive to compute, so they are cached on disk.
+	class ENGINE_CLASS ImageBasedLighting
+	{
+	public:
+		ImageBasedLighting(Context* context);
+		~ImageBasedLighting() {}
+
+		// Sides are mip 0 of a Texture_Format_R8G8B8A8_UNORM cubemap, in cubemap face order. Without reusing the cache the sides
+		// are always prefiltered (and the cache overwritten), an empty cache path doesn't cache at all.
+		bool Generate(const std::vector<std::vector<std::byte>>& sides, unsigned int size, const std::string& cacheFilePath, bool reuseCache = true);
+		// Only what an earlier Generate cached, of sides this size, returns false if there is none
+		bool Load(const std::string& cacheFilePath, unsigned int size);
+		bool IsReady() { return m_isReady; }
+
+		const std::shared_ptr<RHI_Texture>& GetSpecularTexture()	{ return m_specularTexture; }
+		unsigned int GetSpecularMipCount()							{ return m_specularMipCount; }
+		// Pre-convolved with the cosine lobe and divided by PI, rgb per coefficient
+		const Math::Vector4* GetIrradianceSH()						{ return m_irradianceSH; }
+
+	private:
+		typedef std::vector<Math::Vector3> Face;	// linear color
+		typedef std::vector<Face> Level;			// six faces
+
+		void Downsample(const std::vector<std::vector<std::byte>>& sides, unsigned int size);
+		void PrefilterSpecular();
+		void ProjectIrradiance();
+		bool LoadFromCache(const std::string& filePath, unsigned int sourceSize);
+		void SaveToCache(const std::string& filePath, unsigned int sourceSize);
+		bool CreateTexture();
+
+		Math::Vector3 Sample(const Math::Vector3& direction, float lod);
+
+		// Box filtered source chain, sampled while prefiltering
+		std::vector<Level> m_source;
+		std::vector<std::vector<std::vector<std::byte>>> m_specularData; // vector<face<mip<data>>>
+		std::shared_ptr<RHI_Texture> m_specularTexture;
+		unsigned int m_specularSize;
+		unsigned int m_specularMipCount;
+		Math::Vector4 m_irradianceSH[9];
+		bool m_isReady;
+		Context* m_context;
+	};
+}
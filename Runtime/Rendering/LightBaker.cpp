@@ -0,0 +1,460 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============================
+#include "LightBaker.h"
+#include <algorithm>
+#include <cfloat>
+#include "Material.h"
+#include "../Core/Context.h"
+#include "../Core/Stopwatch.h"
+#include "../World/World.h"
+#include "../World/Actor.h"
+#include "../World/Components/Transform.h"
+#include "../World/Components/Renderable.h"
+#include "../World/Components/Light.h"
+#include "../World/Components/Skybox.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../Math/Matrix.h"
+#include "../Math/MathHelper.h"
+#include "../Threading/Threading.h"
+#include "../Logging/Log.h"
+//==========================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+namespace _LightBaker
+{
+	using namespace Directus::Math;
+
+	inline float Axis(const Vector3& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+	inline Vector3 Min(const Vector3& a, const Vector3& b) { return Vector3(Helper::Min(a.x, b.x), Helper::Min(a.y, b.y), Helper::Min(a.z, b.z)); }
+	inline Vector3 Max(const Vector3& a, const Vector3& b) { return Vector3(Helper::Max(a.x, b.x), Helper::Max(a.y, b.y), Helper::Max(a.z, b.z)); }
+
+	// Slab test, against the closest hit so far
+	inline bool RayBox(const Vector3& origin, const Vector3& inverse, const Vector3& min, const Vector3& max, float distance)
+	{
+		float t0x = (min.x - origin.x) * inverse.x, t1x = (max.x - origin.x) * inverse.x;
+		float t0y = (min.y - origin.y) * inverse.y, t1y = (max.y - origin.y) * inverse.y;
+		float t0z = (min.z - origin.z) * inverse.z, t1z = (max.z - origin.z) * inverse.z;
+		float near	= Helper::Max(Helper::Max(Helper::Min(t0x, t1x), Helper::Min(t0y, t1y)), Helper::Max(Helper::Min(t0z, t1z), 0.0f));
+		float far	= Helper::Min(Helper::Min(Helper::Max(t0x, t1x), Helper::Max(t0y, t1y)), Helper::Min(Helper::Max(t0z, t1z), distance));
+		return near <= far;
+	}
+
+	// xorshift, seeded per probe so a bake comes out the same every time
+	inline float Random(uint32_t* state)
+	{
+		*state ^= *state << 13;
+		*state ^= *state >> 17;
+		*state ^= *state << 5;
+		return (*state >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Cosine weighted, around the normal
+	inline Vector3 Hemisphere(const Vector3& normal, uint32_t* state)
+	{
+		float u			= Random(state);
+		float v			= Random(state);
+		float radius	= sqrtf(u);
+		float phi		= PI_2 * v;
+		Vector3 tangent	= (fabsf(normal.x) > 0.9f ? Vector3::Up : Vector3::Right).Cross(normal).Normalized();
+		Vector3 bitangent = normal.Cross(tangent);
+		return (tangent * (radius * cosf(phi)) + bitangent * (radius * sinf(phi)) + normal * sqrtf(Helper::Max(1.0f - u, 0.0f))).Normalized();
+	}
+
+	// Evenly spread over the sphere (a Fibonacci spiral), every direction stands for the same solid angle
+	inline Vector3 Sphere(unsigned int index, unsigned int count)
+	{
+		float z		= 1.0f - (2.0f * index + 1.0f) / count;
+		float r		= sqrtf(Helper::Max(1.0f - z * z, 0.0f));
+		float phi	= index * 2.39996322973f; // golden angle
+		return Vector3(r * cosf(phi), r * sinf(phi), z);
+	}
+
+	inline void SH_Basis(const Vector3& n, float basis[9])
+	{
+		basis[0] = 0.282095f;
+		basis[1] = 0.488603f * n.y;
+		basis[2] = 0.488603f * n.z;
+		basis[3] = 0.488603f * n.x;
+		basis[4] = 1.092548f * n.x * n.y;
+		basis[5] = 1.092548f * n.y * n.z;
+		basis[6] = 0.315392f * (3.0f * n.z * n.z - 1.0f);
+		basis[7] = 1.092548f * n.x * n.z;
+		basis[8] = 0.546274f * (n.x * n.x - n.y * n.y);
+	}
+}
+
+namespace Directus
+{
+	LightBaker::LightBaker(Context* context)
+	{
+		m_context = context;
+		m_bounces = 0;
+		for (auto& coefficient : m_skySH) { coefficient = Vector4::Zero; }
+	}
+
+	bool LightBaker::Bake(const Vector3& min, const unsigned int count[3], float spacing, unsigned int rays, unsigned int bounces, vector<Vector3>* coefficients)
+	{
+		auto world		= m_context->GetSubsystem<World>();
+		auto threading	= m_context->GetSubsystem<Threading>();
+		if (!world || !threading || !coefficients || rays == 0)
+			return false;
+
+		Stopwatch timer;
+		m_bounces = bounces;
+		Scene_Gather(world->Actors_GetAll());
+		if (m_triangles.empty())
+		{
+			LOG_WARNING("LightBaker::Bake: There is no static geometry to bake");
+			return false;
+		}
+		m_nodes.clear();
+		m_nodes.reserve(2 * m_triangles.size() / LIGHT_BAKER_LEAF_SIZE + 1);
+		Bvh_Build(0, (unsigned int)m_triangles.size());
+
+		// The same directions for every probe, a direction's SH basis is computed once
+		vector<Vector3> directions(rays);
+		vector<float> basis(rays * 9);
+		for (unsigned int i = 0; i < rays; i++)
+		{
+			directions[i] = _LightBaker::Sphere(i, rays);
+			_LightBaker::SH_Basis(directions[i], &basis[i * 9]);
+		}
+
+		// Convolve with the cosine lobe and fold in the basis constants and 1/PI, like ImageBasedLighting::ProjectIrradiance()
+		const float band[9]		= { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+		const float constant[9]	= { 0.282095f, 0.488603f, 0.488603f, 0.488603f, 1.092548f, 1.092548f, 0.315392f, 1.092548f, 0.546274f };
+		float solidAngle		= 4.0f * PI / rays;
+
+		unsigned int probeCount = count[0] * count[1] * count[2];
+		coefficients->assign(probeCount * 9, Vector3::Zero);
+		threading->Parallel_For(0, probeCount, 1, [&](unsigned int start, unsigned int end)
+		{
+			for (unsigned int probe = start; probe < end; probe++)
+			{
+				unsigned int x		= probe % count[0];
+				unsigned int y		= (probe / count[0]) % count[1];
+				unsigned int z		= probe / (count[0] * count[1]);
+				Vector3 position	= min + Vector3((float)x, (float)y, (float)z) * spacing;
+				uint32_t random		= probe * 2654435761u + 1u;
+
+				Vector3 sh[9];
+				for (auto& coefficient : sh) { coefficient = Vector3::Zero; }
+				for (unsigned int i = 0; i < rays; i++)
+				{
+					Vector3 radiance = Radiance(position, directions[i], &random);
+					for (unsigned int j = 0; j < 9; j++)
+					{
+						sh[j] += radiance * basis[i * 9 + j];
+					}
+				}
+
+				for (unsigned int j = 0; j < 9; j++)
+				{
+					(*coefficients)[probe * 9 + j] = sh[j] * (solidAngle * band[j] * constant[j]);
+				}
+			}
+		});
+
+		LOGF_INFO("LightBaker::Bake: Baked %d probes against %d triangles in %.2f sec", probeCount, (int)m_triangles.size(), timer.GetElapsedTimeSec());
+		m_triangles.clear();
+		m_nodes.clear();
+		m_emitters.clear();
+		return true;
+	}
+
+	void LightBaker::Scene_Gather(const vector<shared_ptr<Actor>>& actors)
+	{
+		m_triangles.clear();
+		m_emitters.clear();
+		for (auto& coefficient : m_skySH) { coefficient = Vector4::Zero; }
+
+		vector<unsigned int> indices;
+		vector<RHI_Vertex_PosUVTBN> vertices;
+		vector<Vector3> positions;
+		vector<Vector3> positionsWorld;
+		for (const auto& actor : actors)
+		{
+			if (!actor || !actor->IsActive())
+				continue;
+
+			// Lights count whether they are static or not, they are what the static geometry would have reflected
+			if (auto light = actor->GetComponent_PtrRaw<Light>())
+			{
+				Vector4 color = light->GetColor();
+				Emitter emitter;
+				emitter.type		= (int)light->GetLightType();
+				emitter.position	= actor->GetTransform_PtrRaw()->GetPosition();
+				emitter.direction	= light->GetDirection().Normalized();
+				emitter.color		= Vector3(color.x, color.y, color.z) * light->GetIntensity();
+				emitter.range		= light->GetRange();
+				emitter.angle		= light->GetAngle();
+				m_emitters.emplace_back(emitter);
+			}
+
+			if (auto skybox = actor->GetComponent_PtrRaw<Skybox>())
+			{
+				if (auto sh = skybox->GetEnvironmentIrradianceSH())
+				{
+					for (unsigned int i = 0; i < 9; i++) { m_skySH[i] = sh[i]; }
+				}
+			}
+
+			// Only static geometry, anything that moves (or deforms) would leave it's light behind
+			auto renderable = actor->GetRenderable_PtrRaw();
+			if (!actor->IsStatic() || !renderable || !renderable->Geometry_Model() || renderable->Geometry_IsSkinned())
+				continue;
+
+			renderable->Geometry_Get(&indices, &vertices);
+			if (indices.empty() || vertices.empty())
+				continue;
+
+			positions.resize(vertices.size());
+			positionsWorld.resize(vertices.size());
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				positions[i] = Vector3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+			}
+			Matrix::TransformPoints(actor->GetTransform_PtrRaw()->GetWorldTransform(), positions.data(), positionsWorld.data(), positions.size());
+
+			Vector4 albedo = renderable->Material_Exists() ? renderable->Material_Ptr()->GetColorAlbedo() : Vector4::One;
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				if (indices[i] >= vertices.size() || indices[i + 1] >= vertices.size() || indices[i + 2] >= vertices.size())
+					continue;
+
+				Triangle triangle;
+				triangle.v0		= positionsWorld[indices[i]];
+				triangle.edge1	= positionsWorld[indices[i + 1]] - triangle.v0;
+				triangle.edge2	= positionsWorld[indices[i + 2]] - triangle.v0;
+				Vector3 normal	= triangle.edge1.Cross(triangle.edge2);
+				if (normal.Length() <= 0.0f)
+					continue;
+				triangle.normal	= normal.Normalized();
+				triangle.albedo	= Vector3(albedo.x, albedo.y, albedo.z);
+				m_triangles.emplace_back(triangle);
+			}
+		}
+	}
+
+	unsigned int LightBaker::Bvh_Build(unsigned int first, unsigned int count)
+	{
+		auto Centroid = [](const Triangle& triangle) { return triangle.v0 + (triangle.edge1 + triangle.edge2) / 3.0f; };
+
+		Vector3 min			= Vector3::Infinity;
+		Vector3 max			= Vector3::InfinityNeg;
+		Vector3 centroidMin	= Vector3::Infinity;
+		Vector3 centroidMax	= Vector3::InfinityNeg;
+		for (unsigned int i = first; i < first + count; i++)
+		{
+			const Triangle& triangle = m_triangles[i];
+			min			= _LightBaker::Min(min, _LightBaker::Min(triangle.v0, _LightBaker::Min(triangle.v0 + triangle.edge1, triangle.v0 + triangle.edge2)));
+			max			= _LightBaker::Max(max, _LightBaker::Max(triangle.v0, _LightBaker::Max(triangle.v0 + triangle.edge1, triangle.v0 + triangle.edge2)));
+			Vector3 c	= Centroid(triangle);
+			centroidMin	= _LightBaker::Min(centroidMin, c);
+			centroidMax	= _LightBaker::Max(centroidMax, c);
+		}
+
+		unsigned int index = (unsigned int)m_nodes.size();
+		m_nodes.emplace_back();
+		m_nodes[index].min = min;
+		m_nodes[index].max = max;
+		if (count <= LIGHT_BAKER_LEAF_SIZE)
+		{
+			m_nodes[index].first = first;
+			m_nodes[index].count = count;
+			return index;
+		}
+
+		// Split at the median centroid along the longest axis
+		Vector3 extent	= centroidMax - centroidMin;
+		int axis		= extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		unsigned int half = count / 2;
+		nth_element(m_triangles.begin() + first, m_triangles.begin() + first + half, m_triangles.begin() + first + count, [&Centroid, axis](const Triangle& a, const Triangle& b)
+		{
+			return _LightBaker::Axis(Centroid(a), axis) < _LightBaker::Axis(Centroid(b), axis);
+		});
+
+		Bvh_Build(first, half);
+		unsigned int right		= Bvh_Build(first + half, count - half);
+		m_nodes[index].first	= right;
+		return index;
+	}
+
+	bool LightBaker::Trace(const Vector3& origin, const Vector3& direction, float distance, bool any, unsigned int* triangle /*= nullptr*/, float* hitDistance /*= nullptr*/)
+	{
+		Vector3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+		unsigned int stack[LIGHT_BAKER_STACK_SIZE];
+		unsigned int depth	= 0;
+		stack[depth++]		= 0;
+		bool hit			= false;
+
+		while (depth > 0)
+		{
+			unsigned int index	= stack[--depth];
+			const Node& node	= m_nodes[index];
+			if (!_LightBaker::RayBox(origin, inverse, node.min, node.max, distance))
+				continue;
+
+			if (node.count == 0)
+			{
+				if (depth + 2 <= LIGHT_BAKER_STACK_SIZE)
+				{
+					stack[depth++] = node.first;
+					stack[depth++] = index + 1;
+				}
+				continue;
+			}
+
+			// Möller-Trumbore, both faces
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				const Triangle& t	= m_triangles[i];
+				Vector3 p			= direction.Cross(t.edge2);
+				float determinant	= t.edge1.Dot(p);
+				if (fabsf(determinant) < M_EPSILON)
+					continue;
+
+				float inverseDeterminant = 1.0f / determinant;
+				Vector3 s	= origin - t.v0;
+				float u		= s.Dot(p) * inverseDeterminant;
+				if (u < 0.0f || u > 1.0f)
+					continue;
+
+				Vector3 q	= s.Cross(t.edge1);
+				float v		= direction.Dot(q) * inverseDeterminant;
+				if (v < 0.0f || u + v > 1.0f)
+					continue;
+
+				float d = t.edge2.Dot(q) * inverseDeterminant;
+				if (d <= 0.0f || d >= distance)
+					continue;
+
+				if (any)
+					return true;
+
+				distance	= d;
+				hit			= true;
+				if (triangle) *triangle = i;
+			}
+		}
+
+		if (hit && hitDistance) *hitDistance = distance;
+		return hit;
+	}
+
+	Vector3 LightBaker::Radiance(Vector3 origin, Vector3 direction, uint32_t* random)
+	{
+		Vector3 radiance	= Vector3::Zero;
+		Vector3 throughput	= Vector3::One;
+		for (unsigned int bounce = 0; bounce <= m_bounces; bounce++)
+		{
+			unsigned int index	= 0;
+			float distance		= 0.0f;
+			if (!Trace(origin, direction, FLT_MAX, false, &index, &distance))
+			{
+				radiance += throughput * Sky(direction);
+				break;
+			}
+
+			// Facing the ray, the geometry isn't necessarily closed
+			const Triangle& triangle	= m_triangles[index];
+			Vector3 normal				= triangle.normal.Dot(direction) < 0.0f ? triangle.normal : triangle.normal * -1.0f;
+			origin						= origin + direction * distance + normal * LIGHT_BAKER_OFFSET;
+			throughput					*= triangle.albedo;
+			radiance					+= throughput * Direct(origin, normal);
+
+			// Cosine weighted, so the next bounce's light is only scaled by the albedo
+			direction = _LightBaker::Hemisphere(normal, random);
+		}
+
+		return radiance;
+	}
+
+	Vector3 LightBaker::Direct(const Vector3& position, const Vector3& normal)
+	{
+		// Lambertian, the light's attenuation is the shader's (see Light.hlsl)
+		Vector3 irradiance = Vector3::Zero;
+		for (const auto& emitter : m_emitters)
+		{
+			Vector3 toLight;
+			float distance		= FLT_MAX;
+			float attenuation	= 1.0f;
+			if (emitter.type == LightType_Directional)
+			{
+				toLight = emitter.direction * -1.0f;
+			}
+			else
+			{
+				toLight		= emitter.position - position;
+				distance	= toLight.Length();
+				if (distance >= emitter.range || distance <= 0.0f)
+					continue;
+				toLight		*= 1.0f / distance;
+				attenuation	= 1.0f - distance / emitter.range;
+
+				if (emitter.type == LightType_Spot)
+				{
+					float cutoff	= 1.0f - emitter.angle;
+					float theta		= toLight.Dot(emitter.direction * -1.0f);
+					if (theta <= cutoff)
+						continue;
+					attenuation *= Clamp((theta - cutoff) / (cutoff * 0.1f), 0.0f, 1.0f);
+				}
+				attenuation *= attenuation;
+			}
+
+			float NdotL = normal.Dot(toLight);
+			if (NdotL <= 0.0f || attenuation <= 0.0f)
+				continue;
+
+			if (Trace(position, toLight, distance, true))
+				continue;
+
+			irradiance += emitter.color * (NdotL * attenuation);
+		}
+
+		return irradiance * PI_INV;
+	}
+
+	Vector3 LightBaker::Sky(const Vector3& direction)
+	{
+		// The environment's irradiance is already divided by PI, for a sky this low frequency it's the radiance
+		float basis[9];
+		_LightBaker::SH_Basis(direction, basis);
+		const float constant[9] = { 0.282095f, 0.488603f, 0.488603f, 0.488603f, 1.092548f, 1.092548f, 0.315392f, 1.092548f, 0.546274f };
+
+		Vector3 radiance = Vector3::Zero;
+		for (unsigned int i = 0; i < 9; i++)
+		{
+			radiance += Vector3(m_skySH[i].x, m_skySH[i].y, m_skySH[i].z) * (basis[i] / constant[i]);
+		}
+
+		return Vector3(Helper::Max(radiance.x, 0.0f), Helper::Max(radiance.y, 0.0f), Helper::Max(radiance.z, 0.0f));
+	}
+}
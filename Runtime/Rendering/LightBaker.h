@@ -0,0 +1,100 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ================
+#include <vector>
+#include <memory>
+#include "../Core/EngineDefs.h"
+#include "../Math/Vector3.h"
+#include "../Math/Vector4.h"
+//===========================
+
+#define LIGHT_BAKER_LEAF_SIZE	4		// triangles a BVH leaf holds, at most
+#define LIGHT_BAKER_STACK_SIZE	64		// BVH nodes a traversal can have pending
+#define LIGHT_BAKER_OFFSET		0.001f	// how far off a surface the rays that leave it start
+
+namespace Directus
+{
+	class Context;
+	class Actor;
+
+	// Bakes irradiance probes out of the world's static geometry by path tracing on the CPU, on every worker thread.
+	// A ray that hits a surface gathers what the directional, point and spot lights reflect off it (shadowed by the
+	// static geometry) and keeps bouncing off it's albedo, a ray that escapes sees the sky. What a probe's rays bring
+	// back is projected onto 9 spherical harmonics and convolved like the environment's (see ImageBasedLighting), so
+	// a probe replaces the environment's irradiance as is. Materials only contribute their albedo color, not their
+	// textures, and a probe buried in geometry only sees back faces, so it reads black.
+	class ENGINE_CLASS LightBaker
+	{
+	public:
+		LightBaker(Context* context);
+		~LightBaker() {}
+
+		// Probes are spaced evenly from min, x varies fastest. Fills in 9 coefficients per probe, false if there's no static geometry.
+		bool Bake(const Math::Vector3& min, const unsigned int count[3], float spacing, unsigned int rays, unsigned int bounces, std::vector<Math::Vector3>* coefficients);
+
+	private:
+		struct Triangle
+		{
+			Math::Vector3 v0;
+			Math::Vector3 edge1;
+			Math::Vector3 edge2;
+			Math::Vector3 normal;
+			Math::Vector3 albedo;
+		};
+
+		// A leaf has a count, otherwise the left child follows it's parent and first is the right one
+		struct Node
+		{
+			Math::Vector3 min;
+			Math::Vector3 max;
+			unsigned int first = 0;
+			unsigned int count = 0;
+		};
+
+		struct Emitter
+		{
+			int type;
+			Math::Vector3 position;
+			Math::Vector3 direction;
+			Math::Vector3 color; // premultiplied by the intensity
+			float range;
+			float angle;
+		};
+
+		void Scene_Gather(const std::vector<std::shared_ptr<Actor>>& actors);
+		unsigned int Bvh_Build(unsigned int first, unsigned int count);
+		// The closest hit, or any hit (for shadows) closer than the distance
+		bool Trace(const Math::Vector3& origin, const Math::Vector3& direction, float distance, bool any, unsigned int* triangle = nullptr, float* hitDistance = nullptr);
+		Math::Vector3 Radiance(Math::Vector3 origin, Math::Vector3 direction, uint32_t* random);
+		Math::Vector3 Direct(const Math::Vector3& position, const Math::Vector3& normal);
+		Math::Vector3 Sky(const Math::Vector3& direction);
+
+		std::vector<Triangle> m_triangles;
+		std::vector<Node> m_nodes;
+		std::vector<Emitter> m_emitters;
+		Math::Vector4 m_skySH[9];
+		unsigned int m_bounces;
+		Context* m_context;
+	};
+}
@@ -21,12 +21,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ===========================
 #include "Material.h"
+#include <string_view>
+#include <cstring>
 #include "Renderer.h"
 #include "Deferred/ShaderVariation.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../Resource/ResourceManager.h"
-#include "../IO/XmlDocument.h"
+#include "../IO/BinaryDocument.h"
 #include "../RHI/RHI_Texture.h"
+#include "../RHI/RHI_ConstantBuffer.h"
+#include "../Core/EventSystem.h"
+#include "../IO/FileStream.h"
+#include "../Core/Settings.h"
 //======================================
 
 //= NAMESPACES ================
@@ -34,6 +40,25 @@ using namespace std;
 using namespace Directus::Math;
 //=============================
 
+namespace _Material
+{
+	// Has to match PerMaterialBuffer in GBuffer.hlsl
+	struct ConstantBufferType
+	{
+		Vector4 albedo;
+		Vector2 tilingUV;
+		Vector2 offsetUV;
+		float roughnessMul;
+		float metallicMul;
+		float normalMul;
+		float heightMul;
+		float shadingMode;
+		unsigned int textureArrays;
+		Vector2 padding;
+		unsigned int textureSlices[MATERIAL_GBUFFER_TEXTURES];
+	};
+}
+
 namespace Directus
 {
 	static const char* textureTypeChar[] =
@@ -64,7 +89,8 @@ namespace Directus
 		m_uvTiling				= Vector2(1.0f, 1.0f);
 		m_uvOffset				= Vector2(0.0f, 0.0f);
 		m_isEditable			= true;
-		m_rhiDevice				= context->GetSubsystem<Renderer>()->GetRHIDevice();
+		auto renderer			= context->GetSubsystem<Renderer>();
+		m_rhiDevice				= renderer ? renderer->GetRHIDevice() : nullptr;
 
 		AcquireShader();
 	}
@@ -81,40 +107,49 @@ namespace Directus
 		// Make sure the path is relative
 		SetResourceFilePath(FileSystem::GetRelativeFilePath(filePath));
 
-		auto xml = make_unique<XmlDocument>();
-		if (!xml->Load(GetResourceFilePath()))
+		// Binary, or XML if it was saved as such (see Settings::MetadataXml_Set)
+		auto document = make_unique<BinaryDocument>();
+		if (!document->Load(GetResourceFilePath()))
 			return false;
 
-		SetResourceName(xml->GetAttributeAs<string>("Material", "Name"));
-		SetResourceFilePath(xml->GetAttributeAs<string>("Material", "Path"));
-		xml->GetAttribute("Material", "Model_ID",				&m_modelID);
-		xml->GetAttribute("Material", "Roughness_Multiplier",	&m_roughnessMultiplier);
-		xml->GetAttribute("Material", "Metallic_Multiplier",	&m_metallicMultiplier);
-		xml->GetAttribute("Material", "Normal_Multiplier",		&m_normalMultiplier);
-		xml->GetAttribute("Material", "Height_Multiplier",		&m_heightMultiplier);
-		xml->GetAttribute("Material", "IsEditable",				&m_isEditable);
-		xml->GetAttribute("Material", "Cull_Mode",				(unsigned int*)&m_cullMode);
-		xml->GetAttribute("Material", "Shading_Mode",			(unsigned int*)&m_shadingMode);
-		xml->GetAttribute("Material", "Color",					&m_colorAlbedo);
-		xml->GetAttribute("Material", "UV_Tiling",				&m_uvTiling);
-		xml->GetAttribute("Material", "UV_Offset",				&m_uvOffset);
-
-		auto textureCount = xml->GetAttributeAs<int>("Textures", "Count");
+		SetResourceName(document->GetAttributeAs<string>("Material", "Name"));
+		SetResourceFilePath(document->GetAttributeAs<string>("Material", "Path"));
+		document->GetAttribute("Material", "Model_ID",				&m_modelID);
+		document->GetAttribute("Material", "Roughness_Multiplier",	&m_roughnessMultiplier);
+		document->GetAttribute("Material", "Metallic_Multiplier",	&m_metallicMultiplier);
+		document->GetAttribute("Material", "Normal_Multiplier",		&m_normalMultiplier);
+		document->GetAttribute("Material", "Height_Multiplier",		&m_heightMultiplier);
+		document->GetAttribute("Material", "IsEditable",				&m_isEditable);
+		document->GetAttribute("Material", "Cull_Mode",				(unsigned int*)&m_cullMode);
+		document->GetAttribute("Material", "Shading_Mode",			(unsigned int*)&m_shadingMode);
+		document->GetAttribute("Material", "Color",					&m_colorAlbedo);
+		document->GetAttribute("Material", "UV_Tiling",				&m_uvTiling);
+		document->GetAttribute("Material", "UV_Offset",				&m_uvOffset);
+		m_constantBufferDirty = true;
+
+		// The textures that aren't loaded yet all load in parallel
+		auto resourceManager	= m_context->GetSubsystem<ResourceManager>();
+		auto textureCount		= document->GetAttributeAs<int>("Textures", "Count");
+		vector<pair<TextureType, shared_future<shared_ptr<RHI_Texture>>>> textures;
 		for (int i = 0; i < textureCount; i++)
 		{
 			string nodeName		= "Texture_" + to_string(i);
-			TextureType texType	= (TextureType)xml->GetAttributeAs<unsigned int>(nodeName, "Texture_Type");
-			auto texName		= xml->GetAttributeAs<string>(nodeName, "Texture_Name");
-			auto texPath		= xml->GetAttributeAs<string>(nodeName, "Texture_Path");
+			TextureType texType	= (TextureType)document->GetAttributeAs<unsigned int>(nodeName, "Texture_Type");
+			auto texName		= document->GetAttributeAs<string>(nodeName, "Texture_Name");
+			auto texPath		= document->GetAttributeAs<string>(nodeName, "Texture_Path");
 
 			// If the texture happens to be loaded, get a reference to it
-			auto texture = m_context->GetSubsystem<ResourceManager>()->GetResourceByName<RHI_Texture>(texName);
-			// If there is not texture (it's not loaded yet), load it
-			if (!texture)
+			if (auto texture = resourceManager->GetResourceByName<RHI_Texture>(texName))
 			{
-				texture = m_context->GetSubsystem<ResourceManager>()->Load<RHI_Texture>(texPath);
+				SetTextureSlot(texType, texture);
+				continue;
 			}
-			SetTextureSlot(texType, texture);
+			textures.emplace_back(texType, resourceManager->LoadAsync<RHI_Texture>(texPath));
+		}
+
+		for (const auto& texture : textures)
+		{
+			SetTextureSlot(texture.first, resourceManager->Wait(texture.second));
 		}
 
 		AcquireShader();
@@ -133,36 +168,73 @@ namespace Directus
 			SetResourceFilePath(GetResourceFilePath() + EXTENSION_MATERIAL);
 		}
 
-		auto xml = make_unique<XmlDocument>();
-		xml->AddNode("Material");
-		xml->AddAttribute("Material", "Name",					GetResourceName());
-		xml->AddAttribute("Material", "Path",					GetResourceFilePath());
-		xml->AddAttribute("Material", "Model_ID",				m_modelID);
-		xml->AddAttribute("Material", "Cull_Mode",				unsigned int(m_cullMode));	
-		xml->AddAttribute("Material", "Shading_Mode",			unsigned int(m_shadingMode));
-		xml->AddAttribute("Material", "Color",					m_colorAlbedo);
-		xml->AddAttribute("Material", "Roughness_Multiplier",	m_roughnessMultiplier);
-		xml->AddAttribute("Material", "Metallic_Multiplier",	m_metallicMultiplier);
-		xml->AddAttribute("Material", "Normal_Multiplier",		m_normalMultiplier);
-		xml->AddAttribute("Material", "Height_Multiplier",		m_heightMultiplier);
-		xml->AddAttribute("Material", "UV_Tiling",				m_uvTiling);
-		xml->AddAttribute("Material", "UV_Offset",				m_uvOffset);
-		xml->AddAttribute("Material", "IsEditable",				m_isEditable);
-
-		xml->AddChildNode("Material", "Textures");
-		xml->AddAttribute("Textures", "Count", (unsigned int)m_textureSlots.size());
+		auto document = make_unique<BinaryDocument>();
+		document->AddNode("Material");
+		document->AddAttribute("Material", "Name",					GetResourceName());
+		document->AddAttribute("Material", "Path",					GetResourceFilePath());
+		document->AddAttribute("Material", "Model_ID",				m_modelID);
+		document->AddAttribute("Material", "Cull_Mode",				unsigned int(m_cullMode));	
+		document->AddAttribute("Material", "Shading_Mode",			unsigned int(m_shadingMode));
+		document->AddAttribute("Material", "Color",					m_colorAlbedo);
+		document->AddAttribute("Material", "Roughness_Multiplier",	m_roughnessMultiplier);
+		document->AddAttribute("Material", "Metallic_Multiplier",	m_metallicMultiplier);
+		document->AddAttribute("Material", "Normal_Multiplier",		m_normalMultiplier);
+		document->AddAttribute("Material", "Height_Multiplier",		m_heightMultiplier);
+		document->AddAttribute("Material", "UV_Tiling",				m_uvTiling);
+		document->AddAttribute("Material", "UV_Offset",				m_uvOffset);
+		document->AddAttribute("Material", "IsEditable",				m_isEditable);
+
+		document->AddChildNode("Material", "Textures");
+		document->AddAttribute("Textures", "Count", (unsigned int)m_textureSlots.size());
 		int i = 0;
 		for (const auto& textureSlot : m_textureSlots)
 		{
 			string texNode = "Texture_" + to_string(i);
-			xml->AddChildNode("Textures", texNode);
-			xml->AddAttribute(texNode, "Texture_Type", (unsigned int)textureSlot.type);
-			xml->AddAttribute(texNode, "Texture_Name", !textureSlot.ptr_weak.expired() ? textureSlot.ptr_raw->GetResourceName() : NOT_ASSIGNED);
-			xml->AddAttribute(texNode, "Texture_Path", !textureSlot.ptr_weak.expired() ? textureSlot.ptr_raw->GetResourceFilePath() : NOT_ASSIGNED);
+			document->AddChildNode("Textures", texNode);
+			document->AddAttribute(texNode, "Texture_Type", (unsigned int)textureSlot.type);
+			document->AddAttribute(texNode, "Texture_Name", !textureSlot.ptr_weak.expired() ? textureSlot.ptr_raw->GetResourceName() : NOT_ASSIGNED);
+			document->AddAttribute(texNode, "Texture_Path", !textureSlot.ptr_weak.expired() ? textureSlot.ptr_raw->GetResourceFilePath() : NOT_ASSIGNED);
 			i++;
 		}
 
-		return xml->Save(GetResourceFilePath());
+		return Settings::Get().MetadataXml_Get() ? document->Save_Xml(GetResourceFilePath()) : document->Save(GetResourceFilePath());
+	}
+
+	size_t Material::Resource_GetContentHash()
+	{
+		return Hash(true);
+	}
+
+	size_t Material::Hash(bool identity)
+	{
+		// What SaveToFile() writes, hashed from memory instead of XML, the properties can be edited through references
+		vector<std::byte> data;
+		{
+			FileStream stream(&data);
+			if (identity)
+			{
+				stream.Write(GetResourceName());
+				stream.Write(GetResourceFilePath());
+				stream.Write(m_modelID);
+			}
+			stream.Write((unsigned int)m_cullMode);
+			stream.Write((unsigned int)m_shadingMode);
+			stream.Write(m_colorAlbedo);
+			stream.Write(m_roughnessMultiplier);
+			stream.Write(m_metallicMultiplier);
+			stream.Write(m_normalMultiplier);
+			stream.Write(m_heightMultiplier);
+			stream.Write(m_uvTiling);
+			stream.Write(m_uvOffset);
+			stream.Write(m_isEditable);
+			for (const auto& textureSlot : m_textureSlots)
+			{
+				stream.Write((unsigned int)textureSlot.type);
+				stream.Write(!textureSlot.ptr_weak.expired() ? textureSlot.ptr_raw->GetResourceFilePath() : NOT_ASSIGNED);
+			}
+		}
+
+		return hash<string_view>()(string_view(reinterpret_cast<const char*>(data.data()), data.size()));
 	}
 
 	unsigned int Material::GetMemoryUsage()
@@ -215,6 +287,7 @@ namespace Directus
 		{
 			if (textureSlot.type == type)
 			{
+				textureSlot.ptr_shared	= texCached;
 				textureSlot.ptr_weak	= texCached;
 				textureSlot.ptr_raw		= texCached.get();
 				replaced = true;
@@ -224,7 +297,7 @@ namespace Directus
 		// Assign - Add a new one (in case it's the first time the slot is assigned)
 		if (!replaced)
 		{
-			m_textureSlots.emplace_back(type, texCached, texCached.get());
+			m_textureSlots.emplace_back(type, texCached);
 		}
 
 		TextureBasedMultiplierAdjustment();
@@ -296,17 +369,6 @@ namespace Directus
 		m_shader = GetOrCreateShader(shaderFlags);
 	}
 
-	weak_ptr<ShaderVariation> Material::FindMatchingShader(unsigned long shaderFlags)
-	{
-		auto shaders = m_context->GetSubsystem<ResourceManager>()->GetResourcesByType<ShaderVariation>();
-		for (const auto& shader : shaders)
-		{
-			if (shader->GetShaderFlags() == shaderFlags)
-				return shader;
-		}
-		return weak_ptr<ShaderVariation>();
-	}
-
 	weak_ptr<ShaderVariation> Material::GetOrCreateShader(unsigned long shaderFlags)
 	{
 		if (!m_context)
@@ -315,18 +377,26 @@ namespace Directus
 			return weak_ptr<ShaderVariation>();
 		}
 
-		// If an appropriate shader already exists, return it's ID
-		auto existingShader = FindMatchingShader(shaderFlags);
-		if (!existingShader.expired())
-			return existingShader;
+		// Nothing to compile for without a device (headless)
+		if (!m_rhiDevice)
+			return weak_ptr<ShaderVariation>();
+
+		// Variations are cached under a name made of their flags, finding one is a lookup in the cache's name index
+		auto resourceManager	= m_context->GetSubsystem<ResourceManager>();
+		string name				= ShaderVariation::GetName(shaderFlags);
+		if (auto existing = resourceManager->GetResourceByName<ShaderVariation>(name))
+			return existing;
 
-		// Create and initialize shader
+		// Cached before it compiles, a material that asks for the same flags meanwhile (on another thread) gets the same one
 		auto shader = make_shared<ShaderVariation>(m_rhiDevice, m_context);
-		shader->Compile(m_context->GetSubsystem<ResourceManager>()->GetStandardResourceDirectory(Resource_Shader) + "GBuffer.hlsl", shaderFlags);
-		shader->SetResourceName("ShaderVariation_" + to_string(shader->Resource_GetID())); // set a different name for it's shader the cache doesn't thing they are the same
+		shader->SetResourceName(name);
+		auto cached = shader->Cache<ShaderVariation>();
+		if (cached == shader)
+		{
+			shader->Compile(resourceManager->GetStandardResourceDirectory(Resource_Shader) + "GBuffer.hlsl", shaderFlags);
+		}
 
-		// Add the shader to the pool and return it
-		return shader->Cache<ShaderVariation>();
+		return cached;
 	}
 
 	void Material::SetMultiplier(TextureType type, float value)
@@ -347,6 +417,71 @@ namespace Directus
 		{
 			m_heightMultiplier = value;
 		}
+		m_constantBufferDirty = true;
+	}
+
+	const shared_ptr<RHI_ConstantBuffer>& Material::UpdateConstantBuffer(const unsigned int* textureSlices /*= nullptr*/)
+	{
+		lock_guard<mutex> lock(m_constantBufferMutex);
+
+		if (!m_constantBuffer && m_rhiDevice)
+		{
+			auto buffer = make_shared<RHI_ConstantBuffer>(m_rhiDevice);
+			if (buffer->Create(sizeof(_Material::ConstantBufferType), 0, Buffer_PixelShader))
+			{
+				m_constantBuffer = buffer;
+			}
+		}
+
+		// Streaming can move a texture to another array, the slices are compared every time
+		bool arrays = textureSlices != nullptr;
+		if (arrays != m_constantBufferArrays || (arrays && memcmp(textureSlices, m_constantBufferSlices, sizeof(m_constantBufferSlices)) != 0))
+		{
+			m_constantBufferArrays = arrays;
+			if (arrays)
+			{
+				memcpy(m_constantBufferSlices, textureSlices, sizeof(m_constantBufferSlices));
+			}
+			m_constantBufferDirty = true;
+		}
+
+		auto commandList = m_rhiDevice ? m_rhiDevice->CommandList_GetID() : 0;
+		if (!m_constantBuffer || (!m_constantBufferDirty && commandList == m_constantBufferCommandList))
+			return m_constantBuffer;
+
+		auto buffer = (_Material::ConstantBufferType*)m_constantBuffer->Map();
+		if (!buffer)
+			return m_constantBuffer;
+
+		buffer->albedo			= m_colorAlbedo;
+		buffer->tilingUV		= m_uvTiling;
+		buffer->offsetUV		= m_uvOffset;
+		buffer->roughnessMul	= m_roughnessMultiplier;
+		buffer->metallicMul		= m_metallicMultiplier;
+		buffer->normalMul		= m_normalMultiplier;
+		buffer->heightMul		= m_heightMultiplier;
+		buffer->shadingMode		= float(m_shadingMode);
+		buffer->textureArrays	= m_constantBufferArrays ? 1 : 0;
+		buffer->padding			= Vector2::Zero;
+		memcpy(buffer->textureSlices, m_constantBufferSlices, sizeof(m_constantBufferSlices));
+		m_constantBuffer->Unmap();
+
+		m_constantBufferDirty		= false;
+		m_constantBufferCommandList	= commandList;
+		return m_constantBuffer;
+	}
+
+	void Material::SetColorAlbedo(const Vector4& color)
+	{
+		bool wasTransparent		= IsTransparent();
+		m_colorAlbedo			= color;
+		m_constantBufferDirty	= true;
+
+		// Opacity decides which render list a renderable belongs to, so let the Renderer know
+		if (wasTransparent != IsTransparent())
+		{
+			FIRE_EVENT(EVENT_MATERIAL_CHANGED);
+		}
 	}
 
 	void Material::TextureBasedMultiplierAdjustment()
@@ -24,12 +24,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <vector>
 #include <memory>
+#include <mutex>
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/Vector2.h"
 #include "../Math/Vector4.h"
 //================================
 
+// The textures the G-Buffer samples, TextureType_Albedo to TextureType_Mask
+#define MATERIAL_GBUFFER_TEXTURES 8
+
 namespace Directus
 {	
 	class ShaderPool;
@@ -58,13 +62,15 @@ namespace Directus
 			ptr_raw = nullptr;
 		}
 
-		TextureSlot(TextureType type, std::weak_ptr<RHI_Texture> ptr_weak, RHI_Texture* ptr_raw)
+		TextureSlot(TextureType type, const std::shared_ptr<RHI_Texture>& ptr)
 		{
-			this->type		= type;
-			this->ptr_weak	= ptr_weak;
-			this->ptr_raw	= ptr_raw;		
+			this->type			= type;
+			this->ptr_shared	= ptr;
+			this->ptr_weak		= ptr;
+			this->ptr_raw		= ptr.get();
 		}
 
+		std::shared_ptr<RHI_Texture> ptr_shared; // keeps the texture from being evicted from the cache while the material uses it
 		std::weak_ptr<RHI_Texture> ptr_weak;
 		RHI_Texture* ptr_raw;
 		TextureType type;
@@ -87,8 +93,13 @@ namespace Directus
 		bool LoadFromFile(const std::string& filePath) override;
 		bool SaveToFile(const std::string& filePath) override;
 		unsigned int GetMemoryUsage() override;
+		size_t Resource_GetContentHash() override;
 		//==============================================================
 
+		// A hash of what the material looks like, its name and where it's saved left out. Materials
+		// with the same one draw the same, so the model importer keeps only one of them.
+		size_t GetAppearanceHash() { return Hash(false); }
+
 		//= TEXTURE SLOTS  ===========================================================================================
 		const TextureSlot& GetTextureSlotByType(TextureType type);
 		void SetTextureSlot(TextureType type, const std::shared_ptr<RHI_Texture>& textureWeak, bool autoCache = true);	
@@ -96,17 +107,25 @@ namespace Directus
 		bool HasTexture(const std::string& path);
 		std::string GetTexturePathByType(TextureType type);
 		std::vector<std::string> GetTexturePaths();
+		const std::vector<TextureSlot>& GetTextureSlots() { return m_textureSlots; }
 		//===========================================================================================================
 
 		//= SHADER ==================================================================
 		void AcquireShader();
-		std::weak_ptr<ShaderVariation> FindMatchingShader(unsigned long shaderFlags);
+		// One variation per set of flags, shared by every material that has them
 		std::weak_ptr<ShaderVariation> GetOrCreateShader(unsigned long shaderFlags);
 		std::weak_ptr<ShaderVariation> GetShader() { return m_shader; }
 		bool HasShader() { return GetShader().expired() ? false : true; }
 		void SetMultiplier(TextureType type, float value);
 		//===========================================================================
 
+		//= CONSTANT BUFFER ====================================================================================================
+		// The properties as the G-Buffer shaders read them (PerMaterialBuffer in GBuffer.hlsl), in a buffer the material keeps.
+		// It's rewritten when they change, and once for every command list that draws with it (one can't see what was mapped before it).
+		// With slices (MATERIAL_GBUFFER_TEXTURES of them), the shader samples the textures out of arrays (see MaterialTextures).
+		const std::shared_ptr<RHI_ConstantBuffer>& UpdateConstantBuffer(const unsigned int* textureSlices = nullptr);
+		//=====================================================================================================================
+
 		//= PROPERTIES =======================================================================
 		unsigned int GetModelID()						{ return m_modelID; }
 		void SetModelID(unsigned int ID)				{ m_modelID = ID; }
@@ -114,29 +133,30 @@ namespace Directus
 		Cull_Mode GetCullMode()							{ return m_cullMode; }
 		void SetCullMode(Cull_Mode cullMode)			{ m_cullMode = cullMode; }
 
-		float& GetRoughnessMultiplier()					{ return m_roughnessMultiplier; }
-		void SetRoughnessMultiplier(float roughness)	{ m_roughnessMultiplier = roughness; }
+		float GetRoughnessMultiplier()					{ return m_roughnessMultiplier; }
+		void SetRoughnessMultiplier(float roughness)	{ m_roughnessMultiplier = roughness; m_constantBufferDirty = true; }
 
 		float GetMetallicMultiplier()					{ return m_metallicMultiplier; }
-		void SetMetallicMultiplier(float metallic)		{ m_metallicMultiplier = metallic; }
+		void SetMetallicMultiplier(float metallic)		{ m_metallicMultiplier = metallic; m_constantBufferDirty = true; }
 
 		float GetNormalMultiplier()						{ return m_normalMultiplier; }
-		void SetNormalMultiplier(float normal)			{ m_normalMultiplier = normal; }
+		void SetNormalMultiplier(float normal)			{ m_normalMultiplier = normal; m_constantBufferDirty = true; }
 
 		float GetHeightMultiplier()						{ return m_heightMultiplier; }
-		void SetHeightMultiplier(float height)			{ m_heightMultiplier = height; }
+		void SetHeightMultiplier(float height)			{ m_heightMultiplier = height; m_constantBufferDirty = true; }
 
 		ShadingMode GetShadingMode()					{ return m_shadingMode; }
-		void SetShadingMode(ShadingMode shadingMode)	{ m_shadingMode = shadingMode; }
+		void SetShadingMode(ShadingMode shadingMode)	{ m_shadingMode = shadingMode; m_constantBufferDirty = true; }
 
 		const Math::Vector4& GetColorAlbedo()			{ return m_colorAlbedo; }
-		void SetColorAlbedo(const Math::Vector4& color) { m_colorAlbedo = color; }
+		void SetColorAlbedo(const Math::Vector4& color);
+		bool IsTransparent()							{ return m_colorAlbedo.w < 1.0f; }
 
 		const Math::Vector2& GetTiling()				{ return m_uvTiling; }
-		void SetTiling(const Math::Vector2& tiling)		{ m_uvTiling = tiling; }
+		void SetTiling(const Math::Vector2& tiling)		{ m_uvTiling = tiling; m_constantBufferDirty = true; }
 
 		const Math::Vector2& GetOffset()				{ return m_uvOffset; }
-		void SetOffset(const Math::Vector2& offset)		{ m_uvOffset = offset; }
+		void SetOffset(const Math::Vector2& offset)		{ m_uvOffset = offset; m_constantBufferDirty = true; }
 
 		bool IsEditable()								{ return m_isEditable; }
 		void SetIsEditable(bool isEditable)				{ m_isEditable = isEditable; }
@@ -146,6 +166,7 @@ namespace Directus
 
 	private:
 		void TextureBasedMultiplierAdjustment();
+		size_t Hash(bool identity);
 
 		unsigned int m_modelID;	
 		Cull_Mode m_cullMode;
@@ -162,5 +183,13 @@ namespace Directus
 		std::vector<TextureSlot> m_textureSlots;
 		TextureSlot m_emptyTextureSlot;
 		std::shared_ptr<RHI_Device> m_rhiDevice;
+
+		// Constant buffer
+		std::shared_ptr<RHI_ConstantBuffer> m_constantBuffer;
+		std::atomic<bool> m_constantBufferDirty = true;
+		unsigned long long m_constantBufferCommandList = 0; // the last one it was mapped in
+		bool m_constantBufferArrays = false;
+		unsigned int m_constantBufferSlices[MATERIAL_GBUFFER_TEXTURES] = {};
+		std::mutex m_constantBufferMutex;
 	};
 }
\ No newline at end of file
@@ -51,7 +51,8 @@ namespace Directus
 
 	void Mesh::Geometry_Get(unsigned int indexOffset, unsigned int indexCount, unsigned int vertexOffset, unsigned vertexCount, vector<unsigned int>* indices, vector<RHI_Vertex_PosUVTBN>* vertices)
 	{
-		if (indexOffset == 0 || indexCount == 0 || vertexOffset == 0 || vertexCount == 0 || !vertices || !indices)
+		// The first geometry of a mesh starts at 0
+		if (indexCount == 0 || vertexCount == 0 || indexOffset + indexCount > m_indices.size() || vertexOffset + vertexCount > m_vertices.size() || !vertices || !indices)
 		{
 			LOG_ERROR("Mesh::Geometry_Get: Invalid parameters");
 			return;
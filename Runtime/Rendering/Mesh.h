@@ -51,12 +51,12 @@ namespace Directus
 		void Vertices_Append(const std::vector<RHI_Vertex_PosUVTBN>& vertices, unsigned int* vertexOffset);	
 		unsigned int Vertices_Count() const;
 		std::vector<RHI_Vertex_PosUVTBN>& Vertices_Get()						{ return m_vertices; }
-		void Vertices_Set(const std::vector<RHI_Vertex_PosUVTBN>& vertices)	{ m_vertices = vertices; }
+		void Vertices_Set(std::vector<RHI_Vertex_PosUVTBN> vertices)		{ m_vertices = std::move(vertices); }
 
 		// Indices
 		void Index_Add(unsigned int index)							{ m_indices.emplace_back(index); }
 		std::vector<unsigned int>& Indices_Get()					{ return m_indices; }
-		void Indices_Set(const std::vector<unsigned int>& indices)	{ m_indices = indices; }
+		void Indices_Set(std::vector<unsigned int> indices)			{ m_indices = std::move(indices); }
 		unsigned int Indices_Count() const							{ return (unsigned int)m_indices.size(); }
 		void Indices_Append(const std::vector<unsigned int>& indices, unsigned int* indexOffset);
 	
@@ -22,17 +22,22 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============================
 #include "Model.h"
 #include "Mesh.h"
+#include "GeometryUtility.h"
 #include "Animation.h"
 #include "Renderer.h"
 #include "Material.h"
 #include "../IO/FileStream.h"
 #include "../Core/Stopwatch.h"
+#include "../Core/Settings.h"
+#include "../Threading/Threading.h"
 #include "../World/Actor.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_VertexBuffer.h"
+#include "../RHI/RHI_Vertex.h"
 #include "../RHI/RHI_IndexBuffer.h"
+#include "../RHI/RHI_StructuredBuffer.h"
 #include "../RHI/RHI_Texture.h"
 #include "../Resource/ResourceManager.h"
 //=========================================
@@ -42,14 +47,77 @@ using namespace std;
 using namespace Directus::Math;
 //=============================
 
+#define MODEL_SKIN_BOUNDS_SAMPLES 32 // poses per animation looked at for how far it moves the bones
+
+namespace _Model
+{
+	// Normals keep two channels (z is rebuilt in the shader), color keeps its alpha, the rest is opaque data
+	Directus::Texture_Format GetTextureCompression(Directus::TextureType type)
+	{
+		switch (type)
+		{
+		case Directus::TextureType_Normal:		return Directus::Texture_Format_BC5_UNORM;
+		case Directus::TextureType_Albedo:		return Directus::Texture_Format_BC7_UNORM;
+		case Directus::TextureType_Emission:	return Directus::Texture_Format_BC7_UNORM;
+		case Directus::TextureType_Roughness:
+		case Directus::TextureType_Metallic:
+		case Directus::TextureType_Occlusion:
+		case Directus::TextureType_Height:
+		case Directus::TextureType_Mask:		return Directus::Texture_Format_BC1_UNORM;
+		default:								return Directus::Texture_Format_R8G8B8A8_UNORM;
+		}
+	}
+
+	// The mesh keeps full vertices for physics and level of detail generation, the GPU and the file get packed ones
+	vector<Directus::RHI_Vertex_PosUVTBNPacked> PackVertices(const vector<Directus::RHI_Vertex_PosUVTBN>& vertices)
+	{
+		return vector<Directus::RHI_Vertex_PosUVTBNPacked>(vertices.begin(), vertices.end());
+	}
+
+	void Matrix_Write(Directus::FileStream* file, const Matrix& matrix)
+	{
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			file->Write(matrix.Data()[i]);
+		}
+	}
+
+	void Matrix_Read(Directus::FileStream* file, Matrix* matrix)
+	{
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			file->Read(&matrix->Data()[i]);
+		}
+	}
+
+	// Every bone's position relative to the model in a pose, parents come first
+	void Bones_GetPositions(const vector<Directus::ModelBone>& bones, const Directus::AnimationPose& pose, vector<Matrix>* globals, vector<Vector3>* positions)
+	{
+		globals->resize(bones.size());
+		positions->resize(bones.size());
+		Vector3 position;
+		Quaternion rotation;
+		Vector3 scale;
+		for (unsigned int i = 0; i < (unsigned int)bones.size(); i++)
+		{
+			pose.Get(i, &position, &rotation, &scale);
+			Matrix local	= Matrix(position, rotation, scale);
+			(*globals)[i]	= bones[i].parent == -1 ? local : local * (*globals)[bones[i].parent];
+			(*positions)[i]	= (*globals)[i].GetTranslation();
+		}
+	}
+}
+
 namespace Directus
 {
 	Model::Model(Context* context) : IResource(context, Resource_Model)
 	{
 		m_normalizedScale	= 1.0f;
 		m_isAnimated		= false;
+		m_importProgressID	= g_progress_ModelImporter;
 		m_resourceManager	= m_context->GetSubsystem<ResourceManager>();
-		m_rhiDevice			= m_context->GetSubsystem<Renderer>()->GetRHIDevice();
+		auto renderer		= m_context->GetSubsystem<Renderer>();
+		m_rhiDevice			= renderer ? renderer->GetRHIDevice() : nullptr;
 		m_memoryUsage		= 0;
 		m_mesh				= make_unique<Mesh>();
 	}
@@ -88,7 +156,7 @@ namespace Directus
 		bool engineFormat = FileSystem::GetExtensionFromFilePath(modelFilePath) == EXTENSION_MODEL;
 		bool success = engineFormat ? LoadFromEngineFormat(modelFilePath) : LoadFromForeignFormat(modelFilePath);
 
-		Geometry_ComputeMemoryUsage();
+		m_memoryUsage = Geometry_ComputeMemoryUsage();
 		LOGF_INFO("Model::LoadFromFile: Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(filePath).c_str(), (int)timer.GetElapsedTimeMs());
 
 		return success;
@@ -96,15 +164,93 @@ namespace Directus
 
 	bool Model::SaveToFile(const string& filePath)
 	{
-		auto file = make_unique<FileStream>(filePath, FileStreamMode_Write);
-		if (!file->IsOpen())
+		auto mode = Settings::Get().FileCompression_Get(FileCompression_Model) ? FileStreamMode_WriteCompressed : FileStreamMode_WriteBuffered;
+		auto file = make_unique<FileStream>(filePath, mode, m_context->GetSubsystem<Threading>());
+		if (!file->IsOpen() || !Geometry_Acquire())
 			return false;
 
 		file->Write(GetResourceName());
 		file->Write(GetResourceFilePath());
 		file->Write(m_normalizedScale);
-		file->Write(m_mesh->Indices_Get());
-		file->Write(m_mesh->Vertices_Get());	
+
+		// Indices, narrowed the same way the index buffer is
+		auto indexFormat = RHI_IndexBuffer::GetFormat(m_mesh->Indices_Get());
+		file->Write((unsigned int)indexFormat);
+		if (indexFormat == Index_Format_UInt16)
+		{
+			file->Write(vector<uint16_t>(m_mesh->Indices_Get().begin(), m_mesh->Indices_Get().end()));
+		}
+		else
+		{
+			file->Write(m_mesh->Indices_Get());
+		}
+
+		file->Write(_Model::PackVertices(m_mesh->Vertices_Get()));
+
+		// Levels of detail
+		file->Write((unsigned int)m_lods.size());
+		for (const auto& geometry : m_lods)
+		{
+			file->Write(geometry.first);
+			file->Write((unsigned int)geometry.second.size());
+			for (const auto& lod : geometry.second)
+			{
+				file->Write(lod.indexOffset);
+				file->Write(lod.indexCount);
+				file->Write(lod.screenSize);
+			}
+		}
+
+		// Skinning
+		file->Write((unsigned int)m_bones.size());
+		for (const auto& bone : m_bones)
+		{
+			file->Write(bone.name);
+			file->Write(bone.parent);
+			file->Write(bone.position);
+			file->Write(bone.rotation);
+			file->Write(bone.scale);
+			_Model::Matrix_Write(file.get(), bone.offset);
+		}
+		file->Write((unsigned int)m_skins.size());
+		for (const auto& skin : m_skins)
+		{
+			file->Write(skin.first);
+			file->Write(skin.second);
+		}
+		auto weights = reinterpret_cast<const unsigned char*>(m_skinWeights.data());
+		file->Write(vector<unsigned char>(weights, weights + m_skinWeights.size() * sizeof(RHI_Vertex_Skin)));
+
+		// Animations
+		vector<shared_ptr<Animation>> animations;
+		for (const auto& animation : m_animations)
+		{
+			if (auto shared = animation.lock())
+				animations.emplace_back(shared);
+		}
+		file->Write((unsigned int)animations.size());
+		for (const auto& animation : animations)
+		{
+			animation->Serialize(file.get());
+		}
+
+		// Clusters
+		file->Write((unsigned int)m_clusters.size());
+		for (const auto& geometry : m_clusters)
+		{
+			file->Write(geometry.first);
+			file->Write((unsigned int)geometry.second.size());
+			for (const auto& cluster : geometry.second)
+			{
+				file->Write(cluster.indexOffset);
+				file->Write(cluster.indexCount);
+				file->Write(cluster.center);
+				file->Write(cluster.extents);
+				file->Write(cluster.coneApex);
+				file->Write(cluster.coneAxis);
+				file->Write(cluster.coneCutoff);
+			}
+		}
 
 		return true;
 	}
@@ -113,36 +259,403 @@ namespace Directus
 	void Model::Geometry_Append(std::vector<unsigned int>& indices, std::vector<RHI_Vertex_PosUVTBN>& vertices, unsigned int* indexOffset, unsigned int* vertexOffset)
 	{
 		// Append indices and vertices to the main mesh
+		Geometry_Acquire();
 		m_mesh->Indices_Append(indices, indexOffset);
 		m_mesh->Vertices_Append(vertices, vertexOffset);
+		Resource_MarkDirty();
 	}
 
 	void Model::Geometry_Get(unsigned int indexOffset, unsigned int indexCount, unsigned int vertexOffset, unsigned int vertexCount, vector<unsigned int>* indices, vector<RHI_Vertex_PosUVTBN>* vertices)
 	{
+		if (!Geometry_Acquire())
+			return;
+
 		m_mesh->Geometry_Get(indexOffset, indexCount, vertexOffset, vertexCount, indices, vertices);
 	}
 
+	void Model::Geometry_Release()
+	{
+		// Without a device the mesh is the only copy, and a model that isn't in a file can't read it back
+		if (!m_rhiDevice || m_geometryKeepResident || !FileSystem::FileExists(GetResourceFilePath()))
+			return;
+
+		lock_guard<mutex> lock(m_geometryMutex);
+		if (!m_geometryResident)
+			return;
+
+		m_mesh->Geometry_Clear();
+		m_geometryResident	= false;
+		m_memoryUsage		= Geometry_ComputeMemoryUsage();
+	}
+
+	void Model::Geometry_KeepResident(bool keep)
+	{
+		m_geometryKeepResident = keep;
+		if (keep)
+		{
+			Geometry_Acquire();
+		}
+	}
+
+	bool Model::Geometry_Acquire()
+	{
+		lock_guard<mutex> lock(m_geometryMutex);
+		if (m_geometryResident)
+			return true;
+
+		// Only the geometry is read, it's at the start of the file
+		auto file = make_unique<FileStream>(GetResourceFilePath(), FileStreamMode_ReadMapped);
+		if (!file->IsOpen())
+		{
+			LOGF_ERROR("Model::Geometry_Acquire: Failed to read the geometry of \"%s\" back", m_resourceName.c_str());
+			return false;
+		}
+
+		string name;
+		string filePath;
+		float normalizedScale;
+		file->Read(&name);
+		file->Read(&filePath);
+		file->Read(&normalizedScale);
+		Geometry_Read(file.get());
+
+		m_geometryResident	= true;
+		m_memoryUsage		= Geometry_ComputeMemoryUsage();
+		return true;
+	}
+
+	void Model::Geometry_Read(FileStream* file)
+	{
+		unsigned int count = 0;
+		if ((Index_Format)file->ReadUInt() == Index_Format_UInt16)
+		{
+			const uint16_t* indices = file->ReadArraySpan<uint16_t>(&count);
+			m_mesh->Indices_Set(indices ? vector<unsigned int>(indices, indices + count) : vector<unsigned int>());
+		}
+		else
+		{
+			file->Read(&m_mesh->Indices_Get());
+		}
+		const RHI_Vertex_PosUVTBNPacked* vertices = file->ReadArraySpan<RHI_Vertex_PosUVTBNPacked>(&count);
+		auto& meshVertices = m_mesh->Vertices_Get();
+		meshVertices.clear();
+		meshVertices.reserve(count);
+		for (unsigned int i = 0; vertices && i < count; i++)
+		{
+			meshVertices.emplace_back(vertices[i].Unpack());
+		}
+	}
+
+	void Model::Geometry_GenerateLods(unsigned int indexOffset, const vector<unsigned int>& indices, const vector<RHI_Vertex_PosUVTBN>& vertices)
+	{
+		vector<ModelLod> lods;
+		vector<vector<unsigned int>> lodIndices;
+		Geometry_SimplifyLods(indices, vertices, &lods, &lodIndices);
+		Geometry_AppendLods(indexOffset, move(lods), lodIndices);
+	}
+
+	void Model::Geometry_SimplifyLods(const vector<unsigned int>& indices, const vector<RHI_Vertex_PosUVTBN>& vertices, vector<ModelLod>* lods, vector<vector<unsigned int>>* lodIndices)
+	{
+		// Grid resolution and screen size of each level, coarser levels are picked as the geometry gets smaller on screen
+		static const unsigned int lodCells[MODEL_LODS_MAX - 1]	= { 64, 32, 16 };
+		static const float lodScreenSize[MODEL_LODS_MAX - 1]	= { 0.25f, 0.1f, 0.04f };
+		static const unsigned int triangleCountMin				= 64;	// below that, simplifying isn't worth it
+		static const float reductionMin							= 0.75f;	// a level has to have at most this fraction of the previous level's triangles
+
+		lods->clear();
+		lodIndices->clear();
+		auto indexCountPrevious = (unsigned int)indices.size();
+		vector<unsigned int> indicesSimplified;
+		for (unsigned int i = 0; i < MODEL_LODS_MAX - 1; i++)
+		{
+			if (indexCountPrevious / 3 < triangleCountMin)
+				break;
+
+			GeometryUtility::Simplify(vertices, indices, lodCells[i], &indicesSimplified);
+			if (indicesSimplified.empty() || indicesSimplified.size() > indexCountPrevious * reductionMin)
+				continue;
+
+			ModelLod lod;
+			lod.indexCount		= (unsigned int)indicesSimplified.size();
+			lod.screenSize		= lodScreenSize[i];
+			indexCountPrevious	= lod.indexCount;
+			lods->emplace_back(lod);
+			lodIndices->emplace_back(move(indicesSimplified));
+			indicesSimplified.clear();
+		}
+	}
+
+	void Model::Geometry_AppendLods(unsigned int indexOffset, vector<ModelLod> lods, const vector<vector<unsigned int>>& lodIndices)
+	{
+		if (lods.empty() || lods.size() != lodIndices.size())
+		{
+			m_lods.erase(indexOffset);
+			return;
+		}
+
+		Geometry_Acquire();
+		for (unsigned int i = 0; i < (unsigned int)lods.size(); i++)
+		{
+			m_mesh->Indices_Append(lodIndices[i], &lods[i].indexOffset);
+		}
+		m_lods[indexOffset] = move(lods);
+	}
+
+	const vector<ModelLod>* Model::Geometry_Lods(unsigned int indexOffset) const
+	{
+		auto it = m_lods.find(indexOffset);
+		return it != m_lods.end() ? &it->second : nullptr;
+	}
+
+	void Model::Geometry_BuildClusters(const vector<unsigned int>& indices, const vector<RHI_Vertex_PosUVTBN>& vertices, vector<ModelCluster>* clusters)
+	{
+		if (!clusters)
+			return;
+
+		clusters->clear();
+		unsigned int triangleCount = (unsigned int)indices.size() / 3;
+		if (triangleCount < MODEL_CLUSTER_TRIANGLES * MODEL_CLUSTERS_MIN)
+			return;
+
+		auto position = [&indices, &vertices](unsigned int index) { auto& pos = vertices[indices[index]].pos; return Vector3(pos[0], pos[1], pos[2]); };
+		for (unsigned int first = 0; first < triangleCount; first += MODEL_CLUSTER_TRIANGLES)
+		{
+			unsigned int last = Helper::Min(first + MODEL_CLUSTER_TRIANGLES, triangleCount);
+
+			// Bounds, and the normals' average (weighted by area) as the cone's axis
+			Vector3 boxMin	= Vector3::Infinity;
+			Vector3 boxMax	= Vector3::InfinityNeg;
+			Vector3 axis	= Vector3::Zero;
+			for (unsigned int i = first * 3; i < last * 3; i++)
+			{
+				Vector3 point	= position(i);
+				boxMin			= Vector3(Helper::Min(boxMin.x, point.x), Helper::Min(boxMin.y, point.y), Helper::Min(boxMin.z, point.z));
+				boxMax			= Vector3(Helper::Max(boxMax.x, point.x), Helper::Max(boxMax.y, point.y), Helper::Max(boxMax.z, point.z));
+			}
+			for (unsigned int i = first; i < last; i++)
+			{
+				axis += Vector3::Cross(position(i * 3 + 1) - position(i * 3), position(i * 3 + 2) - position(i * 3));
+			}
+
+			ModelCluster cluster;
+			cluster.indexOffset	= first * 3;
+			cluster.indexCount	= (last - first) * 3;
+			cluster.center		= (boxMin + boxMax) * 0.5f;
+			cluster.extents		= (boxMax - boxMin) * 0.5f;
+			cluster.coneAxis	= axis.Length() > 0.0f ? axis.Normalized() : Vector3::Up;
+			cluster.coneApex	= cluster.center;
+
+			// The spread of the normals around the axis, if they all lean towards it the apex is pushed back to where
+			// none of the triangles' planes has the center in front of it (degenerate triangles don't count)
+			float dotMin	= 1.0f;
+			float behind	= 0.0f;
+			for (unsigned int i = first; i < last; i++)
+			{
+				Vector3 normal = Vector3::Cross(position(i * 3 + 1) - position(i * 3), position(i * 3 + 2) - position(i * 3));
+				if (normal.Length() <= 0.0f)
+					continue;
+
+				normal		= normal.Normalized();
+				float dot	= Vector3::Dot(normal, cluster.coneAxis);
+				dotMin		= Helper::Min(dotMin, dot);
+				if (dot > 0.0f)
+				{
+					behind = Helper::Max(behind, Vector3::Dot(cluster.center - position(i * 3), normal) / dot);
+				}
+			}
+			if (axis.Length() > 0.0f && dotMin > 0.1f)
+			{
+				cluster.coneApex	= cluster.center - cluster.coneAxis * behind;
+				cluster.coneCutoff	= Helper::Sqrt(1.0f - dotMin * dotMin);
+			}
+
+			clusters->emplace_back(cluster);
+		}
+	}
+
+	void Model::Geometry_AppendClusters(unsigned int indexOffset, vector<ModelCluster> clusters)
+	{
+		if (clusters.empty())
+		{
+			m_clusters.erase(indexOffset);
+			return;
+		}
+
+		for (auto& cluster : clusters)
+		{
+			cluster.indexOffset += indexOffset;
+		}
+		m_clusters[indexOffset] = move(clusters);
+	}
+
+	const vector<ModelCluster>* Model::Geometry_Clusters(unsigned int indexOffset) const
+	{
+		auto it = m_clusters.find(indexOffset);
+		return it != m_clusters.end() ? &it->second : nullptr;
+	}
+
+	void Model::Skin_SetBones(const vector<ModelBone>& bones)
+	{
+		m_bones = bones;
+		Skin_MapAnimations();
+		Resource_MarkDirty();
+	}
+
+	int Model::Skin_GetBone(const string& name) const
+	{
+		for (unsigned int i = 0; i < (unsigned int)m_bones.size(); i++)
+		{
+			if (m_bones[i].name == name)
+				return (int)i;
+		}
+
+		return -1;
+	}
+
+	void Model::Skin_Append(unsigned int vertexOffset, unsigned int meshBone, const vector<RHI_Vertex_Skin>& weights)
+	{
+		if (m_skinWeights.size() < vertexOffset + weights.size())
+		{
+			m_skinWeights.resize(vertexOffset + weights.size());
+		}
+
+		copy(weights.begin(), weights.end(), m_skinWeights.begin() + vertexOffset);
+		m_skins[vertexOffset] = meshBone;
+		Resource_MarkDirty();
+	}
+
+	int Model::Skin_GetAnimation(const string& name) const
+	{
+		for (unsigned int i = 0; i < (unsigned int)m_skinAnimations.size(); i++)
+		{
+			if (m_skinAnimations[i]->GetName() == name)
+				return (int)i;
+		}
+
+		return -1;
+	}
+
+	void Model::Skin_Sample(unsigned int animation, double time, AnimationCursor* cursor, AnimationPose* pose, bool leafBones /* true */) const
+	{
+		// What the animation doesn't move stays in the bind pose
+		*pose = m_skinBindPose;
+		if (animation >= (unsigned int)m_skinAnimations.size())
+			return;
+
+		// Animations without a rate (some exporters leave it out) play at 25 ticks per second
+		const auto& anim	= m_skinAnimations[animation];
+		double ticksPerSec	= anim->GetTicksPerSec() > 0.0 ? anim->GetTicksPerSec() : 25.0;
+		double tick			= anim->GetDuration() > 0.0 ? fmod(time * ticksPerSec, anim->GetDuration()) : 0.0;
+		anim->Sample(tick, leafBones ? m_skinChannelBones[animation] : m_skinChannelBonesInner[animation], cursor, pose);
+	}
+
+	void Model::Skin_ComputePalette(unsigned int vertexOffset, const AnimationPose& pose, Matrix* palette) const
+	{
+		auto skin = m_skins.find(vertexOffset);
+		if (skin == m_skins.end() || pose.GetBoneCount() != (unsigned int)m_bones.size())
+			return;
+
+		// Every bone's pose relative to the model, parents come first so theirs is already there
+		Vector3 position;
+		Quaternion rotation;
+		Vector3 scale;
+		for (unsigned int i = 0; i < (unsigned int)m_bones.size(); i++)
+		{
+			pose.Get(i, &position, &rotation, &scale);
+			Matrix local	= Matrix(position, rotation, scale);
+			int parent		= m_bones[i].parent;
+			palette[i]		= parent == -1 ? local : local * palette[parent];
+		}
+
+		// From the bind pose to the pose, in the space of the node the geometry is placed at (its actor's)
+		Matrix meshInverse = palette[skin->second].Inverted();
+		for (unsigned int i = 0; i < (unsigned int)m_bones.size(); i++)
+		{
+			palette[i] = m_bones[i].offset * palette[i] * meshInverse;
+		}
+	}
+
+	void Model::Skin_MapAnimations()
+	{
+		m_skinBindPose.Resize((unsigned int)m_bones.size());
+		for (unsigned int i = 0; i < (unsigned int)m_bones.size(); i++)
+		{
+			m_skinBindPose.Set(i, m_bones[i].position, m_bones[i].rotation, m_bones[i].scale);
+		}
+
+		// Leaves are the bones no other bone is below
+		vector<bool> leaves(m_bones.size(), true);
+		for (const auto& bone : m_bones)
+		{
+			if (bone.parent != -1)
+			{
+				leaves[bone.parent] = false;
+			}
+		}
+
+		m_skinChannelBones.resize(m_skinAnimations.size());
+		m_skinChannelBonesInner.resize(m_skinAnimations.size());
+		for (unsigned int i = 0; i < (unsigned int)m_skinAnimations.size(); i++)
+		{
+			const auto& channels = m_skinAnimations[i]->GetChannels();
+			m_skinChannelBones[i].resize(channels.size());
+			m_skinChannelBonesInner[i].resize(channels.size());
+			for (unsigned int j = 0; j < (unsigned int)channels.size(); j++)
+			{
+				int bone						= Skin_GetBone(channels[j].name);
+				m_skinChannelBones[i][j]		= bone;
+				m_skinChannelBonesInner[i][j]	= bone != -1 && leaves[bone] ? -1 : bone;
+			}
+		}
+
+		// How far the animations take any bone from its bind pose, a look at a number of poses of each
+		vector<Matrix> globals;
+		vector<Vector3> bind;
+		vector<Vector3> positions;
+		_Model::Bones_GetPositions(m_bones, m_skinBindPose, &globals, &bind);
+		m_skinMotionRadius = 0.0f;
+		AnimationCursor cursor;
+		AnimationPose pose;
+		for (unsigned int i = 0; i < (unsigned int)m_skinAnimations.size(); i++)
+		{
+			for (unsigned int j = 0; j < MODEL_SKIN_BOUNDS_SAMPLES; j++)
+			{
+				pose = m_skinBindPose;
+				m_skinAnimations[i]->Sample(m_skinAnimations[i]->GetDuration() * j / (MODEL_SKIN_BOUNDS_SAMPLES - 1), m_skinChannelBones[i], &cursor, &pose);
+				_Model::Bones_GetPositions(m_bones, pose, &globals, &positions);
+				for (unsigned int k = 0; k < (unsigned int)m_bones.size(); k++)
+				{
+					m_skinMotionRadius = Helper::Max(m_skinMotionRadius, Vector3::Length(positions[k], bind[k]));
+				}
+			}
+		}
+	}
+
 	void Model::Geometry_Update()
 	{
+		Geometry_Acquire();
 		Geometry_CreateBuffers();
 		m_normalizedScale	= Geometry_ComputeNormalizedScale();
 		m_memoryUsage		= Geometry_ComputeMemoryUsage();
 		m_aabb				= BoundingBox(m_mesh->Vertices_Get());
 	}
 
-	void Model::AddMaterial(const shared_ptr<Material>& material, const shared_ptr<Actor>& actor, bool autoCache /* true */)
+	shared_ptr<Material> Model::AddMaterial(const shared_ptr<Material>& material, const shared_ptr<Actor>& actor, bool autoCache /* true */)
 	{
 		if (!material)
 		{
 			LOG_WARNING("Model::AddMaterial: Invalid parameters");
-			return;
+			return nullptr;
 		}
 
 		// Create a file path for this material
 		material->SetResourceFilePath(m_modelDirectoryMaterials + material->GetResourceName() + EXTENSION_MATERIAL);
 
 		// Save the material in the model directory		
-		material->SaveToFile(material->GetResourceFilePath());
+		if (material->SaveToFile(material->GetResourceFilePath()))
+		{
+			material->Resource_MarkClean();
+		}
 
 		// Cache it or use the provided reference as is
 		auto matRef = autoCache ? material->Cache<Material>() : material;
@@ -156,6 +669,8 @@ namespace Directus
 			auto renderable = actor->AddComponent<Renderable>();
 			renderable->Material_Set(matRef, false);
 		}
+
+		return matRef;
 	}
 
 	shared_ptr<Animation> Model::AddAnimation(const shared_ptr<Animation>& animation)
@@ -163,12 +678,17 @@ namespace Directus
 		if (!animation)
 			return animation;
 
-		// Add it to our resources
+		// Add it to our resources, named after the model as animations of different models often share a name ("Take 001")
+		animation->SetResourceName(GetResourceName() + "_" + animation->GetName());
 		auto sharedAnim = m_context->GetSubsystem<ResourceManager>()->Add<Animation>(animation);
 
 		// Keep a reference to it
 		m_animations.emplace_back(sharedAnim);
 
+		// Skinned geometry can play it
+		m_skinAnimations.emplace_back(sharedAnim);
+		Skin_MapAnimations();
+
 		m_isAnimated = true;
 
 		// Return it
@@ -188,32 +708,34 @@ namespace Directus
 			return;
 		}
 
+		material->SetTextureSlot(textureType, ImportTexture(textureType, filePath), false);
+	}
+
+	shared_ptr<RHI_Texture> Model::ImportTexture(TextureType textureType, const string& filePath)
+	{
 		// Try to get the texture
 		auto texName = FileSystem::GetFileNameNoExtensionFromFilePath(filePath);
 		auto texture = m_context->GetSubsystem<ResourceManager>()->GetResourceByName<RHI_Texture>(texName);
 		if (texture)
-		{
-			material->SetTextureSlot(textureType, texture, false);
-		}
+			return texture;
+
 		// If we didn't get a texture, it's not cached, hence we have to load it and cache it now
-		else if (!texture)
+		texture = make_shared<RHI_Texture>(m_context);
+		texture->SetCompression(_Model::GetTextureCompression(textureType));
+		texture->SetSRGB(textureType == TextureType_Albedo || textureType == TextureType_Emission);
+		texture->LoadFromFile(filePath);
+
+		// Update the texture with Model directory relative file path. Then save it to this directory
+		string modelRelativeTexPath = m_modelDirectoryTextures + texName + EXTENSION_TEXTURE;
+		texture->SetResourceFilePath(modelRelativeTexPath);
+		texture->SetResourceName(FileSystem::GetFileNameNoExtensionFromFilePath(modelRelativeTexPath));
+		// Once saved, the residency policy decides whether its memory is freed (there is a shader resource already)
+		if (texture->SaveToFile(modelRelativeTexPath))
 		{
-			// Load texture
-			texture = make_shared<RHI_Texture>(m_context);
-			texture->LoadFromFile(filePath);
-
-			// Update the texture with Model directory relative file path. Then save it to this directory
-			string modelRelativeTexPath = m_modelDirectoryTextures + texName + EXTENSION_TEXTURE;
-			texture->SetResourceFilePath(modelRelativeTexPath);
-			texture->SetResourceName(FileSystem::GetFileNameNoExtensionFromFilePath(modelRelativeTexPath));
-			texture->SaveToFile(modelRelativeTexPath);
-			// Now that the texture is saved, free up it's memory since we already have a shader resource
-			texture->ClearTextureBytes();
-
-			// Set the texture to the provided material
-			auto texWeak = texture->Cache<RHI_Texture>();
-			material->SetTextureSlot(textureType, texWeak, false);
+			texture->Resource_MarkClean();
 		}
+
+		return texture->Cache<RHI_Texture>();
 	}
 
 	void Model::SetWorkingDirectory(const string& directory)
@@ -232,7 +754,8 @@ namespace Directus
 	bool Model::LoadFromEngineFormat(const string& filePath)
 	{
 		// Deserialize
-		auto file = make_unique<FileStream>(filePath, FileStreamMode_Read);
+		// Mapped, the geometry is unpacked straight out of the file
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_ReadMapped);
 		if (!file->IsOpen())
 			return false;
 
@@ -241,10 +764,77 @@ namespace Directus
 		file->Read(&m_resourceName);
 		file->Read(&m_resourceFilePath);
 		file->Read(&m_normalizedScale);
-		file->Read(&m_mesh->Indices_Get());
-		file->Read(&m_mesh->Vertices_Get());
+		Geometry_Read(file.get());
+
+		// Levels of detail (models saved before they existed simply have none)
+		m_lods.clear();
+		unsigned int geometryCount = file->ReadUInt();
+		for (unsigned int i = 0; i < geometryCount; i++)
+		{
+			unsigned int indexOffset	= file->ReadUInt();
+			auto& lods					= m_lods[indexOffset];
+			lods.resize(file->ReadUInt());
+			for (auto& lod : lods)
+			{
+				file->Read(&lod.indexOffset);
+				file->Read(&lod.indexCount);
+				file->Read(&lod.screenSize);
+			}
+		}
+
+		// Skinning and animations, like levels of detail older models have none
+		m_bones.resize(file->ReadUInt());
+		for (auto& bone : m_bones)
+		{
+			file->Read(&bone.name);
+			file->Read(&bone.parent);
+			file->Read(&bone.position);
+			file->Read(&bone.rotation);
+			file->Read(&bone.scale);
+			_Model::Matrix_Read(file.get(), &bone.offset);
+		}
+		m_skins.clear();
+		unsigned int skinCount = file->ReadUInt();
+		for (unsigned int i = 0; i < skinCount; i++)
+		{
+			unsigned int vertexOffset	= file->ReadUInt();
+			m_skins[vertexOffset]		= file->ReadUInt();
+		}
+		vector<unsigned char> weights;
+		file->Read(&weights);
+		m_skinWeights.resize(weights.size() / sizeof(RHI_Vertex_Skin));
+		memcpy(m_skinWeights.data(), weights.data(), m_skinWeights.size() * sizeof(RHI_Vertex_Skin));
+		unsigned int animationCount = file->ReadUInt();
+		for (unsigned int i = 0; i < animationCount; i++)
+		{
+			auto animation = make_shared<Animation>(m_context);
+			animation->Deserialize(file.get());
+			AddAnimation(animation);
+		}
+		Skin_MapAnimations();
+
+		// Clusters, like levels of detail older models have none
+		m_clusters.clear();
+		geometryCount = file->ReadUInt();
+		for (unsigned int i = 0; i < geometryCount; i++)
+		{
+			unsigned int indexOffset	= file->ReadUInt();
+			auto& clusters				= m_clusters[indexOffset];
+			clusters.resize(file->ReadUInt());
+			for (auto& cluster : clusters)
+			{
+				file->Read(&cluster.indexOffset);
+				file->Read(&cluster.indexCount);
+				file->Read(&cluster.center);
+				file->Read(&cluster.extents);
+				file->Read(&cluster.coneApex);
+				file->Read(&cluster.coneAxis);
+				file->Read(&cluster.coneCutoff);
+			}
+		}
 
 		Geometry_Update();
+		Geometry_Release();
 
 		return true;
 	}
@@ -257,15 +847,18 @@ namespace Directus
 		SetResourceName(FileSystem::GetFileNameNoExtensionFromFilePath(filePath)); // Sponza
 
 		// Load the model
-		if (m_resourceManager->GetModelImporter()->Load(this, filePath))
+		if (m_resourceManager->GetModelImporter()->Load(this, filePath, m_importProgressID))
 		{
 			// Set the normalized scale to the root actor's transform
 			m_normalizedScale = Geometry_ComputeNormalizedScale();
 			m_rootActor.lock()->GetComponent<Transform>()->SetScale(m_normalizedScale);
 			m_rootActor.lock()->GetComponent<Transform>()->UpdateTransform();
 
-			// Save the model in our custom format.
-			SaveToFile(GetResourceFilePath());
+			// Save the model in our custom format, from then on the geometry can be read back from it
+			if (SaveToFile(GetResourceFilePath()))
+			{
+				Geometry_Release();
+			}
 
 			return true;
 		}
@@ -275,16 +868,22 @@ namespace Directus
 
 	bool Model::Geometry_CreateBuffers()
 	{
+		// Without a device (headless) the geometry only lives in the mesh, where colliders read it from
+		if (!m_rhiDevice)
+			return true;
+
 		bool success = true;
 
 		// Get geometry
-		vector<unsigned int> indices			= m_mesh->Indices_Get();
-		vector<RHI_Vertex_PosUVTBN> vertices	= m_mesh->Vertices_Get();
+		const vector<unsigned int>& indices				= m_mesh->Indices_Get();
+		vector<RHI_Vertex_PosUVTBNPacked> vertices		= _Model::PackVertices(m_mesh->Vertices_Get());
 
 		if (!indices.empty())
 		{
+			// Indices are relative to each mesh's vertex offset, so most models fit in 16 bits even when the combined buffer is larger
+			// Culling clusters compacts their indices on the GPU, it reads them from here
 			m_indexBuffer = make_shared<RHI_IndexBuffer>(m_rhiDevice);
-			if (!m_indexBuffer->Create(indices))
+			if (!m_indexBuffer->Create(indices, RHI_IndexBuffer::GetFormat(indices), !m_clusters.empty()))
 			{
 				LOGF_ERROR("Model::Geometry_CreateBuffers: Failed to create index buffer for \"%s\".", m_resourceName.c_str());
 				success = false;
@@ -311,6 +910,20 @@ namespace Directus
 			success = false;
 		}
 
+		// Skinned geometry is posed by compute shaders, they read the bind pose from structured buffers
+		if (!m_skins.empty() && !vertices.empty())
+		{
+			m_skinWeights.resize(vertices.size());
+			m_skinVertexBuffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+			m_skinWeightBuffer = make_shared<RHI_StructuredBuffer>(m_rhiDevice);
+			if (!m_skinVertexBuffer->Create(sizeof(RHI_Vertex_PosUVTBNPacked), (unsigned int)vertices.size(), vertices.data()) ||
+				!m_skinWeightBuffer->Create(sizeof(RHI_Vertex_Skin), (unsigned int)m_skinWeights.size(), m_skinWeights.data()))
+			{
+				LOGF_ERROR("Model::Geometry_CreateBuffers: Failed to create skinning buffers for \"%s\".", m_resourceName.c_str());
+				success = false;
+			}
+		}
+
 		return success;
 	}
 
@@ -24,24 +24,69 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <vector>
+#include <map>
+#include <mutex>
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Matrix.h"
 #include "Material.h"
+#include "AnimationPose.h"
 //================================
 
+#define MODEL_LODS_MAX 4		// including the full detail geometry
+#define MODEL_BONES_MAX 256	// a skinned vertex names its bones with a byte
+#define MODEL_CLUSTER_TRIANGLES 128	// the most a cluster has, fewer is enough for a GPU to cull them apart
+#define MODEL_CLUSTERS_MIN 4		// geometry that would make fewer clusters is culled whole
+
 namespace Directus
 {
 	class ResourceManager;
 	class Actor;
 	class Mesh;
 	class Animation;
+	class FileStream;
+	struct AnimationCursor;
 
 	namespace Math
 	{
 		class BoundingBox;
 	}
 
+	// A simplified version of some geometry, it uses the same vertices with fewer indices
+	struct ModelLod
+	{
+		unsigned int indexOffset	= 0;
+		unsigned int indexCount		= 0;
+		float screenSize			= 0.0f; // used once the bounding sphere is smaller than this fraction of the screen height
+	};
+
+	// A run of the full detail geometry's triangles that the GPU culls on it's own (see GPUCulling). The triangles all
+	// face away from a camera that's inside the cone around the axis, behind the apex, see IsBackFacing.
+	struct ModelCluster
+	{
+		unsigned int indexOffset	= 0;
+		unsigned int indexCount		= 0;
+		Math::Vector3 center;			// bounding box, in the space of the geometry
+		Math::Vector3 extents;
+		Math::Vector3 coneApex;
+		Math::Vector3 coneAxis;
+		float coneCutoff			= 2.0f; // the sine of the normals' spread, above 1 when they are too far apart for it to ever be
+
+		bool IsBackFacing(const Math::Vector3& cameraPosition) const { return Math::Vector3::Dot((coneApex - cameraPosition).Normalized(), coneAxis) >= coneCutoff; }
+	};
+
+	// A node of the hierarchy skinned geometry follows, a bone or a node above one
+	struct ModelBone
+	{
+		std::string name;
+		int parent = -1;			// bones come after their parent
+		Math::Vector3 position;		// bind pose, relative to the parent
+		Math::Quaternion rotation;
+		Math::Vector3 scale			= Math::Vector3::One;
+		Math::Matrix offset;		// from the space of the geometry to the bone's, in the bind pose
+	};
+
 	class ENGINE_CLASS Model : public IResource
 	{
 	public:
@@ -74,21 +119,69 @@ namespace Directus
 		);
 		void Geometry_Update();
 		const Math::BoundingBox& Geometry_AABB() { return m_aabb; }
+		// Once the geometry is on the GPU and in the model's file, the CPU copy isn't kept. Geometry_Get reads it back from
+		// the file when something (a mesh collider) needs it, it then stays until released again. Editing keeps it resident.
+		void Geometry_Release();
+		void Geometry_KeepResident(bool keep);
+		bool Geometry_IsResident() { return m_geometryResident; }
+		// Generates simplified levels of detail for geometry that was appended to the model at an index offset
+		void Geometry_GenerateLods(unsigned int indexOffset, const std::vector<unsigned int>& indices, const std::vector<RHI_Vertex_PosUVTBN>& vertices);
+		// The two halves of Geometry_GenerateLods, simplifying doesn't touch the model so importers can run it on any thread
+		static void Geometry_SimplifyLods(const std::vector<unsigned int>& indices, const std::vector<RHI_Vertex_PosUVTBN>& vertices, std::vector<ModelLod>* lods, std::vector<std::vector<unsigned int>>* lodIndices);
+		void Geometry_AppendLods(unsigned int indexOffset, std::vector<ModelLod> lods, const std::vector<std::vector<unsigned int>>& lodIndices);
+		// The simplified levels (coarsest last) of the geometry that starts at an index offset, nullptr if there are none
+		const std::vector<ModelLod>* Geometry_Lods(unsigned int indexOffset) const;
+		// Splits geometry into runs of MODEL_CLUSTER_TRIANGLES in the order it's indices are (optimized for the vertex cache,
+		// that keeps them close together), offsets are relative to the geometry. Like simplifying, it runs on any thread.
+		static void Geometry_BuildClusters(const std::vector<unsigned int>& indices, const std::vector<RHI_Vertex_PosUVTBN>& vertices, std::vector<ModelCluster>* clusters);
+		void Geometry_AppendClusters(unsigned int indexOffset, std::vector<ModelCluster> clusters);
+		// The clusters of the geometry that starts at an index offset, nullptr if it's culled whole
+		const std::vector<ModelCluster>* Geometry_Clusters(unsigned int indexOffset) const;
 		//=========================================================
 
+		//= SKINNING ==============================================================================================
+		void Skin_SetBones(const std::vector<ModelBone>& bones);
+		const std::vector<ModelBone>& Skin_GetBones() const { return m_bones; }
+		// -1 if there isn't a bone of that name
+		int Skin_GetBone(const std::string& name) const;
+		// Makes the geometry at a vertex offset skinned, with one weight per vertex, meshBone is the node it's placed at
+		void Skin_Append(unsigned int vertexOffset, unsigned int meshBone, const std::vector<RHI_Vertex_Skin>& weights);
+		bool Skin_IsSkinned(unsigned int vertexOffset) const { return m_skins.find(vertexOffset) != m_skins.end(); }
+		// The animations skinned geometry can play, in the order they were added
+		unsigned int Skin_GetAnimationCount() const { return (unsigned int)m_skinAnimations.size(); }
+		// -1 if there isn't an animation of that name
+		int Skin_GetAnimation(const std::string& name) const;
+		// An animation's pose at a time (in seconds, looping), the cursor is the caller's own so any thread can sample.
+		// Without leaf bones the bones no other bone is below stay in the bind pose, for characters too far to tell.
+		void Skin_Sample(unsigned int animation, double time, AnimationCursor* cursor, AnimationPose* pose, bool leafBones = true) const;
+		// How far the animations take any bone from where the bind pose has it, bounds grow by it to stay conservative
+		float Skin_GetMotionRadius() const { return m_skinMotionRadius; }
+		// A pose as one matrix per bone that takes the skinned geometry at a vertex offset from its bind pose
+		// to the pose. The palette has room for every bone.
+		void Skin_ComputePalette(unsigned int vertexOffset, const AnimationPose& pose, Math::Matrix* palette) const;
+		// The bind pose vertices (packed) and their weights in structured buffers, for skinning in compute shaders
+		const std::shared_ptr<RHI_StructuredBuffer>& Skin_GetVertexBuffer() { return m_skinVertexBuffer; }
+		const std::shared_ptr<RHI_StructuredBuffer>& Skin_GetWeightBuffer() { return m_skinWeightBuffer; }
+		//=========================================================================================================
+
 		// Adds a new material
-		void AddMaterial(const std::shared_ptr<Material>& material, const std::shared_ptr<Actor>& actor, bool autoCache = true);
+		// Returns the material the model keeps, the cached one if another of the same name was there already
+		std::shared_ptr<Material> AddMaterial(const std::shared_ptr<Material>& material, const std::shared_ptr<Actor>& actor, bool autoCache = true);
 
 		// Adds a new animation
 		std::shared_ptr<Animation> AddAnimation(const std::shared_ptr<Animation>& animation);
 
 		// Adds a texture (the material that uses this texture must be passed as well)
 		void AddTexture(const std::shared_ptr<Material>& material, TextureType textureType, const std::string& filePath);
+		// Gets the cached texture or loads, saves (in the model directory) and caches it, safe to call from many threads for different textures
+		std::shared_ptr<RHI_Texture> ImportTexture(TextureType textureType, const std::string& filePath);
 
 		bool IsAnimated() { return m_isAnimated; }
 		void SetAnimated(bool isAnimated) { m_isAnimated = isAnimated; }
 
 		void SetWorkingDirectory(const std::string& directory);
+		// The ProgressReport id an import from a foreign format reports to, and can be cancelled through
+		void SetImportProgressID(int progressID) { m_importProgressID = progressID; }
 
 		std::shared_ptr<RHI_IndexBuffer> GetIndexBuffer()	{ return m_indexBuffer; }
 		std::shared_ptr<RHI_VertexBuffer> GetVertexBuffer() { return m_vertexBuffer; }
@@ -100,9 +193,15 @@ namespace Directus
 
 		// Geometry
 		bool Geometry_CreateBuffers();
+		// Reads the geometry back from the model's file if it was released
+		bool Geometry_Acquire();
+		void Geometry_Read(FileStream* file);
 		float Geometry_ComputeNormalizedScale();
 		unsigned int Geometry_ComputeMemoryUsage();
 
+		// Skinning
+		void Skin_MapAnimations();
+
 		// The root actor that represents this model in the scene
 		std::weak_ptr<Actor> m_rootActor;
 
@@ -110,8 +209,13 @@ namespace Directus
 		std::shared_ptr<RHI_VertexBuffer> m_vertexBuffer;
 		std::shared_ptr<RHI_IndexBuffer> m_indexBuffer;
 		std::shared_ptr<Mesh> m_mesh;
+		std::map<unsigned int, std::vector<ModelLod>> m_lods; // keyed by the index offset of the full detail geometry
+		std::map<unsigned int, std::vector<ModelCluster>> m_clusters; // like m_lods
 		Math::BoundingBox m_aabb;
 		unsigned int meshCount;
+		bool m_geometryResident		= true;
+		bool m_geometryKeepResident	= false;
+		std::mutex m_geometryMutex;
 
 		// Material
 		std::vector<std::weak_ptr<Material>> m_materials;
@@ -119,6 +223,18 @@ namespace Directus
 		// Animations
 		std::vector<std::weak_ptr<Animation>> m_animations;
 
+		// Skinning
+		std::vector<ModelBone> m_bones;
+		std::vector<RHI_Vertex_Skin> m_skinWeights;						// one per vertex of the model, skinned or not
+		std::map<unsigned int, unsigned int> m_skins;					// the node skinned geometry is placed at, keyed by its vertex offset
+		AnimationPose m_skinBindPose;
+		std::vector<std::shared_ptr<Animation>> m_skinAnimations;
+		std::vector<std::vector<int>> m_skinChannelBones;				// per animation, the bone each channel moves, -1 for none
+		std::vector<std::vector<int>> m_skinChannelBonesInner;			// like m_skinChannelBones without leaf bones
+		float m_skinMotionRadius = 0.0f;
+		std::shared_ptr<RHI_StructuredBuffer> m_skinVertexBuffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_skinWeightBuffer;
+
 		// Directories relative to this model
 		std::string m_modelDirectoryModel;
 		std::string m_modelDirectoryMaterials;
@@ -128,6 +244,7 @@ namespace Directus
 		float m_normalizedScale;
 		unsigned int m_memoryUsage;		
 		bool m_isAnimated;
+		int m_importProgressID;
 		ResourceManager* m_resourceManager;
 		std::shared_ptr<RHI_Device> m_rhiDevice;	
 	};
@@ -44,6 +44,7 @@ namespace Directus
 		m_y					= 0;
 		m_width				= 0;
 		m_height			= 0;
+		m_uvScale			= 1.0f;
 		m_resolutionWidth	= Settings::Get().Resolution_GetWidth();
 		m_resolutionHeight	= Settings::Get().Resolution_GetHeight();
 	}
@@ -53,13 +54,14 @@ namespace Directus
 
 	}
 
-	bool Rectangle::Create(float x, float y, float width, float height)
+	bool Rectangle::Create(float x, float y, float width, float height, float uvScale /*= 1.0f*/)
 	{
 		// Don't update if it's not needed
 		if (m_x == x && 
 			m_y == y && 
 			m_width == width && 
 			m_height == height && 
+			m_uvScale == uvScale && 
 			m_resolutionWidth == Settings::Get().Resolution_GetWidth() && 
 			m_resolutionHeight == Settings::Get().Resolution_GetHeight()
 			)
@@ -69,6 +71,7 @@ namespace Directus
 		m_y = y;
 		m_width = width;
 		m_height = height;
+		m_uvScale = uvScale;
 		m_resolutionWidth = Settings::Get().Resolution_GetWidth();
 		m_resolutionHeight = Settings::Get().Resolution_GetHeight();
 
@@ -84,23 +87,23 @@ namespace Directus
 
 		// First triangle
 		// Top left
-		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(left, top, 0.0f), Vector2(0.0f, 0.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(left, top, 0.0f), Vector2(0.0f, 0.0f) * m_uvScale));
 
 		// Bottom right
-		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(right, bottom, 0.0f), Vector2(1.0f, 1.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(right, bottom, 0.0f), Vector2(1.0f, 1.0f) * m_uvScale));
 
 		// Bottom left
-		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(left, bottom, 0.0f), Vector2(0.0f, 1.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(left, bottom, 0.0f), Vector2(0.0f, 1.0f) * m_uvScale));
 
 		// Second triangle
 		// Top left
-		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(left, top, 0.0f), Vector2(0.0f, 0.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(left, top, 0.0f), Vector2(0.0f, 0.0f) * m_uvScale));
 
 		// Top right
-		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(right, top, 0.0f), Vector2(1.0f, 0.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(right, top, 0.0f), Vector2(1.0f, 0.0f) * m_uvScale));
 
 		// Bottom right
-		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(right, bottom, 0.0f), Vector2(1.0f, 1.0f)));
+		vertices.emplace_back(RHI_Vertex_PosUV(Vector3(right, bottom, 0.0f), Vector2(1.0f, 1.0f) * m_uvScale));
 
 		// Load the index array with data.
 		for (unsigned int i = 0; i < vertices.size(); i++)
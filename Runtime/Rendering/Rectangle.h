@@ -36,7 +36,8 @@ namespace Directus
 		Rectangle(Context* context);
 		~Rectangle();
 
-		bool Create(float x, float y, float width, float height);
+		// uvScale shrinks the texture coordinates from 0-1 to 0-uvScale, to sample a top left sub-rect of a texture
+		bool Create(float x, float y, float width, float height, float uvScale = 1.0f);
 		int GetIndexCount() { return 6; }
 
 		std::shared_ptr<RHI_IndexBuffer> GetIndexBuffer()	{ return m_indexBuffer; }
@@ -50,6 +51,7 @@ namespace Directus
 		float m_y;
 		float m_width;
 		float m_height;
+		float m_uvScale;
 		int m_resolutionWidth;
 		int m_resolutionHeight;
 	};
@@ -0,0 +1,199 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "RenderGraph.h"
+#include "RenderTexturePool.h"
+#include "../RHI/RHI_RenderTexture.h"
+#include "../Logging/Log.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	RenderGraph::RenderGraph(const shared_ptr<RenderTexturePool>& pool)
+	{
+		m_pool = pool;
+	}
+
+	RenderGraph_Resource RenderGraph::Resource_CreateTransient(const string& name, unsigned int width, unsigned int height, Texture_Format format)
+	{
+		Resource resource;
+		resource.name	= name;
+		resource.width	= width;
+		resource.height	= height;
+		resource.format	= format;
+		m_resources.emplace_back(resource);
+
+		return (RenderGraph_Resource)m_resources.size() - 1;
+	}
+
+	RenderGraph_Resource RenderGraph::Resource_Import(const string& name, const shared_ptr<RHI_RenderTexture>& texture)
+	{
+		if (!texture)
+		{
+			LOGF_WARNING("RenderGraph::Resource_Import: Invalid texture for \"%s\"", name.c_str());
+			return RenderGraph_Resource_Invalid;
+		}
+
+		Resource resource;
+		resource.name		= name;
+		resource.width		= texture->GetWidth();
+		resource.height		= texture->GetHeight();
+		resource.format		= texture->GetFormat();
+		resource.imported	= true;
+		resource.texture	= texture;
+		m_resources.emplace_back(resource);
+
+		return (RenderGraph_Resource)m_resources.size() - 1;
+	}
+
+	shared_ptr<RHI_RenderTexture>& RenderGraph::Resource_Get(RenderGraph_Resource resource)
+	{
+		if (resource < 0 || resource >= (int)m_resources.size())
+		{
+			LOG_ERROR("RenderGraph::Resource_Get: Invalid resource");
+			return m_textureEmpty;
+		}
+
+		return m_resources[resource].texture;
+	}
+
+	void RenderGraph::Pass_Add(const string& name, const vector<RenderGraph_Resource>& inputs, const vector<RenderGraph_Resource>& outputs, function<void()>&& execute)
+	{
+		Pass pass;
+		pass.name		= name;
+		pass.execute	= std::move(execute);
+
+		// Ignore invalid resources, so callers don't have to check every optional input
+		for (const auto& input : inputs)	{ if (input != RenderGraph_Resource_Invalid) pass.inputs.emplace_back(input); }
+		for (const auto& output : outputs)	{ if (output != RenderGraph_Resource_Invalid) pass.outputs.emplace_back(output); }
+
+		m_passes.emplace_back(std::move(pass));
+	}
+
+	void RenderGraph::Execute()
+	{
+		Cull();
+		ComputeLifetimes();
+
+		// Execute passes in order, acquiring transient textures right before
+		// their first use and returning them to the pool right after their last use.
+		m_passCountExecuted = 0;
+		for (int passIndex = 0; passIndex < (int)m_passes.size(); passIndex++)
+		{
+			auto& pass = m_passes[passIndex];
+			if (pass.culled)
+				continue;
+
+			for (auto& resource : m_resources)
+			{
+				if (!resource.imported && resource.firstPass == passIndex)
+				{
+					resource.texture = m_pool->Acquire(resource.width, resource.height, resource.format);
+				}
+			}
+
+			pass.execute();
+			m_passCountExecuted++;
+
+			for (auto& resource : m_resources)
+			{
+				if (!resource.imported && resource.lastPass == passIndex)
+				{
+					m_pool->Release(resource.texture, true); // only passes of this frame can get it
+				}
+			}
+		}
+
+		// The passes are gone after the reset, the stats are kept until the next frame
+		m_passCountCulled = (unsigned int)m_passes.size() - m_passCountExecuted;
+		Reset();
+	}
+
+	void RenderGraph::Cull()
+	{
+		// Count how many passes read each resource
+		vector<int> readers(m_resources.size(), 0);
+		for (const auto& pass : m_passes)
+		{
+			for (const auto& input : pass.inputs)
+			{
+				readers[input]++;
+			}
+		}
+
+		// Walk backwards, a pass is only needed if it has side effects (no outputs),
+		// if it writes to an imported resource or if any of it's outputs are consumed.
+		for (auto it = m_passes.rbegin(); it != m_passes.rend(); ++it)
+		{
+			auto& pass = *it;
+
+			bool needed = pass.outputs.empty();
+			for (const auto& output : pass.outputs)
+			{
+				if (m_resources[output].imported || readers[output] > 0)
+				{
+					needed = true;
+					break;
+				}
+			}
+
+			pass.culled = !needed;
+			if (pass.culled)
+			{
+				// The inputs of a culled pass are one reader short
+				for (const auto& input : pass.inputs)
+				{
+					readers[input]--;
+				}
+			}
+		}
+	}
+
+	void RenderGraph::ComputeLifetimes()
+	{
+		for (int passIndex = 0; passIndex < (int)m_passes.size(); passIndex++)
+		{
+			const auto& pass = m_passes[passIndex];
+			if (pass.culled)
+				continue;
+
+			auto Touch = [passIndex](Resource& resource)
+			{
+				resource.firstPass	= resource.firstPass == -1 ? passIndex : resource.firstPass;
+				resource.lastPass	= passIndex;
+			};
+
+			for (const auto& input : pass.inputs)	Touch(m_resources[input]);
+			for (const auto& output : pass.outputs)	Touch(m_resources[output]);
+		}
+	}
+
+	void RenderGraph::Reset()
+	{
+		m_resources.clear();
+		m_passes.clear();
+	}
+}
@@ -0,0 +1,117 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include <string>
+#include <functional>
+#include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Definition.h"
+//=============================
+
+/*
+HOW TO USE
+==========================================================================================
+Every frame, declare the resources and the passes (in execution order), then execute:
+
+auto target = graph.Resource_CreateTransient("Light", width, height, format);
+graph.Pass_Add("Pass_Light", { shadowing }, { target }, [&]() { Pass_Light(...); });
+graph.Execute();
+
+- Transient resources only live for the passes that use them, their render textures come
+  from the render texture pool and get recycled between passes whose lifetimes don't overlap.
+- Imported resources are owned by someone else, writing to them keeps a pass alive.
+- Passes whose outputs are never consumed get culled, passes without outputs are assumed
+  to have side effects and are never culled.
+==========================================================================================
+*/
+
+namespace Directus
+{
+	class RenderTexturePool;
+
+	typedef int RenderGraph_Resource;
+	static const RenderGraph_Resource RenderGraph_Resource_Invalid = -1;
+
+	class ENGINE_CLASS RenderGraph
+	{
+	public:
+		RenderGraph(const std::shared_ptr<RenderTexturePool>& pool);
+		~RenderGraph() {}
+
+		//= RESOURCES ==================================================================================================================
+		// Declares a render texture that only has to exist for the duration of the passes that use it
+		RenderGraph_Resource Resource_CreateTransient(const std::string& name, unsigned int width, unsigned int height, Texture_Format format);
+		// Declares a render texture whose lifetime is managed externally (e.g. the final frame)
+		RenderGraph_Resource Resource_Import(const std::string& name, const std::shared_ptr<RHI_RenderTexture>& texture);
+		// Returns the actual render texture that backs a resource (only valid while the graph executes)
+		std::shared_ptr<RHI_RenderTexture>& Resource_Get(RenderGraph_Resource resource);
+		//==============================================================================================================================
+
+		// Adds a pass, passes execute in the order they are added
+		void Pass_Add(const std::string& name, const std::vector<RenderGraph_Resource>& inputs, const std::vector<RenderGraph_Resource>& outputs, std::function<void()>&& execute);
+
+		// Culls unused passes, assigns render textures to transient resources and executes the passes
+		void Execute();
+
+		//= STATS ================================================================================
+		// Of the last frame that was executed
+		unsigned int GetPassCountExecuted()		{ return m_passCountExecuted; }
+		unsigned int GetPassCountCulled()		{ return m_passCountCulled; }
+		//========================================================================================
+
+	private:
+		struct Resource
+		{
+			std::string name;
+			unsigned int width		= 0;
+			unsigned int height		= 0;
+			Texture_Format format	= Texture_Format_R8G8B8A8_UNORM;
+			bool imported			= false;
+			int firstPass			= -1;
+			int lastPass			= -1;
+			std::shared_ptr<RHI_RenderTexture> texture;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			std::vector<RenderGraph_Resource> inputs;
+			std::vector<RenderGraph_Resource> outputs;
+			std::function<void()> execute;
+			bool culled = false;
+		};
+
+		void Cull();
+		void ComputeLifetimes();
+		void Reset();
+
+		std::vector<Resource> m_resources;
+		std::vector<Pass> m_passes;
+		std::shared_ptr<RenderTexturePool> m_pool;
+		std::shared_ptr<RHI_RenderTexture> m_textureEmpty;
+		unsigned int m_passCountExecuted	= 0;
+		unsigned int m_passCountCulled		= 0;
+	};
+}
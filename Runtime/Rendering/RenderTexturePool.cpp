@@ -0,0 +1,157 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "RenderTexturePool.h"
+#include "../RHI/RHI_RenderTexture.h"
+#include "../Logging/Log.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	RenderTexturePool::RenderTexturePool(const shared_ptr<RHI_Device>& rhiDevice)
+	{
+		m_rhiDevice = rhiDevice;
+	}
+
+	shared_ptr<RHI_RenderTexture> RenderTexturePool::Acquire(unsigned int width, unsigned int height, Texture_Format format, bool depth /*= false*/, Texture_Format depthFormat /*= Texture_Format_D32_FLOAT*/, bool unorderedAccess /*= false*/)
+	{
+		Description description;
+		description.width			= width;
+		description.height			= height;
+		description.format			= format;
+		description.depth			= depth;
+		description.depthFormat		= depthFormat;
+		description.unorderedAccess	= unorderedAccess;
+
+		lock_guard<mutex> lock(m_mutex);
+
+		// Recycle a free texture with a matching description
+		int stale = -1;
+		for (int i = 0; i < (int)m_entries.size(); i++)
+		{
+			auto& entry = m_entries[i];
+			if (entry.inUse || entry.frameAvailable > m_frame)
+				continue;
+
+			if (entry.description == description)
+			{
+				entry.inUse = true;
+				entry.texture->SetMemoryCategory(Memory_RenderTargets); // the previous owner may have said otherwise
+				return entry.texture;
+			}
+
+			// The same kind of texture at a size nobody asked for lately, most likely left behind by a resize
+			if (stale == -1 && entry.description.IsCompatible(description) && m_frame - entry.frameReleased >= RENDER_TEXTURE_POOL_LATENCY)
+			{
+				stale = i;
+			}
+		}
+
+		// Replace a stale one, so a viewport that keeps getting resized doesn't pile up textures of every size it went through
+		if (stale != -1)
+		{
+			m_entries.erase(m_entries.begin() + stale);
+		}
+
+		Entry entry;
+		entry.texture		= make_shared<RHI_RenderTexture>(m_rhiDevice, width, height, format, depth, depthFormat, unorderedAccess);
+		entry.description	= description;
+		entry.inUse			= true;
+		m_entries.emplace_back(entry);
+
+		return entry.texture;
+	}
+
+	void RenderTexturePool::Release(const shared_ptr<RHI_RenderTexture>& texture, bool immediate /*= false*/)
+	{
+		if (!texture)
+			return;
+
+		lock_guard<mutex> lock(m_mutex);
+		for (auto& entry : m_entries)
+		{
+			if (entry.texture == texture)
+			{
+				entry.inUse				= false;
+				entry.frameReleased		= m_frame;
+				entry.frameAvailable	= immediate ? m_frame : m_frame + RENDER_TEXTURE_POOL_LATENCY;
+				return;
+			}
+		}
+
+		LOG_WARNING("RenderTexturePool::Release: The render texture doesn't belong to the pool");
+	}
+
+	void RenderTexturePool::Tick()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_frame++;
+
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			// Only the pool holds it, the owner let go of it without releasing
+			if (it->inUse && it->texture.use_count() == 1)
+			{
+				it->inUse			= false;
+				it->frameReleased	= m_frame;
+				it->frameAvailable	= m_frame + RENDER_TEXTURE_POOL_LATENCY;
+			}
+
+			if (!it->inUse && m_frame - it->frameReleased > RENDER_TEXTURE_POOL_MAX_UNUSED_FRAMES)
+			{
+				it = m_entries.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	void RenderTexturePool::Clear()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_entries.clear();
+		m_entries.shrink_to_fit();
+	}
+
+	unsigned int RenderTexturePool::GetTextureCount()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		return (unsigned int)m_entries.size();
+	}
+
+	unsigned int RenderTexturePool::GetTextureCountInUse()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		unsigned int count = 0;
+		for (const auto& entry : m_entries)
+		{
+			count += entry.inUse ? 1 : 0;
+		}
+		return count;
+	}
+}
@@ -0,0 +1,96 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Definition.h"
+//=============================
+
+// Frames a released render texture waits before it's handed out again, the GPU may still be reading it
+#define RENDER_TEXTURE_POOL_LATENCY				3
+// Free render textures that haven't been used for this many frames get released
+#define RENDER_TEXTURE_POOL_MAX_UNUSED_FRAMES	60
+
+namespace Directus
+{
+	// Recycles render textures by size, format and flags. Anything that needs a render texture (passes, lights,
+	// editor previews) acquires it here and releases it when done, so changing a resolution swaps textures in
+	// and out of the pool instead of freeing and re-allocating video memory every time.
+	class ENGINE_CLASS RenderTexturePool
+	{
+	public:
+		RenderTexturePool(const std::shared_ptr<RHI_Device>& rhiDevice);
+		~RenderTexturePool() {}
+
+		std::shared_ptr<RHI_RenderTexture> Acquire(
+			unsigned int width,
+			unsigned int height,
+			Texture_Format format,
+			bool depth					= false,
+			Texture_Format depthFormat	= Texture_Format_D32_FLOAT,
+			bool unorderedAccess		= false
+		);
+		// Immediate makes it available again right away, for textures that are only used within a frame (e.g. render graph transients)
+		void Release(const std::shared_ptr<RHI_RenderTexture>& texture, bool immediate = false);
+		// Advances the frame and releases what hasn't been used for a while, once per frame
+		void Tick();
+		void Clear();
+
+		//= STATS ================================
+		unsigned int GetTextureCount();
+		unsigned int GetTextureCountInUse();
+		//========================================
+
+	private:
+		struct Description
+		{
+			unsigned int width			= 0;
+			unsigned int height			= 0;
+			Texture_Format format		= Texture_Format_R8G8B8A8_UNORM;
+			bool depth					= false;
+			Texture_Format depthFormat	= Texture_Format_D32_FLOAT;
+			bool unorderedAccess		= false;
+
+			// Same kind of texture, possibly of a different size
+			bool IsCompatible(const Description& other) const { return format == other.format && depth == other.depth && (!depth || depthFormat == other.depthFormat) && unorderedAccess == other.unorderedAccess; }
+			bool operator==(const Description& other) const { return width == other.width && height == other.height && IsCompatible(other); }
+		};
+
+		struct Entry
+		{
+			std::shared_ptr<RHI_RenderTexture> texture;
+			Description description;
+			bool inUse					= false;
+			uint64_t frameReleased		= 0;
+			uint64_t frameAvailable		= 0; // the first frame it can be handed out again
+		};
+
+		std::vector<Entry> m_entries;
+		uint64_t m_frame = 0;
+		std::mutex m_mutex;
+		std::shared_ptr<RHI_Device> m_rhiDevice;
+	};
+}
@@ -21,27 +21,58 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==============================
 #include "Renderer.h"
+#include <unordered_set>
+#include <algorithm>
+#include <future>
 #include "Rectangle.h"
 #include "Grid.h"
 #include "Font.h"
+#include "Model.h"
+#include "DebugDraw.h"
+#include "RenderTexturePool.h"
 #include "Deferred/ShaderVariation.h"
 #include "Deferred/LightShader.h"
+#include "Deferred/LightClusters.h"
+#include "Deferred/ShadowAtlas.h"
+#include "Deferred/ReflectionProbes.h"
+#include "Deferred/OcclusionCulling.h"
+#include "Deferred/GPUCulling.h"
+#include "Deferred/GPUSkinning.h"
+#include "Deferred/GPUParticles.h"
+#include "Deferred/MaterialTextures.h"
+#include "Deferred/Impostors.h"
 #include "Deferred/GBuffer.h"
 #include "../RHI/RHI_Device.h"
 #include "../RHI/RHI_CommonBuffers.h"
 #include "../RHI/RHI_VertexBuffer.h"
+#include "../RHI/RHI_IndexBuffer.h"
 #include "../RHI/RHI_Sampler.h"
 #include "../RHI/RHI_Pipeline.h"
+#include "../RHI/RHI_StructuredBuffer.h"
+#include "../RHI/RHI_PipelineCache.h"
+#include "../RHI/RHI_Readback.h"
+#include "../RHI/RHI_Capture.h"
 #include "../RHI/RHI_RenderTexture.h"
 #include "../RHI/RHI_Shader.h"
+#include "../RHI/RHI_ConstantBuffer.h"
+#include "../World/World.h"
 #include "../World/Actor.h"
 #include "../World/Components/Transform.h"
+#include "../World/Components/Camera.h"
 #include "../World/Components/Renderable.h"
 #include "../World/Components/Skybox.h"
+#include "../World/Components/ParticleEmitter.h"
+#include "../World/Components/Terrain.h"
+#include "../World/Components/LightProbeVolume.h"
 #include "../Physics/Physics.h"
 #include "../Physics/PhysicsDebugDraw.h"
 #include "../Profiling/Profiler.h"
+#include "../Profiling/MemoryTracker.h"
+#include "../Threading/Threading.h"
+#include "../Resource/TextureStreaming.h"
 #include "../Core/Context.h"
+#include "../Core/Engine.h"
+#include "../Core/Timer.h"
 #include "../Math/BoundingBox.h"
 //=========================================
 
@@ -53,10 +84,49 @@ using namespace Helper;
 
 #define GIZMO_MAX_SIZE 5.0f
 #define GIZMO_MIN_SIZE 0.1f
+#define COMMAND_LIST_ACTORS_MIN 128 // fewer actors than that aren't worth recording on another thread
+#define SORT_KEYS_PER_TASK 512 // fewer renderables than that aren't worth computing sort keys for on another thread
+#define SHADOW_CASTER_STATIC_FRAMES 30 // frames an actor has to stay still before it's baked into the cached shadow maps
+#define SHADOW_CASTER_CULL_PARALLEL 4096 // fewer casters than that aren't worth culling on other threads
+#define SHADOW_CASTER_CULL_GRAIN 16 // words of the visibility bits (64 casters each) per chunk
+#define DYNAMIC_RESOLUTION_MIN 0.5f
+#define DYNAMIC_RESOLUTION_STEP 0.05f // the scale moves in steps, so the targets aren't resampled every frame
+#define DYNAMIC_RESOLUTION_HEADROOM 0.9f // aim a bit below the budget, spikes shouldn't drop frames
+#define RENDER_ON_DEMAND_FRAMES 32 // frames still rendered after a change, temporal effects converge and still casters get cached meanwhile
+#define TAA_JITTER_SAMPLES 8
+#define BLOOM_MIP_COUNT 5 // the first level is at half resolution, every other one halves it again
+#define BLOOM_THRESHOLD 1.0f // luminance
+#define BLOOM_INTENSITY 0.2f
+#define SSR_LEVELS_MAX 8 // must match ScreenSpaceReflections.hlsl
+#define SSR_RAYS_MAX 4 // on the roughest traced surfaces, mirrors trace one
+#define SSR_STEPS 48
+#define SSR_ROUGHNESS_MAX 0.6f // rougher surfaces are left to the environment
+#define SSR_THICKNESS 0.02f // of the surface's depth
+
+namespace _Renderer
+{
+	// What the GPU pays the most for, a preset only sets or clears these
+	struct QualityPreset
+	{
+		const char* name;
+		unsigned long flags;
+		unsigned int shadowResolution;
+		unsigned int anisotropy;
+	};
+
+	static const QualityPreset qualityPresets[Directus::Quality_Count] =
+	{
+		{ "Low",	Directus::Render_FXAA | Directus::Render_Checkerboard, 512, 2 },
+		{ "Medium",	Directus::Render_FXAA | Directus::Render_Bloom, 1024, 4 },
+		{ "High",	Directus::Render_FXAA | Directus::Render_Bloom | Directus::Render_Sharpening | Directus::Render_SSR, 2048, 16 },
+		{ "Ultra",	Directus::Render_TAA | Directus::Render_Bloom | Directus::Render_Sharpening | Directus::Render_SSR, 4096, 16 }
+	};
+}
 
 namespace Directus
 {
 	static ResourceManager* g_resourceMng	= nullptr;
+	static TextureStreaming* g_streaming	= nullptr;
 	unsigned long Renderer::m_flags;
 	bool Renderer::m_isRendering			= false;
 	uint64_t Renderer::m_frame				= 0;
@@ -77,15 +147,33 @@ namespace Directus
 		m_flags			|= Render_Sharpening;
 		//m_flags		|= Render_ChromaticAberration;
 		m_flags			|= Render_Correction;
+		m_flags			|= Render_OcclusionCulling;
+		m_flags			|= Render_ReverseZ;
+		m_flags			|= Render_CameraRelative;
+		m_flags			|= Render_SSR;
+		//m_flags		|= Render_DynamicResolution;
 
 		// Create RHI device
 		m_rhiDevice			= make_shared<RHI_Device>(drawHandle);
 		m_rhiPipeline	= make_shared<RHI_Pipeline>(m_rhiDevice);
+		m_pipelineCache	= make_unique<RHI_PipelineCache>(m_rhiDevice);
+		m_readback		= make_unique<RHI_Readback>(m_rhiDevice);
+		m_renderTexturePool	= make_shared<RenderTexturePool>(m_rhiDevice);
+		m_renderGraph	= make_unique<RenderGraph>(m_renderTexturePool);
+		m_occlusionCulling = make_unique<OcclusionCulling>(m_rhiDevice);
+		m_gpuCulling		= make_unique<GPUCulling>(m_rhiDevice);
+		m_gpuSkinning		= make_unique<GPUSkinning>(m_rhiDevice, m_context->GetSubsystem<Threading>());
+		m_gpuParticles		= make_unique<GPUParticles>(m_rhiDevice);
+		m_materialTextures	= make_unique<MaterialTextures>(m_rhiDevice);
+		m_impostors			= make_unique<Impostors>(m_rhiDevice, m_renderTexturePool);
 
 		// Subscribe to events
 		SUBSCRIBE_TO_EVENT(EVENT_RENDER, EVENT_HANDLER(Render));
-		SUBSCRIBE_TO_EVENT(EVENT_WORLD_SUBMIT, EVENT_HANDLER_VARIANT(Renderables_Acquire));
-		SUBSCRIBE_TO_EVENT(EVENT_WORLD_UNLOAD, [this](Variant) { Clear(); });
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_SUBMIT, [this](const vector<shared_ptr<Actor>>& actors) { Renderables_Acquire(actors); RenderOnDemand_Request(); });
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_ACTOR_CHANGED, [this](const weak_ptr<Actor>& actor) { Renderables_OnActorChanged(actor, false); RenderOnDemand_Request(); });
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_ACTOR_REMOVED, [this](const weak_ptr<Actor>& actor) { Renderables_OnActorChanged(actor, true); RenderOnDemand_Request(); });
+		SUBSCRIBE_TO_EVENT(EVENT_MATERIAL_CHANGED, [this](const auto&) { lock_guard<mutex> lock(m_actorsChangedMutex); m_materialsChanged = true; RenderOnDemand_Request(); });
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_UNLOAD, [this](const auto&) { Renderables_Acquire({}); RenderOnDemand_Request(); });
 	}
 
 	Renderer::~Renderer()
@@ -97,19 +185,33 @@ namespace Directus
 	{
 		// Create/Get required systems		
 		g_resourceMng		= m_context->GetSubsystem<ResourceManager>();
+		g_streaming			= m_context->GetSubsystem<TextureStreaming>();
 
 		// Get standard resource directories
 		string fontDir			= g_resourceMng->GetStandardResourceDirectory(Resource_Font);
 		string shaderDirectory	= g_resourceMng->GetStandardResourceDirectory(Resource_Shader);
 		string textureDirectory = g_resourceMng->GetStandardResourceDirectory(Resource_Texture);
 
+		// Keep compiled shaders next to the project, so later launches skip the compiler
+		RHI_Shader::SetCacheDirectory(g_resourceMng->GetProjectDirectory() + "Shader_Cache//");
+
 		// Load a font (used for performance metrics)
 		m_font = make_unique<Font>(m_context, fontDir + "CalibriBold.ttf", 12, Vector4(0.7f, 0.7f, 0.7f, 1.0f));
 		// Make a grid (used in editor)
-		m_grid = make_unique<Grid>(m_rhiDevice);
+		m_grid = make_unique<Grid>();
 		// Light gizmo icon rectangle
 		m_gizmoRectLight = make_unique<Rectangle>(m_context);
 
+		// What a calibration run picked for this GPU, before the samplers take the anisotropy. Otherwise the defaults stay.
+		if (Settings::Get().Quality_IsCalibrated())
+		{
+			Quality_Apply(Settings::Get().Quality_Get(), Settings::Get().Quality_GetBudget(), Settings::Get().Quality_GetDynamicResolution());
+		}
+		else
+		{
+			LOG_INFO("Renderer::Initialize: Quality isn't calibrated for this GPU, run Benchmark -calibrate to pick a preset");
+		}
+
 		RenderTargets_Create(Settings::Get().Resolution_GetWidth(), Settings::Get().Resolution_GetHeight());
 
 		// SAMPLERS
@@ -122,22 +224,55 @@ namespace Directus
 			m_samplerAnisotropicWrapAlways	= make_shared<RHI_Sampler>(m_rhiDevice, Texture_Sampler_Anisotropic,	Texture_Address_Wrap,	Texture_Comparison_Always);
 		}
 
+		// INSTANCING
+		{
+			m_instanceBuffer = make_shared<RHI_ConstantBuffer>(m_rhiDevice);
+			m_instanceBuffer->CreateRing(sizeof(Struct_Instances), INSTANCE_RING_SIZE, 2, Buffer_VertexShader);
+		}
+
+		// G-BUFFER
+		{
+			m_gbufferFrameBuffer = make_shared<RHI_ConstantBuffer>(m_rhiDevice);
+			m_gbufferFrameBuffer->Create(sizeof(Struct_GBufferFrame), 3, Buffer_PixelShader);
+		}
+
 		// SHADERS
 		{
 			// Light
 			m_shaderLight = make_shared<LightShader>(m_rhiDevice);
 			m_shaderLight->Compile(shaderDirectory + "Light.hlsl", m_context);
+			m_shaderLightCheckerboard = make_shared<LightShader>(m_rhiDevice);
+			m_shaderLightCheckerboard->AddDefine("CHECKERBOARD");
+			m_shaderLightCheckerboard->Compile(shaderDirectory + "Light.hlsl", m_context);
+			m_lightClusters = make_unique<LightClusters>(m_rhiDevice);
+			m_shadowAtlas	= make_unique<ShadowAtlas>(m_rhiDevice, m_renderTexturePool);
+			m_reflectionProbes = make_unique<ReflectionProbes>(m_context, m_rhiDevice);
 
 			// Line
 			m_shaderLine = make_shared<RHI_Shader>(m_rhiDevice);
 			m_shaderLine->Compile_VertexPixel(shaderDirectory + "Line.hlsl", Input_PositionColor, m_context);
-			m_shaderLine->AddBuffer<Struct_Matrix>(0, Buffer_VertexShader);
+			m_shaderLine->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+			m_shaderLineInstanced = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderLineInstanced->AddDefine("INSTANCED");
+			m_shaderLineInstanced->Compile_VertexPixel(shaderDirectory + "Line.hlsl", Input_PositionColor, m_context);
+			m_debugDraw = make_unique<DebugDraw>(m_rhiDevice);
+
+			// Grid
+			m_shaderGrid = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderGrid->Compile_VertexPixel(shaderDirectory + "Grid.hlsl", Input_PositionTexture, m_context);
+			m_shaderGrid->AddBuffer<Struct_Grid>(0, Buffer_Global);
 
 			// Depth
 			m_shaderLightDepth = make_shared<RHI_Shader>(m_rhiDevice);
 			m_shaderLightDepth->Compile_VertexPixel(shaderDirectory + "ShadowingDepth.hlsl", Input_Position, m_context);
 			m_shaderLightDepth->AddBuffer<Struct_Matrix>(0, Buffer_VertexShader);
 
+			// Picking
+			m_shaderPicking = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderPicking->AddDefine("PICKING");
+			m_shaderPicking->Compile_VertexPixel(shaderDirectory + "ShadowingDepth.hlsl", Input_Position, m_context);
+			m_shaderPicking->AddBuffer<Struct_Matrix_Vector4>(0, Buffer_Global);
+
 			// Font
 			m_shaderFont = make_shared<RHI_Shader>(m_rhiDevice);
 			m_shaderFont->Compile_VertexPixel(shaderDirectory + "Font.hlsl", Input_PositionTexture, m_context);
@@ -154,41 +289,35 @@ namespace Directus
 			m_shaderFXAA->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
 			m_shaderFXAA->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
 
-			// Sharpening
-			m_shaderSharpening = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderSharpening->AddDefine("PASS_SHARPENING");
-			m_shaderSharpening->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
-			m_shaderSharpening->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
-
-			// Chromatic aberration
-			m_shaderChromaticAberration = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderChromaticAberration->AddDefine("PASS_CHROMATIC_ABERRATION");
-			m_shaderChromaticAberration->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
-			m_shaderChromaticAberration->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
-
 			// Blur Box
-			m_shaderBlurBox = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderBlurBox->AddDefine("PASS_BLUR_BOX");
-			m_shaderBlurBox->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
-			m_shaderBlurBox->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
-
-			// Blur Gaussian Horizontal
-			m_shaderBlurGaussianH = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderBlurGaussianH->AddDefine("PASS_BLUR_GAUSSIAN_H");
-			m_shaderBlurGaussianH->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
-			m_shaderBlurGaussianH->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
-
-			// Blur Gaussian Vertical
-			m_shaderBlurGaussianV = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderBlurGaussianV->AddDefine("PASS_BLUR_GAUSSIAN_V", "1");
-			m_shaderBlurGaussianV->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
-			m_shaderBlurGaussianV->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
-
-			// Bloom - bright
-			m_shaderBloom_Bright = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderBloom_Bright->AddDefine("PASS_BRIGHT", "1");
-			m_shaderBloom_Bright->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
-			m_shaderBloom_Bright->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+			m_shaderUpsampleBilateral = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderUpsampleBilateral->AddDefine("PASS_UPSAMPLE_BILATERAL");
+			m_shaderUpsampleBilateral->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
+			m_shaderUpsampleBilateral->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+
+			// Transparency composition
+			m_shaderCompositeOIT = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderCompositeOIT->AddDefine("PASS_COMPOSITE_OIT");
+			m_shaderCompositeOIT->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
+			m_shaderCompositeOIT->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+
+			// Bloom - downsample
+			m_shaderBloom_DownsampleBright = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderBloom_DownsampleBright->AddDefine("PASS_DOWNSAMPLE");
+			m_shaderBloom_DownsampleBright->AddDefine("PASS_BRIGHT");
+			m_shaderBloom_DownsampleBright->Compile_Compute(shaderDirectory + "Bloom.hlsl");
+			m_shaderBloom_DownsampleBright->AddBuffer<Struct_Bloom>(0, Buffer_ComputeShader);
+
+			m_shaderBloom_Downsample = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderBloom_Downsample->AddDefine("PASS_DOWNSAMPLE");
+			m_shaderBloom_Downsample->Compile_Compute(shaderDirectory + "Bloom.hlsl");
+			m_shaderBloom_Downsample->AddBuffer<Struct_Bloom>(0, Buffer_ComputeShader);
+
+			// Bloom - upsample
+			m_shaderBloom_Upsample = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderBloom_Upsample->AddDefine("PASS_UPSAMPLE");
+			m_shaderBloom_Upsample->Compile_Compute(shaderDirectory + "Bloom.hlsl");
+			m_shaderBloom_Upsample->AddBuffer<Struct_Bloom>(0, Buffer_ComputeShader);
 
 			// Bloom - blend
 			m_shaderBloom_BlurBlend = make_shared<RHI_Shader>(m_rhiDevice);
@@ -196,15 +325,26 @@ namespace Directus
 			m_shaderBloom_BlurBlend->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
 			m_shaderBloom_BlurBlend->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
 
-			// Tone-mapping
-			m_shaderCorrection = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderCorrection->AddDefine("PASS_CORRECTION");
-			m_shaderCorrection->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
-			m_shaderCorrection->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+			// Correction (tone-mapping & gamma), chromatic aberration and sharpening, one permutation for every combination
+			const unsigned long fusable[] = { Render_Correction, Render_ChromaticAberration, Render_Sharpening };
+			for (unsigned long combination = 1; combination < 8; combination++)
+			{
+				unsigned long flags = 0;
+				for (unsigned int i = 0; i < 3; i++) { flags |= (combination & (1UL << i)) ? fusable[i] : 0; }
+
+				auto shader = make_shared<RHI_Shader>(m_rhiDevice);
+				shader->AddDefine("PASS_FUSED");
+				shader->AddDefine("FUSED_CORRECTION",			(flags & Render_Correction)				? "1" : "0");
+				shader->AddDefine("FUSED_CHROMATIC_ABERRATION",	(flags & Render_ChromaticAberration)	? "1" : "0");
+				shader->AddDefine("FUSED_SHARPENING",			(flags & Render_Sharpening)				? "1" : "0");
+				shader->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
+				shader->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+				m_shadersPostFused[flags] = shader;
+			}
 
 			// Transformation gizmo
 			m_shaderTransformationGizmo = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderTransformationGizmo->Compile_VertexPixel(shaderDirectory + "TransformationGizmo.hlsl", Input_PositionTextureTBN, m_context);
+			m_shaderTransformationGizmo->Compile_VertexPixel(shaderDirectory + "TransformationGizmo.hlsl", Input_PositionTextureTBNPacked, m_context);
 			m_shaderTransformationGizmo->AddBuffer<Struct_Matrix_Vector3_Vector3>(0, Buffer_Global);
 
 			// Shadowing (shadow mapping & SSAO)
@@ -214,20 +354,141 @@ namespace Directus
 
 			// Transparent
 			m_shaderTransparent = make_shared<RHI_Shader>(m_rhiDevice);
-			m_shaderTransparent->Compile_VertexPixel(shaderDirectory + "Transparent.hlsl", Input_PositionTextureTBN, m_context);
+			m_shaderTransparent->Compile_VertexPixel(shaderDirectory + "Transparent.hlsl", Input_PositionTextureTBNPacked, m_context);
 			m_shaderTransparent->AddBuffer<Struct_Transparency>(0, Buffer_Global);
+
+			// G-Buffer fallback, a plain variation used while a material's own one is compiling
+			m_shaderFallback = make_shared<ShaderVariation>(m_rhiDevice, m_context);
+			m_shaderFallback->Compile(shaderDirectory + "GBuffer.hlsl", 0, false);
+
+			// G-Buffer depth pre-pass, the same vertex shader (so the depth matches exactly) with an empty pixel shader
+			m_shaderDepthPrepass = make_shared<ShaderVariation>(m_rhiDevice, m_context);
+			m_shaderDepthPrepass->AddDefine("DEPTH_PREPASS");
+			m_shaderDepthPrepass->Compile(shaderDirectory + "GBuffer.hlsl", 0, false);
+
+			// Downsample depth (occlusion culling)
+			m_shaderDownsampleDepth = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderDownsampleDepth->AddDefine("PASS_DOWNSAMPLE_DEPTH_MAX");
+			m_shaderDownsampleDepth->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
+			m_shaderDownsampleDepth->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+
+			m_shaderDownsampleDepthFirst = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderDownsampleDepthFirst->AddDefine("PASS_DOWNSAMPLE_DEPTH_MAX");
+			m_shaderDownsampleDepthFirst->AddDefine("DOWNSAMPLE_DEPTH_FIRST");
+			m_shaderDownsampleDepthFirst->Compile_VertexPixel(shaderDirectory + "PostProcess.hlsl", Input_PositionTexture, m_context);
+			m_shaderDownsampleDepthFirst->AddBuffer<Struct_Matrix_Vector2>(0, Buffer_Global);
+		}
+
+		// Screen space reflections
+		{
+			m_shaderSSR_Trace = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderSSR_Trace->AddDefine("PASS_TRACE");
+			m_shaderSSR_Trace->Compile_VertexPixel(shaderDirectory + "ScreenSpaceReflections.hlsl", Input_PositionTexture, m_context);
+			m_shaderSSR_Trace->AddBuffer<Struct_ScreenSpaceReflections>(0, Buffer_Global);
+
+			m_shaderSSR_Resolve = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderSSR_Resolve->AddDefine("PASS_RESOLVE");
+			m_shaderSSR_Resolve->Compile_VertexPixel(shaderDirectory + "ScreenSpaceReflections.hlsl", Input_PositionTexture, m_context);
+			m_shaderSSR_Resolve->AddBuffer<Struct_ScreenSpaceReflections>(0, Buffer_Global);
+
+			// Temporal anti-aliasing (and upscaling)
+			m_shaderTemporalAntialiasing = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderTemporalAntialiasing->Compile_VertexPixel(shaderDirectory + "TemporalAntialiasing.hlsl", Input_PositionTexture, m_context);
+			m_shaderTemporalAntialiasing->AddBuffer<Struct_TemporalAntialiasing>(0, Buffer_Global);
+
+			// Checkerboard lighting - resolve
+			m_shaderCheckerboardResolve = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderCheckerboardResolve->Compile_VertexPixel(shaderDirectory + "Checkerboard.hlsl", Input_PositionTexture, m_context);
+			m_shaderCheckerboardResolve->AddBuffer<Struct_Checkerboard>(0, Buffer_Global);
+
+			// GPU driven - the G-Buffer's vertex shader for indirect draws, the pixel shaders are the materials' own
+			m_shaderGBufferIndirect = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderGBufferIndirect->AddDefine("INDIRECT");
+			m_shaderGBufferIndirect->Compile_Vertex(shaderDirectory + "GBuffer.hlsl", Input_PositionTextureTBNPacked);
+
+			// GPU driven - culling, the passes share the culling buffer
+			m_shaderCulling_Reset = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderCulling_Reset->AddDefine("PASS_RESET");
+			m_shaderCulling_Reset->Compile_Compute(shaderDirectory + "Culling.hlsl");
+
+			m_shaderCulling_Cull = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderCulling_Cull->AddDefine("PASS_CULL");
+			m_shaderCulling_Cull->Compile_Compute(shaderDirectory + "Culling.hlsl");
+			m_shaderCulling_Cull->AddBuffer<Struct_Culling>(0, Buffer_ComputeShader);
+
+			m_shaderCulling_Cluster = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderCulling_Cluster->AddDefine("PASS_CLUSTER");
+			m_shaderCulling_Cluster->Compile_Compute(shaderDirectory + "Culling.hlsl");
+
+			// Skinning, poses skinned geometry for every pass that draws it
+			m_shaderSkinning = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderSkinning->Compile_Compute(shaderDirectory + "Skinning.hlsl");
+			m_shaderSkinning->AddBuffer<Struct_Skinning>(0, Buffer_ComputeShader);
+
+			// Particles, simulated on the compute shaders then drawn with the transparent surfaces
+			m_shaderParticles_Reset = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderParticles_Reset->AddDefine("PASS_RESET");
+			m_shaderParticles_Reset->Compile_Compute(shaderDirectory + "Particles.hlsl");
+
+			m_shaderParticles_Simulate = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderParticles_Simulate->AddDefine("PASS_SIMULATE");
+			m_shaderParticles_Simulate->Compile_Compute(shaderDirectory + "Particles.hlsl");
+			m_shaderParticles_Simulate->AddBuffer<GPUParticles::Simulation>(0, Buffer_ComputeShader);
+
+			m_shaderParticles = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderParticles->Compile_VertexPixel(shaderDirectory + "Particles.hlsl", Input_PositionTexture, m_context);
+			m_shaderParticles->AddBuffer<Struct_Particles>(0, Buffer_Global);
+
+			// Impostors, far away geometry drawn into the G-Buffer out of it's baked views
+			m_shaderImpostor = make_shared<RHI_Shader>(m_rhiDevice);
+			m_shaderImpostor->Compile_VertexPixel(shaderDirectory + "Impostor.hlsl", Input_PositionTexture, m_context);
+			m_shaderImpostor->AddBuffer<Struct_Impostors>(0, Buffer_Global);
 		}
 
 		// PIPELINE STATES
 		{
 			// Line
-			m_pipelineLine.primitiveTopology	= PrimitiveTopology_LineList;
-			m_pipelineLine.cullMode				= Cull_Back;
-			m_pipelineLine.fillMode				= Fill_Solid;
-			m_pipelineLine.vertexShader			= m_shaderLine;
-			m_pipelineLine.pixelShader			= m_shaderLine;
-			m_pipelineLine.constantBuffer		= m_shaderLine->GetConstantBuffer();
-			m_pipelineLine.sampler				= m_samplerPointClampGreater;
+			RHI_PipelineState line;
+			line.primitiveTopology	= PrimitiveTopology_LineList;
+			line.cullMode			= Cull_Back;
+			line.fillMode			= Fill_Solid;
+			line.vertexShader		= m_shaderLine;
+			line.pixelShader		= m_shaderLine;
+			line.constantBuffer		= m_shaderLine->GetConstantBuffer();
+			line.sampler			= m_samplerPointClampGreater;
+			m_pipelineLine			= m_pipelineCache->GetState(line);
+
+			// Grid, a blended full screen quad
+			RHI_PipelineState grid;
+			grid.primitiveTopology	= PrimitiveTopology_TriangleList;
+			grid.cullMode			= Cull_Back;
+			grid.fillMode			= Fill_Solid;
+			grid.blendMode			= Blend_Alpha;
+			grid.vertexShader		= m_shaderGrid;
+			grid.pixelShader		= m_shaderGrid;
+			grid.constantBuffer		= m_shaderGrid->GetConstantBuffer();
+			grid.sampler			= m_samplerPointClampGreater;
+			m_pipelineGrid			= m_pipelineCache->GetState(grid);
+
+			// Transparent, cull mode comes from the material. Surfaces only test against the depth, so the ones
+			// behind other transparent ones still get accumulated.
+			RHI_PipelineState transparent;
+			transparent.primitiveTopology	= PrimitiveTopology_TriangleList;
+			transparent.fillMode			= Fill_Solid;
+			transparent.blendMode			= Blend_WeightedOIT;
+			transparent.depthWrite			= false;
+			transparent.vertexShader		= m_shaderTransparent;
+			transparent.pixelShader			= m_shaderTransparent;
+			transparent.sampler				= m_samplerLinearClampGreater;
+			m_pipelineTransparent			= m_pipelineCache->GetState(transparent);
+
+			// Particles, camera facing quads accumulated like the transparent surfaces
+			RHI_PipelineState particles		= transparent;
+			particles.cullMode				= Cull_None;
+			particles.vertexShader			= m_shaderParticles;
+			particles.pixelShader			= m_shaderParticles;
+			particles.constantBuffer		= m_shaderParticles->GetConstantBuffer();
+			m_pipelineParticles				= m_pipelineCache->GetState(particles);
 		}
 
 		// TEXTURES
@@ -260,7 +521,7 @@ namespace Directus
 
 	void* Renderer::GetFrameShaderResource()
 	{
-		return m_renderTex3 ? m_renderTex3->GetShaderResource() : nullptr;
+		return m_renderTexFrame ? m_renderTexFrame->GetShaderResource() : nullptr;
 	}
 
 	void Renderer::Present()
@@ -270,26 +531,100 @@ namespace Directus
 
 	void Renderer::Render()
 	{
-		TIME_BLOCK_START_MULTI();
-
 		if (!m_rhiDevice || !m_rhiDevice->IsInitialized())
 			return;
 
+		// The frame texture keeps showing the last frame, what got submitted for this one goes
+		if (RenderOnDemand_IsIdle())
+		{
+			m_debugDraw->Discard();
+			return;
+		}
+
+		TIME_BLOCK_SCOPED_MULTI();
+		MEMORY_TAG(MemoryTag_Renderer);
+
 		m_isRendering = true;
 		Profiler::Get().Reset();
 		m_frame++;
+		m_renderTexturePool->Tick();
+		m_readback->Poll();
+		RHI_Capture::Get().Frame(); // a requested capture starts, counts or finishes with the frame
+
+		// Bring the renderable lists up to date with whatever changed since the last frame
+		Renderables_ProcessChanges();
+		m_reflectionProbes->Collect();
 
 		// If there is a camera, render the scene
 		if (m_camera)
 		{
-			m_mV					= m_camera->GetViewMatrix();
-			m_mV_base				= m_camera->GetBaseViewMatrix();
-			m_mP_perspective		= m_camera->GetProjectionMatrix();
+			// When pipelined the camera is already simulating the next frame, so this one renders from the snapshot
+			const auto& snapshot	= m_snapshots[m_snapshotRender];
+			bool fromSnapshot		= m_pipelined && snapshot.camera;
+			m_mV					= fromSnapshot ? snapshot.view		: m_camera->GetViewMatrix();
+			m_mV_base				= fromSnapshot ? snapshot.viewBase	: m_camera->GetBaseViewMatrix();
+			m_mP_perspective		= fromSnapshot ? snapshot.projection	: m_camera->GetProjectionMatrix();
 			m_mP_orthographic		= Matrix::CreateOrthographicLH((float)Settings::Get().Resolution_GetWidth(), (float)Settings::Get().Resolution_GetHeight(), m_nearPlane, m_farPlane);		
-			m_wvp_perspective		= m_mV * m_mP_perspective;
 			m_wvp_baseOrthographic	= m_mV_base * m_mP_orthographic;
-			m_nearPlane				= m_camera->GetNearPlane();
-			m_farPlane				= m_camera->GetFarPlane();
+			m_nearPlane				= fromSnapshot ? snapshot.nearPlane	: m_camera->GetNearPlane();
+			m_farPlane				= fromSnapshot ? snapshot.farPlane	: m_camera->GetFarPlane();
+
+			// Anything moved since the World ticked (the editor) gets re-fitted, then the tree gets culled against the camera and the views
+			if (!m_pipelined)
+			{
+				auto world = m_context->GetSubsystem<World>();
+				world->Spatial_Update();
+				Views_Capture(m_snapshots[m_snapshotRender], m_camera);
+				Renderables_Cull(m_snapshots[m_snapshotRender], m_camera->GetFrustum());
+			}
+
+			// Depth testing follows the camera's projection, a switch leaves nothing to reproject from
+			if (m_rhiDevice->Get_DepthReverse() != m_camera->IsReverseZ())
+			{
+				m_rhiDevice->Set_DepthReverse(m_camera->IsReverseZ());
+				m_taaHistoryValid = false;
+			}
+			m_mVP_previous			= m_taaHistoryValid ? m_mVP_unjittered : m_mV * m_mP_perspective;
+			m_mVP_unjittered		= m_mV * m_mP_perspective;
+
+			// Relative to the camera, last frame's view projection is moved by how far the origin moved since (the World's origin included)
+			Vector3 origin				= RenderFlags_IsSet(Render_CameraRelative) ? Camera_GetPosition() : Vector3::Zero;
+			WorldPosition originWorld	= (fromSnapshot ? snapshot.origin : m_context->GetSubsystem<World>()->Origin_Get()) + WorldPosition(origin);
+			Vector3 originMoved			= (originWorld - m_originWorld).ToVector3();
+			m_origin					= origin;
+			m_originWorld				= originWorld;
+			m_mV_origin					= Matrix::CreateTranslation(m_origin) * m_mV;
+			m_mVP_previous_origin		= m_taaHistoryValid ? Matrix::CreateTranslation(originMoved) * m_mVP_unjittered_origin : m_mV_origin * m_mP_perspective;
+			m_mVP_unjittered_origin		= m_mV_origin * m_mP_perspective;
+
+			// Pick the resolution the G-Buffer and lighting render at
+			DynamicResolution_Update();
+
+			// Temporal anti-aliasing accumulates a different sub-pixel offset every frame, the offset is a pixel of the rendered resolution at most
+			m_taaJitter = Vector2::Zero;
+			if (RenderFlags_IsSet(Render_TAA))
+			{
+				unsigned int sample	= (unsigned int)(m_frame % TAA_JITTER_SAMPLES) + 1;
+				float width			= Settings::Get().Resolution_GetWidth() * m_dynamicResolutionScale;
+				float height		= Settings::Get().Resolution_GetHeight() * m_dynamicResolutionScale;
+				m_taaJitter			= Vector2((Halton(sample, 2) - 0.5f) * 2.0f / width, (Halton(sample, 3) - 0.5f) * 2.0f / height);
+				m_mP_perspective	= m_mP_perspective * Matrix::CreateTranslation(Vector3(m_taaJitter.x, m_taaJitter.y, 0.0f));
+			}
+			else
+			{
+				m_taaHistoryValid = false;
+			}
+			m_wvp_perspective = m_mV * m_mP_perspective;
+
+			// Shaders derive NDC from the texture coordinates of the scaled quad, so they span less than -1 to 1. Stretch them
+			// back before un-projecting, x' = (x + 1) / scale - 1 and y' = 1 - (1 - y) / scale (y points up in NDC).
+			float scaleInv		= 1.0f / m_dynamicResolutionScale;
+			Matrix ndcRemap		= Matrix::CreateScale(scaleInv, scaleInv, 1.0f) * Matrix::CreateTranslation(Vector3(scaleInv - 1.0f, 1.0f - scaleInv, 0.0f));
+			m_mVP_inverseScaled	= ndcRemap * m_wvp_perspective.Inverted();
+
+			// Order this view's draws
+			Renderables_Sort(&m_actors[Renderable_ObjectOpaque], false);
+			Renderables_Sort(&m_actors[Renderable_ObjectTransparent], true);
 
 			// If there is nothing to render clear to camera's color and present
 			if (m_actors.empty())
@@ -300,29 +635,9 @@ namespace Directus
 				return;
 			}
 
-			Pass_DepthDirectionalLight(GetLightDirectional());
-		
-			Pass_GBuffer();
-
-			Pass_PreLight(
-				m_renderTex1,			// IN:	Render texture		
-				m_renderTexShadowing	// OUT: Render texture	- Shadowing (Shadow mapping + SSAO)
-			);
-
-			Pass_Light(
-				m_renderTexShadowing,	// IN:	Texture			- Shadowing (Shadow mapping + SSAO)
-				m_renderTex1			// OUT: Render texture	- Result
-			);
-
-			Pass_PostLight(
-				m_renderTex1,	// IN:	Render texture - Light pass result
-				m_renderTex3	// OUT: Render texture - Result
-			);
-
-			Pass_Transparent(m_renderTex3);
-			Pass_DebugGBuffer(m_renderTex3);
-			// Debug rendering (on the target that happens to be bound)
-			Pass_Debug();
+			// The main camera first, then the views, they share the shadow maps and whatever else persists
+			Render_Graph(m_renderTexFrame, false);
+			Views_Render();
 		}		
 		else // If there is no camera, clear to black
 		{
@@ -330,8 +645,144 @@ namespace Directus
 		}
 
 		m_isRendering = false;
+	}
+
+	void Renderer::Render_Graph(const shared_ptr<RHI_RenderTexture>& target, bool view)
+	{
+		// Declare this frame's passes and the resources they use, the render graph
+		// will cull what's not needed and recycle transient render textures between passes.
+		auto& graph		= *m_renderGraph;
+		auto width		= (unsigned int)Settings::Get().Resolution_GetWidth();
+		auto height		= (unsigned int)Settings::Get().Resolution_GetHeight();
+		auto frame		= graph.Resource_Import("Frame", target);
+		bool scaled		= m_dynamicResolutionScale < 1.0f;
+
+		// A view draws what the main camera already prepared, the skinned vertices and the shadow maps
+		if (!view)
+		{
+			// Skinned vertices are written once, everything after draws them
+			graph.Pass_Add("Pass_Skinning", {}, {}, [this]() { Pass_Skinning(); });
+
+			// GPU driven culling only needs an earlier frame's depth, so it runs on the compute queue alongside the shadow maps
+			if (RenderFlags_IsSet(Render_GPUDriven) && Pass_GBuffer_Indirect_IsSupported())
+			{
+				graph.Pass_Add("Pass_Culling", {}, {}, [this]() { Pass_Culling(); });
+			}
+
+			graph.Pass_Add("Pass_DepthDirectionalLight", {}, {}, [this]() { Pass_DepthDirectionalLight(GetLightDirectional()); });
+			graph.Pass_Add("Pass_DepthLocalLights", {}, {}, [this]() { Pass_DepthLocalLights(); });
+		}
+
+		// Shadow maps and the G-Buffer are persistent, they are written as a side effect
+		graph.Pass_Add("Pass_GBuffer", {}, {}, [this]() { Pass_GBuffer(); });
+		if (!view && Pick_IsSupported())
+		{
+			graph.Pass_Add("Pass_Picking", {}, {}, [this]() { Pass_Picking(); });
+		}
+
+		// Passes that run at full resolution expect depth to cover the whole target, so a scaled one gets upscaled
+		auto depth = graph.Resource_Import("Depth", m_gbuffer->GetTexture(GBuffer_Target_Depth));
+		if (scaled)
+		{
+			auto depthScaled	= depth;
+			depth				= graph.Resource_CreateTransient("Depth_Upscaled", width, height, Texture_Format_R32G32_FLOAT);
+			graph.Pass_Add("Pass_UpscaleDepth", { depthScaled }, { depth }, [this, depthScaled, depth]()
+			{
+				Pass_Upscale(m_renderGraph->Resource_Get(depthScaled), m_renderGraph->Resource_Get(depth), true);
+			});
+		}
+		if (!view)
+		{
+			graph.Pass_Add("Pass_DepthPyramid", { depth }, {}, [this, depth]() { Pass_DepthPyramid(m_renderGraph->Resource_Get(depth)); });
+		}
+
+		// Reflections read the pyramid and the last frame, before the light pass overwrites it
+		if (!view && RenderFlags_IsSet(Render_SSR) && Pass_ScreenSpaceReflections_IsSupported())
+		{
+			auto trace = graph.Resource_CreateTransient("SSR_Trace", width / 2, height / 2, Texture_Format_R16G16B16A16_FLOAT);
+			graph.Pass_Add("Pass_ScreenSpaceReflections", { depth, frame }, { trace }, [this, trace]()
+			{
+				Pass_ScreenSpaceReflections(m_renderGraph->Resource_Get(trace));
+			});
+			graph.Pass_Add("Pass_ScreenSpaceReflections_Resolve", { trace }, {}, [this, trace]()
+			{
+				Pass_ScreenSpaceReflections_Resolve(m_renderGraph->Resource_Get(trace));
+			});
+		}
+		else if (!view)
+		{
+			m_ssrHistoryScale = 0.0f;
+		}
+
+		// Shadowing (Shadow mapping + SSAO) at half resolution, blurred to full resolution
+		auto shadowing			= graph.Resource_CreateTransient("Shadowing", width / 2, height / 2, Texture_Format_R32G32_FLOAT);
+		auto shadowingBlurred	= graph.Resource_CreateTransient("Shadowing_Blurred", width, height, Texture_Format_R16G16B16A16_FLOAT);
+		graph.Pass_Add("Pass_PreLight", {}, { shadowing, shadowingBlurred }, [this, shadowing, shadowingBlurred]()
+		{
+			Pass_PreLight(m_renderGraph->Resource_Get(shadowingBlurred), m_renderGraph->Resource_Get(shadowing));
+		});
+
+		// Light, outputs straight to the frame when there is no post-processing. Reflection probes capture it as is, linear and unclamped.
+		bool probeCapture	= view && m_snapshots[m_snapshotRender].views[m_viewRendering].probeCapture != 0;
+		bool postProcess	= !probeCapture && (RenderFlags_IsSet(Render_Bloom) && Pass_Bloom_IsSupported()) || RenderFlags_IsSet(Render_Correction) || RenderFlags_IsSet(Render_FXAA) || RenderFlags_IsSet(Render_ChromaticAberration) || RenderFlags_IsSet(Render_Sharpening);
+		auto light			= postProcess ? graph.Resource_CreateTransient("Light", width, height, Texture_Format_R16G16B16A16_FLOAT) : frame;
+		bool temporal		= !view && RenderFlags_IsSet(Render_TAA);
+		auto lightRaw		= (scaled || temporal) ? graph.Resource_CreateTransient("Light_Raw", width, height, Texture_Format_R16G16B16A16_FLOAT) : light;
+
+		// Checkerboard lights a half width target, then resolves it to lightRaw
+		bool checkerboard	= !view && RenderFlags_IsSet(Render_Checkerboard) && Pass_Checkerboard_IsSupported();
+		auto lightLit		= checkerboard ? graph.Resource_CreateTransient("Light_Checkerboard", (width + 1) / 2, height, Texture_Format_R16G16B16A16_FLOAT) : lightRaw;
+		graph.Pass_Add("Pass_Light", { shadowingBlurred, frame }, { lightLit }, [this, shadowingBlurred, lightLit, checkerboard]()
+		{
+			Pass_Light(m_renderGraph->Resource_Get(shadowingBlurred), m_renderGraph->Resource_Get(lightLit), checkerboard);
+		});
+		if (checkerboard)
+		{
+			graph.Pass_Add("Pass_CheckerboardResolve", { lightLit }, { lightRaw }, [this, lightLit, lightRaw]()
+			{
+				Pass_CheckerboardResolve(m_renderGraph->Resource_Get(lightLit), m_renderGraph->Resource_Get(lightRaw));
+			});
+		}
+		else if (!view)
+		{
+			m_checkerboardHistoryScale = 0.0f;
+		}
+
+		// Resolve the rendered sub-rect to the whole target, everything from here on runs at full resolution
+		if (temporal)
+		{
+			graph.Pass_Add("Pass_TemporalAntialiasing", { lightRaw }, { light }, [this, lightRaw, light]()
+			{
+				Pass_TemporalAntialiasing(m_renderGraph->Resource_Get(lightRaw), m_renderGraph->Resource_Get(light));
+			});
+		}
+		else if (scaled)
+		{
+			graph.Pass_Add("Pass_Upscale", { lightRaw }, { light }, [this, lightRaw, light]()
+			{
+				Pass_Upscale(m_renderGraph->Resource_Get(lightRaw), m_renderGraph->Resource_Get(light), false);
+			});
+		}
+
+		if (postProcess)
+		{
+			Pass_PostLight(light, frame);
+		}
+
+		auto transparentAccumulation	= graph.Resource_CreateTransient("Transparent_Accumulation", width, height, Texture_Format_R16G16B16A16_FLOAT);
+		auto transparentRevealage		= graph.Resource_CreateTransient("Transparent_Revealage", width, height, Texture_Format_R16_FLOAT);
+		graph.Pass_Add("Pass_Transparent", { frame, depth }, { frame, transparentAccumulation, transparentRevealage }, [this, frame, depth, transparentAccumulation, transparentRevealage]()
+		{
+			Pass_Transparent(m_renderGraph->Resource_Get(frame), m_renderGraph->Resource_Get(depth), m_renderGraph->Resource_Get(transparentAccumulation), m_renderGraph->Resource_Get(transparentRevealage));
+		});
+		if (!view)
+		{
+			graph.Pass_Add("Pass_DebugGBuffer", { frame }, { frame }, [this]() { Pass_DebugGBuffer(m_renderTexFrame); });
+			// Debug rendering (on the target that happens to be bound)
+			graph.Pass_Add("Pass_Debug", { frame, depth }, { frame }, [this, depth]() { Pass_Debug(m_renderGraph->Resource_Get(depth)); });
+		}
 
-		TIME_BLOCK_END_MULTI();
+		graph.Execute();
 	}
 
 	void Renderer::SetBackBufferSize(int width, int height)
@@ -368,99 +819,324 @@ namespace Directus
 
 	void Renderer::AddBoundigBox(const BoundingBox& box, const Vector4& color)
 	{
-		// Compute points from min and max
-		Vector3 boundPoint1 = box.GetMin();
-		Vector3 boundPoint2 = box.GetMax();
-		Vector3 boundPoint3 = Vector3(boundPoint1.x, boundPoint1.y, boundPoint2.z);
-		Vector3 boundPoint4 = Vector3(boundPoint1.x, boundPoint2.y, boundPoint1.z);
-		Vector3 boundPoint5 = Vector3(boundPoint2.x, boundPoint1.y, boundPoint1.z);
-		Vector3 boundPoint6 = Vector3(boundPoint1.x, boundPoint2.y, boundPoint2.z);
-		Vector3 boundPoint7 = Vector3(boundPoint2.x, boundPoint1.y, boundPoint2.z);
-		Vector3 boundPoint8 = Vector3(boundPoint2.x, boundPoint2.y, boundPoint1.z);
-
-		// top of rectangular cuboid (6-2-8-4)
-		AddLine(boundPoint6, boundPoint2, color);
-		AddLine(boundPoint2, boundPoint8, color);
-		AddLine(boundPoint8, boundPoint4, color);
-		AddLine(boundPoint4, boundPoint6, color);
-
-		// bottom of rectangular cuboid (3-7-5-1)
-		AddLine(boundPoint3, boundPoint7, color);
-		AddLine(boundPoint7, boundPoint5, color);
-		AddLine(boundPoint5, boundPoint1, color);
-		AddLine(boundPoint1, boundPoint3, color);
-
-		// legs (6-3, 2-7, 8-5, 4-1)
-		AddLine(boundPoint6, boundPoint3, color);
-		AddLine(boundPoint2, boundPoint7, color);
-		AddLine(boundPoint8, boundPoint5, color);
-		AddLine(boundPoint4, boundPoint1, color);
+		m_debugDraw->Box(box, color);
+	}
+
+	bool Renderer::RenderOnDemand_IsIdle()
+	{
+		// Either way, this is the state rendering goes from
+		const auto& snapshot		= m_snapshots[m_snapshotRender];
+		bool fromSnapshot			= m_pipelined && snapshot.camera;
+		const Matrix& view			= fromSnapshot ? snapshot.view : (m_camera ? m_camera->GetViewMatrix() : Matrix::Identity);
+		const Matrix& projection	= fromSnapshot ? snapshot.projection : (m_camera ? m_camera->GetProjectionMatrix() : Matrix::Identity);
+		auto world					= m_context->GetSubsystem<World>();
+		unsigned int transforms		= world ? world->Transforms_GetRevision() : 0;
+		const Vector2& resolution	= Settings::Get().Resolution_Get();
+		auto now					= chrono::steady_clock::now();
+
+		bool changed =
+			m_renderOnDemandRequested.exchange(false)	||
+			view != m_renderOnDemandView				||
+			projection != m_renderOnDemandProjection	||
+			transforms != m_renderOnDemandTransforms	||
+			m_flags != m_renderOnDemandFlags			||
+			m_renderOnDemandResolution != resolution	||
+			m_reflectionProbes->IsCapturing()			||
+			m_readback->GetPendingCount() != 0; // frames have to go by for them to come back
+		if (changed)
+		{
+			m_renderOnDemandView		= view;
+			m_renderOnDemandProjection	= projection;
+			m_renderOnDemandTransforms	= transforms;
+			m_renderOnDemandFlags		= m_flags;
+			m_renderOnDemandResolution	= resolution;
+			m_renderOnDemandFrames		= RENDER_ON_DEMAND_FRAMES;
+		}
+
+		// Always rendering in game mode, or without a camera (nothing to compare)
+		if (!Settings::Get().RenderOnDemand_Get() || Engine::EngineMode_IsSet(Engine_Game) || !m_camera)
+			return false;
+
+		// What animates by itself (particles, scrolling materials, resources that finished loading) shows up once in a while
+		if (m_renderOnDemandFrames == 0 && chrono::duration<float>(now - m_renderOnDemandTime).count() >= Settings::Get().RenderOnDemand_GetRefresh())
+		{
+			m_renderOnDemandFrames = 1;
+		}
+
+		if (m_renderOnDemandFrames == 0)
+			return true;
+
+		m_renderOnDemandFrames--;
+		m_renderOnDemandTime = now;
+		return false;
+	}
+
+	void Renderer::Pick_Request(const Vector2& pixel)
+	{
+		{
+			lock_guard<mutex> lock(m_pickMutex);
+			m_pickRequested	= true;
+			m_pickAnswered	= false;
+			m_pickReadback	= 0; // supersedes one in flight
+			m_pickPixel		= pixel;
+		}
+
+		RenderOnDemand_Request();
+	}
+
+	bool Renderer::Pick_Get(unsigned int* actorID)
+	{
+		lock_guard<mutex> lock(m_pickMutex);
+		if (!m_pickAnswered)
+			return false;
+
+		m_pickAnswered = false;
+		if (actorID)
+		{
+			*actorID = m_pickActorID;
+		}
+
+		return true;
+	}
+
+	bool Renderer::Pick_IsSupported()
+	{
+		return m_shaderPicking && m_shaderPicking->GetState() == Shader_Built;
+	}
+
+	void Renderer::Pick_Resolve(unsigned int request, const vector<unsigned char>& data)
+	{
+		if (data.size() < sizeof(float))
+			return;
+
+		float index = 0.0f;
+		memcpy(&index, data.data(), sizeof(float));
+
+		lock_guard<mutex> lock(m_pickMutex);
+		if (request != m_pickReadback)
+			return;
+
+		auto actor		= (unsigned int)index;
+		m_pickActorID	= (actor != 0 && actor <= (unsigned int)m_pickActors.size()) ? m_pickActors[actor - 1] : 0;
+		m_pickAnswered	= true;
+		m_pickReadback	= 0;
 	}
 
 	void Renderer::AddLine(const Vector3& from, const Vector3& to, const Vector4& colorFrom, const Vector4& colorTo)
 	{
-		m_lineVertices.emplace_back(from, colorFrom);
-		m_lineVertices.emplace_back(to, colorTo);
+		m_debugDraw->Line(from, to, colorFrom, colorTo);
 	}
 
 	void Renderer::Clear()
 	{
 		m_actors.clear();
 		m_camera = nullptr;
+		m_shadowCasters.clear();
+		m_sortKeys.clear();
+		m_actorsAlive.clear();
+		m_taaHistoryValid = false;
+		m_impostors->Clear();
 	}
 
 	void Renderer::RenderTargets_Create(int width, int height)
 	{
 		// Resize everything
 		m_gbuffer.reset();
-		m_gbuffer = make_unique<GBuffer>(m_rhiDevice, width, height);
+		m_gbuffer = make_unique<GBuffer>(m_renderTexturePool, width, height);
+		{
+			// A pick in flight was drawn into the previous G-Buffer's ID target
+			lock_guard<mutex> lock(m_pickMutex);
+			m_pickReadback = 0;
+		}
 
 		m_quad.reset();
 		m_quad = make_unique<Rectangle>(m_context);
 		m_quad->Create(0, 0, (float)width, (float)height);
 
-		m_renderTex1.reset();
-		m_renderTex1 = make_unique<RHI_RenderTexture>(m_rhiDevice, width, height, Texture_Format_R16G16B16A16_FLOAT);
+		m_quadScaled.reset();
+		m_quadScaled = make_unique<Rectangle>(m_context);
+		m_quadScaled->Create(0, 0, (float)width, (float)height, m_dynamicResolutionScale);
+
+		// Return the previous resolution's textures, the pool hands them out again or evicts them
+		// once the GPU is done with them, so resizing back and forth doesn't re-allocate every time
+		if (m_renderTexFrame)				m_renderTexturePool->Release(m_renderTexFrame);
+		if (m_renderTexHistory)				m_renderTexturePool->Release(m_renderTexHistory);
+		if (m_renderTexHistoryPrevious)		m_renderTexturePool->Release(m_renderTexHistoryPrevious);
+		if (m_renderTexCheckerboard)			m_renderTexturePool->Release(m_renderTexCheckerboard);
+		if (m_renderTexCheckerboardPrevious)	m_renderTexturePool->Release(m_renderTexCheckerboardPrevious);
+		if (m_renderTexSSR)					m_renderTexturePool->Release(m_renderTexSSR);
+		if (m_renderTexSSRPrevious)			m_renderTexturePool->Release(m_renderTexSSRPrevious);
+		for (const auto& texture : m_renderTexBloomDownsampled)	m_renderTexturePool->Release(texture);
+		for (const auto& texture : m_renderTexBloomUpsampled)	m_renderTexturePool->Release(texture);
+
+		m_renderTexFrame			= m_renderTexturePool->Acquire(width, height, Texture_Format_R16G16B16A16_FLOAT);
+		m_renderTexHistory			= m_renderTexturePool->Acquire(width, height, Texture_Format_R16G16B16A16_FLOAT);
+		m_renderTexHistoryPrevious	= m_renderTexturePool->Acquire(width, height, Texture_Format_R16G16B16A16_FLOAT);
+		m_taaHistoryValid			= false;
+
+		m_renderTexCheckerboard			= m_renderTexturePool->Acquire(width, height, Texture_Format_R16G16B16A16_FLOAT);
+		m_renderTexCheckerboardPrevious	= m_renderTexturePool->Acquire(width, height, Texture_Format_R16G16B16A16_FLOAT);
+		m_checkerboardHistoryScale		= 0.0f;
+
+		m_renderTexSSR			= m_renderTexturePool->Acquire(width / 2, height / 2, Texture_Format_R16G16B16A16_FLOAT);
+		m_renderTexSSRPrevious	= m_renderTexturePool->Acquire(width / 2, height / 2, Texture_Format_R16G16B16A16_FLOAT);
+		m_ssrHistoryScale		= 0.0f;
+
+		// Views render at the same resolution
+		{
+			lock_guard<mutex> lock(m_viewsMutex);
+			for (auto& view : m_views)
+			{
+				if (!view.alive)
+					continue;
+
+				m_renderTexturePool->Release(view.target);
+				view.target = m_renderTexturePool->Acquire(width, height, Texture_Format_R16G16B16A16_FLOAT);
+			}
+		}
+
+		// Bloom mip chain, written by compute shaders so it can't come from the render graph
+		m_renderTexBloomDownsampled.clear();
+		m_renderTexBloomUpsampled.clear();
+		for (unsigned int i = 0; i < BLOOM_MIP_COUNT; i++)
+		{
+			int levelWidth	= Max(width >> (i + 1), 1);
+			int levelHeight	= Max(height >> (i + 1), 1);
+			m_renderTexBloomDownsampled.emplace_back(m_renderTexturePool->Acquire(levelWidth, levelHeight, Texture_Format_R16G16B16A16_FLOAT, false, Texture_Format_D32_FLOAT, true));
+			// The smallest level has nothing below it to upsample
+			if (i < BLOOM_MIP_COUNT - 1)
+			{
+				m_renderTexBloomUpsampled.emplace_back(m_renderTexturePool->Acquire(levelWidth, levelHeight, Texture_Format_R16G16B16A16_FLOAT, false, Texture_Format_D32_FLOAT, true));
+			}
+		}
+
+		m_occlusionCulling->Resize(width, height);
+		m_gpuCulling->Occluder_Set(Matrix::Identity, 0.0f); // the new pyramid holds no depth yet
+	}
+
+	//= DYNAMIC RESOLUTION =====================================================================================
+	void Renderer::DynamicResolution_Update()
+	{
+		float gpuTime = Profiler::Get().GetRenderTime_GPU();
+		if (!RenderFlags_IsSet(Render_DynamicResolution))
+		{
+			m_dynamicResolutionTarget = 1.0f;
+		}
+		else if (gpuTime > 0.0f && gpuTime != m_dynamicResolutionGpuTime) // the profiler only takes a reading every now and then
+		{
+			// The cost goes with the pixel count, so the scale that meets the budget goes with the square root of the time ratio.
+			// Only move half way there, a single slow frame shouldn't make the resolution jump.
+			float scale					= m_dynamicResolutionScale * sqrt(m_dynamicResolutionBudget * DYNAMIC_RESOLUTION_HEADROOM / gpuTime);
+			m_dynamicResolutionTarget	= Clamp(Lerp(m_dynamicResolutionTarget, scale, 0.5f), DYNAMIC_RESOLUTION_MIN, 1.0f);
+		}
+		m_dynamicResolutionGpuTime = gpuTime;
+
+		// Follow the target only once it's a full step away (or back at full resolution)
+		if (Abs(m_dynamicResolutionTarget - m_dynamicResolutionScale) >= DYNAMIC_RESOLUTION_STEP || m_dynamicResolutionTarget == 1.0f)
+		{
+			m_dynamicResolutionScale = Clamp(Round(m_dynamicResolutionTarget / DYNAMIC_RESOLUTION_STEP) * DYNAMIC_RESOLUTION_STEP, DYNAMIC_RESOLUTION_MIN, 1.0f);
+		}
+
+		// Texture coordinates that stop at the edge of the rendered sub-rect
+		float width		= (float)Settings::Get().Resolution_GetWidth();
+		float height	= (float)Settings::Get().Resolution_GetHeight();
+		m_quadScaled->Create(0, 0, width, height, m_dynamicResolutionScale);
+	}
 
-		m_renderTex2.reset();
-		m_renderTex2 = make_unique<RHI_RenderTexture>(m_rhiDevice, width, height, Texture_Format_R16G16B16A16_FLOAT);
+	RHI_Viewport Renderer::DynamicResolution_GetViewport(const shared_ptr<RHI_RenderTexture>& target)
+	{
+		const auto& viewport = target->GetViewport();
+		return RHI_Viewport(
+			viewport.GetTopLeftX(),
+			viewport.GetTopLeftY(),
+			viewport.GetWidth() * m_dynamicResolutionScale,
+			viewport.GetHeight() * m_dynamicResolutionScale,
+			viewport.GetMinDepth(),
+			viewport.GetMaxDepth()
+		);
+	}
+	//==========================================================================================================
 
-		m_renderTex3.reset();
-		m_renderTex3 = make_unique<RHI_RenderTexture>(m_rhiDevice, width, height, Texture_Format_R16G16B16A16_FLOAT);
+	//= QUALITY ================================================================================================
+	void Renderer::Quality_Apply(Quality quality, float budgetMs, bool dynamicResolution)
+	{
+		const auto& preset = _Renderer::qualityPresets[Clamp((int)quality, 0, (int)Quality_Count - 1)];
+		m_flags = (m_flags & ~Quality_GetFlagsMask()) | preset.flags;
+		m_flags = dynamicResolution ? (m_flags | Render_DynamicResolution) : (m_flags & ~Render_DynamicResolution);
+		m_dynamicResolutionBudget = budgetMs;
+		Settings::Get().Shadows_SetResolution(preset.shadowResolution);
+		Settings::Get().Anisotropy_Set(preset.anisotropy);
+		RenderOnDemand_Request();
+
+		LOGF_INFO("Renderer::Quality_Apply: %s, %.1f ms budget%s", preset.name, budgetMs, dynamicResolution ? ", dynamic resolution" : "");
+	}
 
-		m_renderTexQuarterRes1.reset();
-		m_renderTexQuarterRes1 = make_unique<RHI_RenderTexture>(m_rhiDevice, int(width * 0.25f), int(height * 0.25f), Texture_Format_R16G16B16A16_FLOAT);
+	unsigned long Renderer::Quality_GetFlags(Quality quality)
+	{
+		return _Renderer::qualityPresets[Clamp((int)quality, 0, (int)Quality_Count - 1)].flags;
+	}
 
-		m_renderTexQuarterRes2.reset();
-		m_renderTexQuarterRes2 = make_unique<RHI_RenderTexture>(m_rhiDevice, int(width * 0.25f), int(height * 0.25f), Texture_Format_R16G16B16A16_FLOAT);
+	unsigned long Renderer::Quality_GetFlagsMask()
+	{
+		return Render_Bloom | Render_FXAA | Render_TAA | Render_Sharpening | Render_SSR | Render_Checkerboard;
+	}
 
-		m_renderTexShadowing.reset();
-		m_renderTexShadowing = make_unique<RHI_RenderTexture>(m_rhiDevice, int(width * 0.5f), int(height * 0.5f), Texture_Format_R32G32_FLOAT);
+	const char* Renderer::Quality_GetName(Quality quality)
+	{
+		return _Renderer::qualityPresets[Clamp((int)quality, 0, (int)Quality_Count - 1)].name;
 	}
+	//==========================================================================================================
 
 	//= RENDERABLES ============================================================================================
-	void Renderer::Renderables_Acquire(const Variant& actorsVariant)
+	void Renderer::Renderables_Acquire(const vector<shared_ptr<Actor>>& actors)
+	{
+		// Whatever changed before the world got submitted is part of it already
+		{
+			lock_guard<mutex> lock(m_actorsChangedMutex);
+			m_actorsChanged.clear();
+			m_materialsChanged = false;
+
+			// A frame might be rendering from the current lists, so they get rebuilt before the next one
+			if (m_pipelined)
+			{
+				m_actorsSubmitted			= actors;
+				m_actorsSubmittedPending	= true;
+				return;
+			}
+			m_actorsSubmitted.clear();
+			m_actorsSubmittedPending = false;
+		}
+
+		Renderables_Rebuild(actors);
+	}
+
+	void Renderer::Renderables_Rebuild(const vector<shared_ptr<Actor>>& actors)
 	{
-		TIME_BLOCK_START_CPU();
+		TIME_BLOCK_SCOPED_CPU();
 
 		Clear();
-		auto actorsVec = actorsVariant.Get<vector<shared_ptr<Actor>>>();
 
-		for (const auto& actorShared : actorsVec)
+		for (const auto& actorShared : actors)
 		{
 			auto actor = actorShared.get();
 			if (!actor)
 				continue;
+			m_actorsAlive[actor] = actorShared;
 
 			// Get all the components we are interested in
-			auto renderable = actor->GetComponent<Renderable>();
-			auto light		= actor->GetComponent<Light>();
-			auto skybox		= actor->GetComponent<Skybox>();
-			auto camera		= actor->GetComponent<Camera>();
+			auto renderable = actor->GetRenderable_PtrRaw();
+			auto light		= actor->GetComponent_PtrRaw<Light>();
+			auto skybox		= actor->GetComponent_PtrRaw<Skybox>();
+			auto camera		= actor->GetComponent_PtrRaw<Camera>();
 
-			if (renderable)
+			// A terrain's Renderable only holds it's material, the chunks are drawn by a pass of their own
+			if (actor->HasComponent<Terrain>())
+			{
+				m_actors[Renderable_Terrain].emplace_back(actor);
+			}
+			else if (renderable)
 			{
-				bool isTransparent = !renderable->Material_Exists() ? false : renderable->Material_Ptr()->GetColorAlbedo().w < 1.0f;
+				bool isTransparent = !renderable->Material_Exists() ? false : renderable->Material_Ptr()->IsTransparent();
 				m_actors[isTransparent ? Renderable_ObjectTransparent : Renderable_ObjectOpaque].emplace_back(actor);
 			}
 
@@ -474,264 +1150,1862 @@ namespace Directus
 				m_actors[Renderable_Skybox].emplace_back(actor);
 			}
 
+			if (actor->HasComponent<ParticleEmitter>())
+			{
+				m_actors[Renderable_ParticleEmitter].emplace_back(actor);
+			}
+
+			if (actor->HasComponent<LightProbeVolume>())
+			{
+				m_actors[Renderable_LightProbeVolume].emplace_back(actor);
+			}
+
 			if (camera)
 			{
 				m_actors[Renderable_Camera].emplace_back(actor);
-				m_camera = camera.get();
+				m_camera = camera;
 			}
 		}
+	}
 
-		Renderables_Sort(&m_actors[Renderable_ObjectOpaque]);
-		Renderables_Sort(&m_actors[Renderable_ObjectTransparent]);
+	void Renderer::Renderables_OnActorChanged(const weak_ptr<Actor>& actorWeak, bool removed)
+	{
+		auto actor = actorWeak.lock();
+		if (!actor)
+			return;
 
-		TIME_BLOCK_END_CPU();
+		// Actors can change from any thread (e.g. while a world is loading), so only queue
+		// the change here. It will be applied by the rendering thread before the next frame.
+		lock_guard<mutex> lock(m_actorsChangedMutex);
+		m_actorsChanged.push_back({ actor.get(), actorWeak, removed });
 	}
 
-	void Renderer::Renderables_Sort(vector<Actor*>* renderables)
+	void Renderer::Renderables_ProcessChanges()
 	{
-		if (renderables->size() <= 2)
-			return;
+		vector<RenderableChange> changes;
+		vector<shared_ptr<Actor>> submitted;
+		bool submittedPending = false;
+		bool materialsChanged = false;
+		{
+			lock_guard<mutex> lock(m_actorsChangedMutex);
+			submitted.swap(m_actorsSubmitted);
+			submittedPending			= m_actorsSubmittedPending;
+			m_actorsSubmittedPending	= false;
+			changes.swap(m_actorsChanged);
+			materialsChanged	= m_materialsChanged;
+			m_materialsChanged	= false;
+		}
 
-		sort(renderables->begin(), renderables->end(),[](Actor* a, Actor* b)
+		if (submittedPending)
 		{
-			// Get renderable component
-			auto a_renderable = a->GetRenderable_PtrRaw();
-			auto b_renderable = b->GetRenderable_PtrRaw();
+			Renderables_Rebuild(submitted);
+		}
 
-			// Validate renderable components
-			if (!a_renderable || !b_renderable)
-				return false;
+		if (changes.empty() && !materialsChanged)
+			return;
 
-			// Get geometry parents
-			auto a_geometryModel = a_renderable->Geometry_Model();
-			auto b_geometryModel = b_renderable->Geometry_Model();
+		TIME_BLOCK_SCOPED_CPU();
 
-			// Validate geometry parents
-			if (!a_geometryModel || !b_geometryModel)
-				return false;
+		// An actor can change multiple times per frame (e.g. a renderable gets added, then it's geometry
+		// and then it's material get set), only it's latest state matters, so walk the changes backwards.
+		unordered_set<Actor*> processed;
+		for (auto it = changes.rbegin(); it != changes.rend(); ++it)
+		{
+			if (!processed.insert(it->actor).second)
+				continue;
 
-			// Get materials
-			auto a_material = a_renderable->Material_Ptr();
-			auto b_material = b_renderable->Material_Ptr();
+			// Removed or destroyed actors are only used as a key, they are never dereferenced
+			Renderables_Remove(it->actor);
 
-			if (!a_material || !b_material)
-				return false;
+			if (it->removed)
+				continue;
 
-			// Get key for models
-			auto a_keyModel = a_geometryModel->Resource_GetID();
-			auto b_keyModel = b_geometryModel->Resource_GetID();
+			if (auto actor = it->actorWeak.lock())
+			{
+				Renderables_Insert(actor.get());
+				m_actorsAlive[actor.get()] = actor;
+			}
+		}
 
-			// Get key for shaders
-			auto a_keyShader = a_material->GetShader().lock()->Resource_GetID();
-			auto b_keyShader = b_material->GetShader().lock()->Resource_GetID();
+		// A material's opacity changed, move any renderables that ended up in the wrong list
+		if (materialsChanged)
+		{
+			auto& opaque		= m_actors[Renderable_ObjectOpaque];
+			auto& transparent	= m_actors[Renderable_ObjectTransparent];
+			vector<Actor*> relocate;
 
-			// Get key for materials
-			auto a_keyMaterial = a_material->Resource_GetID();
-			auto b_keyMaterial = b_material->Resource_GetID();
+			auto CollectMisplaced = [&relocate](vector<Actor*>& actors, bool transparent)
+			{
+				for (auto it = actors.begin(); it != actors.end();)
+				{
+					Renderable* renderable	= (*it)->GetRenderable_PtrRaw();
+					bool isTransparent		= (renderable && renderable->Material_Exists()) ? renderable->Material_Ptr()->IsTransparent() : false;
+					if (isTransparent != transparent)
+					{
+						relocate.emplace_back(*it);
+						it = actors.erase(it);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			};
+			CollectMisplaced(opaque, false);
+			CollectMisplaced(transparent, true);
 
-			auto a_key = 
-				(((unsigned long long)a_keyModel)		<< 48u)	| 
-				(((unsigned long long)a_keyShader)		<< 32u)	|
-				(((unsigned long long)a_keyMaterial)	<< 16u);
+			for (const auto& actor : relocate)
+			{
+				Renderables_Insert(actor);
+			}
 
-			auto b_key = 
-				(((unsigned long long)b_keyModel)		<< 48u)	|
-				(((unsigned long long)b_keyShader)		<< 32u)	|
-				(((unsigned long long)b_keyMaterial)	<< 16u);
-	
-			return a_key < b_key;
-		});
+			// A material's shader might have changed as well
+			for (auto& sortKey : m_sortKeys)
+			{
+				sortKey.second = Renderables_GetSortKey(sortKey.first);
+			}
+
+			// Impostors were baked with the previous look
+			m_impostors->Clear();
+		}
+
+		// The active camera might have been removed
+		auto& cameras	= m_actors[Renderable_Camera];
+		m_camera		= cameras.empty() ? nullptr : cameras.back()->GetComponent_PtrRaw<Camera>();
 	}
-	//==========================================================================================================
 
-	//= PASSES =================================================================================================
-	void Renderer::Pass_DepthDirectionalLight(Light* light)
+	void Renderer::Renderables_Insert(Actor* actor)
 	{
-		if (!light || !light->GetCastShadows())
+		if (!actor)
 			return;
 
-		TIME_BLOCK_START_MULTI();
+		// Opaque and transparent lists are sorted every frame, only the state part of the key is computed here
+		if (actor->HasComponent<Terrain>())
+		{
+			m_actors[Renderable_Terrain].emplace_back(actor);
+		}
+		else if (auto renderable = actor->GetRenderable_PtrRaw())
+		{
+			bool isTransparent	= !renderable->Material_Exists() ? false : renderable->Material_Ptr()->IsTransparent();
+			m_actors[isTransparent ? Renderable_ObjectTransparent : Renderable_ObjectOpaque].emplace_back(actor);
+			m_sortKeys[actor]	= Renderables_GetSortKey(actor);
+		}
 
-		m_rhiDevice->EventBegin("Pass_DepthDirectionalLight");
-		m_rhiPipeline->SetShader(m_shaderLightDepth);
-		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		if (actor->HasComponent<Light>())
+		{
+			m_actors[Renderable_Light].emplace_back(actor);
+		}
 
-		// Variables that help reduce state changes
-		unsigned int currentlyBoundGeometry = 0;
+		if (actor->HasComponent<Skybox>())
+		{
+			m_actors[Renderable_Skybox].emplace_back(actor);
+		}
 
-		auto& actors = m_actors[Renderable_ObjectOpaque];
+		if (actor->HasComponent<ParticleEmitter>())
+		{
+			m_actors[Renderable_ParticleEmitter].emplace_back(actor);
+		}
 
-		if (!actors.empty())
+		if (actor->HasComponent<LightProbeVolume>())
 		{
-			for (unsigned int i = 0; i < light->ShadowMap_GetCount(); i++)
-			{
-				m_rhiDevice->EventBegin("Pass_ShadowMap_" + to_string(i));
+			m_actors[Renderable_LightProbeVolume].emplace_back(actor);
+		}
 
-				if (auto shadowMap = light->ShadowMap_GetRenderTexture(i))
-				{
-					m_rhiPipeline->SetRenderTarget(shadowMap, shadowMap->GetDepthStencilView(), true);
-					m_rhiPipeline->SetViewport(shadowMap->GetViewport());
-				}
+		if (actor->HasComponent<Camera>())
+		{
+			m_actors[Renderable_Camera].emplace_back(actor);
+		}
+	}
 
-				for (const auto& actor : actors)
-				{
-					// Acquire renderable component
-					Renderable* renderable = actor->GetRenderable_PtrRaw();
-					if (!renderable)
-						continue;
+	void Renderer::Renderables_Remove(Actor* actor)
+	{
+		for (auto& list : m_actors)
+		{
+			auto& actors = list.second;
+			auto it = find(actors.begin(), actors.end(), actor);
+			if (it != actors.end())
+			{
+				// The opaque and transparent lists get re-sorted before they are drawn, the rest aren't ordered
+				*it = actors.back();
+				actors.pop_back();
+			}
+		}
+		m_sortKeys.erase(actor);
+
+		// Treated as a new caster if it comes back, removing it also changes the static set so the caches get rebuilt
+		m_shadowCasters.erase(actor);
+		m_actorsAlive.erase(actor);
+	}
+
+	void Renderer::Renderables_Sort(vector<Actor*>* renderables, bool transparent)
+	{
+		if (renderables->size() <= 1)
+			return;
+
+		TIME_BLOCK_SCOPED_CPU();
+
+		// Only the view depth is computed per frame, the state part of the key is cached. Missing keys are added and
+		// moved transforms resolved up front, so the keys can be computed in parallel with everything only being read.
+		for (auto actor : *renderables)
+		{
+			if (m_sortKeys.find(actor) == m_sortKeys.end())
+			{
+				m_sortKeys[actor] = Renderables_GetSortKey(actor);
+			}
+			Renderables_GetWorld(actor);
+		}
+
+		m_drawPackets.resize(renderables->size());
+		m_context->GetSubsystem<Threading>()->Parallel_For(0, (unsigned int)renderables->size(), SORT_KEYS_PER_TASK, [this, renderables, transparent](unsigned int start, unsigned int end)
+		{
+			for (unsigned int i = start; i < end; i++)
+			{
+				Actor* actor		= (*renderables)[i];
+				auto keyState		= m_sortKeys.find(actor)->second;
+				auto renderable		= actor->GetRenderable_PtrRaw();
+				Vector3 center		= renderable ? renderable->Geometry_AABB().GetCenter() * Renderables_GetWorld(actor) : Vector3::Zero;
+				float viewZ			= center.x * m_mV.m02 + center.y * m_mV.m12 + center.z * m_mV.m22 + m_mV.m32;
+				float depth			= m_farPlane > 0.0f ? Clamp(viewZ / m_farPlane, 0.0f, 1.0f) : 0.0f;
+
+				unsigned long long key;
+				if (!transparent)
+				{
+					// A few (square root distributed) depth buckets come first, then the state so instances stay adjacent, then the remaining depth
+					auto keyBucket	= (unsigned long long)(Sqrt(depth) * 15.99f);
+					auto keyDepth	= (unsigned long long)(depth * 4095.0f);
+					key				= (keyBucket << 60) | (keyState << 12) | keyDepth;
+				}
+				else
+				{
+					// Strictly back-to-front, the state only breaks ties
+					auto keyDepth	= 0xFFFFFFFFull - (unsigned long long)((double)depth * 0xFFFFFFFF);
+					key				= (keyDepth << 32) | (keyState & 0xFFFFFFFF);
+				}
+
+				m_drawPackets[i] = { key, actor };
+			}
+		});
+
+		DrawPackets_Sort(m_drawPackets, m_drawPacketsScratch);
+
+		for (unsigned int i = 0; i < (unsigned int)m_drawPackets.size(); i++)
+		{
+			(*renderables)[i] = m_drawPackets[i].actor;
+		}
+	}
+
+	void Renderer::DrawPackets_Sort(vector<DrawPacket>& packets, vector<DrawPacket>& scratch)
+	{
+		auto count = (unsigned int)packets.size();
+		scratch.resize(count);
+
+		// Count every digit of every pass up front
+		unsigned int histograms[8][256] = {};
+		for (const auto& packet : packets)
+		{
+			for (unsigned int pass = 0; pass < 8; pass++)
+			{
+				histograms[pass][(packet.key >> (pass * 8)) & 0xFF]++;
+			}
+		}
+
+		auto source			= &packets;
+		auto destination	= &scratch;
+		for (unsigned int pass = 0; pass < 8; pass++)
+		{
+			// Skip passes over bytes that are the same for every key
+			auto& histogram = histograms[pass];
+			auto shift		= pass * 8;
+			if (histogram[(source->front().key >> shift) & 0xFF] == count)
+				continue;
+
+			unsigned int offsets[256];
+			unsigned int offset = 0;
+			for (unsigned int digit = 0; digit < 256; digit++)
+			{
+				offsets[digit]	= offset;
+				offset			+= histogram[digit];
+			}
+
+			for (const auto& packet : *source)
+			{
+				(*destination)[offsets[(packet.key >> shift) & 0xFF]++] = packet;
+			}
+			swap(source, destination);
+		}
+
+		if (source != &packets)
+		{
+			packets.swap(scratch);
+		}
+	}
+
+	unsigned long long Renderer::Renderables_GetSortKey(Actor* actor)
+	{
+		// Get renderable component
+		auto renderable = actor->GetRenderable_PtrRaw();
+		if (!renderable)
+			return 0;
+
+		// Get geometry parent
+		auto geometryModel = renderable->Geometry_Model();
+		if (!geometryModel)
+			return 0;
+
+		// Get material and shader
+		auto material = renderable->Material_Ptr();
+		if (!material)
+			return 0;
+
+		auto shader = material->GetShader().lock();
+		if (!shader)
+			return 0;
+
+		// Get keys (12 bits each, shaders change the most state so they go first)
+		auto keyShader		= shader->Resource_GetID() & 0xFFF;
+		auto keyMaterial	= material->Resource_GetID() & 0xFFF;
+		auto keyModel		= geometryModel->Resource_GetID() & 0xFFF;
+		auto keyMesh		= (renderable->Geometry_IndexOffset() * 2654435761u) >> 20; // keeps identical meshes adjacent so they can be instanced
+
+		return
+			(((unsigned long long)keyShader)	<< 36u)	|
+			(((unsigned long long)keyMaterial)	<< 24u)	|
+			(((unsigned long long)keyModel)		<< 12u)	|
+			((unsigned long long)keyMesh);
+	}
+
+	bool Renderer::Renderables_AreInstances(Actor* a, Actor* b)
+	{
+		auto renderableA = a->GetRenderable_PtrRaw();
+		auto renderableB = b->GetRenderable_PtrRaw();
+		if (!renderableA || !renderableB)
+			return false;
+
+		// Skinned ones have a pose each
+		return
+			!renderableA->Geometry_IsSkinned()										&&
+			renderableA->Geometry_Model()			== renderableB->Geometry_Model()		&&
+			renderableA->Material_Ptr()				== renderableB->Material_Ptr()			&&
+			renderableA->Geometry_IndexOffset()		== renderableB->Geometry_IndexOffset()	&&
+			renderableA->Geometry_IndexCount()		== renderableB->Geometry_IndexCount()	&&
+			renderableA->Geometry_VertexOffset()	== renderableB->Geometry_VertexOffset();
+	}
+
+	unsigned int Renderer::Renderables_BindGeometry(shared_ptr<RHI_Pipeline>& pipeline, Actor* actor, unsigned int* currentlyBoundGeometry)
+	{
+		Renderable* renderable	= actor->GetRenderable_PtrRaw();
+		Model* model			= renderable->Geometry_Model();
+		int skinnedOffset		= m_gpuSkinning->Instance_GetVertexOffset(actor);
+		if (skinnedOffset != -1)
+		{
+			pipeline->SetIndexBuffer(model->GetIndexBuffer());
+			pipeline->SetVertexBuffer(m_gpuSkinning->GetVertexBuffer());
+			*currentlyBoundGeometry = 0;
+			return (unsigned int)skinnedOffset;
+		}
+
+		if (*currentlyBoundGeometry != model->Resource_GetID())
+		{
+			pipeline->SetIndexBuffer(model->GetIndexBuffer());
+			pipeline->SetVertexBuffer(model->GetVertexBuffer());
+			*currentlyBoundGeometry = model->Resource_GetID();
+		}
+
+		return renderable->Geometry_VertexOffset();
+	}
+
+	float Renderer::Renderables_GetScreenSize(const BoundingBox& box)
+	{
+		if (!m_camera)
+			return 1.0f;
+
+		// Size of the bounding sphere relative to the screen height
+		float radius	= box.GetExtents().Length();
+		float distance	= Vector3::Length(box.GetCenter(), Camera_GetPosition());
+		return distance > radius ? radius * m_mP_perspective.m11 / distance : 1.0f;
+	}
+
+	unsigned int Renderer::Renderables_GetLod(Renderable* renderable, const BoundingBox& box)
+	{
+		auto model	= renderable->Geometry_Model();
+		auto lods	= model ? model->Geometry_Lods(renderable->Geometry_IndexOffset()) : nullptr;
+		if (!lods || !m_camera)
+			return 0;
+
+		float screenSize = Renderables_GetScreenSize(box);
+		unsigned int lod = 0;
+		while (lod < Min((unsigned int)lods->size(), (unsigned int)MODEL_LODS_MAX - 1) && screenSize < (*lods)[lod].screenSize) { lod++; }
+		return lod;
+	}
+
+	const Matrix& Renderer::Renderables_GetWorld(Actor* actor)
+	{
+		if (m_pipelined)
+		{
+			const auto& transforms	= m_snapshots[m_snapshotRender].transforms;
+			auto it					= transforms.find(actor);
+			if (it != transforms.end())
+				return it->second;
+		}
+
+		// Not pipelined, or added after the snapshot was captured (e.g. by a world that is loading)
+		return actor->GetTransform_PtrRaw()->GetWorldTransformRendered();
+	}
+
+	Matrix Renderer::Renderables_GetWorldRelative(Actor* actor)
+	{
+		Matrix world = Renderables_GetWorld(actor);
+		world.m30 -= m_origin.x;
+		world.m31 -= m_origin.y;
+		world.m32 -= m_origin.z;
+		return world;
+	}
+
+	Vector3 Renderer::Camera_GetPosition()
+	{
+		const auto& snapshot = m_snapshots[m_snapshotRender];
+		if (m_viewRendering != -1)
+			return snapshot.views[m_viewRendering].cameraPosition;
+
+		return (m_pipelined && snapshot.camera) ? snapshot.cameraPosition : m_camera->GetTransform()->GetPosition();
+	}
+
+	void Renderer::Renderables_Cull(RenderSnapshot& snapshot, Frustum& frustum)
+	{
+		// The camera and the views in one walk of the tree, the camera's frustum goes first
+		auto count = (unsigned int)snapshot.views.size() + 1;
+		m_viewFrusta.resize(count);
+		m_viewActors.resize(count);
+		m_viewFrusta[0] = frustum;
+		for (unsigned int i = 1; i < count; i++)
+		{
+			m_viewFrusta[i] = snapshot.views[i - 1].frustum;
+		}
+		for (auto& actors : m_viewActors)
+		{
+			actors.clear();
+		}
+		m_context->GetSubsystem<World>()->Spatial_Get().Query(m_viewFrusta.data(), count, m_viewActors.data(), m_context->GetSubsystem<Threading>());
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			auto& visible = (i == 0) ? snapshot.visible : snapshot.views[i - 1].visible;
+			visible.assign(visible.size(), false);
+			for (auto actor : m_viewActors[i])
+			{
+				auto index = actor->GetHandle().GetIndex();
+				if (index >= (unsigned int)visible.size()) visible.resize(index + 1, false);
+				visible[index] = true;
+			}
+		}
+		snapshot.culled = true;
+	}
+
+	bool Renderer::Renderables_IsVisible(const Actor* actor)
+	{
+		// Nothing got culled yet (no camera was captured), draw everything
+		const auto& snapshot = m_snapshots[m_snapshotRender];
+		if (!snapshot.culled)
+			return true;
+
+		const auto& visible	= (m_viewRendering != -1) ? snapshot.views[m_viewRendering].visible : snapshot.visible;
+		auto index			= actor->GetHandle().GetIndex();
+		return index < (unsigned int)visible.size() && visible[index];
+	}
+	//==========================================================================================================
+
+	//= PIPELINED FRAMES =======================================================================================
+	void Renderer::Snapshot_Capture()
+	{
+		TIME_BLOCK_SCOPED_CPU();
+
+		// The frame that is rendering reads the other snapshot, so this one is free to write to
+		auto& snapshot		= m_snapshots[1 - m_snapshotRender];
+		snapshot.camera		= false;
+		snapshot.culled		= false;
+		snapshot.origin		= m_context->GetSubsystem<World>()->Origin_Get();
+		snapshot.transforms.clear();
+
+		Camera* cameraLast = nullptr;
+		for (const auto& actor : m_context->GetSubsystem<World>()->Actors_GetAll())
+		{
+			snapshot.transforms[actor.get()] = actor->GetTransform_PtrRaw()->GetWorldTransformRendered();
+
+			// The last camera is the active one, same as when the renderable lists get built
+			if (auto camera = actor->GetComponent_PtrRaw<Camera>())
+			{
+				snapshot.view			= camera->GetViewMatrix();
+				snapshot.viewBase		= camera->GetBaseViewMatrix();
+				snapshot.projection		= camera->GetProjectionMatrix();
+				snapshot.cameraPosition	= actor->GetTransform_PtrRaw()->GetPosition();
+				snapshot.nearPlane		= camera->GetNearPlane();
+				snapshot.farPlane		= camera->GetFarPlane();
+				snapshot.frustum.Construct(snapshot.view, camera->IsReverseZ() ? snapshot.projection * Matrix::CreateReverseZ() : snapshot.projection, snapshot.farPlane);
+				snapshot.camera			= true;
+				cameraLast				= camera;
+			}
+		}
+
+		// The tree is only safe to query from here, the render thread would race the World's next tick
+		Views_Capture(snapshot, cameraLast);
+		if (snapshot.camera)
+		{
+			Renderables_Cull(snapshot, snapshot.frustum);
+		}
+	}
+	//==========================================================================================================
+
+	//= VIEWS ==================================================================================================
+	unsigned int Renderer::View_Add(const weak_ptr<Actor>& camera)
+	{
+		lock_guard<mutex> lock(m_viewsMutex);
+
+		// Re-use the slot of a removed view, IDs start from 1
+		unsigned int index = 0;
+		while (index < (unsigned int)m_views.size() && m_views[index].alive) { index++; }
+		if (index == (unsigned int)m_views.size())
+		{
+			m_views.emplace_back();
+		}
+
+		auto& view	= m_views[index];
+		view.camera	= camera;
+		view.target	= m_renderTexturePool->Acquire(Settings::Get().Resolution_GetWidth(), Settings::Get().Resolution_GetHeight(), Texture_Format_R16G16B16A16_FLOAT);
+		view.alive	= true;
+		RenderOnDemand_Request();
+
+		return index + 1;
+	}
+
+	void Renderer::View_Remove(unsigned int id)
+	{
+		lock_guard<mutex> lock(m_viewsMutex);
+		if (id == 0 || id > (unsigned int)m_views.size() || !m_views[id - 1].alive)
+			return;
+
+		// A snapshot may still render into the target, the pool holds it back for a few frames
+		auto& view = m_views[id - 1];
+		m_renderTexturePool->Release(view.target);
+		view.target.reset();
+		view.camera.reset();
+		view.alive = false;
+	}
+
+	void* Renderer::View_GetShaderResource(unsigned int id)
+	{
+		lock_guard<mutex> lock(m_viewsMutex);
+		if (id == 0 || id > (unsigned int)m_views.size() || !m_views[id - 1].target)
+			return nullptr;
+
+		return m_views[id - 1].target->GetShaderResource();
+	}
+
+	void Renderer::Views_Capture(RenderSnapshot& snapshot, Camera* camera)
+	{
+		lock_guard<mutex> lock(m_viewsMutex);
+
+		// Only the views whose camera is still around, the captured ones keep their visibility's memory
+		unsigned int count = 0;
+		for (const auto& view : m_views)
+		{
+			auto actor		= view.camera.lock();
+			auto viewCamera	= actor ? actor->GetComponent_PtrRaw<Camera>() : nullptr;
+			if (!view.alive || !viewCamera)
+				continue;
+
+			if (count == (unsigned int)snapshot.views.size())
+			{
+				snapshot.views.emplace_back();
+			}
+
+			auto& captured			= snapshot.views[count++];
+			captured.camera			= viewCamera;
+			captured.target			= view.target;
+			captured.view			= viewCamera->GetViewMatrix();
+			captured.viewBase		= viewCamera->GetBaseViewMatrix();
+			captured.projection		= viewCamera->GetProjectionMatrix();
+			captured.cameraPosition	= actor->GetTransform_PtrRaw()->GetPosition();
+			captured.nearPlane		= viewCamera->GetNearPlane();
+			captured.farPlane		= viewCamera->GetFarPlane();
+			captured.frustum.Construct(captured.view, viewCamera->IsReverseZ() ? captured.projection * Matrix::CreateReverseZ() : captured.projection, captured.farPlane);
+			captured.probeCapture	= 0;
+		}
+
+		// A face of a reflection probe is a square view with the camera's planes and depth direction (it's what the device is set to)
+		auto capture = (m_reflectionProbes && camera) ? m_reflectionProbes->Update(m_context->GetSubsystem<World>()->Actors_GetAll()) : ReflectionProbes::Capture();
+		if (capture.ticket != 0)
+		{
+			if (count == (unsigned int)snapshot.views.size())
+			{
+				snapshot.views.emplace_back();
+			}
+
+			auto& captured			= snapshot.views[count++];
+			captured.camera			= camera;
+			captured.target			= m_reflectionProbes->GetFaceTexture(Settings::Get().Resolution_GetWidth(), Settings::Get().Resolution_GetHeight());
+			captured.view			= ReflectionProbes::GetFaceView(capture.position, capture.face);
+			captured.viewBase		= camera->GetBaseViewMatrix();
+			captured.projection		= camera->IsReverseZ() ? Matrix::CreatePerspectiveFieldOfViewInfiniteLH(PI_DIV_2, 1.0f, camera->GetNearPlane()) * Matrix::CreateReverseZ() : Matrix::CreatePerspectiveFieldOfViewLH(PI_DIV_2, 1.0f, camera->GetNearPlane(), camera->GetFarPlane());
+			captured.cameraPosition	= capture.position;
+			captured.nearPlane		= camera->GetNearPlane();
+			captured.farPlane		= camera->GetFarPlane();
+			captured.frustum.Construct(captured.view, camera->IsReverseZ() ? captured.projection * Matrix::CreateReverseZ() : captured.projection, captured.farPlane);
+			captured.probeCapture	= capture.ticket;
+		}
+		snapshot.views.resize(count);
+	}
+
+	void Renderer::Views_Render()
+	{
+		const auto& snapshot = m_snapshots[m_snapshotRender];
+		if (snapshot.views.empty())
+			return;
+
+		TIME_BLOCK_SCOPED_CPU();
+
+		// What the main camera carries into it's next frame, a view keeps no history
+		Camera* camera					= m_camera;
+		Matrix mVP_unjittered			= m_mVP_unjittered;
+		Matrix mVP_unjittered_origin	= m_mVP_unjittered_origin;
+
+		// Views render at the main camera's dynamic resolution, without jitter, and only with it's depth direction
+		float scaleInv	= 1.0f / m_dynamicResolutionScale;
+		Matrix ndcRemap	= Matrix::CreateScale(scaleInv, scaleInv, 1.0f) * Matrix::CreateTranslation(Vector3(scaleInv - 1.0f, 1.0f - scaleInv, 0.0f));
+		m_taaJitter		= Vector2::Zero;
+		for (unsigned int i = 0; i < (unsigned int)snapshot.views.size(); i++)
+		{
+			// Captured before a resize, or with a depth direction the device isn't set to
+			const auto& view = snapshot.views[i];
+			if (view.target->GetWidth() != (unsigned int)Settings::Get().Resolution_GetWidth() || view.target->GetHeight() != (unsigned int)Settings::Get().Resolution_GetHeight() || view.camera->IsReverseZ() != m_rhiDevice->Get_DepthReverse())
+				continue;
+
+			m_viewRendering			= (int)i;
+			m_camera				= view.camera;
+			m_mV					= view.view;
+			m_mV_base				= view.viewBase;
+			m_mP_perspective		= view.projection;
+			m_nearPlane				= view.nearPlane;
+			m_farPlane				= view.farPlane;
+			m_mP_orthographic		= Matrix::CreateOrthographicLH((float)Settings::Get().Resolution_GetWidth(), (float)Settings::Get().Resolution_GetHeight(), m_nearPlane, m_farPlane);
+			m_wvp_baseOrthographic	= m_mV_base * m_mP_orthographic;
+			m_wvp_perspective		= m_mV * m_mP_perspective;
+			m_mVP_unjittered		= m_wvp_perspective;
+			m_mVP_previous			= m_wvp_perspective;
+			m_mVP_inverseScaled		= ndcRemap * m_wvp_perspective.Inverted();
+
+			m_origin				= RenderFlags_IsSet(Render_CameraRelative) ? view.cameraPosition : Vector3::Zero;
+			m_mV_origin				= Matrix::CreateTranslation(m_origin) * m_mV;
+			m_mVP_unjittered_origin	= m_mV_origin * m_mP_perspective;
+			m_mVP_previous_origin	= m_mVP_unjittered_origin;
+
+			Render_Graph(view.target, true);
+
+			// Downsampled for the readback, the face's prefiltering waits for the rest of them
+			if (view.probeCapture != 0)
+			{
+				auto target = view.target;
+				Pass_ReflectionProbe_Downsample(target);
+				m_reflectionProbes->Capture_Readback(view.probeCapture);
+			}
+		}
+
+		m_viewRendering			= -1;
+		m_camera				= camera;
+		m_mVP_unjittered		= mVP_unjittered;
+		m_mVP_unjittered_origin	= mVP_unjittered_origin;
+	}
+	//==========================================================================================================
+
+	//= INSTANCING =============================================================================================
+	void Renderer::Instances_Draw(shared_ptr<RHI_Pipeline>& pipeline, const vector<Matrix>& transforms, const vector<shared_ptr<RHI_ConstantBuffer>>& constantBuffers, unsigned int indexCount, unsigned int indexOffset, unsigned int vertexOffset)
+	{
+		// The pipeline forgets constant buffers on every bind, so the
+		// caller's buffers are re-set for each batch along with the instance buffer
+		for (unsigned int offset = 0; offset < (unsigned int)transforms.size(); offset += INSTANCE_BATCH_MAX)
+		{
+			auto count = Min((unsigned int)transforms.size() - offset, (unsigned int)INSTANCE_BATCH_MAX);
+
+			// Each batch appends to the instance ring instead of discarding the whole buffer
+			unsigned int firstConstant = 0;
+			auto buffer = (Struct_Instances*)m_instanceBuffer->Map(&firstConstant);
+			if (!buffer)
+				return;
+			memcpy(buffer->m_world, &transforms[offset], count * sizeof(Matrix));
+			m_instanceBuffer->Unmap();
+
+			for (const auto& constantBuffer : constantBuffers)
+			{
+				pipeline->SetConstantBuffer(constantBuffer);
+			}
+			pipeline->SetConstantBuffer(m_instanceBuffer, firstConstant);
+			pipeline->Bind();
+
+			m_rhiDevice->DrawIndexedInstanced(indexCount, count, indexOffset, vertexOffset);
+			Profiler::Get().m_rendererMeshesRendered += count;
+		}
+	}
+
+	void Renderer::Instances_DrawLods(shared_ptr<RHI_Pipeline>& pipeline, Renderable* renderable, const vector<Matrix>* lodTransforms, const vector<shared_ptr<RHI_ConstantBuffer>>& constantBuffers, unsigned int vertexOffset)
+	{
+		auto lods = renderable->Geometry_Model()->Geometry_Lods(renderable->Geometry_IndexOffset());
+		for (unsigned int lod = 0; lod < MODEL_LODS_MAX; lod++)
+		{
+			if (lodTransforms[lod].empty())
+				continue;
+
+			// Simplified levels share the full detail geometry's vertices
+			unsigned int indexOffset	= lod == 0 ? renderable->Geometry_IndexOffset() : (*lods)[lod - 1].indexOffset;
+			unsigned int indexCount		= lod == 0 ? renderable->Geometry_IndexCount()	: (*lods)[lod - 1].indexCount;
+			Instances_Draw(pipeline, lodTransforms[lod], constantBuffers, indexCount, indexOffset, vertexOffset);
+		}
+	}
+	//==========================================================================================================
+
+	//= COMMAND LISTS ==========================================================================================
+	void Renderer::CommandLists_Record(const FrameVector<function<void(shared_ptr<RHI_Pipeline>&)>>& jobs)
+	{
+		if (jobs.empty())
+			return;
+
+		// Nothing to gain from a single job, draw it directly
+		if (jobs.size() == 1)
+		{
+			jobs.front()(m_rhiPipeline);
+			return;
+		}
+
+		// Every job needs a pipeline of its own, state tracking can't be shared between contexts
+		while (m_rhiPipelinesDeferred.size() < jobs.size())
+		{
+			m_rhiPipelinesDeferred.emplace_back(make_shared<RHI_Pipeline>(m_rhiDevice));
+		}
+
+		// Per frame scratch comes out of the frame allocator
+		FrameVector<void*> commandLists(jobs.size(), nullptr, m_context->GetFrameAllocatorSTL<void*>());
+		auto record = [this, &jobs, &commandLists](unsigned int index)
+		{
+			if (!m_rhiDevice->CommandList_Begin())
+				return;
+
+			// Deferred contexts start from the default state, so forget whatever was bound last time
+			auto& pipeline = m_rhiPipelinesDeferred[index];
+			pipeline->Clear();
+
+			jobs[index](pipeline);
+			commandLists[index] = m_rhiDevice->CommandList_End();
+		};
+
+		// Hand all but the first job to the worker threads, this thread records the first one
+		auto threading = m_context->GetSubsystem<Threading>();
+		FrameVector<future<void>> recorded(m_context->GetFrameAllocatorSTL<future<void>>());
+		for (unsigned int i = 1; i < (unsigned int)jobs.size(); i++)
+		{
+			auto done = make_shared<promise<void>>();
+			recorded.emplace_back(done->get_future());
+			threading->AddTask([&record, i, done]() { record(i); done->set_value(); });
+		}
+		record(0);
+
+		for (auto& result : recorded)
+		{
+			result.wait();
+		}
+
+		// Replay in submission order, a job that failed to record is drawn directly instead
+		for (unsigned int i = 0; i < (unsigned int)jobs.size(); i++)
+		{
+			if (commandLists[i])
+			{
+				m_rhiDevice->CommandList_Execute(commandLists[i]);
+			}
+			else
+			{
+				jobs[i](m_rhiPipeline);
+			}
+		}
+	}
+	//==========================================================================================================
+
+	//= SHADOWS ================================================================================================
+	void Renderer::Shadows_SetCascadeUpdateInterval(unsigned int cascadeIndex, unsigned int frames)
+	{
+		if (m_shadowCascadeIntervals.size() <= cascadeIndex)
+		{
+			m_shadowCascadeIntervals.resize(cascadeIndex + 1, 1);
+		}
+		m_shadowCascadeIntervals[cascadeIndex] = Max(frames, 1u);
+	}
+
+	void Renderer::Shadows_Classify(Light* light)
+	{
+		auto cascadeCount = Min(light->ShadowMap_GetCount(), (unsigned int)m_shadowCascades.size());
+		for (unsigned int i = 0; i < cascadeCount; i++)
+		{
+			auto& cascade = m_shadowCascades[i];
+			cascade.castersStatic.clear();
+			cascade.castersDynamic.clear();
+			cascade.castersStaticHash	= 0;
+			cascade.castersDynamicHash	= 0;
+		}
+		const Matrix& view = light->GetViewMatrix();
+		m_shadowCandidates.clear();
+		m_shadowCandidateBounds.Clear();
+
+		// The opaque list is sorted, so every list stays sorted and keeps its instancing runs intact
+		for (const auto& actor : m_actors[Renderable_ObjectOpaque])
+		{
+			Renderable* renderable = actor->GetRenderable_PtrRaw();
+			if (!renderable || !renderable->GetCastShadows())
+				continue;
+
+			const Matrix& world	= Renderables_GetWorld(actor);
+			auto result			= m_shadowCasters.emplace(actor, ShadowCaster{ world, 0 });
+			auto& caster		= result.first->second;
+			if (!result.second)
+			{
+				if (caster.world != world)
+				{
+					caster.world		= world;
+					caster.framesStill	= 0;
+					caster.boundsDirty	= true;
+				}
+				else if (caster.framesStill < SHADOW_CASTER_STATIC_FRAMES)
+				{
+					caster.framesStill++;
+				}
+			}
+
+			if (caster.boundsDirty || caster.boundsView != view)
+			{
+				caster.boundsLight	= renderable->Geometry_BB().Transformed(view);
+				caster.boundsView	= view;
+				caster.boundsDirty	= false;
+			}
+
+			// Actors flagged static go straight to the cached cascades, the rest have to sit still for a while first. Skinned ones move in place.
+			bool isStatic	= !renderable->Geometry_IsSkinned() && ((actor->IsStatic() && caster.world == world) || caster.framesStill >= SHADOW_CASTER_STATIC_FRAMES);
+			uint64_t key	= ((uint64_t)(uintptr_t)actor ^ 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+			m_shadowCandidates.emplace_back(ShadowCandidate{ actor, key, isStatic });
+			m_shadowCandidateBounds.Add(caster.boundsLight.GetCenter(), caster.boundsLight.GetExtents());
+		}
+
+		// Cascades reach toward the light, so a caster which overlaps none of them can't shadow anything that gets shadowed
+		auto threading	= m_context->GetSubsystem<Threading>();
+		size_t count	= m_shadowCandidates.size();
+		m_shadowCandidateVisible.resize((count + 63) / 64);
+		for (unsigned int i = 0; i < cascadeCount; i++)
+		{
+			Frustum bounds;
+			bounds.Construct(light->ShadowMap_GetBounds(i));
+			if (count >= SHADOW_CASTER_CULL_PARALLEL)
+			{
+				threading->Parallel_For(0, (unsigned int)m_shadowCandidateVisible.size(), SHADOW_CASTER_CULL_GRAIN, [this, &bounds, count](unsigned int start, unsigned int end)
+				{
+					bounds.CheckCubes(m_shadowCandidateBounds, start * 64, Min((size_t)end * 64, count), m_shadowCandidateVisible.data());
+				});
+			}
+			else
+			{
+				bounds.CheckCubes(m_shadowCandidateBounds, 0, count, m_shadowCandidateVisible.data());
+			}
+
+			auto& cascade = m_shadowCascades[i];
+			for (size_t j = 0; j < count; j++)
+			{
+				if (!((m_shadowCandidateVisible[j / 64] >> (j % 64)) & 1))
+					continue;
+
+				const auto& candidate = m_shadowCandidates[j];
+				(candidate.isStatic ? cascade.castersStatic : cascade.castersDynamic).emplace_back(candidate.actor);
+				(candidate.isStatic ? cascade.castersStaticHash : cascade.castersDynamicHash) += candidate.key;
+			}
+		}
+	}
+	//==========================================================================================================
+
+	//= PASSES =================================================================================================
+	void Renderer::Pass_DepthDirectionalLight(Light* light)
+	{
+		if (!light || !light->GetCastShadows())
+			return;
+
+		if (m_actors[Renderable_ObjectOpaque].empty())
+			return;
+
+		TIME_BLOCK_SCOPED_MULTI();
+
+		if (m_shadowCascades.size() < light->ShadowMap_GetCount())
+		{
+			m_shadowCascades.resize(light->ShadowMap_GetCount());
+		}
+		Shadows_Classify(light);
+
+		// Cascades are independent of each other, so each one is recorded as a separate job
+		FrameVector<function<void(shared_ptr<RHI_Pipeline>&)>> jobs(m_context->GetFrameAllocatorSTL<function<void(shared_ptr<RHI_Pipeline>&)>>());
+		for (unsigned int i = 0; i < light->ShadowMap_GetCount(); i++)
+		{
+			jobs.emplace_back([this, light, i](shared_ptr<RHI_Pipeline>& pipeline) { Pass_DepthDirectionalLight_Cascade(pipeline, light, i); });
+		}
+		CommandLists_Record(jobs);
+	}
+
+	void Renderer::Pass_DepthDirectionalLight_Cascade(shared_ptr<RHI_Pipeline>& pipeline, Light* light, unsigned int cascadeIndex)
+	{
+		auto shadowMap = light->ShadowMap_GetRenderTexture(cascadeIndex);
+		if (!shadowMap)
+			return;
+
+		// Each job only touches it's own cascade's cache
+		auto& cache				= m_shadowCascades[cascadeIndex];
+		auto viewProjection		= light->GetViewMatrix() * light->ShadowMap_GetProjectionMatrix(cascadeIndex);
+		unsigned int interval	= cascadeIndex < m_shadowCascadeIntervals.size() ? m_shadowCascadeIntervals[cascadeIndex] : 1;
+
+		// The shadow map belongs to a different light or got re-created (e.g. resolution change)
+		if (cache.target != shadowMap.get())
+		{
+			cache.target	= shadowMap.get();
+			cache.valid		= false;
+			if (!cache.staticMap || cache.staticMap->GetWidth() != shadowMap->GetWidth() || cache.staticMap->GetHeight() != shadowMap->GetHeight() || cache.staticMap->GetFormat() != shadowMap->GetFormat())
+			{
+				if (cache.staticMap) m_renderTexturePool->Release(cache.staticMap);
+				cache.staticMap = m_renderTexturePool->Acquire(shadowMap->GetWidth(), shadowMap->GetHeight(), shadowMap->GetFormat(), true, Texture_Format_D32_FLOAT);
+			}
+		}
+
+		bool staticDirty	= !cache.valid || cache.viewProjection != viewProjection || cache.staticHash != cache.castersStaticHash;
+		bool dynamicDirty	= cache.dynamicHash != cache.castersDynamicHash || (!cache.castersDynamic.empty() && m_frame - cache.frameUpdated >= interval);
+
+		// The shadow map still holds what it would be re-rendered to. Skipping is only allowed while the cascade's
+		// projection is unchanged, since the shadowing pass samples it with the current projection. It only changes
+		// with the light's direction or once the camera moves a step (see Light::ShadowMap_ComputeProjectionMatrix).
+		if (!staticDirty && !dynamicDirty)
+			return;
+
+		if (staticDirty)
+		{
+			Pass_DepthDirectionalLight_Casters(pipeline, cache.staticMap, viewProjection, cache.castersStatic, true);
+			cache.viewProjection	= viewProjection;
+			cache.staticHash		= cache.castersStaticHash;
+			cache.valid				= true;
+		}
+
+		// Start from the static casters and draw the dynamic ones on top
+		shadowMap->CopyFrom(cache.staticMap);
+		if (!cache.castersDynamic.empty())
+		{
+			Pass_DepthDirectionalLight_Casters(pipeline, shadowMap, viewProjection, cache.castersDynamic, false);
+		}
+		cache.dynamicHash	= cache.castersDynamicHash;
+		cache.frameUpdated	= m_frame;
+	}
+
+	void Renderer::Pass_DepthDirectionalLight_Casters(shared_ptr<RHI_Pipeline>& pipeline, const shared_ptr<RHI_RenderTexture>& target, const Matrix& viewProjection, const vector<Actor*>& actors, bool clear)
+	{
+		pipeline->SetShader(m_shaderLightDepth);
+		pipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		pipeline->SetRenderTarget(target, target->GetDepthStencilView(), clear);
+		pipeline->SetViewport(target->GetViewport());
+
+		// The light's view projection is shared by every instance drawn into this cascade
+		auto buffer = Struct_Matrix(viewProjection);
+		m_shaderLightDepth->UpdateBuffer(&buffer);
+
+		// Variables that help reduce state changes
+		unsigned int currentlyBoundGeometry = 0;
+		vector<Matrix> instanceTransforms[MODEL_LODS_MAX];
+
+		for (unsigned int i = 0; i < (unsigned int)actors.size();)
+		{
+			// Find the run of consecutive actors that can be drawn as instances of this one
+			Actor* actor			= actors[i];
+			unsigned int runStart	= i++;
+			while (i < (unsigned int)actors.size() && Renderables_AreInstances(actor, actors[i])) { i++; }
+
+			// Acquire renderable component
+			Renderable* renderable = actor->GetRenderable_PtrRaw();
+			if (!renderable)
+				continue;
+
+			// Acquire material
+			Material* material = renderable ? renderable->Material_Ptr().get() : nullptr;
+			if (!material)
+				continue;
+
+			// Acquire geometry
+			Model* geometry = renderable->Geometry_Model();
+			if (!geometry || !geometry->GetVertexBuffer() || !geometry->GetIndexBuffer())
+				continue;
+
+			// Skip transparent meshes (for now)
+			if (material->GetColorAlbedo().w < 1.0f)
+				continue;
+
+			// Gather the instances per level of detail (the caster lists only contain meshes that cast shadows)
+			for (auto& transforms : instanceTransforms) { transforms.clear(); }
+			for (unsigned int j = runStart; j < i; j++)
+			{
+				auto lod = Renderables_GetLod(actors[j]->GetRenderable_PtrRaw(), actors[j]->GetRenderable_PtrRaw()->Geometry_BB());
+				instanceTransforms[lod].emplace_back(Renderables_GetWorld(actors[j]));
+			}
+
+			unsigned int vertexOffset = Renderables_BindGeometry(pipeline, actor, &currentlyBoundGeometry);
+			Instances_DrawLods(pipeline, renderable, instanceTransforms, { m_shaderLightDepth->GetConstantBuffer() }, vertexOffset);
+		}
+	}
+
+	void Renderer::Pass_DepthLocalLights()
+	{
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Moving casters change their key, skinned ones move in place so they change it every frame
+		m_shadowAtlas->Casters_Clear();
+		for (const auto& actor : m_actors[Renderable_ObjectOpaque])
+		{
+			Renderable* renderable = actor->GetRenderable_PtrRaw();
+			if (!renderable || !renderable->GetCastShadows())
+				continue;
+
+			uint64_t key = (((uint64_t)(uintptr_t)actor ^ 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull) ^ ShadowAtlas::Hash(Renderables_GetWorld(actor));
+			if (renderable->Geometry_IsSkinned())
+			{
+				key ^= m_frame * 0x94D049BB133111EBull;
+			}
+			m_shadowAtlas->Caster_Add(actor, renderable->Geometry_BB(), key);
+		}
+		m_shadowAtlas->Update(m_actors[Renderable_Light], m_camera, RenderFlags_IsSet(Render_ReverseZ));
+
+		// The atlas has no depth buffer, so every tile is rendered on it's own and copied into place. Tiles are independent of each other.
+		const auto& dirty = m_shadowAtlas->Tiles_GetDirty();
+		vector<shared_ptr<RHI_RenderTexture>> targets;
+		FrameVector<function<void(shared_ptr<RHI_Pipeline>&)>> jobs(m_context->GetFrameAllocatorSTL<function<void(shared_ptr<RHI_Pipeline>&)>>());
+		for (auto index : dirty)
+		{
+			const auto& tile = m_shadowAtlas->Tile_Get(index);
+			targets.emplace_back(m_renderTexturePool->Acquire(tile.size, tile.size, Texture_Format_R32_FLOAT, true, Texture_Format_D32_FLOAT));
+			jobs.emplace_back([this, index, target = targets.back()](shared_ptr<RHI_Pipeline>& pipeline)
+			{
+				const auto& tile = m_shadowAtlas->Tile_Get(index);
+				Pass_DepthDirectionalLight_Casters(pipeline, target, tile.viewProjection, m_shadowAtlas->Tile_GetCasters(index), true);
+				m_shadowAtlas->GetAtlas()->CopyRegionFrom(target, tile.x, tile.y);
+			});
+		}
+		CommandLists_Record(jobs);
+
+		for (auto index : dirty)
+		{
+			m_shadowAtlas->Tile_Rendered(index);
+		}
+		for (const auto& target : targets)
+		{
+			m_renderTexturePool->Release(target, true);
+		}
+		m_shadowAtlas->Upload();
+	}
+
+	void Renderer::Pass_GBuffer()
+	{
+		if (!m_rhiDevice)
+			return;
+
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Occlusion is tested against the depth of an earlier frame, pick up the latest one the GPU has finished
+		if (RenderFlags_IsSet(Render_OcclusionCulling) && m_viewRendering == -1)
+		{
+			m_occlusionCulling->Readback_Update();
+		}
+
+		// Copies into the texture arrays go to the immediate context, ahead of every command list that samples them
+		Pass_GBuffer_MaterialTextures();
+
+		// GPU driven, the CPU doesn't look at individual objects (the main camera's, views are culled on the CPU)
+		if (RenderFlags_IsSet(Render_GPUDriven) && Pass_GBuffer_Indirect_IsSupported() && m_viewRendering == -1)
+		{
+			m_rhiDevice->Compute_Wait();
+			Pass_GBuffer_Indirect();
+
+			// Skinned actors aren't culled on the GPU, their posed vertices are drawn like without it
+			if (!m_gpuSkinning->GetActors().empty())
+			{
+				m_depthPrepass = false;
+				Pass_GBuffer_Range(m_rhiPipeline, m_gpuSkinning->GetActors(), 0, (unsigned int)m_gpuSkinning->GetActors().size(), false);
+			}
+			Pass_GBuffer_Terrain(m_rhiPipeline, false);
+			return;
+		}
+
+		// Impostors earlier frames asked for, baked on the immediate context ahead of the command lists that draw them
+		if (RenderFlags_IsSet(Render_Impostors) && m_viewRendering == -1)
+		{
+			Pass_Impostors_Bake();
+		}
+
+		// Split the opaque actors into one range per available thread, as long as each range is worth recording
+		auto& actors			= m_actors[Renderable_ObjectOpaque];
+		auto actorCount			= (unsigned int)actors.size();
+		auto threadCount		= m_context->GetSubsystem<Threading>()->GetThreadCount() + 1;
+		auto jobCount			= Clamp(actorCount / COMMAND_LIST_ACTORS_MIN, 1u, threadCount);
+		auto actorsPerJob		= (actorCount + jobCount - 1) / jobCount;
+
+		FrameVector<pair<unsigned int, unsigned int>> ranges(m_context->GetFrameAllocatorSTL<pair<unsigned int, unsigned int>>());
+		unsigned int start = 0;
+		while (start < actorCount || ranges.empty())
+		{
+			// Don't split a run of instances across ranges
+			unsigned int end = Min(start + actorsPerJob, actorCount);
+			while (end < actorCount && end > 0 && Renderables_AreInstances(actors[end - 1], actors[end])) { end++; }
+
+			ranges.emplace_back(start, end);
+			start = end;
+		}
+
+		// With a depth pre-pass, the same ranges are drawn depth only first, the jobs execute in order
+		m_depthPrepass = RenderFlags_IsSet(Render_DepthPrepass) && m_shaderDepthPrepass->GetState() == Shader_Built;
+		if (m_depthPrepass)
+		{
+			m_shaderDepthPrepass->UpdatePerObjectBuffer(m_mV_origin, m_mP_perspective, m_mVP_unjittered_origin, m_mVP_previous_origin);
+		}
+
+		FrameVector<function<void(shared_ptr<RHI_Pipeline>&)>> jobs(m_context->GetFrameAllocatorSTL<function<void(shared_ptr<RHI_Pipeline>&)>>());
+		for (unsigned int pass = m_depthPrepass ? 0 : 1; pass < 2; pass++)
+		{
+			for (const auto& range : ranges)
+			{
+				bool clear		= jobs.empty();
+				bool depthOnly	= pass == 0;
+				jobs.emplace_back([this, &actors, range, clear, depthOnly](shared_ptr<RHI_Pipeline>& pipeline) { Pass_GBuffer_Range(pipeline, actors, range.first, range.second, clear, depthOnly); });
+			}
+		}
+		if (!m_actors[Renderable_Terrain].empty())
+		{
+			jobs.emplace_back([this](shared_ptr<RHI_Pipeline>& pipeline) { Pass_GBuffer_Terrain(pipeline, false); });
+		}
+		CommandLists_Record(jobs);
+	}
+
+	void Renderer::Pass_GBuffer_Range(shared_ptr<RHI_Pipeline>& pipeline, const vector<Actor*>& actors, unsigned int start, unsigned int end, bool clear, bool depthOnly /*= false*/)
+	{
+		//  Bind render target, only the first range clears it
+		m_gbuffer->SetAsRenderTarget(pipeline, clear);
+		pipeline->SetViewport(DynamicResolution_GetViewport(m_gbuffer->GetTexture(GBuffer_Target_Albedo)));
+		pipeline->SetSampler(m_samplerAnisotropicWrapAlways);
+		pipeline->SetFillMode(Fill_Solid);
+		pipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+
+		// The depth occlusion is tested against is the main camera's
+		bool occlusionCulling = RenderFlags_IsSet(Render_OcclusionCulling) && m_viewRendering == -1;
+		Pass_GBuffer_UpdateFrameBuffer();
+
+		// Variables that help reduce state changes
+		bool vertexShaderBound				= false;
+		unsigned int currentlyBoundGeometry = 0;
+		unsigned int currentlyBoundShader	= 0;
+		unsigned int currentlyBoundMaterial = 0;
+		shared_ptr<RHI_ConstantBuffer> materialBuffer;
+		vector<Matrix> instanceTransforms[MODEL_LODS_MAX];
+		vector<Matrix> impostorTransforms;
+		bool impostors = RenderFlags_IsSet(Render_Impostors) && m_shaderImpostor->HasVertexShader() && m_shaderImpostor->HasPixelShader();
+
+		for (unsigned int i = start; i < end;)
+		{
+			// Find the run of consecutive actors that can be drawn as instances of this one
+			Actor* actor			= actors[i];
+			unsigned int runStart	= i++;
+			while (i < end && Renderables_AreInstances(actor, actors[i])) { i++; }
+
+			// Get renderable and material
+			Renderable* renderable	= actor->GetRenderable_PtrRaw();
+			Material* material		= renderable ? renderable->Material_Ptr().get() : nullptr;
+
+			if (!renderable || !material)
+				continue;
+
+			// Get shader and geometry, drawing with the fallback until the material's shader has compiled
+			auto shader		= material->GetShader().lock();
+			Model* model	= renderable->Geometry_Model();
+			if (!shader || shader->GetState() != Shader_Built)
+			{
+				shader = m_shaderFallback;
+			}
+
+			// Validate shader
+			if (!shader || shader->GetState() != Shader_Built)
+				continue;
+
+			// Validate geometry
+			if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+				continue;
+
+			// Masked materials discard pixels, they write their own depth during the G-Buffer pass
+			bool prepassed = m_depthPrepass && !shader->HasMaskTexture();
+			if (depthOnly && !prepassed)
+				continue;
+
+			// Far away, static geometry is drawn out of it's impostor once it's baked (the slot is looked up once per run)
+			bool impostor		= impostors && !renderable->Geometry_IsSkinned();
+			int impostorSlot	= -2;
+
+			// Gather the instances per level of detail, skipping objects outside of the view frustum or hidden behind others
+			bool visible		= false;
+			float screenSize	= 0.0f;
+			for (auto& transforms : instanceTransforms) { transforms.clear(); }
+			for (unsigned int j = runStart; j < i; j++)
+			{
+				if (!Renderables_IsVisible(actors[j]))
+					continue;
+
+				const auto& box = actors[j]->GetRenderable_PtrRaw()->Geometry_BB();
+
+				if (occlusionCulling && m_occlusionCulling->IsOccluded(box))
+					continue;
+
+				float size = Renderables_GetScreenSize(box);
+				if (impostor && size < m_impostorScreenSize)
+				{
+					impostorSlot = impostorSlot == -2 ? m_impostors->Get(renderable) : impostorSlot;
+					if (impostorSlot >= 0)
+					{
+						// The impostor writes it's own depth, it's left out of the depth pre-pass
+						if (!depthOnly)
+						{
+							impostorTransforms.emplace_back(Impostors::GetTransform(renderable->Geometry_AABB(), Renderables_GetWorldRelative(actors[j]), (unsigned int)impostorSlot));
+						}
+						continue;
+					}
+				}
+
+				instanceTransforms[Renderables_GetLod(actors[j]->GetRenderable_PtrRaw(), box)].emplace_back(Renderables_GetWorldRelative(actors[j]));
+				screenSize	= Max(screenSize, size);
+				visible		= true;
+			}
+
+			if (!visible)
+				continue;
+
+			// set face culling (changes only if required)
+			pipeline->SetCullMode(material->GetCullMode());
+
+			// Bind geometry
+			unsigned int vertexOffset = Renderables_BindGeometry(pipeline, actor, &currentlyBoundGeometry);
+
+			// Depth only, one shader for everything and no materials
+			if (depthOnly)
+			{
+				if (!vertexShaderBound)
+				{
+					pipeline->SetVertexShader(shared_ptr<RHI_Shader>(m_shaderDepthPrepass));
+					pipeline->SetPixelShader(shared_ptr<RHI_Shader>(m_shaderDepthPrepass));
+					vertexShaderBound = true;
+				}
+				Instances_DrawLods(pipeline, renderable, instanceTransforms, { m_shaderDepthPrepass->GetPerObjectBuffer(), m_gbufferFrameBuffer }, vertexOffset);
+				continue;
+			}
+
+			// Stream in the mips the largest instance needs
+			g_streaming->Material_Request(material, screenSize * Settings::Get().Resolution_GetHeight());
+
+			// Pixels that made it through the pre-pass are the visible ones, their depth is already there
+			pipeline->SetDepthWrite(!prepassed);
+
+			// Bind shader
+			if (currentlyBoundShader != shader->Resource_GetID())
+			{
+				if (!vertexShaderBound)
+				{
+					pipeline->SetVertexShader(shared_ptr<RHI_Shader>(shader));
+					vertexShaderBound = true;
+				}
+				pipeline->SetPixelShader(shared_ptr<RHI_Shader>(shader));
+				currentlyBoundShader = shader->Resource_GetID();
 
-					// Acquire material
-					Material* material = renderable ? renderable->Material_Ptr().get() : nullptr;
-					if (!material)
-						continue;
+				// UPDATE PER OBJECT BUFFER
+				shader->UpdatePerObjectBuffer(m_mV_origin, m_mP_perspective, m_mVP_unjittered_origin, m_mVP_previous_origin);
+			}
 
-					// Acquire geometry
-					Model* geometry = renderable->Geometry_Model();
-					if (!geometry || !geometry->GetVertexBuffer() || !geometry->GetIndexBuffer())
-						continue;
+			// Bind material
+			if (currentlyBoundMaterial != material->Resource_GetID())
+			{
+				materialBuffer			= Pass_GBuffer_SetMaterial(pipeline, material);
+				currentlyBoundMaterial	= material->Resource_GetID();
+			}
 
-					// Skip meshes that don't cast shadows
-					if (!renderable->GetCastShadows())
-						continue;
+			// Render
+			Instances_DrawLods(pipeline, renderable, instanceTransforms, { materialBuffer, shader->GetPerObjectBuffer(), m_gbufferFrameBuffer }, vertexOffset);
 
-					// Skip transparent meshes (for now)
-					if (material->GetColorAlbedo().w < 1.0f)
-						continue;
+		} // Actor/MESH ITERATION
 
-					// Bind geometry
-					if (currentlyBoundGeometry != geometry->Resource_GetID())
-					{
-						m_rhiPipeline->SetIndexBuffer(geometry->GetIndexBuffer());
-						m_rhiPipeline->SetVertexBuffer(geometry->GetVertexBuffer());					
-						currentlyBoundGeometry = geometry->Resource_GetID();
-					}
+		if (!impostorTransforms.empty())
+		{
+			Pass_GBuffer_Impostors(pipeline, impostorTransforms);
+		}
 
-					// skip objects outside of the view frustum
-					//if (!m_directionalLight->IsInViewFrustum(obj_renderable, i))
-					//continue;
+		pipeline->SetDepthWrite(true);
+	}
 
-					auto buffer = Struct_Matrix(actor->GetTransform_PtrRaw()->GetWorldTransform() * light->GetViewMatrix() * light->ShadowMap_GetProjectionMatrix(i));
-					m_shaderLightDepth->UpdateBuffer(&buffer);
-					m_rhiPipeline->SetConstantBuffer(m_shaderLightDepth->GetConstantBuffer());
-					m_rhiPipeline->Bind();
+	void Renderer::Pass_GBuffer_Terrain(shared_ptr<RHI_Pipeline>& pipeline, bool clear)
+	{
+		auto& actors = m_actors[Renderable_Terrain];
+		if (actors.empty())
+			return;
+
+		m_gbuffer->SetAsRenderTarget(pipeline, clear);
+		pipeline->SetViewport(DynamicResolution_GetViewport(m_gbuffer->GetTexture(GBuffer_Target_Albedo)));
+		pipeline->SetSampler(m_samplerAnisotropicWrapAlways);
+		pipeline->SetFillMode(Fill_Solid);
+		pipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		pipeline->SetDepthWrite(true);
+		Pass_GBuffer_UpdateFrameBuffer();
+
+		vector<Terrain_Chunk> chunks;
+		for (auto actor : actors)
+		{
+			auto terrain			= actor->GetComponent_PtrRaw<Terrain>();
+			Renderable* renderable	= actor->GetRenderable_PtrRaw();
+			Material* material		= renderable ? renderable->Material_Ptr().get() : nullptr;
+			if (!terrain || !material || !terrain->GetIndexBuffer())
+				continue;
+
+			auto shader = material->GetShader().lock();
+			if (!shader || shader->GetState() != Shader_Built)
+			{
+				shader = m_shaderFallback;
+			}
+
+			if (!shader || shader->GetState() != Shader_Built)
+				continue;
+
+			// Chunks are selected in the terrain's space, from wherever the camera (or the view) is
+			const Matrix& world = Renderables_GetWorld(actor);
+			chunks.clear();
+			terrain->Chunks_Select(Camera_GetPosition() * world.Inverted(), &chunks);
+			if (chunks.empty())
+				continue;
 
-					m_rhiDevice->DrawIndexed(renderable->Geometry_IndexCount(), renderable->Geometry_IndexOffset(), renderable->Geometry_VertexOffset());
+			// The whole terrain can be on screen
+			g_streaming->Material_Request(material, (float)Settings::Get().Resolution_GetHeight());
+
+			pipeline->SetCullMode(material->GetCullMode());
+			pipeline->SetVertexShader(shared_ptr<RHI_Shader>(shader));
+			pipeline->SetPixelShader(shared_ptr<RHI_Shader>(shader));
+			shader->UpdatePerObjectBuffer(m_mV_origin, m_mP_perspective, m_mVP_unjittered_origin, m_mVP_previous_origin);
+			auto materialBuffer = Pass_GBuffer_SetMaterial(pipeline, material);
+
+			vector<Matrix> transforms = { Renderables_GetWorldRelative(actor) };
+			pipeline->SetIndexBuffer(terrain->GetIndexBuffer());
+			for (const auto& chunk : chunks)
+			{
+				// Views are culled on the CPU against their own frustum, only the main camera's is at hand here
+				if (m_viewRendering == -1 && m_camera)
+				{
+					BoundingBox box = chunk.box.Transformed(world);
+					if (!m_camera->IsInViewFrustrum(box.GetCenter(), box.GetExtents()))
+						continue;
 				}
 
-				m_rhiDevice->EventEnd();
+				pipeline->SetVertexBuffer(chunk.vertexBuffer);
+				Instances_Draw(pipeline, transforms, { materialBuffer, shader->GetPerObjectBuffer(), m_gbufferFrameBuffer }, terrain->GetIndexCount(), 0, 0);
 			}
 		}
+	}
 
-		m_rhiDevice->EventEnd();
-
-		TIME_BLOCK_END_MULTI();
+	void Renderer::Pass_GBuffer_Impostors(shared_ptr<RHI_Pipeline>& pipeline, const vector<Matrix>& transforms)
+	{
+		auto buffer = Struct_Impostors(m_mV_origin, m_mP_perspective, m_mVP_unjittered_origin, m_mVP_previous_origin, Camera_GetPosition() - m_origin, m_farPlane);
+		m_shaderImpostor->UpdateBuffer(&buffer);
+
+		// Quads face the camera either way, and they write the depth of the surface they stand in for
+		pipeline->SetCullMode(Cull_None);
+		pipeline->SetDepthWrite(true);
+		pipeline->SetVertexShader(m_shaderImpostor);
+		pipeline->SetPixelShader(m_shaderImpostor);
+		pipeline->SetIndexBuffer(m_impostors->GetIndexBuffer());
+		pipeline->SetVertexBuffer(m_impostors->GetVertexBuffer());
+		pipeline->SetTexture(m_impostors->GetAtlas(GBuffer_Target_Albedo));
+		pipeline->SetTexture(m_impostors->GetAtlas(GBuffer_Target_Normal));
+		pipeline->SetTexture(m_impostors->GetAtlas(GBuffer_Target_Specular));
+		pipeline->SetTexture(m_impostors->GetAtlas(GBuffer_Target_Depth));
+
+		Instances_Draw(pipeline, transforms, { m_shaderImpostor->GetConstantBuffer() }, 6, 0, 0);
 	}
 
-	void Renderer::Pass_GBuffer()
+	void Renderer::Pass_Impostors_Bake()
 	{
-		if (!m_rhiDevice)
+		Renderable* renderable	= nullptr;
+		unsigned int slot		= 0;
+		if (!m_impostors->Bake_Next(m_actors[Renderable_ObjectOpaque], &renderable, &slot))
+			return;
+
+		// Baked with the fallback it would stay that way, so it waits for the material's shader
+		Material* material	= renderable->Material_Ptr().get();
+		Model* model		= renderable->Geometry_Model();
+		auto shader			= material->GetShader().lock();
+		if (!shader || shader->GetState() != Shader_Built || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+			return;
+
+		const auto& aabb	= renderable->Geometry_AABB();
+		Vector3 center		= aabb.GetCenter();
+		float radius		= aabb.GetExtents().Length();
+		if (radius <= 0.0f)
 			return;
 
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_GBuffer");
+		TIME_BLOCK_SCOPED_MULTI();
+		m_rhiDevice->EventBegin("Pass_Impostors_Bake");
+
+		// A view is a small part of the tile, the textures don't need more than that
+		g_streaming->Material_Request(material, (float)IMPOSTOR_CELL_SIZE);
+
+		// Cleared to transparent black, so what the renderable doesn't cover can be told apart
+		GBuffer gbuffer(m_renderTexturePool, IMPOSTOR_TILE_SIZE, IMPOSTOR_TILE_SIZE);
+		gbuffer.SetAsRenderTarget(m_rhiPipeline, false);
+		for (auto type : { GBuffer_Target_Albedo, GBuffer_Target_Normal, GBuffer_Target_Specular, GBuffer_Target_Depth, GBuffer_Target_Velocity })
+		{
+			m_rhiDevice->ClearRenderTarget(gbuffer.GetTexture(type)->GetRenderTargetView(), Vector4::Zero);
+		}
+		const auto& depth = gbuffer.GetTexture(GBuffer_Target_Depth);
+		m_rhiDevice->ClearDepthStencil(depth->GetDepthStencilView(), Clear_Depth, m_rhiDevice->Get_DepthFar(depth->GetViewport()));
 
-		//  Bind render target
-		m_gbuffer->SetAsRenderTarget(m_rhiPipeline);
 		m_rhiPipeline->SetSampler(m_samplerAnisotropicWrapAlways);
 		m_rhiPipeline->SetFillMode(Fill_Solid);
 		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetBlendMode(Blend_Disabled);
+		m_rhiPipeline->SetCullMode(material->GetCullMode());
+		m_rhiPipeline->SetDepthWrite(true);
+		m_rhiPipeline->SetVertexShader(shared_ptr<RHI_Shader>(shader));
+		m_rhiPipeline->SetPixelShader(shared_ptr<RHI_Shader>(shader));
+		m_rhiPipeline->SetIndexBuffer(model->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(model->GetVertexBuffer());
+		auto materialBuffer = Pass_GBuffer_SetMaterial(m_rhiPipeline, material);
+
+		// Full detail, in the renderable's own space, from every direction of the grid
+		vector<Matrix> transforms	= { Matrix::Identity };
+		Matrix projection			= Impostors::GetProjection(radius, m_rhiDevice->Get_DepthReverse());
+		for (unsigned int y = 0; y < IMPOSTOR_GRID; y++)
+		{
+			for (unsigned int x = 0; x < IMPOSTOR_GRID; x++)
+			{
+				Vector3 direction		= Impostors::GetViewDirection(x, y);
+				Matrix view				= Impostors::GetView(center, radius, direction);
+				Matrix viewProjection	= view * projection;
+				shader->UpdatePerObjectBuffer(view, projection, viewProjection, viewProjection);
+
+				// The linear depth is over the sphere's diameter, what Impostor.hlsl reconstructs the surface from
+				auto frame = (Struct_GBufferFrame*)m_gbufferFrameBuffer->Map();
+				if (!frame)
+				{
+					m_rhiDevice->EventEnd();
+					return;
+				}
+				*frame = Struct_GBufferFrame(center + direction * radius, Vector2(0.0f, radius * 2.0f), Vector2((float)IMPOSTOR_TILE_SIZE, (float)IMPOSTOR_TILE_SIZE));
+				m_gbufferFrameBuffer->Unmap();
 
-		// Variables that help reduce state changes
-		bool vertexShaderBound				= false;
-		unsigned int currentlyBoundGeometry = 0;
-		unsigned int currentlyBoundShader	= 0;
-		unsigned int currentlyBoundMaterial = 0;
+				m_rhiPipeline->SetViewport(RHI_Viewport(float(x * IMPOSTOR_CELL_SIZE), float(y * IMPOSTOR_CELL_SIZE), (float)IMPOSTOR_CELL_SIZE, (float)IMPOSTOR_CELL_SIZE, 0.0f, 1.0f));
+				Instances_Draw(m_rhiPipeline, transforms, { materialBuffer, shader->GetPerObjectBuffer(), m_gbufferFrameBuffer }, renderable->Geometry_IndexCount(), renderable->Geometry_IndexOffset(), renderable->Geometry_VertexOffset());
+			}
+		}
+
+		m_impostors->Bake_Store(renderable, slot, &gbuffer);
+		m_rhiDevice->EventEnd();
+	}
+
+	const shared_ptr<RHI_ConstantBuffer>& Renderer::Pass_GBuffer_SetMaterial(shared_ptr<RHI_Pipeline>& pipeline, Material* material)
+	{
+		// Out of arrays (t10 onwards), only the arrays that differ from the previous material's get bound
+		void* arrays[MATERIAL_GBUFFER_TEXTURES];
+		unsigned int slices[MATERIAL_GBUFFER_TEXTURES];
+		if (RenderFlags_IsSet(Render_TextureArrays) && m_materialTextures->Material_Get(material, arrays, slices))
+		{
+			for (unsigned int i = 0; i < 10; i++)		{ pipeline->SetShaderResource(nullptr); }
+			for (auto array : arrays)					{ pipeline->SetShaderResource(array); }
+			return material->UpdateConstantBuffer(slices);
+		}
+
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Albedo).ptr_raw);
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Roughness).ptr_raw);
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Metallic).ptr_raw);
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Normal).ptr_raw);
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Height).ptr_raw);
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Occlusion).ptr_raw);
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Emission).ptr_raw);
+		pipeline->SetTexture(material->GetTextureSlotByType(TextureType_Mask).ptr_raw);
+
+		return material->UpdateConstantBuffer();
+	}
+
+	void Renderer::Pass_GBuffer_UpdateFrameBuffer()
+	{
+		auto buffer = (Struct_GBufferFrame*)m_gbufferFrameBuffer->Map();
+		if (!buffer)
+			return;
+
+		*buffer = Struct_GBufferFrame(Camera_GetPosition() - m_origin, Vector2(m_nearPlane, m_farPlane), Settings::Get().Resolution_Get());
+		m_gbufferFrameBuffer->Unmap();
+	}
+
+	void Renderer::Pass_GBuffer_MaterialTextures()
+	{
+		if (!RenderFlags_IsSet(Render_TextureArrays))
+		{
+			m_materialTextures->Clear();
+			return;
+		}
 
+		// The opaque actors are sorted by material, so most are skipped
+		m_materialTextures->Update();
+		Material* previous = nullptr;
 		for (auto actor : m_actors[Renderable_ObjectOpaque])
 		{
-			// Get renderable and material
 			Renderable* renderable	= actor->GetRenderable_PtrRaw();
 			Material* material		= renderable ? renderable->Material_Ptr().get() : nullptr;
+			if (material && material != previous)
+			{
+				m_materialTextures->Material_Add(material);
+			}
+			previous = material;
+		}
+	}
 
-			if (!renderable || !material)
-				continue;
+	void Renderer::Pass_Culling()
+	{
+		TIME_BLOCK_SCOPED_MULTI();
 
-			// Get shader and geometry
-			auto shader		= material->GetShader().lock();
-			Model* model	= renderable->Geometry_Model();
+		m_rhiDevice->Compute_Begin();
+		m_gpuCullingDispatched = Pass_Culling_Dispatch();
+		m_rhiDevice->Compute_End();
+	}
 
-			// Validate shader
-			if (!shader || shader->GetState() != Shader_Built)
+	bool Renderer::Pass_Culling_Dispatch()
+	{
+		// Every run of instances becomes a draw, it's objects are uploaded as they are
+		auto& actors = m_actors[Renderable_ObjectOpaque];
+		m_gpuCulling->Clear();
+		m_gpuCullingDraws.clear();
+		for (unsigned int i = 0; i < (unsigned int)actors.size();)
+		{
+			Actor* actor			= actors[i];
+			unsigned int runStart	= i++;
+			while (i < (unsigned int)actors.size() && Renderables_AreInstances(actor, actors[i])) { i++; }
+
+			Renderable* renderable	= actor->GetRenderable_PtrRaw();
+			Model* model			= renderable ? renderable->Geometry_Model() : nullptr;
+			if (!renderable || !renderable->Material_Ptr() || !model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
 				continue;
 
-			// Validate geometry
-			if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+			// Skinned actors are drawn after the indirect draws, from their posed vertices
+			if (m_gpuSkinning->Instance_GetVertexOffset(actor) != -1)
 				continue;
 
-			// Skip objects outside of the view frustum
-			if (!m_camera->IsInViewFrustrum(renderable))
+			// Culling happens on the GPU, so mips are streamed for whatever is inside the view frustum
+			auto draw			= m_gpuCulling->Draw_Add(renderable, i - runStart, m_shaderCulling_Cluster->HasComputeShader());
+			float screenSize	= 0.0f;
+			for (unsigned int j = runStart; j < i; j++)
+			{
+				const auto& box = actors[j]->GetRenderable_PtrRaw()->Geometry_BB();
+				m_gpuCulling->Object_Add(Renderables_GetWorldRelative(actors[j]), box, draw);
+				if (Renderables_IsVisible(actors[j]))
+				{
+					screenSize = Max(screenSize, Renderables_GetScreenSize(box));
+				}
+			}
+			g_streaming->Material_Request(renderable->Material_Ptr().get(), screenSize * Settings::Get().Resolution_GetHeight());
+			m_gpuCullingDraws.emplace_back(actor);
+		}
+
+		if (!m_gpuCulling->Upload())
+			return false;
+
+		// Cull, against the depth pyramid of the previous frame when occlusion culling is enabled
+		{
+			m_rhiDevice->EventBegin("Culling");
+
+			auto& levels			= m_occlusionCulling->GetLevels();
+			unsigned int levelCount	= RenderFlags_IsSet(Render_OcclusionCulling) ? Min((unsigned int)levels.size(), (unsigned int)GPU_CULLING_HIZ_LEVELS_MAX) : 0;
+			auto buffer = Struct_Culling
+			(
+				m_mVP_unjittered,
+				m_gpuCulling->Occluder_GetViewProjection(),
+				Camera_GetPosition(),
+				m_mP_perspective.m11,
+				m_gpuCulling->Occluder_GetFarPlane(),
+				m_gpuCulling->GetObjectCount(),
+				m_gpuCulling->GetArgumentCount(),
+				levelCount,
+				RenderFlags_IsSet(Render_CameraRelative) ? Camera_GetPosition() : Vector3::Zero
+			);
+			m_shaderCulling_Cull->UpdateBuffer(&buffer);
+
+			void* constantBuffer							= m_shaderCulling_Cull->GetConstantBuffer()->GetBuffer();
+			void* textures[2 + GPU_CULLING_HIZ_LEVELS_MAX]	= { m_gpuCulling->GetObjectBuffer()->GetShaderResource(), m_gpuCulling->GetDrawBuffer()->GetShaderResource() };
+			void* views[2]									= { m_gpuCulling->GetInstanceBuffer()->GetUnorderedAccessView(), m_gpuCulling->GetArgumentBuffer()->GetUnorderedAccessView() };
+			for (unsigned int i = 0; i < levelCount; i++)
+			{
+				textures[2 + i] = levels[i]->GetShaderResource();
+			}
+			m_rhiDevice->Set_ConstantBuffers(0, 1, Buffer_ComputeShader, &constantBuffer);
+			m_rhiDevice->Set_ComputeTextures(0, 2 + GPU_CULLING_HIZ_LEVELS_MAX, textures);
+			m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 2, views);
+
+			m_rhiDevice->Set_ComputeShader(m_shaderCulling_Reset->GetComputeShaderBuffer());
+			m_rhiDevice->Dispatch((m_gpuCulling->GetArgumentCount() + GPU_CULLING_THREAD_GROUP_SIZE - 1) / GPU_CULLING_THREAD_GROUP_SIZE, 1);
+			m_rhiDevice->Set_ComputeShader(m_shaderCulling_Cull->GetComputeShaderBuffer());
+			m_rhiDevice->Dispatch((m_gpuCulling->GetObjectCount() + GPU_CULLING_THREAD_GROUP_SIZE - 1) / GPU_CULLING_THREAD_GROUP_SIZE, 1);
+
+			// Then the clusters of what's left, a dispatch per draw as each reads it's own model's indices
+			if (!m_gpuCulling->GetClusteredDraws().empty())
+			{
+				void* compacted = m_gpuCulling->GetCompactedIndexBuffer()->GetUnorderedAccessView();
+				m_rhiDevice->Set_ComputeUnorderedAccessViews(2, 1, &compacted);
+				m_rhiDevice->Set_ComputeShader(m_shaderCulling_Cluster->GetComputeShaderBuffer());
+				for (unsigned int draw : m_gpuCulling->GetClusteredDraws())
+				{
+					Model* model			= m_gpuCullingDraws[draw]->GetRenderable_PtrRaw()->Geometry_Model();
+					void* clusterViews[2]	= { model->GetIndexBuffer()->GetShaderResource(), m_gpuCulling->GetClusterBuffer()->GetShaderResource() };
+					m_rhiDevice->Set_ComputeTextures(2 + GPU_CULLING_HIZ_LEVELS_MAX, 2, clusterViews);
+
+					unsigned int clusterCount	= m_gpuCulling->GetClusterCount(draw);
+					buffer.m_clusterDraw		= draw;
+					buffer.m_clusterOffset		= m_gpuCulling->GetClusterOffset(draw);
+					buffer.m_clusterCount		= clusterCount;
+					m_shaderCulling_Cull->UpdateBuffer(&buffer);
+					m_rhiDevice->Set_ConstantBuffers(0, 1, Buffer_ComputeShader, &constantBuffer);
+
+					m_rhiDevice->Dispatch(Min(clusterCount, (unsigned int)GPU_CULLING_CLUSTER_DISPATCH_WIDTH), (clusterCount + GPU_CULLING_CLUSTER_DISPATCH_WIDTH - 1) / GPU_CULLING_CLUSTER_DISPATCH_WIDTH);
+				}
+			}
+
+			// The pyramid gets rendered into later on and the buffers get read by the vertex shader (the compacted indices by the input assembler)
+			void* nulls[4 + GPU_CULLING_HIZ_LEVELS_MAX] = { nullptr };
+			m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 3, nulls);
+			m_rhiDevice->Set_ComputeTextures(0, 4 + GPU_CULLING_HIZ_LEVELS_MAX, nulls);
+			m_rhiDevice->Set_ComputeShader(nullptr);
+
+			m_rhiDevice->EventEnd();
+		}
+
+		return true;
+	}
+
+	void Renderer::Pass_GBuffer_Indirect()
+	{
+		auto& pipeline = m_rhiPipeline;
+		m_gbuffer->SetAsRenderTarget(pipeline, true);
+		pipeline->SetViewport(DynamicResolution_GetViewport(m_gbuffer->GetTexture(GBuffer_Target_Albedo)));
+		pipeline->SetSampler(m_samplerAnisotropicWrapAlways);
+		pipeline->SetFillMode(Fill_Solid);
+		pipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+
+		if (!m_gpuCullingDispatched)
+		{
+			pipeline->Bind(); // still clears the G-Buffer
+			return;
+		}
+		m_gpuCullingDispatched = false;
+
+		// Draw, the visible instance counts never come back to the CPU
+		void* vertexResources[2] = { m_gpuCulling->GetObjectBuffer()->GetShaderResource(), m_gpuCulling->GetInstanceBuffer()->GetShaderResource() };
+		m_rhiDevice->Set_VertexTextures(8, 2, vertexResources);
+		pipeline->SetVertexShader(m_shaderGBufferIndirect);
+
+		Pass_GBuffer_UpdateFrameBuffer();
+		unsigned int currentlyBoundGeometry = 0;
+		unsigned int currentlyBoundShader	= 0;
+		unsigned int currentlyBoundMaterial = 0;
+		shared_ptr<RHI_ConstantBuffer> materialBuffer;
+		auto& drawConstants					= m_gpuCulling->GetDrawConstantBuffer();
+		for (unsigned int draw = 0; draw < (unsigned int)m_gpuCullingDraws.size(); draw++)
+		{
+			Renderable* renderable	= m_gpuCullingDraws[draw]->GetRenderable_PtrRaw();
+			Material* material		= renderable->Material_Ptr().get();
+			Model* model			= renderable->Geometry_Model();
+
+			// Drawing with the fallback until the material's shader has compiled
+			auto shader = material->GetShader().lock();
+			if (!shader || shader->GetState() != Shader_Built)
+			{
+				shader = m_shaderFallback;
+			}
+
+			if (!shader || shader->GetState() != Shader_Built)
 				continue;
 
-			// set face culling (changes only if required)
-			m_rhiPipeline->SetCullMode(material->GetCullMode());
+			pipeline->SetCullMode(material->GetCullMode());
 
-			// Bind geometry
 			if (currentlyBoundGeometry != model->Resource_GetID())
 			{	
-				m_rhiPipeline->SetIndexBuffer(model->GetIndexBuffer());
-				m_rhiPipeline->SetVertexBuffer(model->GetVertexBuffer());
+				pipeline->SetIndexBuffer(model->GetIndexBuffer());
+				pipeline->SetVertexBuffer(model->GetVertexBuffer());
 				currentlyBoundGeometry = model->Resource_GetID();
 			}
 
-			// Bind shader
 			if (currentlyBoundShader != shader->Resource_GetID())
 			{
-				if (!vertexShaderBound)
-				{
-					m_rhiPipeline->SetVertexShader(shared_ptr<RHI_Shader>(shader));
-					vertexShaderBound = true;
-				}
-				m_rhiPipeline->SetPixelShader(shared_ptr<RHI_Shader>(shader));
+				pipeline->SetPixelShader(shared_ptr<RHI_Shader>(shader));
+				shader->UpdatePerObjectBuffer(m_mV_origin, m_mP_perspective, m_mVP_unjittered_origin, m_mVP_previous_origin);
 				currentlyBoundShader = shader->Resource_GetID();
 			}
 
-			// Bind material
 			if (currentlyBoundMaterial != material->Resource_GetID())
 			{
-				shader->UpdatePerMaterialBuffer(m_camera, material);
+				materialBuffer			= Pass_GBuffer_SetMaterial(pipeline, material);
+				currentlyBoundMaterial	= material->Resource_GetID();
+			}
+
+			// One draw per level of detail, the vertex shader finds it's instances through the per draw constants.
+			// The full detail of a clustered draw is what's left of it's clusters.
+			for (unsigned int lod = 0; lod < m_gpuCulling->GetLodCount(draw); lod++)
+			{
+				bool clustered				= lod == 0 && m_gpuCulling->IsClustered(draw);
+				unsigned int firstConstant	= 0;
+				auto buffer = (Struct_IndirectDraw*)drawConstants->Map(&firstConstant);
+				if (!buffer)
+					break;
+				buffer->m_instanceOffset = m_gpuCulling->GetInstanceOffset(draw, lod);
+				drawConstants->Unmap();
+
+				pipeline->SetConstantBuffer(materialBuffer);
+				pipeline->SetConstantBuffer(shader->GetPerObjectBuffer());
+				pipeline->SetConstantBuffer(drawConstants, firstConstant);
+				pipeline->SetConstantBuffer(m_gbufferFrameBuffer);
+				if (clustered)
+				{
+					pipeline->SetIndexBuffer(m_gpuCulling->GetCompactedIndexBuffer());
+				}
+				pipeline->Bind();
 
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Albedo).ptr_raw);
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Roughness).ptr_raw);
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Metallic).ptr_raw);
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Normal).ptr_raw);
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Height).ptr_raw);
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Occlusion).ptr_raw);
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Emission).ptr_raw);
-				m_rhiPipeline->SetTexture(material->GetTextureSlotByType(TextureType_Mask).ptr_raw);
+				m_rhiDevice->DrawIndexedInstancedIndirect(m_gpuCulling->GetArgumentBuffer()->GetBuffer(), clustered ? m_gpuCulling->GetClusterArgumentsOffset(draw) : m_gpuCulling->GetArgumentsOffset(draw, lod));
 
-				currentlyBoundMaterial = material->Resource_GetID();
+				if (clustered)
+				{
+					pipeline->SetIndexBuffer(model->GetIndexBuffer());
+				}
 			}
+		}
 
-			// UPDATE PER OBJECT BUFFER
-			shader->UpdatePerObjectBuffer(
-				actor->GetTransform_PtrRaw()->GetWorldTransform(),
-				m_mV, 
-				m_mP_perspective
-			);
-		
-			m_rhiPipeline->SetConstantBuffer(shader->GetMaterialBuffer());
-			m_rhiPipeline->SetConstantBuffer(shader->GetPerObjectBuffer());
+		void* nulls[2] = { nullptr, nullptr };
+		m_rhiDevice->Set_VertexTextures(8, 2, nulls);
+	}
 
-			m_rhiPipeline->Bind();
+	bool Renderer::Pass_GBuffer_Indirect_IsSupported()
+	{
+		return m_shaderGBufferIndirect->HasVertexShader() && m_shaderCulling_Reset->HasComputeShader() && m_shaderCulling_Cull->HasComputeShader();
+	}
 
-			// Render	
-			m_rhiDevice->DrawIndexed(renderable->Geometry_IndexCount(), renderable->Geometry_IndexOffset(), renderable->Geometry_VertexOffset());
-			Profiler::Get().m_rendererMeshesRendered++;
+	void Renderer::Pass_Skinning()
+	{
+		// Whatever isn't posed this frame draws its bind pose
+		m_gpuSkinning->Clear();
+		if (!Pass_Skinning_IsSupported())
+			return;
 
-		} // Actor/MESH ITERATION
+		// The opaque list is sorted by model, so instances of a model end up in one dispatch
+		for (const auto& actor : m_actors[Renderable_ObjectOpaque])
+		{
+			Renderable* renderable = actor->GetRenderable_PtrRaw();
+			if (renderable && renderable->Geometry_IsSkinned())
+			{
+				const BoundingBox& box = renderable->Geometry_BB();
+				m_gpuSkinning->Instance_Add(actor, renderable, Renderables_GetScreenSize(box), !m_camera || m_camera->IsInViewFrustrum(box.GetCenter(), box.GetExtents()));
+			}
+		}
+
+		if (m_gpuSkinning->GetActors().empty())
+			return;
+
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Animations keep playing, so the frame after this one has something new to show
+		RenderOnDemand_Request();
+
+		if (!m_gpuSkinning->Upload((float)m_context->GetSubsystem<Timer>()->GetDeltaTimeSec()))
+		{
+			m_gpuSkinning->Clear();
+			return;
+		}
+
+		m_rhiDevice->EventBegin("Pass_Skinning");
+
+		void* views[1] = { m_gpuSkinning->GetVertexBuffer()->GetUnorderedAccessView() };
+		m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 1, views);
+		m_rhiDevice->Set_ComputeShader(m_shaderSkinning->GetComputeShaderBuffer());
+		for (const auto& batch : m_gpuSkinning->GetBatches())
+		{
+			auto buffer = Struct_Skinning(batch.instanceOffset);
+			m_shaderSkinning->UpdateBuffer(&buffer);
+
+			void* constantBuffer	= m_shaderSkinning->GetConstantBuffer()->GetBuffer();
+			void* textures[4]		=
+			{
+				batch.model->Skin_GetVertexBuffer()->GetShaderResource(),
+				batch.model->Skin_GetWeightBuffer()->GetShaderResource(),
+				m_gpuSkinning->GetPaletteBuffer()->GetShaderResource(),
+				m_gpuSkinning->GetInstanceBuffer()->GetShaderResource()
+			};
+			m_rhiDevice->Set_ConstantBuffers(0, 1, Buffer_ComputeShader, &constantBuffer);
+			m_rhiDevice->Set_ComputeTextures(0, 4, textures);
+			m_rhiDevice->Dispatch((batch.vertexCountMax + GPU_SKINNING_THREAD_GROUP_SIZE - 1) / GPU_SKINNING_THREAD_GROUP_SIZE, batch.instanceCount);
+		}
+
+		// The vertex buffer gets drawn from next
+		void* nulls[4] = { nullptr };
+		m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 1, nulls);
+		m_rhiDevice->Set_ComputeTextures(0, 4, nulls);
+		m_rhiDevice->Set_ComputeShader(nullptr);
 
 		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
+	}
+
+	void Renderer::Skinning_Play(Actor* actor, unsigned int animation, float fadeSeconds)
+	{
+		m_gpuSkinning->Character_Play(actor, animation, fadeSeconds);
+	}
+
+	void Renderer::Skinning_SetLod(unsigned int level, float screenSize, unsigned int updateInterval, bool leafBones)
+	{
+		m_gpuSkinning->Lod_Set(level, SkinningLod{ screenSize, updateInterval, leafBones });
+	}
+
+	bool Renderer::Pass_Skinning_IsSupported()
+	{
+		return m_shaderSkinning && m_shaderSkinning->HasComputeShader();
+	}
+
+	void Renderer::Pass_DepthPyramid(shared_ptr<RHI_RenderTexture>& texDepth)
+	{
+		bool occlusionCulling = RenderFlags_IsSet(Render_OcclusionCulling);
+		if (!occlusionCulling && !RenderFlags_IsSet(Render_SSR))
+			return;
+
+		TIME_BLOCK_SCOPED_MULTI();
+
+		m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
+		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetCullMode(Cull_Back);
+
+		// Each level keeps the farthest and the closest depth of the four (or more, for odd sizes) texels below it,
+		// the first one reads the G-Buffer's depth, which only has one of them
+		auto source = texDepth;
+		for (const auto& level : m_occlusionCulling->GetLevels())
+		{
+			auto& shader = source == texDepth ? m_shaderDownsampleDepthFirst : m_shaderDownsampleDepth;
+			m_rhiPipeline->SetShader(shader);
+			m_rhiPipeline->SetRenderTarget(level);
+			m_rhiPipeline->SetViewport(level->GetViewport());
+			m_rhiPipeline->SetTexture(source);
+			auto buffer = Struct_Matrix_Vector2(m_wvp_baseOrthographic, Vector2((float)source->GetWidth(), (float)source->GetHeight()));
+			shader->UpdateBuffer(&buffer);
+			m_rhiPipeline->SetConstantBuffer(shader->GetConstantBuffer());
+			m_rhiPipeline->Bind();
+
+			m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+			source = level;
+		}
+
+		if (!occlusionCulling)
+			return;
+
+		// The result is read back a few frames later, the view projection it was rendered with goes along
+		m_occlusionCulling->Readback_Request(m_wvp_perspective, m_farPlane);
+		m_gpuCulling->Occluder_Set(m_wvp_perspective, m_farPlane);
 	}
 
 	void Renderer::Pass_PreLight(
@@ -739,145 +3013,323 @@ namespace Directus
 		shared_ptr<RHI_RenderTexture>& texOut
 	)
 	{
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_PreLight");
+		TIME_BLOCK_SCOPED_MULTI();
 
-		m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
-		m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
+		// Like the G-Buffer, only the sub-rect of the dynamic resolution is shaded
+		m_rhiPipeline->SetIndexBuffer(m_quadScaled->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quadScaled->GetVertexBuffer());
 		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
 		m_rhiPipeline->SetCullMode(Cull_Back);
 		
 		// Shadow mapping + SSAO
 		Pass_Shadowing(GetLightDirectional(), texOut);
 
-		// Blur the shadows and the SSAO
-		Pass_Blur(texOut, texIn);
-
-		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
+		// Blur the shadows and the SSAO up to full resolution
+		Pass_UpsampleBilateral(texOut, texIn);
 	}
 
-	void Renderer::Pass_Light(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	void Renderer::Pass_Light(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut, bool checkerboard /*= false*/)
 	{
-		if (m_shaderLight->GetState() != Shader_Built)
+		auto& shader = checkerboard ? m_shaderLightCheckerboard : m_shaderLight;
+		if (shader->GetState() != Shader_Built)
 			return;
 
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_Light");
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Bin point and spot lights into clusters
+		m_lightClusters->Build(m_actors[Renderable_Light], m_camera, m_mV, m_mP_perspective, m_shadowAtlas.get());
 
 		// Update constant buffer
-		m_shaderLight->UpdateConstantBuffer(
+		shader->UpdateConstantBuffer(
 			Matrix::Identity,
-			m_mV,
+			m_mVP_inverseScaled,
 			m_mV_base,
-			m_mP_perspective,
 			m_mP_orthographic,
 			m_actors[Renderable_Light],
-			m_camera
+			m_lightClusters.get(),
+			m_camera,
+			GetSkybox(),
+			GetLightProbeVolume(),
+			m_dynamicResolutionScale,
+			(unsigned int)(m_frame & 1)
 		);
 
-		m_rhiPipeline->SetRenderTarget(texOut);
-		m_rhiPipeline->SetViewport(texOut->GetViewport());
-		m_rhiPipeline->SetShader(shared_ptr<RHI_Shader>(m_shaderLight));
-		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Albedo));
+		m_rhiPipeline->SetIndexBuffer(m_quadScaled->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quadScaled->GetVertexBuffer());
+		m_rhiPipeline->SetRenderTarget(texOut);
+		m_rhiPipeline->SetViewport(DynamicResolution_GetViewport(texOut));
+		m_rhiPipeline->SetShader(shared_ptr<RHI_Shader>(shader));
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Albedo));
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Normal));
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Depth));
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Specular));
+		m_rhiPipeline->SetTexture(texIn);
+		m_rhiPipeline->SetTexture(m_viewRendering == -1 && m_ssrHistoryScale != 0.0f ? m_renderTexSSR : shared_ptr<RHI_RenderTexture>());
+		m_rhiPipeline->SetTexture(GetSkybox() ? GetSkybox()->GetTexture() : nullptr);
+		m_rhiPipeline->SetTexture(GetSkybox() ? GetSkybox()->GetEnvironmentTexture() : nullptr);
+		m_rhiPipeline->SetStructuredBuffer(m_lightClusters->GetLightBuffer());
+		m_rhiPipeline->SetStructuredBuffer(m_lightClusters->GetGridBuffer());
+		m_rhiPipeline->SetStructuredBuffer(m_lightClusters->GetIndexBuffer());
+		m_rhiPipeline->SetStructuredBuffer(m_shadowAtlas->GetTileBuffer());
+		m_rhiPipeline->SetTexture(m_shadowAtlas->GetAtlas());
+		m_rhiPipeline->SetStructuredBuffer(GetLightProbeVolume() ? GetLightProbeVolume()->GetBuffer() : nullptr);
+		m_rhiPipeline->SetStructuredBuffer(m_reflectionProbes->GetBuffer());
+		m_rhiPipeline->SetShaderResource(m_reflectionProbes->GetArray());
+		m_rhiPipeline->SetSampler(m_samplerLinearClampAlways);	
+		m_rhiPipeline->SetConstantBuffer(shader->GetConstantBuffer());
+		m_rhiPipeline->Bind();
+
+		m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
+	}
+
+	void Renderer::Pass_CheckerboardResolve(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	{
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Last frame's output becomes this frame's history, it lit the pixels that were skipped this frame.
+		// It's only usable at the same scale, as it covers the same sub-rect.
+		m_renderTexCheckerboard.swap(m_renderTexCheckerboardPrevious);
+		bool historyValid = m_checkerboardHistoryScale == m_dynamicResolutionScale;
+
+		// Stays in the rendered sub-rect, the output is also kept as the next frame's history
+		m_rhiPipeline->SetIndexBuffer(m_quadScaled->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quadScaled->GetVertexBuffer());
+		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetFillMode(Fill_Solid);
+		m_rhiPipeline->SetCullMode(Cull_Back);
+		m_rhiPipeline->SetRenderTargets({ texOut->GetRenderTargetView(), m_renderTexCheckerboard->GetRenderTargetView() });
+		m_rhiPipeline->SetViewport(DynamicResolution_GetViewport(texOut));
+		m_rhiPipeline->SetShader(m_shaderCheckerboardResolve);
+		m_rhiPipeline->SetTexture(texIn);
+		m_rhiPipeline->SetTexture(m_renderTexCheckerboardPrevious);
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Velocity));
+		m_rhiPipeline->SetSampler(m_samplerPointClampAlways);
+		m_rhiPipeline->SetSampler(m_samplerBilinearClampAlways);
+		auto buffer = Struct_Checkerboard(m_wvp_baseOrthographic, Vector2(texOut->GetWidth(), texOut->GetHeight()), m_dynamicResolutionScale, historyValid, (unsigned int)(m_frame & 1));
+		m_shaderCheckerboardResolve->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderCheckerboardResolve->GetConstantBuffer());
+		m_rhiPipeline->Bind();
+
+		m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
+		m_checkerboardHistoryScale = m_dynamicResolutionScale;
+	}
+
+	void Renderer::Pass_ScreenSpaceReflections(shared_ptr<RHI_RenderTexture>& texTrace)
+	{
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Reflect what the last frame ended up looking like, before post-processing when TAA kept that around
+		bool history		= RenderFlags_IsSet(Render_TAA) && m_taaHistoryValid;
+		auto& texSource		= history ? m_renderTexHistory : m_renderTexFrame;
+		bool sourceGamma	= !history && RenderFlags_IsSet(Render_Correction);
+		const auto& levels	= m_occlusionCulling->GetLevels();
+		auto levelCount		= Min((unsigned int)levels.size(), (unsigned int)SSR_LEVELS_MAX);
+
+		// The trace covers half of the rendered sub-rect
+		m_rhiPipeline->SetIndexBuffer(m_quadScaled->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quadScaled->GetVertexBuffer());
+		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetFillMode(Fill_Solid);
+		m_rhiPipeline->SetCullMode(Cull_Back);
+		m_rhiPipeline->SetRenderTarget(texTrace);
+		m_rhiPipeline->SetViewport(DynamicResolution_GetViewport(texTrace));
+		m_rhiPipeline->SetShader(m_shaderSSR_Trace);
 		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Normal));
 		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Depth));
 		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Specular));
-		m_rhiPipeline->SetTexture(texIn);
-		m_rhiPipeline->SetTexture(m_renderTex3); // previous frame for SSR // Todo SSR
-		m_rhiPipeline->SetTexture(GetSkybox() ? GetSkybox()->GetTexture() : nullptr);
-		m_rhiPipeline->SetSampler(m_samplerLinearClampAlways);	
-		m_rhiPipeline->SetConstantBuffer(m_shaderLight->GetConstantBuffer());
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Velocity));
+		m_rhiPipeline->SetTexture(texSource);
+		for (unsigned int i = 0; i < SSR_LEVELS_MAX; i++)
+		{
+			m_rhiPipeline->SetTexture(i < levelCount ? levels[i] : shared_ptr<RHI_RenderTexture>());
+		}
+		m_rhiPipeline->SetSampler(m_samplerPointClampAlways);
+		m_rhiPipeline->SetSampler(m_samplerBilinearClampAlways);
+		auto buffer = Struct_ScreenSpaceReflections
+		(
+			m_wvp_baseOrthographic,
+			m_wvp_perspective,
+			m_mVP_inverseScaled,
+			Camera_GetPosition(),
+			Vector2((float)m_gbuffer->GetTexture(GBuffer_Target_Depth)->GetWidth(), (float)m_gbuffer->GetTexture(GBuffer_Target_Depth)->GetHeight()),
+			m_dynamicResolutionScale,
+			m_farPlane,
+			levelCount,
+			SSR_RAYS_MAX,
+			SSR_STEPS,
+			SSR_ROUGHNESS_MAX,
+			SSR_THICKNESS,
+			(unsigned int)m_frame,
+			sourceGamma,
+			false
+		);
+		m_shaderSSR_Trace->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderSSR_Trace->GetConstantBuffer());
 		m_rhiPipeline->Bind();
 
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
-
-		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
+		m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
 	}
 
-	void Renderer::Pass_PostLight(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	void Renderer::Pass_ScreenSpaceReflections_Resolve(shared_ptr<RHI_RenderTexture>& texTrace)
 	{
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_PostLight");
+		TIME_BLOCK_SCOPED_MULTI();
 
-		// All post-process passes share the following, so set them once here
-		m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
-		m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+		// Like the checkerboard's, the history is only usable at the same scale
+		m_renderTexSSR.swap(m_renderTexSSRPrevious);
+		bool historyValid = m_ssrHistoryScale == m_dynamicResolutionScale;
+
+		m_rhiPipeline->SetIndexBuffer(m_quadScaled->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quadScaled->GetVertexBuffer());
 		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetFillMode(Fill_Solid);
 		m_rhiPipeline->SetCullMode(Cull_Back);
-		m_rhiPipeline->SetSampler(m_samplerBilinearClampAlways); // FXAA and Bloom (Gaussian blur) require a bilinear sampler
-		m_rhiPipeline->SetVertexShader(m_shaderBloom_Bright);  // vertex shader is the same for every pass
-		Vector2 computeLuma = Vector2(RenderFlags_IsSet(Render_FXAA) ? 1.0f : 0.0f, 0.0f);
-		auto buffer = Struct_Matrix_Vector2(m_wvp_baseOrthographic, Vector2(texIn->GetWidth(), texIn->GetHeight()), computeLuma);
-		m_shaderBloom_Bright->UpdateBuffer(&buffer);
-		m_rhiPipeline->SetConstantBuffer(m_shaderBloom_Bright->GetConstantBuffer());
-		
-		// Keep track of render target swapping
-		auto SwapTargets = [&texIn, &texOut]() { texOut.swap(texIn); };
+		m_rhiPipeline->SetRenderTarget(m_renderTexSSR);
+		m_rhiPipeline->SetViewport(DynamicResolution_GetViewport(m_renderTexSSR));
+		m_rhiPipeline->SetShader(m_shaderSSR_Resolve);
+		m_rhiPipeline->SetTexture(texTrace);
+		m_rhiPipeline->SetTexture(m_renderTexSSRPrevious);
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Velocity));
+		m_rhiPipeline->SetSampler(m_samplerPointClampAlways);
+		m_rhiPipeline->SetSampler(m_samplerBilinearClampAlways);
+		auto buffer = Struct_ScreenSpaceReflections
+		(
+			m_wvp_baseOrthographic,
+			m_wvp_perspective,
+			m_mVP_inverseScaled,
+			Camera_GetPosition(),
+			Vector2((float)m_gbuffer->GetTexture(GBuffer_Target_Depth)->GetWidth(), (float)m_gbuffer->GetTexture(GBuffer_Target_Depth)->GetHeight()),
+			m_dynamicResolutionScale,
+			m_farPlane,
+			0,
+			SSR_RAYS_MAX,
+			SSR_STEPS,
+			SSR_ROUGHNESS_MAX,
+			SSR_THICKNESS,
+			(unsigned int)m_frame,
+			false,
+			historyValid
+		);
+		m_shaderSSR_Resolve->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderSSR_Resolve->GetConstantBuffer());
+		m_rhiPipeline->Bind();
 
-		SwapTargets();
+		m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
+		m_ssrHistoryScale = m_dynamicResolutionScale;
+	}
 
-		// BLOOM
-		if (RenderFlags_IsSet(Render_Bloom))
-		{
-			SwapTargets();
-			Pass_Bloom(texIn, texOut);
-		}
+	bool Renderer::Pass_ScreenSpaceReflections_IsSupported()
+	{
+		return m_shaderSSR_Trace->GetState() == Shader_Built && m_shaderSSR_Resolve->GetState() == Shader_Built && m_shaderDownsampleDepthFirst->GetState() == Shader_Built;
+	}
 
-		// CORRECTION
-		if (RenderFlags_IsSet(Render_Correction))
-		{
-			SwapTargets();
-			Pass_Correction(texIn, texOut);
-		}
+	bool Renderer::Pass_Checkerboard_IsSupported()
+	{
+		return m_shaderLightCheckerboard->GetState() == Shader_Built && m_shaderCheckerboardResolve->GetState() == Shader_Built;
+	}
+
+	void Renderer::Pass_PostLight(RenderGraph_Resource texIn, RenderGraph_Resource texOut)
+	{
+		auto& graph		= *m_renderGraph;
+		auto width		= (unsigned int)Settings::Get().Resolution_GetWidth();
+		auto height		= (unsigned int)Settings::Get().Resolution_GetHeight();
 
-		// FXAA
-		if (RenderFlags_IsSet(Render_FXAA))
+		// All post-process passes share the same state
+		graph.Pass_Add("Pass_PostLight", { texIn }, {}, [this, texIn]() { Pass_PostLight_Setup(m_renderGraph->Resource_Get(texIn)); });
+
+		// Collect the enabled passes, the last one writes to texOut and the rest ping-pong via transient textures.
+		// Correction, chromatic aberration and sharpening fuse into one pass, only FXAA (in between them) splits them up.
+		FrameVector<unsigned long> passes(m_context->GetFrameAllocatorSTL<unsigned long>());
+		auto Fuse = [&passes](unsigned long flag)
 		{
-			SwapTargets();
-			Pass_FXAA(texIn, texOut);
-		}
+			if (!RenderFlags_IsSet((RenderMode)flag))
+				return;
 
-		// CHROMATIC ABERRATION
-		if (RenderFlags_IsSet(Render_ChromaticAberration))
+			if (passes.empty() || passes.back() == Render_FXAA)
+			{
+				passes.emplace_back(0);
+			}
+			passes.back() |= flag;
+		};
+		Fuse(Render_Correction);
+		if (RenderFlags_IsSet(Render_FXAA)) passes.emplace_back(Render_FXAA);
+		Fuse(Render_ChromaticAberration);
+		Fuse(Render_Sharpening);
+
+		auto current = texIn;
+		auto NextTarget = [&](bool last) { return last ? texOut : graph.Resource_CreateTransient("PostLight", width, height, Texture_Format_R16G16B16A16_FLOAT); };
+
+		// BLOOM (the mip chain is the renderer's own, only the composited output is the graph's)
+		if (RenderFlags_IsSet(Render_Bloom) && Pass_Bloom_IsSupported())
 		{
-			SwapTargets();
-			Pass_ChromaticAberration(texIn, texOut);
+			auto output	= NextTarget(passes.empty());
+			graph.Pass_Add("Pass_Bloom", { current }, { output }, [this, current, output]()
+			{
+				Pass_Bloom(m_renderGraph->Resource_Get(current), m_renderGraph->Resource_Get(output));
+			});
+			current = output;
 		}
 
-		// SHARPENING
-		if (RenderFlags_IsSet(Render_Sharpening))
+		// CORRECTION, FXAA, CHROMATIC ABERRATION, SHARPENING
+		for (unsigned int i = 0; i < (unsigned int)passes.size(); i++)
 		{
-			SwapTargets();
-			Pass_Sharpening(texIn, texOut);
+			auto output	= NextTarget(i == passes.size() - 1);
+			auto flags	= passes[i];
+			graph.Pass_Add(flags == Render_FXAA ? "Pass_FXAA" : "Pass_PostFused", { current }, { output }, [this, flags, current, output]()
+			{
+				if (flags == Render_FXAA)
+				{
+					Pass_FXAA(m_renderGraph->Resource_Get(current), m_renderGraph->Resource_Get(output));
+				}
+				else
+				{
+					Pass_PostFused(m_renderGraph->Resource_Get(current), m_renderGraph->Resource_Get(output), flags);
+				}
+			});
+			current = output;
 		}
-
-		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
 	}
 
-	void Renderer::Pass_Transparent(shared_ptr<RHI_RenderTexture>& texOut)
+	void Renderer::Pass_PostLight_Setup(shared_ptr<RHI_RenderTexture>& texIn)
 	{
-		if (!GetLightDirectional())
-			return;
+		m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
+		m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetCullMode(Cull_Back);
+		m_rhiPipeline->SetSampler(m_samplerBilinearClampAlways); // FXAA and the bloom blend require a bilinear sampler
+		m_rhiPipeline->SetVertexShader(m_shaderFXAA);  // vertex shader is the same for every pass
+		Vector2 computeLuma = Vector2(RenderFlags_IsSet(Render_FXAA) ? 1.0f : 0.0f, 0.0f);
+		auto buffer = Struct_Matrix_Vector2(m_wvp_baseOrthographic, Vector2(texIn->GetWidth(), texIn->GetHeight()), computeLuma);
+		m_shaderFXAA->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderFXAA->GetConstantBuffer());
+	}
 
-		auto& actors_transparent = m_actors[Renderable_ObjectTransparent];
-		if (actors_transparent.empty())
+	void Renderer::Pass_Transparent(shared_ptr<RHI_RenderTexture>& texOut, shared_ptr<RHI_RenderTexture>& texDepth, shared_ptr<RHI_RenderTexture>& texAccumulation, shared_ptr<RHI_RenderTexture>& texRevealage)
+	{
+		// Particles are simulated against the main camera's depth, other views don't draw them
+		bool particles = m_viewRendering == -1 && Pass_Particles_Simulate(texDepth);
+
+		// Surfaces need the directional light, particles do without
+		Light* directionalLight		= GetLightDirectional();
+		auto& actors_transparent	= m_actors[Renderable_ObjectTransparent];
+		bool surfaces				= directionalLight && !actors_transparent.empty();
+		if (!surfaces && !particles)
 			return;
 
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_Transparent");
+		TIME_BLOCK_SCOPED_MULTI();
 
-		m_rhiDevice->Set_AlphaBlendingEnabled(true);
-		m_rhiPipeline->SetShader(m_shaderTransparent);
-		m_rhiPipeline->SetRenderTarget(texOut, m_gbuffer->GetTexture(GBuffer_Target_Depth)->GetDepthStencilView());
-		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Depth));
-		m_rhiPipeline->SetTexture(GetSkybox() ? GetSkybox()->GetTexture() : nullptr);
-		m_rhiPipeline->SetSampler(m_samplerLinearClampGreater);
+		// Accumulate, in any order
+		texAccumulation->Clear(0.0f, 0.0f, 0.0f, 0.0f);
+		texRevealage->Clear(1.0f, 1.0f, 1.0f, 1.0f);
+		m_rhiPipeline->SetState(*m_pipelineTransparent);
+		// An upscaled depth has no depth-stencil view, the shader's depth test is enough then
+		m_rhiPipeline->SetRenderTargets({ texAccumulation->GetRenderTargetView(), texRevealage->GetRenderTargetView() }, texDepth->GetDepthStencilView());
+		m_rhiPipeline->SetViewport(texAccumulation->GetViewport());
 
 		for (auto& actor : actors_transparent)
 		{
+			if (!surfaces)
+				break;
+
 			// Get renderable and material
 			Renderable* renderable	= actor->GetRenderable_PtrRaw();
 			Material* material		= renderable ? renderable->Material_Ptr().get() : nullptr;
@@ -891,7 +3343,7 @@ namespace Directus
 				continue;
 
 			// Skip objects outside of the view frustum
-			if (!m_camera->IsInViewFrustrum(renderable))
+			if (!Renderables_IsVisible(actor))
 				continue;
 
 			// Set the following per object
@@ -901,17 +3353,22 @@ namespace Directus
 
 			// Constant buffer
 			auto buffer = Struct_Transparency(
-				actor->GetTransform_PtrRaw()->GetWorldTransform(),
+				Renderables_GetWorld(actor),
 				m_mV,
 				m_mP_perspective,
 				material->GetColorAlbedo(),
-				m_camera->GetTransform()->GetPosition(),
-				GetLightDirectional()->GetDirection(),
-				material->GetRoughnessMultiplier()
+				Camera_GetPosition(),
+				directionalLight->GetDirection(),
+				material->GetRoughnessMultiplier(),
+				m_camera->IsReverseZ()
 			);
 			m_shaderTransparent->UpdateBuffer(&buffer);
 			m_rhiPipeline->SetConstantBuffer(m_shaderTransparent->GetConstantBuffer());
 
+			// Set once a surface is known to be drawn, the particles bind their own
+			m_rhiPipeline->SetTexture(texDepth);
+			m_rhiPipeline->SetTexture(GetSkybox() ? GetSkybox()->GetTexture() : nullptr);
+
 			m_rhiPipeline->Bind();
 
 			// Render	
@@ -920,131 +3377,248 @@ namespace Directus
 
 		} // Actor/MESH ITERATION
 
-		m_rhiDevice->Set_AlphaBlendingEnabled(false);
+		if (particles)
+		{
+			Pass_Particles_Draw(texDepth, directionalLight);
+		}
 
-		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
+		// Composite over the opaque frame
+		m_rhiPipeline->SetBlendMode(Blend_Alpha);
+		m_rhiPipeline->SetDepthWrite(true);
+		m_rhiPipeline->SetRenderTarget(texOut);
+		m_rhiPipeline->SetViewport(texOut->GetViewport());
+		m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
+		m_rhiPipeline->SetCullMode(Cull_Back);
+		m_rhiPipeline->SetShader(m_shaderCompositeOIT);
+		m_rhiPipeline->SetTexture(texAccumulation);
+		m_rhiPipeline->SetTexture(texRevealage);
+		m_rhiPipeline->SetSampler(m_samplerPointClampAlways);
+		auto buffer = Struct_Matrix_Vector2(m_wvp_baseOrthographic, Vector2(texOut->GetWidth(), texOut->GetHeight()));
+		m_shaderCompositeOIT->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderCompositeOIT->GetConstantBuffer());
+		m_rhiPipeline->Bind();
+		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+
+		m_rhiPipeline->SetBlendMode(Blend_Disabled);
 	}
 
-	void Renderer::Pass_Bloom(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	bool Renderer::Pass_Particles_Simulate(shared_ptr<RHI_RenderTexture>& texDepth)
 	{
-		m_rhiDevice->EventBegin("Pass_Bloom");
+		// Emitters that aren't added this frame lose their particles
+		m_gpuParticles->Clear();
+		if (!Pass_Particles_IsSupported() || !m_camera)
+			return false;
 
-		// Bright pass
-		m_rhiPipeline->SetRenderTarget(m_renderTexQuarterRes1);
-		m_rhiPipeline->SetViewport(m_renderTexQuarterRes1->GetViewport());
-		m_rhiPipeline->SetPixelShader(m_shaderBloom_Bright);
-		m_rhiPipeline->SetTexture(texIn);
-		m_rhiPipeline->Bind();
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+		float deltaTime = (float)m_context->GetSubsystem<Timer>()->GetDeltaTimeSec();
+		for (const auto& actor : m_actors[Renderable_ParticleEmitter])
+		{
+			if (auto emitter = actor->GetComponent_PtrRaw<ParticleEmitter>())
+			{
+				m_gpuParticles->Emitter_Add(emitter, Renderables_GetWorld(actor), deltaTime);
+			}
+		}
 
-		// Horizontal Gaussian blur
-		m_rhiPipeline->SetRenderTarget(m_renderTexQuarterRes2);
-		m_rhiPipeline->SetPixelShader(m_shaderBlurGaussianH);
-		m_rhiPipeline->SetTexture(m_renderTexQuarterRes1);
-		m_rhiPipeline->Bind();
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+		if (!m_gpuParticles->Upload(m_mV * m_mP_perspective, m_camera->GetFarPlane(), m_dynamicResolutionScale))
+			return false;
 
-		// Vertical Gaussian blur
-		m_rhiPipeline->SetRenderTarget(m_renderTexQuarterRes1);
-		m_rhiPipeline->SetPixelShader(m_shaderBlurGaussianV);
-		m_rhiPipeline->SetTexture(m_renderTexQuarterRes2);
-		m_rhiPipeline->Bind();
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+		TIME_BLOCK_SCOPED_MULTI();
 
-		// Additive blending
-		m_rhiPipeline->SetRenderTarget(texOut);
-		m_rhiPipeline->SetViewport(texOut->GetViewport());
-		m_rhiPipeline->SetPixelShader(m_shaderBloom_BlurBlend);
-		m_rhiPipeline->SetTexture(texIn);
-		m_rhiPipeline->SetTexture(m_renderTexQuarterRes1);
-		float bloomIntensity = 0.2f;
-		auto buffer = Struct_Matrix_Vector2(m_wvp_baseOrthographic, Vector2(texIn->GetWidth(), texIn->GetHeight()), bloomIntensity);
-		m_shaderBloom_BlurBlend->UpdateBuffer(&buffer);
-		m_rhiPipeline->SetConstantBuffer(m_shaderBloom_BlurBlend->GetConstantBuffer());
-		m_rhiPipeline->Bind();
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+		// Particles keep moving, so the frame after this one has something new to show
+		RenderOnDemand_Request();
+
+		m_rhiDevice->EventBegin("Pass_Particles_Simulate");
+
+		void* views[3] =
+		{
+			m_gpuParticles->GetParticleBuffer()->GetUnorderedAccessView(),
+			m_gpuParticles->GetAliveBuffer()->GetUnorderedAccessView(),
+			m_gpuParticles->GetArgumentBuffer()->GetUnorderedAccessView()
+		};
+		m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 3, views);
+
+		// No instances, until the simulation lists the ones alive
+		m_rhiDevice->Set_ComputeShader(m_shaderParticles_Reset->GetComputeShaderBuffer());
+		m_rhiDevice->Dispatch(1, 1);
+
+		void* textures[2] = { texDepth->GetShaderResource(), m_gbuffer->GetTexture(GBuffer_Target_Normal)->GetShaderResource() };
+		m_rhiDevice->Set_ComputeTextures(0, 2, textures);
+		m_rhiDevice->Set_ComputeShader(m_shaderParticles_Simulate->GetComputeShaderBuffer());
+		for (auto simulation : m_gpuParticles->GetSimulations())
+		{
+			m_shaderParticles_Simulate->UpdateBuffer(&simulation);
+			void* constantBuffer = m_shaderParticles_Simulate->GetConstantBuffer()->GetBuffer();
+			m_rhiDevice->Set_ConstantBuffers(0, 1, Buffer_ComputeShader, &constantBuffer);
+			m_rhiDevice->Dispatch((simulation.rangeSize + GPU_PARTICLES_THREAD_GROUP_SIZE - 1) / GPU_PARTICLES_THREAD_GROUP_SIZE, 1);
+		}
+
+		// The buffers get drawn from next
+		void* nulls[3] = { nullptr, nullptr, nullptr };
+		m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 3, nulls);
+		m_rhiDevice->Set_ComputeTextures(0, 2, nulls);
+		m_rhiDevice->Set_ComputeShader(nullptr);
+
+		// The depth was bound to the compute shader, which unbound it from the pixel shader behind the pipeline's back
+		m_rhiPipeline->InvalidateTextures();
 
 		m_rhiDevice->EventEnd();
+		return true;
 	}
 
-	void Renderer::Pass_Correction(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	void Renderer::Pass_Particles_Draw(shared_ptr<RHI_RenderTexture>& texDepth, Light* directionalLight)
 	{
-		m_rhiDevice->EventBegin("Pass_Correction");
-
-		m_rhiPipeline->SetRenderTarget(texOut);
-		m_rhiPipeline->SetViewport(texOut->GetViewport());
-		m_rhiPipeline->SetPixelShader(m_shaderCorrection);
-		m_rhiPipeline->SetTexture(texIn);
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// A fake ambient, like the light pass' one
+		Vector4 color		= directionalLight ? directionalLight->GetColor() : Vector4::Zero;
+		float intensity		= directionalLight ? directionalLight->GetIntensity() : 0.0f;
+		float ambient		= Clamp(intensity, 0.01f, 1.0f) * 0.1f;
+		auto buffer			= Struct_Particles(m_mV, m_mV * m_mP_perspective, Vector3(color.x, color.y, color.z) * intensity, ambient, m_lightClusters->GetSliceScale(), m_camera->GetNearPlane(), m_camera->GetFarPlane(), m_camera->IsReverseZ());
+		m_shaderParticles->UpdateBuffer(&buffer);
+
+		// The render targets are the ones the transparent surfaces accumulated into
+		m_rhiPipeline->SetState(*m_pipelineParticles);
+		m_rhiPipeline->SetIndexBuffer(m_gpuParticles->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_gpuParticles->GetVertexBuffer());
+		m_rhiPipeline->SetTexture(texDepth);
+
+		void* vertexResources[6] =
+		{
+			m_gpuParticles->GetParticleBuffer()->GetShaderResource(),
+			m_gpuParticles->GetAliveBuffer()->GetShaderResource(),
+			m_gpuParticles->GetEmitterBuffer()->GetShaderResource(),
+			m_lightClusters->GetLightBuffer()->GetShaderResource(),
+			m_lightClusters->GetGridBuffer()->GetShaderResource(),
+			m_lightClusters->GetIndexBuffer()->GetShaderResource()
+		};
+		m_rhiDevice->Set_VertexTextures(1, 6, vertexResources);
 		m_rhiPipeline->Bind();
 
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+		// The instance count never comes back to the CPU
+		m_rhiDevice->DrawIndexedInstancedIndirect(m_gpuParticles->GetArgumentBuffer()->GetBuffer(), 0);
 
-		m_rhiDevice->EventEnd();
+		void* nulls[6] = { nullptr };
+		m_rhiDevice->Set_VertexTextures(1, 6, nulls);
 	}
 
-	void Renderer::Pass_FXAA(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	bool Renderer::Pass_Particles_IsSupported()
+	{
+		return
+			m_shaderParticles_Reset && m_shaderParticles_Reset->HasComputeShader() &&
+			m_shaderParticles_Simulate && m_shaderParticles_Simulate->HasComputeShader() &&
+			m_shaderParticles && m_shaderParticles->HasVertexShader() &&
+			m_gpuParticles->GetArgumentBuffer() && m_gpuParticles->GetEmitterBuffer();
+	}
+
+	void Renderer::Pass_Bloom(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
 	{
-		m_rhiDevice->EventBegin("Pass_FXAA");
+		TIME_BLOCK_SCOPED_MULTI();
+
+		void* sampler = m_samplerBilinearClampAlways->GetBuffer();
+		m_rhiDevice->Set_ComputeSamplers(0, 1, &sampler);
+
+		// One thread per output texel, the views get unbound after every dispatch so a level can be read right after it was written
+		auto Dispatch = [this](shared_ptr<RHI_Shader>& shader, const shared_ptr<RHI_RenderTexture>& source, const shared_ptr<RHI_RenderTexture>& source2, const shared_ptr<RHI_RenderTexture>& target)
+		{
+			auto buffer = Struct_Bloom(Vector2((float)target->GetWidth(), (float)target->GetHeight()), BLOOM_THRESHOLD);
+			shader->UpdateBuffer(&buffer);
+			void* constantBuffer	= shader->GetConstantBuffer()->GetBuffer();
+			void* textures[2]		= { source->GetShaderResource(), source2 ? source2->GetShaderResource() : nullptr };
+			void* view				= target->GetUnorderedAccessView();
+			m_rhiDevice->Set_ComputeShader(shader->GetComputeShaderBuffer());
+			m_rhiDevice->Set_ConstantBuffers(0, 1, Buffer_ComputeShader, &constantBuffer);
+			m_rhiDevice->Set_ComputeTextures(0, 2, textures);
+			m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 1, &view);
+
+			m_rhiDevice->Dispatch((target->GetWidth() + 7) / 8, (target->GetHeight() + 7) / 8);
+
+			void* nulls[2] = { nullptr, nullptr };
+			m_rhiDevice->Set_ComputeUnorderedAccessViews(0, 1, nulls);
+			m_rhiDevice->Set_ComputeTextures(0, 2, nulls);
+		};
+
+		// Downsample, only keeping what's bright on the way to the first level
+		auto& down	= m_renderTexBloomDownsampled;
+		auto& up	= m_renderTexBloomUpsampled;
+		Dispatch(m_shaderBloom_DownsampleBright, texIn, nullptr, down[0]);
+		for (unsigned int i = 1; i < (unsigned int)down.size(); i++)
+		{
+			Dispatch(m_shaderBloom_Downsample, down[i - 1], nullptr, down[i]);
+		}
+
+		// Upsample, accumulating every level on the way back up
+		for (int i = (int)up.size() - 1; i >= 0; i--)
+		{
+			Dispatch(m_shaderBloom_Upsample, i == (int)up.size() - 1 ? down[i + 1] : up[i + 1], down[i], up[i]);
+		}
+		m_rhiDevice->Set_ComputeShader(nullptr);
+
+		// The chain was bound for writing, which unbound it from the pixel shader behind the pipeline's back
+		m_rhiPipeline->InvalidateTextures();
 
+		// Additive blending, the levels add up so the intensity gets spread across them
 		m_rhiPipeline->SetRenderTarget(texOut);
 		m_rhiPipeline->SetViewport(texOut->GetViewport());
-		m_rhiPipeline->SetPixelShader(m_shaderFXAA);	
+		m_rhiPipeline->SetPixelShader(m_shaderBloom_BlurBlend);
 		m_rhiPipeline->SetTexture(texIn);
+		m_rhiPipeline->SetTexture(up.empty() ? down[0] : up[0]);
+		auto buffer = Struct_Matrix_Vector2(m_wvp_baseOrthographic, Vector2(texIn->GetWidth(), texIn->GetHeight()), Vector2(BLOOM_INTENSITY / BLOOM_MIP_COUNT, 0.0f));
+		m_shaderBloom_BlurBlend->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderBloom_BlurBlend->GetConstantBuffer());
 		m_rhiPipeline->Bind();
-
 		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
 
-		m_rhiDevice->EventEnd();
+		// The passes after this one expect the shared post process buffer
+		m_rhiPipeline->SetConstantBuffer(m_shaderFXAA->GetConstantBuffer());
 	}
 
-	void Renderer::Pass_ChromaticAberration(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	bool Renderer::Pass_Bloom_IsSupported()
 	{
-		m_rhiDevice->EventBegin("Pass_ChromaticAberration");
+		return m_shaderBloom_DownsampleBright->HasComputeShader() && m_shaderBloom_Downsample->HasComputeShader() && m_shaderBloom_Upsample->HasComputeShader();
+	}
+
+	void Renderer::Pass_PostFused(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut, unsigned long flags)
+	{
+		TIME_BLOCK_SCOPED_MULTI();
 
 		m_rhiPipeline->SetRenderTarget(texOut);
 		m_rhiPipeline->SetViewport(texOut->GetViewport());
-		m_rhiPipeline->SetPixelShader(m_shaderChromaticAberration);
+		m_rhiPipeline->SetPixelShader(m_shadersPostFused[flags]);
 		m_rhiPipeline->SetTexture(texIn);
 		m_rhiPipeline->Bind();
 
 		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
-
-		m_rhiDevice->EventEnd();
 	}
 
-	void Renderer::Pass_Sharpening(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	void Renderer::Pass_FXAA(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
 	{
-		m_rhiDevice->EventBegin("Pass_Sharpening");
+		TIME_BLOCK_SCOPED_MULTI();
 
 		m_rhiPipeline->SetRenderTarget(texOut);
 		m_rhiPipeline->SetViewport(texOut->GetViewport());
-		m_rhiPipeline->SetPixelShader(m_shaderSharpening);
+		m_rhiPipeline->SetPixelShader(m_shaderFXAA);	
 		m_rhiPipeline->SetTexture(texIn);
 		m_rhiPipeline->Bind();
 
 		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
-
-		m_rhiDevice->EventEnd();
 	}
 
-	void Renderer::Pass_Blur(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	void Renderer::Pass_UpsampleBilateral(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
 	{
-		m_rhiDevice->EventBegin("Pass_Blur");
+		TIME_BLOCK_SCOPED_MULTI();
 
 		m_rhiPipeline->SetRenderTarget(texOut);
-		m_rhiPipeline->SetViewport(texOut->GetViewport());
-		m_rhiPipeline->SetShader(m_shaderBlurBox);
-		m_rhiPipeline->SetTexture(texIn); // Shadows are in the alpha channel
+		m_rhiPipeline->SetViewport(DynamicResolution_GetViewport(texOut));
+		m_rhiPipeline->SetShader(m_shaderUpsampleBilateral);
+		m_rhiPipeline->SetTexture(texIn); // Shadows in red, SSAO in green
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Depth));
 		m_rhiPipeline->SetSampler(m_samplerLinearClampAlways);
 		auto buffer = Struct_Matrix_Vector2(m_wvp_baseOrthographic, Vector2(texIn->GetWidth(), texIn->GetHeight()));
-		m_shaderBlurBox->UpdateBuffer(&buffer);
-		m_rhiPipeline->SetConstantBuffer(m_shaderBlurBox->GetConstantBuffer());
+		m_shaderUpsampleBilateral->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderUpsampleBilateral->GetConstantBuffer());
 		m_rhiPipeline->Bind();
 
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
-
-		m_rhiDevice->EventEnd();
+		m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
 	}
 
 	void Renderer::Pass_Shadowing(
@@ -1054,12 +3628,11 @@ namespace Directus
 		if (!inDirectionalLight)
 			return;
 
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_Shadowing");
+		TIME_BLOCK_SCOPED_MULTI();
 
 		// SHADOWING (Shadow mapping + SSAO)
 		m_rhiPipeline->SetRenderTarget(texOut);
-		m_rhiPipeline->SetViewport(texOut->GetViewport());
+		m_rhiPipeline->SetViewport(DynamicResolution_GetViewport(texOut));
 		m_rhiPipeline->SetShader(m_shaderShadowing);
 		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Normal));
 		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Depth));
@@ -1075,7 +3648,7 @@ namespace Directus
 		auto buffer = Struct_Shadowing
 			(
 				m_wvp_baseOrthographic,
-				(m_mV * m_mP_perspective).Inverted(),
+				m_mVP_inverseScaled,
 				Vector2(texOut->GetWidth(), texOut->GetHeight()),
 				inDirectionalLight,
 				m_camera
@@ -1084,17 +3657,184 @@ namespace Directus
 		m_rhiPipeline->SetConstantBuffer(m_shaderShadowing->GetConstantBuffer());
 		m_rhiPipeline->Bind();
 
-		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+		m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
+	}
 
-		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
+	void Renderer::Pass_Picking()
+	{
+		Vector2 pixel;
+		{
+			lock_guard<mutex> lock(m_pickMutex);
+			if (!m_pickRequested)
+				return;
+
+			m_pickRequested = false;
+			pixel			= m_pickPixel;
+		}
+
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// At the resolution the G-Buffer renders at, with a depth buffer of its own so it doesn't depend on how the G-Buffer was drawn
+		auto& texId = m_gbuffer->GetTexture(GBuffer_Target_Id);
+		m_rhiPipeline->SetShader(m_shaderPicking);
+		m_rhiPipeline->SetRenderTarget(texId, texId->GetDepthStencilView(), true);
+		m_rhiPipeline->SetViewport(DynamicResolution_GetViewport(texId));
+		m_rhiPipeline->SetFillMode(Fill_Solid);
+		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+
+		// Variables that help reduce state changes
+		unsigned int currentlyBoundGeometry = 0;
+		vector<Matrix> instanceTransforms[MODEL_LODS_MAX];
+
+		// Every actor is a draw of its own, the index is per draw. Masked materials are picked as if they were solid.
+		m_pickActors.clear();
+		for (Actor* actor : m_actors[Renderable_ObjectOpaque])
+		{
+			Renderable* renderable	= actor->GetRenderable_PtrRaw();
+			Material* material		= renderable ? renderable->Material_Ptr().get() : nullptr;
+			Model* model			= renderable ? renderable->Geometry_Model() : nullptr;
+			if (!material || !model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || !Renderables_IsVisible(actor))
+				continue;
+
+			m_pickActors.emplace_back(actor->GetID());
+			auto buffer = Struct_Matrix_Vector4(m_mVP_unjittered, Vector4((float)m_pickActors.size(), 0.0f, 0.0f, 0.0f));
+			m_shaderPicking->UpdateBuffer(&buffer);
+
+			for (auto& transforms : instanceTransforms) { transforms.clear(); }
+			instanceTransforms[Renderables_GetLod(renderable, renderable->Geometry_BB())].emplace_back(Renderables_GetWorld(actor));
+
+			m_rhiPipeline->SetCullMode(material->GetCullMode());
+			unsigned int vertexOffset = Renderables_BindGeometry(m_rhiPipeline, actor, &currentlyBoundGeometry);
+			Instances_DrawLods(m_rhiPipeline, renderable, instanceTransforms, { m_shaderPicking->GetConstantBuffer() }, vertexOffset);
+		}
+		m_rhiPipeline->Bind(); // still clears, when nothing was drawn
+
+		// Only the picked pixel goes back to the CPU
+		auto x = (unsigned int)Clamp(pixel.x * m_dynamicResolutionScale, 0.0f, (float)texId->GetWidth() - 1.0f);
+		auto y = (unsigned int)Clamp(pixel.y * m_dynamicResolutionScale, 0.0f, (float)texId->GetHeight() - 1.0f);
+		auto request = m_readback->Request(texId.get(), [this](unsigned int request, const vector<unsigned char>& data) { Pick_Resolve(request, data); }, x, y, 1, 1);
+		if (request == 0)
+			return;
+
+		lock_guard<mutex> lock(m_pickMutex);
+		if (!m_pickRequested) // unless there is a newer pick already
+		{
+			m_pickReadback = request;
+		}
+	}
+
+	void Renderer::Pass_Upscale(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut, bool depth)
+	{
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// The scaled quad samples the rendered sub-rect, the full viewport stretches it over the whole target
+		m_rhiPipeline->SetIndexBuffer(m_quadScaled->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quadScaled->GetVertexBuffer());
+		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetFillMode(Fill_Solid);
+		m_rhiPipeline->SetCullMode(Cull_Back);
+		m_rhiPipeline->SetRenderTarget(texOut);
+		m_rhiPipeline->SetViewport(texOut->GetViewport());
+		m_rhiPipeline->SetShader(m_shaderTexture);
+		m_rhiPipeline->SetTexture(texIn);
+		m_rhiPipeline->SetSampler(depth ? m_samplerPointClampAlways : m_samplerBilinearClampAlways); // blended depth would float between edges
+		auto buffer = Struct_Matrix(m_wvp_baseOrthographic);
+		m_shaderTexture->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderTexture->GetConstantBuffer());
+		m_rhiPipeline->Bind();
+
+		m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
+	}
+
+	void Renderer::Pass_ReflectionProbe_Downsample(shared_ptr<RHI_RenderTexture>& texIn)
+	{
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Bilinear halves average four texels each, a single step down to the capture's size would skip most of the frame
+		auto& capture = m_reflectionProbes->GetCaptureTexture();
+		shared_ptr<RHI_RenderTexture> source = texIn;
+		vector<shared_ptr<RHI_RenderTexture>> acquired;
+		while (true)
+		{
+			unsigned int width	= Max(source->GetWidth() / 2, capture->GetWidth());
+			unsigned int height	= Max(source->GetHeight() / 2, capture->GetHeight());
+			bool last			= width == capture->GetWidth() && height == capture->GetHeight();
+			auto target			= last ? capture : m_renderTexturePool->Acquire(width, height, Texture_Format_R16G16B16A16_FLOAT);
+			if (!last)
+			{
+				acquired.emplace_back(target);
+			}
+
+			m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+			m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
+			m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+			m_rhiPipeline->SetFillMode(Fill_Solid);
+			m_rhiPipeline->SetCullMode(Cull_Back);
+			m_rhiPipeline->SetRenderTarget(target);
+			m_rhiPipeline->SetViewport(target->GetViewport());
+			m_rhiPipeline->SetShader(m_shaderTexture);
+			m_rhiPipeline->SetTexture(source);
+			m_rhiPipeline->SetSampler(m_samplerBilinearClampAlways);
+			auto buffer = Struct_Matrix(m_wvp_baseOrthographic);
+			m_shaderTexture->UpdateBuffer(&buffer);
+			m_rhiPipeline->SetConstantBuffer(m_shaderTexture->GetConstantBuffer());
+			m_rhiPipeline->Bind();
+
+			m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+
+			if (last)
+				break;
+			source = target;
+		}
+
+		for (const auto& texture : acquired)
+		{
+			m_renderTexturePool->Release(texture);
+		}
+	}
+
+	void Renderer::Pass_TemporalAntialiasing(shared_ptr<RHI_RenderTexture>& texIn, shared_ptr<RHI_RenderTexture>& texOut)
+	{
+		if (m_shaderTemporalAntialiasing->GetState() != Shader_Built)
+		{
+			Pass_Upscale(texIn, texOut, false);
+			return;
+		}
+
+		TIME_BLOCK_SCOPED_MULTI();
+
+		// Last frame's output becomes this frame's history
+		m_renderTexHistory.swap(m_renderTexHistoryPrevious);
+
+		// Full resolution, the shader maps to the rendered sub-rect itself. The output is written twice, once
+		// for the passes that follow (they draw on top of it) and once more to keep as the next frame's history.
+		m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+		m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
+		m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
+		m_rhiPipeline->SetFillMode(Fill_Solid);
+		m_rhiPipeline->SetCullMode(Cull_Back);
+		m_rhiPipeline->SetRenderTargets({ texOut->GetRenderTargetView(), m_renderTexHistory->GetRenderTargetView() });
+		m_rhiPipeline->SetViewport(texOut->GetViewport());
+		m_rhiPipeline->SetShader(m_shaderTemporalAntialiasing);
+		m_rhiPipeline->SetTexture(texIn);
+		m_rhiPipeline->SetTexture(m_renderTexHistoryPrevious);
+		m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Velocity));
+		m_rhiPipeline->SetSampler(m_samplerPointClampAlways);
+		m_rhiPipeline->SetSampler(m_samplerBilinearClampAlways);
+		auto jitter = Vector2(m_taaJitter.x * 0.5f, -m_taaJitter.y * 0.5f) * m_dynamicResolutionScale; // NDC to texture coordinates of the sub-rect
+		auto buffer = Struct_TemporalAntialiasing(m_wvp_baseOrthographic, jitter, m_dynamicResolutionScale, m_taaHistoryValid, Vector2(texIn->GetWidth(), texIn->GetHeight()));
+		m_shaderTemporalAntialiasing->UpdateBuffer(&buffer);
+		m_rhiPipeline->SetConstantBuffer(m_shaderTemporalAntialiasing->GetConstantBuffer());
+		m_rhiPipeline->Bind();
+
+		m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+		m_taaHistoryValid = true;
 	}
 	//=============================================================================================================
 
 	bool Renderer::Pass_DebugGBuffer(shared_ptr<RHI_RenderTexture>& texOut)
 	{
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_DebugGBuffer");
+		TIME_BLOCK_SCOPED_MULTI();
 
 		GBuffer_Texture_Type texType = GBuffer_Target_Unknown;
 		texType	= RenderFlags_IsSet(Render_Albedo)		? GBuffer_Target_Albedo		: texType;
@@ -1105,8 +3845,8 @@ namespace Directus
 		if (texType != GBuffer_Target_Unknown)
 		{
 			m_rhiPipeline->Clear();
-			m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
-			m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+			m_rhiPipeline->SetVertexBuffer(m_quadScaled->GetVertexBuffer());
+			m_rhiPipeline->SetIndexBuffer(m_quadScaled->GetIndexBuffer());
 			m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
 			m_rhiPipeline->SetFillMode(Fill_Solid);
 			m_rhiPipeline->SetCullMode(Cull_Back);
@@ -1121,18 +3861,15 @@ namespace Directus
 			m_rhiPipeline->SetConstantBuffer(m_shaderTexture->GetConstantBuffer());
 			m_rhiPipeline->Bind();
 
-			m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
+			m_rhiDevice->DrawIndexed(m_quadScaled->GetIndexCount(), 0, 0);
 		}
 
-		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
 		return true;
 	}
 
-	void Renderer::Pass_Debug()
+	void Renderer::Pass_Debug(shared_ptr<RHI_RenderTexture>& texDepth)
 	{
-		TIME_BLOCK_START_MULTI();
-		m_rhiDevice->EventBegin("Pass_Debug");
+		TIME_BLOCK_SCOPED_MULTI();
 
 		m_rhiDevice->EventBegin("Line_Rendering");
 		{
@@ -1163,50 +3900,32 @@ namespace Directus
 				}
 			}
 
-			auto lineVertexBufferSize = (unsigned int)m_lineVertices.size();
-			if (lineVertexBufferSize != 0)
+			if (!m_debugDraw->IsEmpty())
 			{
-				if (lineVertexBufferSize > m_lineVertexCount)
-				{
-					m_lineVertexBuffer = make_shared<RHI_VertexBuffer>(m_rhiDevice);
-					m_lineVertexBuffer->CreateDynamic(sizeof(RHI_Vertex_PosCol), lineVertexBufferSize);
-					m_lineVertexCount = lineVertexBufferSize;
-				}
-
-				// Update line vertex buffer
-				void* data = m_lineVertexBuffer->Map();
-				memcpy(data, &m_lineVertices[0], sizeof(RHI_Vertex_PosCol) * lineVertexBufferSize);
-				m_lineVertexBuffer->Unmap();
-
-				// Set pipeline state
-				m_rhiPipeline->SetState(m_pipelineLine);
-				m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Depth));
-				m_rhiPipeline->SetVertexBuffer(m_lineVertexBuffer);
-				auto buffer = Struct_Matrix(Matrix::Identity * m_camera->GetViewMatrix() * m_camera->GetProjectionMatrix());
+				m_rhiPipeline->SetState(*m_pipelineLine);
+				m_rhiPipeline->SetTexture(texDepth);
+				auto buffer = Struct_Matrix_Vector2(Matrix::Identity * m_camera->GetViewMatrix() * m_camera->GetProjectionMatrix(), Vector2(m_camera->IsReverseZ() ? 1.0f : 0.0f, 0.0f));
 				m_shaderLine->UpdateBuffer(&buffer);
-				m_rhiPipeline->Bind();
-				m_rhiDevice->Draw(lineVertexBufferSize);
-
-				m_lineVertices.clear();	
+				m_debugDraw->Render(m_rhiPipeline, m_shaderLine->GetConstantBuffer(), m_shaderLineInstanced);
 			}
 		}
 		m_rhiDevice->EventEnd();
 
-		m_rhiDevice->Set_AlphaBlendingEnabled(true);
+		m_rhiPipeline->SetBlendMode(Blend_Alpha);
 
 		// Grid
 		if (m_flags & Render_SceneGrid)
 		{
 			m_rhiDevice->EventBegin("Grid");
 
-			m_rhiPipeline->SetState(m_pipelineLine);
-			m_rhiPipeline->SetTexture(m_gbuffer->GetTexture(GBuffer_Target_Depth));
-			m_rhiPipeline->SetIndexBuffer(m_grid->GetIndexBuffer());
-			m_rhiPipeline->SetVertexBuffer(m_grid->GetVertexBuffer());
-			auto buffer = Struct_Matrix(m_grid->ComputeWorldMatrix(m_camera->GetTransform()) * m_camera->GetViewMatrix() * m_camera->GetProjectionMatrix());
-			m_shaderLine->UpdateBuffer(&buffer);
+			m_rhiPipeline->SetState(*m_pipelineGrid);
+			m_rhiPipeline->SetTexture(texDepth);
+			m_rhiPipeline->SetIndexBuffer(m_quad->GetIndexBuffer());
+			m_rhiPipeline->SetVertexBuffer(m_quad->GetVertexBuffer());
+			auto buffer = m_grid->ComputeBuffer(m_camera, m_wvp_baseOrthographic);
+			m_shaderGrid->UpdateBuffer(&buffer);
 			m_rhiPipeline->Bind();
-			m_rhiDevice->DrawIndexed(m_grid->GetIndexCount(), 0, 0);
+			m_rhiDevice->DrawIndexed(m_quad->GetIndexCount(), 0, 0);
 
 			m_rhiDevice->EventEnd();
 		}
@@ -1220,7 +3939,7 @@ namespace Directus
 				for (const auto& actor : m_actors[Renderable_Light])
 				{
 					Vector3 lightWorldPos	= actor->GetTransform_PtrRaw()->GetPosition();
-					Vector3 cameraWorldPos	= m_camera->GetTransform()->GetPosition();
+					Vector3 cameraWorldPos	= Camera_GetPosition();
 
 					// Compute light screen space position and scale (based on distance from the camera)
 					Vector2 lightScreenPos	= m_camera->WorldToScreenPoint(lightWorldPos);
@@ -1237,7 +3956,7 @@ namespace Directus
 						continue;
 
 					shared_ptr<RHI_Texture> lightTex = nullptr;
-					LightType type = actor->GetComponent<Light>()->GetLightType();
+					LightType type = actor->GetComponent_PtrRaw<Light>()->GetLightType();
 					if (type == LightType_Directional)
 					{
 						lightTex = m_gizmoTexLightDirectional;
@@ -1303,12 +4022,15 @@ namespace Directus
 		if (m_flags & Render_PerformanceMetrics)
 		{
 			Vector2 textPos = Vector2(-(int)Settings::Get().Viewport_GetWidth() * 0.5f + 1.0f, (int)Settings::Get().Viewport_GetHeight() * 0.5f);
-			m_font->SetText(Profiler::Get().GetMetrics(), textPos);
+			m_font->AddText(Profiler::Get().GetMetrics(), textPos);
+		}
 
+		// Text, all of it in one draw
+		if (m_font->UpdateBuffers())
+		{
 			m_rhiPipeline->SetShader(m_shaderFont);
 			m_rhiPipeline->SetTexture(m_font->GetTexture());
 			m_rhiPipeline->SetSampler(m_samplerLinearClampAlways);
-			m_rhiPipeline->SetIndexBuffer(m_font->GetIndexBuffer());
 			m_rhiPipeline->SetVertexBuffer(m_font->GetVertexBuffer());
 			m_rhiPipeline->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
 			auto buffer = Struct_Matrix_Vector4(m_wvp_baseOrthographic, m_font->GetColor());
@@ -1316,22 +4038,19 @@ namespace Directus
 			m_rhiPipeline->SetConstantBuffer(m_shaderFont->GetConstantBuffer());
 			m_rhiPipeline->Bind();
 
-			m_rhiDevice->DrawIndexed(m_font->GetIndexCount(), 0, 0);
+			m_rhiDevice->Draw(m_font->GetVertexCount());
 		}
 
-		m_rhiDevice->Set_AlphaBlendingEnabled(false);
-
-		m_rhiDevice->EventEnd();
-		TIME_BLOCK_END_MULTI();
+		m_rhiPipeline->SetBlendMode(Blend_Disabled);
 	}
 
 	Light* Renderer::GetLightDirectional()
 	{
-		auto actors = m_actors[Renderable_Light];
+		auto& actors = m_actors[Renderable_Light];
 
 		for (const auto& actor : actors)
 		{
-			Light* light = actor->GetComponent<Light>().get();
+			Light* light = actor->GetComponent_PtrRaw<Light>();
 			if (light->GetLightType() == LightType_Directional)
 				return light;
 		}
@@ -1341,11 +4060,24 @@ namespace Directus
 
 	Skybox* Renderer::GetSkybox()
 	{
-		auto actors = m_actors[Renderable_Skybox];
+		auto& actors = m_actors[Renderable_Skybox];
 		if (actors.empty())
 			return nullptr;
 
 		auto skyboxActor = actors.front();
-		return skyboxActor ? skyboxActor->GetComponent<Skybox>().get() : nullptr;
+		return skyboxActor ? skyboxActor->GetComponent_PtrRaw<Skybox>() : nullptr;
+	}
+
+	LightProbeVolume* Renderer::GetLightProbeVolume()
+	{
+		// The first one that's baked, volumes don't blend into each other
+		for (const auto& actor : m_actors[Renderable_LightProbeVolume])
+		{
+			auto volume = actor->GetComponent_PtrRaw<LightProbeVolume>();
+			if (volume && volume->IsBaked())
+				return volume;
+		}
+
+		return nullptr;
 	}
 }
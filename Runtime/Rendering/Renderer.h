@@ -25,28 +25,52 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <chrono>
 #include "../Math/Matrix.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Frustum.h"
 #include "../Core/SubSystem.h"
+#include "../Core/FrameAllocator.h"
+#include "../Core/Settings.h"
 #include "../RHI/RHI_Definition.h"
 #include "../RHI/RHI_Pipeline.h"
+#include "../World/World.h"
+#include "RenderGraph.h"
 //================================
 
 namespace Directus
 {
 	class Actor;
 	class Camera;
+	class Renderable;
 	class Skybox;
+	class LightProbeVolume;
 	class Light;
 	class GBuffer;
 	class Rectangle;
 	class LightShader;
+	class LightClusters;
+	class ShadowAtlas;
+	class ReflectionProbes;
+	class DebugDraw;
+	class OcclusionCulling;
+	class GPUCulling;
+	class GPUSkinning;
+	class GPUParticles;
+	class Impostors;
+	class MaterialTextures;
+	class RenderTexturePool;
 	class ResourceManager;
 	class Font;
-	class Variant;
 	class Grid;
+	class RHI_PipelineCache;
+	class ShaderVariation;
+	class Material;
 	namespace Math
 	{
-		class BoundingBox;
 		class Frustum;
 	}
 
@@ -68,6 +92,16 @@ namespace Directus
 		Render_Sharpening			= 1UL << 13,
 		Render_ChromaticAberration	= 1UL << 14,
 		Render_Correction			= 1UL << 15, // Tone-mapping & Gamma correction
+		Render_OcclusionCulling		= 1UL << 16,
+		Render_DynamicResolution	= 1UL << 17, // Scales the G-Buffer and lighting to keep the GPU time within budget
+		Render_GPUDriven			= 1UL << 18, // The G-Buffer's visibility is decided by a compute shader, the draws are indirect
+		Render_ReverseZ				= 1UL << 19, // Floating point depth with the near plane at 1 and an infinite far plane at 0
+		Render_Checkerboard			= 1UL << 20, // Lights half the pixels per frame in a checkerboard, the rest come from their neighbours and the history
+		Render_DepthPrepass			= 1UL << 21, // Lays down the opaque depth first, so the G-Buffer shades each pixel only once
+		Render_TextureArrays		= 1UL << 22, // Materials sample their textures out of shared arrays, switching materials rebinds no textures
+		Render_CameraRelative		= 1UL << 23, // The G-Buffer's world matrices are relative to the camera, what the GPU multiplies stays small far from the origin
+		Render_SSR					= 1UL << 24, // Screen space reflections, traced at half resolution against the depth pyramid and accumulated over frames
+		Render_Impostors			= 1UL << 25, // Far away opaque static geometry is drawn as camera facing quads, out of views of it baked into an atlas
 	};
 
 	enum RenderableType
@@ -76,7 +110,10 @@ namespace Directus
 		Renderable_ObjectTransparent,
 		Renderable_Light,
 		Renderable_Camera,
-		Renderable_Skybox
+		Renderable_Skybox,
+		Renderable_ParticleEmitter,
+		Renderable_Terrain,
+		Renderable_LightProbeVolume
 	};
 
 	class ENGINE_CLASS Renderer : public Subsystem
@@ -119,63 +156,252 @@ namespace Directus
 		void AddLine(const Math::Vector3& from, const Math::Vector3& to, const Math::Vector4& colorFrom, const Math::Vector4& colorTo);
 		//===============================================================================================================================
 
+		//= DYNAMIC RESOLUTION ===========================================================================
+		// The GPU time (in ms) that the dynamic resolution aims for, 16.6 by default (60 Hz), it requires GPU profiling
+		void DynamicResolution_SetBudget(float budgetMs)	{ m_dynamicResolutionBudget = budgetMs; }
+		// The fraction of the resolution the G-Buffer and lighting currently render at
+		float DynamicResolution_GetScale()					{ return m_dynamicResolutionScale; }
+		//================================================================================================
+
+		//= QUALITY =========================================================================================================
+		// Sets the preset's render flags (those outside of Quality_GetFlagsMask stay as they are), shadow resolution and anisotropy,
+		// and the budget dynamic resolution aims for when it's on. Samplers keep the anisotropy they were created with.
+		void Quality_Apply(Quality quality, float budgetMs, bool dynamicResolution);
+		static unsigned long Quality_GetFlags(Quality quality);
+		static unsigned long Quality_GetFlagsMask();
+		static const char* Quality_GetName(Quality quality);
+		//===================================================================================================================
+
+		//= PIPELINED FRAMES =====================================================================================
+		// With Engine_Pipelined the next frame simulates while this one renders, so whatever the simulation writes
+		// (transforms, the camera) is read from a snapshot, captured once the simulation is done with a frame
+		void Pipelined_Set(bool pipelined)	{ m_pipelined = pipelined; }
+		bool Pipelined_Get()				{ return m_pipelined; }
+		// Copies the world transforms and the camera into the snapshot the next frame will render from
+		void Snapshot_Capture();
+		// Hands the captured snapshot over to the next frame, only while not rendering
+		void Snapshot_Swap()				{ m_snapshotRender = 1 - m_snapshotRender; }
+		//========================================================================================================
+
+		//= RENDER ON DEMAND =============================================================================
+		// With Settings::RenderOnDemand_Set the world isn't rendered while nothing changed. What the Renderer doesn't
+		// see change by itself (the camera, transforms, render flags, the resolution, world and material events) asks for a frame here.
+		void RenderOnDemand_Request() { m_renderOnDemandRequested = true; }
+		//================================================================================================
+
+		//= PICKING ======================================================================================
+		// Finds the opaque actor under a pixel of the frame. The next frame draws which renderable covers each pixel into
+		// GBuffer_Target_Id and only that pixel is read back, a few frames later, which is exact for any mesh at any scene size.
+		void Pick_Request(const Math::Vector2& pixel);
+		// False until the GPU answered the latest request, the ID is 0 when nothing opaque was under the pixel
+		bool Pick_Get(unsigned int* actorID);
+		// False when the picking shader didn't build, Camera::Pick (bounding boxes) is what's left then
+		bool Pick_IsSupported();
+		//================================================================================================
+
+		//= VIEWS ========================================================================================
+		// Cameras rendered every frame after the main one (the editor's extra viewports, split-screen), each into a render texture
+		// from the pool, at the renderer's resolution. All of them get culled in the same walk of the World's tree and draw from
+		// the same sorted lists. A view renders the G-Buffer, lighting, post-processing and transparents, it uses the main camera's
+		// shadow maps and skips what keeps a history (TAA, checkerboard, occlusion and GPU driven culling). Returns the view's ID.
+		unsigned int View_Add(const std::weak_ptr<Actor>& camera);
+		void View_Remove(unsigned int id);
+		// What the view rendered last, nullptr for an unknown ID
+		void* View_GetShaderResource(unsigned int id);
+		//================================================================================================
+
+		//= SKINNING =====================================================================================
+		// Crossfades the skinned renderables under an actor's root into one of their model's animations (see Model::Skin_GetAnimation)
+		void Skinning_Play(Actor* actor, unsigned int animation, float fadeSeconds);
+		// Below a screen size (like a model's levels of detail) characters sample their animations every few frames, easing
+		// in between, and without leaf bones. Level 0 is the first after full detail, off-screen characters pause at any level.
+		void Skinning_SetLod(unsigned int level, float screenSize, unsigned int updateInterval, bool leafBones);
+		//================================================================================================
+
+		//= IMPOSTORS ====================================================================================
+		// With Render_Impostors, opaque static geometry smaller on screen than this (see Renderables_GetScreenSize) is drawn
+		// as an impostor instead of it's last level of detail, once it's baked (see Impostors). 0.03 by default.
+		void Impostors_SetScreenSize(float screenSize)	{ m_impostorScreenSize = screenSize > 0.0f ? screenSize : 0.0f; }
+		float Impostors_GetScreenSize()					{ return m_impostorScreenSize; }
+		//================================================================================================
+
+		//= SHADOWS ======================================================================================
+		// Re-renders a cascade's moving shadow casters only every N frames (1 by default, every frame)
+		void Shadows_SetCascadeUpdateInterval(unsigned int cascadeIndex, unsigned int frames);
+		//================================================================================================
+
 		void Clear();
 		const std::shared_ptr<RHI_Device>& GetRHIDevice() { return m_rhiDevice; }
+		// The main thread's pipeline and the states it binds, for whatever draws after the frame (the editor)
+		const std::shared_ptr<RHI_Pipeline>& GetRHIPipeline()	{ return m_rhiPipeline; }
+		RHI_PipelineCache* GetPipelineCache()					{ return m_pipelineCache.get(); }
+		// Copies from the GPU that come back a few frames later, polled at the start of every frame
+		RHI_Readback* GetReadback()								{ return m_readback.get(); }
+		const std::shared_ptr<RenderTexturePool>& GetRenderTexturePool() { return m_renderTexturePool; }
 		static bool IsRendering()	{ return m_isRendering; }
 		static uint64_t GetFrame()	{ return m_frame; }
 		Camera* GetCamera()			{ return m_camera; }
+		DebugDraw* GetDebugDraw()	{ return m_debugDraw.get(); }
 
 	private:
 		void RenderTargets_Create(int width, int height);
+		// Declares and executes the passes that render the current camera into a target, a view skips what the main camera shares
+		void Render_Graph(const std::shared_ptr<RHI_RenderTexture>& target, bool view);
 
-		void Renderables_Acquire(const Variant& renderables);
-		void Renderables_Sort(std::vector<Actor*>* renderables);
+		//= RENDERABLES ======================================================
+		// Rebuilds all renderable lists from scratch (used when a world is submitted), deferred to the next frame when pipelined
+		void Renderables_Acquire(const std::vector<std::shared_ptr<Actor>>& actors);
+		void Renderables_Rebuild(const std::vector<std::shared_ptr<Actor>>& actors);
+		// Queues an actor whose components changed, it will be re-classified before the next frame
+		void Renderables_OnActorChanged(const std::weak_ptr<Actor>& actor, bool removed);
+		// Applies any queued changes to the renderable lists
+		void Renderables_ProcessChanges();
+		// Adds an actor to the renderable lists it belongs to
+		void Renderables_Insert(Actor* actor);
+		// Removes an actor from any renderable list it's part of
+		void Renderables_Remove(Actor* actor);
+		// Orders a renderable list for the current view, opaque ones front-to-back (coarsely) and transparent ones back-to-front
+		void Renderables_Sort(std::vector<Actor*>* renderables, bool transparent);
+		// The state (shader, material, model, mesh) part of the draw key, 48 bits
+		static unsigned long long Renderables_GetSortKey(Actor* actor);
+		// Returns true if both actors can be drawn by the same instanced draw call
+		static bool Renderables_AreInstances(Actor* a, Actor* b);
+		// Binds an actor's index and vertex buffers, its posed vertices when it's skinned (see Pass_Skinning), and returns the vertex offset to draw it with
+		unsigned int Renderables_BindGeometry(std::shared_ptr<RHI_Pipeline>& pipeline, Actor* actor, unsigned int* currentlyBoundGeometry);
+		// Returns the size of a world bounding box on screen, relative to the screen's height
+		float Renderables_GetScreenSize(const Math::BoundingBox& box);
+		// Returns the level of detail (0 is full detail) that suits the size of a renderable's world bounding box on screen
+		unsigned int Renderables_GetLod(Renderable* renderable, const Math::BoundingBox& box);
+		// Returns an actor's world transform, the snapshot's one when pipelined
+		const Math::Matrix& Renderables_GetWorld(Actor* actor);
+		// The camera's position, the snapshot's one when pipelined (or the view's that is rendering)
+		Math::Vector3 Camera_GetPosition();
+		// Whether an actor was found inside the view frustum, of the snapshot's camera when pipelined (or the view's that is rendering)
+		bool Renderables_IsVisible(const Actor* actor);
+		//====================================================================
 
 		//= PASSES ==========================================================================================================
 		void Pass_DepthDirectionalLight(Light* directionalLight);
+		void Pass_DepthDirectionalLight_Cascade(std::shared_ptr<RHI_Pipeline>& pipeline, Light* directionalLight, unsigned int cascadeIndex);
+		void Pass_DepthDirectionalLight_Casters(std::shared_ptr<RHI_Pipeline>& pipeline, const std::shared_ptr<RHI_RenderTexture>& target, const Math::Matrix& viewProjection, const std::vector<Actor*>& actors, bool clear);
+		void Pass_DepthLocalLights();
 		void Pass_GBuffer();
+		// Depth only draws the same range with m_shaderDepthPrepass, skipping materials that discard pixels (masked)
+		void Pass_GBuffer_Range(std::shared_ptr<RHI_Pipeline>& pipeline, const std::vector<Actor*>& actors, unsigned int start, unsigned int end, bool clear, bool depthOnly = false);
+		// The chunks each terrain selects for the camera, with the material of it's Renderable
+		void Pass_GBuffer_Terrain(std::shared_ptr<RHI_Pipeline>& pipeline, bool clear);
+		// Poses the skinned opaque actors on the compute shader, ahead of every pass that draws them
+		void Pass_Skinning();
+		bool Pass_Skinning_IsSupported();
+		// Uploads the opaque objects and culls them on the GPU, as an async compute section (see RHI_Device::Compute_Begin)
+		void Pass_Culling();
+		bool Pass_Culling_Dispatch();
+		// Draws every run of instances Pass_Culling went through with an indirect draw per level of detail
+		void Pass_GBuffer_Indirect();
+		// False when the culling compute shaders or the indirect vertex shader didn't build
+		bool Pass_GBuffer_Indirect_IsSupported();
+		// Binds a material's textures and returns its constant buffer, uploaded if its properties changed
+		const std::shared_ptr<RHI_ConstantBuffer>& Pass_GBuffer_SetMaterial(std::shared_ptr<RHI_Pipeline>& pipeline, Material* material);
+		// Once per command list, one can't see what was mapped before it
+		void Pass_GBuffer_UpdateFrameBuffer();
+		void Pass_GBuffer_MaterialTextures();
+		// Renders the views of a requested impostor into a G-Buffer of it's own and stores them, one renderable per frame
+		void Pass_Impostors_Bake();
+		// The impostors a range gathered (see Impostors::GetTransform), drawn last with a single instanced draw
+		void Pass_GBuffer_Impostors(std::shared_ptr<RHI_Pipeline>& pipeline, const std::vector<Math::Matrix>& transforms);
+		// The farthest and closest depth, for occlusion culling and screen space reflections
+		void Pass_DepthPyramid(std::shared_ptr<RHI_RenderTexture>& texDepth);
+		// Traces into texTrace (half resolution), the resolve accumulates it into m_renderTexSSR, which the light pass reads
+		void Pass_ScreenSpaceReflections(std::shared_ptr<RHI_RenderTexture>& texTrace);
+		void Pass_ScreenSpaceReflections_Resolve(std::shared_ptr<RHI_RenderTexture>& texTrace);
+		bool Pass_ScreenSpaceReflections_IsSupported();
 		void Pass_PreLight(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
-		void Pass_Light(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
-		void Pass_PostLight(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
-		void Pass_Transparent(std::shared_ptr<RHI_RenderTexture>& texOut);
+		// With checkerboard, texOut is half as wide and only holds this frame's half of the checkerboard
+		void Pass_Light(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut, bool checkerboard = false);
+		// Fills in the pixels Pass_Light skipped this frame, from their lit neighbours and the reprojected history
+		void Pass_CheckerboardResolve(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
+		// False when either of the checkerboard shaders didn't build, everything is lit then
+		bool Pass_Checkerboard_IsSupported();
+		void Pass_PostLight(RenderGraph_Resource texIn, RenderGraph_Resource texOut);
+		void Pass_PostLight_Setup(std::shared_ptr<RHI_RenderTexture>& texIn);
+		// Weighted blended order-independent transparency, accumulated into the two targets then composited onto texOut
+		void Pass_Transparent(std::shared_ptr<RHI_RenderTexture>& texOut, std::shared_ptr<RHI_RenderTexture>& texDepth, std::shared_ptr<RHI_RenderTexture>& texAccumulation, std::shared_ptr<RHI_RenderTexture>& texRevealage);
+		// Emits, moves and collides the particles against texDepth on the compute shaders, returns true if any should be drawn
+		bool Pass_Particles_Simulate(std::shared_ptr<RHI_RenderTexture>& texDepth);
+		// Into the transparency targets Pass_Transparent has set, with a single indirect draw
+		void Pass_Particles_Draw(std::shared_ptr<RHI_RenderTexture>& texDepth, Light* directionalLight);
+		bool Pass_Particles_IsSupported();
 		bool Pass_DebugGBuffer(std::shared_ptr<RHI_RenderTexture>& texOut);
-		void Pass_Debug();
-		void Pass_Correction(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
+		void Pass_Debug(std::shared_ptr<RHI_RenderTexture>& texDepth);
+		void Pass_Upscale(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut, bool depth);
+		// Halves a rendered face of a reflection probe until it fits the probe's capture texture
+		void Pass_ReflectionProbe_Downsample(std::shared_ptr<RHI_RenderTexture>& texIn);
+		void Pass_TemporalAntialiasing(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
+		// Runs any of correction, chromatic aberration and sharpening (the flags) as one pass
+		void Pass_PostFused(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut, unsigned long flags);
 		void Pass_FXAA(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
-		void Pass_Sharpening(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
-		void Pass_ChromaticAberration(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
+		// Progressive downsample/upsample on the compute shaders, then composited onto texOut
 		void Pass_Bloom(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
-		void Pass_Blur(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
+		// False when the compute shaders didn't build (the device has no compute support), bloom is skipped then
+		bool Pass_Bloom_IsSupported();
+		// Depth-aware blur of a lower resolution texIn up to the resolution of the G-Buffer
+		void Pass_UpsampleBilateral(std::shared_ptr<RHI_RenderTexture>& texIn, std::shared_ptr<RHI_RenderTexture>& texOut);
 		void Pass_Shadowing(Light* inDirectionalLight, std::shared_ptr<RHI_RenderTexture>& texOut);
+		// Draws the opaque renderables' list index (plus one) when a pick was requested, then reads back the picked pixel
+		void Pass_Picking();
+		// Resolves a finished readback to an actor ID, unless a newer pick superseded it
+		void Pick_Resolve(unsigned int request, const std::vector<unsigned char>& data);
 		//===================================================================================================================
 
-		//= RENDER TEXTURES ======================================
-		std::shared_ptr<RHI_RenderTexture> m_renderTex1;
-		std::shared_ptr<RHI_RenderTexture> m_renderTex2;
-		std::shared_ptr<RHI_RenderTexture> m_renderTex3;
-		std::shared_ptr<RHI_RenderTexture> m_renderTexQuarterRes1;
-		std::shared_ptr<RHI_RenderTexture> m_renderTexQuarterRes2;
-		std::shared_ptr<RHI_RenderTexture> m_renderTexShadowing;
-		//========================================================
+		//= RENDER TEXTURES =========================================================
+		// The final frame, everything else is a transient owned by the render graph
+		std::shared_ptr<RHI_RenderTexture> m_renderTexFrame;
+		std::shared_ptr<RHI_RenderTexture> m_renderTexHistory;			// temporal anti-aliasing output, written this frame
+		std::shared_ptr<RHI_RenderTexture> m_renderTexHistoryPrevious;	// temporal anti-aliasing output, read this frame
+		std::vector<std::shared_ptr<RHI_RenderTexture>> m_renderTexBloomDownsampled;	// half resolution and below
+		std::vector<std::shared_ptr<RHI_RenderTexture>> m_renderTexBloomUpsampled;	// one level less, the smallest is never upsampled into
+		std::shared_ptr<RenderTexturePool> m_renderTexturePool;
+		std::unique_ptr<RenderGraph> m_renderGraph;
+		//===========================================================================
 
 		//= SHADERS ============================================
 		std::shared_ptr<LightShader> m_shaderLight;
+		std::shared_ptr<LightShader> m_shaderLightCheckerboard;
+		std::shared_ptr<RHI_Shader> m_shaderCheckerboardResolve;
 		std::shared_ptr<RHI_Shader> m_shaderLightDepth;
+		std::shared_ptr<RHI_Shader> m_shaderPicking;
 		std::shared_ptr<RHI_Shader> m_shaderLine;
+		std::shared_ptr<RHI_Shader> m_shaderLineInstanced;
+		std::shared_ptr<RHI_Shader> m_shaderGrid;
 		std::shared_ptr<RHI_Shader> m_shaderFont;
 		std::shared_ptr<RHI_Shader> m_shaderTexture;
 		std::shared_ptr<RHI_Shader> m_shaderFXAA;
 		std::shared_ptr<RHI_Shader> m_shaderShadowing;
-		std::shared_ptr<RHI_Shader> m_shaderSharpening;
-		std::shared_ptr<RHI_Shader> m_shaderChromaticAberration;
-		std::shared_ptr<RHI_Shader> m_shaderBlurBox;
-		std::shared_ptr<RHI_Shader> m_shaderBlurGaussianH;
-		std::shared_ptr<RHI_Shader> m_shaderBlurGaussianV;
-		std::shared_ptr<RHI_Shader> m_shaderBloom_Bright;
+		std::shared_ptr<RHI_Shader> m_shaderUpsampleBilateral;
+		std::shared_ptr<RHI_Shader> m_shaderCompositeOIT;
+		std::shared_ptr<RHI_Shader> m_shaderBloom_DownsampleBright;
+		std::shared_ptr<RHI_Shader> m_shaderBloom_Downsample;
+		std::shared_ptr<RHI_Shader> m_shaderBloom_Upsample;
 		std::shared_ptr<RHI_Shader> m_shaderBloom_BlurBlend;
-		std::shared_ptr<RHI_Shader> m_shaderCorrection;
+		std::unordered_map<unsigned long, std::shared_ptr<RHI_Shader>> m_shadersPostFused; // keyed by the render flags they fuse
 		std::shared_ptr<RHI_Shader> m_shaderTransformationGizmo;
 		std::shared_ptr<RHI_Shader> m_shaderTransparent;
+		std::shared_ptr<ShaderVariation> m_shaderFallback;
+		std::shared_ptr<ShaderVariation> m_shaderDepthPrepass;
+		std::shared_ptr<RHI_Shader> m_shaderDownsampleDepth;
+		std::shared_ptr<RHI_Shader> m_shaderDownsampleDepthFirst; // from the G-Buffer's depth
+		std::shared_ptr<RHI_Shader> m_shaderSSR_Trace;
+		std::shared_ptr<RHI_Shader> m_shaderSSR_Resolve;
+		std::shared_ptr<RHI_Shader> m_shaderTemporalAntialiasing;
+		std::shared_ptr<RHI_Shader> m_shaderGBufferIndirect;
+		std::shared_ptr<RHI_Shader> m_shaderCulling_Reset;
+		std::shared_ptr<RHI_Shader> m_shaderCulling_Cull;
+		std::shared_ptr<RHI_Shader> m_shaderCulling_Cluster;
+		std::shared_ptr<RHI_Shader> m_shaderSkinning;
+		std::shared_ptr<RHI_Shader> m_shaderParticles_Reset;
+		std::shared_ptr<RHI_Shader> m_shaderParticles_Simulate;
+		std::shared_ptr<RHI_Shader> m_shaderParticles;
+		std::shared_ptr<RHI_Shader> m_shaderImpostor;
 		//======================================================
 
 		//= SAMPLERS ===============================================
@@ -187,9 +413,112 @@ namespace Directus
 		std::shared_ptr<RHI_Sampler> m_samplerAnisotropicWrapAlways;
 		//==========================================================
 
-		//= PIPELINE STATES =============
-		RHI_PipelineState m_pipelineLine;
-		//===============================
+		//= INSTANCING ===========================================
+		void Instances_Draw(std::shared_ptr<RHI_Pipeline>& pipeline, const std::vector<Math::Matrix>& transforms, const std::vector<std::shared_ptr<RHI_ConstantBuffer>>& constantBuffers, unsigned int indexCount, unsigned int indexOffset, unsigned int vertexOffset);
+		// Draws the instances gathered per level of detail (an array of MODEL_LODS_MAX transform lists), from the vertices at a vertex offset
+		void Instances_DrawLods(std::shared_ptr<RHI_Pipeline>& pipeline, Renderable* renderable, const std::vector<Math::Matrix>* lodTransforms, const std::vector<std::shared_ptr<RHI_ConstantBuffer>>& constantBuffers, unsigned int vertexOffset);
+		std::shared_ptr<RHI_ConstantBuffer> m_instanceBuffer;
+		//======================================================
+
+		//= COMMAND LISTS ===========================================================================================
+		// Records each job into a command list on the worker threads, then executes them in order
+		void CommandLists_Record(const FrameVector<std::function<void(std::shared_ptr<RHI_Pipeline>&)>>& jobs);
+		std::vector<std::shared_ptr<RHI_Pipeline>> m_rhiPipelinesDeferred;
+		//===========================================================================================================
+
+		//= SHADOW CACHING ===========================================================================================
+		// Splits the shadow casters into static ones (cached per cascade) and dynamic ones (drawn on top of the cache),
+		// and hands each one to the cascades it overlaps. Bounds are cached in light space, where a cascade is a box,
+		// so the casters get culled against each cascade in batches, like the camera's leaves are.
+		void Shadows_Classify(Light* light);
+		struct ShadowCaster
+		{
+			Math::Matrix world;
+			unsigned int framesStill;
+			Math::BoundingBox boundsLight;	// In the light view space below, re-computed when either changes
+			Math::Matrix boundsView;
+			bool boundsDirty = true;
+		};
+		struct ShadowCascadeCache
+		{
+			std::shared_ptr<RHI_RenderTexture> staticMap;	// Depth of the static casters only
+			RHI_RenderTexture* target	= nullptr;			// Only used as a key, the shadow map the cache was made for
+			Math::Matrix viewProjection;
+			uint64_t staticHash			= 0;
+			uint64_t dynamicHash		= 0;
+			uint64_t frameUpdated		= 0;
+			bool valid					= false;
+
+			// This frame's casters, the hashes identify the contents of each list (regardless of order)
+			std::vector<Actor*> castersStatic;
+			std::vector<Actor*> castersDynamic;
+			uint64_t castersStaticHash	= 0;
+			uint64_t castersDynamicHash	= 0;
+		};
+		struct ShadowCandidate
+		{
+			Actor* actor;
+			uint64_t key;
+			bool isStatic;
+		};
+		std::unordered_map<Actor*, ShadowCaster> m_shadowCasters;
+		std::vector<ShadowCandidate> m_shadowCandidates;	// This frame's casters, in the opaque list's order
+		Math::BoundingBoxSoA m_shadowCandidateBounds;	// and their light space bounds
+		std::vector<uint64_t> m_shadowCandidateVisible;
+		std::vector<ShadowCascadeCache> m_shadowCascades;
+		std::vector<unsigned int> m_shadowCascadeIntervals;
+		//============================================================================================================
+
+		//= DYNAMIC RESOLUTION ===============================================================================
+		// Adjusts the scale from the previous frame's GPU time
+		void DynamicResolution_Update();
+		// The viewport that covers the top left sub-rect of a full size target, the part that gets rendered
+		RHI_Viewport DynamicResolution_GetViewport(const std::shared_ptr<RHI_RenderTexture>& target);
+		float m_dynamicResolutionScale		= 1.0f;		// quantized, what's rendered with
+		float m_dynamicResolutionTarget		= 1.0f;		// smoothed, what the scale follows
+		float m_dynamicResolutionBudget		= 16.6f;
+		float m_dynamicResolutionGpuTime	= 0.0f;		// the last reading that was acted upon
+		std::unique_ptr<Rectangle> m_quadScaled;		// m_quad, with texture coordinates that only span the rendered sub-rect
+		Math::Matrix m_mVP_inverseScaled;				// maps the sub-rect's NDC back to world space
+		//====================================================================================================
+
+		//= TEMPORAL ANTI-ALIASING ===========================================================================
+		Math::Vector2 m_taaJitter;				// this frame's sub-pixel offset, in NDC
+		Math::Matrix m_mVP_unjittered;
+		Math::Matrix m_mVP_previous;			// last frame's un-jittered view projection, for the velocity
+		bool m_taaHistoryValid	= false;
+		//====================================================================================================
+
+		//= CAMERA RELATIVE ==================================================================================
+		// The G-Buffer passes (depth pre-pass, indirect draws) get world matrices with the origin subtracted, and view
+		// matrices that add it back. Light and shadows, and everything else, stay in world space.
+		Math::Matrix Renderables_GetWorldRelative(Actor* actor);
+		Math::Vector3 m_origin;					// the camera's position with Render_CameraRelative, zero without
+		WorldPosition m_originWorld;			// where that is in the whole world, to tell how far it moved since the last frame
+		Math::Matrix m_mV_origin;
+		Math::Matrix m_mVP_unjittered_origin;
+		Math::Matrix m_mVP_previous_origin;
+		//====================================================================================================
+
+		//= CHECKERBOARD =====================================================================================
+		std::shared_ptr<RHI_RenderTexture> m_renderTexCheckerboard;			// resolved lighting, written this frame
+		std::shared_ptr<RHI_RenderTexture> m_renderTexCheckerboardPrevious;	// resolved lighting, read this frame
+		float m_checkerboardHistoryScale	= 0.0f;	// the dynamic resolution scale the history was resolved at, 0 when there is none
+		//====================================================================================================
+
+		//= SCREEN SPACE REFLECTIONS =========================================================================
+		std::shared_ptr<RHI_RenderTexture> m_renderTexSSR;			// accumulated, written this frame
+		std::shared_ptr<RHI_RenderTexture> m_renderTexSSRPrevious;	// accumulated, read this frame
+		float m_ssrHistoryScale = 0.0f; // like m_checkerboardHistoryScale, the light pass reads no reflections while it's 0
+		//====================================================================================================
+
+		//= PIPELINE STATES ============================================
+		std::unique_ptr<RHI_PipelineCache> m_pipelineCache;
+		std::shared_ptr<RHI_PipelineState> m_pipelineLine;
+		std::shared_ptr<RHI_PipelineState> m_pipelineGrid;
+		std::shared_ptr<RHI_PipelineState> m_pipelineTransparent;
+		std::shared_ptr<RHI_PipelineState> m_pipelineParticles;
+		//==============================================================
 
 		//= DEBUG ==============================================
 		std::unique_ptr<Font> m_font;
@@ -201,16 +530,137 @@ namespace Directus
 		static unsigned long m_flags;
 		//======================================================
 
-		//= LINE RENDERING ==================================
-		std::shared_ptr<RHI_VertexBuffer> m_lineVertexBuffer;
-		unsigned int m_lineVertexCount = 0;
-		std::vector<RHI_Vertex_PosCol> m_lineVertices;
-		//===================================================
+		//= DRAW KEYS ===================================================================================
+		struct DrawPacket
+		{
+			unsigned long long key;
+			Actor* actor;
+		};
+		// Sorts by key, least significant byte first
+		static void DrawPackets_Sort(std::vector<DrawPacket>& packets, std::vector<DrawPacket>& scratch);
+		std::unordered_map<Actor*, unsigned long long> m_sortKeys; // cached state keys, they only change with the actor's components
+		std::vector<DrawPacket> m_drawPackets;
+		std::vector<DrawPacket> m_drawPacketsScratch;
+		//===============================================================================================
+
+		//= RENDERABLE CHANGES ==============================================
+		struct RenderableChange
+		{
+			Actor* actor;					// Only used as a key, could be dangling
+			std::weak_ptr<Actor> actorWeak;
+			bool removed;
+		};
+		std::vector<RenderableChange> m_actorsChanged;
+		bool m_materialsChanged = false;
+		std::vector<std::shared_ptr<Actor>> m_actorsSubmitted;	// a world submitted while pipelined, rebuilt from before the next frame
+		bool m_actorsSubmittedPending = false;
+		std::unordered_map<Actor*, std::shared_ptr<Actor>> m_actorsAlive; // keeps listed actors alive while a frame might still draw them
+		std::mutex m_actorsChangedMutex;
+		//===================================================================
+
+		//= PIPELINED FRAMES =================================================
+		struct RenderSnapshot_View
+		{
+			Camera* camera = nullptr;
+			std::shared_ptr<RHI_RenderTexture> target;
+			Math::Matrix view;
+			Math::Matrix viewBase;
+			Math::Matrix projection;
+			Math::Frustum frustum;
+			Math::Vector3 cameraPosition;
+			float nearPlane	= 0.0f;
+			float farPlane	= 0.0f;
+			std::vector<bool> visible;	// by actor slot
+			unsigned int probeCapture = 0; // the ticket of the reflection probe face it renders, 0 for a camera's view
+		};
+
+		struct RenderSnapshot
+		{
+			std::unordered_map<const Actor*, Math::Matrix> transforms;
+			Math::Matrix view;
+			Math::Matrix viewBase;
+			Math::Matrix projection;
+			Math::Frustum frustum;
+			Math::Vector3 cameraPosition;
+			WorldPosition origin;		// the World's, as of the capture
+			float nearPlane	= 0.0f;
+			float farPlane	= 0.0f;
+			bool camera		= false;
+			std::vector<bool> visible;	// by actor slot
+			bool culled		= false;
+			std::vector<RenderSnapshot_View> views;
+		};
+		// Marks which actors the World's spatial tree finds inside a frustum and the views' ones, in the snapshot's visibility
+		void Renderables_Cull(RenderSnapshot& snapshot, Math::Frustum& frustum);
+
+		RenderSnapshot m_snapshots[2];		// one is captured while the other is rendered from
+		unsigned int m_snapshotRender	= 0;
+		bool m_pipelined				= false;
+		//===================================================================
+
+		//= VIEWS ===========================================================
+		struct View
+		{
+			std::weak_ptr<Actor> camera;
+			std::shared_ptr<RHI_RenderTexture> target;
+			bool alive = false;
+		};
+		// Copies the cameras of the views into the snapshot, along with the next face a reflection probe needs (rendered like the camera)
+		void Views_Capture(RenderSnapshot& snapshot, Camera* camera);
+		// Renders the snapshot's views, after the main camera
+		void Views_Render();
+
+		std::vector<View> m_views;					// an ID is the index + 1
+		std::mutex m_viewsMutex;					// views are added and removed by the editor, while rendering may capture them
+		int m_viewRendering = -1;					// the snapshot's view being rendered, -1 for the main camera
+		std::vector<Math::Frustum> m_viewFrusta;	// spatial query scratch, the main camera's first
+		std::vector<std::vector<Actor*>> m_viewActors;
+		//===================================================================
+
+		//= RENDER ON DEMAND ===================================================
+		// Whether this frame can be skipped, the last one rendered is still what it would show
+		bool RenderOnDemand_IsIdle();
+
+		std::atomic<bool> m_renderOnDemandRequested		= true;
+		unsigned int m_renderOnDemandFrames				= 0; // left to render since the last change
+		unsigned int m_renderOnDemandTransforms			= 0;
+		unsigned long m_renderOnDemandFlags				= 0;
+		Math::Vector2 m_renderOnDemandResolution;
+		Math::Matrix m_renderOnDemandView;
+		Math::Matrix m_renderOnDemandProjection;
+		std::chrono::steady_clock::time_point m_renderOnDemandTime;
+		//======================================================================
+
+		//= PICKING ============================================================
+		std::mutex m_pickMutex;						// requests come from the editor, answers from rendering
+		bool m_pickRequested			= false;
+		bool m_pickAnswered				= false;
+		Math::Vector2 m_pickPixel;
+		unsigned int m_pickActorID		= 0;
+		unsigned int m_pickReadback		= 0;		// the readback request of the latest pick, older ones are superseded
+		std::vector<unsigned int> m_pickActors;		// actor IDs by the index drawn for the latest pick
+		//======================================================================
 
 		//= MISC ========================================================
 		std::shared_ptr<RHI_Device> m_rhiDevice;
 		std::shared_ptr<RHI_Pipeline> m_rhiPipeline;
+		std::unique_ptr<RHI_Readback> m_readback;
 		std::unique_ptr<GBuffer> m_gbuffer;
+		std::shared_ptr<RHI_ConstantBuffer> m_gbufferFrameBuffer; // see Struct_GBufferFrame
+		std::unique_ptr<LightClusters> m_lightClusters;
+		std::unique_ptr<ShadowAtlas> m_shadowAtlas;
+		std::unique_ptr<ReflectionProbes> m_reflectionProbes;
+		std::unique_ptr<DebugDraw> m_debugDraw;
+		std::unique_ptr<OcclusionCulling> m_occlusionCulling;
+		std::unique_ptr<GPUCulling> m_gpuCulling;
+		std::vector<Actor*> m_gpuCullingDraws; // the first actor of every draw
+		bool m_gpuCullingDispatched = false;
+		std::unique_ptr<GPUSkinning> m_gpuSkinning;
+		std::unique_ptr<GPUParticles> m_gpuParticles;
+		std::unique_ptr<MaterialTextures> m_materialTextures;
+		std::unique_ptr<Impostors> m_impostors;
+		float m_impostorScreenSize	= 0.03f;
+		bool m_depthPrepass			= false; // this frame's G-Buffer tests against an earlier depth only pass
 		std::shared_ptr<RHI_Texture> m_texNoiseMap;
 		std::unique_ptr<Rectangle> m_quad;
 		std::unordered_map<RenderableType, std::vector<Actor*>> m_actors;
@@ -225,6 +675,7 @@ namespace Directus
 		Camera* m_camera;
 		Light* GetLightDirectional();
 		Skybox* GetSkybox();
+		LightProbeVolume* GetLightProbeVolume();
 		static bool m_isRendering;
 		static uint64_t m_frame;
 		//===============================================================
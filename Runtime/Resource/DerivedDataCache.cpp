@@ -0,0 +1,121 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "DerivedDataCache.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string_view>
+#include "../FileSystem/FileSystem.h"
+#include "../Logging/Log.h"
+//===================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+#define DERIVED_DATA_EXTENSION ".derived"
+
+namespace Directus
+{
+	namespace _DerivedDataCache
+	{
+		inline void HashCombine(size_t& seed, size_t value) { seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2); }
+	}
+
+	DerivedDataCache::DerivedDataCache(Context* context)
+	{
+		m_context = context;
+	}
+
+	string DerivedDataCache::GetKey(const string& sourceFilePath, const string& importer, unsigned int importerVersion, size_t settingsHash)
+	{
+		ifstream in(sourceFilePath, ios::in | ios::binary);
+		if (in.fail())
+			return "";
+
+		ostringstream content;
+		content << in.rdbuf();
+
+		// The path is part of it, the output carries the name and path the source was imported from
+		string bytes	= content.str();
+		size_t seed		= hash<string_view>()(bytes);
+		_DerivedDataCache::HashCombine(seed, hash<string>()(FileSystem::GetRelativeFilePath(sourceFilePath)));
+		_DerivedDataCache::HashCombine(seed, hash<string>()(importer));
+		_DerivedDataCache::HashCombine(seed, hash<unsigned int>()(importerVersion));
+		_DerivedDataCache::HashCombine(seed, settingsHash);
+
+		ostringstream key;
+		key << importer << "_" << hex << setw(16) << setfill('0') << seed;
+		return key.str();
+	}
+
+	bool DerivedDataCache::Fetch(const string& key, const string& destinationFilePath)
+	{
+		if (key.empty())
+			return false;
+
+		string local	= GetDirectory_Local();
+		string shared	= GetDirectory_Shared();
+		string fileName	= key + DERIVED_DATA_EXTENSION;
+
+		// Found locally
+		if (!local.empty() && FileSystem::FileExists(local + fileName))
+			return FileSystem::CopyFileFromTo(local + fileName, destinationFilePath);
+
+		// Found in the shared directory, it's kept locally from now on
+		if (!shared.empty() && FileSystem::FileExists(shared + fileName))
+		{
+			if (!local.empty())
+			{
+				FileSystem::CopyFileFromTo(shared + fileName, local + fileName);
+			}
+			return FileSystem::CopyFileFromTo(shared + fileName, destinationFilePath);
+		}
+
+		return false;
+	}
+
+	void DerivedDataCache::Store(const string& key, const string& derivedFilePath)
+	{
+		if (key.empty() || !FileSystem::FileExists(derivedFilePath))
+			return;
+
+		string local	= GetDirectory_Local();
+		string shared	= GetDirectory_Shared();
+		string fileName	= key + DERIVED_DATA_EXTENSION;
+
+		if (!local.empty())
+		{
+			FileSystem::CopyFileFromTo(derivedFilePath, local + fileName);
+		}
+
+		// Someone else might have put it there already, writing it again would only race them
+		if (!shared.empty() && !FileSystem::FileExists(shared + fileName))
+		{
+			if (!FileSystem::CopyFileFromTo(derivedFilePath, shared + fileName))
+			{
+				LOGF_WARNING("DerivedDataCache::Store: Failed to share \"%s\"", fileName.c_str());
+			}
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <string>
+#include <mutex>
+#include "../Core/EngineDefs.h"
+//===============================
+
+namespace Directus
+{
+	class Context;
+
+	// What importing a foreign file produced (e.g. the engine texture of an image), keyed by the source's content and path, the
+	// importer's version and the settings it imported with. A local directory is always used, a shared one (e.g. a network
+	// directory the whole team points to) is optional, what's found there gets copied to the local one.
+	class ENGINE_CLASS DerivedDataCache
+	{
+	public:
+		DerivedDataCache(Context* context);
+
+		// Empty if the source can't be read
+		std::string GetKey(const std::string& sourceFilePath, const std::string& importer, unsigned int importerVersion, size_t settingsHash);
+		// Copies the cached output of a key to a file, false if it isn't cached
+		bool Fetch(const std::string& key, const std::string& destinationFilePath);
+		// Caches a file as the output of a key
+		void Store(const std::string& key, const std::string& derivedFilePath);
+
+		void SetDirectory_Local(const std::string& directory)	{ std::lock_guard<std::mutex> lock(m_mutex); m_directoryLocal = directory; }
+		void SetDirectory_Shared(const std::string& directory)	{ std::lock_guard<std::mutex> lock(m_mutex); m_directoryShared = directory; }
+		std::string GetDirectory_Local()						{ std::lock_guard<std::mutex> lock(m_mutex); return m_directoryLocal; }
+		std::string GetDirectory_Shared()						{ std::lock_guard<std::mutex> lock(m_mutex); return m_directoryShared; }
+
+	private:
+		Context* m_context;
+		std::string m_directoryLocal;
+		std::string m_directoryShared; // empty if there is none
+		std::mutex m_mutex;
+	};
+}
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Rendering/Font.h"
 #include "../Rendering/Deferred/ShaderVariation.h"
 #include "../Rendering/Animation.h"
+#include "../World/Prefab.h"
 //================================================
 
 //= NAMESPACES ==========
@@ -44,6 +45,7 @@ INSTANTIATE_ToResourceType(Mesh,			Resource_Mesh)
 INSTANTIATE_ToResourceType(Model,			Resource_Model)
 INSTANTIATE_ToResourceType(Animation,		Resource_Animation)
 INSTANTIATE_ToResourceType(Font,			Resource_Font)
+INSTANTIATE_ToResourceType(Prefab,			Resource_Prefab)
 
 IResource::IResource(Context* context, Resource_Type type)
 {
@@ -54,6 +56,31 @@ IResource::IResource(Context* context, Resource_Type type)
 	m_loadState			= LoadState_Idle;
 }
 
+void IResource::SetResourceName(const string& name)
+{
+	// A cached resource has to be re-indexed under it's new name
+	if (m_resourceCache)
+	{
+		m_resourceCache->Rename(this, name, m_resourceFilePath);
+		return;
+	}
+
+	m_resourceName		= name;
+	m_resourceNameID	= name;
+}
+
+void IResource::SetResourceFilePath(const string& filePath)
+{
+	if (m_resourceCache)
+	{
+		m_resourceCache->Rename(this, m_resourceName, filePath);
+		return;
+	}
+
+	m_resourceFilePath		= filePath;
+	m_resourceFilePathID	= filePath;
+}
+
 shared_ptr<IResource> IResource::_Cache()
 {
 	auto resource = m_resourceManager->GetResourceByName(GetResourceName(), m_resourceType);
@@ -23,8 +23,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========================
 #include <memory>
+#include <atomic>
 #include "../Core/Context.h"
 #include "../Core/GUIDGenerator.h"
+#include "../Core/StringId.h"
 #include "../FileSystem/FileSystem.h"
 #include "../Logging/Log.h"
 //===================================
@@ -32,6 +34,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Directus
 {
 	class ResourceManager;
+	class ResourceCache;
 	
 	enum Resource_Type
 	{
@@ -45,7 +48,8 @@ namespace Directus
 		Resource_Cubemap,
 		Resource_Script, // not an actual resource, resource manager simply uses this to return a standard resource path (must remove)
 		Resource_Animation,
-		Resource_Font
+		Resource_Font,
+		Resource_Prefab
 	};
 
 	enum LoadState
@@ -56,6 +60,13 @@ namespace Directus
 		LoadState_Failed
 	};
 
+	// What happens to a resource's CPU side copy once the GPU has it
+	enum Resource_Residency
+	{
+		Residency_Keep,					// stays in memory
+		Residency_ReleaseAfterUpload	// freed, re-read from the engine file when needed
+	};
+
 	class ENGINE_CLASS IResource : public std::enable_shared_from_this<IResource>
 	{
 	public:
@@ -70,11 +81,15 @@ namespace Directus
 
 		const char* GetResourceType_cstr() { return typeid(*this).name(); }
 
-		const std::string& GetResourceName()			{ return m_resourceName; }
-		void SetResourceName(const std::string& name)	{ m_resourceName = name; }
+		const std::string& GetResourceName() { return m_resourceName; }
+		void SetResourceName(const std::string& name);
 
-		const std::string& GetResourceFilePath()				{ return m_resourceFilePath; }
-		void SetResourceFilePath(const std::string& filePath)	{ m_resourceFilePath = filePath; }
+		const std::string& GetResourceFilePath() { return m_resourceFilePath; }
+		void SetResourceFilePath(const std::string& filePath);
+
+		// What the cache compares lookups against, instead of the strings
+		const StringId& GetResourceNameID()		{ return m_resourceNameID; }
+		const StringId& GetResourceFilePathID()	{ return m_resourceFilePathID; }
 
 		bool HasFilePath() { return m_resourceFilePath != NOT_ASSIGNED; }
 
@@ -115,6 +130,25 @@ namespace Directus
 		virtual unsigned int GetMemoryUsage()					{ return 0; }
 		//======================================================================
 
+		//= DIRTY =================================================================================================
+		// Whether the engine file is behind what's in memory. A resource that can hash it's content is dirty when
+		// the hash differs from the one it had when it was last saved/loaded, the rest have to be marked dirty.
+		bool Resource_IsDirty()
+		{
+			size_t hash = Resource_GetContentHash();
+			return hash != 0 ? hash != m_resourceHash : m_resourceDirty;
+		}
+		void Resource_MarkDirty() { m_resourceDirty = true; }
+		// The engine file was just saved/loaded, so it matches
+		void Resource_MarkClean()
+		{
+			m_resourceHash	= Resource_GetContentHash();
+			m_resourceDirty	= false;
+		}
+		// A hash of what SaveToFile() writes, 0 if the resource can't tell
+		virtual size_t Resource_GetContentHash() { return 0; }
+		//=========================================================================================================
+
 		//= TYPE ================================
 		template <typename T>
 		static Resource_Type DeduceResourceType();
@@ -128,15 +162,22 @@ namespace Directus
 		void SetLoadState(LoadState state)	{ m_loadState = state; }
 
 	protected:
+		friend class ResourceCache;
 		std::shared_ptr<IResource> _Cache();
 		bool _IsCached();
 
 		unsigned int m_resourceID			= NOT_ASSIGNED_HASH;
 		std::string m_resourceName			= NOT_ASSIGNED;
 		std::string m_resourceFilePath		= NOT_ASSIGNED;
+		StringId m_resourceNameID			= NOT_ASSIGNED;	// stale while the strings are read straight from a file, until the cache re-indexes it
+		StringId m_resourceFilePathID		= NOT_ASSIGNED;
 		Resource_Type m_resourceType			= Resource_Unknown;
 		LoadState m_loadState				= LoadState_Idle;
+		bool m_resourceDirty				= true;	// nothing is in the engine file until it's first saved
+		size_t m_resourceHash				= 0;
 		Context* m_context					= nullptr;
 		ResourceManager* m_resourceManager	= nullptr;
+		ResourceCache* m_resourceCache		= nullptr;	// the cache that indexes this resource by name and path, if any
+		std::atomic<unsigned int> m_resourceLastUse = 0;	// the cache's frame it was last looked up in
 	};
 }
@@ -0,0 +1,405 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "BlockCompression.h"
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <algorithm>
+#include "../../Logging/Log.h"
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace _BlockCompression
+{
+	struct Block
+	{
+		float pixels[16][4];
+	};
+
+	// Writes bits from the least significant one up, the way blocks are laid out
+	struct BitWriter
+	{
+		BitWriter(byte* out) { this->out = out; }
+
+		void Write(uint32_t value, unsigned int bits)
+		{
+			for (unsigned int i = 0; i < bits; i++, position++)
+			{
+				if ((value >> i) & 1)
+				{
+					out[position >> 3] |= (byte)(1 << (position & 7));
+				}
+			}
+		}
+
+		byte* out;
+		unsigned int position = 0;
+	};
+
+	inline void Fetch(const byte* rgba, unsigned int width, unsigned int height, unsigned int blockX, unsigned int blockY, Block* block)
+	{
+		for (unsigned int y = 0; y < 4; y++)
+		{
+			for (unsigned int x = 0; x < 4; x++)
+			{
+				auto pixel = &rgba[(min(blockY * 4 + y, height - 1) * width + min(blockX * 4 + x, width - 1)) * 4];
+				for (unsigned int c = 0; c < 4; c++)
+				{
+					block->pixels[y * 4 + x][c] = (float)pixel[c];
+				}
+			}
+		}
+	}
+
+	inline float Distance(const float* a, const float* b, unsigned int channels)
+	{
+		float distance = 0.0f;
+		for (unsigned int c = 0; c < channels; c++)
+		{
+			distance += (a[c] - b[c]) * (a[c] - b[c]);
+		}
+		return distance;
+	}
+
+	template <unsigned int count>
+	inline unsigned int Nearest(const float* pixel, const float (&palette)[count][4], unsigned int channels)
+	{
+		unsigned int best		= 0;
+		float bestDistance		= Distance(pixel, palette[0], channels);
+		for (unsigned int i = 1; i < count; i++)
+		{
+			float distance = Distance(pixel, palette[i], channels);
+			if (distance < bestDistance)
+			{
+				best			= i;
+				bestDistance	= distance;
+			}
+		}
+		return best;
+	}
+
+	// Endpoints of the segment the pixels span along their principal axis
+	inline void FitLine(const Block& block, unsigned int channels, float* start, float* end)
+	{
+		float mean[4]	= {};
+		float low[4]	= { 255.0f, 255.0f, 255.0f, 255.0f };
+		float high[4]	= {};
+		for (const auto& pixel : block.pixels)
+		{
+			for (unsigned int c = 0; c < channels; c++)
+			{
+				mean[c] += pixel[c] / 16.0f;
+				low[c]	= min(low[c], pixel[c]);
+				high[c]	= max(high[c], pixel[c]);
+			}
+		}
+
+		float covariance[4][4] = {};
+		for (const auto& pixel : block.pixels)
+		{
+			for (unsigned int a = 0; a < channels; a++)
+			{
+				for (unsigned int b = 0; b < channels; b++)
+				{
+					covariance[a][b] += (pixel[a] - mean[a]) * (pixel[b] - mean[b]);
+				}
+			}
+		}
+
+		// Power iteration, starting from the diagonal of the bounding box
+		float axis[4] = {};
+		for (unsigned int c = 0; c < channels; c++) { axis[c] = high[c] - low[c]; }
+		for (unsigned int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4]	= {};
+			float largest	= 0.0f;
+			for (unsigned int a = 0; a < channels; a++)
+			{
+				for (unsigned int b = 0; b < channels; b++)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				largest = max(largest, fabs(next[a]));
+			}
+
+			if (largest == 0.0f)
+				break;
+
+			for (unsigned int c = 0; c < channels; c++) { axis[c] = next[c] / largest; }
+		}
+
+		float zero[4]	= {};
+		float length	= sqrt(Distance(axis, zero, channels));
+		if (length == 0.0f)
+		{
+			for (unsigned int c = 0; c < channels; c++) { start[c] = end[c] = mean[c]; }
+			return;
+		}
+		for (unsigned int c = 0; c < channels; c++) { axis[c] /= length; }
+
+		float projectionMin = FLT_MAX;
+		float projectionMax = -FLT_MAX;
+		for (const auto& pixel : block.pixels)
+		{
+			float projection = 0.0f;
+			for (unsigned int c = 0; c < channels; c++) { projection += (pixel[c] - mean[c]) * axis[c]; }
+			projectionMin = min(projectionMin, projection);
+			projectionMax = max(projectionMax, projection);
+		}
+
+		for (unsigned int c = 0; c < channels; c++)
+		{
+			start[c]	= min(max(mean[c] + axis[c] * projectionMin, 0.0f), 255.0f);
+			end[c]		= min(max(mean[c] + axis[c] * projectionMax, 0.0f), 255.0f);
+		}
+	}
+
+	inline uint16_t To565(const float* color)
+	{
+		auto r = (uint16_t)lround(color[0] * 31.0f / 255.0f);
+		auto g = (uint16_t)lround(color[1] * 63.0f / 255.0f);
+		auto b = (uint16_t)lround(color[2] * 31.0f / 255.0f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	inline void From565(uint16_t value, float* color)
+	{
+		unsigned int r = (value >> 11) & 31;
+		unsigned int g = (value >> 5) & 63;
+		unsigned int b = value & 31;
+		color[0] = (float)((r << 3) | (r >> 2));
+		color[1] = (float)((g << 2) | (g >> 4));
+		color[2] = (float)((b << 3) | (b >> 2));
+		color[3] = 255.0f;
+	}
+
+	// BC1 color block in its four color mode, 8 bytes
+	inline void EncodeColor(const Block& block, byte* out)
+	{
+		float start[4], end[4];
+		FitLine(block, 3, start, end);
+
+		// The four color mode needs the first endpoint to be the larger one
+		uint16_t color0 = To565(end);
+		uint16_t color1 = To565(start);
+		if (color0 < color1)
+		{
+			swap(color0, color1);
+		}
+
+		float palette[4][4];
+		From565(color0, palette[0]);
+		From565(color1, palette[1]);
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+
+		// Equal endpoints would switch to the three color mode, where every index being 0 still means the first color
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			for (unsigned int i = 0; i < 16; i++)
+			{
+				indices |= Nearest(block.pixels[i], palette, 3) << (i * 2);
+			}
+		}
+
+		BitWriter writer(out);
+		writer.Write(color0, 16);
+		writer.Write(color1, 16);
+		writer.Write(indices, 32);
+	}
+
+	// BC4 single channel block in its eight value mode, 8 bytes
+	inline void EncodeChannel(const Block& block, unsigned int channel, byte* out)
+	{
+		float low	= 255.0f;
+		float high	= 0.0f;
+		for (const auto& pixel : block.pixels)
+		{
+			low		= min(low, pixel[channel]);
+			high	= max(high, pixel[channel]);
+		}
+
+		auto value0 = (uint32_t)lround(high);
+		auto value1 = (uint32_t)lround(low);
+
+		BitWriter writer(out);
+		writer.Write(value0, 8);
+		writer.Write(value1, 8);
+
+		// Equal values would switch to the six value mode, where every index being 0 still means the first value
+		if (value0 == value1)
+			return;
+
+		float palette[8][4] = {};
+		palette[0][0] = (float)value0;
+		palette[1][0] = (float)value1;
+		for (unsigned int i = 2; i < 8; i++)
+		{
+			palette[i][0] = ((8 - i) * palette[0][0] + (i - 1) * palette[1][0]) / 7.0f;
+		}
+
+		for (const auto& pixel : block.pixels)
+		{
+			float value = pixel[channel];
+			writer.Write(Nearest(&value, palette, 1), 3);
+		}
+	}
+
+	// BC7 mode 6: one subset of RGBA endpoints with 7 bits per channel plus a p-bit each, and 4 bit indices, 16 bytes
+	inline void EncodeBC7(const Block& block, byte* out)
+	{
+		static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		float endpoints[2][4];
+		FitLine(block, 4, endpoints[0], endpoints[1]);
+
+		// Quantize to 7 bits, with whichever p-bit lands closer
+		uint32_t quantized[2][4];
+		uint32_t pbits[2];
+		for (unsigned int e = 0; e < 2; e++)
+		{
+			float bestError = FLT_MAX;
+			for (uint32_t pbit = 0; pbit < 2; pbit++)
+			{
+				uint32_t candidate[4];
+				float error = 0.0f;
+				for (unsigned int c = 0; c < 4; c++)
+				{
+					candidate[c]		= (uint32_t)min(max(lround((endpoints[e][c] - pbit) / 2.0f), 0l), 127l);
+					float reconstructed	= (float)((candidate[c] << 1) | pbit);
+					error				+= (reconstructed - endpoints[e][c]) * (reconstructed - endpoints[e][c]);
+				}
+
+				if (error < bestError)
+				{
+					bestError	= error;
+					pbits[e]	= pbit;
+					copy(begin(candidate), end(candidate), quantized[e]);
+				}
+			}
+		}
+
+		float palette[16][4];
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			for (unsigned int c = 0; c < 4; c++)
+			{
+				uint32_t value0 = (quantized[0][c] << 1) | pbits[0];
+				uint32_t value1 = (quantized[1][c] << 1) | pbits[1];
+				palette[i][c]	= (float)(((64 - weights[i]) * value0 + weights[i] * value1 + 32) >> 6);
+			}
+		}
+
+		uint32_t indices[16];
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			indices[i] = Nearest(block.pixels[i], palette, 4);
+		}
+
+		// The first pixel's index is stored without its top bit, so it has to be in the lower half
+		if (indices[0] & 8)
+		{
+			swap(quantized[0], quantized[1]);
+			swap(pbits[0], pbits[1]);
+			for (auto& index : indices) { index = 15 - index; }
+		}
+
+		BitWriter writer(out);
+		writer.Write(1 << 6, 7);
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			writer.Write(quantized[0][c], 7);
+			writer.Write(quantized[1][c], 7);
+		}
+		writer.Write(pbits[0], 1);
+		writer.Write(pbits[1], 1);
+		writer.Write(indices[0], 3);
+		for (unsigned int i = 1; i < 16; i++)
+		{
+			writer.Write(indices[i], 4);
+		}
+	}
+}
+
+namespace Directus
+{
+	bool BlockCompression::Compress(const vector<byte>& rgba, unsigned int width, unsigned int height, Texture_Format format, vector<byte>* blocks)
+	{
+		if (!blocks || width == 0 || height == 0 || rgba.size() < (size_t)width * height * 4)
+		{
+			LOG_ERROR("BlockCompression::Compress: Invalid parameters");
+			return false;
+		}
+
+		if (format < Texture_Format_BC1_UNORM || format > Texture_Format_BC7_UNORM)
+		{
+			LOG_ERROR("BlockCompression::Compress: Not a block compressed format");
+			return false;
+		}
+
+		unsigned int blocksX	= (width + 3) / 4;
+		unsigned int blocksY	= (height + 3) / 4;
+		unsigned int blockSize	= format == Texture_Format_BC1_UNORM ? 8 : 16;
+		blocks->assign((size_t)blocksX * blocksY * blockSize, (byte)0);
+
+		_BlockCompression::Block block;
+		for (unsigned int y = 0; y < blocksY; y++)
+		{
+			for (unsigned int x = 0; x < blocksX; x++)
+			{
+				_BlockCompression::Fetch(rgba.data(), width, height, x, y, &block);
+				auto out = &(*blocks)[((size_t)y * blocksX + x) * blockSize];
+
+				switch (format)
+				{
+				case Texture_Format_BC1_UNORM:
+					_BlockCompression::EncodeColor(block, out);
+					break;
+
+				case Texture_Format_BC3_UNORM:
+					_BlockCompression::EncodeChannel(block, 3, out);
+					_BlockCompression::EncodeColor(block, out + 8);
+					break;
+
+				case Texture_Format_BC5_UNORM:
+					_BlockCompression::EncodeChannel(block, 0, out);
+					_BlockCompression::EncodeChannel(block, 1, out + 8);
+					break;
+
+				default:
+					_BlockCompression::EncodeBC7(block, out);
+					break;
+				}
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,40 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+//===================================
+
+namespace Directus
+{
+	// Encoders for the block compressed texture formats, 4x4 pixels at a time. They favour import speed over quality:
+	// endpoints are fitted along the principal axis of each block's colors, and BC7 only uses mode 6 (one subset, RGBA).
+	class ENGINE_CLASS BlockCompression
+	{
+	public:
+		// Compresses tightly packed RGBA8 pixels, edge blocks which stick out of the image repeat its last row/column
+		static bool Compress(const std::vector<std::byte>& rgba, unsigned int width, unsigned int height, Texture_Format format, std::vector<std::byte>* blocks);
+	};
+}
@@ -21,12 +21,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include "FontImporter.h"
+#include <fstream>
+#include <atomic>
 #include "ft2build.h"
 #include FT_FREETYPE_H 
+#include "../ResourceManager.h"
 #include "../../Logging/Log.h"
 #include "../../Math/MathHelper.h"
 #include "../../Core/Settings.h"
-//================================
+#include "../../IO/FileStream.h"
+#include "../../FileSystem/FileSystem.h"
+#include "../../Threading/Threading.h"
+//======================================
 
 //= NAMESPACES ========================
 using namespace std;
@@ -34,15 +40,26 @@ using namespace Directus::Math;
 using namespace Helper;
 //=====================================
 
-// A minimum size for a texture holding all visible ASCII characters
-#define GLYPH_START 32
-#define GLYPH_END 127
 #define ATLAS_MAX_WIDTH 512
+#define GLYPH_BATCH_SIZE 32 // characters a task rasterizes, at least
 
 namespace Directus
 {
 	FT_Library m_library;
 
+	namespace _FontImporter
+	{
+		// Rasterized when the font loads (all visible ASCII characters), anything else is added when some text needs it
+		static const pair<unsigned int, unsigned int> preloadedRanges[] =
+		{
+			{ 32, 127 }
+		};
+
+		static const FT_Int32 loadMode = FT_LOAD_DEFAULT | FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_NO_HINTING | FT_LOAD_TARGET_LIGHT;
+
+		static mutex libraryMutex;
+	}
+
 	FontImporter::FontImporter(Context* context)
 	{
 		m_context = context;
@@ -100,149 +117,354 @@ namespace Directus
 	//              |------------- advanceX ----------->|
 
 
-	bool FontImporter::LoadFromFile(const string& filePath, int size, vector<std::byte>& atlasBuffer, unsigned int& atlasWidth, unsigned int& atlasHeight, map<unsigned int, Glyph>& glyphs)
+	struct FontImporter::RasterizedGlyph
 	{
-		FT_Face face;
+		unsigned int character	= 0;
+		unsigned int width		= 0;
+		unsigned int rows		= 0;
+		int top					= 0;
+		int horizontalOffset	= 0;
+		vector<std::byte> bitmap; // tightly packed rows
+	};
+
+	bool FontImporter::LoadFromFile(const string& filePath, int size, FontAtlas* atlas)
+	{
+		if (!atlas)
+			return false;
+
+		*atlas = FontAtlas();
+
+		// An atlas imported before (same font content, size and character ranges) is read from the file that import wrote
+		size_t settings = hash<int>()(size);
+		for (const auto& range : _FontImporter::preloadedRanges)
+		{
+			settings ^= (hash<unsigned int>()(range.first) << 1) ^ (hash<unsigned int>()(range.second) << 2);
+		}
+		auto ddc			= m_context->GetSubsystem<ResourceManager>()->GetDerivedDataCache();
+		string key			= ddc ? ddc->GetKey(filePath, "Font", GetVersion(), settings) : "";
+		string nativePath	= FileSystem::GetFilePathWithoutExtension(filePath) + "_" + to_string(size) + EXTENSION_FONT_ATLAS;
+		if (!key.empty())
+		{
+			if (Cache_Load(nativePath, key, atlas))
+				return true;
+
+			if (ddc->Fetch(key, nativePath) && Cache_Load(nativePath, key, atlas))
+				return true;
+		}
+
+		vector<unsigned int> characters;
+		for (const auto& range : _FontImporter::preloadedRanges)
+		{
+			for (unsigned int i = range.first; i < range.second; i++)
+			{
+				characters.emplace_back(i);
+			}
+		}
+
+		vector<RasterizedGlyph> rasterized;
+		if (!Rasterize(filePath, size, characters, &rasterized))
+			return false;
+
+		// Descents are measured from the tallest of them, glyphs that are added later hang from the same line
+		for (const auto& glyph : rasterized)
+		{
+			atlas->rowHeight = Max<unsigned int>(atlas->rowHeight, glyph.rows);
+		}
+		Pack(rasterized, atlas);
 
-		// Load font
-		if (HandleError(FT_New_Face(m_library, filePath.c_str(), 0, &face)))
+		if (atlas->width > 8192 || atlas->height > 8192)
 		{
-			FT_Done_Face(face);
+			LOG_ERROR("FontImporter: The resulting font texture atlas is too large (" + to_string(atlas->width) + "x" + to_string(atlas->height) + "). Try using a smaller font size.");
+			*atlas = FontAtlas();
 			return false;
 		}
 
-		// Set size
-		int height = size;
-		if (HandleError(FT_Set_Char_Size(face, 0, height << 6, 96, 96)))
+		if (!key.empty() && Cache_Save(nativePath, key, *atlas))
 		{
-			FT_Done_Face(face);
+			ddc->Store(key, nativePath);
+		}
+
+		return true;
+	}
+
+	bool FontImporter::AddGlyphs(const string& filePath, int fontSize, const vector<unsigned int>& characters, FontAtlas* atlas)
+	{
+		if (!atlas || atlas->width == 0)
 			return false;
+
+		vector<unsigned int> missing;
+		for (auto character : characters)
+		{
+			if (atlas->glyphs.find(character) == atlas->glyphs.end() && find(missing.begin(), missing.end(), character) == missing.end())
+			{
+				missing.emplace_back(character);
+			}
 		}
 
-		// Try to estimate the size of the font atlas texture
-		unsigned int rowHeight = 0;
-		ComputeAtlasTextureDimensions(face, atlasWidth, atlasHeight, rowHeight);
+		if (missing.empty())
+			return false;
+
+		vector<RasterizedGlyph> rasterized;
+		if (!Rasterize(filePath, fontSize, missing, &rasterized))
+			return false;
+
+		Pack(rasterized, atlas);
+		return true;
+	}
 
-		if (atlasWidth > 8192 || atlasHeight > 8192)
+	bool FontImporter::Rasterize(const string& filePath, int fontSize, const vector<unsigned int>& characters, vector<RasterizedGlyph>* rasterized)
+	{
+		// Read once, every task creates it's own face from the same memory (faces can't be shared between threads)
+		ifstream in(filePath, ios::in | ios::binary);
+		if (in.fail())
 		{
-			LOG_ERROR("FontImporter: The resulting font texture atlas is too large (" + to_string(atlasWidth) + "x" + to_string(atlasHeight) + "). Try using a smaller font size.");
+			LOGF_ERROR("FontImporter::Rasterize: Failed to open \"%s\"", filePath.c_str());
 			return false;
 		}
+		vector<FT_Byte> fontData((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+		in.close();
 
-		// Go through each glyph and create a texture atlas
-		atlasBuffer.resize(atlasWidth * atlasHeight);
-		int penX = 0, penY = 0;
-		for (unsigned int i = GLYPH_START; i < GLYPH_END; i++)
+		rasterized->clear();
+		rasterized->resize(characters.size());
+
+		auto threading		= m_context->GetSubsystem<Threading>();
+		auto batchSize		= Max<size_t>(GLYPH_BATCH_SIZE, characters.size() / (threading->GetThreadCount() + 1) + 1);
+		atomic<bool> failed(false);
+		vector<JobHandle> batches;
+		for (size_t start = 0; start < characters.size(); start += batchSize)
 		{
-			FT_UInt32 loadMode_ = 0;
-			loadMode_ |= FT_LOAD_DEFAULT;
-			loadMode_ |= FT_LOAD_RENDER;
-			loadMode_ |= FT_LOAD_FORCE_AUTOHINT;
-			loadMode_ |= FT_LOAD_NO_HINTING;
-			loadMode_ |= FT_LOAD_TARGET_LIGHT;
-
-			if (HandleError(FT_Load_Char(face, i, loadMode_)))
+			size_t end = Min<size_t>(start + batchSize, characters.size());
+			batches.emplace_back(threading->Job_Add([this, &fontData, &characters, &failed, rasterized, fontSize, start, end]()
 			{
-				// Free memory
-				FT_Done_Face(face);
-				return false;
-			}
+				FT_Face face = nullptr;
+				FT_Error error;
+				{
+					// Creating and destroying faces modifies the library
+					lock_guard<mutex> lock(_FontImporter::libraryMutex);
+					error = FT_New_Memory_Face(m_library, fontData.data(), (FT_Long)fontData.size(), 0, &face);
+				}
 
-			FT_Bitmap* bitmap = &face->glyph->bitmap;
-			if (penX + bitmap->width >= atlasWidth)
+				if (!HandleError(error) && !HandleError(FT_Set_Char_Size(face, 0, fontSize << 6, 96, 96)))
+				{
+					for (size_t i = start; i < end; i++)
+					{
+						auto& glyph		= (*rasterized)[i];
+						glyph.character	= characters[i];
+
+						// A character that fails gets an empty glyph, so it isn't tried again
+						if (HandleError(FT_Load_Char(face, glyph.character, _FontImporter::loadMode)))
+							continue;
+
+						FT_Bitmap* bitmap		= &face->glyph->bitmap;
+						glyph.width				= bitmap->width;
+						glyph.rows				= bitmap->rows;
+						glyph.top				= face->glyph->bitmap_top;
+						glyph.horizontalOffset	= face->glyph->advance.x >> 6;
+						// Kerning is the process of adjusting the position of two subsequent glyph images 
+						// in a string of text in order to improve the general appearance of text. 
+						// For example, if a glyph for an uppercase ‘A’ is followed by a glyph for an 
+						// uppercase ‘V’, the space between the two glyphs can be slightly reduced to 
+						// avoid extra ‘diagonal whitespace’.
+						if (glyph.character >= 1 && FT_HAS_KERNING(face))
+						{
+							FT_Vector kerningVec;
+							FT_Get_Kerning(face, glyph.character - 1, glyph.character, FT_KERNING_DEFAULT, &kerningVec);
+							glyph.horizontalOffset += kerningVec.x >> 6;
+						}
+						// horizontal distance from the current cursor position to the leftmost border of the glyph image's bounding box.
+						glyph.horizontalOffset += face->glyph->metrics.horiBearingX;
+
+						glyph.bitmap.resize(glyph.width * glyph.rows);
+						auto bytes = (std::byte*)bitmap->buffer;
+						for (unsigned int row = 0; row < glyph.rows; row++)
+						{
+							memcpy(&glyph.bitmap[row * glyph.width], &bytes[row * bitmap->pitch], glyph.width);
+						}
+					}
+				}
+				else
+				{
+					failed = true;
+				}
+
+				if (face)
+				{
+					lock_guard<mutex> lock(_FontImporter::libraryMutex);
+					FT_Done_Face(face);
+				}
+			}));
+		}
+
+		// Help out instead of just waiting, the queue might be longer than the thread pool
+		threading->Job_Wait(threading->Job_Group(batches));
+
+		return !failed;
+	}
+
+	void FontImporter::Pack(const vector<RasterizedGlyph>& rasterized, FontAtlas* atlas)
+	{
+		// Place them first, to know how many rows the atlas needs
+		vector<pair<unsigned int, unsigned int>> positions;
+		positions.reserve(rasterized.size());
+		unsigned int width		= atlas->width != 0 ? atlas->width : ATLAS_MAX_WIDTH;
+		unsigned int penX		= atlas->penX;
+		unsigned int penY		= atlas->penY;
+		unsigned int rowBottom	= atlas->penRowBottom;
+		for (const auto& glyph : rasterized)
+		{
+			if (penX != 0 && penX + glyph.width >= width)
 			{
 				penX = 0;
-				penY += rowHeight;
+				penY = Max<unsigned int>(penY + atlas->rowHeight, rowBottom);
 			}
+			positions.emplace_back(penX, penY);
+			rowBottom	= Max<unsigned int>(rowBottom, penY + glyph.rows);
+			penX		+= glyph.width + 1;
+		}
+
+		// Rows are appended, so what's already in the atlas stays where it is, only the vertical uvs change
+		unsigned int height = Max<unsigned int>(atlas->height, rowBottom);
+		if (height > atlas->height && atlas->height != 0)
+		{
+			height = Max<unsigned int>(height, atlas->height * 2);
+		}
+		if (height != atlas->height || width != atlas->width)
+		{
+			atlas->buffer.resize(width * height);
+			for (auto& glyph : atlas->glyphs)
+			{
+				glyph.second.uvYTop		= (float)glyph.second.yTop / (float)height;
+				glyph.second.uvYBottom	= (float)glyph.second.yBottom / (float)height;
+			}
+			atlas->width	= width;
+			atlas->height	= height;
+		}
 
-			auto bytes	= (byte*)bitmap->buffer;
-			int	pitch	= bitmap->pitch;
-			for (unsigned int row = 0; row < bitmap->rows; row++)
+		for (size_t i = 0; i < rasterized.size(); i++)
+		{
+			const auto& source	= rasterized[i];
+			auto x				= positions[i].first;
+			auto y				= positions[i].second;
+			auto columns		= Min<unsigned int>(source.width, width - x); // wider than the atlas
+			for (unsigned int row = 0; row < source.rows; row++)
 			{
-				for (unsigned int col = 0; col < bitmap->width; col++)
+				if (columns != 0)
 				{
-					int x = penX + col;
-					int y = penY + row;
-					atlasBuffer[y * atlasWidth + x] = bytes[row * pitch + col];
+					memcpy(&atlas->buffer[(y + row) * width + x], &source.bitmap[row * source.width], columns);
 				}
 			}
 
 			// Save glyph info
 			Glyph glyph;
-			glyph.xLeft = penX;
-			glyph.yTop = penY;
-			glyph.xRight = penX + bitmap->width;
-			glyph.yBottom = penY + bitmap->rows;
-			glyph.width = glyph.xRight - glyph.xLeft;
-			glyph.height = glyph.yBottom - glyph.yTop;
-			glyph.uvXLeft = (float)glyph.xLeft / (float)atlasWidth;
-			glyph.uvXRight = (float)glyph.xRight / (float)atlasWidth;
-			glyph.uvYTop = (float)glyph.yTop / (float)atlasHeight;
-			glyph.uvYBottom = (float)glyph.yBottom / (float)atlasHeight;
-			glyph.descent = rowHeight - face->glyph->bitmap_top;
-			glyph.horizontalOffset = face->glyph->advance.x >> 6;
-			// Kerning is the process of adjusting the position of two subsequent glyph images 
-			// in a string of text in order to improve the general appearance of text. 
-			// For example, if a glyph for an uppercase ‘A’ is followed by a glyph for an 
-			// uppercase ‘V’, the space between the two glyphs can be slightly reduced to 
-			// avoid extra ‘diagonal whitespace’.
-			if (i >= 1 && FT_HAS_KERNING(face))
-			{
-				FT_Vector kerningVec;
-				FT_Get_Kerning(face, i - 1, i, FT_KERNING_DEFAULT, &kerningVec);
-				glyph.horizontalOffset += kerningVec.x >> 6;
-			}
-			// horizontal distance from the current cursor position to the leftmost border of the glyph image's bounding box.
-			glyph.horizontalOffset += face->glyph->metrics.horiBearingX;
-
-			glyphs[i] = (glyph);
-
-			penX += bitmap->width + 1;
+			glyph.xLeft				= x;
+			glyph.yTop				= y;
+			glyph.xRight			= x + columns;
+			glyph.yBottom			= y + source.rows;
+			glyph.width				= glyph.xRight - glyph.xLeft;
+			glyph.height			= glyph.yBottom - glyph.yTop;
+			glyph.uvXLeft			= (float)glyph.xLeft / (float)width;
+			glyph.uvXRight			= (float)glyph.xRight / (float)width;
+			glyph.uvYTop			= (float)glyph.yTop / (float)height;
+			glyph.uvYBottom			= (float)glyph.yBottom / (float)height;
+			glyph.descent			= (int)atlas->rowHeight - source.top;
+			glyph.horizontalOffset	= source.horizontalOffset;
+			atlas->glyphs[source.character] = glyph;
 		}
 
-		// Free memory
-		FT_Done_Face(face);
-
-		return true;
+		atlas->penX			= penX;
+		atlas->penY			= penY;
+		atlas->penRowBottom	= rowBottom;
 	}
 
-	void FontImporter::ComputeAtlasTextureDimensions(FT_FaceRec_* face, unsigned int& atlasWidth, unsigned int& atlasHeight, unsigned int& rowHeight)
+	bool FontImporter::Cache_Load(const string& filePath, const string& key, FontAtlas* atlas)
 	{
-		int penX = 0;
-		rowHeight = GetCharacterMaxHeight(face);
-		for (int i = GLYPH_START; i < GLYPH_END; i++)
-		{
-			if (HandleError(FT_Load_Char(face, i, FT_LOAD_RENDER | FT_LOAD_TARGET_LIGHT))) { continue; }
+		if (!FileSystem::FileExists(filePath))
+			return false;
+
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Read);
+		if (!file->IsOpen())
+			return false;
 
-			FT_Bitmap* bitmap = &face->glyph->bitmap;
+		// Written for other content, size or ranges
+		string fileKey;
+		file->Read(&fileKey);
+		if (fileKey != key)
+			return false;
 
-			penX += bitmap->width + 1;
-			atlasHeight = Max<int>(atlasHeight, bitmap->rows);
+		file->Read(&atlas->width);
+		file->Read(&atlas->height);
+		file->Read(&atlas->rowHeight);
+		file->Read(&atlas->penX);
+		file->Read(&atlas->penY);
+		file->Read(&atlas->penRowBottom);
 
-			// If the pen is about to exceed ATLAS_MAX_WIDTH 
-			// we have to switch row. Hence, the height of the
-			// texture atlas must increase to fit that row.
-			if (penX + bitmap->width >= ATLAS_MAX_WIDTH)
-			{
-				penX = 0;
-				atlasHeight += rowHeight;
-				atlasWidth = ATLAS_MAX_WIDTH;
-			}
+		auto glyphCount = file->ReadUInt();
+		for (unsigned int i = 0; i < glyphCount; i++)
+		{
+			auto character	= file->ReadUInt();
+			Glyph& glyph	= atlas->glyphs[character];
+			file->Read(&glyph.xLeft);
+			file->Read(&glyph.xRight);
+			file->Read(&glyph.yTop);
+			file->Read(&glyph.yBottom);
+			file->Read(&glyph.width);
+			file->Read(&glyph.height);
+			file->Read(&glyph.uvXLeft);
+			file->Read(&glyph.uvXRight);
+			file->Read(&glyph.uvYTop);
+			file->Read(&glyph.uvYBottom);
+			file->Read(&glyph.descent);
+			file->Read(&glyph.horizontalOffset);
 		}
+		file->Read(&atlas->buffer);
+
+		// Truncated
+		if (atlas->buffer.size() != (size_t)atlas->width * atlas->height)
+		{
+			*atlas = FontAtlas();
+			return false;
+		}
+
+		return true;
 	}
 
-	int FontImporter::GetCharacterMaxHeight(FT_FaceRec_* face)
+	bool FontImporter::Cache_Save(const string& filePath, const string& key, const FontAtlas& atlas)
 	{
-		int maxHeight = 0;
-		for (int i = GLYPH_START; i < GLYPH_END; i++)
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Write);
+		if (!file->IsOpen())
 		{
-			if (HandleError(FT_Load_Char(face, i, FT_LOAD_RENDER))) { continue; }
+			LOGF_WARNING("FontImporter::Cache_Save: Failed to write \"%s\"", filePath.c_str());
+			return false;
+		}
+
+		file->Write(key);
+		file->Write(atlas.width);
+		file->Write(atlas.height);
+		file->Write(atlas.rowHeight);
+		file->Write(atlas.penX);
+		file->Write(atlas.penY);
+		file->Write(atlas.penRowBottom);
 
-			FT_Bitmap* bitmap = &face->glyph->bitmap;
-			maxHeight = Max<int>(maxHeight, bitmap->rows);
+		file->Write((unsigned int)atlas.glyphs.size());
+		for (const auto& glyph : atlas.glyphs)
+		{
+			file->Write(glyph.first);
+			file->Write(glyph.second.xLeft);
+			file->Write(glyph.second.xRight);
+			file->Write(glyph.second.yTop);
+			file->Write(glyph.second.yBottom);
+			file->Write(glyph.second.width);
+			file->Write(glyph.second.height);
+			file->Write(glyph.second.uvXLeft);
+			file->Write(glyph.second.uvXRight);
+			file->Write(glyph.second.uvYTop);
+			file->Write(glyph.second.uvYBottom);
+			file->Write(glyph.second.descent);
+			file->Write(glyph.second.horizontalOffset);
 		}
+		file->Write(atlas.buffer);
 
-		return maxHeight;
+		return true;
 	}
 
 	bool FontImporter::HandleError(int errorCode)
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Core/EngineDefs.h"
 #include <vector>
 #include <map>
+#include <string>
 //================================
 
 struct FT_FaceRec_;
@@ -49,6 +50,19 @@ namespace Directus
 		int horizontalOffset;
 	};
 
+	// A single channel texture with the glyphs of a font (at a size) packed in rows
+	struct FontAtlas
+	{
+		std::vector<std::byte> buffer;
+		unsigned int width		= 0;
+		unsigned int height		= 0;
+		unsigned int rowHeight	= 0; // the tallest preloaded glyph, descents are relative to it
+		unsigned int penX		= 0; // where the next glyph goes
+		unsigned int penY		= 0;
+		unsigned int penRowBottom	= 0; // the lowest pixel of the row the pen is on
+		std::map<unsigned int, Glyph> glyphs;
+	};
+
 	class ENGINE_CLASS FontImporter
 	{
 	public:
@@ -56,11 +70,19 @@ namespace Directus
 		~FontImporter();
 
 		void Initialize();
-		bool LoadFromFile(const std::string& filePath, int fontSize, std::vector<std::byte>& atlasBuffer, unsigned int& atlasWidth, unsigned int& atlasHeight, std::map<unsigned int, Glyph>& characterInfo);
+		// Creates an atlas with the preloaded character ranges, it's read from a previous import if there is one
+		bool LoadFromFile(const std::string& filePath, int fontSize, FontAtlas* atlas);
+		// Rasterizes characters the atlas doesn't have yet (e.g. CJK), the atlas grows if they don't fit
+		bool AddGlyphs(const std::string& filePath, int fontSize, const std::vector<unsigned int>& characters, FontAtlas* atlas);
+		// Has to change whenever what an import produces does, so that atlases from before aren't used
+		static unsigned int GetVersion() { return 1; }
 
 	private:
-		void ComputeAtlasTextureDimensions(FT_FaceRec_* face, unsigned int& atlasWidth, unsigned int& atlasHeight, unsigned int& rowHeight);
-		int GetCharacterMaxHeight(FT_FaceRec_* face);
+		struct RasterizedGlyph;
+		bool Rasterize(const std::string& filePath, int fontSize, const std::vector<unsigned int>& characters, std::vector<RasterizedGlyph>* rasterized);
+		void Pack(const std::vector<RasterizedGlyph>& rasterized, FontAtlas* atlas);
+		bool Cache_Load(const std::string& filePath, const std::string& key, FontAtlas* atlas);
+		bool Cache_Save(const std::string& filePath, const std::string& key, const FontAtlas& atlas);
 		bool HandleError(int errorCode);
 
 		Context* m_context;
@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Core/Settings.h"
 #include "../../RHI/RHI_Texture.h"
 #include "../../Math/MathHelper.h"
+#include "BlockCompression.h"
 //====================================
 
 //= NAMESPACES =====
@@ -46,7 +47,6 @@ namespace _ImagImporter
 		unsigned int height		= 0;
 		unsigned int channels	= 0;
 		vector<byte>* data		= nullptr;
-		bool done				= false;
 
 		RescaleJob(unsigned int width, unsigned int height, unsigned int channels)
 		{
@@ -55,6 +55,23 @@ namespace _ImagImporter
 			this->channels	= channels;
 		}
 	};
+
+	// A struct that block compression threads will work with
+	struct CompressJob
+	{
+		unsigned int width	= 0;
+		unsigned int height	= 0;
+		vector<byte>* data	= nullptr;
+		vector<byte> blocks;
+		bool result			= false;
+
+		CompressJob(unsigned int width, unsigned int height, vector<byte>* data)
+		{
+			this->width		= width;
+			this->height	= height;
+			this->data		= data;
+		}
+	};
 }
 
 namespace Directus
@@ -128,12 +145,19 @@ namespace Directus
 		auto mip = texture->Data_AddMipMap();
 		GetBitsFromFIBITMAP(mip, bitmap, image_width, image_height, image_channels);
 
-		// If the texture requires mip-maps, generate them
-		if (texture->IsUsingMimmaps())
+		// If the texture requires mip-maps, generate them, on the GPU if there is one
+		// (it keeps them until the bits are needed), on the CPU otherwise
+		if (texture->IsUsingMimmaps() && !texture->ShaderResource_GenerateMips(image_width, image_height, image_channels))
 		{
 			GenerateMipmaps(bitmap, texture, image_width, image_height, image_channels);
 		}
 
+		// If the texture asks for a block compressed format, encode the mip chain
+		if (RHI_Texture::Format_IsCompressed(texture->GetCompression()))
+		{
+			CompressMipmaps(texture, image_width, image_height);
+		}
+
 		// Free memory 
 		FreeImage_Unload(bitmap);
 
@@ -148,6 +172,56 @@ namespace Directus
 		return true;
 	}
 
+	bool ImageImporter::LoadHeights(const string& filePath, vector<float>* heights, unsigned int* width, unsigned int* height)
+	{
+		if (!heights || !width || !height)
+			return false;
+
+		if (!FileSystem::FileExists(filePath))
+		{
+			LOGF_ERROR("ImageImporter::LoadHeights: Cant' load image. File path \"%s\" is invalid.", filePath.c_str());
+			return false;
+		}
+
+		FREE_IMAGE_FORMAT format = FreeImage_GetFileType(filePath.c_str(), 0);
+		format = (format == FIF_UNKNOWN) ? FreeImage_GetFIFFromFilename(filePath.c_str()) : format;
+		if (!FreeImage_FIFSupportsReading(format))
+		{
+			LOGF_ERROR("ImageImporter::LoadHeights: Failed to detect the image format of \"%s\".", filePath.c_str());
+			return false;
+		}
+
+		FIBITMAP* bitmap = FreeImage_Load(format, filePath.c_str());
+		if (!bitmap)
+		{
+			LOGF_ERROR("ImageImporter::LoadHeights: Failed to load \"%s\".", filePath.c_str());
+			return false;
+		}
+
+		// Greyscale floats, whatever the source (8 or 16 bits per channel, with or without colors)
+		FIBITMAP* bitmapFloat = FreeImage_ConvertToFloat(bitmap);
+		FreeImage_Unload(bitmap);
+		if (!bitmapFloat)
+		{
+			LOGF_ERROR("ImageImporter::LoadHeights: Failed to convert \"%s\" to greyscale.", filePath.c_str());
+			return false;
+		}
+
+		*width	= FreeImage_GetWidth(bitmapFloat);
+		*height	= FreeImage_GetHeight(bitmapFloat);
+		heights->resize((size_t)*width * *height);
+
+		// FreeImage stores the bottom row first too
+		for (unsigned int y = 0; y < *height; y++)
+		{
+			auto row = (const float*)FreeImage_GetScanLine(bitmapFloat, y);
+			memcpy(&(*heights)[(size_t)y * *width], row, *width * sizeof(float));
+		}
+
+		FreeImage_Unload(bitmapFloat);
+		return true;
+	}
+
 	bool ImageImporter::GetBitsFromFIBITMAP(vector<byte>* data, FIBITMAP* bitmap, unsigned int width, unsigned int height, unsigned int channels)
 	{
 		if (!data || width == 0 || height == 0 || channels == 0)
@@ -201,9 +275,10 @@ namespace Directus
 
 		// Parallelize mipmap generation using multiple threads (because FreeImage_Rescale() using FILTER_LANCZOS3 is expensive)
 		auto threading = m_context->GetSubsystem<Threading>();
+		vector<JobHandle> rescaled;
 		for (auto& job : jobs)
 		{
-			threading->AddTask([this, &job, &bitmap]()
+			rescaled.emplace_back(threading->Job_Add([this, &job, &bitmap]()
 			{
 				FIBITMAP* bitmapScaled = FreeImage_Rescale(bitmap, job.width, job.height, _ImagImporter::rescaleFilter);
 				if (!GetBitsFromFIBITMAP(job.data, bitmapScaled, job.width, job.height, job.channels))
@@ -211,23 +286,64 @@ namespace Directus
 					LOGF_ERROR("ImageImporter:GenerateMipmapsFromFIBITMAP: Failed to create mip level %dx%d", job.width, job.height);
 				}
 				FreeImage_Unload(bitmapScaled);
-				job.done = true;
-			});
+			}));
+		}
+
+		// Wait until all mipmaps have been generated, running queued tasks (possibly these) meanwhile
+		threading->Job_Wait(threading->Job_Group(rescaled));
+	}
+
+	void ImageImporter::CompressMipmaps(RHI_Texture* texture, unsigned int width, unsigned int height)
+	{
+		if (!texture)
+			return;
+
+		// Block compressed textures need a full mip chain and a top mip made of whole blocks
+		if (!texture->IsUsingMimmaps() || width % 4 != 0 || height % 4 != 0)
+		{
+			LOGF_WARNING("ImageImporter::CompressMipmaps: A %dx%d image can't be block compressed, it will remain uncompressed", width, height);
+			return;
 		}
 
-		// Wait until all mipmaps have been generated
-		bool ready = false;
-		while (!ready)
+		// Create a CompressJob for every mip
+		vector<_ImagImporter::CompressJob> jobs;
+		for (unsigned int i = 0; i < (unsigned int)texture->Data_Get().size(); i++)
 		{
-			ready = true;
-			for (const auto& job : jobs)
+			jobs.emplace_back(width, height, texture->Data_GetMip(i));
+			width	= Math::Helper::Max(width / 2, (unsigned int)1);
+			height	= Math::Helper::Max(height / 2, (unsigned int)1);
+		}
+
+		// Parallelize compression using multiple threads, one per mip
+		auto threading		= m_context->GetSubsystem<Threading>();
+		auto compression	= texture->GetCompression();
+		vector<JobHandle> compressed;
+		for (auto& job : jobs)
+		{
+			compressed.emplace_back(threading->Job_Add([&job, compression]()
 			{
-				if (!job.done)
-				{
-					ready = false;
-				}
+				job.result = BlockCompression::Compress(*job.data, job.width, job.height, compression, &job.blocks);
+			}));
+		}
+
+		// Wait until all mipmaps have been compressed, running queued tasks (possibly these) meanwhile
+		threading->Job_Wait(threading->Job_Group(compressed));
+
+		// Only swap the data in if every mip made it, so the format is consistent across the chain
+		for (const auto& job : jobs)
+		{
+			if (!job.result)
+			{
+				LOG_ERROR("ImageImporter::CompressMipmaps: Failed to compress mip chain, it will remain uncompressed");
+				return;
 			}
 		}
+
+		for (auto& job : jobs)
+		{
+			job.data->swap(job.blocks);
+		}
+		texture->SetFormat(compression);
 	}
 
 	bool ImageImporter::IsVisuallyGrayscale(FIBITMAP* bitmap)
@@ -77,10 +77,15 @@ namespace Directus
 		~ImageImporter();
 
 		bool Load(const std::string& filePath, RHI_Texture* texture);
+		// A greyscale version of the image in [0, 1], row major from the image's bottom row, 16-bit images keep their precision
+		bool LoadHeights(const std::string& filePath, std::vector<float>* heights, unsigned int* width, unsigned int* height);
+		// Has to change whenever what an import produces does, so that derived data from before isn't used
+		static unsigned int GetVersion() { return 2; }
 
 	private:	
 		bool GetBitsFromFIBITMAP(std::vector<std::byte>* data, FIBITMAP* bitmap, unsigned int width, unsigned int height, unsigned int channels);
 		void GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, unsigned int width, unsigned int height, unsigned int channels);
+		void CompressMipmaps(RHI_Texture* texture, unsigned int width, unsigned int height);
 
 		bool IsVisuallyGrayscale(FIBITMAP* bitmap);
 		FIBITMAP* ApplyBitmapCorrections(FIBITMAP* bitmap);
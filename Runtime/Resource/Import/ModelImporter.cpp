@@ -30,8 +30,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Rendering/Model.h"
 #include "../../Rendering/Animation.h"
 #include "../../Rendering/Material.h"
+#include "../../Rendering/GeometryUtility.h"
+#include "../../RHI/RHI_Vertex.h"
 #include "../../World/Components/Renderable.h"
 #include "../ProgressReport.h"
+#include "../../Threading/Threading.h"
+#include <future>
+#include <unordered_set>
+#include <unordered_map>
 //============================================
 
 //= NAMESPACES ================
@@ -40,51 +46,70 @@ using namespace Directus::Math;
 using namespace Assimp;
 //=============================
 
+#define AABB_VERTICES_PER_TASK	65536	// a mesh with more vertices than that gets bounded a piece at a time, in parallel
+#define ANIMATION_ERROR			0.0002f	// how far compressing animations may move the skin, as a fraction of the skeleton's size
+#define ANIMATION_REACH_MIN		0.05f	// the skin a bone without any below it carries is taken to be this far (a fraction of the skeleton's size too)
+
 // Implement Assimp::ProgressHandler so the engine can track the loading/proccesing progress
 class _ProgressHandler : public ProgressHandler
 {
 public:
-	_ProgressHandler(const string& filePath)
+	_ProgressHandler(const string& filePath, int progressID)
 	{
-		m_filePath = filePath;
-		m_fileName = Directus::FileSystem::GetFileNameFromFilePath(filePath);
+		m_filePath		= filePath;
+		m_fileName		= Directus::FileSystem::GetFileNameFromFilePath(filePath);
+		m_progressID	= progressID;
 
 		// Start progress tracking
 		Directus::ProgressReport& progress = Directus::ProgressReport::Get();
-		progress.Reset(Directus::g_progress_ModelImporter);
-		progress.SetIsLoading(Directus::g_progress_ModelImporter, true);
+		progress.Reset(m_progressID);
+		progress.SetIsLoading(m_progressID, true);
 	}
 
 	~_ProgressHandler() 
 	{
-		Directus::ProgressReport::Get().SetIsLoading(Directus::g_progress_ModelImporter, false);
+		Directus::ProgressReport::Get().SetIsLoading(m_progressID, false);
 	}
 
-	bool Update(float percentage) { return true; }
+	// Returning false asks Assimp to abort the read, Load() checks again once Assimp is done
+	bool Update(float percentage) override { return !Directus::ProgressReport::Get().Job_IsCancelled(m_progressID); }
 
 	void UpdateFileRead(int currentStep, int numberOfSteps) override
 	{
 		Directus::ProgressReport& progress = Directus::ProgressReport::Get();
-		progress.SetStatus(Directus::g_progress_ModelImporter, "Loading \"" + m_fileName + "\" from disk...");
-		progress.SetJobsDone(Directus::g_progress_ModelImporter, currentStep);
-		progress.SetJobCount(Directus::g_progress_ModelImporter, numberOfSteps);
+		progress.SetStatus(m_progressID, "Loading \"" + m_fileName + "\" from disk...");
+		progress.SetJobsDone(m_progressID, currentStep);
+		progress.SetJobCount(m_progressID, numberOfSteps);
 	}
 
 	void UpdatePostProcess(int currentStep, int numberOfSteps) override
 	{
 		Directus::ProgressReport& progress = Directus::ProgressReport::Get();
-		progress.SetStatus(Directus::g_progress_ModelImporter, "Post-Processing \"" + m_fileName + "\"");
-		progress.SetJobsDone(Directus::g_progress_ModelImporter, currentStep);
-		progress.SetJobCount(Directus::g_progress_ModelImporter, numberOfSteps);
+		progress.SetStatus(m_progressID, "Post-Processing \"" + m_fileName + "\"");
+		progress.SetJobsDone(m_progressID, currentStep);
+		progress.SetJobCount(m_progressID, numberOfSteps);
 	}
 
 private:
 	string m_filePath;
 	string m_fileName;
+	int m_progressID;
 };
 
 namespace Directus
 {
+	// Everything about an aiMesh that doesn't depend on the model or the world
+	struct ImportedMesh
+	{
+		std::vector<RHI_Vertex_PosUVTBN> vertices;
+		std::vector<unsigned int> indices;
+		std::vector<RHI_Vertex_Skin> weights; // empty unless skinned
+		BoundingBox aabb;
+		std::vector<ModelLod> lods;
+		std::vector<std::vector<unsigned int>> lodIndices;
+		std::vector<ModelCluster> clusters;
+	};
+
 	namespace _ModelImporter
 	{
 		// Things for Assimp to do
@@ -92,7 +117,6 @@ namespace Directus
 			aiProcess_CalcTangentSpace |
 			aiProcess_GenSmoothNormals |
 			aiProcess_JoinIdenticalVertices |
-			aiProcess_ImproveCacheLocality |
 			aiProcess_LimitBoneWeights |
 			aiProcess_SplitLargeMeshes |
 			aiProcess_Triangulate |
@@ -107,12 +131,59 @@ namespace Directus
 			aiProcess_ConvertToLeftHanded;
 
 		static float normalSmoothAngle = 90.0f; // Default is 45, max is 175
+
+		BoundingBox ComputeAabb(Threading* threading, const vector<RHI_Vertex_PosUVTBN>& vertices)
+		{
+			auto count = (unsigned int)vertices.size();
+			if (count <= AABB_VERTICES_PER_TASK)
+				return BoundingBox(vertices);
+
+			// A box per piece, merged after
+			vector<BoundingBox> boxes((count + AABB_VERTICES_PER_TASK - 1) / AABB_VERTICES_PER_TASK);
+			threading->Parallel_For(0, (unsigned int)boxes.size(), 1, [&vertices, &boxes, count](unsigned int start, unsigned int end)
+			{
+				for (unsigned int piece = start; piece < end; piece++)
+				{
+					Vector3 min = Vector3::Infinity;
+					Vector3 max = Vector3::InfinityNeg;
+					for (unsigned int i = piece * AABB_VERTICES_PER_TASK; i < Min((piece + 1) * AABB_VERTICES_PER_TASK, count); i++)
+					{
+						const auto& vertex = vertices[i];
+						min = Vector3(Min(min.x, vertex.pos[0]), Min(min.y, vertex.pos[1]), Min(min.z, vertex.pos[2]));
+						max = Vector3(Max(max.x, vertex.pos[0]), Max(max.y, vertex.pos[1]), Max(max.z, vertex.pos[2]));
+					}
+					boxes[piece] = BoundingBox(min, max);
+				}
+			});
+
+			BoundingBox aabb = boxes[0];
+			for (unsigned int i = 1; i < (unsigned int)boxes.size(); i++)
+			{
+				aabb.Merge(boxes[i]);
+			}
+			return aabb;
+		}
+
+		// The Assimp texture types a material reads and what the engine uses them as
+		static const pair<aiTextureType, TextureType> textureTypes[] =
+		{
+			{ aiTextureType_DIFFUSE,	TextureType_Albedo },
+			{ aiTextureType_SHININESS,	TextureType_Roughness },	// Specular as roughness
+			{ aiTextureType_AMBIENT,	TextureType_Metallic },		// Ambient as metallic
+			{ aiTextureType_NORMALS,	TextureType_Normal },
+			{ aiTextureType_LIGHTMAP,	TextureType_Occlusion },
+			{ aiTextureType_EMISSIVE,	TextureType_Emission },
+			{ aiTextureType_HEIGHT,		TextureType_Height },
+			{ aiTextureType_OPACITY,	TextureType_Mask }
+		};
 	}
 
 	ModelImporter::ModelImporter(Context* context)
 	{
 		m_context	= context;
-		m_model		= nullptr;
+		m_model			= nullptr;
+		m_meshes		= nullptr;
+		m_progressID	= g_progress_ModelImporter;
 
 		// Get version
 		int major	= aiGetVersionMajor();
@@ -121,7 +192,14 @@ namespace Directus
 		Settings::Get().m_versionAssimp = to_string(major) + "." + to_string(minor) + "." + to_string(rev);
 	}
 
-	bool ModelImporter::Load(Model* model, const string& filePath)
+	bool ModelImporter::Load(Model* model, const string& filePath, int progressID)
+	{
+		// The members hold the state of one load, a copy of the importer per load lets loads run in parallel
+		ModelImporter load(*this);
+		return load.Import(model, filePath, progressID);
+	}
+
+	bool ModelImporter::Import(Model* model, const string& filePath, int progressID)
 	{
 		if (!m_context)
 		{
@@ -129,28 +207,51 @@ namespace Directus
 			return false;
 		}
 
-		m_model		= model;
-		m_modelPath = filePath;
+		m_model			= model;
+		m_modelPath		= filePath;
+		m_progressID	= progressID;
 
 		// Set up an Assimp importer
 		Importer importer;
-		importer.SetPropertyInteger(AI_CONFIG_PP_ICL_PTCACHE_SIZE, 64);										// Optimize mesh
 		importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT);	// Remove points and lines.
 		importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_CAMERAS | aiComponent_LIGHTS);		// Remove cameras and lights
 		importer.SetPropertyFloat(AI_CONFIG_PP_CT_MAX_SMOOTHING_ANGLE, _ModelImporter::normalSmoothAngle);	// Normal smoothing angle
-		importer.SetProgressHandler(new _ProgressHandler(filePath));										// Progress tracking
+		importer.SetProgressHandler(new _ProgressHandler(filePath, m_progressID));							// Progress tracking and cancellation
 
 		// Read the 3D model file from disk
 		if (const aiScene* scene = importer.ReadFile(m_modelPath, _ModelImporter::flags))
 		{
+			ReadSkeleton(scene, model);
+
+			vector<ImportedMesh> meshes(scene->mNumMeshes);
+			m_meshes = &meshes;
+			ImportMeshesAndTextures(scene, model);
+
+			// The last point a cancel is taken, nothing has been added to the world yet
+			if (ProgressReport::Get().Job_IsCancelled(m_progressID))
+			{
+				m_meshes = nullptr;
+				LOGF_INFO("ModelImporter::Load: Import of \"%s\" was cancelled", FileSystem::GetFileNameFromFilePath(filePath).c_str());
+				return false;
+			}
+
 			FIRE_EVENT(EVENT_WORLD_STOP);
 
+			ImportMaterials(scene, model);
 			ReadNodeHierarchy(scene, scene->mRootNode, model);
 			ReadAnimations(scene, model);
 			model->Geometry_Update();
 
+			m_meshes = nullptr;
+			m_materials.clear();
+
 			FIRE_EVENT(EVENT_WORLD_START);
 		}
+		else if (ProgressReport::Get().Job_IsCancelled(m_progressID))
+		{
+			LOGF_INFO("ModelImporter::Load: Import of \"%s\" was cancelled", FileSystem::GetFileNameFromFilePath(filePath).c_str());
+			return false;
+		}
 		else
 		{
 			LOGF_ERROR("ModelImporter::Load: %s", importer.GetErrorString());
@@ -172,7 +273,7 @@ namespace Directus
 
 			int jobCount;
 			ComputeNodeCount(assimpNode, &jobCount);
-			ProgressReport::Get().SetJobCount(g_progress_ModelImporter, jobCount);
+			ProgressReport::Get().SetJobCount(m_progressID, jobCount);
 		}
 
 		//= GET NODE NAME ============================================================
@@ -183,14 +284,14 @@ namespace Directus
 			string name = assimpNode->mName.C_Str();
 			newNode->SetName(name);
 
-			ProgressReport::Get().SetStatus(g_progress_ModelImporter, "Creating actor for " + name);
+			ProgressReport::Get().SetStatus(m_progressID, "Creating actor for " + name);
 		}
 		else
 		{
 			string name = FileSystem::GetFileNameNoExtensionFromFilePath(m_modelPath);
 			newNode->SetName(name);
 
-			ProgressReport::Get().SetStatus(g_progress_ModelImporter, "Creating actor for " + name);
+			ProgressReport::Get().SetStatus(m_progressID, "Creating actor for " + name);
 		}
 		//============================================================================
 
@@ -220,7 +321,7 @@ namespace Directus
 			actor->SetName(name);
 
 			// Process mesh
-			LoadMesh(assimpScene, assimpMesh, model,  actor);
+			LoadMesh(assimpScene, assimpNode, assimpNode->mMeshes[i], model, actor);
 		}
 
 		// Process children
@@ -230,13 +331,32 @@ namespace Directus
 			ReadNodeHierarchy(assimpScene, assimpNode->mChildren[i], model, newNode, child.get());
 		}
 
-		ProgressReport::Get().IncrementJobsDone(g_progress_ModelImporter);
+		ProgressReport::Get().IncrementJobsDone(m_progressID);
 	}
 
 	void ModelImporter::ReadAnimations(const aiScene* scene, Model* model)
 	{
+		// How far each bone's skin reaches, the longest chain of bones below it. A rotation moves the skin in proportion
+		// to it, so the further it reaches the less the rotation may err for the skin to stay within ANIMATION_ERROR.
+		const auto& bones = model->Skin_GetBones();
+		vector<float> reach(bones.size(), 0.0f);
+		float extent = 0.0f;
+		for (int j = (int)bones.size() - 1; j >= 0; j--)
+		{
+			int parent = bones[j].parent;
+			if (parent != -1)
+			{
+				reach[parent] = Helper::Max(reach[parent], bones[j].position.Length() + reach[j]);
+			}
+			extent = Helper::Max(extent, reach[j]);
+		}
+		float error = extent * ANIMATION_ERROR;
+
 		for (unsigned int i = 0; i < scene->mNumAnimations; i++)
 		{
+			unsigned int keysImported = 0;
+			unsigned int keysKept = 0;
+
 			aiAnimation* assimpAnimation = scene->mAnimations[i];
 			shared_ptr<Animation> animation = make_shared<Animation>(m_context);
 
@@ -246,7 +366,7 @@ namespace Directus
 			animation->SetTicksPerSec(assimpAnimation->mTicksPerSecond != 0.0f ? assimpAnimation->mTicksPerSecond : 25.0f);
 
 			// Animation channels
-			for (unsigned int j = 0; j > assimpAnimation->mNumChannels; j++)
+			for (unsigned int j = 0; j < assimpAnimation->mNumChannels; j++)
 			{
 				aiNodeAnim* assimpNodeAnim = assimpAnimation->mChannels[j];
 				AnimationNode animationNode;
@@ -265,7 +385,7 @@ namespace Directus
 				// Rotation keys
 				for (unsigned int k = 0; k < assimpNodeAnim->mNumRotationKeys; k++)
 				{
-					double time = assimpNodeAnim->mPositionKeys[k].mTime;
+					double time = assimpNodeAnim->mRotationKeys[k].mTime;
 					Quaternion value = AssimpHelper::ToQuaternion(assimpNodeAnim->mRotationKeys[k].mValue);
 
 					animationNode.rotationFrames.push_back(KeyQuaternion{ time, value });
@@ -274,33 +394,220 @@ namespace Directus
 				// Scaling keys
 				for (unsigned int k = 0; k < assimpNodeAnim->mNumScalingKeys; k++)
 				{
-					double time = assimpNodeAnim->mPositionKeys[k].mTime;
+					double time = assimpNodeAnim->mScalingKeys[k].mTime;
 					Vector3 value = AssimpHelper::ToVector3(assimpNodeAnim->mScalingKeys[k].mValue);
 
 					animationNode.scaleFrames.push_back(KeyVector{ time, value });
 				}
+
+				// Anything but a bone moves the whole skeleton
+				int bone = model->Skin_GetBone(animationNode.name);
+				AnimationTolerance tolerance;
+				if (error > 0.0f)
+				{
+					float boneReach		= bone == -1 ? extent : Helper::Max(reach[bone], extent * ANIMATION_REACH_MIN);
+					tolerance.position	= error;
+					tolerance.rotation	= error / boneReach;
+					tolerance.scale		= error / boneReach;
+				}
+				animation->AddChannel(animationNode, tolerance);
+
+				const AnimationChannel& channel = animation->GetChannels().back();
+				keysImported	+= (unsigned int)(animationNode.positionFrames.size() + animationNode.rotationFrames.size() + animationNode.scaleFrames.size());
+				keysKept		+= channel.position.Count() + channel.rotation.Count() + channel.scale.Count();
 			}
 
+			LOGF_INFO("ModelImporter::ReadAnimations: \"%s\" compressed to %d of %d keys", animation->GetName().c_str(), keysKept, keysImported);
 			model->AddAnimation(animation);
 		}
 	}
 
-	void ModelImporter::LoadMesh(const aiScene* assimpScene, aiMesh* assimpMesh, Model* model, Actor* parentActor)
+	void ModelImporter::ReadSkeleton(const aiScene* assimpScene, Model* model)
 	{
-		if (!model || !assimpMesh || !assimpScene || !parentActor)
+		// The bind pose offset of every bone, and the nodes skinned meshes are placed at
+		unordered_map<string, aiMatrix4x4> offsets;
+		unordered_set<unsigned int> skinnedMeshes;
+		for (unsigned int i = 0; i < assimpScene->mNumMeshes; i++)
+		{
+			aiMesh* assimpMesh = assimpScene->mMeshes[i];
+			for (unsigned int j = 0; j < assimpMesh->mNumBones; j++)
+			{
+				offsets.emplace(assimpMesh->mBones[j]->mName.C_Str(), assimpMesh->mBones[j]->mOffsetMatrix);
+				skinnedMeshes.insert(i);
+			}
+		}
+
+		if (offsets.empty())
 			return;
 
-		//= MESH ======================================================================
-		vector<RHI_Vertex_PosUVTBN> vertices;
-		AssimpMesh_ExtractVertices(assimpMesh, &vertices);
+		// A node is kept if it's a bone, holds a skinned mesh or is above one that is
+		function<bool(aiNode*)> isKept;
+		unordered_set<aiNode*> kept;
+		isKept = [&](aiNode* node)
+		{
+			bool keep = offsets.find(node->mName.C_Str()) != offsets.end();
+			for (unsigned int i = 0; i < node->mNumMeshes && !keep; i++)
+			{
+				keep = skinnedMeshes.count(node->mMeshes[i]) != 0;
+			}
+			for (unsigned int i = 0; i < node->mNumChildren; i++)
+			{
+				keep = isKept(node->mChildren[i]) || keep;
+			}
+			if (keep)
+			{
+				kept.insert(node);
+			}
+			return keep;
+		};
+		isKept(assimpScene->mRootNode);
 
-		vector<unsigned int> indices;
-		AssimpMesh_ExtractIndices(assimpMesh, &indices);
+		// Parents before children
+		vector<ModelBone> bones;
+		function<void(aiNode*, int)> add = [&](aiNode* node, int parent)
+		{
+			if (kept.find(node) == kept.end())
+				return;
+
+			Matrix local = AssimpHelper::aiMatrix4x4ToMatrix(node->mTransformation);
+			ModelBone bone;
+			bone.name		= node->mName.C_Str();
+			bone.parent		= parent;
+			bone.position	= local.GetTranslation();
+			bone.rotation	= local.GetRotation();
+			bone.scale		= local.GetScale();
+			auto offset		= offsets.find(bone.name);
+			if (offset != offsets.end())
+			{
+				bone.offset = AssimpHelper::aiMatrix4x4ToMatrix(offset->second);
+			}
+			bones.emplace_back(bone);
+
+			int index = (int)bones.size() - 1;
+			for (unsigned int i = 0; i < node->mNumChildren; i++)
+			{
+				add(node->mChildren[i], index);
+			}
+		};
+		add(assimpScene->mRootNode, -1);
+
+		if (bones.size() > MODEL_BONES_MAX)
+		{
+			LOGF_WARNING("ModelImporter::ReadSkeleton: \"%s\" has %d bones, more than the %d that can be skinned, it will stay in its bind pose", FileSystem::GetFileNameFromFilePath(m_modelPath).c_str(), (int)bones.size(), MODEL_BONES_MAX);
+			return;
+		}
+
+		model->Skin_SetBones(bones);
+	}
+
+	void ModelImporter::ImportMeshesAndTextures(const aiScene* assimpScene, Model* model)
+	{
+		// Every mesh and texture converts on it's own, appending to the model, creating actors and materials
+		// is left for the hierarchy walk, so the geometry offsets don't depend on the thread timing
+		auto threading = m_context->GetSubsystem<Threading>();
+		vector<JobHandle> converted;
+		auto AddTask = [&threading, &converted](function<void()>&& task) { converted.emplace_back(threading->Job_Add(move(task))); };
+
+		for (unsigned int i = 0; i < assimpScene->mNumMeshes; i++)
+		{
+			aiMesh* assimpMesh	= assimpScene->mMeshes[i];
+			ImportedMesh* mesh	= &(*m_meshes)[i];
+			AddTask([this, threading, assimpMesh, mesh, model]()
+			{
+				// Tangents are generated by Assimp (aiProcess_CalcTangentSpace), during the file read
+				AssimpMesh_ExtractVertices(assimpMesh, &mesh->vertices);
+				AssimpMesh_ExtractIndices(assimpMesh, &mesh->indices);
+				AssimpMesh_ExtractWeights(assimpMesh, model, &mesh->weights);
+
+				// Done once here, the model file stores the optimized geometry. Reordering the vertices
+				// would take the weights out of step with them, so skinned ones keep their order.
+				GeometryUtility::OptimizeVertexCache(&mesh->indices, (unsigned int)mesh->vertices.size());
+				GeometryUtility::OptimizeOverdraw(&mesh->indices, mesh->vertices);
+				if (mesh->weights.empty())
+				{
+					GeometryUtility::OptimizeVertexFetch(&mesh->vertices, &mesh->indices);
+				}
+
+				mesh->aabb = _ModelImporter::ComputeAabb(threading, mesh->vertices);
+				Model::Geometry_SimplifyLods(mesh->indices, mesh->vertices, &mesh->lods, &mesh->lodIndices);
+				Model::Geometry_BuildClusters(mesh->indices, mesh->vertices, &mesh->clusters);
+				for (auto& lodIndices : mesh->lodIndices)
+				{
+					GeometryUtility::OptimizeVertexCache(&lodIndices, (unsigned int)mesh->vertices.size());
+				}
+			});
+		}
+
+		// Textures are imported once per name (that's how they are cached), the materials will find them in the cache
+		unordered_set<string> textureNames;
+		for (unsigned int i = 0; assimpScene->HasMaterials() && i < assimpScene->mNumMaterials; i++)
+		{
+			aiMaterial* assimpMaterial = assimpScene->mMaterials[i];
+			for (const auto& textureType : _ModelImporter::textureTypes)
+			{
+				aiString texturePath;
+				if (assimpMaterial->GetTextureCount(textureType.first) == 0 || assimpMaterial->GetTexture(textureType.first, 0, &texturePath) != AI_SUCCESS)
+					continue;
+
+				auto deducedPath = ValidateTexturePath(texturePath.data);
+				if (!FileSystem::IsSupportedImageFile(deducedPath) || !textureNames.insert(FileSystem::GetFileNameNoExtensionFromFilePath(deducedPath)).second)
+					continue;
+
+				TextureType engineTex = textureType.second;
+				AddTask([model, engineTex, deducedPath]() { model->ImportTexture(engineTex, deducedPath); });
+			}
+		}
+
+		// Help out instead of just waiting, the queue might be longer than the thread pool
+		threading->Job_Wait(threading->Job_Group(converted));
+	}
+
+	void ModelImporter::ImportMaterials(const aiScene* assimpScene, Model* model)
+	{
+		// Exporters often write one material per mesh, those that look the same become one, so they batch together
+		m_materials.clear();
+		unordered_map<size_t, shared_ptr<Material>> unique;
+		for (unsigned int i = 0; assimpScene->HasMaterials() && i < assimpScene->mNumMaterials; i++)
+		{
+			auto material = AiMaterialToMaterial(assimpScene->mMaterials[i], model);
+			if (!material)
+			{
+				m_materials.emplace_back(nullptr);
+				continue;
+			}
+
+			auto& kept = unique[material->GetAppearanceHash()];
+			if (!kept)
+			{
+				kept = model->AddMaterial(material, nullptr);
+			}
+			m_materials.emplace_back(kept);
+		}
+
+		if (unique.size() < m_materials.size())
+		{
+			LOGF_INFO("ModelImporter::ImportMaterials: %d materials, %d after merging identical ones", (int)m_materials.size(), (int)unique.size());
+		}
+	}
+
+	void ModelImporter::LoadMesh(const aiScene* assimpScene, aiNode* assimpNode, unsigned int meshIndex, Model* model, Actor* parentActor)
+	{
+		if (!model || !assimpScene || !parentActor || !m_meshes || meshIndex >= (unsigned int)m_meshes->size())
+			return;
+
+		aiMesh* assimpMesh	= assimpScene->mMeshes[meshIndex];
+		ImportedMesh& mesh	= (*m_meshes)[meshIndex];
+
+		//= MESH ======================================================================
+		auto& vertices	= mesh.vertices;
+		auto& indices	= mesh.indices;
 
 		// Add the mesh to the model
 		unsigned int indexOffset;
 		unsigned int vertexOffset;
 		model->Geometry_Append(indices, vertices, &indexOffset, &vertexOffset);
+		model->Geometry_AppendLods(indexOffset, move(mesh.lods), mesh.lodIndices);
+		model->Geometry_AppendClusters(indexOffset, mesh.clusters);
 
 		// Add a renderable component to this Actor
 		auto renderable	= parentActor->AddComponent<Renderable>();
@@ -312,26 +619,25 @@ namespace Directus
 			(unsigned int)indices.size(),
 			vertexOffset,
 			(unsigned int)vertices.size(),
-			BoundingBox(vertices),
+			mesh.aabb,
 			model
 		);
 		//=============================================================================
 
 		//= MATERIAL ========================================================================
-		auto material = shared_ptr<Material>();
-		if (assimpScene->HasMaterials())
+		// Converted once for all the meshes that use it (see ImportMaterials)
+		if (assimpMesh->mMaterialIndex < (unsigned int)m_materials.size() && m_materials[assimpMesh->mMaterialIndex])
 		{
-			// Get aiMaterial
-			aiMaterial* assimpMaterial = assimpScene->mMaterials[assimpMesh->mMaterialIndex];
-			// Convert it and add it to the model
-			model->AddMaterial(AiMaterialToMaterial(assimpMaterial, model), parentActor->GetPtrShared());
+			renderable->Material_Set(m_materials[assimpMesh->mMaterialIndex], false);
 		}
 		//===================================================================================
 
 		//= BONES ======================================================================
-		for (unsigned int boneIndex = 0; boneIndex < assimpMesh->mNumBones; boneIndex++)
+		// The actor of a node with many meshes sits where the node is, so the node is what the geometry is posed relative to
+		int meshBone = model->Skin_GetBone(assimpNode->mName.C_Str());
+		if (!mesh.weights.empty() && meshBone != -1)
 		{
-			//aiBone* bone = assimpMesh->mBones[boneIndex];
+			model->Skin_Append(vertexOffset, (unsigned int)meshBone, mesh.weights);
 		}
 		//==============================================================================
 	}
@@ -405,6 +711,63 @@ namespace Directus
 		}
 	}
 
+	void ModelImporter::AssimpMesh_ExtractWeights(aiMesh* assimpMesh, const Model* model, vector<RHI_Vertex_Skin>* weights)
+	{
+		if (!assimpMesh->HasBones() || model->Skin_GetBones().empty())
+			return;
+
+		// The four largest influences of every vertex (aiProcess_LimitBoneWeights already keeps it to that)
+		vector<Vector4> influences(assimpMesh->mNumVertices, Vector4::Zero);
+		weights->resize(assimpMesh->mNumVertices);
+		for (unsigned int i = 0; i < assimpMesh->mNumBones; i++)
+		{
+			aiBone* assimpBone	= assimpMesh->mBones[i];
+			int bone			= model->Skin_GetBone(assimpBone->mName.C_Str());
+			if (bone == -1)
+				continue;
+
+			for (unsigned int j = 0; j < assimpBone->mNumWeights; j++)
+			{
+				const aiVertexWeight& assimpWeight = assimpBone->mWeights[j];
+				if (assimpWeight.mVertexId >= assimpMesh->mNumVertices)
+					continue;
+
+				float* influence		= &influences[assimpWeight.mVertexId].x;
+				unsigned int smallest	= 0;
+				for (unsigned int k = 1; k < 4; k++)
+				{
+					smallest = influence[k] < influence[smallest] ? k : smallest;
+				}
+
+				if (assimpWeight.mWeight > influence[smallest])
+				{
+					influence[smallest]									= assimpWeight.mWeight;
+					(*weights)[assimpWeight.mVertexId].bones[smallest]	= (uint8_t)bone;
+				}
+			}
+		}
+
+		// To bytes that add up to 255, what rounding leaves over goes to the largest
+		for (unsigned int i = 0; i < assimpMesh->mNumVertices; i++)
+		{
+			const float* influence	= &influences[i].x;
+			float sum				= influence[0] + influence[1] + influence[2] + influence[3];
+			if (sum <= 0.0f)
+				continue;
+
+			auto& weight			= (*weights)[i];
+			unsigned int largest	= 0;
+			int total				= 0;
+			for (unsigned int k = 0; k < 4; k++)
+			{
+				weight.weights[k]	= (uint8_t)(influence[k] / sum * 255.0f + 0.5f);
+				total				+= weight.weights[k];
+				largest				= influence[k] > influence[largest] ? k : largest;
+			}
+			weight.weights[largest] = (uint8_t)(weight.weights[largest] + 255 - total);
+		}
+	}
+
 	shared_ptr<Material> ModelImporter::AiMaterialToMaterial(aiMaterial* assimpMaterial, Model* model)
 	{
 		if (!model || !assimpMaterial)
@@ -464,15 +827,10 @@ namespace Directus
 			}
 		};
 
-		LoadMatTex(aiTextureType_DIFFUSE,	TextureType_Albedo);
-		LoadMatTex(aiTextureType_SHININESS,	TextureType_Roughness); // Specular as roughness
-		LoadMatTex(aiTextureType_AMBIENT,	TextureType_Metallic);	// Ambient as metallic
-		LoadMatTex(aiTextureType_NORMALS,	TextureType_Normal);
-		LoadMatTex(aiTextureType_LIGHTMAP,	TextureType_Occlusion);
-		LoadMatTex(aiTextureType_EMISSIVE,	TextureType_Emission);
-		LoadMatTex(aiTextureType_LIGHTMAP,	TextureType_Occlusion);
-		LoadMatTex(aiTextureType_HEIGHT,	TextureType_Height);
-		LoadMatTex(aiTextureType_OPACITY,	TextureType_Mask);
+		for (const auto& textureType : _ModelImporter::textureTypes)
+		{
+			LoadMatTex(textureType.first, textureType.second);
+		}
 
 		return material;
 	}
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include "../../Core/EngineDefs.h"
 #include "../../RHI/RHI_Definition.h"
+#include "../ProgressReport.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,6 +43,7 @@ namespace Directus
 	class Actor;
 	class Model;
 	class Transform;
+	struct ImportedMesh;
 
 	class ENGINE_CLASS ModelImporter
 	{
@@ -49,15 +51,24 @@ namespace Directus
 		ModelImporter(Context* context);
 		~ModelImporter() {}
 
-		bool Load(Model* model, const std::string& filePath);
+		// Reports to (and can be cancelled through) a ProgressReport id, safe to call from many threads
+		bool Load(Model* model, const std::string& filePath, int progressID = g_progress_ModelImporter);
 
 	private:
+		bool Import(Model* model, const std::string& filePath, int progressID);
+
 		// PROCESSING
 		void ReadNodeHierarchy(const aiScene* assimpScene, aiNode* assimpNode, Model* model, Actor* parentNode = nullptr, Actor* newNode = nullptr);
 		void ReadAnimations(const aiScene* scene, Model* model);
-		void LoadMesh(const aiScene* assimpScene, aiMesh* assimpMesh, Model* model, Actor* parentActor);
+		// The bones and what's above them, before the meshes are converted since their weights name bones by index
+		void ReadSkeleton(const aiScene* assimpScene, Model* model);
+		void ImportMeshesAndTextures(const aiScene* assimpScene, Model* model);
+		// Converts every Assimp material once, after the textures they use were imported
+		void ImportMaterials(const aiScene* assimpScene, Model* model);
+		void LoadMesh(const aiScene* assimpScene, aiNode* assimpNode, unsigned int meshIndex, Model* model, Actor* parentActor);
 		void AssimpMesh_ExtractVertices(aiMesh* assimpMesh, std::vector<RHI_Vertex_PosUVTBN>* vertices);
 		void AssimpMesh_ExtractIndices(aiMesh* assimpMesh, std::vector<unsigned int>* indices);
+		void AssimpMesh_ExtractWeights(aiMesh* assimpMesh, const Model* model, std::vector<RHI_Vertex_Skin>* weights);
 		std::shared_ptr<Material> AiMaterialToMaterial(aiMaterial* assimpMaterial, Model* model);
 
 		// HELPER FUNCTIONS
@@ -67,6 +78,11 @@ namespace Directus
 	
 		Model* m_model;
 		std::string m_modelPath;
+		// Converted up front, in parallel, by aiScene mesh index
+		std::vector<ImportedMesh>* m_meshes;
+		// By aiScene material index, identical ones share the first of them
+		std::vector<std::shared_ptr<Material>> m_materials;
+		int m_progressID;
 
 		Context* m_context;
 	};
@@ -25,12 +25,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/EngineDefs.h"
 #include <string>
 #include <map>
+#include <mutex>
+#include <vector>
 //=============================
 
 namespace Directus
 {
 	static int g_progress_ModelImporter = 0;
 	static int g_progress_Scene			= 1;
+	static int g_progress_Jobs			= 2; // ids from here on are handed out by Job_Add()
 
 	struct Progress
 	{
@@ -42,14 +45,17 @@ namespace Directus
 			jobsDone	= 0;
 			jobCount	= 0;
 			isLoading	= false;
+			isCancelled	= false;
 		}
 
 		std::string status;
 		int jobsDone;
 		int jobCount;
 		bool isLoading;
+		bool isCancelled;
 	};
 
+	// Reports are written by the threads doing the work and read by the editor, every call locks
 	class ENGINE_CLASS ProgressReport
 	{
 	public:
@@ -59,23 +65,78 @@ namespace Directus
 			return instance;
 		}
 
-		ProgressReport(){}
+		ProgressReport(){ m_jobNext = g_progress_Jobs; }
 
+		// A cancel outlives a reset, the work it was meant for may not have started reporting yet
 		void Reset(int progressID)
 		{
-			m_reports[progressID].Clear();
+			std::lock_guard<std::mutex> lock(m_mutex);
+			Progress& progress		= m_reports[progressID];
+			bool isCancelled		= progress.isCancelled;
+			progress.Clear();
+			progress.isCancelled	= isCancelled;
 		}
 
-		const std::string& GetStatus(int progressID)				{ return m_reports[progressID].status; }
-		void SetStatus(int progressID, const std::string& status)	{ m_reports[progressID].status = status; }
-		void SetJobCount(int progressID, int jobCount)				{ m_reports[progressID].jobCount = jobCount;}
-		void IncrementJobsDone(int progressID)						{ m_reports[progressID].jobsDone++; }
-		void SetJobsDone(int progressID, int jobsDone)				{ m_reports[progressID].jobsDone = jobsDone; }
-		float GetPercentage(int progressID)							{ return (float)m_reports[progressID].jobsDone / (float)m_reports[progressID].jobCount; }
-		bool GetIsLoading(int progressID)							{ return m_reports[progressID].isLoading; }
-		void SetIsLoading(int progressID, bool isLoading)			{ m_reports[progressID].isLoading = isLoading; }
+		std::string GetStatus(int progressID)						{ std::lock_guard<std::mutex> lock(m_mutex); return m_reports[progressID].status; }
+		void SetStatus(int progressID, const std::string& status)	{ std::lock_guard<std::mutex> lock(m_mutex); m_reports[progressID].status = status; }
+		void SetJobCount(int progressID, int jobCount)				{ std::lock_guard<std::mutex> lock(m_mutex); m_reports[progressID].jobCount = jobCount;}
+		void IncrementJobsDone(int progressID)						{ std::lock_guard<std::mutex> lock(m_mutex); m_reports[progressID].jobsDone++; }
+		void SetJobsDone(int progressID, int jobsDone)				{ std::lock_guard<std::mutex> lock(m_mutex); m_reports[progressID].jobsDone = jobsDone; }
+		float GetPercentage(int progressID)							{ std::lock_guard<std::mutex> lock(m_mutex); return Percentage(m_reports[progressID]); }
+		bool GetIsLoading(int progressID)							{ std::lock_guard<std::mutex> lock(m_mutex); return m_reports[progressID].isLoading; }
+		void SetIsLoading(int progressID, bool isLoading)			{ std::lock_guard<std::mutex> lock(m_mutex); m_reports[progressID].isLoading = isLoading; }
+
+		// True while any report, the fixed ones or a job, is loading
+		bool GetIsLoadingAny()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (const auto& report : m_reports)
+			{
+				if (report.second.isLoading)
+					return true;
+			}
+			return false;
+		}
+
+		//= JOBS ==========================================================================================
+		// A report of its own for work that runs alongside others, it lives until Job_Remove()
+		int Job_Add(const std::string& status)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			int progressID = m_jobNext++;
+			m_reports[progressID].status = status;
+			return progressID;
+		}
+		void Job_Remove(int progressID)				{ std::lock_guard<std::mutex> lock(m_mutex); m_reports.erase(progressID); }
+		// The work checks for it when it can stop, it's up to it how soon that is
+		void Job_Cancel(int progressID)				{ std::lock_guard<std::mutex> lock(m_mutex); m_reports[progressID].isCancelled = true; }
+		bool Job_IsCancelled(int progressID)		{ std::lock_guard<std::mutex> lock(m_mutex); auto it = m_reports.find(progressID); return it != m_reports.end() && it->second.isCancelled; }
+
+		struct Job
+		{
+			int progressID;
+			std::string status;
+			float percentage;
+			bool isCancelled;
+		};
+		// A copy of every job's report, oldest first
+		std::vector<Job> Job_GetAll()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::vector<Job> jobs;
+			for (auto it = m_reports.lower_bound(g_progress_Jobs); it != m_reports.end(); it++)
+			{
+				jobs.push_back(Job{ it->first, it->second.status, Percentage(it->second), it->second.isCancelled });
+			}
+			return jobs;
+		}
+		//=================================================================================================
+
+	private:
+		static float Percentage(const Progress& progress) { return progress.jobCount != 0 ? (float)progress.jobsDone / (float)progress.jobCount : 0.0f; }
 
-	private:	
 		std::map<int, Progress> m_reports;
+		int m_jobNext;
+		std::mutex m_mutex;
 	};
 }
\ No newline at end of file
@@ -24,32 +24,78 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============
 #include <vector>
 #include <memory>
+#include <map>
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <algorithm>
 #include "IResource.h"
 #include "../Logging/Log.h"
-#include <mutex>
 //========================
 
 namespace Directus
 {
+	// Resources are indexed by the StringId of their name and of their path (per type) and by their ID, so a lookup compares
+	// integers only and looking up a string literal allocates nothing. Lookups take a shared lock, only adding, re-indexing, evicting and
+	// clearing take an exclusive one, so loader threads can query the cache concurrently.
+	//
+	// A type can have a memory budget, once it's over it the least recently used resources that nothing outside the cache
+	// references get evicted (see Evict), to be loaded again by whoever asks for them next.
 	class ENGINE_CLASS ResourceCache
 	{
 	public:
 		ResourceCache() {}
 		~ResourceCache() { Clear(); }
 
-		// Adds a resource
-		void Add(const std::shared_ptr<IResource>& resource)
+		// Adds a resource, unless one with it's name and type is cached already, returns whichever ends up cached
+		std::shared_ptr<IResource> Add(const std::shared_ptr<IResource>& resource)
 		{
 			if (!resource)
-				return;
+				return nullptr;
+
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			Index_UpdateIDs(resource.get());
+			if (auto cached = Find(m_byName, resource->GetResourceType(), resource->GetResourceNameID(), &IResource::GetResourceNameID))
+				return cached;
 
-			std::lock_guard<std::mutex> guard(m_mutex);
 			m_resourceGroups[resource->GetResourceType()].push_back(resource);
+			Index_Insert(resource.get());
+			resource->m_resourceCache	= this;
+			resource->m_resourceLastUse	= m_frame;
+
+			return resource;
+		}
+
+		// Renames a cached resource and moves it to the index entries of it's new name and path, the resource calls
+		// this from it's setters, so that nothing reads the strings while they change
+		void Rename(IResource* resource, const std::string& name, const std::string& filePath)
+		{
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			bool indexed = Index_Erase(resource);
+			resource->m_resourceName		= name;
+			resource->m_resourceFilePath	= filePath;
+			Index_UpdateIDs(resource);
+			if (indexed)
+			{
+				Index_Insert(resource);
+			}
+		}
+
+		// Re-indexes a resource under it's current name, path and ID, for when they were read straight from a file
+		void Reindex(IResource* resource)
+		{
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			Index_UpdateIDs(resource);
+			if (Index_Erase(resource))
+			{
+				Index_Insert(resource);
+			}
 		}
 
 		// Returns the file paths of all the resources
 		void GetResourceFilePaths(std::vector<std::string>& filePaths)
 		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
 			for (const auto& resourceGroup : m_resourceGroups)
 			{
 				for (const auto& resource : resourceGroup.second)
@@ -59,17 +105,21 @@ namespace Directus
 			}
 		}
 
-		// Makes the resources save their metadata
+		// Makes the resources save their metadata, the ones whose engine file is up to date are skipped
 		void SaveResourcesToFiles()
 		{
-			for (const auto& resourceGroup : m_resourceGroups)
+			// Saving can change a resource's path, which re-indexes it, so this works on a copy
+			for (const auto& resource : GetAll())
 			{
-				for (const auto& resource : resourceGroup.second)
-				{
-					if (!resource->HasFilePath())
-						continue;
+				if (!resource->HasFilePath())
+					continue;
+
+				if (!resource->Resource_IsDirty() && FileSystem::FileExists(resource->GetResourceFilePath()))
+					continue;
 
-					resource->SaveToFile(resource->GetResourceFilePath());
+				if (resource->SaveToFile(resource->GetResourceFilePath()))
+				{
+					resource->Resource_MarkClean();
 				}
 			}
 		}
@@ -77,6 +127,7 @@ namespace Directus
 		// Returns all the resources
 		std::vector<std::shared_ptr<IResource>> GetAll()
 		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
 			std::vector<std::shared_ptr<IResource>> resources;
 			for (const auto& resourceGroup : m_resourceGroups)
 			{
@@ -88,40 +139,36 @@ namespace Directus
 
 		// Returns a resource by name
 		template <class T>
-		std::shared_ptr<IResource> GetByName(const std::string& name)
+		std::shared_ptr<IResource> GetByName(const StringId& name)
 		{
-			for (const auto& resource : m_resourceGroups[IResource::DeduceResourceType<T>()])
-			{
-				if (name == resource->GetResourceName())
-					return resource;
-			}
-
-			return std::shared_ptr<IResource>();
+			return GetByName(name, IResource::DeduceResourceType<T>());
 		}
 
 		// Returns a resource by name
-		std::shared_ptr<IResource> GetByName(const std::string& name, Resource_Type type)
+		std::shared_ptr<IResource> GetByName(const StringId& name, Resource_Type type)
 		{
-			for (const auto& resource : m_resourceGroups[type])
-			{
-				if (name == resource->GetResourceName())
-					return resource;
-			}
-
-			return std::shared_ptr<IResource>();
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			return Find(m_byName, type, name, &IResource::GetResourceNameID);
 		}
 
 		// Returns a resource by path
 		template <class T>
-		std::shared_ptr<IResource> GetByPath(const std::string& path)
+		std::shared_ptr<IResource> GetByPath(const StringId& path)
 		{
-			for (const auto& resource : m_resourceGroups[IResource::DeduceResourceType<T>()])
-			{
-				if (path == resource->GetResourceFilePath())
-					return resource;
-			}
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			return Find(m_byPath, IResource::DeduceResourceType<T>(), path, &IResource::GetResourceFilePathID);
+		}
+
+		// Returns a resource by ID
+		std::shared_ptr<IResource> GetByID(unsigned int id)
+		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			auto it = m_byID.find(id);
+			if (it == m_byID.end())
+				return nullptr;
 
-			return std::shared_ptr<IResource>();
+			it->second->m_resourceLastUse = m_frame;
+			return it->second->GetSharedPtr();
 		}
 
 		// Checks whether a resource is already cached
@@ -139,27 +186,18 @@ namespace Directus
 				return false;
 			}
 
-			for (const auto& resource : m_resourceGroups[resourceType])
-			{
-				if (resourceName == resource->GetResourceName())
-					return true;
-			}
-
-			return false;
+			return GetByName(resourceName, resourceType) != nullptr;
 		}
 
 		unsigned int GetMemoryUsage()
 		{
 			unsigned int size = 0;
-			for (const auto& group : m_resourceGroups)
+			for (const auto& resource : GetAll())
 			{
-				for (const auto& resource : group.second)
-				{
-					if (!resource)
-						continue;
+				if (!resource)
+					continue;
 
-					size += resource->GetMemoryUsage();
-				}
+				size += resource->GetMemoryUsage();
 			}
 
 			return size;
@@ -168,7 +206,7 @@ namespace Directus
 		unsigned int GetMemoryUsage(Resource_Type type)
 		{
 			unsigned int size = 0;
-			for (const auto& resource : m_resourceGroups[type])
+			for (const auto& resource : GetByType(type))
 			{
 				size += resource->GetMemoryUsage();
 			}
@@ -177,13 +215,206 @@ namespace Directus
 		}
 
 		// Returns all resources of a given type
-		const std::vector<std::shared_ptr<IResource>>& GetByType(Resource_Type type) { return m_resourceGroups[type]; }
+		std::vector<std::shared_ptr<IResource>> GetByType(Resource_Type type)
+		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			auto it = m_resourceGroups.find(type);
+			return it != m_resourceGroups.end() ? it->second : std::vector<std::shared_ptr<IResource>>();
+		}
+
+		unsigned int GetCount(Resource_Type type)
+		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			auto it = m_resourceGroups.find(type);
+			return it != m_resourceGroups.end() ? (unsigned int)it->second.size() : 0;
+		}
+
+		//= BUDGETS ====================================================================================
+		// Only types whose users keep strong references can be budgeted, the rest are referenced weakly or
+		// by raw pointers (e.g. models by renderables, shaders by materials), so they could be evicted in use.
+		void SetBudget(Resource_Type type, unsigned int bytes)
+		{
+			if (type != Resource_Texture && type != Resource_Material)
+			{
+				LOGF_WARNING("ResourceCache::SetBudget: Resources of type %d can't be evicted safely, they have no budget", (int)type);
+				return;
+			}
+
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			m_budgets[type] = bytes;
+		}
+		unsigned int GetBudget(Resource_Type type)
+		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			auto it = m_budgets.find(type);
+			return it != m_budgets.end() ? it->second : 0;
+		}
+
+		// Advances the frame resources are stamped with when they are looked up
+		void Frame_Advance() { m_frame++; }
+
+		// Evicts unreferenced resources of every type that is over it's budget, least recently used ones first. What has
+		// unsaved changes, is still loading or can't be loaded back (no file) stays. Returns how many got evicted.
+		unsigned int Evict()
+		{
+			std::vector<std::shared_ptr<IResource>> evicted;
+			{
+				std::unique_lock<std::shared_mutex> lock(m_mutex);
+				for (const auto& budget : m_budgets)
+				{
+					auto& group = m_resourceGroups[budget.first];
+
+					unsigned int used = 0;
+					for (const auto& resource : group)
+					{
+						used += resource->GetMemoryUsage();
+					}
+					if (budget.second == 0 || used <= budget.second)
+						continue;
+
+					// Only the cache holds these
+					std::vector<IResource*> candidates;
+					for (const auto& resource : group)
+					{
+						if (resource.use_count() == 1 && resource->GetLoadState() != LoadState_Started && resource->HasFilePath() && !resource->Resource_IsDirty() && FileSystem::FileExists(resource->GetResourceFilePath()))
+						{
+							candidates.emplace_back(resource.get());
+						}
+					}
+					std::sort(candidates.begin(), candidates.end(), [](IResource* a, IResource* b) { return a->m_resourceLastUse < b->m_resourceLastUse; });
+
+					for (auto resource : candidates)
+					{
+						if (used <= budget.second)
+							break;
+
+						used -= std::min(used, resource->GetMemoryUsage());
+						Index_Erase(resource);
+						resource->m_resourceCache = nullptr;
+
+						auto it = std::find_if(group.begin(), group.end(), [resource](const auto& shared) { return shared.get() == resource; });
+						evicted.emplace_back(std::move(*it));
+						*it = std::move(group.back());
+						group.pop_back();
+					}
+				}
+			}
+
+			// They get destroyed here, outside of the lock
+			if (!evicted.empty())
+			{
+				LOGF_INFO("ResourceCache::Evict: Evicted %d resources to stay within budget", (int)evicted.size());
+			}
+			return (unsigned int)evicted.size();
+		}
+		//==============================================================================================
 
 		// Unloads all resources
-		void Clear() { m_resourceGroups.clear(); }
+		void Clear()
+		{
+			// The resources get destroyed along with this, after the lock is released
+			std::map<Resource_Type, std::vector<std::shared_ptr<IResource>>> resourceGroups;
+
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			for (const auto& resource : m_keys)
+			{
+				resource.first->m_resourceCache = nullptr;
+			}
+			resourceGroups.swap(m_resourceGroups);
+			m_byName.clear();
+			m_byPath.clear();
+			m_byID.clear();
+			m_keys.clear();
+		}
 
 	private:
+		// The groups hold the only strong references, so a resource nothing else references has a use count of 1
+		typedef std::unordered_multimap<size_t, IResource*> Index;
+
+		static size_t Key(Resource_Type type, const StringId& id)
+		{
+			return (size_t)(id.GetHash() ^ ((uint64_t)type * 0x9e3779b97f4a7c15ull));
+		}
+
+		// Only resources sharing the key are compared, the caller holds the lock
+		std::shared_ptr<IResource> Find(const Index& index, Resource_Type type, const StringId& id, const StringId& (IResource::*get)())
+		{
+			auto range = index.equal_range(Key(type, id));
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				auto resource = it->second;
+				if (resource->GetResourceType() == type && (resource->*get)() == id)
+				{
+					resource->m_resourceLastUse = m_frame;
+					return resource->GetSharedPtr();
+				}
+			}
+
+			return nullptr;
+		}
+
+		// What a resource is indexed under, which can be stale by the time it's removed from the indices
+		struct Keys
+		{
+			size_t name;
+			size_t path;
+			unsigned int id;
+		};
+
+		void Index_Insert(IResource* resource)
+		{
+			Keys keys = { Key(resource->GetResourceType(), resource->GetResourceNameID()), Key(resource->GetResourceType(), resource->GetResourceFilePathID()), resource->Resource_GetID() };
+			m_byName.emplace(keys.name, resource);
+			m_byPath.emplace(keys.path, resource);
+			m_byID[keys.id]		= resource;
+			m_keys[resource]	= keys;
+		}
+
+		// The strings can have been read straight into the resource, bypassing it's setters
+		static void Index_UpdateIDs(IResource* resource)
+		{
+			resource->m_resourceNameID		= resource->m_resourceName;
+			resource->m_resourceFilePathID	= resource->m_resourceFilePath;
+		}
+
+		// False if the resource isn't indexed
+		bool Index_Erase(IResource* resource)
+		{
+			auto it = m_keys.find(resource);
+			if (it == m_keys.end())
+				return false;
+
+			Erase(m_byName, it->second.name, resource);
+			Erase(m_byPath, it->second.path, resource);
+			auto id = m_byID.find(it->second.id);
+			if (id != m_byID.end() && id->second == resource)
+			{
+				m_byID.erase(id);
+			}
+			m_keys.erase(it);
+			return true;
+		}
+
+		static void Erase(Index& index, size_t key, IResource* resource)
+		{
+			auto range = index.equal_range(key);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (it->second == resource)
+				{
+					index.erase(it);
+					return;
+				}
+			}
+		}
+
 		std::map<Resource_Type, std::vector<std::shared_ptr<IResource>>> m_resourceGroups;
-		std::mutex m_mutex;
+		Index m_byName;
+		Index m_byPath;
+		std::unordered_map<unsigned int, IResource*> m_byID;
+		std::unordered_map<IResource*, Keys> m_keys;
+		std::map<Resource_Type, unsigned int> m_budgets;	// in bytes, 0 is unlimited
+		std::atomic<unsigned int> m_frame = 0;
+		std::shared_mutex m_mutex;
 	};
-}
\ No newline at end of file
+}
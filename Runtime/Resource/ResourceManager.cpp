@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ResourceManager.h"
 #include "../World/Actor.h"
 #include "../Core/EventSystem.h"
+#include "../Rendering/Deferred/ShaderVariation.h"
+#include "../Rendering/GeometryUtility.h"
 //==============================
 
 //= NAMESPACES ================
@@ -30,12 +32,16 @@ using namespace std;
 using namespace Directus::Math;
 //=============================
 
+#define RESOURCE_EVICT_INTERVAL 60 // how many frames apart the budgets are enforced
+
 namespace Directus
 {
 	ResourceManager::ResourceManager(Context* context) : Subsystem(context)
 	{
 		m_resourceCache = nullptr;
 		SUBSCRIBE_TO_EVENT(EVENT_WORLD_UNLOAD, EVENT_HANDLER(Clear));
+		SUBSCRIBE_TO_EVENT(EVENT_FRAME_END, EVENT_HANDLER(Budgets_Tick));
+		SUBSCRIBE_TO_EVENT(EVENT_FRAME_END, EVENT_HANDLER(HotReload_Tick));
 	}
 
 	bool ResourceManager::Initialize()
@@ -48,6 +54,7 @@ namespace Directus
 		m_modelImporter = make_shared<ModelImporter>(m_context);
 		m_fontImporter = make_shared<FontImporter>(m_context);
 		m_fontImporter->Initialize();
+		m_derivedDataCache = make_shared<DerivedDataCache>(m_context);
 		
 		// Add engine standard resource directories
 		AddStandardResourceDirectory(Resource_Texture,	"Standard Assets//Textures//");
@@ -61,14 +68,111 @@ namespace Directus
 		// Add project directory
 		SetProjectDirectory("Project//");
 
+		// Packs next to the engine take precedence over loose files
+		PackFile::Mount_Directory(FileSystem::GetWorkingDirectory());
+
+		// Textures can be as large as the rest combined, only keep them on the GPU
+		SetResidency(Resource_Texture, Residency_ReleaseAfterUpload);
+
+		// Edits to the assets show up without reloading the world
+		HotReload_Enable(true);
+
 		return true;
 	}
 
+	void ResourceManager::HotReload_Enable(bool enable)
+	{
+		if (!enable)
+		{
+			m_fileWatcher.reset();
+			return;
+		}
+
+		if (!m_fileWatcher)
+		{
+			m_fileWatcher = make_unique<FileWatcher>(FileSystem::GetWorkingDirectory());
+		}
+	}
+
+	void ResourceManager::HotReload_Tick()
+	{
+		// Nothing uses the device at the end of a frame, so resources can be rebuilt in place
+		if (!m_fileWatcher || !m_resourceCache)
+			return;
+
+		for (const auto& filePath : m_fileWatcher->GetChanges())
+		{
+			if (FileSystem::FileExists(filePath))
+			{
+				HotReload(filePath);
+			}
+		}
+	}
+
+	void ResourceManager::HotReload(const string& filePath)
+	{
+		// Only the permutations that compile the file (or include it) compile again
+		if (FileSystem::IsSupportedShaderFile(filePath))
+		{
+			for (const auto& shader : GetResourcesByType<ShaderVariation>())
+			{
+				if (shader->DependsOn(filePath))
+				{
+					shader->Recompile();
+				}
+			}
+			return;
+		}
+
+		// A texture is named after the image it was imported from, importing it again into the same texture keeps every reference to it valid
+		if (FileSystem::IsSupportedImageFile(filePath))
+		{
+			auto texture = GetResourceByName<RHI_Texture>(FileSystem::GetFileNameNoExtensionFromFilePath(filePath));
+			if (!texture)
+				return;
+
+			// Importing moves the texture next to the image, it goes back to where it was kept (e.g. a model's directory)
+			string name			= texture->GetResourceName();
+			string nativePath	= texture->GetResourceFilePath();
+			if (!texture->LoadFromFile(filePath))
+				return;
+
+			texture->SetResourceName(name);
+			texture->SetResourceFilePath(nativePath);
+			if (FileSystem::IsEngineTextureFile(nativePath) && texture->SaveToFile(nativePath))
+			{
+				texture->Resource_MarkClean();
+			}
+
+			LOGF_INFO("ResourceManager::HotReload: Reloaded \"%s\"", name.c_str());
+		}
+	}
+
+	void ResourceManager::Budgets_Tick()
+	{
+		if (!m_resourceCache)
+			return;
+
+		// Nothing renders at the end of a frame, so nothing uses what isn't referenced
+		m_resourceCache->Frame_Advance();
+		if (++m_budgetFrames < RESOURCE_EVICT_INTERVAL)
+			return;
+
+		m_budgetFrames = 0;
+		m_resourceCache->Evict();
+	}
+
 	void ResourceManager::AddStandardResourceDirectory(Resource_Type type, const string& directory)
 	{
 		m_standardResourceDirectories[type] = directory;
 	}
 
+	Resource_Residency ResourceManager::GetResidency(Resource_Type type)
+	{
+		auto it = m_residencies.find(type);
+		return it != m_residencies.end() ? it->second : Residency_Keep;
+	}
+
 	const string& ResourceManager::GetStandardResourceDirectory(Resource_Type type)
 	{
 		for (auto& directory : m_standardResourceDirectories)
@@ -88,10 +192,48 @@ namespace Directus
 		}
 
 		m_projectDirectory = directory;
+		if (m_derivedDataCache)
+		{
+			m_derivedDataCache->SetDirectory_Local(directory + "Derived_Data//");
+		}
 	}
 
 	string ResourceManager::GetProjectDirectoryAbsolute()
 	{
 		return FileSystem::GetWorkingDirectory() + m_projectDirectory;
 	}
+
+	const ResourceManager::Primitive& ResourceManager::Primitive_Get(GeometryType type)
+	{
+		lock_guard<mutex> lock(m_primitivesMutex);
+		auto& primitive = m_primitives[type];
+		if (primitive.model || type == Geometry_Custom)
+			return primitive;
+
+		vector<RHI_Vertex_PosUVTBN> vertices;
+		vector<unsigned int> indices;
+		string name;
+		switch (type)
+		{
+			case Geometry_Default_Cube:		GeometryUtility::CreateCube(&vertices, &indices);		name = "Default_Cube";		break;
+			case Geometry_Default_Quad:		GeometryUtility::CreateQuad(&vertices, &indices);		name = "Default_Quad";		break;
+			case Geometry_Default_Sphere:	GeometryUtility::CreateSphere(&vertices, &indices);		name = "Default_Sphere";	break;
+			case Geometry_Default_Cylinder:	GeometryUtility::CreateCylinder(&vertices, &indices);	name = "Default_Cylinder";	break;
+			case Geometry_Default_Cone:		GeometryUtility::CreateCone(&vertices, &indices);		name = "Default_Cone";		break;
+			default: break;
+		}
+
+		if (vertices.empty() || indices.empty())
+			return primitive;
+
+		auto model = make_shared<Model>(m_context);
+		model->SetResourceName(name);
+		primitive.indexCount	= (unsigned int)indices.size();
+		primitive.vertexCount	= (unsigned int)vertices.size();
+		model->Geometry_Append(indices, vertices, nullptr, nullptr);
+		model->Geometry_Update();
+		primitive.model = model;
+
+		return primitive;
+	}
 }
@@ -24,15 +24,23 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <map>
+#include <future>
+#include <unordered_map>
 #include "ResourceCache.h"
+#include "DerivedDataCache.h"
 #include "Import/ModelImporter.h"
 #include "Import/ImageImporter.h"
 #include "Import/FontImporter.h"
 #include "../Core/SubSystem.h"
+#include "../Threading/Threading.h"
+#include "../FileSystem/PackFile.h"
+#include "../FileSystem/FileWatcher.h"
 #include "../Audio/AudioClip.h"
 #include "../RHI/RHI_Texture.h"
 #include "../Rendering/Model.h"
+#include "../Profiling/MemoryTracker.h"
 #include "../Rendering/Material.h"
+#include "../World/Components/Renderable.h"
 //================================
 
 namespace Directus
@@ -41,7 +49,7 @@ namespace Directus
 	{
 	public:
 		ResourceManager(Context* context);
-		~ResourceManager() { Clear(); }
+		~ResourceManager() { m_fileWatcher.reset(); Clear(); PackFile::Unmount_All(); }
 
 		//= Subsystem =============
 		bool Initialize() override;
@@ -71,13 +79,17 @@ namespace Directus
 			}
 
 			// Create new resource
+			MEMORY_TAG(MemoryTag_Resource);
 			auto typed = std::make_shared<T>(m_context);
 			// Set a default name and a default filepath in case it's not overridden by LoadFromFile()
 			typed->SetResourceName(name);
 			typed->SetResourceFilePath(filePathRelative);
 
-			// Cache it now so LoadFromFile() can safely pass around a reference to the resource from the ResourceManager
-			Add<T>(typed);
+			// Cache it now so LoadFromFile() can safely pass around a reference to the resource from the ResourceManager,
+			// another thread might have cached the same one since it was looked up, then that one is what gets returned
+			auto cached = Add<T>(typed);
+			if (cached != typed)
+				return cached;
 
 			// Load
 			if (!typed->LoadFromFile(filePathRelative))
@@ -85,11 +97,68 @@ namespace Directus
 				LOGF_WARNING("ResourceManager::Load: Resource \"%s\" failed to load", filePathRelative.c_str());
 				return nullptr;
 			}
+			// Engine files carry the name, path and ID, which get read straight into the resource
+			m_resourceCache->Reindex(typed.get());
+
+			// Read from it's own engine file, there is nothing to save until it changes
+			if (FileSystem::IsEngineFile(filePathRelative) && typed->GetResourceFilePath() == filePathRelative)
+			{
+				typed->Resource_MarkClean();
+			}
 
 			// Cache it and cast it
 			return typed;
 		}
 
+		// Loads a resource on a worker thread, a load of the same one that is still in flight is shared
+		template <class T>
+		std::shared_future<std::shared_ptr<T>> LoadAsync(const std::string& filePath)
+		{
+			std::string filePathRelative	= FileSystem::GetRelativeFilePath(filePath);
+			std::string name				= FileSystem::GetFileNameNoExtensionFromFilePath(filePathRelative);
+			std::string key					= std::to_string(IResource::DeduceResourceType<T>()) + ":" + filePathRelative;
+
+			auto promise	= std::make_shared<std::promise<std::shared_ptr<T>>>();
+			auto future		= promise->get_future().share();
+			{
+				std::lock_guard<std::mutex> lock(m_loadsMutex);
+				auto it = m_loads.find(key);
+				if (it != m_loads.end())
+					return *std::static_pointer_cast<std::shared_future<std::shared_ptr<T>>>(it->second);
+
+				// Cached already, there is nothing to wait for
+				if (auto cached = GetResourceByName<T>(name))
+				{
+					promise->set_value(cached);
+					return future;
+				}
+
+				m_loads[key] = std::make_shared<std::shared_future<std::shared_ptr<T>>>(future);
+			}
+
+			// Not under the lock, without worker threads the task runs right here
+			m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [this, promise, key, filePathRelative]()
+			{
+				auto resource = Load<T>(filePathRelative);
+				{
+					std::lock_guard<std::mutex> lock(m_loadsMutex);
+					m_loads.erase(key);
+				}
+				promise->set_value(resource);
+			});
+
+			return future;
+		}
+
+		// Blocks until an asynchronous load is done, running queued tasks meanwhile so a
+		// load that waits on others (e.g. a material on it's textures) can't starve them
+		template <class T>
+		std::shared_ptr<T> Wait(const std::shared_future<std::shared_ptr<T>>& future)
+		{
+			m_context->GetSubsystem<Threading>()->Task_Wait(future);
+			return future.get();
+		}
+
 		// Adds a resource into the cache and returns the derived resource as a weak reference
 		template <class T>
 		std::shared_ptr<T> Add(std::shared_ptr<IResource> resource)
@@ -97,48 +166,38 @@ namespace Directus
 			if (!resource)
 				return nullptr;
 
-			// If the resource is already loaded, return the existing one
-			if (m_resourceCache->IsCached(resource))
-			{
-				return GetResourceByName<T>(FileSystem::GetFileNameNoExtensionFromFilePath(resource->GetResourceFilePath()));
-			}
-
-			Add(resource);
-			return std::dynamic_pointer_cast<T>(resource);
+			// If the resource is already loaded, the existing one is returned
+			return std::dynamic_pointer_cast<T>(m_resourceCache->Add(resource));
 		}
 
 		// Adds a resource into the cache (if it's not already cached)
-		void Add(std::shared_ptr<IResource> resource)
+		void Add(const std::shared_ptr<IResource>& resource)
 		{
-			if (!resource || m_resourceCache->IsCached(resource))
-				return;
-
-			// Add the resource
 			m_resourceCache->Add(resource);
 		}
 
 		// Returns cached resource by name
 		template <class T>
-		std::shared_ptr<T> GetResourceByName(const std::string& name)
+		std::shared_ptr<T> GetResourceByName(const StringId& name)
 		{
 			return std::dynamic_pointer_cast<T>(m_resourceCache->GetByName<T>(name));
 		}
 
 		// Returns cached resource by name
-		std::shared_ptr<IResource> GetResourceByName(const std::string& name, Resource_Type type)
+		std::shared_ptr<IResource> GetResourceByName(const StringId& name, Resource_Type type)
 		{
 			return m_resourceCache->GetByName(name, type);
 		}
 
 		// Checks if a resource exists
-		bool ExistsByName(const std::string& name, Resource_Type type)
+		bool ExistsByName(const StringId& name, Resource_Type type)
 		{
 			return m_resourceCache->GetByName(name, type) != nullptr;
 		}
 
 		// Returns cached resource by path
 		template <class T>
-		std::shared_ptr<T> GetResourceByPath(const std::string& path)
+		std::shared_ptr<T> GetResourceByPath(const StringId& path)
 		{
 			return std::dynamic_pointer_cast<T>(m_resourceCache->GetByPath<T>(path));
 		}
@@ -163,18 +222,13 @@ namespace Directus
 
 		std::vector<std::shared_ptr<IResource>> GetResourcesByType(Resource_Type type)
 		{
-			std::vector<std::shared_ptr<IResource>> vec;
-			for (const auto& resource : m_resourceCache->GetByType(type))
-			{
-				vec.emplace_back(resource);
-			}
-			return vec;
+			return m_resourceCache->GetByType(type);
 		}
 
 		// Returns all resources of a given type
 		unsigned int GetResourceCountByType(Resource_Type type)
 		{
-			return (unsigned int)m_resourceCache->GetByType(type).size();
+			return m_resourceCache->GetCount(type);
 		}
 
 		auto GetResourceAll() 
@@ -204,19 +258,62 @@ namespace Directus
 		const std::string& GetProjectDirectory()		{ return m_projectDirectory; }	
 		std::string GetProjectStandardAssetsDirectory() { return m_projectDirectory + "Standard_Assets//"; }
 
+		// Budgets, in bytes of memory usage per type (0 is unlimited), see ResourceCache::SetBudget
+		void SetBudget(Resource_Type type, unsigned int bytes)	{ m_resourceCache->SetBudget(type, bytes); }
+		unsigned int GetBudget(Resource_Type type)				{ return m_resourceCache->GetBudget(type); }
+
+		// Residency
+		void SetResidency(Resource_Type type, Resource_Residency residency) { m_residencies[type] = residency; }
+		Resource_Residency GetResidency(Resource_Type type);
+
 		// Importers
 		ModelImporter* GetModelImporter()	{ return m_modelImporter.get(); }
 		ImageImporter* GetImageImporter()	{ return m_imageImporter.get(); }
 		FontImporter* GetFontImporter()		{ return m_fontImporter.get(); }
 
+		// What imports produced, so importing the same source again can be skipped
+		DerivedDataCache* GetDerivedDataCache() { return m_derivedDataCache.get(); }
+
+		// Hot reload, source files that change on disk (images and shaders) are reloaded into the resources made of them, in place
+		void HotReload_Enable(bool enable);
+		bool HotReload_IsEnabled() { return m_fileWatcher != nullptr; }
+
+		// The model of a default geometry (see Renderable::Geometry_Set), built on first use and shared by every renderable of
+		// that type, so they sort and instance together. The engine owns them, they aren't cached and outlive a world unload.
+		struct Primitive
+		{
+			std::shared_ptr<Model> model;
+			unsigned int indexCount		= 0;
+			unsigned int vertexCount	= 0;
+		};
+		const Primitive& Primitive_Get(GeometryType type);
+
 	private:
+		// Advances the cache's frame, and every so often evicts what is over budget
+		void Budgets_Tick();
+		// Reloads what changed on disk since the last frame
+		void HotReload_Tick();
+		void HotReload(const std::string& filePath);
+
 		std::unique_ptr<ResourceCache> m_resourceCache;
+		unsigned int m_budgetFrames = 0;
 		std::map<Resource_Type, std::string> m_standardResourceDirectories;
+		std::map<Resource_Type, Resource_Residency> m_residencies;
 		std::string m_projectDirectory;
 
+		// Asynchronous loads in flight, by type and path, each is a std::shared_future<std::shared_ptr<T>>
+		std::unordered_map<std::string, std::shared_ptr<void>> m_loads;
+		std::mutex m_loadsMutex;
+
 		// Importers
 		std::shared_ptr<ModelImporter> m_modelImporter;
 		std::shared_ptr<ImageImporter> m_imageImporter;
 		std::shared_ptr<FontImporter> m_fontImporter;
+		std::shared_ptr<DerivedDataCache> m_derivedDataCache;
+
+		std::unique_ptr<FileWatcher> m_fileWatcher;
+
+		Primitive m_primitives[Geometry_Default_Cone + 1];
+		std::mutex m_primitivesMutex;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,300 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "TextureStreaming.h"
+#include <algorithm>
+#include <cmath>
+#include "../Core/EventSystem.h"
+#include "../Threading/Threading.h"
+#include "../IO/AsyncIO.h"
+#include "../Rendering/Material.h"
+#include "../Rendering/Renderer.h"
+#include "../Math/MathHelper.h"
+//=====================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math::Helper;
+//=============================
+
+namespace Directus
+{
+	TextureStreaming::TextureStreaming(Context* context) : Subsystem(context)
+	{
+		SUBSCRIBE_TO_EVENT(EVENT_FRAME_END, EVENT_HANDLER(Tick));
+	}
+
+	TextureStreaming::~TextureStreaming()
+	{
+		// Loads hold on to this
+		while (m_tasks > 0)
+		{
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+	}
+
+	bool TextureStreaming::Initialize()
+	{
+		m_threading = m_context->GetSubsystem<Threading>();
+		return true;
+	}
+
+	void TextureStreaming::Texture_Add(const shared_ptr<RHI_Texture>& texture)
+	{
+		if (!texture || !texture->Streaming_IsStreamable())
+			return;
+
+		Entry entry;
+		entry.texture		= texture;
+		entry.mipDefault	= texture->Streaming_GetMipDefault();
+		entry.mipResident	= texture->Streaming_GetMipResident();
+		entry.mipWanted		= entry.mipResident;
+		entry.bytes			= texture->Streaming_GetBytes(entry.mipResident);
+
+		lock_guard<mutex> lock(m_entriesMutex);
+		entry.frameWanted	= m_frame;
+		m_entries.emplace_back(entry);
+	}
+
+	void TextureStreaming::Material_Request(Material* material, float pixels)
+	{
+		if (!material || pixels <= 0.0f)
+			return;
+
+		// Tiling repeats the texture across the surface, so more of it lands on every pixel
+		const auto& tiling	= material->GetTiling();
+		pixels				*= Max(Max(tiling.x, tiling.y), 0.01f);
+
+		for (const auto& slot : material->GetTextureSlots())
+		{
+			auto texture = slot.ptr_raw;
+			if (!texture || slot.type == TextureType_CubeMap || !texture->Streaming_IsStreamable())
+				continue;
+
+			// The mip which has about one texel per pixel
+			float size	= (float)Max(texture->GetWidth(), texture->GetHeight());
+			float mip	= log2(size / pixels) + TEXTURE_STREAMING_MIP_BIAS;
+			texture->Streaming_Request(mip <= 0.0f ? 0 : Min((unsigned int)mip, texture->Streaming_GetMipCount() - 1));
+		}
+	}
+
+	unsigned int TextureStreaming::GetTextureCount()
+	{
+		lock_guard<mutex> lock(m_entriesMutex);
+		return (unsigned int)m_entries.size();
+	}
+
+	void TextureStreaming::Tick()
+	{
+		lock_guard<mutex> lock(m_entriesMutex);
+		m_frame++;
+
+		Apply();
+
+		// Decide which mips every texture wants. Sharper requests are followed right away, coarser ones only once they've
+		// lasted for a while, and textures which weren't seen at all fall back to the mips they were loaded with.
+		m_memoryUsage = 0;
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			auto texture = it->texture.lock();
+			if (!texture)
+			{
+				it = m_entries.erase(it);
+				continue;
+			}
+
+			auto request = texture->Streaming_ConsumeRequest();
+			if (request < texture->Streaming_GetMipCount())
+			{
+				it->frameUsed = m_frame;
+			}
+			request = Min(request, it->mipDefault);
+
+			if (request <= it->mipWanted || m_frame - it->frameWanted > TEXTURE_STREAMING_EVICT_FRAMES)
+			{
+				it->mipWanted	= request;
+				it->frameWanted	= m_frame;
+			}
+
+			m_memoryUsage += it->bytes;
+			it++;
+		}
+
+		if (!m_enabled)
+			return;
+
+		// Drops go first since they make room, then the textures which are missing the most detail
+		vector<Entry*> pending;
+		for (auto& entry : m_entries)
+		{
+			if (!entry.loading && !entry.failed && entry.mipWanted != entry.mipResident)
+			{
+				pending.emplace_back(&entry);
+			}
+		}
+		sort(pending.begin(), pending.end(), [](Entry* a, Entry* b)
+		{
+			bool aDrop = a->mipWanted > a->mipResident;
+			bool bDrop = b->mipWanted > b->mipResident;
+			if (aDrop != bDrop)
+				return aDrop;
+
+			return (int)a->mipResident - (int)a->mipWanted > (int)b->mipResident - (int)b->mipWanted;
+		});
+
+		for (auto entry : pending)
+		{
+			if (m_loads >= TEXTURE_STREAMING_LOADS_MAX)
+				break;
+
+			auto texture	= entry->texture.lock();
+			auto mip		= entry->mipWanted;
+			if (mip < entry->mipResident)
+			{
+				// Over budget, make room for later and settle for fewer mips now
+				auto required = [&](unsigned int firstMip) { return m_memoryUsage + m_memoryPending + texture->Streaming_GetBytes(firstMip) - entry->bytes; };
+				if (required(mip) > m_budget)
+				{
+					Evict(required(mip) - m_budget);
+				}
+
+				while (mip < entry->mipResident && required(mip) > m_budget) { mip++; }
+				if (mip == entry->mipResident)
+					continue;
+			}
+
+			Load_Start(entry, texture, mip);
+		}
+	}
+
+	void TextureStreaming::Apply()
+	{
+		// Take the finished loads the upload budget allows, at least one so a large mip can't stall streaming
+		vector<shared_ptr<Load>> loads;
+		unsigned int uploaded = 0;
+		while (auto loaded = m_loaded.Front())
+		{
+			if (!loads.empty() && uploaded >= TEXTURE_STREAMING_UPLOAD_MB * 1024 * 1024)
+				break;
+
+			uploaded += (*loaded)->texture->Streaming_GetBytes((*loaded)->firstMip);
+			loads.emplace_back(move(*loaded));
+			m_loaded.Pop();
+		}
+
+		for (const auto& load : loads)
+		{
+			m_loads--;
+			m_memoryPending -= load->bytes;
+
+			auto entry = find_if(m_entries.begin(), m_entries.end(), [&load](const Entry& entry) { return entry.texture.lock() == load->texture; });
+			if (entry == m_entries.end())
+				continue;
+
+			entry->loading = false;
+			if (load->loaded && load->texture->Streaming_Apply(load->firstMip, load->mips))
+			{
+				entry->mipResident	= load->firstMip;
+				entry->bytes		= load->texture->Streaming_GetBytes(load->firstMip);
+			}
+			else
+			{
+				entry->failed = true;
+			}
+		}
+
+		// Sharper mips are worth showing, even when the world is rendered on demand
+		if (!loads.empty())
+		{
+			if (auto renderer = m_context->GetSubsystem<Renderer>())
+			{
+				renderer->RenderOnDemand_Request();
+			}
+		}
+	}
+
+	void TextureStreaming::Evict(unsigned int bytes)
+	{
+		// Textures which weren't seen this frame, least recently seen first
+		vector<Entry*> candidates;
+		for (auto& entry : m_entries)
+		{
+			if (!entry.loading && entry.frameUsed < m_frame && entry.mipWanted < entry.mipDefault)
+			{
+				candidates.emplace_back(&entry);
+			}
+		}
+		sort(candidates.begin(), candidates.end(), [](Entry* a, Entry* b) { return a->frameUsed < b->frameUsed; });
+
+		// Dropping them back to their default mips happens along with the other drops next frame
+		unsigned int freed = 0;
+		for (auto entry : candidates)
+		{
+			if (freed >= bytes)
+				break;
+
+			if (auto texture = entry->texture.lock())
+			{
+				freed				+= entry->bytes - texture->Streaming_GetBytes(entry->mipDefault);
+				entry->mipWanted	= entry->mipDefault;
+				entry->frameWanted	= m_frame;
+			}
+		}
+	}
+
+	void TextureStreaming::Load_Start(Entry* entry, const shared_ptr<RHI_Texture>& texture, unsigned int firstMip)
+	{
+		auto load		= make_shared<Load>();
+		load->texture	= texture;
+		load->firstMip	= firstMip;
+		load->bytes		= firstMip < entry->mipResident ? texture->Streaming_GetBytes(firstMip) - entry->bytes : 0;
+
+		entry->loading	= true;
+		m_loads++;
+		m_memoryPending	+= load->bytes;
+		m_tasks++;
+
+		// The mips are read without a worker waiting on the disk, a compressed file has to be read through FileStream
+		uint64_t offset	= 0;
+		uint64_t size	= 0;
+		auto asyncIO	= m_context->GetSubsystem<AsyncIO>();
+		if (asyncIO && texture->Streaming_GetRange(firstMip, &offset, &size))
+		{
+			load->data.resize((size_t)size);
+			asyncIO->Read(texture->Streaming_GetFilePath(), offset, size, load->data.data(), IO_Priority_Streaming, [this, load](bool read)
+			{
+				load->loaded = read && load->texture->Streaming_Load(load->firstMip, load->data.data(), load->data.size(), &load->mips);
+				load->data = vector<std::byte>();
+				m_loaded.Push(load);
+				m_tasks--;
+			}, ThreadGroup_Background);
+			return;
+		}
+
+		m_threading->AddTask(ThreadGroup_Background, [this, load]()
+		{
+			load->loaded = load->texture->Streaming_Load(load->firstMip, &load->mips);
+			m_loaded.Push(load);
+			m_tasks--;
+		});
+	}
+}
@@ -0,0 +1,116 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "../Core/SubSystem.h"
+#include "../Core/RingQueue.h"
+#include "../RHI/RHI_Texture.h"
+//=============================
+
+#define TEXTURE_STREAMING_RESIDENT_SIZE		64		// mips up to this size are loaded with the texture and never leave
+#define TEXTURE_STREAMING_BUDGET_MB			512		// video memory the textures which stream may use, their resident mips included
+#define TEXTURE_STREAMING_UPLOAD_MB			16		// streamed in mips handed to the GPU per frame, more waits for the next one
+#define TEXTURE_STREAMING_LOADS_MAX			8		// mip chains being read (or waiting to be uploaded) at once
+#define TEXTURE_STREAMING_EVICT_FRAMES		120		// frames a texture keeps mips it no longer needs, so they don't come and go
+#define TEXTURE_STREAMING_MIP_BIAS			0.0f	// added to the mip a screen size asks for, positive values stream less
+
+namespace Directus
+{
+	class Material;
+	class Threading;
+
+	// Keeps the large mips of engine textures on the GPU only while something is seen at a size which needs them.
+	// The renderer requests mips for the materials it draws, Tick() reads the missing ones from disk on worker threads,
+	// uploads a few per frame, and drops them again once they've gone unused for a while or no longer fit the budget.
+	class ENGINE_CLASS TextureStreaming : public Subsystem
+	{
+	public:
+		TextureStreaming(Context* context);
+		~TextureStreaming();
+
+		//= Subsystem =============
+		bool Initialize() override;
+		//=========================
+
+		// Textures which were loaded with their low mips only add themselves (thread safe)
+		void Texture_Add(const std::shared_ptr<RHI_Texture>& texture);
+		// Requests the mips a material's textures need when it covers this many pixels of the screen's height (thread safe)
+		void Material_Request(Material* material, float pixels);
+
+		//= PROPERTIES =========================================================
+		bool IsEnabled()					{ return m_enabled; }
+		// Textures loaded while disabled have all of their mips resident
+		void SetEnabled(bool enabled)		{ m_enabled = enabled; }
+		unsigned int GetBudget()			{ return m_budget; }
+		void SetBudget(unsigned int bytes)	{ m_budget = bytes; }
+		unsigned int GetMemoryUsage()		{ return m_memoryUsage; }
+		unsigned int GetTextureCount();
+		//======================================================================
+
+	private:
+		struct Entry
+		{
+			std::weak_ptr<RHI_Texture> texture;
+			unsigned int mipDefault		= 0;
+			unsigned int mipResident	= 0;
+			unsigned int mipWanted		= 0;
+			unsigned int bytes			= 0; // of the resident mips
+			uint64_t frameWanted		= 0; // when mipWanted last got sharper (or stayed)
+			uint64_t frameUsed			= 0;
+			bool loading				= false;
+			bool failed					= false; // its file couldn't be read, it keeps what it has
+		};
+
+		struct Load
+		{
+			std::shared_ptr<RHI_Texture> texture;
+			unsigned int firstMip	= 0;
+			unsigned int bytes		= 0; // reserved from the budget until it's applied
+			std::vector<Mipmap> mips;
+			std::vector<std::byte> data; // the file range of the mips, while it's read
+			bool loaded				= false;
+		};
+
+		// Streams in and out, once per frame
+		void Tick();
+		void Apply();
+		void Evict(unsigned int bytes);
+		void Load_Start(Entry* entry, const std::shared_ptr<RHI_Texture>& texture, unsigned int firstMip);
+
+		std::vector<Entry> m_entries;
+		std::mutex m_entriesMutex;
+		RingQueue_MPSC<std::shared_ptr<Load>, TEXTURE_STREAMING_LOADS_MAX> m_loaded; // never full, there are no more loads than that
+		std::atomic<unsigned int> m_tasks	= 0;
+		unsigned int m_loads				= 0; // started, not applied yet
+		unsigned int m_budget				= TEXTURE_STREAMING_BUDGET_MB * 1024 * 1024;
+		unsigned int m_memoryUsage			= 0;
+		unsigned int m_memoryPending		= 0;
+		uint64_t m_frame					= 0;
+		bool m_enabled						= true;
+		Threading* m_threading				= nullptr;
+	};
+}
@@ -22,16 +22,66 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =============================
 #include "Module.h"
 #include <scriptbuilder/scriptbuilder.cpp>
+#include <fstream>
+#include <sstream>
+#include <string_view>
 #include "Scripting.h"
+#include "ScriptInterface.h"
 #include "../Logging/Log.h"
 #include "../FileSystem/FileSystem.h"
+#include "../IO/FileStream.h"
+#include "../Resource/ResourceManager.h"
 //========================================
 
 namespace Directus
 {
+	namespace _Module
+	{
+		// Bytecode in memory, AngelScript reads and writes it through this
+		class ByteStream : public asIBinaryStream
+		{
+		public:
+			ByteStream(vector<std::byte>* bytes) { m_bytes = bytes; }
+
+			int Write(const void* ptr, asUINT size) override
+			{
+				auto data = (const std::byte*)ptr;
+				m_bytes->insert(m_bytes->end(), data, data + size);
+				return 0;
+			}
+
+			int Read(void* ptr, asUINT size) override
+			{
+				if (m_offset + size > m_bytes->size())
+					return -1;
+
+				memcpy(ptr, m_bytes->data() + m_offset, size);
+				m_offset += size;
+				return 0;
+			}
+
+		private:
+			vector<std::byte>* m_bytes;
+			size_t m_offset = 0;
+		};
+
+		// Of the content, 0 if it can't be read
+		inline uint64_t HashFile(const string& filePath)
+		{
+			ifstream in(filePath, ios::in | ios::binary);
+			if (in.fail())
+				return 0;
+
+			ostringstream content;
+			content << in.rdbuf();
+			return (uint64_t)hash<string_view>()(content.str());
+		}
+	}
+
 	Module::Module(const string& moduleName, Scripting* scriptEngine)
 	{
 		m_builder = nullptr;
+		m_module = nullptr;
 		m_moduleName = moduleName;
 		m_scriptEngine = scriptEngine;
 	}
@@ -44,6 +94,22 @@ namespace Directus
 
 	bool Module::LoadScript(const string& filePath)
 	{
+		// A script compiled before, when it (or what it includes) hasn't changed since, loads without compiling.
+		// The key also covers the interface it was compiled against and the AngelScript version.
+		string bytecodeKey;
+		string bytecodeFilePath = FileSystem::GetFilePathWithoutExtension(filePath) + EXTENSION_BYTECODE;
+		auto resourceManager	= m_scriptEngine->GetContext()->GetSubsystem<ResourceManager>();
+		auto ddc				= resourceManager ? resourceManager->GetDerivedDataCache() : nullptr;
+		if (ddc)
+		{
+			bytecodeKey = ddc->GetKey(filePath, "Script", ScriptInterface::GetVersion(), hash<string>()(ANGELSCRIPT_VERSION_STRING));
+			if (Bytecode_Load(bytecodeFilePath, bytecodeKey))
+				return true;
+
+			if (ddc->Fetch(bytecodeKey, bytecodeFilePath) && Bytecode_Load(bytecodeFilePath, bytecodeKey))
+				return true;
+		}
+
 		// start new module
 		m_builder = new CScriptBuilder();
 		int result = m_builder->StartNewModule(m_scriptEngine->GetAsIScriptEngine(), m_moduleName.c_str());
@@ -68,12 +134,91 @@ namespace Directus
 			LOG_ERROR("Failed to compile script \"" + FileSystem::GetFileNameFromFilePath(filePath) + "\". Correct any errors and try again.");
 			return false;
 		}
+		m_module = m_builder->GetModule();
+
+		if (ddc && !bytecodeKey.empty())
+		{
+			Bytecode_Save(bytecodeFilePath, bytecodeKey);
+			ddc->Store(bytecodeKey, bytecodeFilePath);
+		}
 
 		return true;
 	}
 
 	asIScriptModule* Module::GetAsIScriptModule()
 	{
-		return m_builder->GetModule();
+		return m_module;
+	}
+
+	bool Module::Bytecode_Load(const string& filePath, const string& key)
+	{
+		if (key.empty() || !FileSystem::FileExists(filePath))
+			return false;
+
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Read);
+		if (!file->IsOpen())
+			return false;
+
+		string keyCompiled;
+		file->Read(&keyCompiled);
+		if (keyCompiled != key)
+			return false;
+
+		// The key only covers the script itself, the files it included are checked here
+		unsigned int sectionCount = 0;
+		file->Read(&sectionCount);
+		for (unsigned int i = 0; i < sectionCount; i++)
+		{
+			string section;
+			uint64_t sectionHash = 0;
+			file->Read(&section);
+			file->Read(&sectionHash);
+			if (_Module::HashFile(section) != sectionHash)
+				return false;
+		}
+
+		vector<std::byte> bytecode;
+		file->Read(&bytecode);
+		file.reset();
+
+		auto module = m_scriptEngine->GetAsIScriptEngine()->GetModule(m_moduleName.c_str(), asGM_ALWAYS_CREATE);
+		if (!module)
+			return false;
+
+		_Module::ByteStream stream(&bytecode);
+		if (module->LoadByteCode(&stream) < 0)
+		{
+			LOGF_WARNING("Module::Bytecode_Load: Failed to load \"%s\", compiling instead", filePath.c_str());
+			m_scriptEngine->DiscardModule(m_moduleName);
+			return false;
+		}
+
+		m_module = module;
+		return true;
+	}
+
+	void Module::Bytecode_Save(const string& filePath, const string& key)
+	{
+		vector<std::byte> bytecode;
+		_Module::ByteStream stream(&bytecode);
+		if (m_module->SaveByteCode(&stream) < 0)
+		{
+			LOGF_WARNING("Module::Bytecode_Save: Failed to save the bytecode of \"%s\"", m_moduleName.c_str());
+			return;
+		}
+
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_Write);
+		if (!file->IsOpen())
+			return;
+
+		file->Write(key);
+		file->Write(m_builder->GetSectionCount());
+		for (unsigned int i = 0; i < m_builder->GetSectionCount(); i++)
+		{
+			string section = m_builder->GetSectionName(i);
+			file->Write(section);
+			file->Write(_Module::HashFile(section));
+		}
+		file->Write(bytecode);
 	}
-}
\ No newline at end of file
+}
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ====
 #include <string>
+#include <vector>
 //===============
 
 class asIScriptModule;
@@ -43,7 +44,12 @@ namespace Directus
 		asIScriptModule* GetAsIScriptModule();
 
 	private:
+		// Bytecode compiled from the same script (and the same files it includes), against the same interface
+		bool Bytecode_Load(const std::string& filePath, const std::string& key);
+		void Bytecode_Save(const std::string& filePath, const std::string& key);
+
 		std::string m_moduleName;
+		asIScriptModule* m_module;
 		CScriptBuilder* m_builder;
 		Scripting* m_scriptEngine;
 	};
@@ -87,7 +87,7 @@ namespace Directus
 
 	void ScriptInstance::ExecuteUpdate()
 	{
-		m_scriptEngine->ExecuteCall(m_updateFunction, m_scriptObject);
+		m_scriptEngine->Update_Queue(m_updateFunction, m_scriptObject);
 	}
 
 	bool ScriptInstance::CreateScriptObject()
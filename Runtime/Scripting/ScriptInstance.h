@@ -45,6 +45,7 @@ namespace Directus
 		std::string GetScriptPath() { return m_scriptPath; }
 
 		void ExecuteStart();
+		// Queued, see Scripting::Update_Dispatch()
 		void ExecuteUpdate();
 
 	private:
@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/Camera.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
+#include "ScriptJob.h"
 //=========================================
 
 //= NAMESPACES ========================
@@ -59,6 +60,7 @@ namespace Directus
 		RegisterRigidBody();
 		Registeractor();
 		RegisterDebug();
+		RegisterJobs();
 	}
 
 	void ScriptInterface::RegisterEnumerations()
@@ -82,6 +84,10 @@ namespace Directus
 		m_scriptEngine->RegisterEnumValue("ComponentType", "Script",		int(ComponentType_Script));
 		m_scriptEngine->RegisterEnumValue("ComponentType", "Skybox",		int(ComponentType_Skybox));
 		m_scriptEngine->RegisterEnumValue("ComponentType", "Transform",		int(ComponentType_Transform));
+		m_scriptEngine->RegisterEnumValue("ComponentType", "ParticleEmitter",	int(ComponentType_ParticleEmitter));
+		m_scriptEngine->RegisterEnumValue("ComponentType", "Terrain",			int(ComponentType_Terrain));
+		m_scriptEngine->RegisterEnumValue("ComponentType", "LightProbeVolume",	int(ComponentType_LightProbeVolume));
+		m_scriptEngine->RegisterEnumValue("ComponentType", "ReflectionProbe",	int(ComponentType_ReflectionProbe));
 
 		// Button_Keyboard
 		m_scriptEngine->RegisterEnum("Button_Keyboard");
@@ -170,7 +176,7 @@ namespace Directus
 	void ScriptInterface::RegisterTime()
 	{
 		m_scriptEngine->RegisterGlobalProperty("Time time", m_context->GetSubsystem<Timer>());
-		m_scriptEngine->RegisterObjectMethod("Time", "float GetDeltaTime()", asMETHOD(Timer, GetDeltaTimeSec), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Time", "float GetDeltaTime()", asMETHOD(Timer, GetTickDeltaSec), asCALL_THISCALL);
 	}
 
 	/*------------------------------------------------------------------------------
@@ -478,4 +484,22 @@ namespace Directus
 		m_scriptEngine->RegisterGlobalFunction("void Log(const Vector3& in, LogType)", asFUNCTIONPR(Log::Write, (const Vector3&, Log_Type), void), asCALL_CDECL);
 		m_scriptEngine->RegisterGlobalFunction("void Log(const Quaternion& in, LogType)", asFUNCTIONPR(Log::Write, (const Quaternion&, Log_Type), void), asCALL_CDECL);
 	}
+
+	/*------------------------------------------------------------------------------
+										[JOBS]
+	------------------------------------------------------------------------------*/
+	void ScriptInterface::RegisterJobs()
+	{
+		// A kernel maps a value to a result on a worker thread, it should only use it's arguments
+		m_scriptEngine->RegisterFuncdef("float JobKernel(float value, uint index)");
+		m_scriptEngine->RegisterObjectType("Job", 0, asOBJ_REF);
+		m_scriptEngine->RegisterObjectBehaviour("Job", asBEHAVE_FACTORY, "Job@ f()", asMETHOD(Scripting, Job_Create), asCALL_THISCALL_ASGLOBAL, m_context->GetSubsystem<Scripting>());
+		m_scriptEngine->RegisterObjectBehaviour("Job", asBEHAVE_ADDREF, "void f()", asMETHOD(ScriptJob, AddRef), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectBehaviour("Job", asBEHAVE_RELEASE, "void f()", asMETHOD(ScriptJob, Release), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Job", "void Add(float)", asMETHOD(ScriptJob, Add), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Job", "uint GetCount()", asMETHOD(ScriptJob, GetCount), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Job", "bool Run(JobKernel@ kernel)", asMETHOD(ScriptJob, Run), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Job", "bool IsDone()", asMETHOD(ScriptJob, IsDone), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Job", "float GetResult(uint index)", asMETHOD(ScriptJob, GetResult), asCALL_THISCALL);
+	}
 }
\ No newline at end of file
@@ -33,6 +33,8 @@ namespace Directus
 	{
 	public:
 		void Register(asIScriptEngine* scriptEngine, Context* context);
+		// Has to change whenever what's registered does, so that bytecode compiled against the old interface isn't loaded
+		static unsigned int GetVersion() { return 2; }
 
 	private:
 		void RegisterEnumerations();
@@ -52,6 +54,7 @@ namespace Directus
 		void RegisterQuaternion();
 		void RegisterMath();
 		void RegisterDebug();
+		void RegisterJobs();
 
 		asIScriptEngine* m_scriptEngine;
 		Context* m_context;
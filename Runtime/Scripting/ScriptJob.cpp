@@ -0,0 +1,125 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =============
+#include "ScriptJob.h"
+#include <angelscript.h>
+#include "Scripting.h"
+#include "../Core/Context.h"
+//========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+#define JOB_VALUES_PER_TASK 64 // kernel calls a worker makes in one go
+
+namespace Directus
+{
+	ScriptJob::ScriptJob(Scripting* scripting)
+	{
+		m_scripting = scripting;
+	}
+
+	ScriptJob::~ScriptJob()
+	{
+		// The workers read from it until they are done, a script can let go of a job before that
+		if (m_running && !m_job.IsDone())
+		{
+			m_scripting->GetContext()->GetSubsystem<Threading>()->Job_Wait(m_job);
+		}
+
+		if (m_kernel)
+		{
+			m_kernel->Release();
+		}
+	}
+
+	void ScriptJob::Add(float value)
+	{
+		if (m_running)
+		{
+			LOG_WARNING("ScriptJob::Add: The job already runs, values can't be added anymore");
+			return;
+		}
+
+		m_values.emplace_back(value);
+	}
+
+	bool ScriptJob::Run(asIScriptFunction* kernel)
+	{
+		if (!kernel)
+			return false;
+
+		// Only global functions, a method would have the workers share it's object
+		if (m_running || kernel->GetObjectType() || kernel->GetDelegateObject())
+		{
+			LOG_ERROR("ScriptJob::Run: A job runs once, with a global function for a kernel");
+			kernel->Release();
+			return false;
+		}
+
+		m_kernel	= kernel;
+		m_running	= true;
+		m_results.assign(m_values.size(), 0.0f);
+
+		auto threading = m_scripting->GetContext()->GetSubsystem<Threading>();
+		vector<JobHandle> tasks;
+		unsigned int count = (unsigned int)m_values.size();
+		for (unsigned int start = 0; start < count; start += JOB_VALUES_PER_TASK)
+		{
+			unsigned int end = min(start + JOB_VALUES_PER_TASK, count);
+			tasks.emplace_back(threading->Job_Add([this, start, end]() { Execute(start, end); }));
+		}
+		m_job = threading->Job_Group(tasks);
+
+		return true;
+	}
+
+	float ScriptJob::GetResult(unsigned int index)
+	{
+		if (!IsDone() || index >= (unsigned int)m_results.size())
+			return 0.0f;
+
+		return m_results[index];
+	}
+
+	void ScriptJob::Execute(unsigned int start, unsigned int end)
+	{
+		asIScriptContext* context = m_scripting->RequestContext_Worker();
+		if (!context)
+			return;
+
+		for (unsigned int i = start; i < end; i++)
+		{
+			if (context->Prepare(m_kernel) < 0)
+				return;
+
+			context->SetArgFloat(0, m_values[i]);
+			context->SetArgDWord(1, i);
+			if (context->Execute() == asEXECUTION_FINISHED)
+			{
+				m_results[i] = context->GetReturnFloat();
+			}
+		}
+		context->Unprepare();
+	}
+}
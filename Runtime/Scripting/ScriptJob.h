@@ -0,0 +1,71 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include <atomic>
+#include "../Threading/Threading.h"
+//=================================
+
+class asIScriptFunction;
+
+namespace Directus
+{
+	class Scripting;
+
+	// Work a script hands to the worker threads: a kernel (a global script function, float JobKernel(float value, uint index))
+	// mapped over the values the script added. The kernel runs on a context of each worker, so it must only compute
+	// from it's arguments, touching the world or script globals from it is a race. The script polls IsDone(),
+	// usually next frame, then reads the results.
+	class ScriptJob
+	{
+	public:
+		ScriptJob(Scripting* scripting);
+		~ScriptJob();
+
+		// Script reference counting
+		void AddRef()	{ m_references++; }
+		void Release()	{ if (--m_references == 0) delete this; }
+
+		// Before it runs only
+		void Add(float value);
+		unsigned int GetCount() { return (unsigned int)m_values.size(); }
+
+		// Takes the reference to the kernel the script handed over, false if it already ran or the kernel doesn't fit
+		bool Run(asIScriptFunction* kernel);
+		bool IsDone() { return m_running && m_job.IsDone(); }
+		// 0 until it's done, or if the kernel failed for that value
+		float GetResult(unsigned int index);
+
+	private:
+		void Execute(unsigned int start, unsigned int end);
+
+		Scripting* m_scripting;
+		asIScriptFunction* m_kernel = nullptr;
+		std::vector<float> m_values;
+		std::vector<float> m_results;
+		JobHandle m_job;
+		bool m_running = false;
+		std::atomic<int> m_references = 1;
+	};
+}
@@ -23,14 +23,29 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Scripting.h"
 #include <scriptstdstring/scriptstdstring.cpp>
 #include "ScriptInterface.h"
+#include "ScriptJob.h"
 #include "../Logging/Log.h"
 #include "../FileSystem/FileSystem.h"
 #include "../Core/EventSystem.h"
 #include "../Core/Settings.h"
+#include "../Profiling/MemoryTracker.h"
+#include "../Profiling/Profiler.h"
 //===========================================
 
+//= NAMESPACES =====
+using namespace std::chrono;
+//==================
+
+#define SCRIPT_BUDGET_CUES 1024		// line cues between two looks at the clock, checking it at every one costs more than most scripts do
+#define SCRIPT_USERDATA_SUSPENDED 1	// user data type marking a script object that ran past the budget
+
 namespace Directus
 {
+	namespace _Scripting
+	{
+		thread_local asIScriptContext* workerContext = nullptr;
+	}
+
 	Scripting::Scripting(Context* context) : Subsystem(context)
 	{
 		m_scriptEngine = nullptr;
@@ -41,6 +56,12 @@ namespace Directus
 	{
 		Clear();
 
+		for (auto& context : m_workerContexts)
+		{
+			context->Release();
+		}
+		m_workerContexts.clear();
+
 		if (m_scriptEngine)
 		{
 			m_scriptEngine->ShutDownAndRelease();
@@ -50,6 +71,9 @@ namespace Directus
 
 	bool Scripting::Initialize()
 	{
+		// Script jobs run on the worker threads
+		asPrepareMultithread();
+
 		m_scriptEngine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
 		if (!m_scriptEngine)
 		{
@@ -67,7 +91,9 @@ namespace Directus
 		// Set the message callback to print the human readable messages that the engine gives in case of errors
 		m_scriptEngine->SetMessageCallback(asMETHOD(Scripting, message_callback), this, asCALL_THISCALL);
 
+		// Without line cues the line callback still gets called at every loop and function call, enough to catch a runaway script
 		m_scriptEngine->SetEngineProperty(asEP_BUILD_WITHOUT_LINE_CUES, true);
+		m_budgetMs = Settings::Get().ScriptBudget_Get();
 
 		// Get version
 		string major	= to_string(ANGELSCRIPT_VERSION).erase(1, 4);
@@ -80,6 +106,17 @@ namespace Directus
 
 	void Scripting::Clear()
 	{
+		// Updates still queued don't run
+		for (auto& batch : m_updateBatches)
+		{
+			for (auto obj : batch.objects)
+			{
+				obj->Release();
+			}
+		}
+		m_updateBatches.clear();
+		m_updateBatchIndex.clear();
+
 		for (auto& context : m_contexts)
 		{
 			context->Release();
@@ -110,6 +147,10 @@ namespace Directus
 		else
 		{
 			context = m_scriptEngine->CreateContext();
+			if (m_budgetMs > 0.0f)
+			{
+				context->SetLineCallback(asMETHOD(Scripting, LineCallback), this, asCALL_THISCALL);
+			}
 		}
 
 		return context;
@@ -128,27 +169,82 @@ namespace Directus
 		context->Unprepare();
 	}
 
+	asIScriptContext* Scripting::RequestContext_Worker()
+	{
+		if (!_Scripting::workerContext)
+		{
+			_Scripting::workerContext = m_scriptEngine->CreateContext();
+
+			lock_guard<mutex> lock(m_workerContextsMutex);
+			m_workerContexts.emplace_back(_Scripting::workerContext);
+		}
+
+		return _Scripting::workerContext;
+	}
+
+	ScriptJob* Scripting::Job_Create()
+	{
+		return new ScriptJob(this);
+	}
+
 	/*------------------------------------------------------------------------------
 								[CALLS]
 	------------------------------------------------------------------------------*/
 	bool Scripting::ExecuteCall(asIScriptFunction* scriptFunc, asIScriptObject* obj)
 	{
+		if (!scriptFunc)
+			return false;
+
+		MEMORY_TAG(MemoryTag_Scripting);
+		TIME_BLOCK_SCOPED_CPU_NAMED(GetProfileName(scriptFunc));
 		asIScriptContext* ctx = RequestContext();
+		bool result = Execute(ctx, scriptFunc, obj);
+		ReturnContext(ctx);
+
+		return result;
+	}
 
-		ctx->Prepare(scriptFunc); // prepare the context for calling the method
-		ctx->SetObject(obj); // set the object pointer
-		int r = ctx->Execute(); // execute the call
+	void Scripting::Update_Queue(asIScriptFunction* update, asIScriptObject* obj)
+	{
+		if (!update || !obj || obj->GetUserData(SCRIPT_USERDATA_SUSPENDED))
+			return;
 
-		// output any exceptions
-		if (r == asEXECUTION_EXCEPTION)
+		auto it = m_updateBatchIndex.find(update);
+		if (it == m_updateBatchIndex.end())
 		{
-			LogExceptionInfo(ctx);
-			ReturnContext(ctx);
-			return false;
+			it = m_updateBatchIndex.emplace(update, (unsigned int)m_updateBatches.size()).first;
+			m_updateBatches.push_back({ update, GetProfileName(update), {} });
+		}
+
+		// Held until it's dispatched, a script ticking before it could remove it's actor
+		obj->AddRef();
+		m_updateBatches[it->second].objects.emplace_back(obj);
+	}
+
+	void Scripting::Update_Dispatch()
+	{
+		if (m_updateBatches.empty())
+			return;
+
+		MEMORY_TAG(MemoryTag_Scripting);
+		asIScriptContext* ctx = RequestContext();
+
+		// Preparing a context for the function it last ran only resets it, so every call after a batch's first is cheap
+		for (auto& batch : m_updateBatches)
+		{
+			TIME_BLOCK_SCOPED_CPU_NAMED(batch.name);
+
+			for (auto obj : batch.objects)
+			{
+				Execute(ctx, batch.function, obj);
+				obj->Release();
+			}
 		}
 		ReturnContext(ctx);
 
-		return true;
+		// A script's module can be discarded before the next frame, so the functions aren't kept
+		m_updateBatches.clear();
+		m_updateBatchIndex.clear();
 	}
 
 	/*------------------------------------------------------------------------------
@@ -162,6 +258,62 @@ namespace Directus
 	/*------------------------------------------------------------------------------
 									[PRIVATE]
 	------------------------------------------------------------------------------*/
+	bool Scripting::Execute(asIScriptContext* ctx, asIScriptFunction* function, asIScriptObject* obj)
+	{
+		if (obj && obj->GetUserData(SCRIPT_USERDATA_SUSPENDED))
+			return false;
+
+		if (ctx->Prepare(function) < 0)
+			return false;
+		ctx->SetObject(obj);
+
+		// A script can call into the engine, which can call a script, the outer call's budget is back once it returns
+		auto callStart	= m_callStart;
+		auto callCues	= m_callCues;
+		m_callStart		= steady_clock::now();
+		m_callCues		= 0;
+		int result		= ctx->Execute();
+		m_callStart		= callStart;
+		m_callCues		= callCues;
+
+		if (result == asEXECUTION_EXCEPTION)
+		{
+			LogExceptionInfo(ctx);
+			return false;
+		}
+
+		// Aborted by the line callback, it won't run again
+		if (result == asEXECUTION_ABORTED)
+		{
+			if (obj)
+			{
+				obj->SetUserData((void*)1, SCRIPT_USERDATA_SUSPENDED);
+			}
+			LOGF_WARNING("Scripting::Execute: %s ran past it's %.1f ms budget, it's suspended", function->GetDeclaration(true, true), m_budgetMs);
+			return false;
+		}
+
+		return result == asEXECUTION_FINISHED;
+	}
+
+	void Scripting::LineCallback(asIScriptContext* ctx)
+	{
+		if (++m_callCues % SCRIPT_BUDGET_CUES != 0)
+			return;
+
+		float elapsedMs = duration<float, milli>(steady_clock::now() - m_callStart).count();
+		if (elapsedMs > m_budgetMs)
+		{
+			ctx->Abort();
+		}
+	}
+
+	const char* Scripting::GetProfileName(asIScriptFunction* function)
+	{
+		string name = string("Script: ") + (function->GetObjectName() ? string(function->GetObjectName()) + "::" : "") + function->GetName();
+		return m_profileNames.insert(name).first->c_str();
+	}
+
 	// This is used for script exception messages
 	void Scripting::LogExceptionInfo(asIScriptContext* ctx)
 	{
@@ -23,6 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <chrono>
 #include "../Core/SubSystem.h"
 //============================
 
@@ -38,6 +43,7 @@ struct asSMessageInfo;
 namespace Directus
 {
 	class Module;
+	class ScriptJob;
 
 	class Scripting : public Subsystem
 	{
@@ -51,20 +57,52 @@ namespace Directus
 
 		void Clear();
 		asIScriptEngine* GetAsIScriptEngine();
+		Context* GetContext() { return m_context; }
 
 		// Contexts
 		asIScriptContext* RequestContext();
 		void ReturnContext(asIScriptContext* ctx);
+		// The calling thread's own, for script jobs on the workers, kept until shutdown
+		asIScriptContext* RequestContext_Worker();
+
+		// Jobs, the factory scripts create them through
+		ScriptJob* Job_Create();
 
 		// Calls
 		bool ExecuteCall(asIScriptFunction* scriptFunc, asIScriptObject* obj);
 
+		// Updates are queued by scripts while they tick, then dispatched in batches of the same script type,
+		// each batch through the same context and under a profiler scope of it's own. The World dispatches them.
+		void Update_Queue(asIScriptFunction* update, asIScriptObject* obj);
+		void Update_Dispatch();
+
 		// Modules
 		void DiscardModule(std::string moduleName);
 
 	private:
+		struct Update_Batch
+		{
+			asIScriptFunction* function;
+			const char* name; // interned, the profiler keys scopes by address
+			std::vector<asIScriptObject*> objects;
+		};
+
+		// Runs a prepared call under the budget, a script that runs past it gets suspended
+		bool Execute(asIScriptContext* ctx, asIScriptFunction* function, asIScriptObject* obj);
+		void LineCallback(asIScriptContext* ctx);
+		// "Script: Class::Method", interned so the profiler can key a scope by it
+		const char* GetProfileName(asIScriptFunction* function);
+
 		asIScriptEngine* m_scriptEngine;
 		std::vector<asIScriptContext*> m_contexts;
+		float m_budgetMs = 0.0f;
+		std::chrono::steady_clock::time_point m_callStart;
+		unsigned int m_callCues = 0;
+		std::vector<Update_Batch> m_updateBatches;
+		std::unordered_map<asIScriptFunction*, unsigned int> m_updateBatchIndex;
+		std::unordered_set<std::string> m_profileNames;
+		std::vector<asIScriptContext*> m_workerContexts;
+		std::mutex m_workerContextsMutex;
 
 		void LogExceptionInfo(asIScriptContext* ctx);
 		void message_callback(const asSMessageInfo& msg);
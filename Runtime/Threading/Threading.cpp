@@ -21,6 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ================
 #include "Threading.h"
+#include <Windows.h>
 #include "../Core/Settings.h"
 //===========================
 
@@ -28,75 +29,852 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 using namespace std;
 //==================
 
+#define TASK_POOL_BATCH 64 // free tasks move between a thread's pool and the shared one this many at a time
+#define TASK_DEQUE_CAPACITY 256 // tasks a deque holds before it grows
+#define PARALLEL_CHUNKS_PER_THREAD 4 // with no grain size given, what a parallel for splits into (per thread) at most
+#define TASK_WAIT_SPIN 4096 // times a waiting thread that found nothing to run yields before it starts sleeping, short waits (a parallel for) never sleep
+#define FIBER_STACK_COMMIT (64 * 1024) // committed up front, the rest of the stack is committed as it's touched
+#define FIBER_STACK_RESERVE (1024 * 1024) // the same as a thread's, an import can go deep
+#define FIBER_COUNT_MAX 64 // fibers a worker can have, with that many parked a wait runs tasks on top of itself instead
+
 namespace Directus
 {
+	namespace _Threading
+	{
+		// Which group and deque belong to the calling thread, -1 if it's not a worker
+		thread_local WorkerGroup* workerGroup	= nullptr;
+		thread_local int workerIndex			= -1;
+		thread_local Threading* workerOwner		= nullptr;
+
+		int64_t Now() { return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count(); }
+
+		// Written by the worker they belong to, taken (and reset) by Threading::Stats_Collect. Each on it's own cache
+		// line, so workers counting don't invalidate each other's.
+		struct alignas(64) WorkerCounters
+		{
+			atomic<int64_t> idleNs{ 0 };
+			atomic<int64_t> idleSince{ 0 };	// 0 while it's busy
+			atomic<unsigned int> tasks{ 0 };
+			atomic<unsigned int> steals{ 0 };
+			atomic<int64_t> latencyNs{ 0 };
+			atomic<int64_t> latencyMaxNs{ 0 };
+		};
+		WorkerCounters countersExternal; // shared by the threads that aren't workers
+		thread_local WorkerCounters* workerCounters = nullptr;
+
+		// Waiting with nothing to run, until Idle_End
+		void Idle_Begin()
+		{
+			if (workerCounters && workerCounters->idleSince.load(memory_order_relaxed) == 0)
+			{
+				workerCounters->idleSince.store(Now(), memory_order_relaxed);
+			}
+		}
+
+		// What was already collected isn't counted again
+		void Idle_End(int64_t collected)
+		{
+			if (!workerCounters)
+				return;
+
+			int64_t since = workerCounters->idleSince.load(memory_order_relaxed);
+			if (since == 0)
+				return;
+
+			workerCounters->idleNs += Now() - max(since, collected);
+			workerCounters->idleSince.store(0, memory_order_relaxed);
+		}
+
+		struct GroupDesc
+		{
+			ThreadGroup type;
+			const wchar_t* name;
+			int priority;
+			unsigned int threadCount;
+		};
+
+		// A worker's fibers, they are only ever resumed by the thread that created them, so thread locals stay valid across a
+		// wait. A parked fiber is in a wait that wasn't done yet, any free one will run the worker loop (fresh, or from where
+		// it left it to resume a parked one).
+		struct WorkerFibers
+		{
+			struct Parked
+			{
+				void* fiber;
+				const function<bool()>* done;
+			};
+
+			void* threadFiber = nullptr;
+			vector<void*> all;
+			vector<void*> free;
+			vector<Parked> parked;
+		};
+		thread_local WorkerFibers* workerFibers = nullptr;
+
+		void WINAPI Fiber_Main(void*)
+		{
+			workerOwner->Worker_Loop(workerGroup);
+
+			// Stopping, back to the thread so it can clean up
+			SwitchToFiber(workerFibers->threadFiber);
+		}
+
+		// A free fiber, nullptr when the worker has as many as it can
+		void* Fiber_Get()
+		{
+			auto& fibers = *workerFibers;
+			if (!fibers.free.empty())
+			{
+				void* fiber = fibers.free.back();
+				fibers.free.pop_back();
+				return fiber;
+			}
+
+			if (fibers.all.size() >= FIBER_COUNT_MAX)
+				return nullptr;
+
+			void* fiber = CreateFiberEx(FIBER_STACK_COMMIT, FIBER_STACK_RESERVE, FIBER_FLAG_FLOAT_SWITCH, Fiber_Main, nullptr);
+			if (fiber)
+			{
+				fibers.all.emplace_back(fiber);
+			}
+			return fiber;
+		}
+
+		// Switches to a parked fiber whose wait is done, the calling one becomes free
+		bool Fiber_ResumeReady()
+		{
+			auto& parked = workerFibers->parked;
+			for (size_t i = 0; i < parked.size(); i++)
+			{
+				if (!(*parked[i].done)())
+					continue;
+
+				void* fiber = parked[i].fiber;
+				parked.erase(parked.begin() + i);
+				workerFibers->free.emplace_back(GetCurrentFiber());
+				SwitchToFiber(fiber);
+				return true;
+			}
+
+			return false;
+		}
+
+		// Shows up in debuggers and profilers. Windows 10 1607 and later only, so it's looked up rather than linked.
+		void SetName(const wchar_t* name, unsigned int index)
+		{
+			typedef HRESULT(WINAPI* SetThreadDescriptionFn)(HANDLE, PCWSTR);
+			static auto setThreadDescription = (SetThreadDescriptionFn)GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription");
+			if (!setThreadDescription)
+				return;
+
+			wstring fullName = wstring(name) + L" " + to_wstring(index);
+			setThreadDescription(GetCurrentThread(), fullName.c_str());
+		}
+
+		// Freed tasks, reused by the next ones this thread adds. Tasks mostly run on another thread than the one that
+		// added them, so what a thread frees beyond a couple of batches goes to a shared pool, so the adding thread finds it.
+		struct TaskPool
+		{
+			~TaskPool()
+			{
+				for (auto memory : free)
+				{
+					::operator delete(memory, align_val_t(alignof(Task)));
+				}
+			}
+
+			vector<void*> free;
+		};
+		thread_local TaskPool taskPool;
+		TaskPool taskPoolShared;
+		mutex taskPoolSharedMutex;
+	}
+
+	// A Chase-Lev deque, the owning worker pushes and pops at the bottom while any thread can steal from the top.
+	// Only taking the last task involves a compare-exchange, there are no locks. Buffers that were grown out of
+	// are kept until the deque is destroyed, a thief might still be reading from one.
+	class TaskDeque
+	{
+	public:
+		TaskDeque()
+		{
+			m_buffers.emplace_back(make_unique<Buffer>(TASK_DEQUE_CAPACITY));
+			m_buffer = m_buffers.back().get();
+		}
+
+		// Owner only
+		void Push(Task* task)
+		{
+			int64_t bottom	= m_bottom.load(memory_order_relaxed);
+			int64_t top		= m_top.load(memory_order_acquire);
+			Buffer* buffer	= m_buffer.load(memory_order_relaxed);
+			if (bottom - top > buffer->capacity - 1)
+			{
+				buffer = Grow(buffer, top, bottom);
+			}
+
+			buffer->Put(bottom, task);
+			atomic_thread_fence(memory_order_release);
+			m_bottom.store(bottom + 1, memory_order_relaxed);
+		}
+
+		// Owner only
+		Task* Pop()
+		{
+			int64_t bottom	= m_bottom.load(memory_order_relaxed) - 1;
+			Buffer* buffer	= m_buffer.load(memory_order_relaxed);
+			m_bottom.store(bottom, memory_order_relaxed);
+			atomic_thread_fence(memory_order_seq_cst);
+			int64_t top		= m_top.load(memory_order_relaxed);
+
+			// Empty
+			if (top > bottom)
+			{
+				m_bottom.store(bottom + 1, memory_order_relaxed);
+				return nullptr;
+			}
+
+			Task* task = buffer->Get(bottom);
+			if (top == bottom)
+			{
+				// The last one, a thief might be taking it too
+				if (!m_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+				{
+					task = nullptr;
+				}
+				m_bottom.store(bottom + 1, memory_order_relaxed);
+			}
+
+			return task;
+		}
+
+		// Any thread
+		Task* Steal()
+		{
+			int64_t top		= m_top.load(memory_order_acquire);
+			atomic_thread_fence(memory_order_seq_cst);
+			int64_t bottom	= m_bottom.load(memory_order_acquire);
+			if (top >= bottom)
+				return nullptr;
+
+			Buffer* buffer	= m_buffer.load(memory_order_acquire);
+			Task* task		= buffer->Get(top);
+			if (!m_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+				return nullptr;
+
+			return task;
+		}
+
+	private:
+		struct Buffer
+		{
+			Buffer(int64_t capacity) : capacity(capacity), tasks(new atomic<Task*>[(size_t)capacity]) {}
+			Task* Get(int64_t index)				{ return tasks[index & (capacity - 1)].load(memory_order_relaxed); }
+			void Put(int64_t index, Task* task)		{ tasks[index & (capacity - 1)].store(task, memory_order_relaxed); }
+
+			int64_t capacity; // a power of two
+			unique_ptr<atomic<Task*>[]> tasks;
+		};
+
+		Buffer* Grow(Buffer* buffer, int64_t top, int64_t bottom)
+		{
+			m_buffers.emplace_back(make_unique<Buffer>(buffer->capacity * 2));
+			Buffer* grown = m_buffers.back().get();
+			for (int64_t i = top; i < bottom; i++)
+			{
+				grown->Put(i, buffer->Get(i));
+			}
+			m_buffer.store(grown, memory_order_release);
+			return grown;
+		}
+
+		atomic<int64_t> m_top{ 0 };
+		atomic<int64_t> m_bottom{ 0 };
+		atomic<Buffer*> m_buffer;
+		vector<unique_ptr<Buffer>> m_buffers;
+	};
+
+	struct WorkerGroup
+	{
+		ThreadGroup type;
+		const wchar_t* name;
+		int priority;
+		vector<thread> threads;
+		vector<unique_ptr<TaskDeque>> deques;
+		vector<unique_ptr<_Threading::WorkerCounters>> counters;
+		atomic<unsigned int> tasksQueuedMax{ 0 }; // since stats were last collected
+
+		// Added by threads that aren't workers of this group
+		queue<Task*> tasksShared;
+		mutex tasksSharedMutex;
+		atomic<unsigned int> tasksSharedCount{ 0 };
+
+		// Workers only sleep when nothing is queued anywhere in the group
+		atomic<unsigned int> tasksQueued{ 0 };
+		atomic<unsigned int> sleeping{ 0 };
+		mutex sleepMutex;
+		condition_variable conditionVar;
+	};
+
 	Threading::Threading(Context* context) : Subsystem(context)
 	{
-		m_stopping		= false;
-		m_threadCount	= Settings::Get().ThreadCountMax_Get() - 1;
+		m_stopping			= false;
+		m_fibers			= false;
+		m_statsCollected	= _Threading::Now();
+		m_threadCount		= 0; // until the threads exist, tasks run where they are added
 	}
 
 	Threading::~Threading()
 	{
-		// Put unique lock on task mutex.
-		unique_lock<mutex> lock(m_tasksMutex);
-
-		// Set termination flag to true.
+		// Set termination flag to true, workers leave once everything queued has run
 		m_stopping = true;
+		for (auto& group : m_groups)
+		{
+			{
+				lock_guard<mutex> lock(group->sleepMutex);
+			}
 
-		// Unlock the mutex
-		lock.unlock();
-
-		// Wake up all threads.
-		m_conditionVar.notify_all();
+			// Wake up all threads.
+			group->conditionVar.notify_all();
+		}
 
 		// Join all threads.
-		for (auto& thread : m_threads)
+		for (auto& group : m_groups)
 		{
-			thread.join();
+			for (auto& thread : group->threads)
+			{
+				thread.join();
+			}
 		}
 
 		// Empty worker threads.
-		m_threads.clear();
+		m_groups.clear();
 	}
 
 	bool Threading::Initialize()
 	{
-		for (unsigned int i = 0; i < m_threadCount; i++)
+		unsigned int threadCount = Settings::Get().ThreadCountMax_Get() - 1;
+		m_fibers = Settings::Get().Fibers_Get();
+		if (threadCount == 0)
+		{
+			LOG_INFO("Threading::Initialize: No threads have been created");
+			return true;
+		}
+
+		// The calling (main) thread is one of the cores, a quarter of the rest works in the background. The I/O thread
+		// comes on top, it spends most of it's time waiting. With a single core to spare, both share it.
+		unsigned int countBackground	= max(1U, threadCount / 4);
+		unsigned int countFrame			= max(1U, threadCount - countBackground);
+		_Threading::GroupDesc groups[ThreadGroup_Count] =
+		{
+			{ ThreadGroup_Frame,		L"Frame Worker",		THREAD_PRIORITY_ABOVE_NORMAL,	countFrame },
+			{ ThreadGroup_Background,	L"Background Worker",	THREAD_PRIORITY_BELOW_NORMAL,	countBackground },
+			{ ThreadGroup_IO,			L"IO Worker",			THREAD_PRIORITY_NORMAL,			1 }
+		};
+
+		// Every deque exists before any worker can steal from it
+		for (const auto& desc : groups)
+		{
+			m_groups.emplace_back(make_unique<WorkerGroup>());
+			auto& group		= *m_groups.back();
+			group.type		= desc.type;
+			group.name		= desc.name;
+			group.priority	= desc.priority;
+			for (unsigned int i = 0; i < desc.threadCount; i++)
+			{
+				group.deques.emplace_back(make_unique<TaskDeque>());
+				group.counters.emplace_back(make_unique<_Threading::WorkerCounters>());
+			}
+		}
+
+		for (auto& group : m_groups)
+		{
+			for (unsigned int i = 0; i < (unsigned int)group->deques.size(); i++)
+			{
+				group->threads.emplace_back(thread(&Threading::Invoke, this, group.get(), i));
+				SetThreadPriority(group->threads.back().native_handle(), group->priority);
+			}
+		}
+		m_threadCount = countFrame + countBackground + 1;
+
+		// A frame worker per core, leaving the first to the main thread. They don't get moved around mid-frame, what
+		// they touch stays in that core's cache. The rest go wherever the OS finds room.
+		unsigned int coreCount = max(1U, thread::hardware_concurrency());
+		auto& frameThreads = m_groups[ThreadGroup_Frame]->threads;
+		for (unsigned int i = 0; i < (unsigned int)frameThreads.size(); i++)
 		{
-			m_threads.emplace_back(thread(&Threading::Invoke, this));
+			unsigned int core = (i + 1) % coreCount;
+			if (core < 64)
+			{
+				SetThreadAffinityMask(frameThreads[i].native_handle(), (DWORD_PTR)1 << core);
+			}
 		}
-		LOGF_INFO("Threading::Initialize: %d threads have been created", m_threadCount);
+
+		LOGF_INFO("Threading::Initialize: %d frame, %d background and 1 I/O threads have been created", countFrame, countBackground);
 
 		return true;
 	}
 
-	void Threading::Invoke()
+	ThreadGroup Threading::GetGroup()
+	{
+		return _Threading::workerOwner == this ? _Threading::workerGroup->type : ThreadGroup_Frame;
+	}
+
+	unsigned int Threading::GetThreadCount()
+	{
+		if (m_groups.empty())
+			return 0;
+
+		return (unsigned int)m_groups[GetGroup()]->threads.size();
+	}
+
+	string Threading::GetThreadName()
 	{
-		shared_ptr<Task> task;
+		if (!_Threading::workerGroup)
+			return "";
+
+		auto name = _Threading::workerGroup->name;
+		return string(name, name + wcslen(name)) + " " + to_string(_Threading::workerIndex);
+	}
+
+	void Threading::Group_SetAffinity(ThreadGroup group, uint64_t coreMask)
+	{
+		if (group >= (ThreadGroup)m_groups.size())
+			return;
+
+		// Cores the process can't use are dropped, a mask with none left means any of them
+		DWORD_PTR processMask	= 0;
+		DWORD_PTR systemMask	= 0;
+		GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+		DWORD_PTR mask = (DWORD_PTR)coreMask & processMask;
+		for (auto& thread : m_groups[group]->threads)
+		{
+			SetThreadAffinityMask(thread.native_handle(), mask != 0 ? mask : processMask);
+		}
+	}
+
+	bool Threading::Task_RunOne()
+	{
+		if (m_groups.empty())
+			return false;
+
+		Task* task = Task_Take(*m_groups[GetGroup()]);
+		if (!task)
+			return false;
+
+		Task_Execute(task);
+		return true;
+	}
+
+	void Threading::Task_Wait(const function<bool()>& done)
+	{
+		if (done())
+			return;
+
+		// Park this fiber, the worker picks up other tasks on another and comes back once it's done
+		if (_Threading::workerOwner == this && _Threading::workerFibers)
+		{
+			if (void* next = _Threading::Fiber_Get())
+			{
+				_Threading::workerFibers->parked.push_back({ GetCurrentFiber(), &done });
+				SwitchToFiber(next);
+				return;
+			}
+		}
+
+		unsigned int idle = 0;
+		while (!done())
+		{
+			if (Task_RunOne())
+			{
+				idle = 0;
+				continue;
+			}
+
+			_Threading::Idle_Begin();
+			if (++idle < TASK_WAIT_SPIN)
+			{
+				this_thread::yield();
+			}
+			else
+			{
+				this_thread::sleep_for(chrono::milliseconds(1));
+			}
+		}
+		_Threading::Idle_End(m_statsCollected.load(memory_order_relaxed));
+	}
+
+	void Threading::Invoke(WorkerGroup* group, unsigned int workerIndex)
+	{
+		_Threading::workerGroup = group;
+		_Threading::workerIndex = (int)workerIndex;
+		_Threading::workerOwner = this;
+		_Threading::workerCounters = group->counters[workerIndex].get();
+		_Threading::SetName(group->name, workerIndex);
+
+		if (!m_fibers)
+		{
+			Worker_Loop(group);
+			return;
+		}
+
+		_Threading::WorkerFibers fibers;
+		_Threading::workerFibers	= &fibers;
+		fibers.threadFiber			= ConvertThreadToFiber(nullptr);
+		void* fiber					= fibers.threadFiber ? _Threading::Fiber_Get() : nullptr;
+		if (!fiber)
+		{
+			LOG_WARNING("Threading::Invoke: Failed to create a fiber, waits will run tasks on top of themselves");
+			_Threading::workerFibers = nullptr;
+			if (fibers.threadFiber)
+			{
+				ConvertFiberToThread();
+			}
+			Worker_Loop(group);
+			return;
+		}
+
+		// The loop runs on the fibers, this one comes back when it has stopped
+		SwitchToFiber(fiber);
+
+		for (auto fiber : fibers.all)
+		{
+			DeleteFiber(fiber);
+		}
+		_Threading::workerFibers = nullptr;
+		ConvertFiberToThread();
+	}
+
+	void Threading::Worker_Loop(WorkerGroup* group)
+	{
+		unsigned int idle = 0;
 		while (true)
 		{
-			// Lock tasks mutex
-			unique_lock<mutex> lock(m_tasksMutex);
+			// Finished waits first, what they were part of is older than anything queued
+			if (_Threading::workerFibers && _Threading::Fiber_ResumeReady())
+			{
+				idle = 0;
+				continue;
+			}
 
-			// Check condition on notification
-			m_conditionVar.wait(lock, [this] { return !m_tasks.empty() || m_stopping; });
+			if (Task* task = Task_Take(*group))
+			{
+				_Threading::Idle_End(m_statsCollected.load(memory_order_relaxed));
+				Task_Execute(task);
+				idle = 0;
+				continue;
+			}
+
+			// With waits parked, nothing will wake us when they are done, so keep checking on them
+			_Threading::Idle_Begin();
+			bool parked = _Threading::workerFibers && !_Threading::workerFibers->parked.empty();
+			if (parked && ++idle < TASK_WAIT_SPIN)
+			{
+				this_thread::yield();
+				continue;
+			}
+
+			// Announce the sleep before checking, a task added after the check will see it and wake us
+			unique_lock<mutex> lock(group->sleepMutex);
+			group->sleeping++;
+			auto wake = [this, group] { return group->tasksQueued.load() != 0 || m_stopping; };
+			if (parked)
+			{
+				group->conditionVar.wait_for(lock, chrono::milliseconds(1), wake);
+			}
+			else
+			{
+				group->conditionVar.wait(lock, wake);
+			}
+			group->sleeping--;
 
 			// If m_stopping is true, it's time to shut everything down
-			if (m_stopping && m_tasks.empty())
+			if (m_stopping && group->tasksQueued.load() == 0 && !parked)
 				return;
+		}
+	}
 
-			// Get next task in the queue.
-			task = m_tasks.front();
+	void Threading::Task_Push(ThreadGroup groupType, Task* task)
+	{
+		auto& group = *m_groups[groupType];
 
-			// Remove it from the queue.
-			m_tasks.pop();
+		// Counted first, so it never drops below what can be taken
+		unsigned int queued = ++group.tasksQueued;
+		if (queued > group.tasksQueuedMax.load(memory_order_relaxed))
+		{
+			group.tasksQueuedMax.store(queued, memory_order_relaxed); // racy, close enough for stats
+		}
+		task->queued = _Threading::Now();
 
-			// Unlock the mutex
-			lock.unlock();
+		// A worker of the group keeps what it adds, it's likely to touch the same data
+		if (_Threading::workerOwner == this && _Threading::workerGroup == &group)
+		{
+			group.deques[_Threading::workerIndex]->Push(task);
+		}
+		else
+		{
+			lock_guard<mutex> lock(group.tasksSharedMutex);
+			group.tasksShared.push(task);
+			group.tasksSharedCount++;
+		}
+
+		// Only when someone sleeps is the lock needed, to not notify between their check and their wait
+		if (group.sleeping.load() != 0)
+		{
+			{
+				lock_guard<mutex> lock(group.sleepMutex);
+			}
+			group.conditionVar.notify_one();
+		}
+	}
+
+	Task* Threading::Task_Take(WorkerGroup& group)
+	{
+		Task* task		= nullptr;
+		int ownIndex	= (_Threading::workerOwner == this && _Threading::workerGroup == &group) ? _Threading::workerIndex : -1;
+
+		// Newest of our own
+		if (ownIndex != -1)
+		{
+			task = group.deques[ownIndex]->Pop();
+		}
+
+		// Added by a thread that isn't a worker of the group, the count avoids the lock when there are none
+		if (!task && group.tasksSharedCount.load() != 0)
+		{
+			lock_guard<mutex> lock(group.tasksSharedMutex);
+			if (!group.tasksShared.empty())
+			{
+				task = group.tasksShared.front();
+				group.tasksShared.pop();
+				group.tasksSharedCount--;
+			}
+		}
+
+		// Oldest of someone else's, starting after our own so thieves spread out
+		unsigned int dequeCount = (unsigned int)group.deques.size();
+		for (unsigned int i = 1; !task && i <= dequeCount; i++)
+		{
+			unsigned int victim = (unsigned int)(ownIndex + (int)i) % dequeCount;
+			if ((int)victim != ownIndex)
+			{
+				task = group.deques[victim]->Steal();
+			}
+
+			if (task && _Threading::workerCounters)
+			{
+				_Threading::workerCounters->steals.fetch_add(1, memory_order_relaxed);
+			}
+		}
+
+		if (task)
+		{
+			group.tasksQueued--;
+		}
+
+		return task;
+	}
+
+	void Threading::Parallel_For(unsigned int begin, unsigned int end, unsigned int grainSize, const function<void(unsigned int, unsigned int)>& function)
+	{
+		if (end <= begin)
+			return;
+
+		unsigned int count = end - begin;
+		if (grainSize == 0)
+		{
+			grainSize = count / ((GetThreadCount() + 1) * PARALLEL_CHUNKS_PER_THREAD);
+		}
+		grainSize = grainSize != 0 ? grainSize : 1;
+
+		if (m_threadCount == 0 || count <= grainSize)
+		{
+			function(begin, end);
+			return;
+		}
 
-			// Execute the task.
-			task->Execute();
+		// Whoever runs a piece keeps splitting it, handing the upper half out, until it's down to the grain size
+		atomic<unsigned int> remaining(count);
+		std::function<void(unsigned int, unsigned int)> split;
+		split = [this, &split, &function, &remaining, grainSize](unsigned int start, unsigned int stop)
+		{
+			while (stop - start > grainSize)
+			{
+				unsigned int middle = start + (stop - start) / 2;
+				AddTask([&split, middle, stop]() { split(middle, stop); });
+				stop = middle;
+			}
+
+			function(start, stop);
+			remaining -= stop - start;
+		};
+
+		split(begin, end);
+		Task_Wait([&remaining]() { return remaining.load() == 0; });
+	}
+
+	JobHandle Threading::Job_Add(ThreadGroup group, function<void()>&& function, const vector<JobHandle>& dependencies)
+	{
+		auto job			= make_shared<JobState>();
+		job->function		= move(function);
+		job->group			= group;
+		job->dependencies	= 1; // held while the dependencies are added, so it can't start halfway
+
+		for (const auto& dependency : dependencies)
+		{
+			if (!dependency.m_state)
+				continue;
+
+			lock_guard<mutex> lock(dependency.m_state->mutex);
+			if (!dependency.m_state->done)
+			{
+				job->dependencies++;
+				dependency.m_state->continuations.emplace_back(job);
+			}
+		}
+
+		Job_Release(job);
+		return JobHandle(job);
+	}
+
+	void Threading::Job_Release(const shared_ptr<JobState>& job)
+	{
+		if (--job->dependencies != 0)
+			return;
+
+		// A group has nothing to run, it's done when it's last dependency is
+		if (!job->function)
+		{
+			Job_Complete(job);
+			return;
+		}
+
+		AddTask((ThreadGroup)job->group, [this, job]()
+		{
+			job->function();
+			Job_Complete(job);
+		});
+	}
+
+	void Threading::Job_Complete(const shared_ptr<JobState>& job)
+	{
+		// What it captured is released before anyone waiting on it moves on
+		job->function = nullptr;
+
+		vector<shared_ptr<JobState>> continuations;
+		{
+			lock_guard<mutex> lock(job->mutex);
+			job->done = true;
+			continuations.swap(job->continuations);
+		}
+
+		for (const auto& continuation : continuations)
+		{
+			Job_Release(continuation);
+		}
+	}
+
+	void Threading::Task_Execute(Task* task)
+	{
+		auto counters	= _Threading::workerCounters ? _Threading::workerCounters : &_Threading::countersExternal;
+		int64_t latency	= _Threading::Now() - task->queued;
+		counters->tasks.fetch_add(1, memory_order_relaxed);
+		counters->latencyNs.fetch_add(latency, memory_order_relaxed);
+		if (latency > counters->latencyMaxNs.load(memory_order_relaxed))
+		{
+			counters->latencyMaxNs.store(latency, memory_order_relaxed);
+		}
+
+		task->Execute();
+		Task_Free(task);
+	}
+
+	void Threading::Stats_Collect(ThreadingStats* stats)
+	{
+		int64_t now			= _Threading::Now();
+		int64_t collected	= m_statsCollected.exchange(now);
+		float elapsedMs		= (float)(now - collected) / 1000000.0f;
+		auto ToMs			= [](int64_t ns) { return (float)ns / 1000000.0f; };
+
+		stats->workers.clear();
+		stats->latencyAvgMs	= 0.0f;
+		stats->latencyMaxMs	= 0.0f;
+		int64_t latencyNs	= 0;
+		unsigned int tasks	= 0;
+		auto Collect = [&](const string& name, _Threading::WorkerCounters& counters, bool worker)
+		{
+			WorkerStats workerStats;
+			workerStats.name			= name;
+			workerStats.tasks			= counters.tasks.exchange(0, memory_order_relaxed);
+			workerStats.steals			= counters.steals.exchange(0, memory_order_relaxed);
+			int64_t workerLatencyNs		= counters.latencyNs.exchange(0, memory_order_relaxed);
+			workerStats.latencyMaxMs	= ToMs(counters.latencyMaxNs.exchange(0, memory_order_relaxed));
+			workerStats.latencyAvgMs	= workerStats.tasks ? ToMs(workerLatencyNs / workerStats.tasks) : 0.0f;
+
+			if (worker)
+			{
+				// Still idle, the part up to now counts towards this collection
+				int64_t idleNs	= counters.idleNs.exchange(0, memory_order_relaxed);
+				int64_t since	= counters.idleSince.load(memory_order_relaxed);
+				idleNs			+= since != 0 ? now - max(since, collected) : 0;
+
+				workerStats.idleMs	= min(ToMs(idleNs), elapsedMs);
+				workerStats.busyMs	= elapsedMs - workerStats.idleMs;
+			}
+
+			latencyNs			+= workerLatencyNs;
+			tasks				+= workerStats.tasks;
+			stats->latencyMaxMs	= max(stats->latencyMaxMs, workerStats.latencyMaxMs);
+			stats->workers.emplace_back(move(workerStats));
+		};
+
+		for (auto& group : m_groups)
+		{
+			string name(group->name, group->name + wcslen(group->name));
+			for (unsigned int i = 0; i < (unsigned int)group->counters.size(); i++)
+			{
+				Collect(name + " " + to_string(i), *group->counters[i], true);
+			}
+			stats->queueDepthMax[group->type] = group->tasksQueuedMax.exchange(group->tasksQueued.load(), memory_order_relaxed);
+		}
+		Collect("Other threads", _Threading::countersExternal, false);
+
+		stats->latencyAvgMs = tasks ? ToMs(latencyNs / tasks) : 0.0f;
+	}
+
+	void* Threading::Task_Allocate()
+	{
+		auto& pool = _Threading::taskPool.free;
+		if (pool.empty())
+		{
+			lock_guard<mutex> lock(_Threading::taskPoolSharedMutex);
+			auto& shared	= _Threading::taskPoolShared.free;
+			auto count		= min(shared.size(), (size_t)TASK_POOL_BATCH);
+			pool.insert(pool.end(), shared.end() - count, shared.end());
+			shared.resize(shared.size() - count);
+		}
+
+		if (pool.empty())
+			return ::operator new(sizeof(Task), align_val_t(alignof(Task)));
+
+		void* memory = pool.back();
+		pool.pop_back();
+		return memory;
+	}
+
+	void Threading::Task_Free(Task* task)
+	{
+		task->~Task();
+
+		auto& pool = _Threading::taskPool.free;
+		pool.emplace_back(task);
+		if (pool.size() >= 2 * TASK_POOL_BATCH)
+		{
+			lock_guard<mutex> lock(_Threading::taskPoolSharedMutex);
+			auto& shared = _Threading::taskPoolShared.free;
+			shared.insert(shared.end(), pool.end() - TASK_POOL_BATCH, pool.end());
+			pool.resize(pool.size() - TASK_POOL_BATCH);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -23,9 +23,20 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================
 #include <vector>
+#include <string>
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <cstddef>
 #include "../Core/SubSystem.h"
 #include "../Logging/Log.h"
 //============================
@@ -33,19 +44,113 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Directus
 {
 	//= TASK ===============================================================================
-	class Task
+	// Two cache lines, the callable is stored inline unless it's too big for the rest of them. Tasks come from
+	// (and go back to) a pool per thread, so adding one doesn't allocate.
+	class alignas(64) Task
 	{
 	public:
-		typedef std::function<void()> functionType;
+		template <typename Function>
+		Task(Function&& function)
+		{
+			typedef typename std::decay<Function>::type Callable;
+			if constexpr (sizeof(Callable) <= sizeof(m_storage) && alignof(Callable) <= alignof(std::max_align_t))
+			{
+				new (m_storage) Callable(std::forward<Function>(function));
+				m_invoke	= [](void* storage) { (*reinterpret_cast<Callable*>(storage))(); };
+				m_destroy	= [](void* storage) { reinterpret_cast<Callable*>(storage)->~Callable(); };
+			}
+			else
+			{
+				*reinterpret_cast<Callable**>(m_storage) = new Callable(std::forward<Function>(function));
+				m_invoke	= [](void* storage) { (**reinterpret_cast<Callable**>(storage))(); };
+				m_destroy	= [](void* storage) { delete *reinterpret_cast<Callable**>(storage); };
+			}
+		}
+		~Task() { m_destroy(m_storage); }
+
+		Task(const Task&)				= delete;
+		Task& operator=(const Task&)	= delete;
+
+		void Execute() { m_invoke(m_storage); }
+
+		// When it was queued, nanoseconds on the steady clock
+		int64_t queued = 0;
+
+	private:
+		// What the members ahead of the storage take, up to where it's alignment lets it start
+		static constexpr size_t header_size = (sizeof(int64_t) + 2 * sizeof(void*) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+		void (*m_invoke)(void*);
+		void (*m_destroy)(void*);
+		alignas(std::max_align_t) unsigned char m_storage[128 - header_size];
+	};
+	static_assert(sizeof(Task) == 128, "Task: must stay two cache lines");
+	//======================================================================================
+
+	//= JOB ================================================================================
+	// A task that can wait for others, and be waited for
+	struct JobState
+	{
+		std::function<void()> function;									// empty for a group
+		std::atomic<unsigned int> dependencies{ 0 };					// unfinished jobs it waits for
+		std::atomic<bool> done{ false };
+		unsigned int group = 0;											// the ThreadGroup it runs on
+		std::mutex mutex;												// guards the continuations
+		std::vector<std::shared_ptr<JobState>> continuations;			// jobs waiting for this one
+	};
+
+	class JobHandle
+	{
+	public:
+		JobHandle() = default;
 
-		Task(functionType&& function) { m_function = std::forward<functionType>(function); }
-		void Execute() { m_function(); }
+		bool IsValid() const	{ return m_state != nullptr; }
+		// An invalid handle counts as done, so it can be depended on or waited for
+		bool IsDone() const		{ return !m_state || m_state->done.load(); }
 
 	private:
-		functionType m_function;
+		friend class Threading;
+		JobHandle(const std::shared_ptr<JobState>& state) : m_state(state) {}
+
+		std::shared_ptr<JobState> m_state;
+	};
+	//======================================================================================
+
+	enum ThreadGroup
+	{
+		ThreadGroup_Frame,		// what the frame waits for, above normal priority and a core per thread
+		ThreadGroup_Background,	// importing, compressing and streaming, below normal priority so it doesn't slow the frame
+		ThreadGroup_IO,			// a single thread reading and scanning files, it mostly waits on the disk
+		ThreadGroup_Count
+	};
+
+	//= STATS ==============================================================================
+	struct WorkerStats
+	{
+		std::string name;
+		float busyMs			= 0.0f;
+		float idleMs			= 0.0f;	// asleep or yielding with nothing to run
+		unsigned int tasks		= 0;
+		unsigned int steals		= 0;	// tasks taken from another worker's deque
+		float latencyAvgMs		= 0.0f;	// from being queued to starting
+		float latencyMaxMs		= 0.0f;
+	};
+
+	struct ThreadingStats
+	{
+		std::vector<WorkerStats> workers;					// the last one is every thread that isn't a worker, it has no busy or idle time
+		unsigned int queueDepthMax[ThreadGroup_Count]	= {};	// the most tasks that were queued at once
+		float latencyAvgMs								= 0.0f;
+		float latencyMaxMs								= 0.0f;
 	};
 	//======================================================================================
 
+	class TaskDeque;
+	struct WorkerGroup;
+
+	// Workers are split into groups, tasks only run on the group they were added to. Every worker has it's own deque,
+	// tasks a worker adds go to it's own and are taken back newest first, idle workers steal the oldest from the others
+	// in their group. Threads that aren't workers add to a shared queue per group.
 	class Threading : public Subsystem
 	{
 	public:
@@ -57,38 +162,126 @@ namespace Directus
 		//========================
 
 		// This function is invoked by the threads
-		void Invoke();
+		void Invoke(WorkerGroup* group, unsigned int workerIndex);
+		// Runs the group's tasks until stopping, on the worker's thread or one of it's fibers
+		void Worker_Loop(WorkerGroup* group);
+
+		// The calling worker's group, threads that aren't workers count as the frame's
+		ThreadGroup GetGroup();
+		// Threads in the calling worker's group (see GetGroup)
+		unsigned int GetThreadCount();
+		// The calling worker's name (e.g. "Frame Worker 2"), empty on threads that aren't workers
+		static std::string GetThreadName();
+		// Pins a group's threads to a set of cores (a bit per core), 0 lets them run on any
+		void Group_SetAffinity(ThreadGroup group, uint64_t coreMask);
+		// What the workers did since the previous call (the profiler calls it every frame)
+		void Stats_Collect(ThreadingStats* stats);
+
+		// Executes the next queued task of the calling thread's group, false if there is none. A task that waits
+		// on other tasks can run them while it waits, instead of blocking a thread they might be queued behind.
+		bool Task_RunOne();
+
+		// Returns when done returns true. A worker parks the calling fiber (see Settings::Fibers_Set) and runs other tasks
+		// meanwhile, done is checked from it's loop. Other threads run queued tasks on top of the wait.
+		void Task_Wait(const std::function<bool()>& done);
+
+		template <typename T>
+		void Task_Wait(const std::future<T>& future)
+		{
+			Task_Wait([&future]() { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+		}
+
+		template <typename T>
+		void Task_Wait(const std::shared_future<T>& future)
+		{
+			Task_Wait([&future]() { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+		}
+
+		// Runs the function once every dependency is done (e.g. record after culling and sorting), on the calling thread's group
+		JobHandle Job_Add(std::function<void()>&& function, const std::vector<JobHandle>& dependencies = {}) { return Job_Add(GetGroup(), std::move(function), dependencies); }
+		JobHandle Job_Add(ThreadGroup group, std::function<void()>&& function, const std::vector<JobHandle>& dependencies = {});
+		// Done when all of the jobs are, it doesn't occupy a thread
+		JobHandle Job_Group(const std::vector<JobHandle>& jobs) { return Job_Add(nullptr, jobs); }
+		// Returns once the job is done, waiting like Task_Wait
+		void Job_Wait(const JobHandle& job) { Task_Wait([&job]() { return job.IsDone(); }); }
+
+		// Runs function(start, end) over chunks of [begin, end) on the pool, the caller takes part. Halves get handed out
+		// as the range is split, so an idle thread steals the biggest piece left. A grain size of 0 picks one from the range.
+		void Parallel_For(unsigned int begin, unsigned int end, unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& function);
 
-		// Add a task
+		// Chunks are sorted in parallel, then neighbours are merged in parallel, pairs at a time. Not stable.
+		template <typename Iterator, typename Compare>
+		void Parallel_Sort(Iterator begin, Iterator end, Compare compare, unsigned int grainSize = 4096)
+		{
+			auto count	= (unsigned int)(end - begin);
+			grainSize	= std::max(grainSize, count / (GetThreadCount() + 1) + 1);
+			if (m_threadCount == 0 || count <= grainSize)
+			{
+				std::sort(begin, end, compare);
+				return;
+			}
+
+			unsigned int chunks = (count + grainSize - 1) / grainSize;
+			Parallel_For(0, chunks, 1, [&](unsigned int start, unsigned int stop)
+			{
+				for (unsigned int chunk = start; chunk < stop; chunk++)
+				{
+					std::sort(begin + chunk * grainSize, begin + std::min((chunk + 1) * grainSize, count), compare);
+				}
+			});
+
+			for (unsigned int width = grainSize; width < count; width *= 2)
+			{
+				unsigned int pairs = (count + 2 * width - 1) / (2 * width);
+				Parallel_For(0, pairs, 1, [&](unsigned int start, unsigned int stop)
+				{
+					for (unsigned int pair = start; pair < stop; pair++)
+					{
+						unsigned int first	= pair * 2 * width;
+						unsigned int middle	= std::min(first + width, count);
+						unsigned int last	= std::min(first + 2 * width, count);
+						if (middle < last)
+						{
+							std::inplace_merge(begin + first, begin + middle, begin + last, compare);
+						}
+					}
+				});
+			}
+		}
+
+		// Add a task, to the calling thread's group (a task added by a background import stays in the background)
 		template <typename Function>
 		void AddTask(Function&& function)
 		{
-			if (m_threads.empty())
+			AddTask(GetGroup(), std::forward<Function>(function));
+		}
+
+		template <typename Function>
+		void AddTask(ThreadGroup group, Function&& function)
+		{
+			if (m_threadCount == 0)
 			{
 				LOG_WARNING("Threading::AddTask: No available threads, function will execute in the same thread");
 				function();
 				return;
 			}
 
-			// Lock tasks mutex
-			std::unique_lock<std::mutex> lock(m_tasksMutex);
-
-			// Save the task
-			m_tasks.push(std::make_shared<Task>(std::bind(std::forward<Function>(function))));
-
-			// Unlock the mutex
-			lock.unlock();
-
-			// Wake up a thread
-			m_conditionVar.notify_one();
+			Task_Push(group, new (Task_Allocate()) Task(std::forward<Function>(function)));
 		}
 
 	private:
+		static void* Task_Allocate();
+		static void Task_Free(Task* task);
+		void Task_Push(ThreadGroup group, Task* task);
+		Task* Task_Take(WorkerGroup& group);
+		void Task_Execute(Task* task);
+		void Job_Release(const std::shared_ptr<JobState>& job);
+		void Job_Complete(const std::shared_ptr<JobState>& job);
+
 		unsigned int m_threadCount;
-		std::vector<std::thread> m_threads;
-		std::queue<std::shared_ptr<Task>> m_tasks;
-		std::mutex m_tasksMutex;
-		std::condition_variable m_conditionVar;
-		bool m_stopping;
+		bool m_fibers;
+		std::atomic<int64_t> m_statsCollected;
+		std::vector<std::unique_ptr<WorkerGroup>> m_groups;
+		std::atomic<bool> m_stopping;
 	};
-}
\ No newline at end of file
+}
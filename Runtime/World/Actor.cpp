@@ -32,6 +32,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/Script.h"
 #include "../World/Components/AudioSource.h"
 #include "../World/Components/AudioListener.h"
+#include "../World/Components/ParticleEmitter.h"
+#include "../World/Components/Terrain.h"
+#include "../World/Components/LightProbeVolume.h"
+#include "../World/Components/ReflectionProbe.h"
+#include "Prefab.h"
+#include "ActorQuery.h"
 #include "../IO/FileStream.h"
 #include "../FileSystem/FileSystem.h"
 #include "../Logging/Log.h"
@@ -42,6 +48,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 using namespace std;
 //==================
 
+#define CHUNK_ACTOR		0x52544341 // "ACTR"
+#define ACTOR_VERSION	1 // 1 - the static flag, actors from before it (unversioned) are read as not static
+
 namespace Directus
 {
 	Actor::Actor(Context* context)
@@ -49,6 +58,7 @@ namespace Directus
 		m_context				= context;
 		m_ID					= GENERATE_GUID;
 		m_name					= "Actor";
+		m_nameID				= m_name;
 		m_isActive				= true;
 		m_hierarchyVisibility	= true;
 		m_transform				= nullptr;
@@ -60,13 +70,17 @@ namespace Directus
 		// delete components
 		for (auto it = m_components.begin(); it != m_components.end(); )
 		{
+			ComponentPool::Remove((*it).get());
 			(*it)->OnRemove();
+			auto type = (*it)->GetType();
 			(*it).reset();
 			it = m_components.erase(it);
+			Components_UpdateSlot(type);
 		}
 		m_components.clear();
 
 		m_name.clear();
+		m_nameID				= StringId();
 		m_ID					= NOT_ASSIGNED_HASH;
 		m_isActive				= true;
 		m_hierarchyVisibility	= true;
@@ -79,51 +93,21 @@ namespace Directus
 
 	void Actor::Clone()
 	{
-		auto scene = m_context->GetSubsystem<World>();
-		vector<Actor*> clones;
-
-		// Creation of new actor and copying of a few properties
-		auto CloneActor = [&scene, &clones](Actor* actor)
-		{
-			// Clone the name and the ID
-			Actor* clone = scene->Actor_Create().get();
-			clone->SetID(GENERATE_GUID);
-			clone->SetName(actor->GetName());
-			clone->SetActive(actor->IsActive());
-			clone->SetHierarchyVisibility(actor->IsVisibleInHierarchy());
-
-			// Clone all the components
-			for (const auto& component : actor->GetAllComponents())
-			{
-				shared_ptr<IComponent> originalComp = component;
-				shared_ptr<IComponent> cloneComp	= clone->AddComponent(component->GetType());
-				cloneComp->SetAttributes(originalComp->GetAttributes());
-			}
-
-			clones.emplace_back(clone);
+		// Captures this actor and it's descendants, then spawns them once
+		Prefab prefab(m_context);
+		prefab.Create(this);
+		prefab.Instantiate();
+	}
 
-			return clone;
-		};
+	void Actor::SetID(unsigned int ID)
+	{
+		unsigned int previous	= m_ID;
+		m_ID					= ID;
 
-		// Cloning of an actor and it's descendants (this is a recursive lambda)
-		function<Actor*(Actor*)> CloneActorAndDescendants = [&CloneActorAndDescendants, &CloneActor, &clones](Actor* original)
+		if (auto world = m_context->GetSubsystem<World>())
 		{
-			// clone self
-			Actor* cloneSelf = CloneActor(original);
-
-			// clone children make them call this lambda
-			for (const auto& childTransform : original->GetTransform_PtrRaw()->GetChildren())
-			{
-				Actor* cloneChild = CloneActorAndDescendants(childTransform->GetActor_PtrRaw());
-				cloneChild->GetTransform_PtrRaw()->SetParent(cloneSelf->GetTransform_PtrRaw());
-			}
-
-			// return self
-			return cloneSelf;
-		};
-
-		// Clone the entire hierarchy
-		CloneActorAndDescendants(this);
+			world->Actor_OnIDChanged(this, previous);
+		}
 	}
 
 	void Actor::Start()
@@ -158,11 +142,14 @@ namespace Directus
 
 	void Actor::Serialize(FileStream* stream)
 	{
+		stream->Chunk_Begin(CHUNK_ACTOR, ACTOR_VERSION);
+
 		//= BASIC DATA ======================
 		stream->Write(m_isActive);
 		stream->Write(m_hierarchyVisibility);
 		stream->Write(m_ID);
 		stream->Write(m_name);
+		stream->Write(IsStatic());
 		//===================================
 
 		//= COMPONENTS ================================
@@ -173,9 +160,12 @@ namespace Directus
 			stream->Write(component->GetID());
 		}
 
+		// Each in a chunk of it's type, so one that can't be read is skipped
 		for (const auto& component : m_components)
 		{
+			stream->Chunk_Begin((uint32_t)component->GetType(), component->GetSerializedVersion());
 			component->Serialize(stream);
+			stream->Chunk_End();
 		}
 		//=============================================
 
@@ -205,19 +195,34 @@ namespace Directus
 			}
 		}
 		//=============================================
+
+		stream->Chunk_End();
 	}
 
 	void Actor::Deserialize(FileStream* stream, Transform* parent)
 	{
+		// Without the chunk it's an actor from before chunks, the same fields follow unversioned
+		FileStreamChunk chunk;
+		bool chunked		= stream->Chunk_Enter(CHUNK_ACTOR, &chunk);
+		uint32_t version	= chunked ? chunk.version : 0;
+
 		//= BASIC DATA =====================
 		stream->Read(&m_isActive);
 		stream->Read(&m_hierarchyVisibility);
 		stream->Read(&m_ID);
 		stream->Read(&m_name);
+		m_nameID = m_name;
+		bool isStatic = false;
+		if (version >= 1)
+		{
+			stream->Read(&isStatic);
+		}
+		m_isStatic = isStatic;
 		//==================================
 
 		//= COMPONENTS ================================
 		int componentCount = stream->ReadInt();
+		vector<shared_ptr<IComponent>> components;
 		for (int i = 0; i < componentCount; i++)
 		{
 			unsigned int type = ComponentType_Unknown;
@@ -226,15 +231,40 @@ namespace Directus
 			stream->Read(&type); // load component's type
 			stream->Read(&id); // load component's id
 
+			// Null if the type isn't known (anymore), it's data gets skipped
 			auto component = AddComponent((ComponentType)type);
-			component->SetID(id);
+			if (component)
+			{
+				component->SetID(id);
+			}
+			components.emplace_back(component);
 		}
 		// Sometimes there are component dependencies, e.g. a collider that needs
 		// to set it's shape to a rigibody. So, it's important to first create all 
 		// the components (like above) and then deserialize them (like here).
-		for (const auto& component : m_components)
+		for (const auto& component : components)
 		{
-			component->Deserialize(stream);
+			// Unchunked, the data of a type that isn't known can't be skipped
+			if (!chunked)
+			{
+				if (!component)
+				{
+					LOGF_ERROR("Actor::Deserialize: A component of an unknown type, the rest of \"%s\" can't be read", m_name.c_str());
+					return;
+				}
+				component->Deserialize(stream);
+				continue;
+			}
+
+			FileStreamChunk componentChunk;
+			if (!stream->Chunk_Read(&componentChunk))
+				break;
+
+			if (component && componentChunk.type == (uint32_t)component->GetType())
+			{
+				component->Deserialize(stream);
+			}
+			stream->Chunk_Leave(componentChunk);
 		}
 		//=============================================
 
@@ -265,13 +295,18 @@ namespace Directus
 		}
 		//=============================================
 
+		if (chunked)
+		{
+			stream->Chunk_Leave(chunk);
+		}
+
 		if (m_transform)
 		{
 			m_transform->AcquireChildren();
 		}
 
-		// Make the scene resolve
-		FIRE_EVENT(EVENT_WORLD_RESOLVE);
+		// Let any interested subsystems know about the change
+		NotifyComponentsChanged();
 	}
 
 	shared_ptr<IComponent> Actor::AddComponent(ComponentType type)
@@ -292,13 +327,14 @@ namespace Directus
 			case ComponentType_Script:			component = AddComponent<Script>();			break;
 			case ComponentType_Skybox:			component = AddComponent<Skybox>();			break;
 			case ComponentType_Transform:		component = AddComponent<Transform>();		break;
+			case ComponentType_ParticleEmitter:	component = AddComponent<ParticleEmitter>();	break;
+			case ComponentType_Terrain:			component = AddComponent<Terrain>();			break;
+			case ComponentType_LightProbeVolume:	component = AddComponent<LightProbeVolume>();	break;
+			case ComponentType_ReflectionProbe:	component = AddComponent<ReflectionProbe>();	break;
 			case ComponentType_Unknown:														break;
 			default:																		break;
 		}
 
-		// Make the scene resolve
-		FIRE_EVENT(EVENT_WORLD_RESOLVE);
-
 		return component;
 	}
 
@@ -309,9 +345,17 @@ namespace Directus
 			auto component = *it;
 			if (id == component->GetID())
 			{
+				if (component->GetType() == ComponentType_Renderable)
+				{
+					m_renderable = nullptr;
+				}
+
+				ComponentPool::Remove(component.get());
 				component->OnRemove();
+				auto type = component->GetType();
 				component.reset();
 				it = m_components.erase(it);
+				Components_UpdateSlot(type);
 			}
 			else
 			{
@@ -319,7 +363,51 @@ namespace Directus
 			}
 		}
 
-		// Make the scene resolve
-		FIRE_EVENT(EVENT_WORLD_RESOLVE);
+		// Let any interested subsystems know about the change
+		NotifyComponentsChanged();
+	}
+
+	void Actor::Components_UpdateSlot(ComponentType type)
+	{
+		unsigned int maskPrevious = m_componentMask;
+		m_componentSlots[type].reset();
+		m_componentMask &= ~(1U << type);
+
+		for (const auto& component : m_components)
+		{
+			if (component->GetType() == type)
+			{
+				m_componentSlots[type]	= component;
+				m_componentMask			|= 1U << type;
+				break;
+			}
+		}
+
+		if (m_componentMask != maskPrevious)
+		{
+			ActorQuery::Actor_OnMaskChanged(this, maskPrevious, m_componentMask);
+		}
+	}
+
+	void Actor::SetStatic(bool isStatic)
+	{
+		if (m_isStatic.exchange(isStatic) == isStatic)
+			return;
+
+		// Everything that caches static actors picks the change up from here
+		NotifyComponentsChanged();
+	}
+
+	void Actor::NotifyComponentsChanged()
+	{
+		// Once in the World, it batches the changes until it's next sync point
+		auto world = m_context->GetSubsystem<World>();
+		if (world && m_handle.IsValid())
+		{
+			world->Actor_OnChanged(m_handle);
+			return;
+		}
+
+		FIRE_EVENT_DATA(EVENT_WORLD_ACTOR_CHANGED, weak_ptr<Actor>(shared_from_this()));
 	}
 }
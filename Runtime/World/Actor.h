@@ -23,10 +23,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <vector>
+#include <atomic>
 #include "World.h"
+#include "ActorHandle.h"
 #include "Components/IComponent.h"
+#include "Components/ComponentPool.h"
 #include "../Core/Context.h"
 #include "../Core/EventSystem.h"
+#include "../Core/StringId.h"
 //================================
 
 namespace Directus
@@ -54,16 +58,26 @@ namespace Directus
 
 		//= PROPERTIES =========================================================================================
 		const std::string& GetName()			{ return m_name; }
-		void SetName(const std::string& name)	{ m_name = name; }
+		void SetName(const std::string& name)	{ m_name = name; m_nameID = name; }
+		const StringId& GetNameID()				{ return m_nameID; }
 
 		unsigned int GetID()		{ return m_ID; }
-		void SetID(unsigned int ID) { m_ID = ID; }
+		// Keeps the World's index up to date
+		void SetID(unsigned int ID);
 
 		bool IsActive()				{ return m_isActive; }
 		void SetActive(bool active) { m_isActive = active; }
 
+		// Assigned once the actor is added to the World
+		ActorHandle GetHandle() const	{ return m_handle; }
+
 		bool IsVisibleInHierarchy()								{ return m_hierarchyVisibility; }
 		void SetHierarchyVisibility(bool hierarchyVisibility)	{ m_hierarchyVisibility = hierarchyVisibility; }
+
+		// A static actor doesn't move once the game runs, so shadows, the spatial tree and physics can cache it as it is.
+		// One that moves anyway gets demoted to dynamic, with a warning (see Transform).
+		bool IsStatic()				{ return m_isStatic; }
+		void SetStatic(bool isStatic);
 		//======================================================================================================
 
 		//= COMPONENTS =========================================================================================
@@ -77,11 +91,12 @@ namespace Directus
 			if (HasComponent(type) && type != ComponentType_Script)
 				return GetComponent<T>();
 
-			// Add component
+			// Add component, out of the memory components of it's type are packed in
 			m_components.emplace_back
 			(	
-				std::make_shared<T>
+				std::allocate_shared<T>
 				(
+					PoolAllocator<T>(),
 					m_context,
 					this,
 					GetTransform_PtrRaw()
@@ -90,7 +105,9 @@ namespace Directus
 
 			auto newComponent = std::static_pointer_cast<T>(m_components.back());
 			newComponent->SetType(IComponent::Type_To_Enum<T>());
+			Components_UpdateSlot(type);
 			newComponent->OnInitialize();
+			ComponentPool::Add(newComponent.get());
 
 			// Caching of rendering performance critical components
 			if (newComponent->GetType() == ComponentType_Renderable)
@@ -98,8 +115,8 @@ namespace Directus
 				m_renderable = (Renderable*)newComponent.get();
 			}
 
-			// Make the scene resolve
-			FIRE_EVENT(EVENT_WORLD_RESOLVE);
+			// Let any interested subsystems know about the change
+			NotifyComponentsChanged();
 
 			return newComponent;
 		}
@@ -110,14 +127,14 @@ namespace Directus
 		template <class T>
 		std::shared_ptr<T> GetComponent()
 		{
-			ComponentType type = IComponent::Type_To_Enum<T>();
-			for (const auto& component : m_components)
-			{
-				if (component->GetType() == type)
-					return std::static_pointer_cast<T>(component);
-			}
+			return std::static_pointer_cast<T>(m_componentSlots[IComponent::Type_To_Enum<T>()]);
+		}
 
-			return nullptr;
+		// Returns a component of type T (if it exists), without touching it's reference count
+		template <class T>
+		T* GetComponent_PtrRaw()
+		{
+			return static_cast<T*>(m_componentSlots[IComponent::Type_To_Enum<T>()].get());
 		}
 
 		// Returns any components of type T (if they exist)
@@ -138,16 +155,13 @@ namespace Directus
 			return components;
 		}
 		
+		// A bit per ComponentType, set if there is a component of it
+		unsigned int GetComponentMask() const { return m_componentMask; }
+
 		// Checks if a component of ComponentType exists
 		bool HasComponent(ComponentType type) 
 		{ 
-			for (const auto& component : m_components)
-			{
-				if (component->GetType() == type)
-					return true;
-			}
-
-			return false;
+			return m_componentMask & (1U << type);
 		}
 
 		// Checks if a component of type T exists
@@ -167,6 +181,7 @@ namespace Directus
 				auto component = *it;
 				if (component->GetType() == type)
 				{
+					ComponentPool::Remove(component.get());
 					component->OnRemove();
 					component.reset();
 					it = m_components.erase(it);
@@ -177,8 +192,15 @@ namespace Directus
 				}
 			}
 
-			// Make the scene resolve
-			FIRE_EVENT(EVENT_WORLD_RESOLVE);
+			// Clear cached components
+			if (type == ComponentType_Renderable)
+			{
+				m_renderable = nullptr;
+			}
+			Components_UpdateSlot(type);
+
+			// Let any interested subsystems know about the change
+			NotifyComponentsChanged();
 		}
 
 		void RemoveComponentByID(unsigned int id);
@@ -191,12 +213,25 @@ namespace Directus
 		Renderable* GetRenderable_PtrRaw()		{ return m_renderable; }
 		std::shared_ptr<Actor> GetPtrShared()	{ return shared_from_this(); }
 
+		// Fires EVENT_WORLD_ACTOR_CHANGED (at the World's next sync point), so subsystems can update any cached state they keep about this actor
+		void NotifyComponentsChanged();
+
 	private:
+		friend class World;
+
+		// Points a type's slot (and mask bit) to it's first component, after one was added or removed
+		void Components_UpdateSlot(ComponentType type);
+
 		unsigned int m_ID;
+		ActorHandle m_handle;
 		std::string m_name;
+		StringId m_nameID;
 		bool m_isActive;
 		bool m_hierarchyVisibility;
+		std::atomic<bool> m_isStatic = false;
 		std::vector<std::shared_ptr<IComponent>> m_components;
+		std::shared_ptr<IComponent> m_componentSlots[ComponentType_Unknown + 1];	// the first component of every type, empty if none
+		unsigned int m_componentMask = 0;											// a bit per type, set if there is a component of it
 		Context* m_context;
 		std::shared_ptr<Actor> m_componentEmpty;
 
@@ -0,0 +1,51 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+namespace Directus
+{
+	// Identifies an actor in the World's slot map with 32 bits, the slot's index in the low 20 and it's generation in the
+	// high 12. A slot's generation moves on whenever it's actor is removed, so a handle to a removed actor stops resolving,
+	// even once the slot holds another actor. Cheap to copy and to store (scripts, render packets), no reference counting.
+	class ActorHandle
+	{
+	public:
+		static const unsigned int index_bits		= 20;
+		static const unsigned int index_mask		= (1U << index_bits) - 1;
+		static const unsigned int generation_mask	= (1U << (32 - index_bits)) - 1;
+
+		ActorHandle() = default;
+		ActorHandle(unsigned int index, unsigned int generation) { m_value = (generation << index_bits) | (index & index_mask); }
+
+		unsigned int GetIndex() const		{ return m_value & index_mask; }
+		unsigned int GetGeneration() const	{ return m_value >> index_bits; }
+		unsigned int GetValue() const		{ return m_value; }
+		// Generations start at 1, so a default constructed handle never resolves
+		bool IsValid() const				{ return m_value != 0; }
+
+		bool operator==(const ActorHandle& rhs) const { return m_value == rhs.m_value; }
+		bool operator!=(const ActorHandle& rhs) const { return m_value != rhs.m_value; }
+
+	private:
+		unsigned int m_value = 0;
+	};
+}
@@ -0,0 +1,106 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "ActorQuery.h"
+#include <algorithm>
+#include "Components/ComponentPool.h"
+#include "../Logging/Log.h"
+//===================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	namespace _ActorQuery
+	{
+		vector<ActorQuery*> queries;
+	}
+
+	ActorQuery::ActorQuery(unsigned int required, unsigned int excluded)
+	{
+		m_required = required;
+		m_excluded = excluded;
+
+		// Every actor that matches already has one of the required components, the pool of those is the shortest walk
+		if (m_required == 0)
+		{
+			LOG_ERROR("ActorQuery::ActorQuery: A query has to require at least one component type");
+		}
+		else
+		{
+			unsigned int type = 0;
+			while (!(m_required & (1U << type))) { type++; }
+
+			for (auto component : ComponentPool::Get((ComponentType)type))
+			{
+				auto actor = component->GetActor_PtrRaw();
+				if (actor && Matches(actor->GetComponentMask()) && m_indices.find(actor) == m_indices.end())
+				{
+					Add(actor);
+				}
+			}
+		}
+
+		_ActorQuery::queries.emplace_back(this);
+	}
+
+	ActorQuery::~ActorQuery()
+	{
+		auto& queries = _ActorQuery::queries;
+		queries.erase(remove(queries.begin(), queries.end(), this), queries.end());
+	}
+
+	void ActorQuery::Actor_OnMaskChanged(Actor* actor, unsigned int maskPrevious, unsigned int mask)
+	{
+		for (auto query : _ActorQuery::queries)
+		{
+			bool matched	= query->Matches(maskPrevious);
+			bool matches	= query->Matches(mask);
+			if (matched == matches)
+				continue;
+
+			if (matches)	query->Add(actor);
+			else			query->Remove(actor);
+		}
+	}
+
+	void ActorQuery::Add(Actor* actor)
+	{
+		m_indices[actor] = (unsigned int)m_actors.size();
+		m_actors.emplace_back(actor);
+	}
+
+	void ActorQuery::Remove(Actor* actor)
+	{
+		auto it = m_indices.find(actor);
+		if (it == m_indices.end())
+			return;
+
+		unsigned int index			= it->second;
+		m_actors[index]				= m_actors.back();
+		m_indices[m_actors[index]]	= index;
+		m_actors.pop_back();
+		m_indices.erase(actor);
+	}
+}
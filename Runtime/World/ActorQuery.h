@@ -0,0 +1,84 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========================
+#include <vector>
+#include <unordered_map>
+#include "Actor.h"
+#include "Components/IComponent.h"
+//=====================================
+
+namespace Directus
+{
+	// The actors that have all of some component types (and none of others), kept up to date as components get added
+	// and removed instead of being re-filtered out of the whole world. The matches are packed in one array, in no
+	// particular order. Like the ComponentPool, adding or removing components while iterating a query isn't safe.
+	class ENGINE_CLASS ActorQuery
+	{
+	public:
+		ActorQuery(unsigned int required, unsigned int excluded = 0);
+		~ActorQuery();
+		ActorQuery(const ActorQuery&)				= delete;
+		ActorQuery& operator=(const ActorQuery&)	= delete;
+
+		const std::vector<Actor*>& GetActors() const	{ return m_actors; }
+		auto begin() const								{ return m_actors.begin(); }
+		auto end() const								{ return m_actors.end(); }
+		unsigned int GetCount() const					{ return (unsigned int)m_actors.size(); }
+		bool Matches(unsigned int mask) const			{ return (mask & m_required) == m_required && (mask & m_excluded) == 0; }
+
+		// A mask bit per type, for the required/excluded component masks
+		template <class... T>
+		static unsigned int Mask() { return (0U | ... | (1U << IComponent::Type_To_Enum<T>())); }
+
+		// Called by an actor whenever it's component mask changes, updates every live query
+		static void Actor_OnMaskChanged(Actor* actor, unsigned int maskPrevious, unsigned int mask);
+
+	private:
+		void Add(Actor* actor);
+		// Swaps the last match into the removed one's place
+		void Remove(Actor* actor);
+
+		unsigned int m_required;
+		unsigned int m_excluded;
+		std::vector<Actor*> m_actors;
+		std::unordered_map<Actor*, unsigned int> m_indices;
+	};
+
+	// E.g. Query<Transform, Renderable> renderables; renderables.ForEach([](Actor* actor, Transform* transform, Renderable* renderable) {});
+	template <class... T>
+	class Query : public ActorQuery
+	{
+	public:
+		Query(unsigned int excluded = 0) : ActorQuery(Mask<T...>(), excluded) {}
+
+		template <class Function>
+		void ForEach(Function&& function) const
+		{
+			for (auto actor : GetActors())
+			{
+				function(actor, actor->template GetComponent_PtrRaw<T>()...);
+			}
+		}
+	};
+}
@@ -69,6 +69,11 @@ namespace Directus
 			m_isDirty = true;
 		}
 
+		if (m_reverseZ != Renderer::RenderFlags_IsSet(Render_ReverseZ))
+		{
+			m_isDirty = true;
+		}
+
 		// DIRTY CHECK
 		if (m_position != GetTransform()->GetPosition() || m_rotation != GetTransform()->GetRotation())
 		{
@@ -84,7 +89,8 @@ namespace Directus
 		ComputeViewMatrix();
 		ComputeProjection();
 
-		m_frustrum.Construct(GetViewMatrix(), GetProjectionMatrix(), GetFarPlane());
+		// The frustum wants a conventional depth projection, it culls against the far plane regardless
+		m_frustrum.Construct(GetViewMatrix(), m_reverseZ ? GetProjectionMatrix() * Matrix::CreateReverseZ() : GetProjectionMatrix(), GetFarPlane());
 
 		m_isDirty = false;
 	}
@@ -161,32 +167,29 @@ namespace Directus
 		// Compute ray given the origin and end
 		m_ray = Ray(GetTransform()->GetPosition(), ScreenToWorldPoint(mousePos));
 
-		// Hits <Distance, actor>
-		map<float, shared_ptr<Actor>> hits;
+		// Hits <Distance, actor>, the tree holds renderables (minus the SkyBox) and point/spot lights
+		vector<pair<float, Actor*>> hits;
+		auto world = GetContext()->GetSubsystem<World>();
+		world->Spatial_Get().Query(m_ray, hits);
 
-		// Find all the actors that the ray hits
-		const vector<shared_ptr<Actor>>& actors = GetContext()->GetSubsystem<World>()->Actors_GetAll();
-		for (const auto& actor : actors)
+		// Get closest hit, ignoring any we are inside the bounding box of (0.0f). A light's is it's range, so the
+		// distance is always the one to the renderable's bounding box.
+		Actor* closest		= nullptr;
+		float closestDist	= INFINITY;
+		for (const auto& hit : hits)
 		{
-			// Make sure there actor has a mesh and exclude the SkyBox
-			if (!actor->HasComponent<Renderable>() || actor->HasComponent<Skybox>())
+			auto renderable = hit.second->GetComponent_PtrRaw<Renderable>();
+			if (!renderable)
 				continue;
 
-			// Get bounding box
-			BoundingBox bb = actor->GetComponent<Renderable>()->Geometry_BB();
-
-			// Compute hit distance
-			float hitDistance = m_ray.HitDistance(bb);
-
-			// Don't store hit data if we are inside the bounding box (0.0f) or there was no hit (INFINITY)
-			if (hitDistance == 0.0f || hitDistance == INFINITY)
+			float hitDistance = m_ray.HitDistance(renderable->Geometry_BB());
+			if (hitDistance == 0.0f || hitDistance >= closestDist)
 				continue;
 
-			hits[hitDistance] = actor;
+			closest		= hit.second;
+			closestDist	= hitDistance;
 		}
-
-		// Get closest hit
-		shared_ptr<Actor> hit = !hits.empty() ? hits.begin()->second : nullptr;
+		shared_ptr<Actor> hit = closest ? closest->GetPtrShared() : nullptr;
 
 		// Display transformation gizmo
 		m_transformGizmo->Pick(hit);
@@ -198,10 +201,11 @@ namespace Directus
 	{
 		Vector2 viewport = Settings::Get().Viewport_Get();
 
+		// Already divided by w, x and y are in normalized device coordinates
 		Vector3 localSpace = worldPoint * m_mView * m_mProjection;
 
-		float screenX = localSpace.x	/ localSpace.z	* (viewport.x * 0.5f)	+ viewport.x * 0.5f;
-		float screenY = -(localSpace.y	/ localSpace.z	* (viewport.y * 0.5f))	+ viewport.y * 0.5f;
+		float screenX = localSpace.x	* (viewport.x * 0.5f)	+ viewport.x * 0.5f;
+		float screenY = -(localSpace.y	* (viewport.y * 0.5f))	+ viewport.y * 0.5f;
 
 		return Vector2(screenX, screenY);
 	}
@@ -214,9 +218,14 @@ namespace Directus
 		float pointX = 2.0f		* point.x / viewport.x - 1.0f;
 		float pointY = -2.0f	* point.y / viewport.y + 1.0f;
 
-		// Unproject point
+		// Unproject point, on the far plane. With reverse-z and an infinite projection that's at near / far.
+		float depthFar = 1.0f;
+		if (m_reverseZ)
+		{
+			depthFar = m_projection == Projection_Perspective ? m_nearPlane / m_farPlane : 0.0f;
+		}
 		Matrix unprojectMatrix = (m_mView * m_mProjection).Inverted();
-		Vector3 worldPoint = Vector3(pointX, pointY, 1.0f) * unprojectMatrix;
+		Vector3 worldPoint = Vector3(pointX, pointY, depthFar) * unprojectMatrix;
 
 		return worldPoint;
 	}
@@ -245,29 +254,31 @@ namespace Directus
 	void Camera::ComputeProjection()
 	{
 		Vector2 viewport	= Settings::Get().Viewport_Get();
-		float width			= viewport.x;
-		float height		= viewport.y;
+		m_reverseZ			= Renderer::RenderFlags_IsSet(Render_ReverseZ);
 
 		if (m_projection == Projection_Perspective)
 		{
 			float vfovRad = 2.0f * atan(tan(m_fovHorizontalRad / 2.0f) * (viewport.y / viewport.x)); 
-			m_mProjection = Matrix::CreatePerspectiveFieldOfViewLH(vfovRad, Settings::Get().AspectRatio_Get(), m_nearPlane, m_farPlane);
+
+			// Reverse-z keeps the float depth precise all the way out, so the far plane only limits culling
+			if (m_reverseZ)
+			{
+				m_mProjection = Matrix::CreatePerspectiveFieldOfViewInfiniteLH(vfovRad, Settings::Get().AspectRatio_Get(), m_nearPlane) * Matrix::CreateReverseZ();
+			}
+			else
+			{
+				m_mProjection = Matrix::CreatePerspectiveFieldOfViewLH(vfovRad, Settings::Get().AspectRatio_Get(), m_nearPlane, m_farPlane);
+			}
 		}
 		else if (m_projection == Projection_Orthographic)
 		{
 			m_mProjection = Matrix::CreateOrthographicLH(viewport.x, viewport.y, m_nearPlane, m_farPlane);
+			if (m_reverseZ)
+			{
+				m_mProjection *= Matrix::CreateReverseZ();
+			}
 		}
 
-		// TAA
-		if (Renderer::RenderFlags_IsSet(Render_TAA))
-		{
-			bool isOdd = (Renderer::GetFrame() % 2) == 1;
-
-			// Apply sub-pixel jitter		
-			Vector3 jitterA		= Vector3(-0.5f / width, -0.5f / height, 1.0f);
-			Vector3 jitterB		= Vector3(0.5f / width, 0.5f / height, 1.0f);
-			Matrix jitterMatrix	= Matrix::CreateTranslation(isOdd ? jitterA : jitterB);
-			m_mProjection		*= jitterMatrix;
-		}
+		// TAA jitter is applied by the renderer, every frame
 	}
 }
\ No newline at end of file
@@ -95,6 +95,9 @@ namespace Directus
 		//= MISC ========================================================================
 		bool IsInViewFrustrum(Renderable* renderable);
 		bool IsInViewFrustrum(const Math::Vector3& center, const Math::Vector3& extents);
+		Math::Frustum& GetFrustum() { return m_frustrum; }
+		// Whether the projection maps the near plane to 1 and the far plane to 0
+		bool IsReverseZ() { return m_reverseZ; }
 		const Math::Vector4& GetClearColor() { return m_clearColor; }
 		void SetClearColor(const Math::Vector4& color) { m_clearColor = color; }
 		//===============================================================================
@@ -123,6 +126,7 @@ namespace Directus
 		bool m_isDirty;
 
 		Math::Vector2 m_lastKnownViewport;	
+		bool m_reverseZ = false;
 
 		std::shared_ptr<TransformationGizmo> m_transformGizmo;
 	};
@@ -24,10 +24,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Transform.h"
 #include "RigidBody.h"
 #include "Renderable.h"
+#include "Terrain.h"
 #include "../Actor.h"
 #include "../../IO/FileStream.h"
+#include "../../Physics/Physics.h"
 #include "../../Physics/BulletPhysicsHelper.h"
+#include "../../Physics/CollisionShapeCache.h"
 #include "../../Logging/Log.h"
+#include "../../FileSystem/FileSystem.h"
+#include "../../Rendering/Model.h"
+#include <sstream>
+#include <iomanip>
+#include <string_view>
 #pragma warning(push, 0) // Hide warnings which belong to Bullet
 #include <BulletCollision/CollisionShapes/btSphereShape.h>
 #include <BulletCollision/CollisionShapes/btCylinderShape.h>
@@ -35,6 +43,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <BulletCollision/CollisionShapes/btStaticPlaneShape.h>
 #include <BulletCollision/CollisionShapes/btConeShape.h>
 #include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
 #pragma warning(pop)
 //=============================================================
 
@@ -45,12 +54,33 @@ using namespace std;
 
 namespace Directus
 {
+	namespace _Collider
+	{
+		inline void HashVector(size_t& seed, const Vector3& value)
+		{
+			CollisionShapeCache::HashCombine(seed, hash<float>()(value.x));
+			CollisionShapeCache::HashCombine(seed, hash<float>()(value.y));
+			CollisionShapeCache::HashCombine(seed, hash<float>()(value.z));
+		}
+
+		// Bullet reads the heights where they are, the shape keeps them alive for as long as it's cached
+		class HeightfieldShape : public btHeightfieldTerrainShape
+		{
+		public:
+			HeightfieldShape(const shared_ptr<const vector<float>>& heights, int resolution, float heightMax)
+				: btHeightfieldTerrainShape(resolution, resolution, heights->data(), 1.0f, 0.0f, heightMax, 1, PHY_FLOAT, false), m_heights(heights) {}
+
+		private:
+			shared_ptr<const vector<float>> m_heights;
+		};
+	}
+
 	Collider::Collider(Context* context, Actor* actor, Transform* transform) : IComponent(context, actor, transform)
 	{
 		m_shapeType = ColliderShape_Box;
-		m_center	= Vector3::Zero;
-		m_size		= Vector3::One;
-		m_shape			= nullptr;
+		m_center		= Vector3::Zero;
+		m_size			= Vector3::One;
+		m_shapeCenter	= Vector3::Zero;
 
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_size, Vector3);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_center, Vector3);
@@ -145,40 +175,88 @@ namespace Directus
 	void Collider::Shape_Update()
 	{
 		Shape_Release();
-		Vector3 worldScale = GetTransform()->GetScale();
+		m_shapeCenter		= Vector3::Zero;
+		Vector3 worldScale	= GetTransform()->GetScale();
+		auto cache			= GetContext()->GetSubsystem<Physics>()->GetShapeCache();
+
+		// Everything a shape is built from is part of it's key, the plane is the one shape that isn't scaled
+		size_t key = hash<int>()(m_shapeType);
+		if (m_shapeType != ColliderShape_StaticPlane)
+		{
+			_Collider::HashVector(key, worldScale);
+		}
+
+		if (m_shapeType == ColliderShape_Terrain)
+		{
+			Terrain* terrain = GetActor_PtrRaw()->GetComponent<Terrain>().get();
+			if (!terrain)
+			{
+				LOG_WARNING("Collider::Shape_Update: Can't construct terrain shape, there is no Terrain component attached.");
+				return;
+			}
+
+			auto heights			= terrain->GetCollisionHeights();
+			unsigned int resolution	= terrain->GetCollisionResolution();
+			if (!heights || resolution < 2)
+				return;
 
-		switch (m_shapeType)
+			// Samples are a unit apart in the shape, scaled to the terrain's size
+			float spacing	= terrain->GetSize() / float(resolution - 1);
+			float height	= terrain->GetHeight();
+			m_shapeCenter	= Vector3(0.0f, height * 0.5f * worldScale.y, 0.0f);
+			CollisionShapeCache::HashCombine(key, terrain->GetCollisionKey());
+			m_shape = cache->Get(key, [&heights, resolution, spacing, height, &worldScale]() -> btCollisionShape*
+			{
+				auto shape = new _Collider::HeightfieldShape(heights, (int)resolution, height);
+				shape->setLocalScaling(ToBtVector3(Vector3(spacing * worldScale.x, worldScale.y, spacing * worldScale.z)));
+				return shape;
+			});
+		}
+		else if (m_shapeType != ColliderShape_Mesh)
+		{
+			_Collider::HashVector(key, m_size);
+			m_shape = cache->Get(key, [this, &worldScale]() -> btCollisionShape*
+			{
+				btCollisionShape* shape = nullptr;
+				switch (m_shapeType)
+				{
+				case ColliderShape_Box:
+					shape = new btBoxShape(ToBtVector3(m_size * 0.5f));
+					shape->setLocalScaling(ToBtVector3(worldScale));
+					break;
+
+				case ColliderShape_Sphere:
+					shape = new btSphereShape(m_size.x * 0.5f);
+					shape->setLocalScaling(ToBtVector3(worldScale));
+					break;
+
+				case ColliderShape_StaticPlane:
+					shape = new btStaticPlaneShape(btVector3(0.0f, 1.0f, 0.0f), 0.0f);
+					break;
+
+				case ColliderShape_Cylinder:
+					shape = new btCylinderShape(btVector3(m_size.x * 0.5f, m_size.y * 0.5f, m_size.x * 0.5f));
+					shape->setLocalScaling(ToBtVector3(worldScale));
+					break;
+
+				case ColliderShape_Capsule:
+					shape = new btCapsuleShape(m_size.x * 0.5f, Max(m_size.y - m_size.x, 0.0f));
+					shape->setLocalScaling(ToBtVector3(worldScale));
+					break;
+
+				case ColliderShape_Cone:
+					shape = new btConeShape(m_size.x * 0.5f, m_size.y);
+					shape->setLocalScaling(ToBtVector3(worldScale));
+					break;
+
+				default:
+					break;
+				}
+				return shape;
+			});
+		}
+		else
 		{
-		case ColliderShape_Box:
-			m_shape = new btBoxShape(ToBtVector3(m_size * 0.5f));
-			m_shape->setLocalScaling(ToBtVector3(worldScale));
-			break;
-
-		case ColliderShape_Sphere:
-			m_shape = new btSphereShape(m_size.x * 0.5f);
-			m_shape->setLocalScaling(ToBtVector3(worldScale));
-			break;
-
-		case ColliderShape_StaticPlane:
-			m_shape = new btStaticPlaneShape(btVector3(0.0f, 1.0f, 0.0f), 0.0f);
-			break;
-
-		case ColliderShape_Cylinder:
-			m_shape = new btCylinderShape(btVector3(m_size.x * 0.5f, m_size.y * 0.5f, m_size.x * 0.5f));
-			m_shape->setLocalScaling(ToBtVector3(worldScale));
-			break;
-
-		case ColliderShape_Capsule:
-			m_shape = new btCapsuleShape(m_size.x * 0.5f, Max(m_size.y - m_size.x, 0.0f));
-			m_shape->setLocalScaling(ToBtVector3(worldScale));
-			break;
-
-		case ColliderShape_Cone:
-			m_shape = new btConeShape(m_size.x * 0.5f, m_size.y);
-			m_shape->setLocalScaling(ToBtVector3(worldScale));
-			break;
-
-		case ColliderShape_Mesh:
 			// Get Renderable
 			Renderable* renderable = GetActor_PtrRaw()->GetComponent<Renderable>().get();
 			if (!renderable)
@@ -205,35 +283,72 @@ namespace Directus
 				return;
 			}
 
-			// Construct hull approximation
-			m_shape = new btConvexHullShape(
-				(btScalar*)&vertices[0],					// points
-				renderable->Geometry_VertexCount(),			// point count
-				(unsigned int)sizeof(RHI_Vertex_PosUVTBN));	// stride
-
-			// Scaling has to be done before (potential) optimization
-			m_shape->setLocalScaling(ToBtVector3(worldScale));
-
-			// Optimize if requested
-			if (m_optimize)
+			// The hull only depends on the vertices, so it's cooked once whatever the scale it's used at
+			unsigned int vertexCount	= renderable->Geometry_VertexCount();
+			size_t hullKey				= hash<string_view>()(string_view((const char*)vertices.data(), vertices.size() * sizeof(RHI_Vertex_PosUVTBN)));
+			CollisionShapeCache::HashCombine(hullKey, hash<unsigned int>()(vertexCount));
+			CollisionShapeCache::HashCombine(hullKey, hash<bool>()(m_optimize));
+			CollisionShapeCache::HashCombine(key, hullKey);
+
+			// Cooked next to the model, geometry that isn't saved anywhere is built every time
+			string cookedFilePath;
+			Model* model = renderable->Geometry_Model();
+			if (model && model->HasFilePath())
 			{
-				auto hull = (btConvexHullShape*)m_shape;
-				hull->optimizeConvexHull();
-				hull->initializePolyhedralFeatures();
+				ostringstream name;
+				name << FileSystem::GetFilePathWithoutExtension(model->GetResourceFilePath()) << "_" << hex << setw(16) << setfill('0') << hullKey << EXTENSION_COLLISION;
+				cookedFilePath = name.str();
 			}
-			break;
+
+			m_shape = cache->Get(key, [this, &worldScale, &vertices, vertexCount, hullKey, &cookedFilePath]() -> btCollisionShape*
+			{
+				vector<float> cooked;
+				if (!cookedFilePath.empty() && CollisionShapeCache::Hull_Load(cookedFilePath, hullKey, &cooked))
+				{
+					auto hull = new btConvexHullShape(cooked.data(), (int)cooked.size() / 3, 3 * sizeof(float));
+					hull->setLocalScaling(ToBtVector3(worldScale));
+					if (m_optimize)
+					{
+						hull->initializePolyhedralFeatures();
+					}
+					return hull;
+				}
+
+				// Construct hull approximation
+				auto hull = new btConvexHullShape(
+					(btScalar*)&vertices[0],					// points
+					vertexCount,								// point count
+					(unsigned int)sizeof(RHI_Vertex_PosUVTBN));	// stride
+
+				// Scaling has to be done before (potential) optimization
+				hull->setLocalScaling(ToBtVector3(worldScale));
+
+				// Optimize if requested
+				if (m_optimize)
+				{
+					hull->optimizeConvexHull();
+					hull->initializePolyhedralFeatures();
+				}
+
+				if (!cookedFilePath.empty())
+				{
+					CollisionShapeCache::Hull_Save(cookedFilePath, hullKey, hull);
+				}
+				return hull;
+			});
 		}
 
-		m_shape->setUserPointer(this);
+		if (!m_shape)
+			return;
 
-		RigidBody_SetShape(m_shape);
+		RigidBody_SetShape(m_shape.get());
 		RigidBody_SetCenterOfMass(m_center);
 	}
 
 	void Collider::Shape_Release()
 	{
 		RigidBody_SetShape(nullptr);
-		SafeDelete(m_shape);
+		m_shape = nullptr;
 	}
 
 	void Collider::RigidBody_SetShape(btCollisionShape* shape)
@@ -248,7 +363,7 @@ namespace Directus
 	{
 		if (const auto& rigidBody = m_actor->GetComponent<RigidBody>())
 		{
-			rigidBody->SetCenterOfMass(center);
+			rigidBody->SetCenterOfMass(center + m_shapeCenter);
 		}
 	}
 }
\ No newline at end of file
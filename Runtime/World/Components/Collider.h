@@ -42,6 +42,7 @@ namespace Directus
 		ColliderShape_Capsule,
 		ColliderShape_Cone,
 		ColliderShape_Mesh,
+		ColliderShape_Terrain, // the heights of the actor's Terrain
 	};
 
 	class ENGINE_CLASS Collider : public IComponent
@@ -71,21 +72,24 @@ namespace Directus
 		void SetShapeType(ColliderShape type);
 
 		// Collision shape
-		const auto& GetShape() { return m_shape; }
+		btCollisionShape* GetShape() { return m_shape.get(); }
 
 		bool GetOptimize() { return m_optimize; }
 		void SetOptimize(bool optimize);
 
-	private:
+		// Rebuilds the shape, a Terrain calls it whenever it's heights change
 		void Shape_Update();
+
+	private:
 		void Shape_Release();
 		void RigidBody_SetShape(btCollisionShape* shape);
 		void RigidBody_SetCenterOfMass(const Math::Vector3& center);
 
 		ColliderShape m_shapeType;
-		btCollisionShape* m_shape;
+		std::shared_ptr<btCollisionShape> m_shape; // shared by the colliders with the same one, see CollisionShapeCache
 		Math::Vector3 m_size;
 		Math::Vector3 m_center;
+		Math::Vector3 m_shapeCenter; // where the shape's origin is relative to the actor, heightfields are centered on their heights
 		unsigned int m_vertexLimit = 100000;
 		bool m_optimize = true;
 	};
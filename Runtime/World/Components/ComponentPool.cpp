@@ -0,0 +1,66 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============
+#include "ComponentPool.h"
+//==========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	namespace _ComponentPool
+	{
+		vector<IComponent*> components[ComponentType_Unknown + 1];
+	}
+
+	void ComponentPool::Add(IComponent* component)
+	{
+		if (!component)
+			return;
+
+		auto& components		= _ComponentPool::components[component->GetType()];
+		component->m_poolIndex	= (unsigned int)components.size();
+		components.emplace_back(component);
+	}
+
+	void ComponentPool::Remove(IComponent* component)
+	{
+		if (!component)
+			return;
+
+		auto& components	= _ComponentPool::components[component->GetType()];
+		auto index			= component->m_poolIndex;
+		if (index >= (unsigned int)components.size() || components[index] != component)
+			return;
+
+		components[index]				= components.back();
+		components[index]->m_poolIndex	= index;
+		components.pop_back();
+	}
+
+	const vector<IComponent*>& ComponentPool::Get(ComponentType type)
+	{
+		return _ComponentPool::components[type];
+	}
+}
@@ -0,0 +1,43 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ================
+#include <vector>
+#include "IComponent.h"
+#include "../PoolAllocator.h"
+//============================
+
+namespace Directus
+{
+	// Every live component of a ComponentType in one packed array, so a system walks all of them (e.g. every Transform)
+	// linearly instead of going through their actors. The components themselves are carved out of chunks that only hold
+	// their type, see PoolAllocator, so walking the array walks memory that is mostly contiguous as well.
+	class ENGINE_CLASS ComponentPool
+	{
+	public:
+		static void Add(IComponent* component);
+		// Swaps the last component of the type into the removed one's place
+		static void Remove(IComponent* component);
+		static const std::vector<IComponent*>& Get(ComponentType type);
+	};
+}
\ No newline at end of file
@@ -28,6 +28,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Camera.h"
 #include "AudioSource.h"
 #include "AudioListener.h"
+#include "ParticleEmitter.h"
+#include "Terrain.h"
+#include "LightProbeVolume.h"
+#include "ReflectionProbe.h"
 #include "../Actor.h"
 #include "../../Core/GUIDGenerator.h"
 #include "../../FileSystem/FileSystem.h"
@@ -77,4 +81,8 @@ namespace Directus
 	REGISTER_COMPONENT(Script,			ComponentType_Script)
 	REGISTER_COMPONENT(Skybox,			ComponentType_Skybox)
 	REGISTER_COMPONENT(Transform,		ComponentType_Transform)
+	REGISTER_COMPONENT(ParticleEmitter,	ComponentType_ParticleEmitter)
+	REGISTER_COMPONENT(Terrain,			ComponentType_Terrain)
+	REGISTER_COMPONENT(LightProbeVolume,	ComponentType_LightProbeVolume)
+	REGISTER_COMPONENT(ReflectionProbe,	ComponentType_ReflectionProbe)
 }
@@ -50,6 +50,10 @@ namespace Directus
 		ComponentType_Script,
 		ComponentType_Skybox,
 		ComponentType_Transform,
+		ComponentType_ParticleEmitter, // saved worlds store types by value, so new ones go last
+		ComponentType_Terrain,
+		ComponentType_LightProbeVolume,
+		ComponentType_ReflectionProbe,
 		ComponentType_Unknown
 	};
 
@@ -83,9 +87,12 @@ namespace Directus
 		// Runs when the actor is being saved
 		virtual void Serialize(FileStream* stream) {}
 
-		// Runs when the actor is being loaded
+		// Runs when the actor is being loaded, what older versions wrote is told apart by stream->Chunk_GetVersion()
 		virtual void Deserialize(FileStream* stream) {}
 
+		// Goes up whenever what Serialize() writes changes, it's saved along with it
+		virtual unsigned int GetSerializedVersion() { return 1; }
+
 		//= PROPERTIES ==========================================================================
 		Actor*					GetActor_PtrRaw()		{ return m_actor; }	
 		std::weak_ptr<Actor>	GetActor_PtrWeak()		{ return GetActor_PtrShared(); }
@@ -111,6 +118,14 @@ namespace Directus
 				m_attributes[i].setter(attributes[i].getter());
 			}
 		}
+		// Same as above, from values already read from another component's attributes (see Prefab)
+		void SetAttributeValues(const std::vector<std::any>& values)
+		{
+			for (unsigned int i = 0; i < (unsigned int)m_attributes.size() && i < (unsigned int)values.size(); i++)
+			{
+				m_attributes[i].setter(values[i]);
+			}
+		}
 		//=======================================================================================
 
 	protected:
@@ -149,7 +164,11 @@ namespace Directus
 		Context* m_context			= nullptr;
 
 	private:
+		friend class ComponentPool;
+
 		// The attributes of the component
 		std::vector<Attribute> m_attributes;
+		// Where the component is in it's type's ComponentPool
+		unsigned int m_poolIndex = 0;
 	};
 }
\ No newline at end of file
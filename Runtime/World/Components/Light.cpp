@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../World/Actor.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
+#include "../../Rendering/RenderTexturePool.h"
 #include "../../RHI/RHI_RenderTexture.h"
 //========================================
 
@@ -35,6 +36,9 @@ using namespace Directus::Math;
 using namespace std;
 //=============================
 
+#define SHADOW_CASCADE_REACH 100.0f // how much further toward the light than the camera a cascade goes, casters off screen still cast into it
+#define SHADOW_CASCADE_STEP 0.0625f // of a cascade's resolution, how far it's origin moves at once (the cascade grows by half of it to still cover the camera)
+
 namespace Directus
 {
 	Light::Light(Context* context, Actor* actor, Transform* transform) : IComponent(context, actor, transform)
@@ -83,6 +87,12 @@ namespace Directus
 		if (m_lightType != LightType_Directional)
 			return;
 
+		// A quality preset changed the resolution
+		if (!m_shadowMaps.empty() && m_shadowMapResolution != Settings::Get().Shadows_GetResolution())
+		{
+			ShadowMap_Create(true);
+		}
+
 		// DIRTY CHECK
 		if (m_lastPosLight != GetTransform()->GetPosition() || m_lastRotLight != GetTransform()->GetRotation())
 		{
@@ -98,20 +108,25 @@ namespace Directus
 			m_isDirty = true;
 		}
 
-		// Acquire camera
-		Camera* camera = m_context->GetSubsystem<Renderer>()->GetCamera();
+		// Acquire camera, there is none without a renderer (headless)
+		auto renderer	= m_context->GetSubsystem<Renderer>();
+		Camera* camera	= renderer ? renderer->GetCamera() : nullptr;
 		if (!camera)
 			return;
 
-		if (m_lastPosCamera != camera->GetTransform()->GetPosition())
+		// The projections are relative to the light's view, so they follow it's direction too
+		if (m_isDirty || m_lastPosCamera != camera->GetTransform()->GetPosition() || m_reverseZ != Renderer::RenderFlags_IsSet(Render_ReverseZ))
 		{
-			m_lastPosCamera = camera->GetTransform()->GetPosition();
+			m_lastPosCamera	= camera->GetTransform()->GetPosition();
+			m_reverseZ		= Renderer::RenderFlags_IsSet(Render_ReverseZ);
 
 			// Update shadow map projection matrices
 			m_shadowMapsProjectionMatrix.clear();
+			m_shadowMapsBounds.clear();
 			for (unsigned int i = 0; i < m_shadowMapCount; i++)
 			{
 				m_shadowMapsProjectionMatrix.emplace_back(Matrix());
+				m_shadowMapsBounds.emplace_back(BoundingBox());
 				ShadowMap_ComputeProjectionMatrix(i);
 			}
 
@@ -123,8 +138,10 @@ namespace Directus
 
 		for (unsigned int index = 0; index < (unsigned int)m_frustums.size(); index++)
 		{
-			m_frustums[index]->Construct(m_viewMatrix, ShadowMap_GetProjectionMatrix(index), camera->GetFarPlane());
+			const Matrix& projection = ShadowMap_GetProjectionMatrix(index);
+			m_frustums[index]->Construct(m_viewMatrix, m_reverseZ ? projection * Matrix::CreateReverseZ() : projection, camera->GetFarPlane());
 		}
+		m_isDirty = false;
 	}
 
 	void Light::Serialize(FileStream* stream)
@@ -223,6 +240,15 @@ namespace Directus
 		return m_shadowMapsProjectionMatrix[index];
 	}
 
+	const BoundingBox& Light::ShadowMap_GetBounds(unsigned int index /*= 0*/)
+	{
+		static const BoundingBox empty;
+		if (index >= (unsigned int)m_shadowMapsBounds.size())
+			return empty;
+
+		return m_shadowMapsBounds[index];
+	}
+
 	shared_ptr<RHI_RenderTexture> Light::ShadowMap_GetRenderTexture(unsigned int index /*= 0*/)
 	{
 		if (index >= (unsigned int)m_shadowMaps.size())
@@ -268,23 +294,34 @@ namespace Directus
 		if (index == 2)
 			extents = 90;
 
-		Vector3 center = m_lastPosCamera * m_viewMatrix;
-		Vector3 min = center - Vector3(extents, extents, extents);
-		Vector3 max = center + Vector3(extents, extents, extents);
-
 		//= Shadow shimmering remedy based on ============================================
 		// https://msdn.microsoft.com/en-us/library/windows/desktop/ee416324(v=vs.85).aspx
-		float fWorldUnitsPerTexel = (extents * 2.0f) / m_shadowMapResolution;
-
-		min /= fWorldUnitsPerTexel;
-		min.Floor();
-		min *= fWorldUnitsPerTexel;
-		max /= fWorldUnitsPerTexel;
-		max.Floor();
-		max *= fWorldUnitsPerTexel;
+		// The origin snaps to a grid of whole texels, a step of which is a few of them, so the projection (and with it
+		// the renderer's cache of the static casters) stays the same until the camera leaves the step it's in.
+		unsigned int stepTexels		= Max((unsigned int)(m_shadowMapResolution * SHADOW_CASCADE_STEP) & ~1u, 2u);
+		float fWorldUnitsPerTexel	= (extents * 2.0f) / (m_shadowMapResolution - stepTexels);
+		float step					= stepTexels * fWorldUnitsPerTexel;
+
+		Vector3 center	= m_lastPosCamera * m_viewMatrix;
+		center.x		= floorf(center.x / step + 0.5f) * step;
+		center.y		= floorf(center.y / step + 0.5f) * step;
+		center.z		= floorf(center.z / step + 0.5f) * step;
+
+		float half		= m_shadowMapResolution * fWorldUnitsPerTexel * 0.5f;
+		Vector3 min		= center - Vector3(half, half, half);
+		Vector3 max		= center + Vector3(half, half, half);
 		//================================================================================
 
+		// Pull the near plane toward the light
+		min.z -= SHADOW_CASCADE_REACH;
+		m_shadowMapsBounds[index] = BoundingBox(min, max);
+
 		m_shadowMapsProjectionMatrix[index] = Matrix::CreateOrthoOffCenterLH(min.x, max.x, min.y, max.y, min.z, max.z);
+		if (m_reverseZ)
+		{
+			// Shadow maps share the depth test with the camera
+			m_shadowMapsProjectionMatrix[index] *= Matrix::CreateReverseZ();
+		}
 	}
 
 	void Light::ShadowMap_Create(bool force)
@@ -294,32 +331,35 @@ namespace Directus
 
 		ShadowMap_Destroy();
 
-		// Compute shadow map count
-		if (GetLightType() == LightType_Directional)
-		{
-			m_shadowMapCount = 3; // cascades
-		}
-		else if (GetLightType() == LightType_Point)
-		{
-			m_shadowMapCount = 6; // points of view
-		}
-		else if (GetLightType() == LightType_Spot)
-		{
-			m_shadowMapCount = 1;
-		}
+		// Compute shadow map count, point and spot lights render into the renderer's shadow atlas instead
+		m_shadowMapCount = GetLightType() == LightType_Directional ? 3 : 0; // cascades
+
+		// Create the shadow maps, unless there is no renderer (headless)
+		auto renderer = m_context->GetSubsystem<Renderer>();
+		if (!renderer)
+			return;
 
-		// Create the shadow maps
 		m_shadowMapResolution	= Settings::Get().Shadows_GetResolution();
-		auto rhiDevice			= m_context->GetSubsystem<Renderer>()->GetRHIDevice();
+		auto pool				= renderer->GetRenderTexturePool();
 		for (unsigned int i = 0; i < m_shadowMapCount; i++)
 		{
-			m_shadowMaps.emplace_back(make_unique<RHI_RenderTexture>(rhiDevice, m_shadowMapResolution, m_shadowMapResolution, Texture_Format_R32_FLOAT, true, Texture_Format_D32_FLOAT)); // could use the g-buffers depth which should be same res
+			m_shadowMaps.emplace_back(pool->Acquire(m_shadowMapResolution, m_shadowMapResolution, Texture_Format_R32_FLOAT, true, Texture_Format_D32_FLOAT)); // could use the g-buffers depth which should be same res
+			m_shadowMaps.back()->SetMemoryCategory(Memory_Shadows);
 			m_frustums.emplace_back(make_shared<Frustum>());
 		}
 	}
 
 	void Light::ShadowMap_Destroy()
 	{
+		// The renderer can be gone already when the world is torn down on shutdown
+		auto renderer = m_context->GetSubsystem<Renderer>();
+		if (renderer && renderer->GetRenderTexturePool())
+		{
+			for (const auto& shadowMap : m_shadowMaps)
+			{
+				renderer->GetRenderTexturePool()->Release(shadowMap);
+			}
+		}
 		m_shadowMaps.clear();
 		m_shadowMaps.shrink_to_fit();
 
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Math/Vector4.h"
 #include "../../Math/Vector3.h"
 #include "../../Math/Matrix.h"
+#include "../../Math/BoundingBox.h"
 #include "../../RHI/RHI_Definition.h"
 //====================================
 
@@ -92,6 +93,8 @@ namespace Directus
 		
 		// Shadow maps
 		const Math::Matrix& ShadowMap_GetProjectionMatrix(unsigned int index = 0);
+		// The volume a cascade covers, in light view space (it reaches further toward the light than the cascade does)
+		const Math::BoundingBox& ShadowMap_GetBounds(unsigned int index = 0);
 		std::shared_ptr<RHI_RenderTexture> ShadowMap_GetRenderTexture(unsigned int index = 0);
 		float ShadowMap_GetSplit(unsigned int index = 0);
 		void ShadowMap_SetSplit(float split, unsigned int index = 0);
@@ -116,11 +119,13 @@ namespace Directus
 		Math::Quaternion m_lastRotLight;
 		Math::Vector3 m_lastPosLight;
 		Math::Vector3 m_lastPosCamera;
+		bool m_reverseZ = false;
 		bool m_isDirty;
 
 		// Shadow maps
 		std::vector<std::shared_ptr<RHI_RenderTexture>> m_shadowMaps;
 		std::vector<Math::Matrix> m_shadowMapsProjectionMatrix;
+		std::vector<Math::BoundingBox> m_shadowMapsBounds;
 		std::vector<std::shared_ptr<Math::Frustum>> m_frustums;
 		unsigned int m_shadowMapResolution;
 		unsigned int m_shadowMapCount;
@@ -0,0 +1,172 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============================
+#include "LightProbeVolume.h"
+#include "Transform.h"
+#include "../../Core/Context.h"
+#include "../../IO/FileStream.h"
+#include "../../Math/Packing.h"
+#include "../../Rendering/LightBaker.h"
+#include "../../Rendering/Renderer.h"
+#include "../../RHI/RHI_StructuredBuffer.h"
+#include "../../Logging/Log.h"
+//==========================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+//=============================
+
+namespace Directus
+{
+	LightProbeVolume::LightProbeVolume(Context* context, Actor* actor, Transform* transform) : IComponent(context, actor, transform)
+	{
+		REGISTER_ATTRIBUTE_GET_SET(GetSpacing, SetSpacing, float);
+		REGISTER_ATTRIBUTE_GET_SET(GetRays, SetRays, unsigned int);
+		REGISTER_ATTRIBUTE_GET_SET(GetBounces, SetBounces, unsigned int);
+
+		m_spacing		= 2.0f;
+		m_rays			= 256;
+		m_bounces		= 2;
+		m_size			= Vector3::Zero;
+		m_spacingBaked	= 0.0f;
+		m_count[0]		= m_count[1] = m_count[2] = 0;
+		m_bufferDirty	= false;
+	}
+
+	void LightProbeVolume::Serialize(FileStream* stream)
+	{
+		stream->Write(m_spacing);
+		stream->Write(m_rays);
+		stream->Write(m_bounces);
+		stream->Write(m_size);
+		stream->Write(m_spacingBaked);
+		stream->Write(m_count[0]);
+		stream->Write(m_count[1]);
+		stream->Write(m_count[2]);
+		stream->Write(m_probes);
+	}
+
+	void LightProbeVolume::Deserialize(FileStream* stream)
+	{
+		stream->Read(&m_spacing);
+		stream->Read(&m_rays);
+		stream->Read(&m_bounces);
+		stream->Read(&m_size);
+		stream->Read(&m_spacingBaked);
+		stream->Read(&m_count[0]);
+		stream->Read(&m_count[1]);
+		stream->Read(&m_count[2]);
+		stream->Read(&m_probes);
+
+		if (m_probes.size() != (size_t)m_count[0] * m_count[1] * m_count[2] * 9 * 2)
+		{
+			Clear();
+		}
+		m_bufferDirty = true;
+	}
+
+	bool LightProbeVolume::Bake()
+	{
+		// Enough probes to span the box, at least two along each axis so they can be interpolated
+		Vector3 size	= GetTransform()->GetScale().Absolute();
+		float spacing	= m_spacing;
+		unsigned int count[3];
+		for (;;)
+		{
+			count[0] = Helper::Max((unsigned int)(size.x / spacing) + 1, 2u);
+			count[1] = Helper::Max((unsigned int)(size.y / spacing) + 1, 2u);
+			count[2] = Helper::Max((unsigned int)(size.z / spacing) + 1, 2u);
+			if ((uint64_t)count[0] * count[1] * count[2] <= LIGHT_PROBES_MAX)
+				break;
+			spacing *= 1.25f;
+		}
+		if (spacing != m_spacing)
+		{
+			LOGF_WARNING("LightProbeVolume::Bake: Spaced the probes %.2f m apart, to stay within %d", spacing, LIGHT_PROBES_MAX);
+		}
+
+		// Centered in the box
+		Vector3 span	= Vector3(float(count[0] - 1), float(count[1] - 1), float(count[2] - 1)) * spacing;
+		Vector3 origin	= GetTransform()->GetPosition() - span * 0.5f;
+
+		vector<Vector3> coefficients;
+		if (!LightBaker(m_context).Bake(origin, count, spacing, m_rays, m_bounces, &coefficients))
+			return false;
+
+		// Halfs are plenty for irradiance and take half the memory (and bandwidth) of floats
+		lock_guard<mutex> lock(m_mutex);
+		m_probes.resize(coefficients.size() * 2);
+		for (size_t i = 0; i < coefficients.size(); i++)
+		{
+			const Vector3& c	= coefficients[i];
+			m_probes[i * 2]		= (unsigned int)Packing::FloatToHalf(c.x) | ((unsigned int)Packing::FloatToHalf(c.y) << 16);
+			m_probes[i * 2 + 1]	= (unsigned int)Packing::FloatToHalf(c.z);
+		}
+
+		m_size			= span;
+		m_spacingBaked	= spacing;
+		m_count[0]		= count[0];
+		m_count[1]		= count[1];
+		m_count[2]		= count[2];
+		m_bufferDirty	= true;
+		return true;
+	}
+
+	void LightProbeVolume::Clear()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_probes.clear();
+		m_probes.shrink_to_fit();
+		m_size			= Vector3::Zero;
+		m_spacingBaked	= 0.0f;
+		m_count[0]		= m_count[1] = m_count[2] = 0;
+		m_bufferDirty	= true;
+	}
+
+	Vector3 LightProbeVolume::GetOrigin()
+	{
+		return GetTransform()->GetPosition() - m_size * 0.5f;
+	}
+
+	const shared_ptr<RHI_StructuredBuffer>& LightProbeVolume::GetBuffer()
+	{
+		// The renderer asks while the editor might be baking
+		lock_guard<mutex> lock(m_mutex);
+		if (m_bufferDirty)
+		{
+			m_bufferDirty = false;
+			m_buffer.reset();
+			if (!m_probes.empty())
+			{
+				m_buffer = make_shared<RHI_StructuredBuffer>(m_context->GetSubsystem<Renderer>()->GetRHIDevice());
+				if (!m_buffer->Create(sizeof(unsigned int) * 2, (unsigned int)m_probes.size() / 2, m_probes.data()))
+				{
+					LOG_ERROR("LightProbeVolume::GetBuffer: Failed to create the probe buffer");
+					m_buffer.reset();
+				}
+			}
+		}
+
+		return m_buffer;
+	}
+}
@@ -0,0 +1,92 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <memory>
+#include <vector>
+#include <mutex>
+#include "IComponent.h"
+#include "../../Math/Vector3.h"
+#include "../../Math/MathHelper.h"
+#include "../../RHI/RHI_Definition.h"
+//=================================
+
+#define LIGHT_PROBES_MAX 65536 // probes a volume bakes, at most, the spacing grows to stay within it
+
+namespace Directus
+{
+	// A grid of irradiance probes filling the actor's box (it's scale, centered on it's position), baked out of the static
+	// geometry by the LightBaker. The light pass takes the diffuse ambient of whatever is inside the box from the probes,
+	// the environment's everywhere else. The probes keep the layout they were baked with, moving the actor moves them along.
+	class ENGINE_CLASS LightProbeVolume : public IComponent
+	{
+	public:
+		LightProbeVolume(Context* context, Actor* actor, Transform* transform);
+		~LightProbeVolume() {}
+
+		//= COMPONENT ================================
+		void Serialize(FileStream* stream) override;
+		void Deserialize(FileStream* stream) override;
+		//============================================
+
+		// Meters between probes
+		float GetSpacing()							{ return m_spacing; }
+		void SetSpacing(float spacing)				{ m_spacing = Math::Helper::Max(spacing, 0.1f); }
+
+		// Per probe, more of them are less noisy
+		unsigned int GetRays()						{ return m_rays; }
+		void SetRays(unsigned int rays)				{ m_rays = Math::Helper::Clamp(rays, 16u, 4096u); }
+
+		// Times a ray bounces off the geometry, 0 only lets it pick up what the first surface it hits reflects
+		unsigned int GetBounces()					{ return m_bounces; }
+		void SetBounces(unsigned int bounces)		{ m_bounces = Math::Helper::Min(bounces, 8u); }
+
+		// Blocks until it's done, on every worker thread
+		bool Bake();
+		bool IsBaked()								{ return !m_probes.empty(); }
+		void Clear();
+
+		// The first probe, in world space
+		Math::Vector3 GetOrigin();
+		// Meters between probes as baked
+		float GetSpacingBaked()						{ return m_spacingBaked; }
+		const unsigned int* GetCount()				{ return m_count; }
+		// 9 coefficients per probe, rgb as halfs in two uints each, null until baked
+		const std::shared_ptr<RHI_StructuredBuffer>& GetBuffer();
+
+	private:
+		float m_spacing;
+		unsigned int m_rays;
+		unsigned int m_bounces;
+
+		// As baked
+		Math::Vector3 m_size;
+		float m_spacingBaked;
+		unsigned int m_count[3];
+		std::vector<unsigned int> m_probes;
+
+		std::shared_ptr<RHI_StructuredBuffer> m_buffer;
+		bool m_bufferDirty;
+		std::mutex m_mutex; // guards what's baked and the buffer
+	};
+}
@@ -0,0 +1,104 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "ParticleEmitter.h"
+#include "../../IO/FileStream.h"
+//===============================
+
+//= NAMESPACES ================
+using namespace Directus::Math;
+//=============================
+
+#define PARTICLE_EMITTER_CAPACITY_MAX (1 << 20) // must fit the renderer's pool, see GPU_PARTICLES_MAX
+
+namespace Directus
+{
+	ParticleEmitter::ParticleEmitter(Context* context, Actor* actor, Transform* transform) : IComponent(context, actor, transform)
+	{
+		REGISTER_ATTRIBUTE_GET_SET(GetCapacity, SetCapacity, unsigned int);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_rate, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_lifetime, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_speed, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_spread, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_gravity, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_sizeStart, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_sizeEnd, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_colorStart, Vector4);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_colorEnd, Vector4);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_collisions, bool);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_bounce, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_emitting, bool);
+
+		m_capacity		= 4096;
+		m_rate			= 1000.0f;
+		m_lifetime		= 3.0f;
+		m_speed			= 4.0f;
+		m_spread		= 20.0f;
+		m_gravity		= 1.0f;
+		m_sizeStart		= 0.1f;
+		m_sizeEnd		= 0.3f;
+		m_colorStart	= Vector4(1.0f, 0.9f, 0.7f, 0.8f);
+		m_colorEnd		= Vector4(1.0f, 0.4f, 0.1f, 0.0f);
+		m_collisions	= true;
+		m_bounce		= 0.4f;
+		m_emitting		= true;
+	}
+
+	void ParticleEmitter::Serialize(FileStream* stream)
+	{
+		stream->Write(m_capacity);
+		stream->Write(m_rate);
+		stream->Write(m_lifetime);
+		stream->Write(m_speed);
+		stream->Write(m_spread);
+		stream->Write(m_gravity);
+		stream->Write(m_sizeStart);
+		stream->Write(m_sizeEnd);
+		stream->Write(m_colorStart);
+		stream->Write(m_colorEnd);
+		stream->Write(m_collisions);
+		stream->Write(m_bounce);
+		stream->Write(m_emitting);
+	}
+
+	void ParticleEmitter::Deserialize(FileStream* stream)
+	{
+		SetCapacity(stream->ReadUInt());
+		stream->Read(&m_rate);
+		stream->Read(&m_lifetime);
+		stream->Read(&m_speed);
+		stream->Read(&m_spread);
+		stream->Read(&m_gravity);
+		stream->Read(&m_sizeStart);
+		stream->Read(&m_sizeEnd);
+		stream->Read(&m_colorStart);
+		stream->Read(&m_colorEnd);
+		stream->Read(&m_collisions);
+		stream->Read(&m_bounce);
+		stream->Read(&m_emitting);
+	}
+
+	void ParticleEmitter::SetCapacity(unsigned int capacity)
+	{
+		m_capacity = Helper::Clamp(capacity, 1u, (unsigned int)PARTICLE_EMITTER_CAPACITY_MAX);
+	}
+}
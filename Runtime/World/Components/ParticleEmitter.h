@@ -0,0 +1,103 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include "IComponent.h"
+#include "../../Math/Vector4.h"
+#include "../../Math/MathHelper.h"
+//================================
+
+namespace Directus
+{
+	// Emits particles that live on the GPU, the renderer simulates and draws them (see GPUParticles). Particles leave
+	// along the actor's up axis, within a cone, fall with gravity and bounce off whatever the camera sees.
+	class ENGINE_CLASS ParticleEmitter : public IComponent
+	{
+	public:
+		ParticleEmitter(Context* context, Actor* actor, Transform* transform);
+		~ParticleEmitter() {}
+
+		//= COMPONENT ================================
+		void Serialize(FileStream* stream) override;
+		void Deserialize(FileStream* stream) override;
+		//============================================
+
+		// The most particles alive at once, the oldest ones make room for new ones
+		unsigned int GetCapacity()					{ return m_capacity; }
+		void SetCapacity(unsigned int capacity);
+
+		// Particles per second
+		float GetRate()								{ return m_rate; }
+		void SetRate(float rate)					{ m_rate = Math::Helper::Max(rate, 0.0f); }
+
+		// Seconds
+		float GetLifetime()							{ return m_lifetime; }
+		void SetLifetime(float lifetime)			{ m_lifetime = Math::Helper::Max(lifetime, 0.01f); }
+
+		float GetSpeed()							{ return m_speed; }
+		void SetSpeed(float speed)					{ m_speed = speed; }
+
+		// Half of the cone's angle, in degrees
+		float GetSpread()							{ return m_spread; }
+		void SetSpread(float spread)				{ m_spread = Math::Helper::Clamp(spread, 0.0f, 180.0f); }
+
+		// A multiplier of the world's gravity
+		float GetGravity()							{ return m_gravity; }
+		void SetGravity(float gravity)				{ m_gravity = gravity; }
+
+		float GetSizeStart()						{ return m_sizeStart; }
+		void SetSizeStart(float size)				{ m_sizeStart = Math::Helper::Max(size, 0.0f); }
+		float GetSizeEnd()							{ return m_sizeEnd; }
+		void SetSizeEnd(float size)					{ m_sizeEnd = Math::Helper::Max(size, 0.0f); }
+
+		const Math::Vector4& GetColorStart()		{ return m_colorStart; }
+		void SetColorStart(const Math::Vector4& color)	{ m_colorStart = color; }
+		const Math::Vector4& GetColorEnd()			{ return m_colorEnd; }
+		void SetColorEnd(const Math::Vector4& color)	{ m_colorEnd = color; }
+
+		// Against the depth buffer, the fraction of the speed a particle keeps when it bounces
+		bool GetCollisions()						{ return m_collisions; }
+		void SetCollisions(bool collisions)			{ m_collisions = collisions; }
+		float GetBounce()							{ return m_bounce; }
+		void SetBounce(float bounce)				{ m_bounce = Math::Helper::Clamp(bounce, 0.0f, 1.0f); }
+
+		// Particles already alive live on when it stops
+		bool IsEmitting()							{ return m_emitting; }
+		void SetEmitting(bool emitting)				{ m_emitting = emitting; }
+
+	private:
+		unsigned int m_capacity;
+		float m_rate;
+		float m_lifetime;
+		float m_speed;
+		float m_spread;
+		float m_gravity;
+		float m_sizeStart;
+		float m_sizeEnd;
+		Math::Vector4 m_colorStart;
+		Math::Vector4 m_colorEnd;
+		bool m_collisions;
+		float m_bounce;
+		bool m_emitting;
+	};
+}
@@ -0,0 +1,59 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "ReflectionProbe.h"
+#include "Transform.h"
+#include "../../IO/FileStream.h"
+//===============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+//=============================
+
+namespace Directus
+{
+	ReflectionProbe::ReflectionProbe(Context* context, Actor* actor, Transform* transform) : IComponent(context, actor, transform)
+	{
+		REGISTER_ATTRIBUTE_GET_SET(GetUpdate, SetUpdate, ReflectionProbe_Update);
+
+		m_update			= ReflectionProbe_Static;
+		m_captureRequests	= 0;
+	}
+
+	void ReflectionProbe::Serialize(FileStream* stream)
+	{
+		stream->Write(int(m_update));
+	}
+
+	void ReflectionProbe::Deserialize(FileStream* stream)
+	{
+		m_update = ReflectionProbe_Update(stream->ReadInt());
+	}
+
+	BoundingBox ReflectionProbe::GetBox()
+	{
+		Vector3 position	= GetTransform()->GetPosition();
+		Vector3 extents		= GetTransform()->GetScale().Absolute() * 0.5f;
+		return BoundingBox(position - extents, position + extents);
+	}
+}
@@ -0,0 +1,65 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include "IComponent.h"
+#include "../../Math/BoundingBox.h"
+//=================================
+
+namespace Directus
+{
+	enum ReflectionProbe_Update
+	{
+		ReflectionProbe_Static,		// captured once, again when it moves or static geometry changes
+		ReflectionProbe_Realtime	// captured over and over
+	};
+
+	// A cubemap of the surroundings, captured by the renderer (see ReflectionProbes) from the actor's position a face per frame,
+	// and prefiltered like the skybox's. Whatever is inside the actor's box (it's scale, centered on it's position) reflects
+	// it instead of the skybox, projected onto the box so that the reflections line up with the walls of a room.
+	class ENGINE_CLASS ReflectionProbe : public IComponent
+	{
+	public:
+		ReflectionProbe(Context* context, Actor* actor, Transform* transform);
+		~ReflectionProbe() {}
+
+		//= COMPONENT ================================
+		void Serialize(FileStream* stream) override;
+		void Deserialize(FileStream* stream) override;
+		//============================================
+
+		ReflectionProbe_Update GetUpdate()					{ return m_update; }
+		void SetUpdate(ReflectionProbe_Update update)		{ m_update = update; }
+
+		// In world space
+		Math::BoundingBox GetBox();
+
+		// Captures it again, whatever it's update is
+		void Capture()										{ m_captureRequests++; }
+		unsigned int GetCaptureRequests()					{ return m_captureRequests; }
+
+	private:
+		ReflectionProbe_Update m_update;
+		unsigned int m_captureRequests;
+	};
+}
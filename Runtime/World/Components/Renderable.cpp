@@ -22,9 +22,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===============================
 #include "Renderable.h"
 #include "Transform.h"
+#include "../Actor.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceManager.h"
-#include "../../Rendering/GeometryUtility.h"
 #include "../../Rendering/Material.h"
 #include "../../Rendering/Model.h"
 //==========================================
@@ -40,51 +40,19 @@ namespace Directus
 	{
 		inline void Build(GeometryType type, Renderable* renderable)
 		{	
-			Model* model = new Model(renderable->GetContext());
-			vector<RHI_Vertex_PosUVTBN> vertices;
-			vector<unsigned int> indices;
-
-			// Construct geometry
-			if (type == Geometry_Default_Cube)
-			{
-				GeometryUtility::CreateCube(&vertices, &indices);		
-				model->SetResourceName("Default_Cube");
-			}
-			else if (type == Geometry_Default_Quad)
-			{
-				GeometryUtility::CreateQuad(&vertices, &indices);
-				model->SetResourceName("Default_Cube");
-			}
-			else if (type == Geometry_Default_Sphere)
-			{
-				GeometryUtility::CreateSphere(&vertices, &indices);
-				model->SetResourceName("Default_Cube");
-			}
-			else if (type == Geometry_Default_Cylinder)
-			{
-				GeometryUtility::CreateCylinder(&vertices, &indices);
-				model->SetResourceName("Default_Cube");
-			}
-			else if (type == Geometry_Default_Cone)
-			{
-				GeometryUtility::CreateCone(&vertices, &indices);
-				model->SetResourceName("Default_Cube");
-			}
-
-			if (vertices.empty() || indices.empty())
+			// Every renderable of a type draws the same engine owned model
+			const auto& primitive = renderable->GetContext()->GetSubsystem<ResourceManager>()->Primitive_Get(type);
+			if (!primitive.model)
 				return;
 
-			model->Geometry_Append(indices, vertices, nullptr, nullptr);
-			model->Geometry_Update();
-
 			renderable->Geometry_Set(
 				"Default_Geometry",
 				0,
-				(unsigned int)indices.size(),
+				primitive.indexCount,
 				0,
-				(unsigned int)vertices.size(),
-				BoundingBox(vertices),
-				model
+				primitive.vertexCount,
+				primitive.model->Geometry_AABB(),
+				primitive.model.get()
 			);
 		}
 	}
@@ -96,6 +64,8 @@ namespace Directus
 		m_geometryIndexCount	= 0;
 		m_geometryVertexOffset	= 0;
 		m_geometryVertexCount	= 0;
+		m_geometryBBRevision	= 0;
+		m_geometryBBValid		= false;
 		m_materialDefault		= false;
 		m_castShadows			= true;
 		m_receiveShadows		= true;
@@ -116,10 +86,7 @@ namespace Directus
 
 	Renderable::~Renderable()
 	{
-		if (m_geometryType != Geometry_Custom)
-		{
-			delete m_model;
-		}
+
 	}
 
 	//= ICOMPONENT ===============================================================
@@ -190,6 +157,14 @@ namespace Directus
 		m_geometryVertexCount	= vertexCount;
 		m_geometryAABB			= AABB;
 		m_model					= model;
+
+		// The geometry is part of the Renderer's sort key
+		if (m_actor) m_actor->NotifyComponentsChanged();
+	}
+
+	bool Renderable::Geometry_IsSkinned() const
+	{
+		return m_model && m_model->Skin_IsSkinned(m_geometryVertexOffset);
 	}
 
 	void Renderable::Geometry_Set(GeometryType type)
@@ -213,9 +188,29 @@ namespace Directus
 		m_model->Geometry_Get(m_geometryIndexOffset, m_geometryIndexCount, m_geometryVertexOffset, m_geometryVertexCount, indices, vertices);
 	}
 
-	BoundingBox Renderable::Geometry_BB()
+	const BoundingBox& Renderable::Geometry_BB()
 	{
-		return m_geometryAABB.Transformed(GetTransform()->GetWorldTransform());
+		auto transform		= GetTransform();
+		const Matrix& world	= transform->GetWorldTransform(); // resolves first, which can change the revision
+
+		bool changed = !m_geometryBBValid || m_geometryBBRevision != transform->GetRevision() || m_geometryBBLocal.GetMin() != m_geometryAABB.GetMin() || m_geometryBBLocal.GetMax() != m_geometryAABB.GetMax();
+		if (changed)
+		{
+			// Skinned geometry leaves its bind pose, by as much as it can turn within its bounding sphere and the bones move
+			BoundingBox local = m_geometryAABB;
+			if (Geometry_IsSkinned())
+			{
+				Vector3 radius	= Vector3(m_geometryAABB.GetExtents().Length() + m_model->Skin_GetMotionRadius());
+				local			= BoundingBox(m_geometryAABB.GetCenter() - radius, m_geometryAABB.GetCenter() + radius);
+			}
+
+			m_geometryBB			= local.Transformed(world);
+			m_geometryBBLocal		= m_geometryAABB;
+			m_geometryBBRevision	= transform->GetRevision();
+			m_geometryBBValid		= true;
+		}
+
+		return m_geometryBB;
 	}
 	//==============================================================================
 
@@ -246,6 +241,9 @@ namespace Directus
 		{
 			m_material = material;
 		}
+
+		// The material decides the Renderer's sort key and whether this is an opaque or a transparent renderable
+		if (m_actor) m_actor->NotifyComponentsChanged();
 	}
 
 	shared_ptr<Material> Renderable::Material_Set(const string& filePath)
@@ -78,8 +78,12 @@ namespace Directus
 		GeometryType Geometry_Type()					{ return m_geometryType; }
 		const std::string& Geometry_Name()				{ return m_geometryName; }
 		Model* Geometry_Model()							{ return m_model; }
+		// Posed by bones every frame (see GPUSkinning), so it's never instanced or cached as a static shadow caster
+		bool Geometry_IsSkinned() const;
 		const Math::BoundingBox& Geometry_AABB() const	{ return m_geometryAABB; }
-		Math::BoundingBox Geometry_BB();
+		// The world space box, cached until the transform's revision or the geometry changes. The World's spatial
+		// update refreshes it whenever either does, so the render passes (possibly on other threads) only read it.
+		const Math::BoundingBox& Geometry_BB();
 		//===============================================================================================
 
 		//= MATERIAL ===========================================================================
@@ -110,6 +114,10 @@ namespace Directus
 		unsigned int m_geometryVertexOffset;
 		unsigned int m_geometryVertexCount;
 		Math::BoundingBox m_geometryAABB;
+		Math::BoundingBox m_geometryBB;
+		Math::BoundingBox m_geometryBBLocal;	// the AABB and the transform revision the world box was computed from
+		unsigned int m_geometryBBRevision;
+		bool m_geometryBBValid;
 		Model* m_model;
 		GeometryType m_geometryType;
 		//==================================
@@ -73,8 +73,7 @@ namespace Directus
 			Quaternion newWorldRot	= ToQuaternion(worldTrans.getRotation());
 			Vector3 newWorldPos		= ToVector3(worldTrans.getOrigin()) - newWorldRot * m_rigidBody->GetCenterOfMass();
 
-			m_rigidBody->GetTransform()->SetPosition(newWorldPos);
-			m_rigidBody->GetTransform()->SetRotation(newWorldRot);
+			m_rigidBody->Pose_Set(newWorldPos, newWorldRot);
 
 			m_rigidBody->m_hasSimulated = true;
 		}
@@ -133,9 +132,16 @@ namespace Directus
 	void RigidBody::OnTick()
 	{
 		// When in editor mode, get position from transform (so the user can move the body around)
-		if (!Engine::EngineMode_IsSet(Engine_Game))
+		if (!Engine::EngineMode_IsSet(Engine_Game) && m_transformRevision != GetTransform()->GetRevision())
 		{
 			SetPosition(GetTransform()->GetPosition());
+			m_transformRevision = GetTransform()->GetRevision();
+		}
+
+		// The actor was flagged static (or demoted to dynamic), the body has to be re-created as such
+		if (m_inWorld && m_isStatic != m_actor->IsStatic())
+		{
+			Body_AddToWorld();
 		}
 	}
 
@@ -392,9 +398,32 @@ namespace Directus
 			m_rigidBody->setInterpolationWorldTransform(interpTrans);
 		}
 
+		Pose_Reset();
 		Activate();
 	}
 
+	void RigidBody::Origin_Shift(const Vector3& offset)
+	{
+		if (!m_rigidBody)
+			return;
+
+		btVector3 shift = ToBtVector3(offset);
+		m_rigidBody->getWorldTransform().getOrigin() -= shift;
+
+		btTransform interpTrans = m_rigidBody->getInterpolationWorldTransform();
+		interpTrans.getOrigin() -= shift;
+		m_rigidBody->setInterpolationWorldTransform(interpTrans);
+
+		m_posePreviousPosition	-= offset;
+		m_poseCurrentPosition	-= offset;
+
+		// Static bodies only get their bounds updated when told to
+		if (m_inWorld)
+		{
+			m_physics->GetWorld()->updateSingleAabb(m_rigidBody);
+		}
+	}
+
 	//= ROTATION ============================================================
 	Quaternion RigidBody::GetRotation() const
 	{
@@ -427,9 +456,114 @@ namespace Directus
 
 		m_rigidBody->updateInertiaTensor();
 
+		Pose_Reset();
 		Activate();
 	}
 
+	//= INTERPOLATION =======================================================
+	void RigidBody::Pose_Store()
+	{
+		m_posePreviousPosition = m_poseCurrentPosition;
+		m_posePreviousRotation = m_poseCurrentRotation;
+	}
+
+	void RigidBody::Pose_Set(const Vector3& position, const Quaternion& rotation)
+	{
+		m_poseCurrentPosition = position;
+		m_poseCurrentRotation = rotation;
+
+		// Stepping in lockstep with the tick, the step is what gets rendered
+		if (!m_physics->IsInterpolating())
+		{
+			GetTransform()->SetPose(position, rotation);
+			return;
+		}
+
+		if (!m_poseMoving)
+		{
+			m_poseMoving = true;
+			m_physics->Body_Moved(this);
+		}
+	}
+
+	bool RigidBody::Pose_Interpolate(float alpha)
+	{
+		// Normalized lerp along the shorter arc, like Transform::Interpolate
+		const Quaternion& rotationA = m_posePreviousRotation;
+		const Quaternion& rotationB = m_poseCurrentRotation;
+		float sign = (rotationA.x * rotationB.x + rotationA.y * rotationB.y + rotationA.z * rotationB.z + rotationA.w * rotationB.w) < 0.0f ? -1.0f : 1.0f;
+		Quaternion rotation = Quaternion
+		(
+			Lerp(rotationA.x, rotationB.x * sign, alpha),
+			Lerp(rotationA.y, rotationB.y * sign, alpha),
+			Lerp(rotationA.z, rotationB.z * sign, alpha),
+			Lerp(rotationA.w, rotationB.w * sign, alpha)
+		).Normalized();
+
+		GetTransform()->SetPose(Lerp(m_posePreviousPosition, m_poseCurrentPosition, alpha), rotation);
+
+		// Didn't move in the last step, it's now at rest where it ended up
+		m_poseMoving = m_posePreviousPosition != m_poseCurrentPosition || m_posePreviousRotation != m_poseCurrentRotation;
+		return m_poseMoving;
+	}
+
+	void RigidBody::Pose_Reset()
+	{
+		// A body that's been placed (rather than simulated there) doesn't blend in from where it was
+		m_poseCurrentPosition	= m_posePreviousPosition = GetPosition();
+		m_poseCurrentRotation	= m_posePreviousRotation = GetRotation();
+	}
+
+	//= SIMULATION LOD ======================================================
+	void RigidBody::Lod_Set(SimulationLod lod)
+	{
+		if (!m_rigidBody || m_lod == lod)
+			return;
+
+		if (m_lod == SimulationLod_Full)
+		{
+			m_lodResting = m_rigidBody->getActivationState() == ISLAND_SLEEPING;
+		}
+		m_lod = lod;
+
+		if (lod == SimulationLod_Full)
+		{
+			m_rigidBody->forceActivationState(m_lodResting ? ISLAND_SLEEPING : ACTIVE_TAG);
+			m_rigidBody->setDeactivationTime(0.0f);
+			return;
+		}
+
+		// Out of the islands and not integrated, it keeps it's velocity for when it's simulated again
+		m_rigidBody->forceActivationState(DISABLE_SIMULATION);
+	}
+
+	void RigidBody::Lod_StepBegin(float steps)
+	{
+		if (!m_rigidBody || m_lodResting)
+			return;
+
+		// A step of dt behaves like one of steps x dt (semi-implicit Euler) with the velocity
+		// scaled by steps and the gravity by steps squared, Lod_StepEnd() scales them back.
+		m_rigidBody->forceActivationState(ACTIVE_TAG);
+		m_rigidBody->setLinearVelocity(m_rigidBody->getLinearVelocity() * steps);
+		m_rigidBody->setAngularVelocity(m_rigidBody->getAngularVelocity() * steps);
+		m_rigidBody->setGravity(m_rigidBody->getGravity() * steps * steps);
+	}
+
+	void RigidBody::Lod_StepEnd(float steps)
+	{
+		if (!m_rigidBody || m_lodResting)
+			return;
+
+		m_rigidBody->setLinearVelocity(m_rigidBody->getLinearVelocity() / steps);
+		m_rigidBody->setAngularVelocity(m_rigidBody->getAngularVelocity() / steps);
+		m_rigidBody->setGravity(m_rigidBody->getGravity() / (steps * steps));
+
+		// Came to rest, it isn't woken for the steps to come
+		m_lodResting = m_rigidBody->getActivationState() == ISLAND_SLEEPING;
+		m_rigidBody->forceActivationState(DISABLE_SIMULATION);
+	}
+
 	//= MISC ====================================================================
 	void RigidBody::ClearForces() const
 	{
@@ -501,12 +635,16 @@ namespace Directus
 			m_mass = 0.0f;
 		}
 
+		// A static actor gets a static body, whatever it's mass
+		m_isStatic	= m_actor->IsStatic();
+		float mass	= m_isStatic ? 0.0f : m_mass;
+
 		// Transfer inertia to new collision shape
 		btVector3 localInertia = btVector3(0, 0, 0);
 		if (m_collisionShape && m_rigidBody)
 		{
 			localInertia = m_rigidBody ? m_rigidBody->getLocalInertia() : localInertia;
-			m_collisionShape->calculateLocalInertia(m_mass, localInertia);
+			m_collisionShape->calculateLocalInertia(mass, localInertia);
 		}
 		
 		Body_Release();
@@ -517,8 +655,8 @@ namespace Directus
 			auto motionState = new MotionState(this);
 			
 			// Info
-			btRigidBody::btRigidBodyConstructionInfo constructionInfo(m_mass, motionState, m_collisionShape, localInertia);
-			constructionInfo.m_mass				= m_mass;
+			btRigidBody::btRigidBodyConstructionInfo constructionInfo(mass, motionState, m_collisionShape, localInertia);
+			constructionInfo.m_mass				= mass;
 			constructionInfo.m_friction			= m_friction;
 			constructionInfo.m_rollingFriction	= m_frictionRolling;
 			constructionInfo.m_restitution		= m_restitution;
@@ -549,7 +687,7 @@ namespace Directus
 
 		// Add to world
 		m_physics->GetWorld()->addRigidBody(m_rigidBody);
-		if (m_mass > 0.0f)
+		if (mass > 0.0f)
 		{
 			Activate();
 		}
@@ -586,6 +724,13 @@ namespace Directus
 		if (!m_rigidBody)
 			return;
 
+		if (m_poseMoving || m_lod != SimulationLod_Full)
+		{
+			m_physics->Body_Forget(this);
+			m_poseMoving	= false;
+			m_lod			= SimulationLod_Full;
+		}
+
 		if (m_inWorld)
 		{
 			m_physics->GetWorld()->removeRigidBody(m_rigidBody);
@@ -618,6 +763,15 @@ namespace Directus
 			flags &= ~btCollisionObject::CF_KINEMATIC_OBJECT;
 		}
 
+		if (m_isStatic)
+		{
+			flags |= btCollisionObject::CF_STATIC_OBJECT;
+		}
+		else
+		{
+			flags &= ~btCollisionObject::CF_STATIC_OBJECT;
+		}
+
 		m_rigidBody->setCollisionFlags(flags);
 		m_rigidBody->forceActivationState(m_isKinematic ? DISABLE_DEACTIVATION : ISLAND_SLEEPING);
 		m_rigidBody->setDeactivationTime(DEFAULT_DEACTIVATION_TIME);
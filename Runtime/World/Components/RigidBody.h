@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "IComponent.h"
 #include <memory>
 #include "../../Math/Vector3.h"
+#include "../../Math/Quaternion.h"
 #include <vector>
 //=============================
 
@@ -36,7 +37,6 @@ namespace Directus
 	class Actor;
 	class Constraint;
 	class Physics;
-	namespace Math { class Quaternion; }
 
 	enum ForceMode
 	{
@@ -44,6 +44,14 @@ namespace Directus
 		Impulse
 	};
 
+	// How often a body is stepped, by how far it is from the nearest viewer (see Physics::Lod_SetViewers)
+	enum SimulationLod
+	{
+		SimulationLod_Full,
+		SimulationLod_Reduced,	// every few steps, each taking the time of the ones it sat out
+		SimulationLod_Frozen	// not simulated until a viewer comes close again
+	};
+
 	class ENGINE_CLASS RigidBody : public IComponent
 	{
 	public:
@@ -119,6 +127,8 @@ namespace Directus
 		//= POSITION =======================================
 		Math::Vector3 GetPosition() const;
 		void SetPosition(const Math::Vector3& position);
+		// Moves the body opposite to the World's origin, it keeps moving as it was (see World::Origin_Shift)
+		void Origin_Shift(const Math::Vector3& offset);
 		//==================================================
 
 		//= ROTATION ======================================
@@ -134,6 +144,23 @@ namespace Directus
 		bool IsInWorld() { return m_inWorld; }
 		//===================================================
 
+		//= INTERPOLATION ====================================================================
+		// The pose after the last two physics steps, the transform is rendered between them
+		void Pose_Store();
+		void Pose_Set(const Math::Vector3& position, const Math::Quaternion& rotation);
+		bool Pose_Interpolate(float alpha);
+		const Math::Vector3& Pose_GetPosition(bool previous) const		{ return previous ? m_posePreviousPosition : m_poseCurrentPosition; }
+		const Math::Quaternion& Pose_GetRotation(bool previous) const	{ return previous ? m_posePreviousRotation : m_poseCurrentRotation; }
+		//====================================================================================
+
+		//= SIMULATION LOD =====================================================================
+		SimulationLod Lod_Get() const { return m_lod; }
+		void Lod_Set(SimulationLod lod);
+		// A reduced body is woken for one step that covers the time of the given number of them
+		void Lod_StepBegin(float steps);
+		void Lod_StepEnd(float steps);
+		//======================================================================================
+
 		// Communication with other physics components
 		void AddConstraint(Constraint* constraint);
 		void RemoveConstraint(Constraint* constraint);
@@ -147,6 +174,7 @@ namespace Directus
 		void Flags_UpdateKinematic();
 		void Flags_UpdateGravity();
 		bool IsActivated() const;
+		void Pose_Reset();
 
 		float m_mass;
 		float m_friction;
@@ -163,7 +191,16 @@ namespace Directus
 		btCollisionShape* m_collisionShape;
 		std::vector<Constraint*> m_constraints;
 		bool m_inWorld;
+		bool m_isStatic = false; // what the body was added to the world as, a static actor's body has no mass
 		Physics* m_physics;
+		Math::Vector3 m_posePreviousPosition;
+		Math::Vector3 m_poseCurrentPosition;
+		Math::Quaternion m_posePreviousRotation;
+		Math::Quaternion m_poseCurrentRotation;
+		bool m_poseMoving = false;				// in Physics' list of bodies that moved in the last step
+		SimulationLod m_lod = SimulationLod_Full;
+		bool m_lodResting = false;				// was asleep when it left full simulation, it's left asleep
+		unsigned int m_transformRevision = ~0U;	// the transform revision the body was last placed at in the editor
 	public:
 		bool m_hasSimulated;
 	};
@@ -19,7 +19,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ==============================
+//= INCLUDES ====================================
 #include "Skybox.h"
 #include "Transform.h"
 #include "Renderable.h"
@@ -28,7 +28,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../RHI/RHI_Texture.h"
 #include "../../Math/MathHelper.h"
 #include "../../Rendering/Material.h"
-//=========================================
+#include "../../Rendering/ImageBasedLighting.h"
+#include "../../FileSystem/FileSystem.h"
+#include "../../Logging/Log.h"
+//===============================================
 
 //= NAMESPACES ========================
 using namespace std;
@@ -44,6 +47,7 @@ namespace Directus
 		m_matSkybox			= make_shared<Material>(GetContext());
 		m_format			= Texture_Format_R8G8B8A8_UNORM;
 		m_skyboxType		= Skybox_Array;
+		m_ibl				= make_unique<ImageBasedLighting>(GetContext());
 
 		// Texture paths
 		auto cubemapDirectory = GetContext()->GetSubsystem<ResourceManager>()->GetStandardResourceDirectory(Resource_Cubemap);
@@ -87,13 +91,28 @@ namespace Directus
 
 	}
 
+	const shared_ptr<RHI_Texture>& Skybox::GetEnvironmentTexture()
+	{
+		return m_ibl->IsReady() ? m_ibl->GetSpecularTexture() : m_cubemapTexture;
+	}
+
+	unsigned int Skybox::GetEnvironmentMipCount()
+	{
+		return m_ibl->IsReady() ? m_ibl->GetSpecularMipCount() : 1;
+	}
+
+	const Vector4* Skybox::GetEnvironmentIrradianceSH()
+	{
+		return m_ibl->IsReady() ? m_ibl->GetIrradianceSH() : nullptr;
+	}
+
 	void Skybox::CreateFromArray(const vector<string>& texturePaths)
 	{
 		if (texturePaths.empty())
 			return;
 
 		// Load all textures (sides) in a different thread to speed up engine start-up
-		m_context->GetSubsystem<Threading>()->AddTask([this, &texturePaths]()
+		m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [this, &texturePaths]()
 		{
 			vector<vector<vector<std::byte>>> cubemapData;
 
@@ -130,6 +149,8 @@ namespace Directus
 				m_cubemapTexture->SetHeight(m_size);
 				m_cubemapTexture->SetGrayscale(false);
 			}
+
+			CreateEnvironment(cubemapData);
 		});
 
 		// Material
@@ -157,7 +178,7 @@ namespace Directus
 	void Skybox::CreateFromCross(const string& texturePath)
 	{
 		// Load all textures (sides) in a different thread to speed up engine start-up
-		m_context->GetSubsystem<Threading>()->AddTask([this, &texturePath]()
+		m_context->GetSubsystem<Threading>()->AddTask(ThreadGroup_Background, [this, &texturePath]()
 		{
 			// Load texture
 			vector<Mipmap> data; // vector<mip<data>>>
@@ -187,6 +208,8 @@ namespace Directus
 				m_cubemapTexture->SetHeight(m_size);
 				m_cubemapTexture->SetGrayscale(false);
 			}
+
+			CreateEnvironment(cubemapData);
 		});
 
 		// Material
@@ -210,4 +233,24 @@ namespace Directus
 		// Make the skybox big enough
 		GetTransform()->SetScale(Vector3(1000, 1000, 1000));
 	}
-}
\ No newline at end of file
+
+	void Skybox::CreateEnvironment(const vector<vector<Mipmap>>& cubemapData)
+	{
+		// Only plain 8-bit sides can be prefiltered, anything else keeps sampling the skybox
+		if (cubemapData.size() != 6 || m_format != Texture_Format_R8G8B8A8_UNORM)
+		{
+			LOG_WARNING("Skybox::CreateEnvironment: Unsupported cubemap, image based lighting will sample the skybox directly.");
+			return;
+		}
+
+		vector<Mipmap> sides;
+		for (const auto& side : cubemapData)
+		{
+			sides.emplace_back(side.empty() ? Mipmap() : side.front());
+		}
+
+		// Prefiltering takes a while, the result is cached next to the cubemap
+		auto cacheFilePath = FileSystem::GetDirectoryFromFilePath(m_texturePaths.front()) + "environment.ibl";
+		m_ibl->Generate(sides, m_size, cacheFilePath);
+	}
+}
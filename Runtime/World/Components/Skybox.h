@@ -30,6 +30,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Directus
 {
 	class Material;
+	class ImageBasedLighting;
+	namespace Math { class Vector4; }
 
 	enum Skybox_Type
 	{
@@ -51,10 +53,20 @@ namespace Directus
 		const std::shared_ptr<RHI_Texture>& GetTexture()	{ return m_cubemapTexture; }
 		std::weak_ptr<Material> GetMaterial()				{ return m_matSkybox;}
 
+		//= IMAGE BASED LIGHTING =====================================================================================
+		// The prefiltered cubemap once it's ready, the skybox itself until then
+		const std::shared_ptr<RHI_Texture>& GetEnvironmentTexture();
+		// Mips of the environment texture, the shader maps roughness onto them
+		unsigned int GetEnvironmentMipCount();
+		// Nine rgb coefficients of the diffuse irradiance, null until ready
+		const Math::Vector4* GetEnvironmentIrradianceSH();
+		//============================================================================================================
+
 	private:
 
 		void CreateFromArray(const std::vector<std::string>& texturePaths);
 		void CreateFromCross(const std::string& texturePath);
+		void CreateEnvironment(const std::vector<std::vector<std::vector<std::byte>>>& cubemapData);
 
 		// Cubemap sides
 		std::vector<std::string> m_texturePaths;
@@ -64,6 +76,9 @@ namespace Directus
 		std::shared_ptr<RHI_Texture> m_cubemapTexture;
 		Texture_Format m_format;
 
+		// Pre-integrated lighting of the cubemap
+		std::unique_ptr<ImageBasedLighting> m_ibl;
+
 		// Material
 		std::shared_ptr<Material> m_matSkybox;
 
@@ -0,0 +1,604 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============================
+#include "Terrain.h"
+#include "Collider.h"
+#include "../Actor.h"
+#include "../../IO/FileStream.h"
+#include "../../IO/AsyncIO.h"
+#include "../../Logging/Log.h"
+#include "../../FileSystem/FileSystem.h"
+#include "../../Math/MathHelper.h"
+#include "../../Rendering/Renderer.h"
+#include "../../RHI/RHI_Vertex.h"
+#include "../../RHI/RHI_VertexBuffer.h"
+#include "../../RHI/RHI_IndexBuffer.h"
+#include "../../Resource/ResourceManager.h"
+#include "../../Resource/DerivedDataCache.h"
+#include "../../Resource/Import/ImageImporter.h"
+#include "../../Physics/CollisionShapeCache.h"
+#include <algorithm>
+//=========================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+#define TERRAIN_VERSION	1			// has to change whenever the .terrain file does
+#define TERRAIN_MAGIC	0x4E525254	// "TRRN"
+#define TERRAIN_SKIRT	0.02f		// how far the skirts hang below a chunk's edges, of the chunk's size
+
+namespace Directus
+{
+	namespace _Terrain
+	{
+		// A chunk's samples, one more along each side than it's vertices so that the normals at the edges are right
+		const unsigned int tileSide		= TERRAIN_CHUNK_QUADS + 3;
+		const unsigned int tileSamples	= tileSide * tileSide;
+		const uint64_t tileBytes		= tileSamples * sizeof(uint16_t);
+
+		// Bilinear, u and v in [0, 1] and clamped to the edges
+		inline float Sample(const vector<float>& heights, unsigned int width, unsigned int height, float u, float v)
+		{
+			float x		= Clamp(u, 0.0f, 1.0f) * (width - 1);
+			float y		= Clamp(v, 0.0f, 1.0f) * (height - 1);
+			auto x0		= (unsigned int)x;
+			auto y0		= (unsigned int)y;
+			auto x1		= Min(x0 + 1, width - 1);
+			auto y1		= Min(y0 + 1, height - 1);
+			float fx	= x - x0;
+			float fy	= y - y0;
+
+			float bottom	= Lerp(heights[(size_t)y0 * width + x0], heights[(size_t)y0 * width + x1], fx);
+			float top		= Lerp(heights[(size_t)y1 * width + x0], heights[(size_t)y1 * width + x1], fx);
+			return Lerp(bottom, top, fy);
+		}
+
+		inline uint16_t Quantize(float value)
+		{
+			return (uint16_t)(Clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+		}
+
+		inline float Distance(const BoundingBox& box, const Vector3& position)
+		{
+			const Vector3& min	= box.GetMin();
+			const Vector3& max	= box.GetMax();
+			float dx			= Max(Max(min.x - position.x, position.x - max.x), 0.0f);
+			float dy			= Max(Max(min.y - position.y, position.y - max.y), 0.0f);
+			float dz			= Max(Max(min.z - position.z, position.z - max.z), 0.0f);
+			return sqrtf(dx * dx + dy * dy + dz * dz);
+		}
+	}
+
+	Terrain::Terrain(Context* context, Actor* actor, Transform* transform) : IComponent(context, actor, transform)
+	{
+		m_loads = make_shared<Loads>();
+
+		// The height map comes last, so that it's built with the size and height that come with it
+		REGISTER_ATTRIBUTE_VALUE_SET(m_size, SetSize, float);
+		REGISTER_ATTRIBUTE_VALUE_SET(m_height, SetHeight, float);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_lodDistance, float);
+		REGISTER_ATTRIBUTE_VALUE_SET(m_heightMapPath, SetHeightMap, string);
+	}
+
+	Terrain::~Terrain()
+	{
+		Tiles_Close();
+	}
+
+	void Terrain::Serialize(FileStream* stream)
+	{
+		stream->Write(m_heightMapPath);
+		stream->Write(m_size);
+		stream->Write(m_height);
+		stream->Write(m_lodDistance);
+	}
+
+	void Terrain::Deserialize(FileStream* stream)
+	{
+		string heightMapPath;
+		stream->Read(&heightMapPath);
+		stream->Read(&m_size);
+		stream->Read(&m_height);
+		stream->Read(&m_lodDistance);
+
+		SetHeightMap(heightMapPath);
+	}
+
+	void Terrain::SetHeightMap(const string& filePath)
+	{
+		if (filePath.empty())
+		{
+			m_heightMapPath.clear();
+			Tiles_Close();
+			Collider_Refresh();
+			return;
+		}
+
+		m_heightMapPath		= FileSystem::GetRelativeFilePath(filePath);
+		string tilesPath	= FileSystem::GetFilePathWithoutExtension(m_heightMapPath) + EXTENSION_TERRAIN;
+
+		// Building reads the whole height map and writes every chunk, a terrain imported before is read from what that import produced
+		auto ddc		= m_context->GetSubsystem<ResourceManager>()->GetDerivedDataCache();
+		string key		= ddc ? ddc->GetKey(m_heightMapPath, "Terrain", TERRAIN_VERSION, hash<unsigned int>()(TERRAIN_CHUNK_QUADS)) : "";
+		bool cached		= ddc && ddc->Fetch(key, tilesPath);
+		if (!cached)
+		{
+			if (!Tiles_Build(m_heightMapPath, tilesPath))
+			{
+				Tiles_Close();
+				Collider_Refresh();
+				return;
+			}
+
+			if (ddc)
+			{
+				ddc->Store(key, tilesPath);
+			}
+		}
+
+		if (!Tiles_Open(tilesPath))
+		{
+			Tiles_Close();
+		}
+		Collider_Refresh();
+	}
+
+	void Terrain::SetSize(float size)
+	{
+		size = Max(size, 1.0f);
+		if (m_size == size)
+			return;
+
+		m_size = size;
+		if (!m_tilesPath.empty() && !Tiles_Open(m_tilesPath))
+		{
+			Tiles_Close();
+		}
+		Collider_Refresh();
+	}
+
+	void Terrain::SetHeight(float height)
+	{
+		height = Max(height, 0.0f);
+		if (m_height == height)
+			return;
+
+		m_height = height;
+		if (!m_tilesPath.empty() && !Tiles_Open(m_tilesPath))
+		{
+			Tiles_Close();
+		}
+		Collider_Refresh();
+	}
+
+	void Terrain::Chunks_Select(const Vector3& cameraPositionLocal, vector<Terrain_Chunk>* chunks)
+	{
+		if (!chunks)
+			return;
+
+		lock_guard<mutex> lock(m_mutex);
+		if (m_levels == 0)
+			return;
+
+		m_selection++;
+		Chunks_Apply();
+		Chunks_Select(0, 0, 0, cameraPositionLocal, chunks);
+		Chunks_Evict();
+	}
+
+	bool Terrain::Tiles_Build(const string& heightMapPath, const string& tilesPath)
+	{
+		vector<float> heights;
+		unsigned int width	= 0;
+		unsigned int height	= 0;
+		if (!m_context->GetSubsystem<ResourceManager>()->GetImageImporter()->LoadHeights(heightMapPath, &heights, &width, &height) || width < 2 || height < 2)
+		{
+			LOGF_ERROR("Terrain::Tiles_Build: Failed to load the heights of \"%s\"", heightMapPath.c_str());
+			return false;
+		}
+
+		// As many levels as it takes for the finest one to have a vertex per sample
+		unsigned int side	= Max(width, height);
+		unsigned int levels	= 1;
+		while (levels < TERRAIN_LEVELS_MAX && (1u << (levels - 1)) * TERRAIN_CHUNK_QUADS + 1 < side)
+		{
+			levels++;
+		}
+		unsigned int collisionResolution = Min((1u << (levels - 1)) * TERRAIN_CHUNK_QUADS + 1, (unsigned int)TERRAIN_COLLISION_RESOLUTION);
+
+		auto file = make_unique<FileStream>(tilesPath, FileStreamMode_Write);
+		if (!file->IsOpen())
+		{
+			LOGF_ERROR("Terrain::Tiles_Build: Failed to create \"%s\"", tilesPath.c_str());
+			return false;
+		}
+
+		file->Write((unsigned int)TERRAIN_MAGIC);
+		file->Write((unsigned int)TERRAIN_VERSION);
+		file->Write(levels);
+		file->Write((unsigned int)TERRAIN_CHUNK_QUADS);
+		file->Write(collisionResolution);
+
+		// The collider's heights
+		vector<uint16_t> samples((size_t)collisionResolution * collisionResolution);
+		for (unsigned int y = 0; y < collisionResolution; y++)
+		{
+			for (unsigned int x = 0; x < collisionResolution; x++)
+			{
+				float u = x / float(collisionResolution - 1);
+				float v = y / float(collisionResolution - 1);
+				samples[(size_t)y * collisionResolution + x] = _Terrain::Quantize(_Terrain::Sample(heights, width, height, u, v));
+			}
+		}
+		file->WriteBytes(samples.data(), samples.size() * sizeof(uint16_t));
+
+		// Every chunk of every level, in the order Chunk_GetIndex() numbers them
+		samples.resize(_Terrain::tileSamples);
+		for (unsigned int level = 0; level < levels; level++)
+		{
+			unsigned int count	= 1u << level;
+			float quads			= float(count * TERRAIN_CHUNK_QUADS);
+			for (unsigned int cy = 0; cy < count; cy++)
+			{
+				for (unsigned int cx = 0; cx < count; cx++)
+				{
+					for (unsigned int j = 0; j < _Terrain::tileSide; j++)
+					{
+						for (unsigned int i = 0; i < _Terrain::tileSide; i++)
+						{
+							float u = (float(cx * TERRAIN_CHUNK_QUADS + i) - 1.0f) / quads;
+							float v = (float(cy * TERRAIN_CHUNK_QUADS + j) - 1.0f) / quads;
+							samples[j * _Terrain::tileSide + i] = _Terrain::Quantize(_Terrain::Sample(heights, width, height, u, v));
+						}
+					}
+					file->WriteBytes(samples.data(), _Terrain::tileBytes);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool Terrain::Tiles_Open(const string& tilesPath)
+	{
+		auto file = make_unique<FileStream>(tilesPath, FileStreamMode_Read);
+		if (!file->IsOpen())
+		{
+			LOGF_ERROR("Terrain::Tiles_Open: Failed to open \"%s\"", tilesPath.c_str());
+			return false;
+		}
+
+		unsigned int magic					= file->ReadUInt();
+		unsigned int version				= file->ReadUInt();
+		unsigned int levels					= file->ReadUInt();
+		unsigned int quads					= file->ReadUInt();
+		unsigned int collisionResolution	= file->ReadUInt();
+		if (magic != TERRAIN_MAGIC || version != TERRAIN_VERSION || quads != TERRAIN_CHUNK_QUADS || levels == 0 || levels > TERRAIN_LEVELS_MAX || collisionResolution < 2)
+		{
+			LOGF_ERROR("Terrain::Tiles_Open: \"%s\" isn't a terrain this version can read", tilesPath.c_str());
+			return false;
+		}
+
+		vector<uint16_t> samples((size_t)collisionResolution * collisionResolution);
+		file->ReadBytes(samples.data(), samples.size() * sizeof(uint16_t));
+		auto collisionHeights = make_shared<vector<float>>(samples.size());
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			(*collisionHeights)[i] = samples[i] / 65535.0f * m_height;
+		}
+
+		// The coarsest chunk is always there, it's what's drawn until anything sharper is
+		uint64_t tilesOffset = file->GetPosition();
+		vector<uint16_t> root(_Terrain::tileSamples);
+		file->ReadBytes(root.data(), _Terrain::tileBytes);
+
+		lock_guard<mutex> lock(m_mutex);
+		m_chunks.clear();
+		m_loading.clear();
+		m_loadsPending	= 0;
+		m_generation++;
+		m_tilesPath		= tilesPath;
+		m_tilesOffset	= tilesOffset;
+		m_levels		= levels;
+
+		if (!m_indexBuffer)
+		{
+			// A grid, then the skirts, both sides of them since they hang from every edge
+			const unsigned int side	= TERRAIN_CHUNK_QUADS + 1;
+			const unsigned int skirt	= side * side;
+			vector<unsigned int> indices;
+			indices.reserve(TERRAIN_CHUNK_QUADS * TERRAIN_CHUNK_QUADS * 6 + 4 * TERRAIN_CHUNK_QUADS * 12);
+			for (unsigned int j = 0; j < TERRAIN_CHUNK_QUADS; j++)
+			{
+				for (unsigned int i = 0; i < TERRAIN_CHUNK_QUADS; i++)
+				{
+					// The same diagonal as Bullet's heightfield, so what's drawn is what's collided with
+					unsigned int a = j * side + i;
+					unsigned int b = (j + 1) * side + i;
+					indices.insert(indices.end(), { a, b, b + 1, a, b + 1, a + 1 });
+				}
+			}
+
+			for (unsigned int edge = 0; edge < 4; edge++)
+			{
+				for (unsigned int k = 0; k < TERRAIN_CHUNK_QUADS; k++)
+				{
+					auto top = [side, edge](unsigned int k)
+					{
+						return edge == 0 ? k : edge == 1 ? (side - 1) * side + k : edge == 2 ? k * side : k * side + side - 1;
+					};
+					unsigned int a		= top(k);
+					unsigned int b		= top(k + 1);
+					unsigned int aLow	= skirt + edge * side + k;
+					unsigned int bLow	= aLow + 1;
+					indices.insert(indices.end(), { a, b, aLow, b, bLow, aLow, a, aLow, b, b, aLow, bLow });
+				}
+			}
+
+			m_indexBuffer = make_shared<RHI_IndexBuffer>(m_context->GetSubsystem<Renderer>()->GetRHIDevice());
+			if (!m_indexBuffer->Create(indices))
+			{
+				LOG_ERROR("Terrain::Tiles_Open: Failed to create index buffer");
+				m_indexBuffer = nullptr;
+				return false;
+			}
+			m_indexCount = (unsigned int)indices.size();
+		}
+
+		if (!Chunk_Create(0, root))
+			return false;
+
+		m_collisionHeights		= collisionHeights;
+		m_collisionResolution	= collisionResolution;
+		m_collisionKey			= hash<string>()(m_tilesPath);
+		CollisionShapeCache::HashCombine(m_collisionKey, hash<float>()(m_size));
+		CollisionShapeCache::HashCombine(m_collisionKey, hash<float>()(m_height));
+		CollisionShapeCache::HashCombine(m_collisionKey, hash<uint64_t>()(m_generation));
+
+		return true;
+	}
+
+	void Terrain::Tiles_Close()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_chunks.clear();
+		m_loading.clear();
+		m_loadsPending			= 0;
+		m_generation++;
+		m_tilesPath.clear();
+		m_levels				= 0;
+		m_collisionHeights		= nullptr;
+		m_collisionResolution	= 0;
+		m_collisionKey			= 0;
+	}
+
+	void Terrain::Chunk_Request(unsigned int index)
+	{
+		if (m_loadsPending >= TERRAIN_LOADS_MAX || m_loading.count(index))
+			return;
+
+		m_loading.insert(index);
+		m_loadsPending++;
+
+		auto load			= make_shared<Load>();
+		load->index			= index;
+		load->generation	= m_generation;
+		load->heights.resize(_Terrain::tileSamples);
+
+		auto loads = m_loads;
+		m_context->GetSubsystem<AsyncIO>()->Read(m_tilesPath, m_tilesOffset + index * _Terrain::tileBytes, _Terrain::tileBytes, load->heights.data(), IO_Priority_Streaming, [load, loads](bool read)
+		{
+			load->loaded = read;
+			lock_guard<mutex> lock(loads->mutex);
+			loads->done.emplace_back(load);
+		}, ThreadGroup_Background);
+	}
+
+	bool Terrain::Chunk_Create(unsigned int index, const vector<uint16_t>& heights)
+	{
+		// Which chunk it is
+		unsigned int level = 0;
+		while (Chunk_GetIndex(level + 1, 0, 0) <= index)
+		{
+			level++;
+		}
+		unsigned int first	= Chunk_GetIndex(level, 0, 0);
+		unsigned int x	= (index - first) % (1u << level);
+		unsigned int y	= (index - first) / (1u << level);
+
+		const unsigned int side	= TERRAIN_CHUNK_QUADS + 1;
+		float chunkSize			= m_size / float(1u << level);
+		float spacing			= chunkSize / TERRAIN_CHUNK_QUADS;
+		float skirt				= chunkSize * TERRAIN_SKIRT;
+		float originX			= -m_size * 0.5f + x * chunkSize;
+		float originZ			= -m_size * 0.5f + y * chunkSize;
+		auto sample = [this, &heights](int i, int j)
+		{
+			return heights[(j + 1) * _Terrain::tileSide + (i + 1)] / 65535.0f * m_height;
+		};
+
+		vector<RHI_Vertex_PosUVTBNPacked> vertices;
+		vertices.reserve(side * side + 4 * side);
+		float heightMin = FLT_MAX;
+		float heightMax = -FLT_MAX;
+		for (int j = 0; j < (int)side; j++)
+		{
+			for (int i = 0; i < (int)side; i++)
+			{
+				float h			= sample(i, j);
+				float left		= sample(i - 1, j);
+				float right		= sample(i + 1, j);
+				float down		= sample(i, j - 1);
+				float up		= sample(i, j + 1);
+				heightMin		= Min(heightMin, h);
+				heightMax		= Max(heightMax, h);
+
+				// The height map's top is at +z, textures are mapped the way it looks from above
+				Vector3 position(originX + i * spacing, h, originZ + j * spacing);
+				Vector2 uv(position.x / m_size + 0.5f, 0.5f - position.z / m_size);
+				Vector3 normal		= Vector3(left - right, 2.0f * spacing, down - up).Normalized();
+				Vector3 tangent		= Vector3(2.0f * spacing, right - left, 0.0f).Normalized();
+				Vector3 bitangent	= Vector3(0.0f, down - up, -2.0f * spacing).Normalized();
+				vertices.emplace_back(RHI_Vertex_PosUVTBN(position, uv, normal, tangent, bitangent));
+			}
+		}
+
+		// Skirts, the edges again but lower, they hide the cracks between chunks of different levels
+		for (unsigned int edge = 0; edge < 4; edge++)
+		{
+			for (unsigned int k = 0; k < side; k++)
+			{
+				unsigned int top				= edge == 0 ? k : edge == 1 ? (side - 1) * side + k : edge == 2 ? k * side : k * side + side - 1;
+				RHI_Vertex_PosUVTBNPacked low	= vertices[top];
+				low.pos[1]						-= skirt;
+				vertices.emplace_back(low);
+			}
+		}
+
+		auto vertexBuffer = make_shared<RHI_VertexBuffer>(m_context->GetSubsystem<Renderer>()->GetRHIDevice());
+		if (!vertexBuffer->Create(vertices))
+		{
+			LOG_ERROR("Terrain::Chunk_Create: Failed to create vertex buffer");
+			return false;
+		}
+
+		Chunk& chunk					= m_chunks[index];
+		chunk.drawable.vertexBuffer		= vertexBuffer;
+		chunk.drawable.box				= Chunk_GetBox(level, x, y, heightMin - skirt, heightMax);
+		chunk.drawable.level			= level;
+		chunk.selection					= m_selection;
+		return true;
+	}
+
+	void Terrain::Chunks_Apply()
+	{
+		vector<shared_ptr<Load>> done;
+		{
+			lock_guard<mutex> lock(m_loads->mutex);
+			done.swap(m_loads->done);
+		}
+
+		for (const auto& load : done)
+		{
+			// Read for a height map (or a size) that's gone since
+			if (load->generation != m_generation)
+				continue;
+
+			m_loadsPending--;
+			if (!load->loaded || !Chunk_Create(load->index, load->heights))
+			{
+				// Stays in m_loading, so it isn't asked for every frame from now on
+				LOGF_ERROR("Terrain::Chunks_Apply: Failed to load chunk %d of \"%s\"", load->index, m_tilesPath.c_str());
+				continue;
+			}
+			m_loading.erase(load->index);
+		}
+	}
+
+	void Terrain::Chunks_Evict()
+	{
+		if (m_chunks.size() <= TERRAIN_CHUNKS_RESIDENT)
+			return;
+
+		// The least recently drawn go, never the coarsest one nor any drawn now
+		vector<pair<uint64_t, unsigned int>> candidates;
+		for (const auto& chunk : m_chunks)
+		{
+			if (chunk.first != 0 && chunk.second.selection != m_selection)
+			{
+				candidates.emplace_back(chunk.second.selection, chunk.first);
+			}
+		}
+		sort(candidates.begin(), candidates.end());
+
+		for (const auto& candidate : candidates)
+		{
+			if (m_chunks.size() <= TERRAIN_CHUNKS_RESIDENT)
+				break;
+
+			m_chunks.erase(candidate.second);
+		}
+	}
+
+	void Terrain::Chunks_Select(unsigned int level, unsigned int x, unsigned int y, const Vector3& camera, vector<Terrain_Chunk>* chunks)
+	{
+		auto it = m_chunks.find(Chunk_GetIndex(level, x, y));
+		if (it == m_chunks.end())
+			return;
+
+		Chunk& chunk	= it->second;
+		chunk.selection	= m_selection;
+
+		// Split where the camera is near, once all four children are there to draw instead
+		bool split = false;
+		if (level + 1 < m_levels && _Terrain::Distance(chunk.drawable.box, camera) < m_size / float(1u << level) * m_lodDistance)
+		{
+			split = true;
+			for (unsigned int child = 0; child < 4; child++)
+			{
+				unsigned int index = Chunk_GetIndex(level + 1, x * 2 + (child & 1), y * 2 + (child >> 1));
+				if (!m_chunks.count(index))
+				{
+					Chunk_Request(index);
+					split = false;
+				}
+			}
+		}
+
+		if (!split)
+		{
+			chunks->emplace_back(chunk.drawable);
+			return;
+		}
+
+		for (unsigned int child = 0; child < 4; child++)
+		{
+			Chunks_Select(level + 1, x * 2 + (child & 1), y * 2 + (child >> 1), camera, chunks);
+		}
+	}
+
+	void Terrain::Collider_Refresh()
+	{
+		auto collider = GetActor_PtrRaw()->GetComponent<Collider>();
+		if (collider && collider->GetShapeType() == ColliderShape_Terrain)
+		{
+			collider->Shape_Update();
+		}
+	}
+
+	unsigned int Terrain::Chunk_GetIndex(unsigned int level, unsigned int x, unsigned int y)
+	{
+		// The levels before hold (4^level - 1) / 3 chunks
+		return ((1u << (2 * level)) - 1) / 3 + y * (1u << level) + x;
+	}
+
+	BoundingBox Terrain::Chunk_GetBox(unsigned int level, unsigned int x, unsigned int y, float heightMin, float heightMax)
+	{
+		float chunkSize	= m_size / float(1u << level);
+		float minX		= -m_size * 0.5f + x * chunkSize;
+		float minZ		= -m_size * 0.5f + y * chunkSize;
+		return BoundingBox(Vector3(minX, heightMin, minZ), Vector3(minX + chunkSize, heightMax, minZ + chunkSize));
+	}
+}
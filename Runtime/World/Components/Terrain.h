@@ -0,0 +1,161 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include "IComponent.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "../../Math/BoundingBox.h"
+#include "../../Math/Vector3.h"
+#include "../../RHI/RHI_Definition.h"
+//===================================
+
+#define TERRAIN_CHUNK_QUADS				64		// a chunk's grid along a side, at every level of detail
+#define TERRAIN_LEVELS_MAX				8		// the finest level has (1 << (levels - 1)) chunks along a side
+#define TERRAIN_CHUNKS_RESIDENT			256		// chunks kept in memory (heights and vertices), the least recently drawn ones go first
+#define TERRAIN_LOADS_MAX				16		// chunks being read at once
+#define TERRAIN_COLLISION_RESOLUTION	1025	// heights the collider gets along a side, at most
+
+namespace Directus
+{
+	// A chunk ready to draw, the vertices are in the terrain's local space
+	struct Terrain_Chunk
+	{
+		std::shared_ptr<RHI_VertexBuffer> vertexBuffer;
+		Math::BoundingBox box;
+		unsigned int level = 0;
+	};
+
+	// A heightfield drawn as a quadtree of chunks, the nearer a part is to the camera the smaller (and more detailed) the
+	// chunks there. Every chunk has the same grid, so what's drawn stays bounded however large the height map. Importing a
+	// height map writes the heights of every chunk of every level to a .terrain file (see DerivedDataCache), chunks are read
+	// from it as the camera comes near and dropped again once they haven't been drawn for a while. The material is the
+	// Renderable's, a Collider with ColliderShape_Terrain collides with the heights.
+	class ENGINE_CLASS Terrain : public IComponent
+	{
+	public:
+		Terrain(Context* context, Actor* actor, Transform* transform);
+		~Terrain();
+
+		//= COMPONENT ================================
+		void Serialize(FileStream* stream) override;
+		void Deserialize(FileStream* stream) override;
+		//============================================
+
+		// Any image, 16-bit greyscale ones keep their precision
+		const std::string& GetHeightMap()	{ return m_heightMapPath; }
+		void SetHeightMap(const std::string& filePath);
+
+		// Along x and z, the terrain is centered on the actor
+		float GetSize()						{ return m_size; }
+		void SetSize(float size);
+
+		// Of the height map's white
+		float GetHeight()					{ return m_height; }
+		void SetHeight(float height);
+
+		// Chunks split once the camera is nearer than their size times this, larger values draw more detail
+		float GetLodDistance()				{ return m_lodDistance; }
+		void SetLodDistance(float distance)	{ m_lodDistance = distance; }
+
+		//= RENDERING (thread safe) ==========================================================================
+		// The chunks to draw from a camera at a position in the terrain's local space. Chunks that would be sharper
+		// are requested, what's drawn meanwhile is the nearest coarser one that's in memory.
+		void Chunks_Select(const Math::Vector3& cameraPositionLocal, std::vector<Terrain_Chunk>* chunks);
+		// Every chunk's triangles, skirts included
+		const std::shared_ptr<RHI_IndexBuffer>& GetIndexBuffer()	{ return m_indexBuffer; }
+		unsigned int GetIndexCount()								{ return m_indexCount; }
+		//====================================================================================================
+
+		//= COLLISION ===========================================================================================
+		// Row major (along x, then z), in units of height, empty until a height map loaded. Shapes keep them alive.
+		const std::shared_ptr<const std::vector<float>>& GetCollisionHeights()	{ return m_collisionHeights; }
+		unsigned int GetCollisionResolution()									{ return m_collisionResolution; }
+		// Changes whenever the collision heights do
+		size_t GetCollisionKey()												{ return m_collisionKey; }
+		//=======================================================================================================
+
+	private:
+		struct Chunk
+		{
+			Terrain_Chunk drawable;
+			uint64_t selection = 0; // the last one it was drawn in
+		};
+
+		struct Load
+		{
+			unsigned int index		= 0;
+			uint64_t generation		= 0;
+			std::vector<uint16_t> heights;
+			bool loaded				= false;
+		};
+
+		// Loads outlive the terrain if it goes while they are being read
+		struct Loads
+		{
+			std::mutex mutex;
+			std::vector<std::shared_ptr<Load>> done;
+		};
+
+		bool Tiles_Build(const std::string& heightMapPath, const std::string& tilesPath);
+		// Starts over from the coarsest chunk, what's in memory was built with the previous size and height
+		bool Tiles_Open(const std::string& tilesPath);
+		void Tiles_Close();
+		void Chunk_Request(unsigned int index);
+		bool Chunk_Create(unsigned int index, const std::vector<uint16_t>& heights);
+		void Chunks_Apply();
+		void Chunks_Evict();
+		void Chunks_Select(unsigned int level, unsigned int x, unsigned int y, const Math::Vector3& camera, std::vector<Terrain_Chunk>* chunks);
+		void Collider_Refresh();
+
+		// Chunks are numbered level by level, row by row
+		static unsigned int Chunk_GetIndex(unsigned int level, unsigned int x, unsigned int y);
+		Math::BoundingBox Chunk_GetBox(unsigned int level, unsigned int x, unsigned int y, float heightMin, float heightMax);
+
+		std::string m_heightMapPath;
+		std::string m_tilesPath;
+		float m_size			= 256.0f;
+		float m_height			= 32.0f;
+		float m_lodDistance		= 2.0f;
+		unsigned int m_levels	= 0; // zero until a height map loaded
+
+		std::mutex m_mutex;
+		std::unordered_map<unsigned int, Chunk> m_chunks;
+		std::unordered_set<unsigned int> m_loading; // being read, or failed to and not retried
+		unsigned int m_loadsPending = 0;
+		std::shared_ptr<Loads> m_loads;
+		uint64_t m_generation	= 0; // loads of an earlier height map are dropped
+		uint64_t m_selection	= 0;
+		uint64_t m_tilesOffset	= 0; // where the chunks start in the file
+
+		std::shared_ptr<RHI_IndexBuffer> m_indexBuffer;
+		unsigned int m_indexCount = 0;
+
+		std::shared_ptr<const std::vector<float>> m_collisionHeights;
+		unsigned int m_collisionResolution	= 0;
+		size_t m_collisionKey				= 0;
+	};
+}
@@ -36,6 +36,9 @@ using namespace Directus::Math;
 
 namespace Directus
 {
+	atomic<unsigned int> Transform::m_hierarchyVersion(0);
+	atomic<unsigned int> Transform::m_tick(0);
+
 	Transform::Transform(Context* context, Actor* actor, Transform* transform) : IComponent(context, actor, transform)
 	{
 		m_positionLocal		= Vector3::Zero;
@@ -44,10 +47,11 @@ namespace Directus
 		m_worldTransform	= Matrix::Identity;
 		m_localTransform	= Matrix::Identity;
 		m_parent			= nullptr;
+		m_tickCreated		= m_tick;
 
-		REGISTER_ATTRIBUTE_VALUE_VALUE(m_positionLocal,	Vector3);
-		REGISTER_ATTRIBUTE_VALUE_VALUE(m_rotationLocal,	Quaternion);
-		REGISTER_ATTRIBUTE_VALUE_VALUE(m_scaleLocal, Vector3);
+		REGISTER_ATTRIBUTE_VALUE_SET(m_positionLocal, SetPositionLocal, Vector3);
+		REGISTER_ATTRIBUTE_VALUE_SET(m_rotationLocal, SetRotationLocal, Quaternion);
+		REGISTER_ATTRIBUTE_VALUE_SET(m_scaleLocal, SetScaleLocal, Vector3);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_worldTransform, Matrix);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_localTransform, Matrix);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_lookAt, Vector3);
@@ -61,9 +65,15 @@ namespace Directus
 	//= ICOMPONENT ==================================================================================
 	void Transform::OnInitialize()
 	{
+		m_hierarchyVersion++;
 		UpdateTransform();
 	}
 
+	void Transform::OnRemove()
+	{
+		m_hierarchyVersion++;
+	}
+
 	void Transform::Serialize(FileStream* stream)
 	{
 		stream->Write(m_positionLocal);
@@ -95,26 +105,85 @@ namespace Directus
 	//===============================================================================================
 	void Transform::UpdateTransform()
 	{
-		// Compute local transform
-		m_localTransform = Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
+		MarkDirty();
+		Resolve();
+	}
 
-		// Compute world transform
-		if (!HasParent())
+	void Transform::MarkDirty()
+	{
+		if (m_isDirty)
+			return;
+
+		m_isDirty = true;
+		for (const auto& child : m_children)
 		{
-			m_worldTransform = m_localTransform;
+			child->MarkDirty();
 		}
-		else
+	}
+
+	void Transform::AttachTo(Transform* parent)
+	{
+		m_parent = parent;
+		parent->m_children.emplace_back(this);
+		m_hierarchyVersion++;
+		MarkDirty();
+	}
+
+	void Transform::Resolve()
+	{
+		// A static actor that moves while the game runs gets demoted, this catches moves inherited from a parent too
+		Actor* actor			= GetActor_PtrRaw();
+		bool checkStatic		= m_revision != 0 && actor && actor->IsStatic() && Engine::EngineMode_IsSet(Engine_Game);
+		Matrix worldPrevious	= checkStatic ? m_worldTransform : Matrix::Identity;
+
+		// The first resolve in a tick keeps the state from before it, for rendering to interpolate from
+		unsigned int tick = m_tick;
+		if (m_tickResolved != tick)
 		{
-			m_worldTransform = m_localTransform * GetParentTransformMatrix();
+			m_worldPrevious	= m_worldTransform;
+			m_tickResolved	= tick;
 		}
-		
-		// Update children
-		for (const auto& child : m_children)
+
+		// Compute local transform
+		m_localTransform = Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
+
+		// Compute world transform, the parent's own is resolved first if it's dirty too
+		m_worldTransform	= HasParent() ? m_localTransform * GetParentTransformMatrix() : m_localTransform;
+		m_isDirty			= false;
+		m_revision++;
+
+		if (checkStatic && m_worldTransform != worldPrevious)
 		{
-			child->UpdateTransform();
+			LOGF_WARNING("Transform::Resolve: \"%s\" is static but moved, it's dynamic from now on", actor->GetName().c_str());
+			actor->SetStatic(false);
 		}
 	}
 
+	void Transform::Interpolate(float alpha)
+	{
+		// Only what moved in the last tick (and existed before it) has two states to blend
+		m_interpolated = alpha < 1.0f && m_tickResolved == m_tick && m_tickCreated != m_tick;
+		if (!m_interpolated)
+			return;
+
+		Vector3 positionA, positionB, scaleA, scaleB;
+		Quaternion rotationA, rotationB;
+		m_worldPrevious.Decompose(scaleA, rotationA, positionA);
+		GetWorldTransform().Decompose(scaleB, rotationB, positionB);
+
+		// Normalized lerp along the shorter arc, close enough to a slerp for the angle a tick covers
+		float sign = (rotationA.x * rotationB.x + rotationA.y * rotationB.y + rotationA.z * rotationB.z + rotationA.w * rotationB.w) < 0.0f ? -1.0f : 1.0f;
+		Quaternion rotation = Quaternion
+		(
+			Lerp(rotationA.x, rotationB.x * sign, alpha),
+			Lerp(rotationA.y, rotationB.y * sign, alpha),
+			Lerp(rotationA.z, rotationB.z * sign, alpha),
+			Lerp(rotationA.w, rotationB.w * sign, alpha)
+		).Normalized();
+
+		m_worldInterpolated = Matrix(Lerp(positionA, positionB, alpha), rotation, Lerp(scaleA, scaleB, alpha));
+	}
+
 	//= TRANSLATION ==================================================================================
 	void Transform::SetPosition(const Vector3& position)
 	{
@@ -130,7 +199,34 @@ namespace Directus
 			return;
 
 		m_positionLocal = position;
-		UpdateTransform();
+		MarkDirty();
+	}
+
+	WorldPosition Transform::GetPositionAbsolute()
+	{
+		return GetContext()->GetSubsystem<World>()->Origin_Get() + WorldPosition(GetPosition());
+	}
+
+	void Transform::SetPositionAbsolute(const WorldPosition& position)
+	{
+		SetPosition((position - GetContext()->GetSubsystem<World>()->Origin_Get()).ToVector3());
+	}
+
+	void Transform::Origin_Shift(const Vector3& offset)
+	{
+		// Roots move, descendants keep their local position and move along with them
+		if (!HasParent())
+		{
+			m_positionLocal		-= offset;
+			m_localTransform	= Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
+		}
+
+		// The blended and previous states too, a tick or frame that spans the shift doesn't see a jump
+		Matrix shift			= Matrix::CreateTranslation(Vector3::Zero - offset);
+		m_worldTransform		= HasParent() ? m_worldTransform * shift : m_localTransform;
+		m_worldPrevious			= m_worldPrevious * shift;
+		m_worldInterpolated		= m_worldInterpolated * shift;
+		m_revision++;
 	}
 	//================================================================================================
 
@@ -149,7 +245,27 @@ namespace Directus
 			return;
 
 		m_rotationLocal = rotation;
-		UpdateTransform();
+		MarkDirty();
+	}
+	//================================================================================================
+
+	//= POSE =========================================================================================
+	void Transform::SetPose(const Vector3& position, const Quaternion& rotation)
+	{
+		Vector3 positionLocal		= position;
+		Quaternion rotationLocal	= rotation;
+		if (HasParent())
+		{
+			positionLocal = position * GetParent()->GetWorldTransform().Inverted();
+			rotationLocal = rotation * GetParent()->GetRotation().Inverse();
+		}
+
+		if (m_positionLocal == positionLocal && m_rotationLocal == rotationLocal)
+			return;
+
+		m_positionLocal = positionLocal;
+		m_rotationLocal = rotationLocal;
+		MarkDirty();
 	}
 	//================================================================================================
 
@@ -175,7 +291,7 @@ namespace Directus
 		m_scaleLocal.y = (m_scaleLocal.y == 0.0f) ? M_EPSILON : m_scaleLocal.y;
 		m_scaleLocal.z = (m_scaleLocal.z == 0.0f) ? M_EPSILON : m_scaleLocal.z;
 
-		UpdateTransform();
+		MarkDirty();
 	}
 	//================================================================================================
 
@@ -278,7 +394,8 @@ namespace Directus
 			m_parent->AcquireChildren();
 		}
 
-		UpdateTransform();
+		m_hierarchyVersion++;
+		MarkDirty();
 	}
 
 	void Transform::AddChild(Transform* child)
@@ -398,7 +515,8 @@ namespace Directus
 		m_parent = nullptr;
 
 		// Update the transform without the parent now
-		UpdateTransform();
+		m_hierarchyVersion++;
+		MarkDirty();
 
 		// make the parent search for children,
 		// that's indirect way of making tha parent "forget"
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include "IComponent.h"
 #include <vector>
+#include <atomic>
 #include "../../Math/Vector3.h"
 #include "../../Math/Quaternion.h"
 #include "../../Math/Matrix.h"
@@ -40,28 +41,39 @@ namespace Directus
 
 		//= ICOMPONENT ===============================
 		void OnInitialize() override;
+		void OnRemove() override;
 		void Serialize(FileStream* stream) override;
 		void Deserialize(FileStream* stream) override;
 		//============================================
 
+		// Recomputes the matrices right away, setters only mark them (and the descendants') as dirty,
+		// they are recomputed when read or by the World once per frame (see World::Transforms_Update)
 		void UpdateTransform();
 
 		//= POSITION ============================================================
-		Math::Vector3 GetPosition() { return m_worldTransform.GetTranslation(); }
+		Math::Vector3 GetPosition() { return GetWorldTransform().GetTranslation(); }
 		const Math::Vector3& GetPositionLocal() { return m_positionLocal; }
 		void SetPosition(const Math::Vector3& position);
 		void SetPositionLocal(const Math::Vector3& position);
+		// In the whole world, in double precision, rather than relative to the World's origin (see World::Origin_Get)
+		WorldPosition GetPositionAbsolute();
+		void SetPositionAbsolute(const WorldPosition& position);
 		//=======================================================================
 
 		//= ROTATION ============================================================
-		Math::Quaternion GetRotation() { return m_worldTransform.GetRotation(); }
+		Math::Quaternion GetRotation() { return GetWorldTransform().GetRotation(); }
 		const Math::Quaternion& GetRotationLocal() { return m_rotationLocal; }
 		void SetRotation(const Math::Quaternion& rotation);
 		void SetRotationLocal(const Math::Quaternion& rotation);
 		//=======================================================================
 
+		//= POSE ==============================================================================
+		// World position and rotation in one write, the transform is marked dirty once and isn't read back
+		void SetPose(const Math::Vector3& position, const Math::Quaternion& rotation);
+		//=====================================================================================
+
 		//= SCALE ======================================================
-		Math::Vector3 GetScale() { return m_worldTransform.GetScale(); }
+		Math::Vector3 GetScale() { return GetWorldTransform().GetScale(); }
 		const Math::Vector3& GetScaleLocal() { return m_scaleLocal; }
 		void SetScale(const Math::Vector3& scale);
 		void SetScaleLocal(const Math::Vector3& scale);
@@ -97,10 +109,35 @@ namespace Directus
 		//=============================================================================
 
 		void LookAt(const Math::Vector3& v) { m_lookAt = v; }
-		Math::Matrix& GetWorldTransform()	{ return m_worldTransform; }
-		Math::Matrix& GetLocalTransform()	 { return m_localTransform; }
+		Math::Matrix& GetWorldTransform()	{ if (m_isDirty) Resolve(); return m_worldTransform; }
+		Math::Matrix& GetLocalTransform()	{ if (m_isDirty) Resolve(); return m_localTransform; }
+
+		// What rendering uses, between the last two simulated states when the simulation ticks in fixed steps (see Engine_FixedStep)
+		const Math::Matrix& GetWorldTransformRendered() { return m_interpolated ? m_worldInterpolated : GetWorldTransform(); }
+		// Starts a simulation tick, the first time a transform resolves in it it keeps the state it had before
+		static void Tick_Begin() { m_tick++; }
+
+		// Changes whenever the world transform gets recomputed
+		unsigned int GetRevision() const { return m_revision; }
+		// Changes whenever a transform is added, removed or re-parented, the World re-sorts it's transforms by depth then
+		static unsigned int GetHierarchyVersion() { return m_hierarchyVersion; }
 
 	private:
+		friend class World;
+		friend class Prefab;
+		friend class WorldSnapshot;
+
+		// Marks this transform and it's descendants as dirty, a dirty transform's descendants are always dirty already
+		void MarkDirty();
+		// Recomputes the matrices, resolving any dirty ancestors first
+		void Resolve();
+		// Links a new transform (no parent or children yet) to a parent, without re-acquiring anyone's children
+		void AttachTo(Transform* parent);
+		// Blends the state before the last tick with the current one, alpha is how far past the last tick the frame is (in ticks)
+		void Interpolate(float alpha);
+		// Moves it opposite to the World's origin, without resolving again, so it doesn't count as moving (see World::Origin_Shift)
+		void Origin_Shift(const Math::Vector3& offset);
+
 		// local
 		Math::Vector3 m_positionLocal;
 		Math::Quaternion m_rotationLocal;
@@ -112,6 +149,17 @@ namespace Directus
 
 		Transform* m_parent; // the parent of this transform
 		std::vector<Transform*> m_children; // the children of this transform
+		bool m_isDirty = true;
+		unsigned int m_revision = 0;
+		static std::atomic<unsigned int> m_hierarchyVersion;
+
+		// Interpolation
+		Math::Matrix m_worldPrevious;		// as of before the tick it last resolved in
+		Math::Matrix m_worldInterpolated;
+		unsigned int m_tickResolved	= 0;
+		unsigned int m_tickCreated	= 0;
+		bool m_interpolated			= false;
+		static std::atomic<unsigned int> m_tick;
 
 		//= HELPER FUNCTIONS ================================================================
 		Math::Matrix GetParentTransformMatrix();
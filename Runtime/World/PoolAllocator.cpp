@@ -0,0 +1,70 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "PoolAllocator.h"
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	namespace _PoolRegistry
+	{
+		mutex& Mutex()
+		{
+			static mutex registryMutex;
+			return registryMutex;
+		}
+
+		// Pools register during static initialization too, so the list is constructed on first use
+		vector<PoolStatistics (*)()>& Pools()
+		{
+			static vector<PoolStatistics (*)()> pools;
+			return pools;
+		}
+	}
+
+	void PoolRegistry::Register(PoolStatistics (*getStatistics)())
+	{
+		lock_guard<mutex> lock(_PoolRegistry::Mutex());
+		_PoolRegistry::Pools().emplace_back(getStatistics);
+	}
+
+	vector<PoolStatistics> PoolRegistry::GetStatistics()
+	{
+		vector<PoolStatistics (*)()> pools;
+		{
+			lock_guard<mutex> lock(_PoolRegistry::Mutex());
+			pools = _PoolRegistry::Pools();
+		}
+
+		vector<PoolStatistics> statistics;
+		for (auto getStatistics : pools)
+		{
+			statistics.emplace_back(getStatistics());
+		}
+
+		return statistics;
+	}
+}
@@ -0,0 +1,154 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===============
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <cstddef>
+#include "../Core/EngineDefs.h"
+//==========================
+
+// Blocks every new chunk of a pool holds
+#define POOL_ALLOCATOR_CHUNK 256
+
+namespace Directus
+{
+	// What a pool holds, for the profiler
+	struct PoolStatistics
+	{
+		size_t blockSize				= 0;
+		unsigned int blocksUsed			= 0;
+		unsigned int blocksAllocated	= 0;
+	};
+
+	class ENGINE_CLASS PoolRegistry
+	{
+	public:
+		// Every pool registers itself the first time it's used
+		static void Register(PoolStatistics (*getStatistics)());
+		// One entry per pool, i.e. per block size and alignment in use
+		static std::vector<PoolStatistics> GetStatistics();
+	};
+
+	// Fixed size blocks, handed out from chunks of POOL_ALLOCATOR_CHUNK and recycled through a free list. Chunks live as
+	// long as the process does, the peak number of blocks of a size is what stays allocated. Actors and components
+	// of every type get their own pool (unless another type has the same size), so they are mostly contiguous in memory.
+	template <size_t Size, size_t Alignment>
+	class PoolMemory
+	{
+	public:
+		static void* Allocate()
+		{
+			auto& memory = Get();
+			std::lock_guard<std::mutex> lock(memory.m_mutex);
+
+			if (!memory.m_free)
+			{
+				auto chunk = (char*)::operator new(m_blockSize * POOL_ALLOCATOR_CHUNK);
+				memory.m_chunks.emplace_back(chunk);
+				for (unsigned int i = 0; i < POOL_ALLOCATOR_CHUNK; i++)
+				{
+					Free_Push(memory, chunk + (POOL_ALLOCATOR_CHUNK - 1 - i) * m_blockSize);
+				}
+			}
+
+			auto block		= memory.m_free;
+			memory.m_free	= *(void**)block;
+			memory.m_used++;
+			return block;
+		}
+
+		static void Free(void* block)
+		{
+			auto& memory = Get();
+			std::lock_guard<std::mutex> lock(memory.m_mutex);
+			Free_Push(memory, block);
+			memory.m_used--;
+		}
+
+	private:
+		static PoolMemory& Get()
+		{
+			static PoolMemory memory;
+			return memory;
+		}
+
+		PoolMemory() { PoolRegistry::Register(&GetStatistics); }
+
+		static PoolStatistics GetStatistics()
+		{
+			auto& memory = Get();
+			std::lock_guard<std::mutex> lock(memory.m_mutex);
+
+			PoolStatistics statistics;
+			statistics.blockSize		= m_blockSize;
+			statistics.blocksUsed		= memory.m_used;
+			statistics.blocksAllocated	= (unsigned int)memory.m_chunks.size() * POOL_ALLOCATOR_CHUNK;
+			return statistics;
+		}
+
+		static void Free_Push(PoolMemory& memory, void* block)
+		{
+			*(void**)block	= memory.m_free;
+			memory.m_free	= block;
+		}
+
+		// A free block holds the next free one, blocks are a multiple of the alignment so every one of them is aligned
+		static const size_t m_blockSize = ((Size > sizeof(void*) ? Size : sizeof(void*)) + Alignment - 1) / Alignment * Alignment;
+		std::vector<char*> m_chunks;
+		void* m_free		= nullptr;
+		unsigned int m_used	= 0;
+		std::mutex m_mutex;
+	};
+
+	// Used with std::allocate_shared, so an object and it's reference count share a block of it's type's pool
+	template <typename T>
+	class PoolAllocator
+	{
+	public:
+		typedef T value_type;
+
+		PoolAllocator() = default;
+		template <typename U> PoolAllocator(const PoolAllocator<U>&) {}
+
+		T* allocate(size_t count)
+		{
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types aren't supported");
+			return count == 1 ? (T*)PoolMemory<sizeof(T), alignof(T)>::Allocate() : (T*)::operator new(count * sizeof(T));
+		}
+
+		void deallocate(T* pointer, size_t count)
+		{
+			if (count == 1)
+			{
+				PoolMemory<sizeof(T), alignof(T)>::Free(pointer);
+				return;
+			}
+			::operator delete(pointer);
+		}
+
+		template <typename U> bool operator==(const PoolAllocator<U>&) const { return true; }
+		template <typename U> bool operator!=(const PoolAllocator<U>&) const { return false; }
+	};
+}
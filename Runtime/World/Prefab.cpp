@@ -0,0 +1,143 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "Prefab.h"
+#include "Actor.h"
+#include "World.h"
+#include "Components/Transform.h"
+//===============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Directus
+{
+	Prefab::Prefab(Context* context) : IResource(context, Resource_Prefab)
+	{
+
+	}
+
+	void Prefab::Create(Actor* root)
+	{
+		m_nodes.clear();
+		if (!root)
+		{
+			LOG_ERROR("Prefab::Create: Invalid actor");
+			return;
+		}
+
+		// Depth first, so a parent is always spawned before it's children
+		function<void(Actor*, int)> Capture = [this, &Capture](Actor* actor, int parent)
+		{
+			int index = (int)m_nodes.size();
+			m_nodes.emplace_back();
+			auto& node		= m_nodes.back();
+			node.name		= actor->GetName();
+			node.parent		= parent;
+			node.active		= actor->IsActive();
+			node.visible	= actor->IsVisibleInHierarchy();
+			node.isStatic	= actor->IsStatic();
+
+			for (const auto& component : actor->GetAllComponents())
+			{
+				ComponentTemplate componentTemplate;
+				componentTemplate.type = component->GetType();
+				for (const auto& attribute : component->GetAttributes())
+				{
+					componentTemplate.attributes.emplace_back(attribute.getter());
+				}
+				node.components.emplace_back(move(componentTemplate));
+			}
+
+			for (const auto& child : actor->GetTransform_PtrRaw()->GetChildren())
+			{
+				Capture(child->GetActor_PtrRaw(), index);
+			}
+		};
+		Capture(root, -1);
+	}
+
+	vector<Actor*> Prefab::Instantiate(unsigned int count /*= 1*/)
+	{
+		vector<Actor*> roots;
+		if (m_nodes.empty() || count == 0)
+			return roots;
+
+		// Grow the World once, instead of every few actors
+		auto world = m_context->GetSubsystem<World>();
+		world->Actors_Reserve(count * (unsigned int)m_nodes.size());
+		roots.reserve(count);
+
+		vector<Actor*> spawned(m_nodes.size());
+		for (unsigned int instance = 0; instance < count; instance++)
+		{
+			for (unsigned int i = 0; i < (unsigned int)m_nodes.size(); i++)
+			{
+				const auto& node	= m_nodes[i];
+				Actor* actor		= world->Actor_Create().get();
+				actor->SetName(node.name);
+				actor->SetActive(node.active);
+				actor->SetHierarchyVisibility(node.visible);
+				actor->SetStatic(node.isStatic);
+
+				// The transform comes with the actor, AddComponent() hands it back
+				for (const auto& componentTemplate : node.components)
+				{
+					if (auto component = actor->AddComponent(componentTemplate.type))
+					{
+						component->SetAttributeValues(componentTemplate.attributes);
+					}
+				}
+
+				// The parent is always this instance's own, and new, so it's linked directly instead of re-scanning the World
+				auto transform = actor->GetTransform_PtrRaw();
+				if (node.parent != -1)
+				{
+					transform->AttachTo(spawned[node.parent]->GetTransform_PtrRaw());
+				}
+				transform->MarkDirty();
+
+				spawned[i] = actor;
+			}
+
+			roots.emplace_back(spawned[0]);
+		}
+
+		return roots;
+	}
+
+	unsigned int Prefab::GetMemoryUsage()
+	{
+		unsigned int size = sizeof(Prefab);
+		for (const auto& node : m_nodes)
+		{
+			size += (unsigned int)(sizeof(Node) + node.name.capacity());
+			for (const auto& component : node.components)
+			{
+				size += (unsigned int)(sizeof(ComponentTemplate) + component.attributes.capacity() * sizeof(any));
+			}
+		}
+
+		return size;
+	}
+}
@@ -0,0 +1,71 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========================
+#include <vector>
+#include <string>
+#include <any>
+#include "Components/IComponent.h"
+#include "../Resource/IResource.h"
+//====================================
+
+namespace Directus
+{
+	class Actor;
+
+	// A template actor hierarchy, captured once and spawned many times. Spawning writes the captured component values
+	// straight into the new components, so instances share whatever resources those reference (models, materials).
+	class ENGINE_CLASS Prefab : public IResource
+	{
+	public:
+		Prefab(Context* context);
+		~Prefab() {}
+
+		// Captures an actor and it's descendants as the template, the actor itself is left untouched
+		void Create(Actor* root);
+
+		// Spawns instances of the template into the World, returns the root of every instance
+		std::vector<Actor*> Instantiate(unsigned int count = 1);
+
+		unsigned int GetNodeCount()		{ return (unsigned int)m_nodes.size(); }
+		unsigned int GetMemoryUsage() override;
+
+	private:
+		struct ComponentTemplate
+		{
+			ComponentType type;
+			std::vector<std::any> attributes;
+		};
+
+		struct Node
+		{
+			std::string name;
+			int parent		= -1;
+			bool active		= true;
+			bool visible	= true;
+			bool isStatic	= false;
+			std::vector<ComponentTemplate> components;
+		};
+		std::vector<Node> m_nodes; // depth first, a parent always comes before it's children
+	};
+}
@@ -0,0 +1,714 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ============
+#include "SpatialTree.h"
+#include "../Math/Ray.h"
+#include "../Math/SIMD.h"
+#include "../Threading/Threading.h"
+//==================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+using namespace Helper;
+//=============================
+
+#define SPATIAL_TREE_MARGIN 0.1f // how much a leaf's box gets fattened by, relative to it's size
+#define SPATIAL_TREE_CULL_PARALLEL 4096 // fewer leaves than that aren't worth culling on other threads
+#define SPATIAL_TREE_CULL_GRAIN 16 // words of the visibility bits (64 leaves each) per chunk
+#define SPATIAL_TREE_VIEWS_MAX 32 // frusta a single query can cull, a bit each
+#define SPATIAL_TREE_RAY_EPSILON 1e-20f // direction components smaller than that are nudged, so the slabs never divide by zero
+
+namespace Directus
+{
+	namespace _SpatialTree
+	{
+		// Four rays, component by component, with their inverse directions
+		struct RayPacket
+		{
+			SIMD::Float4 originX, originY, originZ;
+			SIMD::Float4 inverseX, inverseY, inverseZ;
+			SIMD::Float4 distanceMax;
+
+			// Returns the lanes (out of the given ones) that hit the box, and every lane's entry distance
+			int Hit(const BoundingBox& box, int lanes, float* distances) const
+			{
+				using namespace SIMD;
+
+				const Vector3& min = box.GetMin();
+				const Vector3& max = box.GetMax();
+				Float4 x0 = Mul(Sub(Splat(min.x), originX), inverseX), x1 = Mul(Sub(Splat(max.x), originX), inverseX);
+				Float4 y0 = Mul(Sub(Splat(min.y), originY), inverseY), y1 = Mul(Sub(Splat(max.y), originY), inverseY);
+				Float4 z0 = Mul(Sub(Splat(min.z), originZ), inverseZ), z1 = Mul(Sub(Splat(max.z), originZ), inverseZ);
+
+				Float4 entry	= Max(Max(Min(x0, x1), Min(y0, y1)), Max(Min(z0, z1), Splat(0.0f)));
+				Float4 exit		= Min(Min(Max(x0, x1), Max(y0, y1)), Min(Max(z0, z1), distanceMax));
+				Store(distances, entry);
+
+				return ~Mask(Less(exit, entry)) & lanes;
+			}
+		};
+
+		float Inverse(float value)
+		{
+			if (Abs(value) < SPATIAL_TREE_RAY_EPSILON)
+			{
+				value = value < 0.0f ? -SPATIAL_TREE_RAY_EPSILON : SPATIAL_TREE_RAY_EPSILON;
+			}
+			return 1.0f / value;
+		}
+
+		BoundingBox Merged(const BoundingBox& a, const BoundingBox& b)
+		{
+			BoundingBox box = a;
+			box.Merge(b);
+			return box;
+		}
+
+		float Area(const BoundingBox& box)
+		{
+			Vector3 size = box.GetSize();
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		BoundingBox Fattened(const BoundingBox& box)
+		{
+			Vector3 margin = box.GetSize() * SPATIAL_TREE_MARGIN;
+			return BoundingBox(box.GetMin() - margin, box.GetMax() + margin);
+		}
+
+		bool Overlaps(const BoundingBox& box, const Vector3& center, float radius)
+		{
+			// Distance from the center to the closest point of the box
+			Vector3 closest = Vector3
+			(
+				Clamp(center.x, box.GetMin().x, box.GetMax().x),
+				Clamp(center.y, box.GetMin().y, box.GetMax().y),
+				Clamp(center.z, box.GetMin().z, box.GetMax().z)
+			);
+			return (closest - center).LengthSquared() <= radius * radius;
+		}
+	}
+
+	int SpatialTree::Insert(Actor* actor, const BoundingBox& box, bool isStatic)
+	{
+		int leaf				= Node_Allocate();
+		m_nodes[leaf].actor		= actor;
+		m_nodes[leaf].boxLeaf	= box;
+		m_nodes[leaf].box		= isStatic ? box : _SpatialTree::Fattened(box);
+		m_nodes[leaf].isStatic	= isStatic;
+		Leaf_Insert(leaf);
+
+		return leaf;
+	}
+
+	void SpatialTree::Update(int proxy, const BoundingBox& box, bool isStatic)
+	{
+		if (proxy < 0 || proxy >= (int)m_nodes.size() || !m_nodes[proxy].IsLeaf())
+			return;
+
+		// Still inside the fattened box, the tree stays as it is
+		m_nodes[proxy].boxLeaf = box;
+		if (m_nodes[proxy].isStatic == isStatic && m_nodes[proxy].box.IsInside(box) == Inside)
+			return;
+
+		Leaf_Remove(proxy);
+		m_nodes[proxy].box		= isStatic ? box : _SpatialTree::Fattened(box);
+		m_nodes[proxy].isStatic	= isStatic;
+		Leaf_Insert(proxy);
+	}
+
+	void SpatialTree::Remove(int proxy)
+	{
+		if (proxy < 0 || proxy >= (int)m_nodes.size() || !m_nodes[proxy].IsLeaf() || m_nodes[proxy].height == -1)
+			return;
+
+		Leaf_Remove(proxy);
+		Node_Free(proxy);
+	}
+
+	void SpatialTree::Clear()
+	{
+		m_nodes.clear();
+		m_nodesFree.clear();
+		m_root = -1;
+	}
+
+	//= QUERIES ==========================================================================================
+	void SpatialTree::Query(Frustum& frustum, vector<Actor*>& actors, Threading* threading)
+	{
+		if (m_root == -1)
+			return;
+
+		m_leafBoxes.Clear();
+		m_leafActors.clear();
+		m_stack.clear();
+		m_stack.emplace_back(m_root);
+		while (!m_stack.empty())
+		{
+			int index = m_stack.back();
+			m_stack.pop_back();
+
+			const auto& node = m_nodes[index];
+			if (node.IsLeaf())
+			{
+				m_leafBoxes.Add(node.boxLeaf.GetCenter(), node.boxLeaf.GetExtents());
+				m_leafActors.emplace_back(node.actor);
+				continue;
+			}
+
+			// A node completely inside the frustum has all of it's leaves inside too
+			auto intersection = frustum.CheckCube(node.box.GetCenter(), node.box.GetExtents());
+			if (intersection == Inside)
+			{
+				Collect(index, actors);
+			}
+			else if (intersection == Intersects)
+			{
+				m_stack.emplace_back(node.left);
+				m_stack.emplace_back(node.right);
+			}
+		}
+
+		size_t count = m_leafActors.size();
+		m_leafVisible.resize((count + 63) / 64);
+		if (threading && count >= SPATIAL_TREE_CULL_PARALLEL)
+		{
+			threading->Parallel_For(0, (unsigned int)m_leafVisible.size(), SPATIAL_TREE_CULL_GRAIN, [this, &frustum, count](unsigned int start, unsigned int end)
+			{
+				frustum.CheckCubes(m_leafBoxes, start * 64, Min((size_t)end * 64, count), m_leafVisible.data());
+			});
+		}
+		else
+		{
+			frustum.CheckCubes(m_leafBoxes, 0, count, m_leafVisible.data());
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if ((m_leafVisible[i / 64] >> (i % 64)) & 1)
+			{
+				actors.emplace_back(m_leafActors[i]);
+			}
+		}
+	}
+
+	void SpatialTree::Query(Frustum* frusta, unsigned int count, vector<Actor*>* actors, Threading* threading)
+	{
+		if (m_root == -1 || count == 0)
+			return;
+
+		// More views than there are bits get queried in another walk
+		if (count > SPATIAL_TREE_VIEWS_MAX)
+		{
+			Query(frusta + SPATIAL_TREE_VIEWS_MAX, count - SPATIAL_TREE_VIEWS_MAX, actors + SPATIAL_TREE_VIEWS_MAX, threading);
+			count = SPATIAL_TREE_VIEWS_MAX;
+		}
+
+		m_leafBoxes.Clear();
+		m_leafActors.clear();
+		m_leafViews.clear();
+		m_stackPacket.clear();
+		m_stackPacket.emplace_back(m_root, (int)(count == 32 ? ~0u : (1u << count) - 1));
+		while (!m_stackPacket.empty())
+		{
+			auto entry = m_stackPacket.back();
+			m_stackPacket.pop_back();
+
+			const auto& node	= m_nodes[entry.first];
+			auto views			= (uint32_t)entry.second;
+			if (node.IsLeaf())
+			{
+				m_leafBoxes.Add(node.boxLeaf.GetCenter(), node.boxLeaf.GetExtents());
+				m_leafActors.emplace_back(node.actor);
+				m_leafViews.emplace_back(views);
+				continue;
+			}
+
+			// Views that have the node completely inside get all of it's leaves, the ones it intersects go on
+			uint32_t intersecting = 0;
+			for (unsigned int view = 0; view < count; view++)
+			{
+				if (!((views >> view) & 1))
+					continue;
+
+				auto intersection = frusta[view].CheckCube(node.box.GetCenter(), node.box.GetExtents());
+				if (intersection == Inside)
+				{
+					Collect(entry.first, actors[view]);
+				}
+				else if (intersection == Intersects)
+				{
+					intersecting |= 1u << view;
+				}
+			}
+
+			if (intersecting != 0)
+			{
+				m_stackPacket.emplace_back(node.left, (int)intersecting);
+				m_stackPacket.emplace_back(node.right, (int)intersecting);
+			}
+		}
+
+		// Every view culls the gathered leaves, only the ones it reached count
+		size_t leaves = m_leafActors.size();
+		m_leafVisible.resize((leaves + 63) / 64);
+		for (unsigned int view = 0; view < count; view++)
+		{
+			auto& frustum = frusta[view];
+			if (threading && leaves >= SPATIAL_TREE_CULL_PARALLEL)
+			{
+				threading->Parallel_For(0, (unsigned int)m_leafVisible.size(), SPATIAL_TREE_CULL_GRAIN, [this, &frustum, leaves](unsigned int start, unsigned int end)
+				{
+					frustum.CheckCubes(m_leafBoxes, start * 64, Min((size_t)end * 64, leaves), m_leafVisible.data());
+				});
+			}
+			else
+			{
+				frustum.CheckCubes(m_leafBoxes, 0, leaves, m_leafVisible.data());
+			}
+
+			for (size_t i = 0; i < leaves; i++)
+			{
+				if (((m_leafVisible[i / 64] >> (i % 64)) & 1) && ((m_leafViews[i] >> view) & 1))
+				{
+					actors[view].emplace_back(m_leafActors[i]);
+				}
+			}
+		}
+	}
+
+	void SpatialTree::Query(const BoundingBox& box, vector<Actor*>& actors)
+	{
+		if (m_root == -1)
+			return;
+
+		m_stack.clear();
+		m_stack.emplace_back(m_root);
+		while (!m_stack.empty())
+		{
+			int index = m_stack.back();
+			m_stack.pop_back();
+
+			const auto& node = m_nodes[index];
+			if (node.IsLeaf())
+			{
+				if (box.IsInside(node.boxLeaf) != Outside)
+				{
+					actors.emplace_back(node.actor);
+				}
+				continue;
+			}
+
+			auto intersection = box.IsInside(node.box);
+			if (intersection == Inside)
+			{
+				Collect(index, actors);
+			}
+			else if (intersection == Intersects)
+			{
+				m_stack.emplace_back(node.left);
+				m_stack.emplace_back(node.right);
+			}
+		}
+	}
+
+	void SpatialTree::Query(const Vector3& center, float radius, vector<Actor*>& actors)
+	{
+		if (m_root == -1)
+			return;
+
+		m_stack.clear();
+		m_stack.emplace_back(m_root);
+		while (!m_stack.empty())
+		{
+			int index = m_stack.back();
+			m_stack.pop_back();
+
+			const auto& node = m_nodes[index];
+			if (!_SpatialTree::Overlaps(node.IsLeaf() ? node.boxLeaf : node.box, center, radius))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				actors.emplace_back(node.actor);
+				continue;
+			}
+
+			m_stack.emplace_back(node.left);
+			m_stack.emplace_back(node.right);
+		}
+	}
+
+	void SpatialTree::Query(Ray& ray, vector<pair<float, Actor*>>& hits)
+	{
+		if (m_root == -1)
+			return;
+
+		m_stack.clear();
+		m_stack.emplace_back(m_root);
+		while (!m_stack.empty())
+		{
+			int index = m_stack.back();
+			m_stack.pop_back();
+
+			const auto& node	= m_nodes[index];
+			float distance		= ray.HitDistance(node.IsLeaf() ? node.boxLeaf : node.box);
+			if (distance == INFINITY)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				hits.emplace_back(distance, node.actor);
+				continue;
+			}
+
+			m_stack.emplace_back(node.left);
+			m_stack.emplace_back(node.right);
+		}
+	}
+
+	void SpatialTree::Query(const Ray* rays, size_t count, vector<RayHit>& hits, bool closestOnly, const function<bool(Actor*)>& filter)
+	{
+		using namespace SIMD;
+
+		if (m_root == -1)
+			return;
+
+		for (size_t first = 0; first < count; first += 4)
+		{
+			// A packet that runs past the end repeats the last ray, it's lanes are masked out
+			float originX[4], originY[4], originZ[4], inverseX[4], inverseY[4], inverseZ[4], distanceMax[4];
+			Actor* closest[4]		= { nullptr, nullptr, nullptr, nullptr };
+			float closestDistance[4];
+			int lanes = 0;
+			for (int lane = 0; lane < 4; lane++)
+			{
+				const auto& ray			= rays[Helper::Min(first + lane, count - 1)];
+				const auto& origin		= ray.GetOrigin();
+				const auto& direction	= ray.GetDirection();
+				originX[lane]			= origin.x;
+				originY[lane]			= origin.y;
+				originZ[lane]			= origin.z;
+				inverseX[lane]			= _SpatialTree::Inverse(direction.x);
+				inverseY[lane]			= _SpatialTree::Inverse(direction.y);
+				inverseZ[lane]			= _SpatialTree::Inverse(direction.z);
+				distanceMax[lane]		= (ray.GetEnd() - origin).Length();
+				closestDistance[lane]	= distanceMax[lane];
+				lanes |= first + lane < count ? 1 << lane : 0;
+			}
+
+			_SpatialTree::RayPacket packet;
+			packet.originX		= Load(originX);
+			packet.originY		= Load(originY);
+			packet.originZ		= Load(originZ);
+			packet.inverseX		= Load(inverseX);
+			packet.inverseY		= Load(inverseY);
+			packet.inverseZ		= Load(inverseZ);
+			packet.distanceMax	= Load(distanceMax);
+
+			m_stackPacket.clear();
+			m_stackPacket.emplace_back(m_root, lanes);
+			while (!m_stackPacket.empty())
+			{
+				auto entry = m_stackPacket.back();
+				m_stackPacket.pop_back();
+
+				const auto& node = m_nodes[entry.first];
+				float distances[4];
+				int hit = packet.Hit(node.IsLeaf() ? node.boxLeaf : node.box, entry.second, distances);
+				if (!hit)
+					continue;
+
+				if (!node.IsLeaf())
+				{
+					m_stackPacket.emplace_back(node.left, hit);
+					m_stackPacket.emplace_back(node.right, hit);
+					continue;
+				}
+
+				if (filter && !filter(node.actor))
+					continue;
+
+				for (int lane = 0; lane < 4; lane++)
+				{
+					if (!(hit & (1 << lane)))
+						continue;
+
+					if (!closestOnly)
+					{
+						hits.emplace_back(RayHit{ (unsigned int)(first + lane), distances[lane], node.actor });
+					}
+					else if (distances[lane] < closestDistance[lane] || !closest[lane])
+					{
+						closest[lane]			= node.actor;
+						closestDistance[lane]	= distances[lane];
+					}
+				}
+
+				// Whatever is behind the closest hits can't be closer
+				if (closestOnly)
+				{
+					packet.distanceMax = Load(closestDistance);
+				}
+			}
+
+			for (int lane = 0; lane < 4 && closestOnly; lane++)
+			{
+				if (closest[lane])
+				{
+					hits.emplace_back(RayHit{ (unsigned int)(first + lane), closestDistance[lane], closest[lane] });
+				}
+			}
+		}
+	}
+	//====================================================================================================
+
+	int SpatialTree::Node_Allocate()
+	{
+		if (m_nodesFree.empty())
+		{
+			m_nodes.emplace_back();
+			return (int)m_nodes.size() - 1;
+		}
+
+		int index = m_nodesFree.back();
+		m_nodesFree.pop_back();
+		m_nodes[index] = Node();
+
+		return index;
+	}
+
+	void SpatialTree::Node_Free(int index)
+	{
+		m_nodes[index].actor	= nullptr;
+		m_nodes[index].height	= -1;
+		m_nodesFree.emplace_back(index);
+	}
+
+	void SpatialTree::Leaf_Insert(int leaf)
+	{
+		m_nodes[leaf].parent = -1;
+		if (m_root == -1)
+		{
+			m_root = leaf;
+			return;
+		}
+
+		// Find the sibling which grows the tree's surface area the least (the cost of testing against it)
+		BoundingBox box	= m_nodes[leaf].box;
+		int index		= m_root;
+		while (!m_nodes[index].IsLeaf())
+		{
+			const auto& node	= m_nodes[index];
+			float area			= _SpatialTree::Area(node.box);
+			float areaMerged	= _SpatialTree::Area(_SpatialTree::Merged(node.box, box));
+
+			// Pairing with this node adds a parent, descending further grows this node's box anyway
+			float cost			= 2.0f * areaMerged;
+			float costInherited	= 2.0f * (areaMerged - area);
+			auto costChild		= [this, &box, costInherited](int child)
+			{
+				const auto& node	= m_nodes[child];
+				float areaMerged	= _SpatialTree::Area(_SpatialTree::Merged(node.box, box));
+				return (node.IsLeaf() ? areaMerged : areaMerged - _SpatialTree::Area(node.box)) + costInherited;
+			};
+			float costLeft	= costChild(node.left);
+			float costRight	= costChild(node.right);
+
+			if (cost < costLeft && cost < costRight)
+				break;
+
+			index = costLeft < costRight ? node.left : node.right;
+		}
+
+		// Pair the leaf with it's sibling under a new parent
+		int sibling		= index;
+		int parentOld	= m_nodes[sibling].parent;
+		int parent		= Node_Allocate();
+		m_nodes[parent].parent	= parentOld;
+		m_nodes[parent].box		= _SpatialTree::Merged(box, m_nodes[sibling].box);
+		m_nodes[parent].height	= m_nodes[sibling].height + 1;
+		m_nodes[parent].left	= sibling;
+		m_nodes[parent].right	= leaf;
+		m_nodes[sibling].parent	= parent;
+		m_nodes[leaf].parent	= parent;
+
+		if (parentOld == -1)
+		{
+			m_root = parent;
+		}
+		else
+		{
+			if (m_nodes[parentOld].left == sibling)	m_nodes[parentOld].left		= parent;
+			else									m_nodes[parentOld].right	= parent;
+		}
+
+		Refit(m_nodes[leaf].parent);
+	}
+
+	void SpatialTree::Leaf_Remove(int leaf)
+	{
+		if (leaf == m_root)
+		{
+			m_root = -1;
+			return;
+		}
+
+		// The sibling takes the parent's place
+		int parent		= m_nodes[leaf].parent;
+		int grandParent	= m_nodes[parent].parent;
+		int sibling		= m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+		if (grandParent == -1)
+		{
+			m_root					= sibling;
+			m_nodes[sibling].parent	= -1;
+			Node_Free(parent);
+			return;
+		}
+
+		if (m_nodes[grandParent].left == parent)	m_nodes[grandParent].left	= sibling;
+		else										m_nodes[grandParent].right	= sibling;
+		m_nodes[sibling].parent = grandParent;
+		Node_Free(parent);
+
+		Refit(grandParent);
+	}
+
+	void SpatialTree::Refit(int index)
+	{
+		while (index != -1)
+		{
+			index		= Balance(index);
+			auto& node	= m_nodes[index];
+			node.height	= 1 + Max(m_nodes[node.left].height, m_nodes[node.right].height);
+			node.box	= _SpatialTree::Merged(m_nodes[node.left].box, m_nodes[node.right].box);
+			index		= node.parent;
+		}
+	}
+
+	int SpatialTree::Balance(int indexA)
+	{
+		auto& a = m_nodes[indexA];
+		if (a.IsLeaf() || a.height < 2)
+			return indexA;
+
+		int indexB	= a.left;
+		int indexC	= a.right;
+		auto& b		= m_nodes[indexB];
+		auto& c		= m_nodes[indexC];
+		int balance	= c.height - b.height;
+
+		// Puts the rotated up node where a was
+		auto replace = [this, &a, indexA](int index)
+		{
+			if (a.parent == -1)
+			{
+				m_root = index;
+			}
+			else
+			{
+				auto& parent = m_nodes[a.parent];
+				if (parent.left == indexA)	parent.left		= index;
+				else						parent.right	= index;
+			}
+		};
+
+		// Rotate c up
+		if (balance > 1)
+		{
+			int indexF	= c.left;
+			int indexG	= c.right;
+			auto& f		= m_nodes[indexF];
+			auto& g		= m_nodes[indexG];
+
+			c.left		= indexA;
+			c.parent	= a.parent;
+			replace(indexC);
+			a.parent	= indexC;
+
+			// c keeps the taller of it's children, a takes the other one
+			int indexKept	= f.height > g.height ? indexF : indexG;
+			int indexGiven	= f.height > g.height ? indexG : indexF;
+			c.right							= indexKept;
+			a.right							= indexGiven;
+			m_nodes[indexGiven].parent		= indexA;
+			a.box							= _SpatialTree::Merged(b.box, m_nodes[indexGiven].box);
+			a.height						= 1 + Max(b.height, m_nodes[indexGiven].height);
+			c.box							= _SpatialTree::Merged(a.box, m_nodes[indexKept].box);
+			c.height						= 1 + Max(a.height, m_nodes[indexKept].height);
+
+			return indexC;
+		}
+
+		// Rotate b up
+		if (balance < -1)
+		{
+			int indexD	= b.left;
+			int indexE	= b.right;
+			auto& d		= m_nodes[indexD];
+			auto& e		= m_nodes[indexE];
+
+			b.left		= indexA;
+			b.parent	= a.parent;
+			replace(indexB);
+			a.parent	= indexB;
+
+			int indexKept	= d.height > e.height ? indexD : indexE;
+			int indexGiven	= d.height > e.height ? indexE : indexD;
+			b.right							= indexKept;
+			a.left							= indexGiven;
+			m_nodes[indexGiven].parent		= indexA;
+			a.box							= _SpatialTree::Merged(c.box, m_nodes[indexGiven].box);
+			a.height						= 1 + Max(c.height, m_nodes[indexGiven].height);
+			b.box							= _SpatialTree::Merged(a.box, m_nodes[indexKept].box);
+			b.height						= 1 + Max(a.height, m_nodes[indexKept].height);
+
+			return indexB;
+		}
+
+		return indexA;
+	}
+
+	void SpatialTree::Collect(int index, vector<Actor*>& actors)
+	{
+		// Shares the caller's stack, what's pushed here gets popped before returning
+		size_t bottom = m_stack.size();
+		m_stack.emplace_back(index);
+		while (m_stack.size() > bottom)
+		{
+			int current = m_stack.back();
+			m_stack.pop_back();
+
+			const auto& node = m_nodes[current];
+			if (node.IsLeaf())
+			{
+				actors.emplace_back(node.actor);
+				continue;
+			}
+
+			m_stack.emplace_back(node.left);
+			m_stack.emplace_back(node.right);
+		}
+	}
+}
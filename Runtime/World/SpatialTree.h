@@ -0,0 +1,116 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <functional>
+#include "../Math/BoundingBox.h"
+#include "../Math/Frustum.h"
+//=============================
+
+namespace Directus
+{
+	class Actor;
+	class Threading;
+	namespace Math
+	{
+		class Ray;
+	}
+
+	// A dynamic AABB tree. Leaves get a fattened box, so an actor that moves a little doesn't
+	// need re-inserting, while queries still test the actual box of every leaf they reach.
+	// Static leaves aren't expected to move, so they keep their actual box and the tree stays tighter.
+	class SpatialTree
+	{
+	public:
+		SpatialTree() {}
+		~SpatialTree() {}
+
+		// Returns a proxy to update/remove the actor by
+		int Insert(Actor* actor, const Math::BoundingBox& box, bool isStatic = false);
+		void Update(int proxy, const Math::BoundingBox& box, bool isStatic = false);
+		void Remove(int proxy);
+		void Clear();
+
+		//= QUERIES ========================================================================
+		// Every query appends to the provided vector. The leaves a frustum query reaches get culled
+		// together at the end, spread over the threading subsystem's workers when it's provided.
+		void Query(Math::Frustum& frustum, std::vector<Actor*>& actors, Threading* threading = nullptr);
+		// Several frusta (views) in one walk, every node is only tested against the views that still partially see it.
+		// What each view finds gets appended to it's own vector, actors[i] for frusta[i].
+		void Query(Math::Frustum* frusta, unsigned int count, std::vector<Actor*>* actors, Threading* threading = nullptr);
+		void Query(const Math::BoundingBox& box, std::vector<Actor*>& actors);
+		void Query(const Math::Vector3& center, float radius, std::vector<Actor*>& actors);
+		// Hits are <distance, actor>, in no particular order
+		void Query(Math::Ray& ray, std::vector<std::pair<float, Actor*>>& hits);
+
+		struct RayHit
+		{
+			unsigned int ray;	// index into the queried rays
+			float distance;		// 0 when the ray starts inside the box
+			Actor* actor;
+		};
+		// Traces rays four at a time, every node's box gets slab tested against the whole packet. Unlike the single ray
+		// query these are segments, from the origin to the end. Either every hit gets appended (in no particular
+		// order) or only the closest one of each ray, which lets the traversal skip anything further. The filter
+		// can reject leaves, the tree holds lights too (boxed by their range).
+		void Query(const Math::Ray* rays, size_t count, std::vector<RayHit>& hits, bool closestOnly = false, const std::function<bool(Actor*)>& filter = nullptr);
+		//==================================================================================
+
+	private:
+		struct Node
+		{
+			Math::BoundingBox box;		// fattened for leaves, what encloses the children for the rest
+			Math::BoundingBox boxLeaf;	// the actual box of a leaf
+			Actor* actor	= nullptr;
+			int parent		= -1;
+			int left		= -1;
+			int right		= -1;
+			int height		= 0;		// a leaf is 0, -1 marks a free node
+			bool isStatic	= false;	// a leaf that isn't fattened
+			bool IsLeaf() const { return left == -1; }
+		};
+
+		int Node_Allocate();
+		void Node_Free(int index);
+		void Leaf_Insert(int leaf);
+		void Leaf_Remove(int leaf);
+		// Walks from a node to the root, re-balancing and re-fitting the boxes on the way
+		void Refit(int index);
+		// Rotates the taller child up when the children's heights differ by more than one, returns the node now in its place
+		int Balance(int index);
+		// Appends every leaf under a node, no tests
+		void Collect(int index, std::vector<Actor*>& actors);
+
+		std::vector<Node> m_nodes;
+		std::vector<int> m_nodesFree;
+		std::vector<int> m_stack; // traversal scratch
+		std::vector<std::pair<int, int>> m_stackPacket; // <node, the lanes that reached it>
+		// Frustum query scratch, the leaves to cull and a bit per leaf that passed
+		Math::BoundingBoxSoA m_leafBoxes;
+		std::vector<Actor*> m_leafActors;
+		std::vector<uint32_t> m_leafViews; // the views that reached each leaf, for the multi-frustum query
+		std::vector<uint64_t> m_leafVisible;
+		int m_root = -1;
+	};
+}
@@ -21,6 +21,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ===========================
 #include "World.h"
+#include <future>
+#include <algorithm>
+#include <unordered_set>
+#include <string_view>
 #include "Actor.h"
 #include "Components/Transform.h"
 #include "Components/Camera.h"
@@ -29,13 +33,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Components/Skybox.h"
 #include "Components/AudioListener.h"
 #include "Components/Renderable.h"
+#include "Components/RigidBody.h"
 #include "../Core/Engine.h"
 #include "../Core/Stopwatch.h"
+#include "../Core/Settings.h"
 #include "../Resource/ResourceManager.h"
 #include "../Resource/ProgressReport.h"
 #include "../IO/FileStream.h"
 #include "../Profiling/Profiler.h"
+#include "../Profiling/MemoryTracker.h"
 #include "../Rendering/Renderer.h"
+#include "WorldCells.h"
+#include "WorldSnapshot.h"
+#include "ActorQuery.h"
 //======================================
 
 //= NAMESPACES ================
@@ -43,20 +53,91 @@ using namespace std;
 using namespace Directus::Math;
 //=============================
 
+#define TRANSFORMS_PER_TASK 1024 // fewer transforms than that in a level aren't worth handing to another thread
+#define COMPONENTS_PER_TASK 256  // fewer components than that in a parallel system aren't worth handing to another thread
+#define CHANGES_RESUBMIT 256     // more actors than that changing in a frame resubmit the world, instead of notifying one by one
+#define LOAD_BUDGET_MS 4.0f      // how long an asynchronous load can spend creating actors in a frame
+#define CHUNK_RESOURCES 0x43525352 // "RSRC"
+#define CHUNK_ACTORS 0x53544341    // "ACTS"
+
 namespace Directus
 {
 	namespace _World
 	{
 		shared_ptr<Actor> emptyActor;
+
+		// What a component type's OnTick() reads and writes, a bit per ComponentType. Two systems can tick together
+		// when neither writes what the other touches, a parallel system's components can also tick at the same time
+		// as each other. Physics, audio and scripting talk to backends which aren't thread safe, so they stay serial.
+		struct ComponentSystem
+		{
+			ComponentType type;
+			unsigned int reads;
+			unsigned int writes;
+			bool parallel;
+		};
+
+		#define SYSTEM_BIT(type) (1U << (type))
+		#define SYSTEM_ALL ~0U
+		static const ComponentSystem systems[] =
+		{
+			// Listener and sources both go through FMOD
+			{ ComponentType_AudioListener,	SYSTEM_BIT(ComponentType_Transform),												SYSTEM_BIT(ComponentType_AudioListener) | SYSTEM_BIT(ComponentType_AudioSource),	false },
+			{ ComponentType_AudioSource,	SYSTEM_BIT(ComponentType_Transform),												SYSTEM_BIT(ComponentType_AudioSource),												false },
+			{ ComponentType_Camera,			SYSTEM_BIT(ComponentType_Transform),												SYSTEM_BIT(ComponentType_Camera),													true },
+			{ ComponentType_Collider,		0,																					0,																					true },
+			// Constraints and bodies both go through the Bullet world
+			{ ComponentType_Constraint,		SYSTEM_BIT(ComponentType_Transform),												SYSTEM_BIT(ComponentType_Constraint) | SYSTEM_BIT(ComponentType_RigidBody),		false },
+			// Directional lights follow the camera
+			{ ComponentType_Light,			SYSTEM_BIT(ComponentType_Transform) | SYSTEM_BIT(ComponentType_Camera),			SYSTEM_BIT(ComponentType_Light),													true },
+			{ ComponentType_Renderable,		0,																					0,																					true },
+			{ ComponentType_RigidBody,		SYSTEM_BIT(ComponentType_Transform),												SYSTEM_BIT(ComponentType_RigidBody),												false },
+			// A script can touch anything, it ticks alone
+			{ ComponentType_Script,			SYSTEM_ALL,																			SYSTEM_ALL,																			false },
+			{ ComponentType_Skybox,			0,																					0,																					true },
+			// Particles are simulated by the renderer
+			{ ComponentType_ParticleEmitter,	0,																				0,																					true },
+			// Chunks are streamed in as the renderer selects them
+			{ ComponentType_Terrain,		0,																					0,																					true },
+			// Baked on demand, read by the renderer
+			{ ComponentType_LightProbeVolume,	0,																				0,																					true },
+			// Captured by the renderer
+			{ ComponentType_ReflectionProbe,	0,																				0,																					true }
+		};
+		static const unsigned int systemCount = sizeof(systems) / sizeof(systems[0]);
+
+		// Groups the systems into stages that run one after the other. A system lands right after the last earlier one
+		// it conflicts with, so conflicting systems keep their order while unrelated ones share a stage.
+		vector<vector<const ComponentSystem*>> BuildStages()
+		{
+			vector<vector<const ComponentSystem*>> stages;
+			unsigned int stageOf[systemCount] = {};
+			for (unsigned int i = 0; i < systemCount; i++)
+			{
+				unsigned int stage = 0;
+				for (unsigned int j = 0; j < i; j++)
+				{
+					bool conflict = (systems[j].writes & (systems[i].reads | systems[i].writes)) || (systems[i].writes & systems[j].reads);
+					if (conflict) stage = Max(stage, stageOf[j] + 1);
+				}
+
+				stageOf[i] = stage;
+				if (stage >= (unsigned int)stages.size()) stages.resize(stage + 1);
+				stages[stage].emplace_back(&systems[i]);
+			}
+			return stages;
+		}
 	}
 
 	World::World(Context* context) : Subsystem(context)
 	{
 		m_state = Ticking;
-		SUBSCRIBE_TO_EVENT(EVENT_WORLD_RESOLVE, [this](Variant) { m_isDirty = true; });
+		m_cells	= make_unique<WorldCells>(context);
+		m_spatialRenderables = make_unique<Query<Renderable>>(ActorQuery::Mask<Skybox>());
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_RESOLVE, [this](const auto&) { m_isDirty = true; });
 		SUBSCRIBE_TO_EVENT(EVENT_TICK, EVENT_HANDLER(Tick));
-		SUBSCRIBE_TO_EVENT(EVENT_WORLD_STOP, [this](Variant)	{ m_state = Idle; });
-		SUBSCRIBE_TO_EVENT(EVENT_WORLD_START, [this](Variant)	{ m_state = Ticking; });
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_STOP, [this](const auto&)	{ m_state = Idle; });
+		SUBSCRIBE_TO_EVENT(EVENT_WORLD_START, [this](const auto&)	{ m_state = Ticking; });
 	}
 
 	World::~World()
@@ -85,7 +166,13 @@ namespace Directus
 		if (m_state != Ticking)
 			return;
 
-		TIME_BLOCK_START_CPU();
+		TIME_BLOCK_SCOPED_CPU();
+		MEMORY_TAG(MemoryTag_World);
+
+		m_threadID = this_thread::get_id();
+
+		// ASYNC LOADING
+		Load_Tick();
 		
 		// Detect game toggling
 		bool started		= Engine::EngineMode_IsSet(Engine_Game) && m_wasInEditorMode;
@@ -94,7 +181,8 @@ namespace Directus
 
 		// ACTOR START
 		if (started)
-		{			
+		{
+			PlayMode_Capture();
 			for (const auto& actor : m_actors)
 			{
 				actor->Start();
@@ -107,14 +195,35 @@ namespace Directus
 			{
 				actor->Stop();
 			}
+			PlayMode_Restore();
 		}
-		// ACTOR TICK
-		for (const auto& actor : m_actors)
+		// ORIGIN
+		// Follows the active camera, the last one (same as the Renderer), while the game runs so the editor shows what gets saved
+		const auto& cameras = ComponentPool::Get(ComponentType_Camera);
+		if (m_originRebaseDistance > 0.0f && Engine::EngineMode_IsSet(Engine_Game) && !cameras.empty())
+		{
+			Vector3 camera = cameras.back()->GetTransform()->GetPosition();
+			if (camera.LengthSquared() > m_originRebaseDistance * m_originRebaseDistance)
+			{
+				Origin_Shift(camera);
+			}
+		}
+
+		// CELL STREAMING
+		// Around the active camera, cells are laid out in the whole world
+		if (m_cells->IsOpen() && !cameras.empty())
 		{
-			actor->Tick();
+			m_cells->Tick(cameras.back()->GetTransform()->GetPositionAbsolute().ToVector3());
 		}
 
-		TIME_BLOCK_END_CPU();
+		// COMPONENT TICK
+		Systems_Tick();
+
+		// SYNC POINT
+		Structure_Apply();
+
+		// SPATIAL TREE
+		Spatial_Update();
 
 		if (m_isDirty)
 		{
@@ -124,16 +233,408 @@ namespace Directus
 		}
 	}
 
+	void World::Systems_Tick()
+	{
+		static const auto stages = _World::BuildStages();
+
+		// Everything reading a transform expects it resolved, that way their getters don't write to it while ticking
+		Transforms_Update();
+
+		// A component added/removed while ticking its type gets its first tick next frame, the one swapped into a removed
+		// one's place gets skipped this frame. Only serial systems can add or remove components.
+		// An actor that was removed but is still referenced keeps it's components pooled, without a handle (see
+		// Actor_Slot_Release) they are left alone. Only this thread releases handles, so the check needs no lock.
+		auto tick = [](ComponentType type, unsigned int start, unsigned int end)
+		{
+			const auto& components = ComponentPool::Get(type);
+			for (unsigned int i = start; i < end && i < (unsigned int)components.size(); i++)
+			{
+				auto component	= components[i];
+				auto actor		= component->GetActor_PtrRaw();
+				if (actor->GetHandle().IsValid() && actor->IsActive())
+				{
+					component->OnTick();
+				}
+			}
+		};
+
+		struct Job
+		{
+			ComponentType type;
+			unsigned int start;
+			unsigned int end;
+		};
+
+		auto threading = m_context->GetSubsystem<Threading>();
+		vector<Job> jobs;
+		for (const auto& stage : stages)
+		{
+			// A serial system is a single job, a parallel one gets split into chunks
+			jobs.clear();
+			bool writesTransforms	= false;
+			bool scripts			= false;
+			for (auto system : stage)
+			{
+				unsigned int count = (unsigned int)ComponentPool::Get(system->type).size();
+				writesTransforms |= (system->writes & SYSTEM_BIT(ComponentType_Transform)) != 0;
+				if (count == 0)
+					continue;
+
+				scripts |= system->type == ComponentType_Script;
+
+				unsigned int chunks = system->parallel ? Min(threading->GetThreadCount() + 1, (count + COMPONENTS_PER_TASK - 1) / COMPONENTS_PER_TASK) : 1;
+				chunks = Max(chunks, 1U);
+				unsigned int chunkSize = (count + chunks - 1) / chunks;
+				for (unsigned int i = 0; i < chunks; i++)
+				{
+					jobs.push_back({ system->type, i * chunkSize, Min((i + 1) * chunkSize, count) });
+				}
+			}
+
+			// Hand all but the first job to the worker threads, this thread runs the first one
+			vector<JobHandle> ticked;
+			for (unsigned int i = 1; i < (unsigned int)jobs.size(); i++)
+			{
+				Job job = jobs[i];
+				ticked.emplace_back(threading->Job_Add([&tick, job]() { tick(job.type, job.start, job.end); }));
+			}
+			if (!jobs.empty())
+			{
+				tick(jobs[0].type, jobs[0].start, jobs[0].end);
+			}
+			threading->Job_Wait(threading->Job_Group(ticked));
+
+			// Scripts only queued their updates while ticking, they run now, batched by script type
+			if (scripts)
+			{
+				if (auto scripting = m_context->GetSubsystem<Scripting>())
+				{
+					scripting->Update_Dispatch();
+				}
+			}
+
+			if (writesTransforms)
+			{
+				Transforms_Update();
+			}
+		}
+	}
+
+	void World::Transforms_Interpolate(float alpha)
+	{
+		// Nothing blends, and nothing is left blended from before either
+		if (alpha >= 1.0f && !m_transformsInterpolated)
+			return;
+
+		TIME_BLOCK_SCOPED_CPU();
+
+		// Every transform only blends it's own states
+		m_transformsInterpolated	= alpha < 1.0f;
+		m_transformsRevision++;
+		const auto& transforms		= ComponentPool::Get(ComponentType_Transform);
+		m_context->GetSubsystem<Threading>()->Parallel_For(0, (unsigned int)transforms.size(), TRANSFORMS_PER_TASK, [&transforms, alpha](unsigned int start, unsigned int end)
+		{
+			for (unsigned int i = start; i < end; i++)
+			{
+				static_cast<Transform*>(transforms[i])->Interpolate(alpha);
+			}
+		});
+	}
+
+	void World::Origin_Shift(const Vector3& offset)
+	{
+		TIME_BLOCK_SCOPED_CPU();
+
+		m_origin = m_origin + WorldPosition(offset);
+		m_transformsRevision++;
+
+		for (auto component : ComponentPool::Get(ComponentType_Transform))
+		{
+			static_cast<Transform*>(component)->Origin_Shift(offset);
+		}
+
+		for (auto component : ComponentPool::Get(ComponentType_RigidBody))
+		{
+			static_cast<RigidBody*>(component)->Origin_Shift(offset);
+		}
+	}
+
+	void World::Origin_Place(Actor* root)
+	{
+		if (m_origin.x == 0.0 && m_origin.y == 0.0 && m_origin.z == 0.0)
+			return;
+
+		vector<Transform*> transforms = { root->GetTransform_PtrRaw() };
+		transforms.front()->GetDescendants(&transforms);
+
+		Vector3 offset = m_origin.ToVector3();
+		for (auto transform : transforms)
+		{
+			transform->Origin_Shift(offset);
+			if (auto rigidBody = transform->GetActor_PtrRaw()->GetComponent_PtrRaw<RigidBody>())
+			{
+				rigidBody->Origin_Shift(offset);
+			}
+		}
+	}
+
+	void World::Transforms_Update()
+	{
+		TIME_BLOCK_SCOPED_CPU();
+
+		// Re-sort only when the hierarchy changed, a parent is always in an earlier level than it's children
+		if (m_transformsVersion != Transform::GetHierarchyVersion())
+		{
+			m_transformsVersion = Transform::GetHierarchyVersion();
+
+			vector<vector<Transform*>> levels;
+			for (auto component : ComponentPool::Get(ComponentType_Transform))
+			{
+				auto transform		= static_cast<Transform*>(component);
+				unsigned int depth	= 0;
+				for (auto parent = transform->GetParent(); parent; parent = parent->GetParent()) { depth++; }
+
+				if (depth >= (unsigned int)levels.size()) levels.resize(depth + 1);
+				levels[depth].emplace_back(transform);
+			}
+
+			m_transforms.clear();
+			m_transformLevels.clear();
+			for (const auto& level : levels)
+			{
+				m_transformLevels.emplace_back((unsigned int)m_transforms.size());
+				m_transforms.insert(m_transforms.end(), level.begin(), level.end());
+			}
+			m_transformLevels.emplace_back((unsigned int)m_transforms.size());
+		}
+
+		// By the time a level resolves the one before it is clean, so a dirty transform only reads it's parent
+		auto resolve = [this](unsigned int start, unsigned int end)
+		{
+			bool resolved = false;
+			for (unsigned int i = start; i < end; i++)
+			{
+				if (m_transforms[i]->m_isDirty)
+				{
+					m_transforms[i]->Resolve();
+					resolved = true;
+				}
+			}
+
+			if (resolved) m_transformsRevision++;
+		};
+
+		auto threading = m_context->GetSubsystem<Threading>();
+		for (unsigned int level = 0; level + 1 < (unsigned int)m_transformLevels.size(); level++)
+		{
+			threading->Parallel_For(m_transformLevels[level], m_transformLevels[level + 1], TRANSFORMS_PER_TASK, resolve);
+		}
+	}
+
 	void World::Unload()
 	{
 		FIRE_EVENT(EVENT_WORLD_UNLOAD);
+		for (const auto& actor : m_actors)
+		{
+			Actor_Slot_Release(actor.get());
+		}
 		m_actors.clear();
 		m_actors.shrink_to_fit();
+		m_actorsByID.clear();
+		m_actorsByName.clear();
+		m_spatialTree.Clear();
+		m_spatialEntries.clear();
+		m_cells->Close();
+		m_origin = WorldPosition();
+
+		lock_guard<mutex> lock(m_actorsPendingMutex);
+		m_actorsPendingRemoval.clear();
+		m_actorsPendingChange.clear();
+	}
+
+	void World::Structure_Apply()
+	{
+		vector<ActorHandle> removals;
+		vector<ActorHandle> changes;
+		{
+			lock_guard<mutex> lock(m_actorsPendingMutex);
+			removals.swap(m_actorsPendingRemoval);
+			changes.swap(m_actorsPendingChange);
+		}
+
+		if (removals.empty() && changes.empty())
+			return;
+
+		TIME_BLOCK_SCOPED_CPU();
+
+		// Gather the removed actors along with their descendants, each once
+		vector<shared_ptr<Actor>> removed;
+		unordered_set<Actor*> removedSet;
+		vector<Transform*> descendants;
+		for (auto handle : removals)
+		{
+			Actor* actor = Actor_Get(handle);
+			if (!actor || !removedSet.insert(actor).second)
+				continue;
+
+			removed.emplace_back(actor->GetPtrShared());
+			descendants.clear();
+			actor->GetTransform_PtrRaw()->GetDescendants(&descendants);
+			for (auto descendant : descendants)
+			{
+				if (removedSet.insert(descendant->GetActor_PtrRaw()).second)
+				{
+					removed.emplace_back(descendant->GetActor_PtrRaw()->GetPtrShared());
+				}
+			}
+		}
+
+		// Too many changes resubmit the whole world instead, the Renderer rebuilds it's lists once then
+		bool resubmit = removed.size() + changes.size() > CHANGES_RESUBMIT;
+		if (resubmit)
+		{
+			m_isDirty = true;
+		}
+		else
+		{
+			// Let subsystems drop any references they keep to these actors
+			for (const auto& actor : removed)
+			{
+				FIRE_EVENT_DATA(EVENT_WORLD_ACTOR_REMOVED, weak_ptr<Actor>(actor));
+			}
+		}
+
+		// Remove them with a single compaction, then index the rest once
+		if (!removed.empty())
+		{
+			unordered_set<Transform*> parents;
+			for (const auto& actor : removed)
+			{
+				Transform* parent = actor->GetTransform_PtrRaw()->GetParent();
+				if (parent && !removedSet.count(parent->GetActor_PtrRaw()))
+				{
+					parents.insert(parent);
+				}
+				Actor_Slot_Release(actor.get());
+			}
+
+			m_actors.erase(remove_if(m_actors.begin(), m_actors.end(), [&removedSet](const shared_ptr<Actor>& actor) { return removedSet.count(actor.get()) != 0; }), m_actors.end());
+			m_actorsByID.clear();
+			for (size_t i = 0; i < m_actors.size(); i++)
+			{
+				m_actorsByID[m_actors[i]->GetID()] = i;
+			}
+			m_actorsByName.clear();
+
+			// If there were parents left behind, update them
+			for (auto parent : parents)
+			{
+				parent->AcquireChildren();
+			}
+		}
+
+		// An actor can change many times per frame (components added, then set up), subsystems only hear of it once
+		if (!resubmit)
+		{
+			unordered_set<unsigned int> notified;
+			for (auto handle : changes)
+			{
+				Actor* actor = Actor_Get(handle);
+				if (actor && notified.insert(handle.GetValue()).second)
+				{
+					FIRE_EVENT_DATA(EVENT_WORLD_ACTOR_CHANGED, weak_ptr<Actor>(actor->GetPtrShared()));
+				}
+			}
+		}
+
+		// The last references to the removed actors (unless a subsystem still keeps one) go here
+		removed.clear();
+	}
+
+	void World::Spatial_Update()
+	{
+		TIME_BLOCK_SCOPED_CPU();
+
+		m_spatialUpdate++;
+		if (m_spatialEntries.size() < m_actorSlots.size())
+		{
+			m_spatialEntries.resize(m_actorSlots.size());
+		}
+
+		// Only what moved (a new transform revision) or changed shape gets re-fitted
+		for (auto actor : *m_spatialRenderables)
+		{
+			auto handle		= actor->GetHandle();
+			if (!handle.IsValid())
+				continue;
+
+			auto renderable	= actor->GetRenderable_PtrRaw();
+			auto transform	= actor->GetTransform_PtrRaw();
+			auto& entry		= m_spatialEntries[handle.GetIndex()];
+			entry.renderableSeen = m_spatialUpdate;
+
+			const auto& geometry	= renderable->Geometry_AABB();
+			bool isStatic			= actor->IsStatic();
+			bool changed = entry.renderable == -1 || entry.renderableRevision != transform->GetRevision() || entry.renderableStatic != isStatic || entry.geometry.GetMin() != geometry.GetMin() || entry.geometry.GetMax() != geometry.GetMax();
+			if (!changed)
+				continue;
+
+			entry.renderableRevision	= transform->GetRevision();
+			entry.renderableStatic		= isStatic;
+			entry.geometry				= geometry;
+			const auto& box				= renderable->Geometry_BB();
+			if (entry.renderable == -1)	entry.renderable = m_spatialTree.Insert(actor, box, isStatic);
+			else						m_spatialTree.Update(entry.renderable, box, isStatic);
+		}
+
+		// Directional lights reach everything, they aren't in the tree
+		for (auto component : ComponentPool::Get(ComponentType_Light))
+		{
+			auto actor	= component->GetActor_PtrRaw();
+			auto handle	= actor->GetHandle();
+			auto light	= static_cast<Light*>(component);
+			if (!handle.IsValid() || light->GetLightType() == LightType_Directional)
+				continue;
+
+			auto transform	= actor->GetTransform_PtrRaw();
+			auto& entry		= m_spatialEntries[handle.GetIndex()];
+			entry.lightSeen = m_spatialUpdate;
+
+			bool isStatic	= actor->IsStatic();
+			bool changed	= entry.light == -1 || entry.lightRevision != transform->GetRevision() || entry.lightStatic != isStatic || entry.range != light->GetRange();
+			if (!changed)
+				continue;
+
+			entry.lightRevision	= transform->GetRevision();
+			entry.lightStatic	= isStatic;
+			entry.range			= light->GetRange();
+			Vector3 position	= transform->GetPosition();
+			Vector3 extents		= Vector3(entry.range, entry.range, entry.range);
+			auto box			= BoundingBox(position - extents, position + extents);
+			if (entry.light == -1)	entry.light = m_spatialTree.Insert(actor, box, isStatic);
+			else					m_spatialTree.Update(entry.light, box, isStatic);
+		}
+
+		// What wasn't found got it's component removed (or became a directional light)
+		for (auto& entry : m_spatialEntries)
+		{
+			if (entry.renderable != -1 && entry.renderableSeen != m_spatialUpdate)
+			{
+				m_spatialTree.Remove(entry.renderable);
+				entry.renderable = -1;
+			}
+
+			if (entry.light != -1 && entry.lightSeen != m_spatialUpdate)
+			{
+				m_spatialTree.Remove(entry.light);
+				entry.light = -1;
+			}
+		}
 	}
 	//=========================================================================================================
 
 	//= I/O ===================================================================================================
-	bool World::SaveToFile(const string& filePathIn)
+	bool World::SaveToFile(const string& filePathIn, bool streamed /*= false*/)
 	{
 		ProgressReport::Get().Reset(g_progress_Scene);
 		ProgressReport::Get().SetIsLoading(g_progress_Scene, true);
@@ -141,49 +642,73 @@ namespace Directus
 		Stopwatch timer;
 	
 		// Add scene file extension to the filepath if it's missing
-		string filePath = filePathIn;
-		if (FileSystem::GetExtensionFromFilePath(filePath) != EXTENSION_WORLD)
+		string filePath		= filePathIn;
+		bool isSnapshot		= FileSystem::GetExtensionFromFilePath(filePath) == EXTENSION_WORLD_SNAPSHOT;
+		if (!isSnapshot && FileSystem::GetExtensionFromFilePath(filePath) != EXTENSION_WORLD)
 		{
 			filePath += EXTENSION_WORLD;
 		}
 
-		// Save any in-memory changes done to resources while running.
+		// Save any in-memory changes done to resources while running, the unchanged ones are skipped
 		m_context->GetSubsystem<ResourceManager>()->SaveResourcesToFiles();
 
-		// Create a prefab file
-		auto file = make_unique<FileStream>(filePath, FileStreamMode_Write);
-		if (!file->IsOpen())
+		// Files hold positions in the whole world, the origin moves back to where it started (and follows the camera again from there)
+		if (m_origin.x != 0.0 || m_origin.y != 0.0 || m_origin.z != 0.0)
 		{
-			return false;
+			Origin_Shift(Vector3::Zero - m_origin.ToVector3());
+			m_origin = WorldPosition();
 		}
 
+		// Baked, everything goes into the snapshot
+		if (isSnapshot)
+		{
+			vector<string> filePaths;
+			m_context->GetSubsystem<ResourceManager>()->GetResourceFilePaths(filePaths);
+			bool saved = WorldSnapshot(m_context).Save(filePath, filePaths, Actors_GetRoots());
+
+			ProgressReport::Get().SetIsLoading(g_progress_Scene, false);
+			if (!saved)
+				return false;
+
+			LOG_INFO("Scene: Saving took " + to_string((int)timer.GetElapsedTimeMs()) + " ms");
+			FIRE_EVENT(EVENT_WORLD_SAVED);
+			return true;
+		}
+
+		// Serialized to memory first, so a world that didn't change isn't written again
+		vector<std::byte> data;
+		auto file = make_unique<FileStream>(&data);
+
 		// Save currently loaded resource paths
 		vector<string> filePaths;
 		m_context->GetSubsystem<ResourceManager>()->GetResourceFilePaths(filePaths);
-		file->Write(filePaths);
+		Resources_Serialize(file.get(), filePaths);
 
-		//= Save actors ============================
 		// Only save root actors as they will also save their descendants
 		vector<shared_ptr<Actor>> rootActors = Actors_GetRoots();
 
-		// 1st - actor count
-		auto rootActorCount = (int)rootActors.size();
-		file->Write(rootActorCount);
-
-		// 2nd - actor IDs
-		for (const auto& root : rootActors)
+		// Streamable ones go into cells of their own, the world file keeps the rest
+		if (streamed)
 		{
-			file->Write(root->GetID());
-		}
+			vector<shared_ptr<Actor>> rootsStreamed;
+			auto itPersistent = partition(rootActors.begin(), rootActors.end(), [](const shared_ptr<Actor>& root) { return !WorldCells::IsStreamable(root.get()); });
+			rootsStreamed.assign(itPersistent, rootActors.end());
+			rootActors.erase(itPersistent, rootActors.end());
 
-		// 3rd - actors
-		for (const auto& root : rootActors)
-		{
-			root->Serialize(file.get());
+			if (!m_cells->Save(filePath, rootsStreamed))
+			{
+				LOG_ERROR("World::SaveToFile: Failed to save the world's cells");
+			}
 		}
-		//==============================================
 
+		Actors_Serialize(file.get(), rootActors);
+		file.reset();
+
+		bool saved = File_Write(filePath, data);
 		ProgressReport::Get().SetIsLoading(g_progress_Scene, false);
+		if (!saved)
+			return false;
+
 		LOG_INFO("Scene: Saving took " + to_string((int)timer.GetElapsedTimeMs()) + " ms");	
 		FIRE_EVENT(EVENT_WORLD_SAVED);
 
@@ -198,6 +723,15 @@ namespace Directus
 			return false;
 		}
 
+		{
+			lock_guard<mutex> lock(m_loadMutex);
+			if (m_load)
+			{
+				LOG_WARNING("World::LoadFromFile: \"" + m_load->GetFilePath() + "\" is still loading");
+				return false;
+			}
+		}
+
 		// Thread safety: Wait for scene and the renderer to stop the actors (could do double buffering in the future)
 		while (m_state != Loading || Renderer::IsRendering()) { m_state = Request_Loading; this_thread::sleep_for(chrono::milliseconds(16)); }
 
@@ -207,15 +741,26 @@ namespace Directus
 
 		Unload();
 
-		// Read all the resource file paths
-		auto file = make_unique<FileStream>(filePath, FileStreamMode_Read);
-		if (!file->IsOpen())
-			return false;
+		// Read all the resource file paths, a snapshot is read whole (see WorldSnapshot)
+		bool isSnapshot = FileSystem::GetExtensionFromFilePath(filePath) == EXTENSION_WORLD_SNAPSHOT;
+		unique_ptr<FileStream> file;
+		WorldSnapshot snapshot(m_context);
+		vector<string> resourcePaths;
+		if (isSnapshot)
+		{
+			if (!snapshot.Open(filePath))
+				return false;
 
-		Stopwatch timer;
+			resourcePaths = snapshot.GetResourcePaths();
+		}
+		else
+		{
+			file = make_unique<FileStream>(filePath, FileStreamMode_ReadMapped);
+			if (!file->IsOpen() || !Resources_Deserialize(file.get(), &resourcePaths))
+				return false;
+		}
 
-		vector<string> resourcePaths;
-		file->Read(&resourcePaths);
+		Stopwatch timer;
 
 		ProgressReport::Get().SetJobCount(g_progress_Scene, (int)resourcePaths.size());
 
@@ -241,27 +786,17 @@ namespace Directus
 			ProgressReport::Get().IncrementJobsDone(g_progress_Scene);
 		}
 
-		//= Load actors ============================	
-		// 1st - Root actor count
-		int rootactorCount = file->ReadInt();
-
-		// 2nd - Root actor IDs
-		for (int i = 0; i < rootactorCount; i++)
+		if (isSnapshot)
 		{
-			auto& actor = Actor_Create();
-			actor->SetID(file->ReadInt());
+			snapshot.Instantiate();
 		}
-
-		// 3rd - actors
-		// It's important to loop with rootactorCount
-		// as the vector size will increase as we deserialize
-		// actors. This is because a actor will also
-		// deserialize their descendants.
-		for (int i = 0; i < rootactorCount; i++)
+		else
 		{
-			m_actors[i]->Deserialize(file.get(), nullptr);
+			Actors_Deserialize(file.get());
 		}
-		//==============================================
+
+		// Whatever was saved in cells streams in from now on
+		m_cells->Open(filePath);
 
 		m_isDirty	= true;
 		m_state		= Ticking;
@@ -271,13 +806,361 @@ namespace Directus
 		FIRE_EVENT(EVENT_WORLD_LOADED);
 		return true;
 	}
+
+	shared_ptr<WorldLoad> World::LoadFromFileAsync(const string& filePath)
+	{
+		if (!FileSystem::FileExists(filePath))
+		{
+			LOG_ERROR(filePath + " was not found.");
+			return nullptr;
+		}
+
+		lock_guard<mutex> lock(m_loadMutex);
+		if (m_load)
+		{
+			LOG_WARNING("World::LoadFromFileAsync: \"" + m_load->GetFilePath() + "\" is still loading");
+			return nullptr;
+		}
+
+		// Read all the resource file paths, a snapshot is read whole and kept until the actors get created
+		auto load = make_shared<WorldLoad>(filePath);
+		vector<string> resourcePaths;
+		if (FileSystem::GetExtensionFromFilePath(filePath) == EXTENSION_WORLD_SNAPSHOT)
+		{
+			load->m_snapshot = make_unique<WorldSnapshot>(m_context);
+			if (!load->m_snapshot->Open(filePath))
+				return nullptr;
+
+			resourcePaths = load->m_snapshot->GetResourcePaths();
+		}
+		else
+		{
+			FileStream file(filePath, FileStreamMode_ReadMapped);
+			if (!file.IsOpen() || !Resources_Deserialize(&file, &resourcePaths))
+				return nullptr;
+		}
+
+		// Textures, then materials (which reference textures), then models (which reference materials), so
+		// each resource finds what it depends on already in the cache instead of loading it a second time
+		load->m_stages.resize(3);
+		for (const auto& resourcePath : resourcePaths)
+		{
+			if (FileSystem::IsEngineTextureFile(resourcePath))	load->m_stages[0].emplace_back(resourcePath);
+			if (FileSystem::IsEngineMaterialFile(resourcePath))	load->m_stages[1].emplace_back(resourcePath);
+			if (FileSystem::IsEngineModelFile(resourcePath))	load->m_stages[2].emplace_back(resourcePath);
+		}
+		load->m_resourceCount	= (unsigned int)resourcePaths.size();
+		load->m_resourcesDone	= load->m_resourceCount - (unsigned int)(load->m_stages[0].size() + load->m_stages[1].size() + load->m_stages[2].size());
+		load->m_worldThread		= m_threadID;
+		m_load					= load;
+
+		ProgressReport::Get().Reset(g_progress_Scene);
+		ProgressReport::Get().SetIsLoading(g_progress_Scene, true);
+		ProgressReport::Get().SetStatus(g_progress_Scene, "Loading scene...");
+		ProgressReport::Get().SetJobCount(g_progress_Scene, 100);
+
+		Load_Stage(load, 0);
+		return load;
+	}
+
+	void World::Load_Stage(const shared_ptr<WorldLoad>& load, unsigned int stage)
+	{
+		while (stage < (unsigned int)load->m_stages.size() && load->m_stages[stage].empty())
+		{
+			stage++;
+		}
+
+		// Everything is in, the actors get created by the World as it ticks
+		if (stage == (unsigned int)load->m_stages.size())
+		{
+			load->m_state = WorldLoad_Actors;
+			return;
+		}
+
+		auto threading		= m_context->GetSubsystem<Threading>();
+		auto resourceMng	= m_context->GetSubsystem<ResourceManager>();
+		load->m_stagePending = (unsigned int)load->m_stages[stage].size();
+		for (const auto& resourcePath : load->m_stages[stage])
+		{
+			threading->AddTask(ThreadGroup_Background, [this, load, stage, resourcePath, resourceMng]()
+			{
+				if (stage == 0) resourceMng->Load<RHI_Texture>(resourcePath);
+				if (stage == 1) resourceMng->Load<Material>(resourcePath);
+				if (stage == 2) resourceMng->Load<Model>(resourcePath);
+
+				load->m_resourcesDone++;
+				if (--load->m_stagePending == 0)
+				{
+					Load_Stage(load, stage + 1);
+				}
+			});
+		}
+	}
+
+	void World::Load_Tick()
+	{
+		shared_ptr<WorldLoad> load;
+		{
+			lock_guard<mutex> lock(m_loadMutex);
+			load = m_load;
+		}
+		if (!load)
+			return;
+
+		ProgressReport::Get().SetJobsDone(g_progress_Scene, (int)(load->GetProgress() * 100.0f));
+
+		if (load->m_state != WorldLoad_Actors)
+			return;
+
+		// First frame of the new world, the old one goes and every root gets created (so IDs resolve),
+		// the root actors then deserialize one after the other, along with their descendants
+		if (!load->m_file)
+		{
+			// Wait for the renderer to stop the actors
+			if (Renderer::IsRendering())
+				return;
+
+			Unload();
+
+			// A snapshot is nothing but copies, so it's created in one go
+			if (load->m_snapshot)
+			{
+				load->m_snapshot->Instantiate();
+				load->m_snapshot.reset();
+			}
+			else
+			{
+				load->m_file = make_unique<FileStream>(load->GetFilePath(), FileStreamMode_ReadMapped);
+				vector<string> resourcePaths;
+				if (!load->m_file->IsOpen() || !Resources_Deserialize(load->m_file.get(), &resourcePaths))
+				{
+					LOG_ERROR("World::Load_Tick: Failed to open \"" + load->GetFilePath() + "\"");
+					ProgressReport::Get().SetIsLoading(g_progress_Scene, false);
+					{
+						lock_guard<mutex> lock(m_loadMutex);
+						m_load.reset();
+					}
+					load->Finish(WorldLoad_Failed);
+					return;
+				}
+
+				// Entered for as long as the file is open, one from before chunks has none (see Actors_Deserialize)
+				FileStreamChunk actors;
+				load->m_file->Chunk_Enter(CHUNK_ACTORS, &actors);
+				int rootCount = load->m_file->ReadInt();
+				Actors_Reserve(rootCount);
+				for (int i = 0; i < rootCount; i++)
+				{
+					auto& actor = Actor_Create();
+					actor->SetID(load->m_file->ReadInt());
+					load->m_roots.emplace_back(actor.get());
+				}
+				load->m_actorCount = rootCount;
+			}
+		}
+
+		// As many roots as fit in this frame, at least one
+		Stopwatch timer;
+		while (load->m_file && load->m_actorsDone < load->m_actorCount)
+		{
+			load->m_roots[load->m_actorsDone]->Deserialize(load->m_file.get(), nullptr);
+			load->m_actorsDone++;
+
+			if (timer.GetElapsedTimeMs() >= LOAD_BUDGET_MS)
+				break;
+		}
+
+		if (load->m_actorsDone < load->m_actorCount)
+			return;
+
+		load->m_file.reset();
+		load->m_roots.clear();
+
+		// Whatever was saved in cells streams in from now on
+		m_cells->Open(load->GetFilePath());
+
+		m_isDirty = true;
+		ProgressReport::Get().SetIsLoading(g_progress_Scene, false);
+		LOG_INFO("Scene: Loading took " + to_string((int)load->m_timer.GetElapsedTimeMs()) + " ms");
+		{
+			lock_guard<mutex> lock(m_loadMutex);
+			m_load.reset();
+		}
+		load->Finish(WorldLoad_Completed);
+
+		FIRE_EVENT(EVENT_WORLD_LOADED);
+	}
+	//===================================================================================================
+
+	void World::Resources_Serialize(FileStream* file, const vector<string>& filePaths)
+	{
+		file->Chunk_Begin(CHUNK_RESOURCES, 1);
+		file->Write(filePaths);
+		file->Chunk_End();
+	}
+
+	bool World::Resources_Deserialize(FileStream* file, vector<string>* filePaths)
+	{
+		// A file from before chunks starts with the paths, the actors follow unchunked (see Actors_Deserialize)
+		FileStreamChunk chunk;
+		bool chunked = file->Chunk_Enter(CHUNK_RESOURCES, &chunk);
+		file->Read(filePaths);
+
+		if (chunked)
+		{
+			file->Chunk_Leave(chunk);
+		}
+		return true;
+	}
+
+	void World::Actors_Serialize(FileStream* file, const vector<shared_ptr<Actor>>& roots)
+	{
+		file->Chunk_Begin(CHUNK_ACTORS, 1);
+
+		// 1st - actor count
+		file->Write((int)roots.size());
+
+		// 2nd - actor IDs
+		for (const auto& root : roots)
+		{
+			file->Write(root->GetID());
+		}
+
+		// 3rd - actors
+		for (const auto& root : roots)
+		{
+			root->Serialize(file);
+		}
+
+		file->Chunk_End();
+	}
+
+	bool World::File_Write(const string& filePath, const vector<std::byte>& data)
+	{
+		size_t hash	= std::hash<string_view>()(string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+		auto it		= m_fileHashes.find(filePath);
+		if (it != m_fileHashes.end() && it->second == hash && FileSystem::FileExists(filePath))
+			return true;
+
+		auto mode = Settings::Get().FileCompression_Get(FileCompression_World) ? FileStreamMode_WriteCompressed : FileStreamMode_WriteBuffered;
+		auto file = make_unique<FileStream>(filePath, mode, m_context->GetSubsystem<Threading>());
+		if (!file->IsOpen())
+		{
+			LOGF_ERROR("World::File_Write: Failed to create \"%s\"", filePath.c_str());
+			return false;
+		}
+		file->WriteBytes(data.data(), data.size());
+		m_fileHashes[filePath] = hash;
+
+		return true;
+	}
+
+	vector<Actor*> World::Actors_Deserialize(FileStream* file)
+	{
+		// Without the chunk it's a file from before chunks, the same fields follow right away
+		FileStreamChunk chunk;
+		bool chunked = file->Chunk_Enter(CHUNK_ACTORS, &chunk);
+
+		// 1st - Root actor count
+		int rootCount = file->ReadInt();
+
+		// 2nd - Root actor IDs
+		vector<Actor*> roots;
+		for (int i = 0; i < rootCount; i++)
+		{
+			auto& actor = Actor_Create();
+			actor->SetID(file->ReadInt());
+			roots.emplace_back(actor.get());
+		}
+
+		// 3rd - actors, which deserialize their descendants too
+		for (auto root : roots)
+		{
+			root->Deserialize(file, nullptr);
+		}
+
+		if (chunked)
+		{
+			file->Chunk_Leave(chunk);
+		}
+
+		return roots;
+	}
+	//===================================================================================================
+
+	//= PLAY MODE ==================================================================================
+	void World::PlayMode_Capture()
+	{
+		m_playSnapshot.clear();
+
+		// Actors still being created would come back half there
+		{
+			lock_guard<mutex> lock(m_loadMutex);
+			if (m_load)
+			{
+				LOG_WARNING("World::PlayMode_Capture: A world is loading, it won't be restored when the game stops");
+				return;
+			}
+		}
+
+		Stopwatch timer;
+
+		vector<shared_ptr<Actor>> roots = Actors_GetRoots();
+		if (m_cells->IsOpen())
+		{
+			roots.erase(remove_if(roots.begin(), roots.end(), [](const shared_ptr<Actor>& root) { return WorldCells::IsStreamable(root.get()); }), roots.end());
+		}
+
+		auto file = make_unique<FileStream>(&m_playSnapshot);
+		Actors_Serialize(file.get(), roots);
+		file.reset();
+		m_playOrigin = m_origin;
+
+		LOGF_INFO("World::PlayMode_Capture: %d root actors in %.2f ms (%d KB)", (int)roots.size(), timer.GetElapsedTimeMs(), (int)(m_playSnapshot.size() / 1024));
+	}
+
+	void World::PlayMode_Restore()
+	{
+		if (m_playSnapshot.empty())
+			return;
+
+		Stopwatch timer;
+
+		// Everything that was captured goes, along with whatever the game created, at once
+		for (const auto& root : Actors_GetRoots())
+		{
+			if (!m_cells->IsOpen() || !WorldCells::IsStreamable(root.get()))
+			{
+				Actor_Remove(root);
+			}
+		}
+		Structure_Apply();
+
+		// The actors were serialized relative to the origin of back then, the streamed ones that stayed move there too
+		if (m_origin.x != m_playOrigin.x || m_origin.y != m_playOrigin.y || m_origin.z != m_playOrigin.z)
+		{
+			Origin_Shift((m_playOrigin - m_origin).ToVector3());
+			m_origin = m_playOrigin;
+		}
+
+		FileStream file(m_playSnapshot.data(), m_playSnapshot.size());
+		Actors_Deserialize(&file);
+		m_playSnapshot.clear();
+		m_playSnapshot.shrink_to_fit();
+		m_isDirty = true;
+
+		LOGF_INFO("World::PlayMode_Restore: %d actors in %.2f ms", Actor_GetCount(), timer.GetElapsedTimeMs());
+	}
 	//===================================================================================================
 
 	//= Actor HELPER FUNCTIONS  ====================================================================
 	shared_ptr<Actor>& World::Actor_Create()
 	{
-		auto actor = make_shared<Actor>(m_context);
+		// Out of the actor pool, recycled once the last reference goes
+		auto actor = allocate_shared<Actor>(PoolAllocator<Actor>(), m_context);
 		actor->Initialize(actor->AddComponent<Transform>().get());
+		Actor_Slot_Acquire(actor.get());
+		m_actorsByID[actor->GetID()] = m_actors.size();
 		return m_actors.emplace_back(actor);
 	}
 
@@ -286,53 +1169,106 @@ namespace Directus
 		if (!actor)
 			return m_actorEmpty;
 
-		return m_actors.emplace_back(actor);
+		// Already in the world, it stays where it is instead of being listed twice
+		if (Actor_Get(actor->GetHandle()) == actor.get())
+			return m_actors[m_actorsByID[actor->GetID()]];
+
+		Actor_Slot_Acquire(actor.get());
+		m_actorsByID[actor->GetID()] = m_actors.size();
+		auto& actorAdded = m_actors.emplace_back(actor);
+		actorAdded->NotifyComponentsChanged();
+
+		return actorAdded;
 	}
 
 	bool World::Actor_Exists(const weak_ptr<Actor>& actor)
 	{
-		if (actor.expired())
-			return false;
-
-		return Actor_GetByID(actor.lock()->GetID()) != nullptr;
+		auto actorShared = actor.lock();
+		return actorShared ? Actor_Exists(actorShared->GetHandle()) : false;
 	}
 
-	// Removes an actor and all of it's children
 	void World::Actor_Remove(const weak_ptr<Actor>& actor)
 	{
-		Actor* actorPtr = actor.lock().get();
-		if (!actorPtr)
+		auto actorShared = actor.lock();
+		if (!actorShared || !actorShared->GetHandle().IsValid())
 			return;
 
-		// remove any descendants
-		vector<Transform*> children = actorPtr->GetTransform_PtrRaw()->GetChildren();
-		for (const auto& child : children)
+		lock_guard<mutex> lock(m_actorsPendingMutex);
+		m_actorsPendingRemoval.emplace_back(actorShared->GetHandle());
+	}
+
+	void World::Actor_OnChanged(ActorHandle handle)
+	{
+		lock_guard<mutex> lock(m_actorsPendingMutex);
+		m_actorsPendingChange.emplace_back(handle);
+	}
+
+	Actor* World::Actor_Get(ActorHandle handle)
+	{
+		if (!handle.IsValid() || handle.GetIndex() >= (unsigned int)m_actorSlots.size())
+			return nullptr;
+
+		const auto& slot = m_actorSlots[handle.GetIndex()];
+		return slot.generation == handle.GetGeneration() ? slot.actor : nullptr;
+	}
+
+	void World::Actor_Remove(ActorHandle handle)
+	{
+		if (Actor_Get(handle))
 		{
-			Actor_Remove(child->GetActor_PtrWeak());
+			lock_guard<mutex> lock(m_actorsPendingMutex);
+			m_actorsPendingRemoval.emplace_back(handle);
 		}
+	}
 
-		// Keep a reference to it's parent (in case it has one)
-		Transform* parent = actorPtr->GetTransform_PtrRaw()->GetParent();
+	void World::Actor_Slot_Acquire(Actor* actor)
+	{
+		// Added again while still in the world, it keeps the handle it has
+		if (!actor || Actor_Get(actor->m_handle) == actor)
+			return;
 
-		// Remove this actor
-		for (auto it = m_actors.begin(); it < m_actors.end();)
+		unsigned int index = 0;
+		if (!m_actorSlotsFree.empty())
+		{
+			index = m_actorSlotsFree.back();
+			m_actorSlotsFree.pop_back();
+		}
+		else
 		{
-			shared_ptr<Actor> temp = *it;
-			if (temp->GetID() == actorPtr->GetID())
+			if (m_actorSlots.size() > ActorHandle::index_mask)
 			{
-				it = m_actors.erase(it);
-				break;
+				LOG_ERROR("World::Actor_Slot_Acquire: Out of actor slots, the actor won't have a handle");
+				return;
 			}
-			++it;
+			index = (unsigned int)m_actorSlots.size();
+			m_actorSlots.emplace_back();
 		}
 
-		// If there was a parent, update it
-		if (parent)
+		auto& slot			= m_actorSlots[index];
+		slot.actor			= actor;
+		actor->m_handle		= ActorHandle(index, slot.generation);
+	}
+
+	void World::Actor_Slot_Release(Actor* actor)
+	{
+		if (!actor || Actor_Get(actor->m_handle) != actor)
+			return;
+
+		// Generation 0 is never handed out, a default handle has it
+		auto index		= actor->m_handle.GetIndex();
+		if (index < (unsigned int)m_spatialEntries.size())
 		{
-			parent->AcquireChildren();
+			auto& entry = m_spatialEntries[index];
+			m_spatialTree.Remove(entry.renderable);
+			m_spatialTree.Remove(entry.light);
+			entry = SpatialEntry();
 		}
-
-		m_isDirty = true;
+		auto& slot		= m_actorSlots[index];
+		slot.actor		= nullptr;
+		slot.generation	= (slot.generation + 1) & ActorHandle::generation_mask;
+		slot.generation	= slot.generation == 0 ? 1 : slot.generation;
+		m_actorSlotsFree.emplace_back(index);
+		actor->m_handle	= ActorHandle();
 	}
 
 	vector<shared_ptr<Actor>> World::Actors_GetRoots()
@@ -349,26 +1285,45 @@ namespace Directus
 		return rootActors;
 	}
 
-	const shared_ptr<Actor>& World::Actor_GetByName(const string& name)
+	const shared_ptr<Actor>& World::Actor_GetByName(const StringId& name)
 	{
-		for (const auto& actor : m_actors)
+		// Names change without the world knowing, so an entry is only trusted if the actor still goes by it
+		auto it = m_actorsByName.find(name);
+		if (it != m_actorsByName.end() && it->second < m_actors.size() && m_actors[it->second]->GetNameID() == name)
+			return m_actors[it->second];
+
+		for (size_t i = 0; i < m_actors.size(); i++)
 		{
-			if (actor->GetName() == name)
-				return actor;
+			if (m_actors[i]->GetNameID() == name)
+			{
+				m_actorsByName[name] = i;
+				return m_actors[i];
+			}
 		}
 
+		m_actorsByName.erase(name);
 		return _World::emptyActor;
 	}
 
 	const shared_ptr<Actor>& World::Actor_GetByID(unsigned int ID)
 	{
-		for (const auto& actor : m_actors)
-		{
-			if (actor->GetID() == ID)
-				return actor;
-		}
+		auto it = m_actorsByID.find(ID);
+		if (it == m_actorsByID.end())
+			return _World::emptyActor;
 
-		return _World::emptyActor;
+		return m_actors[it->second];
+	}
+
+	void World::Actor_OnIDChanged(Actor* actor, unsigned int previousID)
+	{
+		// Actors not in the world yet (e.g. still being constructed) get indexed once they are added
+		auto it = m_actorsByID.find(previousID);
+		if (!actor || it == m_actorsByID.end() || m_actors[it->second].get() != actor)
+			return;
+
+		size_t index = it->second;
+		m_actorsByID.erase(it);
+		m_actorsByID[actor->GetID()] = index;
 	}
 	//===================================================================================================
 
@@ -379,6 +1334,7 @@ namespace Directus
 		skybox->SetName("Skybox");
 		skybox->SetHierarchyVisibility(false);
 		skybox->AddComponent<Skybox>();	
+		m_skybox = skybox->GetHandle();
 
 		return skybox;
 	}
@@ -23,14 +23,27 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ======================
 #include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include "ActorHandle.h"
+#include "SpatialTree.h"
+#include "WorldLoad.h"
 #include "../Math/Vector3.h"
 #include "../Threading/Threading.h"
+#include "../Core/StringId.h"
 //=================================
 
+#define WORLD_ORIGIN_REBASE_DISTANCE 1024.0f // how far the camera gets from the origin before the origin is moved to it, floats are still precise to a tenth of a millimeter there
+
 namespace Directus
 {
+	class WorldCells;
+	class ActorQuery;
+	class FileStream;
 	class Actor;
 	class Light;
+	class Transform;
 
 	enum Scene_State
 	{
@@ -40,6 +53,22 @@ namespace Directus
 		Loading
 	};
 
+	// A position anywhere in a large world, in double precision (see World::Origin_Get)
+	struct WorldPosition
+	{
+		WorldPosition() = default;
+		WorldPosition(double x, double y, double z) : x(x), y(y), z(z) {}
+		WorldPosition(const Math::Vector3& position) : x(position.x), y(position.y), z(position.z) {}
+
+		WorldPosition operator+(const WorldPosition& b) const	{ return WorldPosition(x + b.x, y + b.y, z + b.z); }
+		WorldPosition operator-(const WorldPosition& b) const	{ return WorldPosition(x - b.x, y - b.y, z - b.z); }
+		Math::Vector3 ToVector3() const							{ return Math::Vector3((float)x, (float)y, (float)z); }
+
+		double x = 0.0;
+		double y = 0.0;
+		double z = 0.0;
+	};
+
 	class ENGINE_CLASS World : public Subsystem
 	{
 	public:
@@ -54,20 +83,82 @@ namespace Directus
 		void Unload();
 
 		//= IO ========================================
-		bool SaveToFile(const std::string& filePath);
+		// Streamed, the actors that can stream (see WorldCells) are saved in cells next to the world file.
+		// A path ending in EXTENSION_WORLD_SNAPSHOT bakes the world instead (see WorldSnapshot), and loads back the same way.
+		bool SaveToFile(const std::string& filePath, bool streamed = false);
 		bool LoadFromFile(const std::string& filePath);
+		// Loads the resources on the worker threads while the current world keeps ticking, then swaps it out for
+		// the loaded one and creates it's actors a batch per frame. Null if the file can't be read or a load is running.
+		std::shared_ptr<WorldLoad> LoadFromFileAsync(const std::string& filePath);
+		// World and cell files are a chunk of the resource paths, then a chunk of the root actors (each holding it's
+		// descendants). The resources are read ahead of the actors, false if a file has none (corrupt, or older than chunks).
+		static void Resources_Serialize(FileStream* file, const std::vector<std::string>& filePaths);
+		static bool Resources_Deserialize(FileStream* file, std::vector<std::string>* filePaths);
+		void Actors_Serialize(FileStream* file, const std::vector<std::shared_ptr<Actor>>& roots);
+		std::vector<Actor*> Actors_Deserialize(FileStream* file);
+		// Writes one of the files the world is made of, unless it still holds these bytes from the last time it was written
+		bool File_Write(const std::string& filePath, const std::vector<std::byte>& data);
+		// Streaming of the cells a world was saved in, if it was
+		WorldCells* GetCells() { return m_cells.get(); }
 		//=============================================
 
+		//= PLAY MODE =================================================================
+		// Entering game mode serializes the actors into memory, leaving it replaces them with what was serialized, so
+		// nothing the game did (physics bodies included, they are re-created at rest) outlives it. Streamed actors
+		// belong to their cells and are left alone. Both happen on their own when the World detects the toggle (see Tick).
+		void PlayMode_Capture();
+		void PlayMode_Restore();
+		bool PlayMode_HasSnapshot() { return !m_playSnapshot.empty(); }
+		//=============================================================================
+
 		//= Actor HELPER FUNCTIONS ====================================================
 		std::shared_ptr<Actor>& Actor_Create();
 		std::shared_ptr<Actor>& Actor_Add(const std::shared_ptr<Actor>& actor);
 		bool Actor_Exists(const std::weak_ptr<Actor>& actor);
+		// Queues an actor and it's descendants for removal, they stay in the World until it's next sync point (see Tick)
 		void Actor_Remove(const std::weak_ptr<Actor>& actor);
 		const std::vector<std::shared_ptr<Actor>>& Actors_GetAll() { return m_actors; }
 		std::vector<std::shared_ptr<Actor>> Actors_GetRoots();
-		const std::shared_ptr<Actor>& Actor_GetByName(const std::string& name);
+		const std::shared_ptr<Actor>& Actor_GetByName(const StringId& name);
 		const std::shared_ptr<Actor>& Actor_GetByID(unsigned int ID);
 		int Actor_GetCount() { return (int)m_actors.size(); }
+		// Makes room for that many more actors, ahead of creating them in bulk
+		void Actors_Reserve(unsigned int count) { m_actors.reserve(m_actors.size() + count); m_actorsByID.reserve(m_actorsByID.size() + count); }
+		// Re-indexes an actor under it's new ID (see Actor::SetID)
+		void Actor_OnIDChanged(Actor* actor, unsigned int previousID);
+		// Holds on to an actor's EVENT_WORLD_ACTOR_CHANGED until the next sync point (see Actor::NotifyComponentsChanged)
+		void Actor_OnChanged(ActorHandle handle);
+		//=============================================================================
+
+		//= Actor HANDLES =============================================================
+		// Returns the actor a handle refers to, null if it was removed
+		Actor* Actor_Get(ActorHandle handle);
+		bool Actor_Exists(ActorHandle handle) { return Actor_Get(handle) != nullptr; }
+		void Actor_Remove(ActorHandle handle);
+		//=============================================================================
+
+		// Blends what moved in the last tick for rendering, alpha is how far past that tick the frame is (see Engine_FixedStep)
+		void Transforms_Interpolate(float alpha);
+		// Changes whenever a tick recomputed any transform, so whether anything moved can be told without looking (see Renderer)
+		unsigned int Transforms_GetRevision() { return m_transformsRevision; }
+
+		//= ORIGIN ====================================================================
+		// Transforms and physics bodies are relative to an origin that follows the camera, floats lose precision a few kilometers out.
+		// Where the origin is in the whole world is kept in double precision, shifting it moves everything by the opposite amount.
+		void Origin_Shift(const Math::Vector3& offset);
+		const WorldPosition& Origin_Get() { return m_origin; }
+		// Moves a root that was read at its position in the whole world (and its descendants) to where that is relative to the origin
+		void Origin_Place(Actor* root);
+		// How far the camera can get from the origin before it's moved to the camera, 0 never moves it
+		void Origin_SetRebaseDistance(float distance)	{ m_originRebaseDistance = distance; }
+		float Origin_GetRebaseDistance()				{ return m_originRebaseDistance; }
+		//=============================================================================
+
+		//= SPATIAL QUERIES ===========================================================
+		// Brings the tree up to date with renderables and point/spot lights that moved, changed or got added/removed
+		void Spatial_Update();
+		// Renderables and point/spot lights by their world bounding box, as of the last update
+		SpatialTree& Spatial_Get() { return m_spatialTree; }
 		//=============================================================================
 
 	private:
@@ -77,9 +168,74 @@ namespace Directus
 		std::shared_ptr<Actor>& CreateDirectionalLight();
 		//===============================================
 
+		// Ticks every component a type at a time, scheduling the types by what they read/write across the worker threads
+		void Systems_Tick();
+		// Recomputes every dirty transform, a level of the hierarchy at a time spread across the worker threads
+		void Transforms_Update();
+		// The sync point, removes the queued actors with a single compaction and notifies subsystems of what changed
+		void Structure_Apply();
+
+		//= ASYNC LOADING ===============================================
+		// Hands a group of resources to the worker threads, the last one to finish starts the next group
+		void Load_Stage(const std::shared_ptr<WorldLoad>& load, unsigned int stage);
+		// Creates the next batch of actors, once the resources are in
+		void Load_Tick();
+		//===============================================================
+
+		//= Actor SLOTS =========================================
+		// Takes a free slot (or adds one), and hands out its handle
+		void Actor_Slot_Acquire(Actor* actor);
+		// Frees an actor's slot, advancing it's generation
+		void Actor_Slot_Release(Actor* actor);
+		//=======================================================
+
+		// Declared before the actors, so it's still around while they get destroyed
+		SpatialTree m_spatialTree;
+		struct SpatialEntry
+		{
+			int renderable					= -1;	// the proxies in m_spatialTree
+			int light						= -1;
+			unsigned int renderableRevision	= 0;	// the transform revision each was last updated at
+			unsigned int lightRevision		= 0;
+			unsigned int renderableSeen		= 0;	// the last update either was found at
+			unsigned int lightSeen			= 0;
+			Math::BoundingBox geometry;
+			float range						= 0.0f;
+			bool renderableStatic			= false;	// what each proxy was inserted as
+			bool lightStatic				= false;
+		};
+		std::vector<SpatialEntry> m_spatialEntries; // by actor slot
+		std::unique_ptr<ActorQuery> m_spatialRenderables; // what goes in the tree, renderables that aren't skyboxes
+		unsigned int m_spatialUpdate = 0;
+		std::vector<ActorHandle> m_actorsPendingRemoval;
+		std::vector<ActorHandle> m_actorsPendingChange;
+		std::mutex m_actorsPendingMutex; // actors can be removed/changed by scripts on a worker thread, or by a world that's loading
 		std::vector<std::shared_ptr<Actor>> m_actors;
+		std::vector<Transform*> m_transforms;			// sorted by depth in the hierarchy, parents come before their children
+		std::vector<unsigned int> m_transformLevels;	// where every depth starts in m_transforms, plus where the last one ends
+		unsigned int m_transformsVersion = ~0U;		// the hierarchy version m_transforms was sorted at
+		std::atomic<unsigned int> m_transformsRevision = 0;
+		bool m_transformsInterpolated = false;		// whether any transform renders a blended state
+		std::unordered_map<unsigned int, size_t> m_actorsByID;		// where every actor is in m_actors
+		std::unordered_map<StringId, size_t> m_actorsByName;	// filled in by lookups, validated against the actor's name on use
+		struct ActorSlot
+		{
+			Actor* actor			= nullptr;
+			unsigned int generation	= 1;
+		};
+		std::vector<ActorSlot> m_actorSlots;
+		std::vector<unsigned int> m_actorSlotsFree;
 		std::shared_ptr<Actor> m_actorEmpty;
-		std::weak_ptr<Actor> m_skybox;
+		std::unique_ptr<WorldCells> m_cells;
+		std::unordered_map<std::string, size_t> m_fileHashes; // the content hash of every file File_Write() wrote, by path
+		std::shared_ptr<WorldLoad> m_load;
+		std::mutex m_loadMutex;
+		std::thread::id m_threadID; // the thread the World ticks on
+		ActorHandle m_skybox;
+		WorldPosition m_origin;
+		float m_originRebaseDistance = WORLD_ORIGIN_REBASE_DISTANCE;
+		std::vector<std::byte> m_playSnapshot;	// the actors as they were when the game started
+		WorldPosition m_playOrigin;				// the origin they were serialized relative to
 		bool m_wasInEditorMode;
 		bool m_isDirty;
 		Scene_State m_state;
@@ -0,0 +1,399 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ================================
+#include "WorldCells.h"
+#include <map>
+#include <algorithm>
+#include "World.h"
+#include "Actor.h"
+#include "Components/Transform.h"
+#include "Components/Camera.h"
+#include "Components/Light.h"
+#include "Components/Skybox.h"
+#include "Components/Renderable.h"
+#include "Components/AudioListener.h"
+#include "../IO/FileStream.h"
+#include "../IO/AsyncIO.h"
+#include "../Resource/ResourceManager.h"
+#include "../Rendering/Model.h"
+#include "../Threading/Threading.h"
+//===========================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+//=============================
+
+#define CELLS_LOADING_MAX 2 // cells loading their resources at the same time, more would compete for the disk
+
+namespace Directus
+{
+	namespace _WorldCells
+	{
+		string GetTableFilePath(const string& worldFilePath)
+		{
+			return FileSystem::GetFilePathWithoutExtension(worldFilePath) + EXTENSION_WORLD_CELLS;
+		}
+
+		// The models and materials a hierarchy's renderables use, loading them loads their textures as well
+		void Resources_Collect(Actor* root, vector<string>& paths)
+		{
+			vector<Transform*> transforms = { root->GetTransform_PtrRaw() };
+			root->GetTransform_PtrRaw()->GetDescendants(&transforms);
+			for (auto transform : transforms)
+			{
+				auto renderable = transform->GetActor_PtrRaw()->GetRenderable_PtrRaw();
+				if (!renderable)
+					continue;
+
+				auto model = renderable->Geometry_Model();
+				if (model && model->HasFilePath())
+				{
+					paths.emplace_back(model->GetResourceFilePath());
+				}
+
+				auto material = renderable->Material_Ptr();
+				if (material && material->HasFilePath())
+				{
+					paths.emplace_back(material->GetResourceFilePath());
+				}
+			}
+		}
+
+		void Resources_Load(ResourceManager* resourceManager, const vector<string>& paths)
+		{
+			for (const auto& path : paths)
+			{
+				if (FileSystem::IsEngineModelFile(path))
+				{
+					resourceManager->Load<Model>(path);
+				}
+
+				if (FileSystem::IsEngineMaterialFile(path))
+				{
+					resourceManager->Load<Material>(path);
+				}
+			}
+		}
+	}
+
+	WorldCells::WorldCells(Context* context)
+	{
+		m_context = context;
+	}
+
+	bool WorldCells::IsStreamable(Actor* root)
+	{
+		if (!root)
+			return false;
+
+		vector<Transform*> transforms = { root->GetTransform_PtrRaw() };
+		root->GetTransform_PtrRaw()->GetDescendants(&transforms);
+
+		bool renders = false;
+		for (auto transform : transforms)
+		{
+			auto actor = transform->GetActor_PtrRaw();
+			if (actor->HasComponent<Camera>() || actor->HasComponent<Skybox>() || actor->HasComponent<AudioListener>())
+				return false;
+
+			auto light = actor->GetComponent_PtrRaw<Light>();
+			if (light && light->GetLightType() == LightType_Directional)
+				return false;
+
+			renders |= actor->HasComponent<Renderable>();
+		}
+
+		return renders;
+	}
+
+	bool WorldCells::Save(const string& worldFilePath, const vector<shared_ptr<Actor>>& roots)
+	{
+		auto world = m_context->GetSubsystem<World>();
+
+		// Group the roots by the cell they are in, descendants go wherever their root goes
+		map<pair<int, int>, vector<shared_ptr<Actor>>> groups;
+		for (const auto& root : roots)
+		{
+			Vector3 position = root->GetTransform_PtrRaw()->GetPosition();
+			groups[{ (int)floorf(position.x / m_cellSize), (int)floorf(position.z / m_cellSize) }].emplace_back(root);
+		}
+
+		// Cells which aren't in memory have nothing to write, their files are kept
+		vector<shared_ptr<Cell>> cells;
+		for (const auto& cell : m_cells)
+		{
+			if (cell->state != Cell_Loaded && FileSystem::FileExists(cell->filePath))
+			{
+				cells.emplace_back(cell);
+			}
+		}
+
+		string directory	= FileSystem::GetDirectoryFromFilePath(worldFilePath);
+		string base			= FileSystem::GetFilePathWithoutExtension(worldFilePath);
+		for (const auto& group : groups)
+		{
+			// A kept cell can share the coordinates, what got moved into it goes next to it
+			string filePath;
+			for (int n = 0; filePath.empty() || any_of(cells.begin(), cells.end(), [&filePath](const shared_ptr<Cell>& cell) { return cell->filePath == filePath; }); n++)
+			{
+				filePath = base + "_" + to_string(group.first.first) + "_" + to_string(group.first.second) + (n ? "_" + to_string(n) : "") + EXTENSION_WORLD_CELL;
+			}
+
+			{
+				// Same layout as a world file, the resources first so they can be loaded ahead of the actors.
+				// A cell that holds the same bytes as when it was last saved isn't written again.
+				vector<std::byte> data;
+				auto file = make_unique<FileStream>(&data);
+				vector<string> resourcePaths;
+				for (const auto& root : group.second)
+				{
+					_WorldCells::Resources_Collect(root.get(), resourcePaths);
+				}
+				World::Resources_Serialize(file.get(), resourcePaths);
+				world->Actors_Serialize(file.get(), group.second);
+				file.reset();
+
+				if (!world->File_Write(filePath, data))
+				{
+					LOGF_ERROR("WorldCells::Save: Failed to create \"%s\"", filePath.c_str());
+					return false;
+				}
+			}
+
+			auto cell		= make_shared<Cell>();
+			cell->x			= group.first.first;
+			cell->z			= group.first.second;
+			cell->filePath	= filePath;
+			cell->size		= (unsigned int)FileSystem::GetFileSize(filePath);
+			cell->state		= Cell_Loaded;
+			for (const auto& root : group.second)
+			{
+				cell->roots.emplace_back(root->GetHandle());
+			}
+			cells.emplace_back(cell);
+		}
+
+		// The table
+		auto table = make_unique<FileStream>(_WorldCells::GetTableFilePath(worldFilePath), FileStreamMode_WriteBuffered);
+		if (!table->IsOpen())
+			return false;
+
+		table->Write(m_cellSize);
+		table->Write((int)cells.size());
+		for (const auto& cell : cells)
+		{
+			table->Write(cell->x);
+			table->Write(cell->z);
+			table->Write(cell->filePath);
+			table->Write(cell->size);
+		}
+
+		// The world now streams from what was just saved
+		m_cells = cells;
+
+		return true;
+	}
+
+	bool WorldCells::Open(const string& worldFilePath)
+	{
+		Close();
+
+		string tableFilePath = _WorldCells::GetTableFilePath(worldFilePath);
+		if (!FileSystem::FileExists(tableFilePath))
+			return false;
+
+		auto table = make_unique<FileStream>(tableFilePath, FileStreamMode_ReadMapped);
+		if (!table->IsOpen())
+			return false;
+
+		table->Read(&m_cellSize);
+		int count = table->ReadInt();
+		for (int i = 0; i < count; i++)
+		{
+			auto cell = make_shared<Cell>();
+			table->Read(&cell->x);
+			table->Read(&cell->z);
+			table->Read(&cell->filePath);
+			table->Read(&cell->size);
+			m_cells.emplace_back(cell);
+		}
+
+		LOGF_INFO("WorldCells::Open: Streaming %d cells", count);
+		return !m_cells.empty();
+	}
+
+	void WorldCells::Close()
+	{
+		// Cells still loading hold on to themselves until they are done
+		m_cells.clear();
+	}
+
+	void WorldCells::Tick(const Vector3& position)
+	{
+		if (m_cells.empty())
+			return;
+
+		// Create the actors of a single cell per frame, a burst of them finishing together gets spread across frames
+		for (const auto& cell : m_cells)
+		{
+			if (cell->state == Cell_Ready)
+			{
+				Cell_Instantiate(*cell);
+				break;
+			}
+		}
+
+		// Nearest first
+		vector<pair<float, shared_ptr<Cell>>> cells;
+		cells.reserve(m_cells.size());
+		for (const auto& cell : m_cells)
+		{
+			cells.emplace_back(Cell_GetDistance(*cell, position), cell);
+		}
+		sort(cells.begin(), cells.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+		// Far cells stream out
+		unsigned long long usage	= 0;
+		unsigned int loading		= 0;
+		for (const auto& cell : cells)
+		{
+			if (cell.second->state == Cell_Loaded && cell.first > m_radiusUnload)
+			{
+				Cell_Unload(*cell.second);
+			}
+
+			usage	+= cell.second->state != Cell_Unloaded ? cell.second->size : 0;
+			loading	+= cell.second->state == Cell_Loading ? 1 : 0;
+		}
+
+		// Near cells stream in, when one doesn't fit the budget the furthest loaded ones beyond it make room
+		for (const auto& cell : cells)
+		{
+			if (cell.first > m_radiusLoad || loading >= CELLS_LOADING_MAX)
+				break;
+
+			if (cell.second->state != Cell_Unloaded)
+				continue;
+
+			for (auto it = cells.rbegin(); usage + cell.second->size > m_budget && it != cells.rend() && it->first > cell.first; ++it)
+			{
+				if (it->second->state == Cell_Loaded)
+				{
+					usage -= it->second->size;
+					Cell_Unload(*it->second);
+				}
+			}
+
+			if (usage + cell.second->size > m_budget)
+				break;
+
+			usage += cell.second->size;
+			loading++;
+			Cell_Load(cell.second);
+		}
+	}
+
+	unsigned long long WorldCells::GetMemoryUsage()
+	{
+		unsigned long long usage = 0;
+		for (const auto& cell : m_cells)
+		{
+			usage += cell->state != Cell_Unloaded ? cell->size : 0;
+		}
+
+		return usage;
+	}
+
+	float WorldCells::Cell_GetDistance(const Cell& cell, const Vector3& position)
+	{
+		// To the closest point of the cell's square
+		float minX	= cell.x * m_cellSize;
+		float minZ	= cell.z * m_cellSize;
+		float dx	= Max(Max(minX - position.x, position.x - (minX + m_cellSize)), 0.0f);
+		float dz	= Max(Max(minZ - position.z, position.z - (minZ + m_cellSize)), 0.0f);
+
+		return sqrtf(dx * dx + dz * dz);
+	}
+
+	void WorldCells::Cell_Load(const shared_ptr<Cell>& cell)
+	{
+		cell->state				= Cell_Loading;
+		auto resourceManager	= m_context->GetSubsystem<ResourceManager>();
+		cell->data.resize(cell->size);
+		m_context->GetSubsystem<AsyncIO>()->Read(cell->filePath, 0, cell->size, cell->data.data(), IO_Priority_World, [cell, resourceManager](bool read)
+		{
+			auto file = make_unique<FileStream>(cell->data.data(), cell->data.size());
+			if (!read || !file->IsOpen())
+			{
+				// Counts as loaded (with nothing in it), so it isn't retried before it gets far enough to unload
+				LOGF_ERROR("WorldCells::Cell_Load: Failed to read \"%s\"", cell->filePath.c_str());
+				cell->data.clear();
+				cell->state = Cell_Loaded;
+				return;
+			}
+
+			vector<string> resourcePaths;
+			World::Resources_Deserialize(file.get(), &resourcePaths);
+			_WorldCells::Resources_Load(resourceManager, resourcePaths);
+
+			cell->state = Cell_Ready;
+		}, ThreadGroup_Background);
+	}
+
+	void WorldCells::Cell_Unload(Cell& cell)
+	{
+		// Removed at the World's next sync point, together with whatever else goes
+		auto world = m_context->GetSubsystem<World>();
+		for (auto root : cell.roots)
+		{
+			world->Actor_Remove(root);
+		}
+		cell.roots.clear();
+		cell.data.clear();
+		cell.state = Cell_Unloaded;
+	}
+
+	void WorldCells::Cell_Instantiate(Cell& cell)
+	{
+		cell.state = Cell_Loaded;
+
+		// What Cell_Load() read, the file isn't read twice
+		vector<std::byte> data	= move(cell.data);
+		auto file				= make_unique<FileStream>(data.data(), data.size());
+		if (!file->IsOpen())
+			return;
+
+		// The resources are loaded already
+		vector<string> resourcePaths;
+		if (!World::Resources_Deserialize(file.get(), &resourcePaths))
+			return;
+
+		// Saved where they are in the whole world
+		auto world = m_context->GetSubsystem<World>();
+		for (auto root : world->Actors_Deserialize(file.get()))
+		{
+			world->Origin_Place(root);
+			cell.roots.emplace_back(root->GetHandle());
+		}
+	}
+}
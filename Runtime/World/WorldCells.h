@@ -0,0 +1,102 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include <string>
+#include <atomic>
+#include "ActorHandle.h"
+#include "../Math/Vector3.h"
+//=============================
+
+namespace Directus
+{
+	class Context;
+	class Actor;
+
+	// Splits a world's streamable actors into cells of the XZ plane, saved next to the world file. Cells near the camera
+	// get their resources loaded on the worker threads and their actors created on the World's thread, far ones go away.
+	class WorldCells
+	{
+	public:
+		WorldCells(Context* context);
+		~WorldCells() {}
+
+		// Whether a root actor (and it's descendants) can leave memory with it's cell: it renders something
+		// and isn't something the world always needs (a camera, the listener, the skybox, a directional light)
+		static bool IsStreamable(Actor* root);
+
+		// Writes the roots into cells by their position, plus the table listing them, cells which aren't loaded are kept as they are
+		bool Save(const std::string& worldFilePath, const std::vector<std::shared_ptr<Actor>>& roots);
+		// Starts streaming the cells saved next to a world file, returns false if there aren't any
+		bool Open(const std::string& worldFilePath);
+		void Close();
+		bool IsOpen() { return !m_cells.empty(); }
+
+		// Unloads far cells, starts loading near ones (as the budget allows) and creates the actors of a cell that finished loading
+		void Tick(const Math::Vector3& position);
+
+		//= PROPERTIES ==============================================================================
+		float GetCellSize()								{ return m_cellSize; }
+		void SetCellSize(float size)					{ m_cellSize = size > 0.0f ? size : m_cellSize; }
+		// Cells closer than the load radius stream in, further than the unload radius they stream out
+		void SetRadius(float load, float unload)		{ m_radiusLoad = load; m_radiusUnload = unload > load ? unload : load; }
+		// The cell files' size is what's budgeted, as an estimate of what their actors take
+		void SetBudget(unsigned long long bytes)		{ m_budget = bytes; }
+		unsigned long long GetMemoryUsage();
+		//===========================================================================================
+
+	private:
+		enum Cell_State
+		{
+			Cell_Unloaded,
+			Cell_Loading,	// the file, then its resources on a worker thread
+			Cell_Ready,		// waiting for it's actors to be created
+			Cell_Loaded
+		};
+
+		struct Cell
+		{
+			int x = 0;
+			int z = 0;
+			std::string filePath;
+			unsigned int size = 0; // of the file, in bytes
+			std::atomic<Cell_State> state = Cell_Unloaded;
+			std::vector<ActorHandle> roots;
+			std::vector<std::byte> data; // of the file, from when it's read until its actors are created
+		};
+
+		float Cell_GetDistance(const Cell& cell, const Math::Vector3& position);
+		void Cell_Load(const std::shared_ptr<Cell>& cell);
+		void Cell_Unload(Cell& cell);
+		void Cell_Instantiate(Cell& cell);
+
+		std::vector<std::shared_ptr<Cell>> m_cells;
+		float m_cellSize				= 64.0f;
+		float m_radiusLoad				= 128.0f;
+		float m_radiusUnload			= 160.0f;
+		unsigned long long m_budget		= 256ULL * 1024 * 1024;
+		Context* m_context				= nullptr;
+	};
+}
@@ -0,0 +1,105 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../Core/EngineDefs.h"
+#include "WorldSnapshot.h"
+#include "../IO/FileStream.h"
+#include "../Core/Stopwatch.h"
+//===============================
+
+namespace Directus
+{
+	enum WorldLoad_State
+	{
+		WorldLoad_Resources,	// loading on the worker threads, the previous world keeps running
+		WorldLoad_Actors,		// being created by the World, a batch per frame
+		WorldLoad_Completed,
+		WorldLoad_Failed
+	};
+
+	// A world loading in the background, see World::LoadFromFileAsync()
+	class ENGINE_CLASS WorldLoad
+	{
+	public:
+		WorldLoad(const std::string& filePath) { m_filePath = filePath; }
+
+		WorldLoad_State GetState()		{ return m_state; }
+		bool IsDone()					{ return m_state == WorldLoad_Completed || m_state == WorldLoad_Failed; }
+		const std::string& GetFilePath()	{ return m_filePath; }
+
+		// Resources count as much as actors, from 0 to 1
+		float GetProgress()
+		{
+			float resources	= m_resourceCount ? (float)m_resourcesDone / (float)m_resourceCount : 1.0f;
+			float actors	= m_actorCount ? (float)m_actorsDone / (float)m_actorCount : (m_state == WorldLoad_Completed ? 1.0f : 0.0f);
+			return (resources + actors) * 0.5f;
+		}
+
+		// Blocks until it's done, the World creates the actors while it ticks, so it's never waited on from there
+		bool Wait()
+		{
+			if (std::this_thread::get_id() == m_worldThread)
+				return false;
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return IsDone(); });
+			return m_state == WorldLoad_Completed;
+		}
+
+	private:
+		friend class World;
+
+		void Finish(WorldLoad_State state)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_state = state;
+			}
+			m_condition.notify_all();
+		}
+
+		std::string m_filePath;
+		std::atomic<WorldLoad_State> m_state	= WorldLoad_Resources;
+		std::atomic<unsigned int> m_resourcesDone		= 0;
+		unsigned int m_resourceCount					= 0;
+		std::atomic<unsigned int> m_actorsDone			= 0;
+		unsigned int m_actorCount						= 0;
+		std::vector<std::vector<std::string>> m_stages;	// resources by type, each type loads once the previous one did
+		std::atomic<unsigned int> m_stagePending		= 0;	// resources of the current stage still loading
+		std::unique_ptr<FileStream> m_file;				// at the next root to create, while creating actors
+		std::unique_ptr<WorldSnapshot> m_snapshot;		// instead of the file, when loading a snapshot
+		std::vector<class Actor*> m_roots;
+		std::thread::id m_worldThread;
+		Stopwatch m_timer;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+	};
+}
@@ -0,0 +1,417 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "WorldSnapshot.h"
+#include <functional>
+#include "World.h"
+#include "Actor.h"
+#include "Components/Transform.h"
+#include "../IO/FileStream.h"
+#include "../FileSystem/FileSystem.h"
+#include "../Logging/Log.h"
+//=====================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Directus::Math;
+//=============================
+
+#define SNAPSHOT_MAGIC 0x50414E53 // "SNAP"
+#define SNAPSHOT_VERSION 3
+
+namespace Directus
+{
+	namespace _WorldSnapshot
+	{
+		// Where a string is in the string table
+		struct StringRecord
+		{
+			unsigned int offset;
+			unsigned int length;
+		};
+
+		// Offsets are from the start of the file, every table is 4 byte aligned
+		struct Header
+		{
+			unsigned int magic;
+			unsigned int version;
+			unsigned int size;
+			unsigned int actorCount;
+			unsigned int actorsOffset;		// ActorRecord[actorCount]
+			unsigned int transformsOffset;	// TransformRecord[actorCount]
+			unsigned int blockCount;
+			unsigned int blocksOffset;		// BlockRecord[blockCount]
+			unsigned int resourceCount;
+			unsigned int resourcesOffset;	// StringRecord[resourceCount]
+			unsigned int stringsOffset;
+			unsigned int stringsSize;
+		};
+
+		// Depth first, a parent always comes before it's children
+		struct ActorRecord
+		{
+			unsigned int ID;
+			int parent; // index of the parent's record, -1 for a root
+			StringRecord name;
+			unsigned int active;
+			unsigned int visible;
+			unsigned int isStatic;
+		};
+
+		// By actor, every actor has a transform
+		struct TransformRecord
+		{
+			Vector3 position;
+			Quaternion rotation;
+			Vector3 scale;
+			Vector3 lookAt;
+		};
+
+		// The components of a type, in the order their actors are in
+		struct BlockRecord
+		{
+			unsigned int type;
+			unsigned int count;
+			unsigned int componentsOffset; // ComponentRecord[count]
+		};
+
+		// A component's own serialized data, it's the only part of a snapshot that is variable in size
+		struct ComponentRecord
+		{
+			unsigned int actor; // index of the actor's record
+			unsigned int ID;
+			unsigned int dataOffset;
+			unsigned int dataSize;
+		};
+
+		template <typename T>
+		const T* Table(const vector<std::byte>& data, unsigned int offset) { return reinterpret_cast<const T*>(data.data() + offset); }
+	}
+
+	WorldSnapshot::WorldSnapshot(Context* context)
+	{
+		m_context = context;
+	}
+
+	bool WorldSnapshot::Save(const string& filePath, const vector<string>& resourcePaths, const vector<shared_ptr<Actor>>& roots)
+	{
+		using namespace _WorldSnapshot;
+
+		vector<char> strings;
+		auto AddString = [&strings](const string& value)
+		{
+			StringRecord record = { (unsigned int)strings.size(), (unsigned int)value.length() };
+			strings.insert(strings.end(), value.begin(), value.end());
+			return record;
+		};
+
+		// Actors and transforms, depth first
+		vector<Actor*> actors;
+		vector<ActorRecord> actorRecords;
+		vector<TransformRecord> transformRecords;
+		function<void(Actor*, int)> Gather = [&](Actor* actor, int parent)
+		{
+			int index = (int)actors.size();
+			actors.emplace_back(actor);
+
+			ActorRecord record;
+			record.ID		= actor->GetID();
+			record.parent	= parent;
+			record.name		= AddString(actor->GetName());
+			record.active	= actor->IsActive() ? 1 : 0;
+			record.visible	= actor->IsVisibleInHierarchy() ? 1 : 0;
+			record.isStatic	= actor->IsStatic() ? 1 : 0;
+			actorRecords.emplace_back(record);
+
+			auto transform = actor->GetTransform_PtrRaw();
+			TransformRecord transformRecord;
+			transformRecord.position	= transform->GetPositionLocal();
+			transformRecord.rotation	= transform->GetRotationLocal();
+			transformRecord.scale		= transform->GetScaleLocal();
+			transformRecord.lookAt		= transform->m_lookAt;
+			transformRecords.emplace_back(transformRecord);
+
+			for (const auto& child : transform->GetChildren())
+			{
+				Gather(child->GetActor_PtrRaw(), index);
+			}
+		};
+		for (const auto& root : roots)
+		{
+			Gather(root.get(), -1);
+		}
+
+		// Every other component, grouped by type
+		vector<vector<ComponentRecord>> componentRecords(ComponentType_Unknown);
+		vector<std::byte> componentData;
+		{
+			FileStream dataStream(&componentData);
+			for (unsigned int i = 0; i < (unsigned int)actors.size(); i++)
+			{
+				for (const auto& component : actors[i]->GetAllComponents())
+				{
+					if (component->GetType() == ComponentType_Transform || component->GetType() >= ComponentType_Unknown)
+						continue;
+
+					ComponentRecord record;
+					record.actor		= i;
+					record.ID			= component->GetID();
+					record.dataOffset	= (unsigned int)componentData.size();
+					dataStream.Chunk_Begin((uint32_t)component->GetType(), component->GetSerializedVersion());
+					component->Serialize(&dataStream);
+					dataStream.Chunk_End();
+					record.dataSize		= (unsigned int)componentData.size() - record.dataOffset;
+					componentRecords[component->GetType()].emplace_back(record);
+				}
+			}
+		}
+
+		vector<StringRecord> resourceRecords;
+		for (const auto& resourcePath : resourcePaths)
+		{
+			resourceRecords.emplace_back(AddString(resourcePath));
+		}
+
+		// Lay the tables out, the variable sized parts (strings and component data) go last
+		Header header			= {};
+		header.magic			= SNAPSHOT_MAGIC;
+		header.version			= SNAPSHOT_VERSION;
+		header.actorCount		= (unsigned int)actors.size();
+		header.actorsOffset		= sizeof(Header);
+		header.transformsOffset	= header.actorsOffset + header.actorCount * sizeof(ActorRecord);
+		header.blocksOffset		= header.transformsOffset + header.actorCount * sizeof(TransformRecord);
+
+		vector<BlockRecord> blockRecords;
+		for (unsigned int type = 0; type < (unsigned int)componentRecords.size(); type++)
+		{
+			if (!componentRecords[type].empty())
+			{
+				blockRecords.push_back({ type, (unsigned int)componentRecords[type].size(), 0 });
+			}
+		}
+		header.blockCount = (unsigned int)blockRecords.size();
+
+		unsigned int offset = header.blocksOffset + header.blockCount * sizeof(BlockRecord);
+		for (auto& block : blockRecords)
+		{
+			block.componentsOffset	= offset;
+			offset					+= block.count * sizeof(ComponentRecord);
+		}
+		header.resourceCount	= (unsigned int)resourceRecords.size();
+		header.resourcesOffset	= offset;
+		header.stringsOffset	= header.resourcesOffset + header.resourceCount * sizeof(StringRecord);
+		header.stringsSize		= (unsigned int)strings.size();
+		unsigned int dataOffset	= header.stringsOffset + header.stringsSize;
+		header.size				= dataOffset + (unsigned int)componentData.size();
+
+		for (auto& block : blockRecords)
+		{
+			for (auto& record : componentRecords[block.type])
+			{
+				record.dataOffset += dataOffset;
+			}
+		}
+
+		// Write everything in the order it was laid out in
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_WriteBuffered);
+		if (!file->IsOpen())
+			return false;
+
+		file->WriteBytes(&header, sizeof(Header));
+		file->WriteBytes(actorRecords.data(), actorRecords.size() * sizeof(ActorRecord));
+		file->WriteBytes(transformRecords.data(), transformRecords.size() * sizeof(TransformRecord));
+		file->WriteBytes(blockRecords.data(), blockRecords.size() * sizeof(BlockRecord));
+		for (const auto& block : blockRecords)
+		{
+			file->WriteBytes(componentRecords[block.type].data(), componentRecords[block.type].size() * sizeof(ComponentRecord));
+		}
+		file->WriteBytes(resourceRecords.data(), resourceRecords.size() * sizeof(StringRecord));
+		file->WriteBytes(strings.data(), strings.size());
+		file->WriteBytes(componentData.data(), componentData.size());
+
+		return true;
+	}
+
+	bool WorldSnapshot::Open(const string& filePath)
+	{
+		using namespace _WorldSnapshot;
+
+		m_data.clear();
+		auto size = FileSystem::GetFileSize(filePath);
+		if (size < sizeof(Header))
+		{
+			LOG_ERROR("WorldSnapshot::Open: \"" + filePath + "\" is not a world snapshot");
+			return false;
+		}
+
+		auto file = make_unique<FileStream>(filePath, FileStreamMode_ReadMapped);
+		if (!file->IsOpen())
+			return false;
+
+		m_data.resize((size_t)size);
+		file->ReadBytes(m_data.data(), m_data.size());
+
+		// Every table has to be where the header says, so nothing needs checking once the actors get created
+		auto header = Table<Header>(m_data, 0);
+		auto Fits	= [this](uint64_t offset, uint64_t count, uint64_t stride) { return offset + count * stride <= m_data.size(); };
+		bool valid	= header->magic == SNAPSHOT_MAGIC && header->version == SNAPSHOT_VERSION && header->size == m_data.size();
+		valid		= valid && Fits(header->actorsOffset, header->actorCount, sizeof(ActorRecord));
+		valid		= valid && Fits(header->transformsOffset, header->actorCount, sizeof(TransformRecord));
+		valid		= valid && Fits(header->blocksOffset, header->blockCount, sizeof(BlockRecord));
+		valid		= valid && Fits(header->resourcesOffset, header->resourceCount, sizeof(StringRecord));
+		valid		= valid && Fits(header->stringsOffset, header->stringsSize, 1);
+		if (valid)
+		{
+			auto actors = Table<ActorRecord>(m_data, header->actorsOffset);
+			for (unsigned int i = 0; i < header->actorCount && valid; i++)
+			{
+				valid = actors[i].parent >= -1 && actors[i].parent < (int)i && actors[i].name.offset + actors[i].name.length <= header->stringsSize;
+			}
+
+			auto resources = Table<StringRecord>(m_data, header->resourcesOffset);
+			for (unsigned int i = 0; i < header->resourceCount && valid; i++)
+			{
+				valid = resources[i].offset + resources[i].length <= header->stringsSize;
+			}
+
+			auto blocks = Table<BlockRecord>(m_data, header->blocksOffset);
+			for (unsigned int i = 0; i < header->blockCount && valid; i++)
+			{
+				valid = blocks[i].type < ComponentType_Unknown && Fits(blocks[i].componentsOffset, blocks[i].count, sizeof(ComponentRecord));
+				auto components = valid ? Table<ComponentRecord>(m_data, blocks[i].componentsOffset) : nullptr;
+				for (unsigned int j = 0; j < blocks[i].count && valid; j++)
+				{
+					valid = components[j].actor < header->actorCount && Fits(components[j].dataOffset, components[j].dataSize, 1);
+				}
+			}
+		}
+
+		if (!valid)
+		{
+			LOG_ERROR("WorldSnapshot::Open: \"" + filePath + "\" is corrupt or from a different version");
+			m_data.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	vector<string> WorldSnapshot::GetResourcePaths()
+	{
+		using namespace _WorldSnapshot;
+
+		vector<string> resourcePaths;
+		if (m_data.empty())
+			return resourcePaths;
+
+		auto header		= Table<Header>(m_data, 0);
+		auto resources	= Table<StringRecord>(m_data, header->resourcesOffset);
+		auto strings	= Table<char>(m_data, header->stringsOffset);
+		for (unsigned int i = 0; i < header->resourceCount; i++)
+		{
+			resourcePaths.emplace_back(strings + resources[i].offset, resources[i].length);
+		}
+
+		return resourcePaths;
+	}
+
+	vector<Actor*> WorldSnapshot::Instantiate()
+	{
+		using namespace _WorldSnapshot;
+
+		vector<Actor*> roots;
+		if (m_data.empty())
+			return roots;
+
+		auto header		= Table<Header>(m_data, 0);
+		auto records	= Table<ActorRecord>(m_data, header->actorsOffset);
+		auto transforms	= Table<TransformRecord>(m_data, header->transformsOffset);
+		auto strings	= Table<char>(m_data, header->stringsOffset);
+		auto world		= m_context->GetSubsystem<World>();
+
+		// Actors and transforms, straight out of their tables
+		world->Actors_Reserve(header->actorCount);
+		vector<Actor*> actors(header->actorCount);
+		for (unsigned int i = 0; i < header->actorCount; i++)
+		{
+			const auto& record	= records[i];
+			Actor* actor		= world->Actor_Create().get();
+			actor->SetID(record.ID);
+			actor->SetName(string(strings + record.name.offset, record.name.length));
+			actor->SetActive(record.active != 0);
+			actor->SetHierarchyVisibility(record.visible != 0);
+			actor->SetStatic(record.isStatic != 0);
+
+			auto transform				= actor->GetTransform_PtrRaw();
+			transform->m_positionLocal	= transforms[i].position;
+			transform->m_rotationLocal	= transforms[i].rotation;
+			transform->m_scaleLocal		= transforms[i].scale;
+			transform->m_lookAt			= transforms[i].lookAt;
+			if (record.parent != -1)
+			{
+				transform->AttachTo(actors[record.parent]->GetTransform_PtrRaw());
+			}
+			else
+			{
+				roots.emplace_back(actor);
+			}
+			transform->MarkDirty();
+
+			actors[i] = actor;
+		}
+
+		// Components can depend on each other (e.g. a collider on it's rigid body), so all of them
+		// get created first, then every type reads back it's components from their slices of the data
+		auto blocks = Table<BlockRecord>(m_data, header->blocksOffset);
+		vector<pair<shared_ptr<IComponent>, const ComponentRecord*>> components;
+		for (unsigned int i = 0; i < header->blockCount; i++)
+		{
+			auto componentRecords = Table<ComponentRecord>(m_data, blocks[i].componentsOffset);
+			for (unsigned int j = 0; j < blocks[i].count; j++)
+			{
+				if (auto component = actors[componentRecords[j].actor]->AddComponent((ComponentType)blocks[i].type))
+				{
+					component->SetID(componentRecords[j].ID);
+					components.emplace_back(component, &componentRecords[j]);
+				}
+			}
+		}
+
+		for (const auto& component : components)
+		{
+			// In a chunk, for the version it was written in
+			FileStream stream(m_data.data() + component.second->dataOffset, component.second->dataSize);
+			FileStreamChunk chunk;
+			if (stream.Chunk_Read(&chunk))
+			{
+				component.first->Deserialize(&stream);
+			}
+		}
+
+		for (auto actor : actors)
+		{
+			actor->NotifyComponentsChanged();
+		}
+
+		return roots;
+	}
+}
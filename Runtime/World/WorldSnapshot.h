@@ -0,0 +1,58 @@
+/*
+Copyright(c) 2016-2018 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+//=====================
+
+namespace Directus
+{
+	class Context;
+	class Actor;
+
+	// A baked world, fixed-layout records grouped by type and tied together by file offsets. It's read with a single
+	// read and used as it is, actors and transforms get copied out of their tables and every other component reads
+	// back from it's own slice of the data, so there is nothing to parse or fix up before the actors get created.
+	class WorldSnapshot
+	{
+	public:
+		WorldSnapshot(Context* context);
+		~WorldSnapshot() {}
+
+		// Bakes the roots and their descendants, along with the resources they need
+		bool Save(const std::string& filePath, const std::vector<std::string>& resourcePaths, const std::vector<std::shared_ptr<Actor>>& roots);
+
+		// Reads and validates a snapshot, the resources it lists have to be loaded before the actors get created
+		bool Open(const std::string& filePath);
+		std::vector<std::string> GetResourcePaths();
+		// Creates the actors into the World, returns the roots
+		std::vector<Actor*> Instantiate();
+
+	private:
+		std::vector<std::byte> m_data;
+		Context* m_context;
+	};
+}